@@ -19,8 +19,9 @@
 
 /* Accumulator Constants */
 #define OS_ACM_EXPIRE_ELM      120
-#define OS_ACM_PURGE_INTERVAL  300
-#define OS_ACM_PURGE_COUNT     200
+
+/* Number of locks shared by the keys. The events with the same key are accumulated one at a time */
+#define OS_ACM_STRIPES         64
 
 /* Accumulator Max Values */
 #define OS_ACM_MAXKEY 256
@@ -47,6 +48,9 @@ int os_analysisd_acm_lookups;
 
 time_t os_analysisd_acm_purge_ts;
 
+static pthread_mutex_t acm_stripes[OS_ACM_STRIPES] = { [0 ... OS_ACM_STRIPES - 1] = PTHREAD_MUTEX_INITIALIZER };
+static pthread_mutex_t acm_purge_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 
 /**
  * @brief Copies the C string pointed by src into the array pointed by dst
@@ -66,6 +70,13 @@ static OS_ACM_Store *InitACMStore(void);
  */
 static void FreeACMStore(OS_ACM_Store *obj);
 
+/**
+ * @brief Get the lock of a key
+ * @param key accumulator key
+ * @return lock that serializes the accesses to the stored data of the key
+ */
+static pthread_mutex_t *acm_stripe(const char *key);
+
 
 /* Start the Accumulator module */
 int Accumulate_Init(OSHash **acm_store, int *acm_lookups, time_t *acm_purge_ts)
@@ -101,6 +112,7 @@ Eventinfo *Accumulate(Eventinfo *lf, OSHash **acm_store, int *acm_lookups, time_
 
     char _key[OS_ACM_MAXKEY];
     OS_ACM_Store *stored_data = 0;
+    pthread_mutex_t *stripe;
 
     time_t  current_ts;
     struct timeval tp;
@@ -139,6 +151,9 @@ Eventinfo *Accumulate(Eventinfo *lf, OSHash **acm_store, int *acm_lookups, time_
         return lf;
     }
 
+    stripe = acm_stripe(_key);
+    w_mutex_lock(stripe);
+
     /* Check if acm is already present */
     if ((stored_data = (OS_ACM_Store *)OSHash_Get_ex(*acm_store, _key)) != NULL) {
         mdebug2("accumulator: DEBUG: Lookup for '%s' found a stored value!", _key);
@@ -233,6 +248,7 @@ Eventinfo *Accumulate(Eventinfo *lf, OSHash **acm_store, int *acm_lookups, time_
         }
     }
 
+    w_mutex_unlock(stripe);
     return lf;
 }
 
@@ -244,53 +260,64 @@ void Accumulate_CleanUp(OSHash **acm_store, int *acm_lookups, time_t *acm_purge_
 
     OSHashNode *curr;
     OS_ACM_Store *stored_data;
-    char *key;
-    unsigned int ti;
-
-    /* Keep track of how many times we're called */
-    (*acm_lookups)++;
+    char **keys = NULL;
+    size_t keys_size = 0;
+    unsigned int row;
+    size_t i;
 
     gettimeofday(&tp, NULL);
     current_ts = tp.tv_sec;
 
-    /* Do we really need to purge? */
-    if (*acm_lookups < OS_ACM_PURGE_COUNT && *acm_purge_ts < current_ts + OS_ACM_PURGE_INTERVAL) {
-        return;
+    /* Each lookup purges the next row of the hash, instead of walking the whole hash at once */
+    w_rwlock_rdlock(&(*acm_store)->mutex);
+
+    w_mutex_lock(&acm_purge_mutex);
+    row = (unsigned int)(*acm_lookups)++ % ((*acm_store)->rows + 1);
+    if (row == (*acm_store)->rows) {
+        *acm_lookups = 0;
+        *acm_purge_ts = current_ts;
     }
-    mdebug1("accumulator: DEBUG: Accumulator_CleanUp() running .. ");
+    w_mutex_unlock(&acm_purge_mutex);
 
-    /* Yes, we do */
-    *acm_lookups = 0;
-    *acm_purge_ts = current_ts;
-
-    /* Loop through the hash */
-    for (ti = 0; ti < (*acm_store)->rows; ti++) {
-        curr = (*acm_store)->table[ti];
-        while ( curr != NULL ) {
-            /* Get the Key and Data */
-            key  = (char *) curr->key;
-            stored_data = (OS_ACM_Store *) curr->data;
-            /* Increment to the next element */
-            curr = curr->next;
-
-            mdebug2("accumulator: DEBUG: CleanUp() evaluating cached key: %s ", key);
-            /* Check for a valid element */
-            if ( stored_data != NULL ) {
-                /* Check for expiration */
-                mdebug2("accumulator: DEBUG: CleanUp() elm:%ld, curr:%ld", (long int)stored_data->timestamp, (long int)current_ts);
-                if ( stored_data->timestamp < current_ts - OS_ACM_EXPIRE_ELM ) {
-                    mdebug2("accumulator: DEBUG: CleanUp() Expiring '%s'", key);
-                    if (OSHash_Delete_ex(*acm_store, key) != NULL) {
-                        FreeACMStore(stored_data);
-                        expired++;
-                    } else {
-                        mdebug1("accumulator: DEBUG: CleanUp() failed to find key '%s'", key);
-                    }
-                }
+    /* The data is only freed after it's deleted from the hash, so it can be read here */
+    for (curr = (*acm_store)->table[row]; curr != NULL; curr = curr->next) {
+        stored_data = (OS_ACM_Store *) curr->data;
+
+        if (stored_data != NULL && stored_data->timestamp < current_ts - OS_ACM_EXPIRE_ELM) {
+            os_realloc(keys, (keys_size + 1) * sizeof(char *), keys);
+            os_strdup(curr->key, keys[keys_size]);
+            keys_size++;
+        }
+    }
+
+    w_rwlock_unlock(&(*acm_store)->mutex);
+
+    /* Check them again with the lock of the key, they may have been updated */
+    for (i = 0; i < keys_size; i++) {
+        pthread_mutex_t *stripe = acm_stripe(keys[i]);
+
+        w_mutex_lock(stripe);
+
+        stored_data = (OS_ACM_Store *) OSHash_Get_ex(*acm_store, keys[i]);
+        if (stored_data != NULL && stored_data->timestamp < current_ts - OS_ACM_EXPIRE_ELM) {
+            mdebug2("accumulator: DEBUG: CleanUp() Expiring '%s'", keys[i]);
+            if (OSHash_Delete_ex(*acm_store, keys[i]) != NULL) {
+                FreeACMStore(stored_data);
+                expired++;
+            } else {
+                mdebug1("accumulator: DEBUG: CleanUp() failed to find key '%s'", keys[i]);
             }
         }
+
+        w_mutex_unlock(stripe);
+        os_free(keys[i]);
+    }
+
+    os_free(keys);
+
+    if (expired > 0) {
+        mdebug1("accumulator: DEBUG: Expired %d elements", expired);
     }
-    mdebug1("accumulator: DEBUG: Expired %d elements", expired);
 }
 
 /* Initialize a storage object */
@@ -334,6 +361,17 @@ void w_analysisd_accumulate_free(OSHash **acm_store) {
     *acm_store = NULL;
 }
 
+pthread_mutex_t *acm_stripe(const char *key)
+{
+    unsigned int hash = 0;
+
+    for (; *key != '\0'; key++) {
+        hash = hash * 31 + (unsigned char)*key;
+    }
+
+    return &acm_stripes[hash % OS_ACM_STRIPES];
+}
+
 int acm_str_replace(char **dst, const char *src)
 {
     int result = 0;
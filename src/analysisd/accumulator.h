@@ -47,10 +47,12 @@ int Accumulate_Init(OSHash **acm_store, int *acm_lookups, time_t *acm_purge_ts);
 Eventinfo *Accumulate(Eventinfo *lf, OSHash **acm_store, int *acm_lookups, time_t *acm_purge_ts);
 
 /**
- * @brief Purge the cache as needed
+ * @brief Purge the expired entries of the next row of the hash
+ *
+ * It's called on each lookup, so the whole hash is purged every `rows` lookups.
  * @param acm_store Hash to save data which have the same id
- * @param acm_lookups counter of the number of times purged
- * @param acm_purge_ts counter of interval time since the last purge
+ * @param acm_lookups counter of the lookups, the next row to purge
+ * @param acm_purge_ts time of the last purge of the whole hash
  */
 void Accumulate_CleanUp(OSHash **acm_store, int *acm_lookups, time_t *acm_purge_ts);
 
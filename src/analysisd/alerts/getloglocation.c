@@ -33,9 +33,14 @@ static char __alogfile[OS_FLSIZE + 1];
 static char __flogfile[OS_FLSIZE + 1];
 static char __jlogfile[OS_FLSIZE + 1];
 static char __ejlogfile[OS_FLSIZE + 1];
+static char *__ebuffer;
+static char *__abuffer;
+static char *__fbuffer;
+static char *__jbuffer;
+static char *__ejbuffer;
 
 // Open a valid log or die. No return on error.
-static FILE * openlog(FILE * fp, char path[OS_FLSIZE + 1], const char * logdir, int year, const char * month, const char * tag, int day, const char * ext, const char * lname, int * counter, int rotate);
+static FILE * openlog(FILE * fp, char path[OS_FLSIZE + 1], const char * logdir, int year, const char * month, const char * tag, int day, const char * ext, const char * lname, int * counter, char ** buffer, int rotate);
 
 void OS_InitLog()
 {
@@ -73,22 +78,22 @@ int OS_GetLogLocation(int day,int year,char *mon)
      */
 
     /* For the events */
-    _eflog = openlog(_eflog, __elogfile, EVENTS, year, mon, "archive", day, "log", EVENTS_DAILY, &__ecounter, FALSE);
+    _eflog = openlog(_eflog, __elogfile, EVENTS, year, mon, "archive", day, "log", EVENTS_DAILY, &__ecounter, &__ebuffer, FALSE);
 
     /* For the events in JSON */
     if (Config.logall_json) {
-        _ejflog = openlog(_ejflog, __ejlogfile, EVENTS, year, mon, "archive", day, "json", EVENTSJSON_DAILY, &__ejcounter, FALSE);
+        _ejflog = openlog(_ejflog, __ejlogfile, EVENTS, year, mon, "archive", day, "json", EVENTSJSON_DAILY, &__ejcounter, &__ejbuffer, FALSE);
     }
 
     /* For the alerts logs */
-    _aflog = openlog(_aflog, __alogfile, ALERTS, year, mon, "alerts", day, "log", ALERTS_DAILY, &__acounter, FALSE);
+    _aflog = openlog(_aflog, __alogfile, ALERTS, year, mon, "alerts", day, "log", ALERTS_DAILY, &__acounter, &__abuffer, FALSE);
 
     if (Config.jsonout_output) {
-        _jflog = openlog(_jflog, __jlogfile, ALERTS, year, mon, "alerts", day, "json", ALERTSJSON_DAILY, &__jcounter, FALSE);
+        _jflog = openlog(_jflog, __jlogfile, ALERTS, year, mon, "alerts", day, "json", ALERTSJSON_DAILY, &__jcounter, &__jbuffer, FALSE);
     }
 
     /* For the firewall events */
-    _fflog = openlog(_fflog, __flogfile, FWLOGS, year, mon, "firewall", day, "log", FWLOGS_DAILY, &__fcounter, FALSE);
+    _fflog = openlog(_fflog, __flogfile, FWLOGS, year, mon, "firewall", day, "log", FWLOGS_DAILY, &__fcounter, &__fbuffer, FALSE);
 
     /* Setting the new day */
     __crt_day = day;
@@ -99,7 +104,7 @@ int OS_GetLogLocation(int day,int year,char *mon)
 
 // Open a valid log or die. No return on error.
 
-FILE * openlog(FILE * fp, char * path, const char * logdir, int year, const char * month, const char * tag, int day, const char * ext, const char * lname, int * counter, int rotate) {
+FILE * openlog(FILE * fp, char * path, const char * logdir, int year, const char * month, const char * tag, int day, const char * ext, const char * lname, int * counter, char ** buffer, int rotate) {
     char next[OS_FLSIZE + 1];
 
     if (fp) {
@@ -140,6 +145,15 @@ FILE * openlog(FILE * fp, char * path, const char * logdir, int year, const char
         merror_exit("Error opening logfile: '%s': (%d) %s", path, errno, strerror(errno));
     }
 
+    // The buffer outlives the stream, it's reused when the log is reopened
+    if (Config.output_buffer_size > 0) {
+        if (*buffer == NULL) {
+            os_malloc(Config.output_buffer_size, *buffer);
+        }
+
+        setvbuf(fp, *buffer, _IOFBF, Config.output_buffer_size);
+    }
+
     // Create a symlink
     unlink(lname);
 
@@ -155,23 +169,23 @@ void OS_RotateLogs(int day,int year,char *mon) {
     if (Config.rotate_interval && c_time - __crt_rsec > Config.rotate_interval) {
         // If timespan exceeded the rotation time and the file isn't empty
         if (_eflog && ftell(_eflog) > 0) {
-            _eflog = openlog(_eflog, __elogfile, EVENTS, year, mon, "archive", day, "log", EVENTS_DAILY, &__ecounter, TRUE);
+            _eflog = openlog(_eflog, __elogfile, EVENTS, year, mon, "archive", day, "log", EVENTS_DAILY, &__ecounter, &__ebuffer, TRUE);
         }
 
         if (_ejflog && ftell(_ejflog) > 0) {
-            _ejflog = openlog(_ejflog, __ejlogfile, EVENTS, year, mon, "archive", day, "json", EVENTSJSON_DAILY, &__ejcounter, TRUE);
+            _ejflog = openlog(_ejflog, __ejlogfile, EVENTS, year, mon, "archive", day, "json", EVENTSJSON_DAILY, &__ejcounter, &__ejbuffer, TRUE);
         }
 
         if (_aflog && ftell(_aflog) > 0) {
-            _aflog = openlog(_aflog, __alogfile, ALERTS, year, mon, "alerts", day, "log", ALERTS_DAILY, &__acounter, TRUE);
+            _aflog = openlog(_aflog, __alogfile, ALERTS, year, mon, "alerts", day, "log", ALERTS_DAILY, &__acounter, &__abuffer, TRUE);
         }
 
         if (_jflog && ftell(_jflog) > 0) {
-            _jflog = openlog(_jflog, __jlogfile, ALERTS, year, mon, "alerts", day, "json", ALERTSJSON_DAILY, &__jcounter, TRUE);
+            _jflog = openlog(_jflog, __jlogfile, ALERTS, year, mon, "alerts", day, "json", ALERTSJSON_DAILY, &__jcounter, &__jbuffer, TRUE);
         }
 
         if (_fflog && ftell(_fflog) > 0) {
-            _fflog = openlog(_fflog, __flogfile, FWLOGS, year, mon, "firewall", day, "log", FWLOGS_DAILY, &__fcounter, TRUE);
+            _fflog = openlog(_fflog, __flogfile, FWLOGS, year, mon, "firewall", day, "log", FWLOGS_DAILY, &__fcounter, &__fbuffer, TRUE);
         }
 
         __crt_rsec = c_time;
@@ -179,28 +193,40 @@ void OS_RotateLogs(int day,int year,char *mon) {
         // Or if timespan from last rotation is enough and the file is too big
 
         if (_eflog && ftell(_eflog) > Config.max_output_size) {
-            _eflog = openlog(_eflog, __elogfile, EVENTS, year, mon, "archive", day, "log", EVENTS_DAILY, &__ecounter, TRUE);
+            _eflog = openlog(_eflog, __elogfile, EVENTS, year, mon, "archive", day, "log", EVENTS_DAILY, &__ecounter, &__ebuffer, TRUE);
             __crt_rsec = c_time;
         }
 
         if (_ejflog && ftell(_ejflog) > Config.max_output_size) {
-            _ejflog = openlog(_ejflog, __ejlogfile, EVENTS, year, mon, "archive", day, "json", EVENTSJSON_DAILY, &__ejcounter, TRUE);
+            _ejflog = openlog(_ejflog, __ejlogfile, EVENTS, year, mon, "archive", day, "json", EVENTSJSON_DAILY, &__ejcounter, &__ejbuffer, TRUE);
             __crt_rsec = c_time;
         }
 
         if (_aflog && ftell(_aflog) > Config.max_output_size) {
-            _aflog = openlog(_aflog, __alogfile, ALERTS, year, mon, "alerts", day, "log", ALERTS_DAILY, &__acounter, TRUE);
+            _aflog = openlog(_aflog, __alogfile, ALERTS, year, mon, "alerts", day, "log", ALERTS_DAILY, &__acounter, &__abuffer, TRUE);
             __crt_rsec = c_time;
         }
 
         if (_jflog && ftell(_jflog) > Config.max_output_size) {
-            _jflog = openlog(_jflog, __jlogfile, ALERTS, year, mon, "alerts", day, "json", ALERTSJSON_DAILY, &__jcounter, TRUE);
+            _jflog = openlog(_jflog, __jlogfile, ALERTS, year, mon, "alerts", day, "json", ALERTSJSON_DAILY, &__jcounter, &__jbuffer, TRUE);
             __crt_rsec = c_time;
         }
 
         if (_fflog && ftell(_fflog) > Config.max_output_size) {
-            _fflog = openlog(_fflog, __flogfile, FWLOGS, year, mon, "firewall", day, "log", FWLOGS_DAILY, &__fcounter, TRUE);
+            _fflog = openlog(_fflog, __flogfile, FWLOGS, year, mon, "firewall", day, "log", FWLOGS_DAILY, &__fcounter, &__fbuffer, TRUE);
             __crt_rsec = c_time;
         }
     }
 }
+
+void OS_SyncLogs()
+{
+    FILE * logs[] = { _eflog, _ejflog, _aflog, _jflog, _fflog };
+    unsigned int i;
+
+    for (i = 0; i < sizeof(logs) / sizeof(FILE *); i++) {
+        if (logs[i] && fdatasync(fileno(logs[i])) == -1) {
+            mdebug1("Unable to sync log file: (%d) %s", errno, strerror(errno));
+        }
+    }
+}
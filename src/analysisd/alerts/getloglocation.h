@@ -33,4 +33,7 @@ extern FILE *_ejflog;
 
 void OS_RotateLogs(int day,int year,char *mon);
 
+/* Write the flushed logs to the disk */
+void OS_SyncLogs(void);
+
 #endif /* GETLL_H */
@@ -461,7 +461,9 @@ int FW_Log(Eventinfo *lf)
             lf->dstip,
             lf->dstport);
 
-    fflush(_fflog);
-
     return (1);
 }
+
+void FW_Log_Flush(){
+    fflush(_fflog);
+}
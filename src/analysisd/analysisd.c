@@ -41,6 +41,8 @@
 #include "state.h"
 #include "syscheck_op.h"
 #include "lists_make.h"
+#include "profiler.h"
+#include "ruleset.h"
 
 #ifdef PRELUDE_OUTPUT_ENABLED
 #include "output/prelude.h"
@@ -60,6 +62,7 @@ int decode_fim_event(_sdb *sdb, Eventinfo *lf); // Decode events in json format
 int DecodeRootcheck(Eventinfo *lf);
 int DecodeHostinfo(Eventinfo *lf);
 int DecodeSyscollector(Eventinfo *lf, int *socket);
+char ** SyscollectorSplitBatch(const char *msg);
 int DecodeCiscat(Eventinfo *lf, int *socket);
 int DecodeWinevt(Eventinfo *lf);
 int DecodeSCA(Eventinfo *lf, int *socket);
@@ -103,6 +106,12 @@ static unsigned int hourly_events;
 static unsigned int hourly_syscheck;
 static unsigned int hourly_firewall;
 
+/* CPU sets of the pipeline stages, NULL leaves a stage to the scheduler */
+static w_cpuset_t * input_cpus;
+static w_cpuset_t * decoder_cpus;
+static w_cpuset_t * rule_matching_cpus;
+static w_cpuset_t * writer_cpus;
+
 /* Archives writer thread */
 void * w_writer_thread(__attribute__((unused)) void * args );
 
@@ -148,6 +157,9 @@ void * w_log_rotate_thread(__attribute__((unused)) void * args);
 /* Decode winevt threads */
 void * w_decode_winevt_thread(__attribute__((unused)) void * args);
 
+/* Compile the changed CDB lists thread */
+static void * w_cdb_lists_thread(void * interval);
+
 /* Database synchronization thread */
 static void * w_dispatch_dbsync_thread(void * args);
 
@@ -198,8 +210,8 @@ w_queue_t * decode_queue_hostinfo_input;
 /* Decode event input queue */
 w_queue_t * decode_queue_event_input;
 
-/* Decode pending event output */
-w_queue_t * decode_queue_event_output;
+/* Decode pending event output, one queue per rule matching thread */
+w_queue_t ** decode_queue_event_output;
 
 /* Decode windows event input queue */
 w_queue_t * decode_queue_winevt_input;
@@ -214,7 +226,6 @@ w_queue_t * upgrade_module_input;
 static pthread_mutex_t hourly_firewall_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /* Accumulate mutex */
-static pthread_mutex_t accumulate_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static pthread_mutex_t current_time_mutex = PTHREAD_MUTEX_INITIALIZER;
 
@@ -419,13 +430,7 @@ int main_analysisd(int argc, char **argv)
     Config.geoip_jsonout = getDefine_Int("analysisd", "geoip_jsonout", 0, 1);
 
     /* Opening GeoIP DB */
-    if(Config.geoipdb_file) {
-        geoipdb = GeoIP_open(Config.geoipdb_file, GEOIP_INDEX_CACHE);
-        if (geoipdb == NULL)
-        {
-            merror("Unable to open GeoIP database from: %s (disabling GeoIP).", Config.geoipdb_file);
-        }
-    }
+    OS_GeoIPInit(Config.geoipdb_file, (unsigned int)getDefine_Int("analysisd", "geoip_cache_size", 0, 1048576));
 #endif
 
     /* Fix Config.ar */
@@ -491,12 +496,29 @@ int main_analysisd(int argc, char **argv)
         num_rule_matching_threads = cpu_cores;
     }
 
+    w_profiler_init();
+
+    /* NUMA nodes are resolved before the chroot */
+    input_cpus = w_cpuset_load("analysisd", "input_cpus");
+    decoder_cpus = w_cpuset_load("analysisd", "decoder_cpus");
+    rule_matching_cpus = w_cpuset_load("analysisd", "rule_matching_cpus");
+    writer_cpus = w_cpuset_load("analysisd", "writer_cpus");
+
     /* Continuing in Daemon mode */
     if (!test_config && !run_foreground) {
         nowDaemon();
         goDaemon();
     }
 
+    /* Write the logs from a dedicated thread */
+    int log_async_buffer = getDefine_Int("analysisd", "log_async_buffer", 0, 1048576);
+
+    if (log_async_buffer > 0 && !test_config) {
+        if (w_logging_async_start((size_t)(log_async_buffer < 128 ? 128 : log_async_buffer) * 1024) < 0) {
+            merror("Could not start the asynchronous logging. Logging synchronously.");
+        }
+    }
+
 #ifdef PRELUDE_OUTPUT_ENABLED
     /* Start prelude */
     if (Config.prelude) {
@@ -557,6 +579,17 @@ int main_analysisd(int argc, char **argv)
         OS_CreateEventList(Config.memorysize, os_analysisd_last_events);
     }
 
+    /* Compiled PCRE2 patterns of the previous start */
+    int pcre2_cache = getDefine_Int("analysisd", "pcre2_cache", 0, 1);
+
+    if (pcre2_cache) {
+        int pcre2_cached = w_expression_cache_load(PCRE2_CACHE_FILE);
+
+        if (pcre2_cached >= 0) {
+            mdebug1("Loaded %d compiled PCRE2 patterns from '%s'.", pcre2_cached, PCRE2_CACHE_FILE);
+        }
+    }
+
     /*
      * Anonymous Section: Load rules, decoders, and lists
      *
@@ -688,6 +721,7 @@ int main_analysisd(int argc, char **argv)
                 os_free(list_msg);
             }
             mdebug1("Building CDB lists.");
+            Lists_OP_MakeThreads(getDefine_Int("analysisd", "cdb_make_threads", 1, 32));
             Lists_OP_MakeAll(0, 0, &os_analysisd_cdblists);
         }
 
@@ -759,6 +793,11 @@ int main_analysisd(int argc, char **argv)
         }
     }
 
+    /* Keep the PCRE2 patterns of the ruleset for the next start, logtest sessions still use them */
+    if (pcre2_cache && !test_config && w_expression_cache_save(PCRE2_CACHE_FILE) < 0) {
+        mwarn("Could not write the compiled PCRE2 patterns to '%s'.", PCRE2_CACHE_FILE);
+    }
+
     /* Fix the levels/accuracy */
     {
         int total_rules;
@@ -777,7 +816,7 @@ int main_analysisd(int argc, char **argv)
         if (!Config.g_rules_hash) {
             merror_exit(MEM_ERROR, errno, strerror(errno));
         }
-        AddHash_Rule(tmp_node);
+        AddHash_Rule(Config.g_rules_hash, tmp_node);
     }
 
     /* Check if log_fw is enabled */
@@ -836,11 +875,19 @@ int main_analysisd(int argc, char **argv)
         }
     }
 
+    /* The event threads take the ruleset from here on */
+    w_ruleset_init();
+
     /* Startup message */
     minfo(STARTUP_MSG, (int)getpid());
 
     w_init_queues();
 
+    /* Store the agent ID, location and hostname of the events once */
+    event_strings = w_strpool_init();
+
+    w_mem_metrics_init();
+
     // Start com request thread
     w_create_thread(asyscom_main, NULL);
 
@@ -965,6 +1012,8 @@ void OS_ReadMSG_analysisd(int m_queue)
     int num_decode_hostinfo_threads = getDefine_Int("analysisd", "hostinfo_threads", 0, 32);
     int num_decode_winevt_threads = getDefine_Int("analysisd", "winevt_threads", 0, 32);
     int num_dispatch_dbsync_threads = getDefine_Int("analysisd", "dbsync_threads", 0, 32);
+    Config.dbsync_interval_hint = getDefine_Int("analysisd", "dbsync_interval_hint", 0, 86400);
+    int num_syscheck_db_threads = getDefine_Int("analysisd", "syscheck_db_threads", 0, 32);
 
     if(num_decode_event_threads == 0){
         num_decode_event_threads = cpu_cores;
@@ -1023,69 +1072,82 @@ void OS_ReadMSG_analysisd(int m_queue)
     w_set_available_credits_prev(Config.eps.maximum * Config.eps.timeframe);
 
     /* Create message handler thread */
-    w_create_thread(ad_input_main, &m_queue);
+    w_create_thread_affinity(ad_input_main, &m_queue, input_cpus);
 
     /* Create archives writer thread */
-    w_create_thread(w_writer_thread, NULL);
+    w_create_thread_affinity(w_writer_thread, NULL, writer_cpus);
 
     /* Create alerts log writer thread */
-    w_create_thread(w_writer_log_thread, NULL);
+    w_create_thread_affinity(w_writer_log_thread, NULL, writer_cpus);
 
     /* Create statistical log writer thread */
-    w_create_thread(w_writer_log_statistical_thread, NULL);
+    w_create_thread_affinity(w_writer_log_statistical_thread, NULL, writer_cpus);
 
     /* Create firewall log writer thread */
-    w_create_thread(w_writer_log_firewall_thread, NULL);
+    w_create_thread_affinity(w_writer_log_firewall_thread, NULL, writer_cpus);
 
     /* Create FTS log writer thread */
-    w_create_thread(w_writer_log_fts_thread, NULL);
+    w_create_thread_affinity(w_writer_log_fts_thread, NULL, writer_cpus);
 
     /* Create log rotation thread */
     w_create_thread(w_log_rotate_thread, NULL);
 
+    /* Create CDB lists compilation thread */
+    int cdb_reload_interval = getDefine_Int("analysisd", "cdb_reload_interval", 0, 86400);
+    if (cdb_reload_interval > 0 && os_analysisd_cdblists) {
+        w_create_thread(w_cdb_lists_thread, (void *)(intptr_t)cdb_reload_interval);
+    }
+
+    /* Create ruleset reload thread */
+    int ruleset_reload_interval = getDefine_Int("analysisd", "ruleset_reload_interval", 0, 86400);
+    w_create_thread(w_ruleset_thread, (void *)(intptr_t)ruleset_reload_interval);
+
+    /* Create syscheck database writer threads */
+    fim_db_writer_init(num_syscheck_db_threads, getDefine_Int("analysisd", "syscheck_db_queue_size", 128, 2000000));
+
     /* Create decode syscheck threads */
     for(i = 0; i < num_decode_syscheck_threads;i++){
-        w_create_thread(w_decode_syscheck_thread, NULL);
+        w_create_thread_affinity(w_decode_syscheck_thread, NULL, decoder_cpus);
     }
 
     /* Create decode syscollector threads */
     for(i = 0; i < num_decode_syscollector_threads;i++){
-        w_create_thread(w_decode_syscollector_thread, NULL);
+        w_create_thread_affinity(w_decode_syscollector_thread, NULL, decoder_cpus);
     }
 
     /* Create decode hostinfo threads */
     for(i = 0; i < num_decode_hostinfo_threads;i++){
-        w_create_thread(w_decode_hostinfo_thread, NULL);
+        w_create_thread_affinity(w_decode_hostinfo_thread, NULL, decoder_cpus);
     }
 
     /* Create decode rootcheck threads */
     for(i = 0; i < num_decode_rootcheck_threads;i++){
-        w_create_thread(w_decode_rootcheck_thread, NULL);
+        w_create_thread_affinity(w_decode_rootcheck_thread, NULL, decoder_cpus);
     }
 
     /* Create decode Security Configuration Assessment threads */
     for(i = 0; i < num_decode_sca_threads;i++){
-        w_create_thread(w_decode_sca_thread, NULL);
+        w_create_thread_affinity(w_decode_sca_thread, NULL, decoder_cpus);
     }
 
     /* Create decode event threads */
     for(i = 0; i < num_decode_event_threads;i++){
-        w_create_thread(w_decode_event_thread, NULL);
+        w_create_thread_affinity(w_decode_event_thread, NULL, decoder_cpus);
     }
 
     /* Create the process event threads */
     for(i = 0; i < num_rule_matching_threads;i++){
-        w_create_thread(w_process_event_thread,(void *) (intptr_t)i);
+        w_create_thread_affinity(w_process_event_thread, (void *)(intptr_t)i, rule_matching_cpus);
     }
 
     /* Create decode winevt threads */
     for(i = 0; i < num_decode_winevt_threads;i++){
-        w_create_thread(w_decode_winevt_thread, NULL);
+        w_create_thread_affinity(w_decode_winevt_thread, NULL, decoder_cpus);
     }
 
     /* Create database synchronization dispatcher threads */
     for (i = 0; i < num_dispatch_dbsync_threads; i++){
-        w_create_thread(w_dispatch_dbsync_thread, NULL);
+        w_create_thread_affinity(w_dispatch_dbsync_thread, NULL, decoder_cpus);
     }
 
     /* Create upgrade module dispatcher thread */
@@ -1135,6 +1197,7 @@ static void LoopRule(RuleNode *curr_node, FILE *flog)
 /* Dump the hourly stats about each rule */
 static void DumpLogstats()
 {
+    w_ruleset_t *ruleset;
     RuleNode *rulenode_pt;
     char logfile[OS_FLSIZE + 1];
     FILE *flog;
@@ -1169,7 +1232,8 @@ static void DumpLogstats()
         return;
     }
 
-    rulenode_pt = OS_GetFirstRule();
+    ruleset = w_ruleset_acquire();
+    rulenode_pt = ruleset->rule_list;
 
     if (!rulenode_pt) {
         merror_exit("Rules in an inconsistent state. Exiting.");
@@ -1180,6 +1244,8 @@ static void DumpLogstats()
         LoopRule(rulenode_pt, flog);
     } while ((rulenode_pt = rulenode_pt->next) != NULL);
 
+    w_ruleset_release(ruleset);
+
     /* Print total for the hour */
     fprintf(flog, "%d--%d--%d--%d--%d\n\n",
             thishour,
@@ -1454,13 +1520,18 @@ void * ad_input_main(void * args) {
 }
 
 void * w_writer_thread(__attribute__((unused)) void * args ){
-    Eventinfo *lf = NULL;
+    Eventinfo *batch[WRITER_BATCH];
+    size_t batch_size;
+    size_t i;
 
     while(1){
-        /* Receive message from queue */
-        if (lf = queue_pop_ex(writer_queue), lf) {
+        /* Receive the pending messages from queue */
+        batch_size = queue_pop_ex_batch(writer_queue, (void **)batch, WRITER_BATCH);
+
+        w_mutex_lock(&writer_threads_mutex);
+        for (i = 0; i < batch_size; i++) {
+            Eventinfo *lf = batch[i];
 
-            w_mutex_lock(&writer_threads_mutex);
             w_inc_archives_written(lf->agent_id);
 
             /* If configured to log all, do it */
@@ -1470,21 +1541,28 @@ void * w_writer_thread(__attribute__((unused)) void * args ){
             if (Config.logall_json) {
                 jsonout_output_archive(lf);
             }
+        }
+        w_mutex_unlock(&writer_threads_mutex);
 
-            Free_Eventinfo(lf);
-            w_mutex_unlock(&writer_threads_mutex);
+        for (i = 0; i < batch_size; i++) {
+            Free_Eventinfo(batch[i]);
         }
     }
 }
 
 void * w_writer_log_thread(__attribute__((unused)) void * args ){
-    Eventinfo *lf = NULL;
+    Eventinfo *batch[WRITER_BATCH];
+    size_t batch_size;
+    size_t i;
 
     while(1){
-        /* Receive message from queue */
-        if (lf = queue_pop_ex(writer_queue_log), lf) {
+        /* Receive the pending messages from queue */
+        batch_size = queue_pop_ex_batch(writer_queue_log, (void **)batch, WRITER_BATCH);
+
+        w_mutex_lock(&writer_threads_mutex);
+        for (i = 0; i < batch_size; i++) {
+            Eventinfo *lf = batch[i];
 
-            w_mutex_lock(&writer_threads_mutex);
             w_inc_alerts_written(lf->agent_id);
 
             if (Config.custom_alert_output) {
@@ -1523,8 +1601,11 @@ void * w_writer_log_thread(__attribute__((unused)) void * args ){
                 zeromq_output_event(lf);
             }
 #endif
-            w_mutex_unlock(&writer_threads_mutex);
-            Free_Eventinfo(lf);
+        }
+        w_mutex_unlock(&writer_threads_mutex);
+
+        for (i = 0; i < batch_size; i++) {
+            Free_Eventinfo(batch[i]);
         }
     }
 }
@@ -1546,11 +1627,7 @@ void * w_decode_syscheck_thread(__attribute__((unused)) void * args){
             get_eps_credit(analysisd_limits);
 
             int res = 0;
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-
-            /* Default values for the log info */
-            Zero_Eventinfo(lf);
+            lf = w_alloc_event_info();
 
             if (OS_CleanMSG(msg, lf) < 0) {
                 merror(IMSG_ERROR, msg);
@@ -1575,7 +1652,7 @@ void * w_decode_syscheck_thread(__attribute__((unused)) void * args){
                 res = DecodeSyscheck(lf, &sdb);
             }
 
-            if (res == 1 && queue_push_ex_block(decode_queue_event_output, lf) == 0) {
+            if (res == 1 && w_push_decoded_event(lf) == 0) {
                 continue;
             } else {
                 /* We don't process syscheck events further */
@@ -1585,44 +1662,58 @@ void * w_decode_syscheck_thread(__attribute__((unused)) void * args){
     }
 }
 
+static void w_decode_syscollector_message(char *msg, int *socket) {
+    Eventinfo *lf;
+
+    get_eps_credit(analysisd_limits);
+
+    lf = w_alloc_event_info();
+
+    if (OS_CleanMSG(msg, lf) < 0) {
+        merror(IMSG_ERROR, msg);
+        Free_Eventinfo(lf);
+        free(msg);
+        return;
+    }
+
+    free(msg);
+
+    /* Msg cleaned */
+    DEBUG_MSG("%s: DEBUG: Msg cleanup: %s ", ARGV0, lf->log);
+
+    w_inc_modules_syscollector_decoded_events(lf->agent_id);
+
+    if (!DecodeSyscollector(lf, socket)) {
+        /* We don't process syscollector events further */
+        w_free_event_info(lf);
+    }
+    else {
+        if (w_push_decoded_event(lf) < 0) {
+            w_free_event_info(lf);
+        }
+    }
+}
+
 void * w_decode_syscollector_thread(__attribute__((unused)) void * args){
-    Eventinfo *lf = NULL;
     char *msg = NULL;
+    char **batch;
     int socket = -1;
+    int i;
 
     while(1) {
         /* Receive message from queue */
         if (msg = queue_pop_ex(decode_queue_syscollector_input), msg) {
-            get_eps_credit(analysisd_limits);
-
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-
-            /* Default values for the log info */
-            Zero_Eventinfo(lf);
-
-            if (OS_CleanMSG(msg, lf) < 0) {
-                merror(IMSG_ERROR, msg);
-                Free_Eventinfo(lf);
+            /* Each delta of a batch is an event on its own */
+            if (batch = SyscollectorSplitBatch(msg), batch) {
                 free(msg);
-                continue;
-            }
-
-            free(msg);
-
-            /* Msg cleaned */
-            DEBUG_MSG("%s: DEBUG: Msg cleanup: %s ", ARGV0, lf->log);
 
-            w_inc_modules_syscollector_decoded_events(lf->agent_id);
-
-            if (!DecodeSyscollector(lf, &socket)) {
-                /* We don't process syscollector events further */
-                w_free_event_info(lf);
-            }
-            else {
-                if (queue_push_ex_block(decode_queue_event_output, lf) < 0) {
-                    w_free_event_info(lf);
+                for (i = 0; batch[i]; i++) {
+                    w_decode_syscollector_message(batch[i], &socket);
                 }
+
+                free(batch);
+            } else {
+                w_decode_syscollector_message(msg, &socket);
             }
         }
     }
@@ -1637,11 +1728,7 @@ void * w_decode_rootcheck_thread(__attribute__((unused)) void * args){
         if (msg = queue_pop_ex(decode_queue_rootcheck_input), msg) {
             get_eps_credit(analysisd_limits);
 
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-
-            /* Default values for the log info */
-            Zero_Eventinfo(lf);
+            lf = w_alloc_event_info();
 
             if (OS_CleanMSG(msg, lf) < 0) {
                 merror(IMSG_ERROR, msg);
@@ -1662,7 +1749,7 @@ void * w_decode_rootcheck_thread(__attribute__((unused)) void * args){
                 w_free_event_info(lf);
             }
             else {
-                if (queue_push_ex_block(decode_queue_event_output, lf) < 0) {
+                if (w_push_decoded_event(lf) < 0) {
                     w_free_event_info(lf);
                 }
             }
@@ -1680,11 +1767,7 @@ void * w_decode_sca_thread(__attribute__((unused)) void * args){
         if (msg = queue_pop_ex(decode_queue_sca_input), msg) {
             get_eps_credit(analysisd_limits);
 
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-
-            /* Default values for the log info */
-            Zero_Eventinfo(lf);
+            lf = w_alloc_event_info();
 
             if (OS_CleanMSG(msg, lf) < 0) {
                 merror(IMSG_ERROR, msg);
@@ -1705,7 +1788,7 @@ void * w_decode_sca_thread(__attribute__((unused)) void * args){
                 w_free_event_info(lf);
             }
             else {
-                if (queue_push_ex_block(decode_queue_event_output, lf) < 0) {
+                if (w_push_decoded_event(lf) < 0) {
                     w_free_event_info(lf);
                 }
             }
@@ -1722,11 +1805,7 @@ void * w_decode_hostinfo_thread(__attribute__((unused)) void * args){
         if (msg = queue_pop_ex(decode_queue_hostinfo_input), msg) {
             get_eps_credit(analysisd_limits);
 
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-
-            /* Default values for the log info */
-            Zero_Eventinfo(lf);
+            lf = w_alloc_event_info();
 
             if (OS_CleanMSG(msg, lf) < 0) {
                 merror(IMSG_ERROR, msg);
@@ -1747,7 +1826,7 @@ void * w_decode_hostinfo_thread(__attribute__((unused)) void * args){
                 w_free_event_info(lf);
             }
             else {
-                if (queue_push_ex_block(decode_queue_event_output, lf) < 0) {
+                if (w_push_decoded_event(lf) < 0) {
                     w_free_event_info(lf);
                 }
             }
@@ -1768,11 +1847,7 @@ void * w_decode_event_thread(__attribute__((unused)) void * args){
         if (msg = queue_pop_ex(decode_queue_event_input), msg) {
             get_eps_credit(analysisd_limits);
 
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-
-            /* Default values for the log info */
-            Zero_Eventinfo(lf);
+            lf = w_alloc_event_info();
 
             if (OS_CleanMSG(msg, lf) < 0) {
                 merror(IMSG_ERROR, msg);
@@ -1794,8 +1869,9 @@ void * w_decode_event_thread(__attribute__((unused)) void * args){
                 } else if (msg[0] == LOCALFILE_MQ) {
                     w_inc_decoded_by_component_events(extract_module_from_location(lf->location), lf->agent_id);
                 }
-                node = OS_GetFirstOSDecoder(lf->program_name);
-                DecodeEvent(lf, Config.g_rules_hash, &decoder_match, node);
+                node = lf->program_name ? lf->ruleset->decoderlist_pn : lf->ruleset->decoderlist_nopn;
+                w_profiler_sample_event();
+                DecodeEvent(lf, lf->ruleset->rules_hash, &decoder_match, node);
             }
 
             free(msg);
@@ -1803,7 +1879,7 @@ void * w_decode_event_thread(__attribute__((unused)) void * args){
             /* Msg cleaned */
             DEBUG_MSG("%s: DEBUG: Msg cleanup: %s ", ARGV0, lf->log);
 
-            if (queue_push_ex_block(decode_queue_event_output, lf) < 0) {
+            if (w_push_decoded_event(lf) < 0) {
                 Free_Eventinfo(lf);
             }
         }
@@ -1819,11 +1895,7 @@ void * w_decode_winevt_thread(__attribute__((unused)) void * args) {
         if (msg = queue_pop_ex(decode_queue_winevt_input), msg) {
             get_eps_credit(analysisd_limits);
 
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-
-            /* Default values for the log info */
-            Zero_Eventinfo(lf);
+            lf = w_alloc_event_info();
 
             if (OS_CleanMSG(msg, lf) < 0) {
                 merror(IMSG_ERROR, msg);
@@ -1844,7 +1916,7 @@ void * w_decode_winevt_thread(__attribute__((unused)) void * args) {
                 w_free_event_info(lf);
             }
             else {
-                if (queue_push_ex_block(decode_queue_event_output, lf) < 0) {
+                if (w_push_decoded_event(lf) < 0) {
                     w_free_event_info(lf);
                 }
             }
@@ -1861,9 +1933,7 @@ void * w_dispatch_dbsync_thread(__attribute__((unused)) void * args) {
         if (msg = queue_pop_ex(dispatch_dbsync_input), msg) {
             get_eps_credit(analysisd_limits);
 
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-            Zero_Eventinfo(lf);
+            lf = w_alloc_event_info();
 
             if (OS_CleanMSG(msg, lf) < 0) {
                 merror(IMSG_ERROR, msg);
@@ -1892,9 +1962,7 @@ void * w_dispatch_upgrade_module_thread(__attribute__((unused)) void * args) {
         if (msg = queue_pop_ex(upgrade_module_input), msg) {
             get_eps_credit(analysisd_limits);
 
-            os_calloc(1, sizeof(Eventinfo), lf);
-            os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
-            Zero_Eventinfo(lf);
+            lf = w_alloc_event_info();
 
             if (OS_CleanMSG(msg, lf) < 0) {
                 merror(IMSG_ERROR, msg);
@@ -1954,6 +2022,9 @@ void * w_process_event_thread(__attribute__((unused)) void * id){
     Eventinfo *lf_cpy = NULL;
     Eventinfo *lf_logall = NULL;
     int sock = -1;
+    void *batch[DECODE_OUTPUT_BATCH];
+    size_t batch_size = 0;
+    size_t batch_pos = 0;
 
     /* Stats */
     RuleInfo *stats_rule = NULL;
@@ -1974,10 +2045,16 @@ void * w_process_event_thread(__attribute__((unused)) void * id){
 
     while(1) {
         RuleNode *rulenode_pt;
+        RuleNode **candidates = NULL;
         lf_logall = NULL;
 
-        /* Extract decoded event from the queue */
-        if (lf = queue_pop_ex(decode_queue_event_output), !lf) {
+        /* Extract decoded events from the queue of this thread */
+        if (batch_pos == batch_size) {
+            batch_size = queue_pop_ex_batch(decode_queue_event_output[t_id], batch, DECODE_OUTPUT_BATCH);
+            batch_pos = 0;
+        }
+
+        if (lf = batch[batch_pos++], !lf) {
             continue;
         }
 
@@ -1988,9 +2065,7 @@ void * w_process_event_thread(__attribute__((unused)) void * id){
 
         /* Run accumulator */
         if ( lf->decoder_info->accumulate == 1 ) {
-            w_mutex_lock(&accumulate_mutex);
             lf = Accumulate(lf, &os_analysisd_acm_store, &os_analysisd_acm_lookups, &os_analysisd_acm_purge_ts);
-            w_mutex_unlock(&accumulate_mutex);
         }
 
         /* Firewall event */
@@ -2057,12 +2132,15 @@ void * w_process_event_thread(__attribute__((unused)) void * id){
 
         w_inc_processed_events(lf->agent_id);
 
-        /* Loop over all the rules */
-        rulenode_pt = OS_GetFirstRule();
+        /* Loop over all the rules of the ruleset the event was decoded with */
+        rulenode_pt = lf->ruleset->rule_list;
         if (!rulenode_pt) {
             merror_exit("Rules in an inconsistent state. Exiting.");
         }
-        do {
+
+        w_profiler_sample_event();
+        for (rulenode_pt = OS_FirstRuleCandidate(rulenode_pt, lf, false, &candidates); rulenode_pt;
+             rulenode_pt = OS_NextRuleCandidate(rulenode_pt, &candidates)) {
             if (lf->decoder_info->type == OSSEC_ALERT) {
                 if (!lf->generated_rule) {
                     goto next_it;
@@ -2078,7 +2156,7 @@ void * w_process_event_thread(__attribute__((unused)) void * id){
             }
 
             /* Check each rule */
-            else if (t_currently_rule = OS_CheckIfRuleMatch(lf, os_analysisd_last_events, &os_analysisd_cdblists,
+            else if (t_currently_rule = OS_CheckIfRuleMatch(lf, os_analysisd_last_events, &lf->ruleset->cdblists,
                      rulenode_pt, &rule_match, &os_analysisd_fts_list, &os_analysisd_fts_store, true, NULL), !t_currently_rule) {
 
                 continue;
@@ -2171,6 +2249,7 @@ void * w_process_event_thread(__attribute__((unused)) void * id){
                     merror("Unable to add data to sig list.");
                 } else {
                     lf->sid_node_to_delete = node;
+                    w_sid_index_add(t_currently_rule, lf);
                 }
                 w_mutex_unlock(&t_currently_rule->mutex);
             }
@@ -2199,7 +2278,7 @@ void * w_process_event_thread(__attribute__((unused)) void * id){
             OS_AddEvent(lf, os_analysisd_last_events);
             break;
 
-        } while ((rulenode_pt = rulenode_pt->next) != NULL);
+        }
 
         if (Config.logall || Config.logall_json){
             if (!lf_logall) {
@@ -2231,7 +2310,7 @@ void * w_log_rotate_thread(__attribute__((unused)) void * args){
     char mon[4] = {0};
 
     while(1){
-        w_guard_mutex_variable(current_time_mutex, (current_time = time(NULL)));
+        w_update_current_time();
         localtime_r(&c_time, &tm_result);
         day = tm_result.tm_mday;
         year = tm_result.tm_year + 1900;
@@ -2279,14 +2358,34 @@ void * w_log_rotate_thread(__attribute__((unused)) void * args){
     }
 }
 
+static void * w_cdb_lists_thread(void * interval) {
+
+    mdebug1("CDB lists are checked for changes every %d seconds.", (int)(intptr_t)interval);
+
+    while (1) {
+        sleep((unsigned int)(intptr_t)interval);
+
+        w_ruleset_t * ruleset = w_ruleset_acquire();
+        Lists_OP_ReloadAll(&ruleset->cdblists);
+        w_ruleset_release(ruleset);
+    }
+
+    return NULL;
+}
+
 void * w_writer_log_statistical_thread(__attribute__((unused)) void * args ){
-    Eventinfo *lf = NULL;
+    Eventinfo *batch[WRITER_BATCH];
+    size_t batch_size;
+    size_t i;
 
     while(1){
-        /* Receive message from queue */
-        if (lf = queue_pop_ex(writer_queue_log_statistical), lf) {
+        /* Receive the pending messages from queue */
+        batch_size = queue_pop_ex_batch(writer_queue_log_statistical, (void **)batch, WRITER_BATCH);
+
+        w_mutex_lock(&writer_threads_mutex);
+        for (i = 0; i < batch_size; i++) {
+            Eventinfo *lf = batch[i];
 
-            w_mutex_lock(&writer_threads_mutex);
             w_inc_stats_written();
 
             if (Config.custom_alert_output) {
@@ -2303,27 +2402,33 @@ void * w_writer_log_statistical_thread(__attribute__((unused)) void * args ){
             if (Config.jsonout_output) {
                 jsonout_output_event(lf);
             }
+        }
+        w_mutex_unlock(&writer_threads_mutex);
 
-            w_mutex_unlock(&writer_threads_mutex);
-
-            Free_Eventinfo(lf);
+        for (i = 0; i < batch_size; i++) {
+            Free_Eventinfo(batch[i]);
         }
     }
 }
 
 void * w_writer_log_firewall_thread(__attribute__((unused)) void * args ){
-    Eventinfo *lf = NULL;
+    Eventinfo *batch[WRITER_BATCH];
+    size_t batch_size;
+    size_t i;
 
     while(1){
-        /* Receive message from queue */
-        if (lf = queue_pop_ex(writer_queue_log_firewall), lf) {
+        /* Receive the pending messages from queue */
+        batch_size = queue_pop_ex_batch(writer_queue_log_firewall, (void **)batch, WRITER_BATCH);
 
-            w_mutex_lock(&writer_threads_mutex);
-            w_inc_firewall_written(lf->agent_id);
-            FW_Log(lf);
-            w_mutex_unlock(&writer_threads_mutex);
+        w_mutex_lock(&writer_threads_mutex);
+        for (i = 0; i < batch_size; i++) {
+            w_inc_firewall_written(batch[i]->agent_id);
+            FW_Log(batch[i]);
+        }
+        w_mutex_unlock(&writer_threads_mutex);
 
-            Free_Eventinfo(lf);
+        for (i = 0; i < batch_size; i++) {
+            Free_Eventinfo(batch[i]);
         }
     }
 }
@@ -2352,28 +2457,47 @@ void w_log_flush(){
         OS_Log_Flush();
     }
 
+    /* Flush firewall.log */
+    FW_Log_Flush();
+
     FTS_Flush();
 
+    /* Write the files to the disk */
+    if (Config.output_sync_interval > 0) {
+        static time_t last_sync = 0;
+
+        if (c_time - last_sync >= Config.output_sync_interval) {
+            OS_SyncLogs();
+            last_sync = c_time;
+        }
+    }
 }
 
 void * w_writer_log_fts_thread(__attribute__((unused)) void * args ){
-    char * line;
+    char * lines[FTS_WRITER_BATCH];
+    size_t batch_size;
+    size_t i;
 
     while(1){
-        /* Receive message from queue */
-        if (line = queue_pop_ex(writer_queue_log_fts), line) {
+        /* Receive the pending messages from queue */
+        batch_size = queue_pop_ex_batch(writer_queue_log_fts, (void **)lines, FTS_WRITER_BATCH);
 
-            w_mutex_lock(&writer_threads_mutex);
+        w_mutex_lock(&writer_threads_mutex);
+        for (i = 0; i < batch_size; i++) {
             w_inc_fts_written();
-            FTS_Fprintf(line);
-            w_mutex_unlock(&writer_threads_mutex);
+            FTS_Fprintf(lines[i]);
+        }
+        w_mutex_unlock(&writer_threads_mutex);
 
-            free(line);
+        for (i = 0; i < batch_size; i++) {
+            free(lines[i]);
         }
     }
 }
 
 void w_init_queues(){
+    int output_queue_size;
+
      /* Init the archives writer queue */
     writer_queue = queue_init(getDefine_Int("analysisd", "archives_queue_size", 128, 2000000));
 
@@ -2410,8 +2534,13 @@ void w_init_queues(){
     /* Init the decode event queue input */
     decode_queue_event_input = queue_init(getDefine_Int("analysisd", "decode_event_queue_size", 128, 2000000));
 
-    /* Init the decode event queue output */
-    decode_queue_event_output = queue_init(getDefine_Int("analysisd", "decode_output_queue_size", 128, 2000000));
+    /* Init the decode event queue output, split among the rule matching threads */
+    output_queue_size = getDefine_Int("analysisd", "decode_output_queue_size", 128, 2000000) / num_rule_matching_threads;
+    os_calloc(num_rule_matching_threads, sizeof(w_queue_t *), decode_queue_event_output);
+
+    for (int i = 0; i < num_rule_matching_threads; i++) {
+        decode_queue_event_output[i] = queue_init(output_queue_size < 128 ? 128 : output_queue_size);
+    }
 
     /* Initialize database synchronization message queue */
     dispatch_dbsync_input = queue_init(getDefine_Int("analysisd", "dbsync_queue_size", 128, 2000000));
@@ -2420,6 +2549,14 @@ void w_init_queues(){
     upgrade_module_input = queue_init(getDefine_Int("analysisd", "upgrade_queue_size", 128, 2000000));
 }
 
+int w_push_decoded_event(Eventinfo * lf) {
+    return queue_push_ex_block(decode_queue_event_output[w_event_shard(lf->agent_id, lf->location, num_rule_matching_threads)], lf);
+}
+
+void w_update_current_time(void) {
+    w_guard_mutex_variable(current_time_mutex, (current_time = time(NULL)));
+}
+
 time_t w_get_current_time(void) {
     time_t _current_time;
     w_guard_mutex_variable(current_time_mutex, (_current_time = current_time));
@@ -61,6 +61,12 @@ extern w_queue_t * writer_queue_log_statistical;
 /* Firewall log writer queue */
 extern w_queue_t * writer_queue_log_firewall;
 
+/* Maximum number of FTS lines retrieved at once by the FTS writer thread */
+#define FTS_WRITER_BATCH 64
+
+/* Maximum number of events retrieved at once by the alerts and archives writer threads */
+#define WRITER_BATCH 64
+
 /* Decode syscheck input queue */
 extern w_queue_t * decode_queue_syscheck_input;
 
@@ -79,8 +85,11 @@ extern w_queue_t * decode_queue_hostinfo_input;
 /* Decode event input queue */
 extern w_queue_t * decode_queue_event_input;
 
-/* Decode pending event output */
-extern w_queue_t * decode_queue_event_output;
+/* Decode pending event output, one queue per rule matching thread */
+extern w_queue_t ** decode_queue_event_output;
+
+/* Maximum number of decoded events retrieved at once by a rule matching thread */
+#define DECODE_OUTPUT_BATCH 16
 
 /* Decode windows event input queue */
 extern w_queue_t * decode_queue_winevt_input;
@@ -98,8 +107,16 @@ extern w_queue_t * upgrade_module_input;
  */
 void w_init_queues();
 
+/**
+ * @brief Push a decoded event to the rule matching queue of its agent or location, waiting if it is full
+ * @param lf decoded event
+ * @return 0 on success, -1 on error
+ */
+int w_push_decoded_event(Eventinfo * lf);
+
 #define WAZUH_SERVER    "wazuh-server"
 #define MAX_DECODER_ORDER_SIZE  1024
+#define PCRE2_CACHE_FILE "queue/fts/pcre2-cache"
 
 extern OSHash *fim_agentinfo;
 extern int num_rule_matching_threads;
@@ -118,6 +135,11 @@ extern int num_rule_matching_threads;
     w_mutex_unlock(&mutex)
 
 
+/**
+ * @brief Set the time returned by w_get_current_time to the current time
+ */
+void w_update_current_time(void);
+
 time_t w_get_current_time(void);
 
 #endif /* LOGAUDIT_H */
@@ -20,6 +20,8 @@
 #include "analysisd.h"
 #include "state.h"
 #include "config.h"
+#include "profiler.h"
+#include "ruleset.h"
 
 typedef enum _error_codes {
     ERROR_OK = 0,
@@ -33,7 +35,8 @@ typedef enum _error_codes {
     ERROR_INVALID_AGENTS,
     ERROR_EMPTY_AGENTS,
     ERROR_EMPTY_LASTID,
-    ERROR_TOO_MANY_AGENTS
+    ERROR_TOO_MANY_AGENTS,
+    ERROR_INVALID_SAMPLING
 } error_codes;
 
 const char * error_messages[] = {
@@ -48,7 +51,8 @@ const char * error_messages[] = {
     [ERROR_INVALID_AGENTS] = "Invalid agents parameter",
     [ERROR_EMPTY_AGENTS] = "Error getting agents from DB",
     [ERROR_EMPTY_LASTID] = "Empty last id",
-    [ERROR_TOO_MANY_AGENTS] = "Too many agents"
+    [ERROR_TOO_MANY_AGENTS] = "Too many agents",
+    [ERROR_INVALID_SAMPLING] = "Invalid sampling rate"
 };
 
 /**
@@ -110,6 +114,8 @@ STATIC size_t asyscom_dispatch(char* request, char** output) {
     if (command_json = cJSON_GetObjectItem(request_json, "command"), cJSON_IsString(command_json)) {
         if (strcmp(command_json->valuestring, "getstats") == 0) {
             *output = asyscom_output_builder(ERROR_OK, error_messages[ERROR_OK], asys_create_state_json());
+        } else if (strcmp(command_json->valuestring, HC_GETMETRICS) == 0) {
+            *output = asyscom_output_builder(ERROR_OK, error_messages[ERROR_OK], w_metrics_getmetrics_json(cJSON_GetObjectItem(request_json, "parameters")));
         } else if (strcmp(command_json->valuestring, "getagentsstats") == 0) {
             if (parameters_json = cJSON_GetObjectItem(request_json, "parameters"), cJSON_IsObject(parameters_json)) {
                 agents_json = cJSON_GetObjectItem(parameters_json, "agents");
@@ -149,6 +155,34 @@ STATIC size_t asyscom_dispatch(char* request, char** output) {
             } else {
                 *output = asyscom_output_builder(ERROR_EMPTY_PARAMATERS, error_messages[ERROR_EMPTY_PARAMATERS], NULL);
             }
+        } else if (strcmp(command_json->valuestring, "getprofile") == 0) {
+            cJSON *top_json = cJSON_GetObjectItem(cJSON_GetObjectItem(request_json, "parameters"), "top");
+            unsigned int top = W_PROFILER_TOP_DEFAULT;
+
+            if (cJSON_IsNumber(top_json) && top_json->valueint > 0) {
+                top = top_json->valueint < W_PROFILER_TOP_MAX ? top_json->valueint : W_PROFILER_TOP_MAX;
+            }
+            *output = asyscom_output_builder(ERROR_OK, error_messages[ERROR_OK], w_profiler_json(top));
+        } else if (strcmp(command_json->valuestring, "setprofile") == 0) {
+            if (parameters_json = cJSON_GetObjectItem(request_json, "parameters"), cJSON_IsObject(parameters_json)) {
+                cJSON *sampling_json = cJSON_GetObjectItem(parameters_json, "sampling");
+
+                if (cJSON_IsNumber(sampling_json) && sampling_json->valueint >= 0 && sampling_json->valueint <= 1000000) {
+                    if (cJSON_IsTrue(cJSON_GetObjectItem(parameters_json, "reset"))) {
+                        w_profiler_reset();
+                    }
+                    w_profiler_set_sampling(sampling_json->valueint);
+                    *output = asyscom_output_builder(ERROR_OK, error_messages[ERROR_OK], NULL);
+                } else {
+                    *output = asyscom_output_builder(ERROR_INVALID_SAMPLING, error_messages[ERROR_INVALID_SAMPLING], NULL);
+                }
+            } else {
+                *output = asyscom_output_builder(ERROR_EMPTY_PARAMATERS, error_messages[ERROR_EMPTY_PARAMATERS], NULL);
+            }
+        } else if (strcmp(command_json->valuestring, "reloadruleset") == 0) {
+            /* The ruleset is compiled by its own thread, the events keep on flowing meanwhile */
+            w_ruleset_request_reload();
+            *output = asyscom_output_builder(ERROR_OK, error_messages[ERROR_OK], NULL);
         } else if (strcmp(command_json->valuestring, "getconfig") == 0) {
             if (parameters_json = cJSON_GetObjectItem(request_json, "parameters"), cJSON_IsObject(parameters_json)) {
                 if (section_json = cJSON_GetObjectItem(parameters_json, "section"), cJSON_IsString(section_json)) {
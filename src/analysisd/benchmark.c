@@ -0,0 +1,486 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Throughput benchmark of the decoding and rules matching of analysisd.
+ * A corpus is replayed through the ruleset of ossec.conf, with a logtest
+ * session per thread.
+ */
+
+#ifdef ARGV0
+#undef ARGV0
+#define ARGV0 "wazuh-analysisd-bench"
+#endif
+
+#include "shared.h"
+#include "config.h"
+#include "analysisd.h"
+#include "eventinfo.h"
+#include "logtest.h"
+#include "logmsg.h"
+#include "fts.h"
+
+#define BENCH_LOCATION  "bench"
+#define BENCH_TOP       20
+#define BENCH_NONE      "(none)"
+
+/* CPU time and events of a decoder or a rule */
+typedef struct bench_stat_t {
+    const char *name;
+    unsigned long long events;
+    unsigned long long nsec;
+} bench_stat_t;
+
+typedef struct bench_worker_t {
+    pthread_t thread;
+    int id;
+    w_logtest_session_t *session;
+    OSHash *decoders;               ///< Decoder name -> bench_stat_t
+    OSHash *rules;                  ///< Rule id -> bench_stat_t
+    unsigned long long events;
+    unsigned long long errors;
+    unsigned long long decode_nsec;
+    unsigned long long rules_nsec;
+    unsigned long long allocs;
+    struct timespec end;
+    volatile int done;
+} bench_worker_t;
+
+/* Requests of the corpus, in the format of wazuh-logtest */
+static cJSON **corpus;
+static size_t corpus_size;
+static int loops = 1;
+static int threads = 1;
+
+/* Allocations of the current thread, counted through the --wrap linker option */
+static __thread unsigned long long bench_allocs;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size) {
+    bench_allocs++;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    bench_allocs++;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    bench_allocs++;
+    return __real_realloc(ptr, size);
+}
+
+__attribute__((noreturn))
+static void help_bench(char * home_path)
+{
+    print_header();
+    print_out("  %s: -[hd] [-t threads] [-n loops] [-k top] [-l location] [-c config] [-D dir] <corpus>", ARGV0);
+    print_out("    -h          This help message");
+    print_out("    -d          Execute in debug mode. This parameter");
+    print_out("                can be specified multiple times");
+    print_out("                to increase the debug level.");
+    print_out("    -t <n>      Number of threads, each one with its own ruleset (default: 1)");
+    print_out("    -n <n>      Number of times the corpus is replayed (default: 1)");
+    print_out("    -k <n>      Number of decoders and rules reported (default: %d)", BENCH_TOP);
+    print_out("    -l <loc>    Location of the plain text logs (default: %s)", BENCH_LOCATION);
+    print_out("    -c <config> Configuration file to use (default: %s)", OSSECCONF);
+    print_out("    -D <dir>    Directory to chdir into (default: %s)", home_path);
+    print_out(" ");
+    print_out("  The corpus is a file with one log per line, '-' for stdin. Lines of an");
+    print_out("  archives.json file are replayed with their full_log and location.");
+    print_out(" ");
+    os_free(home_path);
+    exit(1);
+}
+
+static unsigned long long bench_nsec(const struct timespec *start, const struct timespec *end) {
+    return (unsigned long long)(end->tv_sec - start->tv_sec) * 1000000000ULL + end->tv_nsec - start->tv_nsec;
+}
+
+static void bench_print_msgs(OSList *list_msg) {
+    OSListNode *node_log_msg;
+
+    while (node_log_msg = OSList_GetFirstNode(list_msg), node_log_msg) {
+        os_analysisd_log_msg_t *data_msg = node_log_msg->data;
+        char *msg = os_analysisd_string_log_msg(data_msg);
+
+        if (data_msg->level == LOGLEVEL_WARNING) {
+            mwarn("%s", msg);
+        } else if (data_msg->level == LOGLEVEL_ERROR) {
+            merror("%s", msg);
+        }
+
+        os_free(msg);
+        os_analysisd_free_log_msg(data_msg);
+        OSList_DeleteCurrentlyNode(list_msg);
+    }
+}
+
+/* Load the corpus, building a logtest request for each line */
+static void bench_load_corpus(const char *path, const char *location) {
+    char line[OS_MAXSTR + 1];
+    size_t alloc = 0;
+    FILE *fp;
+
+    if (strcmp(path, "-") == 0) {
+        fp = stdin;
+    } else if (fp = wfopen(path, "r"), !fp) {
+        merror_exit(FOPEN_ERROR, path, errno, strerror(errno));
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        const char *event = line;
+        const char *event_location = location;
+        cJSON *archive = NULL;
+        cJSON *request;
+        char *end;
+
+        if (end = strchr(line, '\n'), end) {
+            *end = '\0';
+        }
+
+        if (*line == '\0') {
+            continue;
+        }
+
+        /* Lines of archives.json */
+        if (*line == '{' && (archive = cJSON_Parse(line), archive)) {
+            const char *full_log = cJSON_GetStringValue(cJSON_GetObjectItem(archive, "full_log"));
+            const char *archive_location = cJSON_GetStringValue(cJSON_GetObjectItem(archive, "location"));
+
+            if (full_log) {
+                event = full_log;
+                event_location = archive_location ? archive_location : location;
+            }
+        }
+
+        request = cJSON_CreateObject();
+        cJSON_AddStringToObject(request, W_LOGTEST_JSON_EVENT, event);
+        cJSON_AddStringToObject(request, W_LOGTEST_JSON_LOCATION, event_location);
+        cJSON_Delete(archive);
+
+        if (corpus_size == alloc) {
+            alloc = alloc ? alloc * 2 : 1024;
+            os_realloc(corpus, alloc * sizeof(cJSON *), corpus);
+        }
+        corpus[corpus_size++] = request;
+    }
+
+    if (fp != stdin) {
+        fclose(fp);
+    }
+
+    if (corpus_size == 0) {
+        merror_exit("No logs found in the corpus '%s'.", path);
+    }
+}
+
+static bench_stat_t *bench_stat_get(OSHash *hash, const char *name) {
+    bench_stat_t *stat;
+
+    if (stat = OSHash_Get(hash, name), !stat) {
+        os_calloc(1, sizeof(bench_stat_t), stat);
+        OSHash_Add(hash, name, stat);
+    }
+
+    return stat;
+}
+
+static void bench_stat_add(OSHash *hash, const char *name, unsigned long long nsec) {
+    bench_stat_t *stat = bench_stat_get(hash, name);
+
+    stat->events++;
+    stat->nsec += nsec;
+}
+
+/* Replay the share of the corpus of a thread */
+static void *bench_worker(void *arg) {
+    bench_worker_t *worker = arg;
+    OSList *list_msg = OSList_Create();
+    unsigned long long allocs = bench_allocs;
+    char rule_id[OS_SIZE_32];
+    size_t i;
+    int loop;
+
+    OSList_SetMaxSize(list_msg, ERRORLIST_MAXSIZE);
+    OSList_SetFreeDataPointer(list_msg, (void (*)(void *))os_analysisd_free_log_msg);
+
+    for (loop = 0; loop < loops; loop++) {
+        for (i = worker->id; i < corpus_size; i += threads) {
+            Eventinfo *lf = w_alloc_event_info();
+            struct timespec t0;
+            struct timespec t1;
+            struct timespec t2;
+            int added;
+
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+
+            if (w_logtest_preprocessing_phase(lf, corpus[i]) != 0) {
+                Free_Eventinfo(lf);
+                worker->errors++;
+                continue;
+            }
+
+            w_logtest_decoding_phase(lf, worker->session);
+
+            if (lf->decoder_info->accumulate == 1) {
+                lf = Accumulate(lf, &worker->session->acm_store, &worker->session->acm_lookups,
+                                &worker->session->acm_purge_ts);
+            }
+
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+            added = w_logtest_rulesmatching_phase(lf, worker->session, NULL, list_msg);
+            clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t2);
+
+            bench_stat_add(worker->decoders, lf->decoder_info->name ? lf->decoder_info->name : BENCH_NONE,
+                           bench_nsec(&t0, &t1));
+
+            if (lf->generated_rule) {
+                snprintf(rule_id, sizeof(rule_id), "%d", lf->generated_rule->sigid);
+            } else {
+                snprintf(rule_id, sizeof(rule_id), "%s", BENCH_NONE);
+            }
+            bench_stat_add(worker->rules, rule_id, bench_nsec(&t1, &t2));
+
+            worker->decode_nsec += bench_nsec(&t0, &t1);
+            worker->rules_nsec += bench_nsec(&t1, &t2);
+            worker->events++;
+
+            /* Events added to the stateful memory are freed by the session */
+            if (added != 1) {
+                Free_Eventinfo(lf);
+            }
+
+            OSList_CleanNodes(list_msg);
+        }
+    }
+
+    worker->allocs = bench_allocs - allocs;
+    clock_gettime(CLOCK_MONOTONIC, &worker->end);
+    worker->done = 1;
+
+    OSList_Destroy(list_msg);
+    return NULL;
+}
+
+static int bench_stat_compare(const void *a, const void *b) {
+    const bench_stat_t *stat_a = *(bench_stat_t * const *)a;
+    const bench_stat_t *stat_b = *(bench_stat_t * const *)b;
+
+    return stat_a->nsec < stat_b->nsec ? 1 : stat_a->nsec > stat_b->nsec ? -1 : 0;
+}
+
+/* Merge the stats of every thread and print the most expensive ones */
+static void bench_report(bench_worker_t *workers, size_t offset, const char *title, unsigned long long total_nsec,
+                         int top) {
+    OSHash *total = OSHash_Create();
+    bench_stat_t **stats = NULL;
+    size_t stats_size = 0;
+    OSHashNode *node;
+    unsigned int row;
+    int i;
+
+    for (i = 0; i < threads; i++) {
+        OSHash *hash = *(OSHash **)((char *)&workers[i] + offset);
+
+        for (node = OSHash_Begin(hash, &row); node; node = OSHash_Next(hash, &row, node)) {
+            bench_stat_t *stat = node->data;
+            bench_stat_t *sum = bench_stat_get(total, node->key);
+
+            sum->events += stat->events;
+            sum->nsec += stat->nsec;
+        }
+    }
+
+    for (node = OSHash_Begin(total, &row); node; node = OSHash_Next(total, &row, node)) {
+        bench_stat_t *stat = node->data;
+
+        stat->name = node->key;
+        os_realloc(stats, (stats_size + 1) * sizeof(bench_stat_t *), stats);
+        stats[stats_size++] = stat;
+    }
+
+    qsort(stats, stats_size, sizeof(bench_stat_t *), bench_stat_compare);
+
+    print_out(" ");
+    print_out("%-32s %12s %12s %8s %12s", title, "events", "cpu (ms)", "% cpu", "us/event");
+
+    for (i = 0; i < top && (size_t)i < stats_size; i++) {
+        print_out("%-32.32s %12llu %12.1f %7.1f%% %12.2f", stats[i]->name, stats[i]->events,
+                  stats[i]->nsec / 1e6, total_nsec ? stats[i]->nsec * 100.0 / total_nsec : 0.0,
+                  stats[i]->nsec / 1e3 / stats[i]->events);
+    }
+
+    OSHash_SetFreeDataPointer(total, free);
+    OSHash_Free(total);
+    os_free(stats);
+}
+
+int main(int argc, char **argv)
+{
+    int c = 0;
+    int top = BENCH_TOP;
+    const char *cfg = OSSECCONF;
+    const char *location = BENCH_LOCATION;
+    bench_worker_t *workers;
+    struct timespec start;
+    struct timespec end = { 0 };
+    unsigned long long events = 0;
+    unsigned long long errors = 0;
+    unsigned long long decode_nsec = 0;
+    unsigned long long rules_nsec = 0;
+    unsigned long long allocs = 0;
+    double wall;
+    int i;
+
+    OS_SetName(ARGV0);
+
+    char * home_path = w_homedir(argv[0]);
+
+    while ((c = getopt(argc, argv, "hdt:n:k:l:c:D:")) != -1) {
+        switch (c) {
+            case 'h':
+                help_bench(home_path);
+                break;
+            case 'd':
+                nowDebug();
+                break;
+            case 't':
+                if (threads = atoi(optarg), threads < 1) {
+                    merror_exit("-t needs a positive number");
+                }
+                break;
+            case 'n':
+                if (loops = atoi(optarg), loops < 1) {
+                    merror_exit("-n needs a positive number");
+                }
+                break;
+            case 'k':
+                if (top = atoi(optarg), top < 0) {
+                    merror_exit("-k needs a number");
+                }
+                break;
+            case 'l':
+                location = optarg;
+                break;
+            case 'c':
+                cfg = optarg;
+                break;
+            case 'D':
+                snprintf(home_path, PATH_MAX, "%s", optarg);
+                break;
+            default:
+                help_bench(home_path);
+                break;
+        }
+    }
+
+    if (optind >= argc) {
+        help_bench(home_path);
+    }
+
+    /* The corpus path is relative to the current directory */
+    bench_load_corpus(argv[optind], location);
+
+    if (chdir(home_path) == -1) {
+        merror_exit(CHDIR_ERROR, home_path, errno, strerror(errno));
+    }
+
+    if (GlobalConf(cfg) < 0) {
+        merror_exit(CONFIG_ERROR, cfg);
+    }
+
+    Config.decoder_order_size = (size_t)getDefine_Int("analysisd", "decoder_order_size", MIN_ORDER_SIZE, MAX_DECODER_ORDER_SIZE);
+
+    srandom_init();
+    w_update_current_time();
+
+    if (Config.g_rules_hash = OSHash_Create(), !Config.g_rules_hash) {
+        merror_exit(HASH_ERROR);
+    }
+
+    if (w_logtest_sessions = OSHash_Create(), !w_logtest_sessions) {
+        merror_exit(LOGTEST_ERROR_INIT_HASH);
+    }
+
+    /* Rules with ignore options read the ignore file */
+    if (!FTS_Init(1, &os_analysisd_fts_list, &os_analysisd_fts_store)) {
+        merror_exit(FTS_LIST_ERROR);
+    }
+
+    os_calloc(threads, sizeof(bench_worker_t), workers);
+
+    for (i = 0; i < threads; i++) {
+        OSList *list_msg = OSList_Create();
+
+        OSList_SetMaxSize(list_msg, ERRORLIST_MAXSIZE);
+        workers[i].id = i;
+        workers[i].session = w_logtest_initialize_session(list_msg);
+        bench_print_msgs(list_msg);
+        OSList_Destroy(list_msg);
+
+        if (!workers[i].session) {
+            merror_exit("Unable to load the ruleset.");
+        }
+
+        workers[i].decoders = OSHash_Create();
+        workers[i].rules = OSHash_Create();
+    }
+
+    print_out("Replaying %zu logs %d times on %d threads.", corpus_size, loops, threads);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < threads; i++) {
+        if (CreateThreadJoinable(&workers[i].thread, bench_worker, &workers[i])) {
+            merror_exit(THREAD_ERROR);
+        }
+    }
+
+    /* Frequency rules compare the events with the current time */
+    for (i = 0; i < threads; i++) {
+        while (!workers[i].done) {
+            w_update_current_time();
+            usleep(100000);
+        }
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    for (i = 0; i < threads; i++) {
+        events += workers[i].events;
+        errors += workers[i].errors;
+        decode_nsec += workers[i].decode_nsec;
+        rules_nsec += workers[i].rules_nsec;
+        allocs += workers[i].allocs;
+
+        if (workers[i].end.tv_sec > end.tv_sec
+            || (workers[i].end.tv_sec == end.tv_sec && workers[i].end.tv_nsec > end.tv_nsec)) {
+            end = workers[i].end;
+        }
+    }
+
+    wall = bench_nsec(&start, &end) / 1e9;
+
+    print_out(" ");
+    print_out("Events:          %llu (%llu not valid)", events, errors);
+    print_out("Wall time:       %.3f s", wall);
+    print_out("Throughput:      %.0f EPS", wall > 0 ? events / wall : 0.0);
+    print_out("Decoding CPU:    %.3f s (%.2f us/event)", decode_nsec / 1e9, events ? decode_nsec / 1e3 / events : 0.0);
+    print_out("Rules CPU:       %.3f s (%.2f us/event)", rules_nsec / 1e9, events ? rules_nsec / 1e3 / events : 0.0);
+    print_out("Allocations:     %llu (%.1f per event)", allocs, events ? (double)allocs / events : 0.0);
+
+    bench_report(workers, offsetof(bench_worker_t, decoders), "Decoder (decoding CPU)", decode_nsec, top);
+    bench_report(workers, offsetof(bench_worker_t, rules), "Rule matched (rules CPU)", rules_nsec, top);
+
+    os_free(home_path);
+    return 0;
+}
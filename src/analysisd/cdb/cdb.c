@@ -178,3 +178,74 @@ int cdb_find(struct cdb *c, char *key, unsigned int len)
     cdb_findstart(c);
     return cdb_findnext(c, key, len);
 }
+
+/* Find a key without using the search state of c, so it can be
+ * called from several threads at once. The file is only locked when
+ * it is not mapped, as it has to be read through its descriptor.
+ */
+int cdb_lookup(struct cdb *c, char *key, unsigned int len, uint32 *dpos, uint32 *dlen)
+{
+    char buf[8];
+    uint32 hslots;
+    uint32 hpos;
+    uint32 khash;
+    uint32 kpos;
+    uint32 loop;
+    uint32 pos;
+    uint32 u;
+    int result = 0;
+
+    if (!c->map) {
+        w_mutex_lock(&c->mutex);
+    }
+
+    khash = cdb_hash(key, len);
+    if (cdb_read(c, buf, 8, (khash << 3) & 2047) == -1) {
+        result = -1;
+        goto end;
+    }
+    uint32_unpack(buf + 4, &hslots);
+    if (!hslots) {
+        goto end;
+    }
+    uint32_unpack(buf, &hpos);
+    kpos = hpos + (((khash >> 8) % hslots) << 3);
+
+    for (loop = 0; loop < hslots; loop++) {
+        if (cdb_read(c, buf, 8, kpos) == -1) {
+            result = -1;
+            goto end;
+        }
+        uint32_unpack(buf + 4, &pos);
+        if (!pos) {
+            goto end;
+        }
+        kpos += 8;
+        if (kpos == hpos + (hslots << 3)) {
+            kpos = hpos;
+        }
+        uint32_unpack(buf, &u);
+        if (u == khash) {
+            if (cdb_read(c, buf, 8, pos) == -1) {
+                result = -1;
+                goto end;
+            }
+            uint32_unpack(buf, &u);
+            if (u == len) {
+                if (result = match(c, key, len, pos + 8), result != 0) {
+                    if (result == 1) {
+                        uint32_unpack(buf + 4, dlen);
+                        *dpos = pos + 8 + len;
+                    }
+                    goto end;
+                }
+            }
+        }
+    }
+
+end:
+    if (!c->map) {
+        w_mutex_unlock(&c->mutex);
+    }
+    return result;
+}
@@ -35,6 +35,7 @@ extern int cdb_read(struct cdb *, char *, unsigned int, uint32);
 extern void cdb_findstart(struct cdb *);
 extern int cdb_findnext(struct cdb *, char *, unsigned int);
 extern int cdb_find(struct cdb *, char *, unsigned int);
+extern int cdb_lookup(struct cdb *, char *, unsigned int, uint32 *, uint32 *);
 
 #define cdb_datapos(c) ((c)->dpos)
 #define cdb_datalen(c) ((c)->dlen)
@@ -53,7 +53,7 @@ int OS_CleanMSG(char *msg, Eventinfo *lf)
         return (-1);
     }
 
-    os_strdup(loc_buff, lf->location);
+    lf->location = w_strpool_get(event_strings, loc_buff);
 
     /* Get the log length */
     loglen = strlen(pieces) + 1;
@@ -540,54 +540,43 @@ int OS_CleanMSG(char *msg, Eventinfo *lf)
      */
 
     /* Set hostname for local messages */
-    if (lf->location[0] == '[') {
+    if (loc_buff[0] == '[') {
         /* Messages from an agent */
-        char *orig = lf->location;
+        char *id = loc_buff + 1;
+        char *location = strchr(id, ']');
         bool extra_info = false;
 
-        lf->agent_id = lf->location + 1;
-        lf->location = strchr(lf->agent_id, ']');
-
-        if (!lf->location) {
-            lf->location = orig;
+        if (!location) {
             lf->agent_id = NULL;
             lf->hostname = NULL;
             merror(FORMAT_ERROR);
             return (-1);
         }
 
-        if (strlen(lf->location) > 1) {
+        if (strlen(location) > 1) {
             extra_info = true;
         }
 
-        *lf->location = '\0';
-        os_strdup(lf->agent_id, lf->agent_id);
-
-        if (extra_info) {
-            os_strdup(lf->location + 2, lf->location);
-        } else {
-            os_strdup("", lf->location);
-        }
+        *location = '\0';
+        lf->agent_id = w_strpool_get(event_strings, id);
 
+        w_strpool_release(event_strings, lf->location);
+        lf->location = w_strpool_get(event_strings, extra_info ? location + 2 : "");
 
         if (lf->location[0] == '(') {
-            char * end;
-
-            os_strdup(lf->location + 1, lf->hostname);
+            const char * end = strchr(lf->location + 1, ')');
 
-            if (end = strchr(lf->hostname, ')'), end) {
-                *end = '\0';
+            if (end) {
+                lf->hostname = w_strpool_getn(event_strings, lf->location + 1, end - lf->location - 1);
             } else {
-                lf->hostname[0] = '\0';
+                lf->hostname = w_strpool_get(event_strings, "");
             }
         } else {
-            os_strdup("", lf->hostname);
+            lf->hostname = w_strpool_get(event_strings, "");
         }
-
-        free(orig);
     } else {
-        os_strdup(lf->hostname ? lf->hostname : __shost, lf->hostname);
-        os_strdup("000", lf->agent_id);
+        lf->hostname = w_strpool_get(event_strings, lf->hostname ? lf->hostname : __shost);
+        lf->agent_id = w_strpool_get(event_strings, "000");
     }
 
     /* Set up the event data */
@@ -18,6 +18,7 @@
 #include "rules.h"
 #include "stats.h"
 #include "fts.h"
+#include "ruleset.h"
 
 long int __crt_ftell; /* Global ftell pointer */
 _Config Config;       /* Global Config structure */
@@ -25,8 +26,12 @@ rlim_t nofile;
 int sys_debug_level;
 
 #ifdef LIBGEOIP_ENABLED
+#ifdef LIBMAXMINDDB_ENABLED
+MMDB_s *geoipdb;
+#else
 GeoIP *geoipdb;
 #endif
+#endif
 
 
 int GlobalConf(const char *cfgfile)
@@ -100,6 +105,8 @@ int GlobalConf(const char *cfgfile)
     }
 
     Config.min_rotate_interval = getDefine_Int("analysisd", "min_rotate_interval", 10, 86400);
+    Config.output_buffer_size = (size_t)getDefine_Int("analysisd", "output_buffer_size", 0, 65536) * 1024;
+    Config.output_sync_interval = getDefine_Int("analysisd", "output_sync_interval", 0, 86400);
 
     /* Minimum memory size */
     if (Config.memorysize < 2048) {
@@ -286,12 +293,14 @@ cJSON *getDecodersConfig(void) {
 
     cJSON *root = cJSON_CreateObject();
     cJSON *list = cJSON_CreateArray();
+    w_ruleset_t *ruleset = w_ruleset_acquire();
 
-    if (os_analysisd_decoderlist_pn) {
-        _getDecodersListJSON(os_analysisd_decoderlist_pn, list);
-        _getDecodersListJSON(os_analysisd_decoderlist_nopn, list);
+    if (ruleset && ruleset->decoderlist_pn) {
+        _getDecodersListJSON(ruleset->decoderlist_pn, list);
+        _getDecodersListJSON(ruleset->decoderlist_nopn, list);
     }
 
+    w_ruleset_release(ruleset);
     cJSON_AddItemToObject(root, "decoders", list);
 
     return root;
@@ -302,11 +311,14 @@ cJSON *getRulesConfig(void) {
 
     cJSON *root = cJSON_CreateObject();
     cJSON *list = cJSON_CreateArray();
+    w_ruleset_t *ruleset = w_ruleset_acquire();
 
-    if (os_analysisd_rulelist) {
-        _getRulesListJSON(os_analysisd_rulelist, list);
+    if (ruleset && ruleset->rule_list) {
+        _getRulesListJSON(ruleset->rule_list, list);
     }
 
+    w_ruleset_release(ruleset);
+
     cJSON_AddItemToObject(root, "rules", list);
 
     return root;
@@ -18,15 +18,23 @@
 #include "decoders/plugin_decoders.h"
 
 #ifdef LIBGEOIP_ENABLED
+#ifdef LIBMAXMINDDB_ENABLED
+#include <maxminddb.h>
+#else
 #include "GeoIP.h"
 #endif
+#endif
 
 extern long int __crt_ftell; /* Global ftell pointer */
 extern _Config Config;       /* Global Config structure */
 
 #ifdef LIBGEOIP_ENABLED
+#ifdef LIBMAXMINDDB_ENABLED
+extern MMDB_s *geoipdb;
+#else
 extern GeoIP *geoipdb;
 #endif
+#endif
 
 int GlobalConf(const char *cfgfile);
 
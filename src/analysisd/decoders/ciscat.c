@@ -12,6 +12,7 @@
 
 #include "eventinfo.h"
 #include "decoder.h"
+#include "ruleset.h"
 #include "external/cJSON/cJSON.h"
 #include "plugin_decoders.h"
 #include "wazuh_modules/wmodules.h"
@@ -19,15 +20,14 @@
 #include "wazuhdb_op.h"
 
 static OSDecoderInfo *ciscat_decoder = NULL;
-
-extern OSStore *os_analysisd_decoder_store;
+static int ciscat_slot;
 
 #define VAR_LENGTH  32
 
 void CiscatInit(){
 
     os_calloc(1, sizeof(OSDecoderInfo), ciscat_decoder);
-    ciscat_decoder->id = getDecoderfromlist(CISCAT_MOD, &os_analysisd_decoder_store);
+    ciscat_slot = w_ruleset_bind_decoder(&ciscat_decoder->id, CISCAT_MOD);
     ciscat_decoder->name = CISCAT_MOD;
     ciscat_decoder->type = OSSEC_RL;
     ciscat_decoder->fts = 0;
@@ -45,6 +45,7 @@ int DecodeCiscat(Eventinfo *lf, int *socket)
     JSON_Decoder_Exec(lf, NULL);
 
     lf->decoder_info = ciscat_decoder;
+    lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, ciscat_slot, ciscat_decoder->id);
 
     // Check location
     if (lf->location[0] == '(') {
@@ -14,7 +14,9 @@
  */
 
 #include "../eventinfo.h"
+#include "../config.h"
 #include "wazuhdb_op.h"
+#include "os_zlib/os_zlib.h"
 
 #ifdef WAZUH_UNIT_TESTING
 /* Remove static qualifier when unit testing */
@@ -88,6 +90,12 @@ static void dispatch_answer(dbsync_context_t * ctx, const char * result) {
     cJSON_DeleteItemFromObject(ctx->data, "tail");
     cJSON_DeleteItemFromObject(ctx->data, "checksum");
 
+    // Spread the next checks of the agents along a quarter of the suggested interval
+    if (Config.dbsync_interval_hint > 0) {
+        int spread = atoi(ctx->agent_id) % (Config.dbsync_interval_hint / 4 + 1);
+        cJSON_AddNumberToObject(ctx->data, "interval", Config.dbsync_interval_hint + spread);
+    }
+
     char * data_plain = cJSON_PrintUnformatted(ctx->data);
     char * query;
     os_malloc(OS_MAXSTR, query);
@@ -159,6 +167,32 @@ end: // LCOV_EXCL_LINE
     free(response);
 }
 
+// Send a save query to wazuh-db and check its answer
+static void dispatch_state_query(dbsync_context_t * ctx, const char * query, char * response) {
+    char * arg;
+
+    switch (wdbc_query_ex(&ctx->db_sock, query, response, OS_MAXSTR)) {
+    case -2:
+        merror("dbsync: Cannot communicate with database.");
+        return;
+    case -1:
+        merror("dbsync: Cannot get response from database.");
+        return;
+    }
+
+    switch (wdbc_parse_result(response, &arg)) {
+    case WDBC_OK:
+        break;
+    case WDBC_ERROR:
+        if (strcmp(arg, "Agent not found") != 0) {
+            merror("dbsync: Bad response from database: %s", arg);
+        }
+        // Fallthrough
+    default:
+        break;
+    }
+}
+
 static void dispatch_state(dbsync_context_t * ctx) {
     if (ctx->data == NULL) {
         merror("dbsync: Corrupt message: cannot get data member.");
@@ -168,41 +202,131 @@ static void dispatch_state(dbsync_context_t * ctx) {
     char * data_plain = cJSON_PrintUnformatted(ctx->data);
     char * query;
     char * response;
-    char * arg;
 
     os_malloc(OS_MAXSTR, query);
     os_malloc(OS_MAXSTR, response);
 
     if (snprintf(query, OS_MAXSTR, "agent %s %s save2 %s", ctx->agent_id, ctx->component, data_plain) >= OS_MAXSTR) {
         merror("dbsync: Cannot build save query: input is too long.");
-        goto end;
+    } else {
+        dispatch_state_query(ctx, query, response);
     }
 
-    switch (wdbc_query_ex(&ctx->db_sock, query, response, OS_MAXSTR)) {
-    case -2:
-        merror("dbsync: Cannot communicate with database.");
-        goto end;
-    case -1:
-        merror("dbsync: Cannot get response from database.");
-        goto end;
+    free(data_plain);
+    free(query);
+    free(response);
+}
+
+// Largest uncompressed rows array accepted in a state_batch message
+#define DBSYNC_STATE_BATCH_MAX_SIZE (OS_MAXSTR * 16)
+
+static cJSON * inflate_state_batch(cJSON * root, cJSON * data) {
+    char * encoded = cJSON_GetStringValue(data);
+    cJSON * size = cJSON_GetObjectItem(root, "size");
+
+    if (encoded == NULL || !cJSON_IsNumber(size) || size->valuedouble <= 0 || size->valuedouble > DBSYNC_STATE_BATCH_MAX_SIZE) {
+        merror("dbsync: Corrupt message: invalid compressed state batch.");
+        return NULL;
     }
 
-    switch (wdbc_parse_result(response, &arg)) {
-    case WDBC_OK:
-        break;
-    case WDBC_ERROR:
-        if (strcmp(arg, "Agent not found") != 0) {
-            merror("dbsync: Bad response from database: %s", arg);
+    // The decoded length is not returned by decode_base64, it is derived from the encoded string.
+    size_t encoded_size = strlen(encoded);
+    size_t padding = 0;
+
+    while (padding < encoded_size && padding < 2 && encoded[encoded_size - 1 - padding] == '=') {
+        padding++;
+    }
+
+    const size_t compressed_size = encoded_size / 4 * 3 - padding;
+    const unsigned long raw_size = (unsigned long)size->valuedouble;
+    char * compressed = decode_base64(encoded);
+    char * raw = NULL;
+    cJSON * rows = NULL;
+
+    if (compressed == NULL) {
+        merror("dbsync: Corrupt message: invalid compressed state batch.");
+        return NULL;
+    }
+
+    os_malloc(raw_size + 1, raw);
+
+    if (os_zlib_uncompress(compressed, raw, compressed_size, raw_size) != raw_size) {
+        merror("dbsync: Cannot uncompress state batch.");
+    } else {
+        rows = cJSON_Parse(raw);
+    }
+
+    os_free(compressed);
+    os_free(raw);
+    return rows;
+}
+
+static void dispatch_state_batch(dbsync_context_t * ctx, cJSON * root) {
+    char * compression = cJSON_GetStringValue(cJSON_GetObjectItem(root, "compression"));
+    cJSON * rows = ctx->data;
+    cJSON * inflated = NULL;
+
+    if (compression != NULL) {
+        if (strcmp(compression, "zlib") != 0) {
+            merror("dbsync: Unsupported state batch compression '%s'.", compression);
+            return;
         }
-        // Fallthrough
-    default:
+
+        rows = inflated = inflate_state_batch(root, ctx->data);
+    }
+
+    if (!cJSON_IsArray(rows)) {
+        merror("dbsync: Corrupt message: cannot get data member.");
         goto end;
     }
 
-end:
-    free(data_plain);
+    char * query;
+    char * response;
+    cJSON * row = NULL;
+    int header;
+    int length;
+
+    os_malloc(OS_MAXSTR, query);
+    os_malloc(OS_MAXSTR, response);
+
+    /* The rows are sent in as few save2_batch queries as fit in the socket
+     * buffer, each row framed as "<length>:<row>". */
+    header = snprintf(query, OS_MAXSTR, "agent %s %s save2_batch ", ctx->agent_id, ctx->component);
+    length = header;
+
+    cJSON_ArrayForEach(row, rows) {
+        char * data_plain = cJSON_PrintUnformatted(row);
+        size_t data_size = strlen(data_plain);
+        char frame[32];
+        int frame_size = snprintf(frame, sizeof(frame), "%zu:", data_size);
+
+        if ((size_t)header + frame_size + data_size >= OS_MAXSTR) {
+            merror("dbsync: Cannot build save query: input is too long.");
+            free(data_plain);
+            continue;
+        }
+
+        if ((size_t)length + frame_size + data_size >= OS_MAXSTR) {
+            dispatch_state_query(ctx, query, response);
+            length = header;
+        }
+
+        memcpy(query + length, frame, frame_size);
+        memcpy(query + length + frame_size, data_plain, data_size);
+        length += frame_size + data_size;
+        query[length] = '\0';
+        free(data_plain);
+    }
+
+    if (length > header) {
+        dispatch_state_query(ctx, query, response);
+    }
+
     free(query);
     free(response);
+
+end:
+    cJSON_Delete(inflated);
 }
 
 static void dispatch_clear(dbsync_context_t * ctx) {
@@ -282,6 +406,8 @@ void DispatchDBSync(dbsync_context_t * ctx, Eventinfo * lf) {
         dispatch_check(ctx, mtype);
     } else if (strcmp(mtype, "state") == 0) {
         dispatch_state(ctx);
+    } else if (strcmp(mtype, "state_batch") == 0) {
+        dispatch_state_batch(ctx, root);
     } else if (strcmp(mtype, "integrity_clear") == 0) {
         dispatch_clear(ctx);
     } else {
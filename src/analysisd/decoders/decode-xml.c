@@ -876,6 +876,9 @@ int SetDecodeXML(OSList* log_msg, OSStore **decoder_list, OSDecoderNode **decode
         return (0);
     }
 
+    /* Events with program name will only try the decoders it matches */
+    OS_BuildDecoderIndex(*decoderlist_pn);
+
     return (1);
 }
 
@@ -14,12 +14,25 @@
 #include "eventinfo.h"
 #include "decoder.h"
 #include "config.h"
+#include "profiler.h"
 
 
-/* Use the osdecoders to decode the received event */
+static void OS_DecodeEvent(struct _Eventinfo *lf, OSHash *rules_hash, regex_matching *decoder_match, OSDecoderNode *node);
+
+/* Use the osdecoders to decode the received event, timing them if the event is sampled by the profiler */
 void DecodeEvent(struct _Eventinfo *lf, OSHash *rules_hash, regex_matching *decoder_match, OSDecoderNode *node)
+{
+    OS_DecodeEvent(lf, rules_hash, decoder_match, node);
+
+    if (w_profiler_sampled) {
+        w_profiler_decoder_next(NULL);
+    }
+}
+
+static void OS_DecodeEvent(struct _Eventinfo *lf, OSHash *rules_hash, regex_matching *decoder_match, OSDecoderNode *node)
 {
     OSDecoderNode *child_node;
+    OSDecoderNode **candidates = NULL;
     OSDecoderInfo *nnode;
 
     const char *llog = NULL;
@@ -38,12 +51,22 @@ void DecodeEvent(struct _Eventinfo *lf, OSHash *rules_hash, regex_matching *deco
     }
 #endif
 
-    do {
+    /* Only the decoders whose program_name matches can match the event */
+    if (lf->program_name && (candidates = OS_GetDecoderCandidates(node, lf->program_name, decoder_match))) {
+        node = *candidates;
+    }
+
+    for (; node; node = candidates ? *(++candidates) : node->next) {
         nnode = node->osdecoder;
 
+        /* The children of a decoder are charged to it */
+        if (w_profiler_sampled) {
+            w_profiler_decoder_next(nnode);
+        }
+
         /* First check program name */
         if (lf->program_name) {
-            if (!w_expression_match(nnode->program_name, lf->program_name, NULL, decoder_match)) {
+            if (!candidates && !w_expression_match(nnode->program_name, lf->program_name, NULL, decoder_match)) {
                 continue;
             }
             pmatch = lf->log;
@@ -218,7 +241,7 @@ void DecodeEvent(struct _Eventinfo *lf, OSHash *rules_hash, regex_matching *deco
 
         /* ok to return  */
         return;
-    } while ((node = node->next) != NULL);
+    }
 
 #ifdef TESTRULE
     if (!alert_only) {
@@ -36,6 +36,9 @@
 #define JSON_TREAT_ARRAY_DEFAULT       JSON_TREAT_ARRAY_AS_ARRAY
 #define JSON_TREAT_NULL_DEFAULT        JSON_TREAT_NULL_AS_STRING
 
+/* Maximum number of program names with saved decoder candidates */
+#define DECODER_PNAME_INDEX_MAX        4096
+
 
 
 struct _Eventinfo;
@@ -79,6 +82,7 @@ typedef struct _OSDecoderNode {
     struct _OSDecoderNode *next;
     struct _OSDecoderNode *child;
     OSDecoderInfo *osdecoder;
+    OSHash *program_names;     ///< Candidate nodes (NULL terminated) by program name, only set on the first node of the list
 } OSDecoderNode;
 
 typedef struct dbsync_context_t {
@@ -194,6 +198,13 @@ OSDecoderNode *OS_GetFirstOSDecoder(const char *pname);
  */
 int getDecoderfromlist(const char *name, OSStore **decoder_store);
 
+/**
+ * @brief Open the GeoIP database, a GeoIP legacy one or a MaxMind DB one if built with USE_MAXMINDDB
+ * @param db_file database path, NULL to disable GeoIP
+ * @param cache_size entries of the location cache of each thread, 0 to disable it
+ */
+void OS_GeoIPInit(const char *db_file, unsigned int cache_size);
+
 char *GetGeoInfobyIP(char *ip_addr);
 
 /**
@@ -209,6 +220,13 @@ int SetDecodeXML(OSList* log_msg, OSStore **decoder_list, OSDecoderNode **decode
 
 void HostinfoInit(void);
 int fim_init(void);
+
+/**
+ * @brief Start the threads sending the FIM decoder queries to Wazuh DB
+ * @param writers number of threads, 0 means that the decoder threads send the queries
+ * @param queue_size queries waiting for each thread, the decoders wait when it's full
+ */
+void fim_db_writer_init(unsigned int writers, size_t queue_size);
 void RootcheckInit(void);
 void SyscollectorInit(void);
 void CiscatInit(void);
@@ -249,6 +267,24 @@ void os_remove_decoders_list(OSDecoderNode *decoderlist_pn, OSDecoderNode *decod
  */
 void os_remove_decodernode(OSDecoderNode *node, OSDecoderInfo **decoders, int *pos, int *max_size);
 
+/**
+ * @brief Create the program name index on the first node of a decoder list
+ *
+ * The candidates of each program name are saved the first time it is seen.
+ * @param node the first node of the list of decoders which have program_name
+ */
+void OS_BuildDecoderIndex(OSDecoderNode *node);
+
+/**
+ * @brief Get the decoders of a list whose program_name matches a program name
+ * @param node the first node of the list of decoders which have program_name
+ * @param program_name program name of the event
+ * @param decoder_match struct to save the regex which match
+ * @return NULL terminated array of nodes, in the list order. NULL if the list has no index
+ *         or the index is full, then the whole list has to be tried.
+ */
+OSDecoderNode **OS_GetDecoderCandidates(OSDecoderNode *node, const char *program_name, regex_matching *decoder_match);
+
 /**
  * @brief Count the number of decoders in a list
  * @param node the first node of the list
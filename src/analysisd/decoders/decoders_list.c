@@ -202,12 +202,77 @@ int OS_AddOSDecoder(OSDecoderInfo *pi, OSDecoderNode **pn_osdecodernode,
     return (1);
 }
 
+void OS_BuildDecoderIndex(OSDecoderNode *node) {
+
+    if (!node || node->program_names) {
+        return;
+    }
+
+    if (node->program_names = OSHash_Create(), !node->program_names) {
+        merror(MEM_ERROR, errno, strerror(errno));
+        return;
+    }
+
+    /* Looked up by every decoder thread for each event */
+    OSHash_SetConcurrent(node->program_names, OSHASH_STRIPES);
+
+    OSHash_SetFreeDataPointer(node->program_names, (void (*)(void *))free);
+}
+
+OSDecoderNode **OS_GetDecoderCandidates(OSDecoderNode *node, const char *program_name, regex_matching *decoder_match) {
+
+    OSDecoderNode **candidates;
+    OSDecoderNode *tmp_node;
+    size_t size = 0;
+
+    if (!node || !node->program_names) {
+        return NULL;
+    }
+
+    if (candidates = OSHash_Get_ex(node->program_names, program_name), candidates) {
+        return candidates;
+    }
+
+    /* Don't let unexpected program names grow the index */
+    if (OSHash_Get_Elem_ex(node->program_names) >= DECODER_PNAME_INDEX_MAX) {
+        return NULL;
+    }
+
+    for (tmp_node = node; tmp_node; tmp_node = tmp_node->next) {
+        size++;
+    }
+
+    os_calloc(size + 1, sizeof(OSDecoderNode *), candidates);
+    size = 0;
+
+    for (tmp_node = node; tmp_node; tmp_node = tmp_node->next) {
+        if (w_expression_match(tmp_node->osdecoder->program_name, program_name, NULL, decoder_match)) {
+            candidates[size++] = tmp_node;
+        }
+    }
+
+    os_realloc(candidates, (size + 1) * sizeof(OSDecoderNode *), candidates);
+
+    /* Another thread may have saved them first */
+    if (OSHash_Add_ex(node->program_names, program_name, candidates) != OSHASH_SUCCESS) {
+        os_free(candidates);
+        return OSHash_Get_ex(node->program_names, program_name);
+    }
+
+    return candidates;
+}
+
 void os_remove_decoders_list(OSDecoderNode *decoderlist_pn, OSDecoderNode *decoderlist_npn) {
 
     OSDecoderInfo **decoders;
     int pos = 0;
     int num_decoders = 0;
 
+    if (decoderlist_pn && decoderlist_pn->program_names) {
+        OSHash_Free(decoderlist_pn->program_names);
+        decoderlist_pn->program_names = NULL;
+    }
+
     os_count_decoders(decoderlist_pn, &num_decoders);
     os_count_decoders(decoderlist_npn, &num_decoders);
 
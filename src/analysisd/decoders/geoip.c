@@ -22,15 +22,83 @@
 #include "eventinfo.h"
 #include "alerts/alerts.h"
 #include "decoder.h"
-#include "GeoIP.h"
+#ifndef LIBMAXMINDDB_ENABLED
 #include "GeoIPCity.h"
+#endif
+
+#define GEOIP_CACHE_WAYS 4
+
+/* Location of an IP address, NULL if it's unknown */
+typedef struct geoip_cache_entry_t {
+    char ip[IPSIZE + 1];
+    char *geodata;
+    unsigned long stamp;
+} geoip_cache_entry_t;
+
+/* Cache of a thread. The entries are grouped in sets of GEOIP_CACHE_WAYS,
+ * a miss replaces the least recently used entry of the set of the IP.
+ */
+typedef struct geoip_cache_t {
+    geoip_cache_entry_t *entries;
+    unsigned int sets;
+    unsigned long clock;
+} geoip_cache_t;
+
+static __thread geoip_cache_t geoip_cache;
+static unsigned int geoip_cache_sets;
+
+static char *geoip_lookup(const char *ip_addr);
+
+/* FNV-1a hash of the IP address */
+static unsigned int geoip_hash(const char *ip_addr)
+{
+    unsigned int hash = 2166136261u;
+
+    for (; *ip_addr; ip_addr++) {
+        hash = (hash ^ (unsigned char)*ip_addr) * 16777619u;
+    }
+
+    return hash;
+}
+
+
+void OS_GeoIPInit(const char *db_file, unsigned int cache_size)
+{
+    geoipdb = NULL;
+
+    /* Round the cache down to a power of two number of sets */
+    for (geoip_cache_sets = 1; geoip_cache_sets * 2 * GEOIP_CACHE_WAYS <= cache_size; geoip_cache_sets *= 2);
+
+    if (cache_size < GEOIP_CACHE_WAYS) {
+        geoip_cache_sets = 0;
+    }
+
+    if (!db_file) {
+        return;
+    }
+
+#ifdef LIBMAXMINDDB_ENABLED
+    os_calloc(1, sizeof(MMDB_s), geoipdb);
+
+    if (MMDB_open(db_file, MMDB_MODE_MMAP, geoipdb) != MMDB_SUCCESS) {
+        os_free(geoipdb);
+    }
+#else
+    geoipdb = GeoIP_open(db_file, GEOIP_INDEX_CACHE);
+#endif
+
+    if (geoipdb == NULL) {
+        merror("Unable to open GeoIP database from: %s (disabling GeoIP).", db_file);
+    }
+}
 
 
 char *GetGeoInfobyIP(char *ip_addr)
 {
-    GeoIPRecord *geoiprecord;
+    geoip_cache_entry_t *set;
+    geoip_cache_entry_t *entry;
     char *geodata = NULL;
-    char geobuffer[256 +1];
+    unsigned int i;
 
     if(!geoipdb)
     {
@@ -42,7 +110,121 @@ char *GetGeoInfobyIP(char *ip_addr)
         return(NULL);
     }
 
-    geoiprecord = GeoIP_record_by_name(geoipdb, (const char *)ip_addr);
+    if (!geoip_cache_sets || strlen(ip_addr) > IPSIZE) {
+        return geoip_lookup(ip_addr);
+    }
+
+    if (!geoip_cache.entries) {
+        os_calloc(geoip_cache_sets * GEOIP_CACHE_WAYS, sizeof(geoip_cache_entry_t), geoip_cache.entries);
+        geoip_cache.sets = geoip_cache_sets;
+    }
+
+    set = geoip_cache.entries + (geoip_hash(ip_addr) & (geoip_cache.sets - 1)) * GEOIP_CACHE_WAYS;
+    entry = set;
+
+    for (i = 0; i < GEOIP_CACHE_WAYS; i++) {
+        if (set[i].stamp && strcmp(set[i].ip, ip_addr) == 0) {
+            set[i].stamp = ++geoip_cache.clock;
+
+            if (set[i].geodata) {
+                os_strdup(set[i].geodata, geodata);
+            }
+
+            return geodata;
+        }
+
+        if (set[i].stamp < entry->stamp) {
+            entry = &set[i];
+        }
+    }
+
+    geodata = geoip_lookup(ip_addr);
+
+    os_free(entry->geodata);
+    strcpy(entry->ip, ip_addr);
+    entry->stamp = ++geoip_cache.clock;
+
+    if (geodata) {
+        os_strdup(geodata, entry->geodata);
+    }
+
+    return geodata;
+}
+
+
+#ifdef LIBMAXMINDDB_ENABLED
+
+/* Get a string of the entry, NULL if it doesn't have it */
+static char *geoip_get_string(MMDB_entry_s *entry, const char *const *path)
+{
+    MMDB_entry_data_s data;
+    char *value;
+
+    if (MMDB_aget_value(entry, &data, path) != MMDB_SUCCESS || !data.has_data ||
+        data.type != MMDB_DATA_TYPE_UTF8_STRING || data.data_size == 0) {
+        return NULL;
+    }
+
+    os_calloc(data.data_size + 1, sizeof(char), value);
+    memcpy(value, data.utf8_string, data.data_size);
+
+    return value;
+}
+
+char *geoip_lookup(const char *ip_addr)
+{
+    static const char *const country_path[] = { "country", "iso_code", NULL };
+    static const char *const region_path[] = { "subdivisions", "0", "names", "en", NULL };
+    MMDB_lookup_result_s result;
+    char geobuffer[256 +1];
+    char *country_code;
+    char *regionname;
+    char *geodata = NULL;
+    int gai_error;
+    int mmdb_error;
+
+    result = MMDB_lookup_string(geoipdb, ip_addr, &gai_error, &mmdb_error);
+    if (gai_error != 0 || mmdb_error != MMDB_SUCCESS || !result.found_entry)
+    {
+        return(NULL);
+    }
+
+    if (country_code = geoip_get_string(&result.entry, country_path), country_code == NULL)
+    {
+        return(NULL);
+    }
+
+    if(strlen(country_code) < 2)
+    {
+        os_free(country_code);
+        return(NULL);
+    }
+
+    if (regionname = geoip_get_string(&result.entry, region_path), regionname != NULL)
+    {
+        snprintf(geobuffer, 255, "%s / %s", country_code, regionname);
+        geobuffer[255] = '\0';
+        os_strdup(geobuffer, geodata);
+        os_free(regionname);
+    }
+    else
+    {
+        os_strdup(country_code, geodata);
+    }
+
+    os_free(country_code);
+    return(geodata);
+}
+
+#else
+
+char *geoip_lookup(const char *ip_addr)
+{
+    GeoIPRecord *geoiprecord;
+    char *geodata = NULL;
+    char geobuffer[256 +1];
+
+    geoiprecord = GeoIP_record_by_name(geoipdb, ip_addr);
     if(geoiprecord == NULL)
     {
         return(NULL);
@@ -87,3 +269,5 @@ char *GetGeoInfobyIP(char *ip_addr)
 }
 
 #endif
+
+#endif
@@ -10,6 +10,7 @@
 
 /* Hostinfo decoder */
 #include "decoder.h"
+#include "ruleset.h"
 
 #include "config.h"
 #include "os_regex/os_regex.h"
@@ -25,8 +26,10 @@
 
 /* Local variables */
 static int hi_err = 0;
-static int id_new = 0;
-static int id_mod = 0;
+static u_int16_t id_new = 0;
+static u_int16_t id_mod = 0;
+static int slot_new;
+static int slot_mod;
 static char _hi_buf[OS_MAXSTR + 1];
 static FILE *_hi_fp = NULL;
 
@@ -72,12 +75,12 @@ void HostinfoInit()
 
     /* Zero decoder */
     os_calloc(1, sizeof(OSDecoderInfo), hostinfo_dec);
-    hostinfo_dec->id = getDecoderfromlist(HOSTINFO_MOD, &os_analysisd_decoder_store);
+    w_ruleset_bind_decoder(&hostinfo_dec->id, HOSTINFO_MOD);
     hostinfo_dec->type = OSSEC_RL;
     hostinfo_dec->name = HOSTINFO_MOD;
     hostinfo_dec->fts = 0;
-    id_new = getDecoderfromlist(HOSTINFO_NEW, &os_analysisd_decoder_store);
-    id_mod = getDecoderfromlist(HOSTINFO_MOD, &os_analysisd_decoder_store);
+    slot_new = w_ruleset_bind_decoder(&id_new, HOSTINFO_NEW);
+    slot_mod = w_ruleset_bind_decoder(&id_mod, HOSTINFO_MOD);
 
     /* Open HOSTINFO_FILE */
     snprintf(_hi_buf, OS_SIZE_1024, "%s", HOSTINFO_FILE);
@@ -223,9 +226,11 @@ int DecodeHostinfo(Eventinfo *lf)
     /* Set comment */
     if (changed == 1) {
         hostinfo_dec->id = id_mod;
+        lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, slot_mod, id_mod);
         /* lf->generated_rule->last_events[0] = opened; */
     } else {
         hostinfo_dec->id = id_new;
+        lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, slot_new, id_new);
     }
 
     w_mutex_unlock(&hostinfo_mutex);
@@ -401,3 +401,8 @@ void *JSON_Decoder_Exec(Eventinfo *lf, __attribute__((unused)) regex_matching *d
     }
     return (NULL);
 }
+
+void JSON_Decoder_Exec_Tree(Eventinfo *lf, cJSON *logJSON)
+{
+    readJSON(logJSON, NULL, lf);
+}
@@ -92,12 +92,10 @@ void *OSSECAlert_Decoder_Exec(Eventinfo *lf, OSHash *rules_hash, __attribute__((
     oa_newlocation[255] = '\0';
 
     snprintf(oa_newlocation, 255, "%s|%s", lf->location, oa_location);
-    free(lf->location);
-    os_strdup(oa_newlocation, lf->location);
-    if (lf->hostname) {
-        free(lf->hostname);
-    }
-    os_strdup(lf->location, lf->hostname);
+    w_strpool_release(event_strings, lf->location);
+    lf->location = w_strpool_get(event_strings, oa_newlocation);
+    w_strpool_release(event_strings, lf->hostname);
+    lf->hostname = w_strpool_ref(event_strings, lf->location);
 
     *tmp_str = ';';
     tmp_str++;
@@ -15,11 +15,13 @@
 #include "eventinfo.h"
 #include "alerts/alerts.h"
 #include "decoder.h"
+#include "ruleset.h"
 #include "rootcheck_op.h"
 #include <pthread.h>
 
 /* Rootcheck decoder */
 static OSDecoderInfo *rootcheck_dec = NULL;
+static int rootcheck_slot;
 
 
 /* Initialize the necessary information to process the rootcheck information */
@@ -27,7 +29,7 @@ void RootcheckInit()
 {
     /* Zero decoder */
     os_calloc(1, sizeof(OSDecoderInfo), rootcheck_dec);
-    rootcheck_dec->id = getDecoderfromlist(ROOTCHECK_MOD, &os_analysisd_decoder_store);
+    rootcheck_slot = w_ruleset_bind_decoder(&rootcheck_dec->id, ROOTCHECK_MOD);
     rootcheck_dec->type = OSSEC_RL;
     rootcheck_dec->name = ROOTCHECK_MOD;
     rootcheck_dec->fts = 0;
@@ -65,6 +67,7 @@ int DecodeRootcheck(Eventinfo *lf)
         mdebug1("Rootcheck decoder response: '%s'", response);
 
         lf->decoder_info = rootcheck_dec;
+        lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, rootcheck_slot, rootcheck_dec->id);
 
         char *op_code = wstr_chr(response, ' ');
         if (op_code) {
@@ -14,6 +14,7 @@
 #include "eventinfo.h"
 #include "alerts/alerts.h"
 #include "decoder.h"
+#include "ruleset.h"
 #include "external/cJSON/cJSON.h"
 #include "plugin_decoders.h"
 #include "wazuh_modules/wmodules.h"
@@ -62,6 +63,7 @@ static void *RequestDBThread();
 static int ConnectToSecurityConfigurationAssessmentSocket();
 static int ConnectToSecurityConfigurationAssessmentSocketRemoted();
 static OSDecoderInfo *sca_json_dec = NULL;
+static int sca_json_slot;
 
 static int cfga_socket;
 static int cfgar_socket;
@@ -72,7 +74,7 @@ void SecurityConfigurationAssessmentInit()
 {
 
     os_calloc(1, sizeof(OSDecoderInfo), sca_json_dec);
-    sca_json_dec->id = getDecoderfromlist(SCA_MOD, &os_analysisd_decoder_store);
+    sca_json_slot = w_ruleset_bind_decoder(&sca_json_dec->id, SCA_MOD);
     sca_json_dec->type = OSSEC_RL;
     sca_json_dec->name = SCA_MOD;
     sca_json_dec->fts = 0;
@@ -173,6 +175,7 @@ int DecodeSCA(Eventinfo *lf, int *socket)
     cJSON *json_event = NULL;
     cJSON *type = NULL;
     lf->decoder_info = sca_json_dec;
+    lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, sca_json_slot, sca_json_dec->id);
     const char *jsonErrPtr;
 
     if (json_event = cJSON_ParseWithOpts(lf->log, &jsonErrPtr, 0), !json_event)
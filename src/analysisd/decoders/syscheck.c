@@ -15,6 +15,7 @@
 #include "config.h"
 #include "alerts/alerts.h"
 #include "decoder.h"
+#include "ruleset.h"
 #include "syscheck_op.h"
 #include "wazuh_modules/wmodules.h"
 #include "os_net/os_net.h"
@@ -88,6 +89,12 @@ void fim_send_db_delete(_sdb * sdb, const char * agent_id, const char * path);
 // Send a query to Wazuh DB
 void fim_send_db_query(int * sock, const char * query);
 
+// Send a query to Wazuh DB, through the writer of the agent if there are writers
+void fim_send_db_request(_sdb * sdb, const char * agent_id, const char * query);
+
+// Send the queries of a writer queue to Wazuh DB
+static void * fim_db_writer_thread(void * queue);
+
 // Build change comment
 static size_t fim_generate_comment(char * str, long size, const char * format, const char * a1, const char * a2);
 
@@ -114,11 +121,14 @@ static char *perm_json_to_old_format(cJSON *perm_json);
 static pthread_mutex_t control_msg_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 typedef struct _fim_decoders_t {
-    int add_id;
+    u_int16_t add_id;
+    int add_slot;
     char *add_name;
-    int modify_id;
+    u_int16_t modify_id;
+    int modify_slot;
     char *modify_name;
-    int delete_id;
+    u_int16_t delete_id;
+    int delete_slot;
     char *delete_name;
 } fim_decoders_t;
 
@@ -134,28 +144,32 @@ static fim_decoders_t *fim_decoders[] = {
 };
 OSHash *fim_agentinfo;
 
+// Queries waiting for the writer threads, the ones of an agent always go to the same writer
+static w_queue_t ** fim_db_queues;
+static unsigned int fim_db_writers;
+
 // Initialize the necessary information to process the syscheck information
 // LCOV_EXCL_START
 int fim_init(void) {
     //Create hash table for agent information
     fim_agentinfo = OSHash_Create();
-    fim_decoders[FILE_DECODER]->add_id = getDecoderfromlist(FIM_NEW, &os_analysisd_decoder_store);
+    fim_decoders[FILE_DECODER]->add_slot = w_ruleset_bind_decoder(&fim_decoders[FILE_DECODER]->add_id, FIM_NEW);
     fim_decoders[FILE_DECODER]->add_name = FIM_NEW;
-    fim_decoders[FILE_DECODER]->modify_id = getDecoderfromlist(FIM_MOD, &os_analysisd_decoder_store);
+    fim_decoders[FILE_DECODER]->modify_slot = w_ruleset_bind_decoder(&fim_decoders[FILE_DECODER]->modify_id, FIM_MOD);
     fim_decoders[FILE_DECODER]->modify_name = FIM_MOD;
-    fim_decoders[FILE_DECODER]->delete_id = getDecoderfromlist(FIM_DEL, &os_analysisd_decoder_store);
+    fim_decoders[FILE_DECODER]->delete_slot = w_ruleset_bind_decoder(&fim_decoders[FILE_DECODER]->delete_id, FIM_DEL);
     fim_decoders[FILE_DECODER]->delete_name = FIM_DEL;
-    fim_decoders[REGISTRY_KEY_DECODER]->add_id = getDecoderfromlist(FIM_REG_KEY_NEW, &os_analysisd_decoder_store);
+    fim_decoders[REGISTRY_KEY_DECODER]->add_slot = w_ruleset_bind_decoder(&fim_decoders[REGISTRY_KEY_DECODER]->add_id, FIM_REG_KEY_NEW);
     fim_decoders[REGISTRY_KEY_DECODER]->add_name = FIM_REG_KEY_NEW;
-    fim_decoders[REGISTRY_KEY_DECODER]->modify_id = getDecoderfromlist(FIM_REG_KEY_MOD, &os_analysisd_decoder_store);
+    fim_decoders[REGISTRY_KEY_DECODER]->modify_slot = w_ruleset_bind_decoder(&fim_decoders[REGISTRY_KEY_DECODER]->modify_id, FIM_REG_KEY_MOD);
     fim_decoders[REGISTRY_KEY_DECODER]->modify_name = FIM_REG_KEY_MOD;
-    fim_decoders[REGISTRY_KEY_DECODER]->delete_id = getDecoderfromlist(FIM_REG_KEY_DEL, &os_analysisd_decoder_store);
+    fim_decoders[REGISTRY_KEY_DECODER]->delete_slot = w_ruleset_bind_decoder(&fim_decoders[REGISTRY_KEY_DECODER]->delete_id, FIM_REG_KEY_DEL);
     fim_decoders[REGISTRY_KEY_DECODER]->delete_name = FIM_REG_KEY_DEL;
-    fim_decoders[REGISTRY_VALUE_DECODER]->add_id = getDecoderfromlist(FIM_REG_VAL_NEW, &os_analysisd_decoder_store);
+    fim_decoders[REGISTRY_VALUE_DECODER]->add_slot = w_ruleset_bind_decoder(&fim_decoders[REGISTRY_VALUE_DECODER]->add_id, FIM_REG_VAL_NEW);
     fim_decoders[REGISTRY_VALUE_DECODER]->add_name = FIM_REG_VAL_NEW;
-    fim_decoders[REGISTRY_VALUE_DECODER]->modify_id = getDecoderfromlist(FIM_REG_VAL_MOD, &os_analysisd_decoder_store);
+    fim_decoders[REGISTRY_VALUE_DECODER]->modify_slot = w_ruleset_bind_decoder(&fim_decoders[REGISTRY_VALUE_DECODER]->modify_id, FIM_REG_VAL_MOD);
     fim_decoders[REGISTRY_VALUE_DECODER]->modify_name = FIM_REG_VAL_MOD;
-    fim_decoders[REGISTRY_VALUE_DECODER]->delete_id = getDecoderfromlist(FIM_REG_VAL_DEL, &os_analysisd_decoder_store);
+    fim_decoders[REGISTRY_VALUE_DECODER]->delete_slot = w_ruleset_bind_decoder(&fim_decoders[REGISTRY_VALUE_DECODER]->delete_id, FIM_REG_VAL_DEL);
     fim_decoders[REGISTRY_VALUE_DECODER]->delete_name = FIM_REG_VAL_DEL;
     if (fim_agentinfo == NULL) return 0;
     return 1;
@@ -169,7 +183,7 @@ void sdb_init(_sdb *localsdb, OSDecoderInfo *fim_decoder) {
     sdb_clean(localsdb);
 
     // Create decoder
-    fim_decoder->id = getDecoderfromlist(FIM_MOD, &os_analysisd_decoder_store);
+    w_ruleset_bind_decoder(&fim_decoder->id, FIM_MOD);
     fim_decoder->name = FIM_MOD;
     fim_decoder->type = OSSEC_RL;
     fim_decoder->fts = 0;
@@ -566,19 +580,19 @@ int fim_alert (char *f_name, sk_sum_t *oldsum, sk_sum_t *newsum, Eventinfo *lf,
     if (event_type == FIM_DELETED) {
         snprintf(msg_type, sizeof(msg_type), "was deleted.");
         lf->decoder_info->id = fim_decoders[FILE_DECODER]->delete_id;
-        lf->decoder_syscheck_id = lf->decoder_info->id;
+        lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, fim_decoders[FILE_DECODER]->delete_slot, lf->decoder_info->id);
         lf->decoder_info->name = fim_decoders[FILE_DECODER]->delete_name;
         changes = 1;
     } else if (event_type == FIM_ADDED) {
         snprintf(msg_type, sizeof(msg_type), "was added.");
         lf->decoder_info->id = fim_decoders[FILE_DECODER]->add_id;
-        lf->decoder_syscheck_id = lf->decoder_info->id;
+        lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, fim_decoders[FILE_DECODER]->add_slot, lf->decoder_info->id);
         lf->decoder_info->name = fim_decoders[FILE_DECODER]->add_name;
         changes = 1;
     } else if (event_type == FIM_MODIFIED) {
         snprintf(msg_type, sizeof(msg_type), "checksum changed.");
         lf->decoder_info->id = fim_decoders[FILE_DECODER]->modify_id;
-        lf->decoder_syscheck_id = lf->decoder_info->id;
+        lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, fim_decoders[FILE_DECODER]->modify_slot, lf->decoder_info->id);
         lf->decoder_info->name = fim_decoders[FILE_DECODER]->modify_name;
         if (oldsum->size && newsum->size) {
             if (strcmp(oldsum->size, newsum->size) == 0) {
@@ -1263,6 +1277,7 @@ static int fim_process_alert(_sdb * sdb, Eventinfo *lf, cJSON * event) {
     cJSON *object = NULL;
     char *entry_type = NULL;
     fim_decoders_t *decoder = NULL;
+    int slot;
     syscheck_event_t event_type;
 
     cJSON_ArrayForEach(object, event) {
@@ -1358,20 +1373,23 @@ static int fim_process_alert(_sdb * sdb, Eventinfo *lf, cJSON * event) {
         event_type = FIM_ADDED;
         lf->decoder_info->name = decoder->add_name;
         lf->decoder_info->id = decoder->add_id;
+        slot = decoder->add_slot;
     } else if (strcmp(SYSCHECK_EVENT_STRINGS[FIM_MODIFIED], lf->fields[FIM_EVENT_TYPE].value) == 0) {
         event_type = FIM_MODIFIED;
         lf->decoder_info->name = decoder->modify_name;
         lf->decoder_info->id = decoder->modify_id;
+        slot = decoder->modify_slot;
     } else if (strcmp(SYSCHECK_EVENT_STRINGS[FIM_DELETED], lf->fields[FIM_EVENT_TYPE].value) == 0) {
         event_type = FIM_DELETED;
         lf->decoder_info->name = decoder->delete_name;
-        lf->decoder_info->id =  decoder->delete_id;
+        lf->decoder_info->id = decoder->delete_id;
+        slot = decoder->delete_slot;
     } else {
         mdebug1("Invalid 'type' value '%s' in JSON payload.", lf->fields[FIM_EVENT_TYPE].value);
         return -1;
     }
 
-    lf->decoder_syscheck_id = lf->decoder_info->id;
+    lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, slot, lf->decoder_info->id);
 
     fim_generate_alert(lf, event_type, attributes, old_attributes, audit);
 
@@ -1408,7 +1426,7 @@ void fim_send_db_save(_sdb * sdb, const char * agent_id, cJSON * data) {
         goto end;
     }
 
-    fim_send_db_query(&sdb->socket, query);
+    fim_send_db_request(sdb, agent_id, query);
 
 end:
     free(data_plain);
@@ -1423,7 +1441,7 @@ void fim_send_db_delete(_sdb * sdb, const char * agent_id, const char * path) {
         return;
     }
 
-    fim_send_db_query(&sdb->socket, query);
+    fim_send_db_request(sdb, agent_id, query);
 }
 
 void fim_send_db_query(int * sock, const char * query) {
@@ -1458,6 +1476,51 @@ end:
 }
 
 
+void fim_send_db_request(_sdb * sdb, const char * agent_id, const char * query) {
+    char * copy;
+
+    if (fim_db_writers == 0) {
+        fim_send_db_query(&sdb->socket, query);
+        return;
+    }
+
+    os_strdup(query, copy);
+
+    // The decoder only waits when the writer of the agent is behind by a whole queue
+    queue_push_ex_block(fim_db_queues[agent_id ? strtoul(agent_id, NULL, 10) % fim_db_writers : 0], copy);
+}
+
+// LCOV_EXCL_START
+void * fim_db_writer_thread(void * queue) {
+    int sock = -1;
+    char * query;
+
+    while (1) {
+        if (query = queue_pop_ex((w_queue_t *)queue), query) {
+            fim_send_db_query(&sock, query);
+            free(query);
+        }
+    }
+
+    return NULL;
+}
+
+void fim_db_writer_init(unsigned int writers, size_t queue_size) {
+    fim_db_writers = writers;
+
+    if (writers == 0) {
+        return;
+    }
+
+    os_calloc(writers, sizeof(w_queue_t *), fim_db_queues);
+
+    for (unsigned int i = 0; i < writers; i++) {
+        fim_db_queues[i] = queue_init(queue_size);
+        w_create_thread(fim_db_writer_thread, fim_db_queues[i]);
+    }
+}
+// LCOV_EXCL_STOP
+
 static int fim_generate_alert(Eventinfo *lf, syscheck_event_t event_type, cJSON *attributes, cJSON *old_attributes, cJSON *audit) {
     static const char *ENTRY_TYPE_FILE = "File";
     static const char *ENTRY_TYPE_REGISTRY_KEY = "Registry Key";
@@ -1673,7 +1736,7 @@ void fim_process_scan_info(_sdb * sdb, const char * agent_id, fim_scan_event eve
         return;
     }
 
-    fim_send_db_query(&sdb->socket, query);
+    fim_send_db_request(sdb, agent_id, query);
 }
 
 int fim_fetch_attributes(cJSON *new_attrs, cJSON *old_attrs, Eventinfo *lf) {
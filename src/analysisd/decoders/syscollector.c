@@ -14,6 +14,7 @@
 #include "eventinfo.h"
 #include "alerts/alerts.h"
 #include "decoder.h"
+#include "ruleset.h"
 #include "external/cJSON/cJSON.h"
 #include "plugin_decoders.h"
 #include "os_net/os_net.h"
@@ -46,6 +47,7 @@ static int decode_process( Eventinfo *lf, cJSON * logJSON, int *socket);
 static int decode_dbsync( Eventinfo *lf, char *msg_type, cJSON * logJSON, int *socket);
 
 static OSDecoderInfo *sysc_decoder = NULL;
+static int sysc_slot;
 
 
 //
@@ -228,7 +230,7 @@ static struct deltas_fields_match_list const OS_FIELDS[] = {
 void SyscollectorInit(){
 
     os_calloc(1, sizeof(OSDecoderInfo), sysc_decoder);
-    sysc_decoder->id = getDecoderfromlist(SYSCOLLECTOR_MOD, &os_analysisd_decoder_store);
+    sysc_slot = w_ruleset_bind_decoder(&sysc_decoder->id, SYSCOLLECTOR_MOD);
     sysc_decoder->name = SYSCOLLECTOR_MOD;
     sysc_decoder->type = OSSEC_RL;
     sysc_decoder->fts = 0;
@@ -236,6 +238,61 @@ void SyscollectorInit(){
     mdebug1("SyscollectorInit completed.");
 }
 
+/* Split a batch of deltas ({"type":"dbsync_<table>","batch":[{"operation":...,"data":...}]})
+ * into the raw message of each delta, in the order they were generated */
+char ** SyscollectorSplitBatch(const char *msg) {
+    const char *payload;
+    cJSON *root;
+    cJSON *type;
+    cJSON *batch;
+    cJSON *item;
+    char **messages;
+    size_t prefix;
+    int count = 0;
+
+    if (strlen(msg) < 2 || (payload = wstr_chr_escape(msg + 2, ':', '|'), !payload) || !strstr(payload, "\"batch\":[")) {
+        return NULL;
+    }
+
+    if (root = cJSON_Parse(payload + 1), !root) {
+        return NULL;
+    }
+
+    type = cJSON_GetObjectItem(root, "type");
+    batch = cJSON_GetObjectItem(root, "batch");
+
+    if (!cJSON_IsString(type) || !cJSON_IsArray(batch)) {
+        cJSON_Delete(root);
+        return NULL;
+    }
+
+    // The queue and the location are kept for every delta
+    prefix = payload + 1 - msg;
+    os_calloc(cJSON_GetArraySize(batch) + 1, sizeof(char *), messages);
+
+    cJSON_ArrayForEach(item, batch) {
+        char *delta;
+
+        if (!cJSON_IsObject(item)) {
+            mdebug1("Invalid delta in the batch of '%s'.", type->valuestring);
+            continue;
+        }
+
+        cJSON_AddStringToObject(item, "type", type->valuestring);
+
+        if (delta = cJSON_PrintUnformatted(item), delta) {
+            os_malloc(prefix + strlen(delta) + 1, messages[count]);
+            memcpy(messages[count], msg, prefix);
+            strcpy(messages[count] + prefix, delta);
+            count++;
+            cJSON_free(delta);
+        }
+    }
+
+    cJSON_Delete(root);
+    return messages;
+}
+
 /* Special decoder for syscollector */
 int DecodeSyscollector(Eventinfo *lf,int *socket)
 {
@@ -244,6 +301,7 @@ int DecodeSyscollector(Eventinfo *lf,int *socket)
     char *msg_type = NULL;
 
     lf->decoder_info = sysc_decoder;
+    lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, sysc_slot, sysc_decoder->id);
 
     // Check location
     if (lf->location[0] == '(') {
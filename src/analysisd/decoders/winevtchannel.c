@@ -14,6 +14,7 @@
 #include "eventinfo.h"
 #include "alerts/alerts.h"
 #include "decoder.h"
+#include "ruleset.h"
 #include "external/cJSON/cJSON.h"
 #include "plugin_decoders.h"
 #include "wazuh_modules/wmodules.h"
@@ -34,12 +35,13 @@
 #define AUDIT_SUCCESS 0x20000000000000LL
 
 static OSDecoderInfo *winevt_decoder = NULL;
+static int winevt_slot;
 static int first_time = 0;
 
 void WinevtInit(){
 
     os_calloc(1, sizeof(OSDecoderInfo), winevt_decoder);
-    winevt_decoder->id = getDecoderfromlist(WINEVT_MOD, &os_analysisd_decoder_store);
+    winevt_slot = w_ruleset_bind_decoder(&winevt_decoder->id, WINEVT_MOD);
     winevt_decoder->name = WINEVT_MOD;
     winevt_decoder->type = OSSEC_RL;
     winevt_decoder->fts = 0;
@@ -103,6 +105,7 @@ int DecodeWinevt(Eventinfo *lf){
     char *join_data = NULL;
     char *join_data2 = NULL;
     lf->decoder_info = winevt_decoder;
+    lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, winevt_slot, winevt_decoder->id);
 
     os_calloc(OS_MAXSTR, sizeof(char), msg_from_prov);
     os_calloc(OS_MAXSTR, sizeof(char), join_data);
@@ -711,19 +714,23 @@ int DecodeWinevt(Eventinfo *lf){
 
     cJSON_AddItemToObject(final_event, "win", json_event);
 
-    returned_event = cJSON_PrintUnformatted(final_event);
-
-    if (returned_event){
-        lf->full_log[strlen(returned_event)] = '\0';
-        memcpy(lf->full_log, returned_event, strlen(returned_event));
-    } else {
-        lf->full_log = NULL;
+    /* The event is printed over the received one, which is held twice in full_log */
+    if (!cJSON_PrintPreallocated(final_event, lf->full_log, (int)(2 * strlen(lf->full_log) + 1), 0)) {
+        if (returned_event = cJSON_PrintUnformatted(final_event), returned_event) {
+            os_free(lf->full_log);
+            lf->full_log = returned_event;
+            returned_event = NULL;
+        } else {
+            *lf->full_log = '\0';
+        }
     }
 
     lf->log = lf->full_log;
     lf->decoder_info = winevt_decoder;
+    lf->decoder_syscheck_id = w_ruleset_decoder_id(lf->ruleset, winevt_slot, winevt_decoder->id);
 
-    JSON_Decoder_Exec(lf, NULL);
+    /* The fields are the ones that the JSON decoder would read from full_log */
+    JSON_Decoder_Exec_Tree(lf, final_event);
 
 cleanup:
     os_free(level);
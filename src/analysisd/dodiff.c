@@ -68,7 +68,7 @@ static int _add2last(const char *str, size_t strsize, const char *file)
 int doDiff(RuleInfo *rule, struct _Eventinfo *lf)
 {
     time_t date_of_change;
-    char *htpt = NULL;
+    const char *htpt = NULL;
     char flastfile[OS_SIZE_2048 + 1];
     char flastcontent[OS_SIZE_65536 + 1];
 
@@ -77,21 +77,16 @@ int doDiff(RuleInfo *rule, struct _Eventinfo *lf)
     flastcontent[OS_SIZE_65536] = '\0';
 
     if (lf->hostname[0] == '(') {
+        /* The hostname may be shared with other events, so it's not cut in place */
         htpt = strchr(lf->hostname, ')');
-        if (htpt) {
-            *htpt = '\0';
-        }
+        int name_len = htpt ? (int)(htpt - lf->hostname - 1) : (int)strlen(lf->hostname + 1);
 
 #ifndef TESTRULE
-        snprintf(flastfile, OS_SIZE_2048, "%s/%s/%d/%s", DIFF_DIR, lf->hostname + 1, rule->sigid, DIFF_LAST_FILE);
+        snprintf(flastfile, OS_SIZE_2048, "%s/%.*s/%d/%s", DIFF_DIR, name_len, lf->hostname + 1, rule->sigid, DIFF_LAST_FILE);
 #else
+        (void)name_len;
         snprintf(flastfile, OS_SIZE_2048, "%s/%s/%d/%s", DIFF_DIR, DIFF_TEST_HOST, rule->sigid, DIFF_LAST_FILE);
 #endif
-
-        if (htpt) {
-            *htpt = ')';
-        }
-        htpt = NULL;
     } else {
 #ifndef TESTRULE
         snprintf(flastfile, OS_SIZE_2048, "%s/%s/%d/%s", DIFF_DIR, lf->hostname, rule->sigid, DIFF_LAST_FILE);
@@ -11,8 +11,16 @@
 #include "config.h"
 #include "analysisd.h"
 #include "eventinfo.h"
+#include "ruleset.h"
 #include "os_regex/os_regex.h"
 
+#ifdef WAZUH_UNIT_TESTING
+// Remove STATIC qualifier from tests
+#define STATIC
+#else
+#define STATIC static
+#endif
+
 /* Global definitions */
 #ifdef TESTRULE
 int full_output;
@@ -21,6 +29,14 @@ int alert_only;
 
 #define OS_COMMENT_MAX 1024
 
+/* Agent ID, location and hostname of the events. NULL if strings aren't interned */
+w_strpool_t *event_strings;
+
+/* Events released by Free_Eventinfo, ready for w_alloc_event_info */
+static Eventinfo *eventinfo_pool[EVENTINFO_POOL_SIZE];
+static size_t eventinfo_pool_size;
+static pthread_mutex_t eventinfo_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 
 size_t field_offset[] = {
     offsetof(Eventinfo, srcip),
@@ -83,6 +99,231 @@ bool different_loop(RuleInfo *rule, Eventinfo *lf, Eventinfo *my_lf) {
     return TRUE;
 }
 
+size_t w_event_shard(const char * agent_id, const char * location, size_t shards) {
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
+
+    /* The manager (000) gets the events of every syslog source, logfile and integration:
+     * only the events of the same location need to keep their order */
+    const char * key = (agent_id && strcmp(agent_id, "000") != 0) ? agent_id : location;
+
+    if (shards == 0) {
+        return 0;
+    }
+
+    if (key) {
+        for (; *key != '\0'; key++) {
+            hash ^= (unsigned char)*key;
+            hash *= 16777619u;
+        }
+    }
+
+    return hash % shards;
+}
+
+/* Append a value to the key of an event */
+static void w_sid_index_key_append(char **key, size_t *size, const char *value)
+{
+    size_t length = strlen(value);
+
+    os_realloc(*key, *size + length + 2, *key);
+    memcpy(*key + *size, value, length);
+    (*key)[*size + length] = '\n';
+    *size += length + 1;
+    (*key)[*size] = '\0';
+}
+
+/* True if the rule requires any value of the events to be the same */
+static bool w_sid_index_keyed(const RuleInfo *rule)
+{
+    return !(rule->context_opts & FIELD_GFREQUENCY) ||
+           (rule->same_field & (FIELD_ID | FIELD_SRCIP | FIELD_DYNAMICS)) ||
+           ((rule->alert_opts & SAME_EXTRAINFO) && (rule->same_field >> 2));
+}
+
+/* Key of an event in the index of a frequency rule: the values the rule requires to be the same.
+ * Returns NULL if the event lacks any of them, so it can't match any other event.
+ * Two events may only match if they have the same key. Different values may get the
+ * same key, Search_LastSids still compares them.
+ */
+STATIC char *w_sid_index_key(const RuleInfo *rule, const Eventinfo *lf)
+{
+    char *key = NULL;
+    size_t size = 0;
+    const char *value;
+    u_int32_t same;
+    size_t i;
+
+    os_calloc(1, sizeof(char), key);
+
+    if (!(rule->context_opts & FIELD_GFREQUENCY)) {
+        if (!lf->agent_id) {
+            goto fail;
+        }
+        w_sid_index_key_append(&key, &size, lf->agent_id);
+    }
+
+    if (rule->same_field & FIELD_ID) {
+        if (!lf->id) {
+            goto fail;
+        }
+        w_sid_index_key_append(&key, &size, lf->id);
+    }
+
+    if (rule->same_field & FIELD_SRCIP) {
+        if (!lf->srcip) {
+            goto fail;
+        }
+        w_sid_index_key_append(&key, &size, lf->srcip);
+    }
+
+    if (rule->same_field & FIELD_DYNAMICS) {
+        if (lf->nfields == 0) {
+            goto fail;
+        }
+
+        for (i = 0; rule->same_fields && rule->same_fields[i]; i++) {
+            if (value = FindField(lf, rule->same_fields[i]), !value) {
+                goto fail;
+            }
+            w_sid_index_key_append(&key, &size, value);
+        }
+    }
+
+    /* Same fields of same_loop */
+    if (rule->alert_opts & SAME_EXTRAINFO) {
+        same = rule->same_field >> 2;
+
+        for (i = 2; same != 0 && i < sizeof(field_offset) / sizeof(field_offset[0]); i++) {
+            if ((same & 1) == 1) {
+                if (value = *(char **)((void *)lf + field_offset[i]), !value) {
+                    goto fail;
+                }
+                w_sid_index_key_append(&key, &size, value);
+            }
+            same >>= 1;
+        }
+    }
+
+    return key;
+
+fail:
+    os_free(key);
+    return NULL;
+}
+
+void w_sid_index_init(RuleInfo *parent, RuleInfo *rule)
+{
+    w_sid_index_t *index;
+
+    /* The rule may be found more than once in the rule tree */
+    if (rule->sid_index || !w_sid_index_keyed(rule)) {
+        return;
+    }
+
+    os_calloc(1, sizeof(w_sid_index_t), index);
+    index->rule = rule;
+
+    if (index->buckets = OSHash_Create(), !index->buckets) {
+        merror_exit(MEM_ERROR, errno, strerror(errno));
+    }
+    OSHash_SetFreeDataPointer(index->buckets, (void (*)(void *))OSList_Destroy);
+    w_rwlock_init(&index->rwlock, NULL);
+
+    os_realloc(parent->sid_prev_index, (parent->sid_prev_index_sz + 1) * sizeof(w_sid_index_t *),
+               parent->sid_prev_index);
+    parent->sid_prev_index[parent->sid_prev_index_sz++] = index;
+    rule->sid_index = index;
+}
+
+void w_sid_index_add(RuleInfo *parent, Eventinfo *lf)
+{
+    unsigned int i;
+
+    if (parent->sid_prev_index_sz == 0) {
+        return;
+    }
+
+    os_calloc(parent->sid_prev_index_sz, sizeof(w_sid_index_entry_t), lf->sid_index_entries);
+
+    for (i = 0; i < parent->sid_prev_index_sz; i++) {
+        w_sid_index_t *index = parent->sid_prev_index[i];
+        OSList *bucket;
+        char *key;
+
+        /* Events without the values of the key are never found by the rule */
+        if (key = w_sid_index_key(index->rule, lf), !key) {
+            continue;
+        }
+
+        w_rwlock_wrlock(&index->rwlock);
+
+        if (bucket = OSHash_Get(index->buckets, key), !bucket) {
+            if (bucket = OSList_Create(), !bucket) {
+                merror_exit(MEM_ERROR, errno, strerror(errno));
+            }
+
+            if (OSHash_Add(index->buckets, key, bucket) != 2) {
+                merror("Unable to add data to sid index.");
+                OSList_Destroy(bucket);
+                bucket = NULL;
+            }
+        }
+
+        if (bucket && (lf->sid_index_entries[i].node = OSList_AddData(bucket, lf))) {
+            lf->sid_index_entries[i].bucket = bucket;
+            lf->sid_index_entries[i].key = key;
+            key = NULL;
+        }
+
+        w_rwlock_unlock(&index->rwlock);
+        os_free(key);
+    }
+}
+
+/* Remove an event from the indexes of the rule that generated it, so it can be freed */
+STATIC void w_sid_index_remove(Eventinfo *lf)
+{
+    RuleInfo *parent = lf->generated_rule;
+    unsigned int i;
+
+    /* The values of the key may have changed since the event was added */
+    for (i = 0; i < parent->sid_prev_index_sz; i++) {
+        w_sid_index_t *index = parent->sid_prev_index[i];
+        w_sid_index_entry_t *entry = &lf->sid_index_entries[i];
+
+        if (!entry->node) {
+            continue;
+        }
+
+        w_rwlock_wrlock(&index->rwlock);
+
+        OSList_DeleteThisNode(entry->bucket, entry->node);
+
+        /* Don't keep a bucket for each value ever seen */
+        if (entry->bucket->currently_size == 0) {
+            OSHash_Delete(index->buckets, entry->key);
+            OSList_Destroy(entry->bucket);
+        }
+
+        w_rwlock_unlock(&index->rwlock);
+        os_free(entry->key);
+    }
+
+    os_free(lf->sid_index_entries);
+}
+
+void w_sid_index_free(RuleInfo *rule)
+{
+    if (!rule->sid_index) {
+        return;
+    }
+
+    OSHash_Free(rule->sid_index->buckets);
+    w_rwlock_destroy(&rule->sid_index->rwlock);
+    os_free(rule->sid_index);
+}
+
 /* Search last times a signature fired
  * Will look for only that specific signature.
  */
@@ -91,6 +332,8 @@ Eventinfo *Search_LastSids(Eventinfo *my_lf, __attribute__((unused)) EventList *
     Eventinfo *lf = NULL;
     Eventinfo *first_matched = NULL;
     OSListNode *lf_node;
+    OSList *list = rule->sid_search;
+    char *key = NULL;
     int frequency_count = 0;
     int i;
     int found;
@@ -104,18 +347,32 @@ Eventinfo *Search_LastSids(Eventinfo *my_lf, __attribute__((unused)) EventList *
         return NULL;
     }
 
-    while (1) {
-        w_mutex_lock(&rule->sid_search->mutex);
-            if (!rule->sid_search->pending_remove) {
-                rule->sid_search->count++;
-                w_mutex_unlock(&rule->sid_search->mutex);
-                break;
-            }
-        w_mutex_unlock(&rule->sid_search->mutex);
+    if (rule->sid_index) {
+        /* Only the events with the same key can match */
+        if (key = w_sid_index_key(rule, my_lf), !key) {
+            return NULL;
+        }
+
+        w_rwlock_rdlock(&rule->sid_index->rwlock);
+
+        if (list = OSHash_Get(rule->sid_index->buckets, key), !list) {
+            lf = NULL;
+            goto end;
+        }
+    } else {
+        while (1) {
+            w_mutex_lock(&rule->sid_search->mutex);
+                if (!rule->sid_search->pending_remove) {
+                    rule->sid_search->count++;
+                    w_mutex_unlock(&rule->sid_search->mutex);
+                    break;
+                }
+            w_mutex_unlock(&rule->sid_search->mutex);
+        }
     }
 
-    /* Get last node */
-    lf_node = OSList_GetLastNode(rule->sid_search);
+    /* Get last node. The bucket is shared by the readers of the index, so its current node isn't set */
+    lf_node = rule->sid_index ? list->last_node : OSList_GetLastNode(list);
     if (!lf_node) {
         lf = NULL;
         goto end;
@@ -253,9 +510,14 @@ Eventinfo *Search_LastSids(Eventinfo *my_lf, __attribute__((unused)) EventList *
 
     lf = NULL;
 end:
-    w_mutex_lock(&rule->sid_search->mutex);
-    rule->sid_search->count--;
-    w_mutex_unlock(&rule->sid_search->mutex);
+    if (rule->sid_index) {
+        w_rwlock_unlock(&rule->sid_index->rwlock);
+        os_free(key);
+    } else {
+        w_mutex_lock(&rule->sid_search->mutex);
+        rule->sid_search->count--;
+        w_mutex_unlock(&rule->sid_search->mutex);
+    }
     return lf;
 }
 
@@ -688,6 +950,7 @@ void Zero_Eventinfo(Eventinfo *lf)
 
     lf->generated_rule = NULL;
     lf->sid_node_to_delete = NULL;
+    lf->sid_index_entries = NULL;
     lf->group_node_to_delete = NULL;
     lf->decoder_info = NULL_Decoder;
 
@@ -701,10 +964,58 @@ void Zero_Eventinfo(Eventinfo *lf)
     lf->rootcheck_fts = 0;
     lf->decoder_syscheck_id = 0;
     lf->tid = -1;
+    lf->literal_set = NULL;
+    lf->literal_log = NULL;
+    lf->literal_matches = NULL;
 
     return;
 }
 
+Eventinfo *w_alloc_event_info(void)
+{
+    Eventinfo *lf = NULL;
+
+    w_mutex_lock(&eventinfo_pool_mutex);
+    if (eventinfo_pool_size > 0) {
+        lf = eventinfo_pool[--eventinfo_pool_size];
+    }
+    w_mutex_unlock(&eventinfo_pool_mutex);
+
+    if (lf) {
+        /* The fields array was cleared by Free_Eventinfo */
+        DynamicField *fields = lf->fields;
+
+        memset(lf, 0, sizeof(Eventinfo));
+        lf->fields = fields;
+    } else {
+        os_calloc(1, sizeof(Eventinfo), lf);
+        os_calloc(Config.decoder_order_size, sizeof(DynamicField), lf->fields);
+    }
+
+    lf->pooled = 1;
+    Zero_Eventinfo(lf);
+    lf->ruleset = w_ruleset_acquire();
+
+    return lf;
+}
+
+/* Return an event allocated by w_alloc_event_info to the pool. Returns false if the pool is full */
+STATIC bool w_release_event_info(Eventinfo *lf)
+{
+    bool retval = false;
+
+    memset(lf->fields, 0, sizeof(DynamicField) * Config.decoder_order_size);
+
+    w_mutex_lock(&eventinfo_pool_mutex);
+    if (eventinfo_pool_size < EVENTINFO_POOL_SIZE) {
+        eventinfo_pool[eventinfo_pool_size++] = lf;
+        retval = true;
+    }
+    w_mutex_unlock(&eventinfo_pool_mutex);
+
+    return retval;
+}
+
 /* Free the loginfo structure */
 void Free_Eventinfo(Eventinfo *lf)
 {
@@ -723,6 +1034,10 @@ void Free_Eventinfo(Eventinfo *lf)
 
     // Free node to delete
     if(!lf->is_a_copy){
+        if (lf->sid_index_entries) {
+            w_sid_index_remove(lf);
+        }
+
         if (lf->sid_node_to_delete) {
             w_mutex_lock(&lf->generated_rule->sid_prev_matched->mutex);
             lf->generated_rule->sid_prev_matched->pending_remove = 1;
@@ -773,21 +1088,17 @@ void Free_Eventinfo(Eventinfo *lf)
         free(lf->comment);
     }
 
+    os_free(lf->literal_matches);
+
     if (lf->full_log) {
         free(lf->full_log);
     }
 
-    if (lf->agent_id) {
-        free(lf->agent_id);
-    }
+    w_strpool_release(event_strings, lf->agent_id);
 
-    if (lf->location) {
-        free(lf->location);
-    }
+    w_strpool_release(event_strings, lf->location);
 
-    if (lf->hostname) {
-        free(lf->hostname);
-    }
+    w_strpool_release(event_strings, lf->hostname);
 
     if (lf->srcip) {
         free(lf->srcip);
@@ -856,8 +1167,6 @@ void Free_Eventinfo(Eventinfo *lf)
             free(lf->fields[i].key);
             free(lf->fields[i].value);
         }
-
-        free(lf->fields);
     }
 
     if (lf->previous) {
@@ -881,10 +1190,19 @@ void Free_Eventinfo(Eventinfo *lf)
         free(last_event);
     }
 
+    /* The rules and decoders of the event may belong to a retired ruleset */
+    w_ruleset_release(lf->ruleset);
+    lf->ruleset = NULL;
+
     /* We dont need to free:
      * fts
      * comment
      */
+    if (lf->pooled && lf->fields && w_release_event_info(lf)) {
+        return;
+    }
+
+    os_free(lf->fields);
     os_free(lf);
 
     return;
@@ -1002,17 +1320,11 @@ void w_copy_event_for_log(Eventinfo *lf,Eventinfo *lf_cpy){
     lf_cpy->log_after_prematch = lf->log_after_prematch;
     lf_cpy->generate_time = lf->generate_time;
 
-    if(lf->agent_id){
-        os_strdup(lf->agent_id,lf_cpy->agent_id);
-    }
+    lf_cpy->agent_id = w_strpool_ref(event_strings, lf->agent_id);
 
-    if(lf->location){
-        os_strdup(lf->location,lf_cpy->location);
-    }
+    lf_cpy->location = w_strpool_ref(event_strings, lf->location);
 
-    if(lf->hostname){
-        os_strdup(lf->hostname,lf_cpy->hostname);
-    }
+    lf_cpy->hostname = w_strpool_ref(event_strings, lf->hostname);
 
     if(lf->program_name){
         os_strdup(lf->program_name,lf_cpy->program_name);
@@ -1150,6 +1462,7 @@ void w_copy_event_for_log(Eventinfo *lf,Eventinfo *lf_cpy){
     lf_cpy->decoder_syscheck_id = lf->decoder_syscheck_id;
     lf_cpy->rootcheck_fts = lf->rootcheck_fts;
     lf_cpy->is_a_copy = 1;
+    lf_cpy->ruleset = w_ruleset_hold(lf->ruleset);
 }
 
 void w_free_event_info(Eventinfo *lf) {
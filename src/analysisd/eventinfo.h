@@ -23,6 +23,13 @@ typedef struct _DynamicField {
     char *value;
 } DynamicField;
 
+/* Place of an event in the sid index of a frequency rule */
+typedef struct _w_sid_index_entry_t {
+    OSList *bucket;         /* It isn't removed while the event is in it */
+    OSListNode *node;
+    char *key;              /* Key of the bucket, as it was when the event was added */
+} w_sid_index_entry_t;
+
 /* Event Information structure */
 typedef struct _Eventinfo {
     /* Extracted from the event */
@@ -66,6 +73,9 @@ typedef struct _Eventinfo {
     /* Sid node to delete */
     OSListNode *sid_node_to_delete;
 
+    /* Entries to delete from the sid indexes of the generated rule */
+    w_sid_index_entry_t *sid_index_entries;
+
     /* Group node to delete */
     OSListNode **group_node_to_delete;
 
@@ -86,6 +96,7 @@ typedef struct _Eventinfo {
     char *previous;
     wlabel_t *labels;
 
+    // Id of the internal decoder in the event ruleset, it overrides decoder_info->id
     u_int16_t decoder_syscheck_id;
     int rootcheck_fts;
     int is_a_copy;
@@ -101,6 +112,17 @@ typedef struct _Eventinfo {
     /* Pointer to the previous rule matched */
     void *prev_rule;
 
+    /* The structure and its fields array return to the event pool when freed */
+    int pooled;
+
+    /* Patterns of the ruleset literals set found in the log */
+    const OSMatchSet *literal_set;
+    const char *literal_log;
+    unsigned char *literal_matches;
+
+    /* Ruleset pinned by the event, it decodes and matches it */
+    struct w_ruleset_t *ruleset;
+
 } Eventinfo;
 
 /* Events List structure */
@@ -128,6 +150,9 @@ extern int full_output;
 extern int alert_only;
 #endif
 
+/* Pool for the agent ID, location and hostname of the events */
+extern w_strpool_t *event_strings;
+
 /* Types of events (from decoders) */
 #define UNKNOWN         0   /* Unknown */
 #define SYSLOG          1   /* syslog messages */
@@ -160,9 +185,55 @@ Eventinfo *Search_LastEvents(Eventinfo *my_lf, EventList *last_events, RuleInfo
 Eventinfo *Search_LastSids(Eventinfo *my_lf, EventList *last_events, RuleInfo *currently_rule, regex_matching *rule_match);
 Eventinfo *Search_LastGroups(Eventinfo *my_lf, EventList *last_events, RuleInfo *currently_rule, regex_matching *rule_match);
 
+/**
+ * @brief Index the events of an if_matched_sid rule by the values a frequency rule requires to be the same
+ *
+ * Nothing is done if the frequency rule doesn't require any value, it searches the whole list.
+ * @param parent rule whose events are stored in sid_prev_matched
+ * @param rule frequency rule with if_matched_sid
+ */
+void w_sid_index_init(RuleInfo *parent, RuleInfo *rule);
+
+/**
+ * @brief Add an event that was added to sid_prev_matched to the indexes of the rule
+ * @param parent rule that generated the event
+ * @param lf event to add
+ */
+void w_sid_index_add(RuleInfo *parent, Eventinfo *lf);
+
+/**
+ * @brief Free the index of a frequency rule
+ * @param rule frequency rule
+ */
+void w_sid_index_free(RuleInfo *rule);
+
+/**
+ * @brief Get the rule matching queue of an event
+ *
+ * The events of an agent always go to the same queue, so they are matched in order.
+ * The events of the manager are spread by their location instead.
+ * @param agent_id agent of the event
+ * @param location location of the event
+ * @param shards number of queues
+ * @return index of the queue
+ */
+size_t w_event_shard(const char * agent_id, const char * location, size_t shards);
+
+/* Maximum number of freed events kept for reuse */
+#define EVENTINFO_POOL_SIZE 1024
+
 /* Zero the eventinfo structure */
 void Zero_Eventinfo(Eventinfo *lf);
 
+/**
+ * @brief Get an event with a fields array of Config.decoder_order_size, initialized by Zero_Eventinfo
+ *
+ * Events released by Free_Eventinfo are reused, so decoder threads don't allocate
+ * the structure and its fields array for each message.
+ * @return event to fill, to be freed with Free_Eventinfo
+ */
+Eventinfo *w_alloc_event_info(void);
+
 /**
  * @brief Free the eventinfo structure
  * @param lf event to remove
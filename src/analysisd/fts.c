@@ -28,6 +28,9 @@ OSHash *os_analysisd_fts_store;
 static pthread_rwlock_t file_update_rwlock;
 static pthread_mutex_t fts_write_lock;
 
+/* Lock of fp_list, so writing it doesn't block the FTS lookups */
+static pthread_mutex_t fts_file_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /* Start the FTS module */
 int FTS_Init(int threads, OSList **fts_list, OSHash **fts_store)
 {
@@ -53,7 +56,7 @@ int FTS_Init(int threads, OSList **fts_list, OSHash **fts_store)
 
     /* Create store data */
     *fts_store = OSHash_Create();
-    if (!(*fts_store)) {
+    if (!(*fts_store) || !OSHash_SetConcurrent(*fts_store, OSHASH_STRIPES)) {
         merror(HASH_ERROR);
         return (0);
     }
@@ -129,6 +132,9 @@ int FTS_Init(int threads, OSList **fts_list, OSHash **fts_store)
         tmp_s = NULL;
     }
 
+    /* Only new entries are written from now on. Seeking before each write would flush the stream */
+    fseek(fp_list, 0, SEEK_END);
+
     /* Create ignore list */
     *fp_ignore = fopen(IG_QUEUE, "r+");
     if (!*fp_ignore) {
@@ -312,12 +318,14 @@ char * FTS(Eventinfo *lf, OSList **fts_list, OSHash **fts_store)
         return NULL;
     }
 
-    w_mutex_lock(&fts_write_lock);
-
     /* Check if from the last FTS events, we had at least 3 "similars" before.
      * If yes, we just ignore it.
+     * Only the list needs the lock, the store is thread safe and if two threads
+     * add the same entry the second one gets a duplicate.
      */
     if (lf->decoder_info->type == IDS) {
+        w_mutex_lock(&fts_write_lock);
+
         fts_node = OSList_GetLastNode(*fts_list);
         while (fts_node) {
             if (OS_StrHowClosedMatch((char *)fts_node->data, _line) >
@@ -359,7 +367,6 @@ char * FTS(Eventinfo *lf, OSList **fts_list, OSHash **fts_store)
         if (!line_for_list) {
             merror(MEM_ERROR, errno, strerror(errno));
             free(_line);
-            w_mutex_unlock(&fts_write_lock);
             return NULL;
         }
     }
@@ -368,24 +375,27 @@ char * FTS(Eventinfo *lf, OSList **fts_list, OSHash **fts_store)
         if (fts_node) OSList_DeleteThisNode(*fts_list, fts_node);
         free(line_for_list);
         free(_line);
-        w_mutex_unlock(&fts_write_lock);
+        if (lf->decoder_info->type == IDS) {
+            w_mutex_unlock(&fts_write_lock);
+        }
         return NULL;
     }
 
-    w_mutex_unlock(&fts_write_lock);
+    if (lf->decoder_info->type == IDS) {
+        w_mutex_unlock(&fts_write_lock);
+    }
     return _line;
 }
 
 void FTS_Fprintf(char * _line){
-    /* Save to fts fp */
-    w_mutex_lock(&fts_write_lock);
-    fseek(fp_list, 0, SEEK_END);
+    /* Save to fts fp. It's flushed by FTS_Flush */
+    w_mutex_lock(&fts_file_lock);
     fprintf(fp_list, "%s\n", _line);
-    w_mutex_unlock(&fts_write_lock);
+    w_mutex_unlock(&fts_file_lock);
 }
 
 void FTS_Flush(){
-    w_mutex_lock(&fts_write_lock);
+    w_mutex_lock(&fts_file_lock);
     fflush(fp_list);
-    w_mutex_unlock(&fts_write_lock);
+    w_mutex_unlock(&fts_file_lock);
 }
@@ -63,6 +63,7 @@ int Lists_OP_LoadList(char *listfile, ListNode **cdblists, OSList* log_msg)
 
     tmp_listnode_pt->loaded = 0;
     tmp_listnode_pt->mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+    tmp_listnode_pt->cdb_lock = (pthread_rwlock_t) PTHREAD_RWLOCK_INITIALIZER;
 
     OS_AddList(tmp_listnode_pt, cdblists);
 
@@ -34,6 +34,7 @@ typedef struct ListNode {
     struct cdb cdb;
     struct ListNode *next;
     pthread_mutex_t mutex;
+    pthread_rwlock_t cdb_lock; ///< Held for reading by the lookups, for writing to swap the cdb
 } ListNode;
 
 /**
@@ -116,6 +117,13 @@ ListNode *OS_FindList(const char *listname, ListNode **l_node);
  */
 void Lists_OP_CreateLists(void);
 
+/**
+ * @brief Close the cdb of a list, the next lookup opens the file again
+ * @details Waits for the lookups in progress. Used once the cdb file has been replaced.
+ * @param lnode list to reload
+ */
+void OS_ReloadList(ListNode *lnode);
+
 /**
  * @brief Remove a list of cdb lists
  * @param l_node list to remove
@@ -121,199 +121,196 @@ ListRule *OS_AddListRule(ListRule *first_rule_list, int lookup_type, int field,
 static int _OS_CDBOpen(ListNode *lnode)
 {
     int fd;
+    int result = 0;
+
+    w_mutex_lock(&lnode->mutex);
     if (lnode->loaded != 1) {
         if ((fd = open(lnode->cdb_filename, O_RDONLY)) == -1) {
             merror(OPEN_ERROR, lnode->cdb_filename, errno, strerror (errno));
-            return -1;
+            result = -1;
+        } else {
+            cdb_init(&lnode->cdb, fd);
+            lnode->loaded = 1;
         }
-        cdb_init(&lnode->cdb, fd);
-        lnode->loaded = 1;
     }
-    return 0;
+    w_mutex_unlock(&lnode->mutex);
+
+    return result;
 }
 
-static int OS_DBSearchKeyValue(ListRule *lrule, char *key)
+/* Look for an address or for the longest of its subnets ("10.0.0.", "10.0.", "10.")
+ * The subnets are looked up as prefixes of the key, without copying it.
+ * Returns 1 if found, 0 otherwise
+ */
+static int _OS_CDBFindAddress(ListNode *lnode, char *key, uint32 *dpos, uint32 *dlen)
 {
-    int result = -1;
-    char *val;
-    unsigned vlen, vpos;
-    w_mutex_lock(&lrule->mutex);
-    if (lrule->db != NULL) {
-        if (_OS_CDBOpen(lrule->db) == -1) {
-            w_mutex_unlock(&lrule->mutex);
-            return 0;
-        }
-        if (cdb_find(&lrule->db->cdb, key, strlen(key)) > 0 ) {
-            vpos = cdb_datapos(&lrule->db->cdb);
-            vlen = cdb_datalen(&lrule->db->cdb);
-            val = (char *) calloc(vlen + 1, sizeof(char));
-
-            w_mutex_unlock(&lrule->mutex);
-            if (!val){
-                return 0;
-            }
+    size_t len = strlen(key);
 
-            w_mutex_lock(&lrule->db->cdb.mutex)
-            cdb_read(&lrule->db->cdb, val, vlen, vpos);
-            w_mutex_unlock(&lrule->db->cdb.mutex);
-            result = OSMatch_Execute(val, vlen, lrule->matcher);
-            free(val);
-            return result;
-        } else {
-            w_mutex_unlock(&lrule->mutex);
-            return 0;
+    /* First lookup for a single IP address */
+    if (cdb_lookup(&lnode->cdb, key, len, dpos, dlen) > 0) {
+        return 1;
+    }
+
+    /* IP address not found, look for matching subnets */
+    for (; len > 0; len--) {
+        if (key[len - 1] == '.' && cdb_lookup(&lnode->cdb, key, len, dpos, dlen) > 0) {
+            return 1;
         }
     }
-    w_mutex_unlock(&lrule->mutex);
+
     return 0;
 }
 
-static int OS_DBSeachKey(ListRule *lrule, char *key)
+/* Match the value of a key found in the list */
+static int _OS_CDBMatchValue(ListNode *lnode, OSMatch *matcher, uint32 dpos, uint32 dlen)
 {
-    w_mutex_lock(&lrule->mutex);
-    if (lrule->db != NULL) {
-        if (_OS_CDBOpen(lrule->db) == -1) {
-            w_mutex_unlock(&lrule->mutex);
-            return -1;
-        }
-        w_mutex_unlock(&lrule->mutex);
-        if ( cdb_find(&lrule->db->cdb, key, strlen(key)) > 0 ) {
-            return 1;
-        }
-    }else {
-        w_mutex_unlock(&lrule->mutex);
+    char *val;
+    int result;
+
+    os_calloc(dlen + 1, sizeof(char), val);
+
+    /* Reading from the descriptor moves the file offset */
+    if (!lnode->cdb.map) {
+        w_mutex_lock(&lnode->cdb.mutex);
     }
-    return 0;
+    result = cdb_read(&lnode->cdb, val, dlen, dpos);
+    if (!lnode->cdb.map) {
+        w_mutex_unlock(&lnode->cdb.mutex);
+    }
+
+    result = result == 0 ? OSMatch_Execute(val, dlen, matcher) : 0;
+    free(val);
+
+    return result;
 }
 
-static int OS_DBSeachKeyAddress(ListRule *lrule, char *key)
+static int OS_DBSearchKeyValue(ListRule *lrule, ListNode *lnode, char *key)
 {
-    w_mutex_lock(&lrule->mutex);
-    if (lrule->db != NULL) {
-        if (_OS_CDBOpen(lrule->db) == -1) {
-            w_mutex_unlock(&lrule->mutex);
-            return -1;
-        }
-        w_mutex_unlock(&lrule->mutex);
-        if ( cdb_find(&lrule->db->cdb, key, strlen(key)) > 0 ) {
-            return 1;
-        } else {
-            char *tmpkey;
-            os_strdup(key, tmpkey);
-            while (strlen(tmpkey) > 0) {
-                if (tmpkey[strlen(tmpkey) - 1] == '.') {
-                    if ( cdb_find(&lrule->db->cdb, tmpkey, strlen(tmpkey)) > 0 ) {
-                        free(tmpkey);
-                        return 1;
-                    }
-                }
-                tmpkey[strlen(tmpkey) - 1] = '\0';
-            }
-            free(tmpkey);
-        }
-    }else{
-        w_mutex_unlock(&lrule->mutex);
+    uint32 dpos;
+    uint32 dlen;
+
+    if (lnode == NULL || _OS_CDBOpen(lnode) == -1) {
+        return 0;
+    }
+
+    if (cdb_lookup(&lnode->cdb, key, strlen(key), &dpos, &dlen) > 0) {
+        return _OS_CDBMatchValue(lnode, lrule->matcher, dpos, dlen);
     }
+
     return 0;
 }
 
-static int OS_DBSearchKeyAddressValue(ListRule *lrule, char *key)
+static int OS_DBSeachKey(ListNode *lnode, char *key)
 {
-    int result = -1;
-    char *val;
-    unsigned vlen, vpos;
-    w_mutex_lock(&lrule->mutex);
-    if (lrule->db != NULL) {
-        if (_OS_CDBOpen(lrule->db) == -1) {
-            w_mutex_unlock(&lrule->mutex);
-            return 0;
-        }
+    uint32 dpos;
+    uint32 dlen;
 
-        w_mutex_unlock(&lrule->mutex);
-
-        /* First lookup for a single IP address */
-        if (cdb_find(&lrule->db->cdb, key, strlen(key)) > 0 ) {
-            vpos = cdb_datapos(&lrule->db->cdb);
-            vlen = cdb_datalen(&lrule->db->cdb);
-            os_calloc(vlen, sizeof(char), val);
-            w_mutex_lock(&lrule->db->cdb.mutex)
-            cdb_read(&lrule->db->cdb, val, vlen, vpos);
-            w_mutex_unlock(&lrule->db->cdb.mutex)
-            result = OSMatch_Execute(val, vlen, lrule->matcher);
-            free(val);
-            return result;
-        } else {
-            /* IP address not found, look for matching subnets */
-            char *tmpkey;
-            os_strdup(key, tmpkey);
-            while (strlen(tmpkey) > 0) {
-                if (tmpkey[strlen(tmpkey) - 1] == '.') {
-                    if ( cdb_find(&lrule->db->cdb, tmpkey, strlen(tmpkey)) > 0 ) {
-                        vpos = cdb_datapos(&lrule->db->cdb);
-                        vlen = cdb_datalen(&lrule->db->cdb);
-                        os_calloc(vlen, sizeof(char), val);
-                        w_mutex_lock(&lrule->db->cdb.mutex)
-                        cdb_read(&lrule->db->cdb, val, vlen, vpos);
-                        w_mutex_unlock(&lrule->db->cdb.mutex)
-                        result = OSMatch_Execute(val, vlen, lrule->matcher);
-                        free(val);
-                        free(tmpkey);
-                        return result;
-                    }
-                }
-                tmpkey[strlen(tmpkey) - 1] = '\0';
-            }
-            free(tmpkey);
-            return 0;
-        }
-    }else{
-        w_mutex_unlock(&lrule->mutex);
+    if (lnode == NULL) {
+        return 0;
+    }
+
+    if (_OS_CDBOpen(lnode) == -1) {
+        return -1;
+    }
+
+    return cdb_lookup(&lnode->cdb, key, strlen(key), &dpos, &dlen) > 0;
+}
+
+static int OS_DBSeachKeyAddress(ListNode *lnode, char *key)
+{
+    uint32 dpos;
+    uint32 dlen;
+
+    if (lnode == NULL) {
+        return 0;
+    }
+
+    if (_OS_CDBOpen(lnode) == -1) {
+        return -1;
+    }
+
+    return _OS_CDBFindAddress(lnode, key, &dpos, &dlen);
+}
+
+static int OS_DBSearchKeyAddressValue(ListRule *lrule, ListNode *lnode, char *key)
+{
+    uint32 dpos;
+    uint32 dlen;
+
+    if (lnode == NULL || _OS_CDBOpen(lnode) == -1) {
+        return 0;
+    }
+
+    if (_OS_CDBFindAddress(lnode, key, &dpos, &dlen) > 0) {
+        return _OS_CDBMatchValue(lnode, lrule->matcher, dpos, dlen);
     }
+
     return 0;
 }
 
 int OS_DBSearch(ListRule *lrule, char *key, ListNode **l_node)
 {
+    ListNode *db;
+    int result;
+
     //XXX - god damn hack!!! Jeremy Rossi
     w_mutex_lock(&lrule->mutex);
     if (lrule->loaded == 0) {
         lrule->db = OS_FindList(lrule->filename, l_node);
         lrule->loaded = 1;
     }
+    db = lrule->db;
     w_mutex_unlock(&lrule->mutex);
 
+    /* The cdb can't be swapped during the lookup */
+    if (db) {
+        w_rwlock_rdlock(&db->cdb_lock);
+    }
+
     switch (lrule->lookup_type) {
         case LR_STRING_MATCH:
-            if (OS_DBSeachKey(lrule, key) == 1) {
-                return 1;
-            }
-            return 0;
+            result = OS_DBSeachKey(db, key) == 1;
+            break;
         case LR_STRING_NOT_MATCH:
-            if (OS_DBSeachKey(lrule, key) == 1) {
-                return 0;
-            }
-            return 1;
+            result = OS_DBSeachKey(db, key) != 1;
+            break;
         case LR_STRING_MATCH_VALUE:
-            if (OS_DBSearchKeyValue(lrule, key) == 1) {
-                return 1;
-            }
-            return 0;
+            result = OS_DBSearchKeyValue(lrule, db, key) == 1;
+            break;
         case LR_ADDRESS_MATCH:
-            return OS_DBSeachKeyAddress(lrule, key) == 1;
+            result = OS_DBSeachKeyAddress(db, key) == 1;
+            break;
         case LR_ADDRESS_NOT_MATCH:
-            if (OS_DBSeachKeyAddress(lrule, key) == 0) {
-                return 1;
-            }
-            return 0;
+            result = OS_DBSeachKeyAddress(db, key) == 0;
+            break;
         case LR_ADDRESS_MATCH_VALUE:
-            if (OS_DBSearchKeyAddressValue(lrule, key) == 0) {
-                return 1;
-            }
-            return 0;
+            result = OS_DBSearchKeyAddressValue(lrule, db, key) == 0;
+            break;
         default:
             mdebug1("lists_list.c::OS_DBSearch should never hit default");
-            return 0;
+            result = 0;
     }
+
+    if (db) {
+        w_rwlock_unlock(&db->cdb_lock);
+    }
+
+    return result;
+}
+
+void OS_ReloadList(ListNode *lnode) {
+
+    w_rwlock_wrlock(&lnode->cdb_lock);
+    w_mutex_lock(&lnode->mutex);
+
+    if (lnode->loaded == 1) {
+        cdb_free(&lnode->cdb);
+        close(lnode->cdb.fd);
+        lnode->loaded = 0;
+    }
+
+    w_mutex_unlock(&lnode->mutex);
+    w_rwlock_unlock(&lnode->cdb_lock);
 }
 
 void os_remove_cdblist(ListNode **l_node) {
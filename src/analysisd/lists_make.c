@@ -19,17 +19,92 @@
 #include "lists_make.h"
 
 
-void Lists_OP_MakeAll(int force, int show_message, ListNode **lnode) {
+/* Lists to build, shared by the builder threads */
+typedef struct {
+    ListNode *next;
+    int force;
+    int show_message;
+    int reload;
+    pthread_mutex_t mutex;
+} lists_make_t;
+
+static int lists_make_threads = 1;
+
+void Lists_OP_MakeThreads(int threads) {
+    lists_make_threads = threads > 0 ? threads : 1;
+}
+
+static void *Lists_OP_MakeWorker(void *arg) {
 
-    ListNode *tmp = *lnode;
+    lists_make_t *state = arg;
+    ListNode *node;
 
-    while (tmp) {
-        Lists_OP_MakeCDB(tmp->txt_filename, tmp->cdb_filename, force, show_message);
-        tmp = tmp->next;
+    while (1) {
+        w_mutex_lock(&state->mutex);
+        if (node = state->next, node) {
+            state->next = node->next;
+        }
+        w_mutex_unlock(&state->mutex);
+
+        if (!node) {
+            break;
+        }
+
+        if (Lists_OP_MakeCDB(node->txt_filename, node->cdb_filename, state->force, state->show_message) == 1 &&
+                state->reload) {
+            OS_ReloadList(node);
+            mdebug1("CDB list '%s' reloaded.", node->cdb_filename);
+        }
     }
+
+    return NULL;
 }
 
-void Lists_OP_MakeCDB(const char *txt_filename, const char *cdb_filename, const int force, const int show_message)
+/* Build the lists with up to lists_make_threads threads, the calling one included */
+static void Lists_OP_MakeLists(ListNode *lnode, int force, int show_message, int reload) {
+
+    lists_make_t state = { .next = lnode, .force = force, .show_message = show_message, .reload = reload,
+                           .mutex = PTHREAD_MUTEX_INITIALIZER };
+    pthread_t *workers = NULL;
+    int count = 0;
+    int i;
+
+    for (ListNode *tmp = lnode; tmp && count < lists_make_threads; tmp = tmp->next) {
+        count++;
+    }
+
+    if (count > 1) {
+        os_calloc(count - 1, sizeof(pthread_t), workers);
+
+        for (i = 0; i < count - 1; i++) {
+            if (pthread_create(&workers[i], NULL, Lists_OP_MakeWorker, &state) != 0) {
+                merror(THREAD_ERROR);
+                break;
+            }
+        }
+        count = i;
+    } else {
+        count = 0;
+    }
+
+    Lists_OP_MakeWorker(&state);
+
+    for (i = 0; i < count; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    os_free(workers);
+}
+
+void Lists_OP_MakeAll(int force, int show_message, ListNode **lnode) {
+    Lists_OP_MakeLists(*lnode, force, show_message, 0);
+}
+
+void Lists_OP_ReloadAll(ListNode **lnode) {
+    Lists_OP_MakeLists(*lnode, 0, 0, 1);
+}
+
+int Lists_OP_MakeCDB(const char *txt_filename, const char *cdb_filename, const int force, const int show_message)
 {
     struct cdb_make cdbm;
     FILE *tmp_fd;
@@ -38,26 +113,33 @@ void Lists_OP_MakeCDB(const char *txt_filename, const char *cdb_filename, const
     char *key, *val;
     char str[OS_MAXSTR + 1];
     char *value_begin;
+    int tmp_desc;
 
     str[OS_MAXSTR] = '\0';
     char tmp_filename[OS_MAXSTR];
     tmp_filename[OS_MAXSTR - 2] = '\0';
-    snprintf(tmp_filename, OS_MAXSTR - 2, "%s.tmp", txt_filename);
+    /* Unique, next to the cdb: the lookups keep reading the previous one until it's replaced */
+    snprintf(tmp_filename, OS_MAXSTR - 2, "%s.XXXXXX", cdb_filename);
 
     if (File_DateofChange(txt_filename) > File_DateofChange(cdb_filename) ||
             force) {
     	if (show_message){
             printf(" * CDB list %s has been updated successfully\n", cdb_filename);
         }
-        if (tmp_fd = fopen(tmp_filename, "w+"), !tmp_fd) {
-            merror(FOPEN_ERROR, tmp_filename, errno, strerror(errno));
-            return;
-        }
-        cdb_make_start(&cdbm, tmp_fd);
         if (!(txt_fd = fopen(txt_filename, "r"))) {
             merror(FOPEN_ERROR, txt_filename, errno, strerror(errno));
-            return;
+            return -1;
         }
+        if (tmp_desc = mkstemp(tmp_filename), tmp_desc < 0 || !(tmp_fd = fdopen(tmp_desc, "w+"))) {
+            merror(FOPEN_ERROR, tmp_filename, errno, strerror(errno));
+            if (tmp_desc >= 0) {
+                close(tmp_desc);
+                unlink(tmp_filename);
+            }
+            fclose(txt_fd);
+            return -1;
+        }
+        cdb_make_start(&cdbm, tmp_fd);
         while ((fgets(str, OS_MAXSTR - 1, txt_fd)) != NULL) {
             /* Remove newlines and carriage returns */
             tmp_str = strchr(str, '\r');
@@ -145,16 +227,27 @@ void Lists_OP_MakeCDB(const char *txt_filename, const char *cdb_filename, const
 
         fclose(txt_fd);
 
-        cdb_make_finish(&cdbm);
+        if (cdb_make_finish(&cdbm) != 0) {
+            merror("Could not write cdb list '%s' due to: [%d - %s]", tmp_filename, errno, strerror(errno));
+            fclose(tmp_fd);
+            unlink(tmp_filename);
+            return -1;
+        }
+        if (fchmod(tmp_desc, 0660) == -1) {
+            merror("Could not chmod cdb list '%s' to 660 due to: [%d - %s]", tmp_filename, errno, strerror(errno));
+        }
+        fclose(tmp_fd);
+
         if (rename(tmp_filename, cdb_filename) == -1) {
             merror(RENAME_ERROR, tmp_filename, cdb_filename, errno, strerror(errno));
-            return;
-        }
-        if( chmod(cdb_filename, 0660) == -1 ) {
-            merror("Could not chmod cdb list '%s' to 660 due to: [%d - %s]", cdb_filename, errno, strerror(errno));
-            return;
+            unlink(tmp_filename);
+            return -1;
         }
+
+        return 1;
     } else if(show_message){
         printf(" * CDB list %s is up-to-date\n", cdb_filename);
     }
+
+    return 0;
 }
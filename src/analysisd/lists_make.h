@@ -13,12 +13,20 @@
 
 /**
  * @brief Compile a CDB list
+ * @details The list is written to a temporary file, then renamed to cdb_filename.
  * @param txt_filename File which has the CDB list
  * @param cdb_filename File which saves the CDB list compile
  * @param force determine if overwrite cdb_filename although txt_filename haven't changed
  * @show_message determine if print  '* CDB list %s has been updated successfully' message
+ * @return 1 if the list was compiled, 0 if it was up to date, -1 on error
  */
-void Lists_OP_MakeCDB(const char *txt_filename, const char *cdb_filename, const int force, const int show_message);
+int Lists_OP_MakeCDB(const char *txt_filename, const char *cdb_filename, const int force, const int show_message);
+
+/**
+ * @brief Set the number of threads compiling the CDB lists
+ * @param threads number of threads, 1 compiles them one by one
+ */
+void Lists_OP_MakeThreads(int threads);
 
 /**
  * @brief Call the Lists_OP_MakeCDB function for each CDB list.
@@ -28,4 +36,10 @@ void Lists_OP_MakeCDB(const char *txt_filename, const char *cdb_filename, const
  */
 void Lists_OP_MakeAll(int force, int show_message, ListNode **lnode);
 
+/**
+ * @brief Compile the outdated CDB lists and swap them while they are in use.
+ * @param lnode list of CDB lists
+ */
+void Lists_OP_ReloadAll(ListNode **lnode);
+
 #endif /* LISTSMAKE_H */
@@ -12,6 +12,28 @@
 
 
 OSHash *w_logtest_sessions;
+w_logtest_ruleset_t *w_logtest_ruleset;
+
+static pthread_mutex_t w_logtest_ruleset_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Add the messages of the loading of a ruleset to the ones of a request */
+static void w_logtest_ruleset_report(const w_logtest_ruleset_t * ruleset, OSList * list_msg) {
+
+    for (OSListNode * node = ruleset->load_msg->first_node; node; node = node->next) {
+        os_analysisd_log_msg_t * msg = node->data;
+        _os_analysisd_add_logmsg(list_msg, msg->level, msg->line, msg->func, msg->file, "%s", msg->msg);
+    }
+}
+
+/* Append a string to the stamp of a ruleset */
+static void w_logtest_stamp_append(char ** stamp, size_t * size, const char * str) {
+
+    size_t length = strlen(str);
+
+    os_realloc(*stamp, *size + length + 1, *stamp);
+    memcpy(*stamp + *size, str, length + 1);
+    *size += length;
+}
 
 
 void *w_logtest_init() {
@@ -214,7 +236,7 @@ cJSON * w_logtest_process_log(cJSON * request, w_logtest_session_t * session,
     /* Add alert description to the event and check alert level if exist a match */
     if (lf->generated_rule) {
         lf->comment = ParseRuleComment(lf);
-        extra_data->alert_generated = ((check_add_event == 1) && session->logbylevel <= lf->generated_rule->level);
+        extra_data->alert_generated = ((check_add_event == 1) && session->ruleset->logbylevel <= lf->generated_rule->level);
     }
 
     /* Parse the alert */
@@ -290,9 +312,9 @@ void w_logtest_decoding_phase(Eventinfo * lf, w_logtest_session_t * session) {
     OSDecoderNode * decodernode = NULL;
 
     if (lf->program_name) {
-        decodernode = session->decoderlist_forpname;
+        decodernode = session->ruleset->decoderlist_forpname;
     } else {
-        decodernode = session->decoderlist_nopname;
+        decodernode = session->ruleset->decoderlist_nopname;
     }
 
     DecodeEvent(lf, session->g_rules_hash, &session->decoder_match, decodernode);
@@ -303,6 +325,7 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
                                   cJSON * rules_debug_list,
                                   OSList * list_msg) {
     RuleNode * rulenode = NULL;
+    RuleNode ** candidates = NULL;
     RuleInfo * ruleinformation = NULL;
     bool added_list_event = false;
 
@@ -310,7 +333,8 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
         return -1;
     }
 
-    do {
+    for (rulenode = OS_FirstRuleCandidate(rulenode, lf, rules_debug_list != NULL, &candidates); rulenode;
+         rulenode = OS_NextRuleCandidate(rulenode, &candidates)) {
 
         if (lf->decoder_info->type == OSSEC_ALERT && !lf->generated_rule) {
             break;
@@ -323,7 +347,7 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
 
         /* Search the rule that match */
         ruleinformation = OS_CheckIfRuleMatch(lf, session->eventlist,
-                                              &session->cdblistnode, rulenode,
+                                              &session->ruleset->cdblistnode, rulenode,
                                               &session->rule_match,
                                               &session->fts_list,
                                               &session->fts_store, false,
@@ -366,6 +390,7 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
                 smerror(list_msg, "Unable to add data to sig list.");
             } else {
                 lf->sid_node_to_delete = ruleinformation->sid_prev_matched->last_node;
+                w_sid_index_add(ruleinformation, lf);
             }
         }
 
@@ -386,7 +411,7 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
         added_list_event = true;
         break;
 
-    } while(rulenode = rulenode->next, rulenode);
+    }
 
     return added_list_event ? 1 : 0;
 }
@@ -394,11 +419,8 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
 w_logtest_session_t * w_logtest_initialize_session(OSList * list_msg) {
 
     w_logtest_session_t * session = NULL;
-    _Config ruleset_config = {0};
     bool retval = true;
 
-    char ** files = NULL;
-
     /*Generate session token*/
     char *token = w_logtest_generate_token();
 
@@ -419,71 +441,22 @@ w_logtest_session_t * w_logtest_initialize_session(OSList * list_msg) {
     os_calloc(1, sizeof(EventList), session->eventlist);
     OS_CreateEventList(Config.memorysize, session->eventlist);
 
-    /* Get ruleset files */
-    if (!w_logtest_ruleset_load(&ruleset_config, list_msg)) {
-        goto cleanup;
-    }
-
-    /* Load decoders */
-    session->decoderlist_forpname = NULL;
-    session->decoderlist_nopname = NULL;
-    session->decoder_store = NULL;
-
-    files = ruleset_config.decoders;
-
-    while (files != NULL && *files != NULL) {
-        if (ReadDecodeXML(*files, &session->decoderlist_forpname,
-            &session->decoderlist_nopname, &session->decoder_store, list_msg) == 0) {
-            goto cleanup;
-        }
-        files++;
-    }
-
-    if (SetDecodeXML(list_msg, &session->decoder_store, &session->decoderlist_nopname,
-                     &session->decoderlist_forpname) == 0) {
+    /* Get the decoders, CDB lists and rules */
+    if (session->ruleset = w_logtest_ruleset_acquire(list_msg), !session->ruleset) {
         goto cleanup;
     }
 
-    /* Load CDB list */
-    session->cdblistnode = NULL;
-    session->cdblistrule = NULL;
-
-    files = ruleset_config.lists;
-
-    while (files != NULL && *files != NULL) {
-        if (Lists_OP_LoadList(*files, &session->cdblistnode, list_msg) < 0) {
-            goto cleanup;
-        }
-        files++;
-    }
-
-    Lists_OP_MakeAll(0, 0, &session->cdblistnode);
-
-    /* Load rules */
-    session->rule_list = NULL;
+    session->eventlist->_max_freq = session->ruleset->max_freq;
 
-    files = ruleset_config.includes;
-
-    while (files != NULL && *files != NULL) {
-        if (Rules_OP_ReadRules(*files, &session->rule_list, &session->cdblistnode,
-                            &session->eventlist, &session->decoder_store, list_msg) < 0) {
-            goto cleanup;
-        }
-        files++;
-    }
-
-    /* Associate rules and CDB lists */
-    OS_ListLoadRules(&session->cdblistnode, &session->cdblistrule);
-
-    /* _setlevels */
-    _setlevels(session->rule_list, 0);
+    /* Clone the rules, they keep the correlation state */
+    session->rule_list = os_clone_rules_list(session->ruleset->rule_list);
 
     /* Creating rule hash */
     if (session->g_rules_hash = OSHash_Create(), !session->g_rules_hash) {
         goto cleanup;
     }
 
-    AddHash_Rule(session->rule_list);
+    AddHash_Rule(session->g_rules_hash, session->rule_list);
 
     /* Initiate the FTS list */
     if (!w_logtest_fts_init(&session->fts_list, &session->fts_store)) {
@@ -499,9 +472,6 @@ w_logtest_session_t * w_logtest_initialize_session(OSList * list_msg) {
     memset(&session->decoder_match, 0, sizeof(regex_matching));
     memset(&session->rule_match, 0, sizeof(regex_matching));
 
-    /* Set custom level for alerts */
-    session->logbylevel = ruleset_config.logbylevel;
-
     retval = false;
 
 cleanup:
@@ -517,15 +487,8 @@ cleanup:
             OSHash_Free(session->g_rules_hash);
         }
 
-        /* Remove decoder lists */
-        os_remove_decoders_list(session->decoderlist_forpname, session->decoderlist_nopname);
-        if (session->decoder_store != NULL) {
-            OSStore_Free(session->decoder_store);
-        }
-
-        /* Remove cdblistnode and cdblistrule */
-        os_remove_cdblist(&session->cdblistnode);
-        os_remove_cdbrules(&session->cdblistrule);
+        /* Release the ruleset */
+        w_logtest_ruleset_release(session->ruleset);
 
         /* Remove fts list and hash */
         if (session->fts_store) {
@@ -547,7 +510,6 @@ cleanup:
         os_free(token);
         os_free(session);
     }
-    w_logtest_ruleset_free_config(&ruleset_config);
 
     return session;
 }
@@ -572,13 +534,8 @@ void w_logtest_remove_session(char *token) {
     os_remove_rules_list(session->rule_list);
     OSHash_Free(session->g_rules_hash);
 
-    /* Remove decoder lists */
-    os_remove_decoders_list(session->decoderlist_forpname, session->decoderlist_nopname);
-    OSStore_Free(session->decoder_store);
-
-    /* Remove cdblistnode and cdblistrule */
-    os_remove_cdblist(&session->cdblistnode);
-    os_remove_cdbrules(&session->cdblistrule);
+    /* Release the ruleset */
+    w_logtest_ruleset_release(session->ruleset);
 
     /* Remove fts list and hash */
     OSHash_Free(session->fts_store);
@@ -602,6 +559,198 @@ void w_logtest_remove_session(char *token) {
 }
 
 
+w_logtest_ruleset_t *w_logtest_ruleset_acquire(OSList * list_msg) {
+
+    w_logtest_ruleset_t * ruleset = NULL;
+    w_logtest_ruleset_t * old_ruleset = NULL;
+    _Config ruleset_config = {0};
+    char * stamp = NULL;
+
+    /* Get ruleset files */
+    if (!w_logtest_ruleset_load(&ruleset_config, list_msg)) {
+        w_logtest_ruleset_free_config(&ruleset_config);
+        return NULL;
+    }
+
+    /* A ruleset whose files can't be checked is only used by this session */
+    if (stamp = w_logtest_ruleset_stamp(&ruleset_config), !stamp) {
+        ruleset = w_logtest_ruleset_build(&ruleset_config, list_msg);
+    } else {
+        w_mutex_lock(&w_logtest_ruleset_mutex);
+
+        if (w_logtest_ruleset && strcmp(w_logtest_ruleset->stamp, stamp) == 0) {
+            ruleset = w_logtest_ruleset;
+            __atomic_add_fetch(&ruleset->references, 1, __ATOMIC_RELAXED);
+        } else if (ruleset = w_logtest_ruleset_build(&ruleset_config, list_msg), ruleset) {
+            ruleset->stamp = stamp;
+            ruleset->references++;
+            stamp = NULL;
+
+            old_ruleset = w_logtest_ruleset;
+            w_logtest_ruleset = ruleset;
+        }
+
+        w_mutex_unlock(&w_logtest_ruleset_mutex);
+    }
+
+    /* The sessions created before keep the old ruleset until they are removed */
+    w_logtest_ruleset_release(old_ruleset);
+
+    if (ruleset) {
+        w_logtest_ruleset_report(ruleset, list_msg);
+    }
+
+    os_free(stamp);
+    w_logtest_ruleset_free_config(&ruleset_config);
+
+    return ruleset;
+}
+
+
+void w_logtest_ruleset_release(w_logtest_ruleset_t * ruleset) {
+
+    if (ruleset && __atomic_sub_fetch(&ruleset->references, 1, __ATOMIC_ACQ_REL) == 0) {
+        w_logtest_ruleset_free(ruleset);
+    }
+}
+
+
+w_logtest_ruleset_t *w_logtest_ruleset_build(_Config * ruleset_config, OSList * list_msg) {
+
+    w_logtest_ruleset_t * ruleset = NULL;
+    EventList eventlist = {0};
+    EventList * p_eventlist = &eventlist;
+    char ** files = NULL;
+    bool retval = true;
+
+    os_calloc(1, sizeof(w_logtest_ruleset_t), ruleset);
+    ruleset->references = 1;
+
+    /* The messages are reported to every session that uses the ruleset */
+    if (ruleset->load_msg = OSList_Create(), !ruleset->load_msg) {
+        merror(LIST_ERROR);
+        os_free(ruleset);
+        return NULL;
+    }
+
+    OSList_SetMaxSize(ruleset->load_msg, ERRORLIST_MAXSIZE);
+    OSList_SetFreeDataPointer(ruleset->load_msg, (void (*)(void *))os_analysisd_free_log_msg);
+
+    /* Load decoders */
+    files = ruleset_config->decoders;
+
+    while (files != NULL && *files != NULL) {
+        if (ReadDecodeXML(*files, &ruleset->decoderlist_forpname,
+            &ruleset->decoderlist_nopname, &ruleset->decoder_store, ruleset->load_msg) == 0) {
+            goto cleanup;
+        }
+        files++;
+    }
+
+    if (SetDecodeXML(ruleset->load_msg, &ruleset->decoder_store, &ruleset->decoderlist_nopname,
+                     &ruleset->decoderlist_forpname) == 0) {
+        goto cleanup;
+    }
+
+    /* Load CDB list */
+    files = ruleset_config->lists;
+
+    while (files != NULL && *files != NULL) {
+        if (Lists_OP_LoadList(*files, &ruleset->cdblistnode, ruleset->load_msg) < 0) {
+            goto cleanup;
+        }
+        files++;
+    }
+
+    Lists_OP_MakeAll(0, 0, &ruleset->cdblistnode);
+
+    /* Load rules, the list of previous events only gets the highest frequency */
+    files = ruleset_config->includes;
+
+    while (files != NULL && *files != NULL) {
+        if (Rules_OP_ReadRules(*files, &ruleset->rule_list, &ruleset->cdblistnode,
+                            &p_eventlist, &ruleset->decoder_store, ruleset->load_msg) < 0) {
+            goto cleanup;
+        }
+        files++;
+    }
+
+    ruleset->max_freq = eventlist._max_freq;
+
+    /* Associate rules and CDB lists */
+    OS_ListLoadRules(&ruleset->cdblistnode, &ruleset->cdblistrule);
+
+    /* _setlevels */
+    _setlevels(ruleset->rule_list, 0);
+
+    /* Set custom level for alerts */
+    ruleset->logbylevel = ruleset_config->logbylevel;
+
+    retval = false;
+
+cleanup:
+
+    if (retval) {
+        w_logtest_ruleset_report(ruleset, list_msg);
+        w_logtest_ruleset_free(ruleset);
+        ruleset = NULL;
+    }
+
+    return ruleset;
+}
+
+
+void w_logtest_ruleset_free(w_logtest_ruleset_t * ruleset) {
+
+    /* Remove rule list */
+    os_remove_rules_list(ruleset->rule_list);
+
+    /* Remove decoder lists */
+    os_remove_decoders_list(ruleset->decoderlist_forpname, ruleset->decoderlist_nopname);
+    if (ruleset->decoder_store != NULL) {
+        OSStore_Free(ruleset->decoder_store);
+    }
+
+    /* Remove cdblistnode and cdblistrule */
+    os_remove_cdblist(&ruleset->cdblistnode);
+    os_remove_cdbrules(&ruleset->cdblistrule);
+
+    OSList_Destroy(ruleset->load_msg);
+    os_free(ruleset->stamp);
+    os_free(ruleset);
+}
+
+
+char *w_logtest_ruleset_stamp(const _Config * ruleset_config) {
+
+    char ** const sets[] = { ruleset_config->decoders, ruleset_config->lists, ruleset_config->includes };
+    char buffer[PATH_MAX + OS_SIZE_128];
+    struct stat file_stat;
+    char * stamp = NULL;
+    size_t size = 0;
+
+    snprintf(buffer, sizeof(buffer), "%u", ruleset_config->logbylevel);
+    w_logtest_stamp_append(&stamp, &size, buffer);
+
+    for (size_t i = 0; i < sizeof(sets) / sizeof(sets[0]); i++) {
+        w_logtest_stamp_append(&stamp, &size, "|");
+
+        for (char ** files = sets[i]; files && *files; files++) {
+            if (stat(*files, &file_stat) < 0) {
+                os_free(stamp);
+                return NULL;
+            }
+
+            snprintf(buffer, sizeof(buffer), "%s:%lu:%ld.%09ld:%ld;", *files, (unsigned long)file_stat.st_ino,
+                     (long)file_stat.st_mtim.tv_sec, (long)file_stat.st_mtim.tv_nsec, (long)file_stat.st_size);
+            w_logtest_stamp_append(&stamp, &size, buffer);
+        }
+    }
+
+    return stamp;
+}
+
+
 void *w_logtest_check_inactive_sessions(w_logtest_connection_t * connection) {
 
     OSHashNode *hash_node;
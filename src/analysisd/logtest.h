@@ -78,6 +78,27 @@
 #define valid_str_session(x,y) (cJSON_IsString(x) && x->valuestring && strlen(x->valuestring) == y) ? 1 : 0)
 
 
+/**
+ * @brief A w_logtest_ruleset_t instance is a compiled ruleset shared by the sessions
+ *
+ * It's read-only once loaded. The rules keep the correlation state, so the sessions match a clone of them.
+ */
+typedef struct w_logtest_ruleset_t {
+
+    RuleNode *rule_list;                    ///< Rule list, the sessions clone it
+    OSDecoderNode *decoderlist_forpname;    ///< Decoder list to match logs which have a program name
+    OSDecoderNode *decoderlist_nopname;     ///< Decoder list to match logs which haven't a program name
+    OSStore *decoder_store;                 ///< Decoder list to save internals decoders
+    ListNode *cdblistnode;                  ///< List of CDB lists
+    ListRule *cdblistrule;                  ///< List to attach rules and CDB lists
+    int max_freq;                           ///< Highest frequency of the rules, for the previous events list
+    u_int8_t logbylevel;                    ///< Custom severity level for generate alerts
+    OSList *load_msg;                       ///< Messages of the loading, reported to every session
+    char *stamp;                            ///< Files of the ruleset and their status, NULL if it can't be reused
+    unsigned int references;                ///< Sessions using it, plus one while it's the current ruleset
+
+} w_logtest_ruleset_t;
+
 /**
  * @brief A w_logtest_session_t instance represents a client
  */
@@ -87,12 +108,8 @@ typedef struct w_logtest_session_t {
     time_t last_connection;                 ///< Timestamp of the last query
     pthread_mutex_t mutex;                  ///< Prevent race condition between get a session and remove it
 
-    RuleNode *rule_list;                    ///< Rule list
-    OSDecoderNode *decoderlist_forpname;    ///< Decoder list to match logs which have a program name
-    OSDecoderNode *decoderlist_nopname;     ///< Decoder list to match logs which haven't a program name
-    OSStore *decoder_store;                 ///< Decoder list to save internals decoders
-    ListNode *cdblistnode;                  ///< List of CDB lists
-    ListRule *cdblistrule;                  ///< List to attach rules and CDB lists
+    w_logtest_ruleset_t *ruleset;           ///< Shared ruleset
+    RuleNode *rule_list;                    ///< Clone of the ruleset rules, with the correlation state
     EventList *eventlist;                   ///< Previous events list
     OSHash *g_rules_hash;                   ///< Hash table of rules
     OSList *fts_list;                       ///< Save FTS previous events
@@ -102,7 +119,6 @@ typedef struct w_logtest_session_t {
     time_t acm_purge_ts;                    ///< Counter of the time interval of last purge. Option accumulate
     regex_matching decoder_match;           ///< Used for decoding phase
     regex_matching rule_match;              ///< Used for rules matching phase
-    u_int8_t logbylevel;                    ///< Custom severity level for generate alerts 
 
 } w_logtest_session_t;
 
@@ -119,6 +135,11 @@ typedef struct {
  */
 extern OSHash *w_logtest_sessions;
 
+/**
+ * @brief Ruleset for the new sessions, while the files it was loaded from don't change
+ */
+extern w_logtest_ruleset_t *w_logtest_ruleset;
+
 /**
  * @brief An instance of w_logtest_connection allow managing the connections with the logtest socket
  */
@@ -209,6 +230,46 @@ int w_logtest_rulesmatching_phase(Eventinfo * lf, w_logtest_session_t * session,
  */
 w_logtest_session_t *w_logtest_initialize_session(OSList * list_msg);
 
+/**
+ * @brief Get a reference to the ruleset of the configuration
+ *
+ * The current ruleset is reused if its files haven't changed, otherwise a new one is loaded.
+ * @param list_msg list of \ref os_analysisd_log_msg_t for store messages
+ * @return NULL on failure, otherwise the ruleset, to be released with w_logtest_ruleset_release()
+ */
+w_logtest_ruleset_t *w_logtest_ruleset_acquire(OSList * list_msg);
+
+/**
+ * @brief Drop a reference to a ruleset, freeing it if it was the last one
+ * @param ruleset ruleset to release
+ */
+void w_logtest_ruleset_release(w_logtest_ruleset_t * ruleset);
+
+/**
+ * @brief Load the decoders, CDB lists and rules of a ruleset configuration
+ *
+ * The messages of the loading are kept in `load_msg`, or added to `list_msg` on failure.
+ * @param ruleset_config ruleset configuration
+ * @param list_msg list of \ref os_analysisd_log_msg_t for store messages
+ * @return NULL on failure, otherwise the ruleset with one reference
+ */
+w_logtest_ruleset_t *w_logtest_ruleset_build(_Config * ruleset_config, OSList * list_msg);
+
+/**
+ * @brief Frees a ruleset
+ * @param ruleset ruleset to free
+ */
+void w_logtest_ruleset_free(w_logtest_ruleset_t * ruleset);
+
+/**
+ * @brief Get the stamp of the files of a ruleset configuration
+ *
+ * It changes if any file is added, removed or modified, or if the alerts level changes.
+ * @param ruleset_config ruleset configuration
+ * @return NULL if a file can't be checked, otherwise the stamp
+ */
+char *w_logtest_ruleset_stamp(const _Config * ruleset_config);
+
 /**
  * @brief Frees resources after client closes connection
  * @param token client identifier
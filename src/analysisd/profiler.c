@@ -0,0 +1,322 @@
+/*
+ * Sampling profiler of the ruleset
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "profiler.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Cost of a rule or a decoder, keyed by its address. Freeing a retired ruleset resets the tables. */
+typedef struct w_profiler_entry_t {
+    uintptr_t key;
+    uint64_t samples;
+    uint64_t ticks;
+} w_profiler_entry_t;
+
+/* Tables of a thread. Only the thread writes them, readers merge them with relaxed loads. */
+typedef struct w_profiler_table_t {
+    w_profiler_entry_t rules[W_PROFILER_RULE_SLOTS];
+    w_profiler_entry_t decoders[W_PROFILER_DECODER_SLOTS];
+    unsigned int generation;
+    struct w_profiler_table_t * next;
+} w_profiler_table_t;
+
+__thread bool w_profiler_sampled;
+
+static unsigned int profiler_sampling;
+/* Bumped on reset: tables of an older generation are ignored until their thread clears them */
+static unsigned int profiler_generation;
+static w_profiler_table_t * profiler_tables;
+static pthread_mutex_t profiler_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Reference points to convert cycles into nanoseconds */
+static uint64_t profiler_start_ticks;
+static struct timespec profiler_start_time;
+
+static __thread w_profiler_table_t * t_table;
+static __thread unsigned int t_events;
+static __thread uint64_t t_children;
+static __thread const OSDecoderInfo * t_decoder;
+static __thread uint64_t t_decoder_start;
+
+uint64_t w_profiler_ticks(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+void w_profiler_init(void) {
+    w_profiler_set_sampling(getDefine_Int("analysisd", "profiler_sampling", 0, 1000000));
+}
+
+void w_profiler_set_sampling(unsigned int rate) {
+    w_mutex_lock(&profiler_mutex);
+
+    if (rate && !__atomic_load_n(&profiler_sampling, __ATOMIC_RELAXED)) {
+        profiler_start_ticks = w_profiler_ticks();
+        gettime(&profiler_start_time);
+    }
+
+    __atomic_store_n(&profiler_sampling, rate, __ATOMIC_RELAXED);
+    w_mutex_unlock(&profiler_mutex);
+
+    mdebug1("Ruleset profiler sampling rate set to %u.", rate);
+}
+
+unsigned int w_profiler_get_sampling(void) {
+    return __atomic_load_n(&profiler_sampling, __ATOMIC_RELAXED);
+}
+
+void w_profiler_reset(void) {
+    __atomic_add_fetch(&profiler_generation, 1, __ATOMIC_RELEASE);
+}
+
+/* Get the tables of the thread, registering them on the first sampled event */
+static w_profiler_table_t * w_profiler_table(void) {
+    unsigned int generation = __atomic_load_n(&profiler_generation, __ATOMIC_ACQUIRE);
+
+    if (!t_table) {
+        os_calloc(1, sizeof(w_profiler_table_t), t_table);
+        t_table->generation = generation;
+
+        w_mutex_lock(&profiler_mutex);
+        t_table->next = profiler_tables;
+        profiler_tables = t_table;
+        w_mutex_unlock(&profiler_mutex);
+    } else if (t_table->generation != generation) {
+        /* Readers skip the tables of an older generation, so they can be cleared unlocked */
+        memset(t_table->rules, 0, sizeof(t_table->rules));
+        memset(t_table->decoders, 0, sizeof(t_table->decoders));
+        __atomic_store_n(&t_table->generation, generation, __ATOMIC_RELEASE);
+    }
+
+    return t_table;
+}
+
+void w_profiler_sample_event(void) {
+    unsigned int rate = __atomic_load_n(&profiler_sampling, __ATOMIC_RELAXED);
+
+    w_profiler_sampled = rate && ++t_events % rate == 0;
+
+    if (w_profiler_sampled) {
+        w_profiler_table();
+        t_children = 0;
+        t_decoder = NULL;
+    }
+}
+
+/* Add a cost to the slot of key, probing linearly. Costs of a full table are dropped. */
+static void w_profiler_add(w_profiler_entry_t * entries, unsigned int slots, const void * key, uint64_t ticks) {
+    uintptr_t k = (uintptr_t)key;
+    unsigned int i = (unsigned int)((k >> 4) * 2654435761u) & (slots - 1);
+
+    for (unsigned int n = 0; n < slots; n++, i = (i + 1) & (slots - 1)) {
+        w_profiler_entry_t * entry = &entries[i];
+
+        if (entry->key == k) {
+            __atomic_store_n(&entry->samples, entry->samples + 1, __ATOMIC_RELAXED);
+            __atomic_store_n(&entry->ticks, entry->ticks + ticks, __ATOMIC_RELAXED);
+            return;
+        }
+
+        if (!entry->key) {
+            entry->samples = 1;
+            entry->ticks = ticks;
+            __atomic_store_n(&entry->key, k, __ATOMIC_RELEASE);
+            return;
+        }
+    }
+}
+
+void w_profiler_rule_enter(w_profiler_frame_t * frame) {
+    frame->children = t_children;
+    t_children = 0;
+    frame->start = w_profiler_ticks();
+}
+
+void w_profiler_rule_leave(w_profiler_frame_t * frame, const RuleInfo * rule) {
+    uint64_t elapsed = w_profiler_ticks() - frame->start;
+    uint64_t self = elapsed > t_children ? elapsed - t_children : 0;
+
+    w_profiler_add(w_profiler_table()->rules, W_PROFILER_RULE_SLOTS, rule, self);
+    t_children = frame->children + elapsed;
+}
+
+void w_profiler_decoder_next(const OSDecoderInfo * decoder) {
+    uint64_t now = w_profiler_ticks();
+
+    if (t_decoder) {
+        w_profiler_add(w_profiler_table()->decoders, W_PROFILER_DECODER_SLOTS, t_decoder, now - t_decoder_start);
+    }
+
+    t_decoder = decoder;
+    t_decoder_start = now;
+}
+
+static int w_profiler_cmp_key(const void * a, const void * b) {
+    uintptr_t x = ((const w_profiler_entry_t *)a)->key;
+    uintptr_t y = ((const w_profiler_entry_t *)b)->key;
+
+    return x < y ? -1 : x > y;
+}
+
+static int w_profiler_cmp_ticks(const void * a, const void * b) {
+    uint64_t x = ((const w_profiler_entry_t *)a)->ticks;
+    uint64_t y = ((const w_profiler_entry_t *)b)->ticks;
+
+    return x > y ? -1 : x < y;
+}
+
+/* Merge a table of every thread into a sorted array. Returns the number of entries. */
+static size_t w_profiler_merge(bool rules, w_profiler_entry_t ** merged) {
+    unsigned int slots = rules ? W_PROFILER_RULE_SLOTS : W_PROFILER_DECODER_SLOTS;
+    unsigned int generation = __atomic_load_n(&profiler_generation, __ATOMIC_ACQUIRE);
+    size_t count = 0;
+    size_t capacity = 0;
+    size_t j = 0;
+
+    *merged = NULL;
+
+    w_mutex_lock(&profiler_mutex);
+
+    for (w_profiler_table_t * table = profiler_tables; table; table = table->next) {
+        if (__atomic_load_n(&table->generation, __ATOMIC_ACQUIRE) != generation) {
+            continue;
+        }
+
+        const w_profiler_entry_t * entries = rules ? table->rules : table->decoders;
+
+        for (unsigned int i = 0; i < slots; i++) {
+            uintptr_t key = __atomic_load_n(&entries[i].key, __ATOMIC_ACQUIRE);
+
+            if (!key) {
+                continue;
+            }
+
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 256;
+                os_realloc(*merged, capacity * sizeof(w_profiler_entry_t), *merged);
+            }
+
+            (*merged)[count].key = key;
+            (*merged)[count].samples = __atomic_load_n(&entries[i].samples, __ATOMIC_RELAXED);
+            (*merged)[count].ticks = __atomic_load_n(&entries[i].ticks, __ATOMIC_RELAXED);
+            count++;
+        }
+    }
+
+    w_mutex_unlock(&profiler_mutex);
+
+    if (!count) {
+        return 0;
+    }
+
+    /* Add up the entries of the same key */
+    qsort(*merged, count, sizeof(w_profiler_entry_t), w_profiler_cmp_key);
+
+    for (size_t i = 1; i < count; i++) {
+        if ((*merged)[i].key == (*merged)[j].key) {
+            (*merged)[j].samples += (*merged)[i].samples;
+            (*merged)[j].ticks += (*merged)[i].ticks;
+        } else {
+            (*merged)[++j] = (*merged)[i];
+        }
+    }
+
+    count = j + 1;
+    qsort(*merged, count, sizeof(w_profiler_entry_t), w_profiler_cmp_ticks);
+
+    return count;
+}
+
+/* Fill in the costs of a row. ns_per_tick is 0 when it can't be estimated yet. */
+static void w_profiler_add_costs(cJSON * row, const w_profiler_entry_t * entry, double ns_per_tick) {
+    cJSON_AddNumberToObject(row, "samples", entry->samples);
+    cJSON_AddNumberToObject(row, "cycles", entry->ticks);
+    cJSON_AddNumberToObject(row, "avg_cycles", entry->ticks / entry->samples);
+
+    if (ns_per_tick > 0) {
+        cJSON_AddNumberToObject(row, "avg_ns", (uint64_t)(entry->ticks / entry->samples * ns_per_tick));
+    }
+}
+
+cJSON * w_profiler_json(unsigned int top) {
+    cJSON * root = cJSON_CreateObject();
+    cJSON * rules = cJSON_CreateArray();
+    cJSON * decoders = cJSON_CreateArray();
+    w_profiler_entry_t * entries;
+    double ns_per_tick = 0;
+    struct timespec now;
+    size_t count;
+
+    /* Cycles of the reference interval, it's worth it from a millisecond on */
+    w_mutex_lock(&profiler_mutex);
+
+    if (profiler_start_time.tv_sec) {
+        uint64_t ticks = w_profiler_ticks() - profiler_start_ticks;
+        gettime(&now);
+        double ns = (now.tv_sec - profiler_start_time.tv_sec) * 1e9 + (now.tv_nsec - profiler_start_time.tv_nsec);
+
+        if (ns >= 1e6 && ticks) {
+            ns_per_tick = ns / ticks;
+        }
+    }
+
+    w_mutex_unlock(&profiler_mutex);
+
+    cJSON_AddNumberToObject(root, "sampling", w_profiler_get_sampling());
+
+    count = w_profiler_merge(true, &entries);
+
+    for (size_t i = 0; i < count && i < top; i++) {
+        const RuleInfo * rule = (const RuleInfo *)entries[i].key;
+        cJSON * row = cJSON_CreateObject();
+
+        cJSON_AddNumberToObject(row, "id", rule->sigid);
+        cJSON_AddNumberToObject(row, "level", rule->level);
+
+        if (rule->comment) {
+            cJSON_AddStringToObject(row, "description", rule->comment);
+        }
+
+        w_profiler_add_costs(row, &entries[i], ns_per_tick);
+        cJSON_AddItemToArray(rules, row);
+    }
+
+    os_free(entries);
+    count = w_profiler_merge(false, &entries);
+
+    for (size_t i = 0; i < count && i < top; i++) {
+        const OSDecoderInfo * decoder = (const OSDecoderInfo *)entries[i].key;
+        cJSON * row = cJSON_CreateObject();
+
+        cJSON_AddStringToObject(row, "name", decoder->name);
+        w_profiler_add_costs(row, &entries[i], ns_per_tick);
+        cJSON_AddItemToArray(decoders, row);
+    }
+
+    os_free(entries);
+
+    cJSON_AddItemToObject(root, "rules", rules);
+    cJSON_AddItemToObject(root, "decoders", decoders);
+
+    return root;
+}
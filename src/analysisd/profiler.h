@@ -0,0 +1,114 @@
+/*
+ * Sampling profiler of the ruleset
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/**
+ * @file profiler.h
+ * @brief Cost of every rule and decoder measured on live traffic
+ *
+ * One in every N events of each decoding and rule matching thread is timed
+ * with the cycle counter of the CPU. The cost of every evaluated decoder and
+ * the self cost of every evaluated rule, excluding its children, are added up
+ * in a table of the thread. The tables are only merged when they are read.
+ *
+ * The sampling rate can be changed at runtime through asyscom, 0 disables the
+ * profiler and leaves a single thread-local check per event and rule.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "eventinfo.h"
+
+/* Slots of the tables of a thread, rules and decoders beyond these aren't profiled */
+#define W_PROFILER_RULE_SLOTS       8192
+#define W_PROFILER_DECODER_SLOTS    2048
+
+/* Rows of every table of getprofile */
+#define W_PROFILER_TOP_DEFAULT      20
+#define W_PROFILER_TOP_MAX          1000
+
+/* Rule being evaluated, with the cost of its children apart */
+typedef struct w_profiler_frame_t {
+    uint64_t start;
+    uint64_t children;
+} w_profiler_frame_t;
+
+/* Whether the current event of the thread is being timed */
+extern __thread bool w_profiler_sampled;
+
+/**
+ * @brief Set the initial sampling rate from the internal options.
+ */
+void w_profiler_init(void);
+
+/**
+ * @brief Change the sampling rate.
+ *
+ * @param rate Time one in every rate events, 0 to disable the profiler.
+ */
+void w_profiler_set_sampling(unsigned int rate);
+
+/**
+ * @brief Get the sampling rate.
+ *
+ * @return One in how many events are timed, 0 if the profiler is disabled.
+ */
+unsigned int w_profiler_get_sampling(void);
+
+/**
+ * @brief Discard the costs collected so far.
+ */
+void w_profiler_reset(void);
+
+/**
+ * @brief Decide whether the event the thread is about to process is timed.
+ *
+ * Decoding and rule matching threads call it once per event.
+ */
+void w_profiler_sample_event(void);
+
+/**
+ * @brief Read the cycle counter of the CPU.
+ */
+uint64_t w_profiler_ticks(void);
+
+/**
+ * @brief Start timing a rule.
+ *
+ * @param frame Frame of the rule, in the stack of the caller.
+ */
+void w_profiler_rule_enter(w_profiler_frame_t * frame);
+
+/**
+ * @brief Charge the time elapsed since w_profiler_rule_enter(), less the one of its children, to a rule.
+ *
+ * @param frame Frame of the rule.
+ * @param rule Evaluated rule.
+ */
+void w_profiler_rule_leave(w_profiler_frame_t * frame, const RuleInfo * rule);
+
+/**
+ * @brief Charge the time elapsed since the previous call to the previous decoder and start timing another one.
+ *
+ * @param decoder Decoder to be evaluated, NULL at the end of the decoding.
+ */
+void w_profiler_decoder_next(const OSDecoderInfo * decoder);
+
+/**
+ * @brief Build the top cost tables.
+ *
+ * @param top Rows of every table.
+ * @return Object with the sampling rate and the "rules" and "decoders" arrays,
+ *         sorted by total cost.
+ */
+cJSON * w_profiler_json(unsigned int top);
+
+#endif /* PROFILER_H */
@@ -13,6 +13,7 @@
 #include "eventinfo.h"
 #include "compiled_rules/compiled_rules.h"
 #include "analysisd.h"
+#include "profiler.h"
 
 #ifdef WAZUH_UNIT_TESTING
 // Remove STATIC qualifier from tests
@@ -54,6 +55,11 @@ STATIC int doesRuleExist(int sid, RuleNode *r_node);
 STATIC void Rule_AddAR(RuleInfo *config_rule);
 STATIC char *loadmemory(char *at, const char *str, OSList* log_msg);
 STATIC void printRuleinfo(const RuleInfo *rule, int node);
+STATIC RuleInfo * OS_CheckRule(struct _Eventinfo *lf, EventList *last_events,
+                               ListNode **cdblists, RuleNode *curr_node,
+                               regex_matching *rule_match, OSList **fts_list,
+                               OSHash **fts_store, const bool save_fts_value,
+                               cJSON * rules_debug_list);
 
 /**
  * @brief Free the rules_tmp_params_t structure members
@@ -2178,6 +2184,10 @@ RuleInfo *zerorulemember(int id, int level, int maxsize, int frequency,
     ruleinfo_pt->sid_search = NULL;
     ruleinfo_pt->group_search = NULL;
 
+    ruleinfo_pt->sid_prev_index = NULL;
+    ruleinfo_pt->sid_prev_index_sz = 0;
+    ruleinfo_pt->sid_index = NULL;
+
     ruleinfo_pt->event_search = NULL;
     ruleinfo_pt->compiled_rule = NULL;
     ruleinfo_pt->lists = NULL;
@@ -2488,7 +2498,7 @@ STATIC void printRuleinfo(const RuleInfo *rule, int node)
 }
 
 /* Add rule to hash */
-int AddHash_Rule(RuleNode *node)
+int AddHash_Rule(OSHash *hash, RuleNode *node)
 {
     char id_key[15] = {'\0'};
 
@@ -2497,12 +2507,12 @@ int AddHash_Rule(RuleNode *node)
 
         /* Add key to hash */
         /* Ignore if the key is already stored */
-        if (!OSHash_Add(Config.g_rules_hash, id_key, node->ruleinfo)) {
+        if (!OSHash_Add(hash, id_key, node->ruleinfo)) {
             merror("At AddHash_Rule(): OSHash_Add() failed");
             break;
         }
 
-        if (node->child) AddHash_Rule(node->child);
+        if (node->child) AddHash_Rule(hash, node->child);
 
         node = node->next;
     }
@@ -2513,6 +2523,12 @@ int AddHash_Rule(RuleNode *node)
 int _setlevels(RuleNode *node, int nnode)
 {
     int l_size = 0;
+
+    if (nnode == 0) {
+        OS_BuildRuleIndex(node);
+        OS_BuildRuleLiterals(node);
+    }
+
     while (node) {
         if (node->ruleinfo->level == 9900) {
             node->ruleinfo->level = 0;
@@ -2540,6 +2556,215 @@ int _setlevels(RuleNode *node, int nnode)
     return (l_size);
 }
 
+STATIC int rule_candidates_cmp(const void *a, const void *b)
+{
+    const RuleCandidates *ca = a;
+    const RuleCandidates *cb = b;
+
+    return (ca->decoder_id > cb->decoder_id) - (ca->decoder_id < cb->decoder_id);
+}
+
+/* Copy the nodes of a list whose decoded_as is zero or decoder_id */
+STATIC RuleNode **rule_candidates_collect(RuleNode *node, size_t size, u_int16_t decoder_id)
+{
+    RuleNode **nodes;
+    size_t i = 0;
+
+    os_calloc(size + 1, sizeof(RuleNode *), nodes);
+
+    for (; node; node = node->next) {
+        if (node->ruleinfo->decoded_as == 0 || node->ruleinfo->decoded_as == decoder_id) {
+            nodes[i++] = node;
+        }
+    }
+
+    return nodes;
+}
+
+void OS_BuildRuleIndex(RuleNode *node)
+{
+    RuleIndex *index;
+    RuleNode *tmp_node;
+    size_t size = 0;
+    size_t generic = 0;
+    size_t i;
+    size_t j;
+
+    if (!node) {
+        return;
+    }
+
+    if (node->index) {
+        OS_FreeRuleIndex(node->index);
+        node->index = NULL;
+    }
+
+    for (tmp_node = node; tmp_node; tmp_node = tmp_node->next) {
+        if (tmp_node->ruleinfo->decoded_as == 0) {
+            generic++;
+        }
+        size++;
+
+        OS_BuildRuleIndex(tmp_node->child);
+    }
+
+    if (generic == size) {
+        return;
+    }
+
+    os_calloc(1, sizeof(RuleIndex), index);
+    os_calloc(size - generic, sizeof(RuleCandidates), index->decoders);
+
+    for (tmp_node = node; tmp_node; tmp_node = tmp_node->next) {
+        if (tmp_node->ruleinfo->decoded_as != 0) {
+            index->decoders[index->decoders_size++].decoder_id = tmp_node->ruleinfo->decoded_as;
+        }
+    }
+
+    qsort(index->decoders, index->decoders_size, sizeof(RuleCandidates), rule_candidates_cmp);
+
+    /* Remove the duplicated ids */
+    for (i = 0, j = 0; i < index->decoders_size; i++) {
+        if (j == 0 || index->decoders[j - 1].decoder_id != index->decoders[i].decoder_id) {
+            index->decoders[j++] = index->decoders[i];
+        }
+    }
+    index->decoders_size = j;
+
+    for (i = 0; i < index->decoders_size; i++) {
+        index->decoders[i].nodes = rule_candidates_collect(node, size, index->decoders[i].decoder_id);
+    }
+
+    index->generic = rule_candidates_collect(node, generic, 0);
+    node->index = index;
+}
+
+/* Add the match options of a rule tree to a literals set */
+STATIC size_t rule_literals_add(RuleNode *node, OSMatchSet *set)
+{
+    size_t count = 0;
+
+    for (; node; node = node->next) {
+        RuleInfo *rule = node->ruleinfo;
+        int id;
+
+        /* Rules with if_group can be in several lists */
+        if (rule->match_literals != set) {
+            rule->match_literals = NULL;
+
+            if (rule->match && rule->match->exp_type == EXP_TYPE_OSMATCH
+                && (id = OSMatchSet_Add(set, rule->match->match), id >= 0)) {
+                rule->match_literals = set;
+                rule->match_literal = id;
+                count++;
+            }
+        }
+
+        count += rule_literals_add(node->child, set);
+    }
+
+    return count;
+}
+
+void OS_BuildRuleLiterals(RuleNode *node)
+{
+    OSMatchSet *set;
+
+    if (!node) {
+        return;
+    }
+
+    if (node->literals) {
+        OSMatchSet_Free(node->literals);
+        node->literals = NULL;
+    }
+
+    if (set = OSMatchSet_Create(), !set) {
+        merror_exit(MEM_ERROR, errno, strerror(errno));
+    }
+
+    if (rule_literals_add(node, set) == 0) {
+        OSMatchSet_Free(set);
+        return;
+    }
+
+    if (!OSMatchSet_Compile(set)) {
+        merror_exit(MEM_ERROR, errno, strerror(errno));
+    }
+
+    node->literals = set;
+}
+
+/* Match the match option of a rule with the scan of the ruleset literals */
+STATIC bool rule_literals_match(Eventinfo *lf, const RuleInfo *rule)
+{
+    if (!lf->log) {
+        return false;
+    }
+
+    if (lf->literal_set != rule->match_literals || lf->literal_log != lf->log) {
+        if (lf->literal_set != rule->match_literals) {
+            os_free(lf->literal_matches);
+            os_calloc((OSMatchSet_Size(rule->match_literals) + 7) / 8, sizeof(unsigned char), lf->literal_matches);
+        }
+
+        OSMatchSet_Execute(rule->match_literals, lf->log, lf->literal_matches);
+        lf->literal_set = rule->match_literals;
+        lf->literal_log = lf->log;
+    }
+
+    return (lf->literal_matches[rule->match_literal / 8] >> (rule->match_literal % 8)) & 1;
+}
+
+void OS_FreeRuleIndex(RuleIndex *index)
+{
+    if (!index) {
+        return;
+    }
+
+    for (size_t i = 0; i < index->decoders_size; i++) {
+        os_free(index->decoders[i].nodes);
+    }
+
+    os_free(index->decoders);
+    os_free(index->generic);
+    os_free(index);
+}
+
+RuleNode *OS_FirstRuleCandidate(RuleNode *node, struct _Eventinfo *lf, bool trace, RuleNode ***cursor)
+{
+    RuleCandidates key = { 0 };
+    RuleCandidates *candidates;
+
+    *cursor = NULL;
+
+#ifdef TESTRULE
+    if (full_output && !alert_only) {
+        trace = true;
+    }
+#endif
+
+    if (!node || !node->index || trace || lf->decoder_info->type == OSSEC_ALERT) {
+        return node;
+    }
+
+    key.decoder_id = lf->decoder_syscheck_id != 0 ? lf->decoder_syscheck_id : lf->decoder_info->id;
+    candidates = bsearch(&key, node->index->decoders, node->index->decoders_size, sizeof(RuleCandidates),
+                         rule_candidates_cmp);
+
+    *cursor = candidates ? candidates->nodes : node->index->generic;
+    return **cursor;
+}
+
+RuleNode *OS_NextRuleCandidate(RuleNode *node, RuleNode ***cursor)
+{
+    if (*cursor) {
+        return *++(*cursor);
+    }
+
+    return node->next;
+}
+
 /* Test if a rule id exists
  * return 1 if exists, otherwise 0
  */
@@ -2566,12 +2791,33 @@ STATIC int doesRuleExist(int sid, RuleNode *r_node)
     return (0);
 }
 
-/* Checks if the current_rule matches the event information */
+/* Checks if the current_rule matches the event information, timing it if the event is sampled by the profiler */
 RuleInfo * OS_CheckIfRuleMatch(struct _Eventinfo *lf, EventList *last_events,
                                ListNode **cdblists, RuleNode *curr_node,
                                regex_matching *rule_match, OSList **fts_list,
                                OSHash **fts_store, const bool save_fts_value,
                                cJSON * rules_debug_list) {
+    w_profiler_frame_t frame;
+    RuleInfo *rule;
+
+    if (!w_profiler_sampled) {
+        return OS_CheckRule(lf, last_events, cdblists, curr_node, rule_match, fts_list, fts_store,
+                            save_fts_value, rules_debug_list);
+    }
+
+    w_profiler_rule_enter(&frame);
+    rule = OS_CheckRule(lf, last_events, cdblists, curr_node, rule_match, fts_list, fts_store,
+                        save_fts_value, rules_debug_list);
+    w_profiler_rule_leave(&frame, curr_node->ruleinfo);
+
+    return rule;
+}
+
+STATIC RuleInfo * OS_CheckRule(struct _Eventinfo *lf, EventList *last_events,
+                               ListNode **cdblists, RuleNode *curr_node,
+                               regex_matching *rule_match, OSList **fts_list,
+                               OSHash **fts_store, const bool save_fts_value,
+                               cJSON * rules_debug_list) {
 
     /* We check for:
      * decoded_as,
@@ -2613,12 +2859,12 @@ RuleInfo * OS_CheckIfRuleMatch(struct _Eventinfo *lf, EventList *last_events,
         cJSON_AddItemToArray(rules_debug_list, cJSON_CreateString(rule_str));
     }
 
-    /* Check if any decoder pre-matched here for syscheck event */
+    /* Check if any decoder pre-matched here for the events of the internal decoders */
     if(lf->decoder_syscheck_id != 0 && (rule->decoded_as &&
             rule->decoded_as != lf->decoder_syscheck_id)){
         return (NULL);
     }
-    /* Check if any decoder pre-matched here for non-syscheck events*/
+    /* Check if any decoder pre-matched here for the other events */
     else if (lf->decoder_syscheck_id == 0 && (rule->decoded_as &&
             rule->decoded_as != lf->decoder_info->id)) {
         return (NULL);
@@ -2671,7 +2917,9 @@ RuleInfo * OS_CheckIfRuleMatch(struct _Eventinfo *lf, EventList *last_events,
 
     /* Check if any word to match exists */
     if (rule->match) {
-        if (w_expression_match(rule->match, lf->log, NULL, rule_match) == rule->match->negate) {
+        bool matches = rule->match_literals ? rule_literals_match(lf, rule)
+                                            : w_expression_match(rule->match, lf->log, NULL, rule_match);
+        if (matches == rule->match->negate) {
             return (NULL);
         }
     }
@@ -3111,7 +3359,10 @@ RuleInfo * OS_CheckIfRuleMatch(struct _Eventinfo *lf, EventList *last_events,
             cJSON_AddItemToArray(rules_debug_list, cJSON_CreateString(RULES_DEBUG_MSG_III));
         }
 
-        while (child_node) {
+        RuleNode **candidates = NULL;
+
+        for (child_node = OS_FirstRuleCandidate(child_node, lf, rules_debug_list != NULL, &candidates); child_node;
+             child_node = OS_NextRuleCandidate(child_node, &candidates)) {
             child_rule = OS_CheckIfRuleMatch(lf, last_events, cdblists,
                                              child_node, rule_match, fts_list,
                                              fts_store, save_fts_value,
@@ -3122,8 +3373,6 @@ RuleInfo * OS_CheckIfRuleMatch(struct _Eventinfo *lf, EventList *last_events,
                 }
                 return (child_rule);
             }
-
-            child_node = child_node->next;
         }
     }
 
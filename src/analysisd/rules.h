@@ -108,6 +108,15 @@ typedef struct _FieldInfo {
 } FieldInfo;
 
 
+/* Events that matched the if_matched_sid rule of a frequency rule, bucketed
+ * by the values that the frequency rule requires to be the same.
+ */
+typedef struct _w_sid_index_t {
+    struct _RuleInfo *rule;     /* Frequency rule that defines the key */
+    OSHash *buckets;            /* Key -> OSList of events, oldest first */
+    pthread_rwlock_t rwlock;
+} w_sid_index_t;
+
 typedef struct _RuleInfo {
     int sigid;  /* id attribute -- required*/
     int level;  /* level attribute --required */
@@ -146,6 +155,13 @@ typedef struct _RuleInfo {
     /* Pointer to a list (points to sid_prev_matched of if_matched_sid */
     OSList *sid_search;
 
+    /* Indexes of sid_prev_matched, one per frequency rule that has a key */
+    w_sid_index_t **sid_prev_index;
+    unsigned int sid_prev_index_sz;
+
+    /* Index of sid_search for this rule, NULL if the whole list is searched */
+    w_sid_index_t *sid_index;
+
     /* List of previously matched events in this group.
      * Every rule that has if_matched_group will have this
      * list. Every rule that matches this group, it going to
@@ -163,6 +179,10 @@ typedef struct _RuleInfo {
     w_expression_t * match;
     w_expression_t * regex;
 
+    /* Set of the ruleset literals where match is, NULL if match isn't made of literals */
+    const OSMatchSet *match_literals;
+    int match_literal;      /* Id of match in match_literals */
+
     /* Policy-based rules */
     char *day_time;
     char *week_day;
@@ -218,6 +238,7 @@ typedef struct _RuleInfo {
     char ** mitre_technique_id;
 
     bool internal_saving;      ///< Used to free RuleInfo structure in wazuh-logtest
+    bool clone;                ///< Shares everything but the correlation state with the rule it was cloned from
 
     /* Pointers to the rules which this one overwrites if it exists */
     OSList * rule_overwrite;
@@ -250,10 +271,25 @@ typedef struct _rules_tmp_params_t {
 
 } rules_tmp_params_t;
 
+/* Rules of a list that can match the events of one decoder */
+typedef struct _RuleCandidates {
+    u_int16_t decoder_id;
+    struct _RuleNode **nodes;   /* NULL terminated, in list order */
+} RuleCandidates;
+
+/* Index of a rule list by the decoded_as option */
+typedef struct _RuleIndex {
+    RuleCandidates *decoders;   /* Sorted by decoder id */
+    size_t decoders_size;
+    struct _RuleNode **generic; /* Rules without decoded_as, NULL terminated */
+} RuleIndex;
+
 typedef struct _RuleNode {
     RuleInfo *ruleinfo;
     struct _RuleNode *next;
     struct _RuleNode *child;
+    RuleIndex *index;           /* Only set on the first node of a list */
+    OSMatchSet *literals;       /* Only set on the first node of the root list */
 } RuleNode;
 
 /**
@@ -359,6 +395,17 @@ RuleNode *OS_GetFirstRule(void);
  */
 void os_remove_rules_list(RuleNode *node);
 
+/**
+ * @brief Clone a rules list
+ *
+ * The clones share the options of the rules, so the list must outlive them, but not their correlation
+ * state: previous matches, fired times and ignore time. The links between frequency rules and the rules
+ * they search are the ones of the list.
+ * @param node rule list to clone
+ * @return the cloned list, it must be freed with os_remove_rules_list()
+ */
+RuleNode *os_clone_rules_list(RuleNode *node);
+
 /**
  * @brief Remove a rule node
  * @param node rule node to remove
@@ -396,10 +443,59 @@ void Rules_OP_CreateRules(void);
 int Rules_OP_ReadRules(const char *rulefile, RuleNode **r_node, ListNode **l_node,
                        EventList **last_event_list, OSStore **decoder_list, OSList* log_msg);
 
-int AddHash_Rule(RuleNode *node);
+/**
+ * @brief Add the rules of a tree to a hash, by id
+ * @param hash Hash of the rules
+ * @param node First rule of the tree
+ * @return 0
+ */
+int AddHash_Rule(OSHash *hash, RuleNode *node);
 
 int _setlevels(RuleNode *node, int nnode);
 
+/**
+ * @brief Index a rule list, and the lists of its children, by the decoded_as option
+ *
+ * Lists without any decoded_as rule are not indexed.
+ * @param node first node of the list
+ */
+void OS_BuildRuleIndex(RuleNode *node);
+
+/**
+ * @brief Put the match options of a rule tree made only of literals in a single set
+ *
+ * OS_CheckIfRuleMatch scans the log once with the set, instead of executing those match options one by one.
+ * @param node first node of the root list, owner of the set
+ */
+void OS_BuildRuleLiterals(RuleNode *node);
+
+/**
+ * @brief Free the index of a rule list
+ * @param index index to free
+ */
+void OS_FreeRuleIndex(RuleIndex *index);
+
+/**
+ * @brief Get the first rule of a list that can match an event
+ *
+ * The rules skipped are the ones whose decoded_as doesn't match the event decoder.
+ * Alerts and traced evaluations walk the whole list.
+ * @param node first node of the list
+ * @param lf event to match
+ * @param trace true when every rule must be tried, to report it in the debug messages
+ * @param cursor position in the candidates of the index, for OS_NextRuleCandidate
+ * @return first candidate, NULL if no rule can match
+ */
+RuleNode *OS_FirstRuleCandidate(RuleNode *node, struct _Eventinfo *lf, bool trace, RuleNode ***cursor);
+
+/**
+ * @brief Get the next rule of a list that can match the event given to OS_FirstRuleCandidate
+ * @param node current candidate
+ * @param cursor position set by OS_FirstRuleCandidate
+ * @return next candidate, NULL at the end of the list
+ */
+RuleNode *OS_NextRuleCandidate(RuleNode *node, RuleNode ***cursor);
+
 int doDiff(RuleInfo *rule, struct _Eventinfo *lf);
 
 
@@ -511,6 +511,7 @@ int OS_MarkID(RuleNode *r_node, RuleInfo *orig_rule)
 
             /* Assign the parent pointer to it */
             orig_rule->sid_search = r_node->ruleinfo->sid_prev_matched;
+            w_sid_index_init(r_node->ruleinfo, orig_rule);
         }
 
         /* Check if the child has a rule */
@@ -574,6 +575,10 @@ void os_remove_rules_list(RuleNode *node) {
     int pos = 0;
     int num_rules = 0;
 
+    if (node) {
+        OSMatchSet_Free(node->literals);
+    }
+
     os_count_rules(node, &num_rules);
 
     os_calloc(num_rules + 1, sizeof(RuleInfo *), rules);
@@ -608,6 +613,7 @@ void os_remove_rulenode(RuleNode *node, RuleInfo **rules, int *pos, int *max_siz
             (*pos)++;
         }
 
+        OS_FreeRuleIndex(tmp->index);
         os_free(tmp);
     }
 }
@@ -618,9 +624,6 @@ void os_remove_ruleinfo(RuleInfo *ruleinfo) {
         return;
     }
 
-    free_strarray(ruleinfo->ignore_fields);
-    free_strarray(ruleinfo->ckignore_fields);
-
     if (ruleinfo->group_search) {
         OSList_Destroy(ruleinfo->group_search);
     }
@@ -628,6 +631,18 @@ void os_remove_ruleinfo(RuleInfo *ruleinfo) {
     os_free(ruleinfo->sid_prev_matched);
     os_free(ruleinfo->group_prev_matched);
 
+    w_sid_index_free(ruleinfo);
+    os_free(ruleinfo->sid_prev_index);
+
+    /* The options belong to the rule it was cloned from */
+    if (ruleinfo->clone) {
+        os_free(ruleinfo);
+        return;
+    }
+
+    free_strarray(ruleinfo->ignore_fields);
+    free_strarray(ruleinfo->ckignore_fields);
+
     os_free(ruleinfo->group);
     w_free_expression_t(&ruleinfo->match);
     w_free_expression_t(&ruleinfo->regex);
@@ -718,3 +733,149 @@ void os_count_rules(RuleNode *node, int *num_rules) {
         node = node->next;
     }
 }
+
+/* Get the clone of a rule or of a list of previous matches */
+STATIC void *os_clone_get(OSHash *clones, const void *orig)
+{
+    char key[OS_SIZE_32];
+
+    snprintf(key, sizeof(key), "%p", orig);
+    return OSHash_Get(clones, key);
+}
+
+STATIC void os_clone_add(OSHash *clones, const void *orig, void *clone)
+{
+    char key[OS_SIZE_32];
+
+    snprintf(key, sizeof(key), "%p", orig);
+
+    if (OSHash_Add(clones, key, clone) != 2) {
+        merror_exit(MEM_ERROR, errno, strerror(errno));
+    }
+}
+
+/* Clone a rule once, even if it's found more than once in the rule tree */
+STATIC RuleInfo *os_clone_ruleinfo(RuleInfo *ruleinfo, OSHash *clones, RuleInfo **rules, int *pos)
+{
+    RuleInfo *clone;
+
+    if (clone = os_clone_get(clones, ruleinfo), clone) {
+        return clone;
+    }
+
+    os_malloc(sizeof(RuleInfo), clone);
+    memcpy(clone, ruleinfo, sizeof(RuleInfo));
+
+    clone->clone = true;
+    clone->internal_saving = false;
+    clone->mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+
+    /* Zeroing the correlation state */
+    clone->firedtimes = 0;
+    clone->time_ignored = 0;
+
+    clone->sid_prev_matched = NULL;
+    clone->sid_search = NULL;
+    clone->sid_prev_index = NULL;
+    clone->sid_prev_index_sz = 0;
+    clone->sid_index = NULL;
+
+    clone->group_prev_matched = NULL;
+    clone->group_search = NULL;
+
+    if (ruleinfo->sid_prev_matched) {
+        if (clone->sid_prev_matched = OSList_Create(), !clone->sid_prev_matched) {
+            merror_exit(MEM_ERROR, errno, strerror(errno));
+        }
+        os_clone_add(clones, ruleinfo->sid_prev_matched, clone->sid_prev_matched);
+    }
+
+    if (ruleinfo->group_search) {
+        if (clone->group_search = OSList_Create(), !clone->group_search) {
+            merror_exit(MEM_ERROR, errno, strerror(errno));
+        }
+        os_clone_add(clones, ruleinfo->group_search, clone->group_search);
+    }
+
+    os_clone_add(clones, ruleinfo, clone);
+    rules[(*pos)++] = ruleinfo;
+
+    return clone;
+}
+
+STATIC RuleNode *os_clone_rulenode(RuleNode *node, OSHash *clones, RuleInfo **rules, int *pos)
+{
+    RuleNode *first = NULL;
+    RuleNode **last = &first;
+
+    for (; node; node = node->next) {
+        RuleNode *clone;
+
+        os_calloc(1, sizeof(RuleNode), clone);
+        clone->ruleinfo = os_clone_ruleinfo(node->ruleinfo, clones, rules, pos);
+        clone->child = os_clone_rulenode(node->child, clones, rules, pos);
+
+        *last = clone;
+        last = &clone->next;
+    }
+
+    return first;
+}
+
+/* Point the clone of a rule to the lists of previous matches of the clones */
+STATIC void os_clone_link(RuleInfo *ruleinfo, OSHash *clones)
+{
+    RuleInfo *clone = os_clone_get(clones, ruleinfo);
+    unsigned int i;
+
+    if (ruleinfo->sid_search) {
+        clone->sid_search = os_clone_get(clones, ruleinfo->sid_search);
+    }
+
+    if (ruleinfo->group_prev_matched) {
+        os_calloc(ruleinfo->group_prev_matched_sz + 1, sizeof(OSList *), clone->group_prev_matched);
+
+        for (i = 0; i < ruleinfo->group_prev_matched_sz; i++) {
+            clone->group_prev_matched[i] = os_clone_get(clones, ruleinfo->group_prev_matched[i]);
+        }
+    }
+
+    /* Same order as when the rules were marked */
+    for (i = 0; i < ruleinfo->sid_prev_index_sz; i++) {
+        w_sid_index_init(clone, os_clone_get(clones, ruleinfo->sid_prev_index[i]->rule));
+    }
+}
+
+RuleNode *os_clone_rules_list(RuleNode *node) {
+
+    RuleNode *clone;
+    RuleInfo **rules;
+    OSHash *clones;
+    int pos = 0;
+    int num_rules = 0;
+
+    if (!node) {
+        return NULL;
+    }
+
+    if (clones = OSHash_Create(), !clones) {
+        merror_exit(MEM_ERROR, errno, strerror(errno));
+    }
+
+    os_count_rules(node, &num_rules);
+    os_calloc(num_rules + 1, sizeof(RuleInfo *), rules);
+
+    clone = os_clone_rulenode(node, clones, rules, &pos);
+
+    for (int i = 0; i < pos; i++) {
+        os_clone_link(rules[i], clones);
+    }
+
+    /* The literals are shared, the candidates are the cloned nodes */
+    OS_BuildRuleIndex(clone);
+
+    os_free(rules);
+    OSHash_Free(clones);
+
+    return clone;
+}
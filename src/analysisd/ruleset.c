@@ -0,0 +1,353 @@
+/*
+ * Ruleset reloading at runtime
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "analysisd.h"
+#include "ruleset.h"
+#include "profiler.h"
+
+/* Seconds between the checks of the retired rulesets */
+#define W_RULESET_RECLAIM_INTERVAL 5
+
+static w_ruleset_t * ruleset_current;
+static w_ruleset_t * ruleset_retired;
+
+/* Read-side sections in progress, by the parity of the epoch they started in */
+static unsigned int ruleset_epoch;
+static unsigned int ruleset_readers[2];
+
+/* Names of the internal decoders, by their slot */
+static const char * ruleset_decoders[W_RULESET_DECODERS_MAX];
+static int ruleset_decoders_size;
+
+/* Reloads, retired rulesets and internal decoders */
+static pthread_mutex_t ruleset_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ruleset_cond = PTHREAD_COND_INITIALIZER;
+static bool ruleset_requested;
+
+static void w_ruleset_free(w_ruleset_t * ruleset) {
+
+    os_remove_rules_list(ruleset->rule_list);
+    os_remove_decoders_list(ruleset->decoderlist_pn, ruleset->decoderlist_nopn);
+
+    if (ruleset->decoder_store) {
+        OSStore_Free(ruleset->decoder_store);
+    }
+
+    os_remove_cdblist(&ruleset->cdblists);
+    os_remove_cdbrules(&ruleset->cdbrules);
+
+    if (ruleset->rules_hash) {
+        OSHash_Free(ruleset->rules_hash);
+    }
+
+    os_free(ruleset->stamp);
+    os_free(ruleset);
+
+    /* The profiler keys its costs by rule and decoder addresses */
+    w_profiler_reset();
+}
+
+/* Log the messages of a compilation */
+static void w_ruleset_log(OSList * list_msg) {
+
+    for (OSListNode * node = list_msg->first_node; node; node = node->next) {
+        os_analysisd_log_msg_t * data_msg = node->data;
+        char * msg = os_analysisd_string_log_msg(data_msg);
+
+        if (data_msg->level == LOGLEVEL_WARNING) {
+            mwarn("%s", msg);
+        } else if (data_msg->level == LOGLEVEL_ERROR) {
+            merror("%s", msg);
+        }
+
+        os_free(msg);
+    }
+}
+
+/* Wait for the read-side sections that may have seen the previous ruleset.
+ * A reader may take the parity of an epoch and count itself in it after a flip,
+ * so the parities are drained one after the other, each after its own flip. */
+static void w_ruleset_synchronize(void) {
+
+    for (int phase = 0; phase < 2; phase++) {
+        unsigned int parity = __atomic_fetch_add(&ruleset_epoch, 1, __ATOMIC_SEQ_CST) & 1;
+
+        while (__atomic_load_n(&ruleset_readers[parity], __ATOMIC_SEQ_CST) > 0) {
+            sched_yield();
+        }
+    }
+}
+
+/* Make a ruleset the current one. Called with ruleset_mutex locked. */
+static void w_ruleset_publish(w_ruleset_t * ruleset) {
+
+    w_ruleset_t * old_ruleset = ruleset_current;
+
+    /* The global lists are only read at startup and by the configuration queries */
+    os_analysisd_rulelist = ruleset->rule_list;
+    os_analysisd_decoderlist_pn = ruleset->decoderlist_pn;
+    os_analysisd_decoderlist_nopn = ruleset->decoderlist_nopn;
+    os_analysisd_decoder_store = ruleset->decoder_store;
+    os_analysisd_cdblists = ruleset->cdblists;
+    os_analysisd_cdbrules = ruleset->cdbrules;
+    Config.g_rules_hash = ruleset->rules_hash;
+
+    /* The events in flight keep the ids of the ruleset they pin */
+    for (int i = 0; i < ruleset_decoders_size; i++) {
+        ruleset->decoder_ids[i] = getDecoderfromlist(ruleset_decoders[i], &ruleset->decoder_store);
+    }
+
+    __atomic_store_n(&ruleset_current, ruleset, __ATOMIC_SEQ_CST);
+
+    if (os_analysisd_last_events) {
+        __atomic_store_n(&os_analysisd_last_events->_max_freq, ruleset->max_freq, __ATOMIC_RELAXED);
+    }
+
+    if (old_ruleset) {
+        w_ruleset_synchronize();
+
+        old_ruleset->next = ruleset_retired;
+        ruleset_retired = old_ruleset;
+        w_ruleset_release(old_ruleset);
+    }
+}
+
+void w_ruleset_init(void) {
+
+    w_ruleset_t * ruleset;
+
+    os_calloc(1, sizeof(w_ruleset_t), ruleset);
+
+    ruleset->rule_list = os_analysisd_rulelist;
+    ruleset->decoderlist_pn = os_analysisd_decoderlist_pn;
+    ruleset->decoderlist_nopn = os_analysisd_decoderlist_nopn;
+    ruleset->decoder_store = os_analysisd_decoder_store;
+    ruleset->cdblists = os_analysisd_cdblists;
+    ruleset->cdbrules = os_analysisd_cdbrules;
+    ruleset->rules_hash = Config.g_rules_hash;
+    ruleset->max_freq = os_analysisd_last_events ? os_analysisd_last_events->_max_freq : 0;
+    ruleset->stamp = w_logtest_ruleset_stamp(&Config);
+    ruleset->references = 1;
+
+    w_mutex_lock(&ruleset_mutex);
+    w_ruleset_publish(ruleset);
+    w_mutex_unlock(&ruleset_mutex);
+}
+
+w_ruleset_t * w_ruleset_acquire(void) {
+
+    unsigned int parity = __atomic_load_n(&ruleset_epoch, __ATOMIC_SEQ_CST) & 1;
+    w_ruleset_t * ruleset;
+
+    __atomic_add_fetch(&ruleset_readers[parity], 1, __ATOMIC_SEQ_CST);
+
+    if (ruleset = __atomic_load_n(&ruleset_current, __ATOMIC_SEQ_CST), ruleset) {
+        __atomic_add_fetch(&ruleset->references, 1, __ATOMIC_RELAXED);
+    }
+
+    __atomic_sub_fetch(&ruleset_readers[parity], 1, __ATOMIC_RELEASE);
+
+    return ruleset;
+}
+
+w_ruleset_t * w_ruleset_hold(w_ruleset_t * ruleset) {
+
+    if (ruleset) {
+        __atomic_add_fetch(&ruleset->references, 1, __ATOMIC_RELAXED);
+    }
+
+    return ruleset;
+}
+
+void w_ruleset_release(w_ruleset_t * ruleset) {
+
+    if (ruleset) {
+        __atomic_sub_fetch(&ruleset->references, 1, __ATOMIC_RELEASE);
+    }
+}
+
+int w_ruleset_reload(bool force) {
+
+    OSList * list_msg = NULL;
+    _Config ruleset_config = {0};
+    w_logtest_ruleset_t * compiled = NULL;
+    w_ruleset_t * ruleset = NULL;
+    struct timespec start;
+    struct timespec end;
+    char * stamp = NULL;
+    int retval = -1;
+
+    if (list_msg = OSList_Create(), !list_msg) {
+        merror(LIST_ERROR);
+        return -1;
+    }
+
+    OSList_SetMaxSize(list_msg, ERRORLIST_MAXSIZE);
+    OSList_SetFreeDataPointer(list_msg, (void (*)(void *))os_analysisd_free_log_msg);
+
+    gettime(&start);
+
+    if (!w_logtest_ruleset_load(&ruleset_config, list_msg)) {
+        goto end;
+    }
+
+    stamp = w_logtest_ruleset_stamp(&ruleset_config);
+
+    if (!force && stamp && ruleset_current && ruleset_current->stamp && strcmp(ruleset_current->stamp, stamp) == 0) {
+        retval = 0;
+        goto end;
+    }
+
+    /* The compiled PCRE2 patterns are taken from the cache, the CDB lists are only compiled if outdated */
+    if (compiled = w_logtest_ruleset_build(&ruleset_config, list_msg), !compiled) {
+        goto end;
+    }
+
+    w_ruleset_log(compiled->load_msg);
+
+    os_calloc(1, sizeof(w_ruleset_t), ruleset);
+    ruleset->rule_list = compiled->rule_list;
+    ruleset->decoderlist_pn = compiled->decoderlist_forpname;
+    ruleset->decoderlist_nopn = compiled->decoderlist_nopname;
+    ruleset->decoder_store = compiled->decoder_store;
+    ruleset->cdblists = compiled->cdblistnode;
+    ruleset->cdbrules = compiled->cdblistrule;
+    ruleset->max_freq = compiled->max_freq;
+    ruleset->stamp = stamp;
+    ruleset->references = 1;
+    stamp = NULL;
+
+    OSList_Destroy(compiled->load_msg);
+    os_free(compiled);
+
+    if (ruleset->rules_hash = OSHash_Create(), !ruleset->rules_hash) {
+        merror(HASH_ERROR);
+        w_ruleset_free(ruleset);
+        goto end;
+    }
+
+    AddHash_Rule(ruleset->rules_hash, ruleset->rule_list);
+
+    w_mutex_lock(&ruleset_mutex);
+    w_ruleset_publish(ruleset);
+    w_mutex_unlock(&ruleset_mutex);
+
+    gettime(&end);
+    minfo("Ruleset reloaded in %.3f seconds.", time_diff(&start, &end));
+    retval = 1;
+
+end:
+    if (retval < 0) {
+        w_ruleset_log(list_msg);
+        merror("The ruleset could not be reloaded, the current one is kept.");
+    }
+
+    os_free(stamp);
+    w_logtest_ruleset_free_config(&ruleset_config);
+    OSList_Destroy(list_msg);
+
+    return retval;
+}
+
+void w_ruleset_request_reload(void) {
+
+    w_mutex_lock(&ruleset_mutex);
+    ruleset_requested = true;
+    w_cond_signal(&ruleset_cond);
+    w_mutex_unlock(&ruleset_mutex);
+}
+
+void w_ruleset_reclaim(void) {
+
+    w_ruleset_t ** prev = &ruleset_retired;
+    w_ruleset_t * ruleset;
+
+    w_mutex_lock(&ruleset_mutex);
+
+    while (ruleset = *prev, ruleset) {
+        if (__atomic_load_n(&ruleset->references, __ATOMIC_ACQUIRE) == 0) {
+            *prev = ruleset->next;
+            w_ruleset_free(ruleset);
+            mdebug1("Retired ruleset freed.");
+        } else {
+            prev = &ruleset->next;
+        }
+    }
+
+    w_mutex_unlock(&ruleset_mutex);
+}
+
+int w_ruleset_bind_decoder(u_int16_t * id, const char * name) {
+
+    int slot;
+
+    w_mutex_lock(&ruleset_mutex);
+
+    *id = getDecoderfromlist(name, &os_analysisd_decoder_store);
+
+    for (slot = 0; slot < ruleset_decoders_size && strcmp(ruleset_decoders[slot], name) != 0; slot++);
+
+    if (slot == W_RULESET_DECODERS_MAX) {
+        slot = -1;
+    } else if (slot == ruleset_decoders_size) {
+        /* No event knows the slot yet, so the current ruleset can be completed in place */
+        ruleset_decoders[ruleset_decoders_size++] = name;
+
+        if (ruleset_current) {
+            ruleset_current->decoder_ids[slot] = *id;
+        }
+    }
+
+    w_mutex_unlock(&ruleset_mutex);
+
+    return slot;
+}
+
+u_int16_t w_ruleset_decoder_id(const w_ruleset_t * ruleset, int slot, u_int16_t id) {
+
+    return ruleset && slot >= 0 ? ruleset->decoder_ids[slot] : id;
+}
+
+void * w_ruleset_thread(void * interval) {
+
+    int check_interval = (int)(intptr_t)interval;
+    time_t last_check = time(NULL);
+    struct timespec timeout;
+    bool force;
+
+    if (check_interval > 0) {
+        mdebug1("The ruleset is checked for changes every %d seconds.", check_interval);
+    }
+
+    while (1) {
+        w_mutex_lock(&ruleset_mutex);
+
+        if (!ruleset_requested) {
+            gettime(&timeout);
+            timeout.tv_sec += W_RULESET_RECLAIM_INTERVAL;
+            pthread_cond_timedwait(&ruleset_cond, &ruleset_mutex, &timeout);
+        }
+
+        force = ruleset_requested;
+        ruleset_requested = false;
+        w_mutex_unlock(&ruleset_mutex);
+
+        if (force || (check_interval > 0 && time(NULL) - last_check >= check_interval)) {
+            w_ruleset_reload(force);
+            last_check = time(NULL);
+        }
+
+        w_ruleset_reclaim();
+    }
+
+    return NULL;
+}
@@ -0,0 +1,141 @@
+/*
+ * Ruleset reloading at runtime
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/**
+ * @file ruleset.h
+ * @brief Decoders, CDB lists and rules in use by the event threads, swapped while analysisd runs
+ *
+ * A new ruleset is compiled by the reload thread, then it's published with a
+ * single pointer store. Each event pins the ruleset that was current when it
+ * was allocated and releases it when it's freed, so it's decoded and matched
+ * by the same ruleset even if it's swapped halfway.
+ *
+ * Getting the current ruleset and pinning it aren't a single atomic operation,
+ * so they are done inside a read-side section. The publisher flips the epoch
+ * twice and waits for the sections of both parities before dropping its own
+ * reference. A retired ruleset is freed by the reload thread once no event
+ * pins it.
+ *
+ * The ids of the internal decoders are positions in the decoder names of each
+ * ruleset, so every ruleset keeps its own and the events read them through the
+ * ruleset they pin.
+ *
+ * The previous events list, FTS and accumulator don't depend on the ruleset
+ * and they are kept. The events matched by if_matched_sid and if_matched_group
+ * are linked to their rules, so these rules start empty in the new ruleset.
+ */
+
+#ifndef RULESET_H
+#define RULESET_H
+
+#include "rules.h"
+#include "lists.h"
+#include "decoders/decoder.h"
+
+/* Internal decoders whose id depends on the ruleset */
+#define W_RULESET_DECODERS_MAX 32
+
+typedef struct w_ruleset_t {
+    RuleNode * rule_list;                   ///< Rule tree
+    OSDecoderNode * decoderlist_pn;         ///< Decoders of the logs which have a program name
+    OSDecoderNode * decoderlist_nopn;       ///< Decoders of the logs which haven't a program name
+    OSStore * decoder_store;                ///< Decoder names, their position is the decoder id
+    ListNode * cdblists;                    ///< CDB lists
+    ListRule * cdbrules;                    ///< Rules that look up CDB lists
+    OSHash * rules_hash;                    ///< Rules by id, for the alerts of other managers
+    int max_freq;                           ///< Highest frequency of the rules
+    u_int16_t decoder_ids[W_RULESET_DECODERS_MAX]; ///< Ids of the internal decoders, by their slot
+    char * stamp;                           ///< Files of the ruleset and their status, NULL if unknown
+    unsigned int references;                ///< Events pinning it, plus one while it's current
+    struct w_ruleset_t * next;              ///< Next retired ruleset
+} w_ruleset_t;
+
+/**
+ * @brief Make the ruleset loaded at startup the current one.
+ *
+ * It takes the global lists and Config.g_rules_hash.
+ */
+void w_ruleset_init(void);
+
+/**
+ * @brief Pin the current ruleset.
+ *
+ * @return Current ruleset, to be released with w_ruleset_release(). NULL before w_ruleset_init().
+ */
+w_ruleset_t * w_ruleset_acquire(void);
+
+/**
+ * @brief Pin a ruleset that is already pinned.
+ *
+ * @param ruleset Ruleset, it may be NULL.
+ * @return The same ruleset.
+ */
+w_ruleset_t * w_ruleset_hold(w_ruleset_t * ruleset);
+
+/**
+ * @brief Release a pinned ruleset.
+ *
+ * A retired ruleset is freed later by the reload thread, so events never pay for it.
+ *
+ * @param ruleset Ruleset, it may be NULL.
+ */
+void w_ruleset_release(w_ruleset_t * ruleset);
+
+/**
+ * @brief Compile the ruleset of the configuration and make it the current one.
+ *
+ * @param force Compile it even if its files haven't changed.
+ * @retval 1 The ruleset was swapped.
+ * @retval 0 The files haven't changed.
+ * @retval -1 The ruleset can't be compiled, the current one is kept.
+ */
+int w_ruleset_reload(bool force);
+
+/**
+ * @brief Ask the reload thread to compile the ruleset, even if its files haven't changed.
+ */
+void w_ruleset_request_reload(void);
+
+/**
+ * @brief Free the retired rulesets that no event pins anymore.
+ */
+void w_ruleset_reclaim(void);
+
+/**
+ * @brief Register an internal decoder, so that every ruleset resolves its id.
+ *
+ * Decoder ids are positions in the decoder names of the ruleset, so they may change.
+ * The decoders registered with the same name share their slot.
+ *
+ * @param id Set to the id in the current ruleset, for the events without a ruleset.
+ * @param name Decoder name, it must live as long as analysisd.
+ * @return Slot of the decoder, for w_ruleset_decoder_id(). -1 if there are too many decoders.
+ */
+int w_ruleset_bind_decoder(u_int16_t * id, const char * name);
+
+/**
+ * @brief Get the id of an internal decoder in a ruleset.
+ *
+ * @param ruleset Ruleset pinned by the event, it may be NULL.
+ * @param slot Slot returned by w_ruleset_bind_decoder().
+ * @param id Id returned by w_ruleset_bind_decoder(), used if there is no ruleset or slot.
+ * @return Id of the decoder.
+ */
+u_int16_t w_ruleset_decoder_id(const w_ruleset_t * ruleset, int slot, u_int16_t id);
+
+/**
+ * @brief Reload thread, it checks the files of the ruleset periodically and serves the requests.
+ *
+ * @param interval Seconds between checks, 0 only serves the requests.
+ */
+void * w_ruleset_thread(void * interval);
+
+#endif /* RULESET_H */
@@ -59,6 +59,18 @@ STATIC analysisd_agent_state_t * get_node(const char *agent_id);
  */
 STATIC void w_analysisd_clean_agents_state(int *sock);
 
+/**
+ * @brief Number of events in the rule matching queues
+ * @return sum of all the queues
+ */
+STATIC size_t w_decode_output_elements(void);
+
+/**
+ * @brief Size of the rule matching queues
+ * @return sum of all the queues
+ */
+STATIC size_t w_decode_output_size(void);
+
 /**
  * @brief Increment agent decoded events counter for agents
  * @param agent_id Id of the agent that corresponds to the event
@@ -503,6 +515,26 @@ int w_analysisd_write_state() {
    return 0;
 }
 
+STATIC size_t w_decode_output_elements(void) {
+    size_t elements = 0;
+
+    for (int i = 0; i < num_rule_matching_threads; i++) {
+        elements += decode_queue_event_output[i]->elements;
+    }
+
+    return elements;
+}
+
+STATIC size_t w_decode_output_size(void) {
+    size_t size = 0;
+
+    for (int i = 0; i < num_rule_matching_threads; i++) {
+        size += decode_queue_event_output[i]->size;
+    }
+
+    return size;
+}
+
 void w_get_queues_size() {
     queue_status.syscheck_queue_usage = ((decode_queue_syscheck_input->elements / (float)decode_queue_syscheck_input->size));
     queue_status.syscollector_queue_usage = ((decode_queue_syscollector_input->elements / (float)decode_queue_syscollector_input->size));
@@ -513,7 +545,7 @@ void w_get_queues_size() {
     queue_status.dbsync_queue_usage = ((dispatch_dbsync_input->elements / (float)dispatch_dbsync_input->size));
     queue_status.upgrade_queue_usage = ((upgrade_module_input->elements / (float)upgrade_module_input->size));
     queue_status.events_queue_usage = ((decode_queue_event_input->elements / (float)decode_queue_event_input->size));
-    queue_status.processed_queue_usage = ((decode_queue_event_output->elements / (float)decode_queue_event_output->size));
+    queue_status.processed_queue_usage = ((w_decode_output_elements() / (float)w_decode_output_size()));
     queue_status.alerts_queue_usage = ((writer_queue_log->elements / (float)writer_queue_log->size));
     queue_status.archives_queue_usage = ((writer_queue->elements / (float)writer_queue->size));
     queue_status.firewall_queue_usage = ((writer_queue_log_firewall->elements / (float)writer_queue_log_firewall->size));
@@ -531,7 +563,7 @@ void w_get_initial_queues_size() {
     queue_status.dbsync_queue_size = dispatch_dbsync_input->size;
     queue_status.upgrade_queue_size = upgrade_module_input->size;
     queue_status.events_queue_size = decode_queue_event_input->size;
-    queue_status.processed_queue_size = decode_queue_event_output->size;
+    queue_status.processed_queue_size = w_decode_output_size();
     queue_status.alerts_queue_size = writer_queue_log->size;
     queue_status.archives_queue_size = writer_queue->size;
     queue_status.firewall_queue_size = writer_queue_log_firewall->size;
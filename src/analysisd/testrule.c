@@ -162,13 +162,7 @@ int main(int argc, char **argv)
     Config.geoip_jsonout = getDefine_Int("analysisd", "geoip_jsonout", 0, 1);
 
     /* Opening GeoIP DB */
-    if(Config.geoipdb_file) {
-        geoipdb = GeoIP_open(Config.geoipdb_file, GEOIP_INDEX_CACHE);
-        if (geoipdb == NULL)
-        {
-            merror("Unable to open GeoIP database from: %s (disabling GeoIP).", Config.geoipdb_file);
-        }
-    }
+    OS_GeoIPInit(Config.geoipdb_file, (unsigned int)getDefine_Int("analysisd", "geoip_cache_size", 0, 1048576));
 #endif
 
     /* Get server hostname */
@@ -461,7 +455,7 @@ int main(int argc, char **argv)
         if (!Config.g_rules_hash) {
             merror_exit(MEM_ERROR, errno, strerror(errno));
         }
-        AddHash_Rule(tmp_node);
+        AddHash_Rule(Config.g_rules_hash, tmp_node);
     }
 
     if (test_config == 1) {
@@ -570,6 +564,7 @@ void OS_ReadMSG(char *ut_str)
         /* Receive message from queue */
         if (fgets(msg + 8, OS_MAXSTR - 8, stdin)) {
             RuleNode *rulenode_pt;
+            RuleNode **candidates = NULL;
 
             /* Get the time we received the event */
             c_time = time(NULL);
@@ -631,7 +626,8 @@ void OS_ReadMSG(char *ut_str)
             }
 #endif
 
-            do {
+            for (rulenode_pt = OS_FirstRuleCandidate(rulenode_pt, lf, false, &candidates); rulenode_pt;
+                 rulenode_pt = OS_NextRuleCandidate(rulenode_pt, &candidates)) {
                 if (lf->decoder_info->type == OSSEC_ALERT) {
                     if (!lf->generated_rule) {
                         break;
@@ -722,6 +718,7 @@ void OS_ReadMSG(char *ut_str)
                     } else {
                         lf->sid_node_to_delete =
                             currently_rule->sid_prev_matched->last_node;
+                        w_sid_index_add(currently_rule, lf);
                     }
                 }
 
@@ -742,7 +739,7 @@ void OS_ReadMSG(char *ut_str)
                 OS_AddEvent(lf, os_analysisd_last_events);
                 break;
 
-            } while ((rulenode_pt = rulenode_pt->next) != NULL);
+            }
 
             if (ut_str) {
                 /* Set up exit code if we are doing unit testing */
@@ -24,7 +24,7 @@
 #define normal(i, j) ((float)((i - j + agt->buflength + 1) % (agt->buflength + 1)) / (float)agt->buflength <= ((float)normal_level/100.0))
 #define capacity(i, j) (float)((i - j + agt->buflength + 1) % (agt->buflength + 1)) / (float)agt->buflength
 #define empty(i, j) (i == j)
-#define forward(x, n) x = (x + 1) % (n)
+#define forward(x, n) __atomic_store_n(&(x), ((x) + 1) % (n), __ATOMIC_RELEASE)
 
 /* Buffer statuses */
 #define NORMAL 0
@@ -82,6 +82,60 @@ void *dispatch_buffer(void * arg);
  */
 int w_agentd_get_buffer_lenght();
 
+/**
+ * @brief Open the spill queue, keeping the segments left by a previous run
+ *
+ * The spill queue is not thread safe: it is used under the buffer lock.
+ *
+ * @param dir Directory of the segment files.
+ * @param max_size Maximum bytes stored in the segments.
+ * @param sync_events Number of events written between fsync calls.
+ * @retval 0 on success.
+ * @retval -1 on error.
+ */
+int spill_init(const char * dir, size_t max_size, int sync_events);
+
+/**
+ * @brief Append an event to the spill queue
+ *
+ * @param msg Event.
+ * @param sync_fd Set to a descriptor to pass to spill_sync() once the buffer lock is released, or -1.
+ *                Even if the event couldn't be written. If NULL, the segment is synced before returning.
+ * @retval 0 on success.
+ * @retval -1 if the queue is full or the event couldn't be written.
+ */
+int spill_push(const char * msg, int * sync_fd);
+
+/**
+ * @brief Sync a segment of the spill queue to disk and close its descriptor
+ *
+ * It doesn't need the buffer lock.
+ *
+ * @param fd Descriptor set by spill_push(), nothing is done if it's -1.
+ */
+void spill_sync(int fd);
+
+/**
+ * @brief Take the oldest event of the spill queue
+ *
+ * Segments with a corrupted record are discarded.
+ *
+ * @return Event, to be freed by the caller. NULL if the queue is empty.
+ */
+char * spill_pop();
+
+/**
+ * @brief Check whether the spill queue has no events
+ *
+ * @return 1 if empty, 0 otherwise.
+ */
+int spill_empty();
+
+/**
+ * @brief Flush and close the files of the spill queue
+ */
+void spill_close();
+
 /* Initialize sender structure */
 void sender_init();
 
@@ -155,6 +209,9 @@ extern int win_debug_level;
 extern int warn_level;
 extern int normal_level;
 extern int tolerance;
+extern int batch_events;
+extern int buffer_bytes;
+extern int spill_size;
 extern int rotate_log;
 extern int request_pool;
 extern int rto_sec;
@@ -31,6 +31,10 @@ static volatile int state = NORMAL;
 int warn_level;
 int normal_level;
 int tolerance;
+int batch_events;
+int buffer_bytes;
+int spill_size;
+int spill_sync;
 
 struct{
   unsigned int full:1;
@@ -39,12 +43,31 @@ struct{
   unsigned int normal:1;
 } buff;
 
-static char ** buffer;
+STATIC char ** buffer;
+STATIC size_t buffer_used_bytes;
 static pthread_mutex_t mutex_lock;
 static pthread_cond_t cond_no_empty;
 static time_t start, end;
 limits_t *agentd_limits;
 
+/* Take the events that follow the first one while they fit in a batch message */
+STATIC int buffer_take_batch(char ** events);
+
+/* Send the events taken from the buffer, as a batch if there are several */
+STATIC void buffer_send_batch(char ** events, int count);
+
+/* Seconds between the attempts to send the spilled events while the agent is disconnected */
+#define SPILL_RETRY_INTERVAL 1
+
+/* Whether an event doesn't fit in the byte limit of the buffer */
+#define bytes_full(size) (buffer_bytes > 0 && buffer_used_bytes + (size) > (size_t)buffer_bytes)
+
+/* Discount the events taken from the buffer from the bytes in use */
+STATIC void buffer_release_bytes(char ** events, int count);
+
+/* Move spilled events back to the buffer while it is below the normal level */
+STATIC void buffer_refill();
+
 /* Create agent buffer */
 void buffer_init(){
 
@@ -55,6 +78,10 @@ void buffer_init(){
     warn_level = getDefine_Int("agent", "warn_level", 1, 100);
     normal_level = getDefine_Int("agent", "normal_level", 0, warn_level-1);
     tolerance = getDefine_Int("agent", "tolerance", 0, 600);
+    batch_events = getDefine_Int("agent", "batch_events", 1, 256);
+    buffer_bytes = getDefine_Int("agent", "buffer_bytes", 0, 1073741824);
+    spill_size = getDefine_Int("agent", "spill_size", 0, 4096);
+    spill_sync = getDefine_Int("agent", "spill_sync", 1, 100000);
 
     w_mutex_init(&mutex_lock, NULL);
     w_cond_init(&cond_no_empty, NULL);
@@ -62,11 +89,17 @@ void buffer_init(){
     if (tolerance == 0)
         mwarn(TOLERANCE_TIME);
 
+    if (spill_size > 0 && spill_init(SPILL_DIR, (size_t)spill_size << 20, spill_sync) < 0) {
+        merror("Couldn't open the spill queue. Events will be dropped when the buffer is full.");
+        spill_size = 0;
+    }
+
     mdebug1("Agent buffer created.");
 }
 
 /* Send messages to buffer. */
 int buffer_append(const char *msg){
+    const size_t msg_size = strlen(msg);
     char flood_msg[OS_MAXSTR];
     char full_msg[OS_MAXSTR];
     char warn_msg[OS_MAXSTR];
@@ -78,7 +111,7 @@ int buffer_append(const char *msg){
     switch (state) {
 
         case NORMAL:
-            if (full(i, j, agt->buflength + 1)){
+            if (full(i, j, agt->buflength + 1) || bytes_full(msg_size)){
                 buff.full = 1;
                 state = FULL;
                 start = time(0);
@@ -89,7 +122,7 @@ int buffer_append(const char *msg){
             break;
 
         case WARNING:
-            if (full(i, j, agt->buflength + 1)){
+            if (full(i, j, agt->buflength + 1) || bytes_full(msg_size)){
                 buff.full = 1;
                 state = FULL;
                 start = time(0);
@@ -132,9 +165,28 @@ int buffer_append(const char *msg){
 
     w_agentd_state_update(INCREMENT_MSG_COUNT, NULL);
 
-    /* When buffer is full, event is dropped */
+    /* When buffer is full, event is spilled to disk or dropped.
+     * Once an event is spilled, the next ones follow it to keep the order. */
+
+    if (spill_size > 0 && (!spill_empty() || full(i, j, agt->buflength + 1) || bytes_full(msg_size))) {
 
-    if (full(i, j, agt->buflength + 1)){
+        int sync_fd;
+        int retval = spill_push(msg, &sync_fd);
+
+        // The dispatcher drains the spill queue when it wakes up
+        w_cond_signal(&cond_no_empty);
+        w_mutex_unlock(&mutex_lock);
+
+        // The other threads don't wait for the disk
+        spill_sync(sync_fd);
+
+        if (retval < 0) {
+            mdebug2("Unable to store new packet: Buffer is full.");
+        }
+
+        return retval;
+
+    }else if (full(i, j, agt->buflength + 1) || bytes_full(msg_size)){
 
         w_mutex_unlock(&mutex_lock);
         mdebug2("Unable to store new packet: Buffer is full.");
@@ -142,7 +194,8 @@ int buffer_append(const char *msg){
 
     }else{
 
-        buffer[i] = strdup(msg);
+        os_strdup(msg, buffer[i]);
+        buffer_used_bytes += msg_size;
         forward(i, agt->buflength + 1);
         w_cond_signal(&cond_no_empty);
         w_mutex_unlock(&mutex_lock);
@@ -178,6 +231,10 @@ DWORD WINAPI dispatch_buffer(__attribute__((unused)) LPVOID arg) {
 void *dispatch_buffer(__attribute__((unused)) void * arg){
 #endif
     char normal_msg[OS_MAXSTR];
+    char ** events;
+    int count;
+
+    os_calloc(batch_events, sizeof(char *), events);
 
     while(1){
         // Maximum events per second limits
@@ -185,8 +242,14 @@ void *dispatch_buffer(__attribute__((unused)) void * arg){
 
         w_mutex_lock(&mutex_lock);
 
-        while(empty(i, j)){
-            w_cond_wait(&cond_no_empty, &mutex_lock);
+        while(buffer_refill(), empty(i, j)){
+            if (spill_size > 0 && !spill_empty()) {
+                // Nothing signals the buffer when the agent connects, so the spilled events are retried
+                struct timespec timeout = { .tv_sec = time(NULL) + SPILL_RETRY_INTERVAL };
+                pthread_cond_timedwait(&cond_no_empty, &mutex_lock, &timeout);
+            } else {
+                w_cond_wait(&cond_no_empty, &mutex_lock);
+            }
         }
         /* Check if buffer usage reaches any lower level */
         switch (state) {
@@ -222,8 +285,14 @@ void *dispatch_buffer(__attribute__((unused)) void * arg){
                 break;
         }
 
-        char * msg_output = buffer[j];
+        events[0] = buffer[j];
         forward(j, agt->buflength + 1);
+        count = buffer_take_batch(events);
+
+        if (buffer_bytes > 0) {
+            buffer_release_bytes(events, count);
+        }
+
         w_mutex_unlock(&mutex_lock);
 
         if (buff.normal){
@@ -234,8 +303,108 @@ void *dispatch_buffer(__attribute__((unused)) void * arg){
         }
 
         os_wait();
-        send_msg(msg_output, -1);
-        free(msg_output);
+        buffer_send_batch(events, count);
+    }
+}
+
+/* Size of an event in a batch message: "<length>:<event>" */
+static size_t batch_record_size(const char * event) {
+    char length[32];
+    size_t event_size = strlen(event);
+
+    return (size_t)snprintf(length, sizeof(length), "%lu:", (unsigned long)event_size) + event_size;
+}
+
+STATIC int buffer_take_batch(char ** events) {
+    const size_t max_size = OS_MAXSTR - OS_HEADER_SIZE;
+    size_t size;
+    int count = 1;
+
+    if (batch_events <= 1 || strncmp(events[0], CONTROL_HEADER, strlen(CONTROL_HEADER)) == 0) {
+        return count;
+    }
+
+    size = strlen(CONTROL_HEADER HC_BATCH) + batch_record_size(events[0]);
+
+    while (count < batch_events && !empty(i, j) && size < max_size) {
+        char * next = buffer[j];
+        size_t next_size;
+
+        // Control messages are never batched
+        if (strncmp(next, CONTROL_HEADER, strlen(CONTROL_HEADER)) == 0) {
+            break;
+        }
+
+        if (next_size = batch_record_size(next), size + next_size > max_size) {
+            break;
+        }
+
+        // Every event takes its own credit, without blocking the batch
+        if (agentd_limits && limit_reached(agentd_limits, NULL)) {
+            break;
+        }
+
+        get_eps_credit(agentd_limits);
+
+        events[count++] = next;
+        size += next_size;
+        forward(j, agt->buflength + 1);
+    }
+
+    return count;
+}
+
+STATIC void buffer_send_batch(char ** events, int count) {
+    char * batch;
+    size_t length;
+    int k;
+
+    if (count == 1) {
+        send_msg(events[0], -1);
+        os_free(events[0]);
+        return;
+    }
+
+    os_malloc(OS_MAXSTR, batch);
+    length = snprintf(batch, OS_MAXSTR, "%s%s", CONTROL_HEADER, HC_BATCH);
+
+    for (k = 0; k < count; k++) {
+        size_t event_size = strlen(events[k]);
+
+        length += snprintf(batch + length, OS_MAXSTR - length, "%lu:", (unsigned long)event_size);
+        memcpy(batch + length, events[k], event_size);
+        length += event_size;
+        os_free(events[k]);
+    }
+
+    send_msg(batch, length);
+    os_free(batch);
+}
+
+STATIC void buffer_release_bytes(char ** events, int count) {
+    int k;
+
+    for (k = 0; k < count; k++) {
+        buffer_used_bytes -= strlen(events[k]);
+    }
+}
+
+STATIC void buffer_refill() {
+    char * event;
+
+    // Spilled events wait for the manager to be reachable
+    if (spill_size <= 0 || spill_empty() || w_agentd_state_get_status() != GA_STATUS_ACTIVE) {
+        return;
+    }
+
+    while (normal(i, j) && !full(i, j, agt->buflength + 1) && !bytes_full(0)) {
+        if (event = spill_pop(), !event) {
+            break;
+        }
+
+        buffer[i] = event;
+        buffer_used_bytes += strlen(event);
+        forward(i, agt->buflength + 1);
     }
 }
 
@@ -244,9 +413,8 @@ int w_agentd_get_buffer_lenght() {
     int retval = -1;
 
     if (agt->buffer > 0) {
-        w_mutex_lock(&mutex_lock);
-        retval = (i - j) % (agt->buflength + 1);
-        w_mutex_unlock(&mutex_lock);
+        // The indexes are published atomically, so the fill level is read without the buffer lock
+        retval = (__atomic_load_n(&i, __ATOMIC_ACQUIRE) - __atomic_load_n(&j, __ATOMIC_ACQUIRE)) % (agt->buflength + 1);
 
         retval = (retval < 0) ? (retval + agt->buflength + 1) : retval;
     }
@@ -23,6 +23,11 @@
 static FILE *fp = NULL;
 static char file_sum[34] = "";
 static char file[OS_SIZE_1024 + 1] = "";
+/* Version a delta being received applies to, and where it's written */
+static char patch_sum[34] = "";
+static char patch_file[OS_SIZE_1024 + 1] = "";
+
+static void set_shared_file(char *name);
 #ifdef WIN32
 w_queue_t * winexec_queue;
 #endif
@@ -222,30 +227,40 @@ int receive_msg()
 
                 /* Copy the file sum */
                 strncpy(file_sum, tmp_msg, 33);
+                patch_sum[0] = '\0';
 
-                /* Set tmp_msg to the beginning of the file name */
-                validate_file++;
-                tmp_msg = validate_file;
+                /* The file name follows the sum */
+                set_shared_file(validate_file + 1);
 
-                if ((validate_file = strchr(tmp_msg, '\n')) != NULL) {
-                    *validate_file = '\0';
+                fp = fopen(file, "w");
+                if (!fp) {
+                    merror(FOPEN_ERROR, file, errno, strerror(errno));
                 }
+            }
 
-                while ((validate_file = strchr(tmp_msg, '/')) != NULL) {
-                    *validate_file = '-';
-                }
+            /* Delta from the version of the file we have */
+            else if (strncmp(tmp_msg, FILE_PATCH_HEADER,
+                             strlen(FILE_PATCH_HEADER)) == 0) {
+                char *base_sum;
+                char *name;
+
+                tmp_msg += strlen(FILE_PATCH_HEADER);
 
-                if (tmp_msg[0] == '.') {
-                    tmp_msg[0] = '-';
+                if (base_sum = strchr(tmp_msg, ' '), !base_sum || (name = strchr(base_sum + 1, ' '), !name)) {
+                    continue;
                 }
 
-                snprintf(file, OS_SIZE_1024, "%s/%s",
-                         SHAREDCFG_DIR,
-                         tmp_msg);
+                *(base_sum++) = '\0';
+                *(name++) = '\0';
 
-                fp = fopen(file, "w");
+                strncpy(file_sum, tmp_msg, 33);
+                strncpy(patch_sum, base_sum, 33);
+                set_shared_file(name);
+                snprintf(patch_file, OS_SIZE_1024, "%s.patch", file);
+
+                fp = fopen(patch_file, "w");
                 if (!fp) {
-                    merror(FOPEN_ERROR, file, errno, strerror(errno));
+                    merror(FOPEN_ERROR, patch_file, errno, strerror(errno));
                 }
             }
 
@@ -254,6 +269,18 @@ int receive_msg()
                 /* No error */
                 os_md5 currently_md5;
 
+                /* Patch the version we have, the result is checked as a whole file */
+                if (patch_sum[0] && file[0] != '\0') {
+                    if (OS_MD5_File(file, currently_md5, OS_TEXT) < 0 || strcmp(currently_md5, patch_sum) != 0
+                        || w_delta_apply_file(file, patch_file, file) < 0) {
+                        mdebug1("Unable to apply the delta of '%s', the whole file will be sent.", file);
+                        file[0] = '\0';
+                    }
+
+                    unlink(patch_file);
+                    patch_sum[0] = '\0';
+                }
+
                 if (file[0] == '\0') {
                     /* Nothing to be done */
                 }
@@ -329,6 +356,28 @@ int receive_msg()
     return 0;
 }
 
+/* Set the path of a shared file from the name sent by the manager */
+static void set_shared_file(char *name)
+{
+    char *validate_file;
+
+    if ((validate_file = strchr(name, '\n')) != NULL) {
+        *validate_file = '\0';
+    }
+
+    while ((validate_file = strchr(name, '/')) != NULL) {
+        *validate_file = '-';
+    }
+
+    if (name[0] == '.') {
+        name[0] = '-';
+    }
+
+    snprintf(file, OS_SIZE_1024, "%s/%s",
+             SHAREDCFG_DIR,
+             name);
+}
+
 #ifdef WIN32
 /* Receive events from the server */
 DWORD WINAPI receiver_thread(__attribute__((unused)) LPVOID none)
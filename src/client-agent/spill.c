@@ -0,0 +1,294 @@
+/*
+ * Agent spill queue
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "agentd.h"
+#include "../external/zlib/zlib.h"
+
+#ifdef WIN32
+#include <io.h>
+#define spill_fsync(fd) _commit(fd)
+#define spill_dup(fd) _dup(fd)
+#define spill_fdclose(fd) _close(fd)
+#else
+#define spill_fsync(fd) fsync(fd)
+#define spill_dup(fd) dup(fd)
+#define spill_fdclose(fd) close(fd)
+#endif
+
+#define SPILL_SEGMENT_SIZE  (4 * 1024 * 1024)
+#define SPILL_EXTENSION     ".seg"
+
+/* Each event is framed with its length and its CRC-32 */
+typedef struct spill_record_t {
+    uint32_t length;
+    uint32_t crc;
+} spill_record_t;
+
+static struct {
+    char dir[PATH_MAX];
+    size_t max_size;        // Maximum bytes of all the segments
+    size_t size;            // Bytes of all the segments
+    int sync_events;        // Records written between fsync calls
+    int unsynced;
+    unsigned long head;     // Segment being read
+    unsigned long tail;     // Segment being written
+    FILE * read_fp;
+    long read_offset;
+    long read_size;
+    FILE * write_fp;
+    long write_size;
+} spill;
+
+static void spill_segment_path(char * path, unsigned long segment) {
+    snprintf(path, PATH_MAX, "%s/%010lu" SPILL_EXTENSION, spill.dir, segment);
+}
+
+/* Close and remove the segment being read, moving to the next one */
+static void spill_drop_head() {
+    char path[PATH_MAX];
+    off_t size;
+
+    if (spill.read_fp) {
+        fclose(spill.read_fp);
+        spill.read_fp = NULL;
+    }
+
+    if (spill.head == spill.tail && spill.write_fp) {
+        fclose(spill.write_fp);
+        spill.write_fp = NULL;
+        spill.write_size = 0;
+        spill.unsynced = 0;
+        spill.tail++;
+    }
+
+    spill_segment_path(path, spill.head);
+
+    if (size = FileSize(path), size > 0) {
+        spill.size = spill.size > (size_t)size ? spill.size - size : 0;
+    }
+
+    if (unlink(path) < 0 && errno != ENOENT) {
+        mwarn("Couldn't remove spill segment '%s': %s (%d)", path, strerror(errno), errno);
+    }
+
+    spill.head++;
+    spill.read_offset = 0;
+    spill.read_size = 0;
+}
+
+/* Flush the segment being written and sync it, now or by the caller through a duplicate descriptor */
+static void spill_sync_segment(int * sync_fd) {
+    fflush(spill.write_fp);
+
+    if (!sync_fd || (*sync_fd = spill_dup(fileno(spill.write_fp))) < 0) {
+        spill_fsync(fileno(spill.write_fp));
+    }
+
+    spill.unsynced = 0;
+}
+
+int spill_init(const char * dir, size_t max_size, int sync_events) {
+    char ** files;
+    int k;
+
+    memset(&spill, 0, sizeof(spill));
+    snprintf(spill.dir, sizeof(spill.dir), "%s", dir);
+    spill.max_size = max_size;
+    spill.sync_events = sync_events > 0 ? sync_events : 1;
+
+    if (mkdir_ex(dir) < 0) {
+        return -1;
+    }
+
+    if (files = wreaddir(dir), !files) {
+        merror("Couldn't open spill directory '%s': %s (%d)", dir, strerror(errno), errno);
+        return -1;
+    }
+
+    spill.head = ULONG_MAX;
+
+    // Segments left by a previous run are sent first
+    for (k = 0; files[k]; k++) {
+        char path[PATH_MAX];
+        char * end;
+        unsigned long segment = strtoul(files[k], &end, 10);
+        off_t size;
+
+        if (end == files[k] || strcmp(end, SPILL_EXTENSION) != 0) {
+            continue;
+        }
+
+        spill_segment_path(path, segment);
+
+        if (size = FileSize(path), size < 0) {
+            continue;
+        }
+
+        spill.size += size;
+        spill.head = segment < spill.head ? segment : spill.head;
+        spill.tail = segment >= spill.tail ? segment + 1 : spill.tail;
+    }
+
+    free_strarray(files);
+
+    if (spill.head == ULONG_MAX) {
+        spill.head = spill.tail;
+    } else {
+        minfo("Found %lu bytes of spilled events.", (unsigned long)spill.size);
+    }
+
+    return 0;
+}
+
+int spill_push(const char * msg, int * sync_fd) {
+    spill_record_t record;
+    size_t length = strlen(msg);
+
+    if (sync_fd) {
+        *sync_fd = -1;
+    }
+
+    if (spill.size + sizeof(record) + length > spill.max_size) {
+        return -1;
+    }
+
+    if (spill.write_fp && spill.write_size > 0 && spill.write_size + sizeof(record) + length > SPILL_SEGMENT_SIZE) {
+        spill_sync_segment(sync_fd);
+        fclose(spill.write_fp);
+
+        // The reader keeps the whole segment
+        if (spill.head == spill.tail) {
+            spill.read_size = spill.write_size;
+        }
+
+        spill.write_fp = NULL;
+        spill.write_size = 0;
+        spill.unsynced = 0;
+        spill.tail++;
+    }
+
+    if (!spill.write_fp) {
+        char path[PATH_MAX];
+
+        spill_segment_path(path, spill.tail);
+
+        if (spill.write_fp = fopen(path, "ab"), !spill.write_fp) {
+            merror(FOPEN_ERROR, path, errno, strerror(errno));
+            return -1;
+        }
+    }
+
+    record.length = length;
+    record.crc = crc32(0L, (const Bytef *)msg, length);
+
+    if (fwrite(&record, sizeof(record), 1, spill.write_fp) != 1 || fwrite(msg, 1, length, spill.write_fp) != length) {
+        merror("Couldn't write to spill segment %lu: %s (%d)", spill.tail, strerror(errno), errno);
+        return -1;
+    }
+
+    spill.write_size += sizeof(record) + length;
+    spill.size += sizeof(record) + length;
+
+    // If the previous segment is being synced, this one waits for the next event
+    if (++spill.unsynced >= spill.sync_events && (!sync_fd || *sync_fd < 0)) {
+        spill_sync_segment(sync_fd);
+    }
+
+    return 0;
+}
+
+void spill_sync(int fd) {
+    if (fd >= 0) {
+        spill_fsync(fd);
+        spill_fdclose(fd);
+    }
+}
+
+char * spill_pop() {
+    spill_record_t record;
+    char * msg;
+
+    while (!spill_empty()) {
+        if (!spill.read_fp) {
+            char path[PATH_MAX];
+
+            spill_segment_path(path, spill.head);
+
+            if (spill.read_fp = fopen(path, "rb"), !spill.read_fp) {
+                if (errno != ENOENT) {
+                    merror(FOPEN_ERROR, path, errno, strerror(errno));
+                }
+
+                spill_drop_head();
+                continue;
+            }
+
+            spill.read_size = spill.head == spill.tail ? spill.write_size : get_fp_size(spill.read_fp);
+        }
+
+        if (spill.head == spill.tail) {
+            // The records of the segment being written may be in the file buffer yet
+            fflush(spill.write_fp);
+            spill.read_size = spill.write_size;
+        }
+
+        if (spill.read_offset >= spill.read_size) {
+            spill_drop_head();
+            continue;
+        }
+
+        if (fseek(spill.read_fp, spill.read_offset, SEEK_SET) < 0 || fread(&record, sizeof(record), 1, spill.read_fp) != 1
+            || record.length > OS_MAXSTR || spill.read_offset + (long)(sizeof(record) + record.length) > spill.read_size) {
+            mwarn("Discarding truncated spill segment %lu.", spill.head);
+            spill_drop_head();
+            continue;
+        }
+
+        os_malloc(record.length + 1, msg);
+
+        if (fread(msg, 1, record.length, spill.read_fp) != record.length
+            || crc32(0L, (const Bytef *)msg, record.length) != record.crc) {
+            mwarn("Discarding corrupted spill segment %lu.", spill.head);
+            os_free(msg);
+            spill_drop_head();
+            continue;
+        }
+
+        msg[record.length] = '\0';
+        spill.read_offset += sizeof(record) + record.length;
+
+        // Reclaim the disk as soon as the queue is drained
+        if (spill_empty()) {
+            spill_drop_head();
+        }
+
+        return msg;
+    }
+
+    return NULL;
+}
+
+int spill_empty() {
+    return spill.head == spill.tail && spill.read_offset >= spill.write_size;
+}
+
+void spill_close() {
+    if (spill.read_fp) {
+        fclose(spill.read_fp);
+        spill.read_fp = NULL;
+    }
+
+    if (spill.write_fp) {
+        spill_sync_segment(NULL);
+        fclose(spill.write_fp);
+        spill.write_fp = NULL;
+    }
+}
@@ -217,6 +217,17 @@ void w_agentd_state_update(w_agentd_state_update_t type, void * data) {
     return;
 }
 
+agent_status_t w_agentd_state_get_status() {
+
+    agent_status_t status;
+
+    w_mutex_lock(&state_mutex);
+    status = agent_state.status;
+    w_mutex_unlock(&state_mutex);
+
+    return status;
+}
+
 char * w_agentd_state_get() {
 
     const char * status = NULL;
@@ -71,6 +71,12 @@ void * state_main(__attribute__((unused)) void * args);
  */
 void w_agentd_state_update(w_agentd_state_update_t type, void * data);
 
+/**
+ * @brief Get the agent status
+ * @return Agent status
+ */
+agent_status_t w_agentd_state_get_status();
+
 /**
  * @brief Returns statistics in real time
  * @return Statistics in raw json format
@@ -61,6 +61,8 @@ typedef struct authd_config_t {
     char *manager_key;
     long timeout_sec;
     long timeout_usec;
+    int dispatch_threads;
+    bool append_keys;
     bool worker_node;
     bool ipv6;
     bool allow_higher_versions;
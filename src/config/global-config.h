@@ -125,6 +125,9 @@ typedef struct __Config {
     int label_cache_maxage;
     int show_hidden_labels;
 
+    /* Integrity sync interval suggested to the agents (seconds) */
+    int dbsync_interval_hint;
+
     // Cluster configuration
     char *cluster_name;
     char *node_name;
@@ -134,6 +137,8 @@ typedef struct __Config {
     int rotate_interval;
     int min_rotate_interval;
     ssize_t max_output_size;
+    size_t output_buffer_size;
+    int output_sync_interval;
     long queue_size;
 
     // EPS limits configuration
@@ -28,6 +28,8 @@ int Read_Integrator(XML_NODE node, void *config, __attribute__((unused)) void *c
     char *xml_integrator_options = "options";
     char *xml_integrator_timeout = "timeout";
     char *xml_integrator_retries = "retries";
+    char *xml_integrator_workers = "workers";
+    char *xml_integrator_batch_size = "batch_size";
 
     IntegratorConfig **integrator_config = *(IntegratorConfig ***)config;
 
@@ -58,6 +60,8 @@ int Read_Integrator(XML_NODE node, void *config, __attribute__((unused)) void *c
     integrator_config[s]->max_log = 165;
     integrator_config[s]->timeout = 10;
     integrator_config[s]->retries = 3;
+    integrator_config[s]->workers = 0;
+    integrator_config[s]->batch_size = 1;
 
     while(node[i])
     {
@@ -211,6 +215,34 @@ int Read_Integrator(XML_NODE node, void *config, __attribute__((unused)) void *c
 
             integrator_config[s]->retries = atoi(node[i]->content);
         }
+        else if (strcmp(node[i]->element, xml_integrator_workers) == 0)
+        {
+            if (!OS_StrIsNum(node[i]->content)) {
+                merror(XML_VALUEERR, node[i]->element, node[i]->content);
+                return(OS_INVALID);
+            }
+
+            integrator_config[s]->workers = atoi(node[i]->content);
+
+            if (integrator_config[s]->workers > 64) {
+                merror(XML_VALUEERR, node[i]->element, node[i]->content);
+                return(OS_INVALID);
+            }
+        }
+        else if (strcmp(node[i]->element, xml_integrator_batch_size) == 0)
+        {
+            if (!OS_StrIsNum(node[i]->content)) {
+                merror(XML_VALUEERR, node[i]->element, node[i]->content);
+                return(OS_INVALID);
+            }
+
+            integrator_config[s]->batch_size = atoi(node[i]->content);
+
+            if (integrator_config[s]->batch_size < 1 || integrator_config[s]->batch_size > 1000) {
+                merror(XML_VALUEERR, node[i]->element, node[i]->content);
+                return(OS_INVALID);
+            }
+        }
         else
         {
             merror(XML_INVELEM, node[i]->element);
@@ -26,6 +26,8 @@ typedef struct _IntegratorConfig
     unsigned int max_log;
     unsigned int timeout;
     unsigned int retries;
+    unsigned int workers;       /* Long-lived senders, 0 runs the script once per alert */
+    unsigned int batch_size;    /* Alerts written to a worker at once */
 
     char *name;
     char *apikey;
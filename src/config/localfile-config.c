@@ -378,6 +378,9 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
                 }
 #endif
 
+            } else if (strcmp(logf[pl].logformat, JOURNALD) == 0) {
+                os_calloc(1, sizeof(w_journald_config_t), logf[pl].journald);
+                w_mutex_init(&logf[pl].journald->mutex, NULL);
             } else {
                 merror(XML_VALUEERR, node[i]->element, node[i]->content);
                 return (OS_INVALID);
@@ -527,6 +530,9 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
         i++;
     }
 
+    /* Any ignore expression drops the log, so the PCRE2 ones are matched at once */
+    w_expression_merge_pcre2(logf[pl].regex_ignore);
+
     if (logf[pl].target == NULL) {
         os_calloc(2, sizeof(char*), logf[pl].target);
         os_strdup("agent", logf[pl].target[0]);
@@ -544,6 +550,8 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
             mwarn(LOGCOLLECTOR_MISSING_LOCATION_MACOS);
             // Neceesary to check duplicated blocks
             os_strdup(MACOS, logf[pl].file);
+        } else if (strcmp(logf[pl].logformat, JOURNALD) == 0) {
+            os_strdup(JOURNALD, logf[pl].file);
         } else {
             merror(MISS_FILE);
             os_strdup("", logf[pl].file);
@@ -587,6 +595,32 @@ int Read_Localfile(XML_NODE node, void *d1, __attribute__((unused)) void *d2)
             mwarn(LOGCOLLECTOR_OPTION_IGNORED, MACOS, xml_localfile_alias);
         }
     }
+    /* Verify journald config */
+    if (strcmp(logf[pl].logformat, JOURNALD) == 0) {
+
+        if (strcmp(logf[pl].file, JOURNALD) != 0) {
+            mwarn(LOGCOLLECTOR_INV_JOURNALD, logf[pl].file);
+            os_free(logf[pl].file);
+            // Necessary to check duplicated blocks
+            w_strdup(JOURNALD, logf[pl].file);
+        }
+
+        if (logf[pl].age != 0) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_age);
+        }
+        if (logf[pl].filter_binary != 0) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_binaries);
+        }
+        if (logf[pl].exclude != NULL) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_exclude);
+        }
+        if (logf[pl].multiline != NULL) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_multiline_regex);
+        }
+        if (logf[pl].ign != DEFAULT_FREQUENCY_SECS) {
+            mwarn(LOGCOLLECTOR_OPTION_IGNORED, JOURNALD, xml_localfile_frequency);
+        }
+    }
     /* Verify Multiline Regex Config */
     if (strcmp(logf[pl].logformat, MULTI_LINE_REGEX) == 0) {
 
@@ -806,6 +840,12 @@ void Free_Logreader(logreader * logf) {
         os_free(logf->exclude);
         os_free(logf->query_level);
 
+        if (logf->journald) {
+            os_free(logf->journald->cursor);
+            pthread_mutex_destroy(&logf->journald->mutex);
+            os_free(logf->journald);
+        }
+
         if (logf->regex_ignore) {
             OSList_Destroy(logf->regex_ignore);
             logf->regex_ignore = NULL;
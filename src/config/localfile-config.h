@@ -14,6 +14,7 @@
 #define EVENTLOG     "eventlog"
 #define EVENTCHANNEL "eventchannel"
 #define MACOS        "macos"
+#define JOURNALD     "journald"
 #define MULTI_LINE_REGEX              "multi-line-regex"
 #define MULTI_LINE_REGEX_TIMEOUT      5
 #define MULTI_LINE_REGEX_MAX_TIMEOUT  120
@@ -61,6 +62,7 @@ typedef struct _outformat {
 typedef struct _logtarget {
     char * format;
     socket_forwarder * log_socket;
+    struct w_msg_queue_t * queue;   ///< Output queue of the socket, resolved at startup
 } logtarget;
 
 /* Logreader config */
@@ -157,6 +159,17 @@ typedef struct {
     bool store_current_settings;        ///< True if current_settings is stored in vault
 } w_macos_log_config_t;
 
+/**
+ * @brief An instance of w_journald_config_t represents the state of the systemd journal reader
+ */
+typedef struct {
+    void * journal;             ///< sd_journal handle, NULL until the journal is opened
+    char * cursor;              ///< Cursor of the last entry read
+    bool cursor_saved;          ///< True if the cursor is stored in the cursor file
+    bool disabled;              ///< True if the journal couldn't be opened, it is not retried
+    pthread_mutex_t mutex;      ///< Protects the cursor, which the main thread saves
+} w_journald_config_t;
+
 /* Logreader config */
 typedef struct _logreader {
     off_t size;
@@ -169,6 +182,9 @@ typedef struct _logreader {
 #else
     ino_t fd;
 #endif
+    int wd;                 ///< Watch descriptor of the file, 0 if it is polled
+    unsigned int wd_events; ///< Events of the watch when the file was last read
+    int pending;            ///< The last read left lines in the file, any input thread may read them
 
     /* ffile - format file is only used when
      * the file has format string to retrieve
@@ -179,6 +195,7 @@ typedef struct _logreader {
     char *logformat;
     w_multiline_config_t * multiline; ///< Multiline regex config & state
     w_macos_log_config_t * macos_log;   ///< macOS log config & state
+    w_journald_config_t * journald;     ///< systemd journal state
     long linecount;
     char *djb_program_name;
     char * channel_str;
@@ -216,6 +233,9 @@ typedef struct _logreader_glob {
     char *exclude_path;
     int num_files;
     logreader *gfiles;
+    int wd;                 ///< Watch descriptor of the pattern directory, 0 if it is not watched
+    unsigned int wd_events; ///< Events of the directory at the last complete expansion
+    int expanded_files;     ///< Files of the pattern after the last complete expansion
 } logreader_glob;
 
 typedef struct _logreader_config {
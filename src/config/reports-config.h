@@ -35,6 +35,8 @@ typedef struct _monitor_config {
     int keep_log_days;
     unsigned long size_rotate;
     int daily_rotations;
+    int compress_level;
+    int compress_threads;
 
     char *smtpserver;
     char *emailfrom;
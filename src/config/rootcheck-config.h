@@ -38,6 +38,7 @@ typedef struct _rkconfig {
     int disabled;
     short skip_nfs;
     int tsleep;
+    int pid_slices;
 
     int time;
     int queue;
@@ -38,6 +38,7 @@ directory_t *fim_create_directory(const char *path,
     os_strdup(path, new_entry->path);
     new_entry->is_wildcard = is_wildcard;
     new_entry->is_expanded = 0;
+    os_calloc(1, sizeof(fim_scan_stats_t), new_entry->stats);
 
 #ifndef WIN32
     if (CHECK_FOLLOW & options) {
@@ -124,12 +125,21 @@ int initialize_syscheck_configuration(syscheck_config *syscheck) {
     syscheck->sync_queue_size                 = 16384;
     syscheck->max_eps                         = 50;
     syscheck->max_files_per_second            = 0;
+    syscheck->scan_threads                    = 1;
+    syscheck->fast_rescan                     = 0;
+    syscheck->fast_rescan_full_verify         = 10;
+    syscheck->inode_index                     = 0;
+    syscheck->memory_snapshot                 = 0;
+    syscheck->snapshot_restored               = 0;
+    syscheck->usn_journal                     = 0;
+    syscheck->usn_full_verify                 = 10;
     syscheck->allow_remote_prefilter_cmd      = false;
     syscheck->disk_quota_enabled              = true;
     syscheck->disk_quota_limit                = 1024 * 1024; // 1 GB
     syscheck->file_size_enabled               = true;
     syscheck->file_size_limit                 = 50 * 1024;   // 50 MB
     syscheck->diff_folder_size                = 0;
+    syscheck->diff_chunked                    = 0;
     syscheck->comp_estimation_perc            = 0.9;         // 90%
     syscheck->disk_quota_full_msg             = true;
     syscheck->audit_key                       = NULL;
@@ -1369,6 +1379,7 @@ void parse_diff(const OS_XML *xml, syscheck_config * syscheck, XML_NODE node) {
     const char *xml_file_size = "file_size";
     const char *xml_file_size_enabled = "enabled";
     const char *xml_file_size_limit = "limit";
+    const char *xml_chunked_storage = "chunked_storage";
     const char *xml_nodiff = "nodiff";
 #ifdef WIN32
     const char *xml_registry_nodiff = "registry_nodiff";
@@ -1606,6 +1617,17 @@ void parse_diff(const OS_XML *xml, syscheck_config * syscheck, XML_NODE node) {
 
             OS_ClearNode(children);
         }
+        else if (strcmp(node[i]->element, xml_chunked_storage) == 0) {
+            if (strcmp(node[i]->content, "yes") == 0) {
+                syscheck->diff_chunked = 1;
+            }
+            else if (strcmp(node[i]->content, "no") == 0) {
+                syscheck->diff_chunked = 0;
+            }
+            else {
+                mwarn(XML_VALUEERR, node[i]->element, node[i]->content);
+            }
+        }
     }
 
     if (syscheck->file_size_enabled && syscheck->disk_quota_limit < syscheck->file_size_limit) {
@@ -1654,6 +1676,13 @@ int Read_Syscheck(const OS_XML *xml, XML_NODE node, void *configp, __attribute__
     const char *xml_restart_audit = "restart_audit";
     const char *xml_windows_audit_interval = "windows_audit_interval";
     const char *xml_max_files_per_second = "max_files_per_second";
+    const char *xml_scan_threads = "scan_threads";
+    const char *xml_fast_rescan = "fast_rescan";
+    const char *xml_fast_rescan_full_verify = "fast_rescan_full_verify";
+    const char *xml_inode_index = "inode_index";
+    const char *xml_memory_snapshot = "memory_snapshot";
+    const char *xml_usn_journal = "usn_journal";
+    const char *xml_usn_full_verify = "usn_full_verify";
 #ifdef WIN32
     const char *xml_arch = "arch";
     const char *xml_32bit = "32bit";
@@ -2200,6 +2229,65 @@ int Read_Syscheck(const OS_XML *xml, XML_NODE node, void *configp, __attribute__
             }
             syscheck->max_files_per_second = atoi(node[i]->content);
 
+        } else if (strcmp(node[i]->element, xml_scan_threads) == 0) {
+            char * end;
+            long value = strtol(node[i]->content, &end, 10);
+
+            if (value < 1 || value > 256 || *end) {
+                mwarn(XML_VALUEERR, node[i]->element, node[i]->content);
+            } else {
+                syscheck->scan_threads = value;
+            }
+        } else if (strcmp(node[i]->element, xml_fast_rescan) == 0) {
+            if (strcmp(node[i]->content, "yes") == 0) {
+                syscheck->fast_rescan = 1;
+            } else if (strcmp(node[i]->content, "no") == 0) {
+                syscheck->fast_rescan = 0;
+            } else {
+                mwarn(XML_VALUEERR, node[i]->element, node[i]->content);
+            }
+        } else if (strcmp(node[i]->element, xml_fast_rescan_full_verify) == 0) {
+            char * end;
+            long value = strtol(node[i]->content, &end, 10);
+
+            if (value < 0 || value > 1000000 || *end) {
+                mwarn(XML_VALUEERR, node[i]->element, node[i]->content);
+            } else {
+                syscheck->fast_rescan_full_verify = value;
+            }
+        } else if (strcmp(node[i]->element, xml_usn_journal) == 0) {
+            if (strcmp(node[i]->content, "yes") == 0) {
+                syscheck->usn_journal = 1;
+            } else if (strcmp(node[i]->content, "no") == 0) {
+                syscheck->usn_journal = 0;
+            } else {
+                mwarn(XML_VALUEERR, node[i]->element, node[i]->content);
+            }
+        } else if (strcmp(node[i]->element, xml_usn_full_verify) == 0) {
+            char * end;
+            long value = strtol(node[i]->content, &end, 10);
+
+            if (value < 0 || value > 1000000 || *end) {
+                mwarn(XML_VALUEERR, node[i]->element, node[i]->content);
+            } else {
+                syscheck->usn_full_verify = value;
+            }
+        } else if (strcmp(node[i]->element, xml_inode_index) == 0) {
+            if (strcmp(node[i]->content, "yes") == 0) {
+                syscheck->inode_index = 1;
+            } else if (strcmp(node[i]->content, "no") == 0) {
+                syscheck->inode_index = 0;
+            } else {
+                mwarn(XML_VALUEERR, node[i]->element, node[i]->content);
+            }
+        } else if (strcmp(node[i]->element, xml_memory_snapshot) == 0) {
+            if (strcmp(node[i]->content, "yes") == 0) {
+                syscheck->memory_snapshot = 1;
+            } else if (strcmp(node[i]->content, "no") == 0) {
+                syscheck->memory_snapshot = 0;
+            } else {
+                mwarn(XML_VALUEERR, node[i]->element, node[i]->content);
+            }
         } else {
             mwarn(XML_INVELEM, node[i]->element);
         }
@@ -2335,6 +2423,13 @@ void free_directory(directory_t *dir) {
     os_free(dir->symbolic_links);
     os_free(dir->tag);
 
+    if (dir->stats) {
+        for (int i = 0; i < FIM_SCAN_STATS_SLOWEST; i++) {
+            os_free(dir->stats->slowest[i].path);
+        }
+        os_free(dir->stats);
+    }
+
     if (dir->filerestrict) {
         OSMatch_FreePattern(dir->filerestrict);
         free(dir->filerestrict);
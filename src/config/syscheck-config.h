@@ -153,8 +153,16 @@ typedef struct whodata_dir_status whodata_dir_status;
 #ifndef WIN32
 typedef struct _rtfim {
     unsigned int queue_overflow:1;
-    OSHash *dirtb;
+    unsigned int pending_full:1;                       /* The pending paths reached rt_coalesce_max */
+    unsigned int fanotify:1;                           /* fd is a fanotify descriptor with filesystem marks */
+    OSHash *dirtb;                                     /* Directories by watch, or by device with fanotify */
+    OSHash *mounts;                                    /* Descriptors to resolve the fanotify file handles, by fsid */
     int fd;
+    rb_tree *pending;                                  /* Paths waiting for the coalescing window to end */
+    struct timespec pending_since;                     /* Time of the first pending event */
+    unsigned int pending_peak;                         /* Maximum number of pending paths */
+    unsigned int coalesced;                            /* Events merged with a pending event of the same path */
+    unsigned int overflows;                            /* Times the kernel queue overflowed and dropped events */
 } rtfim;
 
 #else
@@ -198,6 +206,33 @@ typedef struct whodata {
 
 #endif /* End WIN32*/
 
+#define FIM_SCAN_STATS_SLOWEST 10
+
+typedef enum fim_scan_counter {
+    FIM_STATS_FILES,            ///< Paths visited by the scan.
+    FIM_STATS_HASHED_FILES,
+    FIM_STATS_HASHED_BYTES,
+    FIM_STATS_STAT_TIME,        ///< Nanoseconds.
+    FIM_STATS_HASH_TIME,        ///< Nanoseconds.
+    FIM_STATS_DB_TIME,          ///< Nanoseconds.
+    FIM_STATS_SKIPPED_IGNORE,
+    FIM_STATS_SKIPPED_RESTRICT,
+    FIM_STATS_SKIPPED_DEPTH,
+    FIM_STATS_COUNTERS
+} fim_scan_counter_t;
+
+typedef struct fim_slow_file {
+    char *path;
+    int64_t nsec;
+} fim_slow_file_t;
+
+/* Cost of the last scheduled scan of a directory block */
+typedef struct fim_scan_stats {
+    uint64_t counters[FIM_STATS_COUNTERS];
+    char slowest_lock;
+    fim_slow_file_t slowest[FIM_SCAN_STATS_SLOWEST];   // Longest hash times, slowest first
+} fim_scan_stats_t;
+
 typedef struct _directory_s {
     char *path;
     int options;
@@ -212,6 +247,7 @@ typedef struct _directory_s {
 #endif
     unsigned int is_wildcard:1; // 1 if it is a wildcard, 0 if it is a directory
     unsigned int is_expanded:1; // Indicates if the wilcard has been expanded in this scan
+    fim_scan_stats_t *stats;
 } directory_t;
 
 typedef struct whodata_evt {
@@ -369,6 +405,9 @@ typedef struct _config {
 
     fs_set skip_fs;
     int rt_delay;                                      /* Delay before real-time dispatching (ms) */
+    int rt_coalesce_window;                            /* Time the real-time events of a path are merged during (ms) */
+    int rt_coalesce_max;                               /* Maximum number of paths waiting in the coalescing window */
+    int rt_fanotify;                                   /* Use fanotify filesystem marks for real-time */
 
     int time;                                          /* frequency (secs) for syscheck to run */
     int queue;                                         /* file descriptor of socket to write to queue */
@@ -395,10 +434,19 @@ typedef struct _config {
     int file_size_enabled;                             /* Enable diff file size limit */
     int file_size_limit;                               /* Avoids generating a backup from a file bigger than this limit (in KB) */
     float diff_folder_size;                            /* Save size of queue/diff/local folder */
+    int diff_chunked;                                  /* Store the copies of the files in content-defined chunks */
     float comp_estimation_perc;                        /* Estimation of the percentage of compression each file will have */
     uint16_t disk_quota_full_msg;                      /* Specify if the full disk_quota message can be written (Once per scan) */
 
     unsigned int max_files_per_second;                 /* Max number of files read per second. */
+    int scan_threads;                                  /* Number of threads hashing files in scheduled scans */
+    int fast_rescan;                                   /* Only hash files whose metadata changed in scheduled scans */
+    int fast_rescan_full_verify;                       /* Every how many scheduled scans all files are hashed (0: never) */
+    int inode_index;                                   /* Keep the inodes of the files in memory for the inode lookups */
+    int memory_snapshot;                               /* Save the memory database to disk after each scan and load it on start */
+    int snapshot_restored;                             /* The memory database was loaded from a snapshot */
+    int usn_journal;                                   /* Check only the files changed in the USN journals between full scans (Windows) */
+    int usn_full_verify;                               /* Every how many scheduled scans the directories are walked (0: never) */
 
     char **nodiff;                                     /* list of files/dirs to never output diff */
     OSMatch **nodiff_regex;                            /* regex of files/dirs to never output diff */
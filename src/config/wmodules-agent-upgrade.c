@@ -22,6 +22,8 @@ static const char *XML_CA_STORE = "ca_store";
 static const char *XML_WPK_REPOSITORY = "wpk_repository";
 static const char *XML_CHUNK_SIZE = "chunk_size";
 static const char *XML_MAX_THREADS = "max_threads";
+static const char *XML_CHUNK_WINDOW = "chunk_window";
+static const char *XML_RATE_LIMIT = "rate_limit";
 #endif
 
 #ifdef CLIENT
@@ -50,6 +52,8 @@ int wm_agent_upgrade_read(__attribute__((unused)) const OS_XML *xml, xml_node **
         #else
         data->manager_config.max_threads = WM_UPGRADE_MAX_THREADS;
         data->manager_config.chunk_size = WM_UPGRADE_CHUNK_SIZE;
+        data->manager_config.chunk_window = WM_UPGRADE_CHUNK_WINDOW;
+        data->manager_config.rate_limit = 0;
         data->manager_config.wpk_repository = NULL;
         #endif
         module->data = data;
@@ -167,13 +171,31 @@ int wm_agent_upgrade_read(__attribute__((unused)) const OS_XML *xml, xml_node **
             if (!max_threads) {
                 // If 0, we assign the number of cpu cores
                 data->manager_config.max_threads = get_nproc();
-            } else if (max_threads <= 256) {
+            } else if (max_threads <= WM_UPGRADE_MAX_THREADS_LIMIT) {
                 data->manager_config.max_threads = max_threads;
             } else {
                 merror("Invalid content for tag '%s' at module '%s'.", XML_MAX_THREADS, WM_AGENT_UPGRADE_CONTEXT.name);
                 return (OS_INVALID);
             }
 
+        } else if (!strcmp(nodes[i]->element, XML_CHUNK_WINDOW)) {
+            int chunk_window;
+            if (!OS_StrIsNum(nodes[i]->content) || (chunk_window = atoi(nodes[i]->content), chunk_window < 1 || chunk_window > WM_UPGRADE_CHUNK_WINDOW_LIMIT)) {
+                merror("Invalid content for tag '%s' at module '%s'.", XML_CHUNK_WINDOW, WM_AGENT_UPGRADE_CONTEXT.name);
+                return (OS_INVALID);
+            }
+
+            data->manager_config.chunk_window = chunk_window;
+
+        } else if (!strcmp(nodes[i]->element, XML_RATE_LIMIT)) {
+            long rate_limit;
+            if (!OS_StrIsNum(nodes[i]->content) || (rate_limit = atol(nodes[i]->content), rate_limit > 1048576)) {
+                merror("Invalid content for tag '%s' at module '%s'.", XML_RATE_LIMIT, WM_AGENT_UPGRADE_CONTEXT.name);
+                return (OS_INVALID);
+            }
+
+            data->manager_config.rate_limit = rate_limit;
+
         } else if (!strcmp(nodes[i]->element, XML_WPK_REPOSITORY)) {
             os_free(data->manager_config.wpk_repository);
             os_strdup(nodes[i]->content, data->manager_config.wpk_repository);
@@ -23,6 +23,37 @@ static const char *XML_PORTS = "ports";
 static const char *XML_PROCS = "processes";
 static const char *XML_HOTFIXES = "hotfixes";
 static const char *XML_SYNC = "synchronization";
+static const char *XML_JITTER = "jitter";
+static const char *XML_DELTA_BATCH_SIZE = "delta_batch_size";
+static const char *XML_PORTS_ALL = "all";
+
+// Interval of an inventory, set with the attribute of its tag
+static int parse_inventory_interval(const xml_node *node, const char *attribute, const char *value, unsigned int *interval) {
+    long seconds;
+
+    if (strcmp(attribute, XML_INTERVAL)) {
+        merror("Invalid attribute for tag '%s' at module '%s'.", node->element, WM_SYS_CONTEXT.name);
+        return OS_INVALID;
+    }
+
+    if (seconds = w_parse_time(value), seconds <= 0 || seconds >= UINT_MAX) {
+        merror("Invalid interval for tag '%s' at module '%s'.", node->element, WM_SYS_CONTEXT.name);
+        return OS_INVALID;
+    }
+
+    *interval = (unsigned int)seconds;
+    return 0;
+}
+
+static int parse_inventory_attributes(const xml_node *node, unsigned int *interval) {
+    for (int j = 0; node->attributes && node->attributes[j]; j++) {
+        if (parse_inventory_interval(node, node->attributes[j], node->values[j], interval) < 0) {
+            return OS_INVALID;
+        }
+    }
+
+    return 0;
+}
 
 static void parse_synchronization_section(wm_sys_t * syscollector, XML_NODE node) {
     const char *XML_DB_SYNC_MAX_EPS = "max_eps";
@@ -112,6 +143,26 @@ int wm_syscollector_read(const OS_XML *xml, XML_NODE node, wmodule *module) {
                 merror("Invalid interval at module '%s'", WM_SYS_CONTEXT.name);
                 return OS_INVALID;
             }
+        } else if (!strcmp(node[i]->element, XML_JITTER)) {
+            const long jitter = w_parse_time(node[i]->content);
+
+            if (jitter < 0 || jitter >= UINT_MAX) {
+                merror("Invalid jitter at module '%s'", WM_SYS_CONTEXT.name);
+                return OS_INVALID;
+            }
+
+            syscollector->jitter = (unsigned int)jitter;
+        } else if (!strcmp(node[i]->element, XML_DELTA_BATCH_SIZE)) {
+            char *end;
+            const long size = strtol(node[i]->content, &end, 10);
+
+            // Disabled by default, the managers that predate the batches would reject them
+            if (size < 0 || size > 1000 || *end) {
+                merror("Invalid content for tag '%s' at module '%s'.", XML_DELTA_BATCH_SIZE, WM_SYS_CONTEXT.name);
+                return OS_INVALID;
+            }
+
+            syscollector->delta_batch_size = (unsigned int)size;
         } else if (!strcmp(node[i]->element, XML_SCAN_ON_START)) {
             if (!strcmp(node[i]->content, "yes"))
                 syscollector->flags.scan_on_start = 1;
@@ -131,6 +182,9 @@ int wm_syscollector_read(const OS_XML *xml, XML_NODE node, wmodule *module) {
                 return OS_INVALID;
             }
         } else if (!strcmp(node[i]->element, XML_NETWORK)) {
+            if (parse_inventory_attributes(node[i], &syscollector->intervals.netinfo) < 0) {
+                return OS_INVALID;
+            }
             if (!strcmp(node[i]->content, "yes"))
                 syscollector->flags.netinfo = 1;
             else if (!strcmp(node[i]->content, "no"))
@@ -140,6 +194,9 @@ int wm_syscollector_read(const OS_XML *xml, XML_NODE node, wmodule *module) {
                 return OS_INVALID;
             }
         } else if (!strcmp(node[i]->element, XML_OS_SCAN)) {
+            if (parse_inventory_attributes(node[i], &syscollector->intervals.osinfo) < 0) {
+                return OS_INVALID;
+            }
             if (!strcmp(node[i]->content, "yes"))
                 syscollector->flags.osinfo = 1;
             else if (!strcmp(node[i]->content, "no"))
@@ -149,6 +206,9 @@ int wm_syscollector_read(const OS_XML *xml, XML_NODE node, wmodule *module) {
                 return OS_INVALID;
             }
         } else if (!strcmp(node[i]->element, XML_HARDWARE)) {
+            if (parse_inventory_attributes(node[i], &syscollector->intervals.hwinfo) < 0) {
+                return OS_INVALID;
+            }
             if (!strcmp(node[i]->content, "yes"))
                 syscollector->flags.hwinfo = 1;
             else if (!strcmp(node[i]->content, "no"))
@@ -158,6 +218,9 @@ int wm_syscollector_read(const OS_XML *xml, XML_NODE node, wmodule *module) {
                 return OS_INVALID;
             }
         } else if (!strcmp(node[i]->element, XML_PACKAGES)) {
+            if (parse_inventory_attributes(node[i], &syscollector->intervals.programinfo) < 0) {
+                return OS_INVALID;
+            }
             if (!strcmp(node[i]->content, "yes"))
                 syscollector->flags.programinfo = 1;
             else if (!strcmp(node[i]->content, "no"))
@@ -168,6 +231,9 @@ int wm_syscollector_read(const OS_XML *xml, XML_NODE node, wmodule *module) {
             }
         } else if (!strcmp(node[i]->element, XML_HOTFIXES)) {
 #ifdef WIN32
+                if (parse_inventory_attributes(node[i], &syscollector->intervals.hotfixinfo) < 0) {
+                    return OS_INVALID;
+                }
                 if (!strcmp(node[i]->content, "yes"))
                     syscollector->flags.hotfixinfo = 1;
                 else if (!strcmp(node[i]->content, "no"))
@@ -180,6 +246,9 @@ int wm_syscollector_read(const OS_XML *xml, XML_NODE node, wmodule *module) {
                 mwarn("The '%s' option is only available on Windows systems. Ignoring it.", XML_HOTFIXES);
 #endif
         } else if (!strcmp(node[i]->element, XML_PROCS)) {
+            if (parse_inventory_attributes(node[i], &syscollector->intervals.procinfo) < 0) {
+                return OS_INVALID;
+            }
             if (!strcmp(node[i]->content, "yes"))
                 syscollector->flags.procinfo = 1;
             else if (!strcmp(node[i]->content, "no"))
@@ -189,18 +258,17 @@ int wm_syscollector_read(const OS_XML *xml, XML_NODE node, wmodule *module) {
                 return OS_INVALID;
             }
         } else if (!strcmp(node[i]->element, XML_PORTS)) {
-            if (node[i]->attributes) {
-                if (!strcmp(node[i]->attributes[0], "all")) {
-                    if (!strcmp(node[i]->values[0], "no")) {
+            for (int j = 0; node[i]->attributes && node[i]->attributes[j]; j++) {
+                if (!strcmp(node[i]->attributes[j], XML_PORTS_ALL)) {
+                    if (!strcmp(node[i]->values[j], "no")) {
                         syscollector->flags.allports = 0;
-                    } else if (!strcmp(node[i]->values[0], "yes")) {
+                    } else if (!strcmp(node[i]->values[j], "yes")) {
                         syscollector->flags.allports = 1;
                     } else {
-                        merror("Invalid content for attribute '%s' at module '%s'.", node[i]->attributes[0], WM_SYS_CONTEXT.name);
+                        merror("Invalid content for attribute '%s' at module '%s'.", node[i]->attributes[j], WM_SYS_CONTEXT.name);
                         return OS_INVALID;
                     }
-                } else {
-                    merror("Invalid attribute for tag '%s' at module '%s'.", XML_PORTS, WM_SYS_CONTEXT.name);
+                } else if (parse_inventory_interval(node[i], node[i]->attributes[j], node[i]->values[j], &syscollector->intervals.portsinfo) < 0) {
                     return OS_INVALID;
                 }
             }
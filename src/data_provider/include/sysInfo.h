@@ -126,6 +126,33 @@ EXPORTED int sysinfo_packages_cb(callback_data_t cb);
  */
 EXPORTED int sysinfo_hotfixes(cJSON** js_result);
 
+/**
+ * @brief Obtains the ports information from the current OS being analyzed.
+ *
+ * @param callback Resulting single port data where the specific information will be stored.
+ *
+ * return 0 on success, -1 otherwhise.
+ */
+EXPORTED int sysinfo_ports_cb(callback_data_t cb);
+
+/**
+ * @brief Obtains the network information from the current OS being analyzed.
+ *
+ * @param callback Resulting single network interface data where the specific information will be stored.
+ *
+ * return 0 on success, -1 otherwhise.
+ */
+EXPORTED int sysinfo_networks_cb(callback_data_t cb);
+
+/**
+ * @brief Obtains the hotfixes information from the current OS being analyzed.
+ *
+ * @param callback Resulting single hotfix data where the specific information will be stored.
+ *
+ * return 0 on success, -1 otherwhise.
+ */
+EXPORTED int sysinfo_hotfixes_cb(callback_data_t cb);
+
 
 typedef int(*sysinfo_networks_func)(cJSON** jsresult);
 typedef int(*sysinfo_os_func)(cJSON** jsresult);
@@ -25,6 +25,8 @@
 #define EXPORTED
 #endif
 
+#include <map>
+#include <mutex>
 #include "sysInfoInterface.h"
 
 constexpr auto KByte
@@ -32,6 +34,13 @@ constexpr auto KByte
     1024
 };
 
+struct ProcessIdentity final
+{
+    uint64_t startTime;
+    int64_t statTime;
+    nlohmann::json data;
+};
+
 class EXPORTED SysInfo: public ISysInfo
 {
     public:
@@ -40,24 +49,52 @@ class EXPORTED SysInfo: public ISysInfo
         virtual ~SysInfo() = default;
         // LCOV_EXCL_STOP
         nlohmann::json hardware();
+        nlohmann::json memory();
+        std::string bootId();
         nlohmann::json packages();
         nlohmann::json os();
         nlohmann::json processes();
         nlohmann::json networks();
         nlohmann::json ports();
+        nlohmann::json listeningPorts();
+        void ports(std::function<void(nlohmann::json&)>);
+        void listeningPorts(std::function<void(nlohmann::json&)>);
+        void networks(std::function<void(nlohmann::json&)>);
         void packages(std::function<void(nlohmann::json&)>);
+        nlohmann::json packagesFingerprint();
         void processes(std::function<void(nlohmann::json&)>);
+        void processes(const std::set<std::string>& fields, std::function<void(nlohmann::json&)>);
+        void processes(const std::set<std::string>& fields,
+                       std::function<void(nlohmann::json&)>,
+                       std::function<void(const nlohmann::json&)>);
         nlohmann::json hotfixes();
+        void hotfixes(std::function<void(nlohmann::json&)>);
     private:
         virtual nlohmann::json getHardware() const;
+        virtual nlohmann::json getMemoryInfo() const;
+        virtual std::string getBootId() const;
         virtual nlohmann::json getPackages() const;
         virtual nlohmann::json getOsInfo() const;
         virtual nlohmann::json getProcessesInfo() const;
         virtual nlohmann::json getNetworks() const;
         virtual nlohmann::json getPorts() const;
+        virtual nlohmann::json getListeningPorts() const;
+        virtual void getPorts(const bool listeningOnly, std::function<void(nlohmann::json&)>) const;
+        virtual void getNetworks(std::function<void(nlohmann::json&)>) const;
+        virtual void getHotfixes(std::function<void(nlohmann::json&)>) const;
         virtual nlohmann::json getHotfixes() const;
         virtual void getPackages(std::function<void(nlohmann::json&)>) const;
+        virtual nlohmann::json getPackagesFingerprint() const;
         virtual void getProcessesInfo(std::function<void(nlohmann::json&)>) const;
+        virtual void getProcessesInfo(const std::set<std::string>& fields, std::function<void(nlohmann::json&)>) const;
+        virtual void getProcessesInfo(const std::set<std::string>& fields,
+                                      std::function<void(nlohmann::json&)>,
+                                      std::function<void(const nlohmann::json&)>) const;
+
+        // Processes reported by the previous incremental scan, by pid.
+        mutable std::map<int64_t, ProcessIdentity> m_processesCache;
+        mutable std::set<std::string> m_processesCacheFields;
+        mutable std::mutex m_processesCacheMutex;
 };
 
 #endif //_SYS_INFO_HPP
@@ -12,6 +12,8 @@
 #ifndef _SYS_INFO_INTERFACE
 #define _SYS_INFO_INTERFACE
 
+#include <set>
+#include <string>
 #include "json.hpp"
 
 class ISysInfo
@@ -30,6 +32,124 @@ class ISysInfo
         virtual nlohmann::json hotfixes() = 0;
         virtual void packages(std::function<void(nlohmann::json&)>) = 0;
         virtual void processes(std::function<void(nlohmann::json&)>) = 0;
+        /**
+         * @brief Gathers the processes information restricted to the given fields.
+         * @details Implementations may skip reading whatever the requested fields do not need,
+         * an empty set requests every field. By default the whole information is gathered.
+         */
+        virtual void processes(const std::set<std::string>& /*fields*/, std::function<void(nlohmann::json&)> callback)
+        {
+            processes(callback);
+        }
+        /**
+         * @brief Cheap fingerprint of the package sources, it changes whenever their packages may have changed.
+         * @details An empty value means the sources can't be fingerprinted and must be enumerated every time.
+         */
+        virtual nlohmann::json packagesFingerprint()
+        {
+            return {};
+        }
+        /**
+         * @brief Memory figures of hardware(), the only ones expected to change while the host is up.
+         * @details By default the whole hardware information is gathered.
+         */
+        virtual nlohmann::json memory()
+        {
+            const auto hardwareInfo = hardware();
+            nlohmann::json ret = nlohmann::json::object();
+
+            for (const auto& field : {"ram_total", "ram_free", "ram_usage"})
+            {
+                if (hardwareInfo.contains(field))
+                {
+                    ret[field] = hardwareInfo.at(field);
+                }
+            }
+
+            return ret;
+        }
+        /**
+         * @brief Identifier of the current boot of the host, it changes whenever the host boots.
+         * @details An empty value means it is unknown.
+         */
+        virtual std::string bootId()
+        {
+            return {};
+        }
+        /**
+         * @brief Gathers the TCP ports in listening state and every UDP port.
+         * @details Implementations may filter the sockets at the source, callers still have to filter
+         * the result. By default every port is gathered.
+         */
+        virtual nlohmann::json listeningPorts()
+        {
+            return ports();
+        }
+        /**
+         * @brief Streams the ports information, one port per call.
+         * @details By default the whole list is gathered before the first call.
+         */
+        virtual void ports(std::function<void(nlohmann::json&)> callback)
+        {
+            auto data = ports();
+
+            for (auto& item : data)
+            {
+                callback(item);
+            }
+        }
+        /**
+         * @brief Streams the same ports as listeningPorts(), one port per call.
+         */
+        virtual void listeningPorts(std::function<void(nlohmann::json&)> callback)
+        {
+            auto data = listeningPorts();
+
+            for (auto& item : data)
+            {
+                callback(item);
+            }
+        }
+        /**
+         * @brief Streams the network interfaces, one element of the "iface" list of networks() per call.
+         */
+        virtual void networks(std::function<void(nlohmann::json&)> callback)
+        {
+            auto data = networks();
+            const auto it { data.find("iface") };
+
+            if (data.end() != it)
+            {
+                for (auto& item : it.value())
+                {
+                    callback(item);
+                }
+            }
+        }
+        /**
+         * @brief Streams the hotfixes information, one hotfix per call.
+         */
+        virtual void hotfixes(std::function<void(nlohmann::json&)> callback)
+        {
+            auto data = hotfixes();
+
+            for (auto& item : data)
+            {
+                callback(item);
+            }
+        }
+        /**
+         * @brief Gathers the processes information reporting apart the ones unchanged since the previous call.
+         * @details Processes new or restarted since the previous call are reported to \p changedCallback and
+         * the rest to \p unchangedCallback, with the information gathered when they were last reported as changed.
+         * By default every process is reported as changed.
+         */
+        virtual void processes(const std::set<std::string>& fields,
+                               std::function<void(nlohmann::json&)> changedCallback,
+                               std::function<void(const nlohmann::json&)> /*unchangedCallback*/)
+        {
+            processes(fields, changedCallback);
+        }
 
 };
 
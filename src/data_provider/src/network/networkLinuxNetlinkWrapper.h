@@ -0,0 +1,618 @@
+/*
+ * Wazuh SYSINFO
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _NETWORK_LINUX_NETLINK_WRAPPER_H
+#define _NETWORK_LINUX_NETLINK_WRAPPER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <linux/if_link.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <sys/socket.h>
+#include "uniqueFD.hpp"
+#include "networkLinuxWrapper.h"
+
+constexpr size_t RTNETLINK_BUFFER_SIZE { 64 * 1024 };
+
+// IFLA_OPERSTATE values (RFC 2863, IF_OPER_* of linux/if.h, which clashes with net/if.h) and
+// the same names printed in /sys/class/net/<iface>/operstate.
+static const std::map<uint8_t, std::string> NETLINK_OPERSTATE =
+{
+    { 0,    "unknown"           },
+    { 1,    "notpresent"        },
+    { 2,    "down"              },
+    { 3,    "lowerlayerdown"    },
+    { 4,    "testing"           },
+    { 5,    "dormant"           },
+    { 6,    "up"                },
+};
+
+struct NetlinkLinkData
+{
+    std::string name;
+    unsigned short type { 0 };
+    uint32_t mtu { 0 };
+    std::string state { UNKNOWN_VALUE };
+    std::string mac;
+    LinkStats stats {};
+    std::string gateway { UNKNOWN_VALUE };
+    std::string metrics;
+};
+
+struct NetlinkAddressData
+{
+    int family { AF_PACKET };
+    std::string address;
+    std::string netmask;
+    std::string broadcast;
+};
+
+struct NetlinkInterface
+{
+    std::shared_ptr<NetlinkLinkData> link;
+    // The link itself (AF_PACKET) goes first, then its addresses in the order of the kernel.
+    std::vector<NetlinkAddressData> addresses;
+};
+
+using NetlinkLinks = std::map<int, std::shared_ptr<NetlinkLinkData>>;
+using NetlinkInterfaces = std::map<std::string, NetlinkInterface>;
+
+/**
+ * @brief Dumps one rtnetlink table through a NETLINK_ROUTE socket.
+ *
+ * @param type     Request type (RTM_GETLINK, RTM_GETADDR or RTM_GETROUTE).
+ * @param request  Family header of the request.
+ * @param callback Called with every message of the dump.
+ *
+ * @return false when the dump can't be done.
+ */
+template <typename T>
+static inline bool rtnetlinkDump(const uint16_t type,
+                                 const T& request,
+                                 const std::function<void(const nlmsghdr&)>& callback)
+{
+    const Utils::UniqueFD sock { socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE) };
+
+    if (-1 == sock.get())
+    {
+        return false;
+    }
+
+    struct
+    {
+        nlmsghdr header;
+        T request;
+    } message {};
+
+    message.header.nlmsg_len = NLMSG_LENGTH(sizeof(T));
+    message.header.nlmsg_type = type;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.request = request;
+
+    sockaddr_nl kernel {};
+    kernel.nl_family = AF_NETLINK;
+
+    if (-1 == sendto(sock.get(), &message, sizeof(message), 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)))
+    {
+        return false;
+    }
+
+    const auto buffer { std::make_unique<char[]>(RTNETLINK_BUFFER_SIZE) };
+
+    while (true)
+    {
+        const auto length { recv(sock.get(), buffer.get(), RTNETLINK_BUFFER_SIZE, 0) };
+
+        if (length <= 0)
+        {
+            return false;
+        }
+
+        auto remaining { static_cast<int>(length) };
+
+        for (auto header { reinterpret_cast<const nlmsghdr*>(buffer.get()) };
+                NLMSG_OK(header, remaining);
+                header = NLMSG_NEXT(header, remaining))
+        {
+            if (NLMSG_DONE == header->nlmsg_type)
+            {
+                return true;
+            }
+
+            if (NLMSG_ERROR == header->nlmsg_type)
+            {
+                return false;
+            }
+
+            callback(*header);
+        }
+    }
+}
+
+static inline std::string netlinkAddress(const int family, const rtattr* attribute)
+{
+    std::string retVal;
+    const auto size { AF_INET == family ? sizeof(in_addr) : sizeof(in6_addr) };
+
+    if (attribute && RTA_PAYLOAD(attribute) >= size)
+    {
+        retVal = Utils::NetworkHelper::IAddressToBinary(family, RTA_DATA(attribute));
+    }
+
+    return retVal;
+}
+
+static inline std::string netlinkNetmask(const int family, const unsigned int prefixLength)
+{
+    in6_addr mask {};
+    const auto bits { std::min(prefixLength, AF_INET == family ? 32u : 128u) };
+
+    for (auto i { 0u }; i < bits; ++i)
+    {
+        mask.s6_addr[i / 8] |= static_cast<uint8_t>(0x80 >> (i % 8));
+    }
+
+    return Utils::NetworkHelper::IAddressToBinary(family, &mask);
+}
+
+/**
+ * @brief Parses one RTM_NEWLINK message, the loopback links are skipped as getifaddrs does.
+ */
+static inline void parseNetlinkLink(const nlmsghdr& header, NetlinkLinks& links)
+{
+    if (RTM_NEWLINK != header.nlmsg_type || header.nlmsg_len < NLMSG_LENGTH(sizeof(ifinfomsg)))
+    {
+        return;
+    }
+
+    const auto info { static_cast<const ifinfomsg*>(NLMSG_DATA(&header)) };
+
+    if (info->ifi_flags & IFF_LOOPBACK)
+    {
+        return;
+    }
+
+    auto link { std::make_shared<NetlinkLinkData>() };
+    link->type = info->ifi_type;
+    bool stats64 { false };
+    auto remaining { static_cast<int>(IFLA_PAYLOAD(&header)) };
+
+    for (auto attribute { IFLA_RTA(info) }; RTA_OK(attribute, remaining); attribute = RTA_NEXT(attribute, remaining))
+    {
+        const auto data { static_cast<const uint8_t*>(RTA_DATA(attribute)) };
+        const auto size { RTA_PAYLOAD(attribute) };
+
+        switch (attribute->rta_type)
+        {
+            case IFLA_IFNAME:
+                link->name.assign(reinterpret_cast<const char*>(data), strnlen(reinterpret_cast<const char*>(data), size));
+                break;
+
+            case IFLA_MTU:
+                if (size >= sizeof(uint32_t))
+                {
+                    std::memcpy(&link->mtu, data, sizeof(uint32_t));
+                }
+
+                break;
+
+            case IFLA_OPERSTATE:
+                if (size >= sizeof(uint8_t))
+                {
+                    const auto it { NETLINK_OPERSTATE.find(*data) };
+                    link->state = NETLINK_OPERSTATE.end() != it ? it->second : UNKNOWN_VALUE;
+                }
+
+                break;
+
+            case IFLA_ADDRESS:
+                for (auto i { 0u }; i < size; ++i)
+                {
+                    char octet[4] {};
+                    snprintf(octet, sizeof(octet), i ? ":%02x" : "%02x", data[i]);
+                    link->mac += octet;
+                }
+
+                break;
+
+            case IFLA_STATS64:
+                if (size >= offsetof(rtnl_link_stats64, multicast))
+                {
+                    // Newer kernels append counters, older ones send a shorter structure.
+                    rtnl_link_stats64 stats {};
+                    std::memcpy(&stats, data, std::min<size_t>(size, sizeof(stats)));
+                    link->stats =
+                    {
+                        static_cast<unsigned int>(stats.rx_packets), static_cast<unsigned int>(stats.tx_packets),
+                        static_cast<unsigned int>(stats.rx_bytes), static_cast<unsigned int>(stats.tx_bytes),
+                        static_cast<unsigned int>(stats.rx_errors), static_cast<unsigned int>(stats.tx_errors),
+                        static_cast<unsigned int>(stats.rx_dropped), static_cast<unsigned int>(stats.tx_dropped)
+                    };
+                    stats64 = true;
+                }
+
+                break;
+
+            case IFLA_STATS:
+                if (!stats64 && size >= offsetof(rtnl_link_stats, multicast))
+                {
+                    rtnl_link_stats stats {};
+                    std::memcpy(&stats, data, std::min<size_t>(size, sizeof(stats)));
+                    link->stats =
+                    {
+                        stats.rx_packets, stats.tx_packets, stats.rx_bytes, stats.tx_bytes,
+                        stats.rx_errors, stats.tx_errors, stats.rx_dropped, stats.tx_dropped
+                    };
+                }
+
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (!link->name.empty())
+    {
+        links[info->ifi_index] = link;
+    }
+}
+
+/**
+ * @brief Parses one RTM_NEWADDR message with the getifaddrs semantics: the address is IFA_LOCAL when
+ * it's present, IFA_ADDRESS is then the peer, which is reported as broadcast unless IFA_BROADCAST is set.
+ */
+static inline void parseNetlinkAddress(const nlmsghdr& header, const NetlinkLinks& links, NetlinkInterfaces& interfaces)
+{
+    if (RTM_NEWADDR != header.nlmsg_type || header.nlmsg_len < NLMSG_LENGTH(sizeof(ifaddrmsg)))
+    {
+        return;
+    }
+
+    const auto info { static_cast<const ifaddrmsg*>(NLMSG_DATA(&header)) };
+    const auto itLink { links.find(static_cast<int>(info->ifa_index)) };
+
+    if (links.end() == itLink || (AF_INET != info->ifa_family && AF_INET6 != info->ifa_family))
+    {
+        return;
+    }
+
+    const rtattr* address { nullptr };
+    const rtattr* local { nullptr };
+    const rtattr* broadcast { nullptr };
+    auto remaining { static_cast<int>(IFA_PAYLOAD(&header)) };
+
+    for (auto attribute { IFA_RTA(info) }; RTA_OK(attribute, remaining); attribute = RTA_NEXT(attribute, remaining))
+    {
+        if (IFA_ADDRESS == attribute->rta_type)
+        {
+            address = attribute;
+        }
+        else if (IFA_LOCAL == attribute->rta_type)
+        {
+            local = attribute;
+        }
+        else if (IFA_BROADCAST == attribute->rta_type)
+        {
+            broadcast = attribute;
+        }
+    }
+
+    NetlinkAddressData data;
+    data.family = info->ifa_family;
+    data.address = netlinkAddress(data.family, local ? local : address);
+
+    if (data.address.empty())
+    {
+        return;
+    }
+
+    data.netmask = netlinkNetmask(data.family, info->ifa_prefixlen);
+
+    if (AF_INET == data.family && broadcast)
+    {
+        data.broadcast = netlinkAddress(AF_INET, broadcast);
+    }
+    else if (local && address)
+    {
+        data.broadcast = netlinkAddress(data.family, address);
+    }
+    else if (AF_INET == data.family)
+    {
+        data.broadcast = Utils::NetworkHelper::getBroadcast(data.address, data.netmask);
+    }
+
+    if (AF_INET == data.family && data.broadcast.empty())
+    {
+        data.broadcast = UNKNOWN_VALUE;
+    }
+
+    interfaces[itLink->second->name].addresses.push_back(std::move(data));
+}
+
+/**
+ * @brief Parses one RTM_NEWROUTE message of the main IPv4 table. As with /proc/net/route, the
+ * link gets the first route with a gateway, or else the metric of its last route.
+ */
+static inline void parseNetlinkRoute(const nlmsghdr& header, const NetlinkLinks& links)
+{
+    if (RTM_NEWROUTE != header.nlmsg_type || header.nlmsg_len < NLMSG_LENGTH(sizeof(rtmsg)))
+    {
+        return;
+    }
+
+    const auto info { static_cast<const rtmsg*>(NLMSG_DATA(&header)) };
+
+    if (AF_INET != info->rtm_family || RT_TABLE_MAIN != info->rtm_table)
+    {
+        return;
+    }
+
+    const auto setRoute
+    {
+        [&links](const int index, const rtattr * gateway, const uint32_t priority)
+        {
+            const auto it { links.find(index) };
+
+            // A link keeps the first route with a gateway.
+            if (links.end() != it && UNKNOWN_VALUE == it->second->gateway)
+            {
+                const auto address { netlinkAddress(AF_INET, gateway) };
+                it->second->metrics = std::to_string(priority);
+
+                if (!address.empty() && "0.0.0.0" != address)
+                {
+                    it->second->gateway = address;
+                }
+            }
+        }
+    };
+
+    int index { 0 };
+    uint32_t priority { 0 };
+    const rtattr* gateway { nullptr };
+    const rtattr* multipath { nullptr };
+    auto remaining { static_cast<int>(RTM_PAYLOAD(&header)) };
+
+    for (auto attribute { RTM_RTA(info) }; RTA_OK(attribute, remaining); attribute = RTA_NEXT(attribute, remaining))
+    {
+        if (RTA_OIF == attribute->rta_type && RTA_PAYLOAD(attribute) >= sizeof(int))
+        {
+            std::memcpy(&index, RTA_DATA(attribute), sizeof(int));
+        }
+        else if (RTA_PRIORITY == attribute->rta_type && RTA_PAYLOAD(attribute) >= sizeof(uint32_t))
+        {
+            std::memcpy(&priority, RTA_DATA(attribute), sizeof(uint32_t));
+        }
+        else if (RTA_GATEWAY == attribute->rta_type)
+        {
+            gateway = attribute;
+        }
+        else if (RTA_MULTIPATH == attribute->rta_type)
+        {
+            multipath = attribute;
+        }
+    }
+
+    if (!multipath)
+    {
+        setRoute(index, gateway, priority);
+        return;
+    }
+
+    auto nexthopsLength { static_cast<int>(RTA_PAYLOAD(multipath)) };
+
+    for (auto nexthop { static_cast<const rtnexthop*>(RTA_DATA(multipath)) };
+            RTNH_OK(nexthop, nexthopsLength);
+            nexthopsLength -= NLMSG_ALIGN(nexthop->rtnh_len), nexthop = RTNH_NEXT(nexthop))
+    {
+        const rtattr* nexthopGateway { nullptr };
+        auto attributesLength { static_cast<int>(nexthop->rtnh_len - sizeof(rtnexthop)) };
+
+        for (auto attribute { RTNH_DATA(nexthop) }; RTA_OK(attribute, attributesLength); attribute = RTA_NEXT(attribute, attributesLength))
+        {
+            if (RTA_GATEWAY == attribute->rta_type)
+            {
+                nexthopGateway = attribute;
+            }
+        }
+
+        setRoute(nexthop->rtnh_ifindex, nexthopGateway, priority);
+    }
+}
+
+/**
+ * @brief Gets the links with their addresses and IPv4 gateways through three rtnetlink dumps.
+ *
+ * @return Interfaces sorted by name.
+ */
+static inline NetlinkInterfaces getNetlinkInterfaces()
+{
+    NetlinkLinks links;
+    NetlinkInterfaces interfaces;
+
+    ifinfomsg linkRequest {};
+    linkRequest.ifi_family = AF_UNSPEC;
+
+    const auto linksDumped
+    {
+        rtnetlinkDump(RTM_GETLINK, linkRequest, [&links](const nlmsghdr & header)
+        {
+            parseNetlinkLink(header, links);
+        })
+    };
+
+    if (!linksDumped)
+    {
+        throw std::runtime_error { "Error dumping the network links" };
+    }
+
+    for (const auto& link : links)
+    {
+        auto& interface { interfaces[link.second->name] };
+        interface.link = link.second;
+        interface.addresses.emplace_back();
+    }
+
+    rtmsg routeRequest {};
+    routeRequest.rtm_family = AF_INET;
+
+    const auto routesDumped
+    {
+        rtnetlinkDump(RTM_GETROUTE, routeRequest, [&links](const nlmsghdr & header)
+        {
+            parseNetlinkRoute(header, links);
+        })
+    };
+
+    if (!routesDumped)
+    {
+        throw std::runtime_error { "Error dumping the network routes" };
+    }
+
+    ifaddrmsg addressRequest {};
+    addressRequest.ifa_family = AF_UNSPEC;
+
+    const auto addressesDumped
+    {
+        rtnetlinkDump(RTM_GETADDR, addressRequest, [&links, &interfaces](const nlmsghdr & header)
+        {
+            parseNetlinkAddress(header, links, interfaces);
+        })
+    };
+
+    if (!addressesDumped)
+    {
+        throw std::runtime_error { "Error dumping the network addresses" };
+    }
+
+    return interfaces;
+}
+
+class NetworkLinuxNetlinkInterface final : public INetworkInterfaceWrapper
+{
+        std::shared_ptr<const NetlinkLinkData> m_link;
+        NetlinkAddressData m_address;
+        std::string m_debianConfig;
+
+    public:
+        explicit NetworkLinuxNetlinkInterface(const std::shared_ptr<const NetlinkLinkData>& link,
+                                              const NetlinkAddressData& address,
+                                              const std::string& debianConfig)
+            : m_link { link }
+            , m_address { address }
+            , m_debianConfig { debianConfig }
+        {
+            if (!link)
+            {
+                throw std::runtime_error { "Nullptr instances of network interface" };
+            }
+        }
+
+        std::string name() const override
+        {
+            return m_link->name;
+        }
+
+        std::string adapter() const override
+        {
+            return "";
+        }
+
+        int family() const override
+        {
+            return m_address.family;
+        }
+
+        std::string address() const override
+        {
+            return m_address.address;
+        }
+
+        std::string netmask() const override
+        {
+            return m_address.netmask;
+        }
+
+        std::string broadcast() const override
+        {
+            return m_address.broadcast;
+        }
+
+        std::string addressV6() const override
+        {
+            return m_address.address;
+        }
+
+        std::string netmaskV6() const override
+        {
+            return m_address.netmask;
+        }
+
+        std::string broadcastV6() const override
+        {
+            return m_address.broadcast;
+        }
+
+        std::string gateway() const override
+        {
+            return m_link->gateway;
+        }
+
+        std::string metrics() const override
+        {
+            return m_link->metrics;
+        }
+
+        std::string metricsV6() const override
+        {
+            return "";
+        }
+
+        std::string dhcp() const override
+        {
+            return NetworkLinuxInterface::getDHCPStatus(m_link->name, m_address.family, m_debianConfig);
+        }
+
+        uint32_t mtu() const override
+        {
+            return m_link->mtu;
+        }
+
+        LinkStats stats() const override
+        {
+            return m_link->stats;
+        }
+
+        std::string type() const override
+        {
+            return Utils::NetworkHelper::getNetworkTypeStringCode(m_link->type, NETWORK_INTERFACE_TYPE);
+        }
+
+        std::string state() const override
+        {
+            return m_link->state;
+        }
+
+        std::string MAC() const override
+        {
+            return m_link->mac;
+        }
+};
+
+#endif // _NETWORK_LINUX_NETLINK_WRAPPER_H
@@ -374,10 +374,21 @@ class NetworkLinuxInterface final : public INetworkInterfaceWrapper
 
         std::string dhcp() const override
         {
-            auto fileData { Utils::getFileContent(WM_SYS_IF_FILE) };
+            return getDHCPStatus(this->name(), this->family(), Utils::getFileContent(WM_SYS_IF_FILE));
+        }
+
+        /**
+         * @brief Gets the DHCP status of one interface address.
+         *
+         * @param ifName       Interface name.
+         * @param family       Address family (AF_INET or AF_INET6).
+         * @param debianConfig Content of the Debian interfaces file, the RedHat and SUSE files
+         *                     of the interface are read when it's empty.
+         */
+        static std::string getDHCPStatus(const std::string& ifName, const int family, const std::string& debianConfig)
+        {
+            auto fileData { debianConfig };
             std::string retVal { "unknown" };
-            const auto family { this->family() };
-            const auto ifName { this->name() };
 
             if (!fileData.empty())
             {
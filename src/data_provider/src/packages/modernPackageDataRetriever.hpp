@@ -14,6 +14,7 @@
 
 #include "json.hpp"
 #include "sharedDefs.h"
+#include "packages/packagesEnumerator.hpp"
 #include <functional>
 #include <map>
 
@@ -25,11 +26,13 @@ class PYPI
 {
     public:
         void getPackages(const std::set<std::string>& /*paths*/, std::function<void(nlohmann::json&)> /*callback*/);
+        std::string getFingerprint(const std::set<std::string>& /*paths*/);
 };
 class NPM
 {
     public:
         void getPackages(const std::set<std::string>& /*paths*/, std::function<void(nlohmann::json&)> /*callback*/);
+        std::string getFingerprint(const std::set<std::string>& /*paths*/);
 };
 #endif
 
@@ -40,6 +43,16 @@ class ModernFactoryPackagesCreator final
         static void getPackages(const std::map<std::string, std::set<std::string>>& /*paths*/, std::function<void(nlohmann::json&)> /*callback*/)
         {
         }
+
+        static std::vector<PackagesSource> getSources(const std::map<std::string, std::set<std::string>>& /*paths*/)
+        {
+            return {};
+        }
+
+        static nlohmann::json getFingerprint(const std::map<std::string, std::set<std::string>>& /*paths*/)
+        {
+            return nlohmann::json::object();
+        }
 };
 
 // Standard template to extract package information in fully compatible Linux
@@ -53,6 +66,32 @@ class ModernFactoryPackagesCreator<true> final
             PYPI().getPackages(paths.at("PYPI"), callback);
             NPM().getPackages(paths.at("NPM"), callback);
         }
+
+        /**
+         * @brief Same walks as getPackages, one independent source per package type.
+         */
+        static std::vector<PackagesSource> getSources(const std::map<std::string, std::set<std::string>>& paths)
+        {
+            return
+            {
+                [pypiPaths = paths.at("PYPI")](PackagesCallback callback)
+                {
+                    PYPI().getPackages(pypiPaths, callback);
+                },
+                [npmPaths = paths.at("NPM")](PackagesCallback callback)
+                {
+                    NPM().getPackages(npmPaths, callback);
+                }
+            };
+        }
+
+        static nlohmann::json getFingerprint(const std::map<std::string, std::set<std::string>>& paths)
+        {
+            nlohmann::json ret = nlohmann::json::object();
+            ret["pypi"] = PYPI().getFingerprint(paths.at("PYPI"));
+            ret["npm"] = NPM().getFingerprint(paths.at("NPM"));
+            return ret;
+        }
 };
 
 #endif  // _MODERN_PACKAGE_DATA_RETRIEVER_HPP
@@ -12,7 +12,9 @@
 #ifndef _PACKAGE_LINUX_DATA_RETRIEVER_H
 #define _PACKAGE_LINUX_DATA_RETRIEVER_H
 
+#include <algorithm>
 #include <memory>
+#include <sys/stat.h>
 #include "filesystemHelper.h"
 #include "json.hpp"
 #include "sharedDefs.h"
@@ -58,6 +60,69 @@ void getApkInfo(const std::string& libPath, std::function<void(nlohmann::json&)>
  */
 void getSnapInfo(std::function<void(nlohmann::json&)> callback);
 
+/**
+ * @brief Identity of a package database file or directory: inode, size and modification time.
+ * @param path Path to be fingerprinted.
+ * @return The fingerprint, empty if the path doesn't exist.
+ */
+static inline std::string getPathFingerprint(const std::string& path)
+{
+    std::string ret;
+    struct stat pathStat {};
+
+    if (0 == stat(path.c_str(), &pathStat))
+    {
+        ret = std::to_string(pathStat.st_ino) + ":" +
+              std::to_string(pathStat.st_size) + ":" +
+              std::to_string(pathStat.st_mtim.tv_sec) + "." +
+              std::to_string(pathStat.st_mtim.tv_nsec);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Fingerprint of every entry of a package database directory.
+ * @param path Directory to be fingerprinted.
+ * @return The fingerprint, empty if the directory doesn't exist.
+ */
+static inline std::string getDirectoryFingerprint(const std::string& path)
+{
+    auto ret { getPathFingerprint(path) };
+
+    if (!ret.empty())
+    {
+        auto entries { Utils::enumerateDir(path) };
+        std::sort(entries.begin(), entries.end());
+
+        for (const auto& entry : entries)
+        {
+            if ("." != entry && ".." != entry)
+            {
+                ret += ";" + entry + "=" + getPathFingerprint(path + "/" + entry);
+            }
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Fingerprint of the rpm database, whatever its backend.
+ * @details The Berkeley DB environment files (__db.*) are left out, they are rewritten by readers too.
+ */
+static inline std::string getRpmFingerprint()
+{
+    std::string ret;
+
+    for (const auto& file : { "Packages", "Packages.db", "rpmdb.sqlite", "rpmdb.sqlite-wal" })
+    {
+        ret += std::string(file) + "=" + getPathFingerprint(std::string(RPM_PATH) + file) + ";";
+    }
+
+    return ret;
+}
+
 // Exception template
 template <LinuxType linuxType>
 class FactoryPackagesCreator final
@@ -70,6 +135,11 @@ class FactoryPackagesCreator final
                 "Error creating package data retriever."
             };
         }
+
+        static nlohmann::json getFingerprint()
+        {
+            return {};
+        }
 };
 
 // Standard template to extract package information in fully compatible Linux systems
@@ -104,6 +174,42 @@ class FactoryPackagesCreator<LinuxType::STANDARD> final
                 getSnapInfo(callback);
             }
         }
+
+        /**
+         * @brief Fingerprints the databases read by getPackages, one entry per package manager found.
+         */
+        static nlohmann::json getFingerprint()
+        {
+            nlohmann::json ret = nlohmann::json::object();
+
+            if (Utils::existsDir(DPKG_PATH))
+            {
+                ret["dpkg"] = getPathFingerprint(DPKG_STATUS_PATH);
+            }
+
+            if (Utils::existsDir(PACMAN_PATH))
+            {
+                ret["pacman"] = getPathFingerprint(std::string(PACMAN_PATH) + "/local");
+            }
+
+            if (Utils::existsDir(RPM_PATH))
+            {
+                ret["rpm"] = getRpmFingerprint();
+            }
+
+            if (Utils::existsDir(APK_PATH))
+            {
+                ret["apk"] = getPathFingerprint(APK_DB_PATH);
+            }
+
+            if (Utils::existsDir(SNAP_PATH))
+            {
+                // Every installed revision is a file in the snaps folder.
+                ret["snap"] = getDirectoryFingerprint(std::string(SNAP_PATH) + "/snaps");
+            }
+
+            return ret;
+        }
 };
 
 // Template to extract package information in partially incompatible Linux systems
@@ -118,6 +224,18 @@ class FactoryPackagesCreator<LinuxType::LEGACY> final
                 getRpmInfoLegacy(callback);
             }
         }
+
+        static nlohmann::json getFingerprint()
+        {
+            nlohmann::json ret = nlohmann::json::object();
+
+            if (Utils::existsDir(RPM_PATH))
+            {
+                ret["rpm"] = getRpmFingerprint();
+            }
+
+            return ret;
+        }
 };
 
 #endif // _PACKAGE_LINUX_DATA_RETRIEVER_H
@@ -11,40 +11,73 @@
 
 #include "sharedDefs.h"
 #include "packageLinuxParserHelper.h"
-#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-void getDpkgInfo(const std::string& fileName, std::function<void(nlohmann::json&)> callback)
+// Read only mapping of a whole file, empty when the file can't be mapped.
+class FileMapping final
 {
-    std::fstream file{fileName, std::ios_base::in};
-
-    if (file.is_open())
-    {
-        while (file.good())
+    public:
+        explicit FileMapping(const std::string& fileName)
+            : m_data{ nullptr }
+            , m_size{ 0 }
         {
-            std::string line;
-            std::vector<std::string> data;
+            const auto fd { open(fileName.c_str(), O_RDONLY | O_CLOEXEC) };
 
-            do
+            if (-1 != fd)
             {
-                std::getline(file, line);
+                struct stat fileStat {};
 
-                if (line.front() == ' ') //additional info
+                if (0 == fstat(fd, &fileStat) && 0 < fileStat.st_size)
                 {
-                    data.back() = data.back() + line + "\n";
-                }
-                else
-                {
-                    data.push_back(line + "\n");
-                }
-            }
-            while (!line.empty()); //end of package item info
+                    const auto size { static_cast<size_t>(fileStat.st_size) };
+                    const auto data { mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) };
 
-            auto packageInfo = PackageLinuxHelper::parseDpkg(data);
+                    if (MAP_FAILED != data)
+                    {
+                        // The status file is walked once from the beginning to the end.
+                        madvise(data, size, MADV_SEQUENTIAL);
+                        m_data = static_cast<const char*>(data);
+                        m_size = size;
+                    }
+                }
 
-            if (!packageInfo.empty())
+                close(fd);
+            }
+        }
+        FileMapping& operator=(const FileMapping&) = delete;
+        FileMapping(const FileMapping& other) = delete;
+        ~FileMapping()
+        {
+            if (m_data)
             {
-                callback(packageInfo);
+                munmap(const_cast<char*>(m_data), m_size);
             }
         }
+
+        const char* begin() const
+        {
+            return m_data;
+        }
+
+        const char* end() const
+        {
+            return m_data + m_size;
+        }
+
+    private:
+        const char* m_data;
+        size_t m_size;
+};
+
+void getDpkgInfo(const std::string& fileName, std::function<void(nlohmann::json&)> callback)
+{
+    const FileMapping statusFile { fileName };
+
+    if (statusFile.begin())
+    {
+        PackageLinuxHelper::parseDpkgStatus(statusFile.begin(), statusFile.end(), callback);
     }
 }
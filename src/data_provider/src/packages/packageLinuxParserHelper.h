@@ -21,123 +21,223 @@
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
 
+#include <algorithm>
+#include <functional>
 #include <sstream>
 
 // Parse helpers for standard Linux packaging systems (rpm, dpkg, ...)
 namespace PackageLinuxHelper
 {
 
-    static nlohmann::json parseDpkg(const std::vector<std::string>& entries)
+    // dpkg status fields reported, any other field of a stanza is skipped without being copied.
+    enum DpkgField
     {
-        std::map<std::string, std::string> info;
-        nlohmann::json ret;
+        DPKG_PACKAGE,
+        DPKG_STATUS,
+        DPKG_PRIORITY,
+        DPKG_SECTION,
+        DPKG_INSTALLED_SIZE,
+        DPKG_MULTIARCH,
+        DPKG_ARCHITECTURE,
+        DPKG_SOURCE,
+        DPKG_VERSION,
+        DPKG_MAINTAINER,
+        DPKG_DESCRIPTION,
+        DPKG_FIELDS_COUNT
+    };
+
+    static const std::pair<const char*, size_t> DPKG_FIELD_NAMES[DPKG_FIELDS_COUNT]
+    {
+        {"Package", 7},
+        {"Status", 6},
+        {"Priority", 8},
+        {"Section", 7},
+        {"Installed-Size", 14},
+        {"Multi-Arch", 10},
+        {"Architecture", 12},
+        {"Source", 6},
+        {"Version", 7},
+        {"Maintainer", 10},
+        {"Description", 11}
+    };
+
+    using DpkgValue = std::pair<const char*, const char*>;
+
+    static bool isDpkgBlank(const char c)
+    {
+        return ' ' == c || '\n' == c;
+    }
 
-        for (const auto& entry : entries)
+    static std::string dpkgValueToString(const DpkgValue& value)
+    {
+        return std::string(value.first, value.second);
+    }
+
+    /**
+     * @brief Parses one stanza of the dpkg status file, the text between \p begin and \p end.
+     *
+     * @details Continuation lines (starting with a space or a tab) belong to the previous field.
+     * Values are trimmed of spaces and new lines, and only the description first line is kept.
+     *
+     * @return The package information, empty when the package isn't installed.
+     */
+    static nlohmann::json parseDpkgStanza(const char* begin, const char* end)
+    {
+        DpkgValue values[DPKG_FIELDS_COUNT] {};
+        bool found[DPKG_FIELDS_COUNT] {};
+        auto line { begin };
+
+        while (line < end)
         {
-            const auto pos{entry.find(":")};
+            auto lineEnd { std::find(line, end, '\n') };
+            auto fieldEnd { lineEnd };
 
-            if (pos != std::string::npos)
+            while (end - fieldEnd > 1 && (' ' == fieldEnd[1] || '\t' == fieldEnd[1]))
             {
-                const auto key{Utils::trim(entry.substr(0, pos))};
-                const auto value{Utils::trim(entry.substr(pos + 1), " \n")};
-                info[key] = value;
+                fieldEnd = std::find(fieldEnd + 1, end, '\n');
             }
-        }
 
-        if (!info.empty() && info.at("Status") == "install ok installed")
-        {
-            ret["name"] = info.at("Package");
+            const auto colon { std::find(line, lineEnd, ':') };
 
-            std::string priority {UNKNOWN_VALUE};
-            std::string groups {UNKNOWN_VALUE};
-            // The multiarch field won't have a default value
-            std::string multiarch;
-            std::string architecture {UNKNOWN_VALUE};
-            std::string source {UNKNOWN_VALUE};
-            std::string version {UNKNOWN_VALUE};
-            std::string vendor {UNKNOWN_VALUE};
-            std::string description {UNKNOWN_VALUE};
-            int size                 { 0 };
+            if (lineEnd != colon && ' ' != *line && '\t' != *line)
+            {
+                auto keyBegin { line };
+                auto keyEnd { colon };
 
-            auto it{info.find("Priority")};
+                while (keyBegin < keyEnd && ' ' == *keyBegin)
+                {
+                    ++keyBegin;
+                }
 
-            if (it != info.end())
-            {
-                priority = it->second;
-            }
+                while (keyEnd > keyBegin && ' ' == keyEnd[-1])
+                {
+                    --keyEnd;
+                }
 
-            it = info.find("Section");
+                const auto keySize { static_cast<size_t>(keyEnd - keyBegin) };
 
-            if (it != info.end())
-            {
-                groups = it->second;
+                for (size_t i = 0; i < DPKG_FIELDS_COUNT; ++i)
+                {
+                    if (DPKG_FIELD_NAMES[i].second == keySize &&
+                            0 == std::char_traits<char>::compare(keyBegin, DPKG_FIELD_NAMES[i].first, keySize))
+                    {
+                        auto valueBegin { colon + 1 };
+                        auto valueEnd { fieldEnd };
+
+                        while (valueBegin < valueEnd && isDpkgBlank(*valueBegin))
+                        {
+                            ++valueBegin;
+                        }
+
+                        while (valueEnd > valueBegin && isDpkgBlank(valueEnd[-1]))
+                        {
+                            --valueEnd;
+                        }
+
+                        values[i] = std::make_pair(valueBegin, valueEnd);
+                        found[i] = true;
+                        break;
+                    }
+                }
             }
 
-            it = info.find("Installed-Size");
+            line = fieldEnd < end ? fieldEnd + 1 : end;
+        }
+
+        nlohmann::json ret;
+        constexpr auto INSTALLED { "install ok installed" };
 
-            if (it != info.end())
+        if (found[DPKG_STATUS] && found[DPKG_PACKAGE] && dpkgValueToString(values[DPKG_STATUS]) == INSTALLED)
+        {
+            const auto valueOrDefault
             {
-                size = stol(it->second);
-            }
+                [&values, &found](const DpkgField field, const std::string & defaultValue)
+                {
+                    return found[field] ? dpkgValueToString(values[field]) : defaultValue;
+                }
+            };
 
-            it = info.find("Multi-Arch");
+            std::string description {UNKNOWN_VALUE};
 
-            if (it != info.end())
+            if (found[DPKG_DESCRIPTION])
             {
-                multiarch = it->second;
+                const auto& value { values[DPKG_DESCRIPTION] };
+                description.assign(value.first, std::find(value.first, value.second, '\n'));
             }
 
-            it = info.find("Architecture");
+            ret["name"]         = dpkgValueToString(values[DPKG_PACKAGE]);
+            ret["priority"]     = valueOrDefault(DPKG_PRIORITY, UNKNOWN_VALUE);
+            ret["groups"]       = valueOrDefault(DPKG_SECTION, UNKNOWN_VALUE);
+            ret["size"]         = found[DPKG_INSTALLED_SIZE] ? std::stol(dpkgValueToString(values[DPKG_INSTALLED_SIZE])) : 0;
+            // The multiarch field won't have a default value
+            ret["multiarch"]    = valueOrDefault(DPKG_MULTIARCH, "");
+            ret["architecture"] = valueOrDefault(DPKG_ARCHITECTURE, UNKNOWN_VALUE);
+            ret["source"]       = valueOrDefault(DPKG_SOURCE, UNKNOWN_VALUE);
+            ret["version"]      = valueOrDefault(DPKG_VERSION, UNKNOWN_VALUE);
+            ret["format"]       = "deb";
+            ret["location"]     = UNKNOWN_VALUE;
+            ret["vendor"]       = valueOrDefault(DPKG_MAINTAINER, UNKNOWN_VALUE);
+            ret["install_time"] = UNKNOWN_VALUE;
+            ret["description"]  = description;
+        }
 
-            if (it != info.end())
-            {
-                architecture = it->second;
-            }
+        return ret;
+    }
 
-            it = info.find("Source");
+    /**
+     * @brief Walks the stanzas of a dpkg status file loaded between \p begin and \p end, reporting each
+     * installed package to \p callback.
+     */
+    static void parseDpkgStatus(const char* begin,
+                                const char* end,
+                                const std::function<void(nlohmann::json&)>& callback)
+    {
+        auto stanza { begin };
 
-            if (it != info.end())
+        while (stanza < end)
+        {
+            // A stanza ends on the first empty line.
+            auto stanzaEnd { stanza };
+
+            while (stanzaEnd < end && '\n' != *stanzaEnd)
             {
-                source = it->second;
-            }
+                stanzaEnd = std::find(stanzaEnd, end, '\n');
 
-            it = info.find("Version");
+                if (stanzaEnd < end)
+                {
+                    ++stanzaEnd;
+                }
+            }
 
-            if (it != info.end())
+            if (stanzaEnd > stanza)
             {
-                version = it->second;
+                auto packageInfo = parseDpkgStanza(stanza, stanzaEnd);
+
+                if (!packageInfo.empty())
+                {
+                    callback(packageInfo);
+                }
             }
 
-            it = info.find("Maintainer");
+            stanza = stanzaEnd < end ? stanzaEnd + 1 : end;
+        }
+    }
 
-            if (it != info.end())
-            {
-                vendor = it->second;
-            }
+    static nlohmann::json parseDpkg(const std::vector<std::string>& entries)
+    {
+        std::string stanza;
 
-            it = info.find("Description");
+        for (const auto& entry : entries)
+        {
+            stanza.append(entry);
 
-            if (it != info.end())
+            if (stanza.empty() || '\n' != stanza.back())
             {
-                description = Utils::substrOnFirstOccurrence(it->second, "\n");
+                stanza.push_back('\n');
             }
-
-            ret["priority"]     = priority;
-            ret["groups"]       = groups;
-            ret["size"]         = size;
-            ret["multiarch"]    = multiarch;
-            ret["architecture"] = architecture;
-            ret["source"]       = source;
-            ret["version"]      = version;
-            ret["format"]       = "deb";
-            ret["location"]     = UNKNOWN_VALUE;
-            ret["vendor"]       = vendor;
-            ret["install_time"] = UNKNOWN_VALUE;
-            ret["description"]  = description;
-            ret["location"]     = UNKNOWN_VALUE;
         }
 
-        return ret;
+        return parseDpkgStanza(stanza.data(), stanza.data() + stanza.size());
     }
 
     static nlohmann::json parseSnap(const nlohmann::json& info)
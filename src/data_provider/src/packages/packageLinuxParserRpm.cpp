@@ -12,6 +12,7 @@
 #include "packageLinuxDataRetriever.h"
 #include "iberkeleyDbWrapper.h"
 #include "berkeleyRpmDbHelper.h"
+#include "sqliteRpmDbHelper.h"
 #include "sharedDefs.h"
 #include "packageLinuxRpmParserHelper.h"
 #include "packageLinuxRpmParserHelperLegacy.h"
@@ -47,7 +48,33 @@ void getRpmInfo(std::function<void(nlohmann::json&)> callback)
 
     if (!UtilsWrapperLinux::existsRegular(RPM_DATABASE))
     {
-        // We are probably using RPM >= 4.16 – get the packages from librpm.
+        // We are probably using RPM >= 4.16 – the sqlite database is read without librpm when it's
+        // there, librpm is used for the rest of the backends or when the header blobs can't be read.
+        if (UtilsWrapperLinux::existsRegular(RPM_SQLITE_DATABASE))
+        {
+            try
+            {
+                SqliteRpmDBReader db;
+                RpmPackageManager::Package p;
+
+                while (db.getNext(p))
+                {
+                    auto packageJson = PackageLinuxHelper::parseRpm(p);
+
+                    if (!packageJson.empty())
+                    {
+                        callback(packageJson);
+                    }
+                }
+
+                return;
+            }
+            catch (...)
+            {
+                // The packages already reported are reported again by librpm, the rows are the same.
+            }
+        }
+
         try
         {
             RpmPackageManager rpm{std::make_shared<RpmLib>()};
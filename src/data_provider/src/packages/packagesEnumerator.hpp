@@ -0,0 +1,138 @@
+/*
+ * Wazuh SYSINFO
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _PACKAGES_ENUMERATOR_HPP
+#define _PACKAGES_ENUMERATOR_HPP
+
+#include "json.hpp"
+#include "lockFreeQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using PackagesCallback = std::function<void(nlohmann::json&)>;
+using PackagesSource = std::function<void(PackagesCallback)>;
+
+constexpr auto PACKAGES_CHANNEL_CAPACITY { 1024ul };
+
+/**
+ * @brief Runs independent package sources, on up to maxThreads threads.
+ * @details The sources push their packages into a bounded channel and the calling thread drains it,
+ * so the callback is never called concurrently and sees the packages of every source interleaved.
+ * With a single thread or a single source everything runs serially on the calling thread.
+ * The first exception thrown by a source or by the callback is rethrown once every thread is joined.
+ */
+class PackagesEnumerator final
+{
+    public:
+        static void getPackages(const std::vector<PackagesSource>& sources,
+                                PackagesCallback callback,
+                                const unsigned int maxThreads)
+        {
+            const auto threads { std::min<size_t>(maxThreads, sources.size()) };
+
+            if (threads <= 1)
+            {
+                for (const auto& source : sources)
+                {
+                    source(callback);
+                }
+            }
+            else
+            {
+                Utils::LockFreeQueue<nlohmann::json> channel { PACKAGES_CHANNEL_CAPACITY };
+                std::atomic<size_t> next { 0 };
+                std::exception_ptr error;
+                std::mutex errorMutex;
+                std::vector<std::thread> workers;
+                workers.reserve(threads);
+
+                for (size_t i = 0; i < threads; ++i)
+                {
+                    workers.emplace_back([&]()
+                    {
+                        const auto push
+                        {
+                            [&channel](nlohmann::json & data)
+                            {
+                                channel.push(std::move(data));
+                            }
+                        };
+
+                        for (auto index { next++ }; index < sources.size() && !channel.cancelled(); index = next++)
+                        {
+                            try
+                            {
+                                sources[index](push);
+                            }
+                            catch (...)
+                            {
+                                std::lock_guard<std::mutex> lock{ errorMutex };
+
+                                if (!error)
+                                {
+                                    error = std::current_exception();
+                                }
+                            }
+                        }
+
+                        // A null element tells the consumer that this worker is done.
+                        channel.push(nlohmann::json());
+                    });
+                }
+
+                try
+                {
+                    nlohmann::json data;
+
+                    for (size_t done = 0; done < threads && channel.pop(data);)
+                    {
+                        if (data.is_null())
+                        {
+                            ++done;
+                        }
+                        else
+                        {
+                            callback(data);
+                        }
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock{ errorMutex };
+
+                    if (!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+
+                // Producers blocked on a full channel give up once it is cancelled.
+                channel.cancel();
+
+                for (auto& worker : workers)
+                {
+                    worker.join();
+                }
+
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+};
+
+#endif // _PACKAGES_ENUMERATOR_HPP
@@ -108,10 +108,68 @@ class NPM final
             }
         }
 
+        void fingerprintExpandedPaths(const std::deque<std::string>& expandedPaths, std::string& fingerprint)
+        {
+            for (const auto& expandedPath : expandedPaths)
+            {
+                try
+                {
+                    const auto nodeModulesFolder {std::filesystem::path(expandedPath) / "node_modules"};
+
+                    if (TFileSystem::exists(nodeModulesFolder))
+                    {
+                        fingerprint += nodeModulesFolder.string() + "=" +
+                                       std::to_string(TFileSystem::last_write_time(nodeModulesFolder)) + ";";
+
+                        for (const auto& packageFolder : TFileSystem::directory_iterator(nodeModulesFolder))
+                        {
+                            const auto packageJson { std::filesystem::path(packageFolder) / "package.json" };
+
+                            if (TFileSystem::exists(packageJson))
+                            {
+                                fingerprint += std::filesystem::path(packageFolder).filename().string() + "=" +
+                                               std::to_string(TFileSystem::last_write_time(packageJson)) + ";";
+                            }
+                        }
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    // Ignore exception, continue with next folder
+                }
+            }
+        }
+
     public:
         NPM() = default;
         ~NPM() = default;
 
+        /**
+         * @brief Fingerprint of the node_modules folders explored by getPackages: their modification time and
+         * the one of each package.json, without reading them.
+         */
+        std::string getFingerprint(const std::set<std::string>& osRootFolders)
+        {
+            std::string fingerprint;
+
+            for (const auto& osRootFolder : osRootFolders)
+            {
+                try
+                {
+                    std::deque<std::string> expandedPaths;
+
+                    Utils::expandAbsolutePath(osRootFolder, expandedPaths);
+                    fingerprintExpandedPaths(expandedPaths, fingerprint);
+                }
+                catch (const std::exception& e)
+                {
+                    // Ignore exception, continue with next folder
+                }
+            }
+
+            return fingerprint;
+        }
+
         void getPackages(const std::set<std::string>& osRootFolders, std::function<void(nlohmann::json&)> callback)
         {
 
@@ -133,7 +133,56 @@ class PYPI final : public TFileSystem, public TFileIO
             }
         }
 
+        void fingerprintExpandedPaths(const std::deque<std::string>& expandedPaths, std::string& fingerprint)
+        {
+            for (const auto& expandedPath : expandedPaths)
+            {
+                try
+                {
+                    if (TFileSystem::exists(expandedPath) && TFileSystem::is_directory(expandedPath))
+                    {
+                        fingerprint += expandedPath + "=" + std::to_string(TFileSystem::last_write_time(expandedPath)) + ";";
+
+                        for (const std::filesystem::path& path : TFileSystem::directory_iterator(expandedPath))
+                        {
+                            fingerprint += path.filename().string() + "=" + std::to_string(TFileSystem::last_write_time(path)) + ";";
+                        }
+                    }
+                }
+                catch (const std::exception&)
+                {
+                    // Do nothing, continue with the next path
+                }
+            }
+        }
+
     public:
+        /**
+         * @brief Fingerprint of the folders explored by getPackages: their modification time and the one of
+         * each package folder or file, without reading any metadata.
+         */
+        std::string getFingerprint(const std::set<std::string>& osRootFolders)
+        {
+            std::string fingerprint;
+
+            for (const auto& osFolder : osRootFolders)
+            {
+                std::deque<std::string> expandedPaths;
+
+                try
+                {
+                    Utils::expandAbsolutePath(osFolder, expandedPaths);
+                    fingerprintExpandedPaths(expandedPaths, fingerprint);
+                }
+                catch (const std::exception&)
+                {
+                    // Do nothing, continue with the next path
+                }
+            }
+
+            return fingerprint;
+        }
+
         void getPackages(const std::set<std::string>& osRootFolders, std::function<void(nlohmann::json&)> callback)
         {
 
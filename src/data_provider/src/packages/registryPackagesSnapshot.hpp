@@ -0,0 +1,93 @@
+/*
+ * Wazuh SYSINFO
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _REGISTRY_PACKAGES_SNAPSHOT_HPP
+#define _REGISTRY_PACKAGES_SNAPSHOT_HPP
+
+#include "json.hpp"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Packages parsed from registry keys, remembered with the last write time of their key.
+ * @details A scan calls begin(), then get() for every key it enumerates and commit() once it is complete.
+ * Keys whose last write time didn't change since the previous complete scan aren't parsed again, and the
+ * keys not seen by a complete scan are dropped. An incomplete scan keeps the previous snapshot.
+ * get() can be called from several threads at once.
+ */
+class RegistryPackagesSnapshot final
+{
+    public:
+        void begin()
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_current.clear();
+        }
+
+        /**
+         * @brief Package of a key, parsed only when the key changed.
+         *
+         * @param key           Unique path of the key.
+         * @param lastWriteTime Last write time of the key.
+         * @param parse         Reads the key, returns a null json when the key doesn't hold a package.
+         * @return Package of the key, null when it doesn't hold one.
+         */
+        nlohmann::json get(const std::string& key,
+                           const uint64_t lastWriteTime,
+                           const std::function<nlohmann::json()>& parse)
+        {
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                const auto it { m_previous.find(key) };
+
+                if (m_previous.end() != it && it->second.lastWriteTime == lastWriteTime)
+                {
+                    return m_current.emplace(key, it->second).first->second.package;
+                }
+            }
+
+            // Keys are read without holding the lock, they are independent. No braces, they would wrap the json in an array.
+            auto package = parse();
+
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_current[key] = Entry{ lastWriteTime, package };
+            return package;
+        }
+
+        void commit()
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            m_previous = std::move(m_current);
+            m_current.clear();
+        }
+
+        size_t size() const
+        {
+            std::lock_guard<std::mutex> lock{ m_mutex };
+            return m_previous.size();
+        }
+
+    private:
+        struct Entry
+        {
+            uint64_t lastWriteTime;
+            nlohmann::json package;
+        };
+
+        std::unordered_map<std::string, Entry> m_previous;
+        std::unordered_map<std::string, Entry> m_current;
+        mutable std::mutex m_mutex;
+};
+
+#endif // _REGISTRY_PACKAGES_SNAPSHOT_HPP
@@ -0,0 +1,177 @@
+/*
+ * Wazuh SysInfo
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#ifndef _RPM_HEADER_PROJECTION_H
+#define _RPM_HEADER_PROJECTION_H
+
+#include <cstring>
+#include <string>
+#include "byteArrayHelper.h"
+#include "rpmPackageManager.h"
+
+constexpr size_t RPM_HEADER_INDEX_OFFSET { 8 };
+constexpr size_t RPM_HEADER_ENTRY_SIZE { 16 };
+// This constant is defined with this value in the RPM source code (header.c)
+constexpr int32_t RPM_HEADER_TAGS_MAX { 0x0000ffff };
+
+// Decodes the package fields from a header blob as it's stored in the rpmdb (index length, data
+// length, index entries and data). The index is walked once and only the tags of the package are
+// read, the rest of them (files, dependencies, changelog...) are never decoded.
+class RpmHeaderProjection final
+{
+        static std::string getString(const uint8_t* data, const size_t dataSize, const int32_t type, const size_t offset)
+        {
+            std::string retVal;
+
+            if (RPM_STRING_TYPE == type || RPM_I18NSTRING_TYPE == type || RPM_STRING_ARRAY_TYPE == type)
+            {
+                // The first string of an I18N or array tag is the one returned by librpm in the C locale.
+                const auto str { reinterpret_cast<const char*>(data + offset) };
+                retVal.assign(str, strnlen(str, dataSize - offset));
+            }
+
+            return retVal;
+        }
+
+        static uint64_t getNumber(const uint8_t* data, const size_t dataSize, const int32_t type, const size_t offset)
+        {
+            uint64_t retVal { 0 };
+
+            if (RPM_INT32_TYPE == type && offset + sizeof(int32_t) <= dataSize)
+            {
+                retVal = static_cast<uint32_t>(Utils::toInt32BE(data + offset));
+            }
+            else if (RPM_INT64_TYPE == type && offset + sizeof(int64_t) <= dataSize)
+            {
+                retVal = static_cast<uint64_t>(static_cast<uint32_t>(Utils::toInt32BE(data + offset))) << 32 |
+                         static_cast<uint32_t>(Utils::toInt32BE(data + offset + sizeof(int32_t)));
+            }
+
+            return retVal;
+        }
+
+    public:
+        /**
+         * @brief Decodes one header blob.
+         *
+         * @param blob    Header blob.
+         * @param size    Size of the blob.
+         * @param package Package filled with the tags found in the header.
+         *
+         * @return false when the blob isn't a valid header.
+         */
+        static bool decode(const uint8_t* blob, const size_t size, RpmPackageManager::Package& package)
+        {
+            if (!blob || size < RPM_HEADER_INDEX_OFFSET)
+            {
+                return false;
+            }
+
+            const auto indexLength { Utils::toInt32BE(blob) };
+            const auto dataLength { Utils::toInt32BE(blob + sizeof(int32_t)) };
+
+            if (indexLength <= 0 || indexLength > RPM_HEADER_TAGS_MAX || dataLength < 0 ||
+                    RPM_HEADER_INDEX_OFFSET + indexLength * RPM_HEADER_ENTRY_SIZE + dataLength > size)
+            {
+                return false;
+            }
+
+            const auto data { blob + RPM_HEADER_INDEX_OFFSET + indexLength * RPM_HEADER_ENTRY_SIZE };
+            const auto dataSize { static_cast<size_t>(dataLength) };
+            uint64_t longSize { 0 };
+            package = {};
+
+            for (auto entry { blob + RPM_HEADER_INDEX_OFFSET }; entry < data; entry += RPM_HEADER_ENTRY_SIZE)
+            {
+                const auto tag { Utils::toInt32BE(entry) };
+                const auto type { Utils::toInt32BE(entry + sizeof(int32_t)) };
+                const auto offset { Utils::toInt32BE(entry + 2 * sizeof(int32_t)) };
+
+                if (offset < 0 || static_cast<size_t>(offset) >= dataSize)
+                {
+                    continue;
+                }
+
+                switch (tag)
+                {
+                    case RPMTAG_NAME:
+                        package.name = getString(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_VERSION:
+                        package.version = getString(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_RELEASE:
+                        package.release = getString(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_EPOCH:
+                        package.epoch = getNumber(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_SUMMARY:
+                        package.summary = getString(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_DESCRIPTION:
+                        package.description = getString(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_INSTALLTIME:
+                        package.installTime = std::to_string(getNumber(data, dataSize, type, offset));
+                        break;
+
+                    case RPMTAG_SIZE:
+                        package.size = getNumber(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_LONGSIZE:
+                        longSize = getNumber(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_VENDOR:
+                        package.vendor = getString(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_GROUP:
+                        package.group = getString(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_SOURCE:
+                        package.source = getString(data, dataSize, type, offset);
+                        break;
+
+                    case RPMTAG_ARCH:
+                        package.architecture = getString(data, dataSize, type, offset);
+                        break;
+
+                    default:
+                        break;
+                }
+            }
+
+            if (package.installTime.empty())
+            {
+                package.installTime = "0";
+            }
+
+            // Packages bigger than 4 GiB only have the 64 bits size.
+            if (longSize)
+            {
+                package.size = longSize;
+            }
+
+            return true;
+        }
+};
+
+#endif // _RPM_HEADER_PROJECTION_H
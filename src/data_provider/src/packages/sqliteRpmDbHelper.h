@@ -0,0 +1,91 @@
+/*
+ * Wazuh SysInfo
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#ifndef _SQLITE_RPM_DB_HELPER_H
+#define _SQLITE_RPM_DB_HELPER_H
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include "sqlite3.h"
+#include "customDeleter.hpp"
+#include "rpmHeaderProjection.h"
+
+constexpr auto RPM_SQLITE_DATABASE {"/var/lib/rpm/rpmdb.sqlite"};
+// A running rpm transaction holds the write lock, the reader waits for it up to this time.
+constexpr int RPM_SQLITE_BUSY_TIMEOUT_MS { 5000 };
+
+// Reads the headers of the sqlite rpmdb (RPM >= 4.16) straight from the Packages table, librpm is
+// neither loaded nor initialized (macros, rpmrc, transaction set).
+class SqliteRpmDBReader final
+{
+    private:
+        std::unique_ptr<sqlite3, CustomDeleter<decltype(&sqlite3_close_v2), sqlite3_close_v2>> m_db;
+        std::unique_ptr<sqlite3_stmt, CustomDeleter<decltype(&sqlite3_finalize), sqlite3_finalize>> m_stmt;
+
+    public:
+        explicit SqliteRpmDBReader(const std::string& path = RPM_SQLITE_DATABASE)
+        {
+            sqlite3* db { nullptr };
+            auto result { sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, nullptr) };
+            m_db.reset(db);
+
+            if (SQLITE_OK != result)
+            {
+                throw std::runtime_error { "Error opening the rpm database: " + path };
+            }
+
+            sqlite3_busy_timeout(m_db.get(), RPM_SQLITE_BUSY_TIMEOUT_MS);
+
+            sqlite3_stmt* stmt { nullptr };
+            result = sqlite3_prepare_v2(m_db.get(), "SELECT blob FROM Packages;", -1, &stmt, nullptr);
+            m_stmt.reset(stmt);
+
+            if (SQLITE_OK != result)
+            {
+                throw std::runtime_error { "Error reading the rpm database: " + std::string(sqlite3_errmsg(m_db.get())) };
+            }
+        }
+
+        /**
+         * @brief Gets the next package of the database, the invalid headers are skipped.
+         *
+         * @param package Next package.
+         *
+         * @return false when there are no more packages.
+         */
+        bool getNext(RpmPackageManager::Package& package)
+        {
+            auto result { sqlite3_step(m_stmt.get()) };
+
+            while (SQLITE_ROW == result)
+            {
+                const auto blob { static_cast<const uint8_t*>(sqlite3_column_blob(m_stmt.get(), 0)) };
+                const auto size { sqlite3_column_bytes(m_stmt.get(), 0) };
+
+                if (size > 0 && RpmHeaderProjection::decode(blob, static_cast<size_t>(size), package))
+                {
+                    return true;
+                }
+
+                result = sqlite3_step(m_stmt.get());
+            }
+
+            if (SQLITE_DONE != result)
+            {
+                throw std::runtime_error { "Error reading the rpm database: " + std::string(sqlite3_errmsg(m_db.get())) };
+            }
+
+            return false;
+        }
+};
+
+#endif // _SQLITE_RPM_DB_HELPER_H
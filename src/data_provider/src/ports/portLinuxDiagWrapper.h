@@ -0,0 +1,218 @@
+/*
+ * Wazuh SYSINFO
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _PORT_LINUX_DIAG_WRAPPER_H
+#define _PORT_LINUX_DIAG_WRAPPER_H
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <arpa/inet.h>
+#include <linux/inet_diag.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <sys/socket.h>
+#include "networkHelper.h"
+#include "stringHelper.h"
+#include "uniqueFD.hpp"
+#include "portLinuxWrapper.h"
+
+// Every TCP state, including the time-wait and request sockets listed in /proc/net.
+constexpr uint32_t INET_DIAG_ALL_STATES { 0xFFFFFFFF };
+constexpr uint32_t INET_DIAG_LISTENING_STATES { 1u << TCP_LISTEN };
+constexpr size_t INET_DIAG_BUFFER_SIZE { 64 * 1024 };
+
+static const std::map<PortType, std::pair<uint8_t, uint8_t>> INET_DIAG_FAMILY_PROTOCOL =
+{
+    { UDP_IPV4,                            { AF_INET,  IPPROTO_UDP } },
+    { UDP_IPV6,                            { AF_INET6, IPPROTO_UDP } },
+    { TCP_IPV4,                            { AF_INET,  IPPROTO_TCP } },
+    { TCP_IPV6,                            { AF_INET6, IPPROTO_TCP } }
+};
+
+/**
+ * @brief Dumps the sockets of one type through a NETLINK_SOCK_DIAG socket.
+ *
+ * @param type     Socket family and protocol to dump.
+ * @param states   Bit mask of the TCP states the kernel has to report.
+ * @param callback Called with every socket record.
+ *
+ * @return false when the dump can't be done (e.g. the diag module of the protocol is missing),
+ * the records already passed to the callback are then incomplete.
+ */
+static inline bool inetDiagDump(const PortType type,
+                                const uint32_t states,
+                                const std::function<void(const inet_diag_msg&)>& callback)
+{
+    const Utils::UniqueFD sock { socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG) };
+
+    if (-1 == sock.get())
+    {
+        return false;
+    }
+
+    struct
+    {
+        nlmsghdr header;
+        inet_diag_req_v2 request;
+    } message {};
+
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.request.sdiag_family = INET_DIAG_FAMILY_PROTOCOL.at(type).first;
+    message.request.sdiag_protocol = INET_DIAG_FAMILY_PROTOCOL.at(type).second;
+    message.request.idiag_states = states;
+
+    sockaddr_nl kernel {};
+    kernel.nl_family = AF_NETLINK;
+
+    if (-1 == sendto(sock.get(), &message, sizeof(message), 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)))
+    {
+        return false;
+    }
+
+    const auto buffer { std::make_unique<char[]>(INET_DIAG_BUFFER_SIZE) };
+
+    while (true)
+    {
+        const auto length { recv(sock.get(), buffer.get(), INET_DIAG_BUFFER_SIZE, 0) };
+
+        if (length <= 0)
+        {
+            return false;
+        }
+
+        auto remaining { static_cast<int>(length) };
+
+        for (auto header { reinterpret_cast<const nlmsghdr*>(buffer.get()) };
+                NLMSG_OK(header, remaining);
+                header = NLMSG_NEXT(header, remaining))
+        {
+            if (NLMSG_DONE == header->nlmsg_type)
+            {
+                return true;
+            }
+
+            if (NLMSG_ERROR == header->nlmsg_type || header->nlmsg_len < NLMSG_LENGTH(sizeof(inet_diag_msg)))
+            {
+                return false;
+            }
+
+            callback(*static_cast<const inet_diag_msg*>(NLMSG_DATA(header)));
+        }
+    }
+}
+
+class LinuxPortDiagWrapper final : public IPortWrapper
+{
+        PortType m_type;
+        inet_diag_msg m_message;
+
+        std::string address(const __be32 (&rawAddress)[4]) const
+        {
+            std::string retVal;
+
+            if (IPVERSION_TYPE.at(m_type) == IPV4)
+            {
+                in_addr addr {};
+                addr.s_addr = rawAddress[0];
+                retVal = Utils::NetworkHelper::IAddressToBinary(AF_INET, &addr);
+            }
+            else if (IPVERSION_TYPE.at(m_type) == IPV6)
+            {
+                in6_addr sin6 {};
+                std::copy(std::begin(rawAddress), std::end(rawAddress), sin6.s6_addr32);
+                retVal = Utils::NetworkHelper::IAddressToBinary(AF_INET6, &sin6);
+            }
+
+            return retVal;
+        }
+
+    public:
+        explicit LinuxPortDiagWrapper(const PortType type, const inet_diag_msg& message)
+            : m_type { type }
+            , m_message { message }
+        { }
+
+        ~LinuxPortDiagWrapper() = default;
+        std::string protocol() const override
+        {
+            std::string retVal;
+
+            const auto it { PORTS_TYPE.find(m_type) };
+
+            if (PORTS_TYPE.end() != it)
+            {
+                retVal = it->second;
+            }
+
+            return retVal;
+        }
+
+        std::string localIp() const override
+        {
+            return address(m_message.id.idiag_src);
+        }
+        int32_t localPort() const override
+        {
+            return ntohs(m_message.id.idiag_sport);
+        }
+        std::string remoteIP() const override
+        {
+            return address(m_message.id.idiag_dst);
+        }
+        int32_t remotePort() const override
+        {
+            return ntohs(m_message.id.idiag_dport);
+        }
+        // The diag queues are the same counters printed in the tx_queue:rx_queue column of /proc/net.
+        int32_t txQueue() const override
+        {
+            return static_cast<int32_t>(m_message.idiag_wqueue);
+        }
+        int32_t rxQueue() const override
+        {
+            return static_cast<int32_t>(m_message.idiag_rqueue);
+        }
+        int64_t inode() const override
+        {
+            return static_cast<int64_t>(m_message.idiag_inode);
+        }
+        std::string state() const override
+        {
+            std::string retVal;
+
+            if (TCP == PROTOCOL_TYPE.at(m_type))
+            {
+                const auto itState { STATE_TYPE.find(m_message.idiag_state) };
+
+                if (STATE_TYPE.end() != itState)
+                {
+                    retVal = itState->second;
+                }
+            }
+
+            return retVal;
+        }
+
+        std::string processName() const override
+        {
+            return UNKNOWN_VALUE;
+        }
+
+        int32_t pid() const override
+        {
+            return {};
+        }
+};
+
+#endif //_PORT_LINUX_DIAG_WRAPPER_H
@@ -0,0 +1,294 @@
+/*
+ * Wazuh SYSINFO
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _PROCESS_TRACE_WINDOWS_H
+#define _PROCESS_TRACE_WINDOWS_H
+
+#include <winsock2.h>
+#include <windows.h>
+#include <evntrace.h>
+#include <evntcons.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "encodingWindowsHelper.h"
+
+constexpr auto PROCESS_TRACE_SESSION_NAME { "Wazuh Syscollector Processes" };
+// Microsoft-Windows-Kernel-Process
+static const GUID KERNEL_PROCESS_PROVIDER { 0x22fb2cd6, 0x0e7b, 0x422b, { 0xa0, 0xc7, 0x2f, 0xad, 0x1f, 0xd0, 0xe7, 0x16 } };
+constexpr ULONGLONG KERNEL_PROCESS_KEYWORD { 0x10 }; // WINEVENT_KEYWORD_PROCESS
+constexpr USHORT PROCESS_START_EVENT { 1 };
+constexpr USHORT PROCESS_STOP_EVENT { 2 };
+// Processes started and gone between two scans, kept at most.
+constexpr size_t PROCESS_TRACE_MAX_EXITED { 1024 };
+
+struct TracedProcess final
+{
+    DWORD pid;
+    ULONGLONG createTime;
+    DWORD ppid;
+    DWORD session;
+    std::string name;
+};
+
+struct ProcessTraceChanges final
+{
+    // Processes started since the previous call, by pid.
+    std::set<DWORD> started;
+    // Processes both started and gone since the previous call.
+    std::vector<TracedProcess> exited;
+    // Events were dropped, the changes are incomplete.
+    bool lost;
+};
+
+/**
+ * @brief Real-time ETW consumer of the process start and stop events of the kernel.
+ * @details The session is started by the constructor and consumed on a thread of its own until the object is
+ * destroyed. When it can't be started, running() is false and every scan has to read all the processes.
+ * A session left behind by a previous agent instance is stopped and replaced.
+ */
+class KernelProcessTrace final
+{
+    public:
+        KernelProcessTrace()
+            : m_properties(sizeof(EVENT_TRACE_PROPERTIES) + sizeof(m_sessionName))
+            , m_session { 0 }
+            , m_trace { INVALID_TRACE_HANDLE }
+            , m_eventsLost { 0 }
+        {
+            std::strncpy(m_sessionName, PROCESS_TRACE_SESSION_NAME, sizeof(m_sessionName) - 1);
+
+            auto result { StartTraceA(&m_session, m_sessionName, properties()) };
+
+            if (ERROR_ALREADY_EXISTS == result)
+            {
+                ControlTraceA(0, m_sessionName, properties(), EVENT_TRACE_CONTROL_STOP);
+                result = StartTraceA(&m_session, m_sessionName, properties());
+            }
+
+            if (ERROR_SUCCESS != result)
+            {
+                m_session = 0;
+                return;
+            }
+
+            if (ERROR_SUCCESS != EnableTraceEx(&KERNEL_PROCESS_PROVIDER, nullptr, m_session, TRUE, TRACE_LEVEL_INFORMATION,
+                                               KERNEL_PROCESS_KEYWORD, 0, 0, nullptr))
+            {
+                stopSession();
+                return;
+            }
+
+            EVENT_TRACE_LOGFILEA logFile {};
+            logFile.LoggerName = m_sessionName;
+            logFile.ProcessTraceMode = PROCESS_TRACE_MODE_REAL_TIME | PROCESS_TRACE_MODE_EVENT_RECORD;
+            logFile.EventRecordCallback = &KernelProcessTrace::onEvent;
+            logFile.Context = this;
+
+            m_trace = OpenTraceA(&logFile);
+
+            if (!validTrace())
+            {
+                m_trace = INVALID_TRACE_HANDLE;
+                stopSession();
+                return;
+            }
+
+            // ProcessTrace blocks until the session is stopped.
+            m_consumer = std::thread([this]()
+            {
+                ::ProcessTrace(&m_trace, 1, nullptr, nullptr);
+            });
+        }
+
+        ~KernelProcessTrace()
+        {
+            stopSession();
+
+            if (INVALID_TRACE_HANDLE != m_trace)
+            {
+                CloseTrace(m_trace);
+            }
+
+            if (m_consumer.joinable())
+            {
+                m_consumer.join();
+            }
+        }
+
+        KernelProcessTrace(const KernelProcessTrace&) = delete;
+        KernelProcessTrace& operator=(const KernelProcessTrace&) = delete;
+
+        bool running() const
+        {
+            return 0 != m_session;
+        }
+
+        /**
+         * @brief Changes traced since the previous call.
+         * @details Events reach the consumer when the session buffers are flushed, about a second late: a pid
+         *          reused right before a scan is reported as started by the following one.
+         */
+        ProcessTraceChanges takeChanges()
+        {
+            ProcessTraceChanges ret {};
+
+            // The counters of the session tell about the buffers dropped before reaching the consumer.
+            if (ERROR_SUCCESS == ControlTraceA(m_session, nullptr, properties(), EVENT_TRACE_CONTROL_QUERY))
+            {
+                const auto eventsLost { properties()->EventsLost + properties()->RealTimeBuffersLost };
+
+                if (eventsLost != m_eventsLost)
+                {
+                    m_eventsLost = eventsLost;
+                    ret.lost = true;
+                }
+            }
+            else
+            {
+                // The session was stopped from outside, nothing is traced anymore.
+                m_session = 0;
+                ret.lost = true;
+            }
+
+            std::lock_guard<std::mutex> lock { m_mutex };
+
+            for (const auto& process : m_started)
+            {
+                ret.started.insert(process.first);
+            }
+
+            ret.exited = std::move(m_exited);
+            m_started.clear();
+            m_exited.clear();
+            return ret;
+        }
+
+    private:
+        static constexpr TRACEHANDLE INVALID_TRACE_HANDLE { static_cast<TRACEHANDLE>(-1) };
+
+        EVENT_TRACE_PROPERTIES* properties()
+        {
+            // The properties are rewritten by every control call.
+            auto properties { reinterpret_cast<EVENT_TRACE_PROPERTIES*>(m_properties.data()) };
+            std::fill(m_properties.begin(), m_properties.end(), 0);
+            properties->Wnode.BufferSize = static_cast<ULONG>(m_properties.size());
+            properties->Wnode.Flags = WNODE_FLAG_TRACED_GUID;
+            properties->Wnode.ClientContext = 1;
+            properties->LogFileMode = EVENT_TRACE_REAL_TIME_MODE;
+            properties->LoggerNameOffset = sizeof(EVENT_TRACE_PROPERTIES);
+            return properties;
+        }
+
+        bool validTrace() const
+        {
+            // 32 bit builds get the invalid handle value zero extended.
+            return INVALID_TRACE_HANDLE != m_trace &&
+                   static_cast<TRACEHANDLE>(reinterpret_cast<ULONG_PTR>(INVALID_HANDLE_VALUE)) != m_trace;
+        }
+
+        void stopSession()
+        {
+            if (0 != m_session)
+            {
+                ControlTraceA(m_session, nullptr, properties(), EVENT_TRACE_CONTROL_STOP);
+                m_session = 0;
+            }
+        }
+
+        static std::string imageName(const EVENT_RECORD& record, const size_t offset)
+        {
+            std::wstring path;
+            const auto data { static_cast<const BYTE*>(record.UserData) };
+
+            for (auto it { offset }; it + sizeof(WCHAR) <= record.UserDataLength; it += sizeof(WCHAR))
+            {
+                WCHAR character;
+                std::memcpy(&character, data + it, sizeof(character));
+
+                if (L'\0' == character)
+                {
+                    break;
+                }
+
+                path.push_back(character);
+            }
+
+            // The image is a device path, the inventory holds the file name only.
+            const auto separator { path.find_last_of(L'\\') };
+            return Utils::EncodingWindowsHelper::wstringToStringUTF8(std::wstring::npos == separator ? path : path.substr(separator + 1));
+        }
+
+        static void WINAPI onEvent(PEVENT_RECORD record)
+        {
+            constexpr size_t CREATE_TIME_OFFSET { sizeof(DWORD) };
+            constexpr size_t PARENT_OFFSET { CREATE_TIME_OFFSET + sizeof(ULONGLONG) };
+            constexpr size_t SESSION_OFFSET { PARENT_OFFSET + sizeof(DWORD) };
+            constexpr size_t FLAGS_OFFSET { SESSION_OFFSET + sizeof(DWORD) };
+            const auto self { static_cast<KernelProcessTrace*>(record->UserContext) };
+            const auto id { record->EventHeader.EventDescriptor.Id };
+            const auto data { static_cast<const BYTE*>(record->UserData) };
+
+            if (!IsEqualGUID(record->EventHeader.ProviderId, KERNEL_PROCESS_PROVIDER) ||
+                    record->UserDataLength < FLAGS_OFFSET)
+            {
+                return;
+            }
+
+            TracedProcess process {};
+            std::memcpy(&process.pid, data, sizeof(process.pid));
+            std::memcpy(&process.createTime, data + CREATE_TIME_OFFSET, sizeof(process.createTime));
+
+            if (PROCESS_START_EVENT == id)
+            {
+                std::memcpy(&process.ppid, data + PARENT_OFFSET, sizeof(process.ppid));
+                std::memcpy(&process.session, data + SESSION_OFFSET, sizeof(process.session));
+                // Version 0 (Windows 7) has no Flags before the image name.
+                process.name = imageName(*record, record->EventHeader.EventDescriptor.Version ? FLAGS_OFFSET + sizeof(DWORD) : FLAGS_OFFSET);
+
+                std::lock_guard<std::mutex> lock { self->m_mutex };
+                self->m_started[process.pid] = std::move(process);
+            }
+            else if (PROCESS_STOP_EVENT == id)
+            {
+                std::lock_guard<std::mutex> lock { self->m_mutex };
+                const auto it { self->m_started.find(process.pid) };
+
+                if (self->m_started.end() != it && it->second.createTime == process.createTime)
+                {
+                    if (self->m_exited.size() < PROCESS_TRACE_MAX_EXITED)
+                    {
+                        self->m_exited.push_back(std::move(it->second));
+                    }
+
+                    // Its pid can't be in the next snapshot, unless a newer process takes it and is traced too.
+                    self->m_started.erase(it);
+                }
+            }
+        }
+
+        std::vector<BYTE> m_properties;
+        char m_sessionName[sizeof("Wazuh Syscollector Processes")] {};
+        TRACEHANDLE m_session;
+        TRACEHANDLE m_trace;
+        ULONG m_eventsLost;
+        std::thread m_consumer;
+        std::mutex m_mutex;
+        std::map<DWORD, TracedProcess> m_started;
+        std::vector<TracedProcess> m_exited;
+};
+
+#endif // _PROCESS_TRACE_WINDOWS_H
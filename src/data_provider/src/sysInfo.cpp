@@ -17,6 +17,16 @@ nlohmann::json SysInfo::hardware()
     return getHardware();
 }
 
+nlohmann::json SysInfo::memory()
+{
+    return getMemoryInfo();
+}
+
+std::string SysInfo::bootId()
+{
+    return getBootId();
+}
+
 nlohmann::json SysInfo::packages()
 {
     return getPackages();
@@ -42,21 +52,63 @@ nlohmann::json SysInfo::ports()
     return getPorts();
 }
 
+nlohmann::json SysInfo::listeningPorts()
+{
+    return getListeningPorts();
+}
+
+void SysInfo::ports(std::function<void(nlohmann::json&)> callback)
+{
+    getPorts(false, callback);
+}
+
+void SysInfo::listeningPorts(std::function<void(nlohmann::json&)> callback)
+{
+    getPorts(true, callback);
+}
+
+void SysInfo::networks(std::function<void(nlohmann::json&)> callback)
+{
+    getNetworks(callback);
+}
+
 void SysInfo::processes(std::function<void(nlohmann::json&)> callback)
 {
     getProcessesInfo(callback);
 }
 
+void SysInfo::processes(const std::set<std::string>& fields, std::function<void(nlohmann::json&)> callback)
+{
+    getProcessesInfo(fields, callback);
+}
+
+void SysInfo::processes(const std::set<std::string>& fields,
+                        std::function<void(nlohmann::json&)> changedCallback,
+                        std::function<void(const nlohmann::json&)> unchangedCallback)
+{
+    getProcessesInfo(fields, changedCallback, unchangedCallback);
+}
+
 void SysInfo::packages(std::function<void(nlohmann::json&)> callback)
 {
     getPackages(callback);
 }
 
+nlohmann::json SysInfo::packagesFingerprint()
+{
+    return getPackagesFingerprint();
+}
+
 nlohmann::json SysInfo::hotfixes()
 {
     return getHotfixes();
 }
 
+void SysInfo::hotfixes(std::function<void(nlohmann::json&)> callback)
+{
+    getHotfixes(callback);
+}
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -263,6 +315,102 @@ int sysinfo_processes_cb(callback_data_t callback_data)
     return retVal;
 }
 
+int sysinfo_ports_cb(callback_data_t callback_data)
+{
+    auto retVal { -1 };
+
+    try
+    {
+        if (callback_data.callback)
+        {
+            const auto callbackWrapper
+            {
+                [callback_data](nlohmann::json & jsonResult)
+                {
+                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ cJSON_Parse(jsonResult.dump().c_str()) };
+                    callback_data.callback(GENERIC, spJson.get(), callback_data.user_data);
+                }
+            };
+            // LCOV_EXCL_START
+            SysInfo info;
+            // LCOV_EXCL_STOP
+            info.ports(callbackWrapper);
+            retVal = 0;
+        }
+    }
+    // LCOV_EXCL_START
+    catch (...)
+    {}
+
+    // LCOV_EXCL_STOP
+
+    return retVal;
+}
+
+int sysinfo_networks_cb(callback_data_t callback_data)
+{
+    auto retVal { -1 };
+
+    try
+    {
+        if (callback_data.callback)
+        {
+            const auto callbackWrapper
+            {
+                [callback_data](nlohmann::json & jsonResult)
+                {
+                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ cJSON_Parse(jsonResult.dump().c_str()) };
+                    callback_data.callback(GENERIC, spJson.get(), callback_data.user_data);
+                }
+            };
+            // LCOV_EXCL_START
+            SysInfo info;
+            // LCOV_EXCL_STOP
+            info.networks(callbackWrapper);
+            retVal = 0;
+        }
+    }
+    // LCOV_EXCL_START
+    catch (...)
+    {}
+
+    // LCOV_EXCL_STOP
+
+    return retVal;
+}
+
+int sysinfo_hotfixes_cb(callback_data_t callback_data)
+{
+    auto retVal { -1 };
+
+    try
+    {
+        if (callback_data.callback)
+        {
+            const auto callbackWrapper
+            {
+                [callback_data](nlohmann::json & jsonResult)
+                {
+                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ cJSON_Parse(jsonResult.dump().c_str()) };
+                    callback_data.callback(GENERIC, spJson.get(), callback_data.user_data);
+                }
+            };
+            // LCOV_EXCL_START
+            SysInfo info;
+            // LCOV_EXCL_STOP
+            info.hotfixes(callbackWrapper);
+            retVal = 0;
+        }
+    }
+    // LCOV_EXCL_START
+    catch (...)
+    {}
+
+    // LCOV_EXCL_STOP
+
+    return retVal;
+}
+
 int sysinfo_hotfixes(cJSON** js_result)
 {
     auto retVal { -1 };
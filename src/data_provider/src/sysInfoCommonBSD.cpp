@@ -46,3 +46,18 @@ nlohmann::json SysInfo::getNetworks() const
     return networks;
 }
 
+void SysInfo::getNetworks(std::function<void(nlohmann::json&)> callback) const
+{
+    // The interfaces are gathered all at once on this OS.
+    auto networks = getNetworks();
+    const auto it { networks.find("iface") };
+
+    if (networks.end() != it)
+    {
+        for (auto& iface : it.value())
+        {
+            callback(iface);
+        }
+    }
+}
+
@@ -8,10 +8,16 @@
  * License (version 2) as published by the FSF - Free Software
  * Foundation.
  */
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <regex>
+#include <sstream>
+#include <sys/stat.h>
 #include <sys/utsname.h>
+#include <thread>
+#include <cstdlib>
+#include <cstring>
 #include "packages/modernPackageDataRetriever.hpp"
 #include "sharedDefs.h"
 #include "stringHelper.h"
@@ -23,8 +29,10 @@
 #include "networkUnixHelper.h"
 #include "networkHelper.h"
 #include "network/networkLinuxWrapper.h"
+#include "network/networkLinuxNetlinkWrapper.h"
 #include "network/networkFamilyDataAFactory.h"
 #include "ports/portLinuxWrapper.h"
+#include "ports/portLinuxDiagWrapper.h"
 #include "ports/portImpl.h"
 #include "packages/berkeleyRpmDbHelper.h"
 #include "packages/packageLinuxDataRetriever.h"
@@ -79,32 +87,24 @@ static bool getSystemInfo(const std::string& fileName, const std::string& separa
     return ret;
 }
 
-static nlohmann::json getProcessInfo(const SysInfoProcess& process)
+static std::pair<std::string, std::string> getCommandLine(const proc_t& process)
 {
-    nlohmann::json jsProcessInfo{};
-    // Current process information
-    jsProcessInfo["pid"]        = std::to_string(process->tid);
-    jsProcessInfo["name"]       = process->cmd;
-    jsProcessInfo["state"]      = &process->state;
-    jsProcessInfo["ppid"]       = process->ppid;
-    jsProcessInfo["utime"]      = process->utime;
-    jsProcessInfo["stime"]      = process->stime;
     std::string commandLine;
     std::string commandLineArgs;
 
-    if (process->cmdline && process->cmdline[0])
+    if (process.cmdline && process.cmdline[0])
     {
-        commandLine = process->cmdline[0];
+        commandLine = process.cmdline[0];
 
-        for (int idx = 1; process->cmdline[idx]; ++idx)
+        for (int idx = 1; process.cmdline[idx]; ++idx)
         {
-            const auto cmdlineArgSize { sizeof(process->cmdline[idx]) };
+            const auto cmdlineArgSize { sizeof(process.cmdline[idx]) };
 
-            if (strnlen(process->cmdline[idx], cmdlineArgSize) != 0)
+            if (strnlen(process.cmdline[idx], cmdlineArgSize) != 0)
             {
-                commandLineArgs += process->cmdline[idx];
+                commandLineArgs += process.cmdline[idx];
 
-                if (process->cmdline[idx + 1])
+                if (process.cmdline[idx + 1])
                 {
                     commandLineArgs += " ";
                 }
@@ -112,31 +112,108 @@ static nlohmann::json getProcessInfo(const SysInfoProcess& process)
         }
     }
 
-    jsProcessInfo["cmd"]        = commandLine;
-    jsProcessInfo["argvs"]      = commandLineArgs;
-    jsProcessInfo["euser"]      = process->euser;
-    jsProcessInfo["ruser"]      = process->ruser;
-    jsProcessInfo["suser"]      = process->suser;
-    jsProcessInfo["egroup"]     = process->egroup;
-    jsProcessInfo["rgroup"]     = process->rgroup;
-    jsProcessInfo["sgroup"]     = process->sgroup;
-    jsProcessInfo["fgroup"]     = process->fgroup;
-    jsProcessInfo["priority"]   = process->priority;
-    jsProcessInfo["nice"]       = process->nice;
-    jsProcessInfo["size"]       = process->size;
-    jsProcessInfo["vm_size"]    = process->vm_size;
-    jsProcessInfo["resident"]   = process->vm_rss;
-    jsProcessInfo["share"]      = process->share;
-    jsProcessInfo["start_time"] = Utils::timeTick2unixTime(process->start_time);
-    jsProcessInfo["pgrp"]       = process->pgrp;
-    jsProcessInfo["session"]    = process->session;
-    jsProcessInfo["tgid"]       = process->tgid;
-    jsProcessInfo["tty"]        = process->tty;
-    jsProcessInfo["processor"]  = process->processor;
-    jsProcessInfo["nlwp"]       = process->nlwp;
+    return std::make_pair(commandLine, commandLineArgs);
+}
+
+struct ProcessField final
+{
+    int readFlags;
+    std::function<void(nlohmann::json&, const proc_t&)> fill;
+};
+
+// readproc flags needed by each field, /proc/<pid>/environ (PROC_FILLENV) is never needed.
+static const std::map<std::string, ProcessField> PROCESS_FIELDS
+{
+    {"pid",        {0,                                [](nlohmann::json & js, const proc_t& p) { js["pid"]        = std::to_string(p.tid); }}},
+    {"name",       {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["name"]       = p.cmd; }}},
+    {"state",      {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["state"]      = &p.state; }}},
+    {"ppid",       {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["ppid"]       = p.ppid; }}},
+    {"utime",      {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["utime"]      = p.utime; }}},
+    {"stime",      {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["stime"]      = p.stime; }}},
+    {"cmd",        {PROC_FILLARG | PROC_FILLCOM,      [](nlohmann::json & js, const proc_t& p) { js["cmd"]        = getCommandLine(p).first; }}},
+    {"argvs",      {PROC_FILLARG | PROC_FILLCOM,      [](nlohmann::json & js, const proc_t& p) { js["argvs"]      = getCommandLine(p).second; }}},
+    {"euser",      {PROC_FILLSTATUS | PROC_FILLUSR,   [](nlohmann::json & js, const proc_t& p) { js["euser"]      = p.euser; }}},
+    {"ruser",      {PROC_FILLSTATUS | PROC_FILLUSR,   [](nlohmann::json & js, const proc_t& p) { js["ruser"]      = p.ruser; }}},
+    {"suser",      {PROC_FILLSTATUS | PROC_FILLUSR,   [](nlohmann::json & js, const proc_t& p) { js["suser"]      = p.suser; }}},
+    {"egroup",     {PROC_FILLSTATUS | PROC_FILLGRP,   [](nlohmann::json & js, const proc_t& p) { js["egroup"]     = p.egroup; }}},
+    {"rgroup",     {PROC_FILLSTATUS | PROC_FILLGRP,   [](nlohmann::json & js, const proc_t& p) { js["rgroup"]     = p.rgroup; }}},
+    {"sgroup",     {PROC_FILLSTATUS | PROC_FILLGRP,   [](nlohmann::json & js, const proc_t& p) { js["sgroup"]     = p.sgroup; }}},
+    {"fgroup",     {PROC_FILLSTATUS | PROC_FILLGRP,   [](nlohmann::json & js, const proc_t& p) { js["fgroup"]     = p.fgroup; }}},
+    {"priority",   {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["priority"]   = p.priority; }}},
+    {"nice",       {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["nice"]       = p.nice; }}},
+    {"size",       {PROC_FILLMEM,                     [](nlohmann::json & js, const proc_t& p) { js["size"]       = p.size; }}},
+    {"vm_size",    {PROC_FILLSTATUS,                  [](nlohmann::json & js, const proc_t& p) { js["vm_size"]    = p.vm_size; }}},
+    {"resident",   {PROC_FILLSTATUS,                  [](nlohmann::json & js, const proc_t& p) { js["resident"]   = p.vm_rss; }}},
+    {"share",      {PROC_FILLMEM,                     [](nlohmann::json & js, const proc_t& p) { js["share"]      = p.share; }}},
+    {"start_time", {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["start_time"] = Utils::timeTick2unixTime(p.start_time); }}},
+    {"pgrp",       {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["pgrp"]       = p.pgrp; }}},
+    {"session",    {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["session"]    = p.session; }}},
+    {"tgid",       {PROC_FILLSTATUS,                  [](nlohmann::json & js, const proc_t& p) { js["tgid"]       = p.tgid; }}},
+    {"tty",        {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["tty"]        = p.tty; }}},
+    {"processor",  {PROC_FILLSTAT,                    [](nlohmann::json & js, const proc_t& p) { js["processor"]  = p.processor; }}},
+    {"nlwp",       {PROC_FILLSTAT | PROC_FILLSTATUS,  [](nlohmann::json & js, const proc_t& p) { js["nlwp"]       = p.nlwp; }}},
+};
+
+static std::vector<const ProcessField*> getProcessFields(const std::set<std::string>& fields, int& readFlags)
+{
+    std::vector<const ProcessField*> ret;
+    readFlags = 0;
+
+    for (const auto& field : PROCESS_FIELDS)
+    {
+        if (fields.empty() || fields.count(field.first))
+        {
+            readFlags |= field.second.readFlags;
+            ret.push_back(&field.second);
+        }
+    }
+
+    return ret;
+}
+
+static nlohmann::json getProcessInfo(const SysInfoProcess& process, const std::vector<const ProcessField*>& fields)
+{
+    nlohmann::json jsProcessInfo{};
+
+    // Current process information
+    for (const auto& field : fields)
+    {
+        field->fill(jsProcessInfo, *process);
+    }
+
     return jsProcessInfo;
 }
 
+// Start time, in clock ticks since boot, of the process (22nd field of /proc/<pid>/stat). 0 if it can't be read.
+static uint64_t getProcessStartTime(const std::string& pid)
+{
+    uint64_t startTime {};
+    std::ifstream file { WM_SYS_PROC_DIR + pid + "/stat" };
+    std::string line;
+
+    if (std::getline(file, line))
+    {
+        // The command name (2nd field) may contain spaces, so fields are counted from its closing parenthesis.
+        const auto pos { line.rfind(')') };
+
+        if (std::string::npos != pos)
+        {
+            std::istringstream fields { line.substr(pos + 1) };
+            std::string field;
+            auto index { 3 };
+
+            while (index < 22 && fields >> field)
+            {
+                ++index;
+            }
+
+            fields >> startTime;
+        }
+    }
+
+    return startTime;
+}
+
 static std::string getSerialNumber()
 {
     std::string serial;
@@ -280,6 +357,26 @@ nlohmann::json SysInfo::getHardware() const
     return hardware;
 }
 
+nlohmann::json SysInfo::getMemoryInfo() const
+{
+    nlohmann::json memory;
+    getMemory(memory);
+    return memory;
+}
+
+std::string SysInfo::getBootId() const
+{
+    std::string bootId;
+    std::ifstream file { WM_SYS_BOOT_ID_FILE };
+
+    if (file.is_open())
+    {
+        std::getline(file, bootId);
+    }
+
+    return bootId;
+}
+
 nlohmann::json SysInfo::getPackages() const
 {
     nlohmann::json packages;
@@ -388,7 +485,15 @@ nlohmann::json SysInfo::getProcessesInfo() const
 nlohmann::json SysInfo::getNetworks() const
 {
     nlohmann::json networks;
+    getNetworks([&networks](nlohmann::json & ifaddr)
+    {
+        networks["iface"].push_back(std::move(ifaddr));
+    });
+    return networks;
+}
 
+static void getIfAddrsNetworks(const std::function<void(nlohmann::json&)>& callback)
+{
     std::unique_ptr<ifaddrs, Utils::IfAddressSmartDeleter> interfacesAddress;
     std::map<std::string, std::vector<ifaddrs*>> networkInterfaces;
     Utils::NetworkUnixHelper::getNetworks(interfacesAddress, networkInterfaces);
@@ -407,14 +512,51 @@ nlohmann::json SysInfo::getNetworks() const
             }
         }
 
-        networks["iface"].push_back(ifaddr);
+        callback(ifaddr);
     }
+}
 
-    return networks;
+void SysInfo::getNetworks(std::function<void(nlohmann::json&)> callback) const
+{
+    NetlinkInterfaces interfaces;
+
+    // The links, addresses and routes come in three rtnetlink dumps, getifaddrs and the sysfs and
+    // /proc files of each interface are only read when the dumps aren't available.
+    try
+    {
+        interfaces = getNetlinkInterfaces();
+    }
+    catch (const std::exception&)
+    {
+        getIfAddrsNetworks(callback);
+        return;
+    }
+
+    const auto debianConfig { Utils::getFileContent(WM_SYS_IF_FILE) };
+
+    for (const auto& interface : interfaces)
+    {
+        nlohmann::json ifaddr {};
+
+        for (const auto& address : interface.second.addresses)
+        {
+            const auto networkInterfacePtr
+            {
+                FactoryNetworkFamilyCreator<OSPlatformType::LINUX>::create(std::make_shared<NetworkLinuxNetlinkInterface>(interface.second.link, address, debianConfig))
+            };
+
+            if (networkInterfacePtr)
+            {
+                networkInterfacePtr->buildNetworkData(ifaddr);
+            }
+        }
+
+        callback(ifaddr);
+    }
 }
 
 
-ProcessInfo portProcessInfo(const std::string& procPath, const std::deque<int64_t>& inodes)
+ProcessInfo portProcessInfo(const std::string& procPath)
 {
     ProcessInfo ret;
     auto getProcessName = [](const std::string & filePath) -> std::string
@@ -434,39 +576,45 @@ ProcessInfo portProcessInfo(const std::string& procPath, const std::deque<int64_
         return processInfo;
     };
 
+    // Returns the inode of a socket descriptor, or -1 for any other kind of descriptor.
     auto findInode = [](const std::string & filePath) -> int64_t
     {
         constexpr size_t MAX_LENGTH {256};
+        constexpr auto SOCKET_PREFIX {"socket:["};
         char buffer[MAX_LENGTH];
+        int64_t inode { -1 };
+
+        const auto length { readlink(filePath.c_str(), buffer, MAX_LENGTH - 1) };
 
-        if (-1 == readlink(filePath.c_str(), buffer, MAX_LENGTH))
+        if (-1 != length)
         {
-            throw std::system_error(errno, std::system_category(), "readlink");
-        }
+            // ret format is "socket:[<num>]".
+            buffer[length] = '\0';
 
-        // ret format is "socket:[<num>]".
-        const std::string bufferStr {buffer};
-        const auto openBracketPos {bufferStr.find("[")};
-        const auto closeBracketPos {bufferStr.find("]")};
-        const auto match {bufferStr.substr(openBracketPos + 1, closeBracketPos - openBracketPos - 1)};
+            if (Utils::startsWith(buffer, SOCKET_PREFIX))
+            {
+                inode = std::strtoll(buffer + strlen(SOCKET_PREFIX), nullptr, 10);
+            }
+        }
 
-        return std::stoll(match);
+        return inode;
     };
 
     if (Utils::existsDir(procPath))
     {
         std::vector<std::string> procFiles = Utils::enumerateDir(procPath);
 
-        // Iterate proc directory.
+        // Iterate proc directory, a single pass resolves the owner of every socket.
         for (const auto& procFile : procFiles)
         {
             // Only directories that represent a PID are inspected.
             const std::string procFilePath {procPath + "/" + procFile};
 
-            if (Utils::isNumber(procFile) && Utils::existsDir(procFilePath))
+            if (Utils::isNumber(procFile))
             {
                 // Only fd directory is inspected.
                 const std::string pidFilePath {procFilePath + "/fd"};
+                std::string processName;
 
                 if (Utils::existsDir(pidFilePath))
                 {
@@ -475,22 +623,20 @@ ProcessInfo portProcessInfo(const std::string& procPath, const std::deque<int64_
                     // Iterate fd directory.
                     for (const auto& fdFile : fdFiles)
                     {
-                        // Only sysmlinks that represent a socket are read.
-                        const std::string fdFilePath {pidFilePath + "/" + fdFile};
-
-                        if (!Utils::startsWith(fdFile, ".") && Utils::existsSocket(fdFilePath))
+                        if (!Utils::startsWith(fdFile, "."))
                         {
                             try
                             {
-                                int64_t inode {findInode(fdFilePath)};
+                                const auto inode {findInode(pidFilePath + "/" + fdFile)};
 
-                                if (std::any_of(inodes.cbegin(), inodes.cend(), [&](const auto it)
-                            {
-                                return it == inode;
-                            }))
+                                if (-1 != inode)
                                 {
-                                    std::string statPath {procFilePath + "/" + "stat"};
-                                    std::string processName = getProcessName(statPath);
+                                    // The stat file is only read once per process.
+                                    if (processName.empty())
+                                    {
+                                        processName = getProcessName(procFilePath + "/" + "stat");
+                                    }
+
                                     int32_t pid { std::stoi(procFile) };
 
                                     ret.emplace(std::make_pair(inode, std::make_pair(pid, processName)));
@@ -510,76 +656,129 @@ ProcessInfo portProcessInfo(const std::string& procPath, const std::deque<int64_
     return ret;
 }
 
-nlohmann::json SysInfo::getPorts() const
+static void getProcNetPorts(const PortType type, const std::string& fileName, const std::function<void(nlohmann::json&)>& callback)
 {
-    nlohmann::json ports;
-    std::deque<int64_t> inodes;
+    const auto fileContent { Utils::getFileContent(WM_SYS_NET_DIR + fileName) };
+    const auto rows { Utils::split(fileContent, '\n') };
+    auto fileBody { false };
 
-    for (const auto& portType : PORTS_TYPE)
+    for (auto row : rows)
     {
-        const auto fileContent { Utils::getFileContent(WM_SYS_NET_DIR + portType.second) };
-        const auto rows { Utils::split(fileContent, '\n') };
-        auto fileBody { false };
+        nlohmann::json port {};
 
-        for (auto row : rows)
+        try
         {
-            nlohmann::json port {};
-
-            try
+            if (fileBody)
             {
-                if (fileBody)
-                {
-                    row = Utils::trim(row);
-                    Utils::replaceAll(row, "\t", " ");
-                    Utils::replaceAll(row, "  ", " ");
-                    std::make_unique<PortImpl>(std::make_shared<LinuxPortWrapper>(portType.first, row))->buildPortData(port);
-                    inodes.push_back(port.at("inode"));
-                    ports.push_back(port);
-                }
-
-                fileBody = true;
-            }
-            catch (const std::exception& e)
-            {
-                std::cerr << "Error while parsing port: " << e.what() << std::endl;
+                row = Utils::trim(row);
+                Utils::replaceAll(row, "\t", " ");
+                Utils::replaceAll(row, "  ", " ");
+                std::make_unique<PortImpl>(std::make_shared<LinuxPortWrapper>(type, row))->buildPortData(port);
             }
+
+            fileBody = true;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error while parsing port: " << e.what() << std::endl;
+            port.clear();
+        }
+
+        if (!port.empty())
+        {
+            callback(port);
         }
     }
+}
 
+nlohmann::json SysInfo::getPorts() const
+{
+    nlohmann::json ports;
+    getPorts(false, [&ports](nlohmann::json & port)
+    {
+        ports.push_back(std::move(port));
+    });
+    return ports;
+}
 
-    if (!inodes.empty())
+nlohmann::json SysInfo::getListeningPorts() const
+{
+    nlohmann::json ports;
+    getPorts(true, [&ports](nlohmann::json & port)
     {
-        ProcessInfo ret = portProcessInfo(WM_SYS_PROC_DIR, inodes);
+        ports.push_back(std::move(port));
+    });
+    return ports;
+}
 
-        for (auto& port : ports)
+void SysInfo::getPorts(const bool listeningOnly, std::function<void(nlohmann::json&)> callback) const
+{
+    // The socket owners are resolved first, so every port can be reported as soon as it is read.
+    const auto owners { portProcessInfo(WM_SYS_PROC_DIR) };
+    const std::function<void(nlohmann::json&)> reportPort
+    {
+        [&owners, &callback](nlohmann::json & port)
         {
-            try
+            const auto it { owners.find(port.at("inode").get<int64_t>()) };
+
+            if (owners.end() != it)
             {
-                auto portInode = port.at("inode");
+                port["pid"] = it->second.first;
+                port["process"] = it->second.second;
+            }
 
-                if (ret.find(portInode) != ret.end())
-                {
-                    std::pair<int32_t, std::string> processInfoPair = ret.at(portInode);
-                    port["pid"] = processInfoPair.first;
-                    port["process"] = processInfoPair.second;
-                }
+            callback(port);
+        }
+    };
+
+    for (const auto& portType : PORTS_TYPE)
+    {
+        const auto states
+        {
+            listeningOnly && TCP == PROTOCOL_TYPE.at(portType.first) ? INET_DIAG_LISTENING_STATES : INET_DIAG_ALL_STATES
+        };
+        size_t count { 0 };
+
+        // The kernel filters by state and hands out binary records, /proc/net is only parsed when the
+        // sock_diag dump isn't available for this family and protocol.
+        const auto dumped
+        {
+            inetDiagDump(portType.first, states, [&portType, &reportPort, &count](const inet_diag_msg & message)
+            {
+                nlohmann::json port {};
+                std::make_unique<PortImpl>(std::make_shared<LinuxPortDiagWrapper>(portType.first, message))->buildPortData(port);
+                ++count;
+                reportPort(port);
+            })
+        };
+
+        if (!dumped)
+        {
+            if (0 == count)
+            {
+                getProcNetPorts(portType.first, portType.second, reportPort);
             }
-            catch (const std::exception& e)
+            else
             {
-                std::cerr << "Error while parsing pid and process from ports: " << e.what() << std::endl;
+                std::cerr << "Error while dumping " << portType.second << " sockets, the list may be incomplete" << std::endl;
             }
         }
     }
-
-    return ports;
 }
 
 void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)> callback) const
 {
+    getProcessesInfo({}, callback);
+}
+
+void SysInfo::getProcessesInfo(const std::set<std::string>& fields, std::function<void(nlohmann::json&)> callback) const
+{
+    int readFlags {};
+    const auto processFields { getProcessFields(fields, readFlags) };
 
     const SysInfoProcessesTable spProcTable
     {
-        openproc(PROC_FILLMEM | PROC_FILLSTAT | PROC_FILLSTATUS | PROC_FILLARG | PROC_FILLGRP | PROC_FILLUSR | PROC_FILLCOM | PROC_FILLENV)
+        openproc(readFlags)
     };
 
     SysInfoProcess spProcInfo { readproc(spProcTable.get(), nullptr) };
@@ -587,21 +786,125 @@ void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)> callback) co
     while (nullptr != spProcInfo)
     {
         // Get process information object and push it to the caller
-        auto processInfo = getProcessInfo(spProcInfo);
+        auto processInfo = getProcessInfo(spProcInfo, processFields);
         callback(processInfo);
         spProcInfo.reset(readproc(spProcTable.get(), nullptr));
     }
 }
 
+void SysInfo::getProcessesInfo(const std::set<std::string>& fields,
+                               std::function<void(nlohmann::json&)> changedCallback,
+                               std::function<void(const nlohmann::json&)> unchangedCallback) const
+{
+    int readFlags {};
+    const auto processFields { getProcessFields(fields, readFlags) };
+    std::lock_guard<std::mutex> lock { m_processesCacheMutex };
+
+    // The information cached for other fields can't be reported as unchanged.
+    if (fields != m_processesCacheFields)
+    {
+        m_processesCache.clear();
+        m_processesCacheFields = fields;
+    }
+
+    std::map<int64_t, ProcessIdentity> currentProcesses;
+    // Processes to be read again, with the modification time of their /proc/<pid> directory.
+    std::map<int64_t, int64_t> changedProcesses;
+
+    for (const auto& entry : Utils::enumerateDir(WM_SYS_PROC_DIR))
+    {
+        struct stat procStat {};
+
+        if (!entry.empty() &&
+                std::all_of(entry.begin(), entry.end(), ::isdigit) &&
+                0 == stat((WM_SYS_PROC_DIR + entry).c_str(), &procStat))
+        {
+            const auto pid { std::stoll(entry) };
+            const auto statTime { static_cast<int64_t>(procStat.st_mtim.tv_sec) * 1000000000ll + procStat.st_mtim.tv_nsec };
+            const auto itCached { m_processesCache.find(pid) };
+
+            // The directory time is set when the process shows up, a different one with the same start time
+            // only means the kernel dropped and rebuilt its /proc entry.
+            if (m_processesCache.end() != itCached &&
+                    itCached->second.statTime != statTime &&
+                    itCached->second.startTime == getProcessStartTime(entry))
+            {
+                itCached->second.statTime = statTime;
+            }
+
+            if (m_processesCache.end() != itCached && itCached->second.statTime == statTime)
+            {
+                unchangedCallback(itCached->second.data);
+                currentProcesses.emplace(pid, std::move(itCached->second));
+            }
+            else
+            {
+                changedProcesses.emplace(pid, statTime);
+            }
+        }
+    }
+
+    if (!changedProcesses.empty())
+    {
+        std::vector<pid_t> pids;
+        pids.reserve(changedProcesses.size() + 1);
+
+        for (const auto& process : changedProcesses)
+        {
+            pids.push_back(static_cast<pid_t>(process.first));
+        }
+
+        // The list is zero terminated.
+        pids.push_back(0);
+
+        const SysInfoProcessesTable spProcTable
+        {
+            openproc(readFlags | PROC_FILLSTAT | PROC_PID, pids.data())
+        };
+
+        SysInfoProcess spProcInfo { readproc(spProcTable.get(), nullptr) };
+
+        while (nullptr != spProcInfo)
+        {
+            auto processInfo = getProcessInfo(spProcInfo, processFields);
+            const auto itChanged { changedProcesses.find(spProcInfo->tid) };
+
+            if (changedProcesses.end() != itChanged)
+            {
+                currentProcesses[itChanged->first] = ProcessIdentity{ spProcInfo->start_time, itChanged->second, processInfo };
+            }
+
+            changedCallback(processInfo);
+            spProcInfo.reset(readproc(spProcTable.get(), nullptr));
+        }
+    }
+
+    // Processes gone since the previous scan are dropped from the cache.
+    m_processesCache = std::move(currentProcesses);
+}
+
+static const std::map<std::string, std::set<std::string>> PACKAGES_SEARCH_PATHS
+{
+    {"PYPI", UNIX_PYPI_DEFAULT_BASE_DIRS},
+    {"NPM", UNIX_NPM_DEFAULT_BASE_DIRS}
+};
+
 void SysInfo::getPackages(std::function<void(nlohmann::json&)> callback) const
 {
-    FactoryPackagesCreator<LINUX_TYPE>::getPackages(callback);
-    std::map<std::string, std::set<std::string>> searchPaths =
+    auto sources { ModernFactoryPackagesCreator<HAS_STDFILESYSTEM>::getSources(PACKAGES_SEARCH_PATHS) };
+    sources.insert(sources.begin(), [](PackagesCallback sourceCallback)
     {
-        {"PYPI", UNIX_PYPI_DEFAULT_BASE_DIRS},
-        {"NPM", UNIX_NPM_DEFAULT_BASE_DIRS}
-    };
-    ModernFactoryPackagesCreator<HAS_STDFILESYSTEM>::getPackages(searchPaths, callback);
+        FactoryPackagesCreator<LINUX_TYPE>::getPackages(sourceCallback);
+    });
+    // The OS database and the language package walks are independent and mostly wait on I/O.
+    PackagesEnumerator::getPackages(sources, callback, std::thread::hardware_concurrency());
+}
+
+nlohmann::json SysInfo::getPackagesFingerprint() const
+{
+    auto ret = FactoryPackagesCreator<LINUX_TYPE>::getFingerprint();
+    ret.update(ModernFactoryPackagesCreator<HAS_STDFILESYSTEM>::getFingerprint(PACKAGES_SEARCH_PATHS));
+    return ret;
 }
 
 nlohmann::json SysInfo::getHotfixes() const
@@ -609,3 +912,8 @@ nlohmann::json SysInfo::getHotfixes() const
     // Currently not supported for this OS.
     return nlohmann::json();
 }
+
+void SysInfo::getHotfixes(std::function<void(nlohmann::json&)> /*callback*/) const
+{
+    // Currently not supported for this OS.
+}
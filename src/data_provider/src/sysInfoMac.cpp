@@ -101,6 +101,22 @@ nlohmann::json SysInfo::getHardware() const
     return hardware;
 }
 
+nlohmann::json SysInfo::getMemoryInfo() const
+{
+    nlohmann::json memory;
+    const OSHardwareWrapperMac<OsPrimitivesMac> wrapper;
+    memory["ram_total"] = wrapper.ramTotal();
+    memory["ram_free"] = wrapper.ramFree();
+    memory["ram_usage"] = wrapper.ramUsage();
+    return memory;
+}
+
+std::string SysInfo::getBootId() const
+{
+    // Currently not supported for this OS.
+    return std::string();
+}
+
 static void getPackagesFromPath(const std::string& pkgDirectory, const int pkgType, std::function<void(nlohmann::json&)> callback)
 {
     if (MACPORTS == pkgType)
@@ -383,6 +399,23 @@ nlohmann::json SysInfo::getPorts() const
     return ports;
 }
 
+nlohmann::json SysInfo::getListeningPorts() const
+{
+    // Sockets can't be filtered by state at the source on this OS.
+    return getPorts();
+}
+
+void SysInfo::getPorts(const bool /*listeningOnly*/, std::function<void(nlohmann::json&)> callback) const
+{
+    // The ports are gathered all at once on this OS.
+    auto ports = getPorts();
+
+    for (auto& port : ports)
+    {
+        callback(port);
+    }
+}
+
 void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)> callback) const
 {
     int32_t maxProc{};
@@ -419,6 +452,18 @@ void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)> callback) co
     }
 }
 
+void SysInfo::getProcessesInfo(const std::set<std::string>& /*fields*/, std::function<void(nlohmann::json&)> callback) const
+{
+    getProcessesInfo(callback);
+}
+
+void SysInfo::getProcessesInfo(const std::set<std::string>& fields,
+                               std::function<void(nlohmann::json&)> changedCallback,
+                               std::function<void(const nlohmann::json&)> /*unchangedCallback*/) const
+{
+    getProcessesInfo(fields, changedCallback);
+}
+
 void SysInfo::getPackages(std::function<void(nlohmann::json&)> callback) const
 {
     for (const auto& packageDirectory : s_mapPackagesDirectories)
@@ -439,8 +484,19 @@ void SysInfo::getPackages(std::function<void(nlohmann::json&)> callback) const
     ModernFactoryPackagesCreator<HAS_STDFILESYSTEM>::getPackages(searchPaths, callback);
 }
 
+nlohmann::json SysInfo::getPackagesFingerprint() const
+{
+    // Currently not supported for this OS.
+    return nlohmann::json();
+}
+
 nlohmann::json SysInfo::getHotfixes() const
 {
     // Currently not supported for this OS.
     return nlohmann::json();
 }
+
+void SysInfo::getHotfixes(std::function<void(nlohmann::json&)> /*callback*/) const
+{
+    // Currently not supported for this OS.
+}
@@ -175,6 +175,19 @@ nlohmann::json SysInfo::getHardware() const
     return hardware;
 }
 
+nlohmann::json SysInfo::getMemoryInfo() const
+{
+    nlohmann::json memory;
+    getMemory(memory);
+    return memory;
+}
+
+std::string SysInfo::getBootId() const
+{
+    // Currently not supported for this OS.
+    return std::string();
+}
+
 nlohmann::json SysInfo::getProcessesInfo() const
 {
     // Currently not supported for this OS
@@ -218,18 +231,58 @@ nlohmann::json SysInfo::getPorts() const
     return nlohmann::json {};
 }
 
+nlohmann::json SysInfo::getListeningPorts() const
+{
+    // Sockets can't be filtered by state at the source on this OS.
+    return getPorts();
+}
+
+void SysInfo::getPorts(const bool /*listeningOnly*/, std::function<void(nlohmann::json&)> callback) const
+{
+    // The ports are gathered all at once on this OS.
+    auto ports = getPorts();
+
+    for (auto& port : ports)
+    {
+        callback(port);
+    }
+}
+
 void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)> /*callback*/) const
 {
     // Currently not supported for this OS.
 }
 
+void SysInfo::getProcessesInfo(const std::set<std::string>& /*fields*/, std::function<void(nlohmann::json&)> /*callback*/) const
+{
+    // Currently not supported for this OS.
+}
+
+void SysInfo::getProcessesInfo(const std::set<std::string>& /*fields*/,
+                               std::function<void(nlohmann::json&)> /*changedCallback*/,
+                               std::function<void(const nlohmann::json&)> /*unchangedCallback*/) const
+{
+    // Currently not supported for this OS.
+}
+
 void SysInfo::getPackages(std::function<void(nlohmann::json&)> /*callback*/) const
 {
     // Currently not supported for this OS.
 }
 
+nlohmann::json SysInfo::getPackagesFingerprint() const
+{
+    // Currently not supported for this OS.
+    return nlohmann::json();
+}
+
 nlohmann::json SysInfo::getHotfixes() const
 {
     // Currently not supported for this OS.
     return nlohmann::json();
 }
+
+void SysInfo::getHotfixes(std::function<void(nlohmann::json&)> /*callback*/) const
+{
+    // Currently not supported for this OS.
+}
@@ -80,6 +80,19 @@ nlohmann::json SysInfo::getHardware() const
     return hardware;
 }
 
+nlohmann::json SysInfo::getMemoryInfo() const
+{
+    nlohmann::json memory;
+    getMemory(memory);
+    return memory;
+}
+
+std::string SysInfo::getBootId() const
+{
+    // Currently not supported for this OS.
+    return std::string();
+}
+
 nlohmann::json SysInfo::getPackages() const
 {
     return nlohmann::json {};
@@ -109,22 +122,73 @@ nlohmann::json SysInfo::getNetworks() const
 {
     return nlohmann::json();
 }
+void SysInfo::getNetworks(std::function<void(nlohmann::json&)> callback) const
+{
+    // The interfaces are gathered all at once on this OS.
+    auto networks = getNetworks();
+    const auto it { networks.find("iface") };
+
+    if (networks.end() != it)
+    {
+        for (auto& iface : it.value())
+        {
+            callback(iface);
+        }
+    }
+}
 nlohmann::json SysInfo::getPorts() const
 {
     return nlohmann::json();
 }
+nlohmann::json SysInfo::getListeningPorts() const
+{
+    return getPorts();
+}
+void SysInfo::getPorts(const bool /*listeningOnly*/, std::function<void(nlohmann::json&)> callback) const
+{
+    // The ports are gathered all at once on this OS.
+    auto ports = getPorts();
+
+    for (auto& port : ports)
+    {
+        callback(port);
+    }
+}
 void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)> /*callback*/) const
 {
     // TODO
 }
 
+void SysInfo::getProcessesInfo(const std::set<std::string>& /*fields*/, std::function<void(nlohmann::json&)> /*callback*/) const
+{
+    // TODO
+}
+
+void SysInfo::getProcessesInfo(const std::set<std::string>& /*fields*/,
+                               std::function<void(nlohmann::json&)> /*changedCallback*/,
+                               std::function<void(const nlohmann::json&)> /*unchangedCallback*/) const
+{
+    // TODO
+}
+
 void SysInfo::getPackages(std::function<void(nlohmann::json&)> /*callback*/) const
 {
     // TODO
 }
 
+nlohmann::json SysInfo::getPackagesFingerprint() const
+{
+    // TODO
+    return nlohmann::json();
+}
+
 nlohmann::json SysInfo::getHotfixes() const
 {
     // Currently not supported for this OS.
     return nlohmann::json();
 }
+
+void SysInfo::getHotfixes(std::function<void(nlohmann::json&)> /*callback*/) const
+{
+    // Currently not supported for this OS.
+}
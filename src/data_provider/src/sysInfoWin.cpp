@@ -19,6 +19,8 @@
 #include <list>
 #include <set>
 #include <system_error>
+#include <atomic>
+#include <thread>
 #include <winternl.h>
 #include <ntstatus.h>
 #include <netioapi.h>
@@ -38,9 +40,11 @@
 #include "packages/packagesWindowsParserHelper.h"
 #include "packages/packagesWindows.h"
 #include "packages/appxWindowsWrapper.h"
+#include "packages/registryPackagesSnapshot.hpp"
 #include "packages/packagesPYPI.hpp"
 #include "packages/packagesNPM.hpp"
 #include "packages/modernPackageDataRetriever.hpp"
+#include "processes/processTraceWindows.h"
 
 constexpr auto CENTRAL_PROCESSOR_REGISTRY {"HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0"};
 const std::string UNINSTALL_REGISTRY{"SOFTWARE\\Microsoft\\Windows\\CurrentVersion\\Uninstall"};
@@ -354,99 +358,117 @@ static nlohmann::json getProcessInfo(const PROCESSENTRY32& processEntry)
     return jsProcessInfo;
 }
 
-static void getPackagesFromReg(const HKEY key, const std::string& subKey, std::function<void(nlohmann::json&)> returnCallback, const REGSAM access = 0)
+// Packages of the previous complete scan, by registry key.
+static RegistryPackagesSnapshot gs_packagesSnapshot;
+
+static nlohmann::json getPackageFromReg(const HKEY key, const std::string& subKey, const REGSAM access)
 {
-    try
+    std::string value;
+    nlohmann::json packageJson;
+    Utils::Registry packageReg{key, subKey, access | KEY_READ};
+
+    std::string name;
+    std::string version;
+    std::string vendor;
+    std::string install_time;
+    std::string location;
+    std::string architecture;
+
+    if (packageReg.string("DisplayName", value))
     {
-        const auto callback
+        name = value;
+    }
+
+    if (packageReg.string("DisplayVersion", value))
+    {
+        version = value;
+    }
+
+    if (packageReg.string("Publisher", value))
+    {
+        vendor = value;
+    }
+
+    if (packageReg.string("InstallDate", value))
+    {
+        try
         {
-            [&](const std::string & package)
-            {
-                std::string value;
-                nlohmann::json packageJson;
-                Utils::Registry packageReg{key, subKey + "\\" + package, access | KEY_READ};
-
-                std::string name;
-                std::string version;
-                std::string vendor;
-                std::string install_time;
-                std::string location;
-                std::string architecture;
-
-                if (packageReg.string("DisplayName", value))
-                {
-                    name = value;
-                }
+            install_time = Utils::normalizeTimestamp(value, packageReg.keyModificationDate());
+        }
+        catch (const std::exception& e)
+        {
+            install_time = packageReg.keyModificationDate();
+        }
+    }
+    else
+    {
+        install_time = packageReg.keyModificationDate();
+    }
 
-                if (packageReg.string("DisplayVersion", value))
-                {
-                    version = value;
-                }
+    if (packageReg.string("InstallLocation", value))
+    {
+        location = value;
+    }
+    else
+    {
+        location = UNKNOWN_VALUE;
+    }
 
-                if (packageReg.string("Publisher", value))
-                {
-                    vendor = value;
-                }
+    if (!name.empty())
+    {
+        if (access & KEY_WOW64_32KEY)
+        {
+            architecture = "i686";
+        }
+        else if (access & KEY_WOW64_64KEY)
+        {
+            architecture = "x86_64";
+        }
+        else
+        {
+            architecture = UNKNOWN_VALUE;
+        }
 
-                if (packageReg.string("InstallDate", value))
-                {
-                    try
-                    {
-                        install_time = Utils::normalizeTimestamp(value, packageReg.keyModificationDate());
-                    }
-                    catch (const std::exception& e)
-                    {
-                        install_time = packageReg.keyModificationDate();
-                    }
-                }
-                else
-                {
-                    install_time = packageReg.keyModificationDate();
-                }
+        packageJson["name"]         = std::move(name);
+        packageJson["description"]  = UNKNOWN_VALUE;
+        packageJson["version"]      = version.empty() ? UNKNOWN_VALUE : std::move(version);
+        packageJson["groups"]       = UNKNOWN_VALUE;
+        packageJson["priority"]       = UNKNOWN_VALUE;
+        packageJson["size"]           = 0;
+        packageJson["vendor"]       = vendor.empty() ? UNKNOWN_VALUE : std::move(vendor);
+        packageJson["source"]       = UNKNOWN_VALUE;
+        packageJson["install_time"] = install_time.empty() ? UNKNOWN_VALUE : std::move(install_time);
+        packageJson["location"]     = location.empty() ? UNKNOWN_VALUE : std::move(location);
+        packageJson["architecture"] = std::move(architecture);
+        packageJson["format"]       = "win";
+    }
 
-                if (packageReg.string("InstallLocation", value))
-                {
-                    location = value;
-                }
-                else
-                {
-                    location = UNKNOWN_VALUE;
-                }
+    return packageJson;
+}
 
-                if (!name.empty())
+static void getPackagesFromReg(const HKEY key, const std::string& subKey, std::function<void(nlohmann::json&)> returnCallback, const REGSAM access = 0)
+{
+    try
+    {
+        // The 32 and 64 bit views share the same paths.
+        const auto snapshotPrefix { std::to_string(reinterpret_cast<uintptr_t>(key)) + ":" + std::to_string(access) + ":" + subKey + "\\" };
+        const auto callback
+        {
+            [&](const std::string & package, const uint64_t lastWriteTime)
+            {
+                auto packageJson = gs_packagesSnapshot.get(snapshotPrefix + package, lastWriteTime, [&]()
                 {
-                    if (access & KEY_WOW64_32KEY)
-                    {
-                        architecture = "i686";
-                    }
-                    else if (access & KEY_WOW64_64KEY)
-                    {
-                        architecture = "x86_64";
-                    }
-                    else
-                    {
-                        architecture = UNKNOWN_VALUE;
-                    }
-
-                    packageJson["name"]         = std::move(name);
-                    packageJson["description"]  = UNKNOWN_VALUE;
-                    packageJson["version"]      = version.empty() ? UNKNOWN_VALUE : std::move(version);
-                    packageJson["groups"]       = UNKNOWN_VALUE;
-                    packageJson["priority"]       = UNKNOWN_VALUE;
-                    packageJson["size"]           = 0;
-                    packageJson["vendor"]       = vendor.empty() ? UNKNOWN_VALUE : std::move(vendor);
-                    packageJson["source"]       = UNKNOWN_VALUE;
-                    packageJson["install_time"] = install_time.empty() ? UNKNOWN_VALUE : std::move(install_time);
-                    packageJson["location"]     = location.empty() ? UNKNOWN_VALUE : std::move(location);
-                    packageJson["architecture"] = std::move(architecture);
-                    packageJson["format"]       = "win";
+                    return getPackageFromReg(key, subKey + "\\" + package, access);
+                });
 
+                if (!packageJson.is_null())
+                {
                     returnCallback(packageJson);
                 }
             }
         };
         Utils::Registry root{key, subKey, access | KEY_ENUMERATE_SUB_KEYS | KEY_READ};
-        root.enumerate(callback);
+        root.enumerateWithLastWriteTime(callback);
     }
     catch (...)
     {
@@ -464,24 +486,31 @@ static void getStorePackages(const HKEY key, const std::string& user, std::funct
             cacheReg.insert(registry);
         }
 
+        // Appx package keys are named after the package full name, which includes its version.
+        const auto snapshotPrefix { std::to_string(reinterpret_cast<uintptr_t>(key)) + ":" + user + "\\" + APPLICATION_STORE_REGISTRY + "\\" };
         const auto callback
         {
-            [&](const std::string & nameApp)
+            [&](const std::string & nameApp, const uint64_t lastWriteTime)
             {
-                nlohmann::json jsPackage;
+                auto jsPackage = gs_packagesSnapshot.get(snapshotPrefix + nameApp, lastWriteTime, [&]()
+                {
+                    nlohmann::json package;
 
-                FactoryWindowsPackage::create(key, user, nameApp, cacheReg)->buildPackageData(jsPackage);
+                    FactoryWindowsPackage::create(key, user, nameApp, cacheReg)->buildPackageData(package);
 
-                if (!jsPackage.at("name").get_ref<const std::string&>().empty())
-                {
                     // Only return valid content packages
+                    return package.at("name").get_ref<const std::string&>().empty() ? nlohmann::json() : package;
+                });
+
+                if (!jsPackage.is_null())
+                {
                     returnCallback(jsPackage);
                 }
             }
         };
 
         Utils::Registry root(key, user + "\\" + APPLICATION_STORE_REGISTRY, KEY_READ | KEY_ENUMERATE_SUB_KEYS);
-        root.enumerate(callback);
+        root.enumerateWithLastWriteTime(callback);
     }
     catch (...)
     {
@@ -587,6 +616,19 @@ nlohmann::json SysInfo::getHardware() const
     return hardware;
 }
 
+nlohmann::json SysInfo::getMemoryInfo() const
+{
+    nlohmann::json memory;
+    getMemory(memory);
+    return memory;
+}
+
+std::string SysInfo::getBootId() const
+{
+    // Currently not supported for this OS.
+    return std::string();
+}
+
 static void fillProcessesData(std::function<void(PROCESSENTRY32)> func)
 {
     PROCESSENTRY32 processEntry{};
@@ -725,6 +767,21 @@ nlohmann::json SysInfo::getNetworks() const
     return networks;
 }
 
+void SysInfo::getNetworks(std::function<void(nlohmann::json&)> callback) const
+{
+    // The interfaces are gathered all at once on this OS.
+    auto networks = getNetworks();
+    const auto it { networks.find("iface") };
+
+    if (networks.end() != it)
+    {
+        for (auto& iface : it.value())
+        {
+            callback(iface);
+        }
+    }
+}
+
 template <class T, typename TableClass>
 void getTablePorts(TableClass ownerId, int32_t tcpipVersion, std::unique_ptr<T []>& tableList, std::function<DWORD(T*, DWORD*, bool, int32_t, TableClass)> GetTable)
 {
@@ -813,6 +870,23 @@ nlohmann::json SysInfo::getPorts() const
     return ports;
 }
 
+nlohmann::json SysInfo::getListeningPorts() const
+{
+    // Sockets can't be filtered by state at the source on this OS.
+    return getPorts();
+}
+
+void SysInfo::getPorts(const bool /*listeningOnly*/, std::function<void(nlohmann::json&)> callback) const
+{
+    // The ports are gathered all at once on this OS.
+    auto ports = getPorts();
+
+    for (auto& port : ports)
+    {
+        callback(port);
+    }
+}
+
 void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)> callback) const
 {
     fillProcessesData([&callback](const auto & processEntry)
@@ -826,6 +900,86 @@ void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)> callback) co
     });
 }
 
+void SysInfo::getProcessesInfo(const std::set<std::string>& /*fields*/, std::function<void(nlohmann::json&)> callback) const
+{
+    getProcessesInfo(callback);
+}
+
+static nlohmann::json getTracedProcessInfo(const TracedProcess& process)
+{
+    constexpr auto TO_SECONDS_VALUE { 10000000ULL };
+    nlohmann::json jsProcessInfo{};
+
+    // Only what the start event tells is known about a process already gone.
+    jsProcessInfo["name"]       = process.name;
+    jsProcessInfo["ppid"]       = process.ppid;
+    jsProcessInfo["pid"]        = std::to_string(process.pid);
+    jsProcessInfo["session"]    = process.session;
+    jsProcessInfo["start_time"] = process.createTime / TO_SECONDS_VALUE - WINDOWS_UNIX_EPOCH_DIFF_SECONDS;
+
+    return jsProcessInfo;
+}
+
+void SysInfo::getProcessesInfo(const std::set<std::string>& fields,
+                               std::function<void(nlohmann::json&)> changedCallback,
+                               std::function<void(const nlohmann::json&)> unchangedCallback) const
+{
+    // Traced from the first incremental scan on, before the snapshot is taken so that no start is missed.
+    static KernelProcessTrace processTrace;
+    std::lock_guard<std::mutex> lock { m_processesCacheMutex };
+
+    if (!processTrace.running())
+    {
+        m_processesCache.clear();
+        getProcessesInfo(fields, changedCallback);
+        return;
+    }
+
+    const auto changes { processTrace.takeChanges() };
+
+    if (changes.lost)
+    {
+        m_processesCache.clear();
+    }
+
+    std::map<int64_t, ProcessIdentity> currentProcesses;
+
+    fillProcessesData([&](const auto & processEntry)
+    {
+        const auto pid { static_cast<int64_t>(processEntry.th32ProcessID) };
+        const auto itCached { m_processesCache.find(pid) };
+
+        if (m_processesCache.end() != itCached && 0 == changes.started.count(processEntry.th32ProcessID))
+        {
+            unchangedCallback(itCached->second.data);
+            currentProcesses.emplace(pid, std::move(itCached->second));
+        }
+        else
+        {
+            auto processInfo = getProcessInfo(processEntry);
+
+            if (!processInfo.empty())
+            {
+                currentProcesses[pid] = ProcessIdentity{ processInfo.at("start_time").get<uint64_t>(), 0, processInfo };
+                changedCallback(processInfo);
+            }
+        }
+    });
+
+    // Processes that ran between two scans are reported once, the next scan deletes them.
+    for (const auto& process : changes.exited)
+    {
+        if (0 == currentProcesses.count(process.pid))
+        {
+            auto processInfo = getTracedProcessInfo(process);
+            changedCallback(processInfo);
+        }
+    }
+
+    // Processes gone since the previous scan are dropped from the cache.
+    m_processesCache = std::move(currentProcesses);
+}
+
 void expandFromRegistry(const HKEY key, const std::string& subKey, const std::string& field, std::function<void(const std::string&)> postAction)
 {
     std::vector<std::string> installPaths;
@@ -897,6 +1051,52 @@ const std::set<std::string> getNodeDirectories()
     return nodeDirList;
 }
 
+/**
+ * @brief Reads the packages of every user hive, several hives at once.
+ * @details The packages are returned by hive, in the order of the users, so the packages kept when two
+ * hives hold the same one don't depend on which hive was read first.
+ */
+static std::vector<std::vector<nlohmann::json>> getUsersPackages(const std::vector<std::string>& users)
+{
+    std::vector<std::vector<nlohmann::json>> ret(users.size());
+    std::atomic<size_t> next { 0 };
+    const auto worker
+    {
+        [&]()
+        {
+            for (auto index { next++ }; index < users.size(); index = next++)
+            {
+                const auto collect
+                {
+                    [&ret, index](nlohmann::json & data)
+                    {
+                        ret[index].push_back(std::move(data));
+                    }
+                };
+
+                getPackagesFromReg(HKEY_USERS, users[index] + "\\" + UNINSTALL_REGISTRY, collect);
+                getStorePackages(HKEY_USERS, users[index], collect);
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    const auto threads { std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), users.size()) };
+
+    for (size_t i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+
+    return ret;
+}
+
 void SysInfo::getPackages(std::function<void(nlohmann::json&)> callback) const
 {
     std::set<std::string> set;
@@ -913,15 +1113,20 @@ void SysInfo::getPackages(std::function<void(nlohmann::json&)> callback) const
         }
     }};
 
+    gs_packagesSnapshot.begin();
     getPackagesFromReg(HKEY_LOCAL_MACHINE, UNINSTALL_REGISTRY, fillList, KEY_WOW64_64KEY);
     getPackagesFromReg(HKEY_LOCAL_MACHINE, UNINSTALL_REGISTRY, fillList, KEY_WOW64_32KEY);
 
-    for (const auto& user : Utils::Registry {HKEY_USERS, "", KEY_READ | KEY_ENUMERATE_SUB_KEYS}.enumerate())
+    for (auto& userPackages : getUsersPackages(Utils::Registry {HKEY_USERS, "", KEY_READ | KEY_ENUMERATE_SUB_KEYS}.enumerate()))
     {
-        getPackagesFromReg(HKEY_USERS, user + "\\" + UNINSTALL_REGISTRY, fillList);
-        getStorePackages(HKEY_USERS, user, fillList);
+        for (auto& package : userPackages)
+        {
+            fillList(package);
+        }
     }
 
+    gs_packagesSnapshot.commit();
+
     const std::map<std::string, std::set<std::string>> searchPaths =
     {
         {"PYPI", getPythonDirectories()},
@@ -930,7 +1135,23 @@ void SysInfo::getPackages(std::function<void(nlohmann::json&)> callback) const
 
     ModernFactoryPackagesCreator<HAS_STDFILESYSTEM>::getPackages(searchPaths, callback);
 }
+
+nlohmann::json SysInfo::getPackagesFingerprint() const
+{
+    // Currently not supported for this OS.
+    return nlohmann::json();
+}
 nlohmann::json SysInfo::getHotfixes() const
+{
+    nlohmann::json ret;
+    getHotfixes([&ret](nlohmann::json & hotfix)
+    {
+        ret.push_back(std::move(hotfix));
+    });
+    return ret;
+}
+
+void SysInfo::getHotfixes(std::function<void(nlohmann::json&)> callback) const
 {
     std::set<std::string> hotfixes;
     PackageWindowsHelper::getHotFixFromReg(HKEY_LOCAL_MACHINE, PackageWindowsHelper::WIN_REG_HOTFIX, hotfixes);
@@ -938,14 +1159,10 @@ nlohmann::json SysInfo::getHotfixes() const
     PackageWindowsHelper::getHotFixFromRegWOW(HKEY_LOCAL_MACHINE, PackageWindowsHelper::WIN_REG_WOW_HOTFIX, hotfixes);
     PackageWindowsHelper::getHotFixFromRegProduct(HKEY_LOCAL_MACHINE, PackageWindowsHelper::WIN_REG_PRODUCT_HOTFIX, hotfixes);
 
-    nlohmann::json ret;
-
-    for (auto& hotfix : hotfixes)
+    for (const auto& hotfix : hotfixes)
     {
         nlohmann::json hotfixValue;
-        hotfixValue["hotfix"] = std::move(hotfix);
-        ret.push_back(std::move(hotfixValue));
+        hotfixValue["hotfix"] = hotfix;
+        callback(hotfixValue);
     }
-
-    return ret;
 }
@@ -29,6 +29,21 @@ auto PACKAGES_EXPECTED
     R"([{"test":"packages"}])"_json
 };
 
+auto PORTS_EXPECTED
+{
+    R"({"test":"ports"})"_json
+};
+
+auto NETWORKS_EXPECTED
+{
+    R"({"test":"networks"})"_json
+};
+
+auto HOTFIXES_EXPECTED
+{
+    R"({"test":"hotfixes"})"_json
+};
+
 using ::testing::_;
 using ::testing::DoAll;
 using ::testing::Return;
@@ -57,6 +72,10 @@ nlohmann::json SysInfo::getPorts() const
 {
     return {};
 }
+nlohmann::json SysInfo::getListeningPorts() const
+{
+    return {};
+}
 nlohmann::json SysInfo::getHotfixes() const
 {
     return {};
@@ -67,11 +86,53 @@ void SysInfo::getPackages(std::function<void(nlohmann::json&)>callback) const
     callback(PACKAGES_EXPECTED);
 }
 
+nlohmann::json SysInfo::getPackagesFingerprint() const
+{
+    return {};
+}
+
+nlohmann::json SysInfo::getMemoryInfo() const
+{
+    return {};
+}
+
+std::string SysInfo::getBootId() const
+{
+    return {};
+}
+
 void SysInfo::getProcessesInfo(std::function<void(nlohmann::json&)>callback) const
 {
     callback(PROCESSES_EXPECTED);
 }
 
+void SysInfo::getPorts(const bool /*listeningOnly*/, std::function<void(nlohmann::json&)>callback) const
+{
+    callback(PORTS_EXPECTED);
+}
+
+void SysInfo::getNetworks(std::function<void(nlohmann::json&)>callback) const
+{
+    callback(NETWORKS_EXPECTED);
+}
+
+void SysInfo::getHotfixes(std::function<void(nlohmann::json&)>callback) const
+{
+    callback(HOTFIXES_EXPECTED);
+}
+
+void SysInfo::getProcessesInfo(const std::set<std::string>& /*fields*/, std::function<void(nlohmann::json&)>callback) const
+{
+    callback(PROCESSES_EXPECTED);
+}
+
+void SysInfo::getProcessesInfo(const std::set<std::string>& /*fields*/,
+                               std::function<void(nlohmann::json&)>changedCallback,
+                               std::function<void(const nlohmann::json&)> /*unchangedCallback*/) const
+{
+    changedCallback(PROCESSES_EXPECTED);
+}
+
 class CallbackMock
 {
     public:
@@ -101,9 +162,21 @@ class SysInfoWrapper: public SysInfo
         MOCK_METHOD(nlohmann::json, getProcessesInfo, (), (const override));
         MOCK_METHOD(nlohmann::json, getNetworks, (), (const override));
         MOCK_METHOD(nlohmann::json, getPorts, (), (const override));
+        MOCK_METHOD(nlohmann::json, getListeningPorts, (), (const override));
         MOCK_METHOD(nlohmann::json, getHotfixes, (), (const override));
         MOCK_METHOD(void, getPackages, (std::function<void(nlohmann::json&)>), (const override));
+        MOCK_METHOD(nlohmann::json, getPackagesFingerprint, (), (const override));
+        MOCK_METHOD(nlohmann::json, getMemoryInfo, (), (const override));
+        MOCK_METHOD(std::string, getBootId, (), (const override));
+        MOCK_METHOD(void, getPorts, (const bool, std::function<void(nlohmann::json&)>), (const override));
+        MOCK_METHOD(void, getNetworks, (std::function<void(nlohmann::json&)>), (const override));
+        MOCK_METHOD(void, getHotfixes, (std::function<void(nlohmann::json&)>), (const override));
         MOCK_METHOD(void, getProcessesInfo, (std::function<void(nlohmann::json&)>), (const override));
+        MOCK_METHOD(void, getProcessesInfo, ((const std::set<std::string>&), std::function<void(nlohmann::json&)>), (const override));
+        MOCK_METHOD(void,
+                    getProcessesInfo,
+                    ((const std::set<std::string>&), std::function<void(nlohmann::json&)>, std::function<void(const nlohmann::json&)>),
+                    (const override));
 
 };
 
@@ -183,6 +256,92 @@ TEST_F(SysInfoTest, processes_cb)
     info.processes(processesCallback);
 }
 
+TEST_F(SysInfoTest, processes_fields_cb)
+{
+    SysInfoWrapper info;
+    CallbackMock wrapper;
+    const std::set<std::string> fields { "pid", "name" };
+
+    auto expectedValue
+    {
+        R"({"name":"sleep","pid":"193797"})"_json
+    };
+
+    const auto processesCallback
+    {
+        [&wrapper](nlohmann::json & data)
+        {
+            wrapper.callbackMock(data);
+        }
+    };
+    EXPECT_CALL(info, getProcessesInfo(fields, _)).WillOnce(testing::InvokeArgument<1>(expectedValue));
+    EXPECT_CALL(info, getProcessesInfo(_)).Times(0);
+    EXPECT_CALL(wrapper, callbackMock(expectedValue)).Times(1);
+    info.processes(fields, processesCallback);
+}
+
+TEST_F(SysInfoTest, processes_incremental_cb)
+{
+    SysInfoWrapper info;
+    CallbackMock wrapper;
+    const std::set<std::string> fields { "pid", "name" };
+
+    auto changedValue
+    {
+        R"({"name":"sleep","pid":"193797"})"_json
+    };
+    auto unchangedValue
+    {
+        R"({"name":"bash","pid":"1"})"_json
+    };
+
+    const auto processesCallback
+    {
+        [&wrapper](nlohmann::json & data)
+        {
+            wrapper.callbackMock(data);
+        }
+    };
+    const auto unchangedCallback
+    {
+        [&wrapper](const nlohmann::json & data)
+        {
+            auto value = data;
+            wrapper.callbackMock(value);
+        }
+    };
+    EXPECT_CALL(info, getProcessesInfo(fields, _, _))
+    .WillOnce(DoAll(testing::InvokeArgument<1>(changedValue), testing::InvokeArgument<2>(unchangedValue)));
+    EXPECT_CALL(info, getProcessesInfo(fields, _)).Times(0);
+    EXPECT_CALL(wrapper, callbackMock(changedValue)).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(unchangedValue)).Times(1);
+    info.processes(fields, processesCallback, unchangedCallback);
+}
+
+TEST_F(SysInfoTest, packagesFingerprint)
+{
+    SysInfoWrapper info;
+    const auto fingerprint = R"({"dpkg":"1:2:3.4"})"_json;
+    EXPECT_CALL(info, getPackagesFingerprint()).WillOnce(Return(fingerprint));
+    EXPECT_EQ(fingerprint, info.packagesFingerprint());
+}
+
+TEST_F(SysInfoTest, memory)
+{
+    SysInfoWrapper info;
+    const auto memory = R"({"ram_free":1024,"ram_total":4096,"ram_usage":75})"_json;
+    EXPECT_CALL(info, getMemoryInfo()).WillOnce(Return(memory));
+    EXPECT_CALL(info, getHardware()).Times(0);
+    EXPECT_EQ(memory, info.memory());
+}
+
+TEST_F(SysInfoTest, bootId)
+{
+    SysInfoWrapper info;
+    EXPECT_CALL(info, getBootId()).WillOnce(Return("6a8a5a2c-3b33-4c8e-9a35-2b1f39e7c1d4"));
+    EXPECT_EQ("6a8a5a2c-3b33-4c8e-9a35-2b1f39e7c1d4", info.bootId());
+}
+
 TEST_F(SysInfoTest, processes)
 {
     SysInfoWrapper info;
@@ -207,6 +366,81 @@ TEST_F(SysInfoTest, ports)
     EXPECT_FALSE(result.empty());
 }
 
+TEST_F(SysInfoTest, listeningPorts)
+{
+    SysInfoWrapper info;
+    EXPECT_CALL(info, getListeningPorts()).WillOnce(Return("ports"));
+    EXPECT_CALL(info, getPorts()).Times(0);
+    const auto result {info.listeningPorts()};
+    EXPECT_FALSE(result.empty());
+}
+
+TEST_F(SysInfoTest, ports_cb)
+{
+    SysInfoWrapper info;
+    CallbackMock wrapper;
+    auto expectedValue
+    {
+        R"({"inode":4274126910,"local_ip":"0.0.0.0","local_port":22,"protocol":"tcp","state":"listening"})"_json
+    };
+    EXPECT_CALL(info, getPorts(false, _)).WillOnce(testing::InvokeArgument<1>(expectedValue));
+    EXPECT_CALL(info, getPorts(true, _)).Times(0);
+    EXPECT_CALL(wrapper, callbackMock(expectedValue)).Times(1);
+    info.ports([&wrapper](nlohmann::json & data)
+    {
+        wrapper.callbackMock(data);
+    });
+}
+
+TEST_F(SysInfoTest, listeningPorts_cb)
+{
+    SysInfoWrapper info;
+    CallbackMock wrapper;
+    auto expectedValue
+    {
+        R"({"inode":4274126910,"local_ip":"0.0.0.0","local_port":22,"protocol":"tcp","state":"listening"})"_json
+    };
+    EXPECT_CALL(info, getPorts(true, _)).WillOnce(testing::InvokeArgument<1>(expectedValue));
+    EXPECT_CALL(info, getPorts(false, _)).Times(0);
+    EXPECT_CALL(wrapper, callbackMock(expectedValue)).Times(1);
+    info.listeningPorts([&wrapper](nlohmann::json & data)
+    {
+        wrapper.callbackMock(data);
+    });
+}
+
+TEST_F(SysInfoTest, networks_cb)
+{
+    SysInfoWrapper info;
+    CallbackMock wrapper;
+    auto expectedValue
+    {
+        R"({"name":"eth0","adapter":" ","type":"ethernet","state":"up"})"_json
+    };
+    EXPECT_CALL(info, getNetworks(_)).WillOnce(testing::InvokeArgument<0>(expectedValue));
+    EXPECT_CALL(wrapper, callbackMock(expectedValue)).Times(1);
+    info.networks([&wrapper](nlohmann::json & data)
+    {
+        wrapper.callbackMock(data);
+    });
+}
+
+TEST_F(SysInfoTest, hotfixes_cb)
+{
+    SysInfoWrapper info;
+    CallbackMock wrapper;
+    auto expectedValue
+    {
+        R"({"hotfix":"KB4586786"})"_json
+    };
+    EXPECT_CALL(info, getHotfixes(_)).WillOnce(testing::InvokeArgument<0>(expectedValue));
+    EXPECT_CALL(wrapper, callbackMock(expectedValue)).Times(1);
+    info.hotfixes([&wrapper](nlohmann::json & data)
+    {
+        wrapper.callbackMock(data);
+    });
+}
+
 TEST_F(SysInfoTest, os)
 {
     SysInfoWrapper info;
@@ -291,6 +525,30 @@ TEST_F(SysInfoTest, ports_c_interface)
     EXPECT_NO_THROW(sysinfo_free_result(&object));
 }
 
+TEST_F(SysInfoTest, ports_cb_c_interface)
+{
+    CallbackMock wrapper;
+    callback_data_t callbackData { callback, &wrapper };
+    EXPECT_CALL(wrapper, callbackMock(GENERIC, PORTS_EXPECTED.dump())).Times(1);
+    EXPECT_EQ(0, sysinfo_ports_cb(callbackData));
+}
+
+TEST_F(SysInfoTest, networks_cb_c_interface)
+{
+    CallbackMock wrapper;
+    callback_data_t callbackData { callback, &wrapper };
+    EXPECT_CALL(wrapper, callbackMock(GENERIC, NETWORKS_EXPECTED.dump())).Times(1);
+    EXPECT_EQ(0, sysinfo_networks_cb(callbackData));
+}
+
+TEST_F(SysInfoTest, hotfixes_cb_c_interface)
+{
+    CallbackMock wrapper;
+    callback_data_t callbackData { callback, &wrapper };
+    EXPECT_CALL(wrapper, callbackMock(GENERIC, HOTFIXES_EXPECTED.dump())).Times(1);
+    EXPECT_EQ(0, sysinfo_hotfixes_cb(callbackData));
+}
+
 TEST_F(SysInfoTest, os_c_interface)
 {
     cJSON* object = NULL;
@@ -315,4 +573,8 @@ TEST_F(SysInfoTest, c_interfaces_bad_params)
     EXPECT_EQ(-1, sysinfo_ports(NULL));
     EXPECT_EQ(-1, sysinfo_os(NULL));
     EXPECT_EQ(-1, sysinfo_hotfixes(NULL));
+    callback_data_t cb_data = { .callback = NULL, .user_data = NULL };
+    EXPECT_EQ(-1, sysinfo_ports_cb(cb_data));
+    EXPECT_EQ(-1, sysinfo_networks_cb(cb_data));
+    EXPECT_EQ(-1, sysinfo_hotfixes_cb(cb_data));
 }
@@ -12,6 +12,7 @@
 #include "sysInfoNetworkLinux_test.h"
 #include "network/networkInterfaceLinux.h"
 #include "network/networkFamilyDataAFactory.h"
+#include "network/networkLinuxNetlinkWrapper.h"
 
 void SysInfoNetworkLinuxTest::SetUp() {};
 
@@ -22,6 +23,35 @@ void SysInfoNetworkLinuxTest::TearDown()
 using ::testing::_;
 using ::testing::Return;
 
+// Builds one rtnetlink message with the attributes appended after the family header.
+template <typename T>
+class NetlinkMessage
+{
+        alignas(nlmsghdr) char m_buffer[1024] {};
+
+    public:
+        NetlinkMessage(const uint16_t type, const T& info)
+        {
+            header().nlmsg_len = NLMSG_LENGTH(sizeof(T));
+            header().nlmsg_type = type;
+            std::memcpy(NLMSG_DATA(&header()), &info, sizeof(T));
+        }
+
+        nlmsghdr& header()
+        {
+            return *reinterpret_cast<nlmsghdr*>(m_buffer);
+        }
+
+        void add(const uint16_t type, const void* data, const size_t size)
+        {
+            const auto attribute { reinterpret_cast<rtattr*>(m_buffer + NLMSG_ALIGN(header().nlmsg_len)) };
+            attribute->rta_type = type;
+            attribute->rta_len = RTA_LENGTH(size);
+            std::memcpy(RTA_DATA(attribute), data, size);
+            header().nlmsg_len = NLMSG_ALIGN(header().nlmsg_len) + RTA_ALIGN(attribute->rta_len);
+        }
+};
+
 class SysInfoNetworkLinuxWrapperMock: public INetworkInterfaceWrapper
 {
     public:
@@ -184,3 +214,125 @@ TEST_F(SysInfoNetworkLinuxTest, Test_Gateway_7546)
     EXPECT_EQ(1500, ifaddr.at("mtu").get<int32_t>());
     EXPECT_EQ("A12BA8C0", ifaddr.at("gateway").get_ref<const std::string&>());
 }
+
+TEST_F(SysInfoNetworkLinuxTest, Test_Netlink_AF_PACKET)
+{
+    ifinfomsg info {};
+    info.ifi_index = 2;
+    info.ifi_type = ARPHRD_ETHER;
+    NetlinkMessage<ifinfomsg> message { RTM_NEWLINK, info };
+    const uint32_t mtu { 1500 };
+    const uint8_t operstate { 6 };
+    const uint8_t mac[] { 0x00, 0xa0, 0xc9, 0x14, 0xc8, 0x29 };
+    rtnl_link_stats64 stats { 0, 1, 2, 3, 4, 5, 6, 7 };
+    message.add(IFLA_IFNAME, "eth01", sizeof("eth01"));
+    message.add(IFLA_MTU, &mtu, sizeof(mtu));
+    message.add(IFLA_OPERSTATE, &operstate, sizeof(operstate));
+    message.add(IFLA_ADDRESS, mac, sizeof(mac));
+    message.add(IFLA_STATS64, &stats, sizeof(stats));
+
+    rtmsg route {};
+    route.rtm_family = AF_INET;
+    route.rtm_table = RT_TABLE_MAIN;
+    NetlinkMessage<rtmsg> routeMessage { RTM_NEWROUTE, route };
+    const int oif { 2 };
+    const uint32_t priority { 100 };
+    in_addr gateway {};
+    inet_pton(AF_INET, "10.2.2.50", &gateway);
+    routeMessage.add(RTA_OIF, &oif, sizeof(oif));
+    routeMessage.add(RTA_PRIORITY, &priority, sizeof(priority));
+    routeMessage.add(RTA_GATEWAY, &gateway, sizeof(gateway));
+
+    NetlinkLinks links;
+    parseNetlinkLink(message.header(), links);
+    parseNetlinkRoute(routeMessage.header(), links);
+    ASSERT_EQ(1u, links.size());
+
+    nlohmann::json ifaddr {};
+    EXPECT_NO_THROW(FactoryNetworkFamilyCreator<OSPlatformType::LINUX>::create(std::make_shared<NetworkLinuxNetlinkInterface>(links.at(2), NetlinkAddressData {}, ""))->buildNetworkData(ifaddr));
+
+    EXPECT_EQ("eth01", ifaddr.at("name").get_ref<const std::string&>());
+    EXPECT_EQ("ethernet", ifaddr.at("type").get_ref<const std::string&>());
+    EXPECT_EQ("up", ifaddr.at("state").get_ref<const std::string&>());
+    EXPECT_EQ("00:a0:c9:14:c8:29", ifaddr.at("mac").get_ref<const std::string&>());
+    EXPECT_EQ(1, ifaddr.at("tx_packets").get<int32_t>());
+    EXPECT_EQ(0, ifaddr.at("rx_packets").get<int32_t>());
+    EXPECT_EQ(3, ifaddr.at("tx_bytes").get<int32_t>());
+    EXPECT_EQ(2, ifaddr.at("rx_bytes").get<int32_t>());
+    EXPECT_EQ(7, ifaddr.at("tx_dropped").get<int32_t>());
+    EXPECT_EQ(6, ifaddr.at("rx_dropped").get<int32_t>());
+    EXPECT_EQ(1500u, ifaddr.at("mtu").get<uint32_t>());
+    EXPECT_EQ("10.2.2.50", ifaddr.at("gateway").get_ref<const std::string&>());
+    EXPECT_EQ("100", links.at(2)->metrics);
+}
+
+TEST_F(SysInfoNetworkLinuxTest, Test_Netlink_Loopback_Skipped)
+{
+    ifinfomsg info {};
+    info.ifi_index = 1;
+    info.ifi_flags = IFF_LOOPBACK;
+    NetlinkMessage<ifinfomsg> message { RTM_NEWLINK, info };
+    message.add(IFLA_IFNAME, "lo", sizeof("lo"));
+
+    NetlinkLinks links;
+    parseNetlinkLink(message.header(), links);
+    EXPECT_TRUE(links.empty());
+}
+
+TEST_F(SysInfoNetworkLinuxTest, Test_Netlink_Addresses)
+{
+    NetlinkLinks links { { 2, std::make_shared<NetlinkLinkData>() } };
+    links.at(2)->name = "eth01";
+    links.at(2)->metrics = "100";
+    NetlinkInterfaces interfaces;
+
+    ifaddrmsg info {};
+    info.ifa_family = AF_INET;
+    info.ifa_prefixlen = 24;
+    info.ifa_index = 2;
+    NetlinkMessage<ifaddrmsg> message { RTM_NEWADDR, info };
+    in_addr address {};
+    in_addr broadcast {};
+    inet_pton(AF_INET, "192.168.0.1", &address);
+    inet_pton(AF_INET, "192.168.0.255", &broadcast);
+    message.add(IFA_ADDRESS, &address, sizeof(address));
+    message.add(IFA_LOCAL, &address, sizeof(address));
+    message.add(IFA_BROADCAST, &broadcast, sizeof(broadcast));
+    parseNetlinkAddress(message.header(), links, interfaces);
+
+    // Without IFA_BROADCAST the address is a peer one, it's reported as getifaddrs does
+    ifaddrmsg peerInfo {};
+    peerInfo.ifa_family = AF_INET6;
+    peerInfo.ifa_prefixlen = 64;
+    peerInfo.ifa_index = 2;
+    NetlinkMessage<ifaddrmsg> peerMessage { RTM_NEWADDR, peerInfo };
+    in6_addr local {};
+    in6_addr peer {};
+    inet_pton(AF_INET6, "fd00::1", &local);
+    inet_pton(AF_INET6, "fd00::2", &peer);
+    peerMessage.add(IFA_ADDRESS, &peer, sizeof(peer));
+    peerMessage.add(IFA_LOCAL, &local, sizeof(local));
+    parseNetlinkAddress(peerMessage.header(), links, interfaces);
+
+    const auto& addresses { interfaces["eth01"].addresses };
+    ASSERT_EQ(2u, addresses.size());
+
+    nlohmann::json ifaddr {};
+
+    for (const auto& data : addresses)
+    {
+        EXPECT_NO_THROW(FactoryNetworkFamilyCreator<OSPlatformType::LINUX>::create(std::make_shared<NetworkLinuxNetlinkInterface>(links.at(2), data, "iface eth01 inet dhcp\n"))->buildNetworkData(ifaddr));
+    }
+
+    const auto& ipv4 { ifaddr.at("IPv4").at(0) };
+    EXPECT_EQ("192.168.0.1", ipv4.at("address").get_ref<const std::string&>());
+    EXPECT_EQ("255.255.255.0", ipv4.at("netmask").get_ref<const std::string&>());
+    EXPECT_EQ("192.168.0.255", ipv4.at("broadcast").get_ref<const std::string&>());
+    EXPECT_EQ("enabled", ipv4.at("dhcp").get_ref<const std::string&>());
+    EXPECT_EQ("100", ipv4.at("metric").get_ref<const std::string&>());
+
+    const auto& ipv6 { ifaddr.at("IPv6").at(0) };
+    EXPECT_EQ("fd00::1", ipv6.at("address").get_ref<const std::string&>());
+    EXPECT_EQ("ffff:ffff:ffff:ffff::", ipv6.at("netmask").get_ref<const std::string&>());
+    EXPECT_EQ("fd00::2", ipv6.at("broadcast").get_ref<const std::string&>());
+}
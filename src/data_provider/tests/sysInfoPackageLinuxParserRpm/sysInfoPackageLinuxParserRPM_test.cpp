@@ -12,6 +12,7 @@
 #include "sysInfoPackageLinuxParserRPM_test.hpp"
 #include "packages/packageLinuxDataRetriever.h"
 #include "packages/berkeleyRpmDbHelper.h"
+#include "packages/sqliteRpmDbHelper.h"
 #include <rpm/header.h>
 #include <rpm/rpmdb.h>
 #include <rpm/rpmlib.h>
@@ -357,7 +358,8 @@ TEST(SysInfoPackageLinuxParserRPM_test, rpmFromLibRPM)
     rpmdbMatchIterator mi = (rpmdbMatchIterator) 0x123;
     Header header = (Header) 0x123;
 
-    EXPECT_CALL(*utils_mock, existsRegular(_)).Times(1).WillOnce(Return(false));
+    EXPECT_CALL(*utils_mock, existsRegular(std::string(RPM_DATABASE))).Times(1).WillOnce(Return(false));
+    EXPECT_CALL(*utils_mock, existsRegular(std::string(RPM_SQLITE_DATABASE))).Times(1).WillOnce(Return(false));
     EXPECT_CALL(*rpm_mock, rpmReadConfigFiles(_, _)).Times(1).WillOnce(Return(0));
     EXPECT_CALL(*rpm_mock, rpmtsCreate()).Times(1).WillOnce(Return(ts));
 
@@ -412,7 +414,8 @@ TEST(SysInfoPackageLinuxParserRPM_test, rpmFallbackFromLibRPM)
     gs_utils_mock = utils_mock.get();
     gs_rpm_mock = rpm_mock.get();
 
-    EXPECT_CALL(*utils_mock, existsRegular(_)).Times(1).WillOnce(Return(false));
+    EXPECT_CALL(*utils_mock, existsRegular(std::string(RPM_DATABASE))).Times(1).WillOnce(Return(false));
+    EXPECT_CALL(*utils_mock, existsRegular(std::string(RPM_SQLITE_DATABASE))).Times(1).WillOnce(Return(false));
     EXPECT_CALL(*rpm_mock, rpmReadConfigFiles(_, _)).Times(1).WillOnce(Return(1));
     EXPECT_CALL(*utils_mock, exec(_, _)).Times(1).WillOnce(Return("1\t2\t3\t4\t5\t6\t7\t8\t9\t10\t\n11\t12\t13\t14\t15\t16\t17\t18\t19\t20\t\n"));
     EXPECT_CALL(wrapper, callbackMock(expectedPackage1)).Times(1);
@@ -542,7 +545,8 @@ TEST(SysInfoPackageLinuxParserRPM_test, emptyRpmFallback)
     gs_utils_mock = utils_mock.get();
     gs_rpm_mock = rpm_mock.get();
 
-    EXPECT_CALL(*utils_mock, existsRegular(_)).Times(1).WillOnce(Return(false));
+    EXPECT_CALL(*utils_mock, existsRegular(std::string(RPM_DATABASE))).Times(1).WillOnce(Return(false));
+    EXPECT_CALL(*utils_mock, existsRegular(std::string(RPM_SQLITE_DATABASE))).Times(1).WillOnce(Return(false));
     EXPECT_CALL(*rpm_mock, rpmReadConfigFiles(_, _)).Times(1).WillOnce(Return(1));
     EXPECT_CALL(*utils_mock, exec(_, _)).Times(1).WillOnce(Return(""));
     EXPECT_CALL(wrapper, callbackMock(_)).Times(0);
@@ -564,7 +568,8 @@ TEST(SysInfoPackageLinuxParserRPM_test, invalidPackageParsingRpmFallback)
     gs_utils_mock = utils_mock.get();
     gs_rpm_mock = rpm_mock.get();
 
-    EXPECT_CALL(*utils_mock, existsRegular(_)).Times(1).WillOnce(Return(false));
+    EXPECT_CALL(*utils_mock, existsRegular(std::string(RPM_DATABASE))).Times(1).WillOnce(Return(false));
+    EXPECT_CALL(*utils_mock, existsRegular(std::string(RPM_SQLITE_DATABASE))).Times(1).WillOnce(Return(false));
     EXPECT_CALL(*rpm_mock, rpmReadConfigFiles(_, _)).Times(1).WillOnce(Return(1));
     EXPECT_CALL(*utils_mock, exec(_, _)).Times(1).WillOnce(Return("this is not a valid rpm -qa output"));
     EXPECT_CALL(wrapper, callbackMock(_)).Times(0);
@@ -0,0 +1,106 @@
+/*
+ * Wazuh SysInfo
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "gtest/gtest.h"
+#include "registryPackagesSnapshot.hpp"
+
+static std::function<nlohmann::json()> countedParse(int& calls, const nlohmann::json& package)
+{
+    return [&calls, package]()
+    {
+        ++calls;
+        return package;
+    };
+}
+
+TEST(RegistryPackagesSnapshotTest, unchangedKeysAreNotParsed)
+{
+    RegistryPackagesSnapshot snapshot;
+    const nlohmann::json package = {{"name", "7-Zip"}, {"version", "22.01"}};
+    int calls { 0 };
+
+    snapshot.begin();
+    EXPECT_EQ(package, snapshot.get("7-Zip", 10, countedParse(calls, package)));
+    EXPECT_TRUE(snapshot.get("KB5005463", 10, countedParse(calls, nlohmann::json())).is_null());
+    snapshot.commit();
+    EXPECT_EQ(2, calls);
+
+    snapshot.begin();
+    EXPECT_EQ(package, snapshot.get("7-Zip", 10, countedParse(calls, nlohmann::json())));
+    EXPECT_TRUE(snapshot.get("KB5005463", 10, countedParse(calls, package)).is_null());
+    snapshot.commit();
+    EXPECT_EQ(2, calls);
+}
+
+TEST(RegistryPackagesSnapshotTest, changedKeysAreParsed)
+{
+    RegistryPackagesSnapshot snapshot;
+    const nlohmann::json oldPackage = {{"name", "7-Zip"}, {"version", "22.01"}};
+    const nlohmann::json newPackage = {{"name", "7-Zip"}, {"version", "23.01"}};
+    int calls { 0 };
+
+    snapshot.begin();
+    snapshot.get("7-Zip", 10, countedParse(calls, oldPackage));
+    snapshot.commit();
+
+    snapshot.begin();
+    EXPECT_EQ(newPackage, snapshot.get("7-Zip", 20, countedParse(calls, newPackage)));
+    snapshot.commit();
+
+    snapshot.begin();
+    EXPECT_EQ(newPackage, snapshot.get("7-Zip", 20, countedParse(calls, oldPackage)));
+    snapshot.commit();
+    EXPECT_EQ(2, calls);
+}
+
+TEST(RegistryPackagesSnapshotTest, removedKeysAreDropped)
+{
+    RegistryPackagesSnapshot snapshot;
+    const nlohmann::json package = {{"name", "7-Zip"}};
+    int calls { 0 };
+
+    snapshot.begin();
+    snapshot.get("7-Zip", 10, countedParse(calls, package));
+    snapshot.get("Notepad++", 10, countedParse(calls, package));
+    snapshot.commit();
+    EXPECT_EQ(2u, snapshot.size());
+
+    snapshot.begin();
+    snapshot.get("7-Zip", 10, countedParse(calls, package));
+    snapshot.commit();
+    EXPECT_EQ(1u, snapshot.size());
+
+    snapshot.begin();
+    snapshot.get("Notepad++", 10, countedParse(calls, package));
+    snapshot.commit();
+    EXPECT_EQ(3, calls);
+}
+
+TEST(RegistryPackagesSnapshotTest, incompleteScanKeepsSnapshot)
+{
+    RegistryPackagesSnapshot snapshot;
+    const nlohmann::json package = {{"name", "7-Zip"}};
+    int calls { 0 };
+
+    snapshot.begin();
+    snapshot.get("7-Zip", 10, countedParse(calls, package));
+    snapshot.commit();
+
+    // The scan is interrupted before its commit.
+    snapshot.begin();
+    snapshot.get("Notepad++", 10, countedParse(calls, package));
+
+    snapshot.begin();
+    snapshot.get("7-Zip", 10, countedParse(calls, package));
+    snapshot.commit();
+    EXPECT_EQ(2, calls);
+    EXPECT_EQ(1u, snapshot.size());
+}
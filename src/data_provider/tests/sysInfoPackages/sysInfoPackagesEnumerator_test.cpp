@@ -0,0 +1,82 @@
+/*
+ * Wazuh SysInfo
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "gtest/gtest.h"
+#include "packagesEnumerator.hpp"
+#include <set>
+#include <stdexcept>
+
+static PackagesSource fakeSource(const std::string& type, const int count)
+{
+    return [type, count](PackagesCallback callback)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            nlohmann::json package = {{"format", type}, {"name", type + std::to_string(i)}};
+            callback(package);
+        }
+    };
+}
+
+TEST(PackagesEnumeratorTest, serialEnumeration)
+{
+    std::vector<std::string> names;
+    PackagesEnumerator::getPackages({fakeSource("deb", 2), fakeSource("pypi", 1)}, [&names](nlohmann::json & data)
+    {
+        names.push_back(data.at("name"));
+    }, 1);
+
+    EXPECT_EQ(std::vector<std::string>({"deb0", "deb1", "pypi0"}), names);
+}
+
+TEST(PackagesEnumeratorTest, parallelEnumeration)
+{
+    std::set<std::string> names;
+    std::set<std::thread::id> callbackThreads;
+    // More packages than the channel holds, producers have to wait for the consumer.
+    PackagesEnumerator::getPackages({fakeSource("deb", 3000), fakeSource("pypi", 500), fakeSource("npm", 500)},
+                                    [&names, &callbackThreads](nlohmann::json & data)
+    {
+        names.insert(data.at("name").get<std::string>());
+        callbackThreads.insert(std::this_thread::get_id());
+    }, 2);
+
+    EXPECT_EQ(4000u, names.size());
+    EXPECT_EQ(1u, names.count("deb2999"));
+    EXPECT_EQ(1u, names.count("npm499"));
+    EXPECT_EQ(std::set<std::thread::id>({std::this_thread::get_id()}), callbackThreads);
+}
+
+TEST(PackagesEnumeratorTest, parallelSourceError)
+{
+    size_t count { 0 };
+    const PackagesSource failingSource
+    {
+        [](PackagesCallback)
+        {
+            throw std::runtime_error { "Error creating package data retriever." };
+        }
+    };
+
+    EXPECT_THROW(PackagesEnumerator::getPackages({failingSource, fakeSource("npm", 10)}, [&count](nlohmann::json&)
+    {
+        ++count;
+    }, 2), std::runtime_error);
+    EXPECT_EQ(10u, count);
+}
+
+TEST(PackagesEnumeratorTest, parallelCallbackError)
+{
+    EXPECT_THROW(PackagesEnumerator::getPackages({fakeSource("deb", 3000), fakeSource("npm", 3000)}, [](nlohmann::json&)
+    {
+        throw std::runtime_error { "callback error" };
+    }, 4), std::runtime_error);
+}
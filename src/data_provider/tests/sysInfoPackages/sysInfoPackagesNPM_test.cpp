@@ -182,3 +182,25 @@ TEST_F(NPMTest, getPackages_ValidPackageJson2Test)
     EXPECT_TRUE(callbackCalledSecond);
 }
 
+
+TEST_F(NPMTest, getFingerprint_PackageJsonChangedTest)
+{
+    std::vector<std::filesystem::path> fakePackages = {"/fake/node_modules/package1", "/fake/node_modules/package2"};
+
+    EXPECT_CALL(*npm, exists(_)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*npm, directory_iterator(_)).WillRepeatedly(Return(fakePackages));
+    EXPECT_CALL(*npm, last_write_time(std::filesystem::path("/fake/node_modules"))).WillRepeatedly(Return(10));
+    EXPECT_CALL(*npm, last_write_time(std::filesystem::path("/fake/node_modules/package1/package.json"))).WillRepeatedly(Return(20));
+    EXPECT_CALL(*npm, last_write_time(std::filesystem::path("/fake/node_modules/package2/package.json")))
+    .WillOnce(Return(30))
+    .WillOnce(Return(30))
+    .WillOnce(Return(31));
+    EXPECT_CALL(*npm, readJson(_)).Times(0);
+
+    std::set<std::string> folders = {"/fake"};
+
+    const auto fingerprint { npm->getFingerprint(folders) };
+    EXPECT_FALSE(fingerprint.empty());
+    EXPECT_EQ(fingerprint, npm->getFingerprint(folders));
+    EXPECT_NE(fingerprint, npm->getFingerprint(folders));
+}
@@ -392,3 +392,36 @@ TEST_F(PYPITest, getPackages_InvalidPackageTest_MissingVersion)
     std::cout << capturedJson.dump(4) << std::endl;
     EXPECT_TRUE(capturedJson.empty());
 }
+
+TEST_F(PYPITest, getFingerprint_PackageAddedTest)
+{
+    std::vector<std::filesystem::path> fakeFiles = {"/fake/dir/pkg1.dist-info"};
+    std::vector<std::filesystem::path> moreFakeFiles = {"/fake/dir/pkg1.dist-info", "/fake/dir/pkg2.dist-info"};
+
+    EXPECT_CALL(*pypi, exists(_)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*pypi, is_directory(_)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*pypi, directory_iterator(_))
+    .WillOnce(Return(fakeFiles))
+    .WillOnce(Return(fakeFiles))
+    .WillOnce(Return(moreFakeFiles));
+    EXPECT_CALL(*pypi, last_write_time(_)).WillRepeatedly(Return(10));
+    EXPECT_CALL(*pypi, readLineByLine(_, _)).Times(0);
+
+    std::set<std::string> folders = { "/fake/dir" };
+
+    const auto fingerprint { pypi->getFingerprint(folders) };
+    EXPECT_FALSE(fingerprint.empty());
+    EXPECT_EQ(fingerprint, pypi->getFingerprint(folders));
+    EXPECT_NE(fingerprint, pypi->getFingerprint(folders));
+}
+
+TEST_F(PYPITest, getFingerprint_NonDirectoryPathTest)
+{
+    EXPECT_CALL(*pypi, exists(_)).WillRepeatedly(Return(true));
+    EXPECT_CALL(*pypi, is_directory(_)).WillRepeatedly(Return(false));
+    EXPECT_CALL(*pypi, directory_iterator(_)).Times(0);
+
+    std::set<std::string> folders = { "/fake/dir" };
+
+    EXPECT_TRUE(pypi->getFingerprint(folders).empty());
+}
@@ -329,6 +329,52 @@ TEST_F(SysInfoPackagesLinuxHelperTest, parseDpkgInformation)
     EXPECT_EQ("zlib", jsPackageInfo["source"]);
 }
 
+TEST_F(SysInfoPackagesLinuxHelperTest, parseDpkgStatusFile)
+{
+    constexpr auto STATUS_FILE
+    {
+        "Package: zlib1g-dev\n"
+        "Status: install ok installed\n"
+        "Installed-Size: 591\n"
+        "Conffiles:\n"
+        " /etc/zlib.conf 0123456789abcdef\n"
+        "Version: 1:1.2.11.dfsg-2ubuntu1.2\n"
+        "Description: compression library - development\n"
+        " zlib is a library implementing the deflate compression method found\n"
+        " in gzip and PKZIP.\n"
+        "\n"
+        "Package: removed\n"
+        "Status: deinstall ok config-files\n"
+        "Version: 1.0\n"
+        "\n"
+        "\n"
+        "Package: gzip\n"
+        "Status: install ok installed\n"
+        "Architecture: amd64"
+    };
+    const std::string statusFile { STATUS_FILE };
+    std::vector<nlohmann::json> packages;
+
+    PackageLinuxHelper::parseDpkgStatus(statusFile.data(),
+                                        statusFile.data() + statusFile.size(),
+                                        [&packages](nlohmann::json & packageInfo)
+    {
+        packages.push_back(packageInfo);
+    });
+
+    ASSERT_EQ(2u, packages.size());
+    EXPECT_EQ("zlib1g-dev", packages[0]["name"]);
+    EXPECT_EQ(591, packages[0]["size"]);
+    EXPECT_EQ("1:1.2.11.dfsg-2ubuntu1.2", packages[0]["version"]);
+    EXPECT_EQ("compression library - development", packages[0]["description"]);
+    EXPECT_EQ(UNKNOWN_VALUE, packages[0]["architecture"]);
+    EXPECT_EQ("", packages[0]["multiarch"]);
+    EXPECT_EQ("gzip", packages[1]["name"]);
+    EXPECT_EQ("amd64", packages[1]["architecture"]);
+    EXPECT_EQ(0, packages[1]["size"]);
+    EXPECT_EQ(UNKNOWN_VALUE, packages[1]["description"]);
+}
+
 TEST_F(SysInfoPackagesLinuxHelperTest, parsePacmanInformation)
 {
     __alpm_list_t   mock        {};
@@ -0,0 +1,194 @@
+/*
+ * Wazuh SysInfo
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <unistd.h>
+#include "sysInfoPackagesSqliteRpmDB_test.h"
+#include "packages/sqliteRpmDbHelper.h"
+
+void SysInfoPackagesSqliteRpmDBTest::SetUp() {};
+void SysInfoPackagesSqliteRpmDBTest::TearDown() {};
+
+// Builds a header blob with the layout stored in the rpmdb.
+class HeaderBlobBuilder final
+{
+        std::vector<uint8_t> m_index;
+        std::vector<uint8_t> m_data;
+
+        static void append(std::vector<uint8_t>& bytes, const uint32_t value)
+        {
+            bytes.push_back(value >> 24);
+            bytes.push_back(value >> 16);
+            bytes.push_back(value >> 8);
+            bytes.push_back(value);
+        }
+
+        void entry(const int32_t tag, const int32_t type)
+        {
+            append(m_index, tag);
+            append(m_index, type);
+            append(m_index, m_data.size());
+            append(m_index, 1);
+        }
+
+    public:
+        HeaderBlobBuilder& string(const int32_t tag, const std::string& value, const int32_t type = RPM_STRING_TYPE)
+        {
+            entry(tag, type);
+            m_data.insert(m_data.end(), value.begin(), value.end());
+            m_data.push_back('\0');
+            return *this;
+        }
+
+        HeaderBlobBuilder& int32(const int32_t tag, const uint32_t value)
+        {
+            m_data.resize((m_data.size() + 3) & ~3);
+            entry(tag, RPM_INT32_TYPE);
+            append(m_data, value);
+            return *this;
+        }
+
+        HeaderBlobBuilder& int64(const int32_t tag, const uint64_t value)
+        {
+            m_data.resize((m_data.size() + 7) & ~7);
+            entry(tag, RPM_INT64_TYPE);
+            append(m_data, value >> 32);
+            append(m_data, value);
+            return *this;
+        }
+
+        std::vector<uint8_t> build() const
+        {
+            std::vector<uint8_t> blob;
+            append(blob, m_index.size() / RPM_HEADER_ENTRY_SIZE);
+            append(blob, m_data.size());
+            blob.insert(blob.end(), m_index.begin(), m_index.end());
+            blob.insert(blob.end(), m_data.begin(), m_data.end());
+            return blob;
+        }
+};
+
+static std::vector<uint8_t> packageBlob(const std::string& name)
+{
+    return HeaderBlobBuilder {}
+           .string(RPMTAG_NAME, name)
+           .string(RPMTAG_VERSION, "2.0.4")
+           .string(RPMTAG_RELEASE, "7.el9")
+           .string(RPMTAG_SUMMARY, "Summary", RPM_I18NSTRING_TYPE)
+           .string(RPMTAG_DESCRIPTION, "Description", RPM_I18NSTRING_TYPE)
+           .string(RPMTAG_VENDOR, "Red Hat, Inc.")
+           .string(RPMTAG_GROUP, "Unspecified", RPM_I18NSTRING_TYPE)
+           .string(RPMTAG_ARCH, "x86_64")
+           .int32(RPMTAG_EPOCH, 1)
+           .int32(RPMTAG_INSTALLTIME, 1700000000)
+           .int32(RPMTAG_SIZE, 5007866)
+           .build();
+}
+
+TEST_F(SysInfoPackagesSqliteRpmDBTest, HeaderProjection)
+{
+    const auto blob { packageBlob("wazuh-agent") };
+    RpmPackageManager::Package package;
+
+    EXPECT_TRUE(RpmHeaderProjection::decode(blob.data(), blob.size(), package));
+    EXPECT_EQ("wazuh-agent", package.name);
+    EXPECT_EQ("2.0.4", package.version);
+    EXPECT_EQ("7.el9", package.release);
+    EXPECT_EQ(1u, package.epoch);
+    EXPECT_EQ("Summary", package.summary);
+    EXPECT_EQ("Description", package.description);
+    EXPECT_EQ("Red Hat, Inc.", package.vendor);
+    EXPECT_EQ("Unspecified", package.group);
+    EXPECT_EQ("x86_64", package.architecture);
+    EXPECT_EQ("1700000000", package.installTime);
+    EXPECT_EQ(5007866u, package.size);
+}
+
+TEST_F(SysInfoPackagesSqliteRpmDBTest, HeaderProjectionLongSize)
+{
+    const auto blob
+    {
+        HeaderBlobBuilder {}
+        .string(RPMTAG_NAME, "huge")
+        .int32(RPMTAG_SIZE, 0)
+        .int64(RPMTAG_LONGSIZE, 5000000000)
+        .build()
+    };
+    RpmPackageManager::Package package;
+
+    EXPECT_TRUE(RpmHeaderProjection::decode(blob.data(), blob.size(), package));
+    EXPECT_EQ("huge", package.name);
+    EXPECT_EQ(5000000000u, package.size);
+    EXPECT_EQ("0", package.installTime);
+    EXPECT_EQ(0u, package.epoch);
+    EXPECT_TRUE(package.vendor.empty());
+}
+
+TEST_F(SysInfoPackagesSqliteRpmDBTest, HeaderProjectionInvalid)
+{
+    auto blob { packageBlob("wazuh-agent") };
+    RpmPackageManager::Package package;
+
+    // The data is shorter than the length in the header
+    EXPECT_FALSE(RpmHeaderProjection::decode(blob.data(), blob.size() - 1, package));
+    EXPECT_FALSE(RpmHeaderProjection::decode(blob.data(), 4, package));
+    EXPECT_FALSE(RpmHeaderProjection::decode(nullptr, 0, package));
+
+    // An entry out of the data is skipped
+    blob[RPM_HEADER_INDEX_OFFSET + 8] = 0x7f;
+    EXPECT_TRUE(RpmHeaderProjection::decode(blob.data(), blob.size(), package));
+    EXPECT_TRUE(package.name.empty());
+    EXPECT_EQ("2.0.4", package.version);
+}
+
+TEST_F(SysInfoPackagesSqliteRpmDBTest, ReadDatabase)
+{
+    char path[] { "/tmp/rpmdb_sqlite_XXXXXX" };
+    const auto fd { mkstemp(path) };
+    ASSERT_NE(-1, fd);
+    close(fd);
+
+    sqlite3* db { nullptr };
+    ASSERT_EQ(SQLITE_OK, sqlite3_open(path, &db));
+    ASSERT_EQ(SQLITE_OK, sqlite3_exec(db, "CREATE TABLE Packages (hnum INTEGER PRIMARY KEY AUTOINCREMENT, blob BLOB NOT NULL);",
+                                      nullptr, nullptr, nullptr));
+
+    sqlite3_stmt* stmt { nullptr };
+    ASSERT_EQ(SQLITE_OK, sqlite3_prepare_v2(db, "INSERT INTO Packages (blob) VALUES (?);", -1, &stmt, nullptr));
+
+    for (const auto& blob : { packageBlob("first"), std::vector<uint8_t> { 0, 0, 0, 1 }, packageBlob("second") })
+    {
+        sqlite3_bind_blob(stmt, 1, blob.data(), blob.size(), SQLITE_TRANSIENT);
+        EXPECT_EQ(SQLITE_DONE, sqlite3_step(stmt));
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    {
+        SqliteRpmDBReader reader { path };
+        RpmPackageManager::Package package;
+
+        // The invalid header is skipped
+        EXPECT_TRUE(reader.getNext(package));
+        EXPECT_EQ("first", package.name);
+        EXPECT_TRUE(reader.getNext(package));
+        EXPECT_EQ("second", package.name);
+        EXPECT_FALSE(reader.getNext(package));
+    }
+
+    unlink(path);
+}
+
+TEST_F(SysInfoPackagesSqliteRpmDBTest, MissingDatabase)
+{
+    EXPECT_ANY_THROW(SqliteRpmDBReader { "/tmp/nonexistent/rpmdb.sqlite" });
+}
@@ -0,0 +1,87 @@
+/*
+ * Wazuh SysInfo
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+#include "sysInfoPortLinux_test.h"
+#include "ports/portLinuxDiagWrapper.h"
+#include "ports/portImpl.h"
+
+void SysInfoPortLinuxTest::SetUp() {};
+
+void SysInfoPortLinuxTest::TearDown()
+{
+};
+
+TEST_F(SysInfoPortLinuxTest, Test_Diag_TCP_IPV4)
+{
+    inet_diag_msg message {};
+    message.idiag_family = AF_INET;
+    message.idiag_state = TCP_ESTABLISHED;
+    message.id.idiag_sport = htons(22);
+    message.id.idiag_dport = htons(51482);
+    inet_pton(AF_INET, "192.168.0.10", &message.id.idiag_src[0]);
+    inet_pton(AF_INET, "192.168.0.1", &message.id.idiag_dst[0]);
+    message.idiag_rqueue = 3;
+    message.idiag_wqueue = 36;
+    message.idiag_inode = 4274126910;
+
+    nlohmann::json port {};
+    EXPECT_NO_THROW(std::make_unique<PortImpl>(std::make_shared<LinuxPortDiagWrapper>(TCP_IPV4, message))->buildPortData(port));
+    EXPECT_EQ("tcp", port.at("protocol").get_ref<const std::string&>());
+    EXPECT_EQ("192.168.0.10", port.at("local_ip").get_ref<const std::string&>());
+    EXPECT_EQ(22, port.at("local_port").get<int32_t>());
+    EXPECT_EQ("192.168.0.1", port.at("remote_ip").get_ref<const std::string&>());
+    EXPECT_EQ(51482, port.at("remote_port").get<int32_t>());
+    EXPECT_EQ(36, port.at("tx_queue").get<int32_t>());
+    EXPECT_EQ(3, port.at("rx_queue").get<int32_t>());
+    EXPECT_EQ(4274126910, port.at("inode").get<int64_t>());
+    EXPECT_EQ("established", port.at("state").get_ref<const std::string&>());
+    EXPECT_EQ(0, port.at("pid").get<int32_t>());
+    EXPECT_EQ(UNKNOWN_VALUE, port.at("process").get_ref<const std::string&>());
+}
+
+TEST_F(SysInfoPortLinuxTest, Test_Diag_TCP_IPV6_Listening)
+{
+    inet_diag_msg message {};
+    message.idiag_family = AF_INET6;
+    message.idiag_state = TCP_LISTEN;
+    message.id.idiag_sport = htons(443);
+    inet_pton(AF_INET6, "fe80::a00:27ff:fe2e:5d8b", message.id.idiag_src);
+    message.idiag_wqueue = 128;
+    message.idiag_inode = 1043;
+
+    nlohmann::json port {};
+    EXPECT_NO_THROW(std::make_unique<PortImpl>(std::make_shared<LinuxPortDiagWrapper>(TCP_IPV6, message))->buildPortData(port));
+    EXPECT_EQ("tcp6", port.at("protocol").get_ref<const std::string&>());
+    EXPECT_EQ("fe80::a00:27ff:fe2e:5d8b", port.at("local_ip").get_ref<const std::string&>());
+    EXPECT_EQ(443, port.at("local_port").get<int32_t>());
+    EXPECT_EQ("::", port.at("remote_ip").get_ref<const std::string&>());
+    EXPECT_EQ(0, port.at("remote_port").get<int32_t>());
+    EXPECT_EQ(128, port.at("tx_queue").get<int32_t>());
+    EXPECT_EQ(0, port.at("rx_queue").get<int32_t>());
+    EXPECT_EQ(1043, port.at("inode").get<int64_t>());
+    EXPECT_EQ("listening", port.at("state").get_ref<const std::string&>());
+}
+
+TEST_F(SysInfoPortLinuxTest, Test_Diag_UDP_IPV4_NoState)
+{
+    inet_diag_msg message {};
+    message.idiag_family = AF_INET;
+    message.idiag_state = TCP_CLOSE;
+    message.id.idiag_sport = htons(68);
+    message.idiag_inode = 22356;
+
+    nlohmann::json port {};
+    EXPECT_NO_THROW(std::make_unique<PortImpl>(std::make_shared<LinuxPortDiagWrapper>(UDP_IPV4, message))->buildPortData(port));
+    EXPECT_EQ("udp", port.at("protocol").get_ref<const std::string&>());
+    EXPECT_EQ("0.0.0.0", port.at("local_ip").get_ref<const std::string&>());
+    EXPECT_EQ(68, port.at("local_port").get<int32_t>());
+    EXPECT_EQ(22356, port.at("inode").get<int64_t>());
+    EXPECT_EQ("", port.at("state").get_ref<const std::string&>());
+}
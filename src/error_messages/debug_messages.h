@@ -279,6 +279,24 @@
 #define FIM_WILDCARDS_REGISTERS_START       "(6372): Starting configuration for Windows registry wildcards."
 #define FIM_WILDCARDS_ADD_REGISTER          "(6373): Expanding entry '%s' to '%s' to monitor FIM events."
 #define FIM_WILDCARDS_REGISTERS_FINALIZE    "(6374): Wildcard configuration successfully completed."
+#define FIM_SCAN_THREADS                    "(6375): Hashing scanned files with %d threads."
+#define FIM_FAST_RESCAN                     "(6376): Files with unchanged metadata won't be hashed in this scan."
+#define FIM_INODE_INDEX_INFO                "(6377): Fim inode index entries: '%d', estimated memory: '%zu' bytes"
+#define FIM_REALTIME_QUEUE_INFO             "(6378): Real-time pending paths: '%u', peak: '%u', coalesced events: '%u', kernel queue overflows: '%u'"
+#define FIM_REALTIME_FANOTIFY               "(6379): Real-time engine started with fanotify filesystem marks."
+#define FIM_REALTIME_NEWFILESYSTEM          "(6380): Filesystem of '%s' added for real time monitoring."
+#define FIM_NUM_FILESYSTEMS                 "(6381): Filesystems monitored with real-time engine: %u"
+#define FIM_FANOTIFY_ADD_MARK               "(6382): Unable to add fanotify mark for '%s' (%d): '%s'"
+#define FIM_USN_SCAN                        "(6383): Changed paths read from the USN journals: %u"
+#define FIM_USN_UNAVAILABLE                 "(6384): USN journal of '%s' isn't available (%lu), files will be checked with full scans."
+#define FIM_USN_RESET                       "(6385): USN journal of volume '%c:' can't be replayed since the previous scan, running a full scan."
+#define FIM_SNAPSHOT_RESTORED               "(6386): Database loaded from the snapshot '%s', files with unchanged metadata won't be hashed in the first scan."
+#define FIM_SNAPSHOT_INVALID                "(6387): Database snapshot '%s' can't be loaded, the first scan will start from an empty database."
+#define FIM_SNAPSHOT_SAVED                  "(6388): Database saved to the snapshot '%s'."
+#define FIM_LINKWATCH_START                 "(6389): Watching %d directories for changes of the configured symbolic links."
+#define FIM_LINKWATCH_UNAVAILABLE           "(6390): Symbolic links can't be watched, they will only be checked every %d seconds."
+#define FIM_LINKWATCH_CHANGE                "(6391): A configured symbolic link changed."
+#define FIM_LINKWATCH_ADD                   "(6392): Unable to watch the directory '%s' for symbolic link changes (%d): '%s'"
 
 /* Modules messages */
 #define WM_UPGRADE_RESULT_AGENT_INFO         "(8151): Agent Information obtained: '%s'"
@@ -71,7 +71,9 @@
 #define FIM_WHODATA_POLICY_CHANGE_CHECKER       "(6952): Audit policy change detected. Switching directories to realtime."
 #define FIM_WHODATA_POLICY_CHANGE_CHANNEL       "(6953): Event 4719 received due to changes in audit policy. Switching directories to realtime."
 #define FIM_EMPTY_CHANGED_ATTRIBUTES            "(6954): Entry '%s' does not have any modified fields. No event will be generated."
+#define FIM_WARN_FANOTIFY_INITIALIZE            "(6956): Unable to initialize fanotify (%d): '%s'. Using inotify for real-time monitoring."
 #define FIM_FULL_AUDIT_QUEUE                    "(6955): Internal audit queue is full. Some events may be lost. Next scheduled scan will recover lost data."
+#define FIM_WARN_SNAPSHOT_SAVE                  "(6957): Unable to save the database snapshot '%s'."
 
 /* Monitord warning messages */
 #define ROTATE_LOG_LONG_PATH                    "(7500): The path of the rotated log is too long."
@@ -139,6 +141,8 @@
 #define LOGCOLLECTOR_MISSING_LOCATION_MACOS     "(8006): Missing 'location' element when using 'macos' as " \
                                                 "'log_format'. Default value will be used."
 #define LOGCOLLECTOR_DEFAULT_REGEX_TYPE         "(8007): Invalid type in '%s' regex '%s', setting by default PCRE2 regex."
+#define LOGCOLLECTOR_INV_JOURNALD               "(8008): Invalid location value '%s' when using 'journald' as " \
+                                                "'log_format'. Default value will be used."
 
 /* Remoted */
 #define REMOTED_NET_PROTOCOL_ERROR              "(9000): Error getting protocol. Default value (%s) will be used."
@@ -18,11 +18,16 @@
 
 #include <shared.h>
 
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
+
 /// bqueue flag set
 typedef enum {
     BQUEUE_NOFLAG = 0,  ///< No options defined
     BQUEUE_WAIT   = 1,  ///< Block push if the queue is full, or pop/peek if the queue is empty
-    BQUEUE_SHRINK = 2   ///< Shrink queue on pop/peek, if more than a half of the queue is unused
+    BQUEUE_SHRINK = 2,  ///< Shrink queue on pop/peek, if more than a half of the queue is unused
+    BQUEUE_FIXED  = 4   ///< Allocate the whole queue on initialization and never resize it
 } bqflag_t;
 
 /**
@@ -39,6 +44,7 @@ typedef struct {
     size_t length;              ///< Current queue length
     size_t max_length;          ///< Maximum length limit
     unsigned flags;             ///< Queue-wide flag set
+    size_t reserved;            ///< Bytes reserved by bqueue_reserve() and not committed yet
     pthread_mutex_t mutex;      ///< Internal lock
     pthread_cond_t cond_pushed; ///< Some data has been pushed, pop/peek may be available
     pthread_cond_t cond_popped; ///< Some data has been popped, push may be available
@@ -47,8 +53,12 @@ typedef struct {
 /**
  * @brief Allocate and inititialize a new queue
  *
+ * If BQUEUE_FIXED is defined, the internal buffer is allocated here with
+ * max_length bytes and it is kept until the queue is destroyed. BQUEUE_SHRINK
+ * has no effect on a fixed queue.
+ *
  * @param max_length Maximum allowed length of the queue.
- * @param flags Queue options: BQUEUE_NOFLAG or BQUEUE_SHRINK.
+ * @param flags Queue options: BQUEUE_NOFLAG, BQUEUE_SHRINK or BQUEUE_FIXED.
  * @return Pointer to a newly allocated queue.
  * @retval NULL No queue allocated, parameter value error.
  */
@@ -73,6 +83,53 @@ void bqueue_destroy(bqueue_t * queue);
  */
 int bqueue_push(bqueue_t * queue, const void * data, size_t length, unsigned flags);
 
+#ifndef WIN32
+/**
+ * @brief Push several buffers into the queue, as a single operation
+ *
+ * The data is inserted only if all the buffers fit, so that they are never split.
+ *
+ * @param queue Pointer to a queue.
+ * @param iov Array of buffers to insert in order.
+ * @param iovcnt Number of buffers.
+ * @param flags Operation options: BQUEUE_NOFLAG or BQUEUE_WAIT.
+ * @retval 0 On success.
+ * @retval -1 No space available.
+ */
+int bqueue_pushv(bqueue_t * queue, const struct iovec * iov, int iovcnt, unsigned flags);
+
+/**
+ * @brief Reserve space in the queue to write data in place
+ *
+ * Point length bytes of free queue memory, in one or two segments, as the
+ * space may wrap around the circular buffer. The second segment is empty if
+ * the space is contiguous, that is always the case if the queue is empty.
+ *
+ * On success, the queue remains locked until bqueue_commit() is called, so
+ * the caller shall write the data and commit it without delay.
+ *
+ * @param queue Pointer to a queue.
+ * @param iov Destination segments.
+ * @param length Number of bytes to reserve.
+ * @param flags Operation options: BQUEUE_NOFLAG or BQUEUE_WAIT.
+ * @retval 0 On success.
+ * @retval -1 No space available.
+ */
+int bqueue_reserve(bqueue_t * queue, struct iovec iov[2], size_t length, unsigned flags);
+
+/**
+ * @brief Publish the data written into the reserved space
+ *
+ * Append the first length bytes of the last reservation to the queue and
+ * unlock it. Committing zero bytes cancels the reservation.
+ *
+ * @param queue Pointer to a queue.
+ * @param length Number of bytes written, at most the reserved length.
+ * @pre bqueue_reserve() must have succeeded on this queue.
+ */
+void bqueue_commit(bqueue_t * queue, size_t length);
+#endif
+
 /**
  * @brief Get and remove data from the queue
  *
@@ -82,7 +139,8 @@ int bqueue_push(bqueue_t * queue, const void * data, size_t length, unsigned fla
  *
  * If BQUEUE_SHRINK was defined on initialization, the queue will be resized
  * down when the used space is less than half of the current capacity. In any
- * case, the internal buffer will be deallocated if the queue gets empty.
+ * case, the internal buffer will be deallocated if the queue gets empty,
+ * unless BQUEUE_FIXED was defined.
  *
  * This operation is equivalent to call peek + drop atomically.
  *
@@ -109,6 +167,25 @@ size_t bqueue_pop(bqueue_t * queue, void * buffer, size_t length, unsigned flags
  */
 size_t bqueue_peek(bqueue_t * queue, char * buffer, size_t length, unsigned flags);
 
+#ifndef WIN32
+/**
+ * @brief Get the data from the queue without copying it
+ *
+ * Point at most length bytes of the queue memory, in one or two segments,
+ * as the data may wrap around the circular buffer. The second segment is
+ * empty if the data is contiguous. The data is not removed.
+ *
+ * The segments are only valid until the next operation on the queue, so the
+ * caller must serialize the access to the queue while it uses them.
+ *
+ * @param queue Pointer to a queue.
+ * @param iov Destination segments.
+ * @param length Maximum number of bytes that should be peeked.
+ * @return Number of bytes pointed by the segments.
+ */
+size_t bqueue_peekv(bqueue_t * queue, struct iovec iov[2], size_t length);
+#endif
+
 /**
  * @brief Drop data from the queue
  *
@@ -117,7 +194,8 @@ size_t bqueue_peek(bqueue_t * queue, char * buffer, size_t length, unsigned flag
  *
  * If BQUEUE_SHRINK was defined on initialization, the queue will be resized
  * down when the used space is less than half of the current capacity. In any
- * case, the internal buffer will be deallocated if the queue gets empty.
+ * case, the internal buffer will be deallocated if the queue gets empty,
+ * unless BQUEUE_FIXED was defined.
  *
  * @param queue Pointer to a queue.
  * @param length Number of bytes that shall be removed.
@@ -137,7 +215,8 @@ size_t bqueue_used(bqueue_t * queue);
 /**
  * @brief Clear the queue
  *
- * Discard all data in the queue and deallocate the internal buffer.
+ * Discard all data in the queue and deallocate the internal buffer, unless
+ * BQUEUE_FIXED was defined on initialization.
  *
  * @param queue Pointer to a queue.
  */
@@ -41,8 +41,14 @@
 #define mdebug1(msg, ...) _mdebug1(__FILE__, __LINE__, __func__, msg, ##__VA_ARGS__)
 #define plain_mdebug1(msg, ...) _plain_mdebug1(__FILE__, __LINE__, __func__, msg, ##__VA_ARGS__)
 #define mtdebug1(tag, msg, ...) _mtdebug1(tag, __FILE__, __LINE__, __func__, msg, ##__VA_ARGS__)
+#ifndef DISABLE_DEBUG2
 #define mdebug2(msg, ...) _mdebug2(__FILE__, __LINE__, __func__, msg, ##__VA_ARGS__)
 #define mtdebug2(tag, msg, ...) _mtdebug2(tag, __FILE__, __LINE__, __func__, msg, ##__VA_ARGS__)
+#else
+/* Level 2 debug messages are compiled out, but their format is still checked */
+#define mdebug2(msg, ...) do { if (0) _mdebug2(__FILE__, __LINE__, __func__, msg, ##__VA_ARGS__); } while (0)
+#define mtdebug2(tag, msg, ...) do { if (0) _mtdebug2(tag, __FILE__, __LINE__, __func__, msg, ##__VA_ARGS__); } while (0)
+#endif
 #define merror(msg, ...) _merror(__FILE__, __LINE__, __func__, msg, ##__VA_ARGS__)
 #define plain_merror(msg, ...) _plain_merror(__FILE__, __LINE__, __func__, msg, ##__VA_ARGS__)
 #define mterror(tag, msg, ...) _mterror(tag, __FILE__, __LINE__, __func__, msg, ##__VA_ARGS__)
@@ -89,6 +95,25 @@ void _mlerror_exit(const int level, const char * file, int line, const char * fu
  */
 void w_logging_init();
 
+#ifndef WIN32
+/**
+ * @brief Start logging asynchronously
+ *
+ * From now on, the calling threads format the log lines and queue them,
+ * and a writer thread appends them to the log files in batches. Lines are
+ * dropped if the queue is full, and the writer reports how many were lost.
+ * The pending lines are written on exit.
+ *
+ * This must be called after daemonizing, as the writer thread does not
+ * survive a fork.
+ *
+ * @param max_bytes Size of the queue of each log format, in bytes.
+ * @retval 0 On success.
+ * @retval -1 The size cannot hold a full line, or the writer could not be started.
+ */
+int w_logging_async_start(size_t max_bytes);
+#endif
+
 /* Function to read the logging format configuration */
 void os_logging_config();
 cJSON *getLoggingConfig(void);
@@ -185,6 +185,9 @@ https://www.gnu.org/licenses/gpl.html\n"
 /* Decoder file */
 #define XML_LDECODER    "etc/decoders/local_decoder.xml"
 
+/* Agent spill queue location */
+#define SPILL_DIR     "queue/spill"
+
 /* Agent groups location */
 #define GROUPS_DIR    "queue/agent-groups"
 
@@ -314,6 +317,9 @@ https://www.gnu.org/licenses/gpl.html\n"
 
 /* Multi-groups directory */
 #define MULTIGROUPS_DIR   "var/multigroups"
+
+/* Previous versions of the merged files, to send deltas to the agents */
+#define SHAREDCFG_HISTORY_DIR "queue/shared-history"
 #define MAX_GROUP_NAME 255
 #define MULTIGROUP_SEPARATOR ','
 #define MAX_GROUPS_PER_MULTIGROUP 128
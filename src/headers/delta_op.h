@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/**
+ * @file delta_op.h
+ * @brief Line based deltas between two versions of a text file
+ *
+ * A delta is text itself, so it travels over the same channels as the file:
+ *
+ *     wdelta 1
+ *     c <first> <count>    copy count lines of the old version, from line first (0-based)
+ *     a <count>            append the count lines that follow
+ *
+ * Lines keep their line feed, only the last line of a file may lack it.
+ */
+
+#ifndef DELTA_OP_H
+#define DELTA_OP_H
+
+#include <stddef.h>
+
+#define W_DELTA_MAGIC "wdelta 1\n"
+
+/**
+ * @brief Build the delta that turns a text into another.
+ *
+ * Moved and repeated blocks are found as well, lines are indexed by hash.
+ *
+ * @param base Old version.
+ * @param base_size Size of the old version.
+ * @param target New version.
+ * @param target_size Size of the new version.
+ * @param delta_size Size of the delta.
+ * @return Delta, to be freed by the caller.
+ */
+char * w_delta_create(const char * base, size_t base_size, const char * target, size_t target_size, size_t * delta_size);
+
+/**
+ * @brief Apply a delta to a text.
+ *
+ * @param base Old version.
+ * @param base_size Size of the old version.
+ * @param delta Delta.
+ * @param delta_size Size of the delta.
+ * @param target_size Size of the new version.
+ * @return New version, to be freed by the caller. NULL if the delta is malformed or doesn't fit the old version.
+ */
+char * w_delta_apply(const char * base, size_t base_size, const char * delta, size_t delta_size, size_t * target_size);
+
+/**
+ * @brief Apply a delta file to a text file.
+ *
+ * The files are opened in text mode, so the lines of the delta match the ones of the file on every platform.
+ *
+ * @param base_path Old version, it may be the same as the output.
+ * @param delta_path Delta.
+ * @param output_path New version, written through a temporary file.
+ * @retval 0 Success.
+ * @retval -1 A file can't be read or written, or the delta doesn't fit.
+ */
+int w_delta_apply_file(const char * base_path, const char * delta_path, const char * output_path);
+
+#endif /* DELTA_OP_H */
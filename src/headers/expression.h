@@ -14,6 +14,7 @@
 
 #include "../external/libpcre2/include/pcre2.h"
 #include "../os_regex/os_regex.h"
+#include "../headers/list_op.h"
 
 #define OSMATCH_STR  "osmatch"
 #define OSREGEX_STR  "osregex"
@@ -39,6 +40,8 @@ typedef enum {
 typedef struct {
    pcre2_code * code;
    char * raw_pattern;
+   uint32_t ovector_pairs;  ///< Capturing groups plus the whole match, sizes the matching data
+   bool jit;                ///< The JIT compilation succeeded, it can be matched by pcre2_jit_match()
 } w_pcre2_code_t;
 
 /**
@@ -125,6 +128,24 @@ void w_free_expression_match(w_expression_t * expression, regex_matching **reg);
 void w_expression_PCRE2_fill_regex_match(int captured_groups, const char * str_test, pcre2_match_data * match_data,
                                          regex_matching * regex_match);
 
+/**
+ * @brief Use pcre2_jit_match() for the JIT compiled PCRE2 expressions
+ *
+ * It skips the sanity checks of pcre2_match(), which are not needed for the
+ * patterns compiled by w_expression_compile(). Enabled by default.
+ *
+ * @param enabled false to match through pcre2_match()
+ */
+void w_expression_set_jit_match(bool enabled);
+
+/**
+ * @brief Free the PCRE2 matching data of the calling thread
+ *
+ * Each thread reuses its matching data and JIT stack in every PCRE2 match.
+ * They are freed on the thread exit too.
+ */
+void w_expression_release_thread_data(void);
+
 /**
  * @brief Get regex pattern of the expression
  * @param expression expression with compiled pattern
@@ -139,4 +160,59 @@ const char * w_expression_get_regex_pattern(w_expression_t * expression);
  */
 const char * w_expression_get_regex_type(w_expression_t * expression);
 
+/**
+ * @brief Merge the PCRE2 expressions of a list into a single alternation
+ *
+ * The list must be matched as a whole, being true if any expression matches.
+ * The merged expression is matched by a single pass of the JIT instead of one
+ * pass per expression. Those whose meaning could change inside an alternation
+ * are kept on their own.
+ *
+ * @param list list of w_expression_t
+ * @return true if the expressions were merged, otherwise false
+ */
+bool w_expression_merge_pcre2(OSList * list);
+
+/**
+ * @brief Load the cache of compiled PCRE2 patterns
+ *
+ * Once loaded, every PCRE2 expression compiled is copied from the cache when its
+ * pattern is found, and added to the cache otherwise. Only the JIT compilation
+ * is done for the patterns found.
+ *
+ * @param path cache file, written by w_expression_cache_save()
+ * @return number of patterns loaded, -1 if the file is missing, doesn't match its checksum or can't be used
+ */
+int w_expression_cache_load(const char * path);
+
+/**
+ * @brief Write the cache of compiled PCRE2 patterns
+ *
+ * The file keeps the patterns compiled since the cache was loaded, it's only
+ * written if they changed. From then on, the cache gets no new patterns.
+ *
+ * @param path cache file
+ * @return 0 if the file is up to date, -1 on error
+ */
+int w_expression_cache_save(const char * path);
+
+/**
+ * @brief Free the cache of compiled PCRE2 patterns
+ */
+void w_expression_cache_free(void);
+
+/**
+ * @brief Get a copy of a cached PCRE2 pattern
+ * @param pattern regular expression pattern
+ * @return compiled pattern, without JIT data. NULL if the cache isn't loaded or the pattern is missing
+ */
+pcre2_code * w_expression_cache_get(const char * pattern);
+
+/**
+ * @brief Add a compiled PCRE2 pattern to the cache, if it's loaded
+ * @param pattern regular expression pattern
+ * @param code compiled pattern, it's copied. NULL is accepted
+ */
+void w_expression_cache_add(const char * pattern, const pcre2_code * code);
+
 #endif
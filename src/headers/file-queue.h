@@ -26,6 +26,9 @@ typedef struct _file_queue {
 
     FILE *fp;
     struct stat f_status;
+
+    unsigned int min_level;     ///< JSON queue: alerts below this rule level are skipped before parsing
+    const char *pattern;        ///< JSON queue: alerts not containing this text are skipped before parsing
 } file_queue;
 
 #include "read-alert.h"
@@ -13,25 +13,45 @@
 #ifndef OS_HASHOP
 #define OS_HASHOP
 #include <pthread.h>
+#include <stdint.h>
+
+#define OSHASH_STRIPES  16      ///< Stripes of the concurrent hashes shared by the analysis threads
 
 /* Node structure */
 typedef struct _OSHashNode {
-    struct _OSHashNode *next;
-    struct _OSHashNode *prev;
+    struct _OSHashNode *next;   ///< Unused, kept for compatibility: each slot holds one node
+    struct _OSHashNode *prev;   ///< Unused, kept for compatibility
 
     char *key;
     void *data;
 } OSHashNode;
 
+/* Open-addressing table. While it's being resized, the entries are moved
+ * from the previous table (old_*) to the new one a few at a time.
+ */
 typedef struct _OSHash {
-    unsigned int rows;
-    unsigned int initial_seed;
-    unsigned int constant;
+    unsigned int rows;          ///< Slots of the table, minus one
+    unsigned int growth_left;   ///< Empty slots that can be used before resizing the table
+    uint64_t seed;              ///< Seed of the hash function
     pthread_rwlock_t mutex;
-    unsigned int elements;
+    unsigned int elements;      ///< Entries of both tables
 
     void (*free_data_function)(void *data);
-    OSHashNode **table;
+    OSHashNode **table;         ///< Slots, NULL if empty
+    unsigned char *ctrl;        ///< Metadata of each slot: empty, deleted or 7 bits of the hash of its key
+
+    OSHashNode **old_table;     ///< Table being resized, NULL if none
+    unsigned char *old_ctrl;
+    unsigned int old_rows;
+    unsigned int old_elements;  ///< Entries not moved yet
+    unsigned int old_pos;       ///< Next slot to move
+
+    struct _OSHash **shards;    ///< Stripes of a concurrent table, NULL otherwise
+    unsigned int shard_bits;    ///< Bits of the hash of the keys that select their stripe
+    int lockfree;               ///< Stripe of a concurrent table: OSHash_Get_ex() doesn't lock it
+    unsigned int seq;           ///< Odd while the stripe is being changed
+    void *retired;              ///< Nodes and tables removed while lock-free readers may still use them
+    unsigned int retired_count;
 } OSHash;
 
 typedef enum _OSHash_results_codes {
@@ -45,6 +65,14 @@ typedef enum _OSHash_results_codes {
 /* Create and initialize hash */
 OSHash *OSHash_Create(void);
 
+/* Split the hash in `stripes` tables (a power of two), each one with its
+ * own lock, and serve OSHash_Get_ex() without locking. The *_ex functions
+ * only lock the stripe of the key.
+ * It must be called on an empty hash, before sharing it.
+ * Returns 0 on error
+ */
+int OSHash_SetConcurrent(OSHash *self, unsigned int stripes) __attribute__((nonnull));
+
 /* Free the memory used by the hash */
 int OSHash_SetFreeDataPointer(OSHash *self, void (free_data_function)(void *)) __attribute__((nonnull));
 void *OSHash_Free(OSHash *self) __attribute__((nonnull));
@@ -84,6 +112,9 @@ int OSHash_setSize_ex(OSHash *self, unsigned int new_size) __attribute__((nonnul
 OSHash *OSHash_Duplicate(const OSHash *hash) __attribute__((nonnull));
 OSHash *OSHash_Duplicate_ex(const OSHash *hash) __attribute__((nonnull));
 
+/* Iteration of the entries. The current node may be deleted, but no key
+ * must be added until the iteration ends: it may move the entries.
+ */
 OSHashNode *OSHash_Begin(const OSHash *self, unsigned int *i);
 OSHashNode *OSHash_Next(const OSHash *self, unsigned int *i, OSHashNode *current);
 void *OSHash_Clean(OSHash *self, void (*cleaner)(void*));
@@ -91,12 +122,17 @@ void *OSHash_Clean(OSHash *self, void (*cleaner)(void*));
 /*
  * Safe iteration of the hash Table
  * Mode: 0 (read it), 1 (write it), 2 (write it with delay)
+ * The iterating function may remove the node by setting *row to NULL.
+ * Concurrent hashes are locked one stripe at a time: each stripe is seen
+ * as a whole, but keys of other stripes may change during the iteration.
+ * Their nodes may be in use by lock-free readers, so the iterating
+ * function must not remove them while other threads use the hash.
 */
 void OSHash_It(const OSHash *hash, void *data, void (*iterating_function)(OSHashNode **row, OSHashNode **node, void *data));
 void OSHash_It_ex(const OSHash *hash, char mode, void *data, void (*iterating_function)(OSHashNode **row, OSHashNode **node, void *data));
 
 /*
- * Returns the index of the key.
+ * Returns the index of the first slot probed for the key.
 */
 unsigned int OSHash_GetIndex(OSHash *self, const char *key);
 
@@ -31,11 +31,24 @@ cJSON * jqueue_next(file_queue * queue);
 // Close queue
 void jqueue_close(file_queue * queue);
 
+/**
+ * @brief Set a pre-filter that discards the alerts a consumer doesn't need before parsing them
+ *
+ * The checks run on the raw alert text, so they are conservative: an alert whose
+ * level can't be found in the text is always parsed.
+ *
+ * @param queue pointer to the file_queue struct
+ * @param min_level skip alerts whose rule level is lower. 0 disables the check.
+ * @param pattern skip alerts that don't contain this text. NULL disables the check.
+ */
+void jqueue_set_filter(file_queue * queue, unsigned int min_level, const char * pattern);
+
 /**
  * @brief Read and validate a JSON alert from the file queue
  *
  * @param queue pointer to the file_queue struct
  * @post The flag variable may be set to CRALERT_READ_FAILED if the read operation got no data.
+ * @post The flag variable is set to CRALERT_FILTERED if the alert was skipped by the pre-filter.
  * @post The read position is restored if failed to get a JSON object.
  * @retval NULL No data read or could not get a valid JSON object. Pointer to the JSON object otherwise.
  */
@@ -13,8 +13,11 @@
 #define JSON_OP_H
 
 #define JSON_MAX_FSIZE 2147483648
+#define JSON_WRITER_MAX_DEPTH 64
 
 #include <cJSON.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 /**
  * @brief It temporarily saves in memory the content of the file located in path.
@@ -55,4 +58,156 @@ void json_strip(char * json);
  * */
 int* json_parse_agents(const cJSON* agents);
 
+/**
+ * @brief Streaming JSON serializer.
+ *
+ * Appends JSON text straight into a growable buffer instead of building a cJSON
+ * tree and printing it. The buffer is kept across resets, so a writer reused
+ * in a loop stops allocating once it reaches the size of the largest document.
+ * The output is byte-compatible with cJSON_PrintUnformatted().
+ */
+typedef struct json_writer_t {
+    char * data;        ///< NUL-terminated output.
+    size_t length;      ///< Output length, not including the NUL byte.
+    size_t size;        ///< Allocated size of data.
+    unsigned depth;     ///< Number of open objects and arrays.
+    bool overflow;      ///< Set when the nesting exceeded JSON_WRITER_MAX_DEPTH.
+    uint64_t items;     ///< Bit n is set when the container at depth n already has an item.
+} json_writer_t;
+
+/**
+ * @brief Initialize a JSON writer.
+ *
+ * @param writer Writer to initialize.
+ * @param size Initial buffer size. It grows on demand.
+ */
+void json_writer_init(json_writer_t * writer, size_t size);
+
+/**
+ * @brief Empty the writer output, keeping the buffer.
+ *
+ * @param writer Writer to reset.
+ */
+void json_writer_reset(json_writer_t * writer);
+
+/**
+ * @brief Free the writer buffer.
+ *
+ * @param writer Writer to release.
+ */
+void json_writer_free(json_writer_t * writer);
+
+/**
+ * @brief Open an object.
+ *
+ * @param writer Writer.
+ * @param key Member name when the object lives inside another object. NULL otherwise.
+ */
+void json_writer_object_begin(json_writer_t * writer, const char * key);
+
+/**
+ * @brief Close the innermost object.
+ *
+ * @param writer Writer.
+ */
+void json_writer_object_end(json_writer_t * writer);
+
+/**
+ * @brief Open an array.
+ *
+ * @param writer Writer.
+ * @param key Member name when the array lives inside an object. NULL otherwise.
+ */
+void json_writer_array_begin(json_writer_t * writer, const char * key);
+
+/**
+ * @brief Close the innermost array.
+ *
+ * @param writer Writer.
+ */
+void json_writer_array_end(json_writer_t * writer);
+
+/**
+ * @brief Add an escaped string. A NULL value is written as null.
+ *
+ * @param writer Writer.
+ * @param key Member name, or NULL for array items.
+ * @param value NUL-terminated string.
+ */
+void json_writer_add_string(json_writer_t * writer, const char * key, const char * value);
+
+/**
+ * @brief Add an escaped string of a known length.
+ *
+ * @param writer Writer.
+ * @param key Member name, or NULL for array items.
+ * @param value String, it does not need to be NUL-terminated.
+ * @param length Number of bytes of value.
+ */
+void json_writer_add_stringn(json_writer_t * writer, const char * key, const char * value, size_t length);
+
+/**
+ * @brief Add a number, formatted as cJSON does.
+ *
+ * @param writer Writer.
+ * @param key Member name, or NULL for array items.
+ * @param value Number. NaN and infinite numbers are written as null.
+ */
+void json_writer_add_number(json_writer_t * writer, const char * key, double value);
+
+/**
+ * @brief Add an integer number.
+ *
+ * @param writer Writer.
+ * @param key Member name, or NULL for array items.
+ * @param value Number.
+ */
+void json_writer_add_int(json_writer_t * writer, const char * key, long long value);
+
+/**
+ * @brief Add a boolean.
+ *
+ * @param writer Writer.
+ * @param key Member name, or NULL for array items.
+ * @param value Boolean.
+ */
+void json_writer_add_bool(json_writer_t * writer, const char * key, bool value);
+
+/**
+ * @brief Add a null value.
+ *
+ * @param writer Writer.
+ * @param key Member name, or NULL for array items.
+ */
+void json_writer_add_null(json_writer_t * writer, const char * key);
+
+/**
+ * @brief Add a value that is already serialized. It is copied verbatim.
+ *
+ * @param writer Writer.
+ * @param key Member name, or NULL for array items.
+ * @param json JSON text.
+ * @param length Length of json.
+ */
+void json_writer_add_raw(json_writer_t * writer, const char * key, const char * json, size_t length);
+
+/**
+ * @brief Append text to the output verbatim, without any separator.
+ *
+ * Meant for message headers written before the document.
+ *
+ * @param writer Writer.
+ * @param text Text.
+ * @param length Length of text.
+ */
+void json_writer_append(json_writer_t * writer, const char * text, size_t length);
+
+/**
+ * @brief Get the writer output.
+ *
+ * @param writer Writer.
+ * @return NUL-terminated JSON text, owned by the writer.
+ */
+const char * json_writer_str(const json_writer_t * writer);
+
 #endif
@@ -27,4 +27,30 @@ int    os_IsStrOnArray(const char *str, char **array);
 char  *os_LoadString(char *at, const char *str) __attribute__((nonnull(2)));
 void  *memset_secure(void *v, int c, size_t n) __attribute__((nonnull));
 
+/* Heap usage, as reported by the allocator in use */
+typedef struct w_mem_stats_t {
+    const char *allocator;  ///< "jemalloc" or "system"
+    size_t allocated;       ///< Bytes allocated by the process
+    size_t active;          ///< Bytes of the pages or chunks that hold the allocations
+    size_t resident;        ///< Resident bytes of the process, 0 if unknown
+} w_mem_stats_t;
+
+/**
+ * @brief Get the heap usage of the process.
+ *
+ * jemalloc is used if the daemon is linked with it or it's preloaded,
+ * the system allocator statistics otherwise.
+ *
+ * @param stats Heap usage.
+ * @return 0 on success, -1 if the allocator doesn't report it.
+ */
+int w_mem_stats(w_mem_stats_t *stats);
+
+/**
+ * @brief Export the heap usage through the metrics registry.
+ *
+ * The gauges are sampled every time the registry is dumped.
+ */
+void w_mem_metrics_init(void);
+
 #endif /* MEM_H */
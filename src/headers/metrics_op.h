@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/**
+ * @file metrics_op.h
+ * @brief Process-wide registry of counters, gauges and latency histograms
+ *
+ * Counters and histograms are sharded: every thread updates its own slot with
+ * a relaxed atomic add and the slots are only summed up when the registry is
+ * read. Histograms keep log-linear buckets (HDR style) with a relative error
+ * under 1/16, so any percentile can be computed from them.
+ *
+ * Metrics are registered once, usually at startup, and never released. A NULL
+ * metric is accepted by every update function and ignored.
+ */
+
+#ifndef METRICS_OP_H
+#define METRICS_OP_H
+
+#include <cJSON.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Slots of a sharded metric, threads are spread among them round robin */
+#define W_METRICS_SHARDS            8
+
+/* Exact values below this, then 16 buckets per power of two */
+#define W_METRICS_LINEAR_BUCKETS    32
+#define W_METRICS_SUB_BUCKETS       16
+
+/* Values are clamped to 2^40 - 1, about 12 days in microseconds */
+#define W_METRICS_MAX_BITS          40
+#define W_METRICS_BUCKETS           (W_METRICS_LINEAR_BUCKETS + (W_METRICS_MAX_BITS - 5) * W_METRICS_SUB_BUCKETS)
+
+typedef enum w_metric_type_t {
+    W_METRIC_COUNTER,
+    W_METRIC_GAUGE,
+    W_METRIC_HISTOGRAM
+} w_metric_type_t;
+
+typedef struct w_metric_s w_metric_t;
+
+/**
+ * @brief Get a counter, registering it on the first call.
+ *
+ * @param name Metric name: letters, digits and underscores, e.g. "wazuhdb_queries_total".
+ * @param help One line description.
+ * @return The counter, or NULL if the name is registered with another type.
+ */
+w_metric_t * w_metrics_counter(const char * name, const char * help);
+
+/**
+ * @brief Get a gauge, registering it on the first call.
+ *
+ * @param name Metric name.
+ * @param help One line description.
+ * @return The gauge, or NULL if the name is registered with another type.
+ */
+w_metric_t * w_metrics_gauge(const char * name, const char * help);
+
+/**
+ * @brief Get a histogram, registering it on the first call.
+ *
+ * @param name Metric name, ending in its unit, e.g. "wazuhdb_query_latency_us".
+ * @param help One line description.
+ * @return The histogram, or NULL if the name is registered with another type.
+ */
+w_metric_t * w_metrics_histogram(const char * name, const char * help);
+
+/**
+ * @brief Add a value to a counter.
+ *
+ * @param counter Counter.
+ * @param value Value to add.
+ */
+void w_metrics_add(w_metric_t * counter, uint64_t value);
+
+/**
+ * @brief Set the value of a gauge.
+ *
+ * @param gauge Gauge.
+ * @param value New value.
+ */
+void w_metrics_set(w_metric_t * gauge, int64_t value);
+
+/**
+ * @brief Add a value, that may be negative, to a gauge.
+ *
+ * @param gauge Gauge.
+ * @param delta Value to add.
+ */
+void w_metrics_shift(w_metric_t * gauge, int64_t delta);
+
+/**
+ * @brief Record a sample in a histogram.
+ *
+ * @param histogram Histogram.
+ * @param value Sample.
+ */
+void w_metrics_record(w_metric_t * histogram, uint64_t value);
+
+/**
+ * @brief Record the microseconds elapsed since a point in time.
+ *
+ * @param histogram Histogram.
+ * @param start Starting time, taken with gettime().
+ */
+void w_metrics_record_since(w_metric_t * histogram, const struct timespec * start);
+
+/**
+ * @brief Get the value of a counter or a gauge, summing up its shards.
+ *
+ * @param metric Counter or gauge.
+ * @return Current value. The number of samples for a histogram.
+ */
+int64_t w_metrics_value(w_metric_t * metric);
+
+/**
+ * @brief Get a percentile of a histogram.
+ *
+ * @param histogram Histogram.
+ * @param percentile Percentile, from 0 to 100.
+ * @return Highest value equivalent to the percentile sample, 0 if the histogram is empty.
+ */
+uint64_t w_metrics_percentile(w_metric_t * histogram, double percentile);
+
+/**
+ * @brief Dump the registry.
+ *
+ * Counters and gauges are numbers, histograms are objects with their count,
+ * sum, max and the 50th, 90th, 99th and 99.9th percentiles.
+ *
+ * @return JSON object keyed by metric name.
+ */
+cJSON * w_metrics_json(void);
+
+/**
+ * @brief Dump the registry in Prometheus text format. Histograms are exposed as summaries.
+ *
+ * @return Text to be freed by the caller.
+ */
+char * w_metrics_prometheus(void);
+
+/**
+ * @brief Register a function that is called before every dump of the registry.
+ *
+ * It's meant for gauges that are sampled rather than updated, like the
+ * allocator statistics.
+ *
+ * @param collector Function that sets its gauges.
+ */
+void w_metrics_collector(void (*collector)(void));
+
+/**
+ * @brief Answer the getmetrics command of a plain text com socket.
+ *
+ * @param format "prometheus" for the text format, NULL or "json" for JSON.
+ * @param output "ok" followed by the dump, or an "err" message. To be freed by the caller.
+ * @return Length of the output.
+ */
+size_t w_metrics_getmetrics(const char * format, char ** output);
+
+/**
+ * @brief Answer the getmetrics command of a JSON com socket.
+ *
+ * @param parameters Request parameters, may be NULL. Its "format" is "json" (default) or "prometheus".
+ * @return Response data: the registry dump, or an object with the text format in "prometheus".
+ */
+cJSON * w_metrics_getmetrics_json(const cJSON * parameters);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* METRICS_OP_H */
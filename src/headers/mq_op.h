@@ -30,6 +30,10 @@
 
 #define INFINITE_OPENQ_ATTEMPTS 0
 
+/* Limits of a batch of SendMSGBatch() */
+#define MQ_BATCH_MAX    64
+#define MQ_BATCH_BYTES  (4 * (OS_MAXSTR + 1))
+
 extern int sock_fail_time;
 
 /**
@@ -125,6 +129,79 @@ int SendMSGtoSCK(int queue, const char *message, const char *locmsg, char loc, l
  */
 int SendJSONtoSCK(char* message, socket_forwarder* Config);
 
+#ifdef __linux__
+/**
+ * Sends a batch of messages to the queue with one call, as SendMSGtoSCK() does for the "agent" target.
+ * The batch is cut when the formatted messages exceed MQ_BATCH_BYTES.
+ * @param queue queue socket
+ * @param messages messages to send
+ * @param locmsgs location of each message
+ * @param locs queue identifier of each message
+ * @param targets target of each message, whose format is applied
+ * @param count number of messages, up to MQ_BATCH_MAX are taken
+ * @return
+ * Number of leading messages handled. The rest must be sent again, as the socket was busy or the batch was cut.
+ * -1 if the socket failed (it's closed then)
+ */
+int SendMSGBatch(int queue, char * const * messages, const char * const * locmsgs, const char * locs, logtarget * const * targets, unsigned int count);
+#endif
+
+#ifndef WIN32
+/**
+ * Batch of messages for the queue, filled by mq_batch_push() and sent by mq_batch_flush().
+ * The header of each location is formatted once, and shared by its consecutive messages.
+ */
+typedef struct {
+    int queue;                          ///< Queue socket. Update it after a reconnection.
+    char * arena;                       ///< Copy of the headers and the messages of the batch
+    size_t used;                        ///< Bytes used in the arena
+    struct iovec iov[2 * MQ_BATCH_MAX]; ///< Header and message segments of each message
+    unsigned int count;                 ///< Number of messages in the batch
+    unsigned int sent;                  ///< Messages already sent, if the last flush failed
+    char * locmsg;                      ///< Location of the current header
+    char loc;                           ///< Queue identifier of the current header
+    bool secure;                        ///< The current header is in the SECURE_MQ format
+    char header[OS_SIZE_8192 + 8];      ///< Current header
+    size_t header_len;                  ///< Length of the current header
+    ssize_t header_offset;              ///< Position of the current header in the arena, -1 if not copied yet
+} mq_batch_t;
+
+/**
+ * Allocate an empty batch.
+ * @param queue file descriptor of the queue
+ * @return Pointer to a new batch.
+ */
+mq_batch_t * mq_batch_init(int queue);
+
+/**
+ * Free a batch. Pending messages are discarded.
+ * @param batch Pointer to a batch, NULL is allowed.
+ */
+void mq_batch_free(mq_batch_t * batch);
+
+/**
+ * Format a message as SendMSG() does and add it to the batch. The batch is flushed first if it's full.
+ * @param batch Pointer to a batch.
+ * @param message string containing the message
+ * @param locmsg location of the message
+ * @param loc queue identifier
+ * @return
+ * 0 if the message was queued, or it was discarded as SendMSG() does (format error or keepalive)
+ * -1 if the socket failed while flushing a full batch. The message is not queued and the socket is closed.
+ */
+int mq_batch_push(mq_batch_t * batch, const char * message, const char * locmsg, char loc) __attribute__((nonnull));
+
+/**
+ * Send the messages of the batch at once, where the system allows it.
+ * As in SendMSG(), a message is discarded if the socket is busy.
+ * @param batch Pointer to a batch.
+ * @return
+ * 0 if the batch was sent and it's empty now
+ * -1 if the socket failed. The socket is closed, and the unsent messages are kept for the next flush.
+ */
+int mq_batch_flush(mq_batch_t * batch) __attribute__((nonnull));
+#endif
+
 void mq_log_builder_init();
 
 int mq_log_builder_update();
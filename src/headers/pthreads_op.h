@@ -34,9 +34,64 @@
 #define w_mutexattr_settype(x, y) { int error = pthread_mutexattr_settype(x, y); if (error) merror_exit("At pthread_mutexattr_settype(): %s", strerror(error)); }
 #define w_mutexattr_destroy(x) { int error = pthread_mutexattr_destroy(x); if (error) merror_exit("At pthread_mutexattr_destroy(): %s", strerror(error)); }
 
+#ifndef WIN32
+#define w_create_thread_affinity(x, y, z) if (!CreateThreadAffinity((void * (*) (void *))x, y, z)) merror_exit(THREAD_ERROR);
+
+/* Set of CPUs a group of threads runs on */
+typedef struct w_cpuset_s w_cpuset_t;
+#endif
+
 #ifndef WIN32
 int CreateThread(void * (*function_pointer)(void *), void * data) __attribute__((nonnull(1)));
 int CreateThreadJoinable(pthread_t *lthread, void * (*function_pointer)(void *), void *data);
+
+/**
+ * @brief Create a detached thread that runs on a set of CPUs from its start.
+ *
+ * @param function_pointer Thread function.
+ * @param data Thread argument.
+ * @param cpus CPUs of the thread. NULL leaves the placement to the scheduler.
+ * @return 1 on success, 0 on error.
+ */
+int CreateThreadAffinity(void * (*function_pointer)(void *), void * data, const w_cpuset_t * cpus) __attribute__((nonnull(1)));
+
+/**
+ * @brief Load a CPU set from the internal options.
+ *
+ * The option is a comma separated list of CPUs, ranges of CPUs and NUMA nodes,
+ * e.g. "0-7,32" or "node1". NUMA nodes are resolved through /sys, so the set
+ * has to be loaded before the chroot.
+ *
+ * @param high_name Option section.
+ * @param low_name Option name.
+ * @return The CPU set, NULL if the option is empty, invalid or not supported by the platform.
+ */
+w_cpuset_t * w_cpuset_load(const char * high_name, const char * low_name) __attribute__((nonnull));
+
+/**
+ * @brief Parse a CPU set.
+ *
+ * @param spec CPU list, as in the internal options.
+ * @return The CPU set, NULL if the list is empty or invalid.
+ */
+w_cpuset_t * w_cpuset_parse(const char * spec) __attribute__((nonnull));
+
+/**
+ * @brief Check if a CPU belongs to a set.
+ *
+ * @param cpus CPU set.
+ * @param cpu CPU number.
+ * @return true if the CPU is in the set.
+ */
+bool w_cpuset_contains(const w_cpuset_t * cpus, unsigned int cpu) __attribute__((nonnull));
+
+/**
+ * @brief Move the calling thread to a set of CPUs.
+ *
+ * @param cpus CPUs of the thread. NULL leaves the placement to the scheduler.
+ * @return 0 on success, -1 on error.
+ */
+int w_set_thread_affinity(const w_cpuset_t * cpus);
 #endif
 
 #endif
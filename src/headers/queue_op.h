@@ -31,6 +31,7 @@ typedef struct w_queue_s {
     pthread_cond_t available; ///> condition variable when queue is empty
     pthread_cond_t available_not_empty; ///> Condition variable when queue is full
     unsigned int elements; ///> counts the number of elements stored in the queue
+    unsigned int waiting; ///> Consumers waiting for elements
 } w_queue_t;
 
 /**
@@ -95,6 +96,17 @@ int queue_push_ex(w_queue_t * queue, void * data);
  * */
 int queue_push_ex_block(w_queue_t * queue, void * data);
 
+/**
+ * @brief Same as queue_push_ex but inserts up to n elements with a
+ * single lock. Consumers are only woken up if they are waiting.
+ *
+ * @param queue the queue
+ * @param data elements to be inserted, in FIFO order
+ * @param n number of elements to insert
+ * @return number of elements inserted, less than n if the queue got full
+ * */
+size_t queue_push_ex_batch(w_queue_t * queue, void ** data, size_t n);
+
 /**
  * @brief Retrieves next item in the queue
  * 
@@ -113,6 +125,17 @@ void * queue_pop(w_queue_t * queue);
  * */
 void * queue_pop_ex(w_queue_t * queue);
 
+/**
+ * @brief Same as queue_pop_ex but retrieves up to n elements with a
+ * single lock. If queue is empty THREAD WILL BLOCK
+ *
+ * @param queue the queue
+ * @param data array where the elements are stored, in FIFO order
+ * @param n maximum number of elements to retrieve
+ * @return number of elements retrieved, at least 1
+ * */
+size_t queue_pop_ex_batch(w_queue_t * queue, void ** data, size_t n);
+
 /**
  * @brief Same as queue_pop_ex but with a configured timeout for the
  * wait. If queue is empty THREAD WILL BLOCK
@@ -123,4 +146,16 @@ void * queue_pop_ex(w_queue_t * queue);
  * */
 void * queue_pop_ex_timedwait(w_queue_t * queue, const struct timespec * abstime);
 
+/**
+ * @brief Same as queue_pop_ex_batch but with a configured timeout for the
+ * wait. If queue is empty THREAD WILL BLOCK
+ *
+ * @param queue the queue
+ * @param data array where the elements are stored, in FIFO order
+ * @param n maximum number of elements to retrieve
+ * @param abstime timeout specification
+ * @return number of elements retrieved, 0 on timeout
+ * */
+size_t queue_pop_ex_batch_timedwait(w_queue_t * queue, void ** data, size_t n, const struct timespec * abstime);
+
 #endif // QUEUE_OP_H
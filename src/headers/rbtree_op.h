@@ -21,7 +21,7 @@ typedef enum rb_color { RB_RED, RB_BLACK } rb_color;
 
 /// Red-black tree node
 typedef struct rb_node {
-    char * key;                 ///< Node key
+    char * key;                 ///< Node key, stored in the same allocation as the node
     void * value;               ///< Pointer to value
     rb_color color;             ///< Node color
     struct rb_node * parent;    ///< Pointer to parent node
@@ -39,6 +39,7 @@ typedef struct rb_node {
 typedef struct rb_tree {
     rb_node * root;             ///< Pointer to root node
     void (*dispose)(void *);    ///< Pointer to function to dispose an element
+    unsigned size;              ///< Number of elements
 } rb_tree;
 
 /**
@@ -164,6 +165,44 @@ char ** rbtree_keys(const rb_tree * tree);
 
 char ** rbtree_range(const rb_tree * tree, const char * min, const char * max);
 
+/**
+ * @brief Get the node with the minimum key
+ *
+ * Together with rbtree_next(), it walks the tree in order without building an array:
+ * for (const rb_node * node = rbtree_first(tree); node; node = rbtree_next(node))
+ *
+ * @param tree Pointer to a red-black tree.
+ * @return Pointer to the first node.
+ * @retval NULL The tree is empty.
+ */
+
+const rb_node * rbtree_first(const rb_tree * tree);
+
+/**
+ * @brief Get the first node whose key is not less than a given key
+ *
+ * Use it with rbtree_next() to iterate over a range of keys.
+ *
+ * @param tree Pointer to a red-black tree.
+ * @param key Minimum key.
+ * @return Pointer to the node with the lowest key greater or equal than key.
+ * @retval NULL All the keys are less than key.
+ */
+
+const rb_node * rbtree_lower_bound(const rb_tree * tree, const char * key);
+
+/**
+ * @brief Get the node with the next key
+ *
+ * The tree must not be modified while it's being iterated.
+ *
+ * @param node Pointer to a node of the tree.
+ * @return Pointer to the node with the next key, in alphabetical order.
+ * @retval NULL node has the maximum key.
+ */
+
+const rb_node * rbtree_next(const rb_node * node);
+
 /**
  * @brief Get the black depth of a tree
  *
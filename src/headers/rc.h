@@ -27,9 +27,11 @@
 #define EXECD_HEADER                    "execd "
 #define FILE_UPDATE_HEADER              "up file "
 #define FILE_CLOSE_HEADER               "close file "
+#define FILE_PATCH_HEADER               "patch file "
 #define HC_STARTUP                      "agent startup "
 #define HC_SHUTDOWN                     "agent shutdown "
 #define HC_ACK                          "agent ack "
+#define HC_BATCH                        "batch "
 #define HC_SK_DB_COMPLETED              "syscheck-db-completed"
 #define HC_SK_RESTART                   "syscheck restart"
 #define HC_REQUEST                      "req "
@@ -47,6 +49,8 @@
 #define HC_FORCE_RECONNECT              "force_reconnect"
 #define HC_RESTART                      "restart"
 #define HC_GETCONFIG                    "getconfig"
+#define HC_GETSTATS                     "getstats"
+#define HC_GETMETRICS                   "getmetrics"
 #define HC_ERROR                        "err "
 #define HC_INVALID_VERSION_RESPONSE     "Agent version must be lower or equal to manager version"
 #define HC_INVALID_VERSION              "Incompatible version"
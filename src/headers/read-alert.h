@@ -16,6 +16,7 @@
 #define CRALERT_READ_ALL    0x004
 #define CRALERT_READ_FAILED 0x008
 #define CRALERT_FP_SET      0x010
+#define CRALERT_FILTERED    0x020
 
 /* File queue */
 typedef struct _alert_data {
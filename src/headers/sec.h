@@ -71,10 +71,11 @@ typedef struct _keystore {
     /* Array with all the keys */
     keyentry **keyentries;
 
-    /* Hashes, based on the ID/IP to look up the keys */
+    /* Hashes, based on the ID/IP/name to look up the keys */
     rb_tree *keytree_id;
     rb_tree *keytree_ip;
     rb_tree *keytree_sock;
+    rb_tree *keytree_name;
 
     /* Total key size */
     unsigned int keysize;
@@ -82,6 +83,7 @@ typedef struct _keystore {
     /* Key file stat */
     time_t file_change;
     ino_t inode;
+    off_t file_size;
 
     /* ID counter */
     int id_counter;
@@ -105,7 +107,7 @@ typedef enum key_states {
     KS_ENCKEY
 } key_states;
 
-#define KEYSTORE_INITIALIZER { NULL, NULL, NULL, NULL, 0, 0, 0, 0, { 0, 0 }, NULL, 0, NULL, PTHREAD_MUTEX_INITIALIZER }
+#define KEYSTORE_INITIALIZER { NULL, NULL, NULL, NULL, NULL, 0, 0, 0, 0, 0, { 0, 0 }, NULL, 0, NULL, PTHREAD_MUTEX_INITIALIZER }
 
 /** Function prototypes -- key management **/
 
@@ -126,6 +128,13 @@ int OS_CheckUpdateKeys(const keystore *keys) __attribute((nonnull));
 /* Update the keys if they changed on the system */
 void OS_UpdateKeys(keystore *keys) __attribute((nonnull));
 
+/* Read the keys file into a new keystore, with the same flags as keys */
+keystore * OS_LoadKeys(const keystore *keys) __attribute((nonnull));
+
+/* Replace the keys by a keystore from OS_LoadKeys, keeping the counters and network data.
+ * Returns the former keystore, to be released with OS_FreeKeys */
+keystore * OS_SwapKeys(keystore *keys, keystore *new_keys) __attribute((nonnull));
+
 /* Start counter for all agents */
 void OS_StartCounter(keystore *keys) __attribute((nonnull));
 
@@ -144,6 +153,16 @@ int OS_DeleteKey(keystore *keys, const char *id, int purge);
 /* Write keystore on client keys file */
 int OS_WriteKeys(const keystore *keys);
 
+/**
+ * @brief Append keys at the end of the client keys file, without rewriting it
+ *
+ * @param entries Array of key entries.
+ * @param count Number of entries.
+ * @retval 0 On success.
+ * @retval -1 On failure.
+ */
+int OS_AppendKeys(keyentry * const * entries, unsigned int count);
+
 /* Duplicate keystore except key hashes and file pointer */
 keystore* OS_DupKeys(const keystore *keys);
 
@@ -184,6 +203,16 @@ int OS_ReadTimestamps(keystore * keys);
  */
 int OS_WriteTimestamps(keystore * keys);
 
+/**
+ * @brief Append the timestamps of some keys at the end of the timestamps file
+ *
+ * @param entries Array of key entries.
+ * @param count Number of entries.
+ * @retval 0 On success.
+ * @retval -1 On failure.
+ */
+int OS_AppendTimestamps(keyentry * const * entries, unsigned int count);
+
 /** Function prototypes -- send/recv messages **/
 
 /* Decrypt and decompress a remote message */
@@ -293,6 +293,7 @@ extern const char *__local_name;
 #include "vector_op.h"
 #include "exec_op.h"
 #include "json_op.h"
+#include "strpool_op.h"
 #include "notify_op.h"
 #include "version_op.h"
 #include "utf8_op.h"
@@ -317,6 +318,9 @@ extern const char *__local_name;
 #include "enrollment_op.h"
 #include "buffer_op.h"
 #include "atomic.h"
+#include "token_bucket_op.h"
+#include "metrics_op.h"
+#include "delta_op.h"
 #include "binaries_op.h"
 #include "logging_helper.h"
 #include "../shared_modules/rsync/include/rsync.h"
@@ -20,9 +20,18 @@ typedef struct _OSStoreNode {
     void *data;
     char *key;
     size_t key_size;
+
+    /* Hash index */
+    struct _OSStoreNode *hash_next;
+    unsigned int hash;
+    /* 1-based position in key order */
+    int position;
 } OSStoreNode;
 
-/* Store list */
+/* Store list
+ * Keys are indexed by hash. The list keeps the insertion order until it is
+ * traversed or a position is requested, then it's sorted by key once.
+ */
 typedef struct _OSStore {
     OSStoreNode *first_node;
     OSStoreNode *last_node;
@@ -32,6 +41,16 @@ typedef struct _OSStore {
     int max_size;
 
     void (*free_data_function)(void *data);
+
+    OSStoreNode **table;
+    unsigned int table_size;
+    /* Distinct key sizes, ascending, to look up the prefixes of a key */
+    size_t *key_sizes;
+    unsigned int key_sizes_count;
+    /* The list is in key order and the positions are up to date */
+    int key_sorted;
+    /* The list was sorted by data with OSStore_Sort() */
+    int data_sorted;
 } OSStore;
 
 OSStore *OSStore_Create(void);
@@ -0,0 +1,106 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Interned string pool: each distinct string is stored once and shared by
+ * reference counting, so interned strings can be compared by pointer.
+ */
+
+#ifndef STRPOOL_OP_H
+#define STRPOOL_OP_H
+
+#include <pthread.h>
+#include <stddef.h>
+
+#define STRPOOL_STRIPES     16      ///< Independently locked parts of a pool
+#define STRPOOL_BUCKETS     64      ///< Initial buckets of each stripe
+
+/* Interned string */
+typedef struct w_strpool_entry_t {
+    struct w_strpool_entry_t *next;
+    unsigned int hash;
+    unsigned int refs;
+    char str[];
+} w_strpool_entry_t;
+
+/* Part of the pool with its own lock and chained table */
+typedef struct w_strpool_stripe_t {
+    pthread_mutex_t mutex;
+    w_strpool_entry_t **buckets;
+    unsigned int size;              ///< Number of buckets, a power of two
+    unsigned int elements;
+} w_strpool_stripe_t;
+
+typedef struct w_strpool_t {
+    w_strpool_stripe_t stripes[STRPOOL_STRIPES];
+} w_strpool_t;
+
+/**
+ * @brief Create a string pool.
+ *
+ * @return Pointer to the new pool.
+ */
+w_strpool_t * w_strpool_init(void);
+
+/**
+ * @brief Destroy a string pool.
+ *
+ * Every string of the pool is freed, even if some reference is still held.
+ *
+ * @param pool Pool to destroy.
+ */
+void w_strpool_free(w_strpool_t * pool);
+
+/**
+ * @brief Get the interned copy of a string, adding a reference to it.
+ *
+ * The returned string is shared and must not be modified. Release it with
+ * w_strpool_release(). If pool is NULL, this function returns a private copy
+ * that w_strpool_release() frees, so callers work the same with and without a pool.
+ *
+ * @param pool Pool, or NULL.
+ * @param str String to intern.
+ * @return Interned string. NULL if str is NULL.
+ */
+char * w_strpool_get(w_strpool_t * pool, const char * str);
+
+/**
+ * @brief Get the interned copy of the first length bytes of a string.
+ *
+ * @param pool Pool, or NULL.
+ * @param str String to intern. It does not need to be NUL-terminated.
+ * @param length Number of bytes of str.
+ * @return Interned string.
+ */
+char * w_strpool_getn(w_strpool_t * pool, const char * str, size_t length);
+
+/**
+ * @brief Add a reference to a string returned by w_strpool_get().
+ *
+ * @param pool Pool the string belongs to, or NULL.
+ * @param str Interned string.
+ * @return str itself, or a private copy if pool is NULL. NULL if str is NULL.
+ */
+char * w_strpool_ref(w_strpool_t * pool, char * str);
+
+/**
+ * @brief Drop a reference to an interned string. It's freed with its last reference.
+ *
+ * @param pool Pool the string belongs to, or NULL.
+ * @param str Interned string. Nothing is done if it's NULL.
+ */
+void w_strpool_release(w_strpool_t * pool, char * str);
+
+/**
+ * @brief Get the number of distinct strings of a pool.
+ *
+ * @param pool Pool.
+ * @return Number of strings.
+ */
+size_t w_strpool_count(w_strpool_t * pool);
+
+#endif /* STRPOOL_OP_H */
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/**
+ * @file token_bucket_op.h
+ * @brief Lock-free token bucket rate limiter
+ *
+ * The bucket is kept as the theoretical arrival time of the next event (GCRA),
+ * so it refills continuously instead of once per second and a single
+ * compare-and-swap updates it from any number of threads.
+ */
+
+#ifndef TOKEN_BUCKET_OP_H
+#define TOKEN_BUCKET_OP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define W_TOKEN_BUCKET_INITIALIZER { .tat = 0 }
+
+/* Events allowed in a row before the rate applies: a tenth of a second worth of them */
+#define W_TOKEN_BUCKET_BURST(rate) ((rate) / 10 ? (rate) / 10 : 1)
+
+typedef struct w_token_bucket_s {
+    volatile int64_t tat;   ///< Theoretical arrival time of the next event, in nanoseconds
+} w_token_bucket_t;
+
+/**
+ * @brief Take a token from the bucket.
+ *
+ * @param bucket Token bucket.
+ * @param rate Tokens per second. 0 means no limit.
+ * @param burst Tokens that can be taken in a row without waiting.
+ * @return Nanoseconds the caller has to wait before going on, 0 if it can go on now.
+ */
+int64_t w_token_bucket_take(w_token_bucket_t *bucket, unsigned int rate, unsigned int burst);
+
+/**
+ * @brief Take a token from the bucket, sleeping until it is available.
+ *
+ * @param bucket Token bucket.
+ * @param rate Tokens per second. 0 means no limit.
+ * @param burst Tokens that can be taken in a row without waiting.
+ * @retval true The caller was throttled.
+ * @retval false The token was available.
+ */
+bool w_token_bucket_wait(w_token_bucket_t *bucket, unsigned int rate, unsigned int burst);
+
+#endif /* TOKEN_BUCKET_OP_H */
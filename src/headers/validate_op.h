@@ -16,6 +16,7 @@
 
 /* Run-time definitions */
 int getDefine_Int(const char *high_name, const char *low_name, int min, int max) __attribute__((nonnull));
+char *getDefine_String(const char *high_name, const char *low_name) __attribute__((nonnull));
 
 
 /**
@@ -38,6 +39,48 @@ int OS_IPFound(const char *ip_address, const os_ip *that_ip) __attribute__((nonn
 int OS_IPFoundList(const char *ip_address, os_ip **list_of_ips);// __attribute__((nonnull));
 
 
+/* Node of a binary radix tree of address prefixes */
+typedef struct os_iptree_node {
+    struct os_iptree_node *child[2];
+    bool prefix;                        // The path to this node is a prefix of the tree
+} os_iptree_node;
+
+/* Prefixes of a list of IP addresses, one tree for each family */
+typedef struct os_iptree {
+    os_iptree_node *ipv4;
+    os_iptree_node *ipv6;
+} os_iptree;
+
+
+/**
+ * @brief Build a tree from a list of IP addresses, to look them up in a time that doesn't depend on the list size
+ *
+ * @param list_of_ips List of os_ip struct, NULL terminated.
+ * @return Tree of the prefixes of the list, or NULL if the list is NULL or it has negated entries,
+ *         which must be checked with OS_IPFoundList().
+ */
+os_iptree *OS_IPTreeBuild(os_ip **list_of_ips);
+
+
+/**
+ * @brief Check if an address is covered by a prefix of the tree, as OS_IPFoundList() does with the list
+ *
+ * @param tree Tree built by OS_IPTreeBuild().
+ * @param address Address in network byte order (4 bytes for IPv4, 16 bytes for IPv6).
+ * @param is_ipv6 Family of the address.
+ * @return Returns 1 on success or 0 on failure.
+ */
+int OS_IPFoundTree(const os_iptree *tree, const void *address, bool is_ipv6) __attribute__((nonnull));
+
+
+/**
+ * @brief Free a tree built by OS_IPTreeBuild()
+ *
+ * @param tree Tree to free, NULL is allowed.
+ */
+void OS_IPTreeFree(os_iptree *tree);
+
+
 /**
  * @brief Validate if an IP address is in the right format
  *
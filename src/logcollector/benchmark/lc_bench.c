@@ -0,0 +1,511 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Throughput benchmark of the logcollector readers.
+ * A writer thread appends events to a file of a temporary directory, at a
+ * given rate and rotating it by renaming. The file is read by the real
+ * read_syslog, read_json or read_multiline_regex functions and the events
+ * go through the output queue and thread to a socket, where the delay since
+ * each event was written is measured.
+ */
+
+#ifdef ARGV0
+#undef ARGV0
+#endif
+#define ARGV0 "wazuh-logcollector-bench"
+
+#include "shared.h"
+#include "../logcollector.h"
+#include "../state.h"
+
+#define BENCH_EVENTS            100000
+#define BENCH_SIZE              256
+#define BENCH_FILE              "bench.log"
+#define BENCH_ROTATED_FILE      "bench.log.1"
+#define BENCH_WRITE_BUFFER      OS_SIZE_65536
+#define BENCH_MULTILINE_LINES   4   // Lines of each multi-line event
+#define BENCH_MULTILINE_REGEX   "^bench "
+#define BENCH_IDLE_TIMEOUT      5   // Seconds without events before giving up
+
+typedef enum bench_format_t {
+    BENCH_SYSLOG,
+    BENCH_JSON,
+    BENCH_MULTILINE
+} bench_format_t;
+
+extern OSHash * files_status;
+
+static const char * const format_names[] = { "syslog", "json", MULTI_LINE_REGEX };
+
+static bench_format_t format = BENCH_SYSLOG;
+static int events = BENCH_EVENTS;
+static size_t event_size = BENCH_SIZE;
+static int rate;
+static int rotate;
+static int batch = 1;
+
+static int writer_done;
+static unsigned long long bytes_written;
+static unsigned long long received;
+static unsigned long long * latencies;
+static int output_socket[2];
+static char *filler;
+
+__attribute__((noreturn))
+static void help_bench()
+{
+    print_header();
+    print_out("  %s: -[hd] [-f format] [-n events] [-s size] [-r rate] [-R events] [-b batch]", ARGV0);
+    print_out("    -h          This help message");
+    print_out("    -d          Execute in debug mode. This parameter");
+    print_out("                can be specified multiple times");
+    print_out("                to increase the debug level.");
+    print_out("    -f <format> Log format: syslog, json or %s (default: syslog)", MULTI_LINE_REGEX);
+    print_out("    -n <n>      Number of events (default: %d)", BENCH_EVENTS);
+    print_out("    -s <n>      Size of the events (default: %d)", BENCH_SIZE);
+    print_out("    -r <n>      Events written per second, 0 for no limit (default: 0)");
+    print_out("    -R <n>      Rotate the file every n events, 0 to never rotate it (default: 0)");
+    print_out("    -b <n>      Messages sent to the socket at once (default: 1)");
+    print_out(" ");
+    exit(1);
+}
+
+static unsigned long long bench_nsec(const struct timespec *t0, const struct timespec *t1) {
+    return (unsigned long long)(t1->tv_sec - t0->tv_sec) * 1000000000ULL + (unsigned long long)t1->tv_nsec - (unsigned long long)t0->tv_nsec;
+}
+
+static unsigned long long bench_now() {
+    static const struct timespec zero;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return bench_nsec(&zero, &now);
+}
+
+static int bench_cmp(const void *a, const void *b) {
+    const unsigned long long x = *(const unsigned long long *)a;
+    const unsigned long long y = *(const unsigned long long *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Options of the output queue, read by the logcollector functions */
+static void bench_write_options() {
+    FILE *fp;
+
+    if (mkdir_ex("etc") < 0) {
+        merror_exit("Couldn't create the working directory.");
+    }
+
+    if (fp = fopen(OSSEC_DEFINES, "w"), !fp) {
+        merror_exit(FOPEN_ERROR, OSSEC_DEFINES, errno, strerror(errno));
+    }
+
+    fprintf(fp, "logcollector.queue_size=%d\n", OUTPUT_MIN_QUEUE_SIZE * 8);
+    fprintf(fp, "logcollector.output_batch=%d\n", batch);
+    fprintf(fp, "logcollector.ip_update_interval=0\n");
+    fclose(fp);
+}
+
+/* An event of about event_size bytes, with the time it was written */
+static size_t bench_event(char *buffer, int seq) {
+    const int padding = event_size > 64 ? (int)event_size - 64 : 1;
+    const unsigned long long now = bench_now();
+    size_t length = 0;
+    int i;
+
+    switch (format) {
+    case BENCH_SYSLOG:
+        length = sprintf(buffer, "Oct 14 10:00:00 bench app[%d]: t=%llu %.*s\n", seq, now, padding, filler);
+        break;
+    case BENCH_JSON:
+        length = sprintf(buffer, "{\"timestamp\":\"t=%llu\",\"seq\":%d,\"msg\":\"%.*s\"}\n", now, seq, padding, filler);
+        break;
+    case BENCH_MULTILINE:
+        length = sprintf(buffer, "bench t=%llu seq=%d\n", now, seq);
+
+        for (i = 1; i < BENCH_MULTILINE_LINES; i++) {
+            length += sprintf(buffer + length, "  %.*s\n", padding / (BENCH_MULTILINE_LINES - 1) + 1, filler);
+        }
+        break;
+    }
+
+    return length;
+}
+
+static void bench_flush(int fd, const char *buffer, size_t *used) {
+    if (*used > 0 && write(fd, buffer, *used) != (ssize_t)*used) {
+        merror_exit("Couldn't write to '%s': %s (%d)", BENCH_FILE, strerror(errno), errno);
+    }
+
+    bytes_written += *used;
+    *used = 0;
+}
+
+static int bench_open_output() {
+    int fd;
+
+    if (fd = open(BENCH_FILE, O_WRONLY | O_CREAT | O_APPEND, 0640), fd < 0) {
+        merror_exit(FOPEN_ERROR, BENCH_FILE, errno, strerror(errno));
+    }
+
+    return fd;
+}
+
+static void *bench_writer(__attribute__((unused)) void *arg) {
+    const unsigned long long start = bench_now();
+    char *buffer;
+    size_t used = 0;
+    int in_file = 0;
+    int fd = bench_open_output();
+    int i;
+
+    os_malloc(BENCH_WRITE_BUFFER, buffer);
+
+    for (i = 0; i < events; i++) {
+        if (rate > 0) {
+            const unsigned long long due = start + (unsigned long long)i * 1000000000ULL / rate;
+            const unsigned long long now = bench_now();
+
+            if (now < due) {
+                const struct timespec delay = { (due - now) / 1000000000ULL, (due - now) % 1000000000ULL };
+
+                bench_flush(fd, buffer, &used);
+                nanosleep(&delay, NULL);
+            }
+        }
+
+        if (rotate > 0 && in_file == rotate) {
+            bench_flush(fd, buffer, &used);
+            close(fd);
+
+            if (rename(BENCH_FILE, BENCH_ROTATED_FILE) < 0) {
+                merror_exit(RENAME_ERROR, BENCH_FILE, BENCH_ROTATED_FILE, errno, strerror(errno));
+            }
+
+            fd = bench_open_output();
+            in_file = 0;
+        }
+
+        if (used + OS_MAXSTR > BENCH_WRITE_BUFFER) {
+            bench_flush(fd, buffer, &used);
+        }
+
+        used += bench_event(buffer + used, i);
+        in_file++;
+    }
+
+    bench_flush(fd, buffer, &used);
+    close(fd);
+    os_free(buffer);
+
+    __atomic_store_n(&writer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+/* Messages sent by the output thread, as wazuh-agentd would read them */
+static void *bench_receiver(__attribute__((unused)) void *arg) {
+    char buffer[OS_MAXSTR + OS_SIZE_256];
+    ssize_t length;
+
+    while (__atomic_load_n(&received, __ATOMIC_RELAXED) < (unsigned long long)events) {
+        if (length = recv(output_socket[1], buffer, sizeof(buffer) - 1, 0), length <= 0) {
+            continue;
+        }
+
+        const unsigned long long now = bench_now();
+        const char *stamp;
+
+        buffer[length] = '\0';
+
+        if (stamp = strstr(buffer, "t="), stamp) {
+            latencies[received] = now - strtoull(stamp + 2, NULL, 10);
+            __atomic_add_fetch(&received, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    return NULL;
+}
+
+static void bench_open_input(logreader *lf) {
+    struct stat buf;
+
+    if (lf->fp = fopen(BENCH_FILE, "r"), !lf->fp) {
+        merror_exit(FOPEN_ERROR, BENCH_FILE, errno, strerror(errno));
+    }
+
+    if (fstat(fileno(lf->fp), &buf) < 0) {
+        merror_exit(FSTAT_ERROR, BENCH_FILE, errno, strerror(errno));
+    }
+
+    lf->fd = buf.st_ino;
+    lf->dev = buf.st_dev;
+
+    if (lf->multiline) {
+        lf->multiline->offset_last_read = 0;
+    }
+}
+
+/* Read until the end of the file, returns the bytes read */
+static int64_t bench_read(logreader *lf, unsigned long long *cpu_nsec) {
+    const int64_t start = w_ftell(lf->fp);
+    int64_t position = start;
+    int64_t previous;
+    int r = 0;
+
+    do {
+        struct timespec t0;
+        struct timespec t1;
+        struct timespec w0;
+        struct timespec w1;
+
+        previous = position;
+
+        gettime(&w0);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+        lf->read(lf, &r, 0);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+        gettime(&w1);
+
+        w_logcollector_state_update_read(lf->file, (uint64_t)(time_diff(&w0, &w1) * 1000000));
+        *cpu_nsec += bench_nsec(&t0, &t1);
+        clearerr(lf->fp);
+        position = w_ftell(lf->fp);
+    } while (position > previous);
+
+    return position - start;
+}
+
+/* The file was rotated when other file has its name */
+static int bench_rotated(const logreader *lf) {
+    struct stat buf;
+
+    return stat(BENCH_FILE, &buf) == 0 && buf.st_ino != lf->fd;
+}
+
+int main(int argc, char **argv)
+{
+    char home_path[] = "/tmp/wazuh-logcollector-bench-XXXXXX";
+    logtarget targets[2] = { { .log_socket = &default_agent } };
+    w_multiline_config_t multiline = { .match_type = ML_MATCH_START, .replace_type = ML_REPLACE_NO_REPLACE, .timeout = 1 };
+    logreader lf = { .file = BENCH_FILE, .log_target = targets };
+    pthread_t writer;
+    pthread_t receiver;
+    struct rusage usage;
+    unsigned long long cpu_nsec = 0;
+    unsigned long long start;
+    unsigned long long idle_since;
+    unsigned long long seen = 0;
+    double wall;
+    double megabytes;
+    double cpu;
+    cJSON *state;
+    char *state_str;
+    int c;
+
+    /* Set the name */
+    OS_SetName(ARGV0);
+
+    while ((c = getopt(argc, argv, "hdf:n:s:r:R:b:")) != -1) {
+        switch (c) {
+            case 'h':
+                help_bench();
+                break;
+            case 'd':
+                nowDebug();
+                break;
+            case 'f':
+                for (format = BENCH_SYSLOG; format <= BENCH_MULTILINE && strcmp(optarg, format_names[format]) != 0; format++);
+
+                if (format > BENCH_MULTILINE) {
+                    merror_exit("-f needs syslog, json or %s", MULTI_LINE_REGEX);
+                }
+                break;
+            case 'n':
+                if (events = atoi(optarg), events < 1) {
+                    merror_exit("-n needs a positive number");
+                }
+                break;
+            case 's':
+                if (event_size = (size_t)atol(optarg), event_size < 1 || event_size > OS_MAXSTR / 2) {
+                    merror_exit("-s needs a number between 1 and %d", OS_MAXSTR / 2);
+                }
+                break;
+            case 'r':
+                if (rate = atoi(optarg), rate < 0) {
+                    merror_exit("-r needs a non-negative number");
+                }
+                break;
+            case 'R':
+                if (rotate = atoi(optarg), rotate < 0) {
+                    merror_exit("-R needs a non-negative number");
+                }
+                break;
+            case 'b':
+                if (batch = atoi(optarg), batch < 1 || batch > MQ_BATCH_MAX) {
+                    merror_exit("-b needs a number between 1 and %d", MQ_BATCH_MAX);
+                }
+                break;
+            default:
+                help_bench();
+                break;
+        }
+    }
+
+    if (!mkdtemp(home_path)) {
+        merror_exit("Couldn't create a temporary directory: %s (%d)", strerror(errno), errno);
+    }
+
+    if (chdir(home_path) == -1) {
+        merror_exit(CHDIR_ERROR, home_path, errno, strerror(errno));
+    }
+
+    bench_write_options();
+
+    /* Log-like text, without the characters that JSON escapes */
+    os_malloc(event_size + 1, filler);
+
+    for (size_t k = 0; k < event_size; k++) {
+        filler[k] = "abcdefghij klmnop- 0123456789 qrstuvwxyz"[(k * 7 + k / 13) % 40];
+    }
+
+    filler[event_size] = '\0';
+
+    /* Reader */
+    maximum_lines = 10000;
+    sample_log_length = 64;
+    os_strdup(format_names[format], lf.logformat);
+
+    switch (format) {
+    case BENCH_SYSLOG:
+        lf.read = read_syslog;
+        break;
+    case BENCH_JSON:
+        lf.read = read_json;
+        break;
+    case BENCH_MULTILINE:
+        w_calloc_expression_t(&multiline.regex, EXP_TYPE_PCRE2);
+
+        if (!w_expression_compile(multiline.regex, BENCH_MULTILINE_REGEX, 0)) {
+            merror_exit("Couldn't compile the multi-line regex '%s'", BENCH_MULTILINE_REGEX);
+        }
+
+        lf.multiline = &multiline;
+        lf.read = read_multiline_regex;
+        break;
+    }
+
+    if (files_status = OSHash_Create(), !files_status) {
+        merror_exit(HCREATE_ERROR, "file_status");
+    }
+
+    OSHash_SetFreeDataPointer(files_status, (void (*)(void *))free);
+    w_logcollector_state_init(LC_STATE_GLOBAL, false);
+    w_logcollector_state_add_file(lf.file);
+
+    /* Output queue and thread, sending to a socket of ours */
+    if (socketpair(AF_UNIX, SOCK_DGRAM, 0, output_socket) < 0) {
+        merror_exit("Couldn't create a socket pair: %s (%d)", strerror(errno), errno);
+    }
+
+    logr_queue = output_socket[0];
+    mq_log_builder_init();
+    w_msg_hash_queues_init();
+    w_msg_hash_queues_add_entry("agent");
+    w_create_output_threads();
+    set_can_read(1);
+
+    os_calloc(events, sizeof(unsigned long long), latencies);
+
+    if (pthread_create(&receiver, NULL, bench_receiver, NULL) != 0) {
+        merror_exit(THREAD_ERROR);
+    }
+
+    close(bench_open_output());
+    bench_open_input(&lf);
+
+    print_out("Reading %d %s events of %zu bytes, %s%s.", events, format_names[format], event_size,
+              rate > 0 ? "at a limited rate" : "as fast as possible", rotate > 0 ? ", with rotations" : "");
+
+    start = bench_now();
+    idle_since = start;
+
+    if (pthread_create(&writer, NULL, bench_writer, NULL) != 0) {
+        merror_exit(THREAD_ERROR);
+    }
+
+    while (__atomic_load_n(&received, __ATOMIC_RELAXED) < (unsigned long long)events) {
+        const unsigned long long now = bench_now();
+
+        if (bench_read(&lf, &cpu_nsec) == 0) {
+            if (bench_rotated(&lf)) {
+                // Lines written before the rename are left in the previous file
+                bench_read(&lf, &cpu_nsec);
+                fclose(lf.fp);
+                free(OSHash_Delete_ex(files_status, lf.file));
+                bench_open_input(&lf);
+                continue;
+            }
+
+            usleep(1000);
+        }
+
+        if (__atomic_load_n(&received, __ATOMIC_RELAXED) > seen) {
+            seen = __atomic_load_n(&received, __ATOMIC_RELAXED);
+            idle_since = now;
+        } else if (__atomic_load_n(&writer_done, __ATOMIC_ACQUIRE) && now - idle_since > BENCH_IDLE_TIMEOUT * 1000000000ULL) {
+            mwarn("Only %llu of %d events arrived.", seen, events);
+            break;
+        }
+    }
+
+    wall = (bench_now() - start) / 1e9;
+    megabytes = bytes_written / 1048576.0;
+    seen = __atomic_load_n(&received, __ATOMIC_RELAXED);
+    pthread_join(writer, NULL);
+
+    if (seen < (unsigned long long)events) {
+        pthread_cancel(receiver);
+    }
+
+    pthread_join(receiver, NULL);
+    getrusage(RUSAGE_SELF, &usage);
+    cpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    qsort(latencies, seen, sizeof(unsigned long long), bench_cmp);
+
+    print_out(" ");
+    print_out("Events:          %llu of %d (%.1f MB)", seen, events, megabytes);
+    print_out("Wall time:       %.3f s", wall);
+    print_out("Throughput:      %.0f events/s", wall > 0 ? seen / wall : 0.0);
+    print_out("Reader CPU:      %.2f ms/MB", megabytes > 0 ? cpu_nsec / 1e6 / megabytes : 0.0);
+    print_out("Process CPU:     %.2f ms/MB", megabytes > 0 ? cpu * 1e3 / megabytes : 0.0);
+
+    if (seen > 0) {
+        print_out("Latency:         p50 %.3f ms, p99 %.3f ms, max %.3f ms", latencies[seen / 2] / 1e6,
+                  latencies[seen * 99 / 100] / 1e6, latencies[seen - 1] / 1e6);
+    }
+
+    /* The statistics of the file, as shown by wazuh-logcollector */
+    if (state = w_logcollector_state_get(), state) {
+        state_str = cJSON_PrintUnformatted(state);
+        print_out("State:           %s", state_str);
+        os_free(state_str);
+        cJSON_Delete(state);
+    }
+
+    os_free(latencies);
+    os_free(filler);
+    os_free(lf.logformat);
+
+    if (chdir("/") == 0) {
+        rmdir_ex(home_path);
+    }
+
+    return seen < (unsigned long long)events ? 1 : 0;
+}
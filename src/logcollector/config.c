@@ -52,6 +52,7 @@ int LogCollectorConfig(const char *cfgfile)
     reload_delay = getDefine_Int("logcollector", "reload_delay", 0, 30000);
     free_excluded_files_interval = getDefine_Int("logcollector", "exclude_files_interval", 1, 172800);
     state_interval = getDefine_Int("logcollector", "state_interval", 0, 3600);
+    file_watch = getDefine_Int("logcollector", "file_watch", 0, 1);
 
     /* Current and total files counter */
     total_files = 0;
@@ -65,6 +66,10 @@ int LogCollectorConfig(const char *cfgfile)
     nofile = getDefine_Int("logcollector", "rlimit_nofile", 1024, 1048576);
 #endif
 
+#if defined(WIN32) && defined(EVENTCHANNEL_SUPPORT)
+    eventchannel_batch = getDefine_Int("logcollector", "eventchannel_batch", 0, 1024);
+#endif
+
     if (maximum_lines > 0 && maximum_lines < 100) {
         merror("Definition 'logcollector.max_lines' must be 0 or 100..1000000.");
         return OS_INVALID;
@@ -329,6 +334,7 @@ cJSON *getLogcollectorInternalOptions(void) {
     cJSON_AddNumberToObject(logcollector,"reload_delay",reload_delay);
     cJSON_AddNumberToObject(logcollector, "exclude_files_interval", free_excluded_files_interval);
     cJSON_AddNumberToObject(logcollector, "state_interval", state_interval);
+    cJSON_AddNumberToObject(logcollector, "file_watch", file_watch);
 
 #ifndef WIN32
     cJSON_AddNumberToObject(logcollector,"rlimit_nofile",nofile);
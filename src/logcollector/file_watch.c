@@ -0,0 +1,250 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Event-driven tailing of the monitored files.
+ * A thread reads the inotify events, counts them in a slot of each watch
+ * descriptor and wakes up the input threads. These only read the watched
+ * files whose slot changed. Files without a watch are polled as before.
+ */
+
+#include "shared.h"
+#include "logcollector.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+
+#define FILE_WATCH_SLOTS    4096
+#define FILE_WATCH_MASK     (IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF)
+#define FILE_WATCH_DIR_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MOVE_SELF | IN_DELETE_SELF | IN_ONLYDIR)
+
+/* Network filesystems, where other hosts' writes raise no events */
+#define FILE_WATCH_NFS      0x6969
+#define FILE_WATCH_SMB      0x517B
+#define FILE_WATCH_CIFS     0xFF534D42
+#define FILE_WATCH_SMB2     0xFE534D42
+#define FILE_WATCH_FUSE     0x65735546
+#define FILE_WATCH_CEPH     0x00C36400
+
+static int watch_fd = -1;
+static unsigned int watch_events[FILE_WATCH_SLOTS];   // Events of the watches mapped to each slot
+static unsigned int watch_wakeups;
+static pthread_mutex_t watch_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t watch_cond = PTHREAD_COND_INITIALIZER;
+
+static unsigned int * w_file_watch_slot(int wd) {
+    return &watch_events[(unsigned int)wd % FILE_WATCH_SLOTS];
+}
+
+static int w_file_watch_remote(const struct statfs * fs) {
+    switch ((unsigned long)fs->f_type) {
+    case FILE_WATCH_NFS:
+    case FILE_WATCH_SMB:
+    case FILE_WATCH_CIFS:
+    case FILE_WATCH_SMB2:
+    case FILE_WATCH_FUSE:
+    case FILE_WATCH_CEPH:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void * w_file_watch_main(__attribute__((unused)) void * args) {
+    char buffer[OS_SIZE_8192] __attribute__((aligned(__alignof__(struct inotify_event))));
+    const struct inotify_event * event;
+    ssize_t length;
+
+    while (1) {
+        if (length = read(watch_fd, buffer, sizeof(buffer)), length <= 0) {
+            if (length < 0 && errno != EINTR) {
+                merror("Couldn't read file events: %s (%d)", strerror(errno), errno);
+                sleep(loop_timeout);
+            }
+
+            continue;
+        }
+
+        for (char * ptr = buffer; ptr < buffer + length; ptr += sizeof(struct inotify_event) + event->len) {
+            event = (const struct inotify_event *)ptr;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                // Events were lost: every watched file must be checked
+                mdebug1("File events queue overflowed.");
+
+                for (int i = 0; i < FILE_WATCH_SLOTS; i++) {
+                    __atomic_add_fetch(&watch_events[i], 1, __ATOMIC_RELAXED);
+                }
+            } else if (event->wd > 0) {
+                __atomic_add_fetch(w_file_watch_slot(event->wd), 1, __ATOMIC_RELAXED);
+            }
+        }
+
+        w_mutex_lock(&watch_mutex);
+        watch_wakeups++;
+        pthread_cond_broadcast(&watch_cond);
+        w_mutex_unlock(&watch_mutex);
+    }
+
+    return NULL;
+}
+
+int w_file_watch_init() {
+    if (!file_watch) {
+        return 0;
+    }
+
+    if (watch_fd = inotify_init1(IN_CLOEXEC), watch_fd < 0) {
+        mwarn("Couldn't start watching files, they will be polled: %s (%d)", strerror(errno), errno);
+        return 0;
+    }
+
+    w_create_thread(w_file_watch_main, NULL);
+    mdebug1("Watching the files for changes.");
+    return 1;
+}
+
+int w_file_watch_enabled() {
+    return watch_fd >= 0;
+}
+
+void w_file_watch_add(logreader * lf) {
+    struct statfs fs;
+    int wd;
+
+    if (watch_fd < 0 || !(lf && lf->fp && lf->file)) {
+        return;
+    }
+
+    w_file_watch_remove(lf);
+
+    if (fstatfs(fileno(lf->fp), &fs) == 0 && w_file_watch_remote(&fs)) {
+        mdebug2("File '%s' is on a network filesystem, it will be polled.", lf->file);
+        return;
+    }
+
+    if (wd = inotify_add_watch(watch_fd, lf->file, FILE_WATCH_MASK), wd < 0) {
+        mdebug1("Couldn't watch file '%s', it will be polled: %s (%d)", lf->file, strerror(errno), errno);
+        return;
+    }
+
+    lf->wd = wd;
+
+    // The file is read once, as its content is not known yet
+    lf->wd_events = __atomic_load_n(w_file_watch_slot(wd), __ATOMIC_RELAXED) - 1;
+}
+
+int w_file_watch_add_dir(const char * path) {
+    struct statfs fs;
+    int wd;
+
+    if (watch_fd < 0 || (statfs(path, &fs) == 0 && w_file_watch_remote(&fs))) {
+        return 0;
+    }
+
+    if (wd = inotify_add_watch(watch_fd, path, FILE_WATCH_DIR_MASK), wd < 0) {
+        mdebug2("Couldn't watch directory '%s', its pattern will be expanded every time: %s (%d)", path, strerror(errno), errno);
+        return 0;
+    }
+
+    return wd;
+}
+
+unsigned int w_file_watch_events(int wd) {
+    return __atomic_load_n(w_file_watch_slot(wd), __ATOMIC_RELAXED);
+}
+
+void w_file_watch_remove(logreader * lf) {
+    if (lf && lf->wd > 0) {
+        if (watch_fd >= 0) {
+            inotify_rm_watch(watch_fd, lf->wd);
+        }
+
+        lf->wd = 0;
+    }
+}
+
+int w_file_watch_changed(logreader * lf) {
+    unsigned int events;
+
+    if (lf->wd <= 0) {
+        return 1;
+    }
+
+    if (events = __atomic_load_n(w_file_watch_slot(lf->wd), __ATOMIC_RELAXED), events == lf->wd_events) {
+        return 0;
+    }
+
+    lf->wd_events = events;
+    return 1;
+}
+
+void w_file_watch_pending(logreader * lf) {
+    if (lf->wd > 0) {
+        lf->wd_events--;
+    }
+}
+
+void w_file_watch_wait(int timeout) {
+    static __thread unsigned int seen;
+    struct timespec deadline;
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout;
+
+    w_mutex_lock(&watch_mutex);
+
+    while (seen == watch_wakeups) {
+        if (pthread_cond_timedwait(&watch_cond, &watch_mutex, &deadline) != 0) {
+            break;
+        }
+    }
+
+    seen = watch_wakeups;
+    w_mutex_unlock(&watch_mutex);
+}
+
+#else
+
+/* Files are polled in the other platforms */
+
+int w_file_watch_init() {
+    return 0;
+}
+
+int w_file_watch_enabled() {
+    return 0;
+}
+
+void w_file_watch_add(__attribute__((unused)) logreader * lf) {
+}
+
+int w_file_watch_add_dir(__attribute__((unused)) const char * path) {
+    return 0;
+}
+
+unsigned int w_file_watch_events(__attribute__((unused)) int wd) {
+    return 0;
+}
+
+void w_file_watch_remove(__attribute__((unused)) logreader * lf) {
+}
+
+int w_file_watch_changed(__attribute__((unused)) logreader * lf) {
+    return 1;
+}
+
+void w_file_watch_pending(__attribute__((unused)) logreader * lf) {
+}
+
+void w_file_watch_wait(int timeout) {
+    sleep(timeout);
+}
+
+#endif
@@ -0,0 +1,65 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All right reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#ifndef JOURNALD_LOG_H
+#define JOURNALD_LOG_H
+
+/* ******************  INCLUDES  ****************** */
+
+#include "shared.h"
+#include "../config/localfile-config.h"
+
+/* ******************  DEFINES  ****************** */
+
+#define JOURNALD_LOG_NAME       "journald"  ///< Name to be displayed in the localfile' statistics
+#define JOURNALD_LIB            "libsystemd.so.0"   ///< Library loaded at runtime to read the journal
+#define JOURNALD_CURSOR_FILE    "queue/logcollector/journald.cursor"    ///< Cursor of the last entry read
+
+#define JOURNALD_LOCAL_ONLY     (1 << 0)    ///< SD_JOURNAL_LOCAL_ONLY flag of sd_journal_open()
+#define JOURNALD_FIELD_MAX      OS_SIZE_256 ///< Maximum length of the header fields of an entry
+
+/* ******************  DATATYPES  ****************** */
+
+/**
+ * @brief sd-journal functions, resolved from libsystemd when the reader starts
+ */
+typedef struct {
+    int (*open)(void ** journal, int flags);
+    void (*close)(void * journal);
+    int (*add_match)(void * journal, const void * data, size_t size);
+    int (*add_disjunction)(void * journal);
+    int (*seek_head)(void * journal);
+    int (*seek_tail)(void * journal);
+    int (*seek_cursor)(void * journal, const char * cursor);
+    int (*test_cursor)(void * journal, const char * cursor);
+    int (*next)(void * journal);
+    int (*previous)(void * journal);
+    int (*get_data)(void * journal, const char * field, const void ** data, size_t * length);
+    int (*get_realtime_usec)(void * journal, uint64_t * usec);
+    int (*get_cursor)(void * journal, char ** cursor);
+    int (*wait)(void * journal, uint64_t timeout_usec);
+} w_journald_lib_t;
+
+/* ******************  PROTOTYPES  ****************** */
+
+/**
+ * @brief Set up the journald localfile, restoring the cursor of the previous run
+ *
+ * @param lf journald localfile
+ */
+void w_journald_init(logreader * lf);
+
+/**
+ * @brief Store the cursor of the last entry read, if it changed since the last call
+ *
+ * Called periodically by the main thread and at exit.
+ */
+void w_journald_save_cursor(void);
+
+#endif /* JOURNALD_LOG_H */
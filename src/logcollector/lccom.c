@@ -36,6 +36,8 @@ size_t lccom_dispatch(char * command, char ** output){
 
     } else if (strcmp(rcv_comm, "getstate") == 0) {
         return lccom_getstate(output);
+    } else if (strcmp(rcv_comm, HC_GETMETRICS) == 0) {
+        return w_metrics_getmetrics(rcv_args, output);
     } else {
         mdebug1("LCCOM Unrecognized command '%s'.", rcv_comm);
         os_strdup("err Unrecognized command", *output);
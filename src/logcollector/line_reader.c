@@ -0,0 +1,240 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Buffered reader of the lines of a file.
+ * The file is read in large chunks and split with memchr. The positions
+ * are tracked from the chunk offset and the hash is updated once per
+ * chunk, instead of calling ftell and SHA1 on every line.
+ */
+
+#include "shared.h"
+#include "logcollector.h"
+
+static __thread char * line_buffer;
+
+void w_line_reader_init(w_line_reader_t * reader, logreader * lf, int64_t position, size_t max_length, SHA_CTX * context) {
+    if (line_buffer == NULL) {
+        os_malloc(W_LINE_READER_SIZE + 1, line_buffer);
+    }
+
+    memset(reader, 0, sizeof(w_line_reader_t));
+    reader->lf = lf;
+    reader->context = context;
+    reader->buffer = line_buffer;
+    reader->max_length = max_length < W_LINE_READER_SIZE ? max_length : W_LINE_READER_SIZE - 1;
+    reader->offset = position;
+    reader->committed = position;
+}
+
+void w_line_reader_commit(w_line_reader_t * reader) {
+#ifndef WIN32
+    reader->committed = reader->offset + reader->start;
+#else
+    reader->committed = reader->offset;
+#endif
+}
+
+#ifndef WIN32
+
+/* Restore the byte replaced by the terminator of the last line */
+static void w_line_reader_restore(w_line_reader_t * reader) {
+    if (reader->end > 0) {
+        reader->buffer[reader->end - 1] = reader->end_char;
+        reader->end = 0;
+    }
+}
+
+/* Hash the bytes committed since the last update */
+static void w_line_reader_hash(w_line_reader_t * reader) {
+    size_t committed = reader->committed - reader->offset;
+
+    if (reader->context && committed > reader->hashed) {
+        SHA1_Update(reader->context, reader->buffer + reader->hashed, committed - reader->hashed);
+    }
+
+    reader->hashed = committed;
+}
+
+/* Drop the committed bytes and read the next chunk after the pending ones */
+static int w_line_reader_fill(w_line_reader_t * reader) {
+    size_t committed;
+    size_t requested;
+    size_t n;
+
+    // Records that don't fit in the buffer can't be read again
+    if (reader->committed == reader->offset && reader->length == W_LINE_READER_SIZE) {
+        w_line_reader_commit(reader);
+    }
+
+    w_line_reader_hash(reader);
+
+    if (committed = reader->committed - reader->offset, committed > 0) {
+        memmove(reader->buffer, reader->buffer + committed, reader->length - committed);
+        reader->offset += committed;
+        reader->length -= committed;
+        reader->start -= committed;
+        reader->hashed = 0;
+    }
+
+    if (reader->eof || reader->length == W_LINE_READER_SIZE) {
+        return 0;
+    }
+
+    requested = W_LINE_READER_SIZE - reader->length;
+    n = fread(reader->buffer + reader->length, 1, requested, reader->lf->fp);
+    reader->length += n;
+
+    // A short read only happens at the end of the file or on error
+    if (n < requested) {
+        reader->eof = true;
+    }
+
+    return n > 0;
+}
+
+w_line_status_t w_line_reader_next(w_line_reader_t * reader, char ** line, size_t * length) {
+    if (reader->offset < 0) {
+        return W_LINE_NONE;
+    }
+
+    w_line_reader_restore(reader);
+
+    while (1) {
+        char * begin = reader->buffer + reader->start;
+        size_t available = reader->length - reader->start;
+        char * newline = memchr(begin, '\n', available);
+
+        if (reader->skip) {
+            if (newline) {
+                reader->start += newline - begin + 1;
+                reader->skip = false;
+                continue;
+            }
+
+            reader->start = reader->length;
+
+            if (!w_line_reader_fill(reader)) {
+                return W_LINE_NONE;
+            }
+
+            continue;
+        }
+
+        if (newline && (size_t)(newline - begin) <= reader->max_length) {
+            *line = begin;
+            *length = newline - begin;
+            reader->end = newline - reader->buffer + 1;
+            reader->end_char = '\n';
+            *newline = '\0';
+            reader->start += *length + 1;
+            return W_LINE_OK;
+        }
+
+        if (available > reader->max_length) {
+            *line = begin;
+            *length = reader->max_length;
+            reader->end = reader->start + reader->max_length + 1;
+            reader->end_char = begin[reader->max_length];
+            begin[reader->max_length] = '\0';
+            reader->start += reader->max_length;
+            reader->skip = true;
+            return W_LINE_TRUNCATED;
+        }
+
+        if (!w_line_reader_fill(reader)) {
+            if (available > 0) {
+                mdebug2("Message not complete from '%s'. Trying again: '%.*s'%s", reader->lf->file,
+                        (int)(available < (size_t)sample_log_length ? available : (size_t)sample_log_length),
+                        reader->buffer + reader->start, available > (size_t)sample_log_length ? "..." : "");
+            }
+
+            return W_LINE_NONE;
+        }
+    }
+}
+
+int64_t w_line_reader_close(w_line_reader_t * reader) {
+    if (reader->offset < 0) {
+        return -1;
+    }
+
+    w_line_reader_restore(reader);
+    w_line_reader_hash(reader);
+
+    // Leave the file at the first byte not committed
+    if (reader->committed < reader->offset + (int64_t)reader->length && w_fseek(reader->lf->fp, reader->committed, SEEK_SET) < 0) {
+        return -1;
+    }
+
+    return reader->committed;
+}
+
+#else
+
+/* The files are opened in text mode: their positions only come from ftell */
+
+w_line_status_t w_line_reader_next(w_line_reader_t * reader, char ** line, size_t * length) {
+    char * str = reader->buffer;
+    int64_t rbytes;
+
+    while (reader->offset >= 0 && fgets(str, reader->max_length + 2, reader->lf->fp) != NULL) {
+        if (rbytes = w_ftell(reader->lf->fp) - reader->offset, rbytes <= 0) {
+            break;
+        }
+
+        if (reader->skip) {
+            if (reader->context) {
+                OS_SHA1_Stream(reader->context, NULL, str);
+            }
+
+            reader->offset += rbytes;
+            reader->skip = str[rbytes - 1] != '\n';
+            continue;
+        }
+
+        if (str[rbytes - 1] == '\n') {
+            if (reader->context) {
+                OS_SHA1_Stream(reader->context, NULL, str);
+            }
+
+            str[rbytes - 1] = '\0';
+            *length = rbytes - 1;
+        } else if ((size_t)rbytes >= reader->max_length + 1) {
+            if (reader->context) {
+                OS_SHA1_Stream(reader->context, NULL, str);
+            }
+
+            str[reader->max_length] = '\0';
+            *length = reader->max_length;
+            reader->skip = true;
+        } else if (feof(reader->lf->fp)) {
+            mdebug2("Message not complete from '%s'. Trying again: '%.*s'%s", reader->lf->file, sample_log_length, str, rbytes > sample_log_length ? "..." : "");
+            w_fseek(reader->lf->fp, reader->offset, SEEK_SET);
+            break;
+        } else {
+            *length = rbytes;
+        }
+
+        reader->offset += rbytes;
+        *line = str;
+        return reader->skip ? W_LINE_TRUNCATED : W_LINE_OK;
+    }
+
+    return W_LINE_NONE;
+}
+
+int64_t w_line_reader_close(w_line_reader_t * reader) {
+    if (reader->committed >= 0 && reader->committed != reader->offset && w_fseek(reader->lf->fp, reader->committed, SEEK_SET) < 0) {
+        return -1;
+    }
+
+    return reader->committed;
+}
+
+#endif
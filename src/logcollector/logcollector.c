@@ -30,14 +30,14 @@
 static int update_fname(int i, int j);
 static int update_current(logreader **current, int *i, int *j);
 static void set_read(logreader *current, int i, int j);
-static IT_control remove_duplicates(logreader *current, int i, int j);
+static OSHash * count_files();
+static IT_control remove_duplicates(logreader *current, int i, int j, OSHash *counts);
 static int find_duplicate_inode(logreader * lf);
 static void set_sockets();
 static void files_lock_init(void);
 static void check_text_only();
 static int check_pattern_expand(int do_seek);
 static void check_pattern_expand_excluded();
-static void set_can_read(int value);
 
 /**
  * @brief Create files_status hash and load the previous estatus from JSON file
@@ -55,6 +55,28 @@ STATIC void w_save_file_status();
  */
 STATIC void w_load_files_status(cJSON *global_json);
 
+/**
+ * @brief Add the status of a file to files_status
+ * @param path file path
+ * @param hash hash of the content read
+ * @param offset position to read
+ * @return false if the content of the file couldn't be read, otherwise true
+ */
+static bool w_load_file_status(const char * path, const char * hash, int64_t offset);
+
+/**
+ * @brief Append the files status changed since the last save to the journal
+ *
+ * The status file is written again instead once the journal outgrows the files status.
+ */
+STATIC void w_save_file_status_changes();
+
+/**
+ * @brief Read the records of the journal, keeping the latest one of each file
+ * @param fp journal file
+ */
+STATIC void w_load_files_journal(FILE * fp);
+
 /**
  * @brief Parse the hash files_status to JSON
  * @return json of all read status files in a string
@@ -98,6 +120,7 @@ int reload_interval;
 int reload_delay;
 int free_excluded_files_interval;
 int state_interval;
+int file_watch;
 OSHash * msg_queues_table;
 
 ///< To asociate the path, the position to read, and the hash key of lines read.
@@ -105,8 +128,23 @@ OSHash * files_status;
 ///< Use for log messages
 char *files_status_name = "file_status";
 static int _cday = 0;
+
+///< Record of the files status journal
+typedef struct {
+    char * path;
+    os_sha1 hash;
+    int64_t offset;
+    size_t seq;
+} w_journal_record_t;
+
+static w_journal_record_t * journal;            ///< Latest records of the journal being loaded, sorted by path
+static size_t journal_size;
+static unsigned int journal_records;            ///< Records appended since the status file was written
+static bool journal_compact;                    ///< The status file must be written again
+static __thread w_msg_file_t * msg_file;   ///< Last file name of the input thread, it keeps a reference
 int N_INPUT_THREADS = N_MIN_INPUT_THREADS;
 int OUTPUT_QUEUE_SIZE = OUTPUT_MIN_QUEUE_SIZE;
+int OUTPUT_BATCH = 1;
 socket_forwarder default_agent = { .name = "agent" };
 logtarget default_target[2] = { { .log_socket = &default_agent } };
 
@@ -126,6 +164,7 @@ static rwlock_t files_update_rwlock;
 
 static OSHash *excluded_files = NULL;
 static OSHash *excluded_binaries = NULL;
+static int force_expand = 0;
 
 #if defined(Darwin) || (defined(__linux__) && defined(WAZUH_UNIT_TESTING))
 
@@ -181,6 +220,9 @@ void LogCollectorStart()
     }
 #endif
 
+    /* Files opened from now on are watched for changes */
+    w_file_watch_init();
+
     /* Create store data */
     excluded_files = OSHash_Create();
     if (!excluded_files) {
@@ -265,6 +307,8 @@ void LogCollectorStart()
 
     mdebug1("Entering LogCollectorStart().");
 
+    OSHash * file_counts = count_files();
+
     /* Initialize each file and structure */
     for (i = 0;; i++) {
         if (f_control = update_current(&current, &i, &j), f_control) {
@@ -278,7 +322,7 @@ void LogCollectorStart()
         /* Remove duplicate entries */
         /* Returns NEXT_IT if duplicates were removed, LEAVE_IT if an error occurred
            or CONTINUE_IT to continue with the current iteration */
-        duplicates_removed = remove_duplicates(current, i, j);
+        duplicates_removed = remove_duplicates(current, i, j, file_counts);
         if (duplicates_removed == NEXT_IT) {
             i--;
             continue;
@@ -402,6 +446,25 @@ void LogCollectorStart()
             os_free(current->fp);
         }
 
+        else if (strcmp(current->logformat, JOURNALD) == 0) {
+#ifdef __linux__
+            w_journald_init(current);
+            current->read = read_journald;
+            minfo("Monitoring the systemd journal.");
+
+            for (int tg_idx = 0; current->target[tg_idx]; tg_idx++) {
+                mdebug1("Socket target for '%s' -> %s", JOURNALD_LOG_NAME, current->target[tg_idx]);
+                w_logcollector_state_add_target(JOURNALD_LOG_NAME, current->target[tg_idx]);
+            }
+#else
+            minfo(LOGCOLLECTOR_ONLY_JOURNALD);
+            os_free(current->journald);
+#endif
+            os_free(current->file);
+            os_free(current->command);
+            os_free(current->fp);
+        }
+
         else if (j < 0) {
             set_read(current, i, j);
             if (current->file) {
@@ -443,6 +506,8 @@ void LogCollectorStart()
         }
     }
 
+    OSHash_Free(file_counts);
+
     //Save status localfiles to disk
     w_save_file_status();
 
@@ -488,6 +553,9 @@ void LogCollectorStart()
                 merror_exit(LIST_ERROR);
             }
 
+            /* The files excluded so far may be added again */
+            force_expand = 1;
+
             f_free_excluded = 0;
 
             rwlock_unlock(&files_update_rwlock);
@@ -887,6 +955,8 @@ void LogCollectorStart()
 
             // Check for new files to be expanded
             if (check_pattern_expand(1)) {
+                file_counts = count_files();
+
                 /* Remove duplicate entries */
                 for (i = 0, j = -1;; i++) {
                     if (f_control = update_current(&current, &i, &j), f_control) {
@@ -897,12 +967,14 @@ void LogCollectorStart()
                         }
                     }
 
-                    duplicates_removed = remove_duplicates(current, i, j);
+                    duplicates_removed = remove_duplicates(current, i, j, file_counts);
                     if (duplicates_removed == NEXT_IT) {
                         i--;
                         continue;
                     }
                 }
+
+                OSHash_Free(file_counts);
             }
 
             /* Check for excluded files */
@@ -919,7 +991,10 @@ void LogCollectorStart()
             }
 
             //Save status localfiles to disk
-            w_save_file_status();
+            w_save_file_status_changes();
+#ifdef __linux__
+            w_journald_save_cursor();
+#endif
 
             f_check = 0;
 
@@ -1087,6 +1162,8 @@ int handle_file(int i, int j, __attribute__((unused)) int do_fseek, int do_log)
     }
 #endif
 
+    w_file_watch_add(lf);
+
     /* Set ignore to zero */
     lf->ign = 0;
     lf->exists = 1;
@@ -1139,6 +1216,7 @@ int reload_file(logreader * lf) {
 #endif
 
     fsetpos(lf->fp, &lf->position);
+    w_file_watch_add(lf);
     return 0;
 }
 
@@ -1152,6 +1230,7 @@ void close_file(logreader * lf) {
     fgetpos(lf->fp, &lf->position);
     fclose(lf->fp);
     lf->fp = NULL;
+    w_file_watch_remove(lf);
 
 #ifdef WIN32
     lf->h = NULL;
@@ -1324,13 +1403,33 @@ void set_read(logreader *current, int i, int j) {
 }
 
 #ifndef WIN32
+/* Directory of a pattern, if it has no wildcards */
+static int w_glob_dir(const char * pattern, char * dir, size_t size) {
+    const char * slash = strrchr(pattern, '/');
+    const char * wildcard = strpbrk(pattern, "*?[");
+
+    if (slash == NULL || (size_t)(slash - pattern) >= size || (wildcard && wildcard < slash)) {
+        return 0;
+    }
+
+    if (slash == pattern) {
+        snprintf(dir, size, "/");
+    } else {
+        snprintf(dir, size, "%.*s", (int)(slash - pattern), pattern);
+    }
+
+    return 1;
+}
+
 int check_pattern_expand(int do_seek) {
     glob_t g;
     int err;
     int glob_offset;
-    int found;
     int i, j;
     int retval = 0;
+    char dir[PATH_MAX];
+    unsigned int dir_events = 0;
+    OSHash * known_files;
 
     pthread_mutexattr_t attr;
     w_mutexattr_init(&attr);
@@ -1341,15 +1440,45 @@ int check_pattern_expand(int do_seek) {
             if (current_files >= maximum_files) {
                 break;
             }
+
+            dir_events = 0;
+
+            /* Nothing to add if the directory didn't change and no file left the pattern since the last expansion */
+            if (globs[j].wd > 0 && !force_expand && globs[j].num_files == globs[j].expanded_files
+                && w_file_watch_events(globs[j].wd) == globs[j].wd_events) {
+                continue;
+            }
+
+            /* The events from now on trigger the next expansion */
+            if (w_file_watch_enabled() && w_glob_dir(globs[j].gpath, dir, sizeof(dir))) {
+                if (globs[j].wd = w_file_watch_add_dir(dir), globs[j].wd > 0) {
+                    dir_events = w_file_watch_events(globs[j].wd);
+                }
+            }
+
             glob_offset = 0;
             if (err = glob(globs[j].gpath, 0, NULL, &g), err) {
                 if (err == GLOB_NOMATCH) {
                     mdebug1(GLOB_NFOUND, globs[j].gpath);
+                    globs[j].wd_events = dir_events;
+                    globs[j].expanded_files = globs[j].num_files;
                 } else {
                     mdebug1(GLOB_ERROR, globs[j].gpath);
                 }
                 continue;
             }
+
+            /* Files of the pattern already expanded */
+            if (known_files = OSHash_Create(), !known_files) {
+                merror_exit(LIST_ERROR);
+            }
+
+            OSHash_setSize(known_files, globs[j].num_files * 2 + 16);
+
+            for (i = 0; globs[j].gfiles[i].file; i++) {
+                OSHash_Add(known_files, globs[j].gfiles[i].file, (void *)1);
+            }
+
             while (g.gl_pathv[glob_offset] != NULL) {
                 if (current_files >= maximum_files) {
                     mwarn(FILE_LIMIT, maximum_files);
@@ -1369,14 +1498,7 @@ int check_pattern_expand(int do_seek) {
                     continue;
                 }
 
-                found = 0;
-                for (i = 0; globs[j].gfiles[i].file; i++) {
-                    if (!strcmp(globs[j].gfiles[i].file, g.gl_pathv[glob_offset])) {
-                        found = 1;
-                        break;
-                    }
-                }
-                if (!found) {
+                if (!OSHash_Get(known_files, g.gl_pathv[glob_offset])) {
                     retval = 1;
                     char *ex_file = OSHash_Get(excluded_files,g.gl_pathv[glob_offset]);
                     int added = 0;
@@ -1404,6 +1526,7 @@ int check_pattern_expand(int do_seek) {
                             handle_file(i, j, do_seek, 1);
                         }
 
+                        i++;
                         added = 1;
                     }
 
@@ -1430,14 +1553,25 @@ int check_pattern_expand(int do_seek) {
                         } else {
                             handle_file(i, j, do_seek, 1);
                         }
+
+                        i++;
                     }
                 }
                 glob_offset++;
             }
+
+            /* A partial expansion is completed in the next cycle */
+            if (g.gl_pathv[glob_offset] == NULL) {
+                globs[j].wd_events = dir_events;
+                globs[j].expanded_files = globs[j].num_files;
+            }
+
+            OSHash_Free(known_files);
             globfree(&g);
         }
     }
 
+    force_expand = 0;
     w_mutexattr_destroy(&attr);
 
     return retval;
@@ -1630,40 +1764,65 @@ int check_pattern_expand(int do_seek) {
 }
 #endif
 
-static IT_control remove_duplicates(logreader *current, int i, int j) {
-    IT_control d_control = CONTINUE_IT;
+/* Number of entries of each file path */
+static OSHash * count_files() {
     IT_control f_control;
+    logreader *current;
+    OSHash *counts;
+    intptr_t count;
     int r, k;
-    logreader *dup;
 
-    if (current->file && !current->command) {
-        for (r = 0, k = -1;; r++) {
-            if (f_control = update_current(&dup, &r, &k), f_control) {
-                if (f_control == NEXT_IT) {
-                    continue;
-                } else {
-                    break;
-                }
-            }
+    if (counts = OSHash_Create(), !counts) {
+        merror_exit(LIST_ERROR);
+    }
 
-            if (current != dup && dup->file && !strcmp(current->file, dup->file)) {
-                mwarn(DUP_FILE, current->file);
-                int result;
+    OSHash_setSize(counts, current_files * 2 + 16);
 
-                if (j < 0) {
-                    result = Remove_Localfile(&logff, i, 0, 1,NULL);
-                } else {
-                    result = Remove_Localfile(&(globs[j].gfiles), i, 1, 0,&globs[j]);
-                }
-                if (result) {
-                    merror_exit(REM_ERROR, current->file);
-                } else {
-                    mdebug1(CURRENT_FILES, current_files, maximum_files);
-                }
-                d_control = NEXT_IT;
+    for (r = 0, k = -1;; r++) {
+        if (f_control = update_current(&current, &r, &k), f_control) {
+            if (f_control == NEXT_IT) {
+                continue;
+            } else {
                 break;
             }
         }
+
+        if (current->file && !current->command) {
+            count = (intptr_t)OSHash_Get(counts, current->file);
+
+            if (count == 0) {
+                OSHash_Add(counts, current->file, (void *)1);
+            } else {
+                OSHash_Update(counts, current->file, (void *)(count + 1));
+            }
+        }
+    }
+
+    return counts;
+}
+
+/* Remove an entry if a later one has the same file path */
+static IT_control remove_duplicates(logreader *current, int i, int j, OSHash *counts) {
+    IT_control d_control = CONTINUE_IT;
+    intptr_t count;
+
+    if (current->file && !current->command && (count = (intptr_t)OSHash_Get(counts, current->file), count > 1)) {
+        mwarn(DUP_FILE, current->file);
+        OSHash_Update(counts, current->file, (void *)(count - 1));
+
+        int result;
+
+        if (j < 0) {
+            result = Remove_Localfile(&logff, i, 0, 1,NULL);
+        } else {
+            result = Remove_Localfile(&(globs[j].gfiles), i, 1, 0,&globs[j]);
+        }
+        if (result) {
+            merror_exit(REM_ERROR, current->file);
+        } else {
+            mdebug1(CURRENT_FILES, current_files, maximum_files);
+        }
+        d_control = NEXT_IT;
     }
 
     return d_control;
@@ -1732,6 +1891,7 @@ static void set_sockets() {
             if (strcmp(current->target[j], "agent") == 0) {
                 current->log_target[j].log_socket = &default_agent;
                 w_msg_hash_queues_add_entry("agent");
+                current->log_target[j].queue = OSHash_Get(msg_queues_table, "agent");
                 continue;
             }
             int found = -1;
@@ -1746,6 +1906,7 @@ static void set_sockets() {
             } else {
                 current->log_target[j].log_socket = &logsk[k];
                 w_msg_hash_queues_add_entry(logsk[k].name);
+                current->log_target[j].queue = OSHash_Get(msg_queues_table, logsk[k].name);
             }
         }
 
@@ -1816,6 +1977,9 @@ void free_msg_queue(w_msg_queue_t *msg) {
 void w_msg_hash_queues_init(){
 
     OUTPUT_QUEUE_SIZE = getDefine_Int("logcollector", "queue_size", OUTPUT_MIN_QUEUE_SIZE, 220000);
+#ifdef __linux__
+    OUTPUT_BATCH = getDefine_Int("logcollector", "output_batch", 1, MQ_BATCH_MAX);
+#endif
     msg_queues_table = OSHash_Create();
 
     if(!msg_queues_table){
@@ -1833,36 +1997,64 @@ int w_msg_hash_queues_add_entry(const char *key){
     msg->msg_queue = queue_init(OUTPUT_QUEUE_SIZE);
     w_mutex_init(&msg->mutex, NULL);
     w_cond_init(&msg->available, NULL);
+    w_cond_init(&msg->space, NULL);
 
     if (result = OSHash_Add(msg_queues_table, key, msg), result != 2) {
         queue_free(msg->msg_queue);
         w_mutex_destroy(&msg->mutex);
         w_cond_destroy(&msg->available);
+        w_cond_destroy(&msg->space);
         free(msg);
     }
 
     return result;
 }
 
+char * w_msg_file_get(const char * file) {
+    if (msg_file == NULL || strcmp(msg_file->name, file) != 0) {
+        size_t length = strlen(file);
+
+        if (msg_file) {
+            w_msg_file_release(msg_file->name);
+        }
+
+        os_malloc(sizeof(w_msg_file_t) + length + 1, msg_file);
+        msg_file->refs = 1;
+        memcpy(msg_file->name, file, length + 1);
+    }
+
+    __atomic_add_fetch(&msg_file->refs, 1, __ATOMIC_RELAXED);
+    return msg_file->name;
+}
+
+void w_msg_file_release(char * file) {
+    w_msg_file_t * entry = (w_msg_file_t *)(file - offsetof(w_msg_file_t, name));
+
+    if (__atomic_sub_fetch(&entry->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(entry);
+    }
+}
+
 int w_msg_hash_queues_push(const char *str, char *file, unsigned long size, logtarget * targets, char queue_mq) {
     w_msg_queue_t *msg;
     int i;
-    char *file_cpy;
     int result;
 
     w_logcollector_state_update_file(file, size);
 
     for (i = 0; targets[i].log_socket; i++)
     {
-        w_mutex_lock(&mutex);
+        /* Targets out of the configuration are looked up */
+        if (msg = targets[i].queue, !msg) {
+            w_mutex_lock(&mutex);
 
-        msg = (w_msg_queue_t *)OSHash_Get(msg_queues_table, targets[i].log_socket->name);
+            msg = (w_msg_queue_t *)OSHash_Get(msg_queues_table, targets[i].log_socket->name);
 
-        w_mutex_unlock(&mutex);
+            w_mutex_unlock(&mutex);
+        }
 
         if (msg) {
-            os_strdup(file, file_cpy);
-            result = w_msg_queue_push(msg, str, file_cpy, size, &targets[i], queue_mq);
+            result = w_msg_queue_push(msg, str, w_msg_file_get(file), size, &targets[i], queue_mq);
 
             if (result < 0) {
                 w_logcollector_state_update_target(file,targets[i].log_socket->name, true);
@@ -1873,6 +2065,22 @@ int w_msg_hash_queues_push(const char *str, char *file, unsigned long size, logt
     return 0;
 }
 
+bool w_msg_hash_queues_busy(logtarget * targets) {
+    bool busy = false;
+
+    for (int i = 0; !busy && targets[i].log_socket; i++) {
+        w_msg_queue_t * msg = targets[i].queue;
+
+        if (msg) {
+            w_mutex_lock(&msg->mutex);
+            busy = msg->msg_queue->size - 1 - msg->msg_queue->elements < (size_t)OUTPUT_QUEUE_CREDIT;
+            w_mutex_unlock(&msg->mutex);
+        }
+    }
+
+    return busy;
+}
+
 int w_msg_queue_push(w_msg_queue_t * msg, const char * buffer, char *file, unsigned long size, logtarget * log_target, char queue_mq) {
     w_message_t *message;
     static int reported = 0;
@@ -1888,6 +2096,14 @@ int w_msg_queue_push(w_msg_queue_t * msg, const char * buffer, char *file, unsig
     message->log_target = log_target;
     message->queue_mq = queue_mq;
 
+    /* Out of credit: the line waits for the output thread, unless the main thread needs the files */
+    while (queue_full(msg->msg_queue) && can_read()) {
+        struct timespec deadline;
+
+        gettime(&deadline);
+        deadline.tv_sec++;
+        pthread_cond_timedwait(&msg->space, &msg->mutex, &deadline);
+    }
 
     if (result = queue_push(msg->msg_queue, message), result == 0) {
         w_cond_signal(&msg->available);
@@ -1905,7 +2121,7 @@ int w_msg_queue_push(w_msg_queue_t * msg, const char * buffer, char *file, unsig
     w_mutex_unlock(&msg->mutex);
 
     if (result < 0) {
-        free(message->file);
+        w_msg_file_release(message->file);
         free(message->buffer);
         free(message);
         mdebug2("Discarding log line for target '%s'", log_target->log_socket->name);
@@ -1922,10 +2138,92 @@ w_message_t * w_msg_queue_pop(w_msg_queue_t * msg){
         w_cond_wait(&msg->available, &msg->mutex);
     }
 
+    w_cond_signal(&msg->space);
     w_mutex_unlock(&msg->mutex);
     return message;
 }
 
+unsigned int w_msg_queue_pop_batch(w_msg_queue_t * msg, w_message_t ** messages, unsigned int max) {
+    unsigned int count = 0;
+
+    w_mutex_lock(&msg->mutex);
+
+    while (count < max) {
+        if (messages[count] = (w_message_t *)queue_pop(msg->msg_queue), messages[count]) {
+            count++;
+        } else if (count == 0) {
+            w_cond_wait(&msg->available, &msg->mutex);
+        } else {
+            break;
+        }
+    }
+
+    w_cond_broadcast(&msg->space);
+    w_mutex_unlock(&msg->mutex);
+    return count;
+}
+
+#ifdef __linux__
+/**
+ * @brief Send a batch of messages to the agent queue
+ *
+ * The messages are sent again while the socket is busy, so none is dropped
+ * because agentd is slower than the input threads.
+ * @param messages Messages popped from the agent queue
+ * @param count Number of messages
+ */
+STATIC void w_output_agent_batch(w_message_t ** messages, unsigned int count) {
+    char * buffers[MQ_BATCH_MAX];
+    const char * locmsgs[MQ_BATCH_MAX];
+    char locs[MQ_BATCH_MAX];
+    logtarget * targets[MQ_BATCH_MAX];
+    const struct timespec busy_delay = { 0, 10000000 };
+    bool reconnected = false;
+    unsigned int sent = 0;
+    unsigned int i;
+    int result;
+
+    for (i = 0; i < count; i++) {
+        buffers[i] = messages[i]->buffer;
+        locmsgs[i] = messages[i]->file;
+        locs[i] = messages[i]->queue_mq;
+        targets[i] = messages[i]->log_target;
+    }
+
+    while (sent < count) {
+        if (result = SendMSGBatch(logr_queue, buffers + sent, locmsgs + sent, locs + sent, targets + sent, count - sent), result < 0) {
+            if (reconnected) {
+                // We reconnected but are still unable to send the messages, notify it and go on.
+                merror("Unable to send message to '%s' after a successfull reconnection...", DEFAULTQUEUE);
+                break;
+            }
+
+#ifdef CLIENT
+            merror("Unable to send message to '%s' (wazuh-agentd might be down). Attempting to reconnect.", DEFAULTQUEUE);
+#else
+            merror("Unable to send message to '%s' (wazuh-analysisd might be down). Attempting to reconnect.", DEFAULTQUEUE);
+#endif
+            // Retry to connect infinitely.
+            logr_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS);
+            minfo("Successfully reconnected to '%s'", DEFAULTQUEUE);
+            reconnected = true;
+        } else if (result == 0) {
+            nanosleep(&busy_delay, NULL);
+        } else {
+            sent += result;
+            reconnected = false;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        w_logcollector_state_update_target(messages[i]->file, messages[i]->log_target->log_socket->name, i >= sent);
+        w_msg_file_release(messages[i]->file);
+        free(messages[i]->buffer);
+        free(messages[i]);
+    }
+}
+#endif
+
 #ifdef WIN32
 DWORD WINAPI w_output_thread(void * args) {
 #else
@@ -1945,6 +2243,17 @@ void * w_output_thread(void * args){
     #endif
     }
 
+#ifdef __linux__
+    /* The agent queue is written in batches */
+    if (OUTPUT_BATCH > 1 && strcmp(queue_name, "agent") == 0) {
+        w_message_t * messages[MQ_BATCH_MAX];
+
+        while (1) {
+            w_output_agent_batch(messages, w_msg_queue_pop_batch(msg_queue, messages, OUTPUT_BATCH));
+        }
+    }
+#endif
+
     while(1)
     {
         int sleep_time = 5;
@@ -2011,7 +2320,7 @@ void * w_output_thread(void * args){
                 merror(SEND_ERROR, message->log_target->log_socket->location, message->buffer);
             }
         }
-        free(message->file);
+        w_msg_file_release(message->file);
         free(message->buffer);
         free(message);
     }
@@ -2025,36 +2334,34 @@ void w_create_output_threads(){
     unsigned int i;
     const OSHashNode *curr_node;
 
-    for(i = 0; i <= msg_queues_table->rows; i++){
-        if(msg_queues_table->table[i]){
-            curr_node = msg_queues_table->table[i];
-
-            /* Create one thread per valid hash entry */
-            if(curr_node->key){
+    /* Create one thread per valid hash entry */
+    for (curr_node = OSHash_Begin(msg_queues_table, &i); curr_node; curr_node = OSHash_Next(msg_queues_table, &i, (OSHashNode *)curr_node)) {
 #ifndef WIN32
-                w_create_thread(w_output_thread, curr_node->key);
+        w_create_thread(w_output_thread, curr_node->key);
 #else
-                w_create_thread(NULL,
-                    0,
-                    w_output_thread,
-                    curr_node->key,
-                    0,
-                    NULL);
+        w_create_thread(NULL,
+            0,
+            w_output_thread,
+            curr_node->key,
+            0,
+            NULL);
 #endif
-            }
-        }
     }
 }
 
 #ifdef WIN32
-DWORD WINAPI w_input_thread(__attribute__((unused)) void * t_id) {
+DWORD WINAPI w_input_thread(void * t_id) {
 #else
-void * w_input_thread(__attribute__((unused)) void * t_id){
+void * w_input_thread(void * t_id){
 #endif
     logreader *current;
     int i = 0, r = 0, j = -1;
+    const int id = (int)(intptr_t)t_id;
+    int k;
     IT_control f_control = 0;
     time_t curr_time = 0;
+    struct timespec read_start;
+    struct timespec read_end;
 #ifndef WIN32
     int int_error = 0;
     struct timeval fp_timeout;
@@ -2070,8 +2377,10 @@ void * w_input_thread(__attribute__((unused)) void * t_id){
         fp_timeout.tv_sec = loop_timeout;
         fp_timeout.tv_usec = 0;
 
-        /* Wait for the select timeout */
-        if ((r = select(0, NULL, NULL, NULL, &fp_timeout)) < 0) {
+        /* Wait for a change on the watched files, or for the polling of the other ones */
+        if (w_file_watch_enabled()) {
+            w_file_watch_wait(loop_timeout);
+        } else if ((r = select(0, NULL, NULL, NULL, &fp_timeout)) < 0) {
             merror(SELECT_ERROR, errno, strerror(errno));
             int_error++;
 
@@ -2094,7 +2403,7 @@ void * w_input_thread(__attribute__((unused)) void * t_id){
 #endif
 
         /* Check which file is available */
-        for (i = 0, j = -1;; i++) {
+        for (i = 0, j = -1, k = 0;; i++) {
 
             rwlock_lock_read(&files_update_rwlock);
             if (f_control = update_current(&current, &i, &j), f_control) {
@@ -2107,6 +2416,14 @@ void * w_input_thread(__attribute__((unused)) void * t_id){
                 }
             }
 
+            /* Each thread owns a share of the files. The others only read
+             * them while the owner left lines pending.
+             */
+            if (k++ % N_INPUT_THREADS != id && !__atomic_load_n(&current->pending, __ATOMIC_RELAXED)) {
+                rwlock_unlock(&files_update_rwlock);
+                continue;
+            }
+
             if (pthread_mutex_trylock(&current->mutex) == 0){
 
                 if (!current->fp) {
@@ -2123,6 +2440,12 @@ void * w_input_thread(__attribute__((unused)) void * t_id){
                     else if (current->macos_log != NULL && current->macos_log->state != LOG_NOT_RUNNING) {
                         current->read(current, &r, 0);
                     }
+#endif
+#ifdef __linux__
+                    /* Read the new entries of the journal */
+                    else if (current->journald != NULL && !w_msg_hash_queues_busy(current->log_target)) {
+                        current->read(current, &r, 0);
+                    }
 #endif
                     w_mutex_unlock(&current->mutex);
                     rwlock_unlock(&files_update_rwlock);
@@ -2156,6 +2479,14 @@ void * w_input_thread(__attribute__((unused)) void * t_id){
                     }
                 }
 
+                /* Watched files are only read after they change, or while a multiline event
+                 * is waiting for its timeout to be flushed */
+                if (!(current->multiline && current->multiline->ctxt) && !w_file_watch_changed(current)) {
+                    w_mutex_unlock(&current->mutex);
+                    rwlock_unlock(&files_update_rwlock);
+                    continue;
+                }
+
                 /* We check for the end of file. If is returns EOF,
                 * we don't attempt to read it.
                 * Excluding multiline_regex log format which has its own handler.
@@ -2246,8 +2577,28 @@ void * w_input_thread(__attribute__((unused)) void * t_id){
                 }
             }
 #endif
+                /* The file keeps its position while its targets are out of credit */
+                if (w_msg_hash_queues_busy(current->log_target)) {
+                    w_file_watch_pending(current);
+                    w_mutex_unlock(&current->mutex);
+                    rwlock_unlock(&files_update_rwlock);
+                    continue;
+                }
+
                 /* Finally, send to the function pointer to read it */
+                gettime(&read_start);
                 current->read(current, &r, 0);
+                gettime(&read_end);
+                w_logcollector_state_update_read(current->file, (uint64_t)(time_diff(&read_start, &read_end) * 1000000));
+
+                /* The lines left by the max_lines limit raise no new events */
+                if (!feof(current->fp)) {
+                    w_file_watch_pending(current);
+                    __atomic_store_n(&current->pending, 1, __ATOMIC_RELAXED);
+                } else {
+                    __atomic_store_n(&current->pending, 0, __ATOMIC_RELAXED);
+                }
+
                 /* Check for error */
                 if (!ferror(current->fp)) {
                     /* Clear EOF */
@@ -2340,12 +2691,12 @@ void w_create_input_threads(){
 
     for(i = 0; i < N_INPUT_THREADS; i++) {
 #ifndef WIN32
-        w_create_thread(w_input_thread,NULL);
+        w_create_thread(w_input_thread, (void *)(intptr_t)i);
 #else
         w_create_thread(NULL,
                      0,
                      w_input_thread,
-                     NULL,
+                     (void *)(intptr_t)i,
                      0,
                      NULL);
 #endif
@@ -2557,7 +2908,7 @@ static void check_pattern_expand_excluded() {
 #endif
 
 
-static void set_can_read(int value){
+void set_can_read(int value){
 
     RWLOCK_LOCK_WRITE(&can_read_rwlock, {
         _can_read = value;
@@ -2585,6 +2936,7 @@ int w_update_file_status(const char * path, int64_t pos, SHA_CTX * context) {
     memcpy(data->hash, output, sizeof(os_sha1));
 
     data->offset = pos;
+    data->saved = false;
 
     if (OSHash_Update_ex(files_status, path, data) != 1) {
         if (OSHash_Add_ex(files_status, path, data) != 2) {
@@ -2596,6 +2948,19 @@ int w_update_file_status(const char * path, int64_t pos, SHA_CTX * context) {
     return 0;
 }
 
+/* Records sorted by path, and by order in the journal */
+static int w_journal_record_cmp(const void * a, const void * b) {
+    const w_journal_record_t * x = a;
+    const w_journal_record_t * y = b;
+    int cmp = strcmp(x->path, y->path);
+
+    return cmp ? cmp : (x->seq > y->seq) - (x->seq < y->seq);
+}
+
+static int w_journal_record_find(const void * path, const void * record) {
+    return strcmp(path, ((const w_journal_record_t *)record)->path);
+}
+
 STATIC void w_initialize_file_status() {
 
     /* Initialize hash table to associate paths and read position */
@@ -2612,6 +2977,14 @@ STATIC void w_initialize_file_status() {
     /* Read json file to load last read positions */
     FILE * fd = NULL;
 
+    /* The journal holds the latest positions */
+    if (fd = fopen(LOCALFILE_JOURNAL, "r"), fd != NULL) {
+        w_load_files_journal(fd);
+        fclose(fd);
+    } else if (errno != ENOENT) {
+        merror(FOPEN_ERROR, LOCALFILE_JOURNAL, errno, strerror(errno));
+    }
+
     if (fd = fopen(LOCALFILE_STATUS, "r"), fd != NULL) {
         char str[OS_MAXSTR] = {0};
 
@@ -2628,6 +3001,19 @@ STATIC void w_initialize_file_status() {
     } else if (errno != ENOENT) {
         merror(FOPEN_ERROR, LOCALFILE_STATUS, errno, strerror(errno));
     }
+
+    for (size_t i = 0; i < journal_size; i++) {
+        struct stat stat_fd;
+
+        if (stat(journal[i].path, &stat_fd) == 0) {
+            w_load_file_status(journal[i].path, journal[i].hash, journal[i].offset);
+        }
+
+        os_free(journal[i].path);
+    }
+
+    os_free(journal);
+    journal_size = 0;
 }
 
 STATIC void w_save_file_status() {
@@ -2641,19 +3027,200 @@ STATIC void w_save_file_status() {
     FILE * fd = NULL;
     size_t size_str = strlen(str);
 
-    if (fd = wfopen(LOCALFILE_STATUS, "w"), fd != NULL) {
+    /* The file is replaced at once, so a crash leaves the previous one */
+    if (fd = wfopen(LOCALFILE_STATUS_TMP, "w"), fd != NULL) {
         if (fwrite(str, 1, size_str, fd) == 0) {
-            merror(FWRITE_ERROR, LOCALFILE_STATUS, errno, strerror(errno));
+            merror(FWRITE_ERROR, LOCALFILE_STATUS_TMP, errno, strerror(errno));
             clearerr(fd);
+            fclose(fd);
+            journal_compact = true;
+        } else {
+            fflush(fd);
+#ifndef WIN32
+            fsync(fileno(fd));
+#endif
+            fclose(fd);
+
+            if (rename_ex(LOCALFILE_STATUS_TMP, LOCALFILE_STATUS) == 0) {
+                /* Every record of the journal is in the status file now */
+                if (unlink(LOCALFILE_JOURNAL) < 0 && errno != ENOENT) {
+                    merror(DELETE_ERROR, LOCALFILE_JOURNAL, errno, strerror(errno));
+                }
+
+                journal_records = 0;
+                journal_compact = false;
+            } else {
+                journal_compact = true;
+            }
         }
-        fclose(fd);
     } else {
-        merror_exit(FOPEN_ERROR, LOCALFILE_STATUS, errno, strerror(errno));
+        merror_exit(FOPEN_ERROR, LOCALFILE_STATUS_TMP, errno, strerror(errno));
     }
 
     os_free(str);
 }
 
+STATIC void w_save_file_status_changes() {
+
+    unsigned int index = 0;
+    unsigned int records = 0;
+    OSHashNode * hash_node = NULL;
+    char * buffer = NULL;
+    size_t length = 0;
+    size_t size = 0;
+    FILE * fd = NULL;
+
+#if defined(Darwin) || (defined(__linux__) && defined(WAZUH_UNIT_TESTING))
+    /* The macOS log status is only in the status file */
+    journal_compact |= macos_processes != NULL;
+#endif
+
+    if (journal_compact || journal_records > 2 * files_status->elements + LOCALFILE_JOURNAL_MIN) {
+        w_save_file_status();
+        return;
+    }
+
+    w_rwlock_rdlock(&files_status->mutex);
+
+    for (hash_node = OSHash_Begin(files_status, &index); hash_node != NULL;
+         hash_node = OSHash_Next(files_status, &index, hash_node)) {
+        os_file_status_t * data = hash_node->data;
+        size_t record_size;
+
+        if (data->saved) {
+            continue;
+        }
+
+        record_size = OFFSET_SIZE + sizeof(os_sha1) + strlen(hash_node->key) + 3;
+
+        if (length + record_size > size) {
+            size = (length + record_size) * 2;
+            os_realloc(buffer, size, buffer);
+        }
+
+        length += snprintf(buffer + length, size - length, "%" PRIi64 " %s %s\n", data->offset, data->hash, hash_node->key);
+        data->saved = true;
+        records++;
+    }
+
+    w_rwlock_unlock(&files_status->mutex);
+
+    if (records == 0) {
+        return;
+    }
+
+    if (fd = wfopen(LOCALFILE_JOURNAL, "a"), fd == NULL) {
+        merror(FOPEN_ERROR, LOCALFILE_JOURNAL, errno, strerror(errno));
+        journal_compact = true;
+    } else {
+        if (fwrite(buffer, 1, length, fd) != length) {
+            merror(FWRITE_ERROR, LOCALFILE_JOURNAL, errno, strerror(errno));
+            clearerr(fd);
+            journal_compact = true;
+        } else {
+            fflush(fd);
+#ifndef WIN32
+            fsync(fileno(fd));
+#endif
+        }
+
+        fclose(fd);
+        journal_records += records;
+    }
+
+    os_free(buffer);
+}
+
+STATIC void w_load_files_journal(FILE * fp) {
+
+    char line[PATH_MAX + OFFSET_SIZE + sizeof(os_sha1) + 4];
+    size_t allocated = 0;
+    size_t count = 0;
+    size_t i;
+    size_t k;
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char * hash;
+        char * path;
+        char * end;
+        int64_t offset;
+
+        if (end = strchr(line, '\n'), end == NULL) {
+            // Last record, partially written
+            break;
+        }
+
+        *end = '\0';
+        offset = strtoll(line, &hash, 10);
+
+        if (offset < 0 || *hash != ' ' || strlen(++hash) <= sizeof(os_sha1) || hash[sizeof(os_sha1) - 1] != ' ') {
+            continue;
+        }
+
+        hash[sizeof(os_sha1) - 1] = '\0';
+        path = hash + sizeof(os_sha1);
+
+        if (count == allocated) {
+            allocated = allocated ? allocated * 2 : 64;
+            os_realloc(journal, allocated * sizeof(w_journal_record_t), journal);
+        }
+
+        os_strdup(path, journal[count].path);
+        memcpy(journal[count].hash, hash, sizeof(os_sha1));
+        journal[count].offset = offset;
+        journal[count].seq = count;
+        count++;
+    }
+
+    if (count == 0) {
+        os_free(journal);
+        journal_size = 0;
+        return;
+    }
+
+    /* Keep the last record of each file */
+    qsort(journal, count, sizeof(w_journal_record_t), w_journal_record_cmp);
+
+    for (i = 0, k = 0; i < count; i++) {
+        if (i + 1 < count && strcmp(journal[i].path, journal[i + 1].path) == 0) {
+            os_free(journal[i].path);
+        } else {
+            journal[k++] = journal[i];
+        }
+    }
+
+    journal_size = k;
+}
+
+static bool w_load_file_status(const char * path, const char * hash, int64_t offset) {
+
+    os_file_status_t * data;
+
+    os_malloc(sizeof(os_file_status_t), data);
+    memcpy(data->hash, hash, sizeof(os_sha1));
+    data->offset = offset;
+    data->saved = true;
+
+    SHA_CTX context;
+    os_sha1 output;
+
+    if (OS_SHA1_File_Nbytes(path, &context, output, OS_BINARY, offset) < 0) {
+        mdebug1(LOGCOLLECTOR_FILE_NOT_EXIST, path);
+        os_free(data);
+        return false;
+    }
+    data->context = context;
+
+    if (OSHash_Update_ex(files_status, path, data) != 1) {
+        if (OSHash_Add_ex(files_status, path, data) != 2) {
+            merror(HADD_ERROR, path, files_status_name);
+            os_free(data);
+        }
+    }
+
+    return true;
+}
+
 STATIC void w_load_files_status(cJSON * global_json) {
 
     cJSON * localfiles_array = cJSON_GetObjectItem(global_json, OS_LOGCOLLECTOR_JSON_FILES);
@@ -2672,6 +3239,11 @@ STATIC void w_load_files_status(cJSON * global_json) {
             continue;
         }
 
+        /* The journal has a later position */
+        if (journal_size > 0 && bsearch(path_str, journal, journal_size, sizeof(w_journal_record_t), w_journal_record_find)) {
+            continue;
+        }
+
         struct stat stat_fd;
 
         if (stat(path_str, &stat_fd) == -1) {
@@ -2710,28 +3282,9 @@ STATIC void w_load_files_status(cJSON * global_json) {
             continue;
         }
 
-        os_file_status_t * data;
-
-        os_malloc(sizeof(os_file_status_t), data);
-        memcpy(data->hash, hash_str, sizeof(os_sha1));
-        data->offset = value_offset;
-
-        SHA_CTX context;
-        os_sha1 output;
-
-        if (OS_SHA1_File_Nbytes(path_str, &context, output, OS_BINARY, value_offset) < 0) {
-            mdebug1(LOGCOLLECTOR_FILE_NOT_EXIST, path_str);
-            os_free(data);
+        if (!w_load_file_status(path_str, hash_str, value_offset)) {
             return;
         }
-        data->context = context;
-
-        if (OSHash_Update_ex(files_status, path_str, data) != 1) {
-            if (OSHash_Add_ex(files_status, path_str, data) != 2) {
-                merror(HADD_ERROR, path_str, files_status_name);
-                os_free(data);
-            }
-        }
     }
 #if defined(Darwin) || (defined(__linux__) && defined(WAZUH_UNIT_TESTING))
 
@@ -2761,6 +3314,7 @@ STATIC char * w_save_files_status_to_cJSON() {
 
         while (hash_node != NULL) {
             data = hash_node->data;
+            data->saved = true;
             path = hash_node->key;
             memset(offset, 0, OFFSET_SIZE);
 
@@ -2870,6 +3424,7 @@ STATIC int w_update_hash_node(char * path, int64_t pos) {
     }
     memcpy(data->hash, output, sizeof(os_sha1));
     data->context = context;
+    data->saved = false;
 
     if (OSHash_Update_ex(files_status, path, data) != 1) {
         if (OSHash_Add_ex(files_status, path, data) != 2) {
@@ -18,6 +18,7 @@
 #define N_MIN_INPUT_THREADS 1
 #define N_OUPUT_THREADS 1
 #define OUTPUT_MIN_QUEUE_SIZE 128
+#define OUTPUT_QUEUE_CREDIT (OUTPUT_QUEUE_SIZE / 8)   ///< Free slots a file needs to be read
 #define WIN32_MAX_FILES 200
 
 ///< Size of hash table to save the status file
@@ -26,10 +27,17 @@
 ///< JSON path wich contains the files position of last read
 #ifdef WIN32
 #define LOCALFILE_STATUS   "queue\\logcollector\\file_status.json"
+#define LOCALFILE_STATUS_TMP    "queue\\logcollector\\file_status.json.tmp"
+#define LOCALFILE_JOURNAL  "queue\\logcollector\\file_status.journal"
 #else
 #define LOCALFILE_STATUS        "queue/logcollector/file_status.json"
+#define LOCALFILE_STATUS_TMP    "queue/logcollector/file_status.json.tmp"
+#define LOCALFILE_JOURNAL       "queue/logcollector/file_status.journal"
 #endif
 
+///< Records of the journal besides twice the files status that trigger a compaction
+#define LOCALFILE_JOURNAL_MIN   64
+
 ///< JSON fields for file_status
 #define OS_LOGCOLLECTOR_JSON_FILES      "files"
 #define OS_LOGCOLLECTOR_JSON_PATH       "path"
@@ -42,6 +50,7 @@
 #include "../config/config.h"
 #include "../os_crypto/sha1/sha1_op.h"
 #include "macos_log.h"
+#include "journald_log.h"
 
 
 /*** Function prototypes ***/
@@ -66,6 +75,66 @@ int reload_file(logreader * lf);
 /* Close file and save position */
 void close_file(logreader * lf);
 
+/**
+ * @brief Start watching the files for changes, if the file_watch option is enabled
+ * @return 1 if the files are watched, 0 if they are polled
+ */
+int w_file_watch_init();
+
+/**
+ * @brief Check whether the files are watched for changes
+ * @return 1 if the files are watched, 0 if they are polled
+ */
+int w_file_watch_enabled();
+
+/**
+ * @brief Watch an open file, unless it is on a network filesystem
+ * @param lf File to watch
+ */
+void w_file_watch_add(logreader * lf);
+
+/**
+ * @brief Watch the entries added to or removed from a directory
+ * @param path Directory to watch
+ * @return Watch descriptor, or 0 if the directory is not watched
+ */
+int w_file_watch_add_dir(const char * path);
+
+/**
+ * @brief Get the event counter of a watch
+ *
+ * The counter is shared by the watches that map to the same slot, so it may change
+ * without events on this watch but never stays the same after one.
+ * @param wd Watch descriptor
+ * @return Event counter
+ */
+unsigned int w_file_watch_events(int wd);
+
+/**
+ * @brief Stop watching a file
+ * @param lf File to stop watching
+ */
+void w_file_watch_remove(logreader * lf);
+
+/**
+ * @brief Check whether a file needs to be read
+ * @param lf File to check, with its mutex locked
+ * @return 1 if the file has changed since it was last read, or it is polled. 0 otherwise
+ */
+int w_file_watch_changed(logreader * lf);
+
+/**
+ * @brief Keep a file pending, as it was not read to the end
+ * @param lf File to keep pending, with its mutex locked
+ */
+void w_file_watch_pending(logreader * lf);
+
+/**
+ * @brief Wait for changes on the watched files
+ * @param timeout Maximum time to wait, in seconds
+ */
+void w_file_watch_wait(int timeout);
+
 /* Read syslog file */
 void *read_syslog(logreader *lf, int *rc, int drop_it);
 
@@ -128,6 +197,18 @@ void *read_multiline_regex(logreader *lf, int *rc, int drop_it);
  * @return NULL
  */
 void *read_macos(logreader *lf, int *rc, int drop_it);
+#endif
+
+#ifdef __linux__
+/**
+ * @brief Read the new entries of the systemd journal
+ *
+ * @param lf status and configuration of the journald instance
+ * @param rc output parameter, returns zero
+ * @param drop_it unused, the journal is read from its cursor
+ * @return NULL
+ */
+void *read_journald(logreader *lf, int *rc, int drop_it);
 
 #endif
 
@@ -152,6 +233,7 @@ void win_readel();
 void win_read_vista_sec();
 int win_start_event_channel(char *evt_log, char future, char *query, int reconnect_time);
 void win_format_event_string(char *string);
+extern int eventchannel_batch;
 #endif
 
 #ifndef WIN32
@@ -177,6 +259,7 @@ extern int reload_interval;
 extern int reload_delay;
 extern int free_excluded_files_interval;
 extern int state_interval;
+extern int file_watch;
 
 typedef enum {
     CONTINUE_IT,
@@ -189,12 +272,19 @@ typedef struct w_msg_queue_t{
     w_queue_t *msg_queue;
     pthread_mutex_t mutex;
     pthread_cond_t available;
+    pthread_cond_t space;       ///< Signaled when the output thread frees slots
 } w_msg_queue_t;
 
 
 /* Hash table of queues */
 extern OSHash * msg_queues_table;
 
+/* File name shared by the messages of a file */
+typedef struct w_msg_file_t {
+    int refs;
+    char name[];
+} w_msg_file_t;
+
 /* Message structure */
 typedef struct w_message_t {
     char *file;
@@ -218,8 +308,36 @@ typedef struct file_status {
     int64_t offset;  ///< Position to read
     SHA_CTX context;    ///< It stores the hashed data calculated so far
     os_sha1 hash;       ///< Content file SHA1 hash
+    bool saved;         ///< It's already in the status file or the journal
 } os_file_status_t;
 
+///< Size of the chunks read by the line reader
+#define W_LINE_READER_SIZE  (256 * 1024)
+
+///< Result of reading a line
+typedef enum {
+    W_LINE_NONE,        ///< There isn't a complete line
+    W_LINE_OK,          ///< Complete line
+    W_LINE_TRUNCATED    ///< First bytes of a line longer than the maximum. The rest is skipped
+} w_line_status_t;
+
+///< Buffered reader of the lines of a file
+typedef struct w_line_reader_t {
+    logreader * lf;
+    SHA_CTX * context;      ///< Hash of the file, updated with the committed bytes. NULL to skip it
+    char * buffer;          ///< Chunk of the file
+    size_t max_length;      ///< Maximum length of a line
+    size_t length;          ///< Bytes in the buffer
+    size_t start;           ///< First byte of the buffer not read
+    size_t hashed;          ///< Bytes of the buffer included in the hash
+    size_t end;             ///< Position after the terminator of the last line, 0 if there isn't any
+    char end_char;          ///< Byte replaced by the terminator
+    int64_t offset;         ///< File position of the buffer
+    int64_t committed;      ///< File position after the last record processed
+    bool eof;
+    bool skip;              ///< Skip the rest of a truncated line
+} w_line_reader_t;
+
 extern w_input_range_t *w_input_threads_range;
 
 /* Init queue hash table */
@@ -228,6 +346,21 @@ void w_msg_hash_queues_init();
 /* Add entry to queue hash table */
 int w_msg_hash_queues_add_entry(const char *key);
 
+/**
+ * @brief Get a reference to the shared copy of a file name
+ *
+ * Each input thread keeps the name of the last file, so consecutive lines share it.
+ * @param file File name
+ * @return Shared copy of the name, to be released with w_msg_file_release()
+ */
+char * w_msg_file_get(const char * file);
+
+/**
+ * @brief Release a reference to a file name got with w_msg_file_get()
+ * @param file Shared file name
+ */
+void w_msg_file_release(char * file);
+
 /* Push message into the hash queue */
 int w_msg_hash_queues_push(const char *str, char *file, unsigned long size, logtarget * targets, char queue_mq);
 
@@ -237,6 +370,26 @@ int w_msg_queue_push(w_msg_queue_t * msg, const char * buffer, char *file, unsig
 /* Pop message from the queue */
 w_message_t * w_msg_queue_pop(w_msg_queue_t * queue);
 
+/**
+ * @brief Pop up to max messages from the queue, waiting for the first one
+ *
+ * @param queue Message queue
+ * @param[out] messages Popped messages
+ * @param max Maximum number of messages
+ * @return Number of messages popped, at least 1
+ */
+unsigned int w_msg_queue_pop_batch(w_msg_queue_t * queue, w_message_t ** messages, unsigned int max);
+
+/**
+ * @brief Check whether the queues of some target are running out of credit
+ *
+ * The files of those targets wait, keeping their position, until the
+ * output threads free space.
+ * @param targets Targets of a localfile
+ * @return true if a queue has less than OUTPUT_QUEUE_CREDIT free slots, false otherwise
+ */
+bool w_msg_hash_queues_busy(logtarget * targets);
+
 /* Output processing thread*/
 #ifdef WIN32
 DWORD WINAPI w_output_thread(void * args);
@@ -247,11 +400,11 @@ void * w_output_thread(void * args);
 /* Prepare pool of output threads */
 void w_create_output_threads();
 
-/* Input processing thread */
+/* Input processing thread, t_id being its index in the pool */
 #ifdef WIN32
-DWORD WINAPI w_input_thread(__attribute__((unused)) void * t_id);
+DWORD WINAPI w_input_thread(void * t_id);
 #else
-void * w_input_thread(__attribute__((unused)) void * t_id);
+void * w_input_thread(void * t_id);
 #endif
 
 /* Prepare pool of input threads */
@@ -263,6 +416,9 @@ void w_set_file_mutexes();
 /* Read stop signal from reader threads */
 int can_read();
 
+/* Set the stop signal of the reader threads */
+void set_can_read(int value);
+
 /**
  * @brief Update the read position in file status hash table
  * @param path the path is the hash key
@@ -281,11 +437,46 @@ int w_update_file_status(const char * path, int64_t pos, SHA_CTX *context);
  */
 bool w_get_hash_context(logreader *lf, SHA_CTX *context, int64_t position);
 
+/**
+ * @brief Start reading the lines of a file
+ * @param reader Line reader to initialize
+ * @param lf File to read
+ * @param position Current position of the file
+ * @param max_length Maximum length of a line
+ * @param context SHA1 context of the file, updated with the committed bytes. NULL to skip it
+ */
+void w_line_reader_init(w_line_reader_t * reader, logreader * lf, int64_t position, size_t max_length, SHA_CTX * context);
+
+/**
+ * @brief Get the next line of the file
+ * @param reader Line reader
+ * @param line Set to the line, without the line feed. It is valid until the next call
+ * @param length Set to the length of the line
+ * @return W_LINE_OK, W_LINE_TRUNCATED or W_LINE_NONE if there isn't a complete line
+ */
+w_line_status_t w_line_reader_next(w_line_reader_t * reader, char ** line, size_t * length);
+
+/**
+ * @brief Mark the lines read so far as processed
+ * @param reader Line reader
+ */
+void w_line_reader_commit(w_line_reader_t * reader);
+
+/**
+ * @brief Stop reading, leaving the file after the last line committed
+ *
+ * The lines read after the last commit are read again on the next call.
+ * @param reader Line reader
+ * @return Position of the file, or -1 if it is not known
+ */
+int64_t w_line_reader_close(w_line_reader_t * reader);
+
 extern int sample_log_length;
 extern int lc_debug_level;
 extern int accept_remote;
 extern int N_INPUT_THREADS;
 extern int OUTPUT_QUEUE_SIZE;
+extern int OUTPUT_BATCH;
 #ifndef WIN32
 extern rlim_t nofile;
 #endif
@@ -0,0 +1,367 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All right reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+/* Native reader of the systemd journal.
+ * libsystemd is loaded at runtime, so the agent keeps running on hosts
+ * without it. The entries are filtered by the journal itself with the
+ * matches of the query, and the cursor of the last entry read is kept in
+ * its own file to resume after a restart.
+ */
+
+#ifdef __linux__
+
+#include "shared.h"
+#include "logcollector.h"
+#include "journald_log.h"
+#include "sym_load.h"
+
+#ifdef WAZUH_UNIT_TESTING
+// Remove STATIC qualifier from tests
+#define STATIC
+#else
+#define STATIC static
+#endif
+
+STATIC w_journald_lib_t sd;
+STATIC logreader * journald_reader;
+
+/**
+ * @brief Resolve the sd-journal functions from libsystemd
+ *
+ * @return true if every function was found, false otherwise
+ */
+STATIC bool w_journald_load_lib() {
+    void * handle;
+
+    if (sd.open != NULL) {
+        return true;
+    }
+
+    if (handle = dlopen(JOURNALD_LIB, RTLD_LAZY), handle == NULL) {
+        merror("Couldn't load '%s': %s", JOURNALD_LIB, dlerror());
+        return false;
+    }
+
+    w_journald_lib_t lib = {
+        .open = so_get_function_sym(handle, "sd_journal_open"),
+        .close = so_get_function_sym(handle, "sd_journal_close"),
+        .add_match = so_get_function_sym(handle, "sd_journal_add_match"),
+        .add_disjunction = so_get_function_sym(handle, "sd_journal_add_disjunction"),
+        .seek_head = so_get_function_sym(handle, "sd_journal_seek_head"),
+        .seek_tail = so_get_function_sym(handle, "sd_journal_seek_tail"),
+        .seek_cursor = so_get_function_sym(handle, "sd_journal_seek_cursor"),
+        .test_cursor = so_get_function_sym(handle, "sd_journal_test_cursor"),
+        .next = so_get_function_sym(handle, "sd_journal_next"),
+        .previous = so_get_function_sym(handle, "sd_journal_previous"),
+        .get_data = so_get_function_sym(handle, "sd_journal_get_data"),
+        .get_realtime_usec = so_get_function_sym(handle, "sd_journal_get_realtime_usec"),
+        .get_cursor = so_get_function_sym(handle, "sd_journal_get_cursor"),
+        .wait = so_get_function_sym(handle, "sd_journal_wait"),
+    };
+
+    if (!lib.open || !lib.close || !lib.add_match || !lib.add_disjunction || !lib.seek_head || !lib.seek_tail
+        || !lib.seek_cursor || !lib.test_cursor || !lib.next || !lib.previous || !lib.get_data
+        || !lib.get_realtime_usec || !lib.get_cursor || !lib.wait) {
+        merror("Couldn't find the sd-journal functions in '%s'.", JOURNALD_LIB);
+        dlclose(handle);
+        return false;
+    }
+
+    sd = lib;
+    return true;
+}
+
+/**
+ * @brief Add the matches of the query to the journal
+ *
+ * The query holds the same matches as journalctl: "FIELD=value" terms
+ * separated by spaces. Terms of different fields must all match, those
+ * of the same field are alternatives, and '+' separates alternative groups.
+ *
+ * @param journal sd_journal handle
+ * @param query Query of the localfile, it may be NULL
+ */
+STATIC void w_journald_add_matches(void * journal, const char * query) {
+    char * copy;
+    char * save_ptr = NULL;
+    int ret;
+
+    if (query == NULL) {
+        return;
+    }
+
+    os_strdup(query, copy);
+
+    for (char * term = strtok_r(copy, " \t\n", &save_ptr); term; term = strtok_r(NULL, " \t\n", &save_ptr)) {
+        if (strcmp(term, "+") == 0) {
+            ret = sd.add_disjunction(journal);
+        } else if (term[0] == '=' || strchr(term, '=') == NULL) {
+            mwarn("Invalid journald match '%s', it will be ignored.", term);
+            continue;
+        } else {
+            ret = sd.add_match(journal, term, 0);
+        }
+
+        if (ret < 0) {
+            mwarn("Couldn't add journald match '%s': %s (%d)", term, strerror(-ret), -ret);
+        }
+    }
+
+    os_free(copy);
+}
+
+/**
+ * @brief Open the journal and place it right after the last entry read
+ *
+ * Without a cursor, only new entries are read if `only-future-events` is set.
+ *
+ * @param lf journald localfile
+ * @return true if the journal is ready to be read, false otherwise
+ */
+STATIC bool w_journald_open(logreader * lf) {
+    w_journald_config_t * cfg = lf->journald;
+    void * journal = NULL;
+    char * cursor = NULL;
+    int ret;
+
+    if (!w_journald_load_lib()) {
+        cfg->disabled = true;
+        return false;
+    }
+
+    if (ret = sd.open(&journal, JOURNALD_LOCAL_ONLY), ret < 0) {
+        merror("Couldn't open the journal: %s (%d)", strerror(-ret), -ret);
+        cfg->disabled = true;
+        return false;
+    }
+
+    w_journald_add_matches(journal, lf->query);
+
+    w_mutex_lock(&cfg->mutex);
+    if (cfg->cursor != NULL) {
+        os_strdup(cfg->cursor, cursor);
+    }
+    w_mutex_unlock(&cfg->mutex);
+
+    if (cursor != NULL && sd.seek_cursor(journal, cursor) >= 0) {
+        /* The entry of the cursor was already sent, unless it's gone */
+        if (sd.next(journal) > 0 && sd.test_cursor(journal, cursor) <= 0) {
+            sd.previous(journal);
+        }
+
+        mdebug1("Reading the journal from cursor '%s'.", cursor);
+    } else if (lf->future) {
+        sd.seek_tail(journal);
+        sd.previous(journal);
+    } else {
+        sd.seek_head(journal);
+    }
+
+    os_free(cursor);
+    cfg->journal = journal;
+    return true;
+}
+
+/**
+ * @brief Copy the value of a field of the current entry
+ *
+ * @param journal sd_journal handle
+ * @param field Field name
+ * @param[out] value Buffer for the value, truncated to its size
+ * @param size Size of the buffer
+ * @return Length of the value, 0 if the entry doesn't have the field
+ */
+STATIC size_t w_journald_get_field(void * journal, const char * field, char * value, size_t size) {
+    const size_t prefix = strlen(field) + 1;
+    const void * data;
+    size_t length;
+
+    if (sd.get_data(journal, field, &data, &length) < 0 || length < prefix) {
+        *value = '\0';
+        return 0;
+    }
+
+    length = MIN(length - prefix, size - 1);
+    memcpy(value, (const char *)data + prefix, length);
+    value[length] = '\0';
+    return length;
+}
+
+/**
+ * @brief Format the current entry as a syslog line
+ *
+ * The line is "Mmm dd hh:mm:ss host ident[pid]: message", like journalctl prints it.
+ *
+ * @param journal sd_journal handle
+ * @param[out] buffer Buffer for the line
+ * @param size Size of the buffer
+ * @return Length of the line, 0 if the entry has no message
+ */
+STATIC size_t w_journald_format_entry(void * journal, char * buffer, size_t size) {
+    char message[OS_MAXSTR - OS_LOG_HEADER];
+    char hostname[JOURNALD_FIELD_MAX];
+    char ident[JOURNALD_FIELD_MAX];
+    char pid[JOURNALD_FIELD_MAX];
+    char timestamp[OS_SIZE_32];
+    uint64_t usec;
+    struct tm tm;
+    time_t now;
+    int length;
+
+    if (w_journald_get_field(journal, "MESSAGE", message, sizeof(message)) == 0) {
+        return 0;
+    }
+
+    now = sd.get_realtime_usec(journal, &usec) >= 0 ? (time_t)(usec / 1000000) : time(NULL);
+    localtime_r(&now, &tm);
+    strftime(timestamp, sizeof(timestamp), "%b %d %T", &tm);
+
+    if (w_journald_get_field(journal, "_HOSTNAME", hostname, sizeof(hostname)) == 0) {
+        strcpy(hostname, "localhost");
+    }
+
+    if (w_journald_get_field(journal, "SYSLOG_IDENTIFIER", ident, sizeof(ident)) == 0) {
+        w_journald_get_field(journal, "_COMM", ident, sizeof(ident));
+    }
+
+    if (w_journald_get_field(journal, "SYSLOG_PID", pid, sizeof(pid)) == 0) {
+        w_journald_get_field(journal, "_PID", pid, sizeof(pid));
+    }
+
+    if (*ident == '\0') {
+        length = snprintf(buffer, size, "%s %s %s", timestamp, hostname, message);
+    } else if (*pid == '\0') {
+        length = snprintf(buffer, size, "%s %s %s: %s", timestamp, hostname, ident, message);
+    } else {
+        length = snprintf(buffer, size, "%s %s %s[%s]: %s", timestamp, hostname, ident, pid, message);
+    }
+
+    return length < 0 ? 0 : MIN((size_t)length, size - 1);
+}
+
+void w_journald_init(logreader * lf) {
+    char buffer[OS_MAXSTR];
+    FILE * fp;
+
+    journald_reader = lf;
+
+    if (fp = wfopen(JOURNALD_CURSOR_FILE, "r"), fp != NULL) {
+        if (fgets(buffer, sizeof(buffer), fp) != NULL) {
+            buffer[strcspn(buffer, "\n")] = '\0';
+
+            if (*buffer != '\0') {
+                os_strdup(buffer, lf->journald->cursor);
+                lf->journald->cursor_saved = true;
+            }
+        }
+
+        fclose(fp);
+    }
+
+    if (atexit(w_journald_save_cursor)) {
+        merror(ATEXIT_ERROR);
+    }
+}
+
+void w_journald_save_cursor(void) {
+    w_journald_config_t * cfg;
+    char * cursor = NULL;
+    FILE * fp;
+
+    if (journald_reader == NULL || (cfg = journald_reader->journald) == NULL) {
+        return;
+    }
+
+    w_mutex_lock(&cfg->mutex);
+    if (!cfg->cursor_saved && cfg->cursor != NULL) {
+        os_strdup(cfg->cursor, cursor);
+        cfg->cursor_saved = true;
+    }
+    w_mutex_unlock(&cfg->mutex);
+
+    if (cursor == NULL) {
+        return;
+    }
+
+    /* The file is replaced at once, so a crash leaves the previous cursor */
+    if (fp = wfopen(JOURNALD_CURSOR_FILE ".tmp", "w"), fp == NULL) {
+        merror(FOPEN_ERROR, JOURNALD_CURSOR_FILE ".tmp", errno, strerror(errno));
+    } else {
+        bool written = fprintf(fp, "%s\n", cursor) > 0 && fflush(fp) == 0;
+        fsync(fileno(fp));
+        fclose(fp);
+
+        if (!written || rename_ex(JOURNALD_CURSOR_FILE ".tmp", JOURNALD_CURSOR_FILE) != 0) {
+            merror(FWRITE_ERROR, JOURNALD_CURSOR_FILE, errno, strerror(errno));
+            w_mutex_lock(&cfg->mutex);
+            cfg->cursor_saved = false;
+            w_mutex_unlock(&cfg->mutex);
+        }
+    }
+
+    os_free(cursor);
+}
+
+void * read_journald(logreader * lf, int * rc, __attribute__((unused)) int drop_it) {
+    w_journald_config_t * cfg = lf->journald;
+    char buffer[OS_MAXSTR];
+    char * cursor = NULL;
+    int count = 0;
+    size_t size;
+    int ret;
+
+    *rc = 0;
+
+    if (cfg->disabled || (cfg->journal == NULL && !w_journald_open(lf))) {
+        return NULL;
+    }
+
+    /* Pick up the appended entries and the rotated journal files, without blocking */
+    if (ret = sd.wait(cfg->journal, 0), ret < 0) {
+        mdebug1("Couldn't process the journal changes: %s (%d)", strerror(-ret), -ret);
+    }
+
+    while ((maximum_lines == 0 || count < maximum_lines) && can_read()) {
+        if (ret = sd.next(cfg->journal), ret <= 0) {
+            if (ret < 0) {
+                merror("Couldn't read the journal: %s (%d)", strerror(-ret), -ret);
+            }
+
+            break;
+        }
+
+        count++;
+
+        if (size = w_journald_format_entry(cfg->journal, buffer, sizeof(buffer)), size == 0) {
+            continue;
+        }
+
+        /* Check ignore and restrict log regex, if configured. */
+        if (check_ignore_and_restrict(lf->regex_ignore, lf->regex_restrict, buffer)) {
+            continue;
+        }
+
+        mdebug2("Reading journald message: '%.*s'%s", sample_log_length, buffer, size >= (size_t)sample_log_length ? "..." : "");
+        w_msg_hash_queues_push(buffer, JOURNALD_LOG_NAME, size + 1, lf->log_target, LOCALFILE_MQ);
+    }
+
+    /* A single cursor covers the whole batch */
+    if (count > 0 && sd.get_cursor(cfg->journal, &cursor) >= 0) {
+        w_mutex_lock(&cfg->mutex);
+        os_free(cfg->cursor);
+        os_strdup(cursor, cfg->cursor);
+        cfg->cursor_saved = false;
+        w_mutex_unlock(&cfg->mutex);
+        free(cursor);
+    }
+
+    return NULL;
+}
+
+#endif /* __linux__ */
@@ -19,12 +19,13 @@ void *read_multiline(logreader *lf, int *rc, int drop_it) {
     int __ms_reported = 0;
     int linesgot = 0;
     size_t buffer_size = 0;
-    char str[OS_MAX_LOG_SIZE] = {0};
+    char *str;
     char buffer[OS_MAX_LOG_SIZE] = {0};
     int lines = 0;
     int size = 0;
-    int64_t offset = 0;
-    int64_t rbytes = 0;
+    w_line_reader_t reader;
+    w_line_status_t status = W_LINE_NONE;
+    size_t length;
 
     *rc = 0;
 
@@ -33,46 +34,20 @@ void *read_multiline(logreader *lf, int *rc, int drop_it) {
     int64_t current_position = w_ftell(lf->fp);
     bool is_valid_context_file = w_get_hash_context(lf, &context, current_position);
 
-    for (offset = w_ftell(lf->fp); can_read() && fgets(str, OS_MAX_LOG_SIZE, lf->fp) != NULL && (!maximum_lines || lines < maximum_lines) && offset >= 0; offset += rbytes) {
-        rbytes = w_ftell(lf->fp) - offset;
+    w_line_reader_init(&reader, lf, current_position, OS_MAX_LOG_SIZE - 1, is_valid_context_file ? &context : NULL);
+
+    while (can_read() && (!maximum_lines || lines < maximum_lines) && (status = w_line_reader_next(&reader, &str, &length)) != W_LINE_NONE) {
         lines++;
         linesgot++;
 
-        /* Flow control */
-        if (rbytes <= 0) {
-            break;
-        }
-
-        /* Get the last occurrence of \n */
-        if (str[rbytes - 1] == '\n') {
-            if (is_valid_context_file) {
-                OS_SHA1_Stream(&context, NULL, str);
-            }
-            str[rbytes - 1] = '\0';
-
-            if ((int64_t)strlen(str) != rbytes - 1)
-            {
-                mdebug2("Line in '%s' contains some zero-bytes (valid=" FTELL_TT " / total=" FTELL_TT "). Dropping line.", lf->file, FTELL_INT64 strlen(str), FTELL_INT64 rbytes - 1);
-                continue;
-            }
+        if (strlen(str) != length) {
+            mdebug2("Line in '%s' contains some zero-bytes (valid=" FTELL_TT " / total=" FTELL_TT "). Dropping line.", lf->file, FTELL_INT64 strlen(str), FTELL_INT64 length);
+            continue;
         }
 
-        /* If we didn't get the new line, because the
-         * size is large, send what we got so far.
-         */
-        else if (rbytes == OS_MAX_LOG_SIZE - 1) {
-            /* Message size > maximum allowed */
-            if (is_valid_context_file) {
-                OS_SHA1_Stream(&context, NULL, str);
-            }
+        /* Message size > maximum allowed, the rest of the line is skipped */
+        if (status == W_LINE_TRUNCATED) {
             __ms = 1;
-        } else if (feof(lf->fp)) {
-            /* Message not complete. Return. */
-            mdebug2("Message not complete from '%s'. Trying again: '%.*s'%s", lf->file, sample_log_length, str, rbytes > sample_log_length ? "..." : "");
-            if(current_position >= 0) {
-                w_fseek(lf->fp, current_position, SEEK_SET);
-            }
-            break;
         }
 
 #ifdef WIN32
@@ -100,6 +75,7 @@ void *read_multiline(logreader *lf, int *rc, int drop_it) {
             continue;
         }
         linesgot = 0;
+        w_line_reader_commit(&reader);
 
         /* Check ignore and restrict log regex, if configured. */
         if (drop_it == 0 && !check_ignore_and_restrict(lf->regex_ignore, lf->regex_restrict, buffer)) {
@@ -114,36 +90,24 @@ void *read_multiline(logreader *lf, int *rc, int drop_it) {
         /* Incorrect message size */
         if (__ms) {
             if (!__ms_reported) {
-                merror("Large message size from file '%s' (length = " FTELL_TT "): '%.*s'...", lf->file, FTELL_INT64 rbytes, sample_log_length, str);
+                merror("Large message size from file '%s' (length = " FTELL_TT "): '%.*s'...", lf->file, FTELL_INT64 length, sample_log_length, str);
                 __ms_reported = 1;
             } else {
-                mdebug2("Large message size from file '%s' (length = " FTELL_TT "): '%.*s'...", lf->file, FTELL_INT64 rbytes, sample_log_length, str);
+                mdebug2("Large message size from file '%s' (length = " FTELL_TT "): '%.*s'...", lf->file, FTELL_INT64 length, sample_log_length, str);
             }
 
-            for (offset += rbytes; fgets(str, sizeof(str), lf->fp) != NULL; offset += rbytes) {
-                rbytes = w_ftell(lf->fp) - offset;
-
-                /* Flow control */
-                if (rbytes <= 0) {
-                    break;
-                }
-
-                if (is_valid_context_file) {
-                    OS_SHA1_Stream(&context, NULL, str);
-                }
-
-                /* Get the last occurrence of \n */
-                if (str[rbytes - 1] == '\n') {
-                    break;
-                }
-            }
             __ms = 0;
         }
+    }
 
-        current_position = w_ftell(lf->fp);
+    /* The lines of an incomplete message are read again, unless the reading was interrupted */
+    if (status != W_LINE_NONE) {
+        w_line_reader_commit(&reader);
     }
 
-    if (is_valid_context_file) {
+    current_position = w_line_reader_close(&reader);
+
+    if (is_valid_context_file && current_position >= 0) {
         w_update_file_status(lf->file, current_position, &context);
     }
 
@@ -17,68 +17,30 @@
 
 /* Read syslog files */
 void *read_syslog(logreader *lf, int *rc, int drop_it) {
-    int __ms = 0;
     int __ms_reported = 0;
-    char str[OS_MAXSTR + 1];
-    int64_t current_position = 0;
     int lines = 0;
-    int64_t offset = 0;
-    int64_t rbytes = 0;
+    w_line_reader_t reader;
+    w_line_status_t status;
+    size_t length;
+    char *str;
 
-    str[OS_MAXSTR] = '\0';
     *rc = 0;
 
     /* Obtain context to calculate hash */
-    current_position = w_ftell(lf->fp);
+    int64_t current_position = w_ftell(lf->fp);
 
     SHA_CTX context;
     bool is_valid_context_file = w_get_hash_context(lf, &context, current_position);
 
-    for (offset = w_ftell(lf->fp); can_read() && fgets(str, OS_MAXSTR - OS_LOG_HEADER, lf->fp) != NULL && (!maximum_lines || lines < maximum_lines) && offset >= 0; offset += rbytes) {
-        rbytes = w_ftell(lf->fp) - offset;
-        lines++;
-
-        /* Flow control */
-        if (rbytes <= 0) {
-            break;
-        }
-
-        /* Get the last occurrence of \n */
-        if (str[rbytes - 1] == '\n') {
-            if (is_valid_context_file) {
-                OS_SHA1_Stream(&context, NULL, str);
-            }
-            str[rbytes - 1] = '\0';
+    w_line_reader_init(&reader, lf, current_position, OS_MAXSTR - OS_LOG_HEADER - 2, is_valid_context_file ? &context : NULL);
 
-            if ((int64_t)strlen(str) != rbytes - 1)
-            {
-                mdebug2("Line in '%s' contains some zero-bytes (valid=" FTELL_TT "/ total=" FTELL_TT "). Dropping line.", lf->file, FTELL_INT64 strlen(str), FTELL_INT64 rbytes - 1);
-                continue;
-            }
-        }
+    while (can_read() && (!maximum_lines || lines < maximum_lines) && (status = w_line_reader_next(&reader, &str, &length)) != W_LINE_NONE) {
+        lines++;
+        w_line_reader_commit(&reader);
 
-        /* If we didn't get the new line, because the
-         * size is large, send what we got so far.
-         */
-        else if (rbytes == OS_MAXSTR - OS_LOG_HEADER - 1) {
-            /* Message size > maximum allowed */
-            __ms = 1;
-            if (is_valid_context_file) {
-                OS_SHA1_Stream(&context, NULL, str);
-            }
-            str[rbytes - 1] = '\0';
-        } else {
-            /* We may not have gotten a line feed
-             * because we reached EOF.
-             */
-             if (feof(lf->fp)) {
-                /* Message not complete. Return. */
-                mdebug2("Message not complete from '%s'. Trying again: '%.*s'%s", lf->file, sample_log_length, str, rbytes > sample_log_length ? "..." : "");
-                if(current_position >= 0) {
-                    w_fseek(lf->fp, current_position, SEEK_SET);
-                }
-                break;
-            }
+        if (strlen(str) != length) {
+            mdebug2("Line in '%s' contains some zero-bytes (valid=" FTELL_TT "/ total=" FTELL_TT "). Dropping line.", lf->file, FTELL_INT64 strlen(str), FTELL_INT64 length);
+            continue;
         }
 
 #ifdef WIN32
@@ -89,61 +51,38 @@ void *read_syslog(logreader *lf, int *rc, int drop_it) {
         }
 
         /* Look for empty string (only on Windows) */
-        if (rbytes <= 2) {
-            current_position = w_ftell(lf->fp);
+        if (length <= 1) {
             continue;
         }
 
         /* Windows can have comment on their logs */
         if (str[0] == '#') {
-            current_position = w_ftell(lf->fp);
             continue;
         }
 #endif
 
-        mdebug2("Reading syslog message: '%.*s'%s", sample_log_length, str, rbytes > sample_log_length ? "..." : "");
+        mdebug2("Reading syslog message: '%.*s'%s", sample_log_length, str, length >= (size_t)sample_log_length ? "..." : "");
 
         /* Check ignore and restrict log regex, if configured. */
         if (drop_it == 0 && !check_ignore_and_restrict(lf->regex_ignore, lf->regex_restrict, str)) {
             /* Send message to queue */
-            w_msg_hash_queues_push(str, lf->file, rbytes, lf->log_target, LOCALFILE_MQ);
+            w_msg_hash_queues_push(str, lf->file, length + 1, lf->log_target, LOCALFILE_MQ);
         }
 
-        /* Incorrect message size */
-        if (__ms) {
-            // strlen(str) >= (OS_MAXSTR - OS_LOG_HEADER - 2)
-            // truncate str before logging to ossec.log
-
+        /* Incorrect message size, the rest of the line is skipped */
+        if (status == W_LINE_TRUNCATED) {
             if (!__ms_reported) {
-                merror("Large message size from file '%s' (length = " FTELL_TT "): '%.*s'...", lf->file, FTELL_INT64 rbytes, sample_log_length, str);
+                merror("Large message size from file '%s' (length = " FTELL_TT "): '%.*s'...", lf->file, FTELL_INT64 length, sample_log_length, str);
                 __ms_reported = 1;
             } else {
-                mdebug2("Large message size from file '%s' (length = " FTELL_TT "): '%.*s'...", lf->file, FTELL_INT64 rbytes, sample_log_length, str);
+                mdebug2("Large message size from file '%s' (length = " FTELL_TT "): '%.*s'...", lf->file, FTELL_INT64 length, sample_log_length, str);
             }
-
-            for (offset += rbytes; fgets(str, OS_MAXSTR - 2, lf->fp) != NULL; offset += rbytes) {
-                rbytes = w_ftell(lf->fp) - offset;
-
-                /* Flow control */
-                if (rbytes <= 0) {
-                    break;
-                }
-
-                if (is_valid_context_file) {
-                    OS_SHA1_Stream(&context, NULL, str);
-                }
-
-                /* Get the last occurrence of \n */
-                if (str[rbytes - 1] == '\n') {
-                    break;
-                }
-            }
-            __ms = 0;
         }
-        current_position = w_ftell(lf->fp);
     }
 
-    if (is_valid_context_file) {
+    current_position = w_line_reader_close(&reader);
+
+    if (is_valid_context_file && current_position >= 0) {
         w_update_file_status(lf->file, current_position, &context);
     }
 
@@ -66,11 +66,43 @@ typedef struct _os_channel {
     char *query;
     int reconnect_time;
     EVT_HANDLE subscription;
+    /* Signaled by the service when a pull subscription has new events */
+    HANDLE signal;
+    /* Callbacks of a push subscription may run on different threads */
+    pthread_mutex_t mutex;
+    /* Render buffers, kept at the largest size needed so far */
+    void *render_buffer;
+    DWORD render_size;
+    EVT_HANDLE bookmark;
+    void *bookmark_buffer;
+    DWORD bookmark_size;
 } os_channel;
 
+/* Events pulled with every EvtNext() call, 0 subscribes with callbacks */
+int eventchannel_batch;
+
 static char *get_message(EVT_HANDLE evt, LPCWSTR provider_name, DWORD flags);
 static EVT_HANDLE read_bookmark(os_channel *channel);
 
+/* Render into a buffer of the channel, growing it if needed. Returns TRUE on success, as EvtRender(). */
+static BOOL render_buffer(EVT_HANDLE fragment, DWORD flags, void **buffer, DWORD *size, DWORD *used)
+{
+    DWORD count = 0;
+
+    if (EvtRender(NULL, fragment, flags, *size, *buffer, used, &count)) {
+        return TRUE;
+    }
+
+    if (GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+        return FALSE;
+    }
+
+    os_realloc(*buffer, *used, *buffer);
+    *size = *used;
+
+    return EvtRender(NULL, fragment, flags, *size, *buffer, used, &count);
+}
+
 wchar_t *convert_unix_string(char *string)
 {
     wchar_t *dest = NULL;
@@ -270,70 +302,32 @@ EVT_HANDLE read_bookmark(os_channel *channel)
 int update_bookmark(EVT_HANDLE evt, os_channel *channel)
 {
     DWORD size = 0;
-    DWORD count = 0;
-    void *buffer = NULL;
-    int result = 0;
-    int status = 0;
-    EVT_HANDLE bookmark = NULL;
     FILE *fp = NULL;
 
-    if ((bookmark = EvtCreateBookmark(NULL)) == NULL) {
+    if (channel->bookmark == NULL && (channel->bookmark = EvtCreateBookmark(NULL)) == NULL) {
         merror(
             "Could not EvtCreateBookmark() bookmark (%s) for (%s) which returned (%lu)",
             channel->bookmark_filename,
             channel->evt_log,
             GetLastError());
-        goto cleanup;
+        return (0);
     }
 
-    if (!EvtUpdateBookmark(bookmark, evt)) {
+    if (!EvtUpdateBookmark(channel->bookmark, evt)) {
         merror(
             "Could not EvtUpdateBookmark() bookmark (%s) for (%s) which returned (%lu)",
             channel->bookmark_filename,
             channel->evt_log,
             GetLastError());
-        goto cleanup;
-    }
-
-    /* Make initial call to determine buffer size */
-    result = EvtRender(NULL,
-                       bookmark,
-                       EvtRenderBookmark,
-                       0,
-                       NULL,
-                       &size,
-                       &count);
-    if (result != FALSE || GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
-        merror(
-            "Could not EvtRender() to get buffer size to update bookmark (%s) for (%s) which returned (%lu)",
-            channel->bookmark_filename,
-            channel->evt_log,
-            GetLastError());
-        goto cleanup;
+        return (0);
     }
 
-    if (buffer = calloc(size, sizeof(void)), buffer == NULL) {
-        merror(
-            "Could not calloc() memory to save bookmark (%s) for (%s) which returned [(%d)-(%s)]",
-            channel->bookmark_filename,
-            channel->evt_log,
-            errno,
-            strerror(errno));
-        goto cleanup;
-    }
-
-    if (!EvtRender(NULL,
-                   bookmark,
-                   EvtRenderBookmark,
-                   size,
-                   buffer,
-                   &size,
-                   &count)) {
+    if (!render_buffer(channel->bookmark, EvtRenderBookmark, &channel->bookmark_buffer, &channel->bookmark_size, &size)) {
         merror(
             "Could not EvtRender() bookmark (%s) for (%s) which returned (%lu)",
             channel->bookmark_filename, channel->evt_log,
             GetLastError());
-        goto cleanup;
+        return (0);
     }
 
     if ((fp = fopen(channel->bookmark_filename, "w")) == NULL) {
@@ -343,45 +337,29 @@ int update_bookmark(EVT_HANDLE evt, os_channel *channel)
             channel->evt_log,
             errno,
             strerror(errno));
-        goto cleanup;
+        return (0);
     }
 
-    if ((fwrite(buffer, 1, size, fp)) < size) {
+    if ((fwrite(channel->bookmark_buffer, 1, size, fp)) < size) {
         merror(
             "Could not fwrite() to bookmark (%s) for (%s) which returned [(%d)-(%s)]",
             channel->bookmark_filename,
             channel->evt_log,
             errno,
             strerror(errno));
-        goto cleanup;
+        fclose(fp);
+        return (0);
     }
 
     fclose(fp);
 
-    /* Success */
-    status = 1;
-
-cleanup:
-    free(buffer);
-
-    if (bookmark != NULL) {
-        EvtClose(bookmark);
-    }
-
-    if (fp) {
-        fclose(fp);
-    }
-
-    return (status);
+    return (1);
 }
 
 
 void send_channel_event(EVT_HANDLE evt, os_channel *channel)
 {
     DWORD buffer_length = 0;
-    PEVT_VARIANT properties_values = NULL;
-    DWORD count = 0;
-    int result = 0;
     wchar_t *wprovider_name = NULL;
     char *msg_sent = NULL;
     char *provider_name = NULL;
@@ -396,44 +374,15 @@ void send_channel_event(EVT_HANDLE evt, os_channel *channel)
 
     os_malloc(OS_MAXSTR, provider_name);
 
-    result = EvtRender(NULL,
-                       evt,
-                       EvtRenderEventXml,
-                       0,
-                       NULL,
-                       &buffer_length,
-                       &count);
-    if (result != FALSE || GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
-        merror(
-            "Could not EvtRender() to determine buffer size for (%s) which returned (%lu)",
-            channel->evt_log,
-            GetLastError());
-        goto cleanup;
-    }
-
-    if ((properties_values = malloc(buffer_length)) == NULL) {
-        merror(
-            "Could not malloc() memory to process event (%s) which returned [(%d)-(%s)]",
-            channel->evt_log,
-            errno,
-            strerror(errno));
-        goto cleanup;
-    }
-
-    if (!EvtRender(NULL,
-                   evt,
-                   EvtRenderEventXml,
-                   buffer_length,
-                   properties_values,
-                   &buffer_length,
-                   &count)) {
+    if (!render_buffer(evt, EvtRenderEventXml, &channel->render_buffer, &channel->render_size, &buffer_length)) {
         merror(
             "Could not EvtRender() for (%s) which returned (%lu)",
             channel->evt_log,
             GetLastError());
         goto cleanup;
     }
-    xml_event = convert_windows_string((LPCWSTR) properties_values);
+
+    xml_event = convert_windows_string((LPCWSTR) channel->render_buffer);
 
     if (!xml_event) {
         goto cleanup;
@@ -490,15 +439,10 @@ void send_channel_event(EVT_HANDLE evt, os_channel *channel)
         w_logcollector_state_update_target(channel->evt_log, "agent", false);
     }
 
-    if (channel->bookmark_enabled) {
-        update_bookmark(evt, channel);
-    }
-
 cleanup:
     os_free(msg_from_prov);
     os_free(xml_event);
     os_free(msg_sent);
-    os_free(properties_values);
     os_free(provider_name);
     os_free(wprovider_name);
     cJSON_Delete(event_json);
@@ -524,31 +468,105 @@ void os_channel_destroy(os_channel * channel) {
             }
         }
 
+        if (channel->signal != NULL) {
+            CloseHandle(channel->signal);
+        }
+
+        if (channel->bookmark != NULL) {
+            EvtClose(channel->bookmark);
+        }
+
+        free(channel->render_buffer);
+        free(channel->bookmark_buffer);
+        w_mutex_destroy(&channel->mutex);
         free(channel);
     }
 }
 
+/* Subscribe the channel again once the eventlog service is back, then release the old subscription */
+static void event_channel_reconnect(os_channel *channel)
+{
+    mwarn("The eventlog service is down. Unable to collect logs from '%s' channel.", channel->evt_log);
+
+    while(1) {
+        /* Try to restart EventChannel */
+        if (win_start_event_channel(channel->evt_log, !channel->bookmark_enabled, channel->query, channel->reconnect_time) == -1) {
+            mdebug1("Trying to reconnect %s channel in %i seconds.", channel->evt_log, channel->reconnect_time );
+            sleep(channel->reconnect_time);
+        } else {
+            minfo("'%s' channel has been reconnected succesfully.", channel->evt_log);
+            os_channel_destroy(channel);
+            break;
+        }
+    }
+}
+
 DWORD WINAPI event_channel_callback(EVT_SUBSCRIBE_NOTIFY_ACTION action, os_channel *channel, EVT_HANDLE evt)
 {
     if (action == EvtSubscribeActionDeliver) {
+        w_mutex_lock(&channel->mutex);
         send_channel_event(evt, channel);
+
+        if (channel->bookmark_enabled) {
+            update_bookmark(evt, channel);
+        }
+
+        w_mutex_unlock(&channel->mutex);
     } else {
-        mwarn("The eventlog service is down. Unable to collect logs from '%s' channel.", channel->evt_log);
-
-        while(1) {
-            /* Try to restart EventChannel */
-            if (win_start_event_channel(channel->evt_log, !channel->bookmark_enabled, channel->query, channel->reconnect_time) == -1) {
-                mdebug1("Trying to reconnect %s channel in %i seconds.", channel->evt_log, channel->reconnect_time );
-                sleep(channel->reconnect_time);
-            } else {
-                minfo("'%s' channel has been reconnected succesfully.", channel->evt_log);
-                os_channel_destroy(channel);
-                break;
+        event_channel_reconnect(channel);
+    }
+
+    return (0);
+}
+
+/**
+ * @brief Pull the events of a channel in batches
+ *
+ * The events are fetched with EvtNext() until the subscription is drained,
+ * then the thread waits for the signal of the service. The bookmark is saved
+ * once per batch, after its last event.
+ *
+ * @param args Pointer to the os_channel structure, owned by the thread.
+ */
+static DWORD WINAPI event_channel_pull(void * args)
+{
+    os_channel *channel = (os_channel *)args;
+    EVT_HANDLE *events = NULL;
+    DWORD returned;
+    DWORD error;
+    DWORD i;
+
+    os_calloc(eventchannel_batch, sizeof(EVT_HANDLE), events);
+
+    while (1) {
+        /* Reset before draining, so events arriving meanwhile signal again */
+        WaitForSingleObject(channel->signal, loop_timeout * 1000);
+        ResetEvent(channel->signal);
+
+        while (EvtNext(channel->subscription, eventchannel_batch, events, INFINITE, 0, &returned)) {
+            for (i = 0; i < returned; i++) {
+                send_channel_event(events[i], channel);
+            }
+
+            if (channel->bookmark_enabled && returned > 0) {
+                update_bookmark(events[returned - 1], channel);
+            }
+
+            for (i = 0; i < returned; i++) {
+                EvtClose(events[i]);
             }
         }
+
+        if (error = GetLastError(), error != ERROR_NO_MORE_ITEMS) {
+            mdebug1("Could not EvtNext() for (%s) which returned (%lu)", channel->evt_log, error);
+            break;
+        }
     }
 
-    return (0);
+    os_free(events);
+    event_channel_reconnect(channel);
+
+    return 0;
 }
 
 int win_start_event_channel(char *evt_log, char future, char *query, int reconnect_time)
@@ -562,6 +580,7 @@ int win_start_event_channel(char *evt_log, char future, char *query, int reconne
     int status = 0;
 
     os_calloc(1, sizeof(os_channel), channel);
+    w_mutex_init(&channel->mutex, NULL);
 
     channel->evt_log = evt_log;
     channel->reconnect_time = reconnect_time;
@@ -622,23 +641,32 @@ int win_start_event_channel(char *evt_log, char future, char *query, int reconne
         }
     }
 
+    /* Pull subscriptions get a manual-reset event, signaled from the start to drain the backlog */
+    if (eventchannel_batch > 0 && (channel->signal = CreateEvent(NULL, TRUE, TRUE, NULL)) == NULL) {
+        merror(
+            "Could not CreateEvent() for (%s) which returned (%lu)",
+            channel->evt_log,
+            GetLastError());
+        goto cleanup;
+    }
+
     channel->subscription = EvtSubscribe(NULL,
-                          NULL,
+                          channel->signal,
                           wchannel,
                           wquery,
                           bookmark,
-                          channel,
-                          (EVT_SUBSCRIBE_CALLBACK)event_channel_callback,
+                          channel->signal ? NULL : channel,
+                          channel->signal ? NULL : (EVT_SUBSCRIBE_CALLBACK)event_channel_callback,
                           flags);
 
     if (channel->subscription == NULL && flags == EvtSubscribeStartAfterBookmark) {
         channel->subscription = EvtSubscribe(NULL,
-                              NULL,
+                              channel->signal,
                               wchannel,
                               wquery,
                               NULL,
-                              channel,
-                              (EVT_SUBSCRIBE_CALLBACK)event_channel_callback,
+                              channel->signal ? NULL : channel,
+                              channel->signal ? NULL : (EVT_SUBSCRIBE_CALLBACK)event_channel_callback,
                               EvtSubscribeToFutureEvents);
     }
 
@@ -656,6 +684,15 @@ int win_start_event_channel(char *evt_log, char future, char *query, int reconne
     w_logcollector_state_add_file(channel->evt_log);
     w_logcollector_state_add_target(channel->evt_log, "agent");
 
+    if (channel->signal != NULL) {
+        w_create_thread(NULL,
+                        0,
+                        event_channel_pull,
+                        channel,
+                        0,
+                        NULL);
+    }
+
     /* Success */
     status = 1;
 
@@ -63,6 +63,15 @@ STATIC void _w_logcollector_state_update_file(w_lc_state_storage_t * state, char
  */
 STATIC void _w_logcollector_state_update_target(w_lc_state_storage_t * state, char * fpath, char * target, bool dropped);
 
+/**
+ * @brief Register the duration of a read call on a file/location of `state`
+ *
+ * @param state state to be used
+ * @param fpath file path or locafile location value
+ * @param usec duration of the read call, in microseconds
+ */
+STATIC void _w_logcollector_state_update_read(w_lc_state_storage_t * state, char * fpath, uint64_t usec);
+
 /**
  * @brief Removes the `fpath` file from `state`
  *
@@ -278,6 +287,41 @@ void _w_logcollector_state_update_target(w_lc_state_storage_t * state, char * fp
     }
 }
 
+void w_logcollector_state_update_read(char * fpath, uint64_t usec) {
+
+    if (fpath == NULL) {
+        return;
+    }
+
+    w_mutex_lock(&g_lc_raw_stats_mutex);
+
+    if (g_lc_state_type & LC_STATE_GLOBAL) {
+        _w_logcollector_state_update_read(g_lc_states_global, fpath, usec);
+    }
+    if (g_lc_state_type & LC_STATE_INTERVAL) {
+        _w_logcollector_state_update_read(g_lc_states_interval, fpath, usec);
+    }
+
+    w_mutex_unlock(&g_lc_raw_stats_mutex);
+}
+
+void _w_logcollector_state_update_read(w_lc_state_storage_t * state, char * fpath, uint64_t usec) {
+
+    w_lc_state_file_t * data = NULL;
+
+    // Only files already registered are measured
+    if (data = (w_lc_state_file_t *) OSHash_Get(state->states, fpath), data == NULL) {
+        return;
+    }
+
+    data->reads++;
+    data->read_usec += usec;
+
+    if (usec > data->read_max_usec) {
+        data->read_max_usec = usec;
+    }
+}
+
 void w_logcollector_state_delete_file(char * fpath) {
 
     if (fpath == NULL) {
@@ -396,11 +440,19 @@ cJSON * _w_logcollector_generate_state(w_lc_state_storage_t * state, bool restar
         cJSON_AddStringToObject(lc_stats_file, "location", hash_node->key);
         cJSON_AddNumberToObject(lc_stats_file, "events", data->events);
         cJSON_AddNumberToObject(lc_stats_file, "bytes", data->bytes);
+        if (data->reads > 0) {
+            cJSON_AddNumberToObject(lc_stats_file, "reads", data->reads);
+            cJSON_AddNumberToObject(lc_stats_file, "read_avg_usec", data->read_usec / data->reads);
+            cJSON_AddNumberToObject(lc_stats_file, "read_max_usec", data->read_max_usec);
+        }
         cJSON_AddItemToObject(lc_stats_file, "targets", lc_stats_targets_array);
 
         if (restart) {
             data->bytes = 0;
             data->events = 0;
+            data->reads = 0;
+            data->read_usec = 0;
+            data->read_max_usec = 0;
         }
         cJSON_AddItemToArray(lc_stats_files_array, lc_stats_file);
         hash_node = OSHash_Next(state->states, &index, hash_node);
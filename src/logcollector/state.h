@@ -50,6 +50,9 @@ typedef struct {
 typedef struct {
     uint64_t bytes;               ///< bytes count
     uint64_t events;              ///< events count
+    uint64_t reads;               ///< read calls count
+    uint64_t read_usec;           ///< time spent in the read calls (microseconds)
+    uint64_t read_max_usec;       ///< longest read call (microseconds)
     w_lc_state_target_t ** targets; ///< array of poiters to file's different targets
 } w_lc_state_file_t;
 
@@ -98,6 +101,14 @@ void w_logcollector_state_update_target(char * fpath, char * target, bool droppe
  */
 void w_logcollector_state_update_file(char * fpath, uint64_t bytes);
 
+/**
+ * @brief Register the duration of a read call on an already registered file/location
+ *
+ * @param fpath file path or locafile location value
+ * @param usec duration of the read call, in microseconds
+ */
+void w_logcollector_state_update_read(char * fpath, uint64_t usec);
+
 /**
  * @brief Removes the `fpath` file from statistics
  * 
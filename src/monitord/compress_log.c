@@ -12,21 +12,40 @@
 #include "monitord.h"
 #include "../external/zlib/zlib.h"
 
+/* Block compressed as an independent gzip member */
+typedef struct compress_block_t {
+    unsigned char *in;
+    size_t in_len;
+    unsigned char *out;
+    size_t out_len;
+    int error;
+} compress_block_t;
+
+static int compress_level = Z_DEFAULT_COMPRESSION;
+static int compress_threads = 1;
+
+static int compress_log_stream(FILE *log, gzFile zlog, log_checksum_t *checksum);
+static int compress_log_blocks(FILE *log, FILE *zlog, log_checksum_t *checksum);
+static void * compress_block(void *arg);
+
+/* Set the compression level and the number of threads compressing each file */
+void OS_CompressLogOptions(int level, int threads)
+{
+    compress_level = level;
+    compress_threads = threads < 1 ? 1 : threads > MAX_COMPRESS_THREADS ? MAX_COMPRESS_THREADS : threads;
+}
 
 /* gzip a log file */
 void OS_CompressLog(const char *logfile)
 {
-    FILE *log;
-    gzFile zlog;
+    w_compress_log(logfile, NULL);
+}
 
+int w_compress_log(const char *logfile, log_checksum_t *checksum)
+{
+    FILE *log;
     char logfileGZ[OS_FLSIZE + 1];
-    int len, err;
-
-    char buf[OS_MAXSTR + 1];
-
-    /* Clear memory */
-    memset(logfileGZ, '\0', OS_FLSIZE + 1);
-    memset(buf, '\0', OS_MAXSTR + 1);
+    int retval;
 
     /* Set umask */
     umask(0027);
@@ -38,33 +57,208 @@ void OS_CompressLog(const char *logfile)
     log = fopen(logfile, "r");
     if (!log) {
         /* Do not warn in here, since the alert file may not exist */
-        return;
+        return -1;
+    }
+
+    if (compress_threads > 1) {
+        FILE *zlog = fopen(logfileGZ, "wb");
+
+        if (!zlog) {
+            fclose(log);
+            merror(FOPEN_ERROR, logfileGZ, errno, strerror(errno));
+            return -1;
+        }
+
+        retval = compress_log_blocks(log, zlog, checksum);
+
+        if (fclose(zlog) != 0) {
+            merror("Compression error: %s", strerror(errno));
+            retval = -1;
+        }
+    } else {
+        char mode[8];
+        gzFile zlog;
+
+        snprintf(mode, sizeof(mode), compress_level == Z_DEFAULT_COMPRESSION ? "wb" : "wb%d", compress_level);
+
+        /* Open compressed file */
+        zlog = gzopen(logfileGZ, mode);
+        if (!zlog) {
+            fclose(log);
+            merror(FOPEN_ERROR, logfileGZ, errno, strerror(errno));
+            return -1;
+        }
+
+        retval = compress_log_stream(log, zlog, checksum);
+
+        if (gzclose(zlog) != Z_OK) {
+            merror("Compression error: unable to close '%s'", logfileGZ);
+            retval = -1;
+        }
     }
 
-    /* Open compressed file */
-    zlog = gzopen(logfileGZ, "w");
-    if (!zlog) {
-        fclose(log);
-        merror(FOPEN_ERROR, logfileGZ, errno, strerror(errno));
-        return;
+    if (retval < 0 && checksum) {
+        /* The checksums still cover the whole file */
+        char buf[OS_MAXSTR];
+        size_t len;
+
+        while (len = fread(buf, 1, sizeof(buf), log), len > 0) {
+            w_log_checksum_update(checksum, buf, len);
+        }
+    }
+
+    fclose(log);
+
+    if (retval < 0) {
+        /* Keep the uncompressed file */
+        unlink(logfileGZ);
+        return -1;
     }
 
+    /* Remove uncompressed file */
+    if ( unlink(logfile) == -1)
+        merror("Unable to delete '%s' due to '%s'", logfile, strerror(errno));
+
+    return 0;
+}
+
+/* Compress the whole file as a single gzip member */
+int compress_log_stream(FILE *log, gzFile zlog, log_checksum_t *checksum)
+{
+    char buf[OS_MAXSTR + 1];
+    int len, err;
+
     for (;;) {
         len = (int) fread(buf, 1, OS_MAXSTR, log);
         if (len <= 0) {
             break;
         }
+        if (checksum) {
+            w_log_checksum_update(checksum, buf, (size_t)len);
+        }
         if (gzwrite(zlog, buf, (unsigned)len) != len) {
             merror("Compression error: %s", gzerror(zlog, &err));
+            return -1;
         }
     }
 
-    fclose(log);
-    gzclose(zlog);
+    return ferror(log) ? -1 : 0;
+}
 
-    /* Remove uncompressed file */
-    if ( unlink(logfile) == -1)
-        merror("Unable to delete '%s' due to '%s'", logfile, strerror(errno));
+/* Compress the file in rounds of one block per thread, writing the members in order */
+int compress_log_blocks(FILE *log, FILE *zlog, log_checksum_t *checksum)
+{
+    compress_block_t blocks[MAX_COMPRESS_THREADS];
+    pthread_t threads[MAX_COMPRESS_THREADS];
+    int created[MAX_COMPRESS_THREADS];
+    int retval = 0;
+    int rounds = 0;
+    int count;
+    int i;
+
+    memset(blocks, 0, sizeof(blocks));
+
+    for (i = 0; i < compress_threads; i++) {
+        os_malloc(COMPRESS_BLOCK_SIZE, blocks[i].in);
+    }
+
+    do {
+        /* Read one block per thread */
+        for (count = 0; count < compress_threads; count++) {
+            blocks[count].in_len = fread(blocks[count].in, 1, COMPRESS_BLOCK_SIZE, log);
+
+            if (blocks[count].in_len == 0) {
+                break;
+            }
+
+            if (checksum) {
+                w_log_checksum_update(checksum, blocks[count].in, blocks[count].in_len);
+            }
+        }
+
+        if (ferror(log)) {
+            merror("Compression error: %s", strerror(errno));
+            retval = -1;
+            break;
+        }
+
+        /* An empty file is still written as an empty member */
+        if (count == 0 && rounds == 0) {
+            count = 1;
+        }
+
+        rounds++;
+
+        /* The calling thread compresses the first block */
+        for (i = 1; i < count; i++) {
+            created[i] = pthread_create(&threads[i], NULL, compress_block, &blocks[i]) == 0;
+
+            if (!created[i]) {
+                compress_block(&blocks[i]);
+            }
+        }
+
+        if (count > 0) {
+            compress_block(&blocks[0]);
+        }
+
+        for (i = 1; i < count; i++) {
+            if (created[i]) {
+                pthread_join(threads[i], NULL);
+            }
+        }
+
+        for (i = 0; i < count; i++) {
+            if (retval == 0) {
+                if (blocks[i].error) {
+                    merror("Compression error: %s", zError(blocks[i].error));
+                    retval = -1;
+                } else if (fwrite(blocks[i].out, 1, blocks[i].out_len, zlog) != blocks[i].out_len) {
+                    merror("Compression error: %s", strerror(errno));
+                    retval = -1;
+                }
+            }
+
+            os_free(blocks[i].out);
+        }
+    } while (retval == 0 && count == compress_threads);
+
+    for (i = 0; i < compress_threads; i++) {
+        os_free(blocks[i].in);
+    }
+
+    return retval;
+}
+
+/* Deflate a block into a gzip member */
+void * compress_block(void *arg)
+{
+    compress_block_t *block = (compress_block_t *)arg;
+    z_stream strm;
+    int ret;
+
+    memset(&strm, 0, sizeof(strm));
+    block->out = NULL;
+    block->out_len = 0;
+
+    if (ret = deflateInit2(&strm, compress_level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY), ret != Z_OK) {
+        block->error = ret;
+        return NULL;
+    }
+
+    /* The bound fits the whole member, a single call finishes the stream */
+    block->out_len = deflateBound(&strm, (uLong)block->in_len);
+    os_malloc(block->out_len, block->out);
+
+    strm.next_in = block->in;
+    strm.avail_in = (uInt)block->in_len;
+    strm.next_out = block->out;
+    strm.avail_out = (uInt)block->out_len;
+
+    ret = deflate(&strm, Z_FINISH);
+    block->error = ret == Z_STREAM_END ? 0 : ret == Z_OK ? Z_BUF_ERROR : ret;
+    block->out_len = strm.total_out;
 
-    return;
+    deflateEnd(&strm);
+    return NULL;
 }
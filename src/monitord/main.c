@@ -153,6 +153,8 @@ int main(int argc, char **argv)
         merror_exit(CONFIG_ERROR, cfg);
     }
 
+    OS_CompressLogOptions(mond.compress_level, mond.compress_threads);
+
     /* If we have any reports configured, read smtp/emailfrom */
     if (mond.reports) {
         OS_XML xml;
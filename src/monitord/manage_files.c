@@ -44,16 +44,26 @@ void manage_log(const char * logdir, int cday, int cmon, int cyear, const struct
     snprintf(logfile, OS_FLSIZE + 1, "%s/%d/%s/ossec-%s-%02d", logdir, cyear, months[cmon], tag, cday);
     snprintf(logfile_old, OS_FLSIZE + 1, "%s/%d/%s/ossec-%s-%02d", logdir, pp_old->tm_year + 1900, months[pp_old->tm_mon], tag, pp_old->tm_mday);
 
-    OS_SignLog(logfile, logfile_old, ext);
-
     if (mond.compress) {
+        log_checksum_t checksum;
+        int exists;
+
+        /* The checksums are computed while the files are compressed, reading them once */
+        w_log_checksum_init(&checksum);
+
         os_snprintf(logfile_r, OS_FLSIZE + 1, "%s.%s", logfile, ext);
-        OS_CompressLog(logfile_r);
+        exists = IsFile(logfile_r) == 0;
 
-        for (i = 1; !IsFile(logfile_r) && FileSize(logfile_r) > 0; i++) {
-            if (os_snprintf(logfile_r, OS_FLSIZE + 1, "%s-%.3d.%s", logfile, i, ext) < OS_FLSIZE + 1) {
-                OS_CompressLog(logfile_r);
+        if (exists) {
+            w_compress_log(logfile_r, &checksum);
+
+            for (i = 1; os_snprintf(logfile_r, OS_FLSIZE + 1, "%s-%.3d.%s", logfile, i, ext), !IsFile(logfile_r) && FileSize(logfile_r) > 0; i++) {
+                w_compress_log(logfile_r, &checksum);
             }
         }
+
+        w_sign_log_write(logfile, logfile_old, ext, exists ? &checksum : NULL);
+    } else {
+        OS_SignLog(logfile, logfile_old, ext);
     }
 }
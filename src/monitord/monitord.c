@@ -107,6 +107,8 @@ cJSON *getMonitorInternalOptions(void) {
 
     cJSON_AddNumberToObject(monconf,"day_wait",mond.day_wait);
     cJSON_AddNumberToObject(monconf,"compress",mond.compress);
+    cJSON_AddNumberToObject(monconf,"compress_level",mond.compress_level);
+    cJSON_AddNumberToObject(monconf,"compress_threads",mond.compress_threads);
     cJSON_AddNumberToObject(monconf,"sign",mond.sign);
     cJSON_AddNumberToObject(monconf,"monitor_agents",mond.monitor_agents);
     cJSON_AddNumberToObject(monconf,"keep_log_days",mond.keep_log_days);
@@ -172,6 +174,8 @@ int MonitordConfig(const char *cfg, monitor_config *mond, int no_agents, short d
     /* Get config options */
     mond->day_wait = day_wait >= 0 ? day_wait : (short)getDefine_Int("monitord", "day_wait", 0, MAX_DAY_WAIT);
     mond->compress = (unsigned int) getDefine_Int("monitord", "compress", 0, 1);
+    mond->compress_level = getDefine_Int("monitord", "compress_level", 1, 9);
+    mond->compress_threads = getDefine_Int("monitord", "compress_threads", 1, MAX_COMPRESS_THREADS);
     mond->sign = (unsigned int) getDefine_Int("monitord", "sign", 0, 1);
     mond->monitor_agents = no_agents ? 0 : (unsigned int) getDefine_Int("monitord", "monitor_agents", 0, 1);
     mond->rotate_log = (unsigned int)getDefine_Int("monitord", "rotate_log", 0, 1);
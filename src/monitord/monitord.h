@@ -12,6 +12,8 @@
 #define MONITORD_H
 
 #include "hash_op.h"
+#include <openssl/md5.h>
+#include <openssl/sha.h>
 #ifndef ARGV0
 #define ARGV0 "wazuh-monitord"
 #endif
@@ -23,6 +25,15 @@
 #define MONITORD_MSG_HEADER "1:" ARGV0 ":"
 #define AG_DISCON_MSG MONITORD_MSG_HEADER OS_AG_DISCON
 #define CHECK_LOGS_SIZE TRUE
+#define COMPRESS_BLOCK_SIZE (1024 * 1024)
+#define MAX_COMPRESS_THREADS 32
+
+/* Checksums of a log file and its rotations, computed while they are read */
+typedef struct log_checksum_t {
+    MD5_CTX md5;
+    SHA_CTX sha1;
+    SHA256_CTX sha256;
+} log_checksum_t;
 
 /* Prototypes */
 void Monitord(void) __attribute__((noreturn));
@@ -30,6 +41,31 @@ void manage_files(int cday, int cmon, int cyear);
 void generate_reports(int cday, int cmon, int cyear, const struct tm *p);
 void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext);
 void OS_CompressLog(const char *logfile);
+void OS_CompressLogOptions(int level, int threads);
+void w_log_checksum_init(log_checksum_t *checksum);
+void w_log_checksum_update(log_checksum_t *checksum, const void *data, size_t size);
+
+/**
+ * @brief Write the checksum file of a log, chained to the one of the previous day
+ *
+ * @param logfile Log file path, without extension
+ * @param logfile_old Log file path of the previous day, without extension
+ * @param ext Log file extension
+ * @param checksum Checksums of the log and its rotations, NULL if the log doesn't exist
+ */
+void w_sign_log_write(const char *logfile, const char *logfile_old, const char *ext, log_checksum_t *checksum);
+
+/**
+ * @brief gzip a log file and remove it
+ *
+ * With more than one compression thread, the file is cut in blocks compressed in parallel,
+ * each one written as a gzip member. Concatenated members are a valid gzip file.
+ *
+ * @param logfile Log file path
+ * @param checksum Checksums updated with the uncompressed content, it may be NULL
+ * @return 0 on success, -1 if the file doesn't exist or it couldn't be compressed
+ */
+int w_compress_log(const char *logfile, log_checksum_t *checksum);
 void w_rotate_log(int compress, int keep_log_days, int new_day, int rotate_json, int daily_rotations);
 int delete_old_agent(const char *agent_id);
 int MonitordConfig(const char *cfg, monitor_config *mond, int no_agents, short day_wait);
@@ -13,8 +13,6 @@
 #include "os_crypto/sha1/sha1_op.h"
 #include "os_crypto/sha256/sha256_op.h"
 #include "monitord.h"
-#include <openssl/md5.h>
-#include <openssl/sha.h>
 
 /* Sign a log file */
 void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
@@ -22,6 +20,65 @@ void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
     int i;
     size_t n;
 
+    log_checksum_t checksum;
+
+    char logfile_r[OS_FLSIZE + 1];
+    char buffer[4096];
+
+    FILE *fp;
+
+    snprintf(logfile_r, OS_FLSIZE + 1, "%s.%s", logfile, ext);
+
+    /* Generate MD5, SHA-1, and SHA-256 of the current file */
+
+    if (fp = fopen(logfile_r, "r"), fp) {
+        w_log_checksum_init(&checksum);
+
+        while (n = fread(buffer, 1, 2048, fp), n > 0) {
+            w_log_checksum_update(&checksum, buffer, n);
+        }
+
+        fclose(fp);
+
+        // Include rotated files
+
+        for (i = 1; snprintf(logfile_r, OS_FLSIZE + 1, "%s-%.3d.%s", logfile, i, ext), !IsFile(logfile_r) && FileSize(logfile_r) > 0; i++) {
+            if (fp = fopen(logfile_r, "r"), fp) {
+                while (n = fread(buffer, 1, 2048, fp), n > 0) {
+                    w_log_checksum_update(&checksum, buffer, n);
+                }
+
+                fclose(fp);
+            } else {
+                merror(FOPEN_ERROR, logfile_r, errno, strerror(errno));
+                break;
+            }
+        }
+
+        w_sign_log_write(logfile, logfile_old, ext, &checksum);
+    } else {
+        w_sign_log_write(logfile, logfile_old, ext, NULL);
+    }
+}
+
+void w_log_checksum_init(log_checksum_t *checksum)
+{
+    MD5_Init(&checksum->md5);
+    SHA1_Init(&checksum->sha1);
+    SHA256_Init(&checksum->sha256);
+}
+
+void w_log_checksum_update(log_checksum_t *checksum, const void *data, size_t size)
+{
+    MD5_Update(&checksum->md5, data, (unsigned long)size);
+    SHA1_Update(&checksum->sha1, data, size);
+    SHA256_Update(&checksum->sha256, data, size);
+}
+
+void w_sign_log_write(const char *logfile, const char *logfile_old, const char *ext, log_checksum_t *checksum)
+{
+    size_t n;
+
     os_md5 mf_sum;
     os_md5 mf_sum_old;
 
@@ -31,14 +88,8 @@ void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
     os_sha256 sf256_sum;
     os_sha256 sf256_sum_old;
 
-    SHA_CTX sha1_ctx;
-    MD5_CTX md5_ctx;
-    SHA256_CTX sha256_ctx;
-
     char logfilesum[OS_FLSIZE + 1];
     char logfilesum_old[OS_FLSIZE + 1];
-    char logfile_r[OS_FLSIZE + 1];
-    char buffer[4096];
 
     FILE *fp;
 
@@ -54,14 +105,9 @@ void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
     umask(0027);
 
     /* Create the checksum file names */
-    snprintf(logfile_r, OS_FLSIZE + 1, "%s.%s", logfile, ext);
-    os_snprintf(logfilesum, OS_FLSIZE, "%s.sum", logfile_r);
+    os_snprintf(logfilesum, OS_FLSIZE, "%s.%s.sum", logfile, ext);
     snprintf(logfilesum_old, OS_FLSIZE, "%s.%s.sum", logfile_old, ext);
 
-    MD5_Init(&md5_ctx);
-    SHA1_Init(&sha1_ctx);
-    SHA256_Init(&sha256_ctx);
-
     /* Generate MD5 of the old file */
     if (OS_MD5_File(logfilesum_old, mf_sum_old, OS_TEXT) < 0) {
         minfo("No previous md5 checksum found: '%s'. "
@@ -83,49 +129,22 @@ void OS_SignLog(const char *logfile, const char *logfile_old, const char * ext)
         strncpy(sf256_sum_old, "none", 6);
     }
 
-    /* Generate MD5, SHA-1, and SHA-256 of the current file */
-
-    if (fp = fopen(logfile_r, "r"), fp) {
-        while (n = fread(buffer, 1, 2048, fp), n > 0) {
-            SHA1_Update(&sha1_ctx, buffer, n);
-            MD5_Update(&md5_ctx, buffer, (unsigned long)n);
-            SHA256_Update(&sha256_ctx, buffer, n);
-        }
-
-        fclose(fp);
-
-        // Include rotated files
-
-        for (i = 1; snprintf(logfile_r, OS_FLSIZE + 1, "%s-%.3d.%s", logfile, i, ext), !IsFile(logfile_r) && FileSize(logfile_r) > 0; i++) {
-            if (fp = fopen(logfile_r, "r"), fp) {
-                while (n = fread(buffer, 1, 2048, fp), n > 0) {
-                    SHA1_Update(&sha1_ctx, buffer, n);
-                    MD5_Update(&md5_ctx, buffer, (unsigned long)n);
-                    SHA256_Update(&sha256_ctx, buffer, n);
-                }
-
-                fclose(fp);
-            } else {
-                merror(FOPEN_ERROR, logfile_r, errno, strerror(errno));
-                break;
-            }
-        }
-
-        MD5_Final(md5_digest, &md5_ctx);
+    if (checksum) {
+        MD5_Final(md5_digest, &checksum->md5);
         char *mpos = mf_sum;
         for (n = 0; n < 16; n++) {
             snprintf(mpos, 3, "%02x", md5_digest[n]);
             mpos += 2;
         }
 
-        SHA1_Final(&(md[0]), &sha1_ctx);
+        SHA1_Final(&(md[0]), &checksum->sha1);
         char *spos = sf_sum;
         for (n = 0; n < SHA_DIGEST_LENGTH; n++) {
             snprintf(spos, 3, "%02x", md[n]);
             spos += 2;
         }
 
-        SHA256_Final(&(md256[0]), &sha256_ctx);
+        SHA256_Final(&(md256[0]), &checksum->sha256);
         char *sspos = sf256_sum;
         for (n = 0; n < SHA256_DIGEST_LENGTH; n++) {
             snprintf(sspos, 3, "%02x", md256[n]);
@@ -41,6 +41,8 @@ int authd_read_config(const char *path) {
 
     config.timeout_sec = getDefine_Int("auth", "timeout_seconds", 0, INT_MAX);
     config.timeout_usec = getDefine_Int("auth", "timeout_microseconds", 0, 999999);
+    config.dispatch_threads = getDefine_Int("auth", "dispatch_threads", 1, AUTH_MAX_DISPATCHERS);
+    config.append_keys = getDefine_Int("auth", "append_keys", 0, 1);
 
     return 0;
 }
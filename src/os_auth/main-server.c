@@ -137,7 +137,7 @@ int main(int argc, char **argv)
     char buf[4096 + 1];
 
     pthread_t thread_local_server = 0;
-    pthread_t thread_dispatcher = 0;
+    pthread_t *thread_dispatchers = NULL;
     pthread_t thread_remote_server = 0;
     pthread_t thread_writer = 0;
     pthread_t thread_key_request = 0;
@@ -609,10 +609,13 @@ int main(int argc, char **argv)
 
     if (config.flags.remote_enrollment) {
         client_queue = queue_init(AUTH_POOL);
+        os_calloc(config.dispatch_threads, sizeof(pthread_t), thread_dispatchers);
 
-        if (status = pthread_create(&thread_dispatcher, NULL, (void *)&run_dispatcher, NULL), status != 0) {
-            merror("Couldn't create thread: %s", strerror(status));
-            return EXIT_FAILURE;
+        for (int i = 0; i < config.dispatch_threads; i++) {
+            if (status = pthread_create(&thread_dispatchers[i], NULL, (void *)&run_dispatcher, NULL), status != 0) {
+                merror("Couldn't create thread: %s", strerror(status));
+                return EXIT_FAILURE;
+            }
         }
 
         if (status = pthread_create(&thread_remote_server, NULL, (void *)&run_remote_server, NULL), status != 0) {
@@ -640,8 +643,12 @@ int main(int argc, char **argv)
     /* Join threads */
     pthread_join(thread_local_server, NULL);
     if (config.flags.remote_enrollment) {
-        pthread_join(thread_dispatcher, NULL);
+        for (int i = 0; i < config.dispatch_threads; i++) {
+            pthread_join(thread_dispatchers[i], NULL);
+        }
         pthread_join(thread_remote_server, NULL);
+        os_free(thread_dispatchers);
+        SSL_CTX_free(ctx);
     }
     if (!config.worker_node) {
         /* Send signal to writer thread */
@@ -800,14 +807,18 @@ void* run_dispatcher(__attribute__((unused)) void *arg) {
                     merror("Agent key not saved for %s", agentname);
                     ERR_print_errors_fp(stderr);
                     w_mutex_lock(&mutex_keys);
-                    OS_DeleteKey(&keys, keys.keyentries[keys.keysize - 1]->id, 1);
+                    OS_DeleteKey(&keys, new_id, 1);
                     w_mutex_unlock(&mutex_keys);
                 } else {
-                    /* Add pending key to write */
+                    /* Add pending key to write. Other dispatchers may have added keys meanwhile. */
                     w_mutex_lock(&mutex_keys);
-                    add_insert(keys.keyentries[keys.keysize - 1], centralized_group);
-                    write_pending = 1;
-                    w_cond_signal(&cond_pending);
+                    int index = OS_IsAllowedID(&keys, new_id);
+
+                    if (index >= 0) {
+                        add_insert(keys.keyentries[index], centralized_group);
+                        write_pending = 1;
+                        w_cond_signal(&cond_pending);
+                    }
                     w_mutex_unlock(&mutex_keys);
                 }
             }
@@ -836,7 +847,6 @@ void* run_dispatcher(__attribute__((unused)) void *arg) {
 
     mdebug1("Dispatch thread finished");
 
-    SSL_CTX_free(ctx);
     return NULL;
 }
 
@@ -934,6 +944,9 @@ void* run_writer(__attribute__((unused)) void *arg) {
     struct keynode *copy_remove;
     struct keynode *cur;
     struct keynode *next;
+    keyentry **new_entries = NULL;
+    unsigned int new_count = 0;
+    int keys_synced = 1;
     char wdbquery[OS_SIZE_128];
     char wdboutput[128];
     int wdb_sock = -1;
@@ -959,9 +972,33 @@ void* run_writer(__attribute__((unused)) void *arg) {
 
         gettime(&global_t0);
 
-        copy_keys = OS_DupKeys(&keys);
         copy_insert = queue_insert;
         copy_remove = queue_remove;
+
+        /* New agents only: append them instead of rewriting the whole keystore.
+         * Removals can't be appended, readers would keep the former line. */
+        if (config.append_keys && keys_synced && !copy_remove) {
+            copy_keys = NULL;
+            new_count = 0;
+
+            for (cur = copy_insert; cur; cur = cur->next) {
+                new_count++;
+            }
+
+            os_calloc(new_count + 1, sizeof(keyentry *), new_entries);
+            new_count = 0;
+
+            for (cur = copy_insert; cur; cur = cur->next) {
+                int index = OS_IsAllowedID(&keys, cur->id);
+
+                if (index >= 0) {
+                    new_entries[new_count++] = OS_DupKeyEntry(keys.keyentries[index]);
+                }
+            }
+        } else {
+            copy_keys = OS_DupKeys(&keys);
+        }
+
         queue_insert = NULL;
         queue_remove = NULL;
         insert_tail = &queue_insert;
@@ -969,28 +1006,67 @@ void* run_writer(__attribute__((unused)) void *arg) {
         write_pending = 0;
         w_mutex_unlock(&mutex_keys);
 
-        gettime(&t0);
+        if (!copy_keys) {
+            gettime(&t0);
 
-        if (OS_WriteKeys(copy_keys) < 0) {
-            merror("Couldn't write file client.keys");
-            sleep(1);
-        }
+            if (OS_AppendKeys(new_entries, new_count) < 0) {
+                merror("Couldn't write file client.keys");
+                keys_synced = 0;
+            }
 
-        gettime(&t1);
-        mdebug2("[Writer] OS_WriteKeys(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
+            gettime(&t1);
+            mdebug2("[Writer] OS_AppendKeys(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
 
-        gettime(&t0);
+            gettime(&t0);
 
-        if (OS_WriteTimestamps(copy_keys) < 0) {
-            merror("Couldn't write file agents-timestamp.");
-            sleep(1);
-        }
+            if (OS_AppendTimestamps(new_entries, new_count) < 0) {
+                merror("Couldn't write file agents-timestamp.");
+                keys_synced = 0;
+            }
+
+            gettime(&t1);
+            mdebug2("[Writer] OS_AppendTimestamps(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
+
+            for (unsigned int i = 0; i < new_count; i++) {
+                OS_FreeKey(new_entries[i]);
+            }
+
+            os_free(new_entries);
+
+            if (!keys_synced) {
+                /* Rewrite both files on the next round */
+                w_mutex_lock(&mutex_keys);
+                write_pending = 1;
+                w_mutex_unlock(&mutex_keys);
+                sleep(1);
+            }
+        } else {
+            gettime(&t0);
+            keys_synced = 1;
+
+            if (OS_WriteKeys(copy_keys) < 0) {
+                merror("Couldn't write file client.keys");
+                keys_synced = 0;
+                sleep(1);
+            }
 
-        gettime(&t1);
-        mdebug2("[Writer] OS_WriteTimestamps(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
+            gettime(&t1);
+            mdebug2("[Writer] OS_WriteKeys(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
+
+            gettime(&t0);
 
-        OS_FreeKeys(copy_keys);
-        os_free(copy_keys);
+            if (OS_WriteTimestamps(copy_keys) < 0) {
+                merror("Couldn't write file agents-timestamp.");
+                keys_synced = 0;
+                sleep(1);
+            }
+
+            gettime(&t1);
+            mdebug2("[Writer] OS_WriteTimestamps(): %d µs.", (int)(1000000. * (double)time_diff(&t0, &t1)));
+
+            OS_FreeKeys(copy_keys);
+            os_free(copy_keys);
+        }
 
         for (cur = copy_insert; cur; cur = next) {
             next = cur->next;
@@ -19,6 +19,50 @@
 
 typedef unsigned char uchar;
 
+#define AES_KEY_SIZE 32
+
+/* Cipher context of a thread, with the last key it was set up with.
+ * Reusing it saves the allocation and the key schedule of each message.
+ */
+typedef struct aes_cache_t {
+    EVP_CIPHER_CTX *ctx;
+    unsigned char key[AES_KEY_SIZE];
+    int has_key;
+} aes_cache_t;
+
+static __thread aes_cache_t aes_encrypt_cache;
+static __thread aes_cache_t aes_decrypt_cache;
+
+/* Get the context of the thread ready for a new message */
+static EVP_CIPHER_CTX *aes_cache_init(aes_cache_t *cache, const unsigned char *key,
+    const unsigned char *iv, int enc)
+{
+    if (!cache->ctx) {
+        if (cache->ctx = EVP_CIPHER_CTX_new(), !cache->ctx) {
+            return NULL;
+        }
+
+        cache->has_key = 0;
+    }
+
+    if (cache->has_key && memcmp(cache->key, key, AES_KEY_SIZE) == 0) {
+        // Only the IV is reset, the key schedule is kept
+        if (1 == EVP_CipherInit_ex(cache->ctx, NULL, NULL, NULL, iv, enc)) {
+            return cache->ctx;
+        }
+    }
+
+    if (1 != EVP_CipherInit_ex(cache->ctx, EVP_aes_256_cbc(), NULL, key, iv, enc)) {
+        cache->has_key = 0;
+        return NULL;
+    }
+
+    memcpy(cache->key, key, AES_KEY_SIZE);
+    cache->has_key = 1;
+
+    return cache->ctx;
+}
+
 
 int OS_AES_Str(const char *input, char *output, const char *charkey,
               long size, short int action)
@@ -42,11 +86,7 @@ int encrypt_AES(const unsigned char *plaintext, int plaintext_len, unsigned char
 	int len;
 	int ciphertext_len = 0;
 
-	if (!(ctx = EVP_CIPHER_CTX_new())) {
-        goto end;
-    }
-
-	if (1 != EVP_EncryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, key, iv)) {
+	if (!(ctx = aes_cache_init(&aes_encrypt_cache, key, iv, 1))) {
         goto end;
     }
 
@@ -64,7 +104,6 @@ int encrypt_AES(const unsigned char *plaintext, int plaintext_len, unsigned char
 	ciphertext_len += len;
 
 end:
-	EVP_CIPHER_CTX_free(ctx);
 	return ciphertext_len;
 }
 
@@ -75,11 +114,7 @@ int decrypt_AES(const unsigned char *ciphertext, int ciphertext_len, unsigned ch
 	int len;
 	int plaintext_len = 0;
 
-	if (!(ctx = EVP_CIPHER_CTX_new())) {
-        goto end;
-    }
-
-	if (1 != EVP_DecryptInit_ex(ctx, EVP_aes_256_cbc(), NULL, key, iv)) {
+	if (!(ctx = aes_cache_init(&aes_decrypt_cache, key, iv, 0))) {
         goto end;
     }
 
@@ -97,6 +132,5 @@ int decrypt_AES(const unsigned char *ciphertext, int ciphertext_len, unsigned ch
 	plaintext_len += len;
 
 end:
-	EVP_CIPHER_CTX_free(ctx);
 	return plaintext_len;
 }
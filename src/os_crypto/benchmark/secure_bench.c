@@ -0,0 +1,241 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Microbenchmark of the secure message path.
+ * Each message goes through CreateSecMSG and ReadSecMSG: compression,
+ * encryption, decryption and decompression, with the keys of a set of
+ * fake agents in a temporary directory.
+ */
+
+#ifdef ARGV0
+#undef ARGV0
+#endif
+#define ARGV0 "wazuh-secure-bench"
+
+#include "shared.h"
+#include "sec.h"
+
+#define BENCH_MESSAGES  100000
+#define BENCH_SIZE      512
+
+typedef struct bench_worker_t {
+    pthread_t thread;
+    int id;
+    unsigned long long messages;
+    unsigned long long errors;
+    unsigned long long create_nsec;
+    unsigned long long read_nsec;
+} bench_worker_t;
+
+static keystore keys = KEYSTORE_INITIALIZER;
+static char *message;
+static size_t message_size = BENCH_SIZE;
+static int messages = BENCH_MESSAGES;
+static int threads = 1;
+static int agents = 1;
+
+__attribute__((noreturn))
+static void help_bench()
+{
+    print_header();
+    print_out("  %s: -[hd] [-t threads] [-n messages] [-a agents] [-s size] [-b]", ARGV0);
+    print_out("    -h          This help message");
+    print_out("    -d          Execute in debug mode. This parameter");
+    print_out("                can be specified multiple times");
+    print_out("                to increase the debug level.");
+    print_out("    -t <n>      Number of threads (default: 1)");
+    print_out("    -n <n>      Number of messages of each thread (default: %d)", BENCH_MESSAGES);
+    print_out("    -a <n>      Number of agents whose keys are used in turn (default: 1)");
+    print_out("    -s <n>      Size of the messages (default: %d)", BENCH_SIZE);
+    print_out("    -b          Use Blowfish instead of AES");
+    print_out(" ");
+    exit(1);
+}
+
+static unsigned long long bench_nsec(const struct timespec *t0, const struct timespec *t1) {
+    return (unsigned long long)(t1->tv_sec - t0->tv_sec) * 1000000000ULL + (unsigned long long)t1->tv_nsec - (unsigned long long)t0->tv_nsec;
+}
+
+/* Agents of the keystore, in a client.keys file of the working directory */
+static void bench_write_keys(crypt_method method) {
+    FILE *fp;
+    int i;
+
+    if (mkdir_ex("etc") < 0 || mkdir_ex(RIDS_DIR) < 0) {
+        merror_exit("Couldn't create the working directory.");
+    }
+
+    if (fp = fopen(KEYS_FILE, "w"), !fp) {
+        merror_exit(FOPEN_ERROR, KEYS_FILE, errno, strerror(errno));
+    }
+
+    for (i = 0; i < agents; i++) {
+        fprintf(fp, "%03d bench-%d 10.%d.%d.%d %064x\n", i + 1, i + 1, (i >> 16) & 0xff, (i >> 8) & 0xff, (i & 0xff) + 1, i + 1);
+    }
+
+    fclose(fp);
+
+    OS_ReadKeys(&keys, W_DUAL_KEY, 0);
+    OS_StartCounter(&keys);
+
+    for (i = 0; i < agents; i++) {
+        keys.keyentries[i]->crypto_method = method;
+    }
+}
+
+static void *bench_worker(void *arg) {
+    bench_worker_t *worker = (bench_worker_t *)arg;
+    char encrypted[OS_MAXSTR + 1];
+    char cleartext[OS_MAXSTR + 1];
+    int i;
+
+    for (i = 0; i < messages; i++) {
+        const int agent = (worker->id + i) % agents;
+        struct timespec t0;
+        struct timespec t1;
+        struct timespec t2;
+        size_t final_size;
+        size_t length;
+        char *output = NULL;
+
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+        length = CreateSecMSG(&keys, message, message_size, encrypted, agent);
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+
+        if (length == 0 || ReadSecMSG(&keys, encrypted, cleartext, agent, length - 1, &final_size,
+                                      keys.keyentries[agent]->ip->ip, &output) != KS_VALID) {
+            worker->errors++;
+        }
+
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t2);
+
+        worker->create_nsec += bench_nsec(&t0, &t1);
+        worker->read_nsec += bench_nsec(&t1, &t2);
+        worker->messages++;
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    char home_path[] = "/tmp/wazuh-secure-bench-XXXXXX";
+    crypt_method method = W_METH_AES;
+    bench_worker_t *workers;
+    struct timespec start;
+    struct timespec end;
+    unsigned long long total = 0;
+    unsigned long long errors = 0;
+    unsigned long long create_nsec = 0;
+    unsigned long long read_nsec = 0;
+    double wall;
+    size_t k;
+    int c;
+    int i;
+
+    OS_SetName(ARGV0);
+
+    while ((c = getopt(argc, argv, "hdt:n:a:s:b")) != -1) {
+        switch (c) {
+            case 'd':
+                nowDebug();
+                break;
+            case 't':
+                if (threads = atoi(optarg), threads < 1) {
+                    merror_exit("-t needs a positive number");
+                }
+                break;
+            case 'n':
+                if (messages = atoi(optarg), messages < 1) {
+                    merror_exit("-n needs a positive number");
+                }
+                break;
+            case 'a':
+                if (agents = atoi(optarg), agents < 1 || agents > 65535) {
+                    merror_exit("-a needs a number between 1 and 65535");
+                }
+                break;
+            case 's':
+                if (message_size = (size_t)atol(optarg), message_size < 1 || message_size > OS_MAXSTR / 2) {
+                    merror_exit("-s needs a number between 1 and %d", OS_MAXSTR / 2);
+                }
+                break;
+            case 'b':
+                method = W_METH_BLOWFISH;
+                break;
+            default:
+                help_bench();
+                break;
+        }
+    }
+
+    if (!mkdtemp(home_path)) {
+        merror_exit("Couldn't create a temporary directory: %s (%d)", strerror(errno), errno);
+    }
+
+    if (chdir(home_path) == -1) {
+        merror_exit(CHDIR_ERROR, home_path, errno, strerror(errno));
+    }
+
+    srandom_init();
+    _s_verify_counter = 0;
+    _s_recv_flush = 128;
+    bench_write_keys(method);
+
+    /* Log-like message, printable and moderately compressible */
+    os_malloc(message_size + 1, message);
+
+    for (k = 0; k < message_size; k++) {
+        message[k] = "abcdefghij klmnop: 0123456789 qrstuvwxyz"[(k * 7 + k / 13) % 40];
+    }
+
+    message[message_size] = '\0';
+
+    print_out("Sending %d messages of %zu bytes on %d threads, with %d agents and %s.", messages, message_size,
+              threads, agents, method == W_METH_AES ? "AES" : "Blowfish");
+
+    os_calloc(threads, sizeof(bench_worker_t), workers);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < threads; i++) {
+        workers[i].id = i;
+
+        if (pthread_create(&workers[i].thread, NULL, bench_worker, &workers[i]) != 0) {
+            merror_exit(THREAD_ERROR);
+        }
+    }
+
+    for (i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        total += workers[i].messages;
+        errors += workers[i].errors;
+        create_nsec += workers[i].create_nsec;
+        read_nsec += workers[i].read_nsec;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    wall = bench_nsec(&start, &end) / 1e9;
+
+    print_out(" ");
+    print_out("Messages:        %llu (%llu not valid)", total, errors);
+    print_out("Wall time:       %.3f s", wall);
+    print_out("Throughput:      %.0f messages/s", wall > 0 ? total / wall : 0.0);
+    print_out("CreateSecMSG:    %.2f us/message", total ? create_nsec / 1e3 / total : 0.0);
+    print_out("ReadSecMSG:      %.2f us/message", total ? read_nsec / 1e3 / total : 0.0);
+
+    os_free(workers);
+    os_free(message);
+    OS_FreeKeys(&keys);
+
+    if (chdir("/") == 0) {
+        rmdir_ex(home_path);
+    }
+
+    return errors ? 1 : 0;
+}
@@ -21,20 +21,43 @@
 
 typedef unsigned char uchar;
 
+/* Setting up a Blowfish key is far more expensive than encrypting a message,
+ * so each thread keeps the schedule of the last key it used.
+ */
+#define BF_CACHE_KEY_SIZE 72
+
+static __thread struct {
+    char charkey[BF_CACHE_KEY_SIZE + 1];
+    size_t length;
+    BF_KEY key;
+} bf_cache;
+
 
 int OS_BF_Str(const char *input, char *output, const char *charkey,
               long size, short int action)
 {
-    BF_KEY key = {.P = {0}};
     static unsigned char cbc_iv [8] = {0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10};
     unsigned char iv[8];
+    size_t length = strlen(charkey);
 
     memcpy(iv, cbc_iv, sizeof(iv));
 
-    BF_set_key(&key, (int)strlen(charkey), (const uchar *)charkey);
+    if (length == 0 || length > BF_CACHE_KEY_SIZE) {
+        BF_KEY key = {.P = {0}};
+
+        BF_set_key(&key, (int)length, (const uchar *)charkey);
+        BF_cbc_encrypt((const uchar *)input, (uchar *)output, (long)size, &key, iv, action);
+        return (1);
+    }
+
+    if (bf_cache.length != length || memcmp(bf_cache.charkey, charkey, length) != 0) {
+        BF_set_key(&bf_cache.key, (int)length, (const uchar *)charkey);
+        memcpy(bf_cache.charkey, charkey, length);
+        bf_cache.length = length;
+    }
 
     BF_cbc_encrypt((const uchar *)input, (uchar *)output, (long)size,
-                   &key, iv, action);
+                   &bf_cache.key, iv, action);
 
     return (1);
 }
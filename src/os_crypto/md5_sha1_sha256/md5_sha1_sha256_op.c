@@ -17,6 +17,9 @@
 #include <openssl/sha.h>
 #include "headers/defs.h"
 
+/* Read size when hashing files */
+#define OS_HASH_BUFFER_SIZE OS_SIZE_65536
+
 
 int OS_MD5_SHA1_SHA256_File(const char *fname,
                             char **prefilter_cmd,
@@ -29,7 +32,7 @@ int OS_MD5_SHA1_SHA256_File(const char *fname,
     size_t n, read = 0;
     FILE *fp;
     wfd_t *wfd;
-    unsigned char buf[OS_BUFFER_SIZE + 2];
+    unsigned char *buf;
     unsigned char sha1_digest[SHA_DIGEST_LENGTH];
     unsigned char md5_digest[16];
     unsigned char sha256_digest[SHA256_DIGEST_LENGTH];
@@ -39,10 +42,15 @@ int OS_MD5_SHA1_SHA256_File(const char *fname,
     SHA256_CTX sha256_ctx;
 
     /* Clear the memory */
-    md5output[0] = '\0';
-    sha1output[0] = '\0';
-    sha256output[0] = '\0';
-    buf[OS_BUFFER_SIZE + 1] = '\0';
+    if (md5output) {
+        md5output[0] = '\0';
+    }
+    if (sha1output) {
+        sha1output[0] = '\0';
+    }
+    if (sha256output) {
+        sha256output[0] = '\0';
+    }
 
     /* Use prefilter_cmd if set */
     if (prefilter_cmd == NULL) {
@@ -73,13 +81,22 @@ int OS_MD5_SHA1_SHA256_File(const char *fname,
         fp = wfd->file_out;
     }
 
-    /* Initialize both hashes */
-    MD5_Init(&md5_ctx);
-    SHA1_Init(&sha1_ctx);
-    SHA256_Init(&sha256_ctx);
+    /* Initialize the requested hashes */
+    if (md5output) {
+        MD5_Init(&md5_ctx);
+    }
+    if (sha1output) {
+        SHA1_Init(&sha1_ctx);
+    }
+    if (sha256output) {
+        SHA256_Init(&sha256_ctx);
+    }
+
+    /* Large reads, every digest is updated from the same chunk */
+    os_malloc(OS_HASH_BUFFER_SIZE, buf);
 
     /* Update for each one */
-    while ((n = fread(buf, 1, OS_BUFFER_SIZE, fp)) > 0) {
+    while ((n = fread(buf, 1, OS_HASH_BUFFER_SIZE, fp)) > 0) {
 
         if (max_size > 0) {
             read = read + n;
@@ -90,37 +107,52 @@ int OS_MD5_SHA1_SHA256_File(const char *fname,
                 } else {
                     wpclose(wfd);
                 }
+                os_free(buf);
                 return (-1);
             }
         }
 
-        buf[n] = '\0';
-
-        SHA1_Update(&sha1_ctx, buf, n);
-        SHA256_Update(&sha256_ctx, buf, n);
-        MD5_Update(&md5_ctx, buf, (unsigned)n);
+        if (sha1output) {
+            SHA1_Update(&sha1_ctx, buf, n);
+        }
+        if (sha256output) {
+            SHA256_Update(&sha256_ctx, buf, n);
+        }
+        if (md5output) {
+            MD5_Update(&md5_ctx, buf, (unsigned)n);
+        }
     }
 
-    SHA1_Final(&(sha1_digest[0]), &sha1_ctx);
-    SHA256_Final(&(sha256_digest[0]), &sha256_ctx);
-    MD5_Final(md5_digest, &md5_ctx);
+    os_free(buf);
 
     /* Set output for MD5 */
-    for (n = 0; n < 16; n++) {
-        snprintf(md5output, 3, "%02x", md5_digest[n]);
-        md5output += 2;
+    if (md5output) {
+        MD5_Final(md5_digest, &md5_ctx);
+
+        for (n = 0; n < 16; n++) {
+            snprintf(md5output, 3, "%02x", md5_digest[n]);
+            md5output += 2;
+        }
     }
 
     /* Set output for SHA-1 */
-    for (n = 0; n < SHA_DIGEST_LENGTH; n++) {
-        snprintf(sha1output, 3, "%02x", sha1_digest[n]);
-        sha1output += 2;
+    if (sha1output) {
+        SHA1_Final(&(sha1_digest[0]), &sha1_ctx);
+
+        for (n = 0; n < SHA_DIGEST_LENGTH; n++) {
+            snprintf(sha1output, 3, "%02x", sha1_digest[n]);
+            sha1output += 2;
+        }
     }
 
     /* Set output for SHA-256 */
-    for (n = 0; n < SHA256_DIGEST_LENGTH; n++) {
-        snprintf(sha256output, 3, "%02x", sha256_digest[n]);
-        sha256output += 2;
+    if (sha256output) {
+        SHA256_Final(&(sha256_digest[0]), &sha256_ctx);
+
+        for (n = 0; n < SHA256_DIGEST_LENGTH; n++) {
+            snprintf(sha256output, 3, "%02x", sha256_digest[n]);
+            sha256output += 2;
+        }
     }
 
     /* Close it */
@@ -16,12 +16,24 @@
 #include "../sha256/sha256_op.h"
 
 
+/**
+ * @brief Calculates the MD5, SHA1 and SHA256 of a file in a single read of its content
+ *
+ * @param fname File to hash.
+ * @param prefilter_cmd Command whose output is hashed instead of the file, NULL to read the file.
+ * @param[out] md5output MD5 of the file, NULL to skip it.
+ * @param[out] sha1output SHA1 of the file, NULL to skip it.
+ * @param[out] sha256output SHA256 of the file, NULL to skip it.
+ * @param mode OS_BINARY or OS_TEXT.
+ * @param max_size Maximum size of the file, 0 for no limit.
+ * @return 0 on success, -1 on error.
+ */
 int OS_MD5_SHA1_SHA256_File(const char *fname,
                             char **prefilter_cmd,
                             os_md5 md5output,
                             os_sha1 sha1output,
                             os_sha256 sha256output,
                             int mode,
-                            size_t max_size) __attribute((nonnull(1, 3, 4)));
+                            size_t max_size) __attribute((nonnull(1)));
 
 #endif /* MD5SHA1SHA256_OP_H */
@@ -47,6 +47,25 @@ static void move_netdata(keystore *keys, const keystore *old_keys)
     }
 }
 
+/* Move the content of a keystore, but its mutex */
+static void move_keystore(keystore *dst, const keystore *src)
+{
+    dst->keyentries = src->keyentries;
+    dst->keytree_id = src->keytree_id;
+    dst->keytree_ip = src->keytree_ip;
+    dst->keytree_sock = src->keytree_sock;
+    dst->keytree_name = src->keytree_name;
+    dst->keysize = src->keysize;
+    dst->file_change = src->file_change;
+    dst->inode = src->inode;
+    dst->file_size = src->file_size;
+    dst->id_counter = src->id_counter;
+    dst->flags = src->flags;
+    dst->removed_keys = src->removed_keys;
+    dst->removed_keys_size = src->removed_keys_size;
+    dst->opened_fp_queue = src->opened_fp_queue;
+}
+
 static void save_removed_key(keystore *keys, const char *key) {
     os_realloc(keys->removed_keys, (keys->removed_keys_size + 1) * sizeof(char*), keys->removed_keys);
     keys->removed_keys[keys->removed_keys_size++] = strdup(key);
@@ -95,6 +114,12 @@ int OS_AddKey(keystore *keys, const char *id, const char *name, const char *ip,
     /* Agent name */
     os_strdup(name, keys->keyentries[keys->keysize]->name);
 
+    if (keys->keytree_name) {
+        rbtree_insert(keys->keytree_name,
+                   keys->keyentries[keys->keysize]->name,
+                   keys->keyentries[keys->keysize]);
+    }
+
     /* Initialize the variables */
     keys->keyentries[keys->keysize]->rcvd = 0;
     keys->keyentries[keys->keysize]->local = 0;
@@ -195,6 +220,7 @@ void OS_ReadKeys(keystore *keys, key_mode_t key_mode, int save_removed)
     }
 
     keys->inode = File_Inode(keys_file);
+    keys->file_size = FileSize(keys_file);
     fp = fopen(keys_file, "r");
     if (!fp) {
         if (!pass_empty_keyfile) {
@@ -208,8 +234,9 @@ void OS_ReadKeys(keystore *keys, key_mode_t key_mode, int save_removed)
     keys->keytree_id = rbtree_init();
     keys->keytree_ip = rbtree_init();
     keys->keytree_sock = rbtree_init();
+    keys->keytree_name = rbtree_init();
 
-    if (!(keys->keytree_id && keys->keytree_ip && keys->keytree_sock)) {
+    if (!(keys->keytree_id && keys->keytree_ip && keys->keytree_sock && keys->keytree_name)) {
         merror_exit(MEM_ERROR, errno, strerror(errno));
     }
 
@@ -386,6 +413,7 @@ void OS_FreeKeys(keystore *keys)
     rbtree_destroy(keys->keytree_id);
     rbtree_destroy(keys->keytree_ip);
     rbtree_destroy(keys->keytree_sock);
+    rbtree_destroy(keys->keytree_name);
 
     for (i = 0; i <= keys->keysize; i++) {
         if (keys->keyentries[i]) {
@@ -399,6 +427,7 @@ void OS_FreeKeys(keystore *keys)
     keys->keytree_id = NULL;
     keys->keytree_ip = NULL;
     keys->keytree_sock = NULL;
+    keys->keytree_name = NULL;
 
     if (keys->removed_keys) {
         for (i = 0; i < keys->removed_keys_size; i++)
@@ -418,10 +447,10 @@ void OS_FreeKeys(keystore *keys)
     w_mutex_destroy(&keys->keytree_sock_mutex);
 }
 
-/* Check if key changed */
+/* Check if key changed. Appended keys keep the inode and may keep the modification second, but not the size. */
 int OS_CheckUpdateKeys(const keystore *keys)
 {
-    return keys->file_change != File_DateofChange(KEYS_FILE) || keys->inode != File_Inode(KEYS_FILE);
+    return keys->file_change != File_DateofChange(KEYS_FILE) || keys->inode != File_Inode(KEYS_FILE) || keys->file_size != FileSize(KEYS_FILE);
 }
 
 /* Update the keys if changed */
@@ -431,16 +460,44 @@ void OS_UpdateKeys(keystore *keys)
 
     mdebug1("Reloading keys");
 
-    mdebug2("OS_DupKeys");
-    old_keys = OS_DupKeys(keys);
+    old_keys = OS_SwapKeys(keys, OS_LoadKeys(keys));
 
-    mdebug2("Freekeys");
-    OS_FreeKeys(keys);
+    OS_FreeKeys(old_keys);
+    free(old_keys);
+
+    mdebug1("Key reloading completed");
+}
+
+/* Read the keys file into a new keystore, with the same flags as keys */
+keystore * OS_LoadKeys(const keystore *keys)
+{
+    keystore *new_keys;
+
+    os_calloc(1, sizeof(keystore), new_keys);
 
-    /* Read keys */
     mdebug2("OS_ReadKeys");
     minfo(ENC_READ);
-    OS_ReadKeys(keys, keys->flags.key_mode, keys->flags.save_removed);
+    OS_ReadKeys(new_keys, keys->flags.key_mode, keys->flags.save_removed);
+
+    return new_keys;
+}
+
+/* Replace the content of keys by the one of new_keys, that is released.
+ * The counters and the network data of the agents are kept.
+ * Returns a keystore with the former content, to be freed by the caller.
+ */
+keystore * OS_SwapKeys(keystore *keys, keystore *new_keys)
+{
+    keystore *old_keys;
+
+    os_calloc(1, sizeof(keystore), old_keys);
+    w_mutex_init(&old_keys->keytree_sock_mutex, NULL);
+
+    move_keystore(old_keys, keys);
+    move_keystore(keys, new_keys);
+
+    w_mutex_destroy(&new_keys->keytree_sock_mutex);
+    free(new_keys);
 
     mdebug2("OS_StartCounter");
     OS_StartCounter(keys);
@@ -448,10 +505,7 @@ void OS_UpdateKeys(keystore *keys)
     mdebug2("move_netdata");
     move_netdata(keys, old_keys);
 
-    OS_FreeKeys(old_keys);
-    free(old_keys);
-
-    mdebug1("Key reloading completed");
+    return old_keys;
 }
 
 /* Check if an IP address is allowed to connect */
@@ -476,6 +530,11 @@ int OS_IsAllowedName(const keystore *keys, const char *name)
 {
     unsigned int i = 0;
 
+    if (keys->keytree_name) {
+        keyentry *entry = (keyentry *) rbtree_get(keys->keytree_name, name);
+        return entry ? (int)entry->keyid : -1;
+    }
+
     for (i = 0; i < keys->keysize; i++) {
         if (strcmp(keys->keyentries[i]->name, name) == 0) {
             return ((int)i);
@@ -549,6 +608,18 @@ int OS_DeleteKey(keystore *keys, const char *id, int purge) {
     rbtree_delete(keys->keytree_id, id);
     rbtree_delete(keys->keytree_ip, keys->keyentries[i]->ip->ip);
 
+    /* Another key may hold the same name, index it instead */
+    if (keys->keytree_name && rbtree_get(keys->keytree_name, keys->keyentries[i]->name) == keys->keyentries[i]) {
+        rbtree_delete(keys->keytree_name, keys->keyentries[i]->name);
+
+        for (unsigned int j = 0; j < keys->keysize; j++) {
+            if ((int)j != i && strcmp(keys->keyentries[j]->name, keys->keyentries[i]->name) == 0) {
+                rbtree_insert(keys->keytree_name, keys->keyentries[j]->name, keys->keyentries[j]);
+                break;
+            }
+        }
+    }
+
     if (keys->keyentries[i]->sock >= 0) {
         char strsock[16] = "";
         snprintf(strsock, sizeof(strsock), "%d", keys->keyentries[i]->sock);
@@ -621,6 +692,35 @@ error:
     return -1;
 }
 
+/* Append keys at the end of the client keys file */
+int OS_AppendKeys(keyentry * const * entries, unsigned int count) {
+    unsigned int i;
+    FILE *fp;
+    char cidr[IPSIZE + 1];
+
+    if (fp = fopen(KEYS_FILE, "a"), !fp) {
+        merror(FOPEN_ERROR, KEYS_FILE, errno, strerror(errno));
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        const keyentry *entry = entries[i];
+
+        if (fprintf(fp, "%s %s %s %s\n", entry->id, entry->name, OS_CIDRtoStr(entry->ip, cidr, IPSIZE) ? entry->ip->ip : cidr, entry->raw_key) < 0) {
+            merror(FWRITE_ERROR, KEYS_FILE, errno, strerror(errno));
+            fclose(fp);
+            return -1;
+        }
+    }
+
+    if (fclose(fp) != 0) {
+        merror(FCLOSE_ERROR, KEYS_FILE, errno, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
 /* Duplicate keystore except key hashes and file pointer */
 keystore* OS_DupKeys(const keystore *keys) {
     keystore *copy;
@@ -632,6 +732,7 @@ keystore* OS_DupKeys(const keystore *keys) {
     copy->keysize = keys->keysize;
     copy->file_change = keys->file_change;
     copy->inode = keys->inode;
+    copy->file_size = keys->file_size;
     copy->id_counter = keys->id_counter;
     w_mutex_init(&copy->keytree_sock_mutex, NULL);
 
@@ -847,6 +948,45 @@ int OS_WriteTimestamps(keystore * keys) {
     return r;
 }
 
+// Append the timestamps of some keys at the end of the timestamps file
+
+int OS_AppendTimestamps(keyentry * const * entries, unsigned int count) {
+    FILE *fp;
+    int r = 0;
+
+    if (fp = fopen(TIMESTAMP_FILE, "a"), !fp) {
+        merror(FOPEN_ERROR, TIMESTAMP_FILE, errno, strerror(errno));
+        return -1;
+    }
+
+    for (unsigned i = 0; i < count; i++) {
+        const keyentry *entry = entries[i];
+
+        if (entry->time_added == 0) {
+            continue;
+        }
+
+        char timestamp[40];
+        char cidr[IPSIZE + 1];
+        struct tm tm_result = { .tm_sec = 0 };
+
+        strftime(timestamp, 40, "%Y-%m-%d %H:%M:%S", localtime_r(&entry->time_added, &tm_result));
+
+        if (fprintf(fp, "%s %s %s %s\n", entry->id, entry->name, OS_CIDRtoStr(entry->ip, cidr, IPSIZE) ? entry->ip->ip : cidr, timestamp) < 0) {
+            merror(FWRITE_ERROR, TIMESTAMP_FILE, errno, strerror(errno));
+            r = -1;
+            break;
+        }
+    }
+
+    if (fclose(fp) != 0) {
+        merror(FCLOSE_ERROR, TIMESTAMP_FILE, errno, strerror(errno));
+        r = -1;
+    }
+
+    return r;
+}
+
 int w_get_key_hash(keyentry *key_entry, os_sha1 output) {
     if (!key_entry || !output) {
         mdebug2("Unable to hash agent's key due to empty parameters.");
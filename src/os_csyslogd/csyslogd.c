@@ -35,6 +35,7 @@ void OS_CSyslogD(SyslogConfig **syslog_config)
     alert_source_t sources = get_alert_sources(syslog_config);
     file_queue *fileq = NULL;
     file_queue jfileq;
+    unsigned int min_level = UINT_MAX;
     alert_data *al_data = NULL;
     cJSON *json_data = NULL;
 
@@ -73,6 +74,15 @@ void OS_CSyslogD(SyslogConfig **syslog_config)
         } else {
             mdebug1("JSON file queue connected.");
         }
+
+        /* Alerts below the level of every JSON output are skipped before parsing them */
+        for (s = 0; syslog_config[s]; s++) {
+            if (syslog_config[s]->format == JSON_CSYSLOG && syslog_config[s]->level < min_level) {
+                min_level = syslog_config[s]->level;
+            }
+        }
+
+        jqueue_set_filter(&jfileq, min_level == UINT_MAX ? 0 : min_level, NULL);
     }
 
     if (!(sources.alert_log || sources.alert_json)) {
@@ -190,6 +190,7 @@ cJSON *getExecdInternalOptions(void) {
 
     cJSON_AddNumberToObject(execd,"request_timeout",req_timeout);
     cJSON_AddNumberToObject(execd,"max_restart_lock",max_restart_lock);
+    cJSON_AddNumberToObject(execd,"workers",execd_workers);
 
     cJSON_AddItemToObject(internals,"execd",execd);
     cJSON_AddItemToObject(root,"internal",internals);
@@ -26,11 +26,23 @@
 
 int repeated_offenders_timeout[] = {0, 0, 0, 0, 0, 0, 0};
 time_t pending_upg = 0;
+int execd_workers = 1;
 
 STATIC OSList *timeout_list;
 STATIC OSListNode *timeout_node;
 STATIC OSHash *repeated_hash;
 
+/* Alert fields holding the keys reported by each script, NULL-terminated arrays */
+STATIC OSHash *ar_key_fields;
+
+/* The timeout list and the repeated offenders are shared by the threads running the scripts */
+static pthread_mutex_t timeout_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+STATIC timeout_data *ExecdFindTimeout(const char *rkey);
+STATIC int ExecdRefreshTimeout(const char *rkey, int *timeout_value, time_t curr_time);
+STATIC void ExecdLearnKeyFields(const char *program, const cJSON *alert, const cJSON *keys_json);
+STATIC char *ExecdCachedKey(const char *program, const cJSON *alert);
+
 #ifdef WIN32
 #ifdef WAZUH_UNIT_TESTING
     #include "unit_tests/wrappers/windows/libc/stdio_wrappers.h"
@@ -129,8 +141,13 @@ void ExecdTimeoutRun(int *childcount)
 #endif
 {
     time_t curr_time = time(NULL);
+    timeout_data **expired = NULL;
+    int expired_count = 0;
+    int i;
 
     /* Check if there is any timed out command to execute */
+    w_mutex_lock(&timeout_mutex);
+
     timeout_node = OSList_GetFirstNode(timeout_list);
     while (timeout_node) {
         timeout_data *list_entry;
@@ -139,37 +156,48 @@ void ExecdTimeoutRun(int *childcount)
 
         /* Timed out */
         if ((curr_time - list_entry->time_of_addition) > list_entry->time_to_block) {
-
-            mdebug1("Executing command '%s %s' after a timeout of '%ds'",
-                list_entry->command[0],
-                list_entry->parameters ? list_entry->parameters : "",
-                list_entry->time_to_block
-            );
-
-            wfd_t *wfd = wpopenv(list_entry->command[0], list_entry->command, W_BIND_STDIN);
-            if (wfd) {
-                /* Send alert to AR script */
-                fprintf(wfd->file_in, "%s\n", list_entry->parameters);
-                fflush(wfd->file_in);
-                wpclose(wfd);
-            } else {
-                merror(EXEC_CMD_FAIL, strerror(errno), errno);
-            }
-
             /* Delete currently node - already sets the pointer to next */
             OSList_DeleteCurrentlyNode(timeout_list);
             timeout_node = OSList_GetCurrentlyNode(timeout_list);
 
-            /* Clear the memory */
-            FreeTimeoutEntry(list_entry);
-
-#ifndef WIN32
-            (*childcount)++;
-#endif
+            os_realloc(expired, (expired_count + 1) * sizeof(timeout_data *), expired);
+            expired[expired_count++] = list_entry;
         } else {
             timeout_node = OSList_GetNextNode(timeout_list);
         }
     }
+
+    w_mutex_unlock(&timeout_mutex);
+
+    /* The scripts run without the list locked */
+    for (i = 0; i < expired_count; i++) {
+        timeout_data *list_entry = expired[i];
+
+        mdebug1("Executing command '%s %s' after a timeout of '%ds'",
+            list_entry->command[0],
+            list_entry->parameters ? list_entry->parameters : "",
+            list_entry->time_to_block
+        );
+
+        wfd_t *wfd = wpopenv(list_entry->command[0], list_entry->command, W_BIND_STDIN);
+        if (wfd) {
+            /* Send alert to AR script */
+            fprintf(wfd->file_in, "%s\n", list_entry->parameters);
+            fflush(wfd->file_in);
+            wpclose(wfd);
+        } else {
+            merror(EXEC_CMD_FAIL, strerror(errno), errno);
+        }
+
+        /* Clear the memory */
+        FreeTimeoutEntry(list_entry);
+
+#ifndef WIN32
+        (*childcount)++;
+#endif
+    }
+
+    os_free(expired);
 }
 
 #ifdef WIN32
@@ -252,6 +280,30 @@ void ExecdRun(char *exec_msg, int *childcount)
     cJSON_AddItemToObject(json_parameters, "program", cJSON_CreateString(cmd[0]));
     cmd_parameters = cJSON_PrintUnformatted(json_root);
 
+    /* Skip the script if it would abort, because its keys are already in the timeout list */
+    if (timeout_value) {
+        char *cached_key = NULL;
+
+        w_mutex_lock(&timeout_mutex);
+
+        if (cached_key = ExecdCachedKey(cmd[0], cJSON_GetObjectItem(json_parameters, "alert")), cached_key) {
+            if (ExecdFindTimeout(cached_key)) {
+                ExecdRefreshTimeout(cached_key, &timeout_value, curr_time);
+                w_mutex_unlock(&timeout_mutex);
+
+                mdebug1("Active response '%s' already running for '%s', the script won't be executed.", cmd[0], cached_key);
+                os_free(cached_key);
+                os_free(cmd_parameters);
+                cJSON_Delete(json_root);
+                return;
+            }
+
+            os_free(cached_key);
+        }
+
+        w_mutex_unlock(&timeout_mutex);
+    }
+
     /* Execute command */
     mdebug1("Executing command '%s %s'", cmd[0], cmd_parameters ? cmd_parameters : "");
 
@@ -260,6 +312,7 @@ void ExecdRun(char *exec_msg, int *childcount)
         char response[OS_SIZE_8192];
         char rkey[OS_SIZE_4096];
         cJSON *keys_json = NULL;
+        const cJSON *reported_keys = NULL;
 
         /* Send alert to AR script */
         fprintf(wfd->file_in, "%s\n", cmd_parameters);
@@ -288,74 +341,23 @@ void ExecdRun(char *exec_msg, int *childcount)
                     /* Append to rkey the alert keys that the AR script will use */
                     strcat(rkey, keys);
                     os_free(keys);
+                    reported_keys = cJSON_GetObjectItem(cJSON_GetObjectItem(keys_json, "parameters"), "keys");
                 }
             }
-            cJSON_Delete(keys_json);
         }
 
         added_before = 0;
 
         /* We don't need to add to the list if the timeout_value == 0 */
         if (timeout_value) {
-            if (repeated_hash != NULL) {
-                char *ntimes = NULL;
-
-                if ((ntimes = (char *) OSHash_Get(repeated_hash, rkey))) {
-                    int ntimes_int = 0;
-                    int i2 = 0;
-                    int new_timeout = 0;
-
-                    ntimes_int = atoi(ntimes);
-                    while (repeated_offenders_timeout[i2] != 0) {
-                        i2++;
-                    }
-                    if (ntimes_int >= i2) {
-                        new_timeout = repeated_offenders_timeout[i2 - 1] * 60;
-                    } else {
-                        os_free(ntimes);       /* In hash_op.c, data belongs to caller */
-                        os_calloc(16, sizeof(char), ntimes);
-                        new_timeout = repeated_offenders_timeout[ntimes_int] * 60;
-                        ntimes_int++;
-                        snprintf(ntimes, 16, "%d", ntimes_int);
-                        if (OSHash_Update(repeated_hash, rkey, ntimes) != 1) {
-                            os_free(ntimes);
-                            merror("At ExecdRun: OSHash_Update() failed");
-                        }
-                    }
-                    mdebug1("Repeated offender. Setting timeout to '%ds'", new_timeout);
-                    timeout_value = new_timeout;
-                } else {
-                    /* Add to the repeated offenders list */
-                    char *tmp_zero;
-                    os_strdup("0", tmp_zero);
-                    if (OSHash_Add(repeated_hash, rkey, tmp_zero) != 2) {
-                        os_free(tmp_zero);
-                        merror("At ExecdRun: OSHash_Add() failed");
-                    }
-                }
-            }
-
-            /* Check if this command was already executed */
-            timeout_node = OSList_GetFirstNode(timeout_list);
-            while (timeout_node) {
-                timeout_data *list_entry;
-
-                list_entry = (timeout_data *)timeout_node->data;
-                if (strcmp(list_entry->rkey, rkey) == 0) {
-                    /* Means we executed this command before and we don't need to add it again */
-                    added_before = 1;
-
-                    /* Update the timeout */
-                    mdebug1("Command already received, updating time of addition to now.");
-                    list_entry->time_of_addition = curr_time;
-                    list_entry->time_to_block = timeout_value;
-                    break;
-                }
+            w_mutex_lock(&timeout_mutex);
 
-                /* Continue with the next entry in timeout list */
-                timeout_node = OSList_GetNextNode(timeout_list);
+            if (reported_keys) {
+                ExecdLearnKeyFields(cmd[0], cJSON_GetObjectItem(json_parameters, "alert"), reported_keys);
             }
 
+            added_before = ExecdRefreshTimeout(rkey, &timeout_value, curr_time);
+
             /* If it wasn't added before, do it now */
             if (!added_before) {
                 /* Timeout parameters */
@@ -383,8 +385,12 @@ void ExecdRun(char *exec_msg, int *childcount)
                     FreeTimeoutEntry(timeout_entry);
                 }
             }
+
+            w_mutex_unlock(&timeout_mutex);
         }
 
+        cJSON_Delete(keys_json);
+
         /* If it wasn't added before, continue execution */
         if (!added_before) {
             /* Continue command */
@@ -414,11 +420,225 @@ void ExecdRun(char *exec_msg, int *childcount)
     cJSON_Delete(json_root);
 }
 
+/* Find the entry of an active response in the timeout list
+ * Must be called with the timeout list locked
+ */
+STATIC timeout_data *ExecdFindTimeout(const char *rkey)
+{
+    timeout_node = OSList_GetFirstNode(timeout_list);
+    while (timeout_node) {
+        timeout_data *list_entry = (timeout_data *)timeout_node->data;
+
+        if (strcmp(list_entry->rkey, rkey) == 0) {
+            return list_entry;
+        }
+
+        /* Continue with the next entry in timeout list */
+        timeout_node = OSList_GetNextNode(timeout_list);
+    }
+
+    return NULL;
+}
+
+/* Count a new run of an active response, and refresh its timeout if it's already in the timeout list
+ * Must be called with the timeout list locked
+ * Returns 1 if the active response was in the list, 0 otherwise
+ */
+STATIC int ExecdRefreshTimeout(const char *rkey, int *timeout_value, time_t curr_time)
+{
+    timeout_data *list_entry;
+
+    if (repeated_hash != NULL) {
+        char *ntimes = NULL;
+
+        if ((ntimes = (char *) OSHash_Get(repeated_hash, rkey))) {
+            int ntimes_int = 0;
+            int i2 = 0;
+            int new_timeout = 0;
+
+            ntimes_int = atoi(ntimes);
+            while (repeated_offenders_timeout[i2] != 0) {
+                i2++;
+            }
+            if (ntimes_int >= i2) {
+                new_timeout = repeated_offenders_timeout[i2 - 1] * 60;
+            } else {
+                os_free(ntimes);       /* In hash_op.c, data belongs to caller */
+                os_calloc(16, sizeof(char), ntimes);
+                new_timeout = repeated_offenders_timeout[ntimes_int] * 60;
+                ntimes_int++;
+                snprintf(ntimes, 16, "%d", ntimes_int);
+                if (OSHash_Update(repeated_hash, rkey, ntimes) != 1) {
+                    os_free(ntimes);
+                    merror("At ExecdRun: OSHash_Update() failed");
+                }
+            }
+            mdebug1("Repeated offender. Setting timeout to '%ds'", new_timeout);
+            *timeout_value = new_timeout;
+        } else {
+            /* Add to the repeated offenders list */
+            char *tmp_zero;
+            os_strdup("0", tmp_zero);
+            if (OSHash_Add(repeated_hash, rkey, tmp_zero) != 2) {
+                os_free(tmp_zero);
+                merror("At ExecdRun: OSHash_Add() failed");
+            }
+        }
+    }
+
+    /* Check if this command was already executed */
+    if (list_entry = ExecdFindTimeout(rkey), list_entry) {
+        /* Means we executed this command before and we don't need to add it again */
+        mdebug1("Command already received, updating time of addition to now.");
+        list_entry->time_of_addition = curr_time;
+        list_entry->time_to_block = *timeout_value;
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Look for the string fields of an alert holding a value
+ * The path of the last one is kept in found, its members joined by dots
+ */
+static void ExecdFindKeyField(const cJSON *item, const char *value, char *path, size_t length, char **found, int *matches)
+{
+    const cJSON *child;
+
+    cJSON_ArrayForEach(child, item) {
+        /* Names with dots can't be told apart from nested members */
+        if (!child->string || strchr(child->string, '.')) {
+            continue;
+        }
+
+        int written = snprintf(path + length, OS_SIZE_1024 - length, "%s%s", length ? "." : "", child->string);
+
+        if (written < 0 || length + written >= OS_SIZE_1024) {
+            continue;
+        }
+
+        if (cJSON_IsObject(child)) {
+            ExecdFindKeyField(child, value, path, length + written, found, matches);
+        } else if (cJSON_IsString(child) && strcmp(child->valuestring, value) == 0) {
+            os_free(*found);
+            os_strdup(path, *found);
+            (*matches)++;
+        }
+    }
+
+    path[length] = '\0';
+}
+
+/* Learn which alert fields hold the keys reported by a script
+ * Only the keys held by a single field of the alert are learned, otherwise the script keeps being asked
+ * Must be called with the timeout list locked
+ */
+STATIC void ExecdLearnKeyFields(const char *program, const cJSON *alert, const cJSON *keys_json)
+{
+    char path[OS_SIZE_1024];
+    char **fields = NULL;
+    int count = 0;
+    const cJSON *key;
+
+    if (!ar_key_fields || !cJSON_IsObject(alert) || cJSON_GetArraySize(keys_json) == 0) {
+        return;
+    }
+
+    cJSON_ArrayForEach(key, keys_json) {
+        char *found = NULL;
+        int matches = 0;
+
+        if (!cJSON_IsString(key)) {
+            continue;
+        }
+
+        path[0] = '\0';
+        ExecdFindKeyField(alert, key->valuestring, path, 0, &found, &matches);
+
+        if (matches != 1) {
+            os_free(found);
+            free_strarray(fields);
+            free_strarray(OSHash_Delete(ar_key_fields, program));
+            return;
+        }
+
+        os_realloc(fields, (count + 2) * sizeof(char *), fields);
+        fields[count++] = found;
+        fields[count] = NULL;
+    }
+
+    if (fields && OSHash_Update(ar_key_fields, program, fields) != 1 && OSHash_Add(ar_key_fields, program, fields) != 2) {
+        free_strarray(fields);
+    }
+}
+
+/* Build the key of an active response from the alert fields learned for its script
+ * Must be called with the timeout list locked
+ * Returns the key if the fields were learned and the alert holds them, NULL otherwise
+ */
+STATIC char *ExecdCachedKey(const char *program, const cJSON *alert)
+{
+    char rkey[OS_SIZE_4096];
+    char *cached_key;
+    char **fields;
+    int i;
+
+    if (!ar_key_fields || !(fields = OSHash_Get(ar_key_fields, program))) {
+        return NULL;
+    }
+
+    snprintf(rkey, OS_SIZE_4096 - 1, "%s", basename_ex((char *)program));
+
+    for (i = 0; fields[i]; i++) {
+        char *field;
+        char *saveptr = NULL;
+        const cJSON *item = alert;
+
+        os_strdup(fields[i], field);
+
+        for (char *member = strtok_r(field, ".", &saveptr); member && item; member = strtok_r(NULL, ".", &saveptr)) {
+            item = cJSON_GetObjectItem(item, member);
+        }
+
+        os_free(field);
+
+        if (!cJSON_IsString(item) || strlen(rkey) + strlen(item->valuestring) + 2 > OS_SIZE_4096 - 1) {
+            return NULL;
+        }
+
+        strcat(rkey, "-");
+        strcat(rkey, item->valuestring);
+    }
+
+    os_strdup(rkey, cached_key);
+    return cached_key;
+}
+
 #ifndef WIN32
 
+/* Run the active responses queued by ExecdStart
+ * The scripts are waited for by wpclose, so the children aren't counted
+ */
+STATIC void * ExecdWorker(void *args)
+{
+    w_queue_t *exec_queue = (w_queue_t *)args;
+    int childcount = 0;
+
+    while (1) {
+        char *exec_msg = queue_pop_ex(exec_queue);
+
+        ExecdRun(exec_msg, &childcount);
+        os_free(exec_msg);
+        childcount = 0;
+    }
+
+    return NULL;
+}
+
 void ExecdStart(int q)
 {
     int childcount = 0;
+    w_queue_t *exec_queue = NULL;
 
     char buffer[OS_MAXSTR + 1];
 
@@ -443,6 +663,23 @@ void ExecdStart(int q)
         repeated_hash = NULL;
     }
 
+    if (!ar_key_fields && (ar_key_fields = OSHash_Create(), ar_key_fields)) {
+        OSHash_SetFreeDataPointer(ar_key_fields, (void (*)(void *))free_strarray);
+    }
+
+    /* Every worker runs one script at a time, the messages wait in the queue */
+    if (execd_workers > 1) {
+        int i;
+
+        exec_queue = queue_init(EXECD_QUEUE_SIZE);
+
+        for (i = 0; i < execd_workers; i++) {
+            w_create_thread(ExecdWorker, exec_queue);
+        }
+
+        mdebug1("Running the active responses with %d threads.", execd_workers);
+    }
+
     /* Main loop */
     while (1) {
         /* Clean up any children */
@@ -493,7 +730,14 @@ void ExecdStart(int q)
 
         mdebug2("Received message: '%s'", buffer);
 
-        ExecdRun(buffer, &childcount);
+        if (exec_queue) {
+            char *exec_msg;
+
+            os_strdup(buffer, exec_msg);
+            queue_push_ex_block(exec_queue, exec_msg);
+        } else {
+            ExecdRun(buffer, &childcount);
+        }
 
     #ifdef WAZUH_UNIT_TESTING
         break;
@@ -532,6 +776,10 @@ int WinExecdStart()
         repeated_hash = NULL;
     }
 
+    if (!ar_key_fields && (ar_key_fields = OSHash_Create(), ar_key_fields)) {
+        OSHash_SetFreeDataPointer(ar_key_fields, (void (*)(void *))free_strarray);
+    }
+
     /* Delete pending AR at succesfull exit */
     atexit(ExecdShutdown);
 
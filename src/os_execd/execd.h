@@ -30,11 +30,15 @@
 /* Execd select timeout -- in seconds */
 #define EXECD_TIMEOUT   1
 
+/* Active responses waiting for a worker */
+#define EXECD_QUEUE_SIZE    1024
+
 extern int repeated_offenders_timeout[];
 extern time_t pending_upg;
 extern int is_disabled;
 extern int req_timeout;
 extern int max_restart_lock;
+extern int execd_workers;
 
 /** Function prototypes **/
 
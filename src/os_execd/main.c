@@ -165,6 +165,8 @@ int main(int argc, char **argv)
         exit(EXIT_SUCCESS);
     }
 
+    execd_workers = getDefine_Int("execd", "workers", 1, 32);
+
     /* Start exec queue */
     if ((m_queue = StartMQ(EXECQUEUE, READ, 0)) < 0) {
         merror_exit(QUEUE_ERROR, EXECQUEUE, strerror(errno));
@@ -103,6 +103,9 @@ size_t wcom_dispatch(char *command, char ** output) {
     } else if (strcmp(rcv_comm, "check-manager-configuration") == 0) {
         return wcom_check_manager_config(output);
 
+    } else if (strcmp(rcv_comm, HC_GETMETRICS) == 0) {
+        return w_metrics_getmetrics(rcv_args, output);
+
     } else {
         mdebug1("WCOM Unrecognized command '%s'.", rcv_comm);
         os_strdup("err Unrecognized command", *output);
@@ -64,6 +64,8 @@ cJSON *getIntegratorConfig(void) {
         }
         cJSON_AddNumberToObject(cfg,"timeout",integrator_config[i]->timeout);
         cJSON_AddNumberToObject(cfg,"retries",integrator_config[i]->retries);
+        cJSON_AddNumberToObject(cfg,"workers",integrator_config[i]->workers);
+        cJSON_AddNumberToObject(cfg,"batch_size",integrator_config[i]->batch_size);
         cJSON_AddItemToArray(integrator,cfg);
     }
 
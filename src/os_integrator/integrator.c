@@ -29,12 +29,14 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
     FILE *fp;
 
     file_queue jfileq;
+    unsigned int min_level = UINT_MAX;
     cJSON *al_json = NULL;
     cJSON *json_object;
     cJSON *json_field;
     cJSON *location;
     cJSON *rule;
     cJSON *data;
+    intg_pool_t **pools;
 
     integration_path[2048] = 0;
     exec_tmp_file[2048] = 0;
@@ -146,6 +148,24 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
         s++;
     }
 
+    /* Alerts below the level of every integration are skipped before parsing them */
+    for (s = 0; integrator_config[s]; s++) {
+        if (integrator_config[s]->enabled && integrator_config[s]->level < min_level) {
+            min_level = integrator_config[s]->level;
+        }
+    }
+
+    jqueue_set_filter(&jfileq, min_level == UINT_MAX ? 0 : min_level, NULL);
+
+    /* Integrations with workers are started once */
+    os_calloc(s + 1, sizeof(intg_pool_t *), pools);
+
+    for (s = 0; integrator_config[s]; s++) {
+        if (integrator_config[s]->enabled) {
+            pools[s] = intg_pool_start(integrator_config[s]);
+        }
+    }
+
     /* Infinite loop reading the alerts and inserting them. */
     while(FOREVER())
     {
@@ -154,6 +174,11 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
         mdebug2("jqueue_next()");
         al_json = jqueue_next(&jfileq);
         if(!al_json) {
+            /* The partial batches are sent while the queue is idle */
+            for (s = 0; integrator_config[s]; s++) {
+                intg_pool_flush(pools[s]);
+            }
+
             sleep(1);
             continue;
         }
@@ -274,6 +299,11 @@ void OS_IntegratorD(IntegratorConfig **integrator_config)
                 }
             }
 
+            if (pools[s]) {
+                intg_pool_push(pools[s], al_json);
+                s++; continue;
+            }
+
             /* Create temp file once per alert and integration. */
             snprintf(exec_tmp_file, 2048, "/tmp/%s-%d-%ld.alert",
                         integrator_config[s]->name, (int)time(0), (long int)os_random());
@@ -24,6 +24,41 @@ void OS_IntegratorD(IntegratorConfig **integrator_config);
 
 extern IntegratorConfig **integrator_config;
 
+/* Native webhook message, NULL means that the alert is not sent */
+typedef char * (*intg_msg_builder)(const cJSON *alert, const IntegratorConfig *config, const cJSON *options);
+
+/* Long-lived senders of an integration */
+typedef struct intg_pool_t {
+    IntegratorConfig *config;
+
+    /* Scripts reading newline-delimited alerts from stdin */
+    wfd_t **workers;
+    char *options_file;
+    char *batch;
+    size_t batch_len;
+    size_t batch_alloc;
+    unsigned int pending;
+    unsigned int next;
+
+    /* Native webhook senders, one keep-alive connection each */
+    intg_msg_builder build;
+    const char *url;
+    bool verify;
+    cJSON *options;
+    w_queue_t *queue;
+} intg_pool_t;
+
+// Workers
+intg_pool_t * intg_pool_start(IntegratorConfig *config);
+void intg_pool_push(intg_pool_t *pool, const cJSON *alert);
+void intg_pool_flush(intg_pool_t *pool);
+
+// Native webhooks
+char * intg_slack_msg(const cJSON *alert, const IntegratorConfig *config, const cJSON *options);
+char * intg_shuffle_msg(const cJSON *alert, const IntegratorConfig *config, const cJSON *options);
+char * intg_pagerduty_msg(const cJSON *alert, const IntegratorConfig *config, const cJSON *options);
+void * intg_http_main(void *arg);
+
 // Read config
 cJSON *getIntegratorConfig(void);
 
@@ -32,6 +32,9 @@ size_t intgcom_dispatch(char * command, char ** output) {
         }
         return intgcom_getconfig(rcv_args, output);
 
+    } else if (strcmp(rcv_comm, HC_GETMETRICS) == 0) {
+        return w_metrics_getmetrics(rcv_args, output);
+
     } else {
         mdebug1("INTGCOM Unrecognized command '%s'.", rcv_comm);
         os_strdup("err Unrecognized command", *output);
@@ -0,0 +1,286 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ *
+ */
+
+/* Native senders of the webhook integrations.
+ * The messages are the same ones built by the scripts of the integrations,
+ * each sender thread keeps its connection open across the alerts.
+ */
+
+#include "shared.h"
+#include "integrator.h"
+
+/* Rules skipped by the Shuffle integration, Shuffle itself triggers them */
+static const char *shuffle_skip_rule_ids[] = {
+    "87924", "87900", "87901", "87902", "87903", "87904", "86001", "86002", "86003", "87932",
+    "80710", "87929", "87928", "5710", NULL
+};
+
+static const char *intg_get_string(const cJSON *object, const char *name, const char *def) {
+    const cJSON *item = cJSON_GetObjectItem(object, name);
+    return cJSON_IsString(item) ? item->valuestring : def;
+}
+
+/* The options of the integration replace the fields of the message */
+static void intg_merge_options(cJSON *msg, const cJSON *options) {
+    const cJSON *option;
+
+    if (!cJSON_IsObject(options)) {
+        return;
+    }
+
+    cJSON_ArrayForEach(option, options) {
+        cJSON_DeleteItemFromObject(msg, option->string);
+        cJSON_AddItemToObject(msg, option->string, cJSON_Duplicate(option, 1));
+    }
+}
+
+static char *intg_print_msg(cJSON *msg) {
+    char *output = cJSON_PrintUnformatted(msg);
+    cJSON_Delete(msg);
+    return output;
+}
+
+char *intg_slack_msg(const cJSON *alert, __attribute__((unused)) const IntegratorConfig *config, const cJSON *options) {
+    const cJSON *rule = cJSON_GetObjectItem(alert, "rule");
+    const cJSON *full_log;
+    const cJSON *agent;
+    const cJSON *agentless;
+    const cJSON *id;
+    cJSON *root;
+    cJSON *msg;
+    cJSON *fields;
+    cJSON *field;
+    char value[OS_SIZE_1024];
+    int level;
+
+    if (!rule) {
+        return NULL;
+    }
+
+    level = cJSON_GetObjectItem(rule, "level") ? cJSON_GetObjectItem(rule, "level")->valueint : 0;
+
+    msg = cJSON_CreateObject();
+    cJSON_AddStringToObject(msg, "color", level <= 4 ? "good" : level <= 7 ? "warning" : "danger");
+    cJSON_AddStringToObject(msg, "pretext", "WAZUH Alert");
+    cJSON_AddStringToObject(msg, "title", intg_get_string(rule, "description", "N/A"));
+
+    if (full_log = cJSON_GetObjectItem(alert, "full_log"), full_log) {
+        cJSON_AddItemToObject(msg, "text", cJSON_Duplicate(full_log, 1));
+    } else {
+        cJSON_AddNullToObject(msg, "text");
+    }
+
+    fields = cJSON_AddArrayToObject(msg, "fields");
+
+    if (agent = cJSON_GetObjectItem(alert, "agent"), agent) {
+        snprintf(value, sizeof(value), "(%s) - %s", intg_get_string(agent, "id", ""), intg_get_string(agent, "name", ""));
+        field = cJSON_CreateObject();
+        cJSON_AddStringToObject(field, "title", "Agent");
+        cJSON_AddStringToObject(field, "value", value);
+        cJSON_AddItemToArray(fields, field);
+    }
+
+    if (agentless = cJSON_GetObjectItem(alert, "agentless"), agentless) {
+        field = cJSON_CreateObject();
+        cJSON_AddStringToObject(field, "title", "Agentless Host");
+        cJSON_AddStringToObject(field, "value", intg_get_string(agentless, "host", ""));
+        cJSON_AddItemToArray(fields, field);
+    }
+
+    field = cJSON_CreateObject();
+    cJSON_AddStringToObject(field, "title", "Location");
+    cJSON_AddStringToObject(field, "value", intg_get_string(alert, "location", ""));
+    cJSON_AddItemToArray(fields, field);
+
+    snprintf(value, sizeof(value), "%s _(Level %d)_", intg_get_string(rule, "id", ""), level);
+    field = cJSON_CreateObject();
+    cJSON_AddStringToObject(field, "title", "Rule ID");
+    cJSON_AddStringToObject(field, "value", value);
+    cJSON_AddItemToArray(fields, field);
+
+    if (id = cJSON_GetObjectItem(alert, "id"), id) {
+        cJSON_AddItemToObject(msg, "ts", cJSON_Duplicate(id, 1));
+    }
+
+    intg_merge_options(msg, options);
+
+    root = cJSON_CreateObject();
+    cJSON_AddItemToArray(cJSON_AddArrayToObject(root, "attachments"), msg);
+
+    return intg_print_msg(root);
+}
+
+char *intg_shuffle_msg(const cJSON *alert, __attribute__((unused)) const IntegratorConfig *config, const cJSON *options) {
+    const cJSON *rule = cJSON_GetObjectItem(alert, "rule");
+    const cJSON *full_log;
+    const char *rule_id;
+    cJSON *msg;
+    int level;
+    int i;
+
+    if (!rule) {
+        return NULL;
+    }
+
+    rule_id = intg_get_string(rule, "id", "");
+
+    for (i = 0; shuffle_skip_rule_ids[i]; i++) {
+        if (strcmp(rule_id, shuffle_skip_rule_ids[i]) == 0) {
+            mdebug2("Skipping rule %s", rule_id);
+            return NULL;
+        }
+    }
+
+    level = cJSON_GetObjectItem(rule, "level") ? cJSON_GetObjectItem(rule, "level")->valueint : 0;
+
+    msg = cJSON_CreateObject();
+    cJSON_AddNumberToObject(msg, "severity", level <= 4 ? 1 : level <= 7 ? 2 : 3);
+    cJSON_AddStringToObject(msg, "pretext", "WAZUH Alert");
+    cJSON_AddStringToObject(msg, "title", intg_get_string(rule, "description", "N/A"));
+
+    if (full_log = cJSON_GetObjectItem(alert, "full_log"), full_log) {
+        cJSON_AddItemToObject(msg, "text", cJSON_Duplicate(full_log, 1));
+    } else {
+        cJSON_AddNullToObject(msg, "text");
+    }
+
+    cJSON_AddStringToObject(msg, "rule_id", rule_id);
+    cJSON_AddStringToObject(msg, "timestamp", intg_get_string(alert, "timestamp", ""));
+    cJSON_AddStringToObject(msg, "id", intg_get_string(alert, "id", ""));
+    cJSON_AddItemToObject(msg, "all_fields", cJSON_Duplicate(alert, 1));
+
+    intg_merge_options(msg, options);
+
+    return intg_print_msg(msg);
+}
+
+char *intg_pagerduty_msg(const cJSON *alert, const IntegratorConfig *config, const cJSON *options) {
+    const cJSON *rule = cJSON_GetObjectItem(alert, "rule");
+    const cJSON *group;
+    cJSON *payload;
+    cJSON *msg;
+    char groups[OS_SIZE_1024];
+    size_t length = 0;
+    int level;
+
+    if (!rule) {
+        return NULL;
+    }
+
+    level = cJSON_GetObjectItem(rule, "level") ? cJSON_GetObjectItem(rule, "level")->valueint : 0;
+
+    groups[0] = '\0';
+
+    cJSON_ArrayForEach(group, cJSON_GetObjectItem(rule, "groups")) {
+        if (cJSON_IsString(group) && length < sizeof(groups)) {
+            length += snprintf(groups + length, sizeof(groups) - length, "%s%s", length ? ", " : "", group->valuestring);
+        }
+    }
+
+    msg = cJSON_CreateObject();
+    cJSON_AddStringToObject(msg, "routing_key", config->apikey ? config->apikey : "");
+    cJSON_AddStringToObject(msg, "event_action", "trigger");
+
+    payload = cJSON_AddObjectToObject(msg, "payload");
+    cJSON_AddStringToObject(payload, "summary", intg_get_string(rule, "description", "N/A"));
+    cJSON_AddStringToObject(payload, "timestamp", intg_get_string(alert, "timestamp", ""));
+    cJSON_AddStringToObject(payload, "source", intg_get_string(cJSON_GetObjectItem(alert, "agent"), "name", ""));
+    cJSON_AddStringToObject(payload, "severity", level >= 7 ? "warning" : "info");
+    cJSON_AddStringToObject(payload, "group", groups);
+    cJSON_AddItemToObject(payload, "custom_details", cJSON_Duplicate(alert, 1));
+
+    cJSON_AddStringToObject(msg, "client", "Wazuh Monitoring Service");
+    cJSON_AddStringToObject(msg, "client_url", "https://wazuh.com");
+
+    intg_merge_options(msg, options);
+
+    return intg_print_msg(msg);
+}
+
+static size_t intg_http_discard(__attribute__((unused)) void *data, size_t size, size_t nmemb, __attribute__((unused)) void *userp) {
+    return size * nmemb;
+}
+
+static void intg_http_send(intg_pool_t *pool, CURL *curl, const char *msg) {
+    const char *name = pool->config->name;
+    unsigned int attempt;
+    long status = 0;
+    CURLcode res;
+
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, msg);
+
+    for (attempt = 0; attempt <= pool->config->retries; attempt++) {
+        if (res = curl_easy_perform(curl), res != CURLE_OK) {
+            mdebug1("Could not send the alert to '%s': %s", name, curl_easy_strerror(res));
+            continue;
+        }
+
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+
+        // Only the server errors and the throttling are retried
+        if (status >= 500 || status == 429) {
+            mdebug1("The alert sent to '%s' got the HTTP status %ld.", name, status);
+            continue;
+        }
+
+        if (status >= 400) {
+            merror("The alert sent to '%s' was rejected with the HTTP status %ld.", name, status);
+        } else {
+            mdebug2("Alert sent to '%s' (HTTP status %ld).", name, status);
+        }
+
+        return;
+    }
+
+    merror("Unable to send the alert to '%s' after %u attempts.", name, pool->config->retries + 1);
+}
+
+void *intg_http_main(void *arg) {
+    intg_pool_t *pool = (intg_pool_t *)arg;
+    struct curl_slist *headers = NULL;
+    const char *cert;
+    CURL *curl;
+    char *msg;
+
+    if (curl = curl_easy_init(), !curl) {
+        merror("Could not start a sender of '%s'.", pool->config->name);
+        return NULL;
+    }
+
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    headers = curl_slist_append(headers, "Accept-Charset: UTF-8");
+
+    curl_easy_setopt(curl, CURLOPT_URL, pool->url);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, intg_http_discard);
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+
+    if (pool->config->timeout) {
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, (long)pool->config->timeout);
+    }
+
+    if (!pool->verify) {
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    } else if (strncmp(pool->url, "https", 5) == 0 && (cert = find_cert_list(), cert)) {
+        curl_easy_setopt(curl, CURLOPT_CAINFO, cert);
+    }
+
+    while (msg = queue_pop_ex(pool->queue), msg) {
+        intg_http_send(pool, curl, msg);
+        os_free(msg);
+    }
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+
+    return NULL;
+}
@@ -0,0 +1,225 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ *
+ */
+
+/* Long-lived senders of the integrations.
+ * The webhooks known by integratord are sent by native threads. Custom
+ * integrations are started once as workers that read one JSON alert per
+ * line from stdin: the alert file argument of the script is "-" and the
+ * rest of the arguments are the ones of a single run.
+ */
+
+#include "shared.h"
+#include "integrator.h"
+
+#define INTG_QUEUE_SIZE 4096
+#define INTG_PAGERDUTY_URL "https://events.pagerduty.com/v2/enqueue"
+
+static wfd_t *intg_worker_start(intg_pool_t *pool) {
+    IntegratorConfig *config = pool->config;
+    char timeout[16];
+    char retries[16];
+    wfd_t *wfd;
+
+    snprintf(timeout, sizeof(timeout), "%u", config->timeout);
+    snprintf(retries, sizeof(retries), "%u", config->retries);
+
+    char *argv[] = {
+        config->path,
+        "-",
+        config->apikey ? config->apikey : "",
+        config->hookurl ? config->hookurl : "",
+        isDebug() <= 0 ? "" : "debug",
+        pool->options_file ? pool->options_file : "",
+        timeout,
+        retries,
+        NULL
+    };
+
+    if (wfd = wpopenv(config->path, argv, W_BIND_STDIN | W_CHECK_WRITE), !wfd) {
+        merror("Could not start a worker of '%s': %s (%d)", config->name, strerror(errno), errno);
+        return NULL;
+    }
+
+    mdebug1("Worker of '%s' started.", config->name);
+    return wfd;
+}
+
+static void intg_worker_stop(intg_pool_t *pool, unsigned int i) {
+    int wstatus = wpclose(pool->workers[i]);
+
+    pool->workers[i] = NULL;
+
+    if (WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == 127) {
+        merror("Couldn't execute the worker of '%s'. Check file and permissions.", pool->config->name);
+    } else if (WIFEXITED(wstatus)) {
+        mwarn("The worker of '%s' exited with status %d.", pool->config->name, WEXITSTATUS(wstatus));
+    } else {
+        mwarn("The worker of '%s' exited abnormally.", pool->config->name);
+    }
+}
+
+static int intg_worker_write(intg_pool_t *pool, unsigned int i) {
+    wfd_t *wfd = pool->workers[i];
+
+    if (!wfd && (wfd = pool->workers[i] = intg_worker_start(pool), !wfd)) {
+        return -1;
+    }
+
+    if (fwrite(pool->batch, 1, pool->batch_len, wfd->file_in) != pool->batch_len || fflush(wfd->file_in) != 0) {
+        intg_worker_stop(pool, i);
+        return -1;
+    }
+
+    return 0;
+}
+
+static char *intg_options_file(const IntegratorConfig *config) {
+    char path[PATH_MAX];
+    FILE *fp;
+
+    snprintf(path, sizeof(path), "/tmp/%s-%d-%ld.options", config->name, (int)time(0), (long int)os_random());
+
+    if (fp = fopen(path, "w"), !fp) {
+        mdebug2("File %s couldn't be created.", path);
+        return NULL;
+    }
+
+    fprintf(fp, "%s\n", config->options);
+    fclose(fp);
+    mdebug2("File %s was written.", path);
+
+    return strdup(path);
+}
+
+intg_pool_t *intg_pool_start(IntegratorConfig *config) {
+    static bool curl_ready;
+    intg_msg_builder build = NULL;
+    const char *url = config->hookurl;
+    bool verify = true;
+    intg_pool_t *pool;
+    unsigned int i;
+
+    if (config->workers == 0) {
+        return NULL;
+    }
+
+    if (strcmp(config->name, "slack") == 0) {
+        build = intg_slack_msg;
+    } else if (strcmp(config->name, "shuffle") == 0) {
+        build = intg_shuffle_msg;
+        verify = false;
+    } else if (strcmp(config->name, "pagerduty") == 0) {
+        build = intg_pagerduty_msg;
+        url = INTG_PAGERDUTY_URL;
+    } else if (strncmp(config->name, "custom-", 7) != 0) {
+        mwarn("The integration '%s' doesn't support workers. It will run once per alert.", config->name);
+        return NULL;
+    } else if (!config->alert_format || strncmp(config->alert_format, "json", 4) != 0) {
+        mwarn("The workers of '%s' need the JSON alert format. It will run once per alert.", config->name);
+        return NULL;
+    }
+
+    os_calloc(1, sizeof(intg_pool_t), pool);
+    pool->config = config;
+
+    if (build) {
+        pool->build = build;
+        pool->url = url;
+        pool->verify = verify;
+
+        if (config->options && (pool->options = cJSON_Parse(config->options), !pool->options)) {
+            mwarn("Invalid options for '%s'. They will be ignored.", config->name);
+        }
+
+        if (!curl_ready) {
+            curl_global_init(CURL_GLOBAL_DEFAULT);
+            curl_ready = true;
+        }
+
+        pool->queue = queue_init(INTG_QUEUE_SIZE);
+
+        for (i = 0; i < config->workers; i++) {
+            w_create_thread(intg_http_main, pool);
+        }
+
+        minfo("Sending the alerts of '%s' with %u native senders.", config->name, config->workers);
+        return pool;
+    }
+
+    if (config->options) {
+        pool->options_file = intg_options_file(config);
+    }
+
+    os_calloc(config->workers, sizeof(wfd_t *), pool->workers);
+
+    for (i = 0; i < config->workers; i++) {
+        pool->workers[i] = intg_worker_start(pool);
+    }
+
+    minfo("Streaming the alerts of '%s' to %u workers.", config->name, config->workers);
+    return pool;
+}
+
+void intg_pool_push(intg_pool_t *pool, const cJSON *alert) {
+    char *msg;
+    size_t length;
+
+    if (pool->queue) {
+        if (msg = pool->build(alert, pool->config, pool->options), msg) {
+            // Blocks while every sender is busy
+            queue_push_ex_block(pool->queue, msg);
+        } else {
+            mdebug2("Skipping: The alert isn't sent to '%s'.", pool->config->name);
+        }
+
+        return;
+    }
+
+    if (msg = cJSON_PrintUnformatted(alert), !msg) {
+        return;
+    }
+
+    length = strlen(msg);
+
+    if (pool->batch_len + length + 1 > pool->batch_alloc) {
+        pool->batch_alloc = pool->batch_len + length + OS_MAXSTR;
+        os_realloc(pool->batch, pool->batch_alloc, pool->batch);
+    }
+
+    memcpy(pool->batch + pool->batch_len, msg, length);
+    pool->batch_len += length;
+    pool->batch[pool->batch_len++] = '\n';
+    os_free(msg);
+
+    if (++pool->pending >= pool->config->batch_size) {
+        intg_pool_flush(pool);
+    }
+}
+
+void intg_pool_flush(intg_pool_t *pool) {
+    unsigned int i;
+
+    if (!pool || pool->pending == 0) {
+        return;
+    }
+
+    i = pool->next;
+    pool->next = (pool->next + 1) % pool->config->workers;
+
+    // A worker that exited is started again and gets the whole batch
+    if (intg_worker_write(pool, i) < 0 && intg_worker_write(pool, i) < 0) {
+        merror("Unable to send %u alerts to the workers of '%s'.", pool->pending, pool->config->name);
+    } else {
+        mdebug2("Sent %u alerts to the worker %u of '%s'.", pool->pending, i, pool->config->name);
+    }
+
+    pool->batch_len = 0;
+    pool->pending = 0;
+}
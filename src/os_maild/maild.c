@@ -262,6 +262,8 @@ static void OS_Run(MailConfig *mail)
     case MAIL_SOURCE_JSON:
         minfo("Getting alerts in JSON format.");
         jqueue_init(fileq);
+        /* Only the alerts of rules with the mail flag are sent */
+        jqueue_set_filter(fileq, 0, "\"mail\":true");
 
         if (jqueue_open(fileq, 1) < 0) {
             merror("Could not open JSON alerts file.");
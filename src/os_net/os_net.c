@@ -27,7 +27,7 @@
 #endif
 
 /* Prototypes */
-static int OS_Bindport(u_int16_t _port, unsigned int _proto, const char *_ip, int ipv6);
+static int OS_Bindport(u_int16_t _port, unsigned int _proto, const char *_ip, int ipv6, int reuse_port);
 static int OS_Connect(u_int16_t _port, unsigned int protocol, const char *_ip, int ipv6, uint32_t network_interface);
 
 /* Unix socket -- not for windows */
@@ -52,7 +52,7 @@ static int OS_Connect(u_int16_t _port, unsigned int protocol, const char *_ip, i
 
 
 /* Bind a specific port */
-static int OS_Bindport(u_int16_t _port, unsigned int _proto, const char *_ip, int ipv6)
+static int OS_Bindport(u_int16_t _port, unsigned int _proto, const char *_ip, int ipv6, int reuse_port)
 {
     int ossock;
     struct sockaddr_in server;
@@ -78,6 +78,20 @@ static int OS_Bindport(u_int16_t _port, unsigned int _proto, const char *_ip, in
         return (OS_INVALID);
     }
 
+    if (reuse_port) {
+#ifdef SO_REUSEPORT
+        int flag = 1;
+
+        if (setsockopt(ossock, SOL_SOCKET, SO_REUSEPORT, (char *)&flag, sizeof(flag)) < 0) {
+            OS_CloseSocket(ossock);
+            return (OS_SOCKTERR);
+        }
+#else
+        OS_CloseSocket(ossock);
+        return (OS_INVALID);
+#endif
+    }
+
     if (ipv6) {
         memset(&server6, 0, sizeof(server6));
         server6.sin6_family = AF_INET6;
@@ -123,13 +137,25 @@ static int OS_Bindport(u_int16_t _port, unsigned int _proto, const char *_ip, in
 /* Bind a TCP port, using the OS_Bindport */
 int OS_Bindporttcp(u_int16_t _port, const char *_ip, int ipv6)
 {
-    return (OS_Bindport(_port, IPPROTO_TCP, _ip, ipv6));
+    return (OS_Bindport(_port, IPPROTO_TCP, _ip, ipv6, 0));
 }
 
 /* Bind a UDP port, using the OS_Bindport */
 int OS_Bindportudp(u_int16_t _port, const char *_ip, int ipv6)
 {
-    return (OS_Bindport(_port, IPPROTO_UDP, _ip, ipv6));
+    return (OS_Bindport(_port, IPPROTO_UDP, _ip, ipv6, 0));
+}
+
+/* Bind a TCP port shared with other sockets, using the OS_Bindport */
+int OS_Bindporttcp_reuseport(u_int16_t _port, const char *_ip, int ipv6)
+{
+    return (OS_Bindport(_port, IPPROTO_TCP, _ip, ipv6, 1));
+}
+
+/* Bind a UDP port shared with other sockets, using the OS_Bindport */
+int OS_Bindportudp_reuseport(u_int16_t _port, const char *_ip, int ipv6)
+{
+    return (OS_Bindport(_port, IPPROTO_UDP, _ip, ipv6, 1));
 }
 
 #ifndef WIN32
@@ -27,6 +27,14 @@
 int OS_Bindporttcp(u_int16_t _port, const char *_ip, int ipv6);
 int OS_Bindportudp(u_int16_t _port, const char *_ip, int ipv6);
 
+/* OS_Bindport*_reuseport
+ * Same as OS_Bindport*, with SO_REUSEPORT set, so that several sockets
+ * can be bound to the same port and the kernel balances the load among them.
+ * Return the socket.
+ */
+int OS_Bindporttcp_reuseport(u_int16_t _port, const char *_ip, int ipv6);
+int OS_Bindportudp_reuseport(u_int16_t _port, const char *_ip, int ipv6);
+
 /* OS_BindUnixDomain
  * Bind to a specific file, using the "mode" permissions in
  * a Unix Domain socket.
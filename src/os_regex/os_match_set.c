@@ -0,0 +1,331 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All right reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "os_regex.h"
+#include "os_regex_internal.h"
+
+/* Aho-Corasick automaton state. Transitions are sorted by char */
+typedef struct _OSMatchSetState {
+    uchar *chars;
+    int *next;
+    int size;
+    int fail;       /* State of the longest proper suffix in the trie */
+    int output;     /* First output of the state, -1 if none */
+    int dict;       /* Nearest state with output through the fail links, -1 if none */
+} OSMatchSetState;
+
+struct _OSMatchSet {
+    OSMatchSetState *states;
+    size_t states_size;
+    size_t states_alloc;
+
+    /* Outputs: list of set ids of each state */
+    int *output_id;
+    int *output_next;
+    size_t outputs_size;
+    size_t outputs_alloc;
+
+    size_t size;
+    int compiled;
+};
+
+
+/* Transition of a state, -1 if none */
+static int _os_match_set_goto(const OSMatchSetState *state, uchar c)
+{
+    int low = 0;
+    int high = state->size - 1;
+
+    while (low <= high) {
+        int mid = (low + high) / 2;
+
+        if (state->chars[mid] == c) {
+            return state->next[mid];
+        } else if (state->chars[mid] < c) {
+            low = mid + 1;
+        } else {
+            high = mid - 1;
+        }
+    }
+
+    return -1;
+}
+
+static int _os_match_set_new_state(OSMatchSet *set)
+{
+    if (set->states_size == set->states_alloc) {
+        size_t alloc = set->states_alloc ? set->states_alloc * 2 : 64;
+        OSMatchSetState *states = realloc(set->states, alloc * sizeof(OSMatchSetState));
+
+        if (!states) {
+            return -1;
+        }
+
+        set->states = states;
+        set->states_alloc = alloc;
+    }
+
+    memset(&set->states[set->states_size], 0, sizeof(OSMatchSetState));
+    set->states[set->states_size].output = -1;
+    set->states[set->states_size].dict = -1;
+
+    return (int)set->states_size++;
+}
+
+/* Get the transition of a state, creating it if needed */
+static int _os_match_set_add_goto(OSMatchSet *set, int state, uchar c)
+{
+    OSMatchSetState *st = &set->states[state];
+    uchar *chars;
+    int *next;
+    int target;
+    int pos;
+
+    if (target = _os_match_set_goto(st, c), target >= 0) {
+        return target;
+    }
+
+    if (target = _os_match_set_new_state(set), target < 0) {
+        return -1;
+    }
+
+    /* The states array may have been moved */
+    st = &set->states[state];
+
+    chars = realloc(st->chars, (st->size + 1) * sizeof(uchar));
+    if (!chars) {
+        return -1;
+    }
+    st->chars = chars;
+
+    next = realloc(st->next, (st->size + 1) * sizeof(int));
+    if (!next) {
+        return -1;
+    }
+    st->next = next;
+
+    for (pos = st->size; pos > 0 && st->chars[pos - 1] > c; pos--) {
+        st->chars[pos] = st->chars[pos - 1];
+        st->next[pos] = st->next[pos - 1];
+    }
+
+    st->chars[pos] = c;
+    st->next[pos] = target;
+    st->size++;
+
+    return target;
+}
+
+static int _os_match_set_add_output(OSMatchSet *set, int state, int id)
+{
+    if (set->outputs_size == set->outputs_alloc) {
+        size_t alloc = set->outputs_alloc ? set->outputs_alloc * 2 : 64;
+        int *output_id = realloc(set->output_id, alloc * sizeof(int));
+        int *output_next;
+
+        if (!output_id) {
+            return 0;
+        }
+        set->output_id = output_id;
+
+        if (output_next = realloc(set->output_next, alloc * sizeof(int)), !output_next) {
+            return 0;
+        }
+        set->output_next = output_next;
+        set->outputs_alloc = alloc;
+    }
+
+    set->output_id[set->outputs_size] = id;
+    set->output_next[set->outputs_size] = set->states[state].output;
+    set->states[state].output = (int)set->outputs_size++;
+
+    return 1;
+}
+
+/* Create an empty set of patterns
+ * Returns NULL on error
+ */
+OSMatchSet *OSMatchSet_Create()
+{
+    OSMatchSet *set = calloc(1, sizeof(OSMatchSet));
+
+    if (!set) {
+        return NULL;
+    }
+
+    /* Root state */
+    if (_os_match_set_new_state(set) < 0) {
+        free(set);
+        return NULL;
+    }
+
+    return set;
+}
+
+/* Add the sub patterns of a compiled OSMatch to the set
+ * Only not negated patterns whose sub patterns are plain substrings
+ * (no ^, no $ and not empty) are accepted.
+ * Returns the id of the pattern in the set or -1 if it can't be added
+ */
+int OSMatchSet_Add(OSMatchSet *set, const OSMatch *reg)
+{
+    int id;
+    int i;
+
+    if (!set || set->compiled || !reg || !reg->patterns || !reg->patterns[0] || reg->negate) {
+        return -1;
+    }
+
+    for (i = 0; reg->patterns[i]; i++) {
+        if (reg->match_fp[i] != _OS_Match || reg->size[i] == 0) {
+            return -1;
+        }
+    }
+
+    id = (int)set->size;
+
+    for (i = 0; reg->patterns[i]; i++) {
+        const uchar *pt = (const uchar *)reg->patterns[i];
+        int state = 0;
+
+        for (; *pt != '\0'; pt++) {
+            if (state = _os_match_set_add_goto(set, state, *pt), state < 0) {
+                return -1;
+            }
+        }
+
+        if (!_os_match_set_add_output(set, state, id)) {
+            return -1;
+        }
+    }
+
+    set->size++;
+    return id;
+}
+
+/* Build the failure links of the set. No pattern can be added after it
+ * Returns 1 on success or 0 on error
+ */
+int OSMatchSet_Compile(OSMatchSet *set)
+{
+    int *queue;
+    size_t head = 0;
+    size_t tail = 0;
+
+    if (!set) {
+        return 0;
+    }
+
+    if (queue = calloc(set->states_size, sizeof(int)), !queue) {
+        return 0;
+    }
+
+    /* Breadth-first, so the fail state of each state is already set */
+    queue[tail++] = 0;
+
+    while (head < tail) {
+        int state = queue[head++];
+        int i;
+
+        for (i = 0; i < set->states[state].size; i++) {
+            uchar c = set->states[state].chars[i];
+            int target = set->states[state].next[i];
+            int fail = set->states[state].fail;
+            int next = -1;
+
+            if (state != 0) {
+                while ((next = _os_match_set_goto(&set->states[fail], c)) < 0 && fail != 0) {
+                    fail = set->states[fail].fail;
+                }
+            }
+
+            set->states[target].fail = next >= 0 ? next : 0;
+            fail = set->states[target].fail;
+            set->states[target].dict = set->states[fail].output >= 0 ? fail : set->states[fail].dict;
+
+            queue[tail++] = target;
+        }
+    }
+
+    free(queue);
+    set->compiled = 1;
+
+    return 1;
+}
+
+/* Number of patterns of the set */
+size_t OSMatchSet_Size(const OSMatchSet *set)
+{
+    return set ? set->size : 0;
+}
+
+/* Scan a string once, setting the bit of each pattern of the set with a sub pattern in it
+ * matches must hold (OSMatchSet_Size(set) + 7) / 8 bytes, it is cleared first.
+ * The result of each pattern is the same as OSMatch_Execute.
+ */
+void OSMatchSet_Execute(const OSMatchSet *set, const char *str, uchar *matches)
+{
+    const uchar *pt = (const uchar *)str;
+    int state = 0;
+
+    if (!set || !matches) {
+        return;
+    }
+
+    memset(matches, 0, (set->size + 7) / 8);
+
+    if (!set->compiled || !str) {
+        return;
+    }
+
+    for (; *pt != '\0'; pt++) {
+        uchar c = charmap[*pt];
+        int next;
+        int out;
+
+        while ((next = _os_match_set_goto(&set->states[state], c)) < 0 && state != 0) {
+            state = set->states[state].fail;
+        }
+
+        state = next >= 0 ? next : 0;
+
+        for (out = set->states[state].output >= 0 ? state : set->states[state].dict; out >= 0;
+             out = set->states[out].dict) {
+            int o;
+
+            for (o = set->states[out].output; o >= 0; o = set->output_next[o]) {
+                matches[set->output_id[o] / 8] |= (uchar)(1 << (set->output_id[o] % 8));
+            }
+        }
+    }
+}
+
+/* Release all the memory of the set */
+void OSMatchSet_Free(OSMatchSet *set)
+{
+    size_t i;
+
+    if (!set) {
+        return;
+    }
+
+    for (i = 0; i < set->states_size; i++) {
+        free(set->states[i].chars);
+        free(set->states[i].next);
+    }
+
+    free(set->states);
+    free(set->output_id);
+    free(set->output_next);
+    free(set);
+}
@@ -49,12 +49,21 @@ typedef struct regex_matching {
     regex_dynamic_size d_size;
 } regex_matching;
 
+/* Literal that a string must contain for a sub pattern to match */
+typedef struct regex_literal {
+    char *str;                  ///< Literal as stored in the pattern, NULL if the sub pattern has none
+    size_t size;                ///< Length of str
+    int first_size;             ///< Number of chars matching the first char of str, -1 if more than 2
+    unsigned char first[2];     ///< Chars matching the first char of str
+} regex_literal;
+
 /* OSRegex structure */
 typedef struct _OSRegex {
     int error;
     char *raw;
     int *flags;
     char **patterns;
+    regex_literal *literals;
     const char ** *prts_closure;
     pthread_mutex_t mutex;
     bool mutex_initialised;
@@ -74,6 +83,9 @@ typedef struct _OSMatch {
     int (**match_fp)(const char *str, const char *str2, size_t str_len, size_t size);
 } OSMatch;
 
+/* Set of OSMatch patterns matched with a single scan of the string (Aho-Corasick) */
+typedef struct _OSMatchSet OSMatchSet;
+
 /*** Prototypes ***/
 
 /* Compile a regular expression to be used later
@@ -139,6 +151,35 @@ int OSMatch_Execute(const char *str, size_t str_len, OSMatch *reg);
 /* Release all the memory created by the compilation/execution phases */
 void OSMatch_FreePattern(OSMatch *reg);
 
+/* Create an empty set of patterns.
+ * Returns NULL on error.
+ */
+OSMatchSet *OSMatchSet_Create(void);
+
+/* Add the sub patterns of a compiled OSMatch to the set.
+ * Only not negated patterns made of plain substrings (no ^, no $
+ * and not empty) are accepted.
+ * Returns the id of the pattern in the set or -1 if it can't be added.
+ */
+int OSMatchSet_Add(OSMatchSet *set, const OSMatch *reg);
+
+/* Build the failure links of the set. No pattern can be added after it.
+ * Returns 1 on success or 0 on error.
+ */
+int OSMatchSet_Compile(OSMatchSet *set);
+
+/* Number of patterns of the set */
+size_t OSMatchSet_Size(const OSMatchSet *set);
+
+/* Scan a string once, setting the bit of each pattern of the set that
+ * OSMatch_Execute would match. matches must hold
+ * (OSMatchSet_Size(set) + 7) / 8 bytes, it is cleared first.
+ */
+void OSMatchSet_Execute(const OSMatchSet *set, const char *str, unsigned char *matches);
+
+/* Release all the memory of the set */
+void OSMatchSet_Free(OSMatchSet *set);
+
 int OS_Match2(const char *pattern, const char *str)  __attribute__((nonnull(2)));
 
 /* Searches for pattern in the string */
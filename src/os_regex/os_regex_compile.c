@@ -17,6 +17,9 @@
 #include "shared.h"
 #include "os_regex_internal.h"
 
+/* Internal prototypes */
+static void _os_regex_literal(const char *pattern, regex_literal *literal) __attribute__((nonnull));
+
 
 /* Compile a regular expression to be used later
  * Allowed flags are:
@@ -45,6 +48,7 @@ int OSRegex_Compile(const char *pattern, OSRegex *reg, int flags)
     /* Initialize OSRegex structure */
     reg->error = 0;
     reg->patterns = NULL;
+    reg->literals = NULL;
     reg->flags = NULL;
     reg->d_prts_str = NULL;
     reg->d_sub_strings = NULL;
@@ -178,9 +182,10 @@ int OSRegex_Compile(const char *pattern, OSRegex *reg, int flags)
     count++;
     os_calloc(count + 1, sizeof(char *), reg->patterns);
     os_calloc(count + 1, sizeof(int), reg->flags);
+    os_calloc(count + 1, sizeof(regex_literal), reg->literals);
 
     /* Memory allocation error check */
-    if (!reg->patterns || !reg->flags) {
+    if (!reg->patterns || !reg->flags || !reg->literals) {
         reg->error = OS_REGEX_OUTOFMEMORY;
         goto compile_error;
     }
@@ -241,6 +246,9 @@ int OSRegex_Compile(const char *pattern, OSRegex *reg, int flags)
 
             }
 
+            /* Literal to discard the strings that can't match */
+            _os_regex_literal(reg->patterns[i], &reg->literals[i]);
+
             /* Set the parenthesis closures */
             /* The parenthesis closure if set */
             if (reg->prts_closure) {
@@ -341,3 +349,71 @@ compile_error:
 
     return (0);
 }
+
+/* Get the longest run of plain chars of a sub pattern, that every
+ * matching string must contain.
+ * The last char of the pattern is ignored if it comes right after a
+ * class (\w, \d...): _OS_Regex may accept the string without it.
+ */
+static void _os_regex_literal(const char *pattern, regex_literal *literal)
+{
+    const char *pt;
+    const char *end = pattern + strlen(pattern);
+    const char *run = NULL;
+    const char *best = NULL;
+    size_t best_size = 0;
+    int i;
+
+    memset(literal, 0, sizeof(regex_literal));
+
+    if (end - pattern >= 3 && *(end - 3) == BACKSLASH) {
+        end--;
+    }
+
+    for (pt = pattern; ; pt++) {
+        if (pt < end && *pt != BACKSLASH && !prts(*pt)) {
+            if (!run) {
+                run = pt;
+            }
+            continue;
+        }
+
+        if (run && (size_t)(pt - run) > best_size) {
+            best = run;
+            best_size = (size_t)(pt - run);
+        }
+        run = NULL;
+
+        if (pt >= end) {
+            break;
+        }
+
+        /* Skip the class and its '+' or '*' */
+        if (*pt == BACKSLASH) {
+            pt++;
+            if (isPlus(*(pt + 1))) {
+                pt++;
+            }
+        }
+    }
+
+    if (!best) {
+        return;
+    }
+
+    os_malloc(best_size + 1, literal->str);
+    memcpy(literal->str, best, best_size);
+    literal->str[best_size] = '\0';
+    literal->size = best_size;
+
+    /* The string is compared through charmap: get the chars that can be the first one */
+    for (i = 1; i < 256; i++) {
+        if (charmap[i] == (uchar)*best) {
+            if (literal->first_size == 2) {
+                literal->first_size = -1;
+                break;
+            }
+            literal->first[literal->first_size++] = (uchar)i;
+        }
+    }
+}
@@ -15,9 +15,16 @@
 #include "shared.h"
 #include "os_regex_internal.h"
 
+#ifdef WAZUH_UNIT_TESTING
+#define STATIC
+#else
+#define STATIC static
+#endif
+
 /* Internal prototypes */
-static const char *_OS_Regex(const char *pattern, const char *str, const char **prts_closure,
+STATIC const char *_OS_Regex(const char *pattern, const char *str, const char **prts_closure,
                              const char **prts_str, int flags) __attribute__((nonnull(1, 2)));
+static int _os_regex_literal_in(const OSRegex *reg, int i, const char *str, size_t str_len) __attribute__((nonnull));
 
 
 const char *OSRegex_Execute(const char *str, OSRegex *reg)
@@ -31,6 +38,7 @@ const char *OSRegex_Execute_ex(const char *str, OSRegex *reg, regex_matching *re
     const char ****prts_str;
     regex_dynamic_size *str_sizes;
     const char *ret;
+    size_t str_len;
     int i;
     const bool external_context = (regex_match != NULL) ? true : false;
 
@@ -92,6 +100,8 @@ const char *OSRegex_Execute_ex(const char *str, OSRegex *reg, regex_matching *re
         return (NULL);
     }
 
+    str_len = strlen(str);
+
     if (!external_context) {
         w_mutex_lock((pthread_mutex_t *)&reg->mutex);
     }
@@ -108,7 +118,8 @@ const char *OSRegex_Execute_ex(const char *str, OSRegex *reg, regex_matching *re
             /* Clean the prts_str */
             memset((void*)(*prts_str)[i], 0, (str_sizes) ? str_sizes->prts_str_size[i] : reg->d_size.prts_str_size[i]);
 
-            if ((ret = _OS_Regex(reg->patterns[i], str, reg->prts_closure[i],
+            if (_os_regex_literal_in(reg, i, str, str_len) &&
+                (ret = _OS_Regex(reg->patterns[i], str, reg->prts_closure[i],
                                  (*prts_str)[i], reg->flags[i]))) {
                 j = 0;
 
@@ -157,7 +168,8 @@ const char *OSRegex_Execute_ex(const char *str, OSRegex *reg, regex_matching *re
 
     /* Loop on all sub patterns */
     for (i = 0; reg->patterns[i]; i++) {
-        if ((ret = _OS_Regex(reg->patterns[i], str, NULL, NULL, reg->flags[i]))) {
+        if (_os_regex_literal_in(reg, i, str, str_len) &&
+            (ret = _OS_Regex(reg->patterns[i], str, NULL, NULL, reg->flags[i]))) {
             if (!external_context) {
                 w_mutex_unlock((pthread_mutex_t *)&reg->mutex);
             }
@@ -171,6 +183,67 @@ const char *OSRegex_Execute_ex(const char *str, OSRegex *reg, regex_matching *re
     return (NULL);
 }
 
+/* Check if the string contains the literal of the sub pattern i.
+ * As in _OS_Regex, each char of the string is compared through charmap.
+ * Returns 1 if it does (or the sub pattern has no literal) and 0 otherwise.
+ */
+static int _os_regex_literal_in(const OSRegex *reg, int i, const char *str, size_t str_len)
+{
+    const regex_literal *literal;
+    size_t next[2] = {0, 0};
+    size_t span;
+    size_t pos;
+    size_t j;
+    int k;
+
+    if (!reg->literals || !reg->literals[i].str) {
+        return (1);
+    }
+
+    literal = &reg->literals[i];
+
+    if (literal->size > str_len) {
+        return (0);
+    }
+
+    /* Number of positions where the literal may start */
+    span = str_len - literal->size + 1;
+
+    for (pos = 0; pos < span; pos++) {
+        if (literal->first_size < 0) {
+            if (charmap[(uchar)str[pos]] != (uchar)literal->str[0]) {
+                continue;
+            }
+        } else {
+            /* Jump to the next candidate, looked up with memchr for each possible first char */
+            size_t candidate = span;
+
+            for (k = 0; k < literal->first_size; k++) {
+                if (next[k] < pos || pos == 0) {
+                    const char *found = memchr(str + pos, literal->first[k], span - pos);
+                    next[k] = found ? (size_t)(found - str) : span;
+                }
+                if (next[k] < candidate) {
+                    candidate = next[k];
+                }
+            }
+
+            if (candidate == span) {
+                return (0);
+            }
+            pos = candidate;
+        }
+
+        for (j = 1; j < literal->size && charmap[(uchar)str[pos + j]] == (uchar)literal->str[j]; j++);
+
+        if (j == literal->size) {
+            return (1);
+        }
+    }
+
+    return (0);
+}
+
 #define PRTS(x) ((prts(*x) && x++) || 1)
 #define ENDOFFILE(x) ( PRTS(x) && (*x == '\0'))
 
@@ -179,7 +252,7 @@ const char *OSRegex_Execute_ex(const char *str, OSRegex *reg, regex_matching *re
  * If prts_closure is set, the parenthesis locations will be
  * written on prts_str (which must not be NULL)
  */
-static const char *_OS_Regex(const char *pattern, const char *str, const char **prts_closure,
+STATIC const char *_OS_Regex(const char *pattern, const char *str, const char **prts_closure,
                              const char **prts_str, int flags)
 {
     const char *r_code = str;
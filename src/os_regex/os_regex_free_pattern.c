@@ -20,6 +20,15 @@ void OSRegex_FreePattern(OSRegex *reg)
     if(reg == NULL)
         return;
 
+    /* Free the literals */
+    if (reg->literals) {
+        for (i = 0; reg->patterns && reg->patterns[i]; i++) {
+            os_free(reg->literals[i].str);
+        }
+
+        os_free(reg->literals);
+    }
+
     /* Free the patterns */
     if (reg->patterns) {
         char **pattern = reg->patterns;
@@ -12,15 +12,35 @@
 
 #include "../external/zlib/zlib.h"
 
+/* Each thread keeps its streams, so that every message doesn't allocate
+ * and free the zlib state.
+ */
+static __thread z_stream deflate_stream;
+static __thread int deflate_ready;
+static __thread z_stream inflate_stream;
+static __thread int inflate_ready;
+
 unsigned long int os_zlib_compress(const char *src, char *dst,
                                    unsigned long int src_size,
                                    unsigned long int dst_size)
 {
-    if (compress2((Bytef *)dst,
-                  &dst_size,
-                  (const Bytef *)src,
-                  src_size,
-                  Z_BEST_COMPRESSION) == Z_OK) {
+    if (!deflate_ready) {
+        if (deflateInit(&deflate_stream, Z_BEST_COMPRESSION) != Z_OK) {
+            return (0);
+        }
+
+        deflate_ready = 1;
+    } else if (deflateReset(&deflate_stream) != Z_OK) {
+        return (0);
+    }
+
+    deflate_stream.next_in = (z_const Bytef *)src;
+    deflate_stream.avail_in = (uInt)src_size;
+    deflate_stream.next_out = (Bytef *)dst;
+    deflate_stream.avail_out = (uInt)dst_size;
+
+    if (deflate(&deflate_stream, Z_FINISH) == Z_STREAM_END) {
+        dst_size = deflate_stream.total_out;
         dst[dst_size] = '\0';
         return (dst_size);
     }
@@ -32,10 +52,23 @@ unsigned long int os_zlib_uncompress(const char *src, char *dst,
                                      unsigned long int src_size,
                                      unsigned long int dst_size)
 {
-    if (uncompress((Bytef *)dst,
-                   &dst_size,
-                   (const Bytef *)src,
-                   src_size) == Z_OK) {
+    if (!inflate_ready) {
+        if (inflateInit(&inflate_stream) != Z_OK) {
+            return (0);
+        }
+
+        inflate_ready = 1;
+    } else if (inflateReset(&inflate_stream) != Z_OK) {
+        return (0);
+    }
+
+    inflate_stream.next_in = (z_const Bytef *)src;
+    inflate_stream.avail_in = (uInt)src_size;
+    inflate_stream.next_out = (Bytef *)dst;
+    inflate_stream.avail_out = (uInt)dst_size;
+
+    if (inflate(&inflate_stream, Z_FINISH) == Z_STREAM_END) {
+        dst_size = inflate_stream.total_out;
         dst[dst_size] = '\0';
         return (dst_size);
     }
@@ -23,6 +23,8 @@ unsigned send_chunk;
 unsigned send_buffer_size;
 int send_timeout_to_retry;
 int buffer_relax;
+unsigned udp_batch;
+int keepalive_batch_interval;
 
 /* Read the config file (the remote access) */
 int RemotedConfig(const char *cfgfile, remoted *cfg)
@@ -45,6 +47,8 @@ int RemotedConfig(const char *cfgfile, remoted *cfg)
     buffer_relax = getDefine_Int("remoted", "buffer_relax", 0, 2);
     send_buffer_size = (unsigned)getDefine_Int("remoted", "send_buffer_size", 65536, 1048576);
     send_timeout_to_retry = getDefine_Int("remoted", "send_timeout_to_retry", 1, 60);
+    udp_batch = (unsigned)getDefine_Int("remoted", "udp_batch", 1, 1024);
+    keepalive_batch_interval = getDefine_Int("remoted", "keepalive_batch_interval", 0, 60);
 
     /* Setting default values for global parameters */
     cfg->global.agents_disconnection_time = 600;
@@ -151,6 +155,7 @@ cJSON *getRemoteInternalConfig(void) {
     cJSON_AddNumberToObject(remoted,"recv_timeout",timeout);
     cJSON_AddNumberToObject(remoted,"pass_empty_keyfile",pass_empty_keyfile);
     cJSON_AddNumberToObject(remoted,"sender_pool",sender_pool);
+    cJSON_AddNumberToObject(remoted,"reactor_pool",reactor_pool);
     cJSON_AddNumberToObject(remoted,"request_pool",request_pool);
     cJSON_AddNumberToObject(remoted,"request_rto_sec",rto_sec);
     cJSON_AddNumberToObject(remoted,"request_rto_msec",rto_msec);
@@ -167,6 +172,8 @@ cJSON *getRemoteInternalConfig(void) {
     cJSON_AddNumberToObject(remoted,"buffer_relax",buffer_relax);
     cJSON_AddNumberToObject(remoted,"send_buffer_size",send_buffer_size);
     cJSON_AddNumberToObject(remoted,"send_timeout_to_retry",send_timeout_to_retry);
+    cJSON_AddNumberToObject(remoted,"udp_batch",udp_batch);
+    cJSON_AddNumberToObject(remoted,"keepalive_batch_interval",keepalive_batch_interval);
     cJSON_AddNumberToObject(remoted,"tcp_keepidle",tcp_keepidle);
     cJSON_AddNumberToObject(remoted,"tcp_keepintvl",tcp_keepintvl);
     cJSON_AddNumberToObject(remoted,"tcp_keepcnt",tcp_keepcnt);
@@ -171,6 +171,10 @@ int main(int argc, char **argv)
         OS_PassEmptyKeyfile();
     }
 
+    /* NUMA nodes are resolved before the chroot */
+    reactor_cpus = w_cpuset_load("remoted", "reactor_cpus");
+    worker_cpus = w_cpuset_load("remoted", "worker_cpus");
+
     /* Check if the user and group given are valid */
     uid = Privsep_GetUser(user);
     gid = Privsep_GetGroup(group);
@@ -206,6 +210,8 @@ int main(int argc, char **argv)
 
     os_random();
 
+    w_mem_metrics_init();
+
     /* Start up message */
     mdebug2(STARTUP_MSG, (int)getpid());
 
@@ -109,6 +109,21 @@ STATIC void process_deleted_multi_groups(bool initial_scan);
  */
 STATIC void ftime_add(OSHash **_f_time, const char *name, const time_t m_time);
 
+/**
+ * @brief Get the MD5 of a merged file, only hashing it when its attributes changed
+ * @param merged Path of the merged file
+ * @param md5sum Output MD5
+ * @return 0 on success, -1 on error
+ */
+STATIC int merged_md5(const char *merged, os_md5 md5sum);
+
+/**
+ * @brief Forget the cached MD5 of a merged file
+ * @param sharedcfg_dir Directory of the group
+ * @param group Name of the group directory
+ */
+STATIC void merged_md5_forget(const char *sharedcfg_dir, const char *group);
+
 /**
  * @brief Find a group structure from a file name and md5
  * @param md5 MD5 of the file
@@ -161,15 +176,40 @@ STATIC int lookfor_agent_group(const char *agent_id, char *msg, char **group, in
 STATIC cJSON *assign_group_to_agent_worker(const char *agent_id, const char *md5);
 
 /**
- * @brief Send a shared file to an agent
+ * @brief Send a shared file to an agent, or the delta from the version the agent has
  * @param agent_id ID of the destination agent
  * @param group Name of the group where the file is located
  * @param name Name of the file
  * @param sum MD5 of the file
  * @param sharedcfg_dir Directory where the file is located
+ * @param agent_sum MD5 of the version the agent has, NULL to send the whole file
+ * @param delta Set to true if a delta was sent
  * @return OS_SUCCESS if the file was sent, OS_INVALID otherwise
  */
-static int send_file_toagent(const char *agent_id, const char *group, const char *name, const char *sum, char *sharedcfg_dir);
+static int send_file_toagent(const char *agent_id, const char *group, const char *name, const char *sum, char *sharedcfg_dir,
+                             const char *agent_sum, bool *delta);
+
+/**
+ * @brief Keep a version of a merged file that is about to be replaced, dropping the oldest ones
+ * @param sharedcfg_dir Directory of the group
+ * @param group Name of the group directory
+ * @param merged Path of the merged file
+ * @param md5sum MD5 of the merged file
+ */
+STATIC void shared_history_save(const char *sharedcfg_dir, const char *group, const char *merged, const os_md5 md5sum);
+
+/**
+ * @brief Get the delta from a previous version of a merged file to the current one
+ * @param sharedcfg_dir Directory of the group
+ * @param group Name of the group directory
+ * @param merged Path of the merged file
+ * @param base_sum MD5 of the previous version
+ * @param target_sum MD5 of the current version
+ * @param size Size of the delta
+ * @return Copy of the delta, NULL if the previous version isn't kept or the delta isn't much smaller than the file
+ */
+STATIC char *shared_delta_get(const char *sharedcfg_dir, const char *group, const char *merged,
+                              const char *base_sum, const char *target_sum, size_t *size);
 
 /**
  * @brief Validate files to be shared with agents, update invalid file hash table
@@ -201,10 +241,39 @@ STATIC void copy_directory(const char *src_path, const char *dst_path, char *gro
  */
 STATIC void send_wrong_version_response(const char *agent_id, char *msg, agent_status_code_t status_code, char *version, int *wdb_sock);
 
+/**
+ * @brief Add an agent to the next batch of keepalives
+ * @param agent_id ID of the agent
+ */
+STATIC void keepalive_batch_push(int agent_id);
+
+/**
+ * @brief Remove an agent from the next batch of keepalives, before changing its status
+ * @param agent_id ID of the agent
+ */
+STATIC void keepalive_batch_discard(int agent_id);
+
+/**
+ * @brief Save the batched keepalives in Wazuh DB
+ * @param wdb_sock Wazuh-DB socket
+ */
+STATIC void keepalive_batch_flush(int *wdb_sock);
+
 /* Groups structures */
 static OSHash *groups;
 static OSHash *multi_groups;
 
+/* Cached MD5 of the merged files, with the attributes they were hashed with */
+typedef struct merged_sum_t {
+    time_t m_time;
+    time_t c_time;
+    off_t size;
+    ino_t inode;
+    os_md5 md5;
+} merged_sum_t;
+
+STATIC OSHash *merged_sums;
+
 static time_t _stime;
 int INTERVAL;
 
@@ -225,9 +294,35 @@ OSHash *m_hash;
 /* Interval polling */
 static int poll_interval_time = 0;
 
+/* Agents whose keepalive is saved by the next batch */
+static int *keepalive_batch;
+static size_t keepalive_batch_size;
+static size_t keepalive_batch_max;
+/* Indexed by agent ID, set while the agent is in the batch */
+static unsigned char *keepalive_queued;
+static size_t keepalive_queued_size;
+static pthread_mutex_t keepalive_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* This variable is used to prevent flooding when group files exceed the maximum size */
 static int reported_path_size_exceeded = 0;
 
+/* Versions of each merged file kept to send deltas, 0 to always send the whole file */
+static int shared_history;
+
+/* Largest merged file a delta is built for */
+#define SHARED_DELTA_MAX_FILE (256 * 1024 * 1024)
+
+/* Delta from a previous version of a merged file to the current one, data is NULL if it isn't worth it */
+typedef struct shared_delta_t {
+    os_md5 target;
+    char *data;
+    size_t size;
+} shared_delta_t;
+
+/* Deltas keyed by "<history directory>/<previous version MD5>" */
+static OSHash *shared_deltas;
+static pthread_mutex_t shared_deltas_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 // Frees data in m_hash table
 void cleaner(void* data) {
     os_free(data);
@@ -361,10 +456,14 @@ void save_controlmsg(const keyentry * key, char *r_msg, size_t msg_length, int *
 
         agent_id = atoi(key->id);
 
-        result = wdb_update_agent_keepalive(agent_id, AGENT_CS_ACTIVE, logr.worker_node ? "syncreq" : "synced", wdb_sock);
+        if (keepalive_batch_interval > 0) {
+            keepalive_batch_push(agent_id);
+        } else {
+            result = wdb_update_agent_keepalive(agent_id, AGENT_CS_ACTIVE, logr.worker_node ? "syncreq" : "synced", wdb_sock);
 
-        if (OS_SUCCESS != result) {
-            mwarn("Unable to save last keepalive and set connection status as active for agent: %s", key->id);
+            if (OS_SUCCESS != result) {
+                mwarn("Unable to save last keepalive and set connection status as active for agent: %s", key->id);
+            }
         }
     } else {
         if (!data) {
@@ -384,6 +483,10 @@ void save_controlmsg(const keyentry * key, char *r_msg, size_t msg_length, int *
 
             agent_id = atoi(key->id);
 
+            if (keepalive_batch_interval > 0) {
+                keepalive_batch_discard(agent_id);
+            }
+
             result = wdb_update_agent_keepalive(agent_id, AGENT_CS_PENDING, logr.worker_node ? "syncreq" : "synced", wdb_sock);
 
             if (OS_SUCCESS != result) {
@@ -394,6 +497,10 @@ void save_controlmsg(const keyentry * key, char *r_msg, size_t msg_length, int *
 
             agent_id = atoi(key->id);
 
+            if (keepalive_batch_interval > 0) {
+                keepalive_batch_discard(agent_id);
+            }
+
             result = wdb_update_agent_connection_status(agent_id, AGENT_CS_DISCONNECTED, logr.worker_node ? "syncreq" : "synced", wdb_sock, HC_SHUTDOWN_RECV);
 
             if (OS_SUCCESS != result) {
@@ -499,8 +606,15 @@ void save_controlmsg(const keyentry * key, char *r_msg, size_t msg_length, int *
             os_strdup(AGENT_CS_ACTIVE, agent_data->connection_status);
             os_strdup(logr.worker_node ? "syncreq" : "synced", agent_data->sync_status);
 
+            /* Older agents don't understand deltas, they always get the whole file */
+            const char *agent_version = agent_data->version ? strchr(agent_data->version, 'v') : NULL;
+            bool patchable = agent_data->merged_sum && agent_version
+                             && compare_wazuh_versions(agent_version, SHARED_DELTA_VERSION, true) >= 0;
+
             w_mutex_lock(&lastmsg_mutex);
 
+            snprintf(data->agent_sum, sizeof(os_md5), "%s", patchable ? agent_data->merged_sum : "");
+
             if (data->merged_sum[0] && (!agent_data->merged_sum || (strcmp(data->merged_sum, agent_data->merged_sum) != 0))) {
                 /* Mark data as changed and insert into queue */
                 if (!data->changed) {
@@ -739,7 +853,13 @@ STATIC void c_group(const char *group, OSHash **_f_time, os_md5 *_merged_sum, ch
                 }
             }
 
-            if ((OS_MD5_File(merged, md5sum, OS_TEXT) != 0) || (strcmp(md5sum_tmp, md5sum) != 0)) {
+            int merged_found = merged_md5(merged, md5sum) == 0;
+
+            if (!merged_found || (strcmp(md5sum_tmp, md5sum) != 0)) {
+                if (merged_found) {
+                    shared_history_save(sharedcfg_dir, group, merged, md5sum);
+                }
+
                 if (disk_storage) {
                     OS_MoveFile(merged_tmp, merged);
                 } else {
@@ -762,7 +882,7 @@ STATIC void c_group(const char *group, OSHash **_f_time, os_md5 *_merged_sum, ch
         }
     }
 
-    if (OS_MD5_File(merged, md5sum, OS_TEXT) == 0) {
+    if (merged_md5(merged, md5sum) == 0) {
         snprintf((*_merged_sum), sizeof((*_merged_sum)), "%s", md5sum);
 
         if (stat(merged, &attrib) != 0) {
@@ -1069,6 +1189,7 @@ STATIC void process_deleted_groups() {
             group->has_changed = false;
             group->exists = false;
         } else {
+            merged_md5_forget(SHAREDCFG_DIR, key);
             OSHash_Delete_ex(groups, key);
             OSHash_Clean(group->f_time, free_file_time);
             os_free(group->name);
@@ -1123,6 +1244,8 @@ STATIC void process_deleted_multi_groups(bool initial_scan) {
             OS_SHA256_String(multigroup->name, multi_group_hash);
             snprintf(multi_path, PATH_MAX,"%s/%.8s", MULTIGROUPS_DIR, multi_group_hash);
             rmdir_ex(multi_path);
+            snprintf(multi_path, PATH_MAX, "%.8s", multi_group_hash);
+            merged_md5_forget(MULTIGROUPS_DIR, multi_path);
             OSHash_Delete_ex(multi_groups, key);
             OSHash_Clean(multigroup->f_time, free_file_time);
             os_free(multigroup->name);
@@ -1334,6 +1457,63 @@ STATIC void copy_directory(const char *src_path, const char *dst_path, char *gro
     return;
 }
 
+STATIC int merged_md5(const char *merged, os_md5 md5sum) {
+    struct stat attrib;
+    merged_sum_t *cached;
+
+    if (!merged_sums) {
+        return OS_MD5_File(merged, md5sum, OS_TEXT);
+    }
+
+    if (stat(merged, &attrib) != 0) {
+        return -1;
+    }
+
+    cached = OSHash_Get_ex(merged_sums, merged);
+
+    if (cached && cached->m_time == attrib.st_mtime && cached->c_time == attrib.st_ctime &&
+        cached->size == attrib.st_size && cached->inode == attrib.st_ino) {
+        snprintf(md5sum, sizeof(os_md5), "%s", cached->md5);
+        return 0;
+    }
+
+    if (OS_MD5_File(merged, md5sum, OS_TEXT) != 0) {
+        return -1;
+    }
+
+    if (!cached) {
+        os_calloc(1, sizeof(merged_sum_t), cached);
+
+        if (OSHash_Add_ex(merged_sums, merged, cached) != 2) {
+            os_free(cached);
+            return 0;
+        }
+    }
+
+    cached->m_time = attrib.st_mtime;
+    cached->c_time = attrib.st_ctime;
+    cached->size = attrib.st_size;
+    cached->inode = attrib.st_ino;
+    snprintf(cached->md5, sizeof(os_md5), "%s", md5sum);
+
+    return 0;
+}
+
+STATIC void merged_md5_forget(const char *sharedcfg_dir, const char *group) {
+    char merged[PATH_MAX + 1];
+    merged_sum_t *cached;
+
+    if (!merged_sums) {
+        return;
+    }
+
+    snprintf(merged, PATH_MAX + 1, "%s/%s/%s", sharedcfg_dir, group, SHAREDCFG_FILENAME);
+
+    if (cached = OSHash_Delete_ex(merged_sums, merged), cached) {
+        os_free(cached);
+    }
+}
+
 STATIC void ftime_add(OSHash **_f_time, const char *name, const time_t m_time) {
     file_time *file = NULL;
     os_calloc(1, sizeof(file_time), file);
@@ -1566,40 +1746,202 @@ STATIC int lookfor_agent_group(const char *agent_id, char *msg, char **r_group,
     return OS_INVALID;
 }
 
+/* Keep a version of a merged file that is about to be replaced */
+STATIC void shared_history_save(const char *sharedcfg_dir, const char *group, const char *merged, const os_md5 md5sum) {
+    char history_dir[PATH_MAX + 1];
+    char path[PATH_MAX + 1];
+    const char *dir_name;
+    char **files;
+    int count;
+
+    if (shared_history <= 0) {
+        return;
+    }
+
+    dir_name = strrchr(sharedcfg_dir, '/');
+    snprintf(history_dir, sizeof(history_dir), "%s/%s/%s", SHAREDCFG_HISTORY_DIR, dir_name ? dir_name + 1 : sharedcfg_dir, group);
+    snprintf(path, sizeof(path), "%s/%s", history_dir, md5sum);
+
+    if (mkdir_ex(history_dir) != 0 || w_copy_file(merged, path, 'w', NULL, 1) != 0) {
+        mdebug1("Unable to keep the previous version of '%s'.", merged);
+        return;
+    }
+
+    if (files = wreaddir(history_dir), !files) {
+        return;
+    }
+
+    for (count = 0; files[count]; count++);
+
+    /* Drop the oldest versions, and their deltas */
+    for (; count > shared_history; count--) {
+        time_t oldest_time = 0;
+        int oldest = -1;
+        struct stat attrib;
+
+        for (int i = 0; files[i]; i++) {
+            snprintf(path, sizeof(path), "%s/%s", history_dir, files[i]);
+
+            if (files[i][0] && stat(path, &attrib) == 0 && (oldest < 0 || attrib.st_mtime < oldest_time)) {
+                oldest = i;
+                oldest_time = attrib.st_mtime;
+            }
+        }
+
+        if (oldest < 0) {
+            break;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s", history_dir, files[oldest]);
+        unlink(path);
+
+        w_mutex_lock(&shared_deltas_mutex);
+        shared_delta_t *delta = OSHash_Delete_ex(shared_deltas, path);
+        w_mutex_unlock(&shared_deltas_mutex);
+
+        if (delta) {
+            os_free(delta->data);
+            os_free(delta);
+        }
+
+        files[oldest][0] = '\0';
+    }
+
+    free_strarray(files);
+}
+
+/* Get the delta from a previous version of a merged file to the current one */
+STATIC char *shared_delta_get(const char *sharedcfg_dir, const char *group, const char *merged,
+                              const char *base_sum, const char *target_sum, size_t *size) {
+    char base_path[PATH_MAX + 1];
+    const char *dir_name;
+    shared_delta_t *delta;
+    char *base = NULL;
+    char *target = NULL;
+    char *data = NULL;
+    os_md5 md5sum;
+
+    /* The sum comes from the agent, it becomes a file name */
+    if (shared_history <= 0 || strlen(base_sum) != 32 || strspn(base_sum, "0123456789abcdef") != 32 || strcmp(base_sum, target_sum) == 0) {
+        return NULL;
+    }
+
+    dir_name = strrchr(sharedcfg_dir, '/');
+    snprintf(base_path, sizeof(base_path), "%s/%s/%s/%s", SHAREDCFG_HISTORY_DIR, dir_name ? dir_name + 1 : sharedcfg_dir, group, base_sum);
+
+    w_mutex_lock(&shared_deltas_mutex);
+
+    if (delta = OSHash_Get_ex(shared_deltas, base_path), !delta || strcmp(delta->target, target_sum) != 0) {
+        if (base = w_get_file_content(base_path, SHARED_DELTA_MAX_FILE), !base) {
+            w_mutex_unlock(&shared_deltas_mutex);
+            return NULL;
+        }
+
+        if (target = w_get_file_content(merged, SHARED_DELTA_MAX_FILE), !target) {
+            w_mutex_unlock(&shared_deltas_mutex);
+            os_free(base);
+            return NULL;
+        }
+
+        size_t target_size = strlen(target);
+
+        /* The file may have changed since it was hashed */
+        OS_MD5_Str(target, target_size, md5sum);
+
+        if (strcmp(md5sum, target_sum) != 0) {
+            w_mutex_unlock(&shared_deltas_mutex);
+            os_free(base);
+            os_free(target);
+            return NULL;
+        }
+
+        if (!delta) {
+            os_calloc(1, sizeof(shared_delta_t), delta);
+
+            if (OSHash_Add_ex(shared_deltas, base_path, delta) != 2) {
+                w_mutex_unlock(&shared_deltas_mutex);
+                os_free(delta);
+                os_free(base);
+                os_free(target);
+                return NULL;
+            }
+        }
+
+        os_free(delta->data);
+        snprintf(delta->target, sizeof(os_md5), "%s", target_sum);
+        delta->data = w_delta_create(base, strlen(base), target, target_size, &delta->size);
+
+        /* Agents are better off with the whole file unless the delta is much smaller */
+        if (delta->size > target_size / 2) {
+            os_free(delta->data);
+        }
+
+        mdebug2("Delta of '%s' from version '%s': %zu bytes out of %zu.", merged, base_sum, delta->data ? delta->size : target_size, target_size);
+
+        os_free(base);
+        os_free(target);
+    }
+
+    if (delta->data) {
+        os_malloc(delta->size + 1, data);
+        memcpy(data, delta->data, delta->size + 1);
+        *size = delta->size;
+    }
+
+    w_mutex_unlock(&shared_deltas_mutex);
+
+    return data;
+}
+
 /* Send a file to the agent
  * Returns -1 on error
  */
-static int send_file_toagent(const char *agent_id, const char *group, const char *name, const char *sum, char *sharedcfg_dir)
+static int send_file_toagent(const char *agent_id, const char *group, const char *name, const char *sum, char *sharedcfg_dir,
+                             const char *agent_sum, bool *delta)
 {
     int i = 0;
     size_t n = 0;
+    char group_dir[OS_SIZE_256];
     char file[OS_SIZE_1024 + 1];
     char buf[OS_SIZE_1024 + 1];
-    FILE *fp;
+    FILE *fp = NULL;
+    char *patch = NULL;
+    size_t patch_size = 0;
+    size_t patch_offset = 0;
     os_sha256 multi_group_hash;
     int protocol = -1; // Agent client net protocol
 
+    *delta = false;
+
     /* Check if it is multigroup */
     if (strchr(group, MULTIGROUP_SEPARATOR)) {
         OS_SHA256_String(group, multi_group_hash);
-        snprintf(file, OS_SIZE_1024, "%s/%.8s/%s", sharedcfg_dir, multi_group_hash, name);
+        snprintf(group_dir, sizeof(group_dir), "%.8s", multi_group_hash);
     } else {
-        snprintf(file, OS_SIZE_1024, "%s/%s/%s", sharedcfg_dir, group, name);
+        snprintf(group_dir, sizeof(group_dir), "%s", group);
     }
 
-    fp = fopen(file, "r");
-    if (!fp) {
-        mdebug1(FOPEN_ERROR, file, errno, strerror(errno));
-        return OS_INVALID;
-    }
+    snprintf(file, OS_SIZE_1024, "%s/%s/%s", sharedcfg_dir, group_dir, name);
 
-    /* Send the file name first */
-    snprintf(buf, OS_SIZE_1024, "%s%s%s %s\n",
-             CONTROL_HEADER, FILE_UPDATE_HEADER, sum, name);
+    if (agent_sum && (patch = shared_delta_get(sharedcfg_dir, group_dir, file, agent_sum, sum, &patch_size), patch)) {
+        /* Send the delta and the version it applies to */
+        snprintf(buf, OS_SIZE_1024, "%s%s%s %s %s\n",
+                 CONTROL_HEADER, FILE_PATCH_HEADER, sum, agent_sum, name);
+        *delta = true;
+    } else {
+        fp = fopen(file, "r");
+        if (!fp) {
+            mdebug1(FOPEN_ERROR, file, errno, strerror(errno));
+            return OS_INVALID;
+        }
+
+        /* Send the file name first */
+        snprintf(buf, OS_SIZE_1024, "%s%s%s %s\n",
+                 CONTROL_HEADER, FILE_UPDATE_HEADER, sum, name);
+    }
 
     if (send_msg(agent_id, buf, -1) < 0) {
-        fclose(fp);
-        return OS_INVALID;
+        goto error;
     } else {
         rem_inc_send_shared(agent_id);
     }
@@ -1610,16 +1952,27 @@ static int send_file_toagent(const char *agent_id, const char *group, const char
     key_unlock();
     if (protocol < 0) {
         merror(AR_NOAGENT_ERROR, agent_id);
-        return OS_INVALID;
+        goto error;
     }
 
     /* Send the file contents */
-    while ((n = fread(buf, 1, 900, fp)) > 0) {
+    while (1) {
+        if (patch) {
+            n = patch_size - patch_offset < 900 ? patch_size - patch_offset : 900;
+            memcpy(buf, patch + patch_offset, n);
+            patch_offset += n;
+        } else {
+            n = fread(buf, 1, 900, fp);
+        }
+
+        if (n == 0) {
+            break;
+        }
+
         buf[n] = '\0';
 
         if (send_msg(agent_id, buf, -1) < 0) {
-            fclose(fp);
-            return OS_INVALID;
+            goto error;
         } else {
             rem_inc_send_shared(agent_id);
         }
@@ -1638,15 +1991,25 @@ static int send_file_toagent(const char *agent_id, const char *group, const char
     snprintf(buf, OS_SIZE_1024, "%s%s", CONTROL_HEADER, FILE_CLOSE_HEADER);
 
     if (send_msg(agent_id, buf, -1) < 0) {
-        fclose(fp);
-        return OS_INVALID;
+        goto error;
     } else {
         rem_inc_send_shared(agent_id);
     }
 
-    fclose(fp);
+    if (fp) {
+        fclose(fp);
+    }
+    os_free(patch);
 
     return OS_SUCCESS;
+
+error:
+    if (fp) {
+        fclose(fp);
+    }
+    os_free(patch);
+
+    return OS_INVALID;
 }
 
 /* Wait for new messages to read */
@@ -1658,8 +2021,11 @@ void *wait_for_msgs(__attribute__((unused)) void *none)
     while (1) {
         char *group = NULL;
         os_md5 merged_sum;
+        os_md5 agent_sum;
+        bool delta = false;
 
         memset(&merged_sum, 0, sizeof(os_md5));
+        memset(&agent_sum, 0, sizeof(os_md5));
 
         /* Pop data from queue */
         char *agent_id = linked_queue_pop_ex(pending_queue);
@@ -1669,6 +2035,11 @@ void *wait_for_msgs(__attribute__((unused)) void *none)
         if (data = OSHash_Get(pending_data, agent_id), data) {
             w_strdup(data->group, group);
             memcpy(merged_sum, data->merged_sum, sizeof(os_md5));
+
+            /* A delta is sent once per version of the agent: if it still has it, the delta didn't work */
+            if (strcmp(data->agent_sum, data->delta_base) != 0) {
+                memcpy(agent_sum, data->agent_sum, sizeof(os_md5));
+            }
         } else {
             merror("Couldn't get pending data from hash table for agent ID '%s'.", agent_id);
             os_free(agent_id);
@@ -1690,7 +2061,7 @@ void *wait_for_msgs(__attribute__((unused)) void *none)
                 strcpy(sharedcfg_dir, SHAREDCFG_DIR);
             }
 
-            if (send_file_toagent(agent_id, group, SHAREDCFG_FILENAME, merged_sum, sharedcfg_dir) < 0) {
+            if (send_file_toagent(agent_id, group, SHAREDCFG_FILENAME, merged_sum, sharedcfg_dir, agent_sum[0] ? agent_sum : NULL, &delta) < 0) {
                 mwarn(SHARED_ERROR, SHAREDCFG_FILENAME, agent_id);
             }
 
@@ -1704,6 +2075,10 @@ void *wait_for_msgs(__attribute__((unused)) void *none)
 
         if (data) {
             data->changed = 0;
+
+            if (delta) {
+                memcpy(data->delta_base, agent_sum, sizeof(os_md5));
+            }
         }
 
         w_mutex_unlock(&lastmsg_mutex);
@@ -1743,6 +2118,95 @@ void *update_shared_files(__attribute__((unused)) void *none)
     return NULL;
 }
 
+STATIC void keepalive_batch_push(int agent_id) {
+    if (agent_id < 0) {
+        return;
+    }
+
+    w_mutex_lock(&keepalive_mutex);
+
+    if ((size_t)agent_id >= keepalive_queued_size) {
+        size_t size = keepalive_queued_size ? keepalive_queued_size : 1024;
+
+        while (size <= (size_t)agent_id) {
+            size *= 2;
+        }
+
+        os_realloc(keepalive_queued, size, keepalive_queued);
+        memset(keepalive_queued + keepalive_queued_size, 0, size - keepalive_queued_size);
+        keepalive_queued_size = size;
+    }
+
+    // Several keepalives of an agent in the same interval are saved once
+    if (keepalive_queued[agent_id]) {
+        w_mutex_unlock(&keepalive_mutex);
+        return;
+    }
+
+    keepalive_queued[agent_id] = 1;
+
+    if (keepalive_batch_size == keepalive_batch_max) {
+        keepalive_batch_max = keepalive_batch_max ? keepalive_batch_max * 2 : 1024;
+        os_realloc(keepalive_batch, keepalive_batch_max * sizeof(int), keepalive_batch);
+    }
+
+    keepalive_batch[keepalive_batch_size++] = agent_id;
+    w_mutex_unlock(&keepalive_mutex);
+}
+
+STATIC void keepalive_batch_discard(int agent_id) {
+    size_t j = 0;
+
+    w_mutex_lock(&keepalive_mutex);
+
+    if (agent_id < 0 || (size_t)agent_id >= keepalive_queued_size || !keepalive_queued[agent_id]) {
+        w_mutex_unlock(&keepalive_mutex);
+        return;
+    }
+
+    keepalive_queued[agent_id] = 0;
+
+    for (size_t i = 0; i < keepalive_batch_size; i++) {
+        if (keepalive_batch[i] != agent_id) {
+            keepalive_batch[j++] = keepalive_batch[i];
+        }
+    }
+
+    keepalive_batch_size = j;
+    w_mutex_unlock(&keepalive_mutex);
+}
+
+STATIC void keepalive_batch_flush(int *wdb_sock) {
+    // The batch is sent with the lock held, so that a later status change is not overwritten
+    w_mutex_lock(&keepalive_mutex);
+
+    if (keepalive_batch_size > 0) {
+        if (OS_SUCCESS != wdb_update_agents_keepalive(keepalive_batch, keepalive_batch_size, AGENT_CS_ACTIVE, logr.worker_node ? "syncreq" : "synced", wdb_sock)) {
+            mwarn("Unable to save last keepalive and set connection status as active for %zu agents.", keepalive_batch_size);
+        }
+
+        for (size_t i = 0; i < keepalive_batch_size; i++) {
+            keepalive_queued[keepalive_batch[i]] = 0;
+        }
+
+        keepalive_batch_size = 0;
+    }
+
+    w_mutex_unlock(&keepalive_mutex);
+}
+
+void *keepalive_batch_main(__attribute__((unused)) void *none)
+{
+    int wdb_sock = -1;
+
+    while (1) {
+        sleep(keepalive_batch_interval);
+        keepalive_batch_flush(&wdb_sock);
+    }
+
+    return NULL;
+}
+
 void free_pending_data(pending_data_t *data) {
     if (!data) return;
     os_free(data->message);
@@ -1761,8 +2225,11 @@ void manager_init()
 
     groups = OSHash_Create();
     multi_groups = OSHash_Create();
+    merged_sums = OSHash_Create();
 
     disk_storage = getDefine_Int("remoted", "disk_storage", 0, 1);
+    shared_history = getDefine_Int("remoted", "shared_history", 0, 64);
+    shared_deltas = OSHash_Create();
 
     /* Run initial groups and multigroups scan */
     c_files(true);
@@ -1772,7 +2239,7 @@ void manager_init()
     pending_queue = linked_queue_init();
     pending_data = OSHash_Create();
 
-    if (!m_hash || !invalid_files || !groups || !multi_groups || !pending_data) {
+    if (!m_hash || !invalid_files || !groups || !multi_groups || !merged_sums || !pending_data || !shared_deltas) {
         merror_exit("OSHash_Create() failed");
     }
 
@@ -15,12 +15,8 @@
 #include "remoted.h"
 #include "state.h"
 
-extern wnotify_t * notify;
-
-static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-
 void nb_open(netbuffer_t * buffer, int sock, const struct sockaddr_storage * peer_info) {
-    w_mutex_lock(&mutex);
+    w_mutex_lock(&buffer->mutex);
 
     if (sock >= buffer->max_fd) {
         os_realloc(buffer->buffers, sizeof(sockbuffer_t) * (sock + 1), buffer->buffers);
@@ -32,12 +28,12 @@ void nb_open(netbuffer_t * buffer, int sock, const struct sockaddr_storage * pee
 
     buffer->buffers[sock].bqueue = bqueue_init(send_buffer_size, BQUEUE_SHRINK);
 
-    w_mutex_unlock(&mutex);
+    w_mutex_unlock(&buffer->mutex);
 }
 
 void nb_close(netbuffer_t * buffer, int sock) {
 
-    w_mutex_lock(&mutex);
+    w_mutex_lock(&buffer->mutex);
 
     if (buffer->buffers[sock].bqueue) {
         bqueue_destroy(buffer->buffers[sock].bqueue);
@@ -46,7 +42,7 @@ void nb_close(netbuffer_t * buffer, int sock) {
     os_free(buffer->buffers[sock].data);
     memset(buffer->buffers + sock, 0, sizeof(sockbuffer_t));
 
-    w_mutex_unlock(&mutex);
+    w_mutex_unlock(&buffer->mutex);
 }
 
 /*
@@ -62,7 +58,7 @@ int nb_recv(netbuffer_t * buffer, int sock) {
     unsigned long cur_offset;
     uint32_t cur_len;
 
-    w_mutex_lock(&mutex);
+    w_mutex_lock(&buffer->mutex);
 
     sockbuffer_t * sockbuf = &buffer->buffers[sock];
     unsigned long data_ext = sockbuf->data_len + receive_chunk;
@@ -107,7 +103,7 @@ int nb_recv(netbuffer_t * buffer, int sock) {
 
     if (i > 0) {
         if (i < sockbuf->data_len) {
-            memcpy(sockbuf->data, sockbuf->data + i, sockbuf->data_len - i);
+            memmove(sockbuf->data, sockbuf->data + i, sockbuf->data_len - i);
         }
 
         sockbuf->data_len -= i;
@@ -137,24 +133,25 @@ int nb_recv(netbuffer_t * buffer, int sock) {
 
 end:
 
-    w_mutex_unlock(&mutex);
+    w_mutex_unlock(&buffer->mutex);
     return recv_len;
 }
 
 int nb_send(netbuffer_t * buffer, int socket) {
     ssize_t sent_bytes = 0;
+    struct iovec iov[2];
 
-    char data[send_chunk];
-    memset(data, 0, send_chunk);
-
-    w_mutex_lock(&mutex);
+    w_mutex_lock(&buffer->mutex);
 
     if (buffer->buffers[socket].bqueue) {
 
-        ssize_t peeked_bytes = bqueue_peek(buffer->buffers[socket].bqueue, data, send_chunk, BQUEUE_NOFLAG);
+        // The queue is only modified while holding the buffer lock, so its memory is sent in place
+        ssize_t peeked_bytes = bqueue_peekv(buffer->buffers[socket].bqueue, iov, send_chunk);
         if (peeked_bytes > 0) {
+            struct msghdr msg = { .msg_iov = iov, .msg_iovlen = iov[1].iov_len > 0 ? 2 : 1 };
+
             // Asynchronous sending
-            sent_bytes = send(socket, (const void *)data, peeked_bytes, MSG_DONTWAIT);
+            sent_bytes = sendmsg(socket, &msg, MSG_DONTWAIT);
         }
 
         if (sent_bytes > 0) {
@@ -172,11 +169,11 @@ int nb_send(netbuffer_t * buffer, int socket) {
         }
 
         if (!peeked_bytes || bqueue_used(buffer->buffers[socket].bqueue) == 0) {
-            wnotify_modify(notify, socket, WO_READ);
+            wnotify_modify(buffer->notify, socket, WO_READ);
         }
     }
 
-    w_mutex_unlock(&mutex);
+    w_mutex_unlock(&buffer->mutex);
 
     return sent_bytes;
 }
@@ -184,37 +181,38 @@ int nb_send(netbuffer_t * buffer, int socket) {
 int nb_queue(netbuffer_t * buffer, int socket, char * crypt_msg, ssize_t msg_size, char * agent_id) {
     int retval = -1;
     int header_size = sizeof(uint32_t);
-    char data[msg_size + header_size];
     const uint32_t bytes = wnet_order(msg_size);
 
-    memcpy((data + header_size), crypt_msg, msg_size);
     // Add header at begining, first 4 bytes, it is message msg_size
-    memcpy(data, &bytes, header_size);
+    const struct iovec data[2] = {
+        { .iov_base = (void *)&bytes, .iov_len = header_size },
+        { .iov_base = crypt_msg, .iov_len = msg_size }
+    };
 
-    w_mutex_lock(&mutex);
+    w_mutex_lock(&buffer->mutex);
 
     if (buffer->buffers[socket].bqueue) {
 
-        if (!bqueue_push(buffer->buffers[socket].bqueue, (const void *) data, (size_t)(msg_size + header_size), BQUEUE_NOFLAG)) {
+        if (!bqueue_pushv(buffer->buffers[socket].bqueue, data, 2, BQUEUE_NOFLAG)) {
 
             if (bqueue_used(buffer->buffers[socket].bqueue) == (size_t)(msg_size + header_size)) {
-                wnotify_modify(notify, socket, (WO_READ | WO_WRITE));
+                wnotify_modify(buffer->notify, socket, (WO_READ | WO_WRITE));
             }
             retval = 0;
         } else {
             mdebug1("Not enough buffer space. Retrying... [buffer_size=%lu, used=%lu, msg_size=%lu]",
                 buffer->buffers[socket].bqueue->max_length, buffer->buffers[socket].bqueue->length, msg_size);
 
-            w_mutex_unlock(&mutex);
+            w_mutex_unlock(&buffer->mutex);
             sleep(send_timeout_to_retry);
-            w_mutex_lock(&mutex);
+            w_mutex_lock(&buffer->mutex);
 
             if (buffer->buffers[socket].bqueue) {
 
-                if (!bqueue_push(buffer->buffers[socket].bqueue, (const void *) data, (size_t)(msg_size + header_size), BQUEUE_NOFLAG)) {
+                if (!bqueue_pushv(buffer->buffers[socket].bqueue, data, 2, BQUEUE_NOFLAG)) {
 
                     if (bqueue_used(buffer->buffers[socket].bqueue) == (size_t)(msg_size + header_size)) {
-                        wnotify_modify(notify, socket, (WO_READ | WO_WRITE));
+                        wnotify_modify(buffer->notify, socket, (WO_READ | WO_WRITE));
                     }
                     retval = 0;
                 }
@@ -222,7 +220,7 @@ int nb_queue(netbuffer_t * buffer, int socket, char * crypt_msg, ssize_t msg_siz
         }
     }
 
-    w_mutex_unlock(&mutex);
+    w_mutex_unlock(&buffer->mutex);
 
     if (retval < 0) {
         rem_inc_send_discarded(agent_id);
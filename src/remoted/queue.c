@@ -15,6 +15,18 @@
 static w_queue_t * queue;
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t available = PTHREAD_COND_INITIALIZER;
+static int reported = 0;
+
+// Free a message that didn't fit in the queue
+static void rem_msgdiscard(message_t * message) {
+    rem_msgfree(message);
+    mdebug2("Discarding event from host.");
+    rem_inc_recv_discarded();
+    if (!reported) {
+        mwarn("Message queue is full (%zu). Events may be lost.", queue->size);
+        reported = 1;
+    }
+}
 
 
 // Init message queue
@@ -26,7 +38,6 @@ void rem_msginit(size_t size) {
 int rem_msgpush(const char * buffer, unsigned long size, struct sockaddr_storage * addr, int sock) {
     message_t * message;
     int result;
-    static int reported = 0;
 
     os_malloc(sizeof(message_t), message);
     os_malloc(size, message->buffer);
@@ -34,6 +45,7 @@ int rem_msgpush(const char * buffer, unsigned long size, struct sockaddr_storage
     message->size = size;
     memcpy(&message->addr, addr, sizeof(struct sockaddr_storage));
     message->sock = sock;
+    clock_gettime(CLOCK_MONOTONIC, &message->queued);
 
     w_mutex_lock(&mutex);
 
@@ -46,18 +58,46 @@ int rem_msgpush(const char * buffer, unsigned long size, struct sockaddr_storage
     w_mutex_unlock(&mutex);
 
     if (result < 0) {
-        rem_msgfree(message);
-        mdebug2("Discarding event from host.");
-        rem_inc_recv_discarded();
-        if (!reported) {
-            mwarn("Message queue is full (%zu). Events may be lost.", queue->size);
-            reported = 1;
-        }
+        rem_msgdiscard(message);
     }
 
     return result;
 }
 
+// Push a batch of messages into queue
+size_t rem_msgpush_batch(message_t ** messages, size_t count) {
+    struct timespec now;
+    size_t queued = 0;
+    size_t i;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    w_mutex_lock(&mutex);
+
+    for (i = 0; i < count; i++) {
+        messages[i]->counter = ++global_counter;
+        messages[i]->queued = now;
+
+        if (queue_push(queue, messages[i]) < 0) {
+            break;
+        }
+    }
+
+    queued = i;
+
+    if (queued > 0) {
+        w_cond_broadcast(&available);
+    }
+
+    w_mutex_unlock(&mutex);
+
+    for (i = queued; i < count; i++) {
+        rem_msgdiscard(messages[i]);
+    }
+
+    return queued;
+}
+
 // Get current queue size
 size_t rem_get_qsize() {
     size_t size = 0;
@@ -89,6 +129,8 @@ message_t * rem_msgpop() {
     }
 
     w_mutex_unlock(&mutex);
+
+    rem_latency_since(REM_STAGE_QUEUE, &message->queued);
     return message;
 }
 
@@ -113,6 +113,8 @@ STATIC size_t remcom_dispatch(char* request, char** output) {
     if (command_json = cJSON_GetObjectItem(request_json, "command"), cJSON_IsString(command_json)) {
         if (strcmp(command_json->valuestring, "getstats") == 0) {
             *output = remcom_output_builder(ERROR_OK, error_messages[ERROR_OK], rem_create_state_json());
+        } else if (strcmp(command_json->valuestring, HC_GETMETRICS) == 0) {
+            *output = remcom_output_builder(ERROR_OK, error_messages[ERROR_OK], w_metrics_getmetrics_json(cJSON_GetObjectItem(request_json, "parameters")));
         } else if (strcmp(command_json->valuestring, "getagentsstats") == 0) {
             if (parameters_json = cJSON_GetObjectItem(request_json, "parameters"), cJSON_IsObject(parameters_json)) {
                 agents_json = cJSON_GetObjectItem(parameters_json, "agents");
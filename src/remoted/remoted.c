@@ -26,6 +26,10 @@ rlim_t nofile;
 int tcp_keepidle;
 int tcp_keepintvl;
 int tcp_keepcnt;
+rem_reactor_t * reactors;
+int reactor_pool = 1;
+w_cpuset_t * reactor_cpus;
+w_cpuset_t * worker_cpus;
 
 /* Handle remote connections */
 void HandleRemote(int uid)
@@ -67,39 +71,64 @@ void HandleRemote(int uid)
         }
     }
 
-    /* If TCP is enabled then bind the TCP socket */
-    if (logr.proto[position] & REMOTED_NET_PROTOCOL_TCP) {
+    /* Each secure reactor, or syslog UDP receiver, binds its own listeners to the same port */
+    if (logr.conn[position] == SECURE_CONN || logr.proto[position] != REMOTED_NET_PROTOCOL_TCP) {
+        reactor_pool = getDefine_Int("remoted", "reactor_pool", 1, 16);
+    } else {
+        reactor_pool = 1;
+    }
+    os_calloc(reactor_pool, sizeof(rem_reactor_t), reactors);
 
-        logr.tcp_sock = OS_Bindporttcp(logr.port[position], logr.lip[position], logr.ipv6[position]);
+    for (int i = 0; i < reactor_pool; i++) {
+        reactors[i].id = i;
+        reactors[i].tcp_sock = -1;
+        reactors[i].udp_sock = -1;
 
-        if (logr.tcp_sock < 0) {
-            merror_exit(BIND_ERROR, logr.port[position], errno, strerror(errno));
-        }
-        else if (logr.conn[position] == SECURE_CONN) {
+        /* If TCP is enabled then bind the TCP socket */
+        if (logr.proto[position] & REMOTED_NET_PROTOCOL_TCP) {
 
-            if (OS_SetKeepalive(logr.tcp_sock) < 0) {
-                merror("OS_SetKeepalive failed with error '%s'", strerror(errno));
+            if (reactor_pool > 1) {
+                reactors[i].tcp_sock = OS_Bindporttcp_reuseport(logr.port[position], logr.lip[position], logr.ipv6[position]);
+            } else {
+                reactors[i].tcp_sock = OS_Bindporttcp(logr.port[position], logr.lip[position], logr.ipv6[position]);
             }
-#ifndef CLIENT
-            else {
-                OS_SetKeepalive_Options(logr.tcp_sock, tcp_keepidle, tcp_keepintvl, tcp_keepcnt);
+
+            if (reactors[i].tcp_sock < 0) {
+                merror_exit(BIND_ERROR, logr.port[position], errno, strerror(errno));
             }
+            else if (logr.conn[position] == SECURE_CONN) {
+
+                if (OS_SetKeepalive(reactors[i].tcp_sock) < 0) {
+                    merror("OS_SetKeepalive failed with error '%s'", strerror(errno));
+                }
+#ifndef CLIENT
+                else {
+                    OS_SetKeepalive_Options(reactors[i].tcp_sock, tcp_keepidle, tcp_keepintvl, tcp_keepcnt);
+                }
 #endif
-            if (OS_SetRecvTimeout(logr.tcp_sock, recv_timeout, 0) < 0) {
-                merror("OS_SetRecvTimeout failed with error '%s'", strerror(errno));
+                if (OS_SetRecvTimeout(reactors[i].tcp_sock, recv_timeout, 0) < 0) {
+                    merror("OS_SetRecvTimeout failed with error '%s'", strerror(errno));
+                }
             }
         }
-    }
-    /* If UDP is enabled then bind the UDP socket */
-    if (logr.proto[position] & REMOTED_NET_PROTOCOL_UDP) {
-        /* Using UDP. Fast, unreliable... perfect */
-        logr.udp_sock = OS_Bindportudp(logr.port[position], logr.lip[position], logr.ipv6[position]);
+        /* If UDP is enabled then bind the UDP socket */
+        if (logr.proto[position] & REMOTED_NET_PROTOCOL_UDP) {
+            /* Using UDP. Fast, unreliable... perfect */
+            if (reactor_pool > 1) {
+                reactors[i].udp_sock = OS_Bindportudp_reuseport(logr.port[position], logr.lip[position], logr.ipv6[position]);
+            } else {
+                reactors[i].udp_sock = OS_Bindportudp(logr.port[position], logr.lip[position], logr.ipv6[position]);
+            }
 
-        if (logr.udp_sock < 0) {
-            merror_exit(BIND_ERROR, logr.port[position], errno, strerror(errno));
+            if (reactors[i].udp_sock < 0) {
+                merror_exit(BIND_ERROR, logr.port[position], errno, strerror(errno));
+            }
         }
     }
 
+    /* Syslog and the UDP senders use the sockets of the first reactor */
+    logr.tcp_sock = reactors[0].tcp_sock;
+    logr.udp_sock = reactors[0].udp_sock;
 
     /* Revoke privileges */
     if (Privsep_SetUser(uid) < 0) {
@@ -25,6 +25,7 @@
 #define REMOTED_MSG_HEADER "1:" ARGV0 ":"
 #define AG_STOP_MSG REMOTED_MSG_HEADER OS_AG_STOPPED
 #define MAX_SHARED_PATH 200
+#define SHARED_DELTA_VERSION "v4.9.0" // Agents from this version apply shared file deltas
 
 /* Pending data structure */
 
@@ -32,6 +33,8 @@ typedef struct pending_data_t {
     char *message;
     char *group;
     os_md5 merged_sum;
+    os_md5 agent_sum;   // Merged sum reported by the agent
+    os_md5 delta_base;  // Agent sum the last delta was built from
     int changed;
 } pending_data_t;
 
@@ -41,6 +44,7 @@ typedef struct message_t {
     struct sockaddr_storage addr;
     int sock;
     size_t counter;
+    struct timespec queued;     // Monotonic time when the message was queued
 } message_t;
 
 /* Network buffer structure */
@@ -56,8 +60,25 @@ typedef struct sockbuffer_t {
 typedef struct netbuffer_t {
     int max_fd;
     sockbuffer_t * buffers;
+    pthread_mutex_t mutex;
+    wnotify_t * notify;         // Events watcher of the sockets of the buffer
 } netbuffer_t;
 
+/* Reactor: thread with its own listeners, events watcher and network buffers.
+ * Accepted sockets are handled by the reactor that accepted them. */
+
+typedef struct rem_reactor_t {
+    int id;
+    int tcp_sock;
+    int udp_sock;
+    wnotify_t * notify;
+    netbuffer_t netbuffer_recv;
+    netbuffer_t netbuffer_send;
+    message_t ** udp_messages;  // Messages that the next UDP batch is received into
+    struct mmsghdr * udp_msgs;
+    struct iovec * udp_iov;
+} rem_reactor_t;
+
 /** Function prototypes **/
 
 /* Read remoted config */
@@ -72,6 +93,19 @@ void HandleSyslog(void) __attribute__((noreturn));
 /* Handle Syslog TCP */
 void HandleSyslogTCP(void) __attribute__((noreturn));
 
+/**
+ * @brief Build the lookup trees of the allowed and denied syslog IPs.
+ */
+void rem_syslog_acl_init(void);
+
+/**
+ * @brief Check if a syslog client is not allowed by the allowed and denied IP lists.
+ *
+ * @param srcip IP address of the client.
+ * @return 1 if the IP is not allowed, 0 otherwise.
+ */
+int rem_ip_not_allowed(const char * srcip);
+
 /* Handle Secure connections */
 void HandleSecure() __attribute__((noreturn));
 
@@ -93,6 +127,9 @@ void *wait_for_msgs(void *none);
 /* Update shared files */
 void *update_shared_files(void *none);
 
+/* Send the batched keepalives to Wazuh DB */
+void *keepalive_batch_main(void *none);
+
 /* Save control messages */
 void save_controlmsg(const keyentry * key, char *msg, size_t msg_length, int *wdb_sock);
 
@@ -112,6 +149,26 @@ int req_save(const char * counter, const char * buffer, size_t length);
 /* Must not call key_lock() before this */
 int send_msg(const char *agent_id, const char *msg, ssize_t msg_length);
 
+/**
+ * @brief Send a datagram through the UDP socket.
+ *
+ * If the UDP sender is running, the datagram is queued and sent in a batch.
+ *
+ * @param msg message to send.
+ * @param msg_size message size.
+ * @param addr address of the peer.
+ *
+ * @return msg_size if the message was sent or queued, -1 on error.
+ */
+ssize_t rem_udp_send(const char * msg, size_t msg_size, const struct sockaddr_storage * addr);
+
+/**
+ * @brief Start the thread that sends the queued UDP datagrams in batches of udp_batch.
+ *
+ * @param size capacity of the queue.
+ */
+void rem_udp_sender_init(size_t size);
+
 int check_keyupdate(void);
 
 void key_lock_init(void);
@@ -128,6 +185,18 @@ void rem_msginit(size_t size);
 // Push message into queue
 int rem_msgpush(const char * buffer, unsigned long size, struct sockaddr_storage * addr, int sock);
 
+/**
+ * @brief Push a batch of messages into the queue, taking the ownership of them.
+ *
+ * The messages that don't fit in the queue are discarded and freed.
+ *
+ * @param messages array of messages, with their buffer, size, address and socket set.
+ * @param count number of messages.
+ *
+ * @return number of messages queued.
+ */
+size_t rem_msgpush_batch(message_t ** messages, size_t count);
+
 // Pop message from queue
 message_t * rem_msgpop();
 
@@ -176,6 +245,15 @@ int nb_send(netbuffer_t * buffer, int socket);
  */
 int nb_queue(netbuffer_t * buffer, int socket, char * crypt_msg, ssize_t msg_size, char * agent_id);
 
+/**
+ * @brief Get the reactor that handles a TCP socket.
+ *
+ * @param sock socket id.
+ *
+ * @return reactor of the socket, or the first reactor if the socket is unknown.
+ */
+rem_reactor_t * rem_get_reactor(int sock);
+
 /* Network counter */
 
 void rem_initList(int initial_size);
@@ -203,11 +281,17 @@ extern int guess_agent_group;
 extern unsigned receive_chunk;
 extern unsigned send_chunk;
 extern int buffer_relax;
+extern unsigned udp_batch;
+extern int keepalive_batch_interval;
 extern unsigned send_buffer_size;
 extern int send_timeout_to_retry;
 extern int tcp_keepidle;
 extern int tcp_keepintvl;
 extern int tcp_keepcnt;
 extern size_t global_counter;
+extern rem_reactor_t * reactors;
+extern int reactor_pool;
+extern w_cpuset_t * reactor_cpus;
+extern w_cpuset_t * worker_cpus;
 
 #endif /* LOGREMOTE_H */
@@ -24,10 +24,9 @@
 /* Global variables */
 int sender_pool;
 
-netbuffer_t netbuffer_recv;
-netbuffer_t netbuffer_send;
-
-wnotify_t * notify = NULL;
+/* Reactor of each TCP socket, indexed by socket */
+STATIC rem_reactor_t ** sock_reactors;
+STATIC size_t sock_reactors_size;
 
 size_t global_counter;
 
@@ -37,13 +36,23 @@ OSHash *remoted_agents_state;
 
 extern remoted_state_t remoted_state;
 
-STATIC void handle_outgoing_data_to_tcp_socket(int sock_client);
-STATIC void handle_incoming_data_from_tcp_socket(int sock_client);
-STATIC void handle_incoming_data_from_udp_socket(struct sockaddr_storage * peer_info);
-STATIC void handle_new_tcp_connection(wnotify_t * notify, struct sockaddr_storage * peer_info);
+STATIC void handle_outgoing_data_to_tcp_socket(rem_reactor_t * reactor, int sock_client);
+STATIC void handle_incoming_data_from_tcp_socket(rem_reactor_t * reactor, int sock_client);
+STATIC void handle_incoming_data_from_udp_socket(rem_reactor_t * reactor, struct sockaddr_storage * peer_info);
+STATIC void handle_incoming_data_from_udp_batch(rem_reactor_t * reactor);
+STATIC void handle_new_tcp_connection(rem_reactor_t * reactor, struct sockaddr_storage * peer_info);
+
+// Set up the events watcher and the network buffers of a reactor
+STATIC void rem_reactor_init(rem_reactor_t * reactor);
+
+// Allocate the message that the slot of a UDP batch is received into
+STATIC void rem_udp_slot_init(rem_reactor_t * reactor, unsigned int slot);
+
+// Reactor thread: socket I/O of its listeners and of the sockets it accepted
+STATIC void * rem_reactor_main(void * args) __attribute__((noreturn));
 
 // Message handler thread
-static void * rem_handler_main(__attribute__((unused)) void * args);
+static void * rem_handler_main(void * args);
 
 // Key reloader thread
 void * rem_keyupdate_main(__attribute__((unused)) void * args);
@@ -51,6 +60,12 @@ void * rem_keyupdate_main(__attribute__((unused)) void * args);
 /* Handle each message received */
 STATIC void HandleSecureMessage(const message_t *message, int *wdb_sock);
 
+// Send an event of an agent to analysisd
+STATIC void rem_forward_event(const char *msg, const char *srcmsg, const char *agent_id);
+
+// Send each event of a batch message: "<length>:<event>" records
+STATIC void rem_forward_batch(char *batch, size_t length, const char *srcmsg, const char *agent_id);
+
 // Close and remove socket from keystore
 int _close_sock(keystore * keys, int sock);
 
@@ -93,12 +108,6 @@ char *str_family_address[FAMILY_ADDRESS_SIZE] = {
 /* Handle secure connections */
 void HandleSecure()
 {
-    const int protocol = logr.proto[logr.position];
-    int n_events = 0;
-
-    struct sockaddr_storage peer_info;
-    memset(&peer_info, 0, sizeof(struct sockaddr_storage));
-
     /* Global stats uptime */
     remoted_state.uptime = time(NULL);
 
@@ -157,6 +166,11 @@ void HandleSecure()
         }
     }
 
+    // Create keepalive batch thread
+    if (keepalive_batch_interval > 0) {
+        w_create_thread(keepalive_batch_main, NULL);
+    }
+
     // Reset all the agents' connection status in Wazuh DB
     // The master will disconnect and alert the agents on its own DB. Thus, synchronization is not required.
     if (OS_SUCCESS != wdb_reset_agents_connection("synced", NULL))
@@ -168,9 +182,10 @@ void HandleSecure()
         // Initialize FD list and counter.
         global_counter = 0;
         rem_initList(FD_LIST_INIT_VALUE);
-        while (worker_pool > 0) {
-            w_create_thread(rem_handler_main, NULL);
-            worker_pool--;
+        rem_set_worker_pool(worker_pool);
+
+        for (intptr_t i = 0; i < worker_pool; i++) {
+            w_create_thread_affinity(rem_handler_main, (void *)i, worker_cpus);
         }
     }
 
@@ -197,31 +212,104 @@ void HandleSecure()
     w_create_thread(close_fp_main, &keys);
 
     /* Set up peer size */
-    logr.peer_size = sizeof(peer_info);
+    logr.peer_size = sizeof(struct sockaddr_storage);
+
+    /* UDP datagrams to the agents are sent in batches */
+    if ((logr.proto[logr.position] & REMOTED_NET_PROTOCOL_UDP) && udp_batch > 1) {
+        rem_udp_sender_init(logr.queue_size);
+    }
+
+    /* Map of the accepted sockets to their reactor */
+    sock_reactors_size = nofile;
+    os_calloc(sock_reactors_size, sizeof(rem_reactor_t *), sock_reactors);
+
+    for (int i = 0; i < reactor_pool; i++) {
+        rem_reactor_init(&reactors[i]);
+    }
+
+    mdebug2("Creating %d reactor threads.", reactor_pool);
+
+    for (int i = 1; i < reactor_pool; i++) {
+        w_create_thread_affinity(rem_reactor_main, &reactors[i], reactor_cpus);
+    }
+
+    // The main thread runs the first reactor
+    w_set_thread_affinity(reactor_cpus);
+    rem_reactor_main(&reactors[0]);
+
+    manager_free();
+}
+
+STATIC void rem_reactor_init(rem_reactor_t * reactor)
+{
+    const int protocol = logr.proto[logr.position];
 
     /* Events watcher is started (is used to monitor sockets events) */
-    if (notify = wnotify_init(MAX_EVENTS), !notify) {
+    if (reactor->notify = wnotify_init(MAX_EVENTS), !reactor->notify) {
         merror_exit("wnotify_init(): %s (%d)", strerror(errno), errno);
     }
 
+    w_mutex_init(&reactor->netbuffer_recv.mutex, NULL);
+    w_mutex_init(&reactor->netbuffer_send.mutex, NULL);
+    reactor->netbuffer_recv.notify = reactor->notify;
+    reactor->netbuffer_send.notify = reactor->notify;
+
     /* If TCP is set on the config, then the corresponding sockets is added to the watching list  */
     if (protocol & REMOTED_NET_PROTOCOL_TCP) {
-        if (wnotify_add(notify, logr.tcp_sock, WO_READ) < 0) {
-            merror_exit("wnotify_add(%d): %s (%d)", logr.tcp_sock, strerror(errno), errno);
+        if (wnotify_add(reactor->notify, reactor->tcp_sock, WO_READ) < 0) {
+            merror_exit("wnotify_add(%d): %s (%d)", reactor->tcp_sock, strerror(errno), errno);
         }
     }
 
     /* If UDP is set on the config, then the corresponding sockets is added to the watching list  */
     if (protocol & REMOTED_NET_PROTOCOL_UDP) {
-        if (wnotify_add(notify, logr.udp_sock, WO_READ) < 0) {
-            merror_exit("wnotify_add(%d): %s (%d)", logr.udp_sock, strerror(errno), errno);
+        if (wnotify_add(reactor->notify, reactor->udp_sock, WO_READ) < 0) {
+            merror_exit("wnotify_add(%d): %s (%d)", reactor->udp_sock, strerror(errno), errno);
+        }
+
+        if (udp_batch > 1) {
+            os_calloc(udp_batch, sizeof(message_t *), reactor->udp_messages);
+            os_calloc(udp_batch, sizeof(struct mmsghdr), reactor->udp_msgs);
+            os_calloc(udp_batch, sizeof(struct iovec), reactor->udp_iov);
+
+            for (unsigned int i = 0; i < udp_batch; i++) {
+                rem_udp_slot_init(reactor, i);
+            }
         }
     }
+}
+
+STATIC void rem_udp_slot_init(rem_reactor_t * reactor, unsigned int slot)
+{
+    message_t * message;
+
+    os_calloc(1, sizeof(message_t), message);
+    os_malloc(OS_MAXSTR, message->buffer);
+    message->sock = USING_UDP_NO_CLIENT_SOCKET;
+
+    reactor->udp_messages[slot] = message;
+    reactor->udp_iov[slot].iov_base = message->buffer;
+    reactor->udp_iov[slot].iov_len = OS_MAXSTR;
+    reactor->udp_msgs[slot].msg_hdr.msg_name = &message->addr;
+    reactor->udp_msgs[slot].msg_hdr.msg_iov = &reactor->udp_iov[slot];
+    reactor->udp_msgs[slot].msg_hdr.msg_iovlen = 1;
+}
+
+STATIC void * rem_reactor_main(void * args)
+{
+    rem_reactor_t * reactor = (rem_reactor_t *)args;
+    const int protocol = logr.proto[logr.position];
+    int n_events = 0;
+
+    struct sockaddr_storage peer_info;
+    memset(&peer_info, 0, sizeof(struct sockaddr_storage));
+
+    mdebug1("Reactor thread %d started.", reactor->id);
 
     while (1) {
 
         /* It waits for a socket event */
-        if (n_events = wnotify_wait(notify, EPOLL_MILLIS), n_events < 0) {
+        if (n_events = wnotify_wait(reactor->notify, EPOLL_MILLIS), n_events < 0) {
             if (errno != EINTR) {
                 merror("Waiting for connection: %s (%d)", strerror(errno), errno);
                 sleep(1);
@@ -233,7 +321,7 @@ void HandleSecure()
         for (int i = 0u; i < n_events; i++) {
             // Returns the fd of the socket that recived a message
             wevent_t event;
-            int fd = wnotify_get(notify, i, &event);
+            int fd = wnotify_get(reactor->notify, i, &event);
 
             // In case of failure or unexpected file descriptor
             if (fd <= 0) {
@@ -241,41 +329,57 @@ void HandleSecure()
                 continue;
             }
             // If a new TCP connection was received and TCP is enabled
-            else if ((fd == logr.tcp_sock) && (protocol & REMOTED_NET_PROTOCOL_TCP)) {
-                handle_new_tcp_connection(notify, &peer_info);
+            else if ((fd == reactor->tcp_sock) && (protocol & REMOTED_NET_PROTOCOL_TCP)) {
+                handle_new_tcp_connection(reactor, &peer_info);
             }
             // If a new UDP connection was received and UDP is enabled
-            else if ((fd == logr.udp_sock) && (protocol & REMOTED_NET_PROTOCOL_UDP)) {
-                handle_incoming_data_from_udp_socket(&peer_info);
+            else if ((fd == reactor->udp_sock) && (protocol & REMOTED_NET_PROTOCOL_UDP)) {
+                if (reactor->udp_messages) {
+                    handle_incoming_data_from_udp_batch(reactor);
+                } else {
+                    handle_incoming_data_from_udp_socket(reactor, &peer_info);
+                }
             }
             // If a message was received through a TCP client and tcp is enabled
             else if ((protocol & REMOTED_NET_PROTOCOL_TCP) && (event & WE_READ)) {
-                handle_incoming_data_from_tcp_socket(fd);
+                handle_incoming_data_from_tcp_socket(reactor, fd);
             }
             // If a TCP client socket is ready for sending and tcp is enabled
             else if ((protocol & REMOTED_NET_PROTOCOL_TCP) && (event & WE_WRITE)) {
-                handle_outgoing_data_to_tcp_socket(fd);
+                handle_outgoing_data_to_tcp_socket(reactor, fd);
             }
         }
     }
+}
+
+rem_reactor_t * rem_get_reactor(int sock)
+{
+    if (sock >= 0 && (size_t)sock < sock_reactors_size && sock_reactors[sock]) {
+        return sock_reactors[sock];
+    }
 
-    manager_free();
+    return reactors;
 }
 
-STATIC void handle_new_tcp_connection(wnotify_t * notify, struct sockaddr_storage * peer_info)
+STATIC void handle_new_tcp_connection(rem_reactor_t * reactor, struct sockaddr_storage * peer_info)
 {
-    int sock_client = accept(logr.tcp_sock, (struct sockaddr *) peer_info, &logr.peer_size);
+    socklen_t peer_size = sizeof(struct sockaddr_storage);
+    int sock_client = accept(reactor->tcp_sock, (struct sockaddr *) peer_info, &peer_size);
 
     if (sock_client >= 0) {
-        nb_open(&netbuffer_recv, sock_client, peer_info);
-        nb_open(&netbuffer_send, sock_client, peer_info);
+        if ((size_t)sock_client < sock_reactors_size) {
+            sock_reactors[sock_client] = reactor;
+        }
+
+        nb_open(&reactor->netbuffer_recv, sock_client, peer_info);
+        nb_open(&reactor->netbuffer_send, sock_client, peer_info);
 
         rem_inc_tcp();
 
         mdebug1("New TCP connection [%d]", sock_client);
 
-        if (wnotify_add(notify, sock_client, WO_READ) < 0) {
-            merror("wnotify_add(%d, %d): %s (%d)", notify->fd, sock_client, strerror(errno), errno);
+        if (wnotify_add(reactor->notify, sock_client, WO_READ) < 0) {
+            merror("wnotify_add(%d, %d): %s (%d)", reactor->notify->fd, sock_client, strerror(errno), errno);
             _close_sock(&keys, sock_client);
         }
     } else {
@@ -289,22 +393,72 @@ STATIC void handle_new_tcp_connection(wnotify_t * notify, struct sockaddr_storag
     }
 }
 
-STATIC void handle_incoming_data_from_udp_socket(struct sockaddr_storage * peer_info)
+STATIC void handle_incoming_data_from_udp_socket(rem_reactor_t * reactor, struct sockaddr_storage * peer_info)
 {
     char buffer[OS_MAXSTR + 1];
+    struct timespec start;
     memset(buffer, '\0', OS_MAXSTR + 1);
 
-    int recv_b = recvfrom(logr.udp_sock, buffer, OS_MAXSTR, 0, (struct sockaddr *) peer_info, &logr.peer_size);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    socklen_t peer_size = sizeof(struct sockaddr_storage);
+    int recv_b = recvfrom(reactor->udp_sock, buffer, OS_MAXSTR, 0, (struct sockaddr *) peer_info, &peer_size);
 
     if (recv_b > 0) {
         rem_msgpush(buffer, recv_b, peer_info, USING_UDP_NO_CLIENT_SOCKET);
         rem_add_recv((unsigned long) recv_b);
+        rem_add_reactor_recv(reactor->id, (unsigned long) recv_b);
+        rem_latency_since(REM_STAGE_READ, &start);
+    }
+}
+
+STATIC void handle_incoming_data_from_udp_batch(rem_reactor_t * reactor)
+{
+    message_t * batch[udp_batch];
+    struct timespec start;
+    unsigned long bytes = 0;
+    size_t count = 0;
+    int recv_n;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (unsigned int i = 0; i < udp_batch; i++) {
+        reactor->udp_msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+
+    if (recv_n = recvmmsg(reactor->udp_sock, reactor->udp_msgs, udp_batch, MSG_DONTWAIT, NULL), recv_n <= 0) {
+        return;
+    }
+
+    // The received buffers are handed over to the queue, new ones take their slots
+    for (int i = 0; i < recv_n; i++) {
+        message_t * message = reactor->udp_messages[i];
+        unsigned int recv_b = reactor->udp_msgs[i].msg_len;
+
+        if (recv_b == 0) {
+            continue;
+        }
+
+        os_realloc(message->buffer, recv_b, message->buffer);
+        message->size = recv_b;
+        batch[count++] = message;
+        rem_add_recv((unsigned long) recv_b);
+        bytes += recv_b;
+
+        rem_udp_slot_init(reactor, i);
     }
+
+    rem_msgpush_batch(batch, count);
+    rem_add_reactor_recv(reactor->id, bytes);
+    rem_latency_since(REM_STAGE_READ, &start);
 }
 
-STATIC void handle_incoming_data_from_tcp_socket(int sock_client)
+STATIC void handle_incoming_data_from_tcp_socket(rem_reactor_t * reactor, int sock_client)
 {
-    int recv_b = nb_recv(&netbuffer_recv, sock_client);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int recv_b = nb_recv(&reactor->netbuffer_recv, sock_client);
 
     switch (recv_b) {
     case -2:
@@ -334,12 +488,14 @@ STATIC void handle_incoming_data_from_tcp_socket(int sock_client)
 
     default:
         rem_add_recv((unsigned long) recv_b);
+        rem_add_reactor_recv(reactor->id, (unsigned long) recv_b);
+        rem_latency_since(REM_STAGE_READ, &start);
     }
 }
 
-STATIC void handle_outgoing_data_to_tcp_socket(int sock_client)
+STATIC void handle_outgoing_data_to_tcp_socket(rem_reactor_t * reactor, int sock_client)
 {
-    int sent_b = nb_send(&netbuffer_send, sock_client);
+    int sent_b = nb_send(&reactor->netbuffer_send, sock_client);
 
     switch (sent_b) {
     case -1:
@@ -366,15 +522,21 @@ STATIC void handle_outgoing_data_to_tcp_socket(int sock_client)
 }
 
 // Message handler thread
-void * rem_handler_main(__attribute__((unused)) void * args) {
+void * rem_handler_main(void * args) {
+    const int worker = (int)(intptr_t)args;
     message_t * message;
+    struct timespec start;
+    struct timespec end;
     int wdb_sock = -1;
     mdebug1("Message handler thread started.");
 
     while (1) {
         message = rem_msgpop();
+        clock_gettime(CLOCK_MONOTONIC, &start);
         HandleSecureMessage(message, &wdb_sock);
         rem_msgfree(message);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        rem_add_worker_msg(worker, (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL + end.tv_nsec - start.tv_nsec);
     }
 
     return NULL;
@@ -454,10 +616,13 @@ STATIC void HandleSecureMessage(const message_t *message, int *wdb_sock) {
     char buffer[OS_MAXSTR + 1] = "";
     char *tmp_msg;
     size_t msg_length;
+    struct timespec decrypt_start;
     char ip_found = 0;
     int r;
     int recv_b = message->size;
     int sock_idle = -1;
+    char *batch = NULL;
+    size_t batch_length = 0;
 
     /* Set the source IP */
     switch (message->addr.ss_family) {
@@ -570,7 +735,7 @@ STATIC void HandleSecureMessage(const message_t *message, int *wdb_sock) {
             ssize_t msg_size = strlen(msg);
 
             if (protocol == REMOTED_NET_PROTOCOL_UDP) {
-                retval = sendto(logr.udp_sock, msg, msg_size, 0, (struct sockaddr *)&message->addr, logr.peer_size) == msg_size ? 0 : -1;
+                retval = rem_udp_send(msg, msg_size, &message->addr) == msg_size ? 0 : -1;
             } else {
                 retval = OS_SendSecureTCP(message->sock, msg_size, msg);
             }
@@ -648,7 +813,11 @@ STATIC void HandleSecureMessage(const message_t *message, int *wdb_sock) {
     }
 
     /* Decrypt the message */
-    if (r = ReadSecMSG(&keys, tmp_msg, cleartext_msg, agentid, recv_b - 1, &msg_length, srcip, &tmp_msg), r != KS_VALID) {
+    clock_gettime(CLOCK_MONOTONIC, &decrypt_start);
+    r = ReadSecMSG(&keys, tmp_msg, cleartext_msg, agentid, recv_b - 1, &msg_length, srcip, &tmp_msg);
+    rem_latency_since(REM_STAGE_DECRYPT, &decrypt_start);
+
+    if (r != KS_VALID) {
         /* If duplicated, a warning was already generated */
         key_unlock();
 
@@ -676,8 +845,14 @@ STATIC void HandleSecureMessage(const message_t *message, int *wdb_sock) {
     /* Recieved valid message timestamp updated. */
     keys.keyentries[agentid]->rcvd = current_ts;
 
+    /* Check if it is a batch of events */
+    if (strncmp(tmp_msg, CONTROL_HEADER HC_BATCH, strlen(CONTROL_HEADER HC_BATCH)) == 0) {
+        batch = tmp_msg + strlen(CONTROL_HEADER HC_BATCH);
+        batch_length = msg_length > strlen(CONTROL_HEADER HC_BATCH) ? msg_length - strlen(CONTROL_HEADER HC_BATCH) : 0;
+    }
+
     /* Check if it is a control message */
-    if (IsValidHeader(tmp_msg)) {
+    if (!batch && IsValidHeader(tmp_msg)) {
 
         /* let through new and shutdown messages */
         if (message->sock == USING_UDP_NO_CLIENT_SOCKET || message->counter > rem_getCounter(message->sock) || (strncmp(tmp_msg, HC_SHUTDOWN, strlen(HC_SHUTDOWN)) == 0)) {
@@ -749,10 +924,23 @@ STATIC void HandleSecureMessage(const message_t *message, int *wdb_sock) {
         _close_sock(&keys, sock_idle);
     }
 
+    if (batch) {
+        rem_forward_batch(batch, batch_length, srcmsg, agentid_str);
+    } else {
+        rem_forward_event(tmp_msg, srcmsg, agentid_str);
+    }
+
+    os_free(agentid_str);
+}
+
+STATIC void rem_forward_event(const char *msg, const char *srcmsg, const char *agent_id) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
     /* If we can't send the message, try to connect to the
      * socket again. If it not exit.
      */
-    if (SendMSG(logr.m_queue, tmp_msg, srcmsg, SECURE_MQ) < 0) {
+    if (SendMSG(logr.m_queue, msg, srcmsg, SECURE_MQ) < 0) {
         merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
 
         // Try to reconnect infinitely
@@ -760,22 +948,107 @@ STATIC void HandleSecureMessage(const message_t *message, int *wdb_sock) {
 
         minfo("Successfully reconnected to '%s'", DEFAULTQUEUE);
 
-        if (SendMSG(logr.m_queue, tmp_msg, srcmsg, SECURE_MQ) < 0) {
+        if (SendMSG(logr.m_queue, msg, srcmsg, SECURE_MQ) < 0) {
             // Something went wrong sending a message after an immediate reconnection...
             merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
         } else {
-            rem_inc_recv_evt(agentid_str);
+            rem_inc_recv_evt(agent_id);
         }
     } else {
-        rem_inc_recv_evt(agentid_str);
+        rem_inc_recv_evt(agent_id);
     }
 
-    os_free(agentid_str);
+    rem_latency_since(REM_STAGE_FORWARD, &start);
+}
+
+/* Queue an event into the forwarding batch, reconnecting to the queue once if it fails */
+static int rem_forward_push(mq_batch_t *forward, const char *event, const char *srcmsg) {
+    if (mq_batch_push(forward, event, srcmsg, SECURE_MQ) == 0) {
+        return 0;
+    }
+
+    merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
+
+    // Try to reconnect infinitely
+    forward->queue = logr.m_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS);
+
+    minfo("Successfully reconnected to '%s'", DEFAULTQUEUE);
+
+    if (mq_batch_push(forward, event, srcmsg, SECURE_MQ) < 0) {
+        // Something went wrong sending a message after an immediate reconnection...
+        merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+STATIC void rem_forward_batch(char *batch, size_t length, const char *srcmsg, const char *agent_id) {
+    static __thread mq_batch_t *forward;
+    char *end = batch + length;
+    char *cur = batch;
+    struct timespec start;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    /* The events of a batch share the location, so they are sent together */
+    if (forward == NULL) {
+        forward = mq_batch_init(logr.m_queue);
+    }
+
+    forward->queue = logr.m_queue;
+
+    while (cur < end && *cur != '\0') {
+        char *event;
+        char last;
+        unsigned long event_length = strtoul(cur, &event, 10);
+
+        if (event == cur || *event != ':' || event_length == 0 || event_length > (unsigned long)(end - event - 1)) {
+            mwarn("Invalid batch message from agent '%s'.", agent_id);
+            break;
+        }
+
+        event++;
+        cur = event + event_length;
+
+        /* Control messages are never batched */
+        if (strncmp(event, CONTROL_HEADER, strlen(CONTROL_HEADER)) == 0) {
+            mdebug1("Discarding control message in a batch from agent '%s'.", agent_id);
+            continue;
+        }
+
+        // Terminate the event in place, the next length starts here
+        last = *cur;
+        *cur = '\0';
+
+        if (rem_forward_push(forward, event, srcmsg) == 0) {
+            rem_inc_recv_evt(agent_id);
+        }
+
+        *cur = last;
+    }
+
+    if (mq_batch_flush(forward) < 0) {
+        merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
+
+        // Try to reconnect infinitely
+        forward->queue = logr.m_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS);
+
+        minfo("Successfully reconnected to '%s'", DEFAULTQUEUE);
+
+        if (mq_batch_flush(forward) < 0) {
+            merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
+        }
+    }
+
+    rem_latency_since(REM_STAGE_FORWARD, &start);
 }
 
 // Close and remove socket from keystore
 int _close_sock(keystore * keys, int sock) {
     int retval = 0;
+    // The socket id may be reused by another reactor as soon as it is closed
+    rem_reactor_t * reactor = rem_get_reactor(sock);
 
     rem_setCounter(sock, global_counter);
 
@@ -784,8 +1057,8 @@ int _close_sock(keystore * keys, int sock) {
     key_unlock();
 
     if (!close(sock)) {
-        nb_close(&netbuffer_recv, sock);
-        nb_close(&netbuffer_send, sock);
+        nb_close(&reactor->netbuffer_recv, sock);
+        nb_close(&reactor->netbuffer_send, sock);
         rem_dec_tcp();
     }
 
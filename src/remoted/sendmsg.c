@@ -14,11 +14,21 @@
 #include "state.h"
 #include "os_net/os_net.h"
 
-extern netbuffer_t netbuffer_send;
-
 /* pthread key update mutex */
 static rwlock_t keyupdate_rwlock;
 
+/* Datagram waiting for the UDP sender */
+typedef struct udp_msg_t {
+    struct sockaddr_storage addr;
+    size_t size;
+    char data[];
+} udp_msg_t;
+
+static w_queue_t * udp_send_queue;
+
+// UDP sender thread
+static void * rem_udp_sender_main(void * args);
+
 void key_lock_init()
 {
     rwlock_init(&keyupdate_rwlock);
@@ -42,15 +52,28 @@ void key_unlock()
 /* Check for key updates */
 int check_keyupdate()
 {
+    keystore *new_keys;
+    keystore *old_keys;
+
     /* Check key for updates */
     if (!OS_CheckUpdateKeys(&keys)) {
         return (0);
     }
 
     minfo(ENCFILE_CHANGED);
+    mdebug1("Reloading keys");
+
+    /* The file is parsed before locking, so that readers are only blocked by the swap */
+    new_keys = OS_LoadKeys(&keys);
+
     key_lock_write();
-    OS_UpdateKeys(&keys);
+    old_keys = OS_SwapKeys(&keys, new_keys);
     key_unlock();
+
+    OS_FreeKeys(old_keys);
+    free(old_keys);
+
+    mdebug1("Key reloading completed");
     return 1;
 }
 
@@ -98,12 +121,12 @@ int send_msg(const char *agent_id, const char *msg, ssize_t msg_length)
     /* Send initial message */
     if (keys.keyentries[key_id]->net_protocol == REMOTED_NET_PROTOCOL_UDP) {
         /* UDP mode, send the message */
-        bytes_sent = sendto(logr.udp_sock, crypt_msg, msg_size, 0, (struct sockaddr *)&keys.keyentries[key_id]->peer_info, logr.peer_size);
+        bytes_sent = rem_udp_send(crypt_msg, msg_size, &keys.keyentries[key_id]->peer_info);
         error = errno;
         retval = bytes_sent == msg_size ? OS_SUCCESS : OS_INVALID;
     } else if (keys.keyentries[key_id]->sock >= 0) {
         /* TCP mode, enqueue the message in the send buffer */
-        retval = nb_queue(&netbuffer_send, keys.keyentries[key_id]->sock, crypt_msg, msg_size, keys.keyentries[key_id]->id);
+        retval = nb_queue(&rem_get_reactor(keys.keyentries[key_id]->sock)->netbuffer_send, keys.keyentries[key_id]->sock, crypt_msg, msg_size, keys.keyentries[key_id]->id);
         w_mutex_unlock(&keys.keyentries[key_id]->mutex);
         key_unlock();
         return retval;
@@ -142,3 +165,80 @@ int send_msg(const char *agent_id, const char *msg, ssize_t msg_length)
     key_unlock();
     return retval;
 }
+
+ssize_t rem_udp_send(const char * msg, size_t msg_size, const struct sockaddr_storage * addr)
+{
+    udp_msg_t * udp_msg;
+
+    if (!udp_send_queue) {
+        return sendto(logr.udp_sock, msg, msg_size, 0, (const struct sockaddr *)addr, logr.peer_size);
+    }
+
+    os_malloc(sizeof(udp_msg_t) + msg_size, udp_msg);
+    memcpy(&udp_msg->addr, addr, sizeof(struct sockaddr_storage));
+    memcpy(udp_msg->data, msg, msg_size);
+    udp_msg->size = msg_size;
+
+    if (queue_push_ex(udp_send_queue, udp_msg) < 0) {
+        os_free(udp_msg);
+        errno = EAGAIN;
+        return -1;
+    }
+
+    return msg_size;
+}
+
+void rem_udp_sender_init(size_t size)
+{
+    udp_send_queue = queue_init(size);
+    w_create_thread(rem_udp_sender_main, NULL);
+}
+
+void * rem_udp_sender_main(__attribute__((unused)) void * args)
+{
+    udp_msg_t ** batch;
+    struct mmsghdr * msgs;
+    struct iovec * iov;
+
+    os_calloc(udp_batch, sizeof(udp_msg_t *), batch);
+    os_calloc(udp_batch, sizeof(struct mmsghdr), msgs);
+    os_calloc(udp_batch, sizeof(struct iovec), iov);
+
+    mdebug1("UDP sender thread started.");
+
+    while (1) {
+        size_t count = queue_pop_ex_batch(udp_send_queue, (void **)batch, udp_batch);
+        size_t sent = 0;
+
+        for (size_t i = 0; i < count; i++) {
+            iov[i].iov_base = batch[i]->data;
+            iov[i].iov_len = batch[i]->size;
+            msgs[i].msg_hdr.msg_name = &batch[i]->addr;
+            msgs[i].msg_hdr.msg_namelen = logr.peer_size;
+            msgs[i].msg_hdr.msg_iov = &iov[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        while (sent < count) {
+            int sent_n = sendmmsg(logr.udp_sock, msgs + sent, count - sent, 0);
+
+            if (sent_n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                // The first datagram of the remaining ones could not be sent
+                mdebug1("UDP datagram could not be sent: %s (%d)", strerror(errno), errno);
+                sent_n = 1;
+            }
+
+            sent += sent_n;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            os_free(batch[i]);
+        }
+    }
+
+    return NULL;
+}
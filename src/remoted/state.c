@@ -22,6 +22,11 @@
 #endif
 
 remoted_state_t remoted_state = {0};
+STATIC rem_latency_t rem_latency[REM_STAGE_COUNT];
+STATIC rem_thread_stats_t rem_reactor_stats[REM_MAX_THREAD_POOL];
+STATIC rem_thread_stats_t rem_worker_stats[REM_MAX_THREAD_POOL];
+STATIC int rem_worker_pool = 0;
+static const char *rem_stage_names[REM_STAGE_COUNT] = { "read", "queue", "decrypt", "forward" };
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t agents_state_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int rem_write_state();
@@ -114,6 +119,35 @@ static void rem_inc_agents_send_request(const char *agent_id);
  */
 static void rem_inc_agents_send_discarded(const char *agent_id);
 
+/**
+ * @brief Get the histogram bucket of a latency
+ * @param usec Microseconds
+ * @return Bucket index
+ */
+STATIC unsigned rem_latency_bucket(uint64_t usec);
+
+/**
+ * @brief Get the highest latency that falls into a histogram bucket
+ * @param bucket Bucket index
+ * @return Microseconds
+ */
+STATIC uint64_t rem_latency_bucket_max(unsigned bucket);
+
+/**
+ * @brief Copy the histograms and the thread counters, which are updated without lock
+ * @param latency Array of REM_STAGE_COUNT histograms
+ * @param reactor_stats Array of REM_MAX_THREAD_POOL reactor counters
+ * @param worker_stats Array of REM_MAX_THREAD_POOL worker counters
+ */
+static void rem_copy_perf_stats(rem_latency_t *latency, rem_thread_stats_t *reactor_stats, rem_thread_stats_t *worker_stats);
+
+/**
+ * @brief Create a JSON object with the summary of a latency histogram
+ * @param latency Histogram
+ * @return JSON object
+ */
+static cJSON* rem_latency_json(const rem_latency_t *latency);
+
 void * rem_state_main() {
     int interval = getDefine_Int("remoted", "state_interval", 0, 86400);
 
@@ -152,6 +186,9 @@ int rem_write_state() {
     char path[PATH_MAX - 8];
     char path_temp[PATH_MAX + 1];
     remoted_state_t state_cpy;
+    rem_latency_t latency[REM_STAGE_COUNT];
+    rem_thread_stats_t reactor_stats[REM_MAX_THREAD_POOL];
+    rem_thread_stats_t worker_stats[REM_MAX_THREAD_POOL];
 
     if (!strcmp(__local_name, "unset")) {
         merror("At write_state(): __local_name is unset.");
@@ -172,6 +209,8 @@ int rem_write_state() {
     memcpy(&state_cpy, &remoted_state, sizeof(remoted_state_t));
     w_mutex_unlock(&state_mutex);
 
+    rem_copy_perf_stats(latency, reactor_stats, worker_stats);
+
     fprintf(fp,
         "# State file for %s\n"
         "# THIS FILE WILL BE DEPRECATED IN FUTURE VERSIONS\n"
@@ -207,6 +246,39 @@ int rem_write_state() {
         state_cpy.recv_breakdown.evt_count, state_cpy.recv_breakdown.ctrl_count, state_cpy.recv_breakdown.discarded_count,
         state_cpy.sent_bytes, state_cpy.recv_bytes, state_cpy.recv_breakdown.dequeued_count);
 
+    for (int i = 0; i < REM_STAGE_COUNT; i++) {
+        fprintf(fp,
+            "\n"
+            "# Latency of the %s stage: messages, median, 99th percentile and maximum microseconds\n"
+            "%s_count='%lu'\n"
+            "%s_p50_us='%lu'\n"
+            "%s_p99_us='%lu'\n"
+            "%s_max_us='%lu'\n",
+            rem_stage_names[i],
+            rem_stage_names[i], (unsigned long)latency[i].count,
+            rem_stage_names[i], (unsigned long)rem_latency_percentile(&latency[i], 50),
+            rem_stage_names[i], (unsigned long)rem_latency_percentile(&latency[i], 99),
+            rem_stage_names[i], (unsigned long)latency[i].max);
+    }
+
+    for (int i = 0; i < reactor_pool && i < REM_MAX_THREAD_POOL; i++) {
+        fprintf(fp,
+            "\n"
+            "# Socket reads and bytes received by reactor %d\n"
+            "reactor_%d_reads='%lu'\n"
+            "reactor_%d_bytes='%lu'\n",
+            i, i, (unsigned long)reactor_stats[i].reads, i, (unsigned long)reactor_stats[i].bytes);
+    }
+
+    for (int i = 0; i < rem_worker_pool; i++) {
+        fprintf(fp,
+            "\n"
+            "# Messages handled by worker %d and its busy time in microseconds\n"
+            "worker_%d_messages='%lu'\n"
+            "worker_%d_busy_us='%lu'\n",
+            i, i, (unsigned long)worker_stats[i].reads, i, (unsigned long)worker_stats[i].busy_time);
+    }
+
     fclose(fp);
 
     if (rename(path_temp, path) < 0) {
@@ -532,13 +604,145 @@ void rem_inc_keys_reload() {
     w_mutex_unlock(&state_mutex);
 }
 
+STATIC unsigned rem_latency_bucket(uint64_t usec) {
+    const unsigned sub_buckets = 1 << REM_LATENCY_SUB_BITS;
+    unsigned msb;
+
+    if (usec > UINT32_MAX) {
+        usec = UINT32_MAX;
+    }
+
+    if (usec < sub_buckets) {
+        return usec;
+    }
+
+    // The octave of the value, and its next bits as a linear sub-bucket
+    msb = 63 - __builtin_clzll(usec);
+    return ((msb - REM_LATENCY_SUB_BITS + 1) << REM_LATENCY_SUB_BITS) + ((usec >> (msb - REM_LATENCY_SUB_BITS)) & (sub_buckets - 1));
+}
+
+STATIC uint64_t rem_latency_bucket_max(unsigned bucket) {
+    const unsigned sub_buckets = 1 << REM_LATENCY_SUB_BITS;
+    unsigned octave = bucket >> REM_LATENCY_SUB_BITS;
+    uint64_t lower;
+
+    if (octave == 0) {
+        return bucket;
+    }
+
+    lower = (uint64_t)(sub_buckets + (bucket & (sub_buckets - 1))) << (octave - 1);
+    return lower + (1ULL << (octave - 1)) - 1;
+}
+
+void rem_latency_add(rem_stage_t stage, uint64_t nsec) {
+    rem_latency_t *latency = &rem_latency[stage];
+    uint64_t usec = nsec / 1000;
+    uint64_t max = __atomic_load_n(&latency->max, __ATOMIC_RELAXED);
+
+    __atomic_fetch_add(&latency->buckets[rem_latency_bucket(usec)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&latency->sum, usec, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&latency->count, 1, __ATOMIC_RELAXED);
+
+    while (usec > max && !__atomic_compare_exchange_n(&latency->max, &max, usec, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+}
+
+void rem_latency_since(rem_stage_t stage, const struct timespec *start) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if (now.tv_sec > start->tv_sec || (now.tv_sec == start->tv_sec && now.tv_nsec >= start->tv_nsec)) {
+        rem_latency_add(stage, (uint64_t)(now.tv_sec - start->tv_sec) * 1000000000ULL + now.tv_nsec - start->tv_nsec);
+    }
+}
+
+uint64_t rem_latency_percentile(const rem_latency_t *latency, double percentile) {
+    uint64_t total = 0;
+    uint64_t rank;
+
+    for (unsigned i = 0; i < REM_LATENCY_BUCKETS; i++) {
+        total += latency->buckets[i];
+    }
+
+    if (total == 0) {
+        return 0;
+    }
+
+    rank = (uint64_t)(total * percentile / 100.0 + 0.5);
+    rank = rank > 0 ? rank : 1;
+
+    for (unsigned i = 0, seen = 0; i < REM_LATENCY_BUCKETS; i++) {
+        if (seen += latency->buckets[i], seen >= rank) {
+            uint64_t bound = rem_latency_bucket_max(i);
+            return bound < latency->max ? bound : latency->max;
+        }
+    }
+
+    return latency->max;
+}
+
+void rem_add_reactor_recv(int reactor, unsigned long bytes) {
+    if (reactor >= 0 && reactor < REM_MAX_THREAD_POOL) {
+        __atomic_fetch_add(&rem_reactor_stats[reactor].reads, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&rem_reactor_stats[reactor].bytes, bytes, __ATOMIC_RELAXED);
+    }
+}
+
+void rem_add_worker_msg(int worker, uint64_t nsec) {
+    if (worker >= 0 && worker < REM_MAX_THREAD_POOL) {
+        __atomic_fetch_add(&rem_worker_stats[worker].reads, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&rem_worker_stats[worker].busy_time, nsec / 1000, __ATOMIC_RELAXED);
+    }
+}
+
+void rem_set_worker_pool(int workers) {
+    rem_worker_pool = workers < REM_MAX_THREAD_POOL ? workers : REM_MAX_THREAD_POOL;
+}
+
+static void rem_copy_perf_stats(rem_latency_t *latency, rem_thread_stats_t *reactor_stats, rem_thread_stats_t *worker_stats) {
+    for (int i = 0; i < REM_STAGE_COUNT; i++) {
+        latency[i].count = __atomic_load_n(&rem_latency[i].count, __ATOMIC_RELAXED);
+        latency[i].sum = __atomic_load_n(&rem_latency[i].sum, __ATOMIC_RELAXED);
+        latency[i].max = __atomic_load_n(&rem_latency[i].max, __ATOMIC_RELAXED);
+
+        for (int j = 0; j < REM_LATENCY_BUCKETS; j++) {
+            latency[i].buckets[j] = __atomic_load_n(&rem_latency[i].buckets[j], __ATOMIC_RELAXED);
+        }
+    }
+
+    for (int i = 0; i < REM_MAX_THREAD_POOL; i++) {
+        reactor_stats[i].reads = __atomic_load_n(&rem_reactor_stats[i].reads, __ATOMIC_RELAXED);
+        reactor_stats[i].bytes = __atomic_load_n(&rem_reactor_stats[i].bytes, __ATOMIC_RELAXED);
+        worker_stats[i].reads = __atomic_load_n(&rem_worker_stats[i].reads, __ATOMIC_RELAXED);
+        worker_stats[i].busy_time = __atomic_load_n(&rem_worker_stats[i].busy_time, __ATOMIC_RELAXED);
+    }
+}
+
+static cJSON* rem_latency_json(const rem_latency_t *latency) {
+    cJSON *_latency = cJSON_CreateObject();
+
+    cJSON_AddNumberToObject(_latency, "count", latency->count);
+    cJSON_AddNumberToObject(_latency, "max", latency->max);
+    cJSON_AddNumberToObject(_latency, "mean", latency->count ? (double)latency->sum / latency->count : 0);
+    cJSON_AddNumberToObject(_latency, "p50", rem_latency_percentile(latency, 50));
+    cJSON_AddNumberToObject(_latency, "p90", rem_latency_percentile(latency, 90));
+    cJSON_AddNumberToObject(_latency, "p99", rem_latency_percentile(latency, 99));
+
+    return _latency;
+}
+
 cJSON* rem_create_state_json() {
     remoted_state_t state_cpy;
+    rem_latency_t latency[REM_STAGE_COUNT];
+    rem_thread_stats_t reactor_stats[REM_MAX_THREAD_POOL];
+    rem_thread_stats_t worker_stats[REM_MAX_THREAD_POOL];
 
     w_mutex_lock(&state_mutex);
     memcpy(&state_cpy, &remoted_state, sizeof(remoted_state_t));
     w_mutex_unlock(&state_mutex);
 
+    rem_copy_perf_stats(latency, reactor_stats, worker_stats);
+
     cJSON *rem_state_json = cJSON_CreateObject();
 
     cJSON_AddNumberToObject(rem_state_json, "uptime", state_cpy.uptime);
@@ -558,6 +762,14 @@ cJSON* rem_create_state_json() {
 
     cJSON_AddNumberToObject(_metrics, "keys_reload_count", state_cpy.keys_reload_count);
 
+    // Microseconds of each stage of the message path
+    cJSON *_latency = cJSON_CreateObject();
+    cJSON_AddItemToObject(_metrics, "latency", _latency);
+
+    for (int i = 0; i < REM_STAGE_COUNT; i++) {
+        cJSON_AddItemToObject(_latency, rem_stage_names[i], rem_latency_json(&latency[i]));
+    }
+
     cJSON *_messages = cJSON_CreateObject();
     cJSON_AddItemToObject(_metrics, "messages", _messages);
 
@@ -599,8 +811,30 @@ cJSON* rem_create_state_json() {
     cJSON_AddNumberToObject(_received_q, "size", rem_get_tsize());
     cJSON_AddNumberToObject(_received_q, "usage", rem_get_qsize());
 
+    cJSON *_reactors = cJSON_CreateArray();
+    cJSON_AddItemToObject(_metrics, "reactors", _reactors);
+
+    for (int i = 0; i < reactor_pool && i < REM_MAX_THREAD_POOL; i++) {
+        cJSON *_reactor = cJSON_CreateObject();
+        cJSON_AddNumberToObject(_reactor, "id", i);
+        cJSON_AddNumberToObject(_reactor, "bytes", reactor_stats[i].bytes);
+        cJSON_AddNumberToObject(_reactor, "reads", reactor_stats[i].reads);
+        cJSON_AddItemToArray(_reactors, _reactor);
+    }
+
     cJSON_AddNumberToObject(_metrics, "tcp_sessions", state_cpy.tcp_sessions);
 
+    cJSON *_workers = cJSON_CreateArray();
+    cJSON_AddItemToObject(_metrics, "workers", _workers);
+
+    for (int i = 0; i < rem_worker_pool; i++) {
+        cJSON *_worker = cJSON_CreateObject();
+        cJSON_AddNumberToObject(_worker, "id", i);
+        cJSON_AddNumberToObject(_worker, "busy_time", worker_stats[i].busy_time);
+        cJSON_AddNumberToObject(_worker, "messages", worker_stats[i].reads);
+        cJSON_AddItemToArray(_workers, _worker);
+    }
+
     return rem_state_json;
 }
 
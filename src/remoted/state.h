@@ -12,6 +12,11 @@
 #define STATEREMOTE_H
 
 #define REM_MAX_NUM_AGENTS_STATS 150
+#define REM_MAX_THREAD_POOL      16
+
+/* Latency histograms: four buckets for each power of two microseconds */
+#define REM_LATENCY_SUB_BITS     2
+#define REM_LATENCY_BUCKETS      ((32 - REM_LATENCY_SUB_BITS + 1) << REM_LATENCY_SUB_BITS)
 
 #include <stdint.h>
 #include "../wazuh_db/helpers/wdb_global_helpers.h"
@@ -54,6 +59,28 @@ typedef struct _remoted_state_t {
     sent_msgs_t sent_breakdown;
 } remoted_state_t;
 
+/* Stages of the path of a message, from the socket to analysisd */
+typedef enum _rem_stage_t {
+    REM_STAGE_READ,         // Socket read until the message is queued
+    REM_STAGE_QUEUE,        // Waiting in the message queue
+    REM_STAGE_DECRYPT,      // Decryption and decompression
+    REM_STAGE_FORWARD,      // Sending to analysisd
+    REM_STAGE_COUNT
+} rem_stage_t;
+
+typedef struct _rem_latency_t {
+    uint64_t count;
+    uint64_t sum;           // Microseconds
+    uint64_t max;           // Microseconds
+    uint64_t buckets[REM_LATENCY_BUCKETS];
+} rem_latency_t;
+
+typedef struct _rem_thread_stats_t {
+    uint64_t reads;         // Reactors: socket reads. Workers: messages handled
+    uint64_t bytes;         // Reactors: bytes received
+    uint64_t busy_time;     // Workers: microseconds handling messages
+} rem_thread_stats_t;
+
 typedef struct _remoted_agent_state_t {
     uint64_t uptime;
     uint64_t recv_evt_count;
@@ -193,6 +220,48 @@ void rem_inc_send_discarded(const char *agent_id);
  */
 void rem_inc_keys_reload();
 
+/**
+ * @brief Record the time that a message spent in a stage
+ * @param stage Stage of the message path
+ * @param nsec Nanoseconds spent in the stage
+ */
+void rem_latency_add(rem_stage_t stage, uint64_t nsec);
+
+/**
+ * @brief Record the time elapsed in a stage since a point in the monotonic clock
+ * @param stage Stage of the message path
+ * @param start Time when the stage began
+ */
+void rem_latency_since(rem_stage_t stage, const struct timespec *start);
+
+/**
+ * @brief Get the upper bound of the bucket that holds a percentile of a histogram
+ * @param latency Histogram
+ * @param percentile Percentile, from 0 to 100
+ * @return Microseconds, never above the maximum recorded
+ */
+uint64_t rem_latency_percentile(const rem_latency_t *latency, double percentile);
+
+/**
+ * @brief Increment the socket reads and the bytes received by a reactor
+ * @param reactor Reactor id
+ * @param bytes Number of bytes received
+ */
+void rem_add_reactor_recv(int reactor, unsigned long bytes);
+
+/**
+ * @brief Increment the messages handled by a worker and its busy time
+ * @param worker Worker id
+ * @param nsec Nanoseconds spent handling the message
+ */
+void rem_add_worker_msg(int worker, uint64_t nsec);
+
+/**
+ * @brief Set the number of worker threads whose counters are reported
+ * @param workers Number of workers
+ */
+void rem_set_worker_pool(int workers);
+
 /**
  * @brief Create a JSON object with all the remoted state information
  * @return JSON object
@@ -12,20 +12,50 @@
 #include "os_net/os_net.h"
 #include "remoted.h"
 
+#ifdef WAZUH_UNIT_TESTING
+// Remove static qualifier when unit testing
+#define STATIC
+#else
+#define STATIC static
+#endif
+
+/* Receiver of a syslog UDP socket, run by each reactor */
+typedef struct syslog_receiver_t {
+    int sock;
+    mq_batch_t * forward;                   // Messages for analysisd, sent once per received batch
+    struct mmsghdr * msgs;
+    struct iovec * iov;
+    char ** buffers;
+    struct sockaddr_storage * addrs;
+} syslog_receiver_t;
+
+/* Trees of the allowed and denied IPs. NULL if the list is empty or it must be looked up in order. */
+static os_iptree * allow_tree;
+static os_iptree * deny_tree;
+
 /* Prototypes */
-static int OS_IPNotAllowed(const char *srcip);
+STATIC int syslog_addr_not_allowed(const void * addr, bool is_ipv6, const char * srcip);
+STATIC void syslog_forward(syslog_receiver_t * receiver, char * buffer, size_t length, const struct sockaddr_storage * peer);
+STATIC int syslog_receive_batch(syslog_receiver_t * receiver);
+STATIC syslog_receiver_t * syslog_receiver_init(int sock, int queue);
+static void * syslog_receiver_main(void * args);
 
 
-/* Check if an IP is not allowed */
-static int OS_IPNotAllowed(const char *srcip)
+void rem_syslog_acl_init() {
+    allow_tree = OS_IPTreeBuild(logr.allowips);
+    deny_tree = OS_IPTreeBuild(logr.denyips);
+}
+
+/* Check if an IP is not allowed. The address, if not NULL, saves parsing the string. */
+STATIC int syslog_addr_not_allowed(const void * addr, bool is_ipv6, const char * srcip)
 {
     if (logr.denyips != NULL) {
-        if (OS_IPFoundList(srcip, logr.denyips)) {
+        if (deny_tree != NULL && addr != NULL ? OS_IPFoundTree(deny_tree, addr, is_ipv6) : OS_IPFoundList(srcip, logr.denyips)) {
             return (1);
         }
     }
     if (logr.allowips != NULL) {
-        if (OS_IPFoundList(srcip, logr.allowips)) {
+        if (allow_tree != NULL && addr != NULL ? OS_IPFoundTree(allow_tree, addr, is_ipv6) : OS_IPFoundList(srcip, logr.allowips)) {
             return (0);
         }
     }
@@ -34,88 +64,194 @@ static int OS_IPNotAllowed(const char *srcip)
     return (1);
 }
 
-/* Handle syslog connections */
-void HandleSyslog()
+int rem_ip_not_allowed(const char * srcip)
 {
-    char buffer[OS_MAXSTR + 2];
-    char srcip[IPSIZE + 1];
-    char *buffer_pt = NULL;
-    ssize_t recv_b;
-    struct sockaddr_storage _nc;
-    socklen_t _ncl;
+    struct in_addr net;
+    struct in6_addr net6;
+
+    if (get_ipv4_numeric(srcip, &net) == OS_SUCCESS) {
+        return syslog_addr_not_allowed(&net, false, srcip);
+    } else if (get_ipv6_numeric(srcip, &net6) == OS_SUCCESS) {
+        return syslog_addr_not_allowed(&net6, true, srcip);
+    }
 
-    /* Set peer size */
-    _ncl = sizeof(_nc);
+    return syslog_addr_not_allowed(NULL, false, srcip);
+}
 
-    /* Initialize some variables */
-    memset(buffer, '\0', OS_MAXSTR + 2);
-    memset(&_nc, 0, sizeof(_nc));
+/* Check and queue a received message */
+STATIC void syslog_forward(syslog_receiver_t * receiver, char * buffer, size_t length, const struct sockaddr_storage * peer)
+{
+    char srcip[IPSIZE + 1];
+    char * buffer_pt = NULL;
+    const void * addr;
+    bool is_ipv6;
 
-    /* Connect to the message queue infinitely */
-    if ((logr.m_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
-        merror_exit(QUEUE_FATAL, DEFAULTQUEUE);
+    /* Null-terminate the message */
+    buffer[length] = '\0';
+
+    /* Remove newline */
+    if (buffer[length - 1] == '\n') {
+        buffer[length - 1] = '\0';
     }
 
-    /* Infinite loop */
-    while (1) {
-        /* Receive message */
-        recv_b = recvfrom(logr.udp_sock, buffer, OS_MAXSTR, 0, (struct sockaddr *)&_nc, &_ncl);
+    /* Set the source IP. IPv4-mapped addresses are checked and reported as IPv4. */
+    switch (peer->ss_family) {
+    case AF_INET:
+        addr = &((struct sockaddr_in *)peer)->sin_addr;
+        is_ipv6 = false;
+        get_ipv4_string(((struct sockaddr_in *)peer)->sin_addr, srcip, IPSIZE);
+        break;
+    case AF_INET6:
+        if (IN6_IS_ADDR_V4MAPPED(&((struct sockaddr_in6 *)peer)->sin6_addr)) {
+            struct in_addr addr4;
 
-        /* Nothing received */
-        if (recv_b <= 0) {
-            continue;
+            memcpy(&addr4, ((struct sockaddr_in6 *)peer)->sin6_addr.s6_addr + 12, sizeof(addr4));
+            addr = ((struct sockaddr_in6 *)peer)->sin6_addr.s6_addr + 12;
+            is_ipv6 = false;
+            get_ipv4_string(addr4, srcip, IPSIZE);
+        } else {
+            addr = &((struct sockaddr_in6 *)peer)->sin6_addr;
+            is_ipv6 = true;
+            get_ipv6_string(((struct sockaddr_in6 *)peer)->sin6_addr, srcip, IPSIZE);
+        }
+        break;
+    default:
+        return;
+    }
+
+    /* Remove syslog header */
+    if (buffer[0] == '<') {
+        buffer_pt = strchr(buffer + 1, '>');
+        if (buffer_pt) {
+            buffer_pt++;
+        } else {
+            buffer_pt = buffer;
         }
+    } else {
+        buffer_pt = buffer;
+    }
+
+    /* Check if IP is allowed here */
+    if (syslog_addr_not_allowed(addr, is_ipv6, srcip)) {
+        mwarn(DENYIP_WARN, srcip);
+        return;
+    }
+
+    if (mq_batch_push(receiver->forward, buffer_pt, srcip, SYSLOG_MQ) < 0) {
+        merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
 
-        /* Null-terminate the message */
-        buffer[recv_b] = '\0';
+        // Try to reconnect infinitely
+        receiver->forward->queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS);
 
-        /* Remove newline */
-        if (buffer[recv_b - 1] == '\n') {
-            buffer[recv_b - 1] = '\0';
+        minfo("Successfully reconnected to '%s'", DEFAULTQUEUE);
+
+        if (mq_batch_push(receiver->forward, buffer_pt, srcip, SYSLOG_MQ) < 0) {
+            // Something went wrong sending a message after an immediate reconnection...
+            merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
         }
+    }
+}
+
+/* Receive up to udp_batch datagrams, waiting for the first one, and forward them at once */
+STATIC int syslog_receive_batch(syslog_receiver_t * receiver)
+{
+    int recv_n;
+
+    for (unsigned int i = 0; i < udp_batch; i++) {
+        receiver->msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    }
+
+    if (recv_n = recvmmsg(receiver->sock, receiver->msgs, udp_batch, MSG_WAITFORONE, NULL), recv_n <= 0) {
+        return recv_n;
+    }
 
-        /* Set the source IP */
-        switch (_nc.ss_family) {
-        case AF_INET:
-            get_ipv4_string(((struct sockaddr_in *)&_nc)->sin_addr, srcip, IPSIZE);
-            break;
-        case AF_INET6:
-            get_ipv6_string(((struct sockaddr_in6 *)&_nc)->sin6_addr, srcip, IPSIZE);
-            break;
-        default:
+    for (int i = 0; i < recv_n; i++) {
+        /* Nothing received */
+        if (receiver->msgs[i].msg_len == 0) {
             continue;
         }
 
-        /* Remove syslog header */
-        if (buffer[0] == '<') {
-            buffer_pt = strchr(buffer + 1, '>');
-            if (buffer_pt) {
-                buffer_pt++;
-            } else {
-                buffer_pt = buffer;
-            }
-        } else {
-            buffer_pt = buffer;
+        syslog_forward(receiver, receiver->buffers[i], receiver->msgs[i].msg_len, &receiver->addrs[i]);
+    }
+
+    if (mq_batch_flush(receiver->forward) < 0) {
+        merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
+
+        // Try to reconnect infinitely
+        receiver->forward->queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS);
+
+        minfo("Successfully reconnected to '%s'", DEFAULTQUEUE);
+
+        if (mq_batch_flush(receiver->forward) < 0) {
+            merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
         }
+    }
 
-        /* Check if IP is allowed here */
-        if (OS_IPNotAllowed(srcip)) {
-            mwarn(DENYIP_WARN, srcip);
-            continue;
+    return recv_n;
+}
+
+STATIC syslog_receiver_t * syslog_receiver_init(int sock, int queue)
+{
+    syslog_receiver_t * receiver;
+
+    os_calloc(1, sizeof(syslog_receiver_t), receiver);
+    receiver->sock = sock;
+    receiver->forward = mq_batch_init(queue);
+
+    os_calloc(udp_batch, sizeof(struct mmsghdr), receiver->msgs);
+    os_calloc(udp_batch, sizeof(struct iovec), receiver->iov);
+    os_calloc(udp_batch, sizeof(char *), receiver->buffers);
+    os_calloc(udp_batch, sizeof(struct sockaddr_storage), receiver->addrs);
+
+    // The last byte of each buffer is kept for the terminator
+    for (unsigned int i = 0; i < udp_batch; i++) {
+        os_malloc(OS_MAXSTR + 1, receiver->buffers[i]);
+        receiver->iov[i].iov_base = receiver->buffers[i];
+        receiver->iov[i].iov_len = OS_MAXSTR;
+        receiver->msgs[i].msg_hdr.msg_name = &receiver->addrs[i];
+        receiver->msgs[i].msg_hdr.msg_iov = &receiver->iov[i];
+        receiver->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    return receiver;
+}
+
+static void * syslog_receiver_main(void * args)
+{
+    syslog_receiver_t * receiver = (syslog_receiver_t *)args;
+
+    while (1) {
+        if (syslog_receive_batch(receiver) < 0 && errno != EINTR) {
+            mdebug1("recvmmsg(%d): %s (%d)", receiver->sock, strerror(errno), errno);
         }
+    }
 
-        if (SendMSG(logr.m_queue, buffer_pt, srcip, SYSLOG_MQ) < 0) {
-            merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
+    return NULL;
+}
 
-            // Try to reconnect infinitely
-            logr.m_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS);
+/* Handle syslog connections */
+void HandleSyslog()
+{
+    /* Connect to the message queue infinitely */
+    if ((logr.m_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
+        merror_exit(QUEUE_FATAL, DEFAULTQUEUE);
+    }
 
-            minfo("Successfully reconnected to '%s'", DEFAULTQUEUE);
+    rem_syslog_acl_init();
 
-            if (SendMSG(logr.m_queue, buffer_pt, srcip, SYSLOG_MQ) < 0) {
-                // Something went wrong sending a message after an immediate reconnection...
-                merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
-            }
+    /* Each reactor receives from its own socket, bound to the same port, and has its own queue connection */
+    for (int i = 1; i < reactor_pool; i++) {
+        int queue;
+
+        if ((queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
+            merror_exit(QUEUE_FATAL, DEFAULTQUEUE);
         }
+
+        w_create_thread_affinity(syslog_receiver_main, syslog_receiver_init(reactors[i].udp_sock, queue), reactor_cpus);
     }
+
+    syslog_receiver_main(syslog_receiver_init(logr.udp_sock, logr.m_queue));
+
+    /* Never reached */
+    exit(0);
 }
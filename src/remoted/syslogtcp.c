@@ -27,30 +27,13 @@
  */
 STATIC size_t w_get_pri_header_len(const char * syslog_msg);
 
-/* Checks if an IP is not allowed */
-static int OS_IPNotAllowed(char *srcip)
-{
-    if (logr.denyips != NULL) {
-        if (OS_IPFoundList(srcip, logr.denyips)) {
-            return (1);
-        }
-    }
-    if (logr.allowips != NULL) {
-        if (OS_IPFoundList(srcip, logr.allowips)) {
-            return (0);
-        }
-    }
-
-    /* If the IP is not allowed, it will be denied */
-    return (1);
-}
-
 /**
  * @brief Function that sends a buffer to a queue.
  * @param socket_buffer sockbuffer_t structure that contains the data from the socket.
  * @param srcip String with the IP of the queue where the message will be sent.
+ * @param forward Batch of messages for the queue, sent once per buffer.
  */
-void send_buffer(sockbuffer_t *socket_buffer, char *srcip) {
+void send_buffer(sockbuffer_t *socket_buffer, char *srcip, mq_batch_t *forward) {
     char *data_pt = socket_buffer->data;
     int offset;
     char * buffer_pt = NULL;
@@ -61,11 +44,11 @@ void send_buffer(sockbuffer_t *socket_buffer, char *srcip) {
         // Get the position of '\n' in buffer
         offset = ((int)(buffer_pt - data_pt));
         *buffer_pt = '\0';
-        // Send message to the queue
-        if (SendMSG(logr.m_queue, data_pt + w_get_pri_header_len(data_pt), srcip, SYSLOG_MQ) < 0) {
+        // Queue the message
+        if (mq_batch_push(forward, data_pt + w_get_pri_header_len(data_pt), srcip, SYSLOG_MQ) < 0) {
             merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
 
-            if ((logr.m_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
+            if ((forward->queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
                 merror_exit(QUEUE_FATAL, DEFAULTQUEUE);
             }
         }
@@ -75,8 +58,16 @@ void send_buffer(sockbuffer_t *socket_buffer, char *srcip) {
         // Find the next '\n'
         buffer_pt = strchr(data_pt, '\n');
     }
-    memcpy(socket_buffer->data, data_pt, socket_buffer->data_len);
+    memmove(socket_buffer->data, data_pt, socket_buffer->data_len);
+
+    // Send the messages of this buffer at once
+    if (mq_batch_flush(forward) < 0) {
+        merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
 
+        if ((forward->queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
+            merror_exit(QUEUE_FATAL, DEFAULTQUEUE);
+        }
+    }
 }
 
 /* Handle each client */
@@ -84,6 +75,7 @@ static void HandleClient(int client_socket, char *srcip)
 {
     int r_sz = 0;
     sockbuffer_t socket_buff;
+    mq_batch_t *forward = mq_batch_init(logr.m_queue);
 
     os_calloc(OS_MAXSTR + 2, sizeof(char), socket_buff.data);
     socket_buff.data_len = 0;
@@ -106,12 +98,13 @@ static void HandleClient(int client_socket, char *srcip)
                 close(client_socket);
                 DeletePID(ARGV0);
                 os_free(socket_buff.data);
+                mq_batch_free(forward);
                 return;
             default:
                 mdebug2("Received %d bytes from '%s'", r_sz, srcip);
                 break;
         }
-        send_buffer(&socket_buff, srcip);
+        send_buffer(&socket_buff, srcip, forward);
     }
 }
 
@@ -131,6 +124,8 @@ void HandleSyslogTCP()
         merror_exit(QUEUE_FATAL, DEFAULTQUEUE);
     }
 
+    rem_syslog_acl_init();
+
     while (1) {
         /* Wait for the children */
         while (childcount) {
@@ -156,7 +151,7 @@ void HandleSyslogTCP()
         }
 
         /* Check if IP is allowed here */
-        if (OS_IPNotAllowed(srcip)) {
+        if (rem_ip_not_allowed(srcip)) {
             mwarn(DENYIP_WARN, srcip);
             close(client_socket);
             continue;
@@ -12,15 +12,23 @@
 #include "shared.h"
 #include "rootcheck.h"
 
+/* Bitset of PIDs */
+#define PID_SET(set, pid)   ((set)[(pid) / 8] |= (unsigned char)(1 << ((pid) % 8)))
+#define PID_ISSET(set, pid) ((set)[(pid) / 8] & (1 << ((pid) % 8)))
+
 /* Prototypes */
 static int  proc_read(int pid);
 static int  proc_opendir(int pid);
 static int  proc_stat(int pid);
+static void proc_list(unsigned char *listed, pid_t max_pid);
 static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_total);
 
 /* Global variables */
 static int noproc;
 
+/* First PID of the slice not listed in /proc to probe in the next scan */
+static pid_t slice_start = 1;
+
 
 /* If /proc is mounted, check to see if the pid is present */
 static int proc_read(int pid)
@@ -82,7 +90,31 @@ static int proc_stat(int pid)
     return (0);
 }
 
-/* Check all the available PIDs for hidden stuff */
+/* Mark the PIDs listed in /proc, reading the directory once */
+static void proc_list(unsigned char *listed, pid_t max_pid)
+{
+    struct dirent *entry;
+    DIR *dp;
+
+    if (noproc || !(dp = opendir("/proc"))) {
+        return;
+    }
+
+    while ((entry = readdir(dp)) != NULL) {
+        char *end;
+        long pid = strtol(entry->d_name, &end, 10);
+
+        if (*end == '\0' && pid > 0 && pid <= max_pid) {
+            PID_SET(listed, pid);
+        }
+    }
+
+    closedir(dp);
+}
+
+/* Check the PIDs for hidden stuff. Every PID listed in /proc is checked,
+ * but only a slice of the rest, that rotates on each scan.
+ */
 static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_total)
 {
     int _kill0 = 0;
@@ -98,16 +130,31 @@ static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_tot
 
     pid_t i = 1;
     pid_t my_pid;
+    pid_t slice_end;
+    unsigned char *listed;
 
     char command[OS_SIZE_1024 + 64];
 
     my_pid = getpid();
 
+    os_calloc(max_pid / 8 + 1, sizeof(unsigned char), listed);
+    proc_list(listed, max_pid);
+
+    if (slice_start > max_pid) {
+        slice_start = 1;
+    }
+
+    slice_end = slice_start + max_pid / (rootcheck.pid_slices > 0 ? rootcheck.pid_slices : 1) + 1;
+
     for (;; i++) {
         if ((i <= 0) || (i > max_pid)) {
             break;
         }
 
+        if (!PID_ISSET(listed, i) && (i < slice_start || i >= slice_end)) {
+            continue;
+        }
+
         (*_total)++;
 
         _kill0 = 0;
@@ -133,9 +180,9 @@ static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_tot
             _gpid0 = 1;
         }
 
-        /* /proc test */
+        /* /proc test, the listing was read at the beginning of the scan */
+        _proc_read = PID_ISSET(listed, i) ? 1 : 0;
         _proc_stat = proc_stat(i);
-        _proc_read = proc_read(i);
         _proc_opendir = proc_opendir(i);
 
         /* If PID does not exist, move on */
@@ -156,7 +203,7 @@ static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_tot
                      ". It maybe a false-positive or "
                      "something really bad is going on.");
             notify_rk(ALERT_SYSTEM_CRIT, op_msg);
-            return;
+            break;
         }
 
         /* Check if the process appears in ps(1) output */
@@ -277,6 +324,9 @@ static void loop_all_pids(const char *ps, pid_t max_pid, int *_errors, int *_tot
             }
         }
     }
+
+    slice_start = slice_end;
+    os_free(listed);
 }
 
 /* Scan the whole filesystem looking for possible issues */
@@ -191,6 +191,7 @@ int rootcheck_init(int test_config)
 #endif
 
     rootcheck.tsleep = getDefine_Int("rootcheck", "sleep", 0, 1000);
+    rootcheck.pid_slices = getDefine_Int("rootcheck", "pid_slices", 1, 64);
 
     /* If testing config, exit here */
     if (test_config) {
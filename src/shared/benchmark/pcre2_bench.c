@@ -0,0 +1,289 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Microbenchmark of the PCRE2 expressions matching.
+ * A set of lines is matched against a set of patterns in several ways:
+ * the interpreter, the matching data created for each match (as done
+ * before it was kept by each thread), and w_expression_match() through
+ * pcre2_match() and pcre2_jit_match().
+ */
+
+#ifdef ARGV0
+#undef ARGV0
+#endif
+#define ARGV0 "wazuh-pcre2-bench"
+
+#include "shared.h"
+#include "expression.h"
+
+#define BENCH_LOOPS     100000
+#define BENCH_MAX_ITEMS 256
+
+typedef enum bench_mode_t {
+    BENCH_INTERPRETER,
+    BENCH_CREATE_EACH,
+    BENCH_EXPRESSION,
+    BENCH_EXPRESSION_JIT,
+    BENCH_MODES
+} bench_mode_t;
+
+static const char *mode_names[BENCH_MODES] = {
+    [BENCH_INTERPRETER] = "Interpreter",
+    [BENCH_CREATE_EACH] = "Data per match",
+    [BENCH_EXPRESSION] = "pcre2_match",
+    [BENCH_EXPRESSION_JIT] = "pcre2_jit_match",
+};
+
+typedef struct bench_worker_t {
+    pthread_t thread;
+    bench_mode_t mode;
+    unsigned long long matches;
+    unsigned long long hits;
+    unsigned long long nsec;
+} bench_worker_t;
+
+/* Alike to the ones of the default ruleset */
+static const char *default_patterns[] = {
+    "^sshd\\[\\d+\\]: Failed password for (?:invalid user )?(\\S+) from (\\S+) port (\\d+)",
+    "^sshd\\[\\d+\\]: Accepted \\w+ for (\\S+) from (\\S+)",
+    "(?i)segmentation fault|core dumped",
+    "^type=(\\w+) msg=audit\\((\\d+)\\.\\d+:(\\d+)\\):",
+    "\"(GET|POST|PUT|DELETE) ([^ \"]+) HTTP/[\\d.]+\" (\\d{3})",
+};
+
+static const char *default_lines[] = {
+    "sshd[1234]: Failed password for invalid user admin from 192.168.1.10 port 54321 ssh2",
+    "sshd[1234]: Accepted publickey for wazuh from 10.0.0.2 port 22 ssh2",
+    "kernel: [12345.678] app[999]: segfault at 0 ip 00007f sp 00007ff error 4",
+    "type=SYSCALL msg=audit(1600000000.123:4567): arch=c000003e syscall=59 success=yes",
+    "10.0.0.1 - - [10/Oct/2026:13:55:36 +0000] \"GET /index.html HTTP/1.1\" 200 2326",
+    "systemd[1]: Started Session 42 of user root.",
+};
+
+static w_expression_t *expressions[BENCH_MAX_ITEMS];
+static char *lines[BENCH_MAX_ITEMS];
+static int n_expressions;
+static int n_lines;
+static int loops = BENCH_LOOPS;
+static int threads = 1;
+
+__attribute__((noreturn))
+static void help_bench()
+{
+    print_header();
+    print_out("  %s: -[hd] [-t threads] [-n loops] [-p pattern] [-f file]", ARGV0);
+    print_out("    -h          This help message");
+    print_out("    -d          Execute in debug mode. This parameter");
+    print_out("                can be specified multiple times");
+    print_out("                to increase the debug level.");
+    print_out("    -t <n>      Number of threads (default: 1)");
+    print_out("    -n <n>      Times each thread matches the lines (default: %d)", BENCH_LOOPS);
+    print_out("    -p <regex>  PCRE2 pattern, it can be repeated (default: a set alike to the ruleset)");
+    print_out("    -f <file>   File with the lines to match (default: a set of log lines)");
+    print_out(" ");
+    exit(1);
+}
+
+static unsigned long long bench_nsec(const struct timespec *t0, const struct timespec *t1) {
+    return (unsigned long long)(t1->tv_sec - t0->tv_sec) * 1000000000ULL + (unsigned long long)t1->tv_nsec - (unsigned long long)t0->tv_nsec;
+}
+
+static void bench_add_pattern(const char *pattern) {
+    w_expression_t *expression = NULL;
+
+    if (n_expressions == BENCH_MAX_ITEMS) {
+        merror_exit("Too many patterns, up to %d are allowed.", BENCH_MAX_ITEMS);
+    }
+
+    w_calloc_expression_t(&expression, EXP_TYPE_PCRE2);
+
+    if (!w_expression_compile(expression, (char *)pattern, 0)) {
+        merror_exit("Invalid PCRE2 pattern: '%s'", pattern);
+    }
+
+    expressions[n_expressions++] = expression;
+}
+
+static void bench_read_lines(const char *path) {
+    char buffer[OS_MAXSTR + 1];
+    FILE *fp;
+
+    if (fp = fopen(path, "r"), !fp) {
+        merror_exit(FOPEN_ERROR, path, errno, strerror(errno));
+    }
+
+    while (n_lines < BENCH_MAX_ITEMS && fgets(buffer, sizeof(buffer), fp)) {
+        buffer[strcspn(buffer, "\r\n")] = '\0';
+        os_strdup(buffer, lines[n_lines++]);
+    }
+
+    fclose(fp);
+
+    if (n_lines == 0) {
+        merror_exit("No lines to match in '%s'", path);
+    }
+}
+
+static bool bench_match(bench_mode_t mode, pcre2_match_data *match_data, w_expression_t *expression, const char *line) {
+    pcre2_match_data *data;
+    int groups;
+
+    switch (mode) {
+        case BENCH_INTERPRETER:
+            return pcre2_match(expression->pcre2->code, (PCRE2_SPTR)line, strlen(line), 0, PCRE2_NO_JIT,
+                               match_data, NULL) > 0;
+
+        case BENCH_CREATE_EACH:
+            if (data = pcre2_match_data_create_from_pattern(expression->pcre2->code, NULL), !data) {
+                return false;
+            }
+
+            groups = pcre2_match(expression->pcre2->code, (PCRE2_SPTR)line, strlen(line), 0, 0, data, NULL);
+            pcre2_match_data_free(data);
+            return groups > 0;
+
+        default:
+            return w_expression_match(expression, line, NULL, NULL);
+    }
+}
+
+static void *bench_worker(void *arg) {
+    bench_worker_t *worker = (bench_worker_t *)arg;
+    pcre2_match_data *match_data = pcre2_match_data_create(OS_SIZE_128, NULL);
+    struct timespec t0;
+    struct timespec t1;
+    int i;
+    int j;
+    int k;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t0);
+
+    for (i = 0; i < loops; i++) {
+        for (j = 0; j < n_lines; j++) {
+            for (k = 0; k < n_expressions; k++) {
+                worker->hits += bench_match(worker->mode, match_data, expressions[k], lines[j]);
+                worker->matches++;
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t1);
+    worker->nsec = bench_nsec(&t0, &t1);
+
+    pcre2_match_data_free(match_data);
+    w_expression_release_thread_data();
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    bench_worker_t *workers;
+    unsigned long long hits[BENCH_MODES] = { 0 };
+    double nsec[BENCH_MODES] = { 0 };
+    unsigned long long matches;
+    size_t k;
+    int mode;
+    int c;
+    int i;
+
+    OS_SetName(ARGV0);
+
+    while ((c = getopt(argc, argv, "hdt:n:p:f:")) != -1) {
+        switch (c) {
+            case 'd':
+                nowDebug();
+                break;
+            case 't':
+                if (threads = atoi(optarg), threads < 1) {
+                    merror_exit("-t needs a positive number");
+                }
+                break;
+            case 'n':
+                if (loops = atoi(optarg), loops < 1) {
+                    merror_exit("-n needs a positive number");
+                }
+                break;
+            case 'p':
+                bench_add_pattern(optarg);
+                break;
+            case 'f':
+                bench_read_lines(optarg);
+                break;
+            default:
+                help_bench();
+                break;
+        }
+    }
+
+    if (n_expressions == 0) {
+        for (k = 0; k < sizeof(default_patterns) / sizeof(default_patterns[0]); k++) {
+            bench_add_pattern(default_patterns[k]);
+        }
+    }
+
+    if (n_lines == 0) {
+        for (k = 0; k < sizeof(default_lines) / sizeof(default_lines[0]); k++) {
+            os_strdup(default_lines[k], lines[n_lines++]);
+        }
+    }
+
+    for (i = 0; i < n_expressions; i++) {
+        if (!expressions[i]->pcre2->jit) {
+            mwarn("The JIT isn't available for the pattern '%s'", expressions[i]->pcre2->raw_pattern);
+        }
+    }
+
+    print_out("Matching %d lines against %d patterns, %d times on %d threads.", n_lines, n_expressions, loops, threads);
+    print_out(" ");
+
+    os_calloc(threads, sizeof(bench_worker_t), workers);
+    matches = (unsigned long long)loops * n_lines * n_expressions * threads;
+
+    for (mode = 0; mode < BENCH_MODES; mode++) {
+        w_expression_set_jit_match(mode == BENCH_EXPRESSION_JIT);
+
+        for (i = 0; i < threads; i++) {
+            memset(&workers[i], 0, sizeof(bench_worker_t));
+            workers[i].mode = mode;
+
+            if (pthread_create(&workers[i].thread, NULL, bench_worker, &workers[i]) != 0) {
+                merror_exit(THREAD_ERROR);
+            }
+        }
+
+        for (i = 0; i < threads; i++) {
+            pthread_join(workers[i].thread, NULL);
+            hits[mode] += workers[i].hits;
+            nsec[mode] += workers[i].nsec;
+        }
+
+        print_out("%-16s %8.1f ns/match (%llu matched)", mode_names[mode], matches ? nsec[mode] / matches : 0.0,
+                  hits[mode]);
+    }
+
+    os_free(workers);
+
+    for (i = 0; i < n_expressions; i++) {
+        w_free_expression_t(&expressions[i]);
+    }
+
+    for (i = 0; i < n_lines; i++) {
+        os_free(lines[i]);
+    }
+
+    for (mode = 1; mode < BENCH_MODES; mode++) {
+        if (hits[mode] != hits[0]) {
+            merror("The matches of '%s' differ from the interpreter ones.", mode_names[mode]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -65,6 +65,21 @@ void _bqueue_expand(bqueue_t * queue, size_t new_length);
  */
 void _bqueue_shrink(bqueue_t * queue, size_t new_length);
 
+/**
+ * @brief Make room for data in the queue
+ *
+ * This is a private function. If BQUEUE_WAIT is defined, it blocks until
+ * there is enough space.
+ *
+ * @param queue Pointer to a queue.
+ * @param length Number of bytes to insert.
+ * @param flags Operation options: BQUEUE_NOFLAG or BQUEUE_WAIT.
+ * @pre The lock must be acquired before calling this function.
+ * @retval 0 The data fits in the queue.
+ * @retval -1 No space available.
+ */
+int _bqueue_reserve(bqueue_t * queue, size_t length, unsigned flags);
+
 /**
  * @brief Insert data into the queue
  *
@@ -94,7 +109,7 @@ size_t _bqueue_extract(bqueue_t * queue, void * buffer, size_t buffer_len);
 /**
  * @brief Trim the queue memory and reset its state
  *
- * This is a private function.
+ * This is a private function. A fixed queue keeps its memory.
  *
  * @param queue Pointer to a queue.
  * @pre The lock must be acquired before calling this function.
@@ -114,6 +129,13 @@ bqueue_t * bqueue_init(size_t max_length, unsigned flags) {
     queue->max_length = max_length;
     queue->flags = flags;
 
+    if (flags & BQUEUE_FIXED) {
+        os_malloc(max_length, queue->memory);
+        queue->head = queue->tail = queue->memory;
+        queue->length = max_length;
+        queue->flags &= ~BQUEUE_SHRINK;
+    }
+
     w_mutex_init(&queue->mutex, NULL);
     w_cond_init(&queue->cond_pushed, NULL);
     w_cond_init(&queue->cond_popped, NULL);
@@ -142,34 +164,42 @@ void bqueue_destroy(bqueue_t * queue) {
 int bqueue_push(bqueue_t * queue, const void * data, size_t length, unsigned flags) {
     w_mutex_lock(&queue->mutex);
 
-    // Check if data would fit
-
-    if (length >= queue->max_length) {
+    if (_bqueue_reserve(queue, length, flags) != 0) {
         w_mutex_unlock(&queue->mutex);
         return -1;
     }
 
-    size_t used = _bqueue_used(queue);
+    _bqueue_insert(queue, data, length);
 
-    if (flags & BQUEUE_WAIT) {
-        while (length + used >= queue->max_length) {
-            w_cond_wait(&queue->cond_popped, &queue->mutex);
-            used = _bqueue_used(queue);
-        }
-    } else {
-        if (length + used >= queue->max_length) {
-            w_mutex_unlock(&queue->mutex);
-            return -1;
-        }
+    w_cond_signal(&queue->cond_pushed);
+    w_mutex_unlock(&queue->mutex);
+
+    return 0;
+}
+
+#ifndef WIN32
+// Push several buffers into the queue
+
+int bqueue_pushv(bqueue_t * queue, const struct iovec * iov, int iovcnt, unsigned flags) {
+    size_t length = 0;
+    int i;
+
+    for (i = 0; i < iovcnt; i++) {
+        length += iov[i].iov_len;
     }
 
-    // Check if data currently fits
+    w_mutex_lock(&queue->mutex);
 
-    if (length + used >= queue->length) {
-        _bqueue_expand(queue, length + used + 1);
+    if (_bqueue_reserve(queue, length, flags) != 0) {
+        w_mutex_unlock(&queue->mutex);
+        return -1;
     }
 
-    _bqueue_insert(queue, data, length);
+    for (i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > 0) {
+            _bqueue_insert(queue, iov[i].iov_base, iov[i].iov_len);
+        }
+    }
 
     w_cond_signal(&queue->cond_pushed);
     w_mutex_unlock(&queue->mutex);
@@ -177,6 +207,50 @@ int bqueue_push(bqueue_t * queue, const void * data, size_t length, unsigned fla
     return 0;
 }
 
+// Reserve space in the queue to write data in place
+
+int bqueue_reserve(bqueue_t * queue, struct iovec iov[2], size_t length, unsigned flags) {
+    w_mutex_lock(&queue->mutex);
+
+    if (_bqueue_reserve(queue, length, flags) != 0) {
+        w_mutex_unlock(&queue->mutex);
+        return -1;
+    }
+
+    // Bytes from the tail to the end of the memory
+
+    size_t tail_len = queue->length - (size_t)(queue->tail - queue->memory);
+    size_t chunk_len = length < tail_len ? length : tail_len;
+
+    iov[0].iov_base = queue->tail;
+    iov[0].iov_len = chunk_len;
+    iov[1].iov_base = queue->memory;
+    iov[1].iov_len = length - chunk_len;
+
+    queue->reserved = length;
+
+    // The lock is released by bqueue_commit()
+    return 0;
+}
+
+// Publish the data written into the reserved space
+
+void bqueue_commit(bqueue_t * queue, size_t length) {
+    if (length > queue->reserved) {
+        length = queue->reserved;
+    }
+
+    queue->reserved = 0;
+
+    if (length > 0) {
+        queue->tail = queue->memory + (queue->tail - queue->memory + length) % queue->length;
+        w_cond_signal(&queue->cond_pushed);
+    }
+
+    w_mutex_unlock(&queue->mutex);
+}
+#endif
+
 // Get and remove data from the queue
 
 size_t bqueue_pop(bqueue_t * queue, void * buffer, size_t length, unsigned flags) {
@@ -234,6 +308,34 @@ size_t bqueue_peek(bqueue_t * queue, char * buffer, size_t length, unsigned flag
     return write_len;
 }
 
+#ifndef WIN32
+// Point the data of the queue
+
+size_t bqueue_peekv(bqueue_t * queue, struct iovec iov[2], size_t length) {
+    w_mutex_lock(&queue->mutex);
+
+    size_t used = _bqueue_used(queue);
+
+    if (length > used) {
+        length = used;
+    }
+
+    // Bytes from the head to the end of the memory
+
+    size_t head_len = length > 0 ? queue->length - (size_t)(queue->head - queue->memory) : 0;
+    size_t chunk_len = length < head_len ? length : head_len;
+
+    iov[0].iov_base = queue->head;
+    iov[0].iov_len = chunk_len;
+    iov[1].iov_base = queue->memory;
+    iov[1].iov_len = length - chunk_len;
+
+    w_mutex_unlock(&queue->mutex);
+
+    return length;
+}
+#endif
+
 // Drop data from the queue
 
 int bqueue_drop(bqueue_t * queue, size_t length) {
@@ -365,6 +467,37 @@ void _bqueue_shrink(bqueue_t * queue, size_t new_length) {
     queue->length = new_length;
 }
 
+// Make room for data in the queue
+
+int _bqueue_reserve(bqueue_t * queue, size_t length, unsigned flags) {
+    // Check if data would fit
+
+    if (length >= queue->max_length) {
+        return -1;
+    }
+
+    size_t used = _bqueue_used(queue);
+
+    if (flags & BQUEUE_WAIT) {
+        while (length + used >= queue->max_length) {
+            w_cond_wait(&queue->cond_popped, &queue->mutex);
+            used = _bqueue_used(queue);
+        }
+    } else {
+        if (length + used >= queue->max_length) {
+            return -1;
+        }
+    }
+
+    // Check if data currently fits
+
+    if (length + used >= queue->length) {
+        _bqueue_expand(queue, length + used + 1);
+    }
+
+    return 0;
+}
+
 // Insert data into the queue
 
 void _bqueue_insert(bqueue_t * queue, const void * data, size_t data_len) {
@@ -415,6 +548,12 @@ size_t _bqueue_extract(bqueue_t * queue, void * buffer, size_t buffer_len) {
 // Trim the queue memory and reset its state
 
 void _bqueue_trim(bqueue_t * queue) {
+    if (queue->flags & BQUEUE_FIXED) {
+        // Keep the memory and start over from the beginning, so that reservations are contiguous
+        queue->head = queue->tail = queue->memory;
+        return;
+    }
+
     free(queue->memory);
     queue->memory = queue->head = queue->tail = NULL;
     queue->length = 0;
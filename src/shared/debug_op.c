@@ -25,10 +25,27 @@ static struct{
   unsigned int log_json:1;
   unsigned int initialized:1;
   unsigned int mutex_initialized:1;
+  unsigned int async:1;
 } flags;
 
 static pthread_mutex_t logging_mutex;
 
+/* Maximum length of a formatted line in the asynchronous mode */
+#define LOG_ASYNC_LINE (OS_MAXSTR + OS_SIZE_2048)
+
+/* Asynchronous logging: the lines are queued and written in batches by a single thread */
+static struct {
+    bqueue_t * plain;       // Lines for the plain log file
+    bqueue_t * json;        // Lines for the JSON log file
+    pthread_mutex_t mutex;  // Serializes the writes and protects the condition
+    pthread_cond_t cond;    // Data available for the writer
+    int idle;               // The writer is waiting for data
+    unsigned long dropped;  // Lines discarded because the queue was full
+} async_log;
+
+/* Per-thread buffer to format the lines of the asynchronous mode, freed on thread exit */
+static pthread_key_t async_buffer;
+
 static void _log_function(int level, const char *tag, const char * file, int line, const char * func, const char *msg, bool plain_only, va_list args) __attribute__((format(printf, 5, 0))) __attribute__((nonnull));
 
 // Wrapper for the real _log_function
@@ -64,6 +81,68 @@ static void print_stderr_msg(char* timestamp, const char *tag, const char * file
 #endif
 }
 
+// Open a log file for appending, creating it with the right permissions
+
+static FILE * _log_open(const char * logfile) {
+    FILE * fp;
+
+#ifndef WIN32
+    int oldmask;
+
+    if (!IsFile(logfile)) {
+        fp = fopen(logfile, "a");
+    } else {
+        oldmask = umask(0006);
+        fp = fopen(logfile, "w");
+        umask(oldmask);
+
+        // Make sure that the group is ossec
+
+        if (fp && getuid() == 0) {
+            gid_t group;
+
+            if (group = Privsep_GetGroup(GROUPGLOBAL), group != (gid_t)-1) {
+                if (chown(logfile, 0, group)) {
+                    // Don't log anything
+                }
+            }
+        }
+    }
+#else
+    fp = fopen(logfile, "a");
+#endif
+
+    return fp;
+}
+
+// Get the formatting buffer of the current thread
+
+static char * _log_async_buffer() {
+    char * buffer = pthread_getspecific(async_buffer);
+
+    if (buffer == NULL) {
+        os_malloc(LOG_ASYNC_LINE, buffer);
+        pthread_setspecific(async_buffer, buffer);
+    }
+
+    return buffer;
+}
+
+// Queue a formatted line and wake up the writer
+
+static void _log_async_push(bqueue_t * queue, const char * line, size_t length) {
+    if (bqueue_push(queue, line, length, BQUEUE_NOFLAG) != 0) {
+        __atomic_add_fetch(&async_log.dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (__atomic_load_n(&async_log.idle, __ATOMIC_SEQ_CST)) {
+        w_mutex_lock(&async_log.mutex);
+        w_cond_signal(&async_log.cond);
+        w_mutex_unlock(&async_log.mutex);
+    }
+}
+
 static void _log_function(int level, const char *tag, const char * file, int line, const char * func, const char *msg, bool plain_only, va_list args)
 {
     va_list args2; /* For the stderr print */
@@ -71,7 +150,6 @@ static void _log_function(int level, const char *tag, const char * file, int lin
     FILE *fp;
     char jsonstr[OS_MAXSTR];
     char *output;
-    char logfile[PATH_MAX + 1];
     char * filename;
     char *timestamp = w_get_timestamp(time(NULL));
 
@@ -125,38 +203,9 @@ static void _log_function(int level, const char *tag, const char * file, int lin
        avoid the call to external libraries like cJSON. */
     if (!plain_only && flags.log_json) {
 
-#ifndef WIN32
-        int oldmask;
-
-        strncpy(logfile, LOGJSONFILE, sizeof(logfile) - 1);
-        logfile[sizeof(logfile) - 1] = '\0';
-
-        if (!IsFile(logfile)) {
-            fp = fopen(logfile, "a");
-        } else {
-            oldmask = umask(0006);
-            fp = fopen(logfile, "w");
-            umask(oldmask);
-
-            // Make sure that the group is ossec
-
-            if (fp && getuid() == 0) {
-                gid_t group;
-
-                if (group = Privsep_GetGroup(GROUPGLOBAL), group != (gid_t)-1) {
-                    if (chown(logfile, 0, group)) {
-                        // Don't log anything
-                    }
-                }
-            }
-        }
-#else
-        strncpy(logfile, LOGJSONFILE, sizeof(logfile) - 1);
-        logfile[sizeof(logfile) - 1] = '\0';
-        fp = fopen(logfile, "a");
-#endif
+        fp = flags.async ? NULL : _log_open(LOGJSONFILE);
 
-        if (fp) {
+        if (fp || flags.async) {
             cJSON *json_log = cJSON_CreateObject();
 
             vsnprintf(jsonstr, OS_MAXSTR, msg, args3);
@@ -176,51 +225,50 @@ static void _log_function(int level, const char *tag, const char * file, int lin
 
             output = cJSON_PrintUnformatted(json_log);
 
-            w_mutex_lock(&logging_mutex);
-            (void)fprintf(fp, "%s", output);
-            (void)fprintf(fp, "\n");
-            fflush(fp);
-            w_mutex_unlock(&logging_mutex);
+            if (fp) {
+                w_mutex_lock(&logging_mutex);
+                (void)fprintf(fp, "%s", output);
+                (void)fprintf(fp, "\n");
+                fflush(fp);
+                w_mutex_unlock(&logging_mutex);
+                fclose(fp);
+            } else {
+                char * buffer = _log_async_buffer();
+                int length = snprintf(buffer, LOG_ASYNC_LINE, "%s\n", output);
+                _log_async_push(async_log.json, buffer, length);
+            }
 
             cJSON_Delete(json_log);
             free(output);
-            fclose(fp);
         }
     }
 
     if (flags.log_plain) {
       /* If under chroot, log directly to /logs/ossec.log */
 
-#ifndef WIN32
-        int oldmask;
-
-        strncpy(logfile, LOGFILE, sizeof(logfile) - 1);
-        logfile[sizeof(logfile) - 1] = '\0';
+        fp = flags.async ? NULL : _log_open(LOGFILE);
 
-        if (!IsFile(logfile)) {
-            fp = fopen(logfile, "a");
-        } else {
-            oldmask = umask(0006);
-            fp = fopen(logfile, "w");
-            umask(oldmask);
+        if (flags.async) {
+            char * buffer = _log_async_buffer();
+            int length;
 
-            // Make sure that the group is ossec
+            if (dbg_flag > 0) {
+                length = snprintf(buffer, LOG_ASYNC_LINE, "%s %s[%d] %s:%d at %s(): %s: ", timestamp, tag, pid, file, line, func, strlevel[level]);
+            } else {
+                length = snprintf(buffer, LOG_ASYNC_LINE, "%s %s: %s: ", timestamp, tag, strlevel[level]);
+            }
 
-            if (fp && getuid() == 0) {
-                gid_t group;
+            if (length < LOG_ASYNC_LINE - 1) {
+                length += vsnprintf(buffer + length, LOG_ASYNC_LINE - 1 - length, msg, args);
+            }
 
-                if (group = Privsep_GetGroup(GROUPGLOBAL), group != (gid_t)-1) {
-                    if (chown(logfile, 0, group)) {
-                        // Don't log anything
-                    }
-                }
+            if (length > LOG_ASYNC_LINE - 2) {
+                length = LOG_ASYNC_LINE - 2;
             }
+
+            buffer[length++] = '\n';
+            _log_async_push(async_log.plain, buffer, length);
         }
-#else
-        strncpy(logfile, LOGFILE, sizeof(logfile) - 1);
-        logfile[sizeof(logfile) - 1] = '\0';
-        fp = fopen(logfile, "a");
-#endif
 
         /* Maybe log to syslog if the log file is not available */
         if (fp) {
@@ -277,6 +325,117 @@ void w_logging_init(){
     os_logging_config();
 }
 
+#ifndef WIN32
+// Write all the queued lines into a log file
+
+static void _log_async_write(bqueue_t * queue, const char * logfile) {
+    struct iovec iov[2];
+    size_t length;
+    ssize_t written;
+    FILE * fp = NULL;
+
+    // The queue is fixed, so the pointed memory is not moved by the producers
+    while (length = bqueue_peekv(queue, iov, SIZE_MAX), length > 0) {
+        if (fp == NULL && (fp = _log_open(logfile), fp == NULL)) {
+            bqueue_drop(queue, length);
+            break;
+        }
+
+        if (written = writev(fileno(fp), iov, iov[1].iov_len > 0 ? 2 : 1), written <= 0) {
+            bqueue_drop(queue, length);
+            break;
+        }
+
+        bqueue_drop(queue, written);
+    }
+
+    if (fp) {
+        fclose(fp);
+    }
+}
+
+// Write the queued lines of both formats
+
+static void _log_async_flush() {
+    if (!flags.async) {
+        return;
+    }
+
+    w_mutex_lock(&async_log.mutex);
+    _log_async_write(async_log.plain, LOGFILE);
+    _log_async_write(async_log.json, LOGJSONFILE);
+    w_mutex_unlock(&async_log.mutex);
+}
+
+// Log writer thread
+
+static void * _log_async_main(__attribute__((unused)) void * args) {
+    struct timespec timeout;
+
+    while (1) {
+        w_mutex_lock(&async_log.mutex);
+
+        __atomic_store_n(&async_log.idle, 1, __ATOMIC_SEQ_CST);
+
+        if (bqueue_used(async_log.plain) == 0 && bqueue_used(async_log.json) == 0) {
+            gettime(&timeout);
+            timeout.tv_sec++;
+            pthread_cond_timedwait(&async_log.cond, &async_log.mutex, &timeout);
+        }
+
+        __atomic_store_n(&async_log.idle, 0, __ATOMIC_SEQ_CST);
+
+        _log_async_write(async_log.plain, LOGFILE);
+        _log_async_write(async_log.json, LOGJSONFILE);
+        w_mutex_unlock(&async_log.mutex);
+
+        unsigned long dropped = __atomic_exchange_n(&async_log.dropped, 0, __ATOMIC_RELAXED);
+
+        if (dropped > 0) {
+            mwarn("The log buffer is full: %lu messages were dropped.", dropped);
+        }
+    }
+
+    return NULL;
+}
+
+// Start logging asynchronously
+
+int w_logging_async_start(size_t max_bytes) {
+    if (flags.async) {
+        return 0;
+    }
+
+    if (max_bytes <= LOG_ASYNC_LINE) {
+        return -1;
+    }
+
+    if (!flags.initialized) {
+        w_logging_init();
+    }
+
+    // The JSON queue is never used if that format is disabled
+    async_log.plain = bqueue_init(max_bytes, BQUEUE_FIXED);
+    async_log.json = bqueue_init(flags.log_json ? max_bytes : 2, BQUEUE_FIXED);
+    w_mutex_init(&async_log.mutex, NULL);
+    w_cond_init(&async_log.cond, NULL);
+    pthread_key_create(&async_buffer, free);
+
+    if (!CreateThread(_log_async_main, NULL)) {
+        bqueue_destroy(async_log.plain);
+        bqueue_destroy(async_log.json);
+        w_mutex_destroy(&async_log.mutex);
+        w_cond_destroy(&async_log.cond);
+        pthread_key_delete(async_buffer);
+        return -1;
+    }
+
+    atexit(_log_async_flush);
+    flags.async = 1;
+    return 0;
+}
+#endif
+
 void os_logging_config(){
   OS_XML xml;
   const char * xmlf[] = {"ossec_config", "logging", "log_format", NULL};
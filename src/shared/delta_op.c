@@ -0,0 +1,384 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+
+/* Candidates of the same hash checked for every line of the new version */
+#define W_DELTA_MAX_CANDIDATES 16
+/* Shorter matches are cheaper as literal lines than as a copy command */
+#define W_DELTA_MIN_MATCH 16
+
+typedef struct w_delta_line_t {
+    const char * data;
+    size_t size;
+    unsigned int hash;
+} w_delta_line_t;
+
+/* Output buffer */
+typedef struct w_delta_buffer_t {
+    char * data;
+    size_t size;
+    size_t capacity;
+} w_delta_buffer_t;
+
+static void w_delta_append(w_delta_buffer_t * buffer, const char * data, size_t size) {
+    if (buffer->size + size + 1 > buffer->capacity) {
+        while (buffer->size + size + 1 > buffer->capacity) {
+            buffer->capacity = buffer->capacity ? buffer->capacity * 2 : OS_SIZE_4096;
+        }
+
+        os_realloc(buffer->data, buffer->capacity, buffer->data);
+    }
+
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    buffer->data[buffer->size] = '\0';
+}
+
+static void w_delta_printf(w_delta_buffer_t * buffer, const char * command, size_t first, size_t count) {
+    char line[OS_SIZE_128];
+    int size;
+
+    if (command[0] == 'c') {
+        size = snprintf(line, sizeof(line), "c %zu %zu\n", first, count);
+    } else {
+        size = snprintf(line, sizeof(line), "a %zu\n", count);
+    }
+
+    w_delta_append(buffer, line, size);
+}
+
+/* Split a text into lines, hashing them with FNV-1a */
+static w_delta_line_t * w_delta_split(const char * text, size_t size, size_t * count) {
+    w_delta_line_t * lines = NULL;
+    size_t capacity = 0;
+    size_t n = 0;
+
+    for (size_t i = 0; i < size;) {
+        const char * end = memchr(text + i, '\n', size - i);
+        size_t length = end ? (size_t)(end - (text + i)) + 1 : size - i;
+        unsigned int hash = 2166136261u;
+
+        for (size_t j = 0; j < length; j++) {
+            hash = (hash ^ (unsigned char)text[i + j]) * 16777619u;
+        }
+
+        if (n == capacity) {
+            capacity = capacity ? capacity * 2 : 1024;
+            os_realloc(lines, capacity * sizeof(w_delta_line_t), lines);
+        }
+
+        lines[n].data = text + i;
+        lines[n].size = length;
+        lines[n].hash = hash;
+        n++;
+        i += length;
+    }
+
+    *count = n;
+    return lines;
+}
+
+static int w_delta_line_equal(const w_delta_line_t * a, const w_delta_line_t * b) {
+    return a->hash == b->hash && a->size == b->size && memcmp(a->data, b->data, a->size) == 0;
+}
+
+char * w_delta_create(const char * base, size_t base_size, const char * target, size_t target_size, size_t * delta_size) {
+    w_delta_buffer_t delta = { NULL, 0, 0 };
+    size_t base_count;
+    size_t target_count;
+    w_delta_line_t * base_lines = w_delta_split(base, base_size, &base_count);
+    w_delta_line_t * target_lines = w_delta_split(target, target_size, &target_count);
+    size_t buckets = 1;
+    size_t * heads;
+    size_t * next;
+    /* Pending copy and run of literal lines */
+    size_t copy_first = 0;
+    size_t copy_count = 0;
+    size_t literal_first = 0;
+    size_t literal_count = 0;
+
+    while (buckets < base_count * 2) {
+        buckets <<= 1;
+    }
+
+    /* Chains of the old lines by hash, in file order. SIZE_MAX ends a chain. */
+    os_malloc(buckets * sizeof(size_t), heads);
+    os_malloc((base_count + 1) * sizeof(size_t), next);
+    memset(heads, 0xff, buckets * sizeof(size_t));
+
+    for (size_t i = base_count; i-- > 0;) {
+        size_t bucket = base_lines[i].hash & (buckets - 1);
+        next[i] = heads[bucket];
+        heads[bucket] = i;
+    }
+
+    w_delta_append(&delta, W_DELTA_MAGIC, strlen(W_DELTA_MAGIC));
+
+    for (size_t j = 0; j < target_count;) {
+        size_t best_first = 0;
+        size_t best_count = 0;
+        size_t best_bytes = 0;
+        size_t candidates = 0;
+
+        /* Keep on copying if the pending copy goes on */
+        if (copy_count && copy_first + copy_count < base_count && w_delta_line_equal(&base_lines[copy_first + copy_count], &target_lines[j])) {
+            copy_count++;
+            j++;
+            continue;
+        }
+
+        for (size_t i = heads[target_lines[j].hash & (buckets - 1)]; i != SIZE_MAX && candidates < W_DELTA_MAX_CANDIDATES; i = next[i]) {
+            size_t count = 0;
+            size_t bytes = 0;
+
+            if (!w_delta_line_equal(&base_lines[i], &target_lines[j])) {
+                continue;
+            }
+
+            candidates++;
+
+            while (i + count < base_count && j + count < target_count && w_delta_line_equal(&base_lines[i + count], &target_lines[j + count])) {
+                bytes += target_lines[j + count].size;
+                count++;
+            }
+
+            if (bytes > best_bytes) {
+                best_first = i;
+                best_count = count;
+                best_bytes = bytes;
+            }
+        }
+
+        if (best_bytes >= W_DELTA_MIN_MATCH) {
+            if (copy_count) {
+                w_delta_printf(&delta, "c", copy_first, copy_count);
+            } else if (literal_count) {
+                w_delta_printf(&delta, "a", 0, literal_count);
+                w_delta_append(&delta, target_lines[literal_first].data, target_lines[j - 1].data + target_lines[j - 1].size - target_lines[literal_first].data);
+                literal_count = 0;
+            }
+
+            copy_first = best_first;
+            copy_count = best_count;
+            j += best_count;
+        } else {
+            if (copy_count) {
+                w_delta_printf(&delta, "c", copy_first, copy_count);
+                copy_count = 0;
+            }
+
+            if (!literal_count) {
+                literal_first = j;
+            }
+
+            literal_count++;
+            j++;
+        }
+    }
+
+    if (copy_count) {
+        w_delta_printf(&delta, "c", copy_first, copy_count);
+    } else if (literal_count) {
+        w_delta_printf(&delta, "a", 0, literal_count);
+        w_delta_append(&delta, target_lines[literal_first].data, target + target_size - target_lines[literal_first].data);
+    }
+
+    os_free(heads);
+    os_free(next);
+    os_free(base_lines);
+    os_free(target_lines);
+
+    *delta_size = delta.size;
+    return delta.data;
+}
+
+/* Parse a number of a command, moving the cursor past it */
+static int w_delta_number(const char ** cursor, const char * end, size_t * value) {
+    const char * p = *cursor;
+    size_t n = 0;
+
+    if (p == end || !isdigit((unsigned char)*p)) {
+        return -1;
+    }
+
+    for (; p < end && isdigit((unsigned char)*p); p++) {
+        if (n > (SIZE_MAX - 9) / 10) {
+            return -1;
+        }
+
+        n = n * 10 + (*p - '0');
+    }
+
+    *value = n;
+    *cursor = p;
+    return 0;
+}
+
+char * w_delta_apply(const char * base, size_t base_size, const char * delta, size_t delta_size, size_t * target_size) {
+    w_delta_buffer_t target = { NULL, 0, 0 };
+    const char * end = delta + delta_size;
+    const char * p = delta;
+    size_t base_count;
+    w_delta_line_t * base_lines;
+
+    if (delta_size < strlen(W_DELTA_MAGIC) || memcmp(delta, W_DELTA_MAGIC, strlen(W_DELTA_MAGIC)) != 0) {
+        return NULL;
+    }
+
+    p += strlen(W_DELTA_MAGIC);
+    base_lines = w_delta_split(base, base_size, &base_count);
+
+    /* An empty version still gets a buffer */
+    w_delta_append(&target, "", 0);
+
+    while (p < end) {
+        char command = *p;
+        size_t first = 0;
+        size_t count = 0;
+
+        if (p + 2 > end || p[1] != ' ' || (command != 'c' && command != 'a')) {
+            goto error;
+        }
+
+        p += 2;
+
+        if (command == 'c') {
+            if (w_delta_number(&p, end, &first) || p == end || *p++ != ' ' || w_delta_number(&p, end, &count)) {
+                goto error;
+            }
+        } else if (w_delta_number(&p, end, &count)) {
+            goto error;
+        }
+
+        if (p == end || *p++ != '\n') {
+            goto error;
+        }
+
+        if (command == 'c') {
+            if (first > base_count || count > base_count - first) {
+                goto error;
+            }
+
+            if (count) {
+                const char * from = base_lines[first].data;
+                const char * to = base_lines[first + count - 1].data + base_lines[first + count - 1].size;
+                w_delta_append(&target, from, to - from);
+            }
+        } else {
+            const char * from = p;
+
+            for (; count; count--) {
+                const char * eol = memchr(p, '\n', end - p);
+
+                if (eol) {
+                    p = eol + 1;
+                } else if (count == 1 && p < end) {
+                    p = end;
+                } else {
+                    goto error;
+                }
+            }
+
+            w_delta_append(&target, from, p - from);
+        }
+    }
+
+    os_free(base_lines);
+    *target_size = target.size;
+    return target.data;
+
+error:
+    os_free(base_lines);
+    os_free(target.data);
+    return NULL;
+}
+
+/* Load a file in text mode */
+static char * w_delta_load(const char * path, size_t * size) {
+    w_delta_buffer_t buffer = { NULL, 0, 0 };
+    char chunk[OS_SIZE_8192];
+    size_t n;
+    FILE * fp;
+
+    if (fp = fopen(path, "r"), !fp) {
+        mdebug1(FOPEN_ERROR, path, errno, strerror(errno));
+        return NULL;
+    }
+
+    w_delta_append(&buffer, "", 0);
+
+    while (n = fread(chunk, 1, sizeof(chunk), fp), n > 0) {
+        w_delta_append(&buffer, chunk, n);
+    }
+
+    if (ferror(fp)) {
+        mdebug1(FREAD_ERROR, path, errno, strerror(errno));
+        os_free(buffer.data);
+    }
+
+    fclose(fp);
+    *size = buffer.size;
+    return buffer.data;
+}
+
+int w_delta_apply_file(const char * base_path, const char * delta_path, const char * output_path) {
+    char tmp_path[PATH_MAX + 1];
+    size_t base_size;
+    size_t delta_size;
+    size_t target_size = 0;
+    char * base = NULL;
+    char * delta = NULL;
+    char * target = NULL;
+    FILE * fp = NULL;
+    int retval = -1;
+
+    if (base = w_delta_load(base_path, &base_size), !base) {
+        goto end;
+    }
+
+    if (delta = w_delta_load(delta_path, &delta_size), !delta) {
+        goto end;
+    }
+
+    if (target = w_delta_apply(base, base_size, delta, delta_size, &target_size), !target) {
+        mdebug1("Delta '%s' doesn't fit the file '%s'.", delta_path, base_path);
+        goto end;
+    }
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", output_path);
+
+    if (fp = fopen(tmp_path, "w"), !fp) {
+        mdebug1(FOPEN_ERROR, tmp_path, errno, strerror(errno));
+        goto end;
+    }
+
+    if (fwrite(target, 1, target_size, fp) != target_size) {
+        mdebug1(FWRITE_ERROR, tmp_path, errno, strerror(errno));
+        fclose(fp);
+        unlink(tmp_path);
+        goto end;
+    }
+
+    fclose(fp);
+
+    if (rename_ex(tmp_path, output_path) != 0) {
+        unlink(tmp_path);
+        goto end;
+    }
+
+    retval = 0;
+
+end:
+    os_free(base);
+    os_free(delta);
+    os_free(target);
+    return retval;
+}
@@ -14,6 +14,99 @@
 #include "unit_tests/wrappers/externals/pcre2/pcre2_wrappers.h"
 #endif
 
+#define PCRE2_JIT_STACK_START   (32 * 1024)
+#define PCRE2_JIT_STACK_MAX     (512 * 1024)
+
+/* Matching data of a thread, reused by every PCRE2 expression it matches */
+typedef struct {
+    pcre2_match_data * match_data;          ///< Sized for the pattern with most groups matched so far
+    uint32_t ovector_pairs;
+    pcre2_match_context * match_context;    ///< Context with the JIT stack assigned
+    pcre2_jit_stack * jit_stack;
+} w_pcre2_thread_data_t;
+
+static __thread w_pcre2_thread_data_t * pcre2_thread_data;
+static pthread_key_t pcre2_thread_key;
+static pthread_once_t pcre2_thread_once = PTHREAD_ONCE_INIT;
+static bool pcre2_jit_match_enabled = true;
+
+static void w_expression_thread_data_free(void * data) {
+
+    w_pcre2_thread_data_t * thread_data = data;
+
+    if (thread_data == NULL) {
+        return;
+    }
+
+    if (thread_data->match_data) {
+        pcre2_match_data_free(thread_data->match_data);
+    }
+
+    pcre2_match_context_free(thread_data->match_context);
+    pcre2_jit_stack_free(thread_data->jit_stack);
+    os_free(thread_data);
+}
+
+static void w_expression_thread_key_create(void) {
+    pthread_key_create(&pcre2_thread_key, w_expression_thread_data_free);
+}
+
+/* Get the matching data of the calling thread, grown to fit the pattern. NULL on failure. */
+static w_pcre2_thread_data_t * w_expression_thread_data(const w_pcre2_code_t * pcre2) {
+
+    w_pcre2_thread_data_t * thread_data = pcre2_thread_data;
+    uint32_t ovector_pairs = pcre2->ovector_pairs;
+    uint32_t captures = 0;
+
+    if (thread_data == NULL) {
+        os_calloc(1, sizeof(w_pcre2_thread_data_t), thread_data);
+        pthread_once(&pcre2_thread_once, w_expression_thread_key_create);
+        pthread_setspecific(pcre2_thread_key, thread_data);
+        pcre2_thread_data = thread_data;
+    }
+
+    // Not compiled by w_expression_compile()
+    if (ovector_pairs == 0) {
+        ovector_pairs = pcre2_pattern_info(pcre2->code, PCRE2_INFO_CAPTURECOUNT, &captures) == 0 ? captures + 1 : 1;
+    }
+
+    if (thread_data->ovector_pairs < ovector_pairs) {
+        if (thread_data->match_data) {
+            pcre2_match_data_free(thread_data->match_data);
+        }
+
+        thread_data->ovector_pairs = 0;
+
+        if (thread_data->match_data = pcre2_match_data_create(ovector_pairs, NULL), !thread_data->match_data) {
+            return NULL;
+        }
+
+        thread_data->ovector_pairs = ovector_pairs;
+    }
+
+    // Without its own stack, the JIT is limited to 32K of the machine stack
+    if (pcre2->jit && thread_data->match_context == NULL) {
+        if (thread_data->match_context = pcre2_match_context_create(NULL), thread_data->match_context) {
+            thread_data->jit_stack = pcre2_jit_stack_create(PCRE2_JIT_STACK_START, PCRE2_JIT_STACK_MAX, NULL);
+            pcre2_jit_stack_assign(thread_data->match_context, NULL, thread_data->jit_stack);
+        }
+    }
+
+    return thread_data;
+}
+
+void w_expression_release_thread_data(void) {
+
+    w_expression_thread_data_free(pcre2_thread_data);
+    pcre2_thread_data = NULL;
+    pthread_once(&pcre2_thread_once, w_expression_thread_key_create);
+    pthread_setspecific(pcre2_thread_key, NULL);
+}
+
+void w_expression_set_jit_match(bool enabled) {
+    pcre2_jit_match_enabled = enabled;
+}
+
 void w_calloc_expression_t(w_expression_t ** var, w_exp_type_t type) {
 
     os_calloc(1, sizeof(w_expression_t), *var);
@@ -166,12 +259,24 @@ bool w_expression_compile(w_expression_t * expression, char * pattern, int flags
             break;
 
         case EXP_TYPE_PCRE2:
-            expression->pcre2->code = pcre2_compile((PCRE2_SPTR) pattern, PCRE2_ZERO_TERMINATED,
-                                               0, &errornumber, &erroroffset, NULL);
+            if (expression->pcre2->code = w_expression_cache_get(pattern), !expression->pcre2->code) {
+                expression->pcre2->code = pcre2_compile((PCRE2_SPTR) pattern, PCRE2_ZERO_TERMINATED,
+                                                   0, &errornumber, &erroroffset, NULL);
+                w_expression_cache_add(pattern, expression->pcre2->code);
+            }
             os_strdup(pattern, expression->pcre2->raw_pattern);
 
             if (!expression->pcre2->code) {
                 retval = false;
+            } else {
+                uint32_t captures = 0;
+
+                if (pcre2_pattern_info(expression->pcre2->code, PCRE2_INFO_CAPTURECOUNT, &captures) == 0) {
+                    expression->pcre2->ovector_pairs = captures + 1;
+                }
+
+                // Falls back to the interpreter if the JIT is not available
+                expression->pcre2->jit = pcre2_jit_compile(expression->pcre2->code, PCRE2_JIT_COMPLETE) == 0;
             }
 
             break;
@@ -194,7 +299,7 @@ bool w_expression_match(w_expression_t * expression, const char * str_test, cons
     const char * ret_match = NULL;
 
     regex_matching status_match = { .sub_strings = NULL };
-    pcre2_match_data * match_data = NULL;
+    w_pcre2_thread_data_t * thread_data = NULL;
     PCRE2_SIZE * ovector = NULL;
     int captured_groups = 0;
 
@@ -224,23 +329,29 @@ bool w_expression_match(w_expression_t * expression, const char * str_test, cons
 
         case EXP_TYPE_PCRE2:
 
-            if (match_data = pcre2_match_data_create_from_pattern(expression->pcre2->code, NULL), !match_data) {
+            if (thread_data = w_expression_thread_data(expression->pcre2), !thread_data) {
                 break;
             }
-            captured_groups = pcre2_match(expression->pcre2->code, (PCRE2_SPTR) str_test,
-                                          strlen(str_test), 0, 0, match_data, NULL);
+
+            if (expression->pcre2->jit && pcre2_jit_match_enabled) {
+                captured_groups = pcre2_jit_match(expression->pcre2->code, (PCRE2_SPTR) str_test, strlen(str_test),
+                                                  0, 0, thread_data->match_data, thread_data->match_context);
+            } else {
+                captured_groups = pcre2_match(expression->pcre2->code, (PCRE2_SPTR) str_test, strlen(str_test),
+                                              0, 0, thread_data->match_data, thread_data->match_context);
+            }
 
             /* successful match */
             if (captured_groups > 0) {
                 retval = true;
-                ovector = pcre2_get_ovector_pointer(match_data);
+                ovector = pcre2_get_ovector_pointer(thread_data->match_data);
                 ret_match = str_test + ovector[1] - 1;
 
                 if (regex_match) {
-                    w_expression_PCRE2_fill_regex_match(captured_groups, str_test, match_data, regex_match);
+                    w_expression_PCRE2_fill_regex_match(captured_groups, str_test, thread_data->match_data,
+                                                        regex_match);
                 }
             }
-            pcre2_match_data_free(match_data);
             break;
 
         case EXP_TYPE_STRING:
@@ -355,3 +466,430 @@ const char * w_expression_get_regex_type(w_expression_t * expression) {
 
     return retval;
 }
+
+/* Whether a PCRE2 pattern keeps its meaning inside a group of an alternation */
+static bool w_expression_pcre2_mergeable(w_expression_t * expression) {
+
+    const char * pattern = expression->pcre2->raw_pattern;
+    uint32_t backrefs = 0;
+    uint32_t names = 0;
+
+    if (expression->negate || !expression->pcre2->code || !pattern) {
+        return false;
+    }
+
+    // Group numbers shift in the alternation
+    if (pcre2_pattern_info(expression->pcre2->code, PCRE2_INFO_BACKREFMAX, &backrefs) != 0 || backrefs > 0
+        || pcre2_pattern_info(expression->pcre2->code, PCRE2_INFO_NAMECOUNT, &names) != 0 || names > 0) {
+        return false;
+    }
+
+    // Subroutine calls, verbs, quoting and extended mode may reach out of the group
+    if (strstr(pattern, "\\g") || strstr(pattern, "\\Q") || strstr(pattern, "(*") || strstr(pattern, "(?R")
+        || strstr(pattern, "(?&") || strstr(pattern, "(?P>")) {
+        return false;
+    }
+
+    for (const char * c = strstr(pattern, "(?"); c; c = strstr(c + 2, "(?")) {
+        const char * option = c + 2;
+
+        if (isdigit((unsigned char)*option) || ((*option == '+' || *option == '-') && isdigit((unsigned char)option[1]))) {
+            return false;
+        }
+
+        for (; isalpha((unsigned char)*option) || *option == '-' || *option == '^'; option++) {
+            if (*option == 'x') {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool w_expression_merge_pcre2(OSList * list) {
+
+    OSListNode * node_it;
+    OSListNode * next;
+    w_expression_t * expression;
+    w_expression_t * merged = NULL;
+    char * pattern = NULL;
+    int count = 0;
+
+    if (list == NULL) {
+        return false;
+    }
+
+    OSList_foreach(node_it, list) {
+        expression = node_it->data;
+
+        if (expression->exp_type == EXP_TYPE_PCRE2 && w_expression_pcre2_mergeable(expression)) {
+            wm_strcat(&pattern, "(?:", count > 0 ? '|' : '\0');
+            wm_strcat(&pattern, expression->pcre2->raw_pattern, '\0');
+            wm_strcat(&pattern, ")", '\0');
+            count++;
+        }
+    }
+
+    if (count < 2) {
+        os_free(pattern);
+        return false;
+    }
+
+    w_calloc_expression_t(&merged, EXP_TYPE_PCRE2);
+
+    if (!w_expression_compile(merged, pattern, 0)) {
+        w_free_expression_t(&merged);
+        os_free(pattern);
+        return false;
+    }
+
+    os_free(pattern);
+
+    for (node_it = OSList_GetFirstNode(list); node_it; node_it = next) {
+        next = OSList_GetNext(list, node_it);
+        expression = node_it->data;
+
+        if (expression->exp_type == EXP_TYPE_PCRE2 && w_expression_pcre2_mergeable(expression)) {
+            w_free_expression_t(&expression);
+            OSList_DeleteThisNode(list, node_it);
+        }
+    }
+
+    OSList_InsertData(list, NULL, merged);
+
+    return true;
+}
+
+/* PCRE2 patterns cache */
+
+#define PCRE2_CACHE_MAGIC   "WPC2"
+#define PCRE2_CACHE_VERSION ((uint32_t)(PCRE2_MAJOR * 1000 + PCRE2_MINOR))
+#define PCRE2_CACHE_MAX_PATTERN 65536
+#define PCRE2_CACHE_CHECKSUM_SEED 2166136261u
+
+/* Header of the cache file */
+typedef struct {
+    char magic[4];
+    uint32_t version;       ///< PCRE2 library that serialized the codes
+    uint32_t count;         ///< Number of patterns
+    uint32_t checksum;      ///< FNV-1a of the records that follow the header
+} w_pcre2_cache_header_t;
+
+/* Header of each pattern, followed by the pattern and its serialized code */
+typedef struct {
+    uint32_t pattern_size;
+    uint32_t code_size;
+} w_pcre2_cache_record_t;
+
+typedef struct {
+    pcre2_code * code;      ///< Compiled pattern, without JIT data
+    bool used;              ///< Compiled since the cache was loaded
+} w_pcre2_cache_entry_t;
+
+static OSHash * pcre2_cache;
+static bool pcre2_cache_changed;
+static bool pcre2_cache_sealed;
+static pthread_mutex_t pcre2_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void w_expression_cache_free_entry(void * data) {
+
+    w_pcre2_cache_entry_t * entry = data;
+
+    pcre2_code_free(entry->code);
+    os_free(entry);
+}
+
+static uint32_t w_expression_cache_checksum(uint32_t hash, const void * data, size_t size) {
+
+    const uint8_t * bytes = data;
+
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+static void w_expression_cache_insert(const char * pattern, pcre2_code * code, bool used) {
+
+    w_pcre2_cache_entry_t * entry;
+
+    os_calloc(1, sizeof(w_pcre2_cache_entry_t), entry);
+    entry->code = code;
+    entry->used = used;
+
+    if (OSHash_Add(pcre2_cache, pattern, entry) != 2) {
+        w_expression_cache_free_entry(entry);
+    }
+}
+
+int w_expression_cache_load(const char * path) {
+
+    w_pcre2_cache_header_t header;
+    w_pcre2_cache_record_t record;
+    pcre2_code * code = NULL;
+    uint8_t * code_data = NULL;
+    uint8_t * records = NULL;
+    size_t records_size;
+    size_t offset = 0;
+    long file_size;
+    FILE * fp = NULL;
+    int retval = -1;
+
+    w_mutex_lock(&pcre2_cache_mutex);
+
+    if (pcre2_cache == NULL) {
+        if (pcre2_cache = OSHash_Create(), pcre2_cache == NULL) {
+            w_mutex_unlock(&pcre2_cache_mutex);
+            return -1;
+        }
+        OSHash_SetFreeDataPointer(pcre2_cache, w_expression_cache_free_entry);
+    }
+
+    pcre2_cache_changed = true;
+    pcre2_cache_sealed = false;
+
+    if (fp = wfopen(path, "rb"), fp == NULL) {
+        goto end;
+    }
+
+    if (fread(&header, sizeof(header), 1, fp) != 1 || memcmp(header.magic, PCRE2_CACHE_MAGIC, sizeof(header.magic))
+        || header.version != PCRE2_CACHE_VERSION) {
+        goto end;
+    }
+
+    // A truncated or corrupted file is refused before decoding any code
+    if (file_size = get_fp_size(fp), file_size <= (long)sizeof(header)) {
+        goto end;
+    }
+
+    records_size = file_size - sizeof(header);
+    os_malloc(records_size, records);
+
+    if (fread(records, records_size, 1, fp) != 1
+        || w_expression_cache_checksum(PCRE2_CACHE_CHECKSUM_SEED, records, records_size) != header.checksum) {
+        goto end;
+    }
+
+    for (uint32_t i = 0; i < header.count; i++) {
+        const char * pattern;
+
+        if (records_size - offset < sizeof(record)) {
+            goto end;
+        }
+
+        memcpy(&record, records + offset, sizeof(record));
+        offset += sizeof(record);
+
+        if (record.pattern_size == 0 || record.pattern_size > PCRE2_CACHE_MAX_PATTERN || record.code_size == 0
+            || records_size - offset < (size_t)record.pattern_size + record.code_size) {
+            goto end;
+        }
+
+        pattern = (const char *)records + offset;
+
+        if (pattern[record.pattern_size - 1] != '\0') {
+            goto end;
+        }
+
+        // Copied to keep the serialized code aligned
+        os_realloc(code_data, record.code_size, code_data);
+        memcpy(code_data, records + offset + record.pattern_size, record.code_size);
+        offset += record.pattern_size + record.code_size;
+
+        // Codes serialized by another build of the library are refused here
+        if (pcre2_serialize_get_number_of_codes(code_data) != 1
+            || pcre2_serialize_decode(&code, 1, code_data, NULL) != 1) {
+            goto end;
+        }
+
+        w_expression_cache_insert(pattern, code, false);
+    }
+
+    pcre2_cache_changed = false;
+    retval = header.count;
+
+end:
+    if (fp) {
+        fclose(fp);
+    }
+
+    // A missing or broken file is written again with the patterns compiled
+    if (retval < 0 && OSHash_Get_Elem_ex(pcre2_cache) > 0) {
+        OSHash_Clean(pcre2_cache, w_expression_cache_free_entry);
+
+        if (pcre2_cache = OSHash_Create(), pcre2_cache) {
+            OSHash_SetFreeDataPointer(pcre2_cache, w_expression_cache_free_entry);
+        }
+    }
+
+    os_free(code_data);
+    os_free(records);
+    w_mutex_unlock(&pcre2_cache_mutex);
+
+    return retval;
+}
+
+int w_expression_cache_save(const char * path) {
+
+    w_pcre2_cache_header_t header = { .magic = PCRE2_CACHE_MAGIC, .version = PCRE2_CACHE_VERSION,
+                                      .checksum = PCRE2_CACHE_CHECKSUM_SEED };
+    w_pcre2_cache_record_t record;
+    char tmp_path[PATH_MAX];
+    uint8_t * code_data = NULL;
+    PCRE2_SIZE code_size = 0;
+    OSHashNode * node;
+    FILE * fp = NULL;
+    unsigned int i;
+    int retval = -1;
+
+    w_mutex_lock(&pcre2_cache_mutex);
+
+    if (pcre2_cache == NULL) {
+        w_mutex_unlock(&pcre2_cache_mutex);
+        return -1;
+    }
+
+    // The cache keeps the current patterns only, those compiled later are not added
+    pcre2_cache_sealed = true;
+
+    for (node = OSHash_Begin(pcre2_cache, &i); node; node = OSHash_Next(pcre2_cache, &i, node)) {
+        if (((w_pcre2_cache_entry_t *)node->data)->used) {
+            header.count++;
+        } else {
+            pcre2_cache_changed = true;
+        }
+    }
+
+    if (!pcre2_cache_changed) {
+        w_mutex_unlock(&pcre2_cache_mutex);
+        return 0;
+    }
+
+    // No PCRE2 pattern is compiled anymore
+    if (header.count == 0) {
+        unlink(path);
+        pcre2_cache_changed = false;
+        w_mutex_unlock(&pcre2_cache_mutex);
+        return 0;
+    }
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    if (fp = wfopen(tmp_path, "wb"), fp == NULL) {
+        w_mutex_unlock(&pcre2_cache_mutex);
+        return -1;
+    }
+
+    if (fwrite(&header, sizeof(header), 1, fp) != 1) {
+        goto end;
+    }
+
+    /* Each code is serialized on its own: the decoded ones have their own
+     * character tables and PCRE2 only serializes codes sharing them. */
+    for (node = OSHash_Begin(pcre2_cache, &i); node; node = OSHash_Next(pcre2_cache, &i, node)) {
+        w_pcre2_cache_entry_t * entry = node->data;
+
+        if (!entry->used) {
+            continue;
+        }
+
+        if (pcre2_serialize_encode((const pcre2_code **)&entry->code, 1, &code_data, &code_size, NULL) != 1) {
+            goto end;
+        }
+
+        record.pattern_size = strlen(node->key) + 1;
+        record.code_size = code_size;
+
+        if (fwrite(&record, sizeof(record), 1, fp) != 1 || fwrite(node->key, record.pattern_size, 1, fp) != 1
+            || fwrite(code_data, code_size, 1, fp) != 1) {
+            goto end;
+        }
+
+        header.checksum = w_expression_cache_checksum(header.checksum, &record, sizeof(record));
+        header.checksum = w_expression_cache_checksum(header.checksum, node->key, record.pattern_size);
+        header.checksum = w_expression_cache_checksum(header.checksum, code_data, code_size);
+
+        pcre2_serialize_free(code_data);
+        code_data = NULL;
+    }
+
+    // The header is written again with the checksum of the records
+    if (fseek(fp, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, fp) != 1) {
+        goto end;
+    }
+
+    if (fclose(fp) == 0) {
+        fp = NULL;
+
+        if (rename(tmp_path, path) == 0) {
+            pcre2_cache_changed = false;
+            retval = 0;
+        }
+    }
+
+end:
+    if (fp) {
+        fclose(fp);
+    }
+
+    if (retval < 0) {
+        unlink(tmp_path);
+    }
+
+    if (code_data) {
+        pcre2_serialize_free(code_data);
+    }
+
+    w_mutex_unlock(&pcre2_cache_mutex);
+
+    return retval;
+}
+
+void w_expression_cache_free(void) {
+
+    w_mutex_lock(&pcre2_cache_mutex);
+
+    if (pcre2_cache) {
+        OSHash_Free(pcre2_cache);
+        pcre2_cache = NULL;
+    }
+
+    w_mutex_unlock(&pcre2_cache_mutex);
+}
+
+pcre2_code * w_expression_cache_get(const char * pattern) {
+
+    w_pcre2_cache_entry_t * entry;
+    pcre2_code * code = NULL;
+
+    w_mutex_lock(&pcre2_cache_mutex);
+
+    if (pcre2_cache && (entry = OSHash_Get(pcre2_cache, pattern), entry)) {
+        code = pcre2_code_copy(entry->code);
+        entry->used = true;
+    }
+
+    w_mutex_unlock(&pcre2_cache_mutex);
+
+    return code;
+}
+
+void w_expression_cache_add(const char * pattern, const pcre2_code * code) {
+
+    pcre2_code * copy;
+
+    if (code == NULL) {
+        return;
+    }
+
+    w_mutex_lock(&pcre2_cache_mutex);
+
+    if (pcre2_cache && !pcre2_cache_sealed && (copy = pcre2_code_copy(code), copy)) {
+        w_expression_cache_insert(pattern, copy, true);
+        pcre2_cache_changed = true;
+    }
+
+    w_mutex_unlock(&pcre2_cache_mutex);
+}
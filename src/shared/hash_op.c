@@ -10,18 +10,578 @@
 
 /* Common API for dealing with hashes/maps */
 
+/* The nodes are kept in an open-addressing table, with a metadata byte per
+ * slot: empty, deleted, or 7 bits of the hash of its key. The probing reads
+ * the metadata of 8 slots at once, so a key is rarely compared more than once.
+ * When the table is full, a new one is allocated and every insertion moves
+ * some entries from the previous table, which is also read until it's empty.
+ *
+ * A concurrent hash is split in stripes, independent tables selected by the
+ * highest bits of the hash of the keys, each one with its own lock. Their
+ * lookups don't lock them: a sequence counter tells whether a change
+ * overlapped the lookup, and the removed memory is kept until no reader
+ * may be using it.
+ */
+
 #include "shared.h"
 
-static unsigned int _os_genhash(const OSHash *self, const char *key) __attribute__((nonnull));
+#define OSHASH_MIN_SLOTS    32      // Slots of a new table
+#define OSHASH_GROUP        8       // Slots whose metadata is read at once
+#define OSHASH_MIGRATE      32      // Slots of the previous table moved on each insertion
+#define OSHASH_MAX_STRIPES  1024    // Stripes of a concurrent hash
+#define OSHASH_RETIRED_MAX  64      // Removed nodes and tables of a stripe before trying to free them
+
+#define OSHASH_EMPTY        0x80
+#define OSHASH_DELETED      0xFE
+
+#define OSHASH_LSB          0x0101010101010101ULL
+#define OSHASH_MSB          0x8080808080808080ULL
+
+static uint64_t _os_genhash(const OSHash *self, const char *key) __attribute__((nonnull));
 
 int _OSHash_Add(OSHash *self, const char *key, void *data, int update);
 
-/* Create hash
- * Returns NULL on error
+/* wyhash (final version 4) */
+
+static const uint64_t _wyp[4] = { 0x2d358dccaa6c78a5ULL, 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL, 0x4d5a2da51de1aa47ULL };
+
+static void _wymum(uint64_t *a, uint64_t *b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = *a;
+    r *= *b;
+    *a = (uint64_t)r;
+    *b = (uint64_t)(r >> 64);
+#else
+    const uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+    const uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const uint64_t t = rl + (rm0 << 32);
+    uint64_t lo = t + (rm1 << 32);
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + (t < rl) + (lo < t);
+    *a = lo;
+    *b = hi;
+#endif
+}
+
+static uint64_t _wymix(uint64_t a, uint64_t b) {
+    _wymum(&a, &b);
+    return a ^ b;
+}
+
+static uint64_t _wyr8(const unsigned char *p) {
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24 |
+           (uint64_t)p[4] << 32 | (uint64_t)p[5] << 40 | (uint64_t)p[6] << 48 | (uint64_t)p[7] << 56;
+}
+
+static uint64_t _wyr4(const unsigned char *p) {
+    return (uint64_t)p[0] | (uint64_t)p[1] << 8 | (uint64_t)p[2] << 16 | (uint64_t)p[3] << 24;
+}
+
+static uint64_t _wyr3(const unsigned char *p, size_t k) {
+    return (uint64_t)p[0] << 16 | (uint64_t)p[k >> 1] << 8 | p[k - 1];
+}
+
+static uint64_t _wyhash(const void *key, size_t len, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)key;
+    uint64_t a;
+    uint64_t b;
+
+    seed ^= _wymix(seed ^ _wyp[0], _wyp[1]);
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (_wyr4(p) << 32) | _wyr4(p + ((len >> 3) << 2));
+            b = (_wyr4(p + len - 4) << 32) | _wyr4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = _wyr3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+
+        if (i > 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+
+            do {
+                seed = _wymix(_wyr8(p) ^ _wyp[1], _wyr8(p + 8) ^ seed);
+                see1 = _wymix(_wyr8(p + 16) ^ _wyp[2], _wyr8(p + 24) ^ see1);
+                see2 = _wymix(_wyr8(p + 32) ^ _wyp[3], _wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+
+            seed ^= see1 ^ see2;
+        }
+
+        while (i > 16) {
+            seed = _wymix(_wyr8(p) ^ _wyp[1], _wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+
+        a = _wyr8(p + i - 16);
+        b = _wyr8(p + i - 8);
+    }
+
+    a ^= _wyp[1];
+    b ^= seed;
+    _wymum(&a, &b);
+
+    return _wymix(a ^ _wyp[0] ^ len, b ^ _wyp[1]);
+}
+
+/* Metadata of a group of slots, the first one in the lowest byte */
+static uint64_t _os_group(const unsigned char *ctrl) {
+    return _wyr8(ctrl);
+}
+
+/* Same, while the stripe may be changed by a writer */
+static uint64_t _os_group_lockfree(const unsigned char *ctrl) {
+    uint64_t group = 0;
+    int i;
+
+    for (i = OSHASH_GROUP - 1; i >= 0; i--) {
+        group = group << 8 | __atomic_load_n(&ctrl[i], __ATOMIC_RELAXED);
+    }
+
+    return group;
+}
+
+/* Slots whose metadata may be h2. The keys of the slots must be compared. */
+static uint64_t _os_group_match(uint64_t group, unsigned int h2) {
+    const uint64_t x = group ^ (OSHASH_LSB * h2);
+    return (x - OSHASH_LSB) & ~x & OSHASH_MSB;
+}
+
+static uint64_t _os_group_empty(uint64_t group) {
+    return group & ~(group << 6) & OSHASH_MSB;
+}
+
+static uint64_t _os_group_free(uint64_t group) {
+    return group & ~(group << 7) & OSHASH_MSB;
+}
+
+static unsigned int _os_group_first(uint64_t mask) {
+    return (unsigned int)__builtin_ctzll(mask) >> 3;
+}
+
+/* Find the slot of a key in a table, -1 if it's not there */
+static long _os_find(OSHashNode * const *table, const unsigned char *ctrl, unsigned int rows, uint64_t hash_key, const char *key) {
+    const unsigned int groups = (rows + 1) / OSHASH_GROUP - 1;
+    unsigned int g = (unsigned int)(hash_key >> 7) & groups;
+    unsigned int step;
+
+    /* Triangular probing visits every group */
+    for (step = 0; step <= groups; step++) {
+        const uint64_t group = _os_group(ctrl + g * OSHASH_GROUP);
+        uint64_t match;
+
+        for (match = _os_group_match(group, hash_key & 0x7F); match; match &= match - 1) {
+            const unsigned int i = g * OSHASH_GROUP + _os_group_first(match);
+
+            if (table[i] && table[i]->key && strcmp(table[i]->key, key) == 0) {
+                return i;
+            }
+        }
+
+        if (_os_group_empty(group)) {
+            break;
+        }
+
+        g = (g + step + 1) & groups;
+    }
+
+    return -1;
+}
+
+/* Find the node of a key without locking the stripe. Nodes in the table are
+ * never freed while a reader is in its epoch.
  */
-OSHash *OSHash_Create()
-{
-    unsigned int i = 0;
+static OSHashNode *_os_find_lockfree(OSHashNode * const *table, const unsigned char *ctrl, unsigned int rows, uint64_t hash_key, const char *key) {
+    const unsigned int groups = (rows + 1) / OSHASH_GROUP - 1;
+    unsigned int g = (unsigned int)(hash_key >> 7) & groups;
+    unsigned int step;
+
+    for (step = 0; step <= groups; step++) {
+        const uint64_t group = _os_group_lockfree(ctrl + g * OSHASH_GROUP);
+        uint64_t match;
+
+        for (match = _os_group_match(group, hash_key & 0x7F); match; match &= match - 1) {
+            OSHashNode *node = __atomic_load_n(&table[g * OSHASH_GROUP + _os_group_first(match)], __ATOMIC_ACQUIRE);
+
+            if (node && node->key && strcmp(node->key, key) == 0) {
+                return node;
+            }
+        }
+
+        if (_os_group_empty(group)) {
+            break;
+        }
+
+        g = (g + step + 1) & groups;
+    }
+
+    return NULL;
+}
+
+/* Lock-free readers and reclamation of the memory they may be using
+ *
+ * Every thread that reads a stripe without locking it announces the global
+ * epoch in its record first. Memory removed from a stripe is retired with
+ * the epoch of its removal, and freed once every reader in progress has
+ * announced a later epoch.
+ */
+
+typedef struct _os_reader {
+    struct _os_reader *next;
+    uint64_t epoch;             // 0 if the thread is not reading
+    int in_use;                 // Taken by a running thread
+} os_reader_t;
+
+typedef struct _os_retired {
+    struct _os_retired *next;
+    void *ptr;
+    void *ctrl;                 // Metadata of a retired table, NULL for nodes
+    uint64_t epoch;
+} os_retired_t;
+
+static os_reader_t *_os_readers;
+static uint64_t _os_epoch = 1;
+static pthread_key_t _os_reader_key;
+static pthread_once_t _os_reader_once = PTHREAD_ONCE_INIT;
+static __thread os_reader_t *_os_reader;
+
+/* Release the record of a finished thread, so that another one may take it */
+static void _os_reader_release(void *reader) {
+    __atomic_store_n(&((os_reader_t *)reader)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void _os_reader_key_create(void) {
+    pthread_key_create(&_os_reader_key, _os_reader_release);
+}
+
+static os_reader_t *_os_reader_get(void) {
+    os_reader_t *reader;
+    int expected;
+
+    if (_os_reader) {
+        return _os_reader;
+    }
+
+    for (reader = __atomic_load_n(&_os_readers, __ATOMIC_ACQUIRE); reader; reader = reader->next) {
+        expected = 0;
+        if (__atomic_compare_exchange_n(&reader->in_use, &expected, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (!reader) {
+        os_calloc(1, sizeof(os_reader_t), reader);
+        reader->in_use = 1;
+        reader->next = __atomic_load_n(&_os_readers, __ATOMIC_RELAXED);
+
+        while (!__atomic_compare_exchange_n(&_os_readers, &reader->next, reader, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    pthread_once(&_os_reader_once, _os_reader_key_create);
+    pthread_setspecific(_os_reader_key, reader);
+    _os_reader = reader;
+    return reader;
+}
+
+static os_reader_t *_os_read_begin(void) {
+    os_reader_t *reader = _os_reader_get();
+
+    __atomic_store_n(&reader->epoch, __atomic_load_n(&_os_epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return reader;
+}
+
+static void _os_read_end(os_reader_t *reader) {
+    __atomic_store_n(&reader->epoch, 0, __ATOMIC_RELEASE);
+}
+
+static void _os_free_node(OSHashNode *node) {
+    free(node->key);
+    free(node);
+}
+
+/* Free the retired memory that no reader can be using */
+static void _os_reclaim(OSHash *self, int force) {
+    os_retired_t **it = (os_retired_t **)&self->retired;
+    os_retired_t *retired;
+    uint64_t oldest = __atomic_add_fetch(&_os_epoch, 1, __ATOMIC_SEQ_CST);
+    os_reader_t *reader;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    for (reader = __atomic_load_n(&_os_readers, __ATOMIC_ACQUIRE); reader && !force; reader = reader->next) {
+        const uint64_t epoch = __atomic_load_n(&reader->epoch, __ATOMIC_SEQ_CST);
+
+        if (epoch && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+
+    while (retired = *it, retired) {
+        if (force || retired->epoch < oldest) {
+            *it = retired->next;
+
+            if (retired->ctrl) {
+                free(retired->ptr);
+                free(retired->ctrl);
+            } else {
+                _os_free_node(retired->ptr);
+            }
+
+            free(retired);
+            self->retired_count--;
+        } else {
+            it = &retired->next;
+        }
+    }
+}
+
+/* Free a node or a table removed from a stripe, when nobody can read it anymore */
+static void _os_retire(OSHash *self, void *ptr, void *ctrl) {
+    os_retired_t *retired;
+
+    if (!self->lockfree) {
+        if (ctrl) {
+            free(ptr);
+            free(ctrl);
+        } else {
+            _os_free_node(ptr);
+        }
+        return;
+    }
+
+    os_calloc(1, sizeof(os_retired_t), retired);
+    retired->ptr = ptr;
+    retired->ctrl = ctrl;
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    retired->epoch = __atomic_load_n(&_os_epoch, __ATOMIC_SEQ_CST);
+    retired->next = self->retired;
+    self->retired = retired;
+
+    if (++self->retired_count >= OSHASH_RETIRED_MAX) {
+        _os_reclaim(self, 0);
+    }
+}
+
+/* The lock-free readers retry with the lock when a change overlaps their lookup */
+static void _os_write_begin(OSHash *self) {
+    if (self->lockfree) {
+        __atomic_store_n(&self->seq, self->seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+    }
+}
+
+static void _os_write_end(OSHash *self) {
+    if (self->lockfree) {
+        __atomic_store_n(&self->seq, self->seq + 1, __ATOMIC_RELEASE);
+    }
+}
+
+/* Put a node in the first free slot of its probe sequence in the current table */
+static void _os_place(OSHash *self, OSHashNode *node, uint64_t hash_key) {
+    const unsigned int groups = (self->rows + 1) / OSHASH_GROUP - 1;
+    unsigned int g = (unsigned int)(hash_key >> 7) & groups;
+    unsigned int step;
+    uint64_t mask;
+
+    for (step = 0; mask = _os_group_free(_os_group(self->ctrl + g * OSHASH_GROUP)), !mask; step++) {
+        g = (g + step + 1) & groups;
+    }
+
+    const unsigned int i = g * OSHASH_GROUP + _os_group_first(mask);
+
+    if (self->ctrl[i] == OSHASH_EMPTY && self->growth_left > 0) {
+        self->growth_left--;
+    }
+
+    __atomic_store_n(&self->table[i], node, __ATOMIC_RELEASE);
+    __atomic_store_n(&self->ctrl[i], hash_key & 0x7F, __ATOMIC_RELAXED);
+}
+
+/* Empty a slot. It's marked as deleted unless its group has empty slots, as
+ * the probing of the keys in the next groups has not gone through it.
+ */
+static void _os_remove(OSHash *self, OSHashNode **table, unsigned char *ctrl, unsigned int i) {
+    __atomic_store_n(&table[i], NULL, __ATOMIC_RELAXED);
+
+    if (_os_group_empty(_os_group(ctrl + i - i % OSHASH_GROUP))) {
+        __atomic_store_n(&ctrl[i], OSHASH_EMPTY, __ATOMIC_RELAXED);
+
+        if (table == self->table) {
+            self->growth_left++;
+        }
+    } else {
+        __atomic_store_n(&ctrl[i], OSHASH_DELETED, __ATOMIC_RELAXED);
+    }
+}
+
+static int _os_alloc_table(unsigned int slots, OSHashNode ***table, unsigned char **ctrl) {
+    if (*table = (OSHashNode **)calloc(slots, sizeof(OSHashNode *)), !*table) {
+        return 0;
+    }
+
+    if (*ctrl = (unsigned char *)malloc(slots), !*ctrl) {
+        free(*table);
+        return 0;
+    }
+
+    memset(*ctrl, OSHASH_EMPTY, slots);
+    return 1;
+}
+
+/* Move up to `slots` slots of the previous table to the current one */
+static void _os_migrate(OSHash *self, unsigned int slots) {
+    while (self->old_table && slots > 0) {
+        if (self->old_elements == 0 || self->old_pos > self->old_rows) {
+            OSHashNode **old_table = self->old_table;
+            unsigned char *old_ctrl = self->old_ctrl;
+
+            __atomic_store_n(&self->old_table, NULL, __ATOMIC_RELAXED);
+            __atomic_store_n(&self->old_ctrl, NULL, __ATOMIC_RELAXED);
+            __atomic_store_n(&self->old_rows, 0, __ATOMIC_RELAXED);
+            self->old_elements = 0;
+            self->old_pos = 0;
+            _os_retire(self, old_table, old_ctrl);
+            break;
+        }
+
+        OSHashNode *node = self->old_table[self->old_pos];
+
+        if (node) {
+            __atomic_store_n(&self->old_table[self->old_pos], NULL, __ATOMIC_RELAXED);
+            __atomic_store_n(&self->old_ctrl[self->old_pos], OSHASH_DELETED, __ATOMIC_RELAXED);
+            self->old_elements--;
+            _os_place(self, node, _os_genhash(self, node->key));
+        }
+
+        self->old_pos++;
+        slots--;
+    }
+}
+
+/* Start moving the entries to a new table
+ * Returns 0 on error (out of memory)
+ */
+static int _os_resize(OSHash *self, unsigned int slots) {
+    OSHashNode **table;
+    unsigned char *ctrl;
+
+    /* Only one table is resized at a time */
+    _os_migrate(self, UINT_MAX);
+
+    if (!_os_alloc_table(slots, &table, &ctrl)) {
+        return 0;
+    }
+
+    __atomic_store_n(&self->old_table, self->table, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->old_ctrl, self->ctrl, __ATOMIC_RELAXED);
+    __atomic_store_n(&self->old_rows, self->rows, __ATOMIC_RELAXED);
+    self->old_elements = self->elements;
+    self->old_pos = 0;
+
+    __atomic_store_n(&self->table, table, __ATOMIC_RELEASE);
+    __atomic_store_n(&self->ctrl, ctrl, __ATOMIC_RELEASE);
+    __atomic_store_n(&self->rows, slots - 1, __ATOMIC_RELAXED);
+    self->growth_left = slots / 8 * 7;
+
+    return 1;
+}
+
+/* Make room for a new entry: double the table, or drop the deleted slots of a half-empty one */
+static int _os_grow(OSHash *self) {
+    unsigned int slots;
+
+    _os_migrate(self, UINT_MAX);
+    slots = self->rows + 1;
+
+    if (self->elements >= slots / 2) {
+        if (slots > UINT_MAX / 4) {
+            return 0;
+        }
+
+        slots *= 2;
+    }
+
+    return _os_resize(self, slots);
+}
+
+/* Free the nodes of a table */
+static void _os_free_table(OSHashNode **table, unsigned int rows, void (*free_data_function)(void *)) {
+    unsigned int i;
+
+    for (i = 0; table && i <= rows; i++) {
+        if (table[i]) {
+            free(table[i]->key);
+            /* Take care of the data as well (if a function has been defined) */
+            if (table[i]->data && free_data_function) free_data_function(table[i]->data);
+            free(table[i]);
+        }
+    }
+
+    free(table);
+}
+
+/* Free the tables of a hash or a stripe, and the hash itself */
+static void _os_destroy(OSHash *self, void (*free_data_function)(void *)) {
+    unsigned int i;
+
+    for (i = 0; self->shards && i < 1U << self->shard_bits; i++) {
+        _os_destroy(self->shards[i], free_data_function);
+    }
+
+    free(self->shards);
+
+    /* No reader is left */
+    _os_reclaim(self, 1);
+
+    _os_free_table(self->table, self->rows, free_data_function);
+    _os_free_table(self->old_table, self->old_rows, free_data_function);
+    free(self->ctrl);
+    free(self->old_ctrl);
+
+    pthread_rwlock_destroy(&self->mutex);
+    free(self);
+}
+
+/* Points to the current or the previous table slot of a key, NULL if not found */
+static OSHashNode **_os_lookup(const OSHash *self, const char *key, uint64_t hash_key, OSHashNode ***table, unsigned char **ctrl) {
+    long i;
+
+    if (i = _os_find(self->table, self->ctrl, self->rows, hash_key, key), i >= 0) {
+        *table = self->table;
+        *ctrl = self->ctrl;
+        return &self->table[i];
+    }
+
+    if (self->old_table && (i = _os_find(self->old_table, self->old_ctrl, self->old_rows, hash_key, key), i >= 0)) {
+        *table = self->old_table;
+        *ctrl = self->old_ctrl;
+        return &self->old_table[i];
+    }
+
+    return NULL;
+}
+
+/* Stripe of a key, or the hash itself if it's not concurrent */
+static OSHash *_os_shard(const OSHash *self, uint64_t hash_key) {
+    if (self->shards) {
+        return self->shards[hash_key >> (64 - self->shard_bits)];
+    }
+
+    return (OSHash *)self;
+}
+
+/* Allocate an empty hash */
+static OSHash *_os_new(void) {
     OSHash *self;
 
     /* Allocate memory for the hash */
@@ -30,150 +590,198 @@ OSHash *OSHash_Create()
         return (NULL);
     }
 
-    /* Set default row size */
-    self->rows = os_getprime(32);
-    if (self->rows == 0) {
-        free(self);
-        return (NULL);
-    }
-
     /* Create hashing table */
-    self->table = (OSHashNode **)calloc(self->rows + 1, sizeof(OSHashNode *));
-    if (!self->table) {
+    if (!_os_alloc_table(OSHASH_MIN_SLOTS, &self->table, &self->ctrl)) {
         free(self);
         return (NULL);
     }
 
-    /* Zero our tables */
-    for (i = 0; i <= self->rows; i++) {
-        self->table[i] = NULL;
+    self->rows = OSHASH_MIN_SLOTS - 1;
+    self->growth_left = OSHASH_MIN_SLOTS / 8 * 7;
+
+    return (self);
+}
+
+/* Create hash
+ * Returns NULL on error
+ */
+OSHash *OSHash_Create()
+{
+    OSHash *self;
+
+    if (self = _os_new(), !self) {
+        return (NULL);
     }
 
     /* Get seed */
     srandom((unsigned int)time(0));
-    self->initial_seed = os_getprime((unsigned)os_random() % self->rows);
-    self->constant = os_getprime((unsigned)os_random() % self->rows);
+    self->seed = (uint64_t)(unsigned int)os_random() << 32 | (unsigned int)os_random();
     w_rwlock_init(&self->mutex, NULL);
     return (self);
 }
 
+/* Split the hash in stripes
+ * Returns 0 on error
+ */
+int OSHash_SetConcurrent(OSHash *self, unsigned int stripes)
+{
+    unsigned int i;
+
+    if (self->shards || self->elements || stripes < 2 || stripes & (stripes - 1) || stripes > OSHASH_MAX_STRIPES) {
+        return (0);
+    }
+
+    if (self->shards = (OSHash **)calloc(stripes, sizeof(OSHash *)), !self->shards) {
+        return (0);
+    }
+
+    for (i = 0; i < stripes; i++) {
+        if (self->shards[i] = _os_new(), !self->shards[i]) {
+            while (i > 0) {
+                _os_destroy(self->shards[--i], NULL);
+            }
+
+            os_free(self->shards);
+            return (0);
+        }
+
+        /* The stripes use the same hash of the keys */
+        self->shards[i]->seed = self->seed;
+        self->shards[i]->free_data_function = self->free_data_function;
+        self->shards[i]->lockfree = 1;
+        w_rwlock_init(&self->shards[i]->mutex, NULL);
+    }
+
+    for (self->shard_bits = 0; 1U << self->shard_bits < stripes; self->shard_bits++);
+
+    /* The entries live in the stripes */
+    os_free(self->table);
+    os_free(self->ctrl);
+    self->rows = 0;
+    self->growth_left = 0;
+
+    return (1);
+}
+
 /* Set the pointer to the function to free the memory data */
 int OSHash_SetFreeDataPointer(OSHash *self, void (free_data_function)(void *))
 {
+    unsigned int i;
+
     self->free_data_function = free_data_function;
+
+    for (i = 0; self->shards && i < 1U << self->shard_bits; i++) {
+        self->shards[i]->free_data_function = free_data_function;
+    }
+
     return (1);
 }
 
 /* Free the memory used by the hash */
 void *OSHash_Free(OSHash *self)
 {
-    unsigned int i = 0;
-    OSHashNode *curr_node;
-    OSHashNode *next_node;
-
-    /* Free each entry */
-    while (i <= self->rows) {
-        curr_node = self->table[i];
-        next_node = curr_node;
-        while (next_node) {
-            next_node = next_node->next;
-            if (curr_node->key) free(curr_node->key);
-            /* Take care of the data as well (if a function has been defined) */
-            if (curr_node->data && self->free_data_function) self->free_data_function(curr_node->data);
-            free(curr_node);
-            curr_node = next_node;
-        }
-        i++;
-    }
-
-    /* Free the hash table */
-    free(self->table);
-    pthread_rwlock_destroy(&self->mutex);
-    free(self);
+    /* Free each entry and the tables */
+    _os_destroy(self, self->free_data_function);
     return (NULL);
 }
 
 /* Generates hash for key */
-static unsigned int _os_genhash(const OSHash *self, const char *key)
+static uint64_t _os_genhash(const OSHash *self, const char *key)
 {
-    unsigned int hash_key = self->initial_seed;
-
-    /* What we have here is a simple polynomial hash.
-     * x0 * a^k-1 .. xk * a^k-k +1
-     */
-    while (*key) {
-        hash_key *= self->constant;
-        hash_key += (unsigned int) * key;
-        key++;
-    }
-
-    return (hash_key);
+    return _wyhash(key, strlen(key), self->seed);
 }
 
-/* Set new size for hash
- * Returns 0 on error (out of memory)
- */
-int OSHash_setSize(OSHash *self, unsigned int new_size)
-{
-    unsigned int i = 0, orig_size = self->rows;
-    OSHashNode **tmpTable = NULL;
+/* Resize a table to keep room for new_size entries */
+static int _os_set_size(OSHash *self, unsigned int new_size) {
+    unsigned int slots = OSHASH_MIN_SLOTS;
+    int result;
 
     /* We can't decrease the size */
     if (new_size <= self->rows) {
         return (1);
     }
 
-    /* Get next prime */
-    self->rows = os_getprime(new_size);
-    if (self->rows == 0) {
-        return (0);
+    /* Keep room for new_size entries */
+    while (slots / 8 * 7 < new_size) {
+        if (slots > UINT_MAX / 4) {
+            return (0);
+        }
+
+        slots *= 2;
     }
 
-    /* Resize hash table */
-    /* If a call to realloc() fails, the pointer passed to it will remain unchanged */
-    tmpTable = (OSHashNode **) realloc(self->table, (self->rows + 1) * sizeof(OSHashNode *));
-    if (!tmpTable) return (0);
+    if (slots <= self->rows + 1) {
+        return (1);
+    }
 
-    /* If a call to realloc() succeeds, the pointer passed to it would have been freed */
-    self->table = tmpTable;
+    _os_write_begin(self);
+    result = _os_resize(self, slots);
+    _os_write_end(self);
 
-    /* Check if previous tables had allocated data */
-    OSHashNode *curr_node, *next_node;
-    for(i = 0; i < orig_size; i++) {
-        curr_node = self->table[i];
-        next_node = curr_node;
-        while(next_node) {
-            next_node = next_node->next;
-            if (curr_node->key) free(curr_node->key);
-            /* Take care of the data as well (if a function has been defined) */
-            if (curr_node->data && self->free_data_function) self->free_data_function(curr_node->data);
-            free(curr_node);
-            curr_node = next_node;
-        }
-    }
+    return result;
+}
 
-    /* Zero our tables */
-    for (i = 0; i <= self->rows; i++) {
-        self->table[i] = NULL;
+/* Set new size for hash
+ * The entries are kept, in a table of at least new_size slots.
+ * Returns 0 on error (out of memory)
+ */
+int OSHash_setSize(OSHash *self, unsigned int new_size)
+{
+    unsigned int i;
+
+    if (!self->shards) {
+        return _os_set_size(self, new_size);
     }
 
-    /* New seed */
-    self->initial_seed = os_getprime(456 % self->rows);
-    self->constant = os_getprime(789 % self->rows);
+    /* Keys are spread evenly among the stripes */
+    for (i = 0; i < 1U << self->shard_bits; i++) {
+        if (!_os_set_size(self->shards[i], (new_size >> self->shard_bits) + 1)) {
+            return (0);
+        }
+    }
 
     return (1);
 }
 
 int OSHash_setSize_ex(OSHash *self, unsigned int new_size)
 {
-    int result;
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_setSize(self,new_size);
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+    unsigned int i;
+    int result = 1;
+
+    if (!self->shards) {
+        w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
+        result = OSHash_setSize(self,new_size);
+        w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+        return result;
+    }
+
+    for (i = 0; i < 1U << self->shard_bits && result; i++) {
+        w_rwlock_wrlock(&self->shards[i]->mutex);
+        result = _os_set_size(self->shards[i], (new_size >> self->shard_bits) + 1);
+        w_rwlock_unlock(&self->shards[i]->mutex);
+    }
+
     return result;
 }
 
 
+static int _os_update(OSHash *self, const char *key, uint64_t hash_key, void *data) {
+    OSHashNode **table;
+    unsigned char *ctrl;
+    OSHashNode **slot;
+
+    if (slot = _os_lookup(self, key, hash_key, &table, &ctrl), !slot) {
+        return (0);
+    }
+
+    if ((*slot)->data && self->free_data_function) {
+        self->free_data_function((*slot)->data);
+    }
+
+    __atomic_store_n(&(*slot)->data, data, __ATOMIC_RELEASE);
+    return (1);
+}
+
 /** int OSHash_Update(OSHash *self, char *key, void *data)
  * Returns 0 on error (not found).
  * Returns 1 on success. Data updated
@@ -181,30 +789,9 @@ int OSHash_setSize_ex(OSHash *self, unsigned int new_size)
  */
 int OSHash_Update(OSHash *self, const char *key, void *data)
 {
-    unsigned int hash_key;
-    unsigned int index;
-    OSHashNode *curr_node;
-
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
+    const uint64_t hash_key = _os_genhash(self, key);
 
-    /* Get array index */
-    index = hash_key % self->rows;
-
-    /* Check for duplicated entries in the index */
-    curr_node = self->table[index];
-    while (curr_node) {
-        /* Checking for duplicated key -- not adding */
-        if (strcmp(curr_node->key, key) == 0) {
-            if (curr_node->data && self->free_data_function) {
-                self->free_data_function(curr_node->data);
-            }
-            curr_node->data = data;
-            return (1);
-        }
-        curr_node = curr_node->next;
-    }
-    return (0);
+    return _os_update(_os_shard(self, hash_key), key, hash_key, data);
 }
 
 /** int OSHash_Update_ex(OSHash *self, char *key, void *data)
@@ -214,11 +801,13 @@ int OSHash_Update(OSHash *self, const char *key, void *data)
  */
 int OSHash_Update_ex(OSHash *self, const char *key, void *data)
 {
+    const uint64_t hash_key = _os_genhash(self, key);
+    OSHash *shard = _os_shard(self, hash_key);
     int result;
 
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Update(self,key,data);
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+    w_rwlock_wrlock(&shard->mutex);
+    result = _os_update(shard, key, hash_key, data);
+    w_rwlock_unlock(&shard->mutex);
 
     return result;
 }
@@ -243,30 +832,18 @@ int OSHash_Set(OSHash *self, const char *key, void *data) {
     return _OSHash_Add(self, key, data, 1);
 }
 
-int _OSHash_Add(OSHash *self, const char *key, void *data, int update)
-{
-    unsigned int hash_key;
-    unsigned int index;
-    OSHashNode *curr_node;
+static int _os_add(OSHash *self, const char *key, uint64_t hash_key, void *data, int update) {
+    OSHashNode **table;
+    unsigned char *ctrl;
+    OSHashNode **slot;
     OSHashNode *new_node;
 
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
-
-    /* Get array index */
-    index = hash_key % self->rows;
-
-    /* Check for duplicated entries in the index */
-    curr_node = self->table[index];
-    while (curr_node) {
-        /* Checking for duplicated key */
-        if (strcmp(curr_node->key, key) == 0) {
-            if (update) {
-                 curr_node->data = data;
-            }
-            return (1);
+    /* Check for duplicated entries */
+    if (slot = _os_lookup(self, key, hash_key, &table, &ctrl), slot) {
+        if (update) {
+            __atomic_store_n(&(*slot)->data, data, __ATOMIC_RELEASE);
         }
-        curr_node = curr_node->next;
+        return (1);
     }
 
     /* Create new node */
@@ -275,8 +852,6 @@ int _OSHash_Add(OSHash *self, const char *key, void *data, int update)
         mdebug1("hash_op: calloc() failed!");
         return (0);
     }
-    new_node->next = NULL;
-    new_node->prev = NULL;
     new_node->data = data;
     new_node->key = strdup(key);
     if ( new_node->key == NULL ) {
@@ -285,22 +860,37 @@ int _OSHash_Add(OSHash *self, const char *key, void *data, int update)
         return (0);
     }
 
-    /* Add to table */
-    if (!self->table[index]) {
-        self->table[index] = new_node;
-    }
-    /* If there is duplicated, add to the beginning */
-    else {
-        new_node->next = self->table[index];
-        self->table[index]->prev = new_node;
-        self->table[index] = new_node;
+    _os_write_begin(self);
+
+    /* Make room for it, or go on moving the entries of the previous table */
+    if (self->growth_left == 0) {
+        if (!_os_grow(self)) {
+            _os_write_end(self);
+            free(new_node->key);
+            free(new_node);
+            mdebug1("hash_op: table resize failed!");
+            return (0);
+        }
     }
 
+    _os_migrate(self, OSHASH_MIGRATE);
+
+    /* Add to table */
+    _os_place(self, new_node, hash_key);
     self->elements = self->elements + 1;
 
+    _os_write_end(self);
+
     return (2);
 }
 
+int _OSHash_Add(OSHash *self, const char *key, void *data, int update)
+{
+    const uint64_t hash_key = _os_genhash(self, key);
+
+    return _os_add(_os_shard(self, hash_key), key, hash_key, data, update);
+}
+
 /** int OSHash_Numeric_Add_ex(OSHash *self, int key, void *data)
  * Returns 0 on error.
  * Returns 1 on duplicated key (not added)
@@ -326,10 +916,13 @@ int OSHash_Numeric_Add_ex(OSHash *self, int key, void *data)
  */
 int OSHash_Add_ex(OSHash *self, const char *key, void *data)
 {
+    const uint64_t hash_key = _os_genhash(self, key);
+    OSHash *shard = _os_shard(self, hash_key);
     int result;
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Add(self,key,data);
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+
+    w_rwlock_wrlock(&shard->mutex);
+    result = _os_add(shard, key, hash_key, data, 0);
+    w_rwlock_unlock(&shard->mutex);
 
     return result;
 }
@@ -342,10 +935,13 @@ int OSHash_Add_ex(OSHash *self, const char *key, void *data)
  */
 int OSHash_Set_ex(OSHash *self, const char *key, void *data)
 {
+    const uint64_t hash_key = _os_genhash(self, key);
+    OSHash *shard = _os_shard(self, hash_key);
     int result;
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Set(self,key,data);
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+
+    w_rwlock_wrlock(&shard->mutex);
+    result = _os_add(shard, key, hash_key, data, 1);
+    w_rwlock_unlock(&shard->mutex);
 
     return result;
 }
@@ -366,6 +962,54 @@ int OSHash_Add_ins(OSHash *self, const char *key, void *data)
     return result;
 }
 
+static void *_os_get(const OSHash *self, const char *key, uint64_t hash_key) {
+    OSHashNode **table;
+    unsigned char *ctrl;
+    OSHashNode **slot;
+
+    if (slot = _os_lookup(self, key, hash_key, &table, &ctrl), !slot) {
+        return (NULL);
+    }
+
+    return ((*slot)->data);
+}
+
+/* Look for a key in a stripe without locking it
+ * Returns 0 if a change overlapped the lookup of a missing key, so that it must be retried with the lock
+ */
+static int _os_get_lockfree(const OSHash *self, const char *key, uint64_t hash_key, void **data) {
+    os_reader_t *reader = _os_read_begin();
+    const unsigned int seq = __atomic_load_n(&self->seq, __ATOMIC_ACQUIRE);
+    OSHashNode **table = __atomic_load_n(&self->table, __ATOMIC_ACQUIRE);
+    unsigned char *ctrl = __atomic_load_n(&self->ctrl, __ATOMIC_ACQUIRE);
+    const unsigned int rows = __atomic_load_n(&self->rows, __ATOMIC_RELAXED);
+    OSHashNode **old_table = __atomic_load_n(&self->old_table, __ATOMIC_RELAXED);
+    unsigned char *old_ctrl = __atomic_load_n(&self->old_ctrl, __ATOMIC_RELAXED);
+    const unsigned int old_rows = __atomic_load_n(&self->old_rows, __ATOMIC_RELAXED);
+    OSHashNode *node = NULL;
+    int valid;
+
+    /* The tables must belong to the same version of the stripe */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (valid = !(seq & 1) && __atomic_load_n(&self->seq, __ATOMIC_RELAXED) == seq, valid) {
+        if (node = _os_find_lockfree(table, ctrl, rows, hash_key, key), !node && old_table) {
+            node = _os_find_lockfree(old_table, old_ctrl, old_rows, hash_key, key);
+        }
+
+        if (node) {
+            *data = __atomic_load_n(&node->data, __ATOMIC_ACQUIRE);
+        } else {
+            /* The entry may have been moved while looking for it */
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+            valid = __atomic_load_n(&self->seq, __ATOMIC_RELAXED) == seq;
+            *data = NULL;
+        }
+    }
+
+    _os_read_end(reader);
+    return valid;
+}
+
 /** void *OSHash_Get(OSHash *self, char *key)
  * Returns NULL on error (key not found).
  * Returns the key otherwise.
@@ -373,31 +1017,9 @@ int OSHash_Add_ins(OSHash *self, const char *key, void *data)
  */
 void *OSHash_Get(const OSHash *self, const char *key)
 {
-    unsigned int hash_key;
-    unsigned int index;
-    const OSHashNode *curr_node;
-
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
+    const uint64_t hash_key = _os_genhash(self, key);
 
-    /* Get array index */
-    index = hash_key % self->rows;
-
-    /* Get entry */
-    curr_node = self->table[index];
-
-    while (curr_node != NULL) {
-        /* Skip null pointers */
-        if (curr_node->key != NULL) {
-            /* We may have collisions, so double check with strcmp */
-            if (strcmp(curr_node->key, key) == 0) {
-                return (curr_node->data);
-            }
-        }
-        curr_node = curr_node->next;
-    }
-
-    return (NULL);
+    return _os_get(_os_shard(self, hash_key), key, hash_key);
 }
 
 /** void *OSHash_Numeric_Get_ex(OSHash *self, int key)
@@ -423,10 +1045,17 @@ void *OSHash_Numeric_Get_ex(const OSHash *self, int key)
  */
 void *OSHash_Get_ex(const OSHash *self, const char *key)
 {
+    const uint64_t hash_key = _os_genhash(self, key);
+    OSHash *shard = _os_shard(self, hash_key);
     void *result;
-    w_rwlock_rdlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Get(self,key);
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+
+    if (shard->lockfree && _os_get_lockfree(shard, key, hash_key, &result)) {
+        return result;
+    }
+
+    w_rwlock_rdlock(&shard->mutex);
+    result = _os_get(shard, key, hash_key);
+    w_rwlock_unlock(&shard->mutex);
 
     return result;
 }
@@ -448,51 +1077,60 @@ void *OSHash_Get_ins(const OSHash *self, const char *key)
 
 /* Return the number of elements in the hash table */
 unsigned int OSHash_Get_Elem_ex(OSHash *self) {
-    unsigned int ret;
-    w_rwlock_rdlock((pthread_rwlock_t *)&self->mutex);
-    ret = self->elements;
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+    unsigned int ret = 0;
+    unsigned int i;
+
+    if (!self->shards) {
+        w_rwlock_rdlock((pthread_rwlock_t *)&self->mutex);
+        ret = self->elements;
+        w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+        return ret;
+    }
+
+    for (i = 0; i < 1U << self->shard_bits; i++) {
+        w_rwlock_rdlock(&self->shards[i]->mutex);
+        ret += self->shards[i]->elements;
+        w_rwlock_unlock(&self->shards[i]->mutex);
+    }
 
     return ret;
 }
 
-/* Return a pointer to a hash node if found, that hash node is removed from the table */
-void *OSHash_Delete(OSHash *self, const char *key)
-{
+static void *_os_delete(OSHash *self, const char *key, uint64_t hash_key) {
+    OSHashNode **table;
+    unsigned char *ctrl;
+    OSHashNode **slot;
     OSHashNode *curr_node;
-    OSHashNode *prev_node = NULL;
-    unsigned int hash_key;
-    unsigned int index;
     void *data;
 
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
+    if (slot = _os_lookup(self, key, hash_key, &table, &ctrl), !slot) {
+        return NULL;
+    }
 
-    /* Get array index */
-    index = hash_key % self->rows;
+    _os_write_begin(self);
 
-    curr_node = self->table[index];
-    while ( curr_node != NULL ) {
-        if (strcmp(curr_node->key, key) == 0) {
-            if ( prev_node == NULL ) {
-                self->table[index] = curr_node->next;
-            } else {
-                prev_node->next = curr_node->next;
-            }
-            if (curr_node->next) {
-                curr_node->next->prev = prev_node;
-            }
-            free(curr_node->key);
-            data = curr_node->data;
-            free(curr_node);
-            self->elements = self->elements - 1;
-            return data;
-        }
-        prev_node = curr_node;
-        curr_node = curr_node->next;
+    curr_node = *slot;
+    _os_remove(self, table, ctrl, (unsigned int)(slot - table));
+
+    if (table == self->old_table) {
+        self->old_elements--;
     }
 
-    return NULL;
+    self->elements = self->elements - 1;
+
+    _os_write_end(self);
+
+    data = curr_node->data;
+    _os_retire(self, curr_node, NULL);
+    return data;
+}
+
+/* Return a pointer to a hash node if found, that hash node is removed from the table */
+void *OSHash_Delete(OSHash *self, const char *key)
+{
+    const uint64_t hash_key = _os_genhash(self, key);
+
+    return _os_delete(_os_shard(self, hash_key), key, hash_key);
 }
 
 void *OSHash_Numeric_Delete_ex(OSHash *self, int key)
@@ -509,10 +1147,13 @@ void *OSHash_Numeric_Delete_ex(OSHash *self, int key)
 /* Return a pointer to a hash node if found, that hash node is removed from the table */
 void *OSHash_Delete_ex(OSHash *self, const char *key)
 {
+    const uint64_t hash_key = _os_genhash(self, key);
+    OSHash *shard = _os_shard(self, hash_key);
     void *result;
-    w_rwlock_wrlock((pthread_rwlock_t *)&self->mutex);
-    result = OSHash_Delete(self,key);
-    w_rwlock_unlock((pthread_rwlock_t *)&self->mutex);
+
+    w_rwlock_wrlock(&shard->mutex);
+    result = _os_delete(shard, key, hash_key);
+    w_rwlock_unlock(&shard->mutex);
 
     return result;
 }
@@ -527,30 +1168,65 @@ void *OSHash_Delete_ins(OSHash *self, const char *key)
     return result;
 }
 
-OSHash *OSHash_Duplicate(const OSHash *hash) {
-    OSHash *self;
+/* Copy a table and its nodes. The data is shared. */
+static void _os_duplicate_table(OSHashNode * const *table, const unsigned char *ctrl, unsigned int rows,
+                                OSHashNode ***new_table, unsigned char **new_ctrl) {
     unsigned int i;
-    OSHashNode *curr_node;
-    OSHashNode **next_addr;
+
+    os_calloc(rows + 1, sizeof(OSHashNode *), *new_table);
+    os_malloc(rows + 1, *new_ctrl);
+    memcpy(*new_ctrl, ctrl, rows + 1);
+
+    for (i = 0; i <= rows; i++) {
+        if (table[i]) {
+            os_calloc(1, sizeof(OSHashNode), (*new_table)[i]);
+            (*new_table)[i]->key = strdup(table[i]->key);
+            (*new_table)[i]->data = table[i]->data;
+        }
+    }
+}
+
+/* Copy a hash or a stripe. The stripes of a concurrent hash are copied by
+ * the caller, locking them if needed.
+ */
+static OSHash *_os_duplicate(const OSHash *hash) {
+    OSHash *self;
 
     os_calloc(1, sizeof(OSHash), self);
     self->rows = hash->rows;
-    self->initial_seed = hash->initial_seed;
-    self->constant = hash->constant;
+    self->growth_left = hash->growth_left;
+    self->seed = hash->seed;
+    self->elements = hash->elements;
     self->free_data_function = hash->free_data_function;
+    self->lockfree = hash->lockfree;
+
+    if (hash->table) {
+        _os_duplicate_table(hash->table, hash->ctrl, hash->rows, &self->table, &self->ctrl);
+    }
+
+    if (hash->old_table) {
+        _os_duplicate_table(hash->old_table, hash->old_ctrl, hash->old_rows, &self->old_table, &self->old_ctrl);
+        self->old_rows = hash->old_rows;
+        self->old_elements = hash->old_elements;
+        self->old_pos = hash->old_pos;
+    }
+
+    if (hash->shards) {
+        os_calloc(1U << hash->shard_bits, sizeof(OSHash *), self->shards);
+        self->shard_bits = hash->shard_bits;
+    }
 
-    os_calloc(self->rows + 1, sizeof(OSHashNode*), self->table);
     w_rwlock_init(&self->mutex, NULL);
 
-    for (i = 0; i <= self->rows; i++) {
-        next_addr = &self->table[i];
+    return self;
+}
 
-        for (curr_node = hash->table[i]; curr_node; curr_node = curr_node->next) {
-            os_calloc(1, sizeof(OSHashNode), *next_addr);
-            (*next_addr)->key = strdup(curr_node->key);
-            (*next_addr)->data = curr_node->data;
-            next_addr = &(*next_addr)->next;
-        }
+OSHash *OSHash_Duplicate(const OSHash *hash) {
+    OSHash *self = _os_duplicate(hash);
+    unsigned int i;
+
+    for (i = 0; hash->shards && i < 1U << hash->shard_bits; i++) {
+        self->shards[i] = _os_duplicate(hash->shards[i]);
     }
 
     return self;
@@ -559,99 +1235,187 @@ OSHash *OSHash_Duplicate(const OSHash *hash) {
 OSHash *OSHash_Duplicate_ex(const OSHash *hash) {
 
     OSHash *result;
+    unsigned int i;
 
-    w_rwlock_rdlock((pthread_rwlock_t *)&hash->mutex);
-    result = OSHash_Duplicate(hash);
-    w_rwlock_unlock((pthread_rwlock_t *)&hash->mutex);
+    if (!hash->shards) {
+        w_rwlock_rdlock((pthread_rwlock_t *)&hash->mutex);
+        result = OSHash_Duplicate(hash);
+        w_rwlock_unlock((pthread_rwlock_t *)&hash->mutex);
+        return result;
+    }
+
+    result = _os_duplicate(hash);
+
+    for (i = 0; i < 1U << hash->shard_bits; i++) {
+        w_rwlock_rdlock(&hash->shards[i]->mutex);
+        result->shards[i] = _os_duplicate(hash->shards[i]);
+        w_rwlock_unlock(&hash->shards[i]->mutex);
+    }
 
     return result;
 }
 
+/* Slots of a hash: the current ones, followed by those of the previous table */
+static unsigned int _os_span(const OSHash *self) {
+    return self->rows + 1 + (self->old_table ? self->old_rows + 1 : 0);
+}
 
-OSHashNode *OSHash_Begin(const OSHash *self, unsigned int *i){
-
+/* Find the first node from the index i. The slots of the previous table go after the current ones. */
+static OSHashNode *_os_scan(const OSHash *self, unsigned int *i) {
     OSHashNode *curr_node;
-    *i = 0;
 
-    if (self) {
-        while (*i <= self->rows) {
-            curr_node = self->table[*i];
-            if (curr_node && curr_node->key) {
-                return curr_node;
-            }
-            (*i)++;
+    while (*i <= self->rows) {
+        curr_node = self->table[*i];
+        if (curr_node && curr_node->key) {
+            return curr_node;
         }
+        (*i)++;
+    }
+
+    while (self->old_table && *i - (self->rows + 1) <= self->old_rows) {
+        curr_node = self->old_table[*i - (self->rows + 1)];
+        if (curr_node && curr_node->key) {
+            return curr_node;
+        }
+        (*i)++;
     }
 
     return NULL;
 }
 
-OSHashNode *OSHash_Next(const OSHash *self, unsigned int *i, OSHashNode *current){
+/* Same, going through the stripes of a concurrent hash one after another */
+static OSHashNode *_os_scan_all(const OSHash *self, unsigned int *i) {
+    unsigned int base = 0;
+    unsigned int s;
 
-    if(current && current->next){
-        return current->next;
+    if (!self->shards) {
+        return _os_scan(self, i);
     }
 
-    (*i)++;
+    for (s = 0; s < 1U << self->shard_bits; s++) {
+        const OSHash *shard = self->shards[s];
+        const unsigned int span = _os_span(shard);
 
-    while (*i <= self->rows) {
-        current = self->table[*i];
-        if (current && current->key) {
-            return current;
+        if (*i < base + span) {
+            unsigned int local = *i - base;
+            OSHashNode *curr_node = _os_scan(shard, &local);
+
+            if (curr_node) {
+                *i = base + local;
+                return curr_node;
+            }
+
+            *i = base + span;
         }
-        (*i)++;
+
+        base += span;
     }
 
     return NULL;
 }
 
+OSHashNode *OSHash_Begin(const OSHash *self, unsigned int *i){
+
+    *i = 0;
+
+    if (self) {
+        return _os_scan_all(self, i);
+    }
+
+    return NULL;
+}
+
+OSHashNode *OSHash_Next(const OSHash *self, unsigned int *i, __attribute__((unused)) OSHashNode *current){
+
+    (*i)++;
+
+    return _os_scan_all(self, i);
+}
+
 void *OSHash_Clean(OSHash *self, void (*cleaner)(void*)){
+
+    /* Free each entry and the tables */
+    _os_destroy(self, cleaner);
+    return NULL;
+}
+
+static void _os_it_table(OSHash *self, OSHashNode **table, unsigned char *ctrl, unsigned int rows, void *data,
+                         void (*iterating_function)(OSHashNode **row, OSHashNode **node, void *data)) {
     unsigned int i;
-    OSHashNode *curr_node;
-    OSHashNode *next_node;
-
-    curr_node = OSHash_Begin(self, &i);
-    if(curr_node){
-        do {
-            next_node = OSHash_Next(self, &i, curr_node);
-            if(curr_node->key){
-                free(curr_node->key);
-            }
-            if(curr_node->data){
-                cleaner(curr_node->data);
+
+    for (i = 0; table && i <= rows; i++) {
+        if (table[i] && table[i]->key) {
+            OSHashNode *node_it = table[i];
+
+            iterating_function(&table[i], &node_it, data);
+
+            /* The function removed the node from its row */
+            if (!table[i]) {
+                _os_write_begin(self);
+                _os_remove(self, table, ctrl, i);
+
+                if (table == self->old_table) {
+                    self->old_elements--;
+                }
+
+                self->elements--;
+                _os_write_end(self);
             }
-            free(curr_node);
-            curr_node = next_node;
-        } while (curr_node);
+        }
     }
+}
 
-    /* Free the hash table */
-    free(self->table);
-    pthread_rwlock_destroy(&self->mutex);
-    free(self);
-    return NULL;
+static void _os_it(OSHash *self, void *data, void (*iterating_function)(OSHashNode **row, OSHashNode **node, void *data)) {
+    _os_it_table(self, self->table, self->ctrl, self->rows, data, iterating_function);
+    _os_it_table(self, self->old_table, self->old_ctrl, self->old_rows, data, iterating_function);
 }
 
 void OSHash_It(const OSHash *hash, void *data, void (*iterating_function)(OSHashNode **row, OSHashNode **node, void *data)) {
+    OSHash *self = (OSHash *)hash;
     unsigned int i;
-    OSHashNode *node_it;
 
-    for (i = 0; i < hash->rows; i++) {
-        node_it = hash->table[i];
-        while (node_it && node_it->key) {
-            OSHashNode *node_cpy = node_it;
+    if (!self->shards) {
+        _os_it(self, data, iterating_function);
+        return;
+    }
 
-            iterating_function(&hash->table[i], &node_it, data);
+    for (i = 0; i < 1U << self->shard_bits; i++) {
+        _os_it(self->shards[i], data, iterating_function);
+    }
+}
+
+void OSHash_It_ex(const OSHash *hash, char mode, void *data, void (*iterating_function)(OSHashNode **row, OSHashNode **node, void *data)) {
+    unsigned int i;
+
+    /* Concurrent hashes are locked one stripe at a time */
+    if (hash->shards) {
+        switch (mode) {
+            case 0:
+            case 1:
+            break;
+            case 2:
+                sleep(1);
+            break;
+            default:
+                return;
+        }
+
+        for (i = 0; i < 1U << hash->shard_bits; i++) {
+            OSHash *shard = hash->shards[i];
 
-            // To avoid infinite loops
-            if (node_cpy == node_it) {
-                node_it = node_it->next;
+            if (mode == 0) {
+                w_rwlock_rdlock(&shard->mutex);
+            } else {
+                w_rwlock_wrlock(&shard->mutex);
             }
+
+            _os_it(shard, data, iterating_function);
+            w_rwlock_unlock(&shard->mutex);
         }
+
+        return;
     }
-}
 
-void OSHash_It_ex(const OSHash *hash, char mode, void *data, void (*iterating_function)(OSHashNode **row, OSHashNode **node, void *data)) {
     switch (mode) {
         case 0:
             w_rwlock_rdlock((pthread_rwlock_t *)&hash->mutex);
@@ -672,19 +1436,12 @@ void OSHash_It_ex(const OSHash *hash, char mode, void *data, void (*iterating_fu
 
 
 /*
- * Returns the index of the key.
+ * Returns the index of the first slot probed for the key.
  * Key must not be NULL.
  */
 unsigned int OSHash_GetIndex(OSHash *self, const char *key)
 {
-    unsigned int hash_key;
-    unsigned int index;
-
-    /* Generate hash of the message */
-    hash_key = _os_genhash(self, key);
-
-    /* Get array index */
-    index = hash_key % self->rows;
+    const uint64_t hash_key = _os_genhash(self, key);
 
-    return index;
+    return ((unsigned int)(hash_key >> 7) * OSHASH_GROUP) & _os_shard(self, hash_key)->rows;
 }
@@ -9,6 +9,12 @@
 
 #include "shared.h"
 
+// Prefix of the rule level in the alerts written by analysisd
+#define JQUEUE_LEVEL_KEY "\"rule\":{\"level\":"
+
+static cJSON * jqueue_read(file_queue * queue);
+static bool jqueue_match(const file_queue * queue, const char * alert);
+
 // Initializes queue. Equivalent to initialize every field to 0.
 void jqueue_init(file_queue * queue) {
     memset(queue, 0, sizeof(file_queue));
@@ -63,7 +69,7 @@ cJSON * jqueue_next(file_queue * queue) {
     }
 
     clearerr(queue->fp);
-    alert = jqueue_parse_json(queue);
+    alert = jqueue_read(queue);
 
     if (alert && !(queue->flags & CRALERT_READ_FAILED)) {
         return alert;
@@ -90,7 +96,7 @@ cJSON * jqueue_next(file_queue * queue) {
             }
 
             clearerr(queue->fp);
-            return jqueue_parse_json(queue);
+            return jqueue_read(queue);
 
         } else {
             return NULL;
@@ -104,11 +110,43 @@ void jqueue_close(file_queue * queue) {
     queue->fp = NULL;
 }
 
+void jqueue_set_filter(file_queue * queue, unsigned int min_level, const char * pattern) {
+    queue->min_level = min_level;
+    queue->pattern = pattern;
+}
+
+// Get the next alert that passes the pre-filter
+static cJSON * jqueue_read(file_queue * queue) {
+    cJSON * alert;
+
+    while (alert = jqueue_parse_json(queue), !alert && (queue->flags & CRALERT_FILTERED)) {
+        queue->flags &= ~CRALERT_FILTERED;
+    }
+
+    return alert;
+}
+
+// Check the raw alert against the pre-filter
+static bool jqueue_match(const file_queue * queue, const char * alert) {
+    const char * level;
+
+    if (queue->pattern && !strstr(alert, queue->pattern)) {
+        return false;
+    }
+
+    if (queue->min_level > 0 && (level = strstr(alert, JQUEUE_LEVEL_KEY), level)) {
+        return strtoul(level + strlen(JQUEUE_LEVEL_KEY), NULL, 10) >= queue->min_level;
+    }
+
+    return true;
+}
+
 /**
  * @brief Read and validate a JSON alert from the file queue
  *
  * @param queue pointer to the file_queue struct
  * @post The flag variable may be set to CRALERT_READ_FAILED if the read operation got no data.
+ * @post The flag variable is set to CRALERT_FILTERED if the alert was skipped by the pre-filter.
  * @post The read position is restored if failed to get a JSON object.
  * @retval NULL No data read or could not get a valid JSON object or read overlong alert. Pointer to the JSON object otherwise.
  */
@@ -130,6 +168,11 @@ cJSON * jqueue_parse_json(file_queue * queue) {
         if (end = buffer + offset - initial_pos - 1, *end == '\n') {
             *end = '\0';
 
+            if (!jqueue_match(queue, buffer)) {
+                queue->flags |= CRALERT_FILTERED;
+                return NULL;
+            }
+
             if ((object = cJSON_ParseWithOpts(buffer, &jsonErrPtr, 0), object) && (*jsonErrPtr == '\0')) {
                 return object;
             }
@@ -10,6 +10,7 @@
  */
 
 #include <shared.h>
+#include <math.h>
 
 cJSON * json_fread(const char * path, char retry) {
     cJSON * item = NULL;
@@ -144,3 +145,241 @@ int* json_parse_agents(const cJSON* agents) {
 
     return agent_ids;
 }
+
+/* Make room for length more bytes plus the NUL byte */
+static void json_writer_reserve(json_writer_t * writer, size_t length) {
+    size_t needed = writer->length + length + 1;
+
+    if (needed > writer->size) {
+        size_t size = writer->size * 2;
+
+        if (size < needed) {
+            size = needed;
+        }
+
+        os_realloc(writer->data, size, writer->data);
+        writer->size = size;
+    }
+}
+
+static void json_writer_put(json_writer_t * writer, const char * text, size_t length) {
+    json_writer_reserve(writer, length);
+    memcpy(writer->data + writer->length, text, length);
+    writer->length += length;
+    writer->data[writer->length] = '\0';
+}
+
+static void json_writer_putc(json_writer_t * writer, char c) {
+    json_writer_reserve(writer, 1);
+    writer->data[writer->length++] = c;
+    writer->data[writer->length] = '\0';
+}
+
+/* Write a quoted string, escaping the same characters as cJSON */
+static void json_writer_quote(json_writer_t * writer, const char * value, size_t length) {
+    const char * end = value + length;
+
+    json_writer_putc(writer, '"');
+
+    while (value < end) {
+        const char * run = value;
+
+        while (value < end && (unsigned char)*value >= 0x20 && *value != '"' && *value != '\\') {
+            value++;
+        }
+
+        if (value > run) {
+            json_writer_put(writer, run, value - run);
+        }
+
+        if (value == end) {
+            break;
+        }
+
+        switch (*value) {
+        case '"':
+            json_writer_put(writer, "\\\"", 2);
+            break;
+        case '\\':
+            json_writer_put(writer, "\\\\", 2);
+            break;
+        case '\b':
+            json_writer_put(writer, "\\b", 2);
+            break;
+        case '\f':
+            json_writer_put(writer, "\\f", 2);
+            break;
+        case '\n':
+            json_writer_put(writer, "\\n", 2);
+            break;
+        case '\r':
+            json_writer_put(writer, "\\r", 2);
+            break;
+        case '\t':
+            json_writer_put(writer, "\\t", 2);
+            break;
+        default: {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*value);
+            json_writer_put(writer, escaped, 6);
+        }
+        }
+
+        value++;
+    }
+
+    json_writer_putc(writer, '"');
+}
+
+/* Write the separator and the member name that go before a value */
+static void json_writer_value(json_writer_t * writer, const char * key) {
+    if (writer->depth > 0) {
+        uint64_t bit = (uint64_t)1 << (writer->depth - 1);
+
+        if (writer->items & bit) {
+            json_writer_putc(writer, ',');
+        } else {
+            writer->items |= bit;
+        }
+    }
+
+    if (key) {
+        json_writer_quote(writer, key, strlen(key));
+        json_writer_putc(writer, ':');
+    }
+}
+
+static void json_writer_begin(json_writer_t * writer, const char * key, char open) {
+    if (writer->depth == JSON_WRITER_MAX_DEPTH) {
+        writer->overflow = true;
+        return;
+    }
+
+    json_writer_value(writer, key);
+    json_writer_putc(writer, open);
+    writer->items &= ~((uint64_t)1 << writer->depth);
+    writer->depth++;
+}
+
+static void json_writer_end(json_writer_t * writer, char close) {
+    if (writer->depth > 0) {
+        writer->depth--;
+    }
+
+    json_writer_putc(writer, close);
+}
+
+void json_writer_init(json_writer_t * writer, size_t size) {
+    if (size == 0) {
+        size = OS_SIZE_256;
+    }
+
+    os_malloc(size, writer->data);
+    writer->size = size;
+    json_writer_reset(writer);
+}
+
+void json_writer_reset(json_writer_t * writer) {
+    *writer->data = '\0';
+    writer->length = 0;
+    writer->depth = 0;
+    writer->overflow = false;
+    writer->items = 0;
+}
+
+void json_writer_free(json_writer_t * writer) {
+    os_free(writer->data);
+    writer->length = writer->size = 0;
+}
+
+void json_writer_object_begin(json_writer_t * writer, const char * key) {
+    json_writer_begin(writer, key, '{');
+}
+
+void json_writer_object_end(json_writer_t * writer) {
+    json_writer_end(writer, '}');
+}
+
+void json_writer_array_begin(json_writer_t * writer, const char * key) {
+    json_writer_begin(writer, key, '[');
+}
+
+void json_writer_array_end(json_writer_t * writer) {
+    json_writer_end(writer, ']');
+}
+
+void json_writer_add_string(json_writer_t * writer, const char * key, const char * value) {
+    if (value) {
+        json_writer_add_stringn(writer, key, value, strlen(value));
+    } else {
+        json_writer_add_null(writer, key);
+    }
+}
+
+void json_writer_add_stringn(json_writer_t * writer, const char * key, const char * value, size_t length) {
+    json_writer_value(writer, key);
+    json_writer_quote(writer, value, length);
+}
+
+void json_writer_add_number(json_writer_t * writer, const char * key, double value) {
+    char number[32];
+    int length;
+
+    json_writer_value(writer, key);
+
+    if (isnan(value) || isinf(value)) {
+        json_writer_put(writer, "null", 4);
+        return;
+    }
+
+    // Same rules as cJSON: integral values in the int range print as integers
+    int integer = value >= INT_MAX ? INT_MAX : value <= (double)INT_MIN ? INT_MIN : (int)value;
+
+    if (value == (double)integer) {
+        length = snprintf(number, sizeof(number), "%d", integer);
+    } else {
+        length = snprintf(number, sizeof(number), "%1.15g", value);
+
+        if (strtod(number, NULL) != value) {
+            length = snprintf(number, sizeof(number), "%1.17g", value);
+        }
+    }
+
+    json_writer_put(writer, number, length);
+}
+
+void json_writer_add_int(json_writer_t * writer, const char * key, long long value) {
+    char number[24];
+    int length = snprintf(number, sizeof(number), "%lld", value);
+
+    json_writer_value(writer, key);
+    json_writer_put(writer, number, length);
+}
+
+void json_writer_add_bool(json_writer_t * writer, const char * key, bool value) {
+    json_writer_value(writer, key);
+
+    if (value) {
+        json_writer_put(writer, "true", 4);
+    } else {
+        json_writer_put(writer, "false", 5);
+    }
+}
+
+void json_writer_add_null(json_writer_t * writer, const char * key) {
+    json_writer_value(writer, key);
+    json_writer_put(writer, "null", 4);
+}
+
+void json_writer_add_raw(json_writer_t * writer, const char * key, const char * json, size_t length) {
+    json_writer_value(writer, key);
+    json_writer_put(writer, json, length);
+}
+
+void json_writer_append(json_writer_t * writer, const char * text, size_t length) {
+    json_writer_put(writer, text, length);
+}
+
+const char * json_writer_str(const json_writer_t * writer) {
+    return writer->data;
+}
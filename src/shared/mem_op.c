@@ -11,6 +11,23 @@
 #include "mem_op.h"
 #include "shared.h"
 
+#ifdef __linux__
+#include <malloc.h>
+
+/* jemalloc options, read at its first allocation. MALLOC_CONF overrides them.
+ * Threads keep their own cache and share one arena per CPU, the background
+ * thread gives the dirty pages back to the system. */
+const char *malloc_conf = "percpu_arena:percpu,background_thread:true,dirty_decay_ms:5000,muzzy_decay_ms:5000";
+
+/* Defined if jemalloc is linked or preloaded */
+extern int mallctl(const char *name, void *oldp, size_t *oldlenp, void *newp, size_t newlen) __attribute__((weak));
+#endif
+
+static w_metric_t *metric_mem_allocated;
+static w_metric_t *metric_mem_active;
+static w_metric_t *metric_mem_resident;
+static w_metric_t *metric_mem_fragmentation;
+
 /* Add pointer to array */
 void **os_AddPtArray(void *pt, void **array)
 {
@@ -130,3 +147,107 @@ void *memset_secure(void *v, int c, size_t n)
 
     return v;
 }
+
+#ifdef __linux__
+/* Read a statistic of jemalloc */
+static size_t mem_jemalloc_stat(const char *name)
+{
+    size_t value = 0;
+    size_t size = sizeof(value);
+
+    if (mallctl(name, &value, &size, NULL, 0) != 0) {
+        return 0;
+    }
+
+    return value;
+}
+
+/* Resident set size of the process */
+static size_t mem_resident(void)
+{
+    unsigned long pages = 0;
+    FILE *fp;
+
+    if (fp = fopen("/proc/self/statm", "r"), !fp) {
+        return 0;
+    }
+
+    if (fscanf(fp, "%*u %lu", &pages) != 1) {
+        pages = 0;
+    }
+
+    fclose(fp);
+    return pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+#endif
+
+int w_mem_stats(w_mem_stats_t *stats)
+{
+#ifdef __linux__
+    memset(stats, 0, sizeof(w_mem_stats_t));
+
+    if (mallctl) {
+        /* Statistics are cached by jemalloc until the epoch is advanced */
+        uint64_t epoch = 1;
+        size_t size = sizeof(epoch);
+
+        mallctl("epoch", &epoch, &size, &epoch, size);
+
+        stats->allocator = "jemalloc";
+        stats->allocated = mem_jemalloc_stat("stats.allocated");
+        stats->active = mem_jemalloc_stat("stats.active");
+        stats->resident = mem_jemalloc_stat("stats.resident");
+        return 0;
+    }
+
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+    struct mallinfo2 info = mallinfo2();
+
+    stats->allocated = info.uordblks + info.hblkhd;
+    stats->active = info.arena + info.hblkhd;
+#else
+    /* mallinfo() counters wrap at 4 GiB */
+    struct mallinfo info = mallinfo();
+
+    stats->allocated = (size_t)(unsigned int)info.uordblks + (unsigned int)info.hblkhd;
+    stats->active = (size_t)(unsigned int)info.arena + (unsigned int)info.hblkhd;
+#endif
+
+    stats->allocator = "system";
+    stats->resident = mem_resident();
+    return 0;
+#endif
+#endif
+
+    return -1;
+}
+
+/* Sample the heap usage into the gauges */
+static void mem_metrics_collect(void)
+{
+    w_mem_stats_t stats;
+
+    if (w_mem_stats(&stats) == 0) {
+        w_metrics_set(metric_mem_allocated, stats.allocated);
+        w_metrics_set(metric_mem_active, stats.active);
+        w_metrics_set(metric_mem_resident, stats.resident);
+        w_metrics_set(metric_mem_fragmentation, stats.active > stats.allocated ? stats.active - stats.allocated : 0);
+    }
+}
+
+void w_mem_metrics_init(void)
+{
+    w_mem_stats_t stats;
+
+    if (w_mem_stats(&stats) == 0) {
+        mdebug1("Memory allocator: %s.", stats.allocator);
+    }
+
+    metric_mem_allocated = w_metrics_gauge("memory_allocated_bytes", "Heap bytes allocated by the process");
+    metric_mem_active = w_metrics_gauge("memory_active_bytes", "Heap bytes of the pages or chunks that hold the allocations");
+    metric_mem_resident = w_metrics_gauge("memory_resident_bytes", "Resident bytes of the process");
+    metric_mem_fragmentation = w_metrics_gauge("memory_fragmentation_bytes", "Heap bytes held but not allocated");
+
+    w_metrics_collector(mem_metrics_collect);
+}
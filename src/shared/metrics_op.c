@@ -0,0 +1,502 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "metrics_op.h"
+
+/* Shards are one cache line apart so that threads don't invalidate each other's slot */
+#define METRICS_CACHE_LINE  64
+
+#define METRICS_MAX_VALUE   ((1ULL << W_METRICS_MAX_BITS) - 1)
+
+#define METRICS_MAX_COLLECTORS  8
+
+#ifdef __ATOMIC_SEQ_CST
+#define metric_load(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+#define metric_store(p, v) __atomic_store_n(p, v, __ATOMIC_RELAXED)
+#define metric_fetch_add(p, v) __atomic_fetch_add(p, v, __ATOMIC_RELAXED)
+#define metric_cas(p, expected, desired) \
+    __atomic_compare_exchange_n(p, expected, desired, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#else
+static pthread_mutex_t metric_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t metric_load(uint64_t *p) {
+    uint64_t ret;
+
+    w_mutex_lock(&metric_mutex);
+    ret = *p;
+    w_mutex_unlock(&metric_mutex);
+
+    return ret;
+}
+
+static void metric_store(uint64_t *p, uint64_t value) {
+    w_mutex_lock(&metric_mutex);
+    *p = value;
+    w_mutex_unlock(&metric_mutex);
+}
+
+static uint64_t metric_fetch_add(uint64_t *p, uint64_t value) {
+    uint64_t ret;
+
+    w_mutex_lock(&metric_mutex);
+    ret = *p;
+    *p += value;
+    w_mutex_unlock(&metric_mutex);
+
+    return ret;
+}
+
+static bool metric_cas(uint64_t *p, uint64_t *expected, uint64_t desired) {
+    bool ret;
+
+    w_mutex_lock(&metric_mutex);
+
+    if (ret = *p == *expected, ret) {
+        *p = desired;
+    } else {
+        *expected = *p;
+    }
+
+    w_mutex_unlock(&metric_mutex);
+
+    return ret;
+}
+#endif
+
+typedef struct metric_slot_t {
+    uint64_t value;
+    char padding[METRICS_CACHE_LINE - sizeof(uint64_t)];
+} metric_slot_t;
+
+typedef struct metric_histogram_t {
+    uint64_t buckets[W_METRICS_BUCKETS];
+    uint64_t sum;
+    uint64_t max;
+    char padding[METRICS_CACHE_LINE];
+} metric_histogram_t;
+
+struct w_metric_s {
+    char * name;
+    char * help;
+    w_metric_type_t type;
+    uint64_t gauge;                     ///< Gauge value, as a two's complement int64_t
+    metric_slot_t * slots;              ///< Counter shards
+    metric_histogram_t * histograms;    ///< Histogram shards
+    struct w_metric_s * next;
+};
+
+static w_metric_t * metrics_head;
+static w_metric_t * metrics_tail;
+static pthread_mutex_t metrics_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Functions that sample their gauges before every dump */
+static void (*metrics_collectors[METRICS_MAX_COLLECTORS])(void);
+static unsigned int metrics_collectors_size;
+static uint64_t metrics_next_shard;
+
+static const struct {
+    double percentile;
+    const char * name;
+    const char * quantile;
+} metrics_percentiles[] = {
+    { 50, "p50", "0.5" },
+    { 90, "p90", "0.9" },
+    { 99, "p99", "0.99" },
+    { 99.9, "p999", "0.999" }
+};
+
+/* Shard of the calling thread, taken the first time it updates a metric */
+static unsigned int metrics_shard() {
+    static __thread unsigned int shard;
+
+    if (shard == 0) {
+        shard = metric_fetch_add(&metrics_next_shard, 1) % W_METRICS_SHARDS + 1;
+    }
+
+    return shard - 1;
+}
+
+static unsigned int bucket_index(uint64_t value) {
+    if (value > METRICS_MAX_VALUE) {
+        value = METRICS_MAX_VALUE;
+    }
+
+    if (value < W_METRICS_LINEAR_BUCKETS) {
+        return value;
+    }
+
+    // Keep the five most significant bits: a power of two and 16 steps within it
+    const unsigned int shift = 63 - __builtin_clzll(value) - 4;
+
+    return W_METRICS_LINEAR_BUCKETS + (shift - 1) * W_METRICS_SUB_BUCKETS + (unsigned int)(value >> shift) - W_METRICS_SUB_BUCKETS;
+}
+
+static uint64_t bucket_highest(unsigned int index) {
+    if (index < W_METRICS_LINEAR_BUCKETS) {
+        return index;
+    }
+
+    const unsigned int shift = (index - W_METRICS_LINEAR_BUCKETS) / W_METRICS_SUB_BUCKETS + 1;
+    const uint64_t mantissa = (index - W_METRICS_LINEAR_BUCKETS) % W_METRICS_SUB_BUCKETS + W_METRICS_SUB_BUCKETS;
+
+    return ((mantissa + 1) << shift) - 1;
+}
+
+static w_metric_t * metrics_register(const char * name, const char * help, w_metric_type_t type) {
+    w_metric_t * metric;
+
+    assert(name != NULL);
+
+    w_mutex_lock(&metrics_mutex);
+
+    for (metric = metrics_head; metric != NULL; metric = metric->next) {
+        if (strcmp(metric->name, name) == 0) {
+            break;
+        }
+    }
+
+    if (metric == NULL) {
+        os_calloc(1, sizeof(w_metric_t), metric);
+        os_strdup(name, metric->name);
+        os_strdup(help ? help : "", metric->help);
+        metric->type = type;
+
+        if (type == W_METRIC_COUNTER) {
+            os_calloc(W_METRICS_SHARDS, sizeof(metric_slot_t), metric->slots);
+        } else if (type == W_METRIC_HISTOGRAM) {
+            os_calloc(W_METRICS_SHARDS, sizeof(metric_histogram_t), metric->histograms);
+        }
+
+        if (metrics_tail != NULL) {
+            metrics_tail->next = metric;
+        } else {
+            metrics_head = metric;
+        }
+
+        metrics_tail = metric;
+    } else if (metric->type != type) {
+        merror("Metric '%s' is already registered with another type.", name);
+        metric = NULL;
+    }
+
+    w_mutex_unlock(&metrics_mutex);
+
+    return metric;
+}
+
+/* Run the collectors, out of the registry lock since they may register their gauges */
+static void metrics_collect(void) {
+    void (*collectors[METRICS_MAX_COLLECTORS])(void);
+    unsigned int size;
+
+    w_mutex_lock(&metrics_mutex);
+    size = metrics_collectors_size;
+    memcpy(collectors, metrics_collectors, size * sizeof(collectors[0]));
+    w_mutex_unlock(&metrics_mutex);
+
+    for (unsigned int i = 0; i < size; i++) {
+        collectors[i]();
+    }
+}
+
+w_metric_t * w_metrics_counter(const char * name, const char * help) {
+    return metrics_register(name, help, W_METRIC_COUNTER);
+}
+
+w_metric_t * w_metrics_gauge(const char * name, const char * help) {
+    return metrics_register(name, help, W_METRIC_GAUGE);
+}
+
+w_metric_t * w_metrics_histogram(const char * name, const char * help) {
+    return metrics_register(name, help, W_METRIC_HISTOGRAM);
+}
+
+void w_metrics_add(w_metric_t * counter, uint64_t value) {
+    if (counter != NULL && counter->type == W_METRIC_COUNTER) {
+        metric_fetch_add(&counter->slots[metrics_shard()].value, value);
+    }
+}
+
+void w_metrics_set(w_metric_t * gauge, int64_t value) {
+    if (gauge != NULL && gauge->type == W_METRIC_GAUGE) {
+        metric_store(&gauge->gauge, (uint64_t)value);
+    }
+}
+
+void w_metrics_shift(w_metric_t * gauge, int64_t delta) {
+    if (gauge != NULL && gauge->type == W_METRIC_GAUGE) {
+        metric_fetch_add(&gauge->gauge, (uint64_t)delta);
+    }
+}
+
+void w_metrics_record(w_metric_t * histogram, uint64_t value) {
+    if (histogram == NULL || histogram->type != W_METRIC_HISTOGRAM) {
+        return;
+    }
+
+    metric_histogram_t * shard = &histogram->histograms[metrics_shard()];
+    uint64_t max = metric_load(&shard->max);
+
+    metric_fetch_add(&shard->buckets[bucket_index(value)], 1);
+    metric_fetch_add(&shard->sum, value);
+
+    while (value > max && !metric_cas(&shard->max, &max, value));
+}
+
+void w_metrics_record_since(w_metric_t * histogram, const struct timespec * start) {
+    struct timespec now = { 0, 0 };
+
+    gettime(&now);
+
+    const int64_t elapsed = (int64_t)(now.tv_sec - start->tv_sec) * 1000000 + (now.tv_nsec - start->tv_nsec) / 1000;
+
+    w_metrics_record(histogram, elapsed > 0 ? (uint64_t)elapsed : 0);
+}
+
+/* Histogram shards summed up into a single one */
+static void histogram_merge(w_metric_t * histogram, metric_histogram_t * merged, uint64_t * count) {
+    *count = 0;
+
+    for (unsigned int i = 0; i < W_METRICS_SHARDS; i++) {
+        metric_histogram_t * shard = &histogram->histograms[i];
+
+        for (unsigned int j = 0; j < W_METRICS_BUCKETS; j++) {
+            const uint64_t samples = metric_load(&shard->buckets[j]);
+
+            merged->buckets[j] += samples;
+            *count += samples;
+        }
+
+        merged->sum += metric_load(&shard->sum);
+        const uint64_t max = metric_load(&shard->max);
+        merged->max = max > merged->max ? max : merged->max;
+    }
+}
+
+static uint64_t histogram_percentile(const metric_histogram_t * merged, uint64_t count, double percentile) {
+    if (count == 0) {
+        return 0;
+    }
+
+    // Rank of the sample, the first one at least
+    uint64_t rank = (uint64_t)(percentile / 100 * count + 0.5);
+    uint64_t seen = 0;
+
+    rank = rank < 1 ? 1 : rank > count ? count : rank;
+
+    for (unsigned int i = 0; i < W_METRICS_BUCKETS; i++) {
+        if (seen += merged->buckets[i], seen >= rank) {
+            const uint64_t highest = bucket_highest(i);
+            return highest < merged->max ? highest : merged->max;
+        }
+    }
+
+    return merged->max;
+}
+
+int64_t w_metrics_value(w_metric_t * metric) {
+    uint64_t value = 0;
+
+    if (metric == NULL) {
+        return 0;
+    }
+
+    switch (metric->type) {
+    case W_METRIC_COUNTER:
+        for (unsigned int i = 0; i < W_METRICS_SHARDS; i++) {
+            value += metric_load(&metric->slots[i].value);
+        }
+        break;
+
+    case W_METRIC_GAUGE:
+        value = metric_load(&metric->gauge);
+        break;
+
+    case W_METRIC_HISTOGRAM:
+        for (unsigned int i = 0; i < W_METRICS_SHARDS; i++) {
+            for (unsigned int j = 0; j < W_METRICS_BUCKETS; j++) {
+                value += metric_load(&metric->histograms[i].buckets[j]);
+            }
+        }
+    }
+
+    return (int64_t)value;
+}
+
+uint64_t w_metrics_percentile(w_metric_t * histogram, double percentile) {
+    metric_histogram_t * merged;
+    uint64_t count;
+    uint64_t value;
+
+    if (histogram == NULL || histogram->type != W_METRIC_HISTOGRAM) {
+        return 0;
+    }
+
+    os_calloc(1, sizeof(metric_histogram_t), merged);
+    histogram_merge(histogram, merged, &count);
+    value = histogram_percentile(merged, count, percentile);
+    os_free(merged);
+
+    return value;
+}
+
+cJSON * w_metrics_json(void) {
+    cJSON * root = cJSON_CreateObject();
+    metric_histogram_t * merged;
+    uint64_t count;
+
+    metrics_collect();
+    os_malloc(sizeof(metric_histogram_t), merged);
+    w_mutex_lock(&metrics_mutex);
+
+    for (w_metric_t * metric = metrics_head; metric != NULL; metric = metric->next) {
+        if (metric->type != W_METRIC_HISTOGRAM) {
+            cJSON_AddNumberToObject(root, metric->name, w_metrics_value(metric));
+            continue;
+        }
+
+        cJSON * histogram = cJSON_AddObjectToObject(root, metric->name);
+
+        memset(merged, 0, sizeof(metric_histogram_t));
+        histogram_merge(metric, merged, &count);
+
+        cJSON_AddNumberToObject(histogram, "count", count);
+        cJSON_AddNumberToObject(histogram, "sum", merged->sum);
+        cJSON_AddNumberToObject(histogram, "max", merged->max);
+
+        for (unsigned int i = 0; i < sizeof(metrics_percentiles) / sizeof(metrics_percentiles[0]); i++) {
+            cJSON_AddNumberToObject(histogram, metrics_percentiles[i].name,
+                                    histogram_percentile(merged, count, metrics_percentiles[i].percentile));
+        }
+    }
+
+    w_mutex_unlock(&metrics_mutex);
+    os_free(merged);
+
+    return root;
+}
+
+/* Append formatted text to a growing buffer */
+static void metrics_append(char ** buffer, size_t * length, size_t * size, const char * format, ...) {
+    va_list args;
+    int written;
+
+    va_start(args, format);
+    written = vsnprintf(*buffer + *length, *size - *length, format, args);
+    va_end(args);
+
+    if (written < 0) {
+        return;
+    }
+
+    if ((size_t)written >= *size - *length) {
+        *size = (*length + written + 1) * 2;
+        os_realloc(*buffer, *size, *buffer);
+
+        va_start(args, format);
+        written = vsnprintf(*buffer + *length, *size - *length, format, args);
+        va_end(args);
+    }
+
+    *length += written;
+}
+
+char * w_metrics_prometheus(void) {
+    metric_histogram_t * merged;
+    size_t length = 0;
+    size_t size = OS_SIZE_4096;
+    uint64_t count;
+    char * buffer;
+
+    metrics_collect();
+    os_calloc(size, sizeof(char), buffer);
+    os_malloc(sizeof(metric_histogram_t), merged);
+    w_mutex_lock(&metrics_mutex);
+
+    for (w_metric_t * metric = metrics_head; metric != NULL; metric = metric->next) {
+        if (*metric->help) {
+            metrics_append(&buffer, &length, &size, "# HELP %s %s\n", metric->name, metric->help);
+        }
+
+        if (metric->type != W_METRIC_HISTOGRAM) {
+            metrics_append(&buffer, &length, &size, "# TYPE %s %s\n%s %" PRId64 "\n", metric->name,
+                           metric->type == W_METRIC_COUNTER ? "counter" : "gauge", metric->name, w_metrics_value(metric));
+            continue;
+        }
+
+        memset(merged, 0, sizeof(metric_histogram_t));
+        histogram_merge(metric, merged, &count);
+
+        metrics_append(&buffer, &length, &size, "# TYPE %s summary\n", metric->name);
+
+        for (unsigned int i = 0; i < sizeof(metrics_percentiles) / sizeof(metrics_percentiles[0]); i++) {
+            metrics_append(&buffer, &length, &size, "%s{quantile=\"%s\"} %" PRIu64 "\n", metric->name,
+                           metrics_percentiles[i].quantile, histogram_percentile(merged, count, metrics_percentiles[i].percentile));
+        }
+
+        metrics_append(&buffer, &length, &size, "%s_sum %" PRIu64 "\n%s_count %" PRIu64 "\n",
+                       metric->name, merged->sum, metric->name, count);
+    }
+
+    w_mutex_unlock(&metrics_mutex);
+    os_free(merged);
+
+    return buffer;
+}
+
+void w_metrics_collector(void (*collector)(void)) {
+    w_mutex_lock(&metrics_mutex);
+
+    if (metrics_collectors_size < METRICS_MAX_COLLECTORS) {
+        metrics_collectors[metrics_collectors_size++] = collector;
+    } else {
+        merror("Too many metrics collectors.");
+    }
+
+    w_mutex_unlock(&metrics_mutex);
+}
+
+size_t w_metrics_getmetrics(const char * format, char ** output) {
+    char * dump;
+
+    if (format == NULL || strcmp(format, "json") == 0) {
+        cJSON * metrics = w_metrics_json();
+        dump = cJSON_PrintUnformatted(metrics);
+        cJSON_Delete(metrics);
+    } else if (strcmp(format, "prometheus") == 0) {
+        dump = w_metrics_prometheus();
+    } else {
+        os_strdup("err Unrecognized metrics format", *output);
+        return strlen(*output);
+    }
+
+    os_strdup("ok", *output);
+    wm_strcat(output, dump, ' ');
+    os_free(dump);
+
+    return strlen(*output);
+}
+
+cJSON * w_metrics_getmetrics_json(const cJSON * parameters) {
+    const cJSON * format = cJSON_GetObjectItem(parameters, "format");
+
+    if (cJSON_IsString(format) && strcmp(format->valuestring, "prometheus") == 0) {
+        cJSON * data = cJSON_CreateObject();
+        char * dump = w_metrics_prometheus();
+
+        cJSON_AddStringToObject(data, "prometheus", dump);
+        os_free(dump);
+
+        return data;
+    }
+
+    return w_metrics_json();
+}
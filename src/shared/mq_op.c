@@ -149,6 +149,229 @@ int SendMSG(int queue, const char *message, const char *locmsg, char loc) {
     return SendMSGAction(queue, message, locmsg, loc);
 }
 
+#ifdef __linux__
+/* Send a batch of messages to the queue with one sendmmsg call */
+int SendMSGBatch(int queue, char * const * messages, const char * const * locmsgs, const char * locs, logtarget * const * targets, unsigned int count) {
+    static __thread char * arena;
+    struct mmsghdr msgs[MQ_BATCH_MAX];
+    struct iovec iov[MQ_BATCH_MAX];
+    unsigned int origin[MQ_BATCH_MAX];
+    char loc_buff[OS_SIZE_8192 + 1];
+    unsigned int built = 0;
+    unsigned int i;
+    size_t used = 0;
+    int sent;
+
+    if (queue < 0) {
+        return -1;
+    }
+
+    if (arena == NULL) {
+        os_malloc(MQ_BATCH_BYTES, arena);
+    }
+
+    count = MIN(count, MQ_BATCH_MAX);
+    os_wait();
+
+    /* Format the messages as SendMSGtoSCK does, while they fit in the arena */
+    for (i = 0; i < count && used + OS_MAXSTR + 1 <= MQ_BATCH_BYTES; i++) {
+        char * _message;
+        int length;
+
+        if (OS_INVALID == wstr_escape(loc_buff, sizeof(loc_buff), (char *) locmsgs[i], '|', ':')) {
+            merror(FORMAT_ERROR);
+            continue;
+        }
+
+        _message = log_builder_build(mq_log_builder, targets[i]->format, messages[i], locmsgs[i]);
+        length = snprintf(arena + used, OS_MAXSTR, "%c:%s:%s", locs[i], loc_buff, _message);
+        free(_message);
+
+        length = MIN(length, OS_MAXSTR - 1) + 1;
+        iov[built].iov_base = arena + used;
+        iov[built].iov_len = length;
+        memset(&msgs[built].msg_hdr, 0, sizeof(struct msghdr));
+        msgs[built].msg_hdr.msg_iov = &iov[built];
+        msgs[built].msg_hdr.msg_iovlen = 1;
+        origin[built++] = i;
+        used += length;
+    }
+
+    if (built == 0) {
+        return i;
+    }
+
+    while (sent = sendmmsg(queue, msgs, built, 0), sent < 0 && errno == EINTR);
+
+    if (sent < 0) {
+        if (errno == ENOBUFS || errno == EAGAIN) {
+            mdebug2("Socket busy, the messages will be sent again.");
+            return origin[0];
+        }
+
+        merror("socketerr (not available).");
+        close(queue);
+        return -1;
+    }
+
+    /* The messages that couldn't be formatted count as sent */
+    return (unsigned int)sent == built ? (int)i : (int)origin[sent];
+}
+#endif
+
+/* Allocate an empty batch */
+mq_batch_t * mq_batch_init(int queue) {
+    mq_batch_t * batch;
+
+    os_calloc(1, sizeof(mq_batch_t), batch);
+    os_malloc(MQ_BATCH_BYTES, batch->arena);
+    batch->queue = queue;
+    batch->header_offset = -1;
+
+    return batch;
+}
+
+/* Free a batch */
+void mq_batch_free(mq_batch_t * batch) {
+    if (batch == NULL) {
+        return;
+    }
+
+    os_free(batch->arena);
+    os_free(batch->locmsg);
+    os_free(batch);
+}
+
+/* Format a message and add it to the batch */
+int mq_batch_push(mq_batch_t * batch, const char * message, const char * locmsg, char loc) {
+    bool secure = false;
+    size_t length;
+
+    if (loc == SECURE_MQ) {
+        loc = message[0];
+        message++;
+
+        if (message[0] != ':') {
+            merror(FORMAT_ERROR);
+            return 0;
+        }
+        message++; /* Pointing now to the location */
+
+        if (strncmp(message, "keepalive", 9) == 0) {
+            return 0;
+        }
+
+        secure = true;
+    }
+
+    /* Format the header only when the location changes */
+    if (batch->locmsg == NULL || batch->loc != loc || batch->secure != secure || strcmp(batch->locmsg, locmsg) != 0) {
+        char loc_buff[OS_SIZE_8192 + 1];
+
+        if (OS_INVALID == wstr_escape(loc_buff, sizeof(loc_buff), (char *) locmsg, '|', ':')) {
+            merror(FORMAT_ERROR);
+            return 0;
+        }
+
+        batch->header_len = snprintf(batch->header, sizeof(batch->header), secure ? "%c:%s->" : "%c:%s:", loc, loc_buff);
+        batch->header_offset = -1;
+        batch->loc = loc;
+        batch->secure = secure;
+        os_free(batch->locmsg);
+        os_strdup(locmsg, batch->locmsg);
+    }
+
+    /* Truncate as SendMSG() does, and leave room for the terminator */
+    length = MIN(strlen(message), OS_MAXSTR - 1 - batch->header_len);
+
+    if (batch->count == MQ_BATCH_MAX || batch->used + batch->header_len + length + 1 > MQ_BATCH_BYTES) {
+        if (mq_batch_flush(batch) < 0) {
+            return -1;
+        }
+    }
+
+    if (batch->header_offset < 0) {
+        memcpy(batch->arena + batch->used, batch->header, batch->header_len);
+        batch->header_offset = batch->used;
+        batch->used += batch->header_len;
+    }
+
+    memcpy(batch->arena + batch->used, message, length);
+    batch->arena[batch->used + length] = '\0';
+
+    batch->iov[2 * batch->count].iov_base = batch->arena + batch->header_offset;
+    batch->iov[2 * batch->count].iov_len = batch->header_len;
+    batch->iov[2 * batch->count + 1].iov_base = batch->arena + batch->used;
+    batch->iov[2 * batch->count + 1].iov_len = length + 1;
+
+    batch->used += length + 1;
+    batch->count++;
+
+    return 0;
+}
+
+/* Send the messages of the batch */
+int mq_batch_flush(mq_batch_t * batch) {
+    static int reported = 0;
+    int sent;
+
+    if (batch->count == 0) {
+        return 0;
+    }
+
+    if (batch->queue < 0) {
+        return -1;
+    }
+
+    /* Check for global locks */
+    os_wait();
+
+    while (batch->sent < batch->count) {
+#ifdef __linux__
+        struct mmsghdr msgs[MQ_BATCH_MAX];
+        unsigned int i;
+
+        memset(msgs, 0, sizeof(struct mmsghdr) * (batch->count - batch->sent));
+
+        for (i = batch->sent; i < batch->count; i++) {
+            msgs[i - batch->sent].msg_hdr.msg_iov = &batch->iov[2 * i];
+            msgs[i - batch->sent].msg_hdr.msg_iovlen = 2;
+        }
+
+        sent = sendmmsg(batch->queue, msgs, batch->count - batch->sent, 0);
+#else
+        struct msghdr msg = { .msg_iov = &batch->iov[2 * batch->sent], .msg_iovlen = 2 };
+        sent = sendmsg(batch->queue, &msg, 0) < 0 ? -1 : 1;
+#endif
+
+        if (sent > 0) {
+            batch->sent += sent;
+        } else if (errno == ENOBUFS) {
+            /* Unable to send. Socket busy */
+            mdebug2("Socket busy, discarding message.");
+
+            if (!reported) {
+                reported = 1;
+                mwarn("Socket busy, discarding message.");
+            }
+
+            batch->sent++;
+        } else if (errno != EINTR) {
+            merror("socketerr (not available).");
+            close(batch->queue);
+            batch->queue = -1;
+            return -1;
+        }
+    }
+
+    batch->used = 0;
+    batch->count = 0;
+    batch->sent = 0;
+    batch->header_offset = -1;
+
+    return 0;
+}
+
 /* Send a message to socket */
 int SendMSGtoSCK(int queue, const char *message, const char *locmsg, __attribute__((unused)) char loc, logtarget * target)
 {
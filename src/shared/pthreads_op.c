@@ -13,11 +13,160 @@
 #include <pthread.h>
 #include <sys/resource.h>
 
-/* Create a new thread and give the argument passed to the function
+#ifdef __linux__
+#include <sched.h>
+
+#define NUMA_NODE_CPULIST "/sys/devices/system/node/node%u/cpulist"
+
+struct w_cpuset_s {
+    cpu_set_t set;
+};
+
+/* Add a list of CPUs and CPU ranges to a set. Returns 0 on success or -1 on error */
+static int cpuset_add_list(cpu_set_t * set, const char * list) {
+    const char * pt = list;
+    char * end;
+
+    while (*pt != '\0') {
+        if (!isdigit((unsigned char)*pt)) {
+            return -1;
+        }
+
+        unsigned long first = strtoul(pt, &end, 10);
+        unsigned long last = first;
+
+        if (*end == '-') {
+            if (pt = end + 1, !isdigit((unsigned char)*pt)) {
+                return -1;
+            }
+
+            last = strtoul(pt, &end, 10);
+        }
+
+        if (last < first || last >= CPU_SETSIZE || (*end != ',' && *end != '\0')) {
+            return -1;
+        }
+
+        for (unsigned long cpu = first; cpu <= last; cpu++) {
+            CPU_SET(cpu, set);
+        }
+
+        pt = *end == ',' ? end + 1 : end;
+    }
+
+    return 0;
+}
+
+/* Add the CPUs of a NUMA node to a set. Returns 0 on success or -1 on error */
+static int cpuset_add_node(cpu_set_t * set, unsigned int node) {
+    char path[PATH_MAX];
+    char list[OS_SIZE_4096];
+    FILE * fp;
+    int ret = -1;
+
+    snprintf(path, sizeof(path), NUMA_NODE_CPULIST, node);
+
+    if (fp = wfopen(path, "r"), !fp) {
+        return -1;
+    }
+
+    if (fgets(list, sizeof(list), fp)) {
+        list[strcspn(list, "\n")] = '\0';
+        ret = cpuset_add_list(set, list);
+    }
+
+    fclose(fp);
+    return ret;
+}
+
+w_cpuset_t * w_cpuset_parse(const char * spec) {
+    w_cpuset_t * cpus;
+    char * copy;
+    char * item;
+    char * save = NULL;
+    int ret = 0;
+
+    os_calloc(1, sizeof(w_cpuset_t), cpus);
+    os_strdup(spec, copy);
+
+    for (item = strtok_r(copy, ",", &save); item && ret == 0; item = strtok_r(NULL, ",", &save)) {
+        item = w_strtrim(item);
+
+        if (strncmp(item, "node", 4) == 0) {
+            char * end;
+            unsigned long node = strtoul(item + 4, &end, 10);
+
+            ret = isdigit((unsigned char)item[4]) && *end == '\0' ? cpuset_add_node(&cpus->set, node) : -1;
+        } else {
+            ret = cpuset_add_list(&cpus->set, item);
+        }
+    }
+
+    os_free(copy);
+
+    if (ret != 0 || CPU_COUNT(&cpus->set) == 0) {
+        os_free(cpus);
+    }
+
+    return cpus;
+}
+
+bool w_cpuset_contains(const w_cpuset_t * cpus, unsigned int cpu) {
+    return cpu < CPU_SETSIZE && CPU_ISSET(cpu, &cpus->set);
+}
+
+int w_set_thread_affinity(const w_cpuset_t * cpus) {
+    int error;
+
+    if (cpus == NULL) {
+        return 0;
+    }
+
+    if (error = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus->set), error) {
+        merror("Cannot set the CPU affinity of the thread: %s (%d)", strerror(error), error);
+        return -1;
+    }
+
+    return 0;
+}
+#else
+w_cpuset_t * w_cpuset_parse(__attribute__((unused)) const char * spec) {
+    return NULL;
+}
+
+bool w_cpuset_contains(__attribute__((unused)) const w_cpuset_t * cpus, __attribute__((unused)) unsigned int cpu) {
+    return false;
+}
+
+int w_set_thread_affinity(__attribute__((unused)) const w_cpuset_t * cpus) {
+    return 0;
+}
+#endif
+
+w_cpuset_t * w_cpuset_load(const char * high_name, const char * low_name) {
+    w_cpuset_t * cpus = NULL;
+    char * spec = getDefine_String(high_name, low_name);
+
+    if (*w_strtrim(spec) != '\0') {
+#ifdef __linux__
+        if (cpus = w_cpuset_parse(spec), !cpus) {
+            mwarn("Invalid CPU set '%s' for '%s.%s'. The threads are left to the scheduler.", spec, high_name, low_name);
+        }
+#else
+        mwarn("CPU affinity is not supported on this platform. Ignoring '%s.%s'.", high_name, low_name);
+#endif
+    }
+
+    os_free(spec);
+    return cpus;
+}
+
+/* Create a new thread and give the argument passed to the function. A CPU
+ * set, if any, applies from the start so the thread stack is allocated on
+ * its own NUMA node.
  * Returns 0 on success or -1 on error
  */
-
-int CreateThreadJoinable(pthread_t *lthread, void * (*function_pointer)(void *), void *data)
+static int create_thread(pthread_t *lthread, void * (*function_pointer)(void *), void *data, const w_cpuset_t *cpus)
 {
     pthread_attr_t attr;
     size_t read_size = 0;
@@ -44,6 +193,15 @@ int CreateThreadJoinable(pthread_t *lthread, void * (*function_pointer)(void *),
 
     mdebug2("Thread stack size set to: %d KiB", (int)stacksize / 1024);
 
+#ifdef __linux__
+    if (cpus && (ret = pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &cpus->set), ret != 0)) {
+        merror(THREAD_ERROR " Cannot set the CPU affinity: %s (%d)", strerror(ret), ret);
+        return -1;
+    }
+#else
+    (void)cpus;
+#endif
+
     ret = pthread_create(lthread, &attr, function_pointer, (void *)data);
     if (ret != 0) {
         merror(THREAD_ERROR " %s (%d)", strerror(ret), ret);
@@ -55,6 +213,27 @@ int CreateThreadJoinable(pthread_t *lthread, void * (*function_pointer)(void *),
     return (0);
 }
 
+int CreateThreadJoinable(pthread_t *lthread, void * (*function_pointer)(void *), void *data)
+{
+    return create_thread(lthread, function_pointer, data, NULL);
+}
+
+int CreateThreadAffinity(void * (*function_pointer)(void *), void *data, const w_cpuset_t *cpus)
+{
+    pthread_t lthread;
+
+    if (create_thread(&lthread, function_pointer, data, cpus) < 0) {
+        return 0;
+    }
+
+    if (pthread_detach(lthread) != 0) {
+        merror(THREAD_ERROR " Cannot detach thread.");
+        return 0;
+    }
+
+    return 1;
+}
+
 int CreateThread(void * (*function_pointer)(void *), void *data)
 {
     pthread_t lthread;
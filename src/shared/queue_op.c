@@ -83,6 +83,28 @@ int queue_push_ex_block(w_queue_t * queue, void * data) {
     return result;
 }
 
+size_t queue_push_ex_batch(w_queue_t * queue, void ** data, size_t n) {
+    size_t count = 0;
+
+    w_mutex_lock(&queue->mutex);
+
+    while (count < n && queue_push(queue, data[count]) == 0) {
+        count++;
+    }
+
+    /* Wake up as many consumers as they can be fed */
+    if (count > 0 && queue->waiting > 0) {
+        if (count > 1 && queue->waiting > 1) {
+            w_cond_broadcast(&queue->available);
+        } else {
+            w_cond_signal(&queue->available);
+        }
+    }
+
+    w_mutex_unlock(&queue->mutex);
+    return count;
+}
+
 void * queue_pop(w_queue_t * queue) {
     void * data;
 
@@ -96,13 +118,36 @@ void * queue_pop(w_queue_t * queue) {
     }
 }
 
+/* Move up to n elements out of the queue, in two copies at most */
+static size_t queue_pop_batch(w_queue_t * queue, void ** data, size_t n) {
+    size_t count = 0;
+
+    while (count < n && !queue_empty(queue)) {
+        const size_t last = queue->begin > queue->end ? queue->begin : queue->size;
+        size_t chunk = last - queue->end;
+
+        if (chunk > n - count) {
+            chunk = n - count;
+        }
+
+        memcpy(data + count, queue->data + queue->end, chunk * sizeof(void *));
+        queue->end = (queue->end + chunk) % queue->size;
+        queue->elements -= chunk;
+        count += chunk;
+    }
+
+    return count;
+}
+
 void * queue_pop_ex(w_queue_t * queue) {
     void * data;
 
     w_mutex_lock(&queue->mutex);
 
     while (data = queue_pop(queue), !data) {
+        queue->waiting++;
         w_cond_wait(&queue->available, &queue->mutex);
+        queue->waiting--;
     }
 
     w_cond_signal(&queue->available_not_empty);
@@ -111,13 +156,60 @@ void * queue_pop_ex(w_queue_t * queue) {
     return data;
 }
 
+size_t queue_pop_ex_batch(w_queue_t * queue, void ** data, size_t n) {
+    size_t count = 0;
+
+    w_mutex_lock(&queue->mutex);
+
+    while (queue_empty(queue)) {
+        queue->waiting++;
+        w_cond_wait(&queue->available, &queue->mutex);
+        queue->waiting--;
+    }
+
+    count = queue_pop_batch(queue, data, n);
+
+    /* Several producers may be waiting for the released slots */
+    w_cond_broadcast(&queue->available_not_empty);
+    w_mutex_unlock(&queue->mutex);
+
+    return count;
+}
+
+size_t queue_pop_ex_batch_timedwait(w_queue_t * queue, void ** data, size_t n, const struct timespec * abstime) {
+    size_t count;
+    int result = 0;
+
+    w_mutex_lock(&queue->mutex);
+
+    while (queue_empty(queue) && result == 0) {
+        queue->waiting++;
+        result = pthread_cond_timedwait(&queue->available, &queue->mutex, abstime);
+        queue->waiting--;
+    }
+
+    if (count = queue_pop_batch(queue, data, n), count > 0) {
+        w_cond_broadcast(&queue->available_not_empty);
+    }
+
+    w_mutex_unlock(&queue->mutex);
+
+    return count;
+}
+
 void * queue_pop_ex_timedwait(w_queue_t * queue, const struct timespec * abstime) {
     void * data;
 
     w_mutex_lock(&queue->mutex);
 
     while (data = queue_pop(queue), !data) {
-        if (pthread_cond_timedwait(&queue->available, &queue->mutex, abstime) != 0) {
+        int result;
+
+        queue->waiting++;
+        result = pthread_cond_timedwait(&queue->available, &queue->mutex, abstime);
+        queue->waiting--;
+
+        if (result != 0) {
             w_mutex_unlock(&queue->mutex);
             return NULL;
         }
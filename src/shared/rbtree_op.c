@@ -38,15 +38,21 @@ void customAssert(bool expression) {
 /**
  * @brief Create and initialize a red-black tree node
  *
+ * The key is stored right after the node, in the same allocation.
+ *
  * @param key Data key. It will be duplicated.
  * @param value Data value.
  * @return Pointer to a newly created node.
  */
 
 static rb_node * rb_init(const char * key, void * value) {
+    size_t size = strlen(key) + 1;
     rb_node * node;
-    os_calloc(1, sizeof(rb_node), node);
-    os_strdup(key, node->key);
+
+    os_malloc(sizeof(rb_node) + size, node);
+    memset(node, 0, sizeof(rb_node));
+    node->key = (char *)(node + 1);
+    memcpy(node->key, key, size);
     node->value = value;
     node->color = RB_RED;
     return node;
@@ -68,8 +74,6 @@ static void rb_destroy(rb_node * node, void (*dispose)(void *)) {
         rb_destroy(node->right, dispose);
     }
 
-    free(node->key);
-
     if (node->value != NULL && dispose != NULL) {
         dispose(node->value);
     }
@@ -347,67 +351,53 @@ static void rb_balance_delete(rb_tree * tree, rb_node * node, rb_node * parent)
 }
 
 /**
- * @brief Get all the keys in a subtree
+ * @brief Get the node with the lowest key not less than a given one
  *
  * @param node Pointer to a red-black tree node.
- * @param array Pointer to the target string array.
- * @param size[in,out] Pointer to the current size of the array.
- * @pre array is expected to be size cells long.
- * @post array is reallocated to size+2 cells long.
- * @post array is no longer valid after calling this function.
- * @return Newly allocated null-terminated array of keys.
+ * @param key Data key (search criteria).
+ * @return Pointer to the first node whose key is greater or equal than key.
+ * @retval NULL All the keys in the subtree are less than key.
  */
 
-static char ** rb_keys(rb_node * node, char ** array, unsigned * size) {
-    if (node->left != NULL) {
-        array = rb_keys(node->left, array, size);
-    }
+static rb_node * rb_lower_bound(rb_node * node, const char * key) {
+    rb_node * bound = NULL;
 
-    os_realloc(array, sizeof(char *) * (*size + 2), array);
-    os_strdup(node->key, array[(*size)++]);
+    while (node != NULL) {
+        int cmp = strcmp(key, node->key);
 
-    if (node->right != NULL) {
-        array = rb_keys(node->right, array, size);
+        if (cmp == 0) {
+            return node;
+        }
+
+        if (cmp < 0) {
+            bound = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
     }
 
-    return array;
+    return bound;
 }
 
 /**
- * @brief Get all the keys from the subtree within a range
+ * @brief Get the in-order successor of a node
  *
  * @param node Pointer to a red-black tree node.
- * @param min Minimum key.
- * @param max Maximum key.
- * @param array Pointer to the target string array.
- * @param size[in,out] Pointer to the current size of the array.
- * @pre array is expected to be size cells long.
- * @post array is reallocated to size+2 cells long.
- * @post array is no longer valid after calling this function.
- * @return Newly allocated null-terminated array of keys.
+ * @return Pointer to the node with the next key.
+ * @retval NULL node holds the maximum key.
  */
 
-static char ** rb_range(rb_node * node, const char * min, const char * max, char ** array, unsigned * size) {
-    int cmp_min = strcmp(node->key, min);
-    int cmp_max = strcmp(node->key, max);
-
-    if (node->left != NULL && cmp_min > 0) {
-        // node > min
-        array = rb_range(node->left, min, max, array, size);
-    }
-
-    if (cmp_min >= 0 && cmp_max <= 0) {
-        // min <= node <= max
-        os_realloc(array, sizeof(char *) * (*size + 2), array);
-        os_strdup(node->key, array[(*size)++]);
+static rb_node * rb_next(rb_node * node) {
+    if (node->right != NULL) {
+        return rb_min(node->right);
     }
 
-    if (node->right != NULL && cmp_max < 0) {
-        // node < min
-        array = rb_range(node->right, min, max, array, size);
+    while (node->parent != NULL && node == node->parent->right) {
+        node = node->parent;
     }
 
-    return array;
+    return node->parent;
 }
 
 /**
@@ -439,19 +429,6 @@ static int rb_black_depth(rb_node * node) {
     return d_left + (node->color == RB_BLACK);
 }
 
-/**
- * @brief Get the size of a subtree
- *
- * This function is recursive: 1 + rb_size(left subtree) + rb_size(right subtree).
- *
- * @param node Pointer to a red-black tree node.
- * @return Number of nodes in the subtree.
- */
-
-unsigned rb_size(rb_node * node) {
-    return (node->left ? rb_size(node->left) : 0) + 1 + (node->right ? rb_size(node->right) : 0);
-}
-
 /* Public functions ***********************************************************/
 
 // Create a red-black tree
@@ -513,6 +490,7 @@ rb_node *rbtree_insert(rb_tree *tree, const char *key, void *value) {
 
     node->parent = parent;
     rb_balance_insert(tree, node);
+    tree->size++;
 
     return node;
 }
@@ -560,9 +538,11 @@ int rbtree_delete(rb_tree * tree, const char * key) {
         return 0;
     }
 
-    // Succesor: node that will be actually deleted
+    // Succesor: node that will be actually unlinked from its position
     rb_node * s = (node->left != NULL && node->right != NULL) ? rb_min(node->right) : node;
     rb_node * t = (s->left != NULL) ? s->left : s->right;
+    rb_node * parent = s->parent;
+    rb_color color = s->color;
 
     if (s->parent == NULL) {
         tree->root = t;
@@ -576,24 +556,46 @@ int rbtree_delete(rb_tree * tree, const char * key) {
         t->parent = s->parent;
     }
 
-    free(node->key);
+    if (node != s) {
+        // Keys live inside their nodes, so the successor takes the place of node
+
+        if (parent == node) {
+            parent = s;
+        }
+
+        s->left = node->left;
+        s->right = node->right;
+        s->parent = node->parent;
+        s->color = node->color;
+
+        if (s->left != NULL) {
+            s->left->parent = s;
+        }
+
+        if (s->right != NULL) {
+            s->right->parent = s;
+        }
+
+        if (node->parent == NULL) {
+            tree->root = s;
+        } else if (node == node->parent->left) {
+            node->parent->left = s;
+        } else {
+            node->parent->right = s;
+        }
+    }
 
     if (node->value && tree->dispose) {
         tree->dispose(node->value);
     }
 
-    if (node != s) {
-        // Copy successor into node
-
-        node->key = s->key;
-        node->value = s->value;
-    }
+    free(node);
+    tree->size--;
 
-    if (s->color == RB_BLACK) {
-        rb_balance_delete(tree, t, s->parent);
+    if (color == RB_BLACK) {
+        rb_balance_delete(tree, t, parent);
     }
 
-    free(s);
     return 1;
 }
 
@@ -619,10 +621,10 @@ char ** rbtree_keys(const rb_tree * tree) {
     unsigned size = 0;
     char ** array;
 
-    os_malloc(sizeof(char *), array);
+    os_malloc(sizeof(char *) * (tree->size + 1), array);
 
-    if (tree->root != NULL) {
-        array = rb_keys(tree->root, array, &size);
+    for (const rb_node * node = rbtree_first(tree); node != NULL; node = rbtree_next(node)) {
+        os_strdup(node->key, array[size++]);
     }
 
     array[size] = NULL;
@@ -637,18 +639,46 @@ char ** rbtree_range(const rb_tree * tree, const char * min, const char * max) {
     assert(max != NULL);
 
     unsigned size = 0;
+    unsigned capacity = 8;
     char ** array;
 
-    os_malloc(sizeof(char *), array);
+    os_malloc(sizeof(char *) * capacity, array);
 
-    if (tree->root != NULL) {
-        array = rb_range(tree->root, min, max, array, &size);
+    for (const rb_node * node = rbtree_lower_bound(tree, min); node != NULL && strcmp(node->key, max) <= 0; node = rbtree_next(node)) {
+        if (size + 1 == capacity) {
+            capacity *= 2;
+            os_realloc(array, sizeof(char *) * capacity, array);
+        }
+
+        os_strdup(node->key, array[size++]);
     }
 
     array[size] = NULL;
     return array;
 }
 
+// Get the node with the minimum key
+
+const rb_node * rbtree_first(const rb_tree * tree) {
+    assert(tree != NULL);
+    return tree->root ? rb_min(tree->root) : NULL;
+}
+
+// Get the first node whose key is not less than a given key
+
+const rb_node * rbtree_lower_bound(const rb_tree * tree, const char * key) {
+    assert(tree != NULL);
+    assert(key != NULL);
+    return rb_lower_bound(tree->root, key);
+}
+
+// Get the node with the next key
+
+const rb_node * rbtree_next(const rb_node * node) {
+    assert(node != NULL);
+    return rb_next((rb_node *)node);
+}
+
 // Get the black depth of a tree
 
 int rbtree_black_depth(const rb_tree * tree) {
@@ -673,7 +703,7 @@ int rbtree_black_depth(const rb_tree * tree) {
 unsigned rbtree_size(const rb_tree * tree) {
     assert(tree != NULL);
 
-    return tree->root ? rb_size(tree->root) : 0;
+    return tree->size;
 }
 
 // Check whether the tree is empty
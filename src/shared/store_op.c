@@ -9,11 +9,166 @@
  */
 
 /* Common API for dealing with ordered lists
- * Provides a fast search on average (n/2)
+ * Provides constant-time lookups on average, through a hash index of the keys
  */
 
 #include "shared.h"
 
+/* Initial buckets of the hash index, it doubles when it gets full */
+#define OS_STORE_MIN_TABLE 64
+
+/* Case-insensitive FNV-1a, so that OSStore_NCaseCheck() can use the index too */
+static unsigned int _os_store_hash(const char *key, size_t size)
+{
+    unsigned int hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        hash = (hash ^ (unsigned char)tolower((unsigned char)key[i])) * 16777619u;
+    }
+
+    return (hash);
+}
+
+/* Find the node of the first size bytes of key */
+static OSStoreNode *_os_store_find(const OSStore *list, const char *key, size_t size, int nocase)
+{
+    OSStoreNode *node;
+    unsigned int hash;
+
+    if (!list->table) {
+        return (NULL);
+    }
+
+    hash = _os_store_hash(key, size);
+
+    for (node = list->table[hash & (list->table_size - 1)]; node; node = node->hash_next) {
+        if (node->hash == hash && node->key_size == size &&
+            (nocase ? strncasecmp(node->key, key, size) : memcmp(node->key, key, size)) == 0) {
+            return (node);
+        }
+    }
+
+    return (NULL);
+}
+
+/* Double the hash index. Returns 0 on error or 1 on success */
+static int _os_store_grow(OSStore *list)
+{
+    unsigned int size = list->table_size ? list->table_size * 2 : OS_STORE_MIN_TABLE;
+    OSStoreNode **table;
+    OSStoreNode *node;
+
+    table = (OSStoreNode **) calloc(size, sizeof(OSStoreNode *));
+    if (!table) {
+        merror(MEM_ERROR, errno, strerror(errno));
+        return (0);
+    }
+
+    for (node = list->first_node; node; node = node->next) {
+        node->hash_next = table[node->hash & (size - 1)];
+        table[node->hash & (size - 1)] = node;
+    }
+
+    free(list->table);
+    list->table = table;
+    list->table_size = size;
+
+    return (1);
+}
+
+/* Add a key size to the ascending set. Returns 0 on error or 1 on success */
+static int _os_store_add_key_size(OSStore *list, size_t size)
+{
+    size_t *key_sizes;
+    unsigned int i;
+
+    for (i = 0; i < list->key_sizes_count && list->key_sizes[i] <= size; i++) {
+        if (list->key_sizes[i] == size) {
+            return (1);
+        }
+    }
+
+    key_sizes = (size_t *) realloc(list->key_sizes, (list->key_sizes_count + 1) * sizeof(size_t));
+    if (!key_sizes) {
+        merror(MEM_ERROR, errno, strerror(errno));
+        return (0);
+    }
+
+    memmove(key_sizes + i + 1, key_sizes + i, (list->key_sizes_count - i) * sizeof(size_t));
+    key_sizes[i] = size;
+    list->key_sizes = key_sizes;
+    list->key_sizes_count++;
+
+    return (1);
+}
+
+/* Merge two lists sorted by key, linked through next */
+static OSStoreNode *_os_store_merge(OSStoreNode *a, OSStoreNode *b)
+{
+    OSStoreNode head;
+    OSStoreNode *tail = &head;
+
+    while (a && b) {
+        if (strcmp(a->key, b->key) <= 0) {
+            tail->next = a;
+            a = a->next;
+        } else {
+            tail->next = b;
+            b = b->next;
+        }
+
+        tail = tail->next;
+    }
+
+    tail->next = a ? a : b;
+
+    return (head.next);
+}
+
+/* Merge sort a list by key, linked through next */
+static OSStoreNode *_os_store_merge_sort(OSStoreNode *first)
+{
+    OSStoreNode *slow = first;
+    OSStoreNode *fast;
+    OSStoreNode *second;
+
+    if (!first || !first->next) {
+        return (first);
+    }
+
+    for (fast = first->next; fast && fast->next; fast = fast->next->next) {
+        slow = slow->next;
+    }
+
+    second = slow->next;
+    slow->next = NULL;
+
+    return (_os_store_merge(_os_store_merge_sort(first), _os_store_merge_sort(second)));
+}
+
+/* Put the list in key order, once after a run of insertions, and number the nodes */
+static void _os_store_sort_keys(OSStore *list)
+{
+    OSStoreNode *prev = NULL;
+    OSStoreNode *node;
+    int position = 1;
+
+    if (list->key_sorted) {
+        return;
+    }
+
+    list->first_node = _os_store_merge_sort(list->first_node);
+
+    for (node = list->first_node; node; node = node->next) {
+        node->prev = prev;
+        node->position = position++;
+        prev = node;
+    }
+
+    list->last_node = prev;
+    list->key_sorted = 1;
+}
 
 /* Create the list storage
  * Returns NULL on error
@@ -33,6 +188,7 @@ OSStore *OSStore_Create()
     my_list->currently_size = 0;
     my_list->max_size = 0;
     my_list->free_data_function = NULL;
+    my_list->key_sorted = 1;
 
     return (my_list);
 }
@@ -64,6 +220,8 @@ OSStore *OSStore_Free(OSStore *list)
     list->first_node = NULL;
     list->last_node = NULL;
 
+    free(list->table);
+    free(list->key_sizes);
     free(list);
     list = NULL;
 
@@ -105,6 +263,9 @@ int OSStore_Sort(OSStore *list, void *(sort_data_function)(void *d1, void *d2))
 {
     OSStoreNode *newnode = NULL;
     OSStoreNode *movenode = NULL;
+
+    _os_store_sort_keys(list);
+    list->data_sorted = 1;
     list->cur_node = list->first_node;
 
     while (list->cur_node) {
@@ -188,24 +349,15 @@ int OSStore_Sort(OSStore *list, void *(sort_data_function)(void *d1, void *d2))
  */
 int OSStore_GetPosition(OSStore *list, const char *key)
 {
-    int chk_rc, pos = 1;
-    list->cur_node = list->first_node;
+    OSStoreNode *node;
 
-    while (list->cur_node) {
-        if ((chk_rc = strcmp(list->cur_node->key, key)) >= 0) {
-            /* Found */
-            if (chk_rc == 0) {
-                return (pos);
-            }
+    if (node = _os_store_find(list, key, strlen(key), 0), !node) {
+        return (0);
+    }
 
-            /* Not found */
-            return (0);
-        }
+    _os_store_sort_keys(list);
 
-        list->cur_node = list->cur_node->next;
-        pos++;
-    }
-    return (0);
+    return (node->position);
 }
 
 /* Get first node from storage
@@ -213,6 +365,8 @@ int OSStore_GetPosition(OSStore *list, const char *key)
  */
 OSStoreNode *OSStore_GetFirstNode(OSStore *list)
 {
+    _os_store_sort_keys(list);
+
     return (list->first_node);
 }
 
@@ -221,23 +375,9 @@ OSStoreNode *OSStore_GetFirstNode(OSStore *list)
  */
 void *OSStore_Get(OSStore *list, const char *key)
 {
-    int chk_rc;
-    list->cur_node = list->first_node;
+    OSStoreNode *node = _os_store_find(list, key, strlen(key), 0);
 
-    while (list->cur_node) {
-        if ((chk_rc = strcmp(list->cur_node->key, key)) >= 0) {
-            /* Found */
-            if (chk_rc == 0) {
-                return (list->cur_node->data);
-            }
-
-            /* Not found */
-            return (NULL);
-        }
-
-        list->cur_node = list->cur_node->next;
-    }
-    return (NULL);
+    return (node ? node->data : NULL);
 }
 
 /* Check if key is present on storage
@@ -245,22 +385,23 @@ void *OSStore_Get(OSStore *list, const char *key)
  */
 int OSStore_Check(OSStore *list, const char *key)
 {
-    int chk_rc;
-    list->cur_node = list->first_node;
+    return (_os_store_find(list, key, strlen(key), 0) != NULL);
+}
 
-    while (list->cur_node) {
-        if ((chk_rc = strcmp(list->cur_node->key, key)) >= 0) {
-            /* Found */
-            if (chk_rc == 0) {
-                return (1);
-            }
+/* Check if any key on storage is a prefix of key
+ * Returns 0 if not present
+ */
+static int _os_store_check_prefix(OSStore *list, const char *key, int nocase)
+{
+    size_t size = strlen(key);
+    unsigned int i;
 
-            /* Not found */
-            return (0);
+    for (i = 0; i < list->key_sizes_count && list->key_sizes[i] <= size; i++) {
+        if (_os_store_find(list, key, list->key_sizes[i], nocase)) {
+            return (1);
         }
-
-        list->cur_node = list->cur_node->next;
     }
+
     return (0);
 }
 
@@ -269,24 +410,7 @@ int OSStore_Check(OSStore *list, const char *key)
  */
 int OSStore_NCheck(OSStore *list, const char *key)
 {
-    int chk_rc;
-    list->cur_node = list->first_node;
-
-    while (list->cur_node) {
-        if ((chk_rc = strncmp(list->cur_node->key, key,
-                              list->cur_node->key_size)) >= 0) {
-            /* Found */
-            if (chk_rc == 0) {
-                return (1);
-            }
-
-            /* Not found */
-            return (0);
-        }
-
-        list->cur_node = list->cur_node->next;
-    }
-    return (0);
+    return (_os_store_check_prefix(list, key, 0));
 }
 
 /* Check if key is present on storage (case insensitive)
@@ -294,18 +418,7 @@ int OSStore_NCheck(OSStore *list, const char *key)
  */
 int OSStore_NCaseCheck(OSStore *list, const char *key)
 {
-    int chk_rc;
-    list->cur_node = list->first_node;
-
-    while (list->cur_node) {
-        if (chk_rc = strncasecmp(list->cur_node->key, key,
-                                 list->cur_node->key_size), chk_rc == 0) {
-            return (1);
-        }
-
-        list->cur_node = list->cur_node->next;
-    }
-    return (0);
+    return (_os_store_check_prefix(list, key, 1));
 }
 
 /* Add data to the list
@@ -313,8 +426,21 @@ int OSStore_NCaseCheck(OSStore *list, const char *key)
  */
 int OSStore_Put(OSStore *list, const char *key, void *data)
 {
-    int chk_rc;
     OSStoreNode *newnode;
+    size_t key_size = strlen(key);
+
+    /* Duplicate entry */
+    if (_os_store_find(list, key, key_size, 0)) {
+        return (1);
+    }
+
+    if ((unsigned int)list->currently_size >= list->table_size && !_os_store_grow(list)) {
+        return (0);
+    }
+
+    if (!_os_store_add_key_size(list, key_size)) {
+        return (0);
+    }
 
     /* Allocate memory for new node */
     newnode = (OSStoreNode *) calloc(1, sizeof(OSStoreNode));
@@ -332,53 +458,31 @@ int OSStore_Put(OSStore *list, const char *key, void *data)
         merror(MEM_ERROR, errno, strerror(errno));
         return (0);
     }
-    newnode->key_size = strlen(key);
-
-    /* If we don't have first node, assign it */
-    if (!list->first_node) {
-        list->first_node = newnode;
-        list->last_node = newnode;
-    }
-
-    /* Store the data in order */
-    else {
-        list->cur_node = list->first_node;
-        while (list->cur_node) {
-            if ((chk_rc = strcmp(list->cur_node->key, key)) >= 0) {
-                /* Duplicate entry */
-                if (chk_rc == 0) {
-                    free(newnode->key);
-                    free(newnode);
-                    return (1);
-                }
-
-                /* If there is no prev node, this is the first node */
-                if (list->cur_node->prev) {
-                    list->cur_node->prev->next = newnode;
-                } else {
-                    list->first_node = newnode;
-                }
+    newnode->key_size = key_size;
+    newnode->hash = _os_store_hash(key, key_size);
 
-                newnode->prev = list->cur_node->prev;
+    newnode->hash_next = list->table[newnode->hash & (list->table_size - 1)];
+    list->table[newnode->hash & (list->table_size - 1)] = newnode;
 
-                list->cur_node->prev = newnode;
-                newnode->next = list->cur_node;
-                break;
-            }
+    /* Append the node, the list stays in key order if it's the higher key */
+    if (list->data_sorted || (list->last_node && strcmp(list->last_node->key, key) > 0)) {
+        list->key_sorted = 0;
+    }
 
-            list->cur_node = list->cur_node->next;
-        }
+    list->data_sorted = 0;
 
-        /* New node is the higher key */
-        if (!newnode->next) {
-            list->last_node->next = newnode;
-            newnode->prev = list->last_node;
-            list->last_node = newnode;
-        }
+    if (list->last_node) {
+        list->last_node->next = newnode;
+        newnode->prev = list->last_node;
+    } else {
+        list->first_node = newnode;
     }
 
+    list->last_node = newnode;
+
     /* Increment list size */
     list->currently_size++;
+    newnode->position = list->currently_size;
 
     return (1);
 }
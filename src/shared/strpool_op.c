@@ -0,0 +1,196 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+
+// FNV-1a hash
+static unsigned int w_strpool_hash(const char * str, size_t length) {
+    unsigned int hash = 2166136261u;
+
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static w_strpool_stripe_t * w_strpool_stripe(w_strpool_t * pool, unsigned int hash) {
+    // The top bits select the stripe, the bottom ones the bucket
+    return &pool->stripes[(hash >> 24) % STRPOOL_STRIPES];
+}
+
+static w_strpool_entry_t * w_strpool_entry(char * str) {
+    return (w_strpool_entry_t *)(str - offsetof(w_strpool_entry_t, str));
+}
+
+// Double the buckets of a stripe. The stripe must be locked.
+static void w_strpool_grow(w_strpool_stripe_t * stripe) {
+    unsigned int size = stripe->size * 2;
+    w_strpool_entry_t ** buckets;
+
+    os_calloc(size, sizeof(w_strpool_entry_t *), buckets);
+
+    for (unsigned int i = 0; i < stripe->size; i++) {
+        w_strpool_entry_t * next;
+
+        for (w_strpool_entry_t * entry = stripe->buckets[i]; entry; entry = next) {
+            next = entry->next;
+            entry->next = buckets[entry->hash & (size - 1)];
+            buckets[entry->hash & (size - 1)] = entry;
+        }
+    }
+
+    os_free(stripe->buckets);
+    stripe->buckets = buckets;
+    stripe->size = size;
+}
+
+w_strpool_t * w_strpool_init(void) {
+    w_strpool_t * pool;
+
+    os_calloc(1, sizeof(w_strpool_t), pool);
+
+    for (int i = 0; i < STRPOOL_STRIPES; i++) {
+        w_mutex_init(&pool->stripes[i].mutex, NULL);
+        os_calloc(STRPOOL_BUCKETS, sizeof(w_strpool_entry_t *), pool->stripes[i].buckets);
+        pool->stripes[i].size = STRPOOL_BUCKETS;
+    }
+
+    return pool;
+}
+
+void w_strpool_free(w_strpool_t * pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < STRPOOL_STRIPES; i++) {
+        w_strpool_stripe_t * stripe = &pool->stripes[i];
+
+        for (unsigned int j = 0; j < stripe->size; j++) {
+            w_strpool_entry_t * next;
+
+            for (w_strpool_entry_t * entry = stripe->buckets[j]; entry; entry = next) {
+                next = entry->next;
+                free(entry);
+            }
+        }
+
+        os_free(stripe->buckets);
+        w_mutex_destroy(&stripe->mutex);
+    }
+
+    free(pool);
+}
+
+char * w_strpool_get(w_strpool_t * pool, const char * str) {
+    return str ? w_strpool_getn(pool, str, strlen(str)) : NULL;
+}
+
+char * w_strpool_getn(w_strpool_t * pool, const char * str, size_t length) {
+    w_strpool_entry_t * entry;
+
+    if (pool == NULL) {
+        char * copy;
+
+        os_malloc(length + 1, copy);
+        memcpy(copy, str, length);
+        copy[length] = '\0';
+        return copy;
+    }
+
+    unsigned int hash = w_strpool_hash(str, length);
+    w_strpool_stripe_t * stripe = w_strpool_stripe(pool, hash);
+
+    w_mutex_lock(&stripe->mutex);
+
+    for (entry = stripe->buckets[hash & (stripe->size - 1)]; entry; entry = entry->next) {
+        if (entry->hash == hash && strncmp(entry->str, str, length) == 0 && entry->str[length] == '\0') {
+            __atomic_add_fetch(&entry->refs, 1, __ATOMIC_RELAXED);
+            w_mutex_unlock(&stripe->mutex);
+            return entry->str;
+        }
+    }
+
+    os_malloc(sizeof(w_strpool_entry_t) + length + 1, entry);
+    memcpy(entry->str, str, length);
+    entry->str[length] = '\0';
+    entry->hash = hash;
+    entry->refs = 1;
+
+    if (stripe->elements >= stripe->size) {
+        w_strpool_grow(stripe);
+    }
+
+    entry->next = stripe->buckets[hash & (stripe->size - 1)];
+    stripe->buckets[hash & (stripe->size - 1)] = entry;
+    stripe->elements++;
+
+    w_mutex_unlock(&stripe->mutex);
+    return entry->str;
+}
+
+char * w_strpool_ref(w_strpool_t * pool, char * str) {
+    if (str == NULL) {
+        return NULL;
+    }
+
+    if (pool == NULL) {
+        char * copy;
+        os_strdup(str, copy);
+        return copy;
+    }
+
+    // The caller holds a reference, so the entry can't be freed meanwhile
+    __atomic_add_fetch(&w_strpool_entry(str)->refs, 1, __ATOMIC_RELAXED);
+    return str;
+}
+
+void w_strpool_release(w_strpool_t * pool, char * str) {
+    if (str == NULL) {
+        return;
+    }
+
+    if (pool == NULL) {
+        free(str);
+        return;
+    }
+
+    w_strpool_entry_t * entry = w_strpool_entry(str);
+    w_strpool_stripe_t * stripe = w_strpool_stripe(pool, entry->hash);
+
+    // Lookups add references under the lock, so none can revive the entry once it drops to zero
+    w_mutex_lock(&stripe->mutex);
+
+    if (__atomic_sub_fetch(&entry->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        w_strpool_entry_t ** node = &stripe->buckets[entry->hash & (stripe->size - 1)];
+
+        while (*node != entry) {
+            node = &(*node)->next;
+        }
+
+        *node = entry->next;
+        stripe->elements--;
+        free(entry);
+    }
+
+    w_mutex_unlock(&stripe->mutex);
+}
+
+size_t w_strpool_count(w_strpool_t * pool) {
+    size_t count = 0;
+
+    for (int i = 0; i < STRPOOL_STRIPES; i++) {
+        w_mutex_lock(&pool->stripes[i].mutex);
+        count += pool->stripes[i].elements;
+        w_mutex_unlock(&pool->stripes[i].mutex);
+    }
+
+    return count;
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "token_bucket_op.h"
+
+#define NSEC_PER_SEC    1000000000LL
+#define NSEC_PER_MSEC   1000000LL
+
+/* A bucket further ahead than this comes from a clock set backwards */
+#define MAX_AHEAD       (60 * NSEC_PER_SEC)
+
+#ifdef __ATOMIC_SEQ_CST
+#define bucket_load(b) __atomic_load_n(&(b)->tat, __ATOMIC_ACQUIRE)
+#define bucket_cas(b, expected, desired) \
+    __atomic_compare_exchange_n(&(b)->tat, expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#else
+static pthread_mutex_t bucket_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int64_t bucket_load(w_token_bucket_t *bucket) {
+    int64_t ret;
+
+    w_mutex_lock(&bucket_mutex);
+    ret = bucket->tat;
+    w_mutex_unlock(&bucket_mutex);
+
+    return ret;
+}
+
+static bool bucket_cas(w_token_bucket_t *bucket, int64_t *expected, int64_t desired) {
+    bool ret;
+
+    w_mutex_lock(&bucket_mutex);
+
+    if (ret = bucket->tat == *expected, ret) {
+        bucket->tat = desired;
+    } else {
+        *expected = bucket->tat;
+    }
+
+    w_mutex_unlock(&bucket_mutex);
+
+    return ret;
+}
+#endif
+
+static int64_t bucket_now() {
+    struct timespec ts = { 0, 0 };
+
+    gettime(&ts);
+    return (int64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+int64_t w_token_bucket_take(w_token_bucket_t *bucket, unsigned int rate, unsigned int burst) {
+    assert(bucket != NULL);
+
+    if (rate == 0) {
+        return 0;
+    }
+
+    const int64_t interval = NSEC_PER_SEC / rate > 0 ? NSEC_PER_SEC / rate : 1;
+    const int64_t tolerance = (int64_t)(burst > 0 ? burst : 1) * interval;
+    const int64_t now = bucket_now();
+    int64_t tat = bucket_load(bucket);
+    int64_t next;
+
+    do {
+        // An idle bucket is full: it never accumulates more than the burst.
+        next = (tat < now || tat - now > tolerance + MAX_AHEAD ? now : tat) + interval;
+    } while (!bucket_cas(bucket, &tat, next));
+
+    return next - now > tolerance ? next - now - tolerance : 0;
+}
+
+bool w_token_bucket_wait(w_token_bucket_t *bucket, unsigned int rate, unsigned int burst) {
+    const int64_t wait = w_token_bucket_take(bucket, rate, burst);
+
+    // Shorter waits are paid back by the next events, since the bucket keeps the debt.
+    if (wait < NSEC_PER_MSEC) {
+        return false;
+    }
+
+    w_time_delay(wait / NSEC_PER_MSEC);
+    return true;
+}
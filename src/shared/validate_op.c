@@ -290,6 +290,25 @@ int getDefine_Int(const char *high_name, const char *low_name, int min, int max)
     return (ret);
 }
 
+/* Get a string definition, to be freed by the caller. This function always
+ * return on success or exits on error.
+ */
+char *getDefine_String(const char *high_name, const char *low_name)
+{
+    char *value;
+
+    /* Try to read from the local define file */
+    value = _read_file(high_name, low_name, OSSEC_LDEFINES);
+    if (!value) {
+        value = _read_file(high_name, low_name, OSSEC_DEFINES);
+        if (!value) {
+            merror_exit(DEF_NOT_FOUND, high_name, low_name);
+        }
+    }
+
+    return (value);
+}
+
 /* Check if IP_address is present at that_IP
  * Returns 1 on success or 0 on failure
  */
@@ -389,6 +408,114 @@ int OS_IPFoundList(const char *ip_address, os_ip **list_of_ips)
     return (!_true);
 }
 
+/* Length of the prefix of a netmask, up to the first unset bit */
+static unsigned int OS_IPTreePrefixLen(const uint8_t *netmask, unsigned int size)
+{
+    unsigned int len = 0;
+
+    for (unsigned int i = 0; i < size; i++) {
+        for (uint8_t bit = 0x80; bit; bit >>= 1) {
+            if (!(netmask[i] & bit)) {
+                return len;
+            }
+            len++;
+        }
+    }
+
+    return len;
+}
+
+/* Add a prefix to a tree. A node that is a prefix already covers any longer one. */
+static void OS_IPTreeInsert(os_iptree_node **root, const uint8_t *address, unsigned int prefix_len)
+{
+    os_iptree_node **node = root;
+
+    for (unsigned int i = 0; ; i++) {
+        if (*node == NULL) {
+            os_calloc(1, sizeof(os_iptree_node), *node);
+        } else if ((*node)->prefix) {
+            return;
+        }
+
+        if (i == prefix_len) {
+            break;
+        }
+
+        node = &(*node)->child[(address[i / 8] >> (7 - i % 8)) & 1];
+    }
+
+    (*node)->prefix = true;
+}
+
+static void OS_IPTreeFreeNode(os_iptree_node *node)
+{
+    if (node) {
+        OS_IPTreeFreeNode(node->child[0]);
+        OS_IPTreeFreeNode(node->child[1]);
+        os_free(node);
+    }
+}
+
+os_iptree *OS_IPTreeBuild(os_ip **list_of_ips)
+{
+    os_iptree *tree;
+
+    if (list_of_ips == NULL) {
+        return NULL;
+    }
+
+    // OS_IPFoundList() inverts the result after a negated entry, that depends on the order of the list
+    for (os_ip **l_ip = list_of_ips; *l_ip; l_ip++) {
+        if ((*l_ip)->ip[0] == '!') {
+            return NULL;
+        }
+    }
+
+    os_calloc(1, sizeof(os_iptree), tree);
+
+    for (os_ip **l_ip = list_of_ips; *l_ip; l_ip++) {
+        if ((*l_ip)->is_ipv6) {
+            OS_IPTreeInsert(&tree->ipv6, (*l_ip)->ipv6->ip_address,
+                            OS_IPTreePrefixLen((*l_ip)->ipv6->netmask, sizeof((*l_ip)->ipv6->netmask)));
+        } else {
+            OS_IPTreeInsert(&tree->ipv4, (const uint8_t *)&(*l_ip)->ipv4->ip_address,
+                            OS_IPTreePrefixLen((const uint8_t *)&(*l_ip)->ipv4->netmask, sizeof((*l_ip)->ipv4->netmask)));
+        }
+    }
+
+    return tree;
+}
+
+int OS_IPFoundTree(const os_iptree *tree, const void *address, bool is_ipv6)
+{
+    const os_iptree_node *node = is_ipv6 ? tree->ipv6 : tree->ipv4;
+    const uint8_t *bytes = address;
+    unsigned int bits = is_ipv6 ? 128 : 32;
+
+    for (unsigned int i = 0; node; i++) {
+        if (node->prefix) {
+            return 1;
+        }
+
+        if (i == bits) {
+            break;
+        }
+
+        node = node->child[(bytes[i / 8] >> (7 - i % 8)) & 1];
+    }
+
+    return 0;
+}
+
+void OS_IPTreeFree(os_iptree *tree)
+{
+    if (tree) {
+        OS_IPTreeFreeNode(tree->ipv4);
+        OS_IPTreeFreeNode(tree->ipv6);
+        os_free(tree);
+    }
+}
+
 /* Validate if an IP address is in the right format
  * Returns 0 if doesn't match or 1 if it is an IP or 2 an IP with CIDR.
  * WARNING: On success this function may modify the value of ip_address
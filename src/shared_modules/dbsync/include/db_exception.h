@@ -38,6 +38,10 @@ DBSyncExceptionType STEP_ERROR_DELETE_STATUS_FIELD { std::make_pair(19, "Error d
 DBSyncExceptionType DELETE_OLD_DB_ERROR            { std::make_pair(20, "Error deleting old db.")                               };
 DBSyncExceptionType MIN_ROW_LIMIT_BELOW_ZERO       { std::make_pair(21, "Invalid row limit, values below 0 not allowed.")       };
 DBSyncExceptionType ERROR_COUNT_MAX_ROWS           { std::make_pair(22, "Count is less than 0.")                                };
+DBSyncExceptionType INVALID_TUNING_CONFIG          { std::make_pair(23, "Invalid database tuning configuration.")               };
+DBSyncExceptionType INVALID_SNAPSHOT               { std::make_pair(24, "Invalid database snapshot.")                           };
+DBSyncExceptionType INVALID_COLUMN_INDEX           { std::make_pair(25, "Invalid column index.")                                };
+DBSyncExceptionType INVALID_SHARD_RELATIONSHIP     { std::make_pair(26, "Related tables placed in different shards.")           };
 
 namespace DbSync
 {
@@ -55,6 +55,78 @@ EXPORTED DBSYNC_HANDLE dbsync_create(const HostType      host_type,
                                      const char*         path,
                                      const char*         sql_statement);
 
+/**
+ * @brief Creates a new DBSync instance applying a SQLite tuning profile when the database is opened.
+ *
+ * @param host_type     Dynamic library host type to be used.
+ * @param db_type       Database type to be used (currently only supported SQLITE3)
+ * @param path          Path where the local database will be created.
+ * @param sql_statement SQL sentence to create tables in a SQL engine.
+ * @param js_tuning     JSON with the tuning configuration, e.g. {"profile": "ssd", "mmap_size": 268435456}.
+ *                      Profiles: "default", "memory-heavy" and "ssd". The journal_mode, synchronous,
+ *                      page_size, cache_size, mmap_size and temp_store values override the profile ones.
+ *                      "read_connections": N (1-16) opens N read only connections in WAL mode that
+ *                      serve \ref dbsync_select_rows without waiting for the sync operations; not
+ *                      supported for in-memory databases.
+ *                      "shards": {"name": ["table", ...], ...} places each group of tables (up to 10) in
+ *                      its own database file, e.g. "fim.db" -> "fim.name.db", with its own connection
+ *                      and lock so the writers of different shards do not wait for each other. The
+ *                      other tables stay in \p path. Every shard attaches the others, so the queries may
+ *                      still reference any table; related tables must share a shard. Backups and
+ *                      restores use the same naming.
+ *
+ * @return Handle instance to be used for common sql operations (cannot be used by more than 1 thread).
+ */
+EXPORTED DBSYNC_HANDLE dbsync_create_with_tuning(const HostType      host_type,
+                                                 const DbEngineType  db_type,
+                                                 const char*         path,
+                                                 const char*         sql_statement,
+                                                 const cJSON*        js_tuning);
+
+/**
+ * @brief Gets the SQLite settings in effect for \p handle.
+ *
+ * @param handle    Handle assigned as part of the \ref dbsync_create method().
+ * @param js_result JSON with the effective journal_mode, synchronous, page_size, cache_size,
+ *                  mmap_size and temp_store values.
+ *
+ * @return 0 if succeeded,
+ *         specific error code (OS dependent) otherwise.
+ *
+ * @details The \p js_result resulting data should be freed using the \ref dbsync_free_result function.
+ */
+EXPORTED int dbsync_get_tuning_info(const DBSYNC_HANDLE handle,
+                                    cJSON**             js_result);
+
+/**
+ * @brief Saves a snapshot of the \p handle database into \p path.
+ *
+ * @param handle Handle assigned as part of the \ref dbsync_create method().
+ * @param path   Snapshot file, replaced once the new one is complete.
+ *
+ * @return 0 if succeeded,
+ *         specific error code (OS dependent) otherwise.
+ *
+ * @details It must not be called while a transaction is open.
+ */
+EXPORTED int dbsync_backup(const DBSYNC_HANDLE handle,
+                           const char*         path);
+
+/**
+ * @brief Replaces the \p handle database contents with the snapshot saved in \p path.
+ *
+ * @param handle Handle assigned as part of the \ref dbsync_create method().
+ * @param path   Snapshot file saved by \ref dbsync_backup.
+ *
+ * @return 0 if succeeded,
+ *         specific error code (OS dependent) otherwise.
+ *
+ * @details The snapshot must have the tables of the database, with the same columns.
+ *  It must not be called while a transaction is open.
+ */
+EXPORTED int dbsync_restore(const DBSYNC_HANDLE handle,
+                            const char*         path);
+
 /**
  * @brief Turns off the services provided by the shared library.
  */
@@ -102,6 +174,38 @@ EXPORTED int dbsync_close_txn(const TXN_HANDLE txn);
 EXPORTED int dbsync_sync_txn_row(const TXN_HANDLE txn,
                                  const cJSON*     js_input);
 
+/**
+ * @brief Synchronizes a batch of rows, \p js_input "data" array, using the \p txn current
+ *  database transaction.
+ *
+ * @param txn      Database transaction to be used for \ref js_input data sync.
+ * @param js_input JSON information to be synchronized (same layout used by \ref dbsync_sync_txn_row).
+ *
+ * @return 0 if succeeded,
+ *         specific error code (OS dependent) otherwise.
+ *
+ * @details The whole batch is staged and compared against the stored rows with set based
+ *  queries, so results are reported once the batch has been processed.
+ */
+EXPORTED int dbsync_sync_txn_rows(const TXN_HANDLE txn,
+                                  const cJSON*     js_input);
+
+/**
+ * @brief Keeps a batch of rows, \p js_input "data" array, known to be unchanged in the \p txn
+ *  current database transaction.
+ *
+ * @param txn      Database transaction where the rows are kept.
+ * @param js_input JSON information of the unchanged rows (same layout used by \ref dbsync_sync_txn_rows).
+ *
+ * @return 0 if succeeded,
+ *         specific error code (OS dependent) otherwise.
+ *
+ * @details Stored rows are not compared, they are only prevented from being deleted when the
+ *  transaction is closed. Rows that aren't stored are synced as \ref dbsync_sync_txn_rows does.
+ */
+EXPORTED int dbsync_keep_txn_rows(const TXN_HANDLE txn,
+                                  const cJSON*     js_input);
+
 /**
  * @brief Generates triggers that execute actions to maintain consistency between tables.
  *
@@ -122,6 +226,9 @@ EXPORTED int dbsync_add_table_relationship(const DBSYNC_HANDLE handle,
  *
  * @return 0 if succeeded,
  *         specific error code (OS dependent) otherwise.
+ *
+ * @details Setting "options": {"upsert": true} updates the rows whose primary key already exists
+ *  instead of failing.
  */
 EXPORTED int dbsync_insert_data(const DBSYNC_HANDLE handle,
                                 const cJSON*        js_insert);
@@ -165,6 +272,9 @@ EXPORTED int dbsync_sync_row(const DBSYNC_HANDLE handle,
  *
  * @return 0 if succeeded,
  *         specific error code (OS dependent) otherwise.
+ *
+ * @details When the handle was created with "read_connections", the rows come from the last
+ *          committed state: changes of an open transaction are visible once it is closed.
  */
 EXPORTED int dbsync_select_rows(const DBSYNC_HANDLE handle,
                                 const cJSON*        js_data_input,
@@ -207,6 +317,8 @@ EXPORTED int dbsync_get_deleted_rows(const TXN_HANDLE  txn,
  *         specific error code (OS dependent) otherwise.
  *
  * @details The \p js_result resulting data should be freed using the \ref dbsync_free_result function.
+ *  When the snapshot rows are sorted by primary key, setting "options": {"sorted": true} merges
+ *  them against the table in a single pass instead of copying the snapshot to a temp table.
  */
 EXPORTED int dbsync_update_with_snapshot(const DBSYNC_HANDLE handle,
                                          const cJSON*        js_snapshot,
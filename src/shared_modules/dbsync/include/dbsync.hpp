@@ -30,6 +30,7 @@
 #include "db_exception.h"
 #include "commonDefs.h"
 #include "builder.hpp"
+#include "rowView.hpp"
 
 using ResultCallbackData = const std::function<void(ReturnTypeCallback, const nlohmann::json&) >;
 
@@ -57,6 +58,22 @@ class EXPORTED DBSync
                         const std::string& path,
                         const std::string& sqlStatement);
 
+        /**
+         * @brief DBSync Constructor applying a SQLite tuning profile when the database is opened.
+         *
+         * @param hostType     Dynamic library host type to be used.
+         * @param dbType       Database type to be used (currently only supported SQLITE3)
+         * @param path         Path where the local database will be created.
+         * @param sqlStatement SQL sentence to create tables in a SQL engine.
+         * @param tuning       Tuning configuration (see \ref dbsync_create_with_tuning).
+         *
+         */
+        explicit DBSync(const HostType        hostType,
+                        const DbEngineType    dbType,
+                        const std::string&    path,
+                        const std::string&    sqlStatement,
+                        const nlohmann::json& tuning);
+
         /**
          * @brief DBSync Constructor.
          *
@@ -116,6 +133,16 @@ class EXPORTED DBSync
         virtual void selectRows(const nlohmann::json& jsInput,
                                 ResultCallbackData    callbackData);
 
+        /**
+         * @brief Select data as \ref selectRows does, without building a JSON object per row.
+         *
+         * @param jsInput         JSON with table name, fields and filters to apply in the query.
+         * @param callbackData    Callback called for each row with a view of its columns, only valid during the call.
+         *
+         */
+        virtual void selectRows(const nlohmann::json& jsInput,
+                                RowCallbackData       callbackData);
+
         /**
          * @brief Deletes a database table record and its relationships based on \p jsInput value.
          *
@@ -145,6 +172,30 @@ class EXPORTED DBSync
         virtual void updateWithSnapshot(const nlohmann::json& jsInput,
                                         ResultCallbackData    callbackData);
 
+        /**
+         * @brief Gets the SQLite settings in effect for this instance.
+         *
+         * @param jsResult JSON with the effective pragma values.
+         *
+         */
+        virtual void getTuningInfo(nlohmann::json& jsResult);
+
+        /**
+         * @brief Saves a snapshot of the database.
+         *
+         * @param path Snapshot file, replaced once the new one is complete.
+         *
+         */
+        virtual void backup(const std::string& path);
+
+        /**
+         * @brief Replaces the database contents with a snapshot saved by \ref backup.
+         *
+         * @param path Snapshot file. It must have the tables of the database, with the same columns.
+         *
+         */
+        virtual void restore(const std::string& path);
+
         /**
          * @brief Turns off the services provided by the shared library.
          */
@@ -208,6 +259,25 @@ class EXPORTED DBSyncTxn
          */
         virtual void syncTxnRow(const nlohmann::json& jsInput);
 
+        /**
+         * @brief Synchronizes the \p jsInput batch of rows ("data" array) at once.
+         *
+         * @param jsInput JSON information to be synchronized.
+         *
+         * @details Results are reported once the whole batch has been processed.
+         */
+        virtual void syncTxnRows(const nlohmann::json& jsInput);
+
+        /**
+         * @brief Keeps the \p jsInput batch of rows ("data" array) known to be unchanged.
+         *
+         * @param jsInput JSON information of the unchanged rows (same layout used by syncTxnRows).
+         *
+         * @details Stored rows are only marked as part of the transaction, without comparing them,
+         *  so they are neither reported nor deleted at the end of it. Rows that aren't stored are synced.
+         */
+        virtual void keepTxnRows(const nlohmann::json& jsInput);
+
         /**
          * @brief Gets the deleted rows (diff) from the database.
          *
@@ -355,6 +425,11 @@ class EXPORTED InsertQuery final : public Query<InsertQuery>
          */
         InsertQuery& data(const nlohmann::json& data);
 
+        /**
+         * @brief Update the rows whose primary key already exists instead of failing.
+         */
+        InsertQuery& upsert();
+
         /**
          * @brief Reset all data to be inserted.
          *
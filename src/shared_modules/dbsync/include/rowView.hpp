@@ -0,0 +1,50 @@
+/*
+ * Wazuh DBSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _ROW_VIEW_HPP_
+#define _ROW_VIEW_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace DbSync
+{
+    /**
+     * @brief Read only view of a selected row. It reads the columns from the running query,
+     * so it's only valid during the callback that receives it.
+     */
+    class IRowView
+    {
+        public:
+            // LCOV_EXCL_START
+            virtual ~IRowView() = default;
+            // LCOV_EXCL_STOP
+
+            /**
+             * @brief Position of a column in the row, to be looked up once per query.
+             *
+             * @param name Column name, or its alias in the column list.
+             *
+             * @return Column index, or -1 if the row has no such column.
+             */
+            virtual int columnIndex(const std::string& name) const = 0;
+
+            virtual bool isNull(const int index) const = 0;
+            virtual int64_t getInt64(const int index) const = 0;
+            virtual double getDouble(const int index) const = 0;
+            virtual std::string getString(const int index) const = 0;
+    };
+}// namespace DbSync
+
+using RowCallbackData = const std::function<void(const DbSync::IRowView&)>;
+
+#endif // _ROW_VIEW_HPP_
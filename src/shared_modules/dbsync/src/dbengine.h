@@ -20,10 +20,12 @@
 #include "json.hpp"
 #include "commonDefs.h"
 #include "abstractLocking.hpp"
+#include "rowView.hpp"
 
 namespace DbSync
 {
     using ResultCallback = std::function<void(ReturnTypeCallback, const nlohmann::json&)>;
+    using RowCallback = std::function<void(const IRowView&)>;
 
     class IDbEngine
     {
@@ -35,6 +37,13 @@ namespace DbSync
             virtual void bulkInsert(const std::string& table,
                                     const nlohmann::json& data) = 0;
 
+            virtual void bulkUpsert(const std::string& table,
+                                    const nlohmann::json& data) = 0;
+
+            virtual nlohmann::json tuningInfo() = 0;
+
+            virtual bool concurrentReads() = 0;
+
             virtual void refreshTableData(const nlohmann::json& data,
                                           const ResultCallback callback,
                                           std::unique_lock<std::shared_timed_mutex>& lock) = 0;
@@ -44,6 +53,14 @@ namespace DbSync
                                           const bool inTransaction,
                                           Utils::ILocking& mutex) = 0;
 
+            virtual void syncTableRowsData(const nlohmann::json& jsInput,
+                                           const ResultCallback callback,
+                                           Utils::ILocking& mutex) = 0;
+
+            virtual void keepTableRowsData(const nlohmann::json& jsInput,
+                                           const ResultCallback callback,
+                                           Utils::ILocking& mutex) = 0;
+
             virtual void setMaxRows(const std::string& table,
                                     const int64_t maxRows) = 0;
 
@@ -60,11 +77,23 @@ namespace DbSync
                                     const ResultCallback& callback,
                                     std::unique_lock<std::shared_timed_mutex>& lock) = 0;
 
+            virtual void selectRows(const std::string& table,
+                                    const nlohmann::json& query,
+                                    const RowCallback& callback,
+                                    std::unique_lock<std::shared_timed_mutex>& lock) = 0;
+
             virtual void deleteTableRowsData(const std::string& table,
                                              const nlohmann::json& jsDeletionData) = 0;
 
             virtual void addTableRelationship(const nlohmann::json& data) = 0;
 
+            virtual void backup(const std::string& path) = 0;
+
+            virtual void restore(const std::string& path) = 0;
+
+            virtual void attach(const std::string& path,
+                                const std::string& alias) = 0;
+
         protected:
             IDbEngine() = default;
     };
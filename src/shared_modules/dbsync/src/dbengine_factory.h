@@ -25,11 +25,12 @@ namespace DbSync
         public:
             static std::unique_ptr<IDbEngine> create(const DbEngineType dbType,
                                                      const std::string& path,
-                                                     const std::string& sqlStatement)
+                                                     const std::string& sqlStatement,
+                                                     const nlohmann::json& tuningConfig)
             {
                 if (SQLITE3 == dbType)
                 {
-                    return std::make_unique<SQLiteDBEngine>(std::make_shared<SQLiteFactory>(), path, sqlStatement);
+                    return std::make_unique<SQLiteDBEngine>(std::make_shared<SQLiteFactory>(), path, sqlStatement, tuningConfig);
                 }
 
                 throw dbsync_error
@@ -16,6 +16,7 @@
 #include "dbsync_implementation.h"
 #include "dbsyncPipelineFactory.h"
 #include "cjsonSmartDeleter.hpp"
+#include "cjsonConverter.hpp"
 
 #ifdef __cplusplus
 extern "C" {
@@ -76,6 +77,151 @@ DBSYNC_HANDLE dbsync_create(const HostType     host_type,
     return retVal;
 }
 
+DBSYNC_HANDLE dbsync_create_with_tuning(const HostType     host_type,
+                                        const DbEngineType db_type,
+                                        const char*        path,
+                                        const char*        sql_statement,
+                                        const cJSON*       js_tuning)
+{
+    DBSYNC_HANDLE retVal{ nullptr };
+    std::string errorMessage;
+
+    if (!path || !sql_statement || !js_tuning)
+    {
+        errorMessage += "Invalid path, sql_statement or tuning.";
+    }
+    else
+    {
+        try
+        {
+            retVal = DBSyncImplementation::instance().initialize(host_type, db_type, path, sql_statement, Utils::cJSONToJson(js_tuning));
+        }
+        catch (const nlohmann::detail::exception& ex)
+        {
+            errorMessage += "json error, id: " + std::to_string(ex.id) + ". " + ex.what();
+        }
+        catch (const DbSync::dbsync_error& ex)
+        {
+            errorMessage += "DB error, id: " + std::to_string(ex.id()) + ". " + ex.what();
+        }
+        // LCOV_EXCL_START
+        catch (...)
+        {
+            errorMessage += "Unrecognized error.";
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    log_message(errorMessage);
+    return retVal;
+}
+
+int dbsync_get_tuning_info(const DBSYNC_HANDLE handle,
+                           cJSON**             js_result)
+{
+    auto retVal { -1 };
+    std::string errorMessage;
+
+    if (!handle || !js_result)
+    {
+        errorMessage += "Invalid input parameter.";
+    }
+    else
+    {
+        try
+        {
+            *js_result = Utils::jsonToCJSON(DBSyncImplementation::instance().tuningInfo(handle));
+            retVal = 0;
+        }
+        catch (const DbSync::dbsync_error& ex)
+        {
+            errorMessage += "DB error, id: " + std::to_string(ex.id()) + ". " + ex.what();
+            retVal = ex.id();
+        }
+        // LCOV_EXCL_START
+        catch (...)
+        {
+            errorMessage += "Unrecognized error.";
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    log_message(errorMessage);
+    return retVal;
+}
+
+int dbsync_backup(const DBSYNC_HANDLE handle,
+                  const char*         path)
+{
+    auto retVal { -1 };
+    std::string errorMessage;
+
+    if (!handle || !path)
+    {
+        errorMessage += "Invalid input parameter.";
+    }
+    else
+    {
+        try
+        {
+            DBSyncImplementation::instance().backup(handle, path);
+            retVal = 0;
+        }
+        catch (const DbSync::dbsync_error& ex)
+        {
+            errorMessage += "DB error, id: " + std::to_string(ex.id()) + ". " + ex.what();
+            retVal = ex.id();
+        }
+        // LCOV_EXCL_START
+        catch (...)
+        {
+            errorMessage += "Unrecognized error.";
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    log_message(errorMessage);
+    return retVal;
+}
+
+int dbsync_restore(const DBSYNC_HANDLE handle,
+                   const char*         path)
+{
+    auto retVal { -1 };
+    std::string errorMessage;
+
+    if (!handle || !path)
+    {
+        errorMessage += "Invalid input parameter.";
+    }
+    else
+    {
+        try
+        {
+            DBSyncImplementation::instance().restore(handle, path);
+            retVal = 0;
+        }
+        catch (const DbSync::dbsync_error& ex)
+        {
+            errorMessage += "DB error, id: " + std::to_string(ex.id()) + ". " + ex.what();
+            retVal = ex.id();
+        }
+        // LCOV_EXCL_START
+        catch (...)
+        {
+            errorMessage += "Unrecognized error.";
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    log_message(errorMessage);
+    return retVal;
+}
+
 void dbsync_teardown(void)
 {
     PipelineFactory::instance().release();
@@ -103,12 +249,11 @@ TXN_HANDLE dbsync_create_txn(const DBSYNC_HANDLE handle,
             {
                 [callback_data](ReturnTypeCallback result, const nlohmann::json & jsonResult)
                 {
-                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ cJSON_Parse(jsonResult.dump().c_str()) };
+                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ Utils::jsonToCJSON(jsonResult) };
                     callback_data.callback(result, spJson.get(), callback_data.user_data);
                 }
             };
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{cJSON_Print(tables)};
-            txn = PipelineFactory::instance().create(handle, nlohmann::json::parse(spJsonBytes.get()), thread_number, max_queue_size, callbackWrapper);
+            txn = PipelineFactory::instance().create(handle, Utils::cJSONToJson(tables), thread_number, max_queue_size, callbackWrapper);
         }
         catch (const DbSync::dbsync_error& ex)
         {
@@ -175,8 +320,77 @@ int dbsync_sync_txn_row(const TXN_HANDLE txn,
     {
         try
         {
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{cJSON_PrintUnformatted(js_input)};
-            PipelineFactory::instance().pipeline(txn)->syncRow(nlohmann::json::parse(spJsonBytes.get()));
+            PipelineFactory::instance().pipeline(txn)->syncRow(Utils::cJSONToJson(js_input));
+            retVal = 0;
+        }
+        catch (const DbSync::dbsync_error& ex)
+        {
+            error_message += "DB error, id: " + std::to_string(ex.id()) + ". " + ex.what();
+            retVal = ex.id();
+        }
+        // LCOV_EXCL_START
+        catch (...)
+        {
+            error_message += "Unrecognized error.";
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    log_message(error_message);
+    return retVal;
+}
+
+int dbsync_sync_txn_rows(const TXN_HANDLE txn,
+                         const cJSON*     js_input)
+{
+    auto retVal { -1 };
+    std::string error_message;
+
+    if (!txn || !js_input)
+    {
+        error_message += "Invalid txn or json.";
+    }
+    else
+    {
+        try
+        {
+            PipelineFactory::instance().pipeline(txn)->syncRows(Utils::cJSONToJson(js_input));
+            retVal = 0;
+        }
+        catch (const DbSync::dbsync_error& ex)
+        {
+            error_message += "DB error, id: " + std::to_string(ex.id()) + ". " + ex.what();
+            retVal = ex.id();
+        }
+        // LCOV_EXCL_START
+        catch (...)
+        {
+            error_message += "Unrecognized error.";
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    log_message(error_message);
+    return retVal;
+}
+
+int dbsync_keep_txn_rows(const TXN_HANDLE txn,
+                         const cJSON*     js_input)
+{
+    auto retVal { -1 };
+    std::string error_message;
+
+    if (!txn || !js_input)
+    {
+        error_message += "Invalid txn or json.";
+    }
+    else
+    {
+        try
+        {
+            PipelineFactory::instance().pipeline(txn)->keepRows(Utils::cJSONToJson(js_input));
             retVal = 0;
         }
         catch (const DbSync::dbsync_error& ex)
@@ -211,8 +425,7 @@ int dbsync_add_table_relationship(const DBSYNC_HANDLE handle,
     {
         try
         {
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{cJSON_Print(js_input)};
-            DBSyncImplementation::instance().addTableRelationship(handle, nlohmann::json::parse(spJsonBytes.get()));
+            DBSyncImplementation::instance().addTableRelationship(handle, Utils::cJSONToJson(js_input));
             retVal = 0;
         }
         catch (const nlohmann::detail::exception& ex)
@@ -250,8 +463,7 @@ int dbsync_insert_data(const DBSYNC_HANDLE handle,
     {
         try
         {
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{cJSON_Print(js_insert)};
-            DBSyncImplementation::instance().insertBulkData(handle, nlohmann::json::parse(spJsonBytes.get()));
+            DBSyncImplementation::instance().insertBulkData(handle, Utils::cJSONToJson(js_insert));
             retVal = 0;
         }
         catch (const nlohmann::detail::exception& ex)
@@ -339,12 +551,11 @@ int dbsync_sync_row(const DBSYNC_HANDLE handle,
             {
                 [callback_data](ReturnTypeCallback result, const nlohmann::json & jsonResult)
                 {
-                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ cJSON_Parse(jsonResult.dump().c_str()) };
+                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ Utils::jsonToCJSON(jsonResult) };
                     callback_data.callback(result, spJson.get(), callback_data.user_data);
                 }
             };
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{ cJSON_PrintUnformatted(js_input) };
-            DBSyncImplementation::instance().syncRowData(handle, nlohmann::json::parse(spJsonBytes.get()), callbackWrapper);
+            DBSyncImplementation::instance().syncRowData(handle, Utils::cJSONToJson(js_input), callbackWrapper);
             retVal = 0;
         }
         catch (const nlohmann::detail::exception& ex)
@@ -389,12 +600,11 @@ int dbsync_select_rows(const DBSYNC_HANDLE handle,
             {
                 [callback_data](ReturnTypeCallback result, const nlohmann::json & jsonResult)
                 {
-                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ cJSON_Parse(jsonResult.dump().c_str()) };
+                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ Utils::jsonToCJSON(jsonResult) };
                     callback_data.callback(result, spJson.get(), callback_data.user_data);
                 }
             };
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{ cJSON_PrintUnformatted(js_data_input) };
-            DBSyncImplementation::instance().selectData(handle, nlohmann::json::parse(spJsonBytes.get()), callbackWrapper);
+            DBSyncImplementation::instance().selectData(handle, Utils::cJSONToJson(js_data_input), callbackWrapper);
             retVal = 0;
         }
         catch (const nlohmann::detail::exception& ex)
@@ -434,8 +644,7 @@ int dbsync_delete_rows(const DBSYNC_HANDLE handle,
     {
         try
         {
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{ cJSON_PrintUnformatted(js_key_values) };
-            DBSyncImplementation::instance().deleteRowsData(handle, nlohmann::json::parse(spJsonBytes.get()));
+            DBSyncImplementation::instance().deleteRowsData(handle, Utils::cJSONToJson(js_key_values));
             retVal = 0;
         }
         catch (const nlohmann::detail::exception& ex)
@@ -479,7 +688,7 @@ int dbsync_get_deleted_rows(const TXN_HANDLE  txn,
             {
                 [callback_data](ReturnTypeCallback result, const nlohmann::json & jsonResult)
                 {
-                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ cJSON_Parse(jsonResult.dump().c_str()) };
+                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ Utils::jsonToCJSON(jsonResult) };
                     callback_data.callback(result, spJson.get(), callback_data.user_data);
                 }
             };
@@ -536,9 +745,8 @@ int dbsync_update_with_snapshot(const DBSYNC_HANDLE handle,
                     result[s_opMap.at(resultType)].push_back(jsonResult);
                 }
             };
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{cJSON_PrintUnformatted(js_snapshot)};
-            DBSyncImplementation::instance().updateSnapshotData(handle, nlohmann::json::parse(spJsonBytes.get()), callbackWrapper);
-            *js_result = cJSON_Parse(result.dump().c_str());
+            DBSyncImplementation::instance().updateSnapshotData(handle, Utils::cJSONToJson(js_snapshot), callbackWrapper);
+            *js_result = Utils::jsonToCJSON(result);
             retVal = 0;
         }
         catch (const nlohmann::detail::exception& ex)
@@ -588,12 +796,11 @@ int dbsync_update_with_snapshot_cb(const DBSYNC_HANDLE handle,
             {
                 [callback_data](ReturnTypeCallback result, const nlohmann::json & jsonResult)
                 {
-                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ cJSON_Parse(jsonResult.dump().c_str()) };
+                    const std::unique_ptr<cJSON, CJsonSmartDeleter> spJson{ Utils::jsonToCJSON(jsonResult) };
                     callback_data.callback(result, spJson.get(), callback_data.user_data);
                 }
             };
-            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{cJSON_PrintUnformatted(js_snapshot)};
-            DBSyncImplementation::instance().updateSnapshotData(handle, nlohmann::json::parse(spJsonBytes.get()), callbackWrapper);
+            DBSyncImplementation::instance().updateSnapshotData(handle, Utils::cJSONToJson(js_snapshot), callbackWrapper);
             retVal = 0;
         }
         catch (const nlohmann::detail::exception& ex)
@@ -648,6 +855,15 @@ DBSync::DBSync(const HostType     hostType,
     , m_shouldBeRemoved{ true }
 { }
 
+DBSync::DBSync(const HostType        hostType,
+               const DbEngineType    dbType,
+               const std::string&    path,
+               const std::string&    sqlStatement,
+               const nlohmann::json& tuning)
+    : m_dbsyncHandle { DBSyncImplementation::instance().initialize(hostType, dbType, path, sqlStatement, tuning) }
+    , m_shouldBeRemoved{ true }
+{ }
+
 DBSync::DBSync(const DBSYNC_HANDLE dbsyncHandle)
     : m_dbsyncHandle { dbsyncHandle }
     , m_shouldBeRemoved{ false }
@@ -710,6 +926,12 @@ void DBSync::selectRows(const nlohmann::json& jsInput,
     DBSyncImplementation::instance().selectData(m_dbsyncHandle, jsInput, callbackWrapper);
 }
 
+void DBSync::selectRows(const nlohmann::json& jsInput,
+                        RowCallbackData       callbackData)
+{
+    DBSyncImplementation::instance().selectRows(m_dbsyncHandle, jsInput, callbackData);
+}
+
 void DBSync::deleteRows(const nlohmann::json& jsInput)
 {
     DBSyncImplementation::instance().deleteRowsData(m_dbsyncHandle, jsInput);
@@ -749,6 +971,21 @@ void DBSync::updateWithSnapshot(const nlohmann::json&     jsInput,
     DBSyncImplementation::instance().updateSnapshotData(m_dbsyncHandle, jsInput, callbackWrapper);
 }
 
+void DBSync::getTuningInfo(nlohmann::json& jsResult)
+{
+    jsResult = DBSyncImplementation::instance().tuningInfo(m_dbsyncHandle);
+}
+
+void DBSync::backup(const std::string& path)
+{
+    DBSyncImplementation::instance().backup(m_dbsyncHandle, path);
+}
+
+void DBSync::restore(const std::string& path)
+{
+    DBSyncImplementation::instance().restore(m_dbsyncHandle, path);
+}
+
 
 DBSyncTxn::DBSyncTxn(const DBSYNC_HANDLE   handle,
                      const nlohmann::json& tables,
@@ -792,6 +1029,16 @@ void DBSyncTxn::syncTxnRow(const nlohmann::json& jsInput)
     PipelineFactory::instance().pipeline(m_txn)->syncRow(jsInput);
 }
 
+void DBSyncTxn::syncTxnRows(const nlohmann::json& jsInput)
+{
+    PipelineFactory::instance().pipeline(m_txn)->syncRows(jsInput);
+}
+
+void DBSyncTxn::keepTxnRows(const nlohmann::json& jsInput)
+{
+    PipelineFactory::instance().pipeline(m_txn)->keepRows(jsInput);
+}
+
 void DBSyncTxn::getDeletedRows(ResultCallbackData  callbackData)
 {
     const auto callbackWrapper
@@ -858,6 +1105,12 @@ InsertQuery& InsertQuery::data(const nlohmann::json& data)
     return *this;
 }
 
+InsertQuery& InsertQuery::upsert()
+{
+    m_jsQuery["options"]["upsert"] = true;
+    return *this;
+}
+
 InsertQuery& InsertQuery::reset()
 {
     m_jsQuery["data"].clear();
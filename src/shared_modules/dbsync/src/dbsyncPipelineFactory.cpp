@@ -84,7 +84,59 @@ namespace DbSync
                     result.first = DB_ERROR;
                     result.second = value;
                     result.second["exception"] = ex.what();
-                    pushResult(result);
+                    pushResult(std::move(result));
+                }
+            }
+            void syncRows(const nlohmann::json& value) override
+            {
+                try
+                {
+                    DBSyncImplementation::instance().syncRowsData
+                    (
+                        m_handle,
+                        m_txnContext,
+                        value,
+                        [this](ReturnTypeCallback resType, const nlohmann::json & resValue)
+                    {
+                        this->pushResult(SyncResult{resType, resValue});
+                    }
+                    );
+                }
+                catch (const DbSync::max_rows_error&)
+                {
+                    pushResult(SyncResult{MAX_ROWS, value});
+                }
+                catch (const std::exception& ex)
+                {
+                    SyncResult result;
+                    result.first = DB_ERROR;
+                    result.second = value;
+                    result.second["exception"] = ex.what();
+                    pushResult(std::move(result));
+                }
+            }
+            void keepRows(const nlohmann::json& value) override
+            {
+                try
+                {
+                    DBSyncImplementation::instance().keepRowsData
+                    (
+                        m_handle,
+                        m_txnContext,
+                        value,
+                        [this](ReturnTypeCallback resType, const nlohmann::json & resValue)
+                    {
+                        this->pushResult(SyncResult{resType, resValue});
+                    }
+                    );
+                }
+                catch (const std::exception& ex)
+                {
+                    SyncResult result;
+                    result.first = DB_ERROR;
+                    result.second = value;
+                    result.second["exception"] = ex.what();
+                    pushResult(std::move(result));
                 }
             }
             void getDeleted(ResultCallback callback) override
@@ -109,13 +161,14 @@ namespace DbSync
                        );
             }
 
-            void pushResult(const SyncResult& result)
+            // Results are moved into the dispatch queue, each changed row is copied only once out of the engine.
+            void pushResult(SyncResult&& result)
             {
                 const auto async{ m_spDispatchNode&& m_spDispatchNode->size() < m_maxQueueSize };
 
                 if (async)
                 {
-                    m_spDispatchNode->receive(result);
+                    m_spDispatchNode->receive(std::move(result));
                 }
                 else
                 {
@@ -9,21 +9,215 @@
  * Foundation.
  */
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
+#include <set>
 #include "abstractLocking.hpp"
 #include "dbsync_implementation.h"
+#include "stringHelper.h"
 
 using namespace DbSync;
 
-DBSYNC_HANDLE DBSyncImplementation::initialize(const HostType     hostType,
-                                               const DbEngineType dbType,
-                                               const std::string& path,
-                                               const std::string& sqlStatement)
+// Upper bound of the shards besides the main one, each of them is attached to the others.
+constexpr auto MAX_SHARDS { 10 };
+
+static std::string shardPath(const std::string& path,
+                             const std::string& name)
+{
+    if (name.empty() || 0 == path.compare(":memory:"))
+    {
+        return path;
+    }
+
+    const auto dot { path.find_last_of('.') };
+    const auto separator { path.find_last_of("/\\") };
+
+    if (std::string::npos == dot || (std::string::npos != separator && dot < separator))
+    {
+        return path + "." + name;
+    }
+
+    return path.substr(0, dot) + "." + name + path.substr(dot);
+}
+
+// Table a CREATE TABLE, CREATE INDEX or CREATE TRIGGER statement is about, empty for any other statement.
+static std::string statementTable(const std::string& statement)
+{
+    std::vector<std::string> tokens;
+    std::string token;
+
+    for (const auto character : statement + " ")
+    {
+        if (std::isspace(static_cast<unsigned char>(character)) || '(' == character)
+        {
+            if (!token.empty())
+            {
+                tokens.push_back(token);
+                token.clear();
+            }
+        }
+        else if ('"' != character && '`' != character && '[' != character && ']' != character)
+        {
+            token += character;
+        }
+    }
+
+    if (tokens.empty() || 0 != Utils::toUpperCase(tokens[0]).compare("CREATE"))
+    {
+        return {};
+    }
+
+    const std::set<std::string> modifiers { "TEMP", "TEMPORARY", "UNIQUE" };
+    size_t i { 1 };
+
+    while (i < tokens.size() && modifiers.count(Utils::toUpperCase(tokens[i])))
+    {
+        ++i;
+    }
+
+    if (i >= tokens.size())
+    {
+        return {};
+    }
+
+    const auto kind { Utils::toUpperCase(tokens[i]) };
+
+    if (0 == kind.compare("TABLE"))
+    {
+        ++i;
+
+        if (i + 2 < tokens.size() && 0 == Utils::toUpperCase(tokens[i]).compare("IF"))
+        {
+            i += 3;
+        }
+
+        return i < tokens.size() ? tokens[i] : std::string {};
+    }
+
+    if (0 == kind.compare("INDEX") || 0 == kind.compare("TRIGGER"))
+    {
+        for (++i; i + 1 < tokens.size(); ++i)
+        {
+            if (0 == Utils::toUpperCase(tokens[i]).compare("ON"))
+            {
+                return tokens[i + 1];
+            }
+        }
+    }
+
+    return {};
+}
+
+static bool isShardName(const std::string& name)
 {
-    auto db{ FactoryDbEngine::create(dbType, path, sqlStatement) };
+    return !name.empty() && std::all_of(name.begin(), name.end(), [](const char character)
+    {
+        return std::isalnum(static_cast<unsigned char>(character)) || '_' == character;
+    });
+}
+
+DBSYNC_HANDLE DBSyncImplementation::initialize(const HostType        hostType,
+                                               const DbEngineType    dbType,
+                                               const std::string&    path,
+                                               const std::string&    sqlStatement,
+                                               const nlohmann::json& tuningConfig)
+{
+    nlohmann::json engineConfig(tuningConfig);
+    std::vector<std::string> shardNames { "" };
+    std::map<std::string, size_t> tableShards;
+    const auto itShards { tuningConfig.find("shards") };
+
+    if (tuningConfig.end() != itShards)
+    {
+        if (!itShards->is_object() || itShards->size() > MAX_SHARDS)
+        {
+            throw dbsync_error { INVALID_TUNING_CONFIG };
+        }
+
+        for (const auto& shard : itShards->items())
+        {
+            if (!isShardName(shard.key()) || !shard.value().is_array() || shard.value().empty())
+            {
+                throw dbsync_error { INVALID_TUNING_CONFIG };
+            }
+
+            shardNames.push_back(shard.key());
+
+            for (const auto& table : shard.value())
+            {
+                if (!table.is_string() || !tableShards.emplace(table.get<std::string>(), shardNames.size() - 1).second)
+                {
+                    throw dbsync_error { INVALID_TUNING_CONFIG };
+                }
+            }
+        }
+
+        engineConfig.erase("shards");
+
+        // The shards read each other while they write, which only WAL allows without blocking.
+        const auto itJournalMode { engineConfig.find("journal_mode") };
+
+        if (engineConfig.end() == itJournalMode)
+        {
+            engineConfig["journal_mode"] = "WAL";
+        }
+        else if (!itJournalMode->is_string() || 0 != Utils::toUpperCase(itJournalMode->get<std::string>()).compare("WAL"))
+        {
+            throw dbsync_error { INVALID_TUNING_CONFIG };
+        }
+    }
+
+    std::vector<std::string> shardStatements(shardNames.size());
+
+    if (1 == shardNames.size())
+    {
+        shardStatements[0] = sqlStatement;
+    }
+    else
+    {
+        for (const auto& statement : Utils::split(sqlStatement, ';'))
+        {
+            if (std::string::npos == statement.find_first_not_of(" \t\r\n"))
+            {
+                continue;
+            }
+
+            // The indexes and triggers go with their table, the triggers cannot reach other database files.
+            const auto it { tableShards.find(statementTable(statement)) };
+            shardStatements[tableShards.end() == it ? 0 : it->second].append(statement + ";");
+        }
+    }
+
+    std::vector<std::unique_ptr<DbShard>> shards;
+
+    for (size_t i = 0; i < shardNames.size(); ++i)
+    {
+        shards.push_back(std::make_unique<DbShard>(FactoryDbEngine::create(dbType,
+                                                                           shardPath(path, shardNames[i]),
+                                                                           shardStatements[i],
+                                                                           engineConfig),
+                                                   shardNames[i]));
+    }
+
+    // Every shard sees the tables of the others, so the queries may still span several of them.
+    if (0 != path.compare(":memory:"))
+    {
+        for (size_t i = 0; i < shards.size(); ++i)
+        {
+            for (size_t j = 0; j < shards.size(); ++j)
+            {
+                if (i != j)
+                {
+                    shards[i]->m_dbEngine->attach(shardPath(path, shardNames[j]), "shard" + std::to_string(j));
+                }
+            }
+        }
+    }
+
     const auto spDbEngineContext
     {
-        std::make_shared<DbEngineContext>(db, hostType, dbType)
+        std::make_shared<DbEngineContext>(shards, tableShards, hostType, dbType)
     };
     const DBSYNC_HANDLE handle{ spDbEngineContext.get() };
     std::lock_guard<std::mutex> lock{m_mutex};
@@ -47,8 +241,18 @@ void DBSyncImplementation::insertBulkData(const DBSYNC_HANDLE   handle,
                                           const nlohmann::json& json)
 {
     const auto ctx{ dbEngineContext(handle) };
-    std::lock_guard<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
-    ctx->m_dbEngine->bulkInsert(json.at("table"), json.at("data"));
+    auto& shard{ ctx->shard(json.at("table")) };
+    std::lock_guard<std::shared_timed_mutex> lock{ shard.m_syncMutex };
+    const auto itOptions { json.find("options") };
+
+    if (json.end() != itOptions && itOptions->contains("upsert") && itOptions->at("upsert").is_boolean() && itOptions->at("upsert").get<bool>())
+    {
+        shard.m_dbEngine->bulkUpsert(json.at("table"), json.at("data"));
+    }
+    else
+    {
+        shard.m_dbEngine->bulkInsert(json.at("table"), json.at("data"));
+    }
 }
 
 void DBSyncImplementation::syncRowData(const DBSYNC_HANDLE      handle,
@@ -56,12 +260,13 @@ void DBSyncImplementation::syncRowData(const DBSYNC_HANDLE      handle,
                                        const ResultCallback     callback)
 {
     const auto ctx{ dbEngineContext(handle) };
-    Utils::ExclusiveLocking lock{ ctx->m_syncMutex };
+    auto& shard{ ctx->shard(json.at("table")) };
+    Utils::ExclusiveLocking lock{ shard.m_syncMutex };
 
-    ctx->m_dbEngine->syncTableRowData(json,
-                                      callback,
-                                      false,
-                                      lock);
+    shard.m_dbEngine->syncTableRowData(json,
+                                       callback,
+                                       false,
+                                       lock);
 }
 
 void DBSyncImplementation::syncRowData(const DBSYNC_HANDLE      handle,
@@ -77,21 +282,64 @@ void DBSyncImplementation::syncRowData(const DBSYNC_HANDLE      handle,
         throw dbsync_error{INVALID_TABLE};
     }
 
-    Utils::SharedLocking lock{ ctx->m_syncMutex };
-    ctx->m_dbEngine->syncTableRowData(json,
-                                      callback,
-                                      true,
-                                      lock);
+    auto& shard{ ctx->shard(json.at("table")) };
+    Utils::SharedLocking lock{ shard.m_syncMutex };
+    shard.m_dbEngine->syncTableRowData(json,
+                                       callback,
+                                       true,
+                                       lock);
+}
+
+void DBSyncImplementation::syncRowsData(const DBSYNC_HANDLE      handle,
+                                        const TXN_HANDLE         txn,
+                                        const nlohmann::json&    json,
+                                        const ResultCallback     callback)
+{
+    const auto& ctx{ dbEngineContext(handle) };
+    const auto& tnxCtx { ctx->transactionContext(txn) };
+
+    if (std::find(tnxCtx->m_tables.begin(), tnxCtx->m_tables.end(), json.at("table")) == tnxCtx->m_tables.end())
+    {
+        throw dbsync_error{INVALID_TABLE};
+    }
+
+    // The batch is staged in a temporary table shared by all the writers, so it needs exclusive access.
+    auto& shard{ ctx->shard(json.at("table")) };
+    Utils::ExclusiveLocking lock{ shard.m_syncMutex };
+    shard.m_dbEngine->syncTableRowsData(json,
+                                        callback,
+                                        lock);
+}
+
+void DBSyncImplementation::keepRowsData(const DBSYNC_HANDLE      handle,
+                                        const TXN_HANDLE         txn,
+                                        const nlohmann::json&    json,
+                                        const ResultCallback     callback)
+{
+    const auto& ctx{ dbEngineContext(handle) };
+    const auto& tnxCtx { ctx->transactionContext(txn) };
+
+    if (std::find(tnxCtx->m_tables.begin(), tnxCtx->m_tables.end(), json.at("table")) == tnxCtx->m_tables.end())
+    {
+        throw dbsync_error{INVALID_TABLE};
+    }
+
+    auto& shard{ ctx->shard(json.at("table")) };
+    Utils::SharedLocking lock{ shard.m_syncMutex };
+    shard.m_dbEngine->keepTableRowsData(json,
+                                        callback,
+                                        lock);
 }
 
 void DBSyncImplementation::deleteRowsData(const DBSYNC_HANDLE   handle,
                                           const nlohmann::json& json)
 {
     const auto ctx{ dbEngineContext(handle) };
-    std::lock_guard<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
+    auto& shard{ ctx->shard(json.at("table")) };
+    std::lock_guard<std::shared_timed_mutex> lock{ shard.m_syncMutex };
 
-    ctx->m_dbEngine->deleteTableRowsData(json.at("table"),
-                                         json.at("query"));
+    shard.m_dbEngine->deleteTableRowsData(json.at("table"),
+                                          json.at("query"));
 }
 
 void DBSyncImplementation::updateSnapshotData(const DBSYNC_HANDLE   handle,
@@ -99,9 +347,10 @@ void DBSyncImplementation::updateSnapshotData(const DBSYNC_HANDLE   handle,
                                               const ResultCallback  callback)
 {
     const auto ctx{ dbEngineContext(handle) };
+    auto& shard{ ctx->shard(json.at("table")) };
 
-    std::unique_lock<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
-    ctx->m_dbEngine->refreshTableData(json, callback, lock);
+    std::unique_lock<std::shared_timed_mutex> lock{ shard.m_syncMutex };
+    shard.m_dbEngine->refreshTableData(json, callback, lock);
 }
 
 std::shared_ptr<DBSyncImplementation::DbEngineContext> DBSyncImplementation::dbEngineContext(const DBSYNC_HANDLE handle)
@@ -122,9 +371,44 @@ void DBSyncImplementation::setMaxRows(const DBSYNC_HANDLE handle,
                                       const long long maxRows)
 {
     const auto ctx{ dbEngineContext(handle) };
+    auto& shard{ ctx->shard(table) };
+
+    std::lock_guard<std::shared_timed_mutex> lock{ shard.m_syncMutex };
+    shard.m_dbEngine->setMaxRows(table, maxRows);
+}
+
+nlohmann::json DBSyncImplementation::tuningInfo(const DBSYNC_HANDLE handle)
+{
+    const auto ctx{ dbEngineContext(handle) };
+    auto& shard{ ctx->mainShard() };
+
+    std::lock_guard<std::shared_timed_mutex> lock{ shard.m_syncMutex };
+    return shard.m_dbEngine->tuningInfo();
+}
+
+void DBSyncImplementation::backup(const DBSYNC_HANDLE handle,
+                                  const std::string& path)
+{
+    const auto ctx{ dbEngineContext(handle) };
 
-    std::lock_guard<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
-    ctx->m_dbEngine->setMaxRows(table, maxRows);
+    // Each shard is saved next to the main snapshot, under the same name as its database file.
+    for (const auto& shard : ctx->m_shards)
+    {
+        std::lock_guard<std::shared_timed_mutex> lock{ shard->m_syncMutex };
+        shard->m_dbEngine->backup(shardPath(path, shard->m_name));
+    }
+}
+
+void DBSyncImplementation::restore(const DBSYNC_HANDLE handle,
+                                   const std::string& path)
+{
+    const auto ctx{ dbEngineContext(handle) };
+
+    for (const auto& shard : ctx->m_shards)
+    {
+        std::lock_guard<std::shared_timed_mutex> lock{ shard->m_syncMutex };
+        shard->m_dbEngine->restore(shardPath(path, shard->m_name));
+    }
 }
 
 TXN_HANDLE DBSyncImplementation::createTransaction(const DBSYNC_HANDLE      handle,
@@ -136,9 +420,13 @@ TXN_HANDLE DBSyncImplementation::createTransaction(const DBSYNC_HANDLE      hand
         std::make_shared<TransactionContext>(json)
     };
 
-    std::lock_guard<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
     ctx->addTransactionContext(spTransactionContext);
-    ctx->m_dbEngine->initializeStatusField(spTransactionContext->m_tables);
+
+    for (const auto& shardTables : ctx->shardTables(spTransactionContext->m_tables))
+    {
+        std::lock_guard<std::shared_timed_mutex> lock{ shardTables.first->m_syncMutex };
+        shardTables.first->m_dbEngine->initializeStatusField(shardTables.second);
+    }
 
     return spTransactionContext.get();
 }
@@ -149,8 +437,12 @@ void DBSyncImplementation::closeTransaction(const DBSYNC_HANDLE handle,
     const auto& ctx{ dbEngineContext(handle) };
     const auto& tnxCtx { ctx->transactionContext(txn) };
 
-    std::lock_guard<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
-    ctx->m_dbEngine->deleteRowsByStatusField(tnxCtx->m_tables);
+    for (const auto& shardTables : ctx->shardTables(tnxCtx->m_tables))
+    {
+        std::lock_guard<std::shared_timed_mutex> lock{ shardTables.first->m_syncMutex };
+        shardTables.first->m_dbEngine->deleteRowsByStatusField(shardTables.second);
+    }
+
     ctx->deleteTransactionContext(txn);
 }
 
@@ -161,8 +453,11 @@ void DBSyncImplementation::getDeleted(const DBSYNC_HANDLE   handle,
     const auto& ctx{ dbEngineContext(handle) };
     const auto& tnxCtx { ctx->transactionContext(txnHandle) };
 
-    std::unique_lock<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
-    ctx->m_dbEngine->returnRowsMarkedForDelete(tnxCtx->m_tables, callback, lock);
+    for (const auto& shardTables : ctx->shardTables(tnxCtx->m_tables))
+    {
+        std::unique_lock<std::shared_timed_mutex> lock{ shardTables.first->m_syncMutex };
+        shardTables.first->m_dbEngine->returnRowsMarkedForDelete(shardTables.second, callback, lock);
+    }
 }
 
 void DBSyncImplementation::selectData(const DBSYNC_HANDLE   handle,
@@ -171,18 +466,56 @@ void DBSyncImplementation::selectData(const DBSYNC_HANDLE   handle,
 {
     const auto ctx{ dbEngineContext(handle) };
 
-    std::unique_lock<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
-    ctx->m_dbEngine->selectData(json.at("table"),
-                                json.at("query"),
-                                callback,
-                                lock);
+    // Engines with read only connections serve selects without waiting for the sync operations.
+    auto& shard{ ctx->shard(json.at("table")) };
+    std::unique_lock<std::shared_timed_mutex> lock{ shard.m_syncMutex, std::defer_lock };
+
+    if (!shard.m_dbEngine->concurrentReads())
+    {
+        lock.lock();
+    }
+
+    shard.m_dbEngine->selectData(json.at("table"),
+                                 json.at("query"),
+                                 callback,
+                                 lock);
+}
+
+void DBSyncImplementation::selectRows(const DBSYNC_HANDLE   handle,
+                                      const nlohmann::json& json,
+                                      const RowCallback&    callback)
+{
+    const auto ctx{ dbEngineContext(handle) };
+
+    auto& shard{ ctx->shard(json.at("table")) };
+    std::unique_lock<std::shared_timed_mutex> lock{ shard.m_syncMutex, std::defer_lock };
+
+    if (!shard.m_dbEngine->concurrentReads())
+    {
+        lock.lock();
+    }
+
+    shard.m_dbEngine->selectRows(json.at("table"),
+                                 json.at("query"),
+                                 callback,
+                                 lock);
 }
 
 void DBSyncImplementation::addTableRelationship(const DBSYNC_HANDLE   handle,
                                                 const nlohmann::json& json)
 {
     const auto ctx{ dbEngineContext(handle) };
+    auto& shard{ ctx->shard(json.at("base_table")) };
+
+    // The relationship triggers can only reach the tables of their own database file.
+    for (const auto& relatedTable : json.at("relationed_tables"))
+    {
+        if (&shard != &ctx->shard(relatedTable.at("table")))
+        {
+            throw dbsync_error { INVALID_SHARD_RELATIONSHIP };
+        }
+    }
 
-    std::lock_guard<std::shared_timed_mutex> lock{ ctx->m_syncMutex };
-    ctx->m_dbEngine->addTableRelationship(json);
+    std::lock_guard<std::shared_timed_mutex> lock{ shard.m_syncMutex };
+    shard.m_dbEngine->addTableRelationship(json);
 }
@@ -16,6 +16,7 @@
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <vector>
 #include "dbengine_factory.h"
 #include "commonDefs.h"
 #include "json.hpp"
@@ -43,6 +44,16 @@ namespace DbSync
                              const nlohmann::json&  json,
                              const ResultCallback   callback);
 
+            void syncRowsData(const DBSYNC_HANDLE    handle,
+                              const TXN_HANDLE       txnHandle,
+                              const nlohmann::json&  json,
+                              const ResultCallback   callback);
+
+            void keepRowsData(const DBSYNC_HANDLE    handle,
+                              const TXN_HANDLE       txnHandle,
+                              const nlohmann::json&  json,
+                              const ResultCallback   callback);
+
             void deleteRowsData(const DBSYNC_HANDLE     handle,
                                 const nlohmann::json&   json);
 
@@ -50,10 +61,19 @@ namespace DbSync
                                     const nlohmann::json&   json,
                                     const ResultCallback    callback);
 
-            DBSYNC_HANDLE initialize(const HostType     hostType,
-                                     const DbEngineType dbType,
-                                     const std::string& path,
-                                     const std::string& sqlStatement);
+            DBSYNC_HANDLE initialize(const HostType        hostType,
+                                     const DbEngineType    dbType,
+                                     const std::string&    path,
+                                     const std::string&    sqlStatement,
+                                     const nlohmann::json& tuningConfig = {});
+
+            nlohmann::json tuningInfo(const DBSYNC_HANDLE handle);
+
+            void backup(const DBSYNC_HANDLE handle,
+                        const std::string& path);
+
+            void restore(const DBSYNC_HANDLE handle,
+                         const std::string& path);
 
             void setMaxRows(const DBSYNC_HANDLE handle,
                             const std::string& table,
@@ -73,6 +93,10 @@ namespace DbSync
                             const nlohmann::json&  json,
                             const ResultCallback&  callback);
 
+            void selectRows(const DBSYNC_HANDLE    handle,
+                            const nlohmann::json&  json,
+                            const RowCallback&     callback);
+
             void addTableRelationship(const DBSYNC_HANDLE   handle,
                                       const nlohmann::json& json);
 
@@ -88,19 +112,65 @@ namespace DbSync
                 {}
                 nlohmann::json m_tables;
             };
+            struct DbShard final
+            {
+                DbShard(std::unique_ptr<IDbEngine> dbEngine,
+                        const std::string& name)
+                    : m_dbEngine{std::move(dbEngine)}
+                    , m_name{name}
+                {}
+                const std::unique_ptr<IDbEngine> m_dbEngine;
+                // Empty for the main shard, the one holding the tables that are not placed in any other.
+                const std::string m_name;
+                std::shared_timed_mutex m_syncMutex;
+            };
             class DbEngineContext final
             {
                 public:
-                    DbEngineContext(std::unique_ptr<IDbEngine>& dbEngine,
+                    DbEngineContext(std::vector<std::unique_ptr<DbShard>>& shards,
+                                    std::map<std::string, size_t>& tableShards,
                                     const HostType hostType,
                                     const DbEngineType dbType)
-                        : m_dbEngine{std::move(dbEngine)}
+                        : m_shards{std::move(shards)}
+                        , m_tableShards{std::move(tableShards)}
                         , m_hostType{hostType}
                         , m_dbEngineType{dbType}
                     {}
-                    const std::unique_ptr<IDbEngine> m_dbEngine;
+                    const std::vector<std::unique_ptr<DbShard>> m_shards;
+                    const std::map<std::string, size_t> m_tableShards;
                     const HostType m_hostType;
                     const DbEngineType m_dbEngineType;
+                    DbShard& shard(const std::string& table) const
+                    {
+                        const auto it{ m_tableShards.find(table) };
+                        return *m_shards[m_tableShards.end() == it ? 0 : it->second];
+                    }
+                    DbShard& mainShard() const
+                    {
+                        return *m_shards.front();
+                    }
+                    // Splits a list of tables by shard, in shard order.
+                    std::vector<std::pair<DbShard*, nlohmann::json>> shardTables(const nlohmann::json& tables) const
+                    {
+                        std::vector<nlohmann::json> tablesByShard(m_shards.size(), nlohmann::json::array());
+                        std::vector<std::pair<DbShard*, nlohmann::json>> ret;
+
+                        for (const auto& table : tables)
+                        {
+                            const auto it{ m_tableShards.find(table.get_ref<const std::string&>()) };
+                            tablesByShard[m_tableShards.end() == it ? 0 : it->second].push_back(table);
+                        }
+
+                        for (size_t i = 0; i < m_shards.size(); ++i)
+                        {
+                            if (!tablesByShard[i].empty())
+                            {
+                                ret.emplace_back(m_shards[i].get(), std::move(tablesByShard[i]));
+                            }
+                        }
+
+                        return ret;
+                    }
                     const std::shared_ptr<DBSyncImplementation::TransactionContext> transactionContext(const TXN_HANDLE handle)
                     {
                         std::lock_guard<std::mutex> lock{m_mutex};
@@ -124,7 +194,6 @@ namespace DbSync
                         m_transactionContexts.erase(txnHandle);
                     }
 
-                    std::shared_timed_mutex m_syncMutex;
                 private:
                     std::map<TXN_HANDLE, std::shared_ptr<TransactionContext>> m_transactionContexts;
                     std::mutex m_mutex;
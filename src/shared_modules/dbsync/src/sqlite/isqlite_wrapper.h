@@ -41,6 +41,8 @@ namespace SQLite
             virtual void execute(const std::string& query) = 0;
             virtual int64_t changes() const = 0;
             virtual const std::shared_ptr<sqlite3>& db() const = 0;
+            virtual void backup(const std::string& path) = 0;
+            virtual void restore(const std::string& path) = 0;
     };
 
     class ITransaction
@@ -9,7 +9,9 @@
  * Foundation.
  */
 
+#include <algorithm>
 #include <fstream>
+#include <limits>
 #include <thread>
 #include "db_exception.h"
 #include "mapWrapperSafe.h"
@@ -21,27 +23,303 @@
 using namespace std::chrono_literals;
 auto constexpr MAX_TRIES = 5;
 
+static void getSyncOptions(const nlohmann::json& jsInput,
+                           bool& returnOldData,
+                           nlohmann::json& ignoredColumns)
+{
+    auto it { jsInput.find("options") };
+
+    if (jsInput.end() != it)
+    {
+        auto itOldData { it->find("return_old_data") };
+
+        if (it->end() != itOldData)
+        {
+            returnOldData = itOldData->is_boolean() ? itOldData.value().get<bool>() : returnOldData;
+        }
+
+        auto itIgnoredFields { it->find("ignore") };
+
+        if (it->end() != itIgnoredFields)
+        {
+            ignoredColumns = itIgnoredFields->is_array() ? itIgnoredFields.value() : ignoredColumns;
+        }
+    }
+}
+
+static bool isEqualFieldValue(const TableField& field,
+                              const nlohmann::json& value)
+{
+    // Mirrors the nlohmann::json numeric comparison rules so the result is the same as comparing
+    // against a materialised JSON value, without building one.
+    const auto type { std::get<GenericTupleIndex::GenType>(field) };
+
+    if (ColumnType::Text == type)
+    {
+        return value.is_string() && value.get_ref<const std::string&>() == std::get<ColumnType::Text>(field);
+    }
+
+    if (ColumnType::Integer == type || ColumnType::BigInt == type)
+    {
+        const int64_t stored
+        {
+            ColumnType::Integer == type ? std::get<ColumnType::Integer>(field) : std::get<ColumnType::BigInt>(field)
+        };
+
+        if (value.is_number_unsigned())
+        {
+            return stored == static_cast<int64_t>(value.get<uint64_t>());
+        }
+        else if (value.is_number_integer())
+        {
+            return stored == value.get<int64_t>();
+        }
+        else if (value.is_number_float())
+        {
+            return static_cast<double_t>(stored) == value.get<double_t>();
+        }
+
+        return false;
+    }
+
+    if (ColumnType::UnsignedBigInt == type)
+    {
+        const auto stored { std::get<ColumnType::UnsignedBigInt>(field) };
+
+        if (value.is_number_unsigned())
+        {
+            return stored == value.get<uint64_t>();
+        }
+        else if (value.is_number_integer())
+        {
+            return static_cast<int64_t>(stored) == value.get<int64_t>();
+        }
+        else if (value.is_number_float())
+        {
+            return static_cast<double_t>(stored) == value.get<double_t>();
+        }
+
+        return false;
+    }
+
+    if (ColumnType::Double == type)
+    {
+        const auto stored { std::get<ColumnType::Double>(field) };
+
+        if (value.is_number_float())
+        {
+            return stored == value.get<double_t>();
+        }
+        else if (value.is_number_unsigned())
+        {
+            return stored == static_cast<double_t>(value.get<uint64_t>());
+        }
+        else if (value.is_number_integer())
+        {
+            return stored == static_cast<double_t>(value.get<int64_t>());
+        }
+
+        return false;
+    }
+
+    throw dbengine_error { DATATYPE_NOT_IMPLEMENTED };
+}
+
+static TableField getTableFieldFromJson(const ColumnType type,
+                                        const nlohmann::json& jsData)
+{
+    const auto hasString { jsData.is_string() && jsData.get_ref<const std::string&>().size() };
+
+    // Same conversions applied by bindJsonData, so the field matches the stored value.
+    if (ColumnType::BigInt == type)
+    {
+        const int64_t value { jsData.is_number() ? jsData.get<int64_t>() : hasString ? std::stoll(jsData.get_ref<const std::string&>()) : 0 };
+        return std::make_tuple(type, std::string(), 0, value, 0, 0);
+    }
+    else if (ColumnType::UnsignedBigInt == type)
+    {
+        const uint64_t value { jsData.is_number_unsigned() ? jsData.get<uint64_t>() : hasString ? std::stoull(jsData.get_ref<const std::string&>()) : 0 };
+        return std::make_tuple(type, std::string(), 0, 0, value, 0);
+    }
+    else if (ColumnType::Integer == type)
+    {
+        const int32_t value { jsData.is_number() ? jsData.get<int32_t>() : hasString ? std::stoi(jsData.get_ref<const std::string&>()) : 0 };
+        return std::make_tuple(type, std::string(), value, 0, 0, 0);
+    }
+    else if (ColumnType::Text == type)
+    {
+        return std::make_tuple(type, jsData.is_string() ? jsData.get<std::string>() : "", 0, 0, 0, 0);
+    }
+    else if (ColumnType::Double == type)
+    {
+        const double_t value { jsData.is_number() ? jsData.get<double>() : hasString ? std::stod(jsData.get_ref<const std::string&>()) : .0f };
+        return std::make_tuple(type, std::string(), 0, 0, 0, value);
+    }
+    else
+    {
+        throw dbengine_error { INVALID_COLUMN_TYPE };
+    }
+}
+
+template<typename T>
+static int compareValues(const T& lhs, const T& rhs)
+{
+    return lhs < rhs ? -1 : rhs < lhs ? 1 : 0;
+}
+
+static int comparePrimaryKeys(const std::vector<TableField>& lhs,
+                              const std::vector<TableField>& rhs)
+{
+    // Follows the SQLite ordering of the stored values (integers are signed 64 bits, text is
+    // compared byte by byte), so it can be merged against an ORDER BY cursor.
+    for (size_t i = 0; i < lhs.size() && i < rhs.size(); ++i)
+    {
+        const auto type { std::get<GenericTupleIndex::GenType>(lhs[i]) };
+        auto result { 0 };
+
+        if (ColumnType::Text == type)
+        {
+            result = std::get<ColumnType::Text>(lhs[i]).compare(std::get<ColumnType::Text>(rhs[i]));
+            result = compareValues(result, 0);
+        }
+        else if (ColumnType::BigInt == type)
+        {
+            result = compareValues(std::get<ColumnType::BigInt>(lhs[i]), std::get<ColumnType::BigInt>(rhs[i]));
+        }
+        else if (ColumnType::UnsignedBigInt == type)
+        {
+            result = compareValues(static_cast<int64_t>(std::get<ColumnType::UnsignedBigInt>(lhs[i])),
+                                   static_cast<int64_t>(std::get<ColumnType::UnsignedBigInt>(rhs[i])));
+        }
+        else if (ColumnType::Integer == type)
+        {
+            result = compareValues(std::get<ColumnType::Integer>(lhs[i]), std::get<ColumnType::Integer>(rhs[i]));
+        }
+        else if (ColumnType::Double == type)
+        {
+            result = compareValues(std::get<ColumnType::Double>(lhs[i]), std::get<ColumnType::Double>(rhs[i]));
+        }
+
+        if (0 != result)
+        {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+static std::vector<TableField> getPrimaryKeyFields(const TableSchema& schema,
+                                                   const nlohmann::json& data)
+{
+    std::vector<TableField> fields;
+    fields.reserve(schema.primaryKeyIndexes.size());
+
+    for (const auto& pkIndex : schema.primaryKeyIndexes)
+    {
+        const auto& column { schema.columns[pkIndex] };
+        const auto& itData { data.find(std::get<TableHeader::Name>(column)) };
+
+        if (data.end() == itData)
+        {
+            throw dbengine_error { BIND_FIELDS_DOES_NOT_MATCH };
+        }
+
+        fields.push_back(getTableFieldFromJson(std::get<TableHeader::Type>(column), *itData));
+    }
+
+    return fields;
+}
+
+static bool isSortedByPrimaryKey(const TableSchema& schema,
+                                 const nlohmann::json& data)
+{
+    std::vector<TableField> previousKey;
+
+    for (const auto& entry : data)
+    {
+        auto currentKey { getPrimaryKeyFields(schema, entry) };
+
+        // Strictly ascending, repeated keys can't be merged.
+        if (!previousKey.empty() && comparePrimaryKeys(previousKey, currentKey) >= 0)
+        {
+            return false;
+        }
+
+        previousKey = std::move(currentKey);
+    }
+
+    return true;
+}
+
+static nlohmann::json getDataToUpdate(const std::vector<std::string>& primaryKeyList,
+                                      const nlohmann::json& result,
+                                      const nlohmann::json& dataParam,
+                                      const bool inTransactionParam,
+                                      const int64_t statusGeneration)
+{
+    nlohmann::json ret;
+
+    if (inTransactionParam)
+    {
+        // No changes detected, only update the status field to avoid row deletion during the txn close.
+        if (result.empty())
+        {
+            std::for_each(primaryKeyList.begin(),
+                          primaryKeyList.end(),
+                          [&dataParam, &ret](const std::string & pKey)
+            {
+                if (dataParam.find(pKey) != dataParam.end())
+                {
+                    ret[pKey] = dataParam[pKey];
+                }
+            });
+        }
+        else // Changes detected, update the row with the new values.
+        {
+            ret = result;
+        }
+
+        ret[STATUS_FIELD_NAME] = statusGeneration;
+    }
+    else if (!result.empty())
+    {
+        ret = result;
+    }
+
+    return ret;
+}
+
 SQLiteDBEngine::SQLiteDBEngine(const std::shared_ptr<ISQLiteFactory>& sqliteFactory,
                                const std::string& path,
-                               const std::string& tableStmtCreation)
-    : m_sqliteFactory(sqliteFactory)
+                               const std::string& tableStmtCreation,
+                               const nlohmann::json& tuningConfig)
+    : m_statementsCacheStats{}
+    , m_sqliteFactory(sqliteFactory)
+    , m_concurrentReads{ false }
+    , m_attached{ false }
 {
-    initialize(path, tableStmtCreation);
+    initialize(path, tableStmtCreation, tuningConfig);
 }
 
 SQLiteDBEngine::~SQLiteDBEngine()
 {
     std::lock_guard<std::mutex> lock(m_stmtMutex);
+    m_statementsCacheIndex.clear();
     m_statementsCache.clear();
 }
 
+StatementCacheStats SQLiteDBEngine::statementCacheStats() const
+{
+    std::lock_guard<std::mutex> lock(m_stmtMutex);
+    return m_statementsCacheStats;
+}
+
 void SQLiteDBEngine::setMaxRows(const std::string& table,
                                 const int64_t maxRows)
 {
     if (0 != loadTableData(table))
     {
-        std::lock_guard<std::mutex> lock(m_maxRowsMutex);
-
         if (maxRows < 0)
         {
             throw dbengine_error { MIN_ROW_LIMIT_BELOW_ZERO };
@@ -64,7 +342,7 @@ void SQLiteDBEngine::setMaxRows(const std::string& table,
                     stmt->column(0)->value(int64_t{})
                 };
 
-                m_maxRows[table] = { maxRows, currentRows };
+                m_maxRows[table] = std::make_unique<MaxRows>(maxRows, currentRows);
             }
             else
             {
@@ -81,19 +359,133 @@ void SQLiteDBEngine::setMaxRows(const std::string& table,
 void SQLiteDBEngine::bulkInsert(const std::string& table,
                                 const nlohmann::json& data)
 {
-    if (0 != loadTableData(table))
+    bulkInsertData(table, data, false);
+    publishChanges();
+}
+
+void SQLiteDBEngine::bulkUpsert(const std::string& table,
+                                const nlohmann::json& data)
+{
+    bulkInsertData(table, data, true);
+    publishChanges();
+}
+
+void SQLiteDBEngine::bulkInsertData(const std::string& table,
+                                    const nlohmann::json& data,
+                                    const bool upsert)
+{
+    if (0 == loadTableData(table))
+    {
+        throw dbengine_error { EMPTY_TABLE_METADATA };
+    }
+
+    const auto schema { tableSchema(table) };
+    std::vector<const ColumnData*> batchColumns;
+    std::vector<const nlohmann::json*> batch;
+    size_t batchRows { 0ull };
+
+    for (const auto& element : data)
     {
-        const auto& tableFieldsMetaData { m_tableFields[table] };
+        std::vector<const ColumnData*> columns;
+
+        for (const auto& field : schema->columns)
+        {
+            if (element.find(std::get<TableHeader::Name>(field)) != element.end())
+            {
+                columns.push_back(&field);
+            }
+        }
 
-        for (const auto& element : data)
+        // Consecutive elements with the same columns share a statement.
+        if (!batch.empty() && (batchColumns != columns || batch.size() == batchRows))
         {
-            insertElement(table, tableFieldsMetaData, element);
+            insertBatch(table, *schema, batchColumns, batch, upsert);
+            batch.clear();
+        }
+
+        if (columns.empty())
+        {
+            insertElement(table, schema->columns, element);
+        }
+        else
+        {
+            if (batch.empty())
+            {
+                batchColumns = std::move(columns);
+                // Batches are capped to the rows left before the limit, so the rows are still inserted
+                // until the limit is reached.
+                batchRows = std::max(1ull, std::min({ BULK_INSERT_BATCH_ROWS,
+                                                      SQLITE_MAX_BIND_PARAMETERS / batchColumns.size(),
+                                                      static_cast<unsigned long long>(remainingRows(table)) }));
+            }
+
+            batch.push_back(&element);
         }
     }
-    else
+
+    if (!batch.empty())
     {
-        throw dbengine_error { EMPTY_TABLE_METADATA };
+        insertBatch(table, *schema, batchColumns, batch, upsert);
+    }
+}
+
+void SQLiteDBEngine::insertBatch(const std::string& table,
+                                 const TableSchema& schema,
+                                 const std::vector<const ColumnData*>& columns,
+                                 const std::vector<const nlohmann::json*>& batch,
+                                 const bool upsert)
+{
+    const auto& upsertPrimaryKeys { upsert ? schema.primaryKeys : std::vector<std::string> {} };
+    const auto stmt { getStatement(buildBulkInsertDataSqlQuery(table, columns, batch.size(), upsertPrimaryKeys)) };
+    auto insertedRows { static_cast<long long>(batch.size()) };
+    int32_t index { 1l };
+
+    if (!upsertPrimaryKeys.empty() && hasMaxRows(table))
+    {
+        // Only the rows that don't exist yet count against the max rows.
+        const auto stmtExists { getStatement(schema.selectMatchingPKsQuery) };
+
+        for (const auto& element : batch)
+        {
+            int32_t pkIndex { 1l };
+
+            for (const auto& pk : schema.primaryKeyIndexes)
+            {
+                bindJsonData(stmtExists, schema.columns[pk], *element, pkIndex);
+                ++pkIndex;
+            }
+
+            if (SQLITE_ROW == stmtExists->step())
+            {
+                --insertedRows;
+            }
+
+            stmtExists->reset();
+        }
+    }
+
+    for (const auto& element : batch)
+    {
+        for (const auto& column : columns)
+        {
+            if (bindJsonData(stmt, *column, *element, index))
+            {
+                ++index;
+            }
+        }
+    }
+
+    updateTableRowCounter(table, insertedRows);
+
+    // LCOV_EXCL_START
+    if (SQLITE_ERROR == stmt->step())
+    {
+        updateTableRowCounter(table, insertedRows * -1ll);
+        throw dbengine_error{ BIND_FIELDS_DOES_NOT_MATCH };
     }
+
+    // LCOV_EXCL_STOP
+    stmt->reset();
 }
 
 void SQLiteDBEngine::refreshTableData(const nlohmann::json& data,
@@ -101,10 +493,22 @@ void SQLiteDBEngine::refreshTableData(const nlohmann::json& data,
                                       std::unique_lock<std::shared_timed_mutex>& lock)
 {
     const std::string table { data.at("table").is_string() ? data.at("table").get_ref<const std::string&>() : "" };
+    const auto itOptions { data.find("options") };
+    const auto sorted
+    {
+        data.end() != itOptions && itOptions->contains("sorted") && itOptions->at("sorted").is_boolean() && itOptions->at("sorted").get<bool>()
+    };
+
+    // Snapshots already sorted by primary key are merged against the live table in a single pass.
+    if (sorted && 0 != loadTableData(table) && mergeSortedSnapshot(table, data.at("data"), callback, lock))
+    {
+        publishChanges();
+        return;
+    }
 
     if (createCopyTempTable(table))
     {
-        bulkInsert(table + TEMP_TABLE_SUBFIX, data.at("data"));
+        bulkInsertData(table + TEMP_TABLE_SUBFIX, data.at("data"), false);
 
         if (0 != loadTableData(table))
         {
@@ -142,76 +546,192 @@ void SQLiteDBEngine::refreshTableData(const nlohmann::json& data,
 
         // LCOV_EXCL_STOP
     }
+
+    publishChanges();
 }
 
-void SQLiteDBEngine::syncTableRowData(const nlohmann::json& jsInput,
-                                      const DbSync::ResultCallback callback,
-                                      const bool inTransaction,
-                                      Utils::ILocking& lock)
+bool SQLiteDBEngine::mergeSortedSnapshot(const std::string& table,
+                                         const nlohmann::json& data,
+                                         const DbSync::ResultCallback callback,
+                                         std::unique_lock<std::shared_timed_mutex>& lock)
 {
-    const auto& table { jsInput.at("table") };
-    const auto& data { jsInput.at("data") };
-
-    auto it { jsInput.find("options") };
-    auto returnOldData { false };
-    nlohmann::json ignoredColumns { };
+    const auto schema { tableSchema(table) };
 
-    if (jsInput.end() != it)
+    if (schema->primaryKeys.empty() || !isSortedByPrimaryKey(*schema, data))
     {
-        auto itOldData { it->find("return_old_data") };
-
-        if (it->end() != itOldData)
-        {
-            returnOldData = itOldData->is_boolean() ? itOldData.value().get<bool>() : returnOldData;
-        }
-
-        auto itIgnoredFields { it->find("ignore") };
-
-        if (it->end() != itIgnoredFields)
-        {
-            ignoredColumns = itIgnoredFields->is_array() ? itIgnoredFields.value() : ignoredColumns;
-        }
+        return false;
     }
 
-    static const auto getDataToUpdate
+    std::vector<Row> rowsToRemove;
+    std::vector<Row> rowsToModify;
+    std::vector<const nlohmann::json*> rowsToInsert;
+    const auto stmt { getStatement(schema->selectOrderedByPKsQuery) };
+    std::vector<TableField> storedKey;
+
+    const auto nextStoredRow
     {
-        [](const std::vector<std::string>& primaryKeyList,
-           const nlohmann::json & result,
-           const nlohmann::json & dataParam,
-           const bool inTransactionParam)
+        [&]() -> bool
         {
-            nlohmann::json ret;
+            storedKey.clear();
 
-            if (inTransactionParam)
+            if (SQLITE_ROW != stmt->step())
             {
-                // No changes detected, only update the status field to avoid row deletion during the txn close.
-                if (result.empty())
-                {
-                    std::for_each(primaryKeyList.begin(),
-                                  primaryKeyList.end(),
-                                  [&dataParam, &ret](const std::string & pKey)
+                return false;
+            }
+
+            for (const auto& pkIndex : schema->primaryKeyIndexes)
+            {
+                const auto& column { schema->columns[pkIndex] };
+                storedKey.push_back(getTableField(stmt, std::get<TableHeader::CID>(column), std::get<TableHeader::Type>(column)));
+            }
+
+            return true;
+        }
+    };
+
+    const auto primaryKeyRow
+    {
+        [&schema](const std::vector<TableField>& key, const std::string& prefix)
+        {
+            Row row;
+            auto itKey { schema->primaryKeys.begin() };
+
+            for (const auto& field : key)
+            {
+                row[prefix + *itKey] = field;
+                ++itKey;
+            }
+
+            return row;
+        }
+    };
+
+    auto hasStoredRow { nextStoredRow() };
+
+    for (const auto& entry : data)
+    {
+        const auto key { getPrimaryKeyFields(*schema, entry) };
+
+        while (hasStoredRow && comparePrimaryKeys(storedKey, key) < 0)
+        {
+            rowsToRemove.push_back(primaryKeyRow(storedKey, ""));
+            hasStoredRow = nextStoredRow();
+        }
+
+        if (hasStoredRow && 0 == comparePrimaryKeys(storedKey, key))
+        {
+            Row modifiedFields;
+
+            for (const auto& column : schema->columns)
+            {
+                const auto& it { entry.find(std::get<TableHeader::Name>(column)) };
+
+                if (!std::get<TableHeader::PK>(column) && entry.end() != it)
+                {
+                    const auto storedField { getTableField(stmt, std::get<TableHeader::CID>(column), std::get<TableHeader::Type>(column)) };
+
+                    if (!isEqualFieldValue(storedField, *it))
                     {
-                        if (dataParam.find(pKey) != dataParam.end())
-                        {
-                            ret[pKey] = dataParam[pKey];
-                        }
-                    });
+                        modifiedFields[std::get<TableHeader::Name>(column)] = getTableFieldFromJson(std::get<TableHeader::Type>(column), *it);
+                    }
                 }
-                else // Changes detected, update the row with the new values.
+            }
+
+            if (!modifiedFields.empty())
+            {
+                // Same layout generated by getRowsToModify, so the rows can be applied by updateRows.
+                auto row { primaryKeyRow(storedKey, "PK_") };
+                row.insert(modifiedFields.begin(), modifiedFields.end());
+                rowsToModify.push_back(std::move(row));
+            }
+
+            hasStoredRow = nextStoredRow();
+        }
+        else
+        {
+            rowsToInsert.push_back(&entry);
+        }
+    }
+
+    while (hasStoredRow)
+    {
+        rowsToRemove.push_back(primaryKeyRow(storedKey, ""));
+        hasStoredRow = nextStoredRow();
+    }
+
+    stmt->reset();
+
+    // The changes are applied once the cursor is done, in the same order used by the temp table path.
+    const auto notify
+    {
+        [&](const ReturnTypeCallback type, const Row & row)
+        {
+            if (callback)
+            {
+                nlohmann::json object;
+
+                for (const auto& value : row)
                 {
-                    ret = result;
+                    getFieldValueFromTuple(value, object);
                 }
 
-                ret[STATUS_FIELD_NAME] = 1;
+                lock.unlock();
+                callback(type, object);
+                lock.lock();
             }
-            else if (!result.empty())
+        }
+    };
+
+    if (!rowsToRemove.empty() && deleteRows(table, schema->primaryKeys, rowsToRemove))
+    {
+        for (const auto& row : rowsToRemove)
+        {
+            notify(ReturnTypeCallback::DELETED, row);
+        }
+    }
+
+    if (!rowsToModify.empty() && updateRows(table, schema->primaryKeys, rowsToModify))
+    {
+        for (const auto& row : rowsToModify)
+        {
+            notify(ReturnTypeCallback::MODIFIED, row);
+        }
+    }
+
+    for (const auto& entry : rowsToInsert)
+    {
+        insertElement(table, schema->columns, *entry);
+
+        Row row;
+
+        for (const auto& column : schema->columns)
+        {
+            if (!std::get<TableHeader::TXNStatusField>(column))
             {
-                ret = result;
+                const auto& it { entry->find(std::get<TableHeader::Name>(column)) };
+                row[std::get<TableHeader::Name>(column)] = getTableFieldFromJson(std::get<TableHeader::Type>(column),
+                                                                                 entry->end() != it ? *it : nlohmann::json {});
             }
-
-            return ret;
         }
-    };
+
+        notify(ReturnTypeCallback::INSERTED, row);
+    }
+
+    return true;
+}
+
+void SQLiteDBEngine::syncTableRowData(const nlohmann::json& jsInput,
+                                      const DbSync::ResultCallback callback,
+                                      const bool inTransaction,
+                                      Utils::ILocking& lock)
+{
+    const auto& table { jsInput.at("table") };
+    const auto& data { jsInput.at("data") };
+
+    auto returnOldData { false };
+    nlohmann::json ignoredColumns { };
+    getSyncOptions(jsInput, returnOldData, ignoredColumns);
+
     std::vector<std::string> primaryKeyList;
 
     if (0 != loadTableData(table))
@@ -226,36 +746,11 @@ void SQLiteDBEngine::syncTableRowData(const nlohmann::json& jsInput,
 
                 if (diffExist)
                 {
-                    const auto& jsDataToUpdate{getDataToUpdate(primaryKeyList, updated, entry, inTransaction)};
-
-                    if (!jsDataToUpdate.empty())
-                    {
-                        updateSingleRow(table, jsDataToUpdate);
-
-                        if (callback && !updated.empty())
-                        {
-
-                            lock.unlock();
-
-                            if (returnOldData)
-                            {
-                                nlohmann::json diff;
-                                diff["old"] = oldData;
-                                diff["new"] = updated;
-                                callback(MODIFIED, diff);
-                            }
-                            else
-                            {
-                                callback(MODIFIED, updated);
-                            }
-
-                            lock.lock();
-                        }
-                    }
+                    updateRowAndNotify(table, primaryKeyList, entry, updated, oldData, returnOldData, inTransaction, callback, lock);
                 }
                 else
                 {
-                    insertElement(table, m_tableFields[table], entry,
+                    insertElement(table, tableSchema(table)->columns, entry,
                                   [&]()
                     {
                         // LCOV_EXCL_START
@@ -271,6 +766,12 @@ void SQLiteDBEngine::syncTableRowData(const nlohmann::json& jsInput,
                 }
             }
         }
+
+        // Rows synced within a transaction are published when the transaction is closed.
+        if (!inTransaction)
+        {
+            publishChanges();
+        }
     }
     else
     {
@@ -278,6 +779,156 @@ void SQLiteDBEngine::syncTableRowData(const nlohmann::json& jsInput,
     }
 }
 
+void SQLiteDBEngine::syncTableRowsData(const nlohmann::json& jsInput,
+                                       const DbSync::ResultCallback callback,
+                                       Utils::ILocking& lock)
+{
+    const std::string table { jsInput.at("table").is_string() ? jsInput.at("table").get_ref<const std::string&>() : "" };
+    const auto& data { jsInput.at("data") };
+
+    if (0 == loadTableData(table))
+    {
+        throw dbengine_error { EMPTY_TABLE_METADATA };
+    }
+
+    std::vector<std::string> primaryKeyList;
+
+    if (!getPrimaryKeysFromTable(table, primaryKeyList) || primaryKeyList.empty())
+    {
+        throw dbengine_error { SQL_STMT_ERROR };
+    }
+
+    // The per row path handles repeated primary keys in the same batch (the staging table can't hold
+    // them), so it's used for those cases.
+    auto batchable { data.size() > 1 };
+    const auto schema { tableSchema(table) };
+    const auto& tableFields { schema->columns };
+    std::vector<std::string> entriesHash;
+    entriesHash.reserve(data.size());
+
+    if (batchable)
+    {
+        std::set<std::string> uniqueHashes;
+
+        for (const auto& entry : data)
+        {
+            entriesHash.push_back(buildPrimaryKeyHash(*schema, entry));
+
+            if (!uniqueHashes.insert(entriesHash.back()).second)
+            {
+                batchable = false;
+                break;
+            }
+        }
+    }
+
+    const auto tempTable { table + TEMP_TABLE_SUBFIX };
+
+    // A staging table left by a previous snapshot could predate the status field, in that case the
+    // batch can't be moved with a plain INSERT ... SELECT.
+    if (!batchable || !createCopyTempTable(table) || loadTableData(tempTable) != tableFields.size())
+    {
+        syncTableRowsDataByRow(jsInput, callback, lock);
+        return;
+    }
+
+    auto returnOldData { false };
+    nlohmann::json ignoredColumns { };
+    getSyncOptions(jsInput, returnOldData, ignoredColumns);
+
+    // Stage the whole batch and resolve which rows already exist with a single join.
+    bulkInsertData(tempTable, data, false);
+
+    std::vector<Row> storedRows;
+    getMatchingRows(table, tempTable, primaryKeyList, storedRows);
+
+    std::map<std::string, Row> storedRowsByHash;
+
+    for (auto& row : storedRows)
+    {
+        auto hash { buildPrimaryKeyHash(primaryKeyList, row) };
+        storedRowsByHash.emplace(std::move(hash), std::move(row));
+    }
+
+    // New rows are moved from the staging table in one statement.
+    if (storedRowsByHash.size() < data.size())
+    {
+        const auto newRows { static_cast<long long>(data.size() - storedRowsByHash.size()) };
+
+        // A batch that doesn't fit in the max rows is synced row by row, reporting the rows over the limit.
+        if (newRows > static_cast<long long>(remainingRows(table)))
+        {
+            deleteTempTable(table);
+            syncTableRowsDataByRow(jsInput, callback, lock);
+            return;
+        }
+
+        updateTableRowCounter(table, newRows);
+        const auto stmtInsert { getStatement(buildInsertLeftOnlyQuery(table, primaryKeyList)) };
+
+        // LCOV_EXCL_START
+        if (SQLITE_ERROR == stmtInsert->step())
+        {
+            updateTableRowCounter(table, newRows * -1ll);
+            deleteTempTable(table);
+            throw dbengine_error{ BIND_FIELDS_DOES_NOT_MATCH };
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    // Mark every existing row of the batch as seen in the transaction.
+    if (!storedRowsByHash.empty() && nullptr != schema->column(STATUS_FIELD_NAME))
+    {
+        const auto stmtStatus { getStatement(buildUpdateStatusMatchingQuery(table, primaryKeyList)) };
+        stmtStatus->bind(1, statusGeneration(table));
+
+        // LCOV_EXCL_START
+        if (SQLITE_ERROR == stmtStatus->step())
+        {
+            deleteTempTable(table);
+            throw dbengine_error{ STEP_ERROR_UPDATE_STATUS_FIELD };
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    deleteTempTable(table);
+
+    auto itHash { entriesHash.begin() };
+
+    for (const auto& entry : data)
+    {
+        const auto itStored { storedRowsByHash.find(*itHash) };
+        ++itHash;
+
+        if (storedRowsByHash.end() != itStored)
+        {
+            nlohmann::json updated;
+            nlohmann::json oldData;
+            const auto& storedRow { itStored->second };
+            buildRowDiff(primaryKeyList, ignoredColumns, tableFields,
+                         [&storedRow](const ColumnData & field) -> const TableField&
+            {
+                return storedRow.at(std::get<TableHeader::Name>(field));
+            },
+            entry, updated, oldData);
+
+            // Unchanged rows were already handled by the status update above.
+            if (!updated.empty())
+            {
+                updateRowAndNotify(table, primaryKeyList, entry, updated, oldData, returnOldData, true, callback, lock);
+            }
+        }
+        else if (callback)
+        {
+            lock.unlock();
+            callback(INSERTED, entry);
+            lock.lock();
+        }
+    }
+}
+
 void SQLiteDBEngine::initializeStatusField(const nlohmann::json& tableNames)
 {
     for (const auto& tableValue : tableNames)
@@ -286,17 +937,9 @@ void SQLiteDBEngine::initializeStatusField(const nlohmann::json& tableNames)
 
         if (0 != loadTableData(table))
         {
-            const auto& fields { m_tableFields[table] };
-            const auto& it { std::find_if(fields.begin(),
-                                          fields.end(),
-                                          [](const ColumnData & column)
-            {
-                return 0 == std::get<Name>(column).compare(STATUS_FIELD_NAME);
-            })};
-
-            if (fields.end() == it)
+            if (nullptr == tableSchema(table)->column(STATUS_FIELD_NAME))
             {
-                m_tableFields.erase(table);
+                m_tableSchemas.erase(table);
                 const auto stmtAdd { getStatement("ALTER TABLE " +
                                                   table +
                                                   " ADD COLUMN " +
@@ -314,11 +957,55 @@ void SQLiteDBEngine::initializeStatusField(const nlohmann::json& tableNames)
                 // LCOV_EXCL_STOP
             }
 
+            auto generation { statusGeneration(table) };
+
+            if (STATUS_FIELD_INSERTED == generation)
+            {
+                // First transaction of the table, the generations go on from the ones already stored.
+                const auto stmtIndex { getStatement("CREATE INDEX IF NOT EXISTS " +
+                                                    table +
+                                                    "_" +
+                                                    STATUS_FIELD_NAME +
+                                                    "_idx ON " +
+                                                    table +
+                                                    "(" +
+                                                    STATUS_FIELD_NAME +
+                                                    ");")};
+
+                // LCOV_EXCL_START
+                if (SQLITE_ERROR == stmtIndex->step())
+                {
+                    throw dbengine_error{ STEP_ERROR_ADD_STATUS_FIELD };
+                }
+
+                // LCOV_EXCL_STOP
+
+                const auto stmtMax { getStatement("SELECT MAX(" +
+                                                  std::string(STATUS_FIELD_NAME) +
+                                                  ") FROM " +
+                                                  table +
+                                                  ";")};
+
+                if (SQLITE_ROW == stmtMax->step())
+                {
+                    generation = std::max(generation, stmtMax->column(0)->value(int64_t{}));
+                }
+
+                ++generation;
+            }
+
+            // The rows inserted by the previous transaction join its generation, the ones not seen from now on
+            // are older than the new one. Only they are written, through the status index.
             const auto& stmtInit { getStatement("UPDATE " +
                                                 table +
                                                 " SET " +
                                                 STATUS_FIELD_NAME +
-                                                "=0;")};
+                                                "=? WHERE " +
+                                                STATUS_FIELD_NAME +
+                                                "=" +
+                                                std::to_string(STATUS_FIELD_INSERTED) +
+                                                ";")};
+            stmtInit->bind(1, generation);
 
             // LCOV_EXCL_START
             if (SQLITE_ERROR == stmtInit->step())
@@ -327,6 +1014,8 @@ void SQLiteDBEngine::initializeStatusField(const nlohmann::json& tableNames)
             }
 
             // LCOV_EXCL_STOP
+
+            m_statusGenerations[table] = generation + 1;
         }
         else
         {
@@ -343,11 +1032,17 @@ void SQLiteDBEngine::deleteRowsByStatusField(const nlohmann::json& tableNames)
 
         if (0 != loadTableData(table))
         {
+            // Neither inserted nor seen in the current generation.
             const auto stmt { getStatement("DELETE FROM " +
                                            table +
                                            " WHERE " +
                                            STATUS_FIELD_NAME +
-                                           "=0;")};
+                                           "<? AND " +
+                                           STATUS_FIELD_NAME +
+                                           "<>" +
+                                           std::to_string(STATUS_FIELD_INSERTED) +
+                                           ";")};
+            stmt->bind(1, statusGeneration(table));
 
             // LCOV_EXCL_START
             if (SQLITE_ERROR == stmt->step())
@@ -364,6 +1059,8 @@ void SQLiteDBEngine::deleteRowsByStatusField(const nlohmann::json& tableNames)
             throw dbengine_error { EMPTY_TABLE_METADATA };
         }
     }
+
+    publishChanges();
 }
 
 void SQLiteDBEngine::returnRowsMarkedForDelete(const nlohmann::json& tableNames,
@@ -379,8 +1076,10 @@ void SQLiteDBEngine::returnRowsMarkedForDelete(const nlohmann::json& tableNames,
 
         if (0 != loadTableData(table))
         {
-            auto tableFields { m_tableFields[table] };
+            const auto schema { tableSchema(table) };
+            const auto& tableFields { schema->columns };
             const auto stmt { getStatement(getSelectAllQuery(table, tableFields)) };
+            stmt->bind(1, statusGeneration(table));
 
             while (SQLITE_ROW == stmt->step())
             {
@@ -420,124 +1119,575 @@ void SQLiteDBEngine::returnRowsMarkedForDelete(const nlohmann::json& tableNames,
     }
 }
 
+static nlohmann::json getSelectedRow(SQLite::IStatement& stmt)
+{
+    nlohmann::json object;
+
+    for (int i = 0; i < stmt.columnsCount(); ++i)
+    {
+        const auto& column{ stmt.column(i) };
+        const auto& name{ column->name() };
+
+        if (column->hasValue() && name != STATUS_FIELD_NAME)
+        {
+            switch (column->type())
+            {
+                case SQLITE_TEXT:
+                    object[name] = column->value(std::string{});
+                    break;
+
+                case SQLITE_INTEGER:
+                    object[name] = column->value(int64_t{});
+                    break;
+
+                case SQLITE_FLOAT:
+                    object[name] = column->value(double_t{});
+                    break;
+
+                // LCOV_EXCL_START
+                default:
+                    throw dbengine_error{INVALID_COLUMN_TYPE};
+                    // LCOV_EXCL_STOP
+            }
+        }
+    }
+
+    return object;
+}
+
 void SQLiteDBEngine::selectData(const std::string& table,
                                 const nlohmann::json& query,
                                 const DbSync::ResultCallback& callback,
                                 std::unique_lock<std::shared_timed_mutex>& lock)
 {
-    if (0 != loadTableData(table))
+    // Read only connections run on their own WAL snapshot, the caller doesn't hold the sync lock.
+    if (m_concurrentReads)
+    {
+        auto connection { acquireReadConnection() };
+
+        if (0 == tableSchema(table)->columns.size())
+        {
+            loadFieldData(table, connection);
+        }
+
+        if (0 != tableSchema(table)->columns.size())
+        {
+            const auto& stmt { m_sqliteFactory->createStatement(connection, buildSelectQuery(table, query)) };
+
+            while (SQLITE_ROW == stmt->step())
+            {
+                const auto object = getSelectedRow(*stmt);
+
+                if (callback && !object.empty())
+                {
+                    callback(SELECTED, object);
+                }
+            }
+        }
+        else
+        {
+            throw dbengine_error { EMPTY_TABLE_METADATA };
+        }
+    }
+    else if (0 != loadTableData(table))
     {
         const auto& stmt { m_sqliteFactory->createStatement(m_sqliteConnection, buildSelectQuery(table, query)) };
 
         while (SQLITE_ROW == stmt->step())
         {
-            nlohmann::json object;
+            const auto object = getSelectedRow(*stmt);
 
-            for (int i = 0; i < stmt->columnsCount(); ++i)
+            if (callback && !object.empty())
             {
-                const auto& column{ stmt->column(i) };
-                const auto& name{ column->name() };
+                lock.unlock();
+                callback(SELECTED, object);
+                lock.lock();
+            }
+        }
+        // Ends the read transaction, so the next query sees the latest data of the attached shards.
+        publishChanges();
+    }
+    else
+    {
+        throw dbengine_error { EMPTY_TABLE_METADATA };
+    }
+}
 
-                if (column->hasValue() && name != STATUS_FIELD_NAME)
-                {
-                    switch (column->type())
-                    {
-                        case SQLITE_TEXT:
-                            object[name] = column->value(std::string{});
-                            break;
+// Columns of the running statement, created once per query and read on each row.
+class SQLiteRowView final : public DbSync::IRowView
+{
+    public:
+        explicit SQLiteRowView(SQLite::IStatement& stmt)
+        {
+            for (int i = 0; i < stmt.columnsCount(); ++i)
+            {
+                m_columns.push_back(stmt.column(i));
+                m_names.push_back(m_columns.back()->name());
+            }
+        }
 
-                        case SQLITE_INTEGER:
-                            object[name] = column->value(int64_t{});
-                            break;
+        int columnIndex(const std::string& name) const override
+        {
+            const auto it { std::find(m_names.begin(), m_names.end(), name) };
+            return m_names.end() != it ? static_cast<int>(it - m_names.begin()) : -1;
+        }
 
-                        case SQLITE_FLOAT:
-                            object[name] = column->value(double_t{});
-                            break;
+        bool isNull(const int index) const override
+        {
+            return !column(index).hasValue();
+        }
 
-                        // LCOV_EXCL_START
-                        default:
-                            throw dbengine_error{INVALID_COLUMN_TYPE};
-                            // LCOV_EXCL_STOP
-                    }
+        int64_t getInt64(const int index) const override
+        {
+            return column(index).value(int64_t{});
+        }
+
+        double getDouble(const int index) const override
+        {
+            return column(index).value(double_t{});
+        }
+
+        std::string getString(const int index) const override
+        {
+            return column(index).value(std::string{});
+        }
+
+    private:
+        const SQLite::IColumn& column(const int index) const
+        {
+            if (index < 0 || static_cast<size_t>(index) >= m_columns.size())
+            {
+                throw dbengine_error { INVALID_COLUMN_INDEX };
+            }
+
+            return *m_columns[index];
+        }
+
+        std::vector<std::unique_ptr<SQLite::IColumn>> m_columns;
+        std::vector<std::string> m_names;
+};
+
+void SQLiteDBEngine::selectRows(const std::string& table,
+                                const nlohmann::json& query,
+                                const DbSync::RowCallback& callback,
+                                std::unique_lock<std::shared_timed_mutex>& lock)
+{
+    if (m_concurrentReads)
+    {
+        auto connection { acquireReadConnection() };
+
+        if (0 == tableSchema(table)->columns.size())
+        {
+            loadFieldData(table, connection);
+        }
+
+        if (0 != tableSchema(table)->columns.size())
+        {
+            const auto& stmt { m_sqliteFactory->createStatement(connection, buildSelectQuery(table, query)) };
+            const SQLiteRowView row { *stmt };
+
+            while (SQLITE_ROW == stmt->step())
+            {
+                if (callback)
+                {
+                    callback(row);
                 }
             }
+        }
+        else
+        {
+            throw dbengine_error { EMPTY_TABLE_METADATA };
+        }
+    }
+    else if (0 != loadTableData(table))
+    {
+        const auto& stmt { m_sqliteFactory->createStatement(m_sqliteConnection, buildSelectQuery(table, query)) };
+        const SQLiteRowView row { *stmt };
 
-            if (callback && !object.empty())
+        while (SQLITE_ROW == stmt->step())
+        {
+            if (callback)
             {
                 lock.unlock();
-                callback(SELECTED, object);
+                callback(row);
                 lock.lock();
             }
         }
+        publishChanges();
+    }
+    else
+    {
+        throw dbengine_error { EMPTY_TABLE_METADATA };
+    }
+}
+
+void SQLiteDBEngine::deleteTableRowsData(const std::string&    table,
+                                         const nlohmann::json& jsDeletionData)
+{
+    if (0 != loadTableData(table))
+    {
+        const auto& itData{ jsDeletionData.find("data")};
+        const auto& itFilter{ jsDeletionData.find("where_filter_opt")};
+
+        if (itData != jsDeletionData.end() && itData->size() > 0)
+        {
+            // Deletion via primary keys on "data" json field.
+            deleteRowsbyPK(table, itData.value());
+        }
+        else if (itFilter != jsDeletionData.end() && !itFilter->get<std::string>().empty())
+        {
+            // Deletion via condition on "where_filter_opt" json field.
+            m_sqliteConnection->execute("DELETE FROM " + table + " WHERE " + itFilter->get<std::string>());
+            updateTableRowCounter(table, m_sqliteConnection->changes() * -1ll);
+        }
+        else
+        {
+            throw dbengine_error{ INVALID_DELETE_INFO };
+        }
+
+        publishChanges();
+    }
+    else
+    {
+        throw dbengine_error { EMPTY_TABLE_METADATA };
+    }
+}
+
+void SQLiteDBEngine::addTableRelationship(const nlohmann::json& data)
+{
+    const auto baseTable { data.at("base_table").get<std::string>() };
+
+    if (0 != loadTableData(baseTable))
+    {
+        std::vector<std::string> primaryKeys;
+
+        if (getPrimaryKeysFromTable(baseTable, primaryKeys))
+        {
+            m_sqliteConnection->execute(buildDeleteRelationTrigger(data, baseTable));
+            m_sqliteConnection->execute(buildUpdateRelationTrigger(data, baseTable, primaryKeys));
+            publishChanges();
+        }
     }
     else
     {
-        throw dbengine_error { EMPTY_TABLE_METADATA };
+        throw dbengine_error { EMPTY_TABLE_METADATA };
+    }
+}
+
+///
+/// Private functions section
+///
+
+bool SQLiteDBEngine::concurrentReads()
+{
+    return m_concurrentReads;
+}
+
+nlohmann::json SQLiteDBEngine::tuningInfo()
+{
+    nlohmann::json info;
+
+    for (const auto& pragma : TuningPragmaNames)
+    {
+        const auto stmt { m_sqliteFactory->createStatement(m_sqliteConnection, "PRAGMA " + pragma + ";") };
+
+        if (SQLITE_ROW == stmt->step())
+        {
+            if (0 == pragma.compare("journal_mode"))
+            {
+                info[pragma] = stmt->column(0)->value(std::string{});
+            }
+            else
+            {
+                info[pragma] = stmt->column(0)->value(int64_t{});
+            }
+        }
+    }
+
+    return info;
+}
+
+std::map<std::string, std::vector<std::string>> SQLiteDBEngine::schemaDefinition(const std::string& schema)
+{
+    std::map<std::string, std::vector<std::string>> definition;
+    const auto tables
+    {
+        m_sqliteFactory->createStatement(m_sqliteConnection, "SELECT name FROM " + schema + ".sqlite_master WHERE type='table';")
+    };
+
+    while (SQLITE_ROW == tables->step())
+    {
+        definition[tables->column(0)->value(std::string{})];
+    }
+
+    for (auto& table : definition)
+    {
+        const auto columns
+        {
+            m_sqliteFactory->createStatement(m_sqliteConnection, "PRAGMA " + schema + ".table_info(" + table.first + ");")
+        };
+
+        while (SQLITE_ROW == columns->step())
+        {
+            const auto name { columns->column(1)->value(std::string{}) };
+
+            // The internal columns are added by the transactions, whenever they are started.
+            if (InternalColumnNames.end() == std::find(InternalColumnNames.begin(), InternalColumnNames.end(), name))
+            {
+                table.second.push_back(name + " " + columns->column(2)->value(std::string{}) + " " +
+                                       std::to_string(columns->column(5)->value(int32_t{})));
+            }
+        }
+    }
+
+    return definition;
+}
+
+void SQLiteDBEngine::backup(const std::string& path)
+{
+    const auto tmpPath { path + ".tmp" };
+
+    m_transaction->commit();
+
+    try
+    {
+        std::remove(tmpPath.c_str());
+        m_sqliteConnection->backup(tmpPath);
+    }
+    catch (...)
+    {
+        m_transaction = m_sqliteFactory->createTransaction(m_sqliteConnection);
+        throw;
+    }
+
+    m_transaction = m_sqliteFactory->createTransaction(m_sqliteConnection);
+
+    // The snapshot is replaced once it is complete, an interrupted backup never leaves a partial one.
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+
+    if (0 != std::rename(tmpPath.c_str(), path.c_str()))
+    {
+        std::remove(tmpPath.c_str());
+        throw dbengine_error { INVALID_SNAPSHOT };
+    }
+}
+
+static std::string quoteLiteral(const std::string& value)
+{
+    std::string quoted;
+
+    for (const auto character : value)
+    {
+        quoted += '\'' == character ? "''" : std::string(1, character);
+    }
+
+    return quoted;
+}
+
+void SQLiteDBEngine::restore(const std::string& path)
+{
+    if (!std::ifstream(path))
+    {
+        throw dbengine_error { INVALID_SNAPSHOT };
+    }
+
+    {
+        // The cached statements would keep the database in use while it is replaced.
+        std::lock_guard<std::mutex> lock(m_stmtMutex);
+        m_statementsCacheIndex.clear();
+        m_statementsCache.clear();
+    }
+
+    const auto quotedPath { quoteLiteral(path) };
+
+    m_transaction->commit();
+
+    try
+    {
+        m_sqliteConnection->execute("ATTACH DATABASE '" + quotedPath + "' AS snapshot;");
+        const auto definition { schemaDefinition("main") };
+        const auto sameSchema { definition == schemaDefinition("snapshot") };
+        m_sqliteConnection->execute("DETACH DATABASE snapshot;");
+
+        // A snapshot taken by another version may not have the tables of this one.
+        if (!sameSchema)
+        {
+            throw dbengine_error { INVALID_SNAPSHOT };
+        }
+
+        m_sqliteConnection->restore(path);
+
+        for (const auto& table : definition)
+        {
+            m_tableSchemas.erase(table.first);
+        }
+    }
+    catch (...)
+    {
+        m_transaction = m_sqliteFactory->createTransaction(m_sqliteConnection);
+        throw;
+    }
+
+    m_transaction = m_sqliteFactory->createTransaction(m_sqliteConnection);
+
+    for (auto& maxRows : m_maxRows)
+    {
+        const auto stmt { getStatement("SELECT COUNT(*) FROM " + maxRows.first + ";") };
+
+        if (SQLITE_ROW != stmt->step())
+        {
+            throw dbengine_error { SQL_STMT_ERROR };
+        }
+
+        maxRows.second = std::make_unique<MaxRows>(maxRows.second->maxRows, stmt->column(0)->value(int64_t{}));
+    }
+}
+
+void SQLiteDBEngine::attach(const std::string& path,
+                            const std::string& alias)
+{
+    const auto statement { "ATTACH DATABASE '" + quoteLiteral(path) + "' AS " + alias + ";" };
+
+    // A database cannot be attached in the middle of a transaction.
+    m_transaction->commit();
+
+    try
+    {
+        m_sqliteConnection->execute(statement);
+    }
+    catch (...)
+    {
+        m_transaction = m_sqliteFactory->createTransaction(m_sqliteConnection);
+        throw;
+    }
+
+    m_transaction = m_sqliteFactory->createTransaction(m_sqliteConnection);
+    m_attached = true;
+
+    std::lock_guard<std::mutex> lock { m_readConnectionsMutex };
+
+    for (const auto& connection : m_readConnections)
+    {
+        connection->execute(statement);
+    }
+}
+
+static int64_t getReadConnections(const nlohmann::json& tuningConfig)
+{
+    int64_t readConnections { 0 };
+    const auto it { tuningConfig.find("read_connections") };
+
+    if (tuningConfig.end() != it)
+    {
+        if (!it->is_number_integer() || it->get<int64_t>() < 0 || it->get<int64_t>() > MAX_READ_CONNECTIONS)
+        {
+            throw dbengine_error { INVALID_TUNING_CONFIG };
+        }
+
+        readConnections = it->get<int64_t>();
     }
+
+    return readConnections;
 }
 
-void SQLiteDBEngine::deleteTableRowsData(const std::string&    table,
-                                         const nlohmann::json& jsDeletionData)
+static std::vector<std::pair<std::string, std::string>> getTuningPragmas(const nlohmann::json& tuningConfig)
 {
-    if (0 != loadTableData(table))
+    std::vector<std::pair<std::string, std::string>> pragmas;
+    const auto itProfile { tuningConfig.find("profile") };
+    const auto& profileName
     {
-        const auto& itData{ jsDeletionData.find("data")};
-        const auto& itFilter{ jsDeletionData.find("where_filter_opt")};
+        tuningConfig.end() != itProfile && itProfile->is_string() ? itProfile->get_ref<const std::string&>() : "default"
+    };
+    const auto itProfileValues { TuningProfiles.find(profileName) };
 
-        if (itData != jsDeletionData.end() && itData->size() > 0)
+    if (TuningProfiles.end() == itProfileValues || (tuningConfig.end() != itProfile && !itProfile->is_string()))
+    {
+        throw dbengine_error { INVALID_TUNING_CONFIG };
+    }
+
+    auto values { itProfileValues->second };
+
+    for (const auto& item : tuningConfig.items())
+    {
+        if (0 == item.key().compare("profile") || 0 == item.key().compare("read_connections"))
         {
-            // Deletion via primary keys on "data" json field.
-            deleteRowsbyPK(table, itData.value());
+            continue;
         }
-        else if (itFilter != jsDeletionData.end() && !itFilter->get<std::string>().empty())
+
+        if (TuningPragmaNames.end() == std::find(TuningPragmaNames.begin(), TuningPragmaNames.end(), item.key()))
         {
-            // Deletion via condition on "where_filter_opt" json field.
-            m_sqliteConnection->execute("DELETE FROM " + table + " WHERE " + itFilter->get<std::string>());
-            updateTableRowCounter(table, m_sqliteConnection->changes() * -1ll);
+            throw dbengine_error { INVALID_TUNING_CONFIG };
+        }
+
+        const auto itKeywords { TuningPragmaKeywords.find(item.key()) };
+        std::string value;
+
+        if (item.value().is_number_integer())
+        {
+            value = std::to_string(item.value().get<int64_t>());
+        }
+        else if (item.value().is_string() && TuningPragmaKeywords.end() != itKeywords)
+        {
+            value = item.value().get<std::string>();
         }
         else
         {
-            throw dbengine_error{ INVALID_DELETE_INFO };
+            throw dbengine_error { INVALID_TUNING_CONFIG };
+        }
+
+        // Only known keywords are accepted, the values are used to build the pragma statements.
+        if (TuningPragmaKeywords.end() != itKeywords && item.value().is_string() &&
+                itKeywords->second.end() == itKeywords->second.find(Utils::toUpperCase(value)))
+        {
+            throw dbengine_error { INVALID_TUNING_CONFIG };
         }
+
+        values[item.key()] = value;
     }
-    else
+
+    // Readers only get their own snapshot while the writer transaction is open in WAL mode.
+    if (0 != getReadConnections(tuningConfig))
     {
-        throw dbengine_error { EMPTY_TABLE_METADATA };
-    }
-}
+        if (tuningConfig.contains("journal_mode") && 0 != Utils::toUpperCase(values["journal_mode"]).compare("WAL"))
+        {
+            throw dbengine_error { INVALID_TUNING_CONFIG };
+        }
 
-void SQLiteDBEngine::addTableRelationship(const nlohmann::json& data)
-{
-    const auto baseTable { data.at("base_table").get<std::string>() };
+        values["journal_mode"] = "WAL";
+    }
 
-    if (0 != loadTableData(baseTable))
+    for (const auto& pragma : TuningPragmaNames)
     {
-        std::vector<std::string> primaryKeys;
+        const auto it { values.find(pragma) };
 
-        if (getPrimaryKeysFromTable(baseTable, primaryKeys))
+        if (values.end() != it)
         {
-            m_sqliteConnection->execute(buildDeleteRelationTrigger(data, baseTable));
-            m_sqliteConnection->execute(buildUpdateRelationTrigger(data, baseTable, primaryKeys));
+            pragmas.emplace_back(pragma, it->second);
         }
     }
-    else
-    {
-        throw dbengine_error { EMPTY_TABLE_METADATA };
-    }
-}
 
-///
-/// Private functions section
-///
+    return pragmas;
+}
 
 void SQLiteDBEngine::initialize(const std::string& path,
-                                const std::string& tableStmtCreation)
+                                const std::string& tableStmtCreation,
+                                const nlohmann::json& tuningConfig)
 {
+    const auto tuningPragmas { getTuningPragmas(tuningConfig) };
+    const auto readConnections { getReadConnections(tuningConfig) };
+
     if (path.empty())
     {
         throw dbengine_error { EMPTY_DATABASE_PATH };
     }
 
+    if (0 != readConnections && 0 == path.compare(":memory:"))
+    {
+        throw dbengine_error { INVALID_TUNING_CONFIG };
+    }
+
     if (!cleanDB(path))
     {
         throw dbengine_error { DELETE_OLD_DB_ERROR };
@@ -545,9 +1695,11 @@ void SQLiteDBEngine::initialize(const std::string& path,
 
     m_sqliteConnection = m_sqliteFactory->createConnection(path);
     const auto createDBQueryList { Utils::split(tableStmtCreation, ';') };
-    m_sqliteConnection->execute("PRAGMA temp_store = memory;");
-    m_sqliteConnection->execute("PRAGMA journal_mode = truncate;");
-    m_sqliteConnection->execute("PRAGMA synchronous = OFF;");
+
+    for (const auto& pragma : tuningPragmas)
+    {
+        m_sqliteConnection->execute("PRAGMA " + pragma.first + " = " + pragma.second + ";");
+    }
 
     for (const auto& query : createDBQueryList)
     {
@@ -559,9 +1711,62 @@ void SQLiteDBEngine::initialize(const std::string& path,
         }
     }
 
+    // The tables are created before the read only connections are opened, so they see the whole schema.
+    for (auto i { 0ll }; i < readConnections; ++i)
+    {
+        const auto connection { m_sqliteFactory->createConnection(path) };
+
+        for (const auto& pragma : tuningPragmas)
+        {
+            if (0 != pragma.first.compare("journal_mode") && 0 != pragma.first.compare("page_size"))
+            {
+                connection->execute("PRAGMA " + pragma.first + " = " + pragma.second + ";");
+            }
+        }
+
+        connection->execute("PRAGMA query_only = ON;");
+        m_readConnections.push_back(connection);
+    }
+
+    m_concurrentReads = !m_readConnections.empty();
     m_transaction = m_sqliteFactory->createTransaction(m_sqliteConnection);
 }
 
+std::shared_ptr<SQLite::IConnection> SQLiteDBEngine::acquireReadConnection()
+{
+    std::unique_lock<std::mutex> lock { m_readConnectionsMutex };
+    m_readConnectionsCondition.wait(lock, [this]()
+    {
+        return !m_readConnections.empty();
+    });
+
+    const auto connection { m_readConnections.back() };
+    m_readConnections.pop_back();
+
+    // The returned pointer hands the connection back to the pool once the caller is done with it.
+    return std::shared_ptr<SQLite::IConnection>
+    {
+        connection.get(), [this, connection](SQLite::IConnection*)
+        {
+            {
+                std::lock_guard<std::mutex> poolLock { m_readConnectionsMutex };
+                m_readConnections.push_back(connection);
+            }
+            m_readConnectionsCondition.notify_one();
+        }
+    };
+}
+
+void SQLiteDBEngine::publishChanges()
+{
+    // With read only connections or attached shards, data is only visible to the readers once it is committed.
+    if (m_concurrentReads || m_attached)
+    {
+        m_transaction->commit();
+        m_transaction = m_sqliteFactory->createTransaction(m_sqliteConnection);
+    }
+}
+
 bool SQLiteDBEngine::cleanDB(const std::string& path)
 {
     auto ret { true };
@@ -625,18 +1830,18 @@ void SQLiteDBEngine::insertElement(const std::string& table,
 size_t SQLiteDBEngine::loadTableData(const std::string& table)
 {
     size_t fieldsNumber { 0ull };
-    const auto& tableFields{ m_tableFields[table] };
+    const auto schema { m_tableSchemas[table] };
 
-    if (0 == tableFields.size())
+    if (!schema || schema->columns.empty())
     {
         if (loadFieldData(table))
         {
-            fieldsNumber = m_tableFields[table].size();
+            fieldsNumber = tableSchema(table)->columns.size();
         }
     }
     else
     {
-        fieldsNumber = tableFields.size();
+        fieldsNumber = schema->columns.size();
     }
 
     return fieldsNumber;
@@ -652,7 +1857,8 @@ std::string SQLiteDBEngine::buildInsertDataSqlQuery(const std::string& table,
     std::string sql   {"INSERT INTO " + table + " ("};
     std::string binds {") VALUES ("};
 
-    const auto tableFields{ m_tableFields[table] };
+    const auto schema { tableSchema(table) };
+    const auto& tableFields { schema->columns };
 
     if (!tableFields.empty())
     {
@@ -686,33 +1892,118 @@ std::string SQLiteDBEngine::buildInsertDataSqlQuery(const std::string& table,
     return sql;
 }
 
+std::string SQLiteDBEngine::buildBulkInsertDataSqlQuery(const std::string& table,
+                                                        const std::vector<const ColumnData*>& columns,
+                                                        const size_t rowsCount,
+                                                        const std::vector<std::string>& upsertPrimaryKeys)
+{
+    //
+    // The INSERT statement will be as the following:
+    //  INSERT INTO table (column1, column2, ...) VALUES (?, ?, ...),(?, ?, ...)
+    //  [ON CONFLICT(pk1, ...) DO UPDATE SET column1=excluded.column1, ...];
+    //
+    std::string sql {"INSERT INTO " + table + " ("};
+    std::string binds {"("};
+    std::string updates;
+
+    for (const auto& column : columns)
+    {
+        const auto& fieldName { std::get<TableHeader::Name>(*column) };
+        sql.append(fieldName + ",");
+        binds.append("?,");
+
+        if (!std::get<TableHeader::PK>(*column))
+        {
+            updates.append(fieldName + "=excluded." + fieldName + ",");
+        }
+    }
+
+    sql = sql.substr(0, sql.size() - 1);
+    binds = binds.substr(0, binds.size() - 1);
+    binds.append("),");
+    sql.append(") VALUES ");
+
+    for (size_t i = 0; i < rowsCount; ++i)
+    {
+        sql.append(binds);
+    }
+
+    sql = sql.substr(0, sql.size() - 1);
+
+    if (!upsertPrimaryKeys.empty())
+    {
+        sql.append(" ON CONFLICT(");
+
+        for (const auto& pk : upsertPrimaryKeys)
+        {
+            sql.append(pk + ",");
+        }
+
+        sql = sql.substr(0, sql.size() - 1);
+        sql.append(updates.empty() ? ") DO NOTHING" : ") DO UPDATE SET " + updates.substr(0, updates.size() - 1));
+    }
+
+    sql.append(";");
+
+    return sql;
+}
+
 bool SQLiteDBEngine::loadFieldData(const std::string& table)
+{
+    return loadFieldData(table, m_sqliteConnection);
+}
+
+bool SQLiteDBEngine::loadFieldData(const std::string& table,
+                                   std::shared_ptr<SQLite::IConnection>& connection)
 {
     const auto ret { !table.empty() };
     const std::string sql {"PRAGMA table_info(" + table + ");"};
 
     if (ret)
     {
-        TableColumns fieldList;
-        auto stmt { m_sqliteFactory->createStatement(m_sqliteConnection, sql) };
+        auto schema { std::make_shared<TableSchema>() };
+        auto stmt { m_sqliteFactory->createStatement(connection, sql) };
 
         while (SQLITE_ROW == stmt->step())
         {
             const auto& fieldName { stmt->column(1)->value(std::string{}) };
-            fieldList.push_back(std::make_tuple(stmt->column(0)->value(int32_t{}),
-                                                fieldName,
-                                                columnTypeName(stmt->column(2)->value(std::string{})),
-                                                0 != stmt->column(5)->value(int32_t{}),
-                                                InternalColumnNames.end() != std::find(InternalColumnNames.begin(),
-                                                                                       InternalColumnNames.end(), fieldName)));
+            const auto isPrimaryKey { 0 != stmt->column(5)->value(int32_t{}) };
+
+            if (isPrimaryKey)
+            {
+                schema->primaryKeys.push_back(fieldName);
+                schema->primaryKeyIndexes.push_back(schema->columns.size());
+            }
+
+            schema->columnIndexes.emplace(fieldName, schema->columns.size());
+            schema->columns.push_back(std::make_tuple(stmt->column(0)->value(int32_t{}),
+                                                      fieldName,
+                                                      columnTypeName(stmt->column(2)->value(std::string{})),
+                                                      isPrimaryKey,
+                                                      InternalColumnNames.end() != std::find(InternalColumnNames.begin(),
+                                                              InternalColumnNames.end(), fieldName)));
+        }
+
+        if (!schema->primaryKeys.empty())
+        {
+            schema->selectMatchingPKsQuery = buildSelectMatchingPKsSqlQuery(table, schema->primaryKeys);
+            schema->deleteMatchingPKsQuery = buildDeleteBulkDataSqlQuery(table, schema->primaryKeys);
+            schema->selectOrderedByPKsQuery = buildSelectOrderedByPKsSqlQuery(table, schema->primaryKeys);
         }
 
-        m_tableFields.insert(table, fieldList);
+        m_tableSchemas.insert(table, schema);
     }
 
     return ret;
 }
 
+TableSchemaPtr SQLiteDBEngine::tableSchema(const std::string& table)
+{
+    static const TableSchemaPtr EMPTY_SCHEMA { std::make_shared<TableSchema>() };
+    const auto schema { m_tableSchemas[table] };
+    return schema ? schema : EMPTY_SCHEMA;
+}
+
 ColumnType SQLiteDBEngine::columnTypeName(const std::string& type)
 {
     ColumnType retVal { Unknown };
@@ -765,78 +2056,330 @@ bool SQLiteDBEngine::bindJsonData(const std::shared_ptr<SQLite::IStatement> stmt
         }
         else if (ColumnType::Integer == type)
         {
-            int32_t value
+            int32_t value
+            {
+                jsData.is_number() ? jsData.get<int32_t>() : jsData.is_string()
+                && jsData.get_ref<const std::string&>().size()
+                ? std::stoi(jsData.get_ref<const std::string&>())
+                : 0
+            };
+            stmt->bind(cid, value);
+        }
+        else if (ColumnType::Text == type)
+        {
+            std::string value
+            {
+                jsData.is_string() ? jsData.get_ref<const std::string&>() : ""
+            };
+            stmt->bind(cid, value);
+        }
+        else if (ColumnType::Double == type)
+        {
+            double_t value
+            {
+                jsData.is_number() ? jsData.get<double>() : jsData.is_string()
+                && jsData.get_ref<const std::string&>().size()
+                ? std::stod(jsData.get_ref<const std::string&>())
+                : .0f
+            };
+            stmt->bind(cid, value);
+        }
+        else
+        {
+            throw dbengine_error { INVALID_COLUMN_TYPE };
+        }
+    }
+    else
+    {
+        retVal = false;
+    }
+
+    return retVal;
+}
+
+bool SQLiteDBEngine::createCopyTempTable(const std::string& table)
+{
+    auto ret { false };
+    std::string queryResult;
+    deleteTempTable(table);
+
+    if (getTableCreateQuery(table, queryResult))
+    {
+        if (Utils::replaceAll(queryResult, "CREATE TABLE " + table, "CREATE TEMP TABLE IF NOT EXISTS " + table + "_TEMP"))
+        {
+            const auto stmt { getStatement(queryResult) };
+            ret = SQLITE_DONE == stmt->step();
+        }
+    }
+
+    return ret;
+}
+
+void SQLiteDBEngine::deleteTempTable(const std::string& table)
+{
+    try
+    {
+        m_sqliteConnection->execute("DELETE FROM " + table + TEMP_TABLE_SUBFIX + ";");
+    }
+    //if the table doesn't exist we don't care.
+    // LCOV_EXCL_START
+    catch (const std::exception& ex)
+    {
+    }
+
+    // LCOV_EXCL_STOP
+}
+
+void SQLiteDBEngine::syncTableRowsDataByRow(const nlohmann::json& jsInput,
+                                            const DbSync::ResultCallback callback,
+                                            Utils::ILocking& lock)
+{
+    auto singleInput = jsInput;
+
+    for (const auto& entry : jsInput.at("data"))
+    {
+        singleInput["data"] = nlohmann::json::array({ entry });
+
+        try
+        {
+            syncTableRowData(singleInput, callback, true, lock);
+        }
+        catch (const DbSync::max_rows_error&)
+        {
+            if (callback)
+            {
+                lock.unlock();
+                callback(MAX_ROWS, entry);
+                lock.lock();
+            }
+        }
+    }
+}
+
+void SQLiteDBEngine::keepTableRowsData(const nlohmann::json& jsInput,
+                                       const DbSync::ResultCallback callback,
+                                       Utils::ILocking& lock)
+{
+    const std::string table { jsInput.at("table").is_string() ? jsInput.at("table").get_ref<const std::string&>() : "" };
+
+    if (0 == loadTableData(table))
+    {
+        throw dbengine_error { EMPTY_TABLE_METADATA };
+    }
+
+    std::vector<std::string> primaryKeyList;
+
+    if (!getPrimaryKeysFromTable(table, primaryKeyList) || primaryKeyList.empty())
+    {
+        throw dbengine_error { SQL_STMT_ERROR };
+    }
+
+    const auto schema { tableSchema(table) };
+
+    // Without a status field there's nothing to keep, the rows stay until they are explicitly deleted.
+    if (nullptr == schema->column(STATUS_FIELD_NAME))
+    {
+        return;
+    }
+
+    std::string sql { "UPDATE " + table + " SET " + STATUS_FIELD_NAME + "=? WHERE " };
+
+    for (const auto& value : primaryKeyList)
+    {
+        sql.append(value);
+        sql.append("=? AND ");
+    }
+
+    sql = sql.substr(0, sql.size() - 5);
+    sql.append(";");
+
+    const auto stmt { getStatement(sql) };
+    nlohmann::json missingRows = nlohmann::json::array();
+
+    const auto generation { statusGeneration(table) };
+
+    for (const auto& entry : jsInput.at("data"))
+    {
+        int32_t index { 2l };
+        stmt->bind(1, generation);
+
+        for (const auto& pkIndex : schema->primaryKeyIndexes)
+        {
+            if (bindJsonData(stmt, schema->columns[pkIndex], entry, index))
             {
-                jsData.is_number() ? jsData.get<int32_t>() : jsData.is_string()
-                && jsData.get_ref<const std::string&>().size()
-                ? std::stoi(jsData.get_ref<const std::string&>())
-                : 0
-            };
-            stmt->bind(cid, value);
+                ++index;
+            }
         }
-        else if (ColumnType::Text == type)
+
+        // LCOV_EXCL_START
+        if (SQLITE_ERROR == stmt->step())
         {
-            std::string value
-            {
-                jsData.is_string() ? jsData.get_ref<const std::string&>() : ""
-            };
-            stmt->bind(cid, value);
+            throw dbengine_error{ STEP_ERROR_UPDATE_STATUS_FIELD };
         }
-        else if (ColumnType::Double == type)
+
+        // LCOV_EXCL_STOP
+
+        if (0 == m_sqliteConnection->changes())
         {
-            double_t value
-            {
-                jsData.is_number_float() ? jsData.get<double>() : jsData.is_string()
-                && jsData.get_ref<const std::string&>().size()
-                ? std::stod(jsData.get_ref<const std::string&>())
-                : .0f
-            };
-            stmt->bind(cid, value);
+            missingRows.push_back(entry);
         }
-        else
+
+        stmt->reset();
+    }
+
+    // Rows the caller had as unchanged but that aren't stored (e.g. a previous sync failed) are synced normally.
+    if (!missingRows.empty())
+    {
+        nlohmann::json missingInput;
+        missingInput["table"] = table;
+        missingInput["data"] = std::move(missingRows);
+
+        const auto itOptions { jsInput.find("options") };
+
+        if (jsInput.end() != itOptions)
         {
-            throw dbengine_error { INVALID_COLUMN_TYPE };
+            missingInput["options"] = *itOptions;
         }
+
+        syncTableRowsDataByRow(missingInput, callback, lock);
     }
-    else
+}
+
+std::string SQLiteDBEngine::buildPrimaryKeyHash(const TableSchema& schema,
+                                                const nlohmann::json& data)
+{
+    Row row;
+    auto itKey { schema.primaryKeys.begin() };
+
+    for (auto& field : getPrimaryKeyFields(schema, data))
     {
-        retVal = false;
+        row[*itKey] = std::move(field);
+        ++itKey;
     }
 
-    return retVal;
+    return buildPrimaryKeyHash(schema.primaryKeys, row);
 }
 
-bool SQLiteDBEngine::createCopyTempTable(const std::string& table)
+std::string SQLiteDBEngine::buildPrimaryKeyHash(const std::vector<std::string>& primaryKeyList,
+                                                const Row& row)
 {
-    auto ret { false };
-    std::string queryResult;
-    deleteTempTable(table);
+    std::string hash;
 
-    if (getTableCreateQuery(table, queryResult))
+    for (const auto& pkValue : primaryKeyList)
     {
-        if (Utils::replaceAll(queryResult, "CREATE TABLE " + table, "CREATE TEMP TABLE IF NOT EXISTS " + table + "_TEMP"))
+        const auto it { row.find(pkValue) };
+
+        if (row.end() != it)
         {
-            const auto stmt { getStatement(queryResult) };
-            ret = SQLITE_DONE == stmt->step();
+            std::string value;
+            getFieldValueFromTuple(*it, value);
+            // Length prefixed to avoid collisions between values containing the separator.
+            hash.append(std::to_string(value.size()));
+            hash.append(":");
+            hash.append(value);
         }
     }
 
-    return ret;
+    return hash;
 }
 
-void SQLiteDBEngine::deleteTempTable(const std::string& table)
+bool SQLiteDBEngine::getMatchingRows(const std::string& t1,
+                                     const std::string& t2,
+                                     const std::vector<std::string>& primaryKeyList,
+                                     std::vector<Row>& returnRows)
 {
-    try
+    std::string onMatchList;
+
+    for (const auto& value : primaryKeyList)
     {
-        m_sqliteConnection->execute("DELETE FROM " + table + TEMP_TABLE_SUBFIX + ";");
+        onMatchList.append("t1." + value + "=t2." + value + " AND ");
     }
-    //if the table doesn't exist we don't care.
-    // LCOV_EXCL_START
-    catch (const std::exception& ex)
+
+    onMatchList = onMatchList.substr(0, onMatchList.size() - 5);
+
+    const auto stmt { getStatement("SELECT t1.* FROM " + t1 + " t1 INNER JOIN " + t2 + " t2 ON " + onMatchList + ";") };
+    const auto schema { tableSchema(t1) };
+    const auto& tableFields { schema->columns };
+
+    while (SQLITE_ROW == stmt->step())
     {
+        Row registerFields;
+
+        for (const auto& field : tableFields)
+        {
+            getTableData(stmt,
+                         std::get<TableHeader::CID>(field),
+                         std::get<TableHeader::Type>(field),
+                         std::get<TableHeader::Name>(field),
+                         registerFields);
+        }
+
+        returnRows.push_back(std::move(registerFields));
     }
 
-    // LCOV_EXCL_STOP
+    return true;
+}
+
+std::string SQLiteDBEngine::buildInsertLeftOnlyQuery(const std::string& table,
+                                                     const std::vector<std::string>& primaryKeyList)
+{
+    //
+    // The INSERT statement will be as the following:
+    //  INSERT INTO table (c1, c2, ...) SELECT t1.c1, t1.c2, ... FROM table_TEMP t1
+    //  LEFT JOIN table t2 ON t1.pk=t2.pk WHERE t2.pk IS NULL;
+    //
+    std::string columns;
+    std::string selectColumns;
+    std::string onMatchList;
+    std::string nullFilterList;
+
+    const auto schema { tableSchema(table) };
+
+    for (const auto& field : schema->columns)
+    {
+        const auto& fieldName { std::get<TableHeader::Name>(field) };
+        columns.append(fieldName + ",");
+        selectColumns.append("t1." + fieldName + ",");
+    }
+
+    for (const auto& value : primaryKeyList)
+    {
+        onMatchList.append("t1." + value + "=t2." + value + " AND ");
+        nullFilterList.append("t2." + value + " IS NULL AND ");
+    }
+
+    columns = columns.substr(0, columns.size() - 1);
+    selectColumns = selectColumns.substr(0, selectColumns.size() - 1);
+    onMatchList = onMatchList.substr(0, onMatchList.size() - 5);
+    nullFilterList = nullFilterList.substr(0, nullFilterList.size() - 5);
+
+    return "INSERT INTO " + table + " (" + columns + ") SELECT " + selectColumns +
+           " FROM " + table + TEMP_TABLE_SUBFIX + " t1 LEFT JOIN " + table + " t2 ON " + onMatchList +
+           " WHERE " + nullFilterList + ";";
+}
+
+std::string SQLiteDBEngine::buildUpdateStatusMatchingQuery(const std::string& table,
+                                                           const std::vector<std::string>& primaryKeyList)
+{
+    std::string onMatchList;
+
+    for (const auto& value : primaryKeyList)
+    {
+        onMatchList.append("t1." + value + "=" + table + "." + value + " AND ");
+    }
+
+    onMatchList = onMatchList.substr(0, onMatchList.size() - 5);
+
+    return std::string("UPDATE ") + table + " SET " + STATUS_FIELD_NAME + "=? WHERE EXISTS (SELECT 1 FROM " +
+           table + TEMP_TABLE_SUBFIX + " t1 WHERE " + onMatchList + ");";
+}
+
+int64_t SQLiteDBEngine::statusGeneration(const std::string& table) const
+{
+    const auto it { m_statusGenerations.find(table) };
+
+    // Without a transaction opened on the table the rows are marked as the inserted ones, as they were.
+    return m_statusGenerations.end() != it ? it->second : STATUS_FIELD_INSERTED;
 }
 
 bool SQLiteDBEngine::getTableCreateQuery(const std::string& table,
@@ -902,20 +2445,10 @@ bool SQLiteDBEngine::removeNotExistsRows(const std::string& table,
 bool SQLiteDBEngine::getPrimaryKeysFromTable(const std::string& table,
                                              std::vector<std::string>& primaryKeyList)
 {
-    auto retVal { false };
-    const auto tableFields { m_tableFields[table] };
-
-    for (const auto& value : tableFields)
-    {
-        if (std::get<TableHeader::PK>(value) == true)
-        {
-            primaryKeyList.push_back(std::get<TableHeader::Name>(value));
-        }
-
-        retVal = true;
-    }
+    const auto schema { tableSchema(table) };
+    primaryKeyList.insert(primaryKeyList.end(), schema->primaryKeys.begin(), schema->primaryKeys.end());
 
-    return retVal;
+    return !schema->columns.empty();
 }
 
 void SQLiteDBEngine::getTableData(std::shared_ptr<SQLite::IStatement>const stmt,
@@ -923,26 +2456,33 @@ void SQLiteDBEngine::getTableData(std::shared_ptr<SQLite::IStatement>const stmt,
                                   const ColumnType& type,
                                   const std::string& fieldName,
                                   Row& row)
+{
+    row[fieldName] = getTableField(stmt, index, type);
+}
+
+TableField SQLiteDBEngine::getTableField(std::shared_ptr<SQLite::IStatement>const stmt,
+                                         const int32_t index,
+                                         const ColumnType& type)
 {
     if (ColumnType::BigInt == type)
     {
-        row[fieldName] = std::make_tuple(type, std::string(), 0, stmt->column(index)->value(int64_t{}), 0, 0);
+        return std::make_tuple(type, std::string(), 0, stmt->column(index)->value(int64_t{}), 0, 0);
     }
     else if (ColumnType::UnsignedBigInt == type)
     {
-        row[fieldName] = std::make_tuple(type, std::string(), 0, 0, stmt->column(index)->value(int64_t{}), 0);
+        return std::make_tuple(type, std::string(), 0, 0, stmt->column(index)->value(int64_t{}), 0);
     }
     else if (ColumnType::Integer == type)
     {
-        row[fieldName] = std::make_tuple(type, std::string(), stmt->column(index)->value(int32_t{}), 0, 0, 0);
+        return std::make_tuple(type, std::string(), stmt->column(index)->value(int32_t{}), 0, 0, 0);
     }
     else if (ColumnType::Text == type)
     {
-        row[fieldName] = std::make_tuple(type, stmt->column(index)->value(std::string{}), 0, 0, 0, 0);
+        return std::make_tuple(type, stmt->column(index)->value(std::string{}), 0, 0, 0, 0);
     }
     else if (ColumnType::Double == type)
     {
-        row[fieldName] = std::make_tuple(type, std::string(), 0, 0, 0, stmt->column(index)->value(double_t{}));
+        return std::make_tuple(type, std::string(), 0, 0, 0, stmt->column(index)->value(double_t{}));
     }
     else
     {
@@ -961,7 +2501,8 @@ bool SQLiteDBEngine::getLeftOnly(const std::string& t1,
     if (!t1.empty() && !query.empty())
     {
         const auto stmt { getStatement(query) };
-        const auto tableFields { m_tableFields[t1] };
+        const auto schema { tableSchema(t1) };
+        const auto& tableFields { schema->columns };
 
         while (SQLITE_ROW == stmt->step())
         {
@@ -996,7 +2537,7 @@ bool SQLiteDBEngine::getPKListLeftOnly(const std::string& t1,
     if (!t1.empty() && !sql.empty())
     {
         const auto stmt { getStatement(sql) };
-        const auto tableFields { m_tableFields[t1] };
+        const auto schema { tableSchema(t1) };
 
         while (SQLITE_ROW == stmt->step())
         {
@@ -1005,21 +2546,14 @@ bool SQLiteDBEngine::getPKListLeftOnly(const std::string& t1,
             for (const auto& pkValue : primaryKeyList)
             {
                 auto index { 0ull };
-                const auto& it
-                {
-                    std::find_if(tableFields.begin(), tableFields.end(),
-                                 [&pkValue](const ColumnData & columnData)
-                    {
-                        return std::get<TableHeader::Name>(columnData) == pkValue;
-                    })
-                };
+                const auto column { schema->column(pkValue) };
 
-                if (tableFields.end() != it)
+                if (nullptr != column)
                 {
                     getTableData(stmt,
                                  index,
-                                 std::get<TableHeader::Type>(*it),
-                                 std::get<TableHeader::Name>(*it),
+                                 std::get<TableHeader::Type>(*column),
+                                 std::get<TableHeader::Name>(*column),
                                  registerFields);
                 }
 
@@ -1063,6 +2597,34 @@ std::string SQLiteDBEngine::buildDeleteBulkDataSqlQuery(const std::string& table
     return sql;
 }
 
+std::string SQLiteDBEngine::buildSelectOrderedByPKsSqlQuery(const std::string& table,
+                                                            const std::vector<std::string>& primaryKeyList)
+{
+    std::string sql{ "SELECT * FROM " };
+    sql.append(table);
+    sql.append(" ORDER BY ");
+
+    if (0 != primaryKeyList.size())
+    {
+        for (const auto& value : primaryKeyList)
+        {
+            sql.append(value);
+            sql.append(",");
+        }
+
+        sql = sql.substr(0, sql.size() - 1);
+        sql.append(";");
+    }
+    // LCOV_EXCL_START
+    else
+    {
+        throw dbengine_error { SQL_STMT_ERROR };
+    }
+
+    // LCOV_EXCL_STOP
+    return sql;
+}
+
 bool SQLiteDBEngine::deleteRows(const std::string& table,
                                 const std::vector<std::string>& primaryKeyList,
                                 const std::vector<Row>& rowsToRemove)
@@ -1115,33 +2677,23 @@ void SQLiteDBEngine::deleteRowsbyPK(const std::string& table,
 
     if (getPrimaryKeysFromTable(table, primaryKeyList))
     {
-        const auto& tableFields { m_tableFields[table] };
+        const auto schema { tableSchema(table) };
         const auto stmt
         {
-            getStatement(buildDeleteBulkDataSqlQuery(table, primaryKeyList))
+            getStatement(schema->deleteMatchingPKsQuery.empty()
+                         ? buildDeleteBulkDataSqlQuery(table, primaryKeyList)
+                         : schema->deleteMatchingPKsQuery)
         };
 
         for (const auto& jsRow : data)
         {
             int32_t index { 1l };
 
-            for (const auto& pkValue : primaryKeyList)
+            for (const auto& pkIndex : schema->primaryKeyIndexes)
             {
-                const auto& it
-                {
-                    std::find_if(tableFields.begin(), tableFields.end(),
-                                 [&pkValue](const ColumnData & column)
-                    {
-                        return 0 == std::get<Name>(column).compare(pkValue);
-                    })
-                };
-
-                if (it != tableFields.end())
+                if (bindJsonData(stmt, schema->columns[pkIndex], jsRow, index))
                 {
-                    if (bindJsonData(stmt, *it, jsRow, index))
-                    {
-                        ++index;
-                    }
+                    ++index;
                 }
             }
 
@@ -1288,76 +2840,82 @@ bool SQLiteDBEngine::getRowDiff(const std::vector<std::string>& primaryKeyList,
                                 nlohmann::json& oldData)
 {
     bool diffExist { false };
-    bool isModified { false };
+    const auto schema { tableSchema(table) };
+    const auto& tableFields { schema->columns };
     const auto stmt
     {
-        getStatement(buildSelectMatchingPKsSqlQuery(table, primaryKeyList))
+        getStatement(schema->selectMatchingPKsQuery.empty()
+                     ? buildSelectMatchingPKsSqlQuery(table, primaryKeyList)
+                     : schema->selectMatchingPKsQuery)
     };
 
-    const auto& tableFields { m_tableFields[table] };
     int32_t index { 1l };
 
-    // Always include primary keys
-    for (const auto& pkValue : primaryKeyList)
+    for (const auto& pkIndex : schema->primaryKeyIndexes)
     {
-        const auto& it
-        {
-            std::find_if(tableFields.begin(), tableFields.end(),
-                         [&pkValue](const ColumnData & column)
-            {
-                return 0 == std::get<Name>(column).compare(pkValue);
-            })
-        };
-
-        if (it != tableFields.end())
-        {
-            updatedData[pkValue] = data.at(pkValue);
-            oldData[pkValue] = data.at(pkValue);
-            bindJsonData(stmt, *it, data, index);
-            ++index;
-        }
+        bindJsonData(stmt, tableFields[pkIndex], data, index);
+        ++index;
     }
 
     diffExist = SQLITE_ROW == stmt->step();
 
     if (diffExist)
     {
-        // The row exists, so let's generate the diff
-        Row registryFields;
+        // The row exists, so let's generate the diff reading only the columns present in the input.
+        TableField storedField;
 
-        for (const auto& field : tableFields)
+        buildRowDiff(primaryKeyList, ignoredColumns, tableFields,
+                     [&](const ColumnData & field) -> const TableField&
         {
-            getTableData(stmt,
-                         std::get<TableHeader::CID>(field),
-                         std::get<TableHeader::Type>(field),
-                         std::get<TableHeader::Name>(field),
-                         registryFields);
-        }
+            storedField = getTableField(stmt,
+                                        std::get<TableHeader::CID>(field),
+                                        std::get<TableHeader::Type>(field));
+            return storedField;
+        },
+        data, updatedData, oldData);
+    }
+
+    return diffExist;
+}
+
+void SQLiteDBEngine::buildRowDiff(const std::vector<std::string>& primaryKeyList,
+                                  const nlohmann::json& ignoredColumns,
+                                  const TableColumns& tableFields,
+                                  const std::function<const TableField&(const ColumnData&)>& storedField,
+                                  const nlohmann::json& data,
+                                  nlohmann::json& updatedData,
+                                  nlohmann::json& oldData)
+{
+    bool isModified { false };
 
-        if (!registryFields.empty())
+    // Always include primary keys
+    for (const auto& pkValue : primaryKeyList)
+    {
+        updatedData[pkValue] = data.at(pkValue);
+        oldData[pkValue] = data.at(pkValue);
+    }
+
+    for (const auto& field : tableFields)
+    {
+        const auto& name { std::get<TableHeader::Name>(field) };
+        const auto& it
         {
-            for (const auto& value : registryFields)
-            {
-                nlohmann::json object;
-                getFieldValueFromTuple(value, object);
-                const auto& it
-                {
-                    data.find(value.first)
-                };
+            data.find(name)
+        };
 
-                if (data.end() != it)
-                {
-                    // Only compare if not in ignore set
-                    if (*it != object.at(value.first))
-                    {
-                        // Diff found
-                        isModified = true;
-                        oldData[value.first] = object[value.first];
-                    }
+        if (data.end() != it)
+        {
+            const Field value { name, storedField(field) };
 
-                    updatedData[value.first] = *it;
-                }
+            // Compare the typed column value, the JSON value is only built when they differ.
+            if (!isEqualFieldValue(value.second, *it))
+            {
+                // Diff found
+                isModified = true;
+                getFieldValueFromTuple(value, oldData);
             }
+
+            updatedData[name] = *it;
         }
     }
 
@@ -1373,7 +2931,7 @@ bool SQLiteDBEngine::getRowDiff(const std::vector<std::string>& primaryKeyList,
         {
             auto haveDiffOnNonIgnored
             {
-                [&ignoredColumns, primaryKeyList](const nlohmann::json & rowToBeUpdated) -> bool
+                [&ignoredColumns, &primaryKeyList](const nlohmann::json & rowToBeUpdated) -> bool
                 {
                     bool haveDiff { false };
 
@@ -1402,8 +2960,43 @@ bool SQLiteDBEngine::getRowDiff(const std::vector<std::string>& primaryKeyList,
             }
         }
     }
+}
 
-    return diffExist;
+void SQLiteDBEngine::updateRowAndNotify(const std::string& table,
+                                        const std::vector<std::string>& primaryKeyList,
+                                        const nlohmann::json& entry,
+                                        const nlohmann::json& updatedData,
+                                        const nlohmann::json& oldData,
+                                        const bool returnOldData,
+                                        const bool inTransaction,
+                                        const DbSync::ResultCallback callback,
+                                        Utils::ILocking& lock)
+{
+    const auto& jsDataToUpdate { getDataToUpdate(primaryKeyList, updatedData, entry, inTransaction, statusGeneration(table)) };
+
+    if (!jsDataToUpdate.empty())
+    {
+        updateSingleRow(table, jsDataToUpdate);
+
+        if (callback && !updatedData.empty())
+        {
+            lock.unlock();
+
+            if (returnOldData)
+            {
+                nlohmann::json diff;
+                diff["old"] = oldData;
+                diff["new"] = updatedData;
+                callback(MODIFIED, diff);
+            }
+            else
+            {
+                callback(MODIFIED, updatedData);
+            }
+
+            lock.lock();
+        }
+    }
 }
 
 bool SQLiteDBEngine::insertNewRows(const std::string& table,
@@ -1443,12 +3036,15 @@ void SQLiteDBEngine::bulkInsert(const std::string& table,
                                 const std::vector<Row>& data)
 {
     const auto stmt { getStatement(buildInsertDataSqlQuery(table)) };
+    const auto schema { tableSchema(table) };
+    auto pendingRows { static_cast<long long>(data.size()) };
+
+    // The rows are accounted once, a set that doesn't fit in the max rows isn't inserted.
+    updateTableRowCounter(table, pendingRows);
 
     for (const auto& row : data)
     {
-        const auto tableFields { m_tableFields[table] };
-
-        for (const auto& value : tableFields)
+        for (const auto& value : schema->columns)
         {
             auto it { row.find(std::get<TableHeader::Name>(value))};
 
@@ -1458,17 +3054,15 @@ void SQLiteDBEngine::bulkInsert(const std::string& table,
             }
         }
 
-        updateTableRowCounter(table, 1ll);
-
         // LCOV_EXCL_START
         if (SQLITE_ERROR == stmt->step())
         {
-
-            updateTableRowCounter(table, -1ll);
+            updateTableRowCounter(table, pendingRows * -1ll);
             throw dbengine_error{ BIND_FIELDS_DOES_NOT_MATCH };
         }
 
         // LCOV_EXCL_STOP
+        --pendingRows;
         stmt->reset();
     }
 }
@@ -1645,11 +3239,11 @@ std::string SQLiteDBEngine::buildModifiedRowsQuery(const std::string& t1,
         onMatchList.append("t1." + value + "=t2." + value + " AND ");
     }
 
-    const auto tableFields { m_tableFields[t1] };
+    const auto schema { tableSchema(t1) };
 
-    for (const auto& value : tableFields)
+    for (const auto& value : schema->columns)
     {
-        const auto fieldName {std::get<TableHeader::Name>(value)};
+        const auto& fieldName {std::get<TableHeader::Name>(value)};
         fieldsList.append("CASE WHEN t1.");
         fieldsList.append(fieldName);
         fieldsList.append("<>t2.");
@@ -1694,31 +3288,25 @@ bool SQLiteDBEngine::getRowsToModify(const std::string& table,
     if (!sql.empty())
     {
         const auto stmt { getStatement(sql) };
+        const auto schema { tableSchema(table) };
+        const auto& tableFields { schema->columns };
 
         while (SQLITE_ROW == stmt->step())
         {
             bool dataModified{false};
-            const auto tableFields { m_tableFields[table] };
             Row registerFields;
             int32_t index {0l};
 
             for (const auto& pkValue : primaryKeyList)
             {
-                const auto it
-                {
-                    std::find_if(tableFields.begin(), tableFields.end(),
-                                 [&pkValue] (const ColumnData & cd)
-                    {
-                        return std::get<TableHeader::Name>(cd).compare(pkValue) == 0;
-                    })
-                };
+                const auto column { schema->column(pkValue) };
 
-                if (tableFields.end() != it)
+                if (nullptr != column)
                 {
                     getTableData(stmt,
                                  index,
-                                 std::get<TableHeader::Type>(*it),
-                                 "PK_" + std::get<TableHeader::Name>(*it),
+                                 std::get<TableHeader::Type>(*column),
+                                 "PK_" + std::get<TableHeader::Name>(*column),
                                  registerFields);
                 }
 
@@ -1765,7 +3353,7 @@ void SQLiteDBEngine::updateSingleRow(const std::string& table,
 
     if (getPrimaryKeysFromTable(table, primaryKeyList))
     {
-        const auto& tableFields { m_tableFields[table] };
+        const auto schema { tableSchema(table) };
         const auto stmt { getStatement(buildUpdatePartialDataSqlQuery(table, jsData, primaryKeyList)) };
         int32_t index { 1l };
 
@@ -1773,17 +3361,14 @@ void SQLiteDBEngine::updateSingleRow(const std::string& table,
         {
             if (std::find(primaryKeyList.begin(), primaryKeyList.end(), it.key()) == primaryKeyList.end())
             {
-                const auto it1{std::find_if(tableFields.begin(), tableFields.end(), [&it](const auto & value)
-                {
-                    return std::get<GenericTupleIndex::GenString>(value) == it.key();
-                })};
+                const auto column { schema->column(it.key()) };
 
-                if (it1 == tableFields.end())
+                if (nullptr == column)
                 {
                     throw dbengine_error{ BIND_FIELDS_DOES_NOT_MATCH };
                 }
 
-                bindJsonData(stmt, *it1, jsData, index);
+                bindJsonData(stmt, *column, jsData, index);
                 ++index;
             }
         }
@@ -1792,17 +3377,14 @@ void SQLiteDBEngine::updateSingleRow(const std::string& table,
         {
             if (std::find(primaryKeyList.begin(), primaryKeyList.end(), it.key()) != primaryKeyList.end())
             {
-                const auto it1{std::find_if(tableFields.begin(), tableFields.end(), [&it](const auto & value)
-                {
-                    return std::get<GenericTupleIndex::GenString>(value) == it.key();
-                })};
+                const auto column { schema->column(it.key()) };
 
-                if (it1 == tableFields.end())
+                if (nullptr == column)
                 {
                     throw dbengine_error{ BIND_FIELDS_DOES_NOT_MATCH };
                 }
 
-                bindJsonData(stmt, *it1, jsData, index);
+                bindJsonData(stmt, *column, jsData, index);
                 ++index;
             }
         }
@@ -1917,31 +3499,30 @@ void SQLiteDBEngine::getFieldValueFromTuple(const Field& value,
 std::shared_ptr<SQLite::IStatement>const SQLiteDBEngine::getStatement(const std::string& sql)
 {
     std::lock_guard<std::mutex> lock(m_stmtMutex);
-    const auto it
-    {
-        std::find_if(m_statementsCache.begin(),
-                     m_statementsCache.end(),
-                     [sql](const std::pair<std::string, std::shared_ptr<SQLite::IStatement>>& pair)
-        {
-            return 0 == pair.first.compare(sql);
-        })
-    };
+    const auto it { m_statementsCacheIndex.find(sql) };
 
-    if (m_statementsCache.end() != it)
+    if (m_statementsCacheIndex.end() != it)
     {
-        it->second->reset();
-        return it->second;
+        // Move the entry to the front, the list is kept in most recently used order.
+        m_statementsCache.splice(m_statementsCache.begin(), m_statementsCache, it->second);
+        ++m_statementsCacheStats.hits;
+        it->second->second->reset();
+        return it->second->second;
     }
     else
     {
-        m_statementsCache.emplace_back(sql, m_sqliteFactory->createStatement(m_sqliteConnection, sql));
+        ++m_statementsCacheStats.misses;
+        m_statementsCache.emplace_front(sql, m_sqliteFactory->createStatement(m_sqliteConnection, sql));
+        m_statementsCacheIndex.emplace(sql, m_statementsCache.begin());
 
-        if (CACHE_STMT_LIMIT <= m_statementsCache.size())
+        if (CACHE_STMT_LIMIT < m_statementsCache.size())
         {
-            m_statementsCache.pop_front();
+            m_statementsCacheIndex.erase(m_statementsCache.back().first);
+            m_statementsCache.pop_back();
+            ++m_statementsCacheStats.evictions;
         }
 
-        return m_statementsCache.back().second;
+        return m_statementsCache.front().second;
     }
 }
 
@@ -1967,7 +3548,11 @@ std::string SQLiteDBEngine::getSelectAllQuery(const std::string& table,
         retVal.append(table);
         retVal.append(" WHERE ");
         retVal.append(STATUS_FIELD_NAME);
-        retVal.append("=0;");
+        retVal.append("<? AND ");
+        retVal.append(STATUS_FIELD_NAME);
+        retVal.append("<>");
+        retVal.append(std::to_string(STATUS_FIELD_INSERTED));
+        retVal.append(";");
     }
     else
     {
@@ -2061,23 +3646,46 @@ std::string SQLiteDBEngine::buildUpdateRelationTrigger(const nlohmann::json&
     return sqlUpdate;
 }
 
+bool SQLiteDBEngine::hasMaxRows(const std::string& table)
+{
+    return m_maxRows.end() != m_maxRows.find(table);
+}
+
+size_t SQLiteDBEngine::remainingRows(const std::string& table)
+{
+    const auto it { m_maxRows.find(table) };
+
+    if (m_maxRows.end() != it)
+    {
+        return static_cast<size_t>(std::max<int64_t>(it->second->maxRows - it->second->currentRows.load(), 0));
+    }
+
+    return std::numeric_limits<size_t>::max();
+}
+
 void SQLiteDBEngine::updateTableRowCounter(const std::string& table, const long long rowModifyCount)
 {
-    std::lock_guard<std::mutex> lock(m_maxRowsMutex);
-    auto it { m_maxRows.find(table) };
+    const auto it { m_maxRows.find(table) };
 
     if (it != m_maxRows.end())
     {
-        if (it->second.currentRows + rowModifyCount > it->second.maxRows)
+        auto& counter { it->second->currentRows };
+        auto currentRows { counter.load() };
+        int64_t newRows;
+
+        do
         {
-            throw DbSync::max_rows_error { SQLite::MAX_ROWS_ERROR_STRING };
-        }
+            if (rowModifyCount > 0 && currentRows + rowModifyCount > it->second->maxRows)
+            {
+                throw DbSync::max_rows_error { SQLite::MAX_ROWS_ERROR_STRING };
+            }
 
-        it->second.currentRows += rowModifyCount;
+            newRows = std::max<int64_t>(currentRows + rowModifyCount, 0);
+        }
+        while (!counter.compare_exchange_weak(currentRows, newRows));
 
-        if (it->second.currentRows < 0)
+        if (currentRows + rowModifyCount < 0)
         {
-            it->second.currentRows = 0;
             throw dbengine_error { ERROR_COUNT_MAX_ROWS };
         }
     }
@@ -13,9 +13,13 @@
 #define _SQLITE_DBENGINE_H
 
 #include <tuple>
+#include <atomic>
+#include <condition_variable>
 #include <iostream>
+#include <list>
 #include <mutex>
 #include <queue>
+#include <unordered_map>
 #include "dbengine.h"
 #include "sqlite_wrapper_factory.h"
 #include "isqlite_wrapper.h"
@@ -25,17 +29,56 @@ constexpr auto TEMP_TABLE_SUBFIX {"_TEMP"};
 
 constexpr auto STATUS_FIELD_NAME {"db_status_field_dm"};
 constexpr auto STATUS_FIELD_TYPE {"INTEGER"};
+// Value the inserted rows get from the column default, they are always kept by the transaction that inserted them.
+constexpr int64_t STATUS_FIELD_INSERTED {1};
 
 constexpr auto CACHE_STMT_LIMIT
 {
     30ull
 };
 
+// Rows per multi-row INSERT statement, bounded by the SQLite host parameter limit.
+constexpr auto BULK_INSERT_BATCH_ROWS
+{
+    64ull
+};
+
+constexpr auto SQLITE_MAX_BIND_PARAMETERS
+{
+    999ull
+};
+
+// Upper bound for the "read_connections" tuning option.
+constexpr auto MAX_READ_CONNECTIONS
+{
+    16ll
+};
+
 const std::vector<std::string> InternalColumnNames =
 {
     { STATUS_FIELD_NAME }
 };
 
+// Tunable pragmas, applied in this order (page_size can't change once the journal is in WAL mode).
+const std::vector<std::string> TuningPragmaNames =
+{
+    "page_size", "temp_store", "journal_mode", "synchronous", "cache_size", "mmap_size"
+};
+
+const std::map<std::string, std::map<std::string, std::string>> TuningProfiles =
+{
+    { "default",      { { "temp_store", "memory" }, { "journal_mode", "truncate" }, { "synchronous", "OFF" } } },
+    { "memory-heavy", { { "temp_store", "memory" }, { "journal_mode", "memory" }, { "synchronous", "OFF" }, { "cache_size", "-65536" } } },
+    { "ssd",          { { "temp_store", "memory" }, { "journal_mode", "WAL" }, { "synchronous", "NORMAL" }, { "mmap_size", "268435456" } } }
+};
+
+const std::map<std::string, std::set<std::string>> TuningPragmaKeywords =
+{
+    { "journal_mode", { "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF" } },
+    { "synchronous",  { "OFF", "NORMAL", "FULL", "EXTRA" } },
+    { "temp_store",   { "DEFAULT", "FILE", "MEMORY" } }
+};
+
 enum ColumnType
 {
     Unknown = 0,
@@ -83,6 +126,27 @@ using ColumnData =
 using TableColumns =
     std::vector<ColumnData>;
 
+// Immutable table metadata, built once when the table is loaded so the sync paths can resolve
+// columns and primary keys without scanning the column list.
+struct TableSchema final
+{
+    TableColumns columns;
+    std::unordered_map<std::string, size_t> columnIndexes;
+    std::vector<std::string> primaryKeys;
+    std::vector<size_t> primaryKeyIndexes;
+    std::string selectMatchingPKsQuery;
+    std::string deleteMatchingPKsQuery;
+    std::string selectOrderedByPKsQuery;
+
+    const ColumnData* column(const std::string& name) const
+    {
+        const auto it { columnIndexes.find(name) };
+        return columnIndexes.end() != it ? &columns[it->second] : nullptr;
+    }
+};
+
+using TableSchemaPtr = std::shared_ptr<const TableSchema>;
+
 using TableField =
     std::tuple<int32_t, std::string, int32_t, int64_t, uint64_t, double_t>;
 
@@ -107,23 +171,48 @@ class dbengine_error : public DbSync::dbsync_error
         {}
 };
 
+// The counter is updated without locks by the transaction rows synced concurrently.
 struct MaxRows final
 {
-    int64_t maxRows;
-    int64_t currentRows;
+    MaxRows(const int64_t max, const int64_t current)
+        : maxRows{ max }
+        , currentRows{ current }
+    {}
+
+    const int64_t maxRows;
+    std::atomic<int64_t> currentRows;
+};
+
+struct StatementCacheStats final
+{
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
 };
 
+using StatementCacheEntry = std::pair<std::string, std::shared_ptr<SQLite::IStatement>>;
+
+using StatementCacheList = std::list<StatementCacheEntry>;
+
 class SQLiteDBEngine final : public DbSync::IDbEngine
 {
     public:
         SQLiteDBEngine(const std::shared_ptr<ISQLiteFactory>& sqliteFactory,
                        const std::string& path,
-                       const std::string& tableStmtCreation);
+                       const std::string& tableStmtCreation,
+                       const nlohmann::json& tuningConfig = {});
         ~SQLiteDBEngine();
 
         void bulkInsert(const std::string& table,
                         const nlohmann::json& data) override;
 
+        void bulkUpsert(const std::string& table,
+                        const nlohmann::json& data) override;
+
+        nlohmann::json tuningInfo() override;
+
+        bool concurrentReads() override;
+
         void refreshTableData(const nlohmann::json& data,
                               const DbSync::ResultCallback callback,
                               std::unique_lock<std::shared_timed_mutex>& lock) override;
@@ -133,6 +222,14 @@ class SQLiteDBEngine final : public DbSync::IDbEngine
                               const bool inTransaction,
                               Utils::ILocking& mutex) override;
 
+        void syncTableRowsData(const nlohmann::json& jsInput,
+                               const DbSync::ResultCallback callback,
+                               Utils::ILocking& mutex) override;
+
+        void keepTableRowsData(const nlohmann::json& jsInput,
+                               const DbSync::ResultCallback callback,
+                               Utils::ILocking& mutex) override;
+
         void setMaxRows(const std::string& table,
                         const int64_t maxRows) override;
 
@@ -149,24 +246,68 @@ class SQLiteDBEngine final : public DbSync::IDbEngine
                         const DbSync::ResultCallback& callback,
                         std::unique_lock<std::shared_timed_mutex>& lock) override;
 
+        void selectRows(const std::string& table,
+                        const nlohmann::json& query,
+                        const DbSync::RowCallback& callback,
+                        std::unique_lock<std::shared_timed_mutex>& lock) override;
+
         void deleteTableRowsData(const std::string& table,
                                  const nlohmann::json& jsDeletionData) override;
 
         void addTableRelationship(const nlohmann::json& data) override;
 
+        void backup(const std::string& path) override;
+
+        void restore(const std::string& path) override;
+
+        void attach(const std::string& path,
+                    const std::string& alias) override;
+
+        StatementCacheStats statementCacheStats() const;
+
     private:
         void initialize(const std::string& path,
-                        const std::string& tableStmtCreation);
+                        const std::string& tableStmtCreation,
+                        const nlohmann::json& tuningConfig);
 
         bool cleanDB(const std::string& path);
 
+        std::map<std::string, std::vector<std::string>> schemaDefinition(const std::string& schema);
+
         size_t loadTableData(const std::string& table);
 
         bool loadFieldData(const std::string& table);
 
+        bool loadFieldData(const std::string& table,
+                           std::shared_ptr<SQLite::IConnection>& connection);
+
+        std::shared_ptr<SQLite::IConnection> acquireReadConnection();
+
+        void publishChanges();
+
+        TableSchemaPtr tableSchema(const std::string& table);
+
         std::string buildInsertDataSqlQuery(const std::string& table,
                                             const nlohmann::json& data = {});
 
+        std::string buildBulkInsertDataSqlQuery(const std::string& table,
+                                                const std::vector<const ColumnData*>& columns,
+                                                const size_t rowsCount,
+                                                const std::vector<std::string>& upsertPrimaryKeys);
+
+        void bulkInsertData(const std::string& table,
+                            const nlohmann::json& data,
+                            const bool upsert);
+
+        void insertBatch(const std::string& table,
+                         const TableSchema& schema,
+                         const std::vector<const ColumnData*>& columns,
+                         const std::vector<const nlohmann::json*>& batch,
+                         const bool upsert);
+
+        std::string buildSelectOrderedByPKsSqlQuery(const std::string& table,
+                                                    const std::vector<std::string>& primaryKeyList);
+
         std::string buildDeleteBulkDataSqlQuery(const std::string& table,
                                                 const std::vector<std::string>& primaryKeyList);
 
@@ -188,6 +329,11 @@ class SQLiteDBEngine final : public DbSync::IDbEngine
         bool getPrimaryKeysFromTable(const std::string& table,
                                      std::vector<std::string>& primaryKeyList);
 
+        bool mergeSortedSnapshot(const std::string& table,
+                                 const nlohmann::json& data,
+                                 const DbSync::ResultCallback callback,
+                                 std::unique_lock<std::shared_timed_mutex>& lock);
+
         bool removeNotExistsRows(const std::string& table,
                                  const std::vector<std::string>& primaryKeyList,
                                  const DbSync::ResultCallback callback,
@@ -200,6 +346,47 @@ class SQLiteDBEngine final : public DbSync::IDbEngine
                         nlohmann::json& updatedData,
                         nlohmann::json& oldData);
 
+        void buildRowDiff(const std::vector<std::string>& primaryKeyList,
+                          const nlohmann::json& ignoredColumns,
+                          const TableColumns& tableFields,
+                          const std::function<const TableField&(const ColumnData&)>& storedField,
+                          const nlohmann::json& data,
+                          nlohmann::json& updatedData,
+                          nlohmann::json& oldData);
+
+        void updateRowAndNotify(const std::string& table,
+                                const std::vector<std::string>& primaryKeyList,
+                                const nlohmann::json& entry,
+                                const nlohmann::json& updatedData,
+                                const nlohmann::json& oldData,
+                                const bool returnOldData,
+                                const bool inTransaction,
+                                const DbSync::ResultCallback callback,
+                                Utils::ILocking& lock);
+
+        void syncTableRowsDataByRow(const nlohmann::json& jsInput,
+                                    const DbSync::ResultCallback callback,
+                                    Utils::ILocking& lock);
+
+        std::string buildPrimaryKeyHash(const TableSchema& schema,
+                                        const nlohmann::json& data);
+
+        std::string buildPrimaryKeyHash(const std::vector<std::string>& primaryKeyList,
+                                        const Row& row);
+
+        bool getMatchingRows(const std::string& t1,
+                             const std::string& t2,
+                             const std::vector<std::string>& primaryKeyList,
+                             std::vector<Row>& returnRows);
+
+        std::string buildInsertLeftOnlyQuery(const std::string& table,
+                                             const std::vector<std::string>& primaryKeyList);
+
+        std::string buildUpdateStatusMatchingQuery(const std::string& table,
+                                                   const std::vector<std::string>& primaryKeyList);
+
+        int64_t statusGeneration(const std::string& table) const;
+
         bool insertNewRows(const std::string& table,
                            const std::vector<std::string>& primaryKeyList,
                            const DbSync::ResultCallback callback,
@@ -222,6 +409,10 @@ class SQLiteDBEngine final : public DbSync::IDbEngine
                           const std::string& fieldName,
                           Row& row);
 
+        TableField getTableField(std::shared_ptr<SQLite::IStatement>const stmt,
+                                 const int32_t index,
+                                 const ColumnType& type);
+
         void bindFieldData(const std::shared_ptr<SQLite::IStatement> stmt,
                            const int32_t index,
                            const TableField& fieldData);
@@ -304,19 +495,34 @@ class SQLiteDBEngine final : public DbSync::IDbEngine
         void updateTableRowCounter(const std::string& table,
                                    const long long    rowModifyCount);
 
+        bool hasMaxRows(const std::string& table);
+
+        size_t remainingRows(const std::string& table);
+
         void insertElement(const std::string& table,
                            const TableColumns& tableColumns,
                            const nlohmann::json& element,
                            const std::function<void()> callback = {});
 
-        Utils::MapWrapperSafe<std::string, TableColumns> m_tableFields;
-        std::deque<std::pair<std::string, std::shared_ptr<SQLite::IStatement>>> m_statementsCache;
+        Utils::MapWrapperSafe<std::string, TableSchemaPtr> m_tableSchemas;
+        StatementCacheList m_statementsCache;
+        std::unordered_map<std::string, StatementCacheList::iterator> m_statementsCacheIndex;
+        StatementCacheStats m_statementsCacheStats;
         const std::shared_ptr<ISQLiteFactory> m_sqliteFactory;
         std::shared_ptr<SQLite::IConnection> m_sqliteConnection;
-        std::mutex m_stmtMutex;
+        mutable std::mutex m_stmtMutex;
         std::unique_ptr<SQLite::ITransaction> m_transaction;
-        std::mutex m_maxRowsMutex;
-        std::map<std::string, MaxRows> m_maxRows;
+        // Only changed by setMaxRows, which runs with the sync operations locked out.
+        std::map<std::string, std::unique_ptr<MaxRows>> m_maxRows;
+        // Status value of the rows seen in the current transaction of each table, only changed by
+        // initializeStatusField, which runs with the sync operations locked out.
+        std::map<std::string, int64_t> m_statusGenerations;
+        std::vector<std::shared_ptr<SQLite::IConnection>> m_readConnections;
+        std::mutex m_readConnectionsMutex;
+        std::condition_variable m_readConnectionsCondition;
+        bool m_concurrentReads;
+        // Set once the other shards are attached, they read this database on their own connections.
+        bool m_attached;
 };
 
 #endif // _SQLITE_DBENGINE_H
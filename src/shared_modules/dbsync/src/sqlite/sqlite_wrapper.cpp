@@ -116,6 +116,59 @@ int64_t Connection::changes() const
     return sqlite3_changes(m_db.get());
 }
 
+static void copyDatabase(sqlite3* source, sqlite3* destination)
+{
+    const std::unique_ptr<sqlite3_backup, CustomDeleter<decltype(&sqlite3_backup_finish), sqlite3_backup_finish>> spBackup
+    {
+        sqlite3_backup_init(destination, "main", source, "main")
+    };
+
+    if (!spBackup)
+    {
+        checkSqliteResult(sqlite3_errcode(destination), std::string("Error starting the database copy. ") + sqlite3_errmsg(destination));
+    }
+
+    // All the pages are copied in a single step, neither database is used meanwhile.
+    const auto result { sqlite3_backup_step(spBackup.get(), -1) };
+
+    if (SQLITE_DONE != result)
+    {
+        checkSqliteResult(SQLITE_OK == result ? SQLITE_ERROR : result, "Error copying the database.");
+    }
+}
+
+void Connection::backup(const std::string& path)
+{
+    if (!m_db)
+    {
+        throw sqlite_error
+        {
+            SQLITE_CONNECTION_ERROR
+        };
+    }
+
+    // The connection ctor restricts the permissions of the new file.
+    Connection destination{ path };
+    copyDatabase(m_db.get(), destination.db().get());
+}
+
+void Connection::restore(const std::string& path)
+{
+    if (!m_db)
+    {
+        throw sqlite_error
+        {
+            SQLITE_CONNECTION_ERROR
+        };
+    }
+
+    const std::unique_ptr<sqlite3, CustomDeleter<decltype(&sqlite3_close_v2), sqlite3_close_v2>> spSource
+    {
+        openSQLiteDb(path, SQLITE_OPEN_READONLY)
+    };
+    copyDatabase(spSource.get(), m_db.get());
+}
+
 Transaction::~Transaction()
 {
     try
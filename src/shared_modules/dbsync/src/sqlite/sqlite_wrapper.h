@@ -30,6 +30,8 @@ namespace SQLite
             void close() override;
             const std::shared_ptr<sqlite3>& db() const override;
             int64_t changes() const override;
+            void backup(const std::string& path) override;
+            void restore(const std::string& path) override;
         private:
             std::shared_ptr<sqlite3> m_db;
     };
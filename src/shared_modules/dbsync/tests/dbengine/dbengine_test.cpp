@@ -21,6 +21,7 @@ using ::testing::_;
 using ::testing::Return;
 using ::testing::An;
 using ::testing::ByMove;
+using ::testing::TypedEq;
 
 static void initNoMetaDataMocks(std::unique_ptr<SQLiteDBEngine>& spEngine)
 {
@@ -198,13 +199,36 @@ TEST_F(DBEngineTest, InitializeStatusField)
                 createStatement(_, "ALTER TABLE dummy ADD COLUMN db_status_field_dm INTEGER DEFAULT 1;"))
     .WillOnce(Return(ByMove(std::move(mockStatement_3))));
 
+    auto mockStatement_5 { std::make_unique<MockStatement>() };
+    EXPECT_CALL(*mockStatement_5,
+                step())
+    .WillOnce(Return(0));
+    EXPECT_CALL(*mockFactory,
+                createStatement(_, "CREATE INDEX IF NOT EXISTS dummy_db_status_field_dm_idx ON dummy(db_status_field_dm);"))
+    .WillOnce(Return(ByMove(std::move(mockStatement_5))));
+
+    auto mockColumnMax { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumnMax, value(An<const int64_t&>()))
+    .WillOnce(Return(0));
+    auto mockStatement_6 { std::make_unique<MockStatement>() };
+    EXPECT_CALL(*mockStatement_6,
+                step())
+    .WillOnce(Return(SQLITE_ROW));
+    EXPECT_CALL(*mockStatement_6, column(0))
+    .WillOnce(Return(ByMove(std::move(mockColumnMax))));
+    EXPECT_CALL(*mockFactory,
+                createStatement(_, "SELECT MAX(db_status_field_dm) FROM dummy;"))
+    .WillOnce(Return(ByMove(std::move(mockStatement_6))));
+
     auto mockStatement_4 { std::make_unique<MockStatement>() };
     EXPECT_CALL(*mockStatement_4,
                 step())
     .WillOnce(Return(0));
+    // The inserted rows join the generation following the stored ones.
+    EXPECT_CALL(*mockStatement_4, bind(1, TypedEq<int64_t>(2))).Times(1);
 
     EXPECT_CALL(*mockFactory,
-                createStatement(_, "UPDATE dummy SET db_status_field_dm=0;"))
+                createStatement(_, "UPDATE dummy SET db_status_field_dm=? WHERE db_status_field_dm=1;"))
     .WillOnce(Return(ByMove(std::move(mockStatement_4))));
 
 
@@ -328,13 +352,36 @@ TEST_F(DBEngineTest, InitializeStatusFieldPreExistent)
                 createStatement(_, "PRAGMA table_info(dummy);"))
     .WillOnce(Return(ByMove(std::move(mockStatement_2))));
 
+    auto mockStatement_5 { std::make_unique<MockStatement>() };
+    EXPECT_CALL(*mockStatement_5,
+                step())
+    .WillOnce(Return(0));
+    EXPECT_CALL(*mockFactory,
+                createStatement(_, "CREATE INDEX IF NOT EXISTS dummy_db_status_field_dm_idx ON dummy(db_status_field_dm);"))
+    .WillOnce(Return(ByMove(std::move(mockStatement_5))));
+
+    auto mockColumnMax { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumnMax, value(An<const int64_t&>()))
+    .WillOnce(Return(7));
+    auto mockStatement_6 { std::make_unique<MockStatement>() };
+    EXPECT_CALL(*mockStatement_6,
+                step())
+    .WillOnce(Return(SQLITE_ROW));
+    EXPECT_CALL(*mockStatement_6, column(0))
+    .WillOnce(Return(ByMove(std::move(mockColumnMax))));
+    EXPECT_CALL(*mockFactory,
+                createStatement(_, "SELECT MAX(db_status_field_dm) FROM dummy;"))
+    .WillOnce(Return(ByMove(std::move(mockStatement_6))));
+
     auto mockStatement_4 { std::make_unique<MockStatement>() };
     EXPECT_CALL(*mockStatement_4,
                 step())
     .WillOnce(Return(0));
+    // The inserted rows join the generation following the stored ones.
+    EXPECT_CALL(*mockStatement_4, bind(1, TypedEq<int64_t>(8))).Times(1);
 
     EXPECT_CALL(*mockFactory,
-                createStatement(_, "UPDATE dummy SET db_status_field_dm=0;"))
+                createStatement(_, "UPDATE dummy SET db_status_field_dm=? WHERE db_status_field_dm=1;"))
     .WillOnce(Return(ByMove(std::move(mockStatement_4))));
 
     EXPECT_NO_THROW(spEngine->initializeStatusField(std::vector<std::string> {"dummy"}));
@@ -424,12 +471,114 @@ TEST_F(DBEngineTest, DeleteRowsByStatusField)
     .WillOnce(Return(0));
 
     EXPECT_CALL(*mockFactory,
-                createStatement(_, "DELETE FROM dummy WHERE db_status_field_dm=0;"))
+                createStatement(_, "DELETE FROM dummy WHERE db_status_field_dm<? AND db_status_field_dm<>1;"))
     .WillOnce(Return(ByMove(std::move(mockStatement_3))));
 
     EXPECT_NO_THROW(spEngine->deleteRowsByStatusField(std::vector<std::string> {"dummy"}));
 }
 
+TEST_F(DBEngineTest, StatementCacheHitsAndMisses)
+{
+    const auto& mockFactory { std::make_shared<MockSQLiteFactory>() };
+    const auto& mockConnection { std::make_shared<MockConnection>() };
+
+    auto mockTransaction { std::make_unique<MockTransaction>() };
+
+    EXPECT_CALL(*mockFactory, createConnection(_))
+    .WillOnce(Return(mockConnection));
+    EXPECT_CALL(*mockFactory, createTransaction(_))
+    .WillOnce(Return(ByMove(std::move(mockTransaction))));
+
+    auto mockStatement_1 { std::make_unique<MockStatement>() };
+    EXPECT_CALL(*mockStatement_1, step())
+    .WillOnce(Return(SQLITE_DONE));
+    EXPECT_CALL(*mockFactory,
+                createStatement(_, "NNN"))
+    .WillOnce(Return(ByMove(std::move(mockStatement_1))));
+
+    EXPECT_CALL(*mockConnection, execute("PRAGMA temp_store = memory;")).Times(1);
+    EXPECT_CALL(*mockConnection, execute("PRAGMA journal_mode = truncate;")).Times(1);
+    EXPECT_CALL(*mockConnection, execute("PRAGMA synchronous = OFF;")).Times(1);
+    EXPECT_CALL(*mockConnection, changes()).Times(2)
+    .WillRepeatedly(Return(1));
+
+    std::unique_ptr<SQLiteDBEngine> spEngine;
+    EXPECT_NO_THROW(spEngine = std::make_unique<SQLiteDBEngine>(
+                                   mockFactory,
+                                   "1",
+                                   "NNN"));
+
+    auto mockColumn_1 { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumn_1, value(An<const int32_t&>()))
+    .WillOnce(Return(0));
+    auto mockColumn_2 { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumn_2, value(An<const std::string&>()))
+    .WillOnce(Return("PID"));
+    auto mockColumn_3 { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumn_3, value(An<const std::string&>()))
+    .WillOnce(Return("INTEGER"));
+    auto mockColumn_4 { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumn_4, value(An<const int32_t&>()))
+    .WillOnce(Return(1));
+
+    auto mockColumn_5 { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumn_5, value(An<const int32_t&>()))
+    .WillOnce(Return(0));
+    auto mockColumn_6 { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumn_6, value(An<const std::string&>()))
+    .WillOnce(Return(STATUS_FIELD_NAME));
+    auto mockColumn_7 { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumn_7, value(An<const std::string&>()))
+    .WillOnce(Return(STATUS_FIELD_TYPE));
+    auto mockColumn_8 { std::make_unique<MockColumn>() };
+    EXPECT_CALL(*mockColumn_8, value(An<const int32_t&>()))
+    .WillOnce(Return(1));
+
+    auto mockStatement_2 { std::make_unique<MockStatement>() };
+    EXPECT_CALL(*mockStatement_2, step())
+    .WillOnce(Return(SQLITE_ROW))
+    .WillOnce(Return(SQLITE_ROW))
+    .WillOnce(Return(SQLITE_DONE));
+    EXPECT_CALL(*mockStatement_2, column(0))
+    .WillOnce(Return(ByMove(std::move(mockColumn_1))))
+    .WillOnce(Return(ByMove(std::move(mockColumn_5))));
+    EXPECT_CALL(*mockStatement_2, column(1))
+    .WillOnce(Return(ByMove(std::move(mockColumn_2))))
+    .WillOnce(Return(ByMove(std::move(mockColumn_6))));
+    EXPECT_CALL(*mockStatement_2, column(2))
+    .WillOnce(Return(ByMove(std::move(mockColumn_3))))
+    .WillOnce(Return(ByMove(std::move(mockColumn_7))));
+    EXPECT_CALL(*mockStatement_2, column(5))
+    .WillOnce(Return(ByMove(std::move(mockColumn_4))))
+    .WillOnce(Return(ByMove(std::move(mockColumn_8))));
+    EXPECT_CALL(*mockFactory,
+                createStatement(_, "PRAGMA table_info(dummy);"))
+    .WillOnce(Return(ByMove(std::move(mockStatement_2))));
+
+    auto mockStatement_3 { std::make_unique<MockStatement>() };
+    EXPECT_CALL(*mockStatement_3,
+                step())
+    .Times(2)
+    .WillRepeatedly(Return(0));
+    EXPECT_CALL(*mockStatement_3, reset()).Times(1);
+
+    EXPECT_CALL(*mockFactory,
+                createStatement(_, "DELETE FROM dummy WHERE db_status_field_dm<? AND db_status_field_dm<>1;"))
+    .WillOnce(Return(ByMove(std::move(mockStatement_3))));
+
+    const auto initialStats { spEngine->statementCacheStats() };
+    EXPECT_EQ(1u, initialStats.misses);
+    EXPECT_EQ(0u, initialStats.hits);
+
+    EXPECT_NO_THROW(spEngine->deleteRowsByStatusField(std::vector<std::string> {"dummy"}));
+    EXPECT_NO_THROW(spEngine->deleteRowsByStatusField(std::vector<std::string> {"dummy"}));
+
+    const auto stats { spEngine->statementCacheStats() };
+    EXPECT_EQ(2u, stats.misses);
+    EXPECT_EQ(1u, stats.hits);
+    EXPECT_EQ(0u, stats.evictions);
+}
+
 TEST_F(DBEngineTest, DeleteRowsByStatusFieldNoMetadata)
 {
     const auto& mockFactory { std::make_shared<MockSQLiteFactory>() };
@@ -603,7 +752,7 @@ TEST_F(DBEngineTest, GetRowsToBeDeletedByStatusField)
     .WillOnce(Return(ByMove(std::move(mockColumn_9))));
 
     EXPECT_CALL(*mockFactory,
-                createStatement(_, "SELECT PID FROM dummy WHERE db_status_field_dm=0;"))
+                createStatement(_, "SELECT PID FROM dummy WHERE db_status_field_dm<? AND db_status_field_dm<>1;"))
     .WillOnce(Return(ByMove(std::move(mockStatement_3))));
 
     std::shared_timed_mutex mutex;
@@ -9,6 +9,7 @@
  * Foundation.
  */
 
+#include <fstream>
 #include <iostream>
 #include "json.hpp"
 #include "dbsync_test.h"
@@ -85,6 +86,353 @@ TEST_F(DBSyncTest, InitializationNullptr)
     ASSERT_EQ(nullptr, handle_2);
 }
 
+TEST_F(DBSyncTest, InitializationWithTuning)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsTuning{ cJSON_Parse(R"({"profile":"memory-heavy","cache_size":-4096,"synchronous":"NORMAL"})") };
+
+    const auto handle { dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, jsTuning.get()) };
+    ASSERT_NE(nullptr, handle);
+
+    cJSON* jsResult { nullptr };
+    ASSERT_EQ(0, dbsync_get_tuning_info(handle, &jsResult));
+    const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{ cJSON_PrintUnformatted(jsResult) };
+    const auto info = nlohmann::json::parse(spJsonBytes.get());
+    dbsync_free_result(&jsResult);
+
+    EXPECT_EQ("memory", info.at("journal_mode").get<std::string>());
+    EXPECT_EQ(1, info.at("synchronous").get<int64_t>());
+    EXPECT_EQ(-4096, info.at("cache_size").get<int64_t>());
+    EXPECT_EQ(2, info.at("temp_store").get<int64_t>());
+
+    EXPECT_NE(0, dbsync_get_tuning_info(nullptr, &jsResult));
+    EXPECT_NE(0, dbsync_get_tuning_info(handle, nullptr));
+}
+
+TEST_F(DBSyncTest, InitializationWithInvalidTuning)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsUnknownProfile{ cJSON_Parse(R"({"profile":"dummy"})") };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsUnknownPragma{ cJSON_Parse(R"({"locking_mode":"EXCLUSIVE"})") };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInvalidValue{ cJSON_Parse(R"({"journal_mode":"WAL; DROP TABLE processes"})") };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInvalidType{ cJSON_Parse(R"({"mmap_size":"big"})") };
+
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, jsUnknownProfile.get()));
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, jsUnknownPragma.get()));
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, jsInvalidValue.get()));
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, jsInvalidType.get()));
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, nullptr));
+}
+
+TEST_F(DBSyncTest, InitializationWithInvalidReadConnections)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsReadConnections{ cJSON_Parse(R"({"read_connections":2})") };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInvalidJournal{ cJSON_Parse(R"({"read_connections":2,"journal_mode":"truncate"})") };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInvalidCount{ cJSON_Parse(R"({"read_connections":-1})") };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInvalidType{ cJSON_Parse(R"({"read_connections":"2"})") };
+
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_MEMORY, sql, jsReadConnections.get()));
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, jsInvalidJournal.get()));
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, jsInvalidCount.get()));
+    EXPECT_EQ(nullptr, dbsync_create_with_tuning(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, jsInvalidType.get()));
+}
+
+TEST_F(DBSyncTest, SelectRowsWithReadConnectionsCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto tables{ R"({"table": "processes"})" };
+    std::unique_ptr<DBSync> dbSync;
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql,
+                                                      nlohmann::json::parse(R"({"profile":"ssd","read_connections":2})")));
+
+    nlohmann::json info;
+    EXPECT_NO_THROW(dbSync->getTuningInfo(info));
+    EXPECT_EQ("wal", info.at("journal_mode").get<std::string>());
+
+    auto insertQuery{ InsertQuery::builder().table("processes").data({{"pid", 4}, {"name", "System"}}).build() };
+    auto selectQuery{ SelectQuery::builder().table("processes").columnList({"pid"}).orderByOpt("pid").countOpt(100).build() };
+
+    std::vector<int64_t> selectedPids;
+    ResultCallbackData selectCallbackData
+    {
+        [&selectedPids](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            EXPECT_EQ(SELECTED, type);
+            selectedPids.push_back(jsonResult.at("pid").get<int64_t>());
+        }
+    };
+    ResultCallbackData txnCallbackData
+    {
+        [](ReturnTypeCallback, const nlohmann::json&)
+        {
+        }
+    };
+    const auto selectPids
+    {
+        [&]()
+        {
+            selectedPids.clear();
+            EXPECT_NO_THROW(dbSync->selectRows(selectQuery.query(), selectCallbackData));
+            return selectedPids;
+        }
+    };
+
+    EXPECT_NO_THROW(dbSync->insertData(insertQuery.query()));
+    EXPECT_EQ(std::vector<int64_t>({4}), selectPids());
+
+    std::unique_ptr<DBSyncTxn> dbSyncTxn;
+    EXPECT_NO_THROW(dbSyncTxn = std::make_unique<DBSyncTxn>(dbSync->handle(), nlohmann::json::parse(tables), 0, 100, txnCallbackData));
+    EXPECT_NO_THROW(dbSyncTxn->syncTxnRow(nlohmann::json::parse(R"({"table":"processes","data":[{"pid":7,"name":"Guake"}]})")));
+
+    // The rows of an open transaction aren't visible to the readers.
+    EXPECT_EQ(std::vector<int64_t>({4}), selectPids());
+
+    EXPECT_NO_THROW(dbSyncTxn->getDeletedRows(txnCallbackData));
+    EXPECT_EQ(std::vector<int64_t>({4, 7}), selectPids());
+
+    dbSyncTxn.reset();
+    EXPECT_EQ(std::vector<int64_t>({7}), selectPids());
+}
+
+TEST_F(DBSyncTest, SelectRowsViewCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, `cpu` DOUBLE, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+
+    for (const auto& tuning : { nlohmann::json::object(), nlohmann::json::parse(R"({"read_connections":1})") })
+    {
+        std::unique_ptr<DBSync> dbSync;
+        EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql, tuning));
+        EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("processes").data({{"pid", 4}, {"name", "System"}, {"cpu", 1.5}}).build().query()));
+        EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("processes").data({{"pid", 7}}).build().query()));
+
+        auto selectQuery{ SelectQuery::builder().table("processes").columnList({"pid", "name", "cpu"}).orderByOpt("pid").countOpt(100).build() };
+
+        std::vector<std::string> rows;
+        RowCallbackData rowCallbackData
+        {
+            [&rows](const DbSync::IRowView & row)
+            {
+                const auto pid { row.columnIndex("pid") };
+                const auto name { row.columnIndex("name") };
+                const auto cpu { row.columnIndex("cpu") };
+                EXPECT_EQ(-1, row.columnIndex("checksum"));
+                EXPECT_THROW(row.getInt64(3), DbSync::dbsync_error);
+
+                rows.push_back(std::to_string(row.getInt64(pid)) + ":" +
+                               (row.isNull(name) ? "null" : row.getString(name)) + ":" +
+                               (row.isNull(cpu) ? "null" : std::to_string(row.getDouble(cpu))));
+            }
+        };
+
+        EXPECT_NO_THROW(dbSync->selectRows(selectQuery.query(), rowCallbackData));
+        EXPECT_EQ(std::vector<std::string>({"4:System:1.500000", "7:null:null"}), rows);
+    }
+}
+
+TEST_F(DBSyncTest, ShardedTablesCPP)
+{
+    const auto sql
+    {
+        "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"
+        "CREATE TABLE file_entry(`path` TEXT, `inode` BIGINT, PRIMARY KEY (`path`)) WITHOUT ROWID;"
+        "CREATE INDEX IF NOT EXISTS inode_index ON file_entry(`inode`);"
+        "CREATE TABLE registry_key(`path` TEXT, PRIMARY KEY (`path`)) WITHOUT ROWID;"
+        "CREATE TABLE registry_data(`path` TEXT, `name` TEXT, PRIMARY KEY (`path`, `name`)) WITHOUT ROWID;"
+    };
+    std::unique_ptr<DBSync> dbSync;
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql,
+                                                      nlohmann::json::parse(R"({"profile":"ssd","shards":{"fim":["file_entry"],"registry":["registry_key","registry_data"]}})")));
+
+    // Each shard gets its own database file next to the main one.
+    EXPECT_TRUE(std::ifstream("TEMP.fim.db").good());
+    EXPECT_TRUE(std::ifstream("TEMP.registry.db").good());
+
+    EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("processes").data({{"pid", 4}, {"name", "System"}}).build().query()));
+    EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("processes").data({{"pid", 7}, {"name", "Guake"}}).build().query()));
+    EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("file_entry").data({{"path", "/bin/sh"}, {"inode", 7}}).build().query()));
+    EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("registry_key").data({{"path", "HKLM"}}).build().query()));
+    EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("registry_data").data({{"path", "HKLM"}, {"name", "value"}}).build().query()));
+
+    // The queries may reference the tables of the other shards.
+    std::vector<int64_t> selectedPids;
+    ResultCallbackData selectCallbackData
+    {
+        [&selectedPids](ReturnTypeCallback, const nlohmann::json & jsonResult)
+        {
+            selectedPids.push_back(jsonResult.at("pid").get<int64_t>());
+        }
+    };
+    auto selectQuery
+    {
+        SelectQuery::builder().table("processes").columnList({"pid"}).rowFilter("WHERE pid IN (SELECT inode FROM file_entry)").countOpt(100).build()
+    };
+    EXPECT_NO_THROW(dbSync->selectRows(selectQuery.query(), selectCallbackData));
+    EXPECT_EQ(std::vector<int64_t>({7}), selectedPids);
+
+    const auto relationship
+    {
+        [](const std::string & baseTable, const std::string & relatedTable)
+        {
+            return nlohmann::json
+            {
+                {"base_table", baseTable},
+                {"relationed_tables", {{{"table", relatedTable}, {"field_match", {{"path", "path"}}}}}}
+            };
+        }
+    };
+    EXPECT_NO_THROW(dbSync->addTableRelationship(relationship("registry_key", "registry_data")));
+    EXPECT_THROW(dbSync->addTableRelationship(relationship("file_entry", "registry_data")), DbSync::dbsync_error);
+
+    ResultCallbackData txnCallbackData
+    {
+        [](ReturnTypeCallback, const nlohmann::json&)
+        {
+        }
+    };
+    std::unique_ptr<DBSyncTxn> dbSyncTxn;
+    EXPECT_NO_THROW(dbSyncTxn = std::make_unique<DBSyncTxn>(dbSync->handle(), nlohmann::json::parse(R"(["file_entry", "registry_key"])"), 0, 100, txnCallbackData));
+    EXPECT_NO_THROW(dbSyncTxn->syncTxnRow(nlohmann::json::parse(R"({"table":"file_entry","data":[{"path":"/bin/sh","inode":7}]})")));
+    EXPECT_NO_THROW(dbSyncTxn->getDeletedRows(txnCallbackData));
+    dbSyncTxn.reset();
+
+    // The registry key wasn't seen by the transaction, its data goes away with it.
+    std::vector<std::string> registryData;
+    ResultCallbackData registryCallbackData
+    {
+        [&registryData](ReturnTypeCallback, const nlohmann::json & jsonResult)
+        {
+            registryData.push_back(jsonResult.at("name").get<std::string>());
+        }
+    };
+    EXPECT_NO_THROW(dbSync->selectRows(SelectQuery::builder().table("registry_data").columnList({"name"}).countOpt(100).build().query(), registryCallbackData));
+    EXPECT_TRUE(registryData.empty());
+
+    selectedPids.clear();
+    EXPECT_NO_THROW(dbSync->selectRows(selectQuery.query(), selectCallbackData));
+    EXPECT_EQ(std::vector<int64_t>({7}), selectedPids);
+
+    EXPECT_THROW(std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql,
+                                          nlohmann::json::parse(R"({"shards":{"fim":["file_entry"],"registry":["file_entry"]}})")),
+                 DbSync::dbsync_error);
+    EXPECT_THROW(std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql,
+                                          nlohmann::json::parse(R"({"shards":{"fim db":["file_entry"]}})")),
+                 DbSync::dbsync_error);
+}
+
+TEST_F(DBSyncTest, InitializationWithTuningCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    std::unique_ptr<DBSync> dbSync;
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql,
+                                                      nlohmann::json::parse(R"({"profile":"ssd","page_size":8192})")));
+
+    nlohmann::json info;
+    EXPECT_NO_THROW(dbSync->getTuningInfo(info));
+    EXPECT_EQ("wal", info.at("journal_mode").get<std::string>());
+    EXPECT_EQ(8192, info.at("page_size").get<int64_t>());
+    EXPECT_EQ(1, info.at("synchronous").get<int64_t>());
+}
+
+TEST_F(DBSyncTest, BackupAndRestoreCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto tables{ R"({"table": "processes"})" };
+    constexpr auto SNAPSHOT_PATH { "SNAPSHOT.db" };
+    std::remove(SNAPSHOT_PATH);
+
+    ResultCallbackData txnCallbackData
+    {
+        [](ReturnTypeCallback, const nlohmann::json&)
+        {
+        }
+    };
+
+    {
+        std::unique_ptr<DBSync> dbSync;
+        EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_MEMORY, sql));
+        EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("processes").data({{"pid", 4}, {"name", "System"}}).build().query()));
+
+        // The transactions add their internal column to the tables.
+        auto dbSyncTxn { std::make_unique<DBSyncTxn>(dbSync->handle(), nlohmann::json::parse(tables), 0, 100, txnCallbackData) };
+        EXPECT_NO_THROW(dbSyncTxn->syncTxnRow(nlohmann::json::parse(R"({"table":"processes","data":[{"pid":7,"name":"Guake"}]})")));
+        EXPECT_NO_THROW(dbSyncTxn->syncTxnRow(nlohmann::json::parse(R"({"table":"processes","data":[{"pid":4,"name":"System"}]})")));
+        dbSyncTxn.reset();
+
+        EXPECT_NO_THROW(dbSync->backup(SNAPSHOT_PATH));
+    }
+
+    struct stat stStat {};
+    ASSERT_EQ(0, stat(SNAPSHOT_PATH, &stStat));
+    EXPECT_EQ(DATABASE_PERMISSIONS, stStat.st_mode & 0777u);
+
+    std::unique_ptr<DBSync> dbSync;
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_MEMORY, sql));
+    EXPECT_NO_THROW(dbSync->setTableMaxRow("processes", 3));
+    EXPECT_NO_THROW(dbSync->restore(SNAPSHOT_PATH));
+
+    std::vector<int64_t> selectedPids;
+    ResultCallbackData selectCallbackData
+    {
+        [&selectedPids](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            EXPECT_EQ(SELECTED, type);
+            selectedPids.push_back(jsonResult.at("pid").get<int64_t>());
+        }
+    };
+    auto selectQuery{ SelectQuery::builder().table("processes").columnList({"pid"}).orderByOpt("pid").countOpt(100).build() };
+    EXPECT_NO_THROW(dbSync->selectRows(selectQuery.query(), selectCallbackData));
+    EXPECT_EQ(std::vector<int64_t>({4, 7}), selectedPids);
+
+    // The row limit counts the restored rows.
+    EXPECT_NO_THROW(dbSync->insertData(InsertQuery::builder().table("processes").data({{"pid", 8}, {"name", "Bash"}}).build().query()));
+    EXPECT_ANY_THROW(dbSync->insertData(InsertQuery::builder().table("processes").data({{"pid", 9}, {"name", "Zsh"}}).build().query()));
+
+    // The restored tables are synced as usual.
+    std::vector<ReturnTypeCallback> results;
+    ResultCallbackData resultsCallbackData
+    {
+        [&results](ReturnTypeCallback type, const nlohmann::json&)
+        {
+            results.push_back(type);
+        }
+    };
+    auto dbSyncTxn { std::make_unique<DBSyncTxn>(dbSync->handle(), nlohmann::json::parse(tables), 0, 100, resultsCallbackData) };
+    EXPECT_NO_THROW(dbSyncTxn->syncTxnRow(nlohmann::json::parse(R"({"table":"processes","data":[{"pid":4,"name":"System"}]})")));
+    EXPECT_NO_THROW(dbSyncTxn->getDeletedRows(resultsCallbackData));
+    EXPECT_EQ(std::vector<ReturnTypeCallback>({DELETED, DELETED}), results);
+
+    std::remove(SNAPSHOT_PATH);
+}
+
+TEST_F(DBSyncTest, RestoreInvalidSnapshot)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto otherSql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, `cmd` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    constexpr auto SNAPSHOT_PATH { "SNAPSHOT.db" };
+    std::remove(SNAPSHOT_PATH);
+
+    const auto handle { dbsync_create(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_MEMORY, sql) };
+    ASSERT_NE(nullptr, handle);
+
+    EXPECT_NE(0, dbsync_restore(handle, SNAPSHOT_PATH));
+    EXPECT_NE(0, dbsync_restore(handle, nullptr));
+    EXPECT_NE(0, dbsync_backup(nullptr, SNAPSHOT_PATH));
+
+    {
+        DBSync otherDbSync{ HostType::AGENT, DbEngineType::SQLITE3, DATABASE_MEMORY, otherSql };
+        EXPECT_NO_THROW(otherDbSync.backup(SNAPSHOT_PATH));
+    }
+
+    // A snapshot with other columns is refused, the database is kept.
+    EXPECT_NE(0, dbsync_restore(handle, SNAPSHOT_PATH));
+
+    EXPECT_EQ(0, dbsync_backup(handle, SNAPSHOT_PATH));
+    EXPECT_EQ(0, dbsync_restore(handle, SNAPSHOT_PATH));
+
+    std::remove(SNAPSHOT_PATH);
+}
+
 TEST_F(DBSyncTest, InitializationWithInvalidSqlStmt)
 {
     const auto sqlWithoutTable{ "CREATE TABLE (`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
@@ -140,6 +488,13 @@ TEST_F(DBSyncTest, syncTxnRowNullptr)
     ASSERT_NE(0, dbsync_sync_txn_row(nullptr, jsInsert1.get()));
 }
 
+TEST_F(DBSyncTest, syncTxnRowsNullptr)
+{
+    const auto insertionSqlStmt1{ R"({"table":"processes","data":[{"pid":7,"name":"Guake"},{"pid":8,"name":"Bash"}]})"}; // Insert
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInsert1{ cJSON_Parse(insertionSqlStmt1) };
+    ASSERT_NE(0, dbsync_sync_txn_rows(nullptr, jsInsert1.get()));
+}
+
 TEST_F(DBSyncTest, closeTxnNullptr)
 {
     ASSERT_NE(0, dbsync_close_txn(nullptr));
@@ -317,6 +672,75 @@ TEST_F(DBSyncTest, InsertMoreCompleteData)
     EXPECT_EQ(0, dbsync_insert_data(handle, jsInsert.get()));
 }
 
+TEST_F(DBSyncTest, InsertDataBatchedCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, `tid` BIGINT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    std::unique_ptr<DBSync> dbSync;
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql));
+
+    // More rows than a single multi-row statement holds, with a change of columns in the middle.
+    nlohmann::json insertQuery;
+    insertQuery["table"] = "processes";
+
+    for (auto pid = 0; pid < 150; ++pid)
+    {
+        insertQuery["data"].push_back(50 == pid ? nlohmann::json {{"pid", pid}, {"name", "System"}}
+                                      : nlohmann::json {{"pid", pid}, {"name", "System"}, {"tid", pid}});
+    }
+
+    auto selectQuery{ SelectQuery::builder().table("processes").columnList({"pid"}).countOpt(1000).build() };
+    auto selectedRows { 0 };
+    ResultCallbackData callbackData
+    {
+        [&selectedRows](ReturnTypeCallback, const nlohmann::json&)
+        {
+            ++selectedRows;
+        }
+    };
+
+    EXPECT_NO_THROW(dbSync->insertData(insertQuery));
+    EXPECT_NO_THROW(dbSync->selectRows(selectQuery.query(), callbackData));
+    EXPECT_EQ(150, selectedRows);
+}
+
+TEST_F(DBSyncTest, UpsertDataCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    std::unique_ptr<DBSync> dbSync;
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql));
+    EXPECT_NO_THROW(dbSync->setTableMaxRow("processes", 2));
+
+    auto insertQuery{ InsertQuery::builder().table("processes").data({{"pid", 4}, {"name", "System"}}).build() };
+    auto upsertQuery
+    {
+        InsertQuery::builder()
+        .table("processes")
+        .data({{"pid", 4}, {"name", "System1"}})
+        .data({{"pid", 5}, {"name", "System2"}})
+        .upsert()
+        .build()
+    };
+    auto selectQuery{ SelectQuery::builder().table("processes").columnList({"pid", "name"}).orderByOpt("pid").countOpt(100).build() };
+
+    CallbackMock wrapper;
+    EXPECT_CALL(wrapper, callbackMock(SELECTED, nlohmann::json::parse(R"({"name":"System1","pid":4})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(SELECTED, nlohmann::json::parse(R"({"name":"System2","pid":5})"))).Times(1);
+
+    ResultCallbackData callbackData
+    {
+        [&wrapper](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            wrapper.callbackMock(type, jsonResult);
+        }
+    };
+
+    EXPECT_NO_THROW(dbSync->insertData(insertQuery.query()));
+    // The existing row doesn't count against the max rows.
+    EXPECT_NO_THROW(dbSync->insertData(upsertQuery.query()));
+    EXPECT_ANY_THROW(dbSync->insertData(insertQuery.query()));
+    EXPECT_NO_THROW(dbSync->selectRows(selectQuery.query(), callbackData));
+}
+
 TEST_F(DBSyncTest, InsertDataWithWrongColumnType)
 {
     const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, `threads` INTEGER, `cpu_usage` DOUBLE, `blob` BLOB, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
@@ -766,6 +1190,38 @@ TEST_F(DBSyncTest, syncRowInsertAndModifiedWithOldData)
     EXPECT_EQ(0, dbsync_sync_row(handle, jsUpdate2.get(), callbackData));  // Expect a modified event
 }
 
+TEST_F(DBSyncTest, syncRowTypedComparisonWithOldData)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, `size` UNSIGNED BIGINT, `nice` INTEGER, `load` DOUBLE, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto handle { dbsync_create(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql) };
+    ASSERT_NE(nullptr, handle);
+
+    CallbackMock wrapper;
+    callback_data_t callbackData { callback, &wrapper };
+
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"pid":4,"name":"System","size":100,"nice":-1,"load":2.0})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(MODIFIED, nlohmann::json::parse(R"({"new":{"name":"Systemmm","pid":4,"size":100,"nice":-1,"load":2},"old":{"name":"System","pid":4}})"))).Times(1);
+
+    auto insertionQuery = SyncRowQuery::builder().table("processes")
+                          .data(nlohmann::json::parse(R"({"pid":4,"name":"System","size":100,"nice":-1,"load":2.0})"));
+    // Same values using a different JSON numeric representation, no diff expected.
+    auto updateQuery1 = SyncRowQuery::builder().table("processes")
+                        .returnOldData()
+                        .data(nlohmann::json::parse(R"({"pid":4,"name":"System","size":100.0,"nice":-1,"load":2})"));
+    // Only the modified column is reported as old data.
+    auto updateQuery2 = SyncRowQuery::builder().table("processes")
+                        .returnOldData()
+                        .data(nlohmann::json::parse(R"({"pid":4,"name":"Systemmm","size":100,"nice":-1,"load":2})"));
+
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInsert{ cJSON_Parse(insertionQuery.query().dump().c_str()) };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsUpdate1{ cJSON_Parse(updateQuery1.query().dump().c_str()) };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsUpdate2{ cJSON_Parse(updateQuery2.query().dump().c_str()) };
+
+    EXPECT_EQ(0, dbsync_sync_row(handle, jsInsert.get(), callbackData));   // Expect an insert event
+    EXPECT_EQ(0, dbsync_sync_row(handle, jsUpdate1.get(), callbackData));  // No event expected
+    EXPECT_EQ(0, dbsync_sync_row(handle, jsUpdate2.get(), callbackData));  // Expect a modified event
+}
+
 TEST_F(DBSyncTest, syncRowIgnoreFields)
 {
     const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, `tid` BIGINT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
@@ -2051,6 +2507,63 @@ TEST_F(DBSyncTest, UpdateDataCPP)
     EXPECT_NO_THROW(dbSync->updateWithSnapshot(nlohmann::json::parse(insertionSqlStmt2), callbackData));
 }
 
+TEST_F(DBSyncTest, UpdateDataSortedSnapshotCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, `tid` BIGINT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto insertionSqlStmt{ R"({"table":"processes","data":[{"pid":4,"name":"System","tid":100},{"pid":7,"name":"Guake","tid":101},{"pid":5,"name":"cmd","tid":102}]})"};
+    const auto snapshotSqlStmt{ R"({"table":"processes","options":{"sorted":true},"data":[{"pid":3,"name":"bash","tid":103},{"pid":4,"name":"System","tid":100},{"pid":5,"name":"cmd2","tid":102},{"pid":8,"name":"ssh","tid":104}]})"};
+
+    std::unique_ptr<DBSync> dbSync;
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql));
+    EXPECT_NO_THROW(dbSync->insertData(nlohmann::json::parse(insertionSqlStmt)));
+
+    CallbackMock wrapper;
+    EXPECT_CALL(wrapper, callbackMock(DELETED, nlohmann::json::parse(R"({"pid":7})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(MODIFIED, nlohmann::json::parse(R"({"PK_pid":5,"name":"cmd2"})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"pid":3,"name":"bash","tid":103})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"pid":8,"name":"ssh","tid":104})"))).Times(1);
+
+    ResultCallbackData callbackData
+    {
+        [&wrapper](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            wrapper.callbackMock(type, jsonResult);
+        }
+    };
+
+    EXPECT_NO_THROW(dbSync->updateWithSnapshot(nlohmann::json::parse(snapshotSqlStmt), callbackData));
+
+    nlohmann::json jsResponse;
+    EXPECT_NO_THROW(dbSync->updateWithSnapshot(nlohmann::json::parse(snapshotSqlStmt), jsResponse));
+    EXPECT_TRUE(jsResponse.empty());
+}
+
+TEST_F(DBSyncTest, UpdateDataUnsortedSnapshotCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto insertionSqlStmt{ R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":7,"name":"Guake"}]})"};
+    // Not sorted by primary key, so the temp table path is used.
+    const auto snapshotSqlStmt{ R"({"table":"processes","options":{"sorted":true},"data":[{"pid":5,"name":"cmd"},{"pid":4,"name":"System"}]})"};
+
+    std::unique_ptr<DBSync> dbSync;
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql));
+    EXPECT_NO_THROW(dbSync->insertData(nlohmann::json::parse(insertionSqlStmt)));
+
+    CallbackMock wrapper;
+    EXPECT_CALL(wrapper, callbackMock(DELETED, nlohmann::json::parse(R"({"pid":7})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"pid":5,"name":"cmd"})"))).Times(1);
+
+    ResultCallbackData callbackData
+    {
+        [&wrapper](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            wrapper.callbackMock(type, jsonResult);
+        }
+    };
+
+    EXPECT_NO_THROW(dbSync->updateWithSnapshot(nlohmann::json::parse(snapshotSqlStmt), callbackData));
+}
+
 TEST_F(DBSyncTest, constructorWithHandle)
 {
     const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
@@ -2310,3 +2823,276 @@ TEST_F(DBSyncTest, InitializationCPP)
     EXPECT_EQ(DATABASE_PERMISSIONS, stStat.st_mode & 0777);
 #endif
 }
+
+TEST_F(DBSyncTest, syncTxnRows)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto tables { R"({"table": "processes"})" };
+    const auto handle { dbsync_create(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql) };
+    ASSERT_NE(nullptr, handle);
+
+    CallbackMock wrapper;
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"System","pid":4})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Init","pid":5})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Old","pid":6})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(MODIFIED, nlohmann::json::parse(R"({"name":"Init2","pid":5})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Guake","pid":7})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(DELETED, nlohmann::json::parse(R"({"name":"Old","pid":6})"))).Times(1);
+
+    callback_data_t callbackData { callback, &wrapper };
+
+    const auto insertionSqlStmt1{ R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":5,"name":"Init"},{"pid":6,"name":"Old"}]})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInsert1{ cJSON_Parse(insertionSqlStmt1) };
+    EXPECT_EQ(0, dbsync_sync_row(handle, jsInsert1.get(), callbackData));
+
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsonTables { cJSON_Parse(tables) };
+    const auto txn { dbsync_create_txn(handle, jsonTables.get(), 0, 100, callbackData) };
+    ASSERT_NE(nullptr, txn);
+
+    // Unchanged, modified and new rows in the same batch.
+    const auto syncSqlStmt{ R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":5,"name":"Init2"},{"pid":7,"name":"Guake"}]})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsSync{ cJSON_Parse(syncSqlStmt) };
+    EXPECT_EQ(0, dbsync_sync_txn_rows(txn, jsSync.get()));
+
+    EXPECT_EQ(0, dbsync_get_deleted_rows(txn, callbackData));
+    EXPECT_EQ(0, dbsync_close_txn(txn));
+}
+
+TEST_F(DBSyncTest, keepTxnRowsNullptr)
+{
+    const auto keepSqlStmt{ R"({"table":"processes","data":[{"pid":7,"name":"Guake"}]})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsKeep{ cJSON_Parse(keepSqlStmt) };
+    ASSERT_NE(0, dbsync_keep_txn_rows(nullptr, jsKeep.get()));
+}
+
+TEST_F(DBSyncTest, keepTxnRows)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto tables { R"({"table": "processes"})" };
+    const auto handle { dbsync_create(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql) };
+    ASSERT_NE(nullptr, handle);
+
+    CallbackMock wrapper;
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"System","pid":4})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Init","pid":5})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Old","pid":6})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Guake","pid":7})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(DELETED, nlohmann::json::parse(R"({"name":"Old","pid":6})"))).Times(1);
+
+    callback_data_t callbackData { callback, &wrapper };
+
+    const auto insertionSqlStmt1{ R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":5,"name":"Init"},{"pid":6,"name":"Old"}]})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInsert1{ cJSON_Parse(insertionSqlStmt1) };
+    EXPECT_EQ(0, dbsync_sync_row(handle, jsInsert1.get(), callbackData));
+
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsonTables { cJSON_Parse(tables) };
+    const auto txn { dbsync_create_txn(handle, jsonTables.get(), 0, 100, callbackData) };
+    ASSERT_NE(nullptr, txn);
+
+    // Kept rows aren't compared (pid 5 isn't reported as modified), the ones not stored are inserted.
+    const auto keepSqlStmt{ R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":5,"name":"Init2"},{"pid":7,"name":"Guake"}]})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsKeep{ cJSON_Parse(keepSqlStmt) };
+    EXPECT_EQ(0, dbsync_keep_txn_rows(txn, jsKeep.get()));
+
+    EXPECT_EQ(0, dbsync_get_deleted_rows(txn, callbackData));
+    EXPECT_EQ(0, dbsync_close_txn(txn));
+}
+
+TEST_F(DBSyncTest, getDeletedRowsConsecutiveTxns)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto tables { R"({"table": "processes"})" };
+    const auto handle { dbsync_create(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql) };
+    ASSERT_NE(nullptr, handle);
+
+    CallbackMock wrapper;
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"System","pid":4})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Init","pid":5})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Old","pid":6})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Guake","pid":7})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(DELETED, nlohmann::json::parse(R"({"name":"System","pid":4})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(DELETED, nlohmann::json::parse(R"({"name":"Init","pid":5})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(DELETED, nlohmann::json::parse(R"({"name":"Old","pid":6})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(DELETED, nlohmann::json::parse(R"({"name":"Guake","pid":7})"))).Times(1);
+
+    callback_data_t callbackData { callback, &wrapper };
+
+    const auto insertionSqlStmt{ R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":5,"name":"Init"},{"pid":6,"name":"Old"}]})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInsert{ cJSON_Parse(insertionSqlStmt) };
+    EXPECT_EQ(0, dbsync_sync_row(handle, jsInsert.get(), callbackData));
+
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsonTables { cJSON_Parse(tables) };
+
+    // The rows seen are kept, the one inserted by the transaction too.
+    const auto syncSqlStmt1{ R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":7,"name":"Guake"}]})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsSync1{ cJSON_Parse(syncSqlStmt1) };
+    auto txn { dbsync_create_txn(handle, jsonTables.get(), 0, 100, callbackData) };
+    ASSERT_NE(nullptr, txn);
+    EXPECT_EQ(0, dbsync_sync_txn_row(txn, jsSync1.get()));
+    EXPECT_EQ(0, dbsync_get_deleted_rows(txn, callbackData));
+    EXPECT_EQ(0, dbsync_close_txn(txn));
+
+    // The rows seen by the previous transaction only are deleted by the next one.
+    const auto syncSqlStmt2{ R"({"table":"processes","data":[{"pid":7,"name":"Guake"}]})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsSync2{ cJSON_Parse(syncSqlStmt2) };
+    txn = dbsync_create_txn(handle, jsonTables.get(), 0, 100, callbackData);
+    ASSERT_NE(nullptr, txn);
+    EXPECT_EQ(0, dbsync_sync_txn_row(txn, jsSync2.get()));
+    EXPECT_EQ(0, dbsync_get_deleted_rows(txn, callbackData));
+    EXPECT_EQ(0, dbsync_close_txn(txn));
+
+    txn = dbsync_create_txn(handle, jsonTables.get(), 0, 100, callbackData);
+    ASSERT_NE(nullptr, txn);
+    EXPECT_EQ(0, dbsync_get_deleted_rows(txn, callbackData));
+    EXPECT_EQ(0, dbsync_close_txn(txn));
+
+    const auto selectSqlStmt{ R"({"table":"processes","query":{"column_list":["pid"],"row_filter":"","distinct_opt":false,"order_by_opt":"","count_opt":100}})"};
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> jsSelect{ cJSON_Parse(selectSqlStmt) };
+    CallbackMock selectWrapper;
+    EXPECT_CALL(selectWrapper, callbackMock(::testing::_, ::testing::_)).Times(0);
+    callback_data_t selectCallbackData { callback, &selectWrapper };
+    EXPECT_EQ(0, dbsync_select_rows(handle, jsSelect.get(), selectCallbackData));
+}
+
+TEST_F(DBSyncTest, syncTxnRowsCPP)
+{
+    constexpr auto sql
+    {
+        R"(CREATE TABLE processes (
+        pid BIGINT,
+        name TEXT,
+        state TEXT,
+        ppid BIGINT,
+        utime BIGINT,
+        stime BIGINT,
+        cmd TEXT,
+        argvs TEXT,
+        euser TEXT,
+        ruser TEXT,
+        suser TEXT,
+        egroup TEXT,
+        rgroup TEXT,
+        sgroup TEXT,
+        fgroup TEXT,
+        priority BIGINT,
+        nice BIGINT,
+        size BIGINT,
+        vm_size BIGINT,
+        resident BIGINT,
+        share BIGINT,
+        start_time BIGINT,
+        pgrp BIGINT,
+        session BIGINT,
+        nlwp BIGINT,
+        tgid BIGINT,
+        tty BIGINT,
+        processor BIGINT,
+        PRIMARY KEY (pid)) WITHOUT ROWID;)"
+    };
+    const auto tables { R"({"table": "processes"})" };
+    std::unique_ptr<DBSync> dbSync;
+
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql));
+    const auto& data1{nlohmann::json::parse(input1)};
+    const auto& data2{nlohmann::json::parse(input2)};
+    const auto& diffData{nlohmann::json::parse(diffResult)};
+    nlohmann::json insertionSqlStmt1;
+    insertionSqlStmt1["table"] = "processes";
+    insertionSqlStmt1["data"] = data1;
+    nlohmann::json insertionSqlStmt2;
+    insertionSqlStmt2["table"] = "processes";
+    insertionSqlStmt2["data"] = data2;
+
+    CallbackMock wrapper;
+
+    for (const auto& entry : data1)
+    {
+        EXPECT_CALL(wrapper, callbackMock(INSERTED, entry)).Times(1);
+    }
+
+    for (const auto& entry : diffData)
+    {
+        EXPECT_CALL(wrapper, callbackMock(MODIFIED, entry)).Times(1);
+    }
+
+    ResultCallbackData callbackData
+    {
+        [&wrapper](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            wrapper.callbackMock(type, jsonResult);
+        }
+    };
+    EXPECT_NO_THROW(dbSync->syncRow(insertionSqlStmt1, callbackData));
+
+    std::unique_ptr<DBSyncTxn> dbSyncTxn;
+    EXPECT_NO_THROW(dbSyncTxn = std::make_unique<DBSyncTxn>(dbSync->handle(), nlohmann::json::parse(tables), 0, 4096, callbackData));
+
+    // Same results as the row by row sync (createTxnCPP1).
+    EXPECT_NO_THROW(dbSyncTxn->syncTxnRows(insertionSqlStmt2));
+
+    EXPECT_NO_THROW(dbSyncTxn->getDeletedRows(callbackData));
+}
+
+TEST_F(DBSyncTest, syncTxnRowsWithMaxRowsCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto tables { R"({"table": "processes"})" };
+    std::unique_ptr<DBSync> dbSync;
+
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql));
+    EXPECT_NO_THROW(dbSync->setTableMaxRow("processes", 1));
+
+    CallbackMock wrapper;
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"System","pid":4})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(MAX_ROWS, nlohmann::json::parse(R"({"name":"Guake","pid":7})"))).Times(1);
+
+    ResultCallbackData callbackData
+    {
+        [&wrapper](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            wrapper.callbackMock(type, jsonResult);
+        }
+    };
+
+    std::unique_ptr<DBSyncTxn> dbSyncTxn;
+    EXPECT_NO_THROW(dbSyncTxn = std::make_unique<DBSyncTxn>(dbSync->handle(), nlohmann::json::parse(tables), 0, 100, callbackData));
+
+    const auto syncSqlStmt{ R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":7,"name":"Guake"}]})"};
+    EXPECT_NO_THROW(dbSyncTxn->syncTxnRows(nlohmann::json::parse(syncSqlStmt)));
+
+    EXPECT_NO_THROW(dbSyncTxn->getDeletedRows(callbackData));
+}
+
+TEST_F(DBSyncTest, syncTxnRowsBatchWithMaxRowsCPP)
+{
+    const auto sql{ "CREATE TABLE processes(`pid` BIGINT, `name` TEXT, PRIMARY KEY (`pid`)) WITHOUT ROWID;"};
+    const auto tables { R"({"table": "processes"})" };
+    std::unique_ptr<DBSync> dbSync;
+
+    EXPECT_NO_THROW(dbSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, DATABASE_TEMP, sql));
+    EXPECT_NO_THROW(dbSync->setTableMaxRow("processes", 3));
+
+    CallbackMock wrapper;
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"System","pid":4})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"Guake","pid":7})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(MODIFIED, nlohmann::json::parse(R"({"name":"Guake2","pid":7})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(INSERTED, nlohmann::json::parse(R"({"name":"htop","pid":9})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(MAX_ROWS, nlohmann::json::parse(R"({"name":"top","pid":10})"))).Times(1);
+    EXPECT_CALL(wrapper, callbackMock(MAX_ROWS, nlohmann::json::parse(R"({"name":"bash","pid":11})"))).Times(1);
+
+    ResultCallbackData callbackData
+    {
+        [&wrapper](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            wrapper.callbackMock(type, jsonResult);
+        }
+    };
+
+    std::unique_ptr<DBSyncTxn> dbSyncTxn;
+    EXPECT_NO_THROW(dbSyncTxn = std::make_unique<DBSyncTxn>(dbSync->handle(), nlohmann::json::parse(tables), 0, 100, callbackData));
+
+    // Batches that fit in the max rows are inserted at once, the others are rejected row by row.
+    EXPECT_NO_THROW(dbSyncTxn->syncTxnRows(nlohmann::json::parse(R"({"table":"processes","data":[{"pid":4,"name":"System"},{"pid":7,"name":"Guake"}]})")));
+    EXPECT_NO_THROW(dbSyncTxn->syncTxnRows(nlohmann::json::parse(R"({"table":"processes","data":[{"pid":7,"name":"Guake2"},{"pid":9,"name":"htop"}]})")));
+    EXPECT_NO_THROW(dbSyncTxn->syncTxnRows(nlohmann::json::parse(R"({"table":"processes","data":[{"pid":10,"name":"top"},{"pid":11,"name":"bash"}]})")));
+}
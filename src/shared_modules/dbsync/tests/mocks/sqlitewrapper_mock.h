@@ -37,6 +37,14 @@ class MockConnection : public SQLite::IConnection
                     db,
                     (),
                     (const override));
+        MOCK_METHOD(void,
+                    backup,
+                    (const std::string& path),
+                    (override));
+        MOCK_METHOD(void,
+                    restore,
+                    (const std::string& path),
+                    (override));
 
 };
 
@@ -36,6 +36,8 @@ class ConnectionWrapper: public IConnection
         MOCK_METHOD(void, close, (), (override));
         MOCK_METHOD(int64_t, changes, (), (const override));
         MOCK_METHOD((const std::shared_ptr<sqlite3>&), db, (), (const override));
+        MOCK_METHOD(void, backup, (const std::string&), (override));
+        MOCK_METHOD(void, restore, (const std::string&), (override));
 };
 
 
@@ -0,0 +1,538 @@
+/*
+ * Wazuh DBSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <json.hpp>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "dbsync.h"
+#include "dbsync.hpp"
+#include "benchmarkArgsHelper.h"
+
+constexpr auto SNAPSHOT_ITERATIONS
+{
+    3ull
+};
+
+constexpr auto MAX_SELECT_QUERIES
+{
+    10000ull
+};
+
+constexpr auto DELETE_BATCH_ROWS
+{
+    100ull
+};
+
+constexpr auto INSERT_BATCH_ROWS
+{
+    1000ull
+};
+
+struct Workload final
+{
+    std::string table;
+    std::string sqlStatement;
+    std::function<nlohmann::json(const size_t id, const size_t revision)> row;
+    std::function<nlohmann::json(const size_t id)> primaryKey;
+    std::function<std::string(const size_t id)> filter;
+};
+
+struct OperationResult final
+{
+    std::string workload;
+    size_t rows;
+    std::string operation;
+    size_t samples;
+    double throughput;
+    double p50;
+    double p99;
+    long peakRss;
+};
+
+static std::string filePath(const size_t id)
+{
+    return "/var/lib/benchmark/dir" + std::to_string(id % 1000) + "/file" + std::to_string(id);
+}
+
+static std::string packageName(const size_t id)
+{
+    return "package" + std::to_string(id);
+}
+
+static const std::map<std::string, Workload> WORKLOADS
+{
+    {
+        "fim",
+        {
+            "file_entry",
+            R"(CREATE TABLE file_entry (
+            path TEXT NOT NULL,
+            mode INTEGER,
+            last_event INTEGER,
+            scanned INTEGER,
+            options INTEGER,
+            checksum TEXT NOT NULL,
+            dev INTEGER,
+            inode INTEGER,
+            size INTEGER,
+            perm TEXT,
+            attributes TEXT,
+            uid TEXT,
+            gid TEXT,
+            user_name TEXT,
+            group_name TEXT,
+            hash_md5 TEXT,
+            hash_sha1 TEXT,
+            hash_sha256 TEXT,
+            mtime INTEGER,
+            PRIMARY KEY(path)) WITHOUT ROWID;)",
+            [](const size_t id, const size_t revision)
+            {
+                const auto hash { std::to_string(id * 31 + revision) };
+                return nlohmann::json
+                {
+                    {"path", filePath(id)}, {"mode", 0}, {"last_event", 1700000000 + revision}, {"scanned", 1},
+                    {"options", 131583}, {"checksum", "checksum" + hash}, {"dev", 2049}, {"inode", id},
+                    {"size", 4096 + revision}, {"perm", "rw-r--r--"}, {"attributes", ""}, {"uid", "0"},
+                    {"gid", "0"}, {"user_name", "root"}, {"group_name", "root"}, {"hash_md5", "md5" + hash},
+                    {"hash_sha1", "sha1" + hash}, {"hash_sha256", "sha256" + hash}, {"mtime", 1700000000 + revision}
+                };
+            },
+            [](const size_t id)
+            {
+                return nlohmann::json {{"path", filePath(id)}};
+            },
+            [](const size_t id)
+            {
+                return "WHERE path = '" + filePath(id) + "'";
+            }
+        }
+    },
+    {
+        "syscollector",
+        {
+            "dbsync_packages",
+            R"(CREATE TABLE dbsync_packages(
+            name TEXT,
+            version TEXT,
+            vendor TEXT,
+            install_time TEXT,
+            location TEXT,
+            architecture TEXT,
+            groups TEXT,
+            description TEXT,
+            size INTEGER,
+            priority TEXT,
+            multiarch TEXT,
+            source TEXT,
+            format TEXT,
+            checksum TEXT,
+            item_id TEXT,
+            PRIMARY KEY (name,version,architecture,format,location)) WITHOUT ROWID;)",
+            [](const size_t id, const size_t revision)
+            {
+                return nlohmann::json
+                {
+                    {"name", packageName(id)}, {"version", "1.0." + std::to_string(id % 100)}, {"vendor", "Wazuh"},
+                    {"install_time", std::to_string(1700000000 + revision)}, {"location", " "},
+                    {"architecture", "amd64"}, {"groups", "utils"}, {"description", "Benchmark package"},
+                    {"size", 1024 + revision}, {"priority", "optional"}, {"multiarch", "same"}, {"source", "benchmark"},
+                    {"format", "deb"}, {"checksum", "checksum" + std::to_string(id * 31 + revision)},
+                    {"item_id", "item" + std::to_string(id)}
+                };
+            },
+            [](const size_t id)
+            {
+                return nlohmann::json
+                {
+                    {"name", packageName(id)}, {"version", "1.0." + std::to_string(id % 100)},
+                    {"architecture", "amd64"}, {"format", "deb"}, {"location", " "}
+                };
+            },
+            [](const size_t id)
+            {
+                return "WHERE name = '" + packageName(id) + "'";
+            }
+        }
+    }
+};
+
+static long peakRss()
+{
+#ifndef _WIN32
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+class BenchmarkRunner final
+{
+    public:
+        BenchmarkRunner(const std::string& workloadName,
+                        const Workload& workload,
+                        const size_t rows,
+                        const std::string& dbPath)
+            : m_workloadName{ workloadName }
+            , m_workload{ workload }
+            , m_rows{ rows }
+            , m_revisions(rows, 0)
+            , m_dbSync{ std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, dbPath, workload.sqlStatement) }
+        {}
+
+        OperationResult syncRow()
+        {
+            std::vector<double> latencies;
+            latencies.reserve(m_rows);
+            ResultCallbackData callbackData { [](ReturnTypeCallback, const nlohmann::json&) {} };
+
+            for (size_t id = 0; id < m_rows; ++id)
+            {
+                const nlohmann::json input { {"table", m_workload.table}, {"data", nlohmann::json::array({ m_workload.row(id, 0) })} };
+                latencies.push_back(measure([&]()
+                {
+                    m_dbSync->syncRow(input, callbackData);
+                }));
+            }
+
+            return result("syncRow", latencies, m_rows, total(latencies));
+        }
+
+        OperationResult syncTxnRow()
+        {
+            std::vector<double> latencies;
+            latencies.reserve(m_rows);
+            ResultCallbackData callbackData { [](ReturnTypeCallback, const nlohmann::json&) {} };
+            const nlohmann::json tables { {"table", m_workload.table} };
+            const auto start { std::chrono::steady_clock::now() };
+
+            {
+                DBSyncTxn txn { m_dbSync->handle(), tables, 1, 4096, callbackData };
+
+                // Every 10th row changes, the others are only marked as seen by the transaction.
+                for (size_t id = 0; id < m_rows; ++id)
+                {
+                    if (0 == id % 10)
+                    {
+                        ++m_revisions[id];
+                    }
+
+                    const nlohmann::json input { {"table", m_workload.table}, {"data", nlohmann::json::array({ m_workload.row(id, m_revisions[id]) })} };
+                    latencies.push_back(measure([&]()
+                    {
+                        txn.syncTxnRow(input);
+                    }));
+                }
+
+                txn.getDeletedRows(callbackData);
+            }
+
+            // The throughput includes the time needed to drain the queue and close the transaction.
+            return result("syncTxnRow", latencies, m_rows, elapsed(start));
+        }
+
+        OperationResult updateWithSnapshot()
+        {
+            std::vector<double> latencies;
+            ResultCallbackData callbackData { [](ReturnTypeCallback, const nlohmann::json&) {} };
+
+            for (size_t iteration = 0; iteration < SNAPSHOT_ITERATIONS; ++iteration)
+            {
+                nlohmann::json input { {"table", m_workload.table}, {"data", nlohmann::json::array()} };
+                auto& data { input.at("data") };
+
+                // Every 100th row changes in each snapshot.
+                for (size_t id = 0; id < m_rows; ++id)
+                {
+                    if (iteration == id % 100)
+                    {
+                        ++m_revisions[id];
+                    }
+
+                    data.push_back(m_workload.row(id, m_revisions[id]));
+                }
+
+                latencies.push_back(measure([&]()
+                {
+                    m_dbSync->updateWithSnapshot(input, callbackData);
+                }));
+            }
+
+            return result("updateWithSnapshot", latencies, m_rows * SNAPSHOT_ITERATIONS, total(latencies));
+        }
+
+        OperationResult selectRows()
+        {
+            const auto queries { std::min(m_rows, static_cast<size_t>(MAX_SELECT_QUERIES)) };
+            std::vector<double> latencies;
+            latencies.reserve(queries);
+            std::mt19937_64 generator { m_rows };
+            std::uniform_int_distribution<size_t> distribution { 0, m_rows - 1 };
+            size_t selectedRows { 0 };
+            ResultCallbackData callbackData
+            {
+                [&selectedRows](ReturnTypeCallback, const nlohmann::json&)
+                {
+                    ++selectedRows;
+                }
+            };
+
+            for (size_t i = 0; i < queries; ++i)
+            {
+                auto selectQuery
+                {
+                    SelectQuery::builder()
+                    .table(m_workload.table)
+                    .columnList({"*"})
+                    .rowFilter(m_workload.filter(distribution(generator)))
+                    .countOpt(1)
+                    .build()
+                };
+                latencies.push_back(measure([&]()
+                {
+                    m_dbSync->selectRows(selectQuery.query(), callbackData);
+                }));
+            }
+
+            if (selectedRows != queries)
+            {
+                std::cerr << "selectRows: " << selectedRows << " rows selected out of " << queries << " queries." << std::endl;
+            }
+
+            return result("selectRows", latencies, queries, total(latencies));
+        }
+
+        OperationResult deleteRows()
+        {
+            std::vector<double> latencies;
+
+            for (size_t first = 0; first < m_rows; first += DELETE_BATCH_ROWS)
+            {
+                auto deleteQuery { DeleteQuery::builder().table(m_workload.table) };
+
+                for (size_t id = first; id < std::min<size_t>(m_rows, first + DELETE_BATCH_ROWS); ++id)
+                {
+                    deleteQuery.data(m_workload.primaryKey(id));
+                }
+
+                latencies.push_back(measure([&]()
+                {
+                    m_dbSync->deleteRows(deleteQuery.query());
+                }));
+            }
+
+            return result("deleteRows", latencies, m_rows, total(latencies));
+        }
+
+        void populate()
+        {
+            for (size_t first = 0; first < m_rows; first += INSERT_BATCH_ROWS)
+            {
+                nlohmann::json input { {"table", m_workload.table}, {"data", nlohmann::json::array()} };
+
+                for (size_t id = first; id < std::min<size_t>(m_rows, first + INSERT_BATCH_ROWS); ++id)
+                {
+                    input.at("data").push_back(m_workload.row(id, m_revisions[id]));
+                }
+
+                m_dbSync->insertData(input);
+            }
+        }
+
+    private:
+        static double measure(const std::function<void()>& operation)
+        {
+            const auto start { std::chrono::steady_clock::now() };
+            operation();
+            return elapsed(start);
+        }
+
+        static double elapsed(const std::chrono::steady_clock::time_point& start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        static double total(const std::vector<double>& latencies)
+        {
+            double seconds { 0 };
+
+            for (const auto& latency : latencies)
+            {
+                seconds += latency;
+            }
+
+            return seconds;
+        }
+
+        static double percentile(std::vector<double> latencies, const double value)
+        {
+            if (latencies.empty())
+            {
+                return 0;
+            }
+
+            const auto index { static_cast<size_t>(value * static_cast<double>(latencies.size() - 1)) };
+            std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+            return latencies[index];
+        }
+
+        OperationResult result(const std::string& operation,
+                               const std::vector<double>& latencies,
+                               const size_t processedRows,
+                               const double seconds) const
+        {
+            return
+            {
+                m_workloadName,
+                m_rows,
+                operation,
+                latencies.size(),
+                seconds > 0 ? static_cast<double>(processedRows) / seconds : 0,
+                percentile(latencies, 0.5) * 1000000,
+                percentile(latencies, 0.99) * 1000000,
+                peakRss()
+            };
+        }
+
+        const std::string m_workloadName;
+        const Workload& m_workload;
+        const size_t m_rows;
+        std::vector<size_t> m_revisions;
+        std::unique_ptr<DBSync> m_dbSync;
+};
+
+static void printResult(const OperationResult& result)
+{
+    std::cout << std::left << std::setw(14) << result.workload
+              << std::right << std::setw(10) << result.rows
+              << "  " << std::left << std::setw(20) << result.operation
+              << std::right << std::setw(10) << result.samples
+              << std::setw(14) << std::fixed << std::setprecision(0) << result.throughput
+              << std::setw(12) << std::setprecision(1) << result.p50
+              << std::setw(12) << result.p99
+              << std::setw(14) << result.peakRss
+              << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        BenchmarkArgs args(argc, argv);
+        const auto& operations { args.operations() };
+        const auto hasOperation
+        {
+            [&operations](const std::string& operation)
+            {
+                return operations.end() != std::find(operations.begin(), operations.end(), operation);
+            }
+        };
+        auto results = nlohmann::json::array();
+
+        DBSync::initialize([](const std::string & msg)
+        {
+            std::cerr << msg << std::endl;
+        });
+
+        std::cout << std::left << std::setw(14) << "workload"
+                  << std::right << std::setw(10) << "rows"
+                  << "  " << std::left << std::setw(20) << "operation"
+                  << std::right << std::setw(10) << "samples"
+                  << std::setw(14) << "rows/s"
+                  << std::setw(12) << "p50(us)"
+                  << std::setw(12) << "p99(us)"
+                  << std::setw(14) << "peakRSS(KB)"
+                  << std::endl;
+
+        for (const auto& workloadName : args.workloads())
+        {
+            const auto& workload { WORKLOADS.at(workloadName) };
+
+            for (const auto rows : args.rows())
+            {
+                std::vector<OperationResult> runResults;
+
+                {
+                    BenchmarkRunner runner { workloadName, workload, rows, args.dbPath() };
+
+                    if (hasOperation("syncRow"))
+                    {
+                        runResults.push_back(runner.syncRow());
+                    }
+                    else
+                    {
+                        runner.populate();
+                    }
+
+                    if (hasOperation("syncTxnRow"))
+                    {
+                        runResults.push_back(runner.syncTxnRow());
+                    }
+
+                    if (hasOperation("updateWithSnapshot"))
+                    {
+                        runResults.push_back(runner.updateWithSnapshot());
+                    }
+
+                    if (hasOperation("selectRows"))
+                    {
+                        runResults.push_back(runner.selectRows());
+                    }
+
+                    if (hasOperation("deleteRows"))
+                    {
+                        runResults.push_back(runner.deleteRows());
+                    }
+                }
+
+                for (const auto& result : runResults)
+                {
+                    printResult(result);
+                    results.push_back(
+                    {
+                        {"workload", result.workload}, {"rows", result.rows}, {"operation", result.operation},
+                        {"samples", result.samples}, {"throughput", result.throughput}, {"p50_us", result.p50},
+                        {"p99_us", result.p99}, {"peak_rss_kb", result.peakRss}
+                    });
+                }
+
+                std::remove(args.dbPath().c_str());
+                std::remove((args.dbPath() + "-journal").c_str());
+            }
+        }
+
+        if (!args.outputFile().empty())
+        {
+            std::ofstream outputFile{ args.outputFile() };
+            outputFile << results.dump(4) << std::endl;
+        }
+
+        DBSync::teardown();
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        BenchmarkArgs::showHelp();
+    }
+
+    return 0;
+}
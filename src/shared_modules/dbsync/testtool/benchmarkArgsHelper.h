@@ -0,0 +1,140 @@
+/*
+ * Wazuh DBSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _BENCHMARK_ARGS_HELPER_H_
+#define _BENCHMARK_ARGS_HELPER_H_
+
+#include <stdexcept>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <iostream>
+
+class BenchmarkArgs
+{
+    public:
+        BenchmarkArgs(const int argc, const char* argv[])
+            : m_rows{ splitRows(paramValueOf(argc, argv, "-r", "1000,100000,1000000")) }
+            , m_workloads{ splitValues(paramValueOf(argc, argv, "-w", "fim,syscollector")) }
+            , m_operations{ splitValues(paramValueOf(argc, argv, "-p", "syncRow,syncTxnRow,updateWithSnapshot,selectRows,deleteRows")) }
+            , m_dbPath{ paramValueOf(argc, argv, "-d", "dbsync_benchmark.db") }
+            , m_outputFile{ paramValueOf(argc, argv, "-o", "") }
+        {}
+
+        const std::vector<size_t>& rows() const
+        {
+            return m_rows;
+        }
+
+        const std::vector<std::string>& workloads() const
+        {
+            return m_workloads;
+        }
+
+        const std::vector<std::string>& operations() const
+        {
+            return m_operations;
+        }
+
+        const std::string& dbPath() const
+        {
+            return m_dbPath;
+        }
+
+        const std::string& outputFile() const
+        {
+            return m_outputFile;
+        }
+
+        static void showHelp()
+        {
+            std::cout << "\nUsage: dbsync_benchmark <option(s)>\n"
+                      << "Options:\n"
+                      << "\t-h \t\t\tShow this help message\n"
+                      << "\t-r ROWS_LIST\t\tTable sizes to benchmark (default: 1000,100000,1000000).\n"
+                      << "\t-w WORKLOAD_LIST\tSynthetic tables to use: fim, syscollector (default: both).\n"
+                      << "\t-p OPERATION_LIST\tOperations to time: syncRow, syncTxnRow, updateWithSnapshot,\n"
+                      << "\t\t\t\tselectRows, deleteRows (default: all).\n"
+                      << "\t-d DB_PATH\t\tDatabase file used during the runs (default: dbsync_benchmark.db).\n"
+                      << "\t-o OUTPUT_FILE\t\tJSON file where the results are also written.\n"
+                      << "\nExample:"
+                      << "\n\t./dbsync_benchmark -r 1000,100000 -w fim -o results.json\n"
+                      << std::endl;
+        }
+
+    private:
+
+        static std::string paramValueOf(const int argc,
+                                        const char* argv[],
+                                        const std::string& switchValue,
+                                        const std::string& defaultValue)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                const std::string currentValue{ argv[i] };
+
+                if (currentValue == "-h")
+                {
+                    throw std::runtime_error
+                    {
+                        "Help requested."
+                    };
+                }
+
+                if (currentValue == switchValue && i + 1 < argc)
+                {
+                    // Switch found
+                    return argv[i + 1];
+                }
+            }
+
+            return defaultValue;
+        }
+
+        static std::vector<std::string> splitValues(const std::string& values)
+        {
+            std::vector<std::string> splitValues;
+            std::stringstream ss{ values };
+
+            while (ss.good())
+            {
+                std::string substr;
+                getline(ss, substr, ','); // Getting each string between ',' character
+
+                if (!substr.empty())
+                {
+                    splitValues.push_back(std::move(substr));
+                }
+            }
+
+            return splitValues;
+        }
+
+        static std::vector<size_t> splitRows(const std::string& values)
+        {
+            std::vector<size_t> rows;
+
+            for (const auto& value : splitValues(values))
+            {
+                rows.push_back(std::stoull(value));
+            }
+
+            return rows;
+        }
+
+        const std::vector<size_t> m_rows;
+        const std::vector<std::string> m_workloads;
+        const std::vector<std::string> m_operations;
+        const std::string m_dbPath;
+        const std::string m_outputFile;
+};
+
+#endif // _BENCHMARK_ARGS_HELPER_H_
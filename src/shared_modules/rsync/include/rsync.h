@@ -33,6 +33,15 @@
 extern "C" {
 #endif
 
+/**
+ * @brief Callback function reporting whether the rsync messages must be held back.
+ *
+ * @param user_data User data space given along with the callback.
+ *
+ * @return Non-zero while the sending buffer is under pressure, 0 otherwise.
+ */
+typedef int((*backpressure_callback_t)(void* user_data));
+
 /**
  * @brief Initializes the shared library.
  *
@@ -49,6 +58,8 @@ EXPORTED void rsync_initialize(log_fnc_t log_function);
  * @param infoFunction Function pointer to the info log function.
  * @param warningFunction Function pointer to the warning function.
  * @param errorFunction Function pointer to the error function.
+ *
+ * @details A NULL function disables its level, and its messages aren't formatted.
  */
 EXPORTED void rsync_initialize_full_log_function(full_log_fnc_t debugVerboseFunction, full_log_fnc_t debugFunction,
                                                  full_log_fnc_t infoFunction, full_log_fnc_t warningFunction,
@@ -118,6 +129,36 @@ EXPORTED int rsync_push_message(const RSYNC_HANDLE handle,
                                 const void* payload,
                                 const size_t size);
 
+/**
+ * @brief Applies a dbsync row change to the checksum tree and the change tracking of \p message_header_id.
+ *
+ * @param handle            Current rsync handle being used.
+ * @param message_header_id Message ID registered with "checksum_tree" or "change_tracking" enabled.
+ * @param type              Type of the dbsync notification (INSERTED, MODIFIED or DELETED).
+ * @param row               Row data as reported by the dbsync callback.
+ *
+ * @return 0 if succeeded,
+ *         specific error code (OS dependent) otherwise.
+ */
+EXPORTED int rsync_notify_row_change(const RSYNC_HANDLE handle,
+                                     const char* message_header_id,
+                                     const ReturnTypeCallback type,
+                                     const cJSON* row);
+
+/**
+ * @brief Sets the hook polled before each sync message to hold it back under pressure.
+ *
+ * @param handle    Current rsync handle being used.
+ * @param callback  Function reporting whether the sending buffer is under pressure, NULL removes it.
+ * @param user_data User data space passed to \p callback.
+ *
+ * @return 0 if succeeded,
+ *         specific error code (OS dependent) otherwise.
+ */
+EXPORTED int rsync_set_backpressure_callback(const RSYNC_HANDLE handle,
+                                             backpressure_callback_t callback,
+                                             void* user_data);
+
 /**
  * @brief Turns off an specific rsync instance.
  *
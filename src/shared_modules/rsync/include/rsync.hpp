@@ -115,6 +115,26 @@ class EXPORTED RemoteSync
          *
          */
         virtual void pushMessage(const std::vector<uint8_t>& payload);
+        /**
+         * @brief Keeps the checksum tree and the change tracking of \p messageHeaderID up to date with a dbsync row change.
+         *
+         * @param messageHeaderID Registered message ID whose checksum tree is updated.
+         * @param type            Type of the dbsync notification (INSERTED, MODIFIED or DELETED).
+         * @param row             Row data as reported by the dbsync callback.
+         *
+         * @details It has no effect on sync ids registered without a checksum tree or change tracking.
+         */
+        virtual void notifyRowChange(const std::string&    messageHeaderID,
+                                     const ReturnTypeCallback type,
+                                     const nlohmann::json& row);
+        /**
+         * @brief Sets the hook that holds back the sync messages while it returns true.
+         *
+         * @param callback Function reporting whether the sending buffer is under pressure.
+         *
+         * @details It is polled before each message sent as answer to the manager requests.
+         */
+        virtual void setBackpressureCallback(const std::function<bool()>& callback);
         /**
          * @brief Get current rsync handle in the instance.
          *
@@ -205,6 +225,19 @@ class EXPORTED Configuration : public Utils::Builder<T>
             m_jsConfiguration["checksum_field"] = checksumField;
             return static_cast<T&>(*this); // Return reference to self
         }
+
+        /**
+         * @brief Set the algorithm used to combine the row checksums of a range.
+         *
+         * @param algorithm "sha1" (default) or "sum", an order-independent 160-bit sum.
+         *                  It is advertised to the manager in every integrity message.
+         *
+         */
+        T& checksumAlgorithm(const std::string& algorithm)
+        {
+            m_jsConfiguration["checksum_algorithm"] = algorithm;
+            return static_cast<T&>(*this); // Return reference to self
+        }
 };
 
 class EXPORTED QueryParameter final : public Utils::Builder<QueryParameter>
@@ -317,6 +350,48 @@ class EXPORTED RegisterConfiguration final : public Configuration<RegisterConfig
          *
          */
         RegisterConfiguration& rangeChecksum(QueryParameter& parameter);
+
+        /**
+         * @brief Keep an in-memory checksum tree to answer checksum_fail requests without database scans.
+         *
+         * @param enabled Whether the checksum tree is used, rows must then be reported through notifyRowChange.
+         *
+         */
+        RegisterConfiguration& checksumTree(const bool enabled);
+
+        /**
+         * @brief Reuse the global checksum sent at the last sync start while the table doesn't change.
+         *
+         * @param enabled Whether the table is tracked, every row change must then be reported through notifyRowChange.
+         *
+         */
+        RegisterConfiguration& changeTracking(const bool enabled);
+
+        /**
+         * @brief Split checksum_fail ranges from a single ordered read instead of counting the range first.
+         *
+         * @param enabled Whether the range is read once, keeping its indexes and checksums in memory.
+         *
+         */
+        RegisterConfiguration& singlePassSplit(const bool enabled);
+
+        /**
+         * @brief Pack the rows sent for a no_data request into "state_batch" messages.
+         *
+         * @param maxRows  Maximum number of rows per message.
+         * @param maxSize  Maximum size in bytes of the serialized rows per message.
+         * @param compress Whether the rows are sent zlib-compressed and base64-encoded.
+         *
+         */
+        RegisterConfiguration& stateBatch(const uint32_t maxRows, const uint32_t maxSize, const bool compress);
+
+        /**
+         * @brief Limit the messages sent while answering manager requests.
+         *
+         * @param messagesPerSecond Maximum messages per second sent by the component, 0 disables the limit.
+         *
+         */
+        RegisterConfiguration& rateLimit(const uint32_t messagesPerSecond);
 };
 
 class EXPORTED StartSyncConfiguration final : public Configuration<StartSyncConfiguration>
@@ -0,0 +1,131 @@
+/*
+ * Wazuh RSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _CHANGE_TRACKER_HPP
+#define _CHANGE_TRACKER_HPP
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace RSync
+{
+    /**
+     * @brief Global checksum message of a table: its first and last index and the checksum of
+     * the rows between them, or no rows at all.
+     */
+    struct GlobalChecksum final
+    {
+        std::string begin;
+        std::string end;
+        std::string checksum;
+        bool clear { false };
+    };
+
+    /**
+     * @brief Change sequence of the tables whose components report every row change, and the
+     * global checksum computed for them at a given sequence.
+     *
+     * A cached checksum is only handed out while no change was reported after it was computed.
+     */
+    class ChangeTracker final
+    {
+        public:
+            void track(const std::string& messageHeaderId,
+                       const std::string& table)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                m_tables[messageHeaderId] = table;
+                m_entries[table];
+            }
+
+            void change(const std::string& messageHeaderId)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                const auto it { m_tables.find(messageHeaderId) };
+
+                if (m_tables.end() != it)
+                {
+                    ++m_entries[it->second].sequence;
+                }
+            }
+
+            /**
+             * @brief Gets the current change sequence of \p table.
+             *
+             * @return false if the changes of the table aren't tracked.
+             */
+            bool sequence(const std::string& table,
+                          uint64_t& sequence)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                const auto it { m_entries.find(table) };
+
+                if (m_entries.end() == it)
+                {
+                    return false;
+                }
+
+                sequence = it->second.sequence;
+                return true;
+            }
+
+            bool cached(const std::string& table,
+                        GlobalChecksum& checksum)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                const auto it { m_entries.find(table) };
+
+                if (m_entries.end() == it || !it->second.cached || it->second.cachedSequence != it->second.sequence)
+                {
+                    return false;
+                }
+
+                checksum = it->second.checksum;
+                return true;
+            }
+
+            /**
+             * @brief Keeps \p checksum, computed with the table at \p sequence, unless the table
+             * changed in the meantime.
+             */
+            void cache(const std::string& table,
+                       const uint64_t sequence,
+                       const GlobalChecksum& checksum)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                const auto it { m_entries.find(table) };
+
+                if (m_entries.end() != it && sequence == it->second.sequence)
+                {
+                    it->second.checksum = checksum;
+                    it->second.cachedSequence = sequence;
+                    it->second.cached = true;
+                }
+            }
+
+        private:
+            struct Entry final
+            {
+                uint64_t sequence { 0 };
+                uint64_t cachedSequence { 0 };
+                bool cached { false };
+                GlobalChecksum checksum;
+            };
+
+            std::map<std::string, std::string> m_tables;
+            std::map<std::string, Entry> m_entries;
+            std::mutex m_mutex;
+    };
+}// namespace RSync
+
+#endif // _CHANGE_TRACKER_HPP
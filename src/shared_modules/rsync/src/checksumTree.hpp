@@ -0,0 +1,161 @@
+/*
+ * Wazuh RSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _CHECKSUM_TREE_HPP
+#define _CHECKSUM_TREE_HPP
+
+#include "commonDefs.h"
+#include "json.hpp"
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace RSync
+{
+    /**
+     * @brief Ordered in-memory index of the per-row checksums of a synchronized table.
+     *
+     * It mirrors the (index, checksum) pairs of the table so checksum_fail requests can be
+     * counted, split and hashed without scanning the database. It is loaded once from the
+     * database and then kept up to date with the dbsync row notifications.
+     */
+    class ChecksumTree final
+    {
+        public:
+            using RowCallback = std::function<void(const std::string& index, const std::string& checksum)>;
+
+            ChecksumTree(const std::string& indexField, const std::string& checksumField)
+                : m_indexField { indexField }
+                , m_checksumField { checksumField }
+                , m_loaded { false }
+                , m_numericIndex { false }
+            { }
+            // LCOV_EXCL_START
+            ~ChecksumTree() = default;
+            // LCOV_EXCL_STOP
+
+            bool loaded()
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                return m_loaded;
+            }
+
+            /**
+             * @brief Replaces the tree content with the rows returned by \p loader.
+             *
+             * @param loader Function receiving a callback to be called with each table row.
+             */
+            void load(const std::function<void(const std::function<void(const nlohmann::json&)>&)>& loader)
+            {
+                std::map<nlohmann::json, std::string> checksums;
+                auto numericIndex { false };
+
+                loader([&](const nlohmann::json & row)
+                {
+                    const auto& index { row.at(m_indexField) };
+                    numericIndex = !index.is_string();
+                    checksums[index] = row.at(m_checksumField).get<std::string>();
+                });
+
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                m_checksums = std::move(checksums);
+                m_numericIndex = numericIndex;
+                m_loaded = true;
+            }
+
+            /**
+             * @brief Applies a dbsync row notification to the tree.
+             *
+             * @param type Notification type, only INSERTED, MODIFIED and DELETED are applied.
+             * @param row  Row data as reported by dbsync, MODIFIED rows may carry a "new" object.
+             */
+            void update(const ReturnTypeCallback type, const nlohmann::json& row)
+            {
+                const auto itNew { row.find("new") };
+                const auto& data { MODIFIED == type && row.end() != itNew ? *itNew : row };
+                const auto itIndex { data.find(m_indexField) };
+
+                if (data.end() == itIndex)
+                {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock{ m_mutex };
+
+                if (DELETED == type)
+                {
+                    m_checksums.erase(*itIndex);
+                }
+                else if (INSERTED == type || MODIFIED == type)
+                {
+                    const auto itChecksum { data.find(m_checksumField) };
+
+                    if (data.end() != itChecksum)
+                    {
+                        m_numericIndex = !itIndex->is_string();
+                        m_checksums[*itIndex] = itChecksum->get<std::string>();
+                    }
+                }
+            }
+
+            /**
+             * @brief Number of rows in the [\p begin, \p end] range.
+             */
+            size_t count(const std::string& begin, const std::string& end)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+
+                if (key(end) < key(begin))
+                {
+                    return 0;
+                }
+
+                return std::distance(m_checksums.lower_bound(key(begin)), m_checksums.upper_bound(key(end)));
+            }
+
+            /**
+             * @brief Calls \p callback with each row in the [\p begin, \p end] range, in index order.
+             */
+            void forEach(const std::string& begin, const std::string& end, const RowCallback& callback)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+
+                if (key(end) < key(begin))
+                {
+                    return;
+                }
+
+                const auto last { m_checksums.upper_bound(key(end)) };
+
+                for (auto it { m_checksums.lower_bound(key(begin)) }; it != last; ++it)
+                {
+                    callback(it->first.is_string() ? it->first.get_ref<const std::string&>()
+                             : std::to_string(it->first.get<unsigned long>()), it->second);
+                }
+            }
+
+        private:
+            nlohmann::json key(const std::string& value) const
+            {
+                return m_numericIndex ? nlohmann::json(std::stoul(value)) : nlohmann::json(value);
+            }
+
+            const std::string m_indexField;
+            const std::string m_checksumField;
+            std::map<nlohmann::json, std::string> m_checksums;
+            std::mutex m_mutex;
+            bool m_loaded;
+            bool m_numericIndex;
+    };
+}// namespace RSync
+
+#endif // _CHECKSUM_TREE_HPP
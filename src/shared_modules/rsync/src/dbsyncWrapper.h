@@ -29,6 +29,11 @@ namespace RSync
             {
                 DBSync(m_dbsyncHandle).selectRows(data, callbackData);
             }
+            virtual void selectRows(nlohmann::json& data,
+                                    RowCallbackData callbackData)
+            {
+                DBSync(m_dbsyncHandle).selectRows(data, callbackData);
+            }
             // LCOV_EXCL_START
             virtual ~DBSyncWrapper() = default;
             // LCOV_EXCL_STOP
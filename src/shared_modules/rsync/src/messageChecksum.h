@@ -57,6 +57,14 @@ namespace RSync
                         }
 
                         outputData["checksum"] = data.checksum;
+
+                        // The manager uses SHA-1 unless another algorithm is advertised.
+                        const auto itAlgorithm { config.find("checksum_algorithm") };
+
+                        if (config.end() != itAlgorithm)
+                        {
+                            outputData["algorithm"] = *itAlgorithm;
+                        }
                     }
 
                     outputMessage["data"] = outputData;
@@ -12,6 +12,8 @@
 #ifndef _JSON_MESSAGE_DECODER_H
 #define _JSON_MESSAGE_DECODER_H
 
+#include <algorithm>
+#include <iterator>
 #include "imessageDecoder.h"
 #include "json.hpp"
 
@@ -26,20 +28,18 @@ namespace RSync
             SyncInputData decode(const std::vector<unsigned char>& rawData) override
             {
                 SyncInputData retVal{};
-                const std::string rawDataString { reinterpret_cast<const char*>(rawData.data()), rawData.size() };
-                const auto firstToken { rawDataString.find(' ') };
+                // The header and command are located in place, only the JSON body is parsed from the raw buffer.
+                const auto firstToken { std::find(rawData.begin(), rawData.end(), ' ') };
 
-                if (std::string::npos != firstToken)
+                if (rawData.end() != firstToken)
                 {
-                    const auto rawDataStringFromFirst { rawDataString.substr(firstToken + 1, rawDataString.length() - firstToken - 1) };
-                    const auto secondToken { rawDataStringFromFirst.find(' ') };
+                    const auto secondToken { std::find(std::next(firstToken), rawData.end(), ' ') };
 
-                    if (std::string::npos != secondToken)
+                    if (rawData.end() != secondToken)
                     {
-                        retVal.command = rawDataStringFromFirst.substr(0, secondToken);
+                        retVal.command.assign(std::next(firstToken), secondToken);
 
-                        const auto rawDataStringFromSecond { rawDataStringFromFirst.substr(secondToken + 1, rawDataStringFromFirst.length() - secondToken - 1) };
-                        const auto& json { nlohmann::json::parse(rawDataStringFromSecond) };
+                        const auto json = nlohmann::json::parse(std::next(secondToken), rawData.end());
                         const auto& begin{json.at("begin")};
                         const auto& end{json.at("end")};
 
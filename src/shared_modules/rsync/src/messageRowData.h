@@ -40,16 +40,19 @@ namespace RSync
                 nlohmann::json outputMessage;
                 outputMessage["component"] = config.at("component");
                 outputMessage["type"] = "state";
+                outputMessage["data"] = stateData(config, data);
 
+                callback(outputMessage.dump());
+            }
+
+            static nlohmann::json stateData(const nlohmann::json& config, const nlohmann::json& data)
+            {
                 nlohmann::json outputData;
                 outputData["index"] = data.at(config.at("index").get_ref<const std::string&>());
                 const auto lastEvent = config.find("last_event");
                 outputData["timestamp"] = (lastEvent != config.end()) ? data.at(lastEvent->get_ref<const std::string&>()) : "";
                 outputData["attributes"] = data;
-
-                outputMessage["data"] = outputData;
-
-                callback(outputMessage.dump());
+                return outputData;
             }
     };
 };// namespace RSync
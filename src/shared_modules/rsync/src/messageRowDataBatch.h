@@ -0,0 +1,126 @@
+/*
+ * Wazuh RSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _MESSAGE_ROW_DATA_BATCH_H
+#define _MESSAGE_ROW_DATA_BATCH_H
+
+#include <string>
+#include <vector>
+#include "json.hpp"
+#include "openssl/evp.h"
+#include "zlib.h"
+#include "messageRowData.h"
+
+namespace RSync
+{
+    constexpr auto STATE_BATCH_DEFAULT_ROWS { 100u };
+    constexpr auto STATE_BATCH_DEFAULT_SIZE { 32768u };
+
+    /**
+     * @brief Packs several row data messages into "state_batch" messages.
+     *
+     * A batch is sent when it reaches "max_rows" rows or "max_size" bytes of serialized rows.
+     * With "compress" enabled the rows array is deflated with zlib and sent base64-encoded.
+     */
+    class MessageRowDataBatch final
+    {
+        public:
+            MessageRowDataBatch(const ResultCallback callback, const nlohmann::json& config)
+                : m_callback { callback }
+                , m_config { config }
+                , m_maxRows { config.at("state_batch").value("max_rows", STATE_BATCH_DEFAULT_ROWS) }
+                , m_maxSize { config.at("state_batch").value("max_size", STATE_BATCH_DEFAULT_SIZE) }
+                , m_compress { config.at("state_batch").value("compress", false) }
+                , m_rows { 0u }
+            { }
+            // LCOV_EXCL_START
+            ~MessageRowDataBatch() = default;
+            // LCOV_EXCL_STOP
+
+            void add(const nlohmann::json& data)
+            {
+                const auto row { MessageRowData<nlohmann::json>::stateData(m_config, data).dump() };
+
+                if (m_rows && m_buffer.size() + row.size() + 1 > m_maxSize)
+                {
+                    flush();
+                }
+
+                m_buffer += m_rows ? "," : "[";
+                m_buffer += row;
+
+                if (++m_rows >= m_maxRows)
+                {
+                    flush();
+                }
+            }
+
+            void flush()
+            {
+                if (m_rows)
+                {
+                    m_buffer += "]";
+
+                    nlohmann::json outputMessage;
+                    outputMessage["component"] = m_config.at("component");
+                    outputMessage["type"] = "state_batch";
+
+                    if (m_compress)
+                    {
+                        outputMessage["compression"] = "zlib";
+                        outputMessage["size"] = m_buffer.size();
+                        outputMessage["data"] = deflate(m_buffer);
+                        m_callback(outputMessage.dump());
+                    }
+                    else
+                    {
+                        // The rows are already serialized, they are not parsed again to build the message.
+                        auto message { outputMessage.dump() };
+                        message.insert(message.size() - 1, R"(,"data":)" + m_buffer);
+                        m_callback(message);
+                    }
+
+                    m_buffer.clear();
+                    m_rows = 0;
+                }
+            }
+
+        private:
+            static std::string deflate(const std::string& data)
+            {
+                auto compressedSize { compressBound(data.size()) };
+                std::vector<unsigned char> compressed(compressedSize);
+
+                // LCOV_EXCL_START
+                if (Z_OK != compress2(compressed.data(), &compressedSize,
+                                      reinterpret_cast<const Bytef*>(data.data()), data.size(), Z_BEST_SPEED))
+                {
+                    throw std::runtime_error { "Error compressing state batch." };
+                }
+
+                // LCOV_EXCL_STOP
+
+                std::vector<unsigned char> encoded(4 * ((compressedSize + 2) / 3) + 1);
+                const auto encodedSize { EVP_EncodeBlock(encoded.data(), compressed.data(), static_cast<int>(compressedSize)) };
+                return std::string { encoded.begin(), encoded.begin() + encodedSize };
+            }
+
+            const ResultCallback m_callback;
+            const nlohmann::json& m_config;
+            const unsigned int m_maxRows;
+            const unsigned int m_maxSize;
+            const bool m_compress;
+            unsigned int m_rows;
+            std::string m_buffer;
+    };
+};// namespace RSync
+
+#endif //_MESSAGE_ROW_DATA_BATCH_H
@@ -0,0 +1,146 @@
+/*
+ * Wazuh RSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _RANGE_CHECKSUM_HPP
+#define _RANGE_CHECKSUM_HPP
+
+#include <array>
+#include <memory>
+#include <string>
+#include "json.hpp"
+#include "hashHelper.h"
+#include "stringHelper.h"
+#include "rsync_exception.h"
+
+namespace RSync
+{
+    constexpr auto CHECKSUM_ALGORITHM_SHA1 { "sha1" };
+    constexpr auto CHECKSUM_ALGORITHM_SUM { "sum" };
+
+    /**
+     * @brief Combines the row checksums of a range into the checksum sent to the manager.
+     *
+     * "sha1" (default) hashes the ordered row checksums. "sum" adds them as 160-bit big-endian
+     * numbers, so the result does not depend on the row order and needs no cryptographic hash.
+     */
+    class RangeChecksum final
+    {
+        public:
+            explicit RangeChecksum(const nlohmann::json& configuration)
+                : m_sum {}
+            {
+                if (CHECKSUM_ALGORITHM_SUM != algorithm(configuration))
+                {
+                    m_spHash = std::make_unique<Utils::HashData>();
+                }
+            }
+            // LCOV_EXCL_START
+            ~RangeChecksum() = default;
+            // LCOV_EXCL_STOP
+
+            /**
+             * @brief Algorithm configured in \p configuration, "sha1" when it is not set.
+             */
+            static std::string algorithm(const nlohmann::json& configuration)
+            {
+                const auto it { configuration.find("checksum_algorithm") };
+
+                if (configuration.end() == it)
+                {
+                    return CHECKSUM_ALGORITHM_SHA1;
+                }
+
+                const auto& value { it->get_ref<const std::string&>() };
+
+                if (CHECKSUM_ALGORITHM_SHA1 != value && CHECKSUM_ALGORITHM_SUM != value)
+                {
+                    throw rsync_error { INVALID_CHECKSUM_ALGORITHM };
+                }
+
+                return value;
+            }
+
+            void update(const std::string& checksum)
+            {
+                if (m_spHash)
+                {
+                    m_spHash->update(checksum.data(), checksum.size());
+                }
+                else
+                {
+                    add(digestOf(checksum));
+                }
+            }
+
+            /**
+             * @brief Starts a new range, keeping the hash context.
+             */
+            void reset()
+            {
+                if (m_spHash)
+                {
+                    m_spHash->reset();
+                }
+                else
+                {
+                    m_sum.fill(0);
+                }
+            }
+
+            std::string digest()
+            {
+                return Utils::asciiToHex(m_spHash ? m_spHash->hash() : std::vector<unsigned char> { m_sum.begin(), m_sum.end() });
+            }
+
+        private:
+            static constexpr auto DIGEST_SIZE { 20 };
+            using Digest = std::array<unsigned char, DIGEST_SIZE>;
+
+            // Row checksums are hex SHA-1 digests, anything else is hashed first so every row counts.
+            static Digest digestOf(const std::string& checksum)
+            {
+                Digest value {};
+
+                if (checksum.size() == DIGEST_SIZE * 2 &&
+                        std::string::npos == checksum.find_first_not_of("0123456789abcdefABCDEF"))
+                {
+                    for (auto i { 0 }; i < DIGEST_SIZE; ++i)
+                    {
+                        value[i] = static_cast<unsigned char>(std::stoul(checksum.substr(i * 2, 2), nullptr, 16));
+                    }
+                }
+                else
+                {
+                    const auto result { Utils::HashData::sha1(checksum) };
+                    std::copy(result.begin(), result.end(), value.begin());
+                }
+
+                return value;
+            }
+
+            void add(const Digest& value)
+            {
+                auto carry { 0u };
+
+                for (auto i { DIGEST_SIZE - 1 }; i >= 0; --i)
+                {
+                    carry += static_cast<unsigned int>(m_sum[i]) + value[i];
+                    m_sum[i] = static_cast<unsigned char>(carry & 0xFF);
+                    carry >>= 8;
+                }
+            }
+
+            std::unique_ptr<Utils::HashData> m_spHash;
+            Digest m_sum;
+    };
+}// namespace RSync
+
+#endif // _RANGE_CHECKSUM_HPP
@@ -173,8 +173,82 @@ EXPORTED int rsync_push_message(const RSYNC_HANDLE handle,
         {
             const auto first{reinterpret_cast<const unsigned char*>(payload)};
             const auto last{first + size};
-            const std::vector<unsigned char> data{first, last};
-            RSyncImplementation::instance().push(handle, data);
+            std::vector<unsigned char> data{first, last};
+            RSyncImplementation::instance().push(handle, std::move(data));
+            retVal = 0;
+        }
+        // LCOV_EXCL_START
+        catch (...)
+        {
+            errorMessage += "Unrecognized error.";
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    log_message(errorMessage);
+    return retVal;
+}
+
+EXPORTED int rsync_notify_row_change(const RSYNC_HANDLE handle,
+                                     const char* message_header_id,
+                                     const ReturnTypeCallback type,
+                                     const cJSON* row)
+{
+    auto retVal { -1 };
+    std::string errorMessage;
+
+    if (!handle || !message_header_id || !row)
+    {
+        errorMessage += "Invalid Parameters.";
+    }
+    else
+    {
+        try
+        {
+            const std::unique_ptr<char, CJsonSmartFree> spJsonBytes{cJSON_PrintUnformatted(row)};
+            RSyncImplementation::instance().notifyRowChange(handle, message_header_id, type, nlohmann::json::parse(spJsonBytes.get()));
+            retVal = 0;
+        }
+        // LCOV_EXCL_START
+        catch (...)
+        {
+            errorMessage += "Unrecognized error.";
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    log_message(errorMessage);
+    return retVal;
+}
+
+EXPORTED int rsync_set_backpressure_callback(const RSYNC_HANDLE handle,
+                                             backpressure_callback_t callback,
+                                             void* user_data)
+{
+    auto retVal { -1 };
+    std::string errorMessage;
+
+    if (!handle)
+    {
+        errorMessage += "Invalid Parameters.";
+    }
+    else
+    {
+        try
+        {
+            BackpressureCallback backpressure;
+
+            if (callback)
+            {
+                backpressure = [callback, user_data]()
+                {
+                    return 0 != callback(user_data);
+                };
+            }
+
+            RSyncImplementation::instance().setBackpressureCallback(handle, backpressure);
             retVal = 0;
         }
         // LCOV_EXCL_START
@@ -288,6 +362,18 @@ void RemoteSync::pushMessage(const std::vector<uint8_t>& payload)
     RSyncImplementation::instance().push(m_handle, payload);
 }
 
+void RemoteSync::notifyRowChange(const std::string&    messageHeaderID,
+                                 const ReturnTypeCallback type,
+                                 const nlohmann::json& row)
+{
+    RSyncImplementation::instance().notifyRowChange(m_handle, messageHeaderID, type, row);
+}
+
+void RemoteSync::setBackpressureCallback(const std::function<bool()>& callback)
+{
+    RSyncImplementation::instance().setBackpressureCallback(m_handle, callback);
+}
+
 QueryParameter& QueryParameter::rowFilter(const std::string& rowFilter)
 {
     m_jsQueryParameter["row_filter"] = rowFilter;
@@ -354,6 +440,38 @@ RegisterConfiguration& RegisterConfiguration::rangeChecksum(QueryParameter& para
     return *this;
 }
 
+RegisterConfiguration& RegisterConfiguration::checksumTree(const bool enabled)
+{
+    m_jsConfiguration["checksum_tree"] = enabled;
+    return *this;
+}
+
+RegisterConfiguration& RegisterConfiguration::changeTracking(const bool enabled)
+{
+    m_jsConfiguration["change_tracking"] = enabled;
+    return *this;
+}
+
+RegisterConfiguration& RegisterConfiguration::singlePassSplit(const bool enabled)
+{
+    m_jsConfiguration["single_pass_split"] = enabled;
+    return *this;
+}
+
+RegisterConfiguration& RegisterConfiguration::stateBatch(const uint32_t maxRows, const uint32_t maxSize, const bool compress)
+{
+    m_jsConfiguration["state_batch"]["max_rows"] = maxRows;
+    m_jsConfiguration["state_batch"]["max_size"] = maxSize;
+    m_jsConfiguration["state_batch"]["compress"] = compress;
+    return *this;
+}
+
+RegisterConfiguration& RegisterConfiguration::rateLimit(const uint32_t messagesPerSecond)
+{
+    m_jsConfiguration["rate_limit"] = messagesPerSecond;
+    return *this;
+}
+
 StartSyncConfiguration& StartSyncConfiguration::first(QueryParameter& parameter)
 {
     m_jsConfiguration["first_query"] = parameter.queryParameter();
@@ -12,9 +12,10 @@
 #include "rsync_exception.h"
 #include "makeUnique.h"
 #include "stringHelper.h"
-#include "hashHelper.h"
+#include "rangeChecksum.hpp"
 #include "loggerHelper.h"
 #include "messageCreatorFactory.h"
+#include "messageRowDataBatch.h"
 #include "rsync.hpp"
 #include "synchronizationController.hpp"
 
@@ -70,10 +71,6 @@ void RSyncImplementation::startRSync(const RSYNC_HANDLE handle,
 
     if (!jsStartParamsTable.empty() && firstQuery != startConfiguration.end() && lastQuery != startConfiguration.end())
     {
-        const auto& jsFirstLastOutput { executeSelectQuery(spDBSyncWrapper, jsStartParamsTable, firstQuery.value(), lastQuery.value()) };
-        const auto& jsonFirstQueryResult { jsFirstLastOutput.at("first_result") };
-        const auto& jsonLastQueryResult  { jsFirstLastOutput.at("last_result") };
-
         auto messageCreator { FactoryMessageCreator<SplitContext, MessageType::CHECKSUM>::create() };
 
         ChecksumContext checksumCtx {};
@@ -81,43 +78,61 @@ void RSyncImplementation::startRSync(const RSYNC_HANDLE handle,
         checksumCtx.size = 0;
         checksumCtx.rightCtx.id = std::time(nullptr);
 
-        if (!jsonFirstQueryResult.empty() && !jsonLastQueryResult.empty())
+        const auto& table { jsStartParamsTable.get_ref<const std::string&>() };
+        GlobalChecksum globalChecksum;
+        uint64_t sequence { 0 };
+        const auto tracked { ctx->m_changeTracker.sequence(table, sequence) };
+
+        // Tables whose rows haven't changed since the last start send the same checksum without being read.
+        if (tracked && ctx->m_changeTracker.cached(table, globalChecksum))
+        {
+            LogIfEnabled(Log::debugVerbose) << "Unchanged table, cached checksum sent: " << table << LogEndl;
+        }
+        else
         {
-            const auto& indexField { startConfiguration.at("index").get_ref<const std::string&>() };
-            const auto& begin      { jsonFirstQueryResult.at(indexField) };
-            const auto& end        { jsonLastQueryResult.at(indexField)  };
+            const auto& jsFirstLastOutput { executeSelectQuery(spDBSyncWrapper, jsStartParamsTable, firstQuery.value(), lastQuery.value()) };
+            const auto& jsonFirstQueryResult { jsFirstLastOutput.at("first_result") };
+            const auto& jsonLastQueryResult  { jsFirstLastOutput.at("last_result") };
 
-            checksumCtx.type           = CHECKSUM_COMPLETE;
-            checksumCtx.rightCtx.type  = IntegrityMsgType::INTEGRITY_CHECK_GLOBAL;
+            globalChecksum.clear = jsonFirstQueryResult.empty() || jsonLastQueryResult.empty();
 
-            if (begin.is_string())
+            if (!globalChecksum.clear)
             {
-                checksumCtx.rightCtx.begin = begin;
-                checksumCtx.rightCtx.end   = end;
-                fillChecksum(spDBSyncWrapper, startConfiguration, begin, end, checksumCtx);
+                const auto& indexField { startConfiguration.at("index").get_ref<const std::string&>() };
+                const auto& begin      { jsonFirstQueryResult.at(indexField) };
+                const auto& end        { jsonLastQueryResult.at(indexField)  };
+
+                checksumCtx.type = CHECKSUM_COMPLETE;
+                globalChecksum.begin = begin.is_string() ? begin.get<std::string>() : std::to_string(begin.get<unsigned long>());
+                globalChecksum.end = end.is_string() ? end.get<std::string>() : std::to_string(end.get<unsigned long>());
+                fillChecksum(spDBSyncWrapper, startConfiguration, globalChecksum.begin, globalChecksum.end, checksumCtx);
+                globalChecksum.checksum = checksumCtx.rightCtx.checksum;
             }
-            else
+
+            if (tracked)
             {
-                const auto beginNumber{begin.get<unsigned long>()};
-                const auto endNumber{end.get<unsigned long>()};
-                const auto beginString{std::to_string(beginNumber)};
-                const auto endString{std::to_string(endNumber)};
-                checksumCtx.rightCtx.begin = beginString;
-                checksumCtx.rightCtx.end   = endString;
-                fillChecksum(spDBSyncWrapper, startConfiguration, beginString, endString, checksumCtx);
+                ctx->m_changeTracker.cache(table, sequence, globalChecksum);
             }
         }
-        else
+
+        if (globalChecksum.clear)
         {
             checksumCtx.rightCtx.type = IntegrityMsgType::INTEGRITY_CLEAR;
         }
+        else
+        {
+            checksumCtx.rightCtx.type     = IntegrityMsgType::INTEGRITY_CHECK_GLOBAL;
+            checksumCtx.rightCtx.begin    = globalChecksum.begin;
+            checksumCtx.rightCtx.end      = globalChecksum.end;
+            checksumCtx.rightCtx.checksum = globalChecksum.checksum;
+        }
 
         m_synchronizationController.start(handle, jsStartParamsTable, checksumCtx.rightCtx.id);
         // rightCtx will have the final checksum based on fillChecksum method. After processing all checksum select data
         // checksumCtx.rightCtx will have the needed (final) information
         messageCreator->send(callbackWrapper, startConfiguration, checksumCtx.rightCtx);
 
-        Log::debugVerbose << "Remote sync started: " << RSync::IntegrityCommands[checksumCtx.rightCtx.type] << LogEndl;
+        LogIfEnabled(Log::debugVerbose) << "Remote sync started: " << RSync::IntegrityCommands[checksumCtx.rightCtx.type] << LogEndl;
     }
     else
     {
@@ -151,24 +166,65 @@ void RSyncImplementation::registerSyncId(const RSYNC_HANDLE handle,
 
     const auto ctx { remoteSyncContext(handle) };
     const SyncMsgBodyType syncMessageType { SyncMsgBodyTypeMap.at(syncConfiguration.at("decoder_type")) };
+    // Reject unsupported algorithms before any message is processed.
+    RangeChecksum::algorithm(syncConfiguration);
 
     ctx->m_msgDispatcher->setMessageDecoderType(messageHeaderID, syncMessageType);
 
+    std::shared_ptr<ChecksumTree> spChecksumTree;
+    const auto itChecksumTree { syncConfiguration.find("checksum_tree") };
+
+    if (syncConfiguration.end() != itChecksumTree && itChecksumTree->get<bool>())
+    {
+        spChecksumTree = std::make_shared<ChecksumTree>(syncConfiguration.at("index").get<std::string>(),
+                                                        syncConfiguration.at("checksum_field").get<std::string>());
+        std::lock_guard<std::mutex> lock{ ctx->m_checksumTreesMutex };
+        ctx->m_checksumTrees[messageHeaderID] = spChecksumTree;
+    }
+
+    // The components reporting every row change may reuse the global checksum of their unchanged tables.
+    const auto itChangeTracking { syncConfiguration.find("change_tracking") };
+
+    if (spChecksumTree || (syncConfiguration.end() != itChangeTracking && itChangeTracking->get<bool>()))
+    {
+        ctx->m_changeTracker.track(messageHeaderID, syncConfiguration.at("table").get<std::string>());
+    }
+
+    std::shared_ptr<TokenBucket> spTokenBucket;
+    const auto itRateLimit { syncConfiguration.find("rate_limit") };
+
+    if (syncConfiguration.end() != itRateLimit && itRateLimit->get<unsigned int>() > 0)
+    {
+        spTokenBucket = std::make_shared<TokenBucket>(itRateLimit->get<unsigned int>());
+    }
+
     const auto registerCallback
     {
-        [spDBSyncWrapper, syncConfiguration, callbackWrapper, handle] (const SyncInputData & syncData)
+        [spDBSyncWrapper, syncConfiguration, callbackWrapper, handle, spChecksumTree, spTokenBucket, spBackpressure = ctx->m_spBackpressure] (const SyncInputData & syncData)
         {
             try
             {
                 m_synchronizationController.checkId(handle, syncConfiguration.at("table"), syncData.id);
 
+                // Every message waits for the rate limit and the backpressure hook, and stops the
+                // operation once the session is cancelled.
+                const auto spSession { m_synchronizationController.session(handle, syncConfiguration.at("table")) };
+                const ResultCallback sessionCallback
+                {
+                    [&spSession, &spTokenBucket, &spBackpressure, &callbackWrapper](const std::string & message)
+                    {
+                        spSession->throttle(spTokenBucket, spBackpressure);
+                        callbackWrapper(message);
+                    }
+                };
+
                 if (0 == syncData.command.compare("checksum_fail"))
                 {
-                    sendChecksumFail(spDBSyncWrapper, syncConfiguration, callbackWrapper, syncData);
+                    sendChecksumFail(spDBSyncWrapper, syncConfiguration, sessionCallback, syncData, spChecksumTree);
                 }
                 else if (0 == syncData.command.compare("no_data"))
                 {
-                    sendAllData(spDBSyncWrapper, syncConfiguration, callbackWrapper, syncData);
+                    sendAllData(spDBSyncWrapper, syncConfiguration, sessionCallback, syncData);
                 }
                 else
                 {
@@ -188,21 +244,102 @@ void RSyncImplementation::registerSyncId(const RSYNC_HANDLE handle,
 }
 
 
-void RSyncImplementation::push(const RSYNC_HANDLE handle, const std::vector<unsigned char>& data)
+/**
+ * @brief Lane of a manager message "<header> <command> <payload>": the full state dumps asked with
+ * no_data go behind the checksum_fail ranges, which are small and answer a pending integrity check.
+ */
+static Utils::DispatchPriority messagePriority(const std::vector<unsigned char>& data)
+{
+    static const std::string NO_DATA_COMMAND { "no_data" };
+    const auto commandBegin { std::find(data.begin(), data.end(), ' ') };
+
+    if (data.end() != commandBegin &&
+            static_cast<size_t>(std::distance(commandBegin + 1, data.end())) >= NO_DATA_COMMAND.size() &&
+            std::equal(NO_DATA_COMMAND.begin(), NO_DATA_COMMAND.end(), commandBegin + 1))
+    {
+        return Utils::DispatchPriority::LOW;
+    }
+
+    return Utils::DispatchPriority::HIGH;
+}
+
+void RSyncImplementation::push(const RSYNC_HANDLE handle, std::vector<unsigned char> data)
 {
     const auto spRSyncContext
     {
         remoteSyncContext(handle)
     };
-    spRSyncContext->m_msgDispatcher->push(data);
+    const auto priority { messagePriority(data) };
+    spRSyncContext->m_msgDispatcher->push(std::move(data), priority);
+}
+
+void RSyncImplementation::setBackpressureCallback(const RSYNC_HANDLE handle,
+                                                  const BackpressureCallback& callback)
+{
+    remoteSyncContext(handle)->m_spBackpressure->callback(callback);
+}
+
+void RSyncImplementation::notifyRowChange(const RSYNC_HANDLE handle,
+                                          const std::string& messageHeaderId,
+                                          const ReturnTypeCallback type,
+                                          const nlohmann::json& row)
+{
+    const auto spRSyncContext
+    {
+        remoteSyncContext(handle)
+    };
+    if (INSERTED == type || MODIFIED == type || DELETED == type)
+    {
+        spRSyncContext->m_changeTracker.change(messageHeaderId);
+    }
+
+    std::shared_ptr<ChecksumTree> spChecksumTree;
+    {
+        std::lock_guard<std::mutex> lock{ spRSyncContext->m_checksumTreesMutex };
+        const auto it { spRSyncContext->m_checksumTrees.find(messageHeaderId) };
+
+        if (spRSyncContext->m_checksumTrees.end() != it)
+        {
+            spChecksumTree = it->second;
+        }
+    }
+
+    // Components registered without a checksum tree have nothing to keep up to date.
+    if (spChecksumTree)
+    {
+        spChecksumTree->update(type, row);
+    }
 }
 
 void RSyncImplementation::sendChecksumFail(const std::shared_ptr<DBSyncWrapper>& spDBSyncWrapper,
                                            const nlohmann::json& jsonSyncConfiguration,
                                            const ResultCallback callbackWrapper,
-                                           const SyncInputData syncData)
+                                           const SyncInputData syncData,
+                                           const std::shared_ptr<ChecksumTree>& spChecksumTree)
 {
-    const auto size { getRangeCount(spDBSyncWrapper, jsonSyncConfiguration, syncData) };
+    if (spChecksumTree && !spChecksumTree->loaded())
+    {
+        loadChecksumTree(spDBSyncWrapper, jsonSyncConfiguration, *spChecksumTree);
+    }
+
+    // The range rows are read once when they can be split in memory, otherwise they are counted first.
+    const auto itSinglePass { jsonSyncConfiguration.find("single_pass_split") };
+    const auto singlePass { spChecksumTree || (jsonSyncConfiguration.end() != itSinglePass && itSinglePass->get<bool>()) };
+    RangeChecksums rangeChecksums;
+
+    if (spChecksumTree)
+    {
+        spChecksumTree->forEach(syncData.begin, syncData.end, [&rangeChecksums](const std::string & index, const std::string & checksum)
+        {
+            rangeChecksums.emplace_back(index, checksum);
+        });
+    }
+    else if (singlePass)
+    {
+        rangeChecksums = getRangeChecksums(spDBSyncWrapper, jsonSyncConfiguration, syncData);
+    }
+
+    const auto size { singlePass ? rangeChecksums.size() : getRangeCount(spDBSyncWrapper, jsonSyncConfiguration, syncData) };
 
     if (1 == size && syncData.begin.compare(syncData.end) == 0)
     {
@@ -224,7 +361,15 @@ void RSyncImplementation::sendChecksumFail(const std::shared_ptr<DBSyncWrapper>&
         checksumCtx.rightCtx.id = syncData.id;
         checksumCtx.rightCtx.type = IntegrityMsgType::INTEGRITY_CHECK_RIGHT;
         checksumCtx.rightCtx.end = syncData.end;
-        fillChecksum(spDBSyncWrapper, jsonSyncConfiguration, syncData.begin, syncData.end, checksumCtx);
+
+        if (singlePass)
+        {
+            splitChecksum(jsonSyncConfiguration, rangeChecksums, checksumCtx);
+        }
+        else
+        {
+            fillChecksum(spDBSyncWrapper, jsonSyncConfiguration, syncData.begin, syncData.end, checksumCtx);
+        }
 
         messageCreator->send(callbackWrapper, jsonSyncConfiguration, checksumCtx.leftCtx);
         messageCreator->send(callbackWrapper, jsonSyncConfiguration, checksumCtx.rightCtx);
@@ -247,11 +392,11 @@ size_t RSyncImplementation::getRangeCount(const std::shared_ptr<DBSyncWrapper>&
     const auto& countFieldName { querySelect.at("count_field_name").get_ref<const std::string&>() };
 
     size_t size { 0ull };
-    ResultCallbackData callback
+    RowCallbackData callback
     {
-        [&size, &countFieldName] (ReturnTypeCallback /*returnType*/, const nlohmann::json & resultJSON)
+        [&size, &countFieldName] (const DbSync::IRowView & row)
         {
-            size = resultJSON.at(countFieldName);
+            size = row.getInt64(row.columnIndex(countFieldName));
         }
     };
 
@@ -264,7 +409,7 @@ size_t RSyncImplementation::getRangeCount(const std::shared_ptr<DBSyncWrapper>&
     queryParam["distinct_opt"] = querySelect.at("distinct_opt");
     queryParam["order_by_opt"] = querySelect.at("order_by_opt");
 
-    spDBSyncWrapper->select(selectData, callback);
+    spDBSyncWrapper->selectRows(selectData, callback);
 
     return size;
 }
@@ -284,29 +429,39 @@ void RSyncImplementation::fillChecksum(const std::shared_ptr<DBSyncWrapper>& spD
     auto index { 1ull };
     const auto middle { ctx.size / 2 };
 
-    std::unique_ptr<Utils::HashData> hash{ std::make_unique<Utils::HashData>() };
-    ResultCallbackData callback
+    RangeChecksum hash{ jsonSyncConfiguration };
+    // Looked up on the first row, the columns keep their position during the query.
+    auto checksumColumn { -1 };
+    auto indexColumn { -1 };
+    RowCallbackData callback
     {
-        [&] (ReturnTypeCallback /*callback*/, const nlohmann::json & resultJSON)
+        [&] (const DbSync::IRowView & row)
         {
-            const auto checksumValue { resultJSON.at(checksumFieldName).get_ref<const std::string&>() };
-            hash->update(checksumValue.data(), checksumValue.size());
+            if (-1 == checksumColumn)
+            {
+                checksumColumn = row.columnIndex(checksumFieldName);
+
+                if (CHECKSUM_SPLIT == ctx.type)
+                {
+                    indexColumn = row.columnIndex(jsonSyncConfiguration.at("index").get_ref<const std::string&>());
+                }
+            }
+
+            hash.update(row.getString(checksumColumn));
 
             if (CHECKSUM_SPLIT == ctx.type)
             {
-                const auto& indexFieldName { jsonSyncConfiguration.at("index").get_ref<const std::string&>() };
-                const auto& result{resultJSON.at(indexFieldName)};
-
+                // Integer indexes are read as text, the same digits std::to_string gives.
                 if (middle + 1 == index)
                 {
-                    ctx.rightCtx.begin = result.is_string() ? result.get_ref<const std::string&>() : std::to_string(result.get<unsigned long>());
+                    ctx.rightCtx.begin = row.getString(indexColumn);
                     ctx.leftCtx.tail = ctx.rightCtx.begin;
                 }
                 else if (middle == index)
                 {
-                    ctx.leftCtx.end = result.is_string() ? result.get_ref<const std::string&>() : std::to_string(result.get<unsigned long>());
-                    ctx.leftCtx.checksum = Utils::asciiToHex(hash->hash());
-                    hash = std::make_unique<Utils::HashData>();
+                    ctx.leftCtx.end = row.getString(indexColumn);
+                    ctx.leftCtx.checksum = hash.digest();
+                    hash.reset();
                 }
 
                 ++index;
@@ -324,10 +479,102 @@ void RSyncImplementation::fillChecksum(const std::shared_ptr<DBSyncWrapper>& spD
     queryParam["distinct_opt"] = querySelect.at("distinct_opt");
     queryParam["order_by_opt"] = querySelect.at("order_by_opt");
 
-    spDBSyncWrapper->select(selectData, callback);
+    spDBSyncWrapper->selectRows(selectData, callback);
 
     // rightCtx field will have the final checksum
-    ctx.rightCtx.checksum = Utils::asciiToHex(hash->hash());
+    ctx.rightCtx.checksum = hash.digest();
+}
+
+RangeChecksums RSyncImplementation::getRangeChecksums(const std::shared_ptr<DBSyncWrapper>& spDBSyncWrapper,
+                                                      const nlohmann::json& jsonSyncConfiguration,
+                                                      const SyncInputData& syncData)
+{
+    nlohmann::json selectData;
+    selectData["table"] = jsonSyncConfiguration.at("table");
+
+    const auto& querySelect { jsonSyncConfiguration.at("range_checksum_query_json") };
+    const auto& indexFieldName { jsonSyncConfiguration.at("index").get_ref<const std::string&>() };
+    const auto& checksumFieldName { jsonSyncConfiguration.at("checksum_field").get_ref<const std::string&>() };
+
+    RangeChecksums rangeChecksums;
+    ResultCallbackData callback
+    {
+        [&] (ReturnTypeCallback /*callback*/, const nlohmann::json & resultJSON)
+        {
+            const auto& result{resultJSON.at(indexFieldName)};
+            rangeChecksums.emplace_back(result.is_string() ? result.get_ref<const std::string&>() : std::to_string(result.get<unsigned long>()),
+                                        resultJSON.at(checksumFieldName).get_ref<const std::string&>());
+        }
+    };
+
+    auto rowFilter { querySelect.at("row_filter").get_ref<const std::string&>() } ;
+    Utils::replaceFirst(rowFilter, "?", syncData.begin);
+    Utils::replaceFirst(rowFilter, "?", syncData.end);
+
+    // Only the index and the checksum are needed to split the range.
+    auto& queryParam { selectData["query"] };
+    queryParam["row_filter"] = rowFilter;
+    queryParam["column_list"] = nlohmann::json::array({ indexFieldName, checksumFieldName });
+    queryParam["distinct_opt"] = querySelect.at("distinct_opt");
+    queryParam["order_by_opt"] = querySelect.at("order_by_opt");
+
+    spDBSyncWrapper->select(selectData, callback);
+
+    return rangeChecksums;
+}
+
+void RSyncImplementation::splitChecksum(const nlohmann::json& jsonSyncConfiguration,
+                                        const RangeChecksums& rangeChecksums,
+                                        ChecksumContext& ctx)
+{
+    const auto middle { ctx.size / 2 };
+    const auto hashRange
+    {
+        [&jsonSyncConfiguration, &rangeChecksums](const size_t first, const size_t last)
+        {
+            RangeChecksum hash { jsonSyncConfiguration };
+
+            for (auto i { first }; i < last; ++i)
+            {
+                hash.update(rangeChecksums[i].second);
+            }
+
+            return hash.digest();
+        }
+    };
+
+    ctx.leftCtx.end = rangeChecksums[middle - 1].first;
+    ctx.leftCtx.checksum = hashRange(0, middle);
+    ctx.rightCtx.begin = rangeChecksums[middle].first;
+    ctx.leftCtx.tail = ctx.rightCtx.begin;
+    ctx.rightCtx.checksum = hashRange(middle, rangeChecksums.size());
+}
+
+void RSyncImplementation::loadChecksumTree(const std::shared_ptr<DBSyncWrapper>& spDBSyncWrapper,
+                                           const nlohmann::json& jsonSyncConfiguration,
+                                           ChecksumTree& checksumTree)
+{
+    checksumTree.load([&](const std::function<void(const nlohmann::json&)>& addRow)
+    {
+        ResultCallbackData callback
+        {
+            [&addRow] (ReturnTypeCallback /*callbackType*/, const nlohmann::json & resultJSON)
+            {
+                addRow(resultJSON);
+            }
+        };
+
+        nlohmann::json selectData;
+        selectData["table"] = jsonSyncConfiguration.at("table");
+        auto& queryParam { selectData["query"] };
+        queryParam["row_filter"] = "";
+        queryParam["column_list"] = nlohmann::json::array({ jsonSyncConfiguration.at("index"), jsonSyncConfiguration.at("checksum_field") });
+        queryParam["distinct_opt"] = false;
+        queryParam["order_by_opt"] = "";
+
+        spDBSyncWrapper->select(selectData, callback);
+    });
+    LogIfEnabled(Log::debugVerbose) << "Checksum tree loaded for table: " << jsonSyncConfiguration.at("table").get_ref<const std::string&>() << LogEndl;
 }
 
 nlohmann::json RSyncImplementation::getRowData(const std::shared_ptr<DBSyncWrapper>& spDBSyncWrapper,
@@ -401,15 +648,29 @@ void RSyncImplementation::sendAllData(const std::shared_ptr<DBSyncWrapper>& spDB
                                       const SyncInputData& syncData)
 {
     const auto& messageCreator { FactoryMessageCreator<nlohmann::json, MessageType::ROW_DATA>::create() };
+    std::unique_ptr<MessageRowDataBatch> spBatch;
+
+    if (jsonSyncConfiguration.contains("state_batch"))
+    {
+        spBatch = std::make_unique<MessageRowDataBatch>(callbackWrapper, jsonSyncConfiguration);
+    }
+
     ResultCallbackData callback
     {
-        [&callbackWrapper, &messageCreator, &jsonSyncConfiguration] (ReturnTypeCallback /*callbackType*/, const nlohmann::json & resultJSON)
+        [&callbackWrapper, &messageCreator, &spBatch, &jsonSyncConfiguration] (ReturnTypeCallback /*callbackType*/, const nlohmann::json & resultJSON)
         {
             const auto component { jsonSyncConfiguration.at("component").get_ref<const std::string&>() };
 
             if (RSyncImplementation::instance().isComponentRegistered(component))
             {
-                messageCreator->send(callbackWrapper, jsonSyncConfiguration, resultJSON);
+                if (spBatch)
+                {
+                    spBatch->add(resultJSON);
+                }
+                else
+                {
+                    messageCreator->send(callbackWrapper, jsonSyncConfiguration, resultJSON);
+                }
             }
             else
             {
@@ -435,6 +696,10 @@ void RSyncImplementation::sendAllData(const std::shared_ptr<DBSyncWrapper>& spDB
 
     spDBSyncWrapper->select(selectData, callback);
 
+    if (spBatch)
+    {
+        spBatch->flush();
+    }
 }
 
 bool RSyncImplementation::isComponentRegistered(const std::string& component)
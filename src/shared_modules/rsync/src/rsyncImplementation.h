@@ -25,6 +25,9 @@
 #include "dbsyncWrapper.h"
 #include "cjsonSmartDeleter.hpp"
 #include "synchronizationController.hpp"
+#include "checksumTree.hpp"
+#include "changeTracker.hpp"
+#include "syncSession.hpp"
 
 namespace RSync
 {
@@ -73,8 +76,9 @@ namespace RSync
         { "JSON_RANGE", SYNC_RANGE_JSON }
     };
 
+    using RangeChecksums = std::vector<std::pair<std::string, std::string>>;
     using ResultCallback = std::function<void(const std::string&)>;
-    using MsgDispatcher = Utils::MsgDispatcher<std::string, SyncInputData, std::vector<unsigned char>, SyncDecoder>;
+    using MsgDispatcher = Utils::MsgDispatcher<std::string, SyncInputData, std::vector<unsigned char>, SyncDecoder, Utils::ExecutorDispatcher>;
 
     class RSyncImplementation final
     {
@@ -104,7 +108,15 @@ namespace RSync
                                 const ResultCallback callbackWrapper);
 
             void push(const RSYNC_HANDLE handle,
-                      const std::vector<unsigned char>& data);
+                      std::vector<unsigned char> data);
+
+            void notifyRowChange(const RSYNC_HANDLE handle,
+                                 const std::string& messageHeaderId,
+                                 const ReturnTypeCallback type,
+                                 const nlohmann::json& row);
+
+            void setBackpressureCallback(const RSYNC_HANDLE handle,
+                                         const BackpressureCallback& callback);
 
             bool isComponentRegistered(const std::string& component);
 
@@ -116,8 +128,13 @@ namespace RSync
                 public:
                     RSyncContext(const unsigned int threadPoolSize, const size_t maxQueueSize)
                         : m_msgDispatcher { std::make_shared<MsgDispatcher>(threadPoolSize, maxQueueSize) }
+                        , m_spBackpressure { std::make_shared<Backpressure>() }
                     { }
                     std::shared_ptr<MsgDispatcher> m_msgDispatcher;
+                    std::shared_ptr<Backpressure> m_spBackpressure;
+                    std::map<std::string, std::shared_ptr<ChecksumTree>> m_checksumTrees;
+                    std::mutex m_checksumTreesMutex;
+                    ChangeTracker m_changeTracker;
             };
 
             std::shared_ptr<RSyncContext> remoteSyncContext(const RSYNC_HANDLE handle);
@@ -132,6 +149,18 @@ namespace RSync
                                      const std::string& end,
                                      ChecksumContext& ctx);
 
+            static RangeChecksums getRangeChecksums(const std::shared_ptr<DBSyncWrapper>& spDBSyncWrapper,
+                                                    const nlohmann::json& jsonSyncConfiguration,
+                                                    const SyncInputData& syncData);
+
+            static void splitChecksum(const nlohmann::json& jsonSyncConfiguration,
+                                      const RangeChecksums& rangeChecksums,
+                                      ChecksumContext& ctx);
+
+            static void loadChecksumTree(const std::shared_ptr<DBSyncWrapper>& spDBSyncWrapper,
+                                         const nlohmann::json& jsonSyncConfiguration,
+                                         ChecksumTree& checksumTree);
+
             static nlohmann::json getRowData(const std::shared_ptr<DBSyncWrapper>& spDBSyncWrapper,
                                              const nlohmann::json& jsonSyncConfiguration,
                                              const std::string& index = "");
@@ -149,7 +178,8 @@ namespace RSync
             static void sendChecksumFail(const std::shared_ptr<DBSyncWrapper>& spDBSyncWrapper,
                                          const nlohmann::json& jsonSyncConfiguration,
                                          const ResultCallback callbackWrapper,
-                                         const SyncInputData syncData);
+                                         const SyncInputData syncData,
+                                         const std::shared_ptr<ChecksumTree>& spChecksumTree);
 
             RSyncImplementation() = default;
             ~RSyncImplementation() = default;
@@ -57,6 +57,14 @@ namespace RSync
     {
         std::make_pair(10, "Handle not found." )
     };
+    constexpr auto INVALID_CHECKSUM_ALGORITHM
+    {
+        std::make_pair(11, "Invalid checksum algorithm." )
+    };
+    constexpr auto SYNC_SESSION_CANCELLED
+    {
+        std::make_pair(12, "Synchronization session cancelled." )
+    };
 
     /**
      *   This class should be used by concrete types to report errors.
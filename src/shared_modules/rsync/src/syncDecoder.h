@@ -12,6 +12,7 @@
 #ifndef _MSGDECODER_SYNC_H
 #define _MSGDECODER_SYNC_H
 
+#include <algorithm>
 #include <iostream>
 #include <mutex>
 #include "commonDefs.h"
@@ -30,12 +31,11 @@ namespace RSync
             {
                 try
                 {
-                    const std::string rawDataString { reinterpret_cast<const char*>(rawData.data()), rawData.size() };
-                    const auto firstToken { rawDataString.find(' ') };
+                    const auto firstToken { std::find(rawData.begin(), rawData.end(), ' ') };
 
-                    if (std::string::npos != firstToken)
+                    if (rawData.end() != firstToken)
                     {
-                        const auto header { rawDataString.substr(0, firstToken) };
+                        const std::string header { rawData.begin(), firstToken };
                         std::lock_guard<std::mutex> lock{ m_mutex };
                         return std::make_pair(header, m_decodersRegistered.at(header)->decode(rawData));
                     }
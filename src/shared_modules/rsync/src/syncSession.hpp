@@ -0,0 +1,176 @@
+/*
+ * Wazuh RSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _SYNC_SESSION_HPP
+#define _SYNC_SESSION_HPP
+
+#include "rsync_exception.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace RSync
+{
+    constexpr auto BACKPRESSURE_POLL_INTERVAL { std::chrono::milliseconds(100) };
+
+    using BackpressureCallback = std::function<bool()>;
+
+    /**
+     * @brief Token bucket limiting the messages per second sent by a component.
+     *
+     * The bucket holds up to one second worth of tokens, so a component may burst up to its rate.
+     */
+    class TokenBucket final
+    {
+        public:
+            explicit TokenBucket(const unsigned int messagesPerSecond)
+                : m_rate { static_cast<double>(messagesPerSecond) }
+                , m_tokens { m_rate }
+                , m_last { std::chrono::steady_clock::now() }
+            { }
+            // LCOV_EXCL_START
+            ~TokenBucket() = default;
+            // LCOV_EXCL_STOP
+
+            /**
+             * @brief Takes one token from the bucket.
+             *
+             * @return Time to wait before the message that took the token can be sent.
+             */
+            std::chrono::nanoseconds acquire()
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                const auto now { std::chrono::steady_clock::now() };
+                const std::chrono::duration<double> elapsed { now - m_last };
+
+                m_last = now;
+                m_tokens = std::min(m_rate, m_tokens + elapsed.count() * m_rate) - 1.0;
+
+                return m_tokens >= 0.0
+                       ? std::chrono::nanoseconds::zero()
+                       : std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double> { -m_tokens / m_rate });
+            }
+
+        private:
+            const double m_rate;
+            double m_tokens;
+            std::chrono::steady_clock::time_point m_last;
+            std::mutex m_mutex;
+    };
+
+    /**
+     * @brief Holder of the hook telling whether the messages of an rsync handle must be held back.
+     *
+     * It is meant to report the fill level of the agent sending buffer.
+     */
+    class Backpressure final
+    {
+        public:
+            void callback(const BackpressureCallback& callback)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                m_callback = callback;
+            }
+
+            bool paused()
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                return m_callback && m_callback();
+            }
+
+        private:
+            BackpressureCallback m_callback;
+            std::mutex m_mutex;
+    };
+
+    /**
+     * @brief Synchronization session started for a table with a given sync id.
+     *
+     * The session is cancelled when a newer sync id is started for the same table or the rsync
+     * handle is released. Senders check it between messages, so a cancelled session stops at the
+     * next row instead of finishing the whole select.
+     */
+    class SyncSession final
+    {
+        public:
+            explicit SyncSession(const int32_t id)
+                : m_id { id }
+                , m_cancelled { false }
+            { }
+            // LCOV_EXCL_START
+            ~SyncSession() = default;
+            // LCOV_EXCL_STOP
+
+            int32_t id() const
+            {
+                return m_id;
+            }
+
+            void cancel()
+            {
+                {
+                    std::lock_guard<std::mutex> lock{ m_mutex };
+                    m_cancelled = true;
+                }
+                m_cv.notify_all();
+            }
+
+            bool cancelled()
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                return m_cancelled;
+            }
+
+            /**
+             * @brief Blocks until one more message can be sent.
+             *
+             * @param spTokenBucket  Rate limit of the component, no limit is applied when it is null.
+             * @param spBackpressure Hook holding back the messages while it reports pressure.
+             *
+             * @details Throws SYNC_SESSION_CANCELLED when the session is cancelled while waiting.
+             */
+            void throttle(const std::shared_ptr<TokenBucket>& spTokenBucket,
+                          const std::shared_ptr<Backpressure>& spBackpressure)
+            {
+                while (spBackpressure && spBackpressure->paused() && !waitFor(BACKPRESSURE_POLL_INTERVAL));
+
+                if (spTokenBucket)
+                {
+                    waitFor(spTokenBucket->acquire());
+                }
+
+                if (cancelled())
+                {
+                    throw rsync_error { SYNC_SESSION_CANCELLED };
+                }
+            }
+
+        private:
+            bool waitFor(const std::chrono::nanoseconds& timeout)
+            {
+                std::unique_lock<std::mutex> lock{ m_mutex };
+                return m_cv.wait_for(lock, timeout, [this]()
+                {
+                    return m_cancelled;
+                });
+            }
+
+            const int32_t m_id;
+            bool m_cancelled;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+    };
+} // namespace RSync
+
+#endif // _SYNC_SESSION_HPP
@@ -15,6 +15,8 @@
 #include "commonDefs.h"
 #include "loggerHelper.h"
 #include "rsync_exception.h"
+#include "syncSession.hpp"
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <unordered_map>
@@ -28,6 +30,16 @@ namespace RSync
             {
                 std::lock_guard<std::mutex> lock{ m_mutex };
                 m_data[key][table] = value;
+
+                auto& spSession { m_sessions[key][table] };
+
+                // A new sync id supersedes the session still sending data for the previous one.
+                if (spSession)
+                {
+                    spSession->cancel();
+                }
+
+                spSession = std::make_shared<SyncSession>(value);
             }
 
             void stop(const RSYNC_HANDLE key)
@@ -38,12 +50,46 @@ namespace RSync
                 {
                     m_data.erase(key);
                 }
+
+                const auto itSessions { m_sessions.find(key) };
+
+                if (itSessions != m_sessions.end())
+                {
+                    cancelSessions(itSessions->second);
+                    m_sessions.erase(itSessions);
+                }
             }
 
             void clear()
             {
                 std::lock_guard<std::mutex> lock{ m_mutex };
                 m_data.clear();
+
+                for (auto& sessions : m_sessions)
+                {
+                    cancelSessions(sessions.second);
+                }
+
+                m_sessions.clear();
+            }
+
+            /**
+             * @brief Session of the sync currently running for \p table.
+             *
+             * @details When no sync was started for the table, a session is created so it is
+             * cancelled like the others when the handle is stopped.
+             */
+            std::shared_ptr<SyncSession> session(const RSYNC_HANDLE key, const std::string& table)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                auto& spSession { m_sessions[key][table] };
+
+                if (!spSession)
+                {
+                    spSession = std::make_shared<SyncSession>(0);
+                }
+
+                return spSession;
             }
 
             void checkId(const RSYNC_HANDLE key, const std::string& table, const int32_t value)
@@ -68,15 +114,24 @@ namespace RSync
 
                         if (value > itTable->second)
                         {
-                            Log::debugVerbose << "Sync id: " << std::to_string(value) << " is not the current id: "
-                                              << std::to_string(itTable->second) << " for table: " << table << LogEndl;
+                            Log::debugVerbose << "Sync id: " << value << " is not the current id: "
+                                              << itTable->second << " for table: " << table << LogEndl;
                             throw std::runtime_error { "Sync id is not the current id" };
                         }
                     }
                 }
             }
         private:
+            static void cancelSessions(const std::unordered_map<std::string, std::shared_ptr<SyncSession>>& sessions)
+            {
+                for (const auto& session : sessions)
+                {
+                    session.second->cancel();
+                }
+            }
+
             std::unordered_map<RSYNC_HANDLE, std::unordered_map<std::string, int32_t>> m_data;
+            std::unordered_map<RSYNC_HANDLE, std::unordered_map<std::string, std::shared_ptr<SyncSession>>> m_sessions;
             std::mutex m_mutex;
     };
 } // namespace RSync
@@ -173,6 +173,223 @@ TEST_F(RSyncImplementationTest, ValidDecoderPushedNoData)
     EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
 }
 
+TEST_F(RSyncImplementationTest, ValidDecoderPushedNoDataStateBatch)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+    const auto config { R"({"decoder_type":"JSON_RANGE", "component":"test_id","table":"test","index":"path",
+                            "state_batch":{"max_rows":2,"max_size":32768,"compress":false},
+                            "no_data_query_json":{"row_filter":"","column_list":"","distinct_opt":"","order_by_opt":""}})" };
+    const std::vector<std::string> expectedResult
+    {
+        R"({"component":"test_id","type":"state_batch","data":[{"attributes":{"path":"a"},"index":"a","timestamp":""},{"attributes":{"path":"b"},"index":"b","timestamp":""}]})",
+        R"({"component":"test_id","type":"state_batch","data":[{"attributes":{"path":"c"},"index":"c","timestamp":""}]})"
+    };
+    auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    EXPECT_CALL(*mockDbSync, select(_, _)).WillOnce(testing::Return()).WillOnce(testing::Return())
+    .WillOnce(testing::Invoke([](nlohmann::json&, ResultCallbackData callback)
+    {
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"a"})"_json);
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"b"})"_json);
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"c"})"_json);
+    }));
+    std::string buffer{R"(test_id no_data {"begin":"a","end":"c","id":1})"};
+
+    const auto first{reinterpret_cast<const unsigned char*>(buffer.data())};
+    const auto last{first + buffer.size()};
+    const std::vector<unsigned char> data{first, last};
+
+    std::vector<std::string> batches;
+    std::function<void(const std::string&)> callbackWrapper
+    {
+        [&](const std::string & payload)
+        {
+            if (payload.find("state_batch") != std::string::npos)
+            {
+                batches.push_back(payload);
+            }
+        }
+    };
+
+    SyncCallbackData callbackData
+    {
+        [&callbackWrapper](const std::string & payload)
+        {
+            callbackWrapper(payload);
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, nlohmann::json::parse(config), callbackData));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().push(handle, data));
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+    EXPECT_EQ(expectedResult, batches);
+}
+
+TEST_F(RSyncImplementationTest, ValidDecoderPushedNoDataRateLimit)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+    const auto config { R"({"decoder_type":"JSON_RANGE", "component":"test_id","table":"test","index":"path",
+                            "rate_limit":2,
+                            "no_data_query_json":{"row_filter":"","column_list":"","distinct_opt":"","order_by_opt":""}})" };
+    auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    EXPECT_CALL(*mockDbSync, select(_, _)).WillOnce(testing::Return()).WillOnce(testing::Return())
+    .WillOnce(testing::Invoke([](nlohmann::json&, ResultCallbackData callback)
+    {
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"a"})"_json);
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"b"})"_json);
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"c"})"_json);
+    }));
+    std::string buffer{R"(test_id no_data {"begin":"a","end":"c","id":1})"};
+
+    const auto first{reinterpret_cast<const unsigned char*>(buffer.data())};
+    const auto last{first + buffer.size()};
+    const std::vector<unsigned char> data{first, last};
+
+    std::vector<std::chrono::steady_clock::time_point> sent;
+    std::function<void(const std::string&)> callbackWrapper
+    {
+        [&](const std::string & payload)
+        {
+            if (payload.find(R"("type":"state")") != std::string::npos)
+            {
+                sent.push_back(std::chrono::steady_clock::now());
+            }
+        }
+    };
+
+    SyncCallbackData callbackData
+    {
+        [&callbackWrapper](const std::string & payload)
+        {
+            callbackWrapper(payload);
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, nlohmann::json::parse(config), callbackData));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().push(handle, data));
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+    // Two messages fit in the bucket, the third one waits for a new token.
+    ASSERT_EQ(3u, sent.size());
+    EXPECT_GE(sent[2] - sent[0], std::chrono::milliseconds(400));
+}
+
+TEST_F(RSyncImplementationTest, ValidDecoderPushedNoDataBackpressureCancelled)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+    const auto config { R"({"decoder_type":"JSON_RANGE", "component":"test_id","table":"test","index":"path",
+                            "no_data_query_json":{"row_filter":"","column_list":"","distinct_opt":"","order_by_opt":""}})" };
+    auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    EXPECT_CALL(*mockDbSync, select(_, _)).WillOnce(testing::Return()).WillOnce(testing::Return())
+    .WillOnce(testing::Invoke([](nlohmann::json&, ResultCallbackData callback)
+    {
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"a"})"_json);
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"b"})"_json);
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"c"})"_json);
+    }));
+    std::string buffer{R"(test_id no_data {"begin":"a","end":"c","id":1})"};
+
+    const auto first{reinterpret_cast<const unsigned char*>(buffer.data())};
+    const auto last{first + buffer.size()};
+    const std::vector<unsigned char> data{first, last};
+
+    std::vector<std::string> rows;
+    std::function<void(const std::string&)> callbackWrapper
+    {
+        [&](const std::string & payload)
+        {
+            if (payload.find(R"("type":"state")") != std::string::npos)
+            {
+                rows.push_back(payload);
+            }
+        }
+    };
+
+    SyncCallbackData callbackData
+    {
+        [&callbackWrapper](const std::string & payload)
+        {
+            callbackWrapper(payload);
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, nlohmann::json::parse(config), callbackData));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().setBackpressureCallback(handle, []()
+    {
+        return true;
+    }));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().push(handle, data));
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    // Releasing the handle cancels the session held back by the backpressure hook.
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+    EXPECT_TRUE(rows.empty());
+}
+
+TEST_F(RSyncImplementationTest, ValidDecoderPushedNoDataStateBatchCompressed)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+    const auto config { R"({"decoder_type":"JSON_RANGE", "component":"test_id","table":"test","index":"path",
+                            "state_batch":{"max_rows":2,"max_size":32768,"compress":true},
+                            "no_data_query_json":{"row_filter":"","column_list":"","distinct_opt":"","order_by_opt":""}})" };
+    const std::vector<std::string> expectedResult
+    {
+        R"({"component":"test_id","compression":"zlib","data":"eAGLrlZKLCkpykwqLUktVrKqVipILMlQslJKVKrVUcrMS0mtAHN0lEoyc1OLSxJzC4B8pdpYACAwEmc=","size":56,"type":"state_batch"})"
+    };
+    auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    EXPECT_CALL(*mockDbSync, select(_, _)).WillOnce(testing::Return()).WillOnce(testing::Return())
+    .WillOnce(testing::Invoke([](nlohmann::json&, ResultCallbackData callback)
+    {
+        callback(ReturnTypeCallback::GENERIC, R"({"path":"a"})"_json);
+    }));
+    std::string buffer{R"(test_id no_data {"begin":"a","end":"a","id":1})"};
+
+    const auto first{reinterpret_cast<const unsigned char*>(buffer.data())};
+    const auto last{first + buffer.size()};
+    const std::vector<unsigned char> data{first, last};
+
+    std::vector<std::string> batches;
+    std::function<void(const std::string&)> callbackWrapper
+    {
+        [&](const std::string & payload)
+        {
+            if (payload.find("state_batch") != std::string::npos)
+            {
+                batches.push_back(payload);
+            }
+        }
+    };
+
+    SyncCallbackData callbackData
+    {
+        [&callbackWrapper](const std::string & payload)
+        {
+            callbackWrapper(payload);
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, nlohmann::json::parse(config), callbackData));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().push(handle, data));
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+    EXPECT_EQ(expectedResult, batches);
+}
+
 TEST_F(RSyncImplementationTest, ValidDecoderPushedChecksumFail)
 {
     const auto handle { RSync::RSyncImplementation::instance().create() };
@@ -396,6 +613,514 @@ TEST_F(RSyncImplementationTest, ValidDecoderPushedChecksumFailToSplit)
     EXPECT_EQ(TOTAL_EXPECTED_MESSAGES, messageCounter.load());
 }
 
+TEST_F(RSyncImplementationTest, ValidDecoderPushedChecksumFailToSplitSinglePass)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+
+    const auto expectedResult1
+    {
+        R"({"component":"test_component","data":{"begin":"1","checksum":"287befc49446efc633d2c224c627515c1919a2bb","end":"1","id":1,"tail":"2"},"type":"integrity_check_left"})"
+    };
+    const auto expectedResult2
+    {
+        R"({"component":"test_component","data":{"begin":"2","checksum":"287befc49446efc633d2c224c627515c1919a2bb","end":"2","id":1},"type":"integrity_check_right"})"
+    };
+
+    const auto config { R"({
+                            "decoder_type":"JSON_RANGE",
+                            "table":"test",
+                            "component":"test_component",
+                            "index":"test_index_field",
+                            "last_event":"test_last_event_field",
+                            "checksum_field":"checksum",
+                            "single_pass_split":true,
+                            "no_data_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "count_range_query_json":{
+                                "row_filter":"",
+                                "count_field_name":"count_field",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "row_data_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "range_checksum_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            }
+                        })" };
+
+    auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    EXPECT_CALL(*mockDbSync, select(_, _)).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data = R"({"path":"test_path", "checksum":"test_checksum"})"_json;
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data = R"({"path":"test_path", "checksum":"test_checksum"})"_json;
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data["checksum"] = "test_checksum";
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::DoAll(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        EXPECT_EQ(R"(["test_index_field","checksum"])"_json, data.at("query").at("column_list"));
+        data["test_index_field"] = "1";
+        data["test_last_event_field"] = "22";
+        data["checksum"] = "aecf1235445354";
+        callback(ReturnTypeCallback::GENERIC, data);
+    }), testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data["test_index_field"] = "2";
+        data["test_last_event_field"] = "23";
+        data["checksum"] = "aecf1235445354";
+        callback(ReturnTypeCallback::GENERIC, data);
+    })));
+
+    std::atomic<uint64_t> messageCounter { 0 };
+    constexpr auto TOTAL_EXPECTED_MESSAGES { 2ull };
+
+    const auto checkExpected
+    {
+        [&](const std::string & payload) -> ::testing::AssertionResult
+        {
+            auto retVal { ::testing::AssertionFailure() };
+
+            if (0 == payload.compare(expectedResult1) || 0 == payload.compare(expectedResult2))
+            {
+                retVal = ::testing::AssertionSuccess();
+                ++messageCounter;
+            }
+
+            return retVal;
+        }
+    };
+
+    const auto callbackWrapper
+    {
+        [&](const std::string & payload)
+        {
+            EXPECT_PRED1(checkExpected, payload);
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, nlohmann::json::parse(config), callbackWrapper));
+
+    std::string buffer{R"(test_id checksum_fail {"begin":"1","end":"2","id":1})"};
+
+    const auto first{reinterpret_cast<const unsigned char*>(buffer.data())};
+    const auto last{first + buffer.size()};
+    const std::vector<unsigned char> data{first, last};
+
+    std::function<void(const std::string&)> callbackWrapper2
+    {
+        [&](const std::string & payload)
+        {
+            EXPECT_FALSE(payload.empty());
+        }
+    };
+
+    SyncCallbackData callbackData
+    {
+        [&callbackWrapper2](const std::string & payload)
+        {
+            callbackWrapper2(payload);
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().push(handle, data));
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+
+    EXPECT_EQ(TOTAL_EXPECTED_MESSAGES, messageCounter.load());
+}
+
+TEST_F(RSyncImplementationTest, ValidDecoderPushedChecksumFailToSplitSumAlgorithm)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+
+    const auto expectedResult1
+    {
+        R"({"component":"test_component","data":{"algorithm":"sum","begin":"1","checksum":"0000000000000000000000000000000000000001","end":"1","id":1,"tail":"2"},"type":"integrity_check_left"})"
+    };
+    const auto expectedResult2
+    {
+        R"({"component":"test_component","data":{"algorithm":"sum","begin":"2","checksum":"0000000000000000000000000000000000000002","end":"2","id":1},"type":"integrity_check_right"})"
+    };
+
+    const auto config { R"({
+                            "decoder_type":"JSON_RANGE",
+                            "table":"test",
+                            "component":"test_component",
+                            "index":"test_index_field",
+                            "last_event":"test_last_event_field",
+                            "checksum_field":"checksum",
+                            "single_pass_split":true,
+                            "checksum_algorithm":"sum",
+                            "no_data_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "count_range_query_json":{
+                                "row_filter":"",
+                                "count_field_name":"count_field",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "row_data_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "range_checksum_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            }
+                        })" };
+
+    auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    EXPECT_CALL(*mockDbSync, select(_, _)).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data = R"({"path":"test_path", "checksum":"test_checksum"})"_json;
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data = R"({"path":"test_path", "checksum":"test_checksum"})"_json;
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data["checksum"] = "test_checksum";
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::DoAll(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        EXPECT_EQ(R"(["test_index_field","checksum"])"_json, data.at("query").at("column_list"));
+        data["test_index_field"] = "1";
+        data["test_last_event_field"] = "22";
+        data["checksum"] = "0000000000000000000000000000000000000001";
+        callback(ReturnTypeCallback::GENERIC, data);
+    }), testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data["test_index_field"] = "2";
+        data["test_last_event_field"] = "23";
+        data["checksum"] = "0000000000000000000000000000000000000002";
+        callback(ReturnTypeCallback::GENERIC, data);
+    })));
+
+    std::atomic<uint64_t> messageCounter { 0 };
+    constexpr auto TOTAL_EXPECTED_MESSAGES { 2ull };
+
+    const auto checkExpected
+    {
+        [&](const std::string & payload) -> ::testing::AssertionResult
+        {
+            auto retVal { ::testing::AssertionFailure() };
+
+            if (0 == payload.compare(expectedResult1) || 0 == payload.compare(expectedResult2))
+            {
+                retVal = ::testing::AssertionSuccess();
+                ++messageCounter;
+            }
+
+            return retVal;
+        }
+    };
+
+    const auto callbackWrapper
+    {
+        [&](const std::string & payload)
+        {
+            EXPECT_PRED1(checkExpected, payload);
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, nlohmann::json::parse(config), callbackWrapper));
+
+    std::string buffer{R"(test_id checksum_fail {"begin":"1","end":"2","id":1})"};
+
+    const auto first{reinterpret_cast<const unsigned char*>(buffer.data())};
+    const auto last{first + buffer.size()};
+    const std::vector<unsigned char> data{first, last};
+
+    std::function<void(const std::string&)> callbackWrapper2
+    {
+        [&](const std::string & payload)
+        {
+            EXPECT_FALSE(payload.empty());
+        }
+    };
+
+    SyncCallbackData callbackData
+    {
+        [&callbackWrapper2](const std::string & payload)
+        {
+            callbackWrapper2(payload);
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().push(handle, data));
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+
+    EXPECT_EQ(TOTAL_EXPECTED_MESSAGES, messageCounter.load());
+}
+
+TEST_F(RSyncImplementationTest, ChangeTrackingReusesGlobalChecksum)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+    auto config = g_commonConfig;
+    config["table"] = "entry_path";
+    config["change_tracking"] = true;
+    const auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, config, {}));
+
+    auto rows = nlohmann::json::array({ R"({"path":"/a","checksum":"1"})"_json, R"({"path":"/b","checksum":"2"})"_json });
+    const auto selectRows
+    {
+        [&rows](nlohmann::json & data, ResultCallbackData callback)
+        {
+            const auto& query { data.at("query") };
+
+            if (query.contains("count_opt") && 1 == query.at("count_opt"))
+            {
+                callback(SELECTED, 0 == query.at("order_by_opt").get<std::string>().compare("path ASC") ? rows.front() : rows.back());
+            }
+            else
+            {
+                for (const auto& row : rows)
+                {
+                    callback(SELECTED, row);
+                }
+            }
+        }
+    };
+
+    std::vector<nlohmann::json> messages;
+    SyncCallbackData callbackData
+    {
+        [&messages](const std::string & payload)
+        {
+            messages.push_back(nlohmann::json::parse(payload).at("data"));
+        }
+    };
+
+    EXPECT_CALL(*mockDbSync, select(_, _)).Times(3).WillRepeatedly(testing::Invoke(selectRows));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+    testing::Mock::VerifyAndClearExpectations(mockDbSync.get());
+
+    // Nothing changed, the checksum is sent again without reading the table.
+    EXPECT_CALL(*mockDbSync, select(_, _)).Times(0);
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+    testing::Mock::VerifyAndClearExpectations(mockDbSync.get());
+
+    rows.push_back(R"({"path":"/c","checksum":"3"})"_json);
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().notifyRowChange(handle, "test_id", INSERTED, rows.back()));
+
+    EXPECT_CALL(*mockDbSync, select(_, _)).Times(3).WillRepeatedly(testing::Invoke(selectRows));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+
+    ASSERT_EQ(3u, messages.size());
+    EXPECT_EQ(messages[0].at("checksum"), messages[1].at("checksum"));
+    EXPECT_EQ(messages[0].at("end"), messages[1].at("end"));
+    EXPECT_NE(messages[1].at("checksum"), messages[2].at("checksum"));
+    EXPECT_EQ("/c", messages[2].at("end").get<std::string>());
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+}
+
+TEST_F(RSyncImplementationTest, RegisterInvalidChecksumAlgorithm)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+    const auto config = R"({"decoder_type":"JSON_RANGE","table":"test","component":"test_component","index":"test_index_field",
+                            "checksum_field":"checksum","checksum_algorithm":"md5"})"_json;
+    const auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    EXPECT_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, config, nullptr), RSync::rsync_error);
+    EXPECT_FALSE(RSync::RSyncImplementation::instance().isComponentRegistered("test_id"));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+}
+
+TEST_F(RSyncImplementationTest, ValidDecoderPushedChecksumFailToSplitWithChecksumTree)
+{
+    const auto handle { RSync::RSyncImplementation::instance().create() };
+
+    const auto expectedLeft
+    {
+        R"({"component":"test_component","data":{"begin":"1","checksum":"287befc49446efc633d2c224c627515c1919a2bb","end":"1","id":1,"tail":"2"},"type":"integrity_check_left"})"
+    };
+    const auto expectedRight
+    {
+        R"({"component":"test_component","data":{"begin":"2","checksum":"287befc49446efc633d2c224c627515c1919a2bb","end":"2","id":1},"type":"integrity_check_right"})"
+    };
+    const auto expectedModifiedRight
+    {
+        R"({"component":"test_component","data":{"begin":"2","checksum":"dff8217f30cd18eacad3c2c18bef124d2e372af0","end":"2","id":1},"type":"integrity_check_right"})"
+    };
+
+    const auto config { R"({
+                            "decoder_type":"JSON_RANGE",
+                            "table":"test",
+                            "component":"test_component",
+                            "index":"test_index_field",
+                            "last_event":"test_last_event_field",
+                            "checksum_field":"checksum",
+                            "checksum_tree":true,
+                            "no_data_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "count_range_query_json":{
+                                "row_filter":"",
+                                "count_field_name":"count_field",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "row_data_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            },
+                            "range_checksum_query_json":{
+                                "row_filter":"",
+                                "column_list":[
+                                    ""
+                                ],
+                                "distinct_opt":"",
+                                "order_by_opt":""
+                            }
+                        })" };
+
+    auto mockDbSync { std::make_shared<MockDBSync>() };
+
+    // Start sync queries, then a single scan to load the checksum tree: no count or range checksum queries.
+    EXPECT_CALL(*mockDbSync, select(_, _)).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data = R"({"path":"test_path", "checksum":"test_checksum"})"_json;
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data = R"({"path":"test_path", "checksum":"test_checksum"})"_json;
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        data["checksum"] = "test_checksum";
+        callback(ReturnTypeCallback::GENERIC, data);
+    })).WillOnce(testing::Invoke([](nlohmann::json & data, ResultCallbackData callback)
+    {
+        EXPECT_EQ(R"(["test_index_field","checksum"])"_json, data.at("query").at("column_list"));
+        callback(ReturnTypeCallback::SELECTED, R"({"test_index_field":"1","checksum":"aecf1235445354"})"_json);
+        callback(ReturnTypeCallback::SELECTED, R"({"test_index_field":"2","checksum":"aecf1235445354"})"_json);
+    }));
+
+    std::atomic<uint64_t> messageCounter { 0 };
+    std::atomic<uint64_t> modifiedCounter { 0 };
+
+    const auto callbackWrapper
+    {
+        [&](const std::string & payload)
+        {
+            if (0 == payload.compare(expectedModifiedRight))
+            {
+                ++modifiedCounter;
+            }
+            else
+            {
+                EXPECT_TRUE(0 == payload.compare(expectedLeft) || 0 == payload.compare(expectedRight));
+                ++messageCounter;
+            }
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().registerSyncId(handle, "test_id", mockDbSync, nlohmann::json::parse(config), callbackWrapper));
+
+    std::string buffer{R"(test_id checksum_fail {"begin":"1","end":"2","id":1})"};
+
+    const auto first{reinterpret_cast<const unsigned char*>(buffer.data())};
+    const auto last{first + buffer.size()};
+    const std::vector<unsigned char> data{first, last};
+
+    SyncCallbackData callbackData
+    {
+        [](const std::string & payload)
+        {
+            EXPECT_FALSE(payload.empty());
+        }
+    };
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().startRSync(handle, mockDbSync, g_startConfigStmt, callbackData));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().push(handle, data));
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().notifyRowChange(handle, "test_id", MODIFIED,
+                                                                            R"({"new":{"test_index_field":"2","checksum":"bcdf6789"}})"_json));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().notifyRowChange(handle, "unknown_id", DELETED,
+                                                                            R"({"test_index_field":"2"})"_json));
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().push(handle, data));
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+
+    EXPECT_NO_THROW(RSync::RSyncImplementation::instance().release());
+
+    EXPECT_EQ(3ull, messageCounter.load());
+    EXPECT_EQ(1ull, modifiedCounter.load());
+}
+
 TEST_F(RSyncImplementationTest, ValidDecoderPushedChecksumInvalidOperation)
 {
     const auto handle { RSync::RSyncImplementation::instance().create() };
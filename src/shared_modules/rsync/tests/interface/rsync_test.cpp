@@ -451,6 +451,15 @@ TEST_F(RSyncTest, pushMessage)
     ASSERT_EQ(0, rsync_push_message(handle, reinterpret_cast<const void*>(buffer.data()), buffer.size()));
 }
 
+TEST_F(RSyncTest, setBackpressureCallback)
+{
+    const auto handle { rsync_create(THREAD_POOL_SIZE, MAX_QUEUE_SIZE) };
+    const auto callback { [](void*) -> int { return 0; } };
+    ASSERT_NE(0, rsync_set_backpressure_callback(nullptr, callback, nullptr));
+    ASSERT_EQ(0, rsync_set_backpressure_callback(handle, callback, nullptr));
+    ASSERT_EQ(0, rsync_set_backpressure_callback(handle, nullptr, nullptr));
+}
+
 TEST_F(RSyncTest, CloseWithoutInitialization)
 {
     EXPECT_EQ(-1, rsync_close(nullptr));
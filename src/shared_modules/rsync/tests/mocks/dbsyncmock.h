@@ -13,7 +13,9 @@
 #define _MOCKDBSYNC_TEST_H
 
 #include <gmock/gmock.h>
+#include <algorithm>
 #include <string>
+#include <vector>
 #include "dbsyncWrapper.h"
 
 class MockDBSync : public RSync::DBSyncWrapper
@@ -27,6 +29,58 @@ class MockDBSync : public RSync::DBSyncWrapper
                     (nlohmann::json&, ResultCallbackData),
                     (override));
 
+        // The row views are served from the rows of the mocked select.
+        void selectRows(nlohmann::json& data, RowCallbackData callbackData) override
+        {
+            select(data, [&callbackData](ReturnTypeCallback, const nlohmann::json & row)
+            {
+                callbackData(JsonRowView{row});
+            });
+        }
+
+    private:
+        class JsonRowView final : public DbSync::IRowView
+        {
+            public:
+                explicit JsonRowView(const nlohmann::json& row)
+                    : m_row{ row }
+                {
+                    for (const auto& item : row.items())
+                    {
+                        m_names.push_back(item.key());
+                    }
+                }
+                int columnIndex(const std::string& name) const override
+                {
+                    const auto it { std::find(m_names.begin(), m_names.end(), name) };
+                    return m_names.end() != it ? static_cast<int>(it - m_names.begin()) : -1;
+                }
+                bool isNull(const int index) const override
+                {
+                    return value(index).is_null();
+                }
+                int64_t getInt64(const int index) const override
+                {
+                    return value(index).get<int64_t>();
+                }
+                double getDouble(const int index) const override
+                {
+                    return value(index).get<double>();
+                }
+                std::string getString(const int index) const override
+                {
+                    const auto& field { value(index) };
+                    return field.is_string() ? field.get<std::string>() : field.dump();
+                }
+            private:
+                const nlohmann::json& value(const int index) const
+                {
+                    return m_row.at(m_names.at(index));
+                }
+                const nlohmann::json& m_row;
+                std::vector<std::string> m_names;
+        };
+
 };
 
 #endif //_MOCKDBSYNC_TEST_H
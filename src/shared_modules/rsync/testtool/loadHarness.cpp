@@ -0,0 +1,511 @@
+/*
+ * Wazuh RSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "json.hpp"
+#include "dbsync.hpp"
+#include "rsync.hpp"
+#include "rangeChecksum.hpp"
+#include "loadHarnessArgsHelper.h"
+
+constexpr auto HARNESS_TABLE { "harness_rows" };
+constexpr auto HARNESS_INDEX { "key" };
+constexpr auto HARNESS_CHECKSUM { "checksum" };
+constexpr auto HARNESS_RANGE_FILTER { "WHERE key BETWEEN '?' and '?' ORDER BY key" };
+constexpr auto STATE_BATCH_MAX_SIZE { 65536u };
+
+struct HarnessMetrics final
+{
+    std::atomic<uint64_t> agentMessages { 0 };
+    std::atomic<uint64_t> agentBytes { 0 };
+    std::atomic<uint64_t> managerMessages { 0 };
+    std::atomic<uint64_t> managerBytes { 0 };
+    std::atomic<uint64_t> managerCpuNs { 0 };
+    std::atomic<int64_t> lastActivity { 0 };
+};
+
+static int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double processCpuSeconds()
+{
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+static uint64_t threadCpuNs()
+{
+#ifndef _WIN32
+    struct timespec ts {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+#else
+    return static_cast<uint64_t>(nowNs());
+#endif
+}
+
+static std::string rowKey(const size_t id)
+{
+    std::ostringstream key;
+    key << "k" << std::setw(10) << std::setfill('0') << id;
+    return key.str();
+}
+
+static std::string randomChecksum(std::mt19937_64& rng)
+{
+    std::ostringstream checksum;
+    checksum << std::hex << std::setfill('0')
+             << std::setw(16) << rng() << std::setw(16) << rng() << std::setw(8) << (rng() & 0xffffffffull);
+    return checksum.str();
+}
+
+/**
+ * @brief Manager side of the integrity protocol for one agent, as done by analysisd and wazuh-db.
+ *
+ * It keeps the index and checksum of the rows the manager knows and answers the agent
+ * integrity messages with the checksum_fail and no_data requests wazuh-db would trigger.
+ */
+class ManagerDecoder final
+{
+    public:
+        ManagerDecoder(const std::string& component, const nlohmann::json& checksumConfig)
+            : m_component { component }
+            , m_checksumConfig ( checksumConfig )
+        { }
+
+        void seed(std::map<std::string, std::string> rows)
+        {
+            m_rows = std::move(rows);
+        }
+
+        const std::map<std::string, std::string>& rows() const
+        {
+            return m_rows;
+        }
+
+        void decode(const std::string& message, std::vector<std::string>& requests)
+        {
+            const auto jsonMessage = nlohmann::json::parse(message);
+            const auto& type { jsonMessage.at("type").get_ref<const std::string&>() };
+            const auto& data { jsonMessage.at("data") };
+
+            if (0 == type.compare("state"))
+            {
+                saveState(data);
+            }
+            else if (0 == type.compare("state_batch"))
+            {
+                for (const auto& row : data)
+                {
+                    saveState(row);
+                }
+            }
+            else if (0 == type.compare("integrity_clear"))
+            {
+                m_rows.clear();
+            }
+            else
+            {
+                checkRange(type, data, requests);
+            }
+        }
+
+    private:
+        void saveState(const nlohmann::json& data)
+        {
+            m_rows[data.at("index").get<std::string>()] = data.at("attributes").at(HARNESS_CHECKSUM).get<std::string>();
+        }
+
+        void checkRange(const std::string& type, const nlohmann::json& data, std::vector<std::string>& requests)
+        {
+            const auto begin { data.at("begin").get<std::string>() };
+            const auto end { data.at("end").get<std::string>() };
+            const auto first { m_rows.lower_bound(begin) };
+            const auto last { m_rows.upper_bound(end) };
+
+            std::string command;
+
+            if (first == last)
+            {
+                command = "no_data";
+            }
+            else
+            {
+                RSync::RangeChecksum checksum { m_checksumConfig };
+
+                for (auto it { first }; it != last; ++it)
+                {
+                    checksum.update(it->second);
+                }
+
+                if (checksum.digest() != data.at("checksum").get_ref<const std::string&>())
+                {
+                    command = "checksum_fail";
+                }
+            }
+
+            // Same cleanup wazuh-db does with wdbi_delete for the global and left ranges.
+            if (0 == type.compare("integrity_check_global"))
+            {
+                m_rows.erase(m_rows.begin(), first);
+                m_rows.erase(last, m_rows.end());
+            }
+            else if (0 == type.compare("integrity_check_left") && data.contains("tail"))
+            {
+                m_rows.erase(last, m_rows.lower_bound(data.at("tail").get<std::string>()));
+            }
+
+            if (!command.empty())
+            {
+                const nlohmann::json request { {"begin", begin}, {"end", end}, {"id", data.at("id")} };
+                requests.push_back(m_component + " " + command + " " + request.dump());
+            }
+        }
+
+        const std::string m_component;
+        const nlohmann::json m_checksumConfig;
+        std::map<std::string, std::string> m_rows;
+};
+
+class EmulatedAgent final
+{
+    public:
+        EmulatedAgent(const size_t agentId, const LoadHarnessArgs& args, HarnessMetrics& metrics)
+            : m_component { "harness_agent_" + std::to_string(agentId) }
+            , m_dbPath { args.dbFolder() + "/rsync_harness_agent_" + std::to_string(agentId) + ".db" }
+            , m_args { args }
+            , m_metrics { metrics }
+            , m_manager { m_component, nlohmann::json { {"checksum_algorithm", args.algorithm()} } }
+            , m_rounds { 0 }
+        {
+            std::mt19937_64 rng { args.seed() * 1000003ull + agentId };
+            std::uniform_real_distribution<double> divergence { 0.0, 1.0 };
+            std::map<std::string, std::string> managerRows;
+            std::string sqlStatement
+            {
+                "CREATE TABLE harness_rows (key TEXT NOT NULL, payload TEXT, checksum TEXT NOT NULL, PRIMARY KEY (key)) WITHOUT ROWID;"
+                "BEGIN TRANSACTION;"
+            };
+            const std::string payload(args.rowSize(), 'x');
+
+            // Baseline rows use even ids so the rows added on the agent side fall between them.
+            for (size_t i = 0; i < args.rows(); ++i)
+            {
+                const auto key { rowKey(i * 2) };
+                auto checksum { randomChecksum(rng) };
+                managerRows[key] = checksum;
+
+                if (divergence(rng) < args.divergence())
+                {
+                    switch (rng() % 3)
+                    {
+                        case 0:
+                            checksum = randomChecksum(rng);
+                            break;
+
+                        case 1:
+                            checksum.clear();
+                            break;
+
+                        default:
+                            addRow(sqlStatement, rowKey(i * 2 + 1), payload, randomChecksum(rng));
+                            break;
+                    }
+                }
+
+                if (!checksum.empty())
+                {
+                    addRow(sqlStatement, key, payload, checksum);
+                }
+            }
+
+            sqlStatement += "COMMIT;";
+            m_manager.seed(std::move(managerRows));
+
+            removeDatabase();
+            m_spDBSync = std::make_unique<DBSync>(HostType::AGENT, DbEngineType::SQLITE3, m_dbPath, sqlStatement);
+            m_spRSync = std::make_unique<RemoteSync>(1, UNLIMITED_QUEUE_SIZE);
+            m_spRSync->registerSyncID(m_component, m_spDBSync->handle(), registerConfig(), m_callback);
+        }
+
+        ~EmulatedAgent()
+        {
+            m_spRSync.reset();
+            m_spDBSync.reset();
+            removeDatabase();
+        }
+
+        void startSync()
+        {
+            m_spRSync->startSync(m_spDBSync->handle(), startConfig(), m_callback);
+        }
+
+        /**
+         * @brief Sends the manager requests collected since the previous round.
+         *
+         * @return Whether any request was sent.
+         */
+        bool pushRequests(const size_t round)
+        {
+            std::vector<std::string> requests;
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                requests.swap(m_requests);
+            }
+
+            for (const auto& request : requests)
+            {
+                ++m_metrics.managerMessages;
+                m_metrics.managerBytes += request.size();
+                m_spRSync->pushMessage({ request.begin(), request.end() });
+            }
+
+            if (!requests.empty())
+            {
+                m_rounds = round;
+            }
+
+            return !requests.empty();
+        }
+
+        size_t rounds() const
+        {
+            return m_rounds;
+        }
+
+        bool converged()
+        {
+            std::lock_guard<std::mutex> lock { m_mutex };
+            return m_manager.rows() == m_expectedRows;
+        }
+
+    private:
+        void addRow(std::string& sqlStatement, const std::string& key, const std::string& payload, const std::string& checksum)
+        {
+            m_expectedRows[key] = checksum;
+            sqlStatement += "INSERT INTO harness_rows VALUES('" + key + "','" + payload + "','" + checksum + "');";
+        }
+
+        void removeDatabase() const
+        {
+            std::remove(m_dbPath.c_str());
+            std::remove((m_dbPath + "-journal").c_str());
+        }
+
+        void onMessage(const std::string& message)
+        {
+            ++m_metrics.agentMessages;
+            m_metrics.agentBytes += message.size();
+            m_metrics.lastActivity = nowNs();
+
+            // The decoding time is taken out of the process CPU time to get the agent share.
+            const auto start { threadCpuNs() };
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                m_manager.decode(message, m_requests);
+            }
+            m_metrics.managerCpuNs += threadCpuNs() - start;
+        }
+
+        nlohmann::json queryJson(const std::string& filter, const nlohmann::json& columns) const
+        {
+            return nlohmann::json { {"row_filter", filter}, {"column_list", columns}, {"distinct_opt", false}, {"order_by_opt", ""} };
+        }
+
+        nlohmann::json registerConfig() const
+        {
+            nlohmann::json config;
+            config["decoder_type"] = "JSON_RANGE";
+            config["table"] = HARNESS_TABLE;
+            config["component"] = m_component;
+            config["index"] = HARNESS_INDEX;
+            config["checksum_field"] = HARNESS_CHECKSUM;
+            config["checksum_algorithm"] = m_args.algorithm();
+            config["single_pass_split"] = true;
+            config["no_data_query_json"] = queryJson(HARNESS_RANGE_FILTER, {"*"});
+            config["count_range_query_json"] = queryJson(HARNESS_RANGE_FILTER, {"count(*) AS count "});
+            config["count_range_query_json"]["count_field_name"] = "count";
+            config["row_data_query_json"] = queryJson("WHERE key ='?'", {"*"});
+            config["range_checksum_query_json"] = queryJson(HARNESS_RANGE_FILTER, {"*"});
+
+            if (m_args.batchRows())
+            {
+                config["state_batch"] = { {"max_rows", m_args.batchRows()}, {"max_size", STATE_BATCH_MAX_SIZE}, {"compress", false} };
+            }
+
+            return config;
+        }
+
+        nlohmann::json startConfig() const
+        {
+            nlohmann::json config;
+            config["table"] = HARNESS_TABLE;
+            config["component"] = m_component;
+            config["index"] = HARNESS_INDEX;
+            config["checksum_field"] = HARNESS_CHECKSUM;
+            config["checksum_algorithm"] = m_args.algorithm();
+            // The first and last rows are the last ones returned by these queries.
+            config["first_query"] = queryJson(" ", {HARNESS_INDEX});
+            config["first_query"]["order_by_opt"] = "key DESC";
+            config["last_query"] = queryJson(" ", {HARNESS_INDEX});
+            config["last_query"]["order_by_opt"] = "key ASC";
+            config["range_checksum_query_json"] = queryJson(HARNESS_RANGE_FILTER, {"key, checksum"});
+            return config;
+        }
+
+        const std::string m_component;
+        const std::string m_dbPath;
+        const LoadHarnessArgs& m_args;
+        HarnessMetrics& m_metrics;
+        ManagerDecoder m_manager;
+        std::map<std::string, std::string> m_expectedRows;
+        std::vector<std::string> m_requests;
+        std::mutex m_mutex;
+        size_t m_rounds;
+        std::unique_ptr<DBSync> m_spDBSync;
+        std::unique_ptr<RemoteSync> m_spRSync;
+        const std::function<void(const std::string&)> m_callback
+        {
+            [this](const std::string & message)
+            {
+                onMessage(message);
+            }
+        };
+};
+
+static void waitIdle(const HarnessMetrics& metrics, const std::chrono::milliseconds idleWindow)
+{
+    const auto window { std::chrono::duration_cast<std::chrono::nanoseconds>(idleWindow).count() };
+
+    while (nowNs() - metrics.lastActivity < window)
+    {
+        std::this_thread::sleep_for(idleWindow / 5);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        LoadHarnessArgs args(argc, argv);
+        HarnessMetrics metrics;
+
+        const auto logFunction
+        {
+            [](const std::string & msg)
+            {
+                std::cerr << msg << std::endl;
+            }
+        };
+        DBSync::initialize(logFunction);
+        RemoteSync::initialize(logFunction);
+
+        {
+            std::vector<std::unique_ptr<EmulatedAgent>> agents;
+
+            for (size_t i = 0; i < args.agents(); ++i)
+            {
+                agents.push_back(std::make_unique<EmulatedAgent>(i, args, metrics));
+            }
+
+            const auto wallStart { std::chrono::steady_clock::now() };
+            const auto cpuStart { processCpuSeconds() };
+
+            for (const auto& agent : agents)
+            {
+                agent->startSync();
+            }
+
+            metrics.lastActivity = nowNs();
+            size_t round { 0 };
+            auto pending { true };
+
+            while (pending)
+            {
+                waitIdle(metrics, std::chrono::milliseconds(args.idleWindow()));
+                pending = false;
+                ++round;
+
+                for (const auto& agent : agents)
+                {
+                    pending = agent->pushRequests(round) || pending;
+                }
+
+                metrics.lastActivity = nowNs();
+            }
+
+            const auto cpuSeconds { processCpuSeconds() - cpuStart - metrics.managerCpuNs / 1e9 };
+            const std::chrono::duration<double> wallSeconds { std::chrono::steady_clock::now() - wallStart };
+            size_t maxRounds { 0 };
+            size_t totalRounds { 0 };
+            size_t converged { 0 };
+
+            for (const auto& agent : agents)
+            {
+                maxRounds = std::max(maxRounds, agent->rounds());
+                totalRounds += agent->rounds();
+                converged += agent->converged() ? 1 : 0;
+            }
+
+            const auto agentCount { std::max<size_t>(agents.size(), 1) };
+            const nlohmann::json results
+            {
+                {"agents", args.agents()},
+                {"rows", args.rows()},
+                {"divergence", args.divergence()},
+                {"algorithm", args.algorithm()},
+                {"batch_rows", args.batchRows()},
+                {"agent_messages", metrics.agentMessages.load()},
+                {"agent_bytes", metrics.agentBytes.load()},
+                {"manager_messages", metrics.managerMessages.load()},
+                {"manager_bytes", metrics.managerBytes.load()},
+                {"max_rounds", maxRounds},
+                {"mean_rounds", static_cast<double>(totalRounds) / agentCount},
+                {"agent_cpu_ms_per_sync", cpuSeconds * 1e3 / agentCount},
+                {"manager_cpu_ms", metrics.managerCpuNs / 1e6},
+                {"wall_time_s", wallSeconds.count()},
+                {"converged_agents", converged}
+            };
+
+            std::cout << results.dump(4) << std::endl;
+
+            if (!args.outputFile().empty())
+            {
+                std::ofstream outputFile{ args.outputFile() };
+                outputFile << results.dump(4) << std::endl;
+            }
+        }
+
+        RemoteSync::teardown();
+        DBSync::teardown();
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        LoadHarnessArgs::showHelp();
+    }
+
+    return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Wazuh RSYNC
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _LOAD_HARNESS_ARGS_HELPER_H_
+#define _LOAD_HARNESS_ARGS_HELPER_H_
+
+#include <stdexcept>
+#include <string>
+#include <iostream>
+
+class LoadHarnessArgs final
+{
+    public:
+        LoadHarnessArgs(const int argc, const char* argv[])
+            : m_agents{ std::stoul(paramValueOf(argc, argv, "-a", "10")) }
+            , m_rows{ std::stoul(paramValueOf(argc, argv, "-r", "10000")) }
+            , m_divergence{ std::stod(paramValueOf(argc, argv, "-d", "0.01")) }
+            , m_rowSize{ std::stoul(paramValueOf(argc, argv, "-s", "256")) }
+            , m_algorithm{ paramValueOf(argc, argv, "-k", "sha1") }
+            , m_batchRows{ std::stoul(paramValueOf(argc, argv, "-b", "0")) }
+            , m_idleWindow{ std::stoul(paramValueOf(argc, argv, "-w", "50")) }
+            , m_seed{ std::stoul(paramValueOf(argc, argv, "-e", "1")) }
+            , m_dbFolder{ paramValueOf(argc, argv, "-f", "./") }
+            , m_outputFile{ paramValueOf(argc, argv, "-o", "") }
+        {
+            if (m_divergence < 0.0 || m_divergence > 1.0)
+            {
+                throw std::runtime_error
+                {
+                    "Divergence rate must be between 0 and 1."
+                };
+            }
+        }
+
+        unsigned long agents() const
+        {
+            return m_agents;
+        }
+
+        unsigned long rows() const
+        {
+            return m_rows;
+        }
+
+        double divergence() const
+        {
+            return m_divergence;
+        }
+
+        unsigned long rowSize() const
+        {
+            return m_rowSize;
+        }
+
+        const std::string& algorithm() const
+        {
+            return m_algorithm;
+        }
+
+        unsigned long batchRows() const
+        {
+            return m_batchRows;
+        }
+
+        unsigned long idleWindow() const
+        {
+            return m_idleWindow;
+        }
+
+        unsigned long seed() const
+        {
+            return m_seed;
+        }
+
+        const std::string& dbFolder() const
+        {
+            return m_dbFolder;
+        }
+
+        const std::string& outputFile() const
+        {
+            return m_outputFile;
+        }
+
+        static void showHelp()
+        {
+            std::cout << "\nUsage: rsync_load_harness <option(s)>\n"
+                      << "Options:\n"
+                      << "\t-h \t\t\tShow this help message\n"
+                      << "\t-a AGENTS\t\tNumber of emulated agents synchronizing at once (default: 10).\n"
+                      << "\t-r ROWS\t\t\tRows of the synchronized table of each agent (default: 10000).\n"
+                      << "\t-d DIVERGENCE\t\tRate of rows changed, removed or added between agent and manager (default: 0.01).\n"
+                      << "\t-s ROW_SIZE\t\tBytes of payload of each row (default: 256).\n"
+                      << "\t-k ALGORITHM\t\tRange checksum algorithm: sha1, sum (default: sha1).\n"
+                      << "\t-b BATCH_ROWS\t\tRows per state_batch message, 0 sends one state message per row (default: 0).\n"
+                      << "\t-w IDLE_WINDOW\t\tMilliseconds without messages closing a round (default: 50).\n"
+                      << "\t-e SEED\t\t\tSeed of the generated data (default: 1).\n"
+                      << "\t-f DB_FOLDER\t\tFolder where the agent databases are created (default: ./).\n"
+                      << "\t-o OUTPUT_FILE\t\tJSON file where the results are also written.\n"
+                      << "\nExample:"
+                      << "\n\t./rsync_load_harness -a 50 -r 100000 -d 0.001 -k sum -o results.json\n"
+                      << std::endl;
+        }
+
+    private:
+
+        static std::string paramValueOf(const int argc,
+                                        const char* argv[],
+                                        const std::string& switchValue,
+                                        const std::string& defaultValue)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                const std::string currentValue{ argv[i] };
+
+                if (currentValue == "-h")
+                {
+                    throw std::runtime_error
+                    {
+                        "Help requested."
+                    };
+                }
+
+                if (currentValue == switchValue && i + 1 < argc)
+                {
+                    // Switch found
+                    return argv[i + 1];
+                }
+            }
+
+            return defaultValue;
+        }
+
+        const unsigned long m_agents;
+        const unsigned long m_rows;
+        const double m_divergence;
+        const unsigned long m_rowSize;
+        const std::string m_algorithm;
+        const unsigned long m_batchRows;
+        const unsigned long m_idleWindow;
+        const unsigned long m_seed;
+        const std::string m_dbFolder;
+        const std::string m_outputFile;
+};
+
+#endif // _LOAD_HARNESS_ARGS_HELPER_H_
@@ -0,0 +1,177 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _CJSON_CONVERTER_HPP
+#define _CJSON_CONVERTER_HPP
+
+#include <cmath>
+#include "json.hpp"
+#include "cJSON.h"
+
+namespace Utils
+{
+    /**
+     * @brief Converts a cJSON tree into a nlohmann::json one, walking it without a textual intermediate.
+     * @details The values are the ones the JSON text printed by cJSON would be parsed into: integral numbers
+     * below 1e15 are integers, unsigned when they aren't negative, and non finite numbers are null.
+     */
+    static nlohmann::json cJSONToJson(const cJSON* item)
+    {
+        nlohmann::json ret;
+
+        if (!item)
+        {
+            return ret;
+        }
+
+        if (cJSON_IsObject(item))
+        {
+            ret = nlohmann::json::object();
+
+            for (auto child { item->child }; child; child = child->next)
+            {
+                if (child->string)
+                {
+                    ret[child->string] = cJSONToJson(child);
+                }
+            }
+        }
+        else if (cJSON_IsArray(item))
+        {
+            ret = nlohmann::json::array();
+
+            for (auto child { item->child }; child; child = child->next)
+            {
+                ret.push_back(cJSONToJson(child));
+            }
+        }
+        else if (cJSON_IsString(item))
+        {
+            ret = item->valuestring ? item->valuestring : "";
+        }
+        else if (cJSON_IsNumber(item))
+        {
+            const auto number { item->valuedouble };
+
+            if (std::isfinite(number))
+            {
+                // cJSON prints these without a fraction nor an exponent.
+                if (std::trunc(number) == number && std::fabs(number) < 1e15)
+                {
+                    if (number < 0)
+                    {
+                        ret = static_cast<int64_t>(number);
+                    }
+                    else
+                    {
+                        ret = static_cast<uint64_t>(number);
+                    }
+                }
+                else
+                {
+                    ret = number;
+                }
+            }
+        }
+        else if (cJSON_IsBool(item))
+        {
+            ret = cJSON_IsTrue(item) ? true : false;
+        }
+        else if (cJSON_IsRaw(item) && item->valuestring)
+        {
+            ret = nlohmann::json::parse(item->valuestring);
+        }
+
+        return ret;
+    }
+
+    /**
+     * @brief Converts a nlohmann::json tree into a cJSON one, without a textual intermediate.
+     *
+     * @return cJSON tree owned by the caller, nullptr if it can't be allocated.
+     */
+    static cJSON* jsonToCJSON(const nlohmann::json& value)
+    {
+        cJSON* ret { nullptr };
+
+        switch (value.type())
+        {
+            case nlohmann::json::value_t::object:
+                ret = cJSON_CreateObject();
+
+                for (auto it { value.begin() }; ret && it != value.end(); ++it)
+                {
+                    const auto child { jsonToCJSON(it.value()) };
+
+                    if (!child)
+                    {
+                        cJSON_Delete(ret);
+                        ret = nullptr;
+                    }
+                    else
+                    {
+                        cJSON_AddItemToObject(ret, it.key().c_str(), child);
+                    }
+                }
+
+                break;
+
+            case nlohmann::json::value_t::array:
+                ret = cJSON_CreateArray();
+
+                for (auto it { value.begin() }; ret && it != value.end(); ++it)
+                {
+                    const auto child { jsonToCJSON(*it) };
+
+                    if (!child)
+                    {
+                        cJSON_Delete(ret);
+                        ret = nullptr;
+                    }
+                    else
+                    {
+                        cJSON_AddItemToArray(ret, child);
+                    }
+                }
+
+                break;
+
+            case nlohmann::json::value_t::string:
+                ret = cJSON_CreateString(value.get_ref<const std::string&>().c_str());
+                break;
+
+            case nlohmann::json::value_t::boolean:
+                ret = cJSON_CreateBool(value.get<bool>());
+                break;
+
+            case nlohmann::json::value_t::number_integer:
+                ret = cJSON_CreateNumber(static_cast<double>(value.get<int64_t>()));
+                break;
+
+            case nlohmann::json::value_t::number_unsigned:
+                ret = cJSON_CreateNumber(static_cast<double>(value.get<uint64_t>()));
+                break;
+
+            case nlohmann::json::value_t::number_float:
+                // Non finite numbers are dumped as null.
+                ret = std::isfinite(value.get<double>()) ? cJSON_CreateNumber(value.get<double>()) : cJSON_CreateNull();
+                break;
+
+            default:
+                ret = cJSON_CreateNull();
+                break;
+        }
+
+        return ret;
+    }
+}
+
+#endif // _CJSON_CONVERTER_HPP
@@ -12,6 +12,7 @@
 #ifndef _FILESYSTEM_HELPER_HPP
 #define _FILESYSTEM_HELPER_HPP
 
+#include <cstdint>
 #include <filesystem>
 
 /**
@@ -61,6 +62,16 @@ class RealFileSystemT
         {
             return std::filesystem::is_directory(path);
         }
+
+        /**
+         * @brief Last modification time
+         * @param path Path to check
+         * @return The modification time, as a count of the file clock ticks
+         */
+        static int64_t last_write_time(const std::filesystem::path& path)
+        {
+            return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+        }
 };
 
 using RealFileSystem = RealFileSystemT<>;
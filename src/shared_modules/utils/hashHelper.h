@@ -14,6 +14,8 @@
 
 #include <vector>
 #include <memory>
+#include <string>
+#include <stdexcept>
 #include "openssl/evp.h"
 
 namespace Utils
@@ -28,12 +30,20 @@ namespace Utils
         public:
             HashData(const HashType hashType = HashType::Sha1)
                 : m_spCtx{createContext()}
+                , m_hashType{hashType}
             {
                 initializeContext(hashType, m_spCtx);
             }
             // LCOV_EXCL_START
             ~HashData() = default;
             // LCOV_EXCL_STOP
+            /**
+             * @brief Starts a new digest of the same type, reusing the context.
+             */
+            void reset()
+            {
+                initializeContext(m_hashType, m_spCtx);
+            }
             void update(const void* data, const size_t size)
             {
                 const auto ret
@@ -55,10 +65,29 @@ namespace Utils
             std::vector<unsigned char> hash()
             {
                 unsigned char digest[EVP_MAX_MD_SIZE] {0};
+                const auto digestSize{hash(digest, sizeof(digest))};
+                return {digest, digest + digestSize};
+            }
+            /**
+             * @brief Writes the digest into the caller storage, which must fit it (EVP_MAX_MD_SIZE is always enough).
+             *
+             * @return Size of the digest.
+             */
+            size_t hash(unsigned char* output, const size_t size)
+            {
                 unsigned int digestSize{0};
+
+                if (size < static_cast<size_t>(EVP_MD_CTX_size(m_spCtx.get())))
+                {
+                    throw std::runtime_error
+                    {
+                        "Digest buffer too small."
+                    };
+                }
+
                 const auto ret
                 {
-                    EVP_DigestFinal_ex(m_spCtx.get(), digest, &digestSize)
+                    EVP_DigestFinal_ex(m_spCtx.get(), output, &digestSize)
                 };
 
                 // LCOV_EXCL_START
@@ -71,19 +100,83 @@ namespace Utils
                 }
 
                 // LCOV_EXCL_STOP
+                return digestSize;
+            }
+            /**
+             * @brief One-shot digest of a buffer, without a HashData object.
+             */
+            static std::vector<unsigned char> digest(const HashType hashType, const void* data, const size_t size)
+            {
+                unsigned char digest[EVP_MAX_MD_SIZE] {0};
+                unsigned int digestSize{0};
+
+                if (!EVP_Digest(data, size, digest, &digestSize, messageDigest(hashType), nullptr))
+                {
+                    throw std::runtime_error
+                    {
+                        "Error getting digest."
+                    };
+                }
+
                 return {digest, digest + digestSize};
             }
+            static std::vector<unsigned char> sha1(const std::string& data)
+            {
+                return digest(HashType::Sha1, data.data(), data.size());
+            }
+            static std::vector<unsigned char> sha256(const std::string& data)
+            {
+                return digest(HashType::Sha256, data.data(), data.size());
+            }
         private:
+            // Released contexts are kept by each thread for the next HashData, up to MAX_POOLED_CONTEXTS.
+            static constexpr size_t MAX_POOLED_CONTEXTS{8};
+
+            static std::vector<EVP_MD_CTX*>& contextPool()
+            {
+                struct ContextPool final
+                {
+                    std::vector<EVP_MD_CTX*> contexts;
+                    ~ContextPool()
+                    {
+                        for (const auto ctx : contexts)
+                        {
+                            EVP_MD_CTX_destroy(ctx);
+                        }
+                    }
+                };
+                thread_local ContextPool pool;
+                return pool.contexts;
+            }
+
             struct EvpContextDeleter final
             {
                 void operator()(EVP_MD_CTX* ctx)
                 {
-                    EVP_MD_CTX_destroy(ctx);
+                    auto& pool{contextPool()};
+
+                    if (pool.size() < MAX_POOLED_CONTEXTS)
+                    {
+                        pool.push_back(ctx);
+                    }
+                    else
+                    {
+                        EVP_MD_CTX_destroy(ctx);
+                    }
                 }
             };
 
             static EVP_MD_CTX* createContext()
             {
+                auto& pool{contextPool()};
+
+                if (!pool.empty())
+                {
+                    const auto ctx{pool.back()};
+                    pool.pop_back();
+                    return ctx;
+                }
+
                 auto ctx{ EVP_MD_CTX_create() };
 
                 // LCOV_EXCL_START
@@ -98,22 +191,25 @@ namespace Utils
                 // LCOV_EXCL_STOP
                 return ctx;
             }
-            static void initializeContext(const HashType hashType, std::unique_ptr<EVP_MD_CTX, EvpContextDeleter>& spCtx)
+            static const EVP_MD* messageDigest(const HashType hashType)
             {
-                auto ret{0};
-
                 switch (hashType)
                 {
                     case HashType::Sha1:
-                        ret = EVP_DigestInit(spCtx.get(), EVP_sha1());
-                        break;
+                        return EVP_sha1();
 
                     case HashType::Sha256:
-                        ret = EVP_DigestInit(spCtx.get(), EVP_sha256());
-                        break;
+                        return EVP_sha256();
                 }
 
-                if (!ret)
+                throw std::runtime_error
+                {
+                    "Error initializing EVP_MD_CTX."
+                };
+            }
+            static void initializeContext(const HashType hashType, std::unique_ptr<EVP_MD_CTX, EvpContextDeleter>& spCtx)
+            {
+                if (!EVP_DigestInit_ex(spCtx.get(), messageDigest(hashType), nullptr))
                 {
                     throw std::runtime_error
                     {
@@ -122,9 +218,9 @@ namespace Utils
                 }
             }
             std::unique_ptr<EVP_MD_CTX, EvpContextDeleter> m_spCtx;
+            HashType m_hashType;
     };
 
-
 }
 
 #endif // _HASH_HELPER_H
\ No newline at end of file
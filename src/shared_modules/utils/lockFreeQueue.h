@@ -0,0 +1,306 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef LOCK_FREE_QUEUE_H
+#define LOCK_FREE_QUEUE_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+    constexpr auto LOCK_FREE_QUEUE_DEFAULT_CAPACITY { 4096ul };
+
+    /**
+     * @brief Bounded multi-producer multi-consumer ring buffer queue.
+     * @details Drop-in alternative to SafeQueue: push and pop do not take any lock, and the element
+     * count is an atomic counter. Producers reserve their place in the count before publishing an
+     * element and consumers release it after taking one, so the count never underflows nor exceeds
+     * the capacity. Consumers only sleep on the queue when it is empty, and producers
+     * only wake them up when the queue goes from empty to non-empty and somebody is waiting.
+     * A push into a full queue yields until a slot is released or the queue is cancelled.
+     *
+     * @tparam T Element type, it must be default constructible and move assignable.
+     */
+    template<typename T>
+    class LockFreeQueue
+    {
+        public:
+            explicit LockFreeQueue(const size_t capacity = LOCK_FREE_QUEUE_DEFAULT_CAPACITY)
+                : m_capacity{ roundUpToPowerOfTwo(capacity) }
+                , m_mask{ m_capacity - 1 }
+                , m_cells{ new Cell[m_capacity] }
+                , m_enqueuePos{ 0 }
+                , m_dequeuePos{ 0 }
+                , m_size{ 0 }
+                , m_waiters{ 0 }
+                , m_canceled{ false }
+            {
+                for (size_t i = 0; i < m_capacity; ++i)
+                {
+                    m_cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+            }
+            LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+            LockFreeQueue(const LockFreeQueue& other) = delete;
+            ~LockFreeQueue()
+            {
+                cancel();
+            }
+
+            void push(const T& value)
+            {
+                T copy(value);
+                push(std::move(copy));
+            }
+
+            void push(T&& value)
+            {
+                size_t previous { 0 };
+                auto reserved { false };
+
+                while (!m_canceled)
+                {
+                    // The element is counted before it is published, so consumers never pop an element that is
+                    // not counted yet and size() stays between 0 and capacity().
+                    reserved = reserved || reserve(previous);
+
+                    if (reserved && tryPush(value))
+                    {
+                        if (0 == previous && m_waiters.load())
+                        {
+                            std::lock_guard<std::mutex> lock{ m_mutex };
+                            m_cv.notify_all();
+                        }
+
+                        return;
+                    }
+
+                    std::this_thread::yield();
+                }
+
+                if (reserved)
+                {
+                    m_size.fetch_sub(1);
+                }
+            }
+
+            bool pop(T& value, const bool wait = true)
+            {
+                while (!m_canceled)
+                {
+                    if (tryPop(value))
+                    {
+                        m_size.fetch_sub(1);
+                        return true;
+                    }
+
+                    if (!wait)
+                    {
+                        break;
+                    }
+
+                    waitForData();
+                }
+
+                return false;
+            }
+
+            std::shared_ptr<T> pop(const bool wait = true)
+            {
+                auto spData{ std::make_shared<T>() };
+                return pop(*spData, wait) ? spData : nullptr;
+            }
+
+            /**
+             * @brief Pops up to maxItems elements, waiting only for the first one.
+             *
+             * @param values   Vector where the popped elements are appended.
+             * @param maxItems Maximum number of elements to pop.
+             * @param wait     Whether to wait for the first element when the queue is empty.
+             *
+             * @return true when at least one element was popped.
+             */
+            bool popBatch(std::vector<T>& values, const size_t maxItems, const bool wait = true)
+            {
+                T value;
+                auto ret { maxItems && pop(value, wait) };
+
+                if (ret)
+                {
+                    values.push_back(std::move(value));
+
+                    for (size_t i = 1; i < maxItems && !m_canceled && tryPop(value); ++i)
+                    {
+                        m_size.fetch_sub(1);
+                        values.push_back(std::move(value));
+                    }
+                }
+
+                return ret;
+            }
+
+            bool empty() const
+            {
+                return 0 == m_size.load();
+            }
+
+            size_t size() const
+            {
+                return m_size.load();
+            }
+
+            size_t capacity() const
+            {
+                return m_capacity;
+            }
+
+            void cancel()
+            {
+                m_canceled = true;
+                std::lock_guard<std::mutex> lock{ m_mutex };
+                m_cv.notify_all();
+            }
+
+            bool cancelled() const
+            {
+                return m_canceled;
+            }
+
+        private:
+            struct Cell
+            {
+                std::atomic<size_t> sequence;
+                T data;
+            };
+
+            static size_t roundUpToPowerOfTwo(const size_t value)
+            {
+                size_t ret { 2 };
+
+                while (ret < value)
+                {
+                    ret <<= 1;
+                }
+
+                return ret;
+            }
+
+            bool reserve(size_t& previous)
+            {
+                previous = m_size.load();
+
+                while (previous < m_capacity)
+                {
+                    if (m_size.compare_exchange_weak(previous, previous + 1))
+                    {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            bool tryPush(T& value)
+            {
+                auto pos { m_enqueuePos.load(std::memory_order_relaxed) };
+
+                while (true)
+                {
+                    auto& cell { m_cells[pos & m_mask] };
+                    const auto sequence { cell.sequence.load(std::memory_order_acquire) };
+                    const auto diff { static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos) };
+
+                    if (0 == diff)
+                    {
+                        if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            cell.data = std::move(value);
+                            cell.sequence.store(pos + 1, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        // Full, the cell still holds the element pushed one lap before.
+                        return false;
+                    }
+                    else
+                    {
+                        pos = m_enqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            bool tryPop(T& value)
+            {
+                auto pos { m_dequeuePos.load(std::memory_order_relaxed) };
+
+                while (true)
+                {
+                    auto& cell { m_cells[pos & m_mask] };
+                    const auto sequence { cell.sequence.load(std::memory_order_acquire) };
+                    const auto diff { static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) };
+
+                    if (0 == diff)
+                    {
+                        if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        {
+                            value = std::move(cell.data);
+                            // Release whatever the moved-from element still holds before the slot is reused.
+                            cell.data = T{};
+                            cell.sequence.store(pos + m_capacity, std::memory_order_release);
+                            return true;
+                        }
+                    }
+                    else if (diff < 0)
+                    {
+                        // Empty, the cell has not been published yet.
+                        return false;
+                    }
+                    else
+                    {
+                        pos = m_dequeuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            void waitForData()
+            {
+                ++m_waiters;
+                {
+                    std::unique_lock<std::mutex> lock{ m_mutex };
+                    m_cv.wait(lock, [this]()
+                    {
+                        return m_size.load() > 0 || m_canceled;
+                    });
+                }
+                --m_waiters;
+            }
+
+            const size_t m_capacity;
+            const size_t m_mask;
+            std::unique_ptr<Cell[]> m_cells;
+            std::atomic<size_t> m_enqueuePos;
+            std::atomic<size_t> m_dequeuePos;
+            std::atomic<size_t> m_size;
+            std::atomic<size_t> m_waiters;
+            std::atomic_bool m_canceled;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+    };
+}//namespace Utils
+
+#endif //LOCK_FREE_QUEUE_H
@@ -18,12 +18,17 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include "commonDefs.h"
 
 // We can't use std::source_location until C++20
 #define LogEndl Log::sourceFile {__FILE__, __LINE__, __func__}
 
+// Gates a whole log statement, so its operands aren't evaluated when the logger is disabled:
+// LogIfEnabled(Log::debugVerbose) << "Rows: " << count << LogEndl;
+#define LogIfEnabled(logger) if (!(logger).enabled()) {} else (logger)
+
 namespace Log
 {
     static std::mutex logMutex;
@@ -34,6 +39,20 @@ namespace Log
         const char* func;
     };
 
+    // Named value appended as " name: value", formatted only if the logger is enabled.
+    template<typename T>
+    struct Field
+    {
+        const char* name;
+        const T& value;
+    };
+
+    template<typename T>
+    Field<T> field(const char* name, const T& value)
+    {
+        return Field<T> {name, value};
+    }
+
     class Logger
     {
         private:
@@ -52,6 +71,7 @@ namespace Log
             Logger& operator=(const Logger& other) = delete;
             Logger(const Logger& other) = delete;
 
+            // A null function leaves the logger disabled, as the caller does for the levels it doesn't log.
             Logger& assignLogFunction(full_log_fnc_t logFunction, const std::string& tag)
             {
                 if (!m_logFunction && logFunction)
@@ -63,11 +83,28 @@ namespace Log
                 return *this;
             }
 
+            bool enabled() const
+            {
+                return m_logFunction != nullptr;
+            }
+
             // The << operator is overloaded to append data in the buffer for the current thread
             // but the message isn't logged until std::endl or LogEndl are found.
+            // Nothing is buffered while the logger is disabled.
             friend Logger& operator<<(Logger& logObject, const std::string& msg)
             {
-                if (!msg.empty())
+                if (logObject.enabled() && !msg.empty())
+                {
+                    std::lock_guard<std::mutex> lockGuard(logMutex);
+                    logObject.m_threadsBuffers[std::this_thread::get_id()] += msg;
+                }
+
+                return logObject;
+            }
+
+            friend Logger& operator<<(Logger& logObject, const char* msg)
+            {
+                if (logObject.enabled() && msg && *msg)
                 {
                     std::lock_guard<std::mutex> lockGuard(logMutex);
                     logObject.m_threadsBuffers[std::this_thread::get_id()] += msg;
@@ -76,6 +113,29 @@ namespace Log
                 return logObject;
             }
 
+            // Numbers are converted only when the logger is enabled, so callers don't need std::to_string.
+            template<typename T, typename std::enable_if<std::is_arithmetic<T>::value, int>::type = 0>
+            friend Logger& operator<<(Logger& logObject, T value)
+            {
+                if (logObject.enabled())
+                {
+                    logObject << std::to_string(value);
+                }
+
+                return logObject;
+            }
+
+            template<typename T>
+            friend Logger& operator<<(Logger& logObject, const Field<T>& field)
+            {
+                if (logObject.enabled())
+                {
+                    logObject << " " << field.name << ": " << field.value;
+                }
+
+                return logObject;
+            }
+
             // This << overload is used when std::endl is found. But the file, line and function always point here.
             friend Logger& operator<<(Logger& logObject,
                                       std::ostream & (*)(std::ostream&))
@@ -0,0 +1,116 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _METRICS_HELPER_HPP
+#define _METRICS_HELPER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "metrics_op.h"
+
+namespace Utils
+{
+    /**
+     * @brief Handles of the process-wide metrics registry of the shared library (metrics_op.h),
+     * so that the C++ code of a daemon reports through the same com socket as its C code.
+     * The handles are cheap to copy, the metrics live as long as the process.
+     */
+    class MetricsCounter final
+    {
+        public:
+            MetricsCounter(const std::string& name, const std::string& help = "")
+                : m_metric{ w_metrics_counter(name.c_str(), help.c_str()) }
+            {
+            }
+            void add(const uint64_t value = 1) const
+            {
+                w_metrics_add(m_metric, value);
+            }
+            int64_t value() const
+            {
+                return w_metrics_value(m_metric);
+            }
+
+        private:
+            w_metric_t* m_metric;
+    };
+
+    class MetricsGauge final
+    {
+        public:
+            MetricsGauge(const std::string& name, const std::string& help = "")
+                : m_metric{ w_metrics_gauge(name.c_str(), help.c_str()) }
+            {
+            }
+            void set(const int64_t value) const
+            {
+                w_metrics_set(m_metric, value);
+            }
+            void shift(const int64_t delta) const
+            {
+                w_metrics_shift(m_metric, delta);
+            }
+            int64_t value() const
+            {
+                return w_metrics_value(m_metric);
+            }
+
+        private:
+            w_metric_t* m_metric;
+    };
+
+    class MetricsHistogram final
+    {
+        public:
+            MetricsHistogram(const std::string& name, const std::string& help = "")
+                : m_metric{ w_metrics_histogram(name.c_str(), help.c_str()) }
+            {
+            }
+            void record(const uint64_t value) const
+            {
+                w_metrics_record(m_metric, value);
+            }
+            uint64_t percentile(const double percentile) const
+            {
+                return w_metrics_percentile(m_metric, percentile);
+            }
+
+        private:
+            w_metric_t* m_metric;
+    };
+
+    /**
+     * @brief Records in a histogram the microseconds elapsed until the end of the scope.
+     */
+    class MetricsLatency final
+    {
+        public:
+            explicit MetricsLatency(const MetricsHistogram& histogram)
+                : m_histogram{ histogram }
+                , m_start{ std::chrono::steady_clock::now() }
+            {
+            }
+            ~MetricsLatency()
+            {
+                const auto elapsed { std::chrono::steady_clock::now() - m_start };
+                m_histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+            }
+            MetricsLatency(const MetricsLatency&) = delete;
+            MetricsLatency& operator=(const MetricsLatency&) = delete;
+
+        private:
+            const MetricsHistogram& m_histogram;
+            const std::chrono::steady_clock::time_point m_start;
+    };
+}
+
+#endif // _METRICS_HELPER_HPP
@@ -70,12 +70,13 @@ namespace Utils
             }
             void dispatch(const RawValue& raw)
             {
-                const auto& data{ RawValueDecoder::decode(raw) };
+                auto data{ RawValueDecoder::decode(raw) };
                 const auto& callback{ findCallback(data.first) };
 
                 if (callback)
                 {
-                    callback(data.second);
+                    // The decoded value is owned by this call, the callback takes it without a copy.
+                    callback(std::move(data.second));
                 }
             }
         private:
@@ -40,6 +40,10 @@ namespace Utils
             {
                 DispatcherType::push(data);
             }
+            void receive(Input&& data)
+            {
+                DispatcherType::push(std::move(data));
+            }
         private:
             using DispatcherType = Dispatcher<Input, Functor>;
             using ReadNodeType = ReadNode<Input, Functor, Dispatcher>;
@@ -73,6 +77,10 @@ namespace Utils
             {
                 DispatcherType::push(data);
             }
+            void receive(Input&& data)
+            {
+                DispatcherType::push(std::move(data));
+            }
         private:
             using DispatcherType = Dispatcher<Input, std::function<void(const Input&)>>;
             using RWNodeType = ReadWriteNode<Input, Output, Reader, Functor, Dispatcher>;
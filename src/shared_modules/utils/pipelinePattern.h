@@ -14,6 +14,7 @@
 #include <memory>
 #include <vector>
 #include <functional>
+#include <iterator>
 #include "threadDispatcher.h"
 
 namespace Utils
@@ -59,6 +60,24 @@ namespace Utils
                     reader->receive(data);
                 }
             }
+            /**
+             * @brief Sends a message to all the chained readers in the pipeline.
+             * @details The message is copied to every reader but the last one, which takes it.
+             *
+             * @param data Message data to be sent to readers.
+             */
+            void send(T&& data)
+            {
+                if (!m_readers.empty())
+                {
+                    for (auto it { m_readers.begin() }; it != std::prev(m_readers.end()); ++it)
+                    {
+                        (*it)->receive(data);
+                    }
+
+                    m_readers.back()->receive(std::move(data));
+                }
+            }
         public:
             // LCOV_EXCL_START
             virtual ~IPipelineWriter() = default;
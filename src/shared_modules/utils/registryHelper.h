@@ -171,6 +171,42 @@ namespace Utils
                 }
             }
 
+            /**
+             * @brief Same as enumerate, also passing the last write time of every subkey as a FILETIME number.
+             *        Lets the caller skip the subkeys that didn't change without opening them.
+             */
+            void enumerateWithLastWriteTime(const std::function<void(const std::string&, const uint64_t)>& callback) const
+            {
+                constexpr auto MAX_KEY_NAME_SIZE{255};//https://docs.microsoft.com/en-us/windows/win32/sysinfo/registry-element-size-limits
+                char buff[MAX_KEY_NAME_SIZE] {};
+                DWORD size{MAX_KEY_NAME_SIZE};
+                DWORD index{0};
+                FILETIME lastWriteTime{};
+                auto result{RegEnumKeyEx(m_registryKey, index, buff, &size, nullptr, nullptr, nullptr, &lastWriteTime)};
+
+                while (result == ERROR_SUCCESS)
+                {
+                    ULARGE_INTEGER time{};
+                    time.LowPart = lastWriteTime.dwLowDateTime;
+                    time.HighPart = lastWriteTime.dwHighDateTime;
+
+                    callback(buff, time.QuadPart);
+                    size = MAX_KEY_NAME_SIZE;
+                    ++index;
+                    result = RegEnumKeyEx(m_registryKey, index, buff, &size, nullptr, nullptr, nullptr, &lastWriteTime);
+                }
+
+                if (result != ERROR_NO_MORE_ITEMS)
+                {
+                    throw std::system_error
+                    {
+                        result,
+                        std::system_category(),
+                        "Error enumerating registry."
+                    };
+                }
+            }
+
             bool enumerate(std::vector<std::string>& values) const
             {
                 bool ret{true};
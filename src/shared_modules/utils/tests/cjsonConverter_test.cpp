@@ -0,0 +1,70 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "cjsonConverter_test.h"
+#include "cjsonConverter.hpp"
+#include "cjsonSmartDeleter.hpp"
+
+void CJsonConverterTest::SetUp() {};
+
+void CJsonConverterTest::TearDown() {};
+
+static const auto DOCUMENT
+{
+    R"({"path":"/etc/passwd","size":1024,"inode":18446744073709,"offset":-12,"ratio":0.25,"big":1e20,)"
+    R"("scanned":true,"changed":false,"attributes":null,"hashes":["a1","b2"],"data":{"uid":"0","gid":0}})"
+};
+
+TEST_F(CJsonConverterTest, CJSONToJsonMatchesTextualConversion)
+{
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> spInput{ cJSON_Parse(DOCUMENT) };
+    const std::unique_ptr<char, CJsonSmartFree> spBytes{ cJSON_PrintUnformatted(spInput.get()) };
+    const auto expected = nlohmann::json::parse(spBytes.get());
+    const auto result = Utils::cJSONToJson(spInput.get());
+
+    EXPECT_EQ(expected, result);
+    EXPECT_EQ(expected.dump(), result.dump());
+    EXPECT_TRUE(result.at("size").is_number_unsigned());
+    EXPECT_TRUE(result.at("offset").is_number_integer());
+    EXPECT_TRUE(result.at("big").is_number_float());
+    EXPECT_TRUE(result.at("ratio").is_number_float());
+}
+
+TEST_F(CJsonConverterTest, CJSONToJsonNull)
+{
+    EXPECT_TRUE(Utils::cJSONToJson(nullptr).is_null());
+}
+
+TEST_F(CJsonConverterTest, CJSONToJsonRaw)
+{
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> spInput{ cJSON_CreateObject() };
+    cJSON_AddRawToObject(spInput.get(), "raw", R"([1,"two"])");
+
+    EXPECT_EQ(nlohmann::json::parse(R"({"raw":[1,"two"]})"), Utils::cJSONToJson(spInput.get()));
+}
+
+TEST_F(CJsonConverterTest, JsonToCJSONMatchesTextualConversion)
+{
+    const auto input = nlohmann::json::parse(DOCUMENT);
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> spExpected{ cJSON_Parse(input.dump().c_str()) };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> spResult{ Utils::jsonToCJSON(input) };
+
+    ASSERT_NE(nullptr, spResult);
+    EXPECT_TRUE(cJSON_Compare(spExpected.get(), spResult.get(), true));
+}
+
+TEST_F(CJsonConverterTest, JsonToCJSONNonFinite)
+{
+    const nlohmann::json input { {"value", std::nan("")} };
+    const std::unique_ptr<cJSON, CJsonSmartDeleter> spResult{ Utils::jsonToCJSON(input) };
+
+    EXPECT_TRUE(cJSON_IsNull(cJSON_GetObjectItem(spResult.get(), "value")));
+}
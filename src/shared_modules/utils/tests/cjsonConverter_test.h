@@ -0,0 +1,27 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef CJSON_CONVERTER_TESTS_H
+#define CJSON_CONVERTER_TESTS_H
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+
+class CJsonConverterTest : public ::testing::Test
+{
+    protected:
+
+        CJsonConverterTest() = default;
+        virtual ~CJsonConverterTest() = default;
+
+        void SetUp() override;
+        void TearDown() override;
+};
+#endif //CJSON_CONVERTER_TESTS_H
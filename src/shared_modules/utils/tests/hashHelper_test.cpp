@@ -83,3 +83,55 @@ TEST_F(HashHelperTest, HashHelperHashIterativeSha256)
     EXPECT_EQ(sizeof(expected), result.size());
     EXPECT_TRUE(!memcmp(expected, result.data(), result.size()));
 }
+
+TEST_F(HashHelperTest, HashHelperResetSha1)
+{
+    const unsigned char expected[] {0x2d, 0x53, 0x3b, 0x9d, 0x9f, 0x0f, 0x06, 0xef, 0x4e, 0x3c, 0x23, 0xfd, 0x49, 0x6c, 0xfe, 0xb2, 0x78, 0x0e, 0xda, 0x7f};
+    const std::string data{"HASH"};
+    HashData hash;
+    hash.update("OTHER", 5);
+    hash.reset();
+    hash.update(data.c_str(), data.size());
+    const auto result{ hash.hash() };
+    EXPECT_EQ(sizeof(expected), result.size());
+    EXPECT_TRUE(!memcmp(expected, result.data(), result.size()));
+
+    hash.reset();
+    hash.update(data.c_str(), data.size());
+    EXPECT_EQ(result, hash.hash());
+}
+
+TEST_F(HashHelperTest, HashHelperHashOutputSha256)
+{
+    const unsigned char expected[] {0xc1, 0xfb, 0x44, 0xc7, 0x26, 0x28, 0xea, 0xe4, 0x91, 0x32, 0x06, 0x2f, 0xe5, 0x10, 0x9f, 0x65,
+                                    0x0b, 0x6a, 0x7a, 0xb9, 0x03, 0x33, 0x6e, 0x7f, 0xcd, 0x2e, 0xf8, 0xf5, 0xeb, 0xa0, 0x41, 0x51
+                                   };
+    const std::string data{"HASH"};
+    unsigned char output[sizeof(expected)] {0};
+    HashData hash{HashType::Sha256};
+    hash.update(data.c_str(), data.size());
+    EXPECT_EQ(sizeof(expected), hash.hash(output, sizeof(output)));
+    EXPECT_TRUE(!memcmp(expected, output, sizeof(expected)));
+}
+
+TEST_F(HashHelperTest, HashHelperHashOutputTooSmall)
+{
+    unsigned char output[16] {0};
+    HashData hash;
+    hash.update("HASH", 4);
+    EXPECT_THROW(hash.hash(output, sizeof(output)), std::runtime_error);
+}
+
+TEST_F(HashHelperTest, HashHelperOneShot)
+{
+    const unsigned char expectedSha1[] {0x2d, 0x53, 0x3b, 0x9d, 0x9f, 0x0f, 0x06, 0xef, 0x4e, 0x3c, 0x23, 0xfd, 0x49, 0x6c, 0xfe, 0xb2, 0x78, 0x0e, 0xda, 0x7f};
+    const unsigned char expectedSha256[] {0xc1, 0xfb, 0x44, 0xc7, 0x26, 0x28, 0xea, 0xe4, 0x91, 0x32, 0x06, 0x2f, 0xe5, 0x10, 0x9f, 0x65,
+                                          0x0b, 0x6a, 0x7a, 0xb9, 0x03, 0x33, 0x6e, 0x7f, 0xcd, 0x2e, 0xf8, 0xf5, 0xeb, 0xa0, 0x41, 0x51
+                                         };
+    const auto sha1{ HashData::sha1("HASH") };
+    const auto sha256{ HashData::sha256("HASH") };
+    EXPECT_EQ(sizeof(expectedSha1), sha1.size());
+    EXPECT_TRUE(!memcmp(expectedSha1, sha1.data(), sha1.size()));
+    EXPECT_EQ(sizeof(expectedSha256), sha256.size());
+    EXPECT_TRUE(!memcmp(expectedSha256, sha256.data(), sha256.size()));
+}
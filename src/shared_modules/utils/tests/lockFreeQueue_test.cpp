@@ -0,0 +1,286 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <thread>
+#include "lockFreeQueue_test.h"
+#include "lockFreeQueue.h"
+
+void LockFreeQueueTest::SetUp() {};
+
+void LockFreeQueueTest::TearDown() {};
+
+using namespace Utils;
+TEST_F(LockFreeQueueTest, Ctor)
+{
+    LockFreeQueue<int> queue;
+    int ret_val{};
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.cancelled());
+    EXPECT_EQ(LOCK_FREE_QUEUE_DEFAULT_CAPACITY, queue.capacity());
+    EXPECT_FALSE(queue.pop(ret_val, false));//non wait pop;
+    auto spValue{queue.pop(false)};
+    EXPECT_FALSE(spValue);
+}
+
+TEST_F(LockFreeQueueTest, CapacityRoundedToPowerOfTwo)
+{
+    LockFreeQueue<int> queue{ 100 };
+    EXPECT_EQ(128ul, queue.capacity());
+}
+
+TEST_F(LockFreeQueueTest, NonBlockingPop)
+{
+    LockFreeQueue<int> queue;
+    queue.push(0);
+    EXPECT_EQ(1ul, queue.size());
+    int ret_val{};
+    EXPECT_TRUE(queue.pop(ret_val, false));//non wait pop;
+    EXPECT_EQ(0, ret_val);//non wait pop;
+    EXPECT_FALSE(queue.pop(ret_val, false));//non wait pop;
+    queue.push(1);
+    auto spValue{queue.pop(false)};
+    EXPECT_TRUE(spValue);
+    EXPECT_EQ(1, *spValue);
+    spValue = queue.pop(false);
+    EXPECT_FALSE(spValue);
+}
+
+TEST_F(LockFreeQueueTest, WrapAround)
+{
+    LockFreeQueue<int> queue{ 4 };
+
+    for (int i = 0; i < 100; ++i)
+    {
+        queue.push(i);
+        queue.push(i + 1);
+        int ret_val{};
+        EXPECT_TRUE(queue.pop(ret_val, false));
+        EXPECT_EQ(i, ret_val);
+        EXPECT_TRUE(queue.pop(ret_val, false));
+        EXPECT_EQ(i + 1, ret_val);
+    }
+
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(LockFreeQueueTest, PopBatch)
+{
+    LockFreeQueue<int> queue;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        queue.push(i);
+    }
+
+    std::vector<int> values;
+    EXPECT_TRUE(queue.popBatch(values, 4, false));
+    EXPECT_EQ((std::vector<int> {0, 1, 2, 3}), values);
+    values.clear();
+    EXPECT_TRUE(queue.popBatch(values, 100, false));
+    EXPECT_EQ((std::vector<int> {4, 5, 6, 7, 8, 9}), values);
+    values.clear();
+    EXPECT_FALSE(queue.popBatch(values, 100, false));
+    EXPECT_TRUE(values.empty());
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(LockFreeQueueTest, BlockingPopByRef)
+{
+    LockFreeQueue<int> queue;
+    std::thread t1
+    {
+        [&queue]()
+        {
+            int ret_val{};
+            EXPECT_TRUE(queue.pop(ret_val));
+            EXPECT_EQ(0, ret_val);
+        }
+    };
+    queue.push(0);
+    t1.join();
+}
+
+TEST_F(LockFreeQueueTest, PushIntoFullQueueWaitsForRoom)
+{
+    LockFreeQueue<int> queue{ 2 };
+    queue.push(0);
+    queue.push(1);
+    std::thread t1
+    {
+        [&queue]()
+        {
+            queue.push(2);
+        }
+    };
+    int ret_val{};
+    EXPECT_TRUE(queue.pop(ret_val));
+    EXPECT_EQ(0, ret_val);
+    t1.join();
+    EXPECT_TRUE(queue.pop(ret_val));
+    EXPECT_EQ(1, ret_val);
+    EXPECT_TRUE(queue.pop(ret_val));
+    EXPECT_EQ(2, ret_val);
+}
+
+TEST_F(LockFreeQueueTest, Cancel)
+{
+    LockFreeQueue<int> queue;
+    queue.push(0);
+    queue.push(1);
+    queue.push(2);
+    int ret_val{};
+    EXPECT_TRUE(queue.pop(ret_val, false));//non wait pop;
+    queue.cancel();
+    EXPECT_FALSE(queue.pop(ret_val, false));//non wait pop;
+    EXPECT_FALSE(queue.pop(ret_val));//wait pop;
+    EXPECT_TRUE(queue.cancelled());
+}
+
+TEST_F(LockFreeQueueTest, CancelBlockingPop)
+{
+    LockFreeQueue<int> queue;
+    std::thread t1
+    {
+        [&queue]()
+        {
+            auto ret_val{queue.pop()};
+            EXPECT_FALSE(ret_val);
+            EXPECT_TRUE(queue.cancelled());
+        }
+    };
+    std::thread t2
+    {
+        [&queue]()
+        {
+            int ret_val{};
+            EXPECT_FALSE(queue.pop(ret_val));
+            EXPECT_TRUE(queue.cancelled());
+        }
+    };
+    queue.cancel();
+    t1.join();
+    t2.join();
+}
+
+TEST_F(LockFreeQueueTest, MultiProducerMultiConsumer)
+{
+    constexpr auto NUMBER_OF_THREADS { 4 };
+    constexpr auto ITEMS_PER_PRODUCER { 10000 };
+    LockFreeQueue<int> queue{ 64 };
+    std::atomic<long> sum { 0 };
+    std::atomic<int> popped { 0 };
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+    {
+        threads.emplace_back([&queue]()
+        {
+            for (int j = 1; j <= ITEMS_PER_PRODUCER; ++j)
+            {
+                queue.push(j);
+            }
+        });
+        threads.emplace_back([&queue, &sum, &popped]()
+        {
+            int ret_val{};
+
+            while (queue.pop(ret_val))
+            {
+                sum += ret_val;
+
+                if (++popped == NUMBER_OF_THREADS * ITEMS_PER_PRODUCER)
+                {
+                    queue.cancel();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(NUMBER_OF_THREADS * ITEMS_PER_PRODUCER, popped);
+    EXPECT_EQ(static_cast<long>(NUMBER_OF_THREADS) * ITEMS_PER_PRODUCER * (ITEMS_PER_PRODUCER + 1) / 2, sum);
+}
+
+TEST_F(LockFreeQueueTest, SizeStaysWithinCapacityAtTheBound)
+{
+    constexpr auto NUMBER_OF_THREADS { 4 };
+    constexpr auto ITEMS_PER_PRODUCER { 20000 };
+    LockFreeQueue<int> queue{ 8 };
+    std::atomic<long> sum { 0 };
+    std::atomic<int> popped { 0 };
+    std::atomic<bool> done { false };
+    std::atomic<size_t> maxSize { 0 };
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < NUMBER_OF_THREADS; ++i)
+    {
+        threads.emplace_back([&queue]()
+        {
+            for (int j = 1; j <= ITEMS_PER_PRODUCER; ++j)
+            {
+                queue.push(j);
+            }
+        });
+        threads.emplace_back([&queue, &sum, &popped]()
+        {
+            std::vector<int> values;
+
+            while (queue.popBatch(values, 3))
+            {
+                for (const auto value : values)
+                {
+                    sum += value;
+                }
+
+                if ((popped += static_cast<int>(values.size())) == NUMBER_OF_THREADS * ITEMS_PER_PRODUCER)
+                {
+                    queue.cancel();
+                }
+
+                values.clear();
+            }
+        });
+    }
+
+    // A size() read between a pop and the matching push accounting would wrap around to SIZE_MAX.
+    std::thread sampler
+    {
+        [&queue, &done, &maxSize]()
+        {
+            while (!done)
+            {
+                const auto size { queue.size() };
+
+                if (size > maxSize)
+                {
+                    maxSize = size;
+                }
+            }
+        }
+    };
+
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    done = true;
+    sampler.join();
+
+    EXPECT_LE(maxSize, queue.capacity());
+    EXPECT_EQ(NUMBER_OF_THREADS * ITEMS_PER_PRODUCER, popped);
+    EXPECT_EQ(static_cast<long>(NUMBER_OF_THREADS) * ITEMS_PER_PRODUCER * (ITEMS_PER_PRODUCER + 1) / 2, sum);
+    EXPECT_TRUE(queue.empty());
+}
@@ -0,0 +1,26 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef LOCK_FREE_QUEUE_TESTS_H
+#define LOCK_FREE_QUEUE_TESTS_H
+#include "gtest/gtest.h"
+
+class LockFreeQueueTest : public ::testing::Test
+{
+    protected:
+
+        LockFreeQueueTest() = default;
+        virtual ~LockFreeQueueTest() = default;
+
+        void SetUp() override;
+        void TearDown() override;
+};
+#endif //LOCK_FREE_QUEUE_TESTS_H
\ No newline at end of file
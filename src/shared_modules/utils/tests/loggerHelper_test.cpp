@@ -183,3 +183,41 @@ TEST_F(LoggerHelperTest, multiThreadTest)
 
     SUCCEED();
 }
+
+TEST_F(LoggerHelperTest, numbersAndFieldsTest)
+{
+    Log::info << "Testing " << 1 << " log" << Log::field("table", std::string{"dbsync_ports"}) << Log::field("rows", 20u) << LogEndl;
+    EXPECT_TRUE(std::regex_match(ssOutput.str(), std::regex("info Tag .+\\.cpp \\d+ TestBody Testing 1 log table: dbsync_ports rows: 20\\n")));
+}
+
+class DisabledLogger final : public Log::Logger
+{
+};
+
+TEST_F(LoggerHelperTest, disabledLoggerTest)
+{
+    DisabledLogger logger;
+    auto evaluated {false};
+    const auto argument
+    {
+        [&evaluated]()
+        {
+            evaluated = true;
+            return std::string{"argument"};
+        }
+    };
+
+    EXPECT_FALSE(logger.enabled());
+    EXPECT_TRUE(Log::info.enabled());
+
+    LogIfEnabled(logger) << "Testing disabled log " << argument() << LogEndl;
+    EXPECT_FALSE(evaluated);
+
+    LogIfEnabled(Log::info) << "Testing Info log" << LogEndl;
+    EXPECT_TRUE(std::regex_match(ssOutput.str(), std::regex(INFO_REGEX)));
+
+    // Without the macro the operands are evaluated, but nothing is buffered for the next message
+    logger << "Testing disabled log " << argument() << 1 << LogEndl;
+    EXPECT_TRUE(evaluated);
+    EXPECT_TRUE(std::regex_match(ssOutput.str(), std::regex(INFO_REGEX)));
+}
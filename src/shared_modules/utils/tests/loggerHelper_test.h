@@ -39,6 +39,7 @@ class LoggerHelperTest : public ::testing::Test
         virtual void SetUp()
         {
             ssOutput.str("");
+            ssOutput.clear();
         }
 };
 #endif //LOGGER_HELPER_TEST_H
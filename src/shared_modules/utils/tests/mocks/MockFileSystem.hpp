@@ -24,6 +24,7 @@ class MockFileSystem
         MOCK_METHOD(bool, is_regular_file, (const std::filesystem::path&), ());
         MOCK_METHOD(bool, is_directory, (const std::filesystem::path&), ());
         MOCK_METHOD(T, directory_iterator, (const std::filesystem::path&), ());
+        MOCK_METHOD(int64_t, last_write_time, (const std::filesystem::path&), ());
 };
 
 #endif  // _MOCKFILESYSTEM_HPP
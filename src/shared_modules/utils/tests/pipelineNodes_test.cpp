@@ -44,6 +44,9 @@ using ReadWriteNodeSync = Utils::ReadWriteNode<std::string, int, ReadIntNodeSync
 using ReadIntNodeAsync = Utils::ReadNode<int, std::reference_wrapper<FunctorWrapper>, Utils::AsyncDispatcher>;
 using ReadWriteNodeAsync = Utils::ReadWriteNode<std::string, int, ReadIntNodeAsync>;
 
+using ReadIntNodeExecutor = Utils::ReadNode<int, std::reference_wrapper<FunctorWrapper>, Utils::ExecutorDispatcher>;
+using ReadWriteNodeExecutor = Utils::ReadWriteNode<std::string, int, ReadIntNodeExecutor, std::function<int(const std::string&)>, Utils::ExecutorDispatcher>;
+
 TEST_F(PipelineNodesTest, ReadNodeAsync)
 {
     FunctorWrapper functor;
@@ -118,6 +121,32 @@ TEST_F(PipelineNodesTest, ReadWriteNodeSync)
     ReadWriteNodeBehaviour(functor, spReadNode, spReadWriteNode);
 }
 
+TEST_F(PipelineNodesTest, ReadNodeExecutor)
+{
+    FunctorWrapper functor;
+    ReadIntNodeExecutor rNode{ std::ref(functor), 1 };
+
+    ReadNodeBehaviour(functor, rNode);
+}
+
+TEST_F(PipelineNodesTest, ReadWriteNodeExecutor)
+{
+    FunctorWrapper functor;
+    auto spReadNode
+    {
+        std::make_shared<ReadIntNodeExecutor>(std::ref(functor))
+    };
+    auto spReadWriteNode
+    {
+        std::make_shared<ReadWriteNodeExecutor>([](const std::string & value)
+        {
+            return std::stoi(value);
+        })
+    };
+
+    ReadWriteNodeBehaviour(functor, spReadNode, spReadWriteNode);
+}
+
 TEST_F(PipelineNodesTest, ConnectInvalidPtrs1)
 {
     std::shared_ptr<Utils::ReadNode<int>> spReadNode;
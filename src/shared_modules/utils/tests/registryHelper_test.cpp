@@ -111,4 +111,16 @@ TEST_F(RegistryUtilsTest, RegistryEnumerateNoThrow)
     EXPECT_EQ(0u, values.size());
 }
 
+TEST_F(RegistryUtilsTest, RegistryEnumerateWithLastWriteTime)
+{
+    Utils::Registry reg(HKEY_LOCAL_MACHINE, CENTRAL_PROCESSOR_REGISTRY, KEY_ENUMERATE_SUB_KEYS | KEY_READ);
+    std::vector<std::string> subKeys;
+    reg.enumerateWithLastWriteTime([&subKeys](const std::string & subKey, const uint64_t lastWriteTime)
+    {
+        EXPECT_NE(0u, lastWriteTime);
+        subKeys.push_back(subKey);
+    });
+    EXPECT_EQ(reg.enumerate(), subKeys);
+}
+
 #endif
@@ -33,6 +33,22 @@ class FunctorWrapper
             Operator(value);
         }
 };
+
+class CopyCounter
+{
+    public:
+        explicit CopyCounter(std::atomic<int>& copies)
+            : m_copies{ copies }
+        {}
+        CopyCounter(const CopyCounter& other)
+            : m_copies{ other.m_copies }
+        {
+            ++m_copies;
+        }
+        CopyCounter(CopyCounter&& other) = default;
+    private:
+        std::atomic<int>& m_copies;
+};
 // LCOV_EXCL_STOP
 
 TEST_F(ThreadDispatcherTest, AsyncDispatcherPushAndRundown)
@@ -121,3 +137,404 @@ TEST_F(ThreadDispatcherTest, AsyncDispatcherQueue)
     dispatcher.rundown();
 }
 
+
+TEST_F(ThreadDispatcherTest, AsyncDispatcherPushRvalueIsNotCopied)
+{
+    std::atomic<int> copies { 0 };
+    std::atomic<int> calls { 0 };
+    AsyncDispatcher<CopyCounter, std::function<void(const CopyCounter&)>> dispatcher
+    {
+        [&calls](const CopyCounter&)
+        {
+            ++calls;
+        }
+    };
+
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.push(CopyCounter{ copies });
+    }
+
+    dispatcher.rundown();
+    EXPECT_EQ(10, calls);
+    EXPECT_EQ(0, copies);
+}
+
+TEST_F(ThreadDispatcherTest, SyncDispatcherPushRvalueIsNotCopied)
+{
+    std::atomic<int> copies { 0 };
+    std::atomic<int> calls { 0 };
+    SyncDispatcher<CopyCounter, std::function<void(const CopyCounter&)>> dispatcher
+    {
+        [&calls](const CopyCounter&)
+        {
+            ++calls;
+        }
+    };
+
+    dispatcher.push(CopyCounter{ copies });
+    EXPECT_EQ(1, calls);
+    EXPECT_EQ(0, copies);
+}
+
+TEST_F(ThreadDispatcherTest, LockFreeAsyncDispatcherPushAndRundown)
+{
+    FunctorWrapper functor;
+    LockFreeAsyncDispatcher<int, std::reference_wrapper<FunctorWrapper>> dispatcher
+    {
+        std::ref(functor)
+    };
+    EXPECT_EQ(std::thread::hardware_concurrency(), dispatcher.numberOfThreads());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_CALL(functor, Operator(i));
+    }
+
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.push(i);
+    }
+
+    dispatcher.rundown();
+    EXPECT_TRUE(dispatcher.cancelled());
+    EXPECT_EQ(0ul, dispatcher.size());
+}
+
+TEST_F(ThreadDispatcherTest, LockFreeAsyncDispatcherQueueLargerThanDefaultCapacity)
+{
+    constexpr auto NUMBER_OF_THREADS { 1ul };
+    constexpr auto MAX_QUEUE_SIZE { 2 * LOCK_FREE_QUEUE_DEFAULT_CAPACITY };
+    constexpr auto NUMBER_OF_ITEMS { MAX_QUEUE_SIZE + 100 };
+    std::mutex mutex;
+    std::unique_lock<std::mutex> lock(mutex);
+    std::condition_variable condition;
+    std::atomic<bool> firstCall { true };
+    std::atomic<size_t> calls { 0 };
+
+    LockFreeAsyncDispatcher<int, std::function<void(int)>> dispatcher
+    {
+        [&mutex, &condition, &firstCall, &calls](int)
+        {
+            std::unique_lock<std::mutex> functorLock(mutex);
+            ++calls;
+            condition.notify_one();
+
+            if (firstCall)
+            {
+                firstCall = false;
+                condition.wait(functorLock);
+            }
+        }
+        , NUMBER_OF_THREADS
+        , MAX_QUEUE_SIZE
+    };
+
+    dispatcher.push(0);
+    condition.wait(lock);
+
+    // The worker is blocked, none of these pushes may wait for room in the ring.
+    for (size_t i = 0; i < NUMBER_OF_ITEMS - 1; ++i)
+    {
+        dispatcher.push(0);
+    }
+
+    EXPECT_EQ(MAX_QUEUE_SIZE, dispatcher.size());
+    condition.notify_one();
+    lock.unlock();
+    dispatcher.rundown();
+    EXPECT_EQ(MAX_QUEUE_SIZE + 1, calls);
+}
+
+TEST_F(ThreadDispatcherTest, ExecutorDispatcherPushAndRundown)
+{
+    FunctorWrapper functor;
+    ExecutorDispatcher<int, std::reference_wrapper<FunctorWrapper>> dispatcher
+    {
+        std::ref(functor)
+    };
+    EXPECT_EQ(std::thread::hardware_concurrency(), dispatcher.numberOfThreads());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_CALL(functor, Operator(i));
+    }
+
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.push(i);
+    }
+
+    dispatcher.rundown();
+    EXPECT_TRUE(dispatcher.cancelled());
+    EXPECT_EQ(0ul, dispatcher.size());
+}
+
+TEST_F(ThreadDispatcherTest, ExecutorDispatcherCancel)
+{
+    FunctorWrapper functor;
+    ExecutorDispatcher<int, std::reference_wrapper<FunctorWrapper>> dispatcher
+    {
+        std::ref(functor)
+    };
+    dispatcher.cancel();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_CALL(functor, Operator(i)).Times(0);
+        dispatcher.push(i);
+    }
+
+    EXPECT_TRUE(dispatcher.cancelled());
+    dispatcher.rundown();
+    EXPECT_EQ(0ul, dispatcher.size());
+}
+
+TEST_F(ThreadDispatcherTest, ExecutorDispatcherSingleThreadKeepsOrder)
+{
+    constexpr auto NUMBER_OF_ITEMS { 1000 };
+    std::vector<int> processed;
+    std::atomic<int> concurrent { 0 };
+    std::atomic<int> maxConcurrent { 0 };
+    ExecutorDispatcher<int, std::function<void(int)>> dispatcher
+    {
+        [&processed, &concurrent, &maxConcurrent](int value)
+        {
+            maxConcurrent = std::max(maxConcurrent.load(), ++concurrent);
+            processed.push_back(value);
+            --concurrent;
+        },
+        1
+    };
+
+    for (int i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        dispatcher.push(i);
+    }
+
+    dispatcher.rundown();
+    ASSERT_EQ(static_cast<size_t>(NUMBER_OF_ITEMS), processed.size());
+
+    for (int i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        EXPECT_EQ(i, processed[i]);
+    }
+
+    EXPECT_EQ(1, maxConcurrent);
+}
+
+TEST_F(ThreadDispatcherTest, ExecutorDispatcherQueue)
+{
+    constexpr auto MAX_QUEUE_SIZE { 5ull };
+    constexpr auto NUMBER_OF_ITEMS { 1000 };
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool release { false };
+    std::atomic<int> calls { 0 };
+
+    ExecutorDispatcher<int, std::function<void(int)>> dispatcher
+    {
+        [&mutex, &condition, &release, &calls](int)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ++calls;
+            condition.wait(lock, [&release]()
+            {
+                return release;
+            });
+        }
+        , 1
+        , MAX_QUEUE_SIZE
+    };
+
+    dispatcher.push(0);
+
+    while (!calls)
+    {
+        std::this_thread::yield();
+    }
+
+    for (int i = 0; i < NUMBER_OF_ITEMS - 1; ++i)
+    {
+        dispatcher.push(0);
+    }
+
+    EXPECT_EQ(MAX_QUEUE_SIZE, dispatcher.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    condition.notify_all();
+    dispatcher.rundown();
+    EXPECT_EQ(static_cast<int>(MAX_QUEUE_SIZE) + 1, calls);
+}
+
+TEST_F(ThreadDispatcherTest, ExecutorDispatcherPriorityLanes)
+{
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool release { false };
+    std::vector<int> processed;
+
+    ExecutorDispatcher<int, std::function<void(int)>> dispatcher
+    {
+        [&mutex, &condition, &release, &processed](int value)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            processed.push_back(value);
+            condition.wait(lock, [&release]()
+            {
+                return release;
+            });
+        }
+        , 1
+    };
+
+    // The first message keeps the only thread busy while the lanes are filled.
+    dispatcher.push(0);
+
+    while (dispatcher.size())
+    {
+        std::this_thread::yield();
+    }
+
+    for (int i = 1; i <= 20; ++i)
+    {
+        dispatcher.push(300 + i, DispatchPriority::LOW);
+        dispatcher.push(200 + i, DispatchPriority::NORMAL);
+        dispatcher.push(100 + i, DispatchPriority::HIGH);
+    }
+
+    EXPECT_EQ(60ul, dispatcher.size());
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    condition.notify_all();
+    dispatcher.rundown();
+
+    // The first message took a credit of the normal lane in the opening round.
+    const std::vector<int> firstRound { 0, 101, 102, 103, 104, 105, 106, 107, 108, 201, 301, 109, 110 };
+    ASSERT_EQ(61ul, processed.size());
+    EXPECT_EQ(firstRound, std::vector<int>(processed.begin(), processed.begin() + firstRound.size()));
+
+    // Each lane keeps its own order.
+    for (const auto lane : { 100, 200, 300 })
+    {
+        auto last { lane };
+
+        for (const auto value : processed)
+        {
+            if (value > lane && value <= lane + 20)
+            {
+                EXPECT_EQ(last + 1, value);
+                last = value;
+            }
+        }
+
+        EXPECT_EQ(lane + 20, last);
+    }
+}
+
+TEST_F(ThreadDispatcherTest, BatchAsyncDispatcherPushAndRundown)
+{
+    constexpr auto NUMBER_OF_ITEMS { 1000 };
+    constexpr auto BATCH_SIZE { 64ul };
+    std::mutex mutex;
+    std::vector<int> processed;
+    size_t biggestBatch { 0 };
+    BatchAsyncDispatcher<int, std::function<void(const std::vector<int>&)>> dispatcher
+    {
+        [&mutex, &processed, &biggestBatch](const std::vector<int>& values)
+        {
+            std::lock_guard<std::mutex> lock{ mutex };
+            biggestBatch = std::max(biggestBatch, values.size());
+            processed.insert(processed.end(), values.begin(), values.end());
+        },
+        1,
+        UNLIMITED_QUEUE_SIZE,
+        BATCH_SIZE
+    };
+    EXPECT_EQ(1u, dispatcher.numberOfThreads());
+    EXPECT_EQ(BATCH_SIZE, dispatcher.batchSize());
+
+    for (int i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        dispatcher.push(i);
+    }
+
+    dispatcher.rundown();
+    EXPECT_TRUE(dispatcher.cancelled());
+    EXPECT_EQ(0ul, dispatcher.size());
+    ASSERT_EQ(static_cast<size_t>(NUMBER_OF_ITEMS), processed.size());
+
+    for (int i = 0; i < NUMBER_OF_ITEMS; ++i)
+    {
+        EXPECT_EQ(i, processed[i]);
+    }
+
+    EXPECT_GE(BATCH_SIZE, biggestBatch);
+}
+
+TEST_F(ThreadDispatcherTest, BatchAsyncDispatcherDrainsQueuedItemsAtOnce)
+{
+    constexpr auto NUMBER_OF_ITEMS { 10 };
+    std::mutex mutex;
+    std::unique_lock<std::mutex> lock(mutex);
+    std::condition_variable condition;
+    std::atomic<bool> firstCall { true };
+    std::vector<size_t> batches;
+
+    BatchAsyncDispatcher<int, std::function<void(const std::vector<int>&)>> dispatcher
+    {
+        [&mutex, &condition, &firstCall, &batches](const std::vector<int>& values)
+        {
+            std::unique_lock<std::mutex> functorLock(mutex);
+            batches.push_back(values.size());
+            condition.notify_one();
+
+            if (firstCall)
+            {
+                firstCall = false;
+                condition.wait(functorLock);
+            }
+        },
+        1
+    };
+
+    dispatcher.push(0);
+    condition.wait(lock);
+
+    for (int i = 1; i < NUMBER_OF_ITEMS; ++i)
+    {
+        dispatcher.push(i);
+    }
+
+    condition.notify_one();
+    lock.unlock();
+    dispatcher.rundown();
+    EXPECT_EQ((std::vector<size_t> {1, NUMBER_OF_ITEMS - 1}), batches);
+}
+
+TEST_F(ThreadDispatcherTest, BatchAsyncDispatcherCancel)
+{
+    std::atomic<int> calls { 0 };
+    BatchAsyncDispatcher<int, std::function<void(const std::vector<int>&)>> dispatcher
+    {
+        [&calls](const std::vector<int>&)
+        {
+            ++calls;
+        }
+    };
+    dispatcher.cancel();
+
+    for (int i = 0; i < 10; ++i)
+    {
+        dispatcher.push(i);
+    }
+
+    EXPECT_TRUE(dispatcher.cancelled());
+    dispatcher.rundown();
+    EXPECT_EQ(0ul, dispatcher.size());
+    EXPECT_EQ(0, calls);
+}
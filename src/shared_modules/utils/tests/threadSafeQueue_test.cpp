@@ -115,4 +115,34 @@ TEST_F(ThreadSafeQueueTest, CancelBlockingPop)
     queue.cancel();
     t1.join();
     t2.join();
-}
\ No newline at end of file
+}
+TEST_F(ThreadSafeQueueTest, PushMoveOnlyValue)
+{
+    SafeQueue<std::unique_ptr<int>> queue;
+    queue.push(std::make_unique<int>(5));
+    std::unique_ptr<int> spValue;
+    EXPECT_TRUE(queue.pop(spValue, false));
+    ASSERT_TRUE(spValue);
+    EXPECT_EQ(5, *spValue);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(ThreadSafeQueueTest, PopBatch)
+{
+    SafeQueue<int> queue;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        queue.push(i);
+    }
+
+    std::vector<int> values;
+    EXPECT_TRUE(queue.popBatch(values, 4, false));
+    EXPECT_EQ((std::vector<int> {0, 1, 2, 3}), values);
+    values.clear();
+    EXPECT_TRUE(queue.popBatch(values, 100, false));
+    EXPECT_EQ((std::vector<int> {4, 5, 6, 7, 8, 9}), values);
+    values.clear();
+    EXPECT_FALSE(queue.popBatch(values, 100, false));
+    EXPECT_TRUE(values.empty());
+}
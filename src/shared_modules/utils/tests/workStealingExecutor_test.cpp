@@ -0,0 +1,110 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <future>
+#include <set>
+#include "workStealingExecutor_test.h"
+#include "workStealingExecutor.h"
+
+void WorkStealingExecutorTest::SetUp() {};
+
+void WorkStealingExecutorTest::TearDown() {};
+
+using namespace Utils;
+
+TEST_F(WorkStealingExecutorTest, Ctor)
+{
+    WorkStealingExecutor executor{ 2 };
+    EXPECT_EQ(2u, executor.numberOfThreads());
+    EXPECT_FALSE(executor.cancelled());
+    executor.cancel();
+    EXPECT_TRUE(executor.cancelled());
+}
+
+TEST_F(WorkStealingExecutorTest, ZeroThreadsUsesOne)
+{
+    WorkStealingExecutor executor{ 0 };
+    EXPECT_EQ(1u, executor.numberOfThreads());
+}
+
+TEST_F(WorkStealingExecutorTest, PostRunsTasks)
+{
+    constexpr auto NUMBER_OF_TASKS { 1000 };
+    WorkStealingExecutor executor{ 4 };
+    std::atomic<int> counter { 0 };
+    std::promise<void> done;
+
+    for (int i = 0; i < NUMBER_OF_TASKS; ++i)
+    {
+        executor.post([&counter, &done]()
+        {
+            if (++counter == NUMBER_OF_TASKS)
+            {
+                done.set_value();
+            }
+        });
+    }
+
+    done.get_future().wait();
+    EXPECT_EQ(NUMBER_OF_TASKS, counter);
+}
+
+TEST_F(WorkStealingExecutorTest, TasksPostedFromWorkersAreStolen)
+{
+    constexpr auto NUMBER_OF_TASKS { 8 };
+    WorkStealingExecutor executor{ 4 };
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    std::atomic<int> counter { 0 };
+    std::promise<void> done;
+
+    executor.post([&]()
+    {
+        // Every task lands in the deque of this worker, the other workers can only get them by stealing.
+        for (int i = 0; i < NUMBER_OF_TASKS; ++i)
+        {
+            executor.post([&]()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                {
+                    std::lock_guard<std::mutex> lock{ mutex };
+                    threads.insert(std::this_thread::get_id());
+                }
+
+                if (++counter == NUMBER_OF_TASKS)
+                {
+                    done.set_value();
+                }
+            });
+        }
+    });
+
+    done.get_future().wait();
+    EXPECT_LT(1ul, threads.size());
+}
+
+TEST_F(WorkStealingExecutorTest, PostAfterCancelIsIgnored)
+{
+    WorkStealingExecutor executor{ 1 };
+    std::atomic<bool> called { false };
+    executor.cancel();
+    executor.post([&called]()
+    {
+        called = true;
+    });
+    EXPECT_FALSE(called);
+}
+
+TEST_F(WorkStealingExecutorTest, Instance)
+{
+    EXPECT_EQ(&WorkStealingExecutor::instance(), &WorkStealingExecutor::instance());
+    EXPECT_EQ(WorkStealingExecutor::threadBudget(), WorkStealingExecutor::instance().numberOfThreads());
+}
@@ -12,12 +12,17 @@
 #ifndef THREAD_DISPATCHER_H
 #define THREAD_DISPATCHER_H
 #include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include <thread>
 #include <atomic>
 #include <future>
 #include <functional>
 #include <iostream>
 #include "threadSafeQueue.h"
+#include "lockFreeQueue.h"
+#include "workStealingExecutor.h"
 #include "promiseFactory.h"
 #include "commonDefs.h"
 
@@ -60,30 +65,73 @@ namespace Utils
     //  void cancel();
     // };
 
+    /**
+     * @brief Queue of a dispatcher, built from the dispatcher maximum queue size.
+     * @details Unbounded queues ignore the size, the dispatcher alone enforces it.
+     *
+     * @tparam Queue Queue policy.
+     * @tparam T     Element type.
+     */
+    template<template <class> class Queue, typename T>
+    class DispatcherQueue : public Queue<T>
+    {
+        public:
+            explicit DispatcherQueue(const size_t /*maxQueueSize*/)
+                : Queue<T>{}
+            {
+            }
+    };
+
+    /**
+     * @brief Lock-free queue of a dispatcher.
+     * @details The ring holds at least maxQueueSize elements, so the dispatcher bound is reached
+     * before the ring is full and an accepted push never waits for room.
+     *
+     * @tparam T Element type.
+     */
+    template<typename T>
+    class DispatcherQueue<LockFreeQueue, T> : public LockFreeQueue<T>
+    {
+        public:
+            explicit DispatcherQueue(const size_t maxQueueSize)
+                : LockFreeQueue<T>{ UNLIMITED_QUEUE_SIZE == maxQueueSize ? LOCK_FREE_QUEUE_DEFAULT_CAPACITY : maxQueueSize }
+            {
+            }
+    };
+
+    /**
+     * @brief Dispatcher processing the messages in a pool of threads.
+     *
+     * @tparam Type Messages types.
+     * @tparam Functor Entity that processes the messages.
+     * @tparam Queue Queue policy holding the pending tasks, SafeQueue or LockFreeQueue.
+     */
     template
     <
         typename Type,
-        typename Functor
+        typename Functor,
+        template <class> class Queue
         >
-    class AsyncDispatcher
+    class BasicAsyncDispatcher
     {
         public:
-            AsyncDispatcher(Functor functor, const unsigned int numberOfThreads = std::thread::hardware_concurrency(), const size_t maxQueueSize = UNLIMITED_QUEUE_SIZE)
+            BasicAsyncDispatcher(Functor functor, const unsigned int numberOfThreads = std::thread::hardware_concurrency(), const size_t maxQueueSize = UNLIMITED_QUEUE_SIZE)
                 : m_functor{ functor }
                 , m_running{ true }
                 , m_numberOfThreads{ numberOfThreads ? numberOfThreads : 1 }
+                , m_queue{ maxQueueSize }
                 , m_maxQueueSize { maxQueueSize }
             {
                 m_threads.reserve(m_numberOfThreads);
 
                 for (unsigned int i = 0; i < m_numberOfThreads; ++i)
                 {
-                    m_threads.push_back(std::thread{ &AsyncDispatcher<Type, Functor>::dispatch, this });
+                    m_threads.push_back(std::thread{ &BasicAsyncDispatcher<Type, Functor, Queue>::dispatch, this });
                 }
             }
-            AsyncDispatcher& operator=(const AsyncDispatcher&) = delete;
-            AsyncDispatcher(AsyncDispatcher& other) = delete;
-            ~AsyncDispatcher()
+            BasicAsyncDispatcher& operator=(const BasicAsyncDispatcher&) = delete;
+            BasicAsyncDispatcher(BasicAsyncDispatcher& other) = delete;
+            ~BasicAsyncDispatcher()
             {
                 cancel();
             }
@@ -105,6 +153,23 @@ namespace Utils
                 }
             }
 
+            void push(Type&& value)
+            {
+                if (m_running)
+                {
+                    if (UNLIMITED_QUEUE_SIZE == m_maxQueueSize || m_queue.size() < m_maxQueueSize)
+                    {
+                        m_queue.push
+                        (
+                            [value = std::move(value), this]()
+                        {
+                            this->m_functor(value);
+                        }
+                        );
+                    }
+                }
+            }
+
             void rundown()
             {
                 if (m_running)
@@ -173,11 +238,429 @@ namespace Utils
             }
 
             Functor m_functor;
-            SafeQueue<std::function<void()>> m_queue;
+            std::atomic_bool m_running;
+            const unsigned int m_numberOfThreads;
+            DispatcherQueue<Queue, std::function<void()>> m_queue;
             std::vector<std::thread> m_threads;
+            const size_t m_maxQueueSize;
+    };
+
+    template <typename Type, typename Functor>
+    using AsyncDispatcher = BasicAsyncDispatcher<Type, Functor, SafeQueue>;
+
+    template <typename Type, typename Functor>
+    using LockFreeAsyncDispatcher = BasicAsyncDispatcher<Type, Functor, LockFreeQueue>;
+
+    constexpr auto BATCH_DISPATCHER_DEFAULT_SIZE { 100u };
+
+    /**
+     * @brief Dispatcher handing the messages to the functor in batches.
+     * @details The queue holds the messages themselves instead of one task per message. Each worker
+     * pops up to batchSize messages per queue access and calls the functor once with all of them, so
+     * consumers can amortise per-call costs such as a database transaction.
+     *
+     * @tparam Type Messages types.
+     * @tparam Functor Entity that processes the messages, called with a const std::vector<Type>&.
+     * @tparam Queue Queue policy holding the pending messages, SafeQueue or LockFreeQueue.
+     */
+    template
+    <
+        typename Type,
+        typename Functor,
+        template <class> class Queue
+        >
+    class BasicBatchAsyncDispatcher
+    {
+        public:
+            BasicBatchAsyncDispatcher(Functor functor,
+                                      const unsigned int numberOfThreads = std::thread::hardware_concurrency(),
+                                      const size_t maxQueueSize = UNLIMITED_QUEUE_SIZE,
+                                      const size_t batchSize = BATCH_DISPATCHER_DEFAULT_SIZE)
+                : m_functor{ functor }
+                , m_running{ true }
+                , m_numberOfThreads{ numberOfThreads ? numberOfThreads : 1 }
+                , m_queue{ maxQueueSize }
+                , m_maxQueueSize{ maxQueueSize }
+                , m_batchSize{ batchSize ? batchSize : 1 }
+                , m_pending{ 0 }
+            {
+                m_threads.reserve(m_numberOfThreads);
+
+                for (unsigned int i = 0; i < m_numberOfThreads; ++i)
+                {
+                    m_threads.push_back(std::thread{ &BasicBatchAsyncDispatcher<Type, Functor, Queue>::dispatch, this });
+                }
+            }
+            BasicBatchAsyncDispatcher& operator=(const BasicBatchAsyncDispatcher&) = delete;
+            BasicBatchAsyncDispatcher(BasicBatchAsyncDispatcher& other) = delete;
+            ~BasicBatchAsyncDispatcher()
+            {
+                cancel();
+            }
+
+            void push(const Type& value)
+            {
+                if (accept())
+                {
+                    m_queue.push(value);
+                }
+            }
+
+            void push(Type&& value)
+            {
+                if (accept())
+                {
+                    m_queue.push(std::move(value));
+                }
+            }
+
+            void rundown()
+            {
+                if (m_running)
+                {
+                    std::unique_lock<std::mutex> lock{ m_mutex };
+                    m_cv.wait(lock, [this]()
+                    {
+                        return 0 == m_pending.load();
+                    });
+                    lock.unlock();
+                    cancel();
+                }
+            }
+            void cancel()
+            {
+                m_running = false;
+                m_queue.cancel();
+                joinThreads();
+            }
+
+            bool cancelled() const
+            {
+                return !m_running;
+            }
+            unsigned int numberOfThreads() const
+            {
+                return m_numberOfThreads;
+            }
+            size_t size() const
+            {
+                return m_queue.size();
+            }
+            size_t batchSize() const
+            {
+                return m_batchSize;
+            }
+
+        private:
+            bool accept()
+            {
+                const auto ret
+                {
+                    m_running && (UNLIMITED_QUEUE_SIZE == m_maxQueueSize || m_queue.size() < m_maxQueueSize)
+                };
+
+                if (ret)
+                {
+                    // Counted before it is queued so rundown never sees it neither pending nor queued.
+                    ++m_pending;
+                }
+
+                return ret;
+            }
+            void dispatch()
+            {
+                std::vector<Type> batch;
+                batch.reserve(m_batchSize);
+
+                try
+                {
+                    while (m_running)
+                    {
+                        if (m_queue.popBatch(batch, m_batchSize))
+                        {
+                            const auto processed { batch.size() };
+
+                            try
+                            {
+                                m_functor(static_cast<const std::vector<Type>&>(batch));
+                            }
+                            catch (const std::exception& ex)
+                            {
+                                std::cerr << "Dispatch handler error, " << ex.what() << std::endl;
+                            }
+
+                            batch.clear();
+
+                            if (m_pending.fetch_sub(processed) == processed)
+                            {
+                                std::lock_guard<std::mutex> lock{ m_mutex };
+                                m_cv.notify_all();
+                            }
+                        }
+                    }
+                }
+                // LCOV_EXCL_START
+                catch (const std::exception& ex)
+                {
+                    std::cerr << "Dispatch handler error, " << ex.what() << std::endl;
+                }
+
+                // LCOV_EXCL_STOP
+            }
+            void joinThreads()
+            {
+                for (auto& thread : m_threads)
+                {
+                    if (thread.joinable())
+                    {
+                        thread.join();
+                    }
+                }
+            }
+
+            Functor m_functor;
             std::atomic_bool m_running;
             const unsigned int m_numberOfThreads;
+            DispatcherQueue<Queue, Type> m_queue;
+            std::vector<std::thread> m_threads;
             const size_t m_maxQueueSize;
+            const size_t m_batchSize;
+            std::atomic<size_t> m_pending;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+    };
+
+    template <typename Type, typename Functor>
+    using BatchAsyncDispatcher = BasicBatchAsyncDispatcher<Type, Functor, SafeQueue>;
+
+    constexpr auto EXECUTOR_DISPATCHER_DRAIN_SIZE { 64u };
+
+    /**
+     * @brief Lanes of an ExecutorDispatcher queue.
+     */
+    enum class DispatchPriority
+    {
+        HIGH,
+        NORMAL,
+        LOW,
+        SIZE
+    };
+
+    /**
+     * @brief Messages a lane may take out of the queue per scheduling round, indexed by DispatchPriority.
+     * @details Every lane with pending messages keeps its share of a round, so a busy high lane
+     * slows the low one down without starving it.
+     */
+    constexpr unsigned int EXECUTOR_DISPATCHER_LANE_WEIGHTS[] { 8u, 2u, 1u };
+
+    /**
+     * @brief Dispatcher running its messages on the process-wide WorkStealingExecutor.
+     * @details Same interface as AsyncDispatcher, but instead of owning threads it keeps its own
+     * queue and has up to numberOfThreads drain tasks scheduled on the executor at a time. With a
+     * single thread the messages are processed one at a time in FIFO order, as with an AsyncDispatcher
+     * of one thread. Messages can be pushed on a DispatchPriority lane, the lanes are drained with
+     * weighted fair scheduling and keep FIFO order within each lane.
+     *
+     * @tparam Type Messages types.
+     * @tparam Functor Entity that processes the messages.
+     */
+    template <typename Type, typename Functor>
+    class ExecutorDispatcher
+    {
+        public:
+            ExecutorDispatcher(Functor functor,
+                               const unsigned int numberOfThreads = std::thread::hardware_concurrency(),
+                               const size_t maxQueueSize = UNLIMITED_QUEUE_SIZE)
+                : m_spState{ std::make_shared<State>(functor, numberOfThreads ? numberOfThreads : 1, maxQueueSize) }
+            {
+            }
+            ExecutorDispatcher& operator=(const ExecutorDispatcher&) = delete;
+            ExecutorDispatcher(ExecutorDispatcher& other) = delete;
+            ~ExecutorDispatcher()
+            {
+                cancel();
+            }
+
+            void push(const Type& value)
+            {
+                Type copy(value);
+                push(std::move(copy));
+            }
+
+            void push(Type&& value)
+            {
+                push(std::move(value), DispatchPriority::NORMAL);
+            }
+
+            void push(Type&& value, const DispatchPriority priority)
+            {
+                auto schedule { false };
+                {
+                    std::lock_guard<std::mutex> lock{ m_spState->mutex };
+
+                    if (m_spState->running &&
+                            (UNLIMITED_QUEUE_SIZE == m_spState->maxQueueSize || m_spState->size < m_spState->maxQueueSize))
+                    {
+                        m_spState->lanes[static_cast<size_t>(priority)].push_back(std::move(value));
+                        ++m_spState->size;
+                        schedule = m_spState->scheduled < m_spState->numberOfThreads;
+                        m_spState->scheduled += schedule ? 1 : 0;
+                    }
+                }
+
+                if (schedule)
+                {
+                    post(m_spState);
+                }
+            }
+
+            void rundown()
+            {
+                {
+                    std::unique_lock<std::mutex> lock{ m_spState->mutex };
+                    m_spState->cv.wait(lock, [this]()
+                    {
+                        return !m_spState->running || (!m_spState->size && !m_spState->active);
+                    });
+                }
+                cancel();
+            }
+
+            void cancel()
+            {
+                std::unique_lock<std::mutex> lock{ m_spState->mutex };
+                m_spState->running = false;
+
+                for (auto& lane : m_spState->lanes)
+                {
+                    lane.clear();
+                }
+
+                m_spState->size = 0;
+                // Drain tasks still scheduled on the executor find the dispatcher stopped, only the running ones are waited.
+                m_spState->cv.wait(lock, [this]()
+                {
+                    return !m_spState->active;
+                });
+            }
+
+            bool cancelled() const
+            {
+                std::lock_guard<std::mutex> lock{ m_spState->mutex };
+                return !m_spState->running;
+            }
+            unsigned int numberOfThreads() const
+            {
+                return m_spState->numberOfThreads;
+            }
+            size_t size() const
+            {
+                std::lock_guard<std::mutex> lock{ m_spState->mutex };
+                return m_spState->size;
+            }
+
+        private:
+            struct State final
+            {
+                State(Functor stateFunctor, const unsigned int stateNumberOfThreads, const size_t stateMaxQueueSize)
+                    : functor{ stateFunctor }
+                    , numberOfThreads{ stateNumberOfThreads }
+                    , maxQueueSize{ stateMaxQueueSize }
+                    , running{ true }
+                    , scheduled{ 0 }
+                    , active{ 0 }
+                    , size{ 0 }
+                    , credits{}
+                {}
+                Functor functor;
+                const unsigned int numberOfThreads;
+                const size_t maxQueueSize;
+                bool running;
+                unsigned int scheduled;
+                unsigned int active;
+                size_t size;
+                std::deque<Type> lanes[static_cast<size_t>(DispatchPriority::SIZE)];
+                unsigned int credits[static_cast<size_t>(DispatchPriority::SIZE)];
+                mutable std::mutex mutex;
+                std::condition_variable cv;
+            };
+
+            static void post(const std::shared_ptr<State>& spState)
+            {
+                WorkStealingExecutor::instance().post([spState]()
+                {
+                    drain(spState);
+                });
+            }
+
+            /**
+             * @brief Picks the highest priority lane with pending messages and credits left, and
+             * starts a new round when none has. Requires a non empty queue.
+             */
+            static std::deque<Type>& nextLane(State& state)
+            {
+                for (;;)
+                {
+                    for (size_t i = 0; i < static_cast<size_t>(DispatchPriority::SIZE); ++i)
+                    {
+                        if (state.credits[i] && !state.lanes[i].empty())
+                        {
+                            --state.credits[i];
+                            return state.lanes[i];
+                        }
+                    }
+
+                    for (size_t i = 0; i < static_cast<size_t>(DispatchPriority::SIZE); ++i)
+                    {
+                        state.credits[i] = EXECUTOR_DISPATCHER_LANE_WEIGHTS[i];
+                    }
+                }
+            }
+
+            static void drain(const std::shared_ptr<State>& spState)
+            {
+                std::unique_lock<std::mutex> lock{ spState->mutex };
+                ++spState->active;
+
+                for (unsigned int i = 0; i < EXECUTOR_DISPATCHER_DRAIN_SIZE && spState->running && spState->size; ++i)
+                {
+                    auto& lane { nextLane(*spState) };
+                    Type value(std::move(lane.front()));
+                    lane.pop_front();
+                    --spState->size;
+                    lock.unlock();
+
+                    try
+                    {
+                        spState->functor(value);
+                    }
+                    catch (const std::exception& ex)
+                    {
+                        std::cerr << "Dispatch handler error, " << ex.what() << std::endl;
+                    }
+
+                    lock.lock();
+                }
+
+                --spState->active;
+                // The drain task gives its thread back to the executor after a slice, and is posted again if needed.
+                const auto repost { spState->running && spState->size };
+
+                if (!repost)
+                {
+                    --spState->scheduled;
+                }
+
+                spState->cv.notify_all();
+                lock.unlock();
+
+                if (repost)
+                {
+                    post(spState);
+                }
+            }
+
+            std::shared_ptr<State> m_spState;
     };
 
     template <typename Input, typename Functor>
@@ -205,6 +688,13 @@ namespace Utils
                     m_functor(data);
                 }
             }
+            void push(Input&& data)
+            {
+                if (m_running)
+                {
+                    m_functor(std::move(data));
+                }
+            }
             size_t size() const
             {
                 return 0;
@@ -16,6 +16,7 @@
 #include <memory>
 #include <atomic>
 #include <condition_variable>
+#include <vector>
 
 namespace Utils
 {
@@ -50,6 +51,17 @@ namespace Utils
                 }
             }
 
+            void push(T&& value)
+            {
+                std::lock_guard<std::mutex> lock{ m_mutex };
+
+                if (!m_canceled)
+                {
+                    m_queue.push(std::move(value));
+                    m_cv.notify_one();
+                }
+            }
+
             bool pop(T& value, const bool wait = true)
             {
                 Lock lock{ m_mutex };
@@ -97,6 +109,38 @@ namespace Utils
                 return nullptr;
             }
 
+            /**
+             * @brief Pops up to maxItems elements under a single lock, waiting only for the first one.
+             *
+             * @param values   Vector where the popped elements are appended.
+             * @param maxItems Maximum number of elements to pop.
+             * @param wait     Whether to wait for the first element when the queue is empty.
+             *
+             * @return true when at least one element was popped.
+             */
+            bool popBatch(std::vector<T>& values, const size_t maxItems, const bool wait = true)
+            {
+                Lock lock{ m_mutex };
+
+                if (wait)
+                {
+                    m_cv.wait(lock, [this]()
+                    {
+                        return !m_queue.empty() || m_canceled;
+                    });
+                }
+
+                const bool ret {!m_canceled&& !m_queue.empty() && maxItems};
+
+                for (size_t i = 0; ret && i < maxItems && !m_queue.empty(); ++i)
+                {
+                    values.push_back(std::move(m_queue.front()));
+                    m_queue.pop();
+                }
+
+                return ret;
+            }
+
             bool empty() const
             {
                 std::lock_guard<std::mutex> lock{ m_mutex };
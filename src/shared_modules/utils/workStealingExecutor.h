@@ -0,0 +1,263 @@
+/*
+ * Wazuh shared modules utils
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef WORK_STEALING_EXECUTOR_H
+#define WORK_STEALING_EXECUTOR_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * @brief Pool of threads shared by every dispatcher of the process.
+     * @details Each worker owns a task deque. Tasks posted from a worker go to its own deque and tasks
+     * posted from any other thread go to a shared injection queue. An idle worker takes from its own
+     * deque first, then from the injection queue and finally steals from the other workers.
+     * Tasks must not block waiting for other tasks of the executor, the number of threads is fixed.
+     */
+    class WorkStealingExecutor final
+    {
+        public:
+            explicit WorkStealingExecutor(const unsigned int numberOfThreads)
+                : m_running{ true }
+                , m_pending{ 0 }
+                , m_sleepers{ 0 }
+            {
+                const auto threads { numberOfThreads ? numberOfThreads : 1 };
+                m_workers.reserve(threads);
+
+                for (unsigned int i = 0; i < threads; ++i)
+                {
+                    m_workers.push_back(std::make_unique<Worker>());
+                }
+
+                for (unsigned int i = 0; i < threads; ++i)
+                {
+                    m_workers[i]->thread = std::thread{ &WorkStealingExecutor::work, this, i };
+                }
+            }
+            WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+            WorkStealingExecutor(const WorkStealingExecutor& other) = delete;
+            ~WorkStealingExecutor()
+            {
+                cancel();
+            }
+
+            /**
+             * @brief Process-wide executor, created with the thread budget set at the time of the first call.
+             * @details It is never destroyed, so dispatchers released from static destructors can still run down.
+             */
+            static WorkStealingExecutor& instance()
+            {
+                static auto s_instance { new WorkStealingExecutor { threadBudget() } };
+                return *s_instance;
+            }
+
+            /**
+             * @brief Sets the number of threads of the process-wide executor.
+             * @details It only has effect before the first call to instance(), 0 means hardware concurrency.
+             */
+            static void threadBudget(const unsigned int numberOfThreads)
+            {
+                budget() = numberOfThreads;
+            }
+
+            static unsigned int threadBudget()
+            {
+                const auto numberOfThreads { budget().load() };
+                return numberOfThreads ? numberOfThreads : std::thread::hardware_concurrency();
+            }
+
+            void post(std::function<void()>&& task)
+            {
+                if (m_running)
+                {
+                    // Counted before it is queued, a worker taking it right away never sees the counter underflow.
+                    ++m_pending;
+                    const auto index { currentWorker() };
+
+                    if (index < m_workers.size())
+                    {
+                        std::lock_guard<std::mutex> lock{ m_workers[index]->mutex };
+                        m_workers[index]->tasks.push_back(std::move(task));
+                    }
+                    else
+                    {
+                        std::lock_guard<std::mutex> lock{ m_mutex };
+                        m_injected.push_back(std::move(task));
+                    }
+
+                    if (m_sleepers.load())
+                    {
+                        std::lock_guard<std::mutex> lock{ m_mutex };
+                        m_cv.notify_one();
+                    }
+                }
+            }
+
+            void cancel()
+            {
+                {
+                    std::lock_guard<std::mutex> lock{ m_mutex };
+                    m_running = false;
+                    m_cv.notify_all();
+                }
+
+                for (auto& worker : m_workers)
+                {
+                    if (worker->thread.joinable())
+                    {
+                        worker->thread.join();
+                    }
+                }
+            }
+
+            bool cancelled() const
+            {
+                return !m_running;
+            }
+
+            unsigned int numberOfThreads() const
+            {
+                return static_cast<unsigned int>(m_workers.size());
+            }
+
+        private:
+            struct Worker final
+            {
+                std::mutex mutex;
+                std::deque<std::function<void()>> tasks;
+                std::thread thread;
+            };
+
+            static std::atomic<unsigned int>& budget()
+            {
+                static std::atomic<unsigned int> s_budget { 0 };
+                return s_budget;
+            }
+
+            size_t currentWorker() const
+            {
+                const auto id { std::this_thread::get_id() };
+
+                for (size_t i = 0; i < m_workers.size(); ++i)
+                {
+                    if (m_workers[i]->thread.get_id() == id)
+                    {
+                        return i;
+                    }
+                }
+
+                return m_workers.size();
+            }
+
+            bool take(const size_t index, std::function<void()>& task)
+            {
+                auto ret { false };
+                {
+                    auto& own { *m_workers[index] };
+                    std::lock_guard<std::mutex> lock{ own.mutex };
+
+                    if (!own.tasks.empty())
+                    {
+                        task = std::move(own.tasks.front());
+                        own.tasks.pop_front();
+                        ret = true;
+                    }
+                }
+
+                if (!ret)
+                {
+                    std::lock_guard<std::mutex> lock{ m_mutex };
+
+                    if (!m_injected.empty())
+                    {
+                        task = std::move(m_injected.front());
+                        m_injected.pop_front();
+                        ret = true;
+                    }
+                }
+
+                for (size_t i = 1; !ret && i < m_workers.size(); ++i)
+                {
+                    // Steal the newest task of the victim, its owner keeps working on the oldest ones.
+                    auto& victim { *m_workers[(index + i) % m_workers.size()] };
+                    std::lock_guard<std::mutex> lock{ victim.mutex };
+
+                    if (!victim.tasks.empty())
+                    {
+                        task = std::move(victim.tasks.back());
+                        victim.tasks.pop_back();
+                        ret = true;
+                    }
+                }
+
+                if (ret)
+                {
+                    --m_pending;
+                }
+
+                return ret;
+            }
+
+            void work(const size_t index)
+            {
+                while (m_running)
+                {
+                    std::function<void()> task;
+
+                    if (take(index, task))
+                    {
+                        try
+                        {
+                            task();
+                        }
+                        // LCOV_EXCL_START
+                        catch (const std::exception& ex)
+                        {
+                            std::cerr << "Executor task error, " << ex.what() << std::endl;
+                        }
+
+                        // LCOV_EXCL_STOP
+                    }
+                    else
+                    {
+                        ++m_sleepers;
+                        {
+                            std::unique_lock<std::mutex> lock{ m_mutex };
+                            m_cv.wait(lock, [this]()
+                            {
+                                return m_pending.load() > 0 || !m_running;
+                            });
+                        }
+                        --m_sleepers;
+                    }
+                }
+            }
+
+            std::vector<std::unique_ptr<Worker>> m_workers;
+            std::deque<std::function<void()>> m_injected;
+            std::atomic_bool m_running;
+            std::atomic<size_t> m_pending;
+            std::atomic<size_t> m_sleepers;
+            std::mutex m_mutex;
+            std::condition_variable m_cv;
+    };
+}//namespace Utils
+
+#endif //WORK_STEALING_EXECUTOR_H
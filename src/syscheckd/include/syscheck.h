@@ -104,9 +104,13 @@ typedef struct create_json_event_ctx {
     const directory_t* config;
 } create_json_event_ctx;
 
+typedef struct fim_scan_pool_s fim_scan_pool_t;
+
 typedef struct fim_txn_context_s {
     event_data_t* evt_data;
     fim_entry* latest_entry;
+    fim_scan_pool_t* pool;       ///< Hashing threads of the scan, NULL when files are synced as they are found.
+    int fast_rescan;             ///< Files whose metadata didn't change since the previous scan aren't hashed again.
 } fim_txn_context_t;
 
 #ifdef WIN32
@@ -236,6 +240,17 @@ void fim_realtime_event(char *file);
  */
 void fim_whodata_event(whodata_evt *w_evt);
 
+/**
+ * @brief Process a path recorded as changed by a filesystem change journal
+ *
+ * The path is checked like in a scheduled scan, but its changes are reported right away. Existing directories
+ * are only walked when they show up, since the changes below them are recorded for their own entries.
+ *
+ * @param path Path of the changed file or directory
+ * @param new_name True if the path was created or renamed into its current name
+ */
+void fim_journal_event(const char *path, bool new_name);
+
 /**
  * @brief Process a path that has possibly been deleted
  *
@@ -280,6 +295,23 @@ int fim_check_depth(const char *path, const directory_t *configuration);
  */
 fim_file_data *fim_get_data(const char *file, const directory_t *configuration, const struct stat *statbuf);
 
+/**
+ * @brief Get data from file, reusing the hashes of its stored entry when the file looks unchanged
+ *
+ * @param file Name of the file to get the data from
+ * @param [in] configuration Configuration block associated with a previous event.
+ * @param [in] statbuf Buffer acquired from a stat command with information linked to 'path'
+ * @param [in] stored Entry stored in the DB for the file, NULL to always hash the file.
+ * @param stats Statistics where the hashing is counted, NULL when the file is not read by a scheduled scan.
+ *
+ * @return A fim_file_data structure with the data from the file
+ */
+fim_file_data *fim_get_file_data(const char *file,
+                                 const directory_t *configuration,
+                                 const struct stat *statbuf,
+                                 const fim_file_data *stored,
+                                 fim_scan_stats_t *stats);
+
 /**
  * @brief Initialize a fim_file_data structure
  *
@@ -306,6 +338,70 @@ void fim_print_info(struct timespec start, struct timespec end, clock_t cputime_
  */
 void fim_rt_delay();
 
+/**
+ * @brief Get the current time for the scan statistics
+ *
+ * @return Nanoseconds since the epoch
+ */
+int64_t fim_scan_stats_clock();
+
+/**
+ * @brief Add a value to a counter of the scan statistics of a directory block
+ *
+ * @param stats Statistics of the directory block, NULL to count nothing
+ * @param counter Counter to update
+ * @param value Value to add
+ */
+void fim_scan_stats_add(fim_scan_stats_t *stats, fim_scan_counter_t counter, uint64_t value);
+
+/**
+ * @brief Add the time elapsed since a previous fim_scan_stats_clock to a time counter
+ *
+ * @param stats Statistics of the directory block, NULL to count nothing
+ * @param counter Time counter to update
+ * @param since Value returned by fim_scan_stats_clock
+ */
+void fim_scan_stats_add_time(fim_scan_stats_t *stats, fim_scan_counter_t counter, int64_t since);
+
+/**
+ * @brief Count a hashed file, keeping it if it is among the slowest ones of the scan
+ *
+ * @param stats Statistics of the directory block, NULL to count nothing
+ * @param path Path of the file
+ * @param bytes Size of the file
+ * @param nsec Time spent hashing the file
+ */
+void fim_scan_stats_hashed(fim_scan_stats_t *stats, const char *path, size_t bytes, int64_t nsec);
+
+/**
+ * @brief Clear the scan statistics of a directory block
+ *
+ * @param stats Statistics of the directory block, it can be NULL
+ */
+void fim_scan_stats_reset(fim_scan_stats_t *stats);
+
+/**
+ * @brief Clear the statistics of every directory block when a scheduled scan starts
+ *
+ * The caller must hold syscheck.directories_lock.
+ */
+void fim_scan_stats_start();
+
+/**
+ * @brief Record the end of a scheduled scan
+ *
+ * @param wall_nsec Wall time of the scan
+ * @param cpu_nsec CPU time of the scan
+ */
+void fim_scan_stats_end(int64_t wall_nsec, int64_t cpu_nsec);
+
+/**
+ * @brief Get the statistics of the last scheduled scan, per directory block
+ *
+ * @return JSON object with the scan times and the counters and slowest files of each directory block
+ */
+cJSON *fim_scan_stats_json();
+
 
 /**
  * @brief Produce a file change JSON event
@@ -406,6 +502,31 @@ void fim_realtime_print_watches();
  */
 void realtime_process(void);
 
+#ifdef INOTIFY_ENABLED
+/**
+ * @brief Add paths to the real-time events waiting for the coalescing window to end
+ *
+ * The paths already pending are merged, so they are checked only once.
+ *
+ * @param paths NULL terminated array of paths with real-time events
+ */
+void realtime_pending_add(char **paths);
+
+/**
+ * @brief Get the time left until the pending real-time events have to be processed
+ *
+ * @return Milliseconds to wait, 0 if they are due, -1 if there are no pending events
+ */
+long realtime_pending_wait();
+
+/**
+ * @brief Process the pending real-time events whose coalescing window ended
+ *
+ * @param force Process them even if the window hasn't ended yet
+ */
+void realtime_flush_pending(bool force);
+#endif
+
 /**
  * @brief Deletes subdirectories watches when a folder changes its name
  *
@@ -463,11 +584,13 @@ int audit_init(void);
 char *audit_get_id(const char * event);
 
 /**
- * @brief Initialize regular expressions
+ * @brief Finds the id of an audit event, without copying it
  *
- * @return 0 on success, -1 on error
+ * @param event An audit event
+ * @param [out] length Length of the id
+ * @return Pointer to the id inside the event, NULL if it has none
  */
-int init_regex(void);
+const char *audit_event_id(const char *event, size_t *length);
 
 /**
  * @brief Adds audit rules to directories
@@ -652,6 +775,22 @@ char *fim_registry_value_diff(const char *key_name,
                               const char *value_data,
                               DWORD data_type,
                               const registry_t *configuration);
+
+/**
+ * @brief Record the current position of the USN journals of the volumes holding the monitored directories
+ *
+ * Journal scans replay the changes made after this point. The checkpoint must be taken before a full scan starts.
+ *
+ * @return 0 if every monitored directory is covered by a USN journal, -1 otherwise
+ */
+int fim_usn_checkpoint();
+
+/**
+ * @brief Check the files recorded as changed in the USN journals since the last checkpoint
+ *
+ * @return 0 on success, -1 if the journals can't be replayed and a full scan must be run instead
+ */
+int fim_usn_scan();
 #endif
 
 /**
@@ -664,6 +803,33 @@ char *fim_registry_value_diff(const char *key_name,
 
 char *fim_file_diff(const char *filename, const directory_t *configuration);
 
+/**
+ * @brief Computes the changes of a file against the copy stored in content-defined chunks, and stores the new version
+ *
+ * Only the chunks new to the version are compressed, and only the range between the first and the last changed
+ * chunks is compared. A whole copy stored by fim_file_diff is converted on its first change.
+ *
+ * @param diff Structure with all the data necessary to compute differences
+ * @return String with the diff to add to the alert, NULL if there isn't any
+ */
+char *fim_diff_chunked_file(const diff_data *diff);
+
+/**
+ * @brief Generates the diff file with the result of the diff/fc command
+ *
+ * @param diff Structure with all the data necessary to compute differences
+ * @return String with the changes to add to the alert
+ */
+char *fim_diff_generate(const diff_data *diff);
+
+/**
+ * @brief Checks if a specific file has been configured with the ``nodiff`` option
+ *
+ * @param filename The name of the file to check
+ * @return 1 if the file has been configured with the ``nodiff`` option, 0 if not
+ */
+int is_file_nodiff(const char *filename);
+
 /**
  * @brief Deletes the filename diff folder and modify diff_folder_size if disk_quota enabled
  *
@@ -723,6 +889,23 @@ int fim_check_restrict(const char *file_name, OSMatch *restriction);
  * @param Argument to be passed to the thread
  */
 void *syscom_main(void *arg);
+
+/**
+ * @brief Watch the directories holding the configured symbolic links, following the links they point to
+ *
+ * Previous watches are replaced. Must be called with the directories lock held.
+ *
+ * @return Number of directories watched, -1 if symbolic links can't be watched on this system
+ */
+int fim_link_watch_update();
+
+/**
+ * @brief Wait until a watched symbolic link is created, removed or replaced
+ *
+ * @param timeout Maximum seconds to wait
+ * @return 1 if a link changed, 0 on timeout
+ */
+int fim_link_watch_wait(int timeout);
 #endif
 
 /**
@@ -743,6 +926,14 @@ size_t syscom_dispatch(char *command, char **output);
  */
 size_t syscom_getconfig(const char *section, char **output);
 
+/**
+ * @brief Answers the scan statistics request
+ *
+ * @param [out] output The output buffer to be filled (answer for the API)
+ * @return The size of the output buffer
+ */
+size_t syscom_getstats(char **output);
+
 #ifdef WIN_WHODATA
 /**
  * @brief Updates the SACL of an specific file
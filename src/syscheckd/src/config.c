@@ -144,6 +144,11 @@ cJSON *getSyscheckConfig(void) {
     if (syscheck.scan_day) cJSON_AddStringToObject(syscfg,"scan_day",syscheck.scan_day);
     if (syscheck.scan_time) cJSON_AddStringToObject(syscfg,"scan_time",syscheck.scan_time);
     cJSON_AddNumberToObject(syscfg, "max_files_per_second", syscheck.max_files_per_second);
+    cJSON_AddNumberToObject(syscfg, "scan_threads", syscheck.scan_threads);
+    cJSON_AddStringToObject(syscfg, "fast_rescan", syscheck.fast_rescan ? "yes" : "no");
+    cJSON_AddNumberToObject(syscfg, "fast_rescan_full_verify", syscheck.fast_rescan_full_verify);
+    cJSON_AddStringToObject(syscfg, "inode_index", syscheck.inode_index ? "yes" : "no");
+    cJSON_AddStringToObject(syscfg, "memory_snapshot", syscheck.memory_snapshot ? "yes" : "no");
 
     cJSON * file_limit = cJSON_CreateObject();
     cJSON_AddStringToObject(file_limit, "enabled", syscheck.file_limit_enabled ? "yes" : "no");
@@ -167,6 +172,7 @@ cJSON *getSyscheckConfig(void) {
     cJSON_AddStringToObject(file_size, "enabled", syscheck.file_size_enabled ? "yes" : "no");
     cJSON_AddNumberToObject(file_size, "limit", syscheck.file_size_limit);
     cJSON_AddItemToObject(diff, "file_size", file_size);
+    cJSON_AddStringToObject(diff, "chunked_storage", syscheck.diff_chunked ? "yes" : "no");
 
     cJSON_AddItemToObject(syscfg, "diff", diff);
 
@@ -299,6 +305,8 @@ cJSON *getSyscheckConfig(void) {
 
 #ifdef WIN32
     cJSON_AddNumberToObject(syscfg, "windows_audit_interval", syscheck.wdata.interval_scan);
+    cJSON_AddStringToObject(syscfg, "usn_journal", syscheck.usn_journal ? "yes" : "no");
+    cJSON_AddNumberToObject(syscfg, "usn_full_verify", syscheck.usn_full_verify);
 
     if (syscheck.registry) {
         cJSON *rg = cJSON_CreateArray();
@@ -519,6 +527,9 @@ cJSON *getSyscheckInternalOptions(void) {
     cJSON_AddNumberToObject(syscheckd,"max_fd_win_rt",syscheck.max_fd_win_rt);
 #else
     cJSON_AddNumberToObject(syscheckd,"max_audit_entries",syscheck.max_audit_entries);
+    cJSON_AddNumberToObject(syscheckd,"rt_coalesce_window",syscheck.rt_coalesce_window);
+    cJSON_AddNumberToObject(syscheckd,"rt_coalesce_max",syscheck.rt_coalesce_max);
+    cJSON_AddNumberToObject(syscheckd,"rt_fanotify",syscheck.rt_fanotify);
 #endif
 
     cJSON_AddItemToObject(internals,"syscheck",syscheckd);
@@ -526,6 +537,7 @@ cJSON *getSyscheckInternalOptions(void) {
     cJSON *rootcheckd = cJSON_CreateObject();
 
     cJSON_AddNumberToObject(rootcheckd,"sleep",rootcheck.tsleep);
+    cJSON_AddNumberToObject(rootcheckd,"pid_slices",rootcheck.pid_slices);
     cJSON_AddItemToObject(internals,"rootcheck",rootcheckd);
     cJSON_AddItemToObject(root,"internal",internals);
 
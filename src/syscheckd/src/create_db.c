@@ -32,6 +32,9 @@ extern void mock_assert(const int result, const char* const expression,
 // Global variables
 static int _base_line = 0;
 
+// Files queued between the scan and its hashing threads, and between these and the transaction writer.
+#define FIM_SCAN_QUEUE_SIZE 4096
+
 static const char *FIM_EVENT_TYPE_ARRAY[] = {
     "added",
     "deleted",
@@ -473,36 +476,272 @@ int fim_generate_delete_event(const char *file_path,
     return fim_db_get_path(file_path, callback_data);
 }
 
-time_t fim_scan() {
-    struct timespec start;
-    struct timespec end;
-    time_t end_of_scan;
-    clock_t cputime_start;
-    int nodes_count = 0;
-    OSListNode *node_it;
-    directory_t *dir_it;
-    event_data_t evt_data = { .report_event = true, .mode = FIM_SCHEDULED, .w_evt = NULL };
-    fim_txn_context_t txn_ctx = { .evt_data = &evt_data, .latest_entry = NULL };
+typedef struct fim_scan_job_s {
+    char *path;                                 ///< NULL in the jobs that stop the threads.
+    const directory_t *configuration;
+    struct stat statbuf;
+    fim_file_data *data;
+} fim_scan_job_t;
+
+struct fim_scan_pool_s {
+    w_queue_t *jobs;                            ///< Files found by the scan, waiting to be hashed.
+    w_queue_t *results;                         ///< Hashed files, waiting to be synced.
+    pthread_t *workers;
+    pthread_t writer;
+    int threads;
+    TXN_HANDLE txn_handle;
+    fim_txn_context_t *txn_context;
+};
 
-    static fim_state_db _files_db_state = FIM_STATE_DB_EMPTY;
-#ifdef WIN32
-    static fim_state_db _registry_key_state = FIM_STATE_DB_EMPTY;
-    static fim_state_db _registry_value_state = FIM_STATE_DB_EMPTY;
-#endif
+/**
+ * @brief Asks the kernel to start reading a file queued to be hashed by the pool.
+ *
+ * The walk usually runs far ahead of the workers, so by the time a worker hashes the file its
+ * contents are already in the page cache instead of being read one blocking chunk at a time.
+ *
+ * @param job Job of the file, it is not queued yet.
+ * @param txn_context Callback context of the scan transaction.
+ */
+static void fim_scan_readahead(const fim_scan_job_t *job, const fim_txn_context_t *txn_context) {
+#ifdef POSIX_FADV_WILLNEED
+    int fd;
+
+    // Fast rescans hash few files, and the prefilter command reads the file by itself.
+    if (txn_context->fast_rescan || syscheck.prefilter_cmd != NULL || !S_ISREG(job->statbuf.st_mode) ||
+        job->statbuf.st_size <= 0 || (size_t)job->statbuf.st_size >= syscheck.file_max_size ||
+        !(job->configuration->options & (CHECK_MD5SUM | CHECK_SHA1SUM | CHECK_SHA256SUM))) {
+        return;
+    }
 
-#ifdef WIN32
-    SafeWow64DisableWow64FsRedirection(NULL); //Disable virtual redirection to 64bits folder due this is a x86 process
+    if (fd = open(job->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC), fd < 0) {
+        return;
+    }
+
+    // The readahead goes on after the descriptor is closed.
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+#else
+    (void)job;
+    (void)txn_context;
 #endif
-    cputime_start = clock();
-    gettime(&start);
-    minfo(FIM_FREQUENCY_STARTED);
-    fim_send_scan_info(FIM_SCAN_START);
+}
+
+static void fim_get_stored_data(void *data, void *ctx) {
+    const fim_file_data *entry_data = ((fim_entry *)data)->file_entry.data;
+    fim_file_data *stored = (fim_file_data *)ctx;
+
+    stored->size = entry_data->size;
+    stored->mtime = entry_data->mtime;
+    stored->inode = entry_data->inode;
+    stored->dev = entry_data->dev;
+    stored->options = entry_data->options;
+    snprintf(stored->hash_md5, sizeof(os_md5), "%s", entry_data->hash_md5);
+    snprintf(stored->hash_sha1, sizeof(os_sha1), "%s", entry_data->hash_sha1);
+    snprintf(stored->hash_sha256, sizeof(os_sha256), "%s", entry_data->hash_sha256);
+    stored->scanned = 1;
+}
+
+/**
+ * @brief Gets the entry stored for a file when the scan can reuse its hashes.
+ *
+ * @param path Path of the file.
+ * @param txn_context Callback context of the scan transaction.
+ * @param [out] stored Buffer where the stored metadata and hashes are copied, its strings other than the hashes are NULL.
+ *
+ * @return stored when the file has an entry and the scan is a fast rescan, NULL otherwise.
+ */
+static const fim_file_data *fim_scan_stored_data(const char *path,
+                                                 const fim_txn_context_t *txn_context,
+                                                 fim_file_data *stored) {
+    callback_context_t callback_data = { .callback = fim_get_stored_data, .context = stored };
+
+    if (txn_context == NULL || !txn_context->fast_rescan) {
+        return NULL;
+    }
+
+    memset(stored, 0, sizeof(fim_file_data));
+
+    if (fim_db_get_path(path, callback_data) != FIMDB_OK || !stored->scanned) {
+        return NULL;
+    }
+
+    return stored;
+}
+
+static void *fim_scan_worker(void *args) {
+    fim_scan_pool_t *pool = (fim_scan_pool_t *)args;
+    fim_scan_job_t *job;
+    fim_file_data stored;
+
+    while (job = queue_pop_ex(pool->jobs), job->path != NULL) {
+        // The files per second limit is shared by every thread.
+        check_max_fps();
+
+        job->data = fim_get_file_data(job->path,
+                                      job->configuration,
+                                      &job->statbuf,
+                                      fim_scan_stored_data(job->path, pool->txn_context, &stored),
+                                      job->configuration->stats);
+
+        if (job->data == NULL) {
+            mdebug1(FIM_GET_ATTRIBUTES, job->path);
+            os_free(job->path);
+            os_free(job);
+        } else {
+            queue_push_ex_block(pool->results, job);
+        }
+    }
+
+    // The stop job is forwarded, the writer ends once every worker is done.
+    queue_push_ex_block(pool->results, job);
+
+    return NULL;
+}
 
+static void *fim_scan_writer(void *args) {
+    fim_scan_pool_t *pool = (fim_scan_pool_t *)args;
+    fim_scan_job_t *job;
+    fim_entry new_entry;
+    int done = 0;
+
+    new_entry.type = FIM_TYPE_FILE;
+
+    // The transaction and its callback context are only used from this thread while the pool runs.
+    while (done < pool->threads) {
+        job = queue_pop_ex(pool->results);
+
+        if (job->path == NULL) {
+            done++;
+        } else {
+            const int64_t db_start = fim_scan_stats_clock();
+
+            new_entry.file_entry.path = job->path;
+            new_entry.file_entry.data = job->data;
+            pool->txn_context->latest_entry = &new_entry;
+
+            fim_db_transaction_sync_row(pool->txn_handle, &new_entry);
+            pool->txn_context->latest_entry = NULL;
+            fim_scan_stats_add_time(job->configuration->stats, FIM_STATS_DB_TIME, db_start);
+
+            free_file_data(job->data);
+            os_free(job->path);
+        }
+
+        os_free(job);
+    }
+
+    return NULL;
+}
+
+static void fim_scan_pool_stop_workers(fim_scan_pool_t *pool) {
+    fim_scan_job_t *stop_job;
+    int i;
+
+    for (i = 0; i < pool->threads; i++) {
+        os_calloc(1, sizeof(fim_scan_job_t), stop_job);
+        queue_push_ex_block(pool->jobs, stop_job);
+    }
+
+    for (i = 0; i < pool->threads; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+}
+
+static void fim_scan_pool_free(fim_scan_pool_t *pool) {
+    queue_free(pool->jobs);
+    queue_free(pool->results);
+    os_free(pool->workers);
+    os_free(pool);
+}
+
+/**
+ * @brief Starts the threads that hash the files found by a scheduled scan and sync them to the transaction.
+ *
+ * @param txn_handle Transaction where the files are synced.
+ * @param txn_context Callback context of the transaction.
+ *
+ * @return The started pool, NULL when the scan has to hash the files itself.
+ */
+static fim_scan_pool_t *fim_scan_pool_start(TXN_HANDLE txn_handle, fim_txn_context_t *txn_context) {
+    fim_scan_pool_t *pool = NULL;
+    int i;
+
+    if (syscheck.scan_threads <= 1) {
+        return NULL;
+    }
+
+    os_calloc(1, sizeof(fim_scan_pool_t), pool);
+    os_calloc(syscheck.scan_threads, sizeof(pthread_t), pool->workers);
+    pool->jobs = queue_init(FIM_SCAN_QUEUE_SIZE);
+    pool->results = queue_init(FIM_SCAN_QUEUE_SIZE);
+    pool->txn_handle = txn_handle;
+    pool->txn_context = txn_context;
+
+    for (i = 0; i < syscheck.scan_threads; i++) {
+        if (pthread_create(&pool->workers[i], NULL, fim_scan_worker, pool) != 0) {
+            merror(THREAD_ERROR); // LCOV_EXCL_LINE
+            break; // LCOV_EXCL_LINE
+        }
+    }
+
+    pool->threads = i;
+
+    // LCOV_EXCL_START
+    if (pool->threads > 0 && pthread_create(&pool->writer, NULL, fim_scan_writer, pool) != 0) {
+        merror(THREAD_ERROR);
+        // Nothing was queued yet, the results queue only holds the stop jobs forwarded by the workers.
+        fim_scan_pool_stop_workers(pool);
+
+        while (!queue_empty(pool->results)) {
+            free(queue_pop(pool->results));
+        }
+
+        pool->threads = 0;
+    }
+
+    if (pool->threads == 0) {
+        fim_scan_pool_free(pool);
+        return NULL;
+    }
+    // LCOV_EXCL_STOP
+
+    mdebug2(FIM_SCAN_THREADS, pool->threads);
+
+    return pool;
+}
+
+/**
+ * @brief Waits for every file queued in the pool to be synced and releases it.
+ *
+ * @param pool Pool started by fim_scan_pool_start, it can be NULL.
+ */
+static void fim_scan_pool_finish(fim_scan_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
 
-    TXN_HANDLE db_transaction_handle = fim_db_transaction_start(FIMDB_FILE_TXN_TABLE, transaction_callback, &txn_ctx);
+    fim_scan_pool_stop_workers(pool);
+    pthread_join(pool->writer, NULL);
+    fim_scan_pool_free(pool);
+}
+
+/**
+ * @brief Walk the monitored directories and sync every file found through a transaction.
+ *
+ * The files that were not found are reported as deleted once the walk is over.
+ *
+ * @param txn_ctx Callback context of the scan transaction.
+ * @return 0 on success, -1 if the transaction could not be started.
+ */
+static int fim_scan_files(fim_txn_context_t *txn_ctx) {
+    int nodes_count = 0;
+    OSListNode *node_it;
+    directory_t *dir_it;
+
+    TXN_HANDLE db_transaction_handle = fim_db_transaction_start(FIMDB_FILE_TXN_TABLE, transaction_callback, txn_ctx);
     if (db_transaction_handle == NULL) {
         merror(FIM_ERROR_TRANSACTION, FIMDB_FILE_TXN_TABLE);
-        return time(NULL);
+        return -1;
     }
     fim_diff_folder_size();
     syscheck.disk_quota_full_msg = true;
@@ -514,11 +753,13 @@ time_t fim_scan() {
     update_wildcards_config();
 
     w_rwlock_rdlock(&syscheck.directories_lock);
+    fim_scan_stats_start();
+    txn_ctx->pool = fim_scan_pool_start(db_transaction_handle, txn_ctx);
     OSList_foreach(node_it, syscheck.directories) {
         dir_it = node_it->data;
         char *path = fim_get_real_path(dir_it);
 
-        fim_checker(path, &evt_data, dir_it, db_transaction_handle, &txn_ctx);
+        fim_checker(path, txn_ctx->evt_data, dir_it, db_transaction_handle, txn_ctx);
 
 #ifndef WIN32
         realtime_adddir(path, dir_it);
@@ -529,6 +770,9 @@ time_t fim_scan() {
 #endif
         os_free(path);
     }
+    // The queued files hold configuration blocks, they must be synced before the directories can change.
+    fim_scan_pool_finish(txn_ctx->pool);
+    txn_ctx->pool = NULL;
     w_rwlock_unlock(&syscheck.directories_lock);
 
     w_mutex_unlock(&syscheck.fim_scan_mutex);
@@ -537,15 +781,16 @@ time_t fim_scan() {
         nodes_count = fim_db_get_count_file_entry();
     }
 
-    fim_db_transaction_deleted_rows(db_transaction_handle, transaction_callback, &txn_ctx);
+    fim_db_transaction_deleted_rows(db_transaction_handle, transaction_callback, txn_ctx);
     db_transaction_handle = NULL;
 
     if (syscheck.file_limit_enabled && (nodes_count >= syscheck.file_entry_limit)) {
         w_mutex_lock(&syscheck.fim_scan_mutex);
 
-        db_transaction_handle = fim_db_transaction_start(FIMDB_FILE_TXN_TABLE, transaction_callback, &txn_ctx);
+        db_transaction_handle = fim_db_transaction_start(FIMDB_FILE_TXN_TABLE, transaction_callback, txn_ctx);
 
         w_rwlock_rdlock(&syscheck.directories_lock);
+        txn_ctx->pool = fim_scan_pool_start(db_transaction_handle, txn_ctx);
         OSList_foreach(node_it, syscheck.directories) {
             dir_it = node_it->data;
             char *path;
@@ -553,7 +798,7 @@ time_t fim_scan() {
 
             path = fim_get_real_path(dir_it);
 
-            fim_checker(path, &evt_data, dir_it, db_transaction_handle, &txn_ctx);
+            fim_checker(path, &evt_data, dir_it, db_transaction_handle, txn_ctx);
 
             // Verify the directory is being monitored correctly
 #ifndef WIN32
@@ -565,20 +810,82 @@ time_t fim_scan() {
 #endif
             os_free(path);
         }
+        fim_scan_pool_finish(txn_ctx->pool);
+        txn_ctx->pool = NULL;
         w_rwlock_unlock(&syscheck.directories_lock);
 
         w_mutex_unlock(&syscheck.fim_scan_mutex);
 
-        fim_db_transaction_deleted_rows(db_transaction_handle, transaction_callback, &txn_ctx);
+        fim_db_transaction_deleted_rows(db_transaction_handle, transaction_callback, txn_ctx);
         db_transaction_handle = NULL;
     }
 
+    return 0;
+}
+
+time_t fim_scan() {
+    struct timespec start;
+    struct timespec end;
+    time_t end_of_scan;
+    clock_t cputime_start;
+    event_data_t evt_data = { .report_event = true, .mode = FIM_SCHEDULED, .w_evt = NULL };
+    fim_txn_context_t txn_ctx = { .evt_data = &evt_data, .latest_entry = NULL, .pool = NULL, .fast_rescan = 0 };
+
+    static fim_state_db _files_db_state = FIM_STATE_DB_EMPTY;
+    static unsigned int _scans_count = 0;
+#ifdef WIN32
+    static fim_state_db _registry_key_state = FIM_STATE_DB_EMPTY;
+    static fim_state_db _registry_value_state = FIM_STATE_DB_EMPTY;
+#endif
+
+#ifdef WIN32
+    SafeWow64DisableWow64FsRedirection(NULL); //Disable virtual redirection to 64bits folder due this is a x86 process
+#endif
+    cputime_start = clock();
+    gettime(&start);
+    minfo(FIM_FREQUENCY_STARTED);
+    fim_send_scan_info(FIM_SCAN_START);
+
+    // Every fast_rescan_full_verify scans all the files are hashed again, whatever their metadata.
+    _scans_count++;
+    // A database loaded from a snapshot is a baseline for the first scan too.
+    txn_ctx.fast_rescan = syscheck.fast_rescan && (_base_line || syscheck.snapshot_restored) &&
+                          (syscheck.fast_rescan_full_verify == 0 || _scans_count % syscheck.fast_rescan_full_verify != 0);
+
+    if (txn_ctx.fast_rescan) {
+        mdebug2(FIM_FAST_RESCAN);
+    }
+
+
+#ifdef WIN32
+    // Between full verifications, only the files recorded as changed in the USN journals are checked.
+    const int usn_scan = syscheck.usn_journal && _base_line && syscheck.wildcards == NULL &&
+                         (syscheck.usn_full_verify == 0 || _scans_count % syscheck.usn_full_verify != 0);
+
+    if (!usn_scan || fim_usn_scan() != 0) {
+        if (syscheck.usn_journal) {
+            // Changes made while the directories are walked are checked again by the next journal scan.
+            fim_usn_checkpoint();
+        }
+
+        if (fim_scan_files(&txn_ctx) != 0) {
+            return time(NULL);
+        }
+    }
+#else
+    if (fim_scan_files(&txn_ctx) != 0) {
+        return time(NULL);
+    }
+#endif
+
 #ifdef WIN32
     fim_registry_scan();
 #endif
 
     gettime(&end);
     end_of_scan = time(NULL);
+    fim_scan_stats_end((int64_t)(time_diff(&start, &end) * 1000000000),
+                       (int64_t)((double)(clock() - cputime_start) / CLOCKS_PER_SEC * 1000000000));
 
     if (syscheck.file_limit_enabled) {
         int files_count = fim_db_get_count_file_entry();
@@ -598,6 +905,14 @@ time_t fim_scan() {
     }
 #endif
 
+    if (syscheck.database_store == FIM_DB_MEMORY && syscheck.memory_snapshot) {
+        if (fim_db_snapshot_save(FIM_DB_SNAPSHOT_PATH) == FIMDB_OK) {
+            mdebug2(FIM_SNAPSHOT_SAVED, FIM_DB_SNAPSHOT_PATH);
+        } else {
+            mwarn(FIM_WARN_SNAPSHOT_SAVE, FIM_DB_SNAPSHOT_PATH);
+        }
+    }
+
     if (_base_line == 0) {
         _base_line = 1;
     } else {
@@ -627,6 +942,8 @@ void fim_checker(const char *path,
                  TXN_HANDLE dbsync_txn,
                  fim_txn_context_t *ctx) {
     directory_t *configuration;
+    fim_scan_stats_t *stats;
+    int64_t stat_start;
     int depth;
 
 #ifdef WIN32
@@ -641,6 +958,9 @@ void fim_checker(const char *path,
         return;
     }
 
+    // Only scheduled scans are accounted.
+    stats = evt_data->mode == FIM_SCHEDULED ? configuration->stats : NULL;
+
     if (parent_configuration == NULL) {
         // First time entering fim_checker
         // It's dangerous to go alone! Take this.
@@ -662,11 +982,17 @@ void fim_checker(const char *path,
 
     if (depth > configuration->recursion_level) {
         mdebug2(FIM_MAX_RECURSION_LEVEL, depth, configuration->recursion_level, path);
+        fim_scan_stats_add(stats, FIM_STATS_SKIPPED_DEPTH, 1);
         return;
     }
 
+    stat_start = stats != NULL ? fim_scan_stats_clock() : 0;
+    const int stat_failed = w_stat(path, &(evt_data->statbuf)) == -1;
+    fim_scan_stats_add_time(stats, FIM_STATS_STAT_TIME, stat_start);
+    fim_scan_stats_add(stats, FIM_STATS_FILES, 1);
+
     // Deleted file. Sending alert.
-    if (w_stat(path, &(evt_data->statbuf)) == -1) {
+    if (stat_failed) {
         if(errno != ENOENT) {
             mdebug1(FIM_STAT_FAILED, path, errno, strerror(errno));
             return;
@@ -715,6 +1041,7 @@ void fim_checker(const char *path,
     }
 
     if (fim_check_ignore(path) == 1) {
+        fim_scan_stats_add(stats, FIM_STATS_SKIPPED_IGNORE, 1);
         return;
     }
 
@@ -725,6 +1052,7 @@ void fim_checker(const char *path,
 #endif
     case FIM_REGULAR:
         if (fim_check_restrict(path, configuration->filerestrict) == 1) {
+            fim_scan_stats_add(stats, FIM_STATS_SKIPPED_RESTRICT, 1);
             return;
         }
 
@@ -734,6 +1062,7 @@ void fim_checker(const char *path,
     case FIM_DIRECTORY:
         if (depth == configuration->recursion_level) {
             mdebug2(FIM_DIR_RECURSION_LEVEL, path, depth);
+            fim_scan_stats_add(stats, FIM_STATS_SKIPPED_DEPTH, 1);
             return;
         }
         fim_directory(path, evt_data, configuration, dbsync_txn, ctx);
@@ -875,12 +1204,30 @@ void fim_file(const char *path,
     assert(evt_data != NULL);
 
     fim_entry new_entry;
+    fim_file_data stored;
+
+    if (txn_handle != NULL && txn_context->pool != NULL) {
+        fim_scan_job_t *job;
+
+        os_calloc(1, sizeof(fim_scan_job_t), job);
+        os_strdup(path, job->path);
+        job->configuration = configuration;
+        job->statbuf = evt_data->statbuf;
+        fim_scan_readahead(job, txn_context);
+        queue_push_ex_block(txn_context->pool->jobs, job);
+        return;
+    }
 
     check_max_fps();
 
     new_entry.type = FIM_TYPE_FILE;
     new_entry.file_entry.path = (char *)path;
-    new_entry.file_entry.data = fim_get_data(path, configuration, &(evt_data->statbuf));
+    // Only scheduled scans sync through a transaction, events always hash the file.
+    new_entry.file_entry.data = fim_get_file_data(path,
+                                                  configuration,
+                                                  &(evt_data->statbuf),
+                                                  txn_handle != NULL ? fim_scan_stored_data(path, txn_context, &stored) : NULL,
+                                                  txn_handle != NULL ? configuration->stats : NULL);
 
     if (new_entry.file_entry.data == NULL) {
         mdebug1(FIM_GET_ATTRIBUTES, path);
@@ -888,11 +1235,14 @@ void fim_file(const char *path,
     }
 
     if (txn_handle != NULL) {
+        const int64_t db_start = configuration->stats != NULL ? fim_scan_stats_clock() : 0;
+
         txn_context->latest_entry = &new_entry;
 
         fim_db_transaction_sync_row(txn_handle, &new_entry);
         free_file_data(new_entry.file_entry.data);
         txn_context->latest_entry = NULL;
+        fim_scan_stats_add_time(configuration->stats, FIM_STATS_DB_TIME, db_start);
     } else {
         create_json_event_ctx ctx = {
             .event = evt_data,
@@ -977,28 +1327,90 @@ void fim_db_remove_entry(void * data, void * ctx)
     fim_generate_delete_event(path, ctx_data->event, ctx_data->config);
 }
 
-void fim_process_wildcard_removed(directory_t *configuration) {
-    event_data_t evt_data = { .mode = FIM_SCHEDULED, .w_evt = NULL, .report_event = true, .type = FIM_DELETE };
+// Callback
+void fim_db_remove_prefix_entry(void * data, void * ctx)
+{
+    cJSON *json_event = NULL;
+    fim_entry *entry = (fim_entry *)data;
+    get_data_ctx *ctx_data = (struct get_data_ctx *)ctx;
+
+    // The entry is deleted along with the rest of the prefix once every callback has run.
+    if (ctx_data->config->options & CHECK_SEECHANGES) {
+        fim_diff_process_delete_file(entry->file_entry.path);
+    }
+
+    if (ctx_data->event->report_event) {
+        json_event = fim_json_event(entry, NULL, ctx_data->config, ctx_data->event, NULL);
+    }
+
+    if (json_event != NULL) {
+        send_syscheck_msg(json_event);
+    }
 
-    if (fim_generate_delete_event(configuration->path, &evt_data, configuration) == FIMDB_ERR)
+    cJSON_Delete(json_event);
+}
+
+/**
+ * @brief Report a path that no longer exists as deleted, along with every entry stored below it.
+ *
+ * @param path Path of the removed file or directory.
+ * @param evt_data Information associated to the deletion.
+ * @param configuration Configuration block of the path.
+ */
+static void fim_process_removed_path(const char *path, event_data_t *evt_data, const directory_t *configuration) {
+    if (fim_generate_delete_event(path, evt_data, configuration) == FIMDB_ERR)
     {
         return;
     }
 
     // Since the file doesn't exist, research if it's directory and have files in DB.
-    char pattern[PATH_MAX] = {0};
+    char prefix[PATH_MAX] = {0};
 
-    // Create the sqlite LIKE pattern -> "pathname/%"
-    snprintf(pattern, PATH_MAX, "%s%c%%", configuration->path, PATH_SEP);
+    // Remove every entry under the directory -> "pathname/"
+    snprintf(prefix, PATH_MAX, "%s%c", path, PATH_SEP);
     get_data_ctx ctx = {
-        .event = (event_data_t *)&evt_data,
+        .event = evt_data,
         .config = configuration,
-        .path = configuration->path
+        .path = path
     };
     callback_context_t callback_data;
-    callback_data.callback = fim_db_remove_entry;
+    callback_data.callback = fim_db_remove_prefix_entry;
     callback_data.context = &ctx;
-    fim_db_file_pattern_search(pattern, callback_data);
+    fim_db_remove_path_prefix(prefix, callback_data);
+}
+
+void fim_process_wildcard_removed(directory_t *configuration) {
+    event_data_t evt_data = { .mode = FIM_SCHEDULED, .w_evt = NULL, .report_event = true, .type = FIM_DELETE };
+
+    fim_process_removed_path(configuration->path, &evt_data, configuration);
+}
+
+void fim_journal_event(const char *path, bool new_name) {
+    event_data_t evt_data = { .mode = FIM_SCHEDULED, .w_evt = NULL, .report_event = true };
+    const directory_t *configuration;
+
+    configuration = fim_configuration_directory(path);
+    if (configuration == NULL) {
+        return;
+    }
+
+    if (w_stat(path, &evt_data.statbuf) == 0) {
+        // Changes inside a directory are journaled for its entries, it is only walked when it shows up.
+        if ((evt_data.statbuf.st_mode & S_IFMT) == FIM_DIRECTORY && !new_name) {
+            return;
+        }
+
+        fim_checker(path, &evt_data, NULL, NULL, NULL);
+        return;
+    }
+
+    if (errno != ENOENT) {
+        mdebug1(FIM_STAT_FAILED, path, errno, strerror(errno));
+        return;
+    }
+
+    evt_data.type = FIM_DELETE;
+    fim_process_removed_path(path, &evt_data, configuration);
 }
 
 // Callback
@@ -1043,15 +1455,15 @@ void fim_process_missing_entry(char * pathname, fim_event_mode mode, whodata_evt
         return;
     }
     // Since the file doesn't exist, research if it's directory and have files in DB.
-    char pattern[PATH_MAX] = {0};
+    char prefix[PATH_MAX] = {0};
 
-    // Create the sqlite LIKE pattern -> "pathname/%"
-    snprintf(pattern, PATH_MAX, "%s%c%%", pathname, PATH_SEP);
+    // Remove every entry under the directory -> "pathname/"
+    snprintf(prefix, PATH_MAX, "%s%c", pathname, PATH_SEP);
     evt_data.type = FIM_DELETE;
     ctx.event = (event_data_t *)&evt_data;
-    callback_data.callback = fim_db_remove_entry;
+    callback_data.callback = fim_db_remove_prefix_entry;
     callback_data.context = &ctx;
-    fim_db_file_pattern_search(pattern, callback_data);
+    fim_db_remove_path_prefix(prefix, callback_data);
 }
 
 // Checks the DB state, sends a message alert if necessary
@@ -1237,6 +1649,29 @@ int fim_check_depth(const char *path, const directory_t *configuration) {
 
 // Get data from file
 fim_file_data *fim_get_data(const char *file, const directory_t *configuration, const struct stat *statbuf) {
+    return fim_get_file_data(file, configuration, statbuf, NULL, NULL);
+}
+
+static int fim_metadata_unchanged(const fim_file_data *data,
+                                  const directory_t *configuration,
+                                  const struct stat *statbuf,
+                                  const fim_file_data *stored) {
+    // The size and the modification time are only known when they are checked.
+    return stored != NULL &&
+           stored->options == configuration->options &&
+           (configuration->options & CHECK_SIZE) &&
+           (configuration->options & CHECK_MTIME) &&
+           stored->size == data->size &&
+           stored->mtime == data->mtime &&
+           stored->inode == (unsigned long long int)statbuf->st_ino &&
+           stored->dev == (unsigned long int)statbuf->st_dev;
+}
+
+fim_file_data *fim_get_file_data(const char *file,
+                                 const directory_t *configuration,
+                                 const struct stat *statbuf,
+                                 const fim_file_data *stored,
+                                 fim_scan_stats_t *stats) {
     fim_file_data * data = NULL;
 
     os_calloc(1, sizeof(fim_file_data), data);
@@ -1308,15 +1743,32 @@ fim_file_data *fim_get_data(const char *file, const directory_t *configuration,
     // The file exists and we don't have to delete it from the hash tables
     data->scanned = 1;
 
+    // Files with the same size, modification time, inode and device as their stored entry keep its hashes.
     // We won't calculate hash for symbolic links, empty or large files
-    if (S_ISREG(statbuf->st_mode) && (statbuf->st_size > 0 && (size_t)statbuf->st_size < syscheck.file_max_size) &&
+    if (fim_metadata_unchanged(data, configuration, statbuf, stored)) {
+        snprintf(data->hash_md5, sizeof(os_md5), "%s", stored->hash_md5);
+        snprintf(data->hash_sha1, sizeof(os_sha1), "%s", stored->hash_sha1);
+        snprintf(data->hash_sha256, sizeof(os_sha256), "%s", stored->hash_sha256);
+    } else if (S_ISREG(statbuf->st_mode) && (statbuf->st_size > 0 && (size_t)statbuf->st_size < syscheck.file_max_size) &&
         (configuration->options & (CHECK_MD5SUM | CHECK_SHA1SUM | CHECK_SHA256SUM))) {
-        if (OS_MD5_SHA1_SHA256_File(file, syscheck.prefilter_cmd, data->hash_md5,
-                                    data->hash_sha1, data->hash_sha256, OS_BINARY, syscheck.file_max_size) < 0) {
+        const int64_t hash_start = stats != NULL ? fim_scan_stats_clock() : 0;
+
+        // Only the digests checked in the configuration block are calculated.
+        if (OS_MD5_SHA1_SHA256_File(file,
+                                    syscheck.prefilter_cmd,
+                                    (configuration->options & CHECK_MD5SUM) ? data->hash_md5 : NULL,
+                                    (configuration->options & CHECK_SHA1SUM) ? data->hash_sha1 : NULL,
+                                    (configuration->options & CHECK_SHA256SUM) ? data->hash_sha256 : NULL,
+                                    OS_BINARY,
+                                    syscheck.file_max_size) < 0) {
             mdebug1(FIM_HASHES_FAIL, file);
             free_file_data(data);
             return NULL;
         }
+
+        if (stats != NULL) {
+            fim_scan_stats_hashed(stats, file, (size_t)statbuf->st_size, fim_scan_stats_clock() - hash_start);
+        }
     }
 
     if ((configuration->options & CHECK_MD5SUM) == 0) {
@@ -1831,6 +2283,10 @@ void fim_print_info(struct timespec start, struct timespec end, clock_t cputime_
     inode_paths = fim_db_get_count_file_entry();
 
     mdebug1(FIM_INODES_INFO, inode_items, inode_paths);
+
+    if (syscheck.inode_index) {
+        mdebug1(FIM_INODE_INDEX_INFO, inode_items, fim_db_file_inode_index_memory());
+    }
 #endif
 
     return;
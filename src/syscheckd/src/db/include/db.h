@@ -39,6 +39,7 @@ extern "C" {
 
 #define FIM_DB_MEMORY_PATH  ":memory:"
 #define FIM_DB_DISK_PATH    "queue/fim/db/fim.db"
+#define FIM_DB_SNAPSHOT_PATH "queue/fim/db/fim.db.snapshot"
 
 #define EVP_MAX_MD_SIZE 64
 
@@ -101,6 +102,21 @@ EXPORTED FIMDBErrorCode fim_db_get_path(const char* file_path,
 EXPORTED FIMDBErrorCode fim_db_file_pattern_search(const char* pattern,
                                                    callback_context_t data);
 
+/**
+ * @brief Find the entries whose path starts with a prefix.
+ *
+ * Unlike fim_db_file_pattern_search, the prefix is taken literally and the entries are read from a range of the
+ * path index, in path order, without scanning the table.
+ *
+ * @param prefix Prefix of the paths, usually a directory followed by the path separator.
+ * @param data Pointer to the data structure where the callback context will be stored.
+ *
+ * @retval FIMDB_OK on success.
+ * @retval FIMDB_ERR on failure.
+ */
+EXPORTED FIMDBErrorCode fim_db_file_prefix_search(const char* prefix,
+                                                  callback_context_t data);
+
 /**
  * @brief Delete entry from the DB using file path.
  *
@@ -112,6 +128,17 @@ EXPORTED FIMDBErrorCode fim_db_file_pattern_search(const char* pattern,
  */
 EXPORTED FIMDBErrorCode fim_db_remove_path(const char* path);
 
+/**
+ * @brief Delete every entry whose path starts with a prefix, with a single database statement.
+ *
+ * @param prefix Prefix of the paths, usually a directory followed by the path separator.
+ * @param callback Callback called with the fim_entry of each entry, before the entries are deleted.
+ *
+ * @retval FIMDB_OK on success.
+ * @retval FIMDB_ERR on failure.
+ */
+EXPORTED FIMDBErrorCode fim_db_remove_path_prefix(const char* prefix, callback_context_t callback);
+
 /**
  * @brief Get count of all inodes in file_entry table.
  *
@@ -150,6 +177,23 @@ EXPORTED FIMDBErrorCode fim_db_file_inode_search(unsigned long long int inode,
                                                  unsigned long int dev,
                                                  callback_context_t data);
 
+/**
+ * @brief Keep an in-memory index of the files by inode, loaded with the files already stored.
+ *
+ * From then on fim_db_file_inode_search and fim_db_get_count_file_inode don't query the database.
+ * It has to be called before the database is used by other threads.
+ *
+ * @return FIMDB_OK on success.
+ */
+EXPORTED FIMDBErrorCode fim_db_file_inode_index_init();
+
+/**
+ * @brief Get the estimated memory used by the inode index.
+ *
+ * @return Number of bytes, 0 when the index is not enabled.
+ */
+EXPORTED size_t fim_db_file_inode_index_memory();
+
 /**
  * @brief Push a message to the syscheck queue
  *
@@ -206,6 +250,27 @@ EXPORTED FIMDBErrorCode fim_db_transaction_deleted_rows(TXN_HANDLE txn_handler,
                                                         result_callback_t callback,
                                                         void* txn_ctx);
 
+/**
+ * @brief Save a snapshot of the database to a file, replacing the previous one atomically.
+ *
+ * @param path Path of the snapshot file.
+ *
+ * @return FIMDB_OK on success.
+ */
+EXPORTED FIMDBErrorCode fim_db_snapshot_save(const char* path);
+
+/**
+ * @brief Load the database from a snapshot saved by fim_db_snapshot_save.
+ *
+ * The snapshot is refused when its tables don't match the ones of the database, which is kept as it is.
+ * It has to be called before fim_db_file_inode_index_init and before the database is used by other threads.
+ *
+ * @param path Path of the snapshot file.
+ *
+ * @return FIMDB_OK on success.
+ */
+EXPORTED FIMDBErrorCode fim_db_snapshot_restore(const char* path);
+
 /**
  * @brief Turns off the services provided.
  *
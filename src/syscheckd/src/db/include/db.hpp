@@ -38,7 +38,8 @@ typedef enum COUNT_SELECT_TYPE
 typedef enum FILE_SEARCH_TYPE
 {
     SEARCH_TYPE_PATH,
-    SEARCH_TYPE_INODE
+    SEARCH_TYPE_INODE,
+    SEARCH_TYPE_PREFIX
 } FILE_SEARCH_TYPE;
 
 using SearchData = std::tuple<FILE_SEARCH_TYPE, std::string, std::string, std::string>;
@@ -140,6 +141,15 @@ class EXPORTED DB final
         */
         void removeFile(const std::string& path);
 
+        /**
+        * @brief removeFilePrefix Remove every file whose path starts with a prefix, with a single delete.
+        *
+        * @param prefix Prefix of the paths to remove, usually a directory followed by the path separator.
+        * @param callback Callback called with each file before the files are removed.
+        */
+        void removeFilePrefix(const std::string& prefix,
+                              std::function<void(const nlohmann::json&)> callback);
+
         /**
         * @brief getFile Get a file from the database.
         *
@@ -170,6 +180,11 @@ class EXPORTED DB final
                         create_json_event_ctx* ctx,
                         std::function<void(nlohmann::json)> callbackPrimitive);
 
+        /**
+        * @brief enableInodeIndex Enable the inode index of the files and load it with the stored files.
+        */
+        void enableInodeIndex();
+
         /**
         * @brief searchFiles Search files in the database.
         *
@@ -22,6 +22,39 @@
 #include "fimDBSpecialization.h"
 #include "stringHelper.h"
 #include "cjsonSmartDeleter.hpp"
+#include <map>
+#include <mutex>
+
+// Callbacks of the transactions started while the inode index is enabled, by transaction handle.
+static std::mutex s_txnCallbacksMutex;
+static std::map<TXN_HANDLE, std::unique_ptr<callback_data_t>> s_txnCallbacks;
+
+/**
+ * @brief Removes from the inode index the file rows rejected or deleted by a transaction.
+ * @details Stored rows are indexed before they are synced, with the exact values of the entry,
+ * the numbers of the cJSON results are doubles and can't hold every inode.
+ */
+static void inodeIndexTxnResult(ReturnTypeCallback resultType, const cJSON* resultJson)
+{
+    if (MAX_ROWS == resultType || DELETED == resultType)
+    {
+        const auto path { cJSON_GetStringValue(cJSON_GetObjectItem(resultJson, "path")) };
+
+        // Registry rows don't have an inode.
+        if (path && cJSON_GetObjectItem(resultJson, "inode"))
+        {
+            FIMDB::instance().inodeIndex().remove(path);
+        }
+    }
+}
+
+static void inodeIndexTxnCallback(ReturnTypeCallback resultType, const cJSON* resultJson, void* userData)
+{
+    const auto callbackData { reinterpret_cast<const callback_data_t*>(userData) };
+
+    inodeIndexTxnResult(resultType, resultJson);
+    callbackData->callback(resultType, resultJson, callbackData->user_data);
+}
 
 void DB::init(const int storage,
               const int syncInterval,
@@ -317,9 +350,23 @@ TXN_HANDLE fim_db_transaction_start(const char* table, result_callback_t row_cal
 
     callback_data_t cb_data = { .callback = row_callback, .user_data = user_data };
 
+    if (!FIMDB::instance().inodeIndex().enabled() || !row_callback)
+    {
+        return dbsync_create_txn(DB::instance().DBSyncHandle(), jsInput.get(), 0, QUEUE_SIZE, cb_data);
+    }
+
+    auto spCallbackData { std::make_unique<callback_data_t>(cb_data) };
+    cb_data = { .callback = inodeIndexTxnCallback, .user_data = spCallbackData.get() };
+
     TXN_HANDLE dbsyncTxnHandle = dbsync_create_txn(DB::instance().DBSyncHandle(), jsInput.get(), 0,
                                                    QUEUE_SIZE, cb_data);
 
+    if (dbsyncTxnHandle)
+    {
+        std::lock_guard<std::mutex> lock{ s_txnCallbacksMutex };
+        s_txnCallbacks[dbsyncTxnHandle] = std::move(spCallbackData);
+    }
+
     return dbsyncTxnHandle;
 }
 
@@ -347,15 +394,24 @@ FIMDBErrorCode fim_db_transaction_sync_row(TXN_HANDLE txn_handler, const fim_ent
             }
         }
 
-        const std::unique_ptr<cJSON, CJsonSmartDeleter> jsInput
+        // Indexed before the sync, a rejected row is removed by its result, that may be dispatched right away.
+        if (entry->type == FIM_TYPE_FILE)
         {
-            cJSON_Parse((*syncItem->toJSON()).dump().c_str())
-        };
+            FIMDB::instance().inodeIndex().insert(entry->file_entry.path,
+                                                  entry->file_entry.data->inode,
+                                                  entry->file_entry.data->dev);
+        }
 
-        if (dbsync_sync_txn_row(txn_handler, jsInput.get()) == 0)
+        // The row is synced as it is, going through the C interface would print and parse it twice.
+        try
         {
+            DBSyncTxn{ txn_handler }.syncTxnRow(*syncItem->toJSON());
             retval = FIMDB_OK;
         }
+        catch (const std::exception& err)
+        {
+            FIMDB::instance().logFunction(LOG_ERROR, err.what());
+        }
     }
 
     return retval;
@@ -367,12 +423,31 @@ FIMDBErrorCode fim_db_transaction_deleted_rows(TXN_HANDLE txn_handler,
 {
     auto retval {FIMDB_OK};
     callback_data_t cb_data = { .callback = res_callback, .user_data = txn_ctx };
+    callback_data_t deletedCallbackData { cb_data };
+    std::unique_ptr<callback_data_t> spCallbackData;
+
+    {
+        std::lock_guard<std::mutex> lock{ s_txnCallbacksMutex };
+        const auto it { s_txnCallbacks.find(txn_handler) };
+
+        if (s_txnCallbacks.end() != it)
+        {
+            spCallbackData = std::move(it->second);
+            s_txnCallbacks.erase(it);
+        }
+    }
+
+    if (spCallbackData && res_callback)
+    {
+        cb_data = { .callback = inodeIndexTxnCallback, .user_data = &deletedCallbackData };
+    }
 
     if (dbsync_get_deleted_rows(txn_handler, cb_data) != 0)
     {
         retval = FIMDB_ERR;
     }
 
+    // The pending results of the transaction are dispatched before it is closed, its callback data is released afterwards.
     if (dbsync_close_txn(txn_handler) != 0)
     {
         retval = FIMDB_ERR;
@@ -381,6 +456,54 @@ FIMDBErrorCode fim_db_transaction_deleted_rows(TXN_HANDLE txn_handler,
     return retval;
 }
 
+FIMDBErrorCode fim_db_snapshot_save(const char* path)
+{
+    auto retVal { FIMDB_ERR };
+
+    if (!path)
+    {
+        FIMDB::instance().logFunction(LOG_ERROR, "Invalid parameters");
+    }
+    else
+    {
+        try
+        {
+            FIMDB::instance().DBSyncHandler()->backup(path);
+            retVal = FIMDB_OK;
+        }
+        catch (const std::exception& err)
+        {
+            FIMDB::instance().logFunction(LOG_ERROR, err.what());
+        }
+    }
+
+    return retVal;
+}
+
+FIMDBErrorCode fim_db_snapshot_restore(const char* path)
+{
+    auto retVal { FIMDB_ERR };
+
+    if (!path)
+    {
+        FIMDB::instance().logFunction(LOG_ERROR, "Invalid parameters");
+    }
+    else
+    {
+        try
+        {
+            FIMDB::instance().DBSyncHandler()->restore(path);
+            retVal = FIMDB_OK;
+        }
+        catch (const std::exception& err)
+        {
+            FIMDB::instance().logFunction(LOG_DEBUG, err.what());
+        }
+    }
+
+    return retVal;
+}
+
 void fim_db_teardown()
 {
     try
@@ -31,6 +31,29 @@ static const char* FIM_EVENT_MODE[] =
     "whodata"
 };
 
+static const std::vector<std::string> FILE_ENTRY_COLUMNS
+{
+    "path",
+    "mode",
+    "last_event",
+    "scanned",
+    "options",
+    "checksum",
+    "dev",
+    "inode",
+    "size",
+    "perm",
+    "attributes",
+    "uid",
+    "gid",
+    "user_name",
+    "group_name",
+    "hash_md5",
+    "hash_sha1",
+    "hash_sha256",
+    "mtime"
+};
+
 enum SEARCH_FIELDS
 {
     SEARCH_FIELD_TYPE,
@@ -336,6 +359,108 @@ void DB::removeFile(const std::string& path)
     };
 
     FIMDB::instance().removeItem(deleteQuery.query());
+    FIMDB::instance().inodeIndex().remove(path);
+}
+
+static std::string quotePath(const std::string& value)
+{
+    // Utils::replaceAll would find the doubled quote again.
+    std::string quoted { "'" };
+
+    for (const auto character : value)
+    {
+        quoted += character;
+
+        if ('\'' == character)
+        {
+            quoted += character;
+        }
+    }
+
+    return quoted + "'";
+}
+
+/**
+ * @brief Filter of the paths starting with a prefix, a range of the primary key instead of a LIKE that scans the table.
+ */
+static std::string pathPrefixFilter(const std::string& prefix)
+{
+    if (prefix.empty())
+    {
+        throw std::runtime_error{ "Invalid prefix" };
+    }
+
+    // The paths starting with the prefix are the primary key range [prefix, upperBound).
+    auto upperBound { prefix };
+
+    while (!upperBound.empty() && static_cast<unsigned char>(upperBound.back()) == 0xFF)
+    {
+        upperBound.pop_back();
+    }
+
+    auto filter { "path >= " + quotePath(prefix) };
+
+    if (!upperBound.empty())
+    {
+        ++upperBound.back();
+        filter += " AND path < " + quotePath(upperBound);
+    }
+
+    return filter;
+}
+
+void DB::removeFilePrefix(const std::string& prefix, std::function<void(const nlohmann::json&)> callback)
+{
+    const auto filter { pathPrefixFilter(prefix) };
+
+    auto selectQuery
+    {
+        SelectQuery::builder()
+        .table(FIMDB_FILE_TABLE_NAME)
+        .columnList(FILE_ENTRY_COLUMNS)
+        .rowFilter("WHERE " + filter)
+        .orderByOpt(FILE_PRIMARY_KEY)
+        .distinctOpt(false)
+        .build()
+    };
+
+    std::vector<std::string> removedPaths;
+    const auto selectCallback
+    {
+        [&removedPaths, &callback](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            if (ReturnTypeCallback::SELECTED == type)
+            {
+                removedPaths.push_back(jsonResult.at("path"));
+
+                if (callback)
+                {
+                    callback(jsonResult);
+                }
+            }
+        }
+    };
+
+    FIMDB::instance().executeQuery(selectQuery.query(), selectCallback);
+
+    if (!removedPaths.empty())
+    {
+        // A single statement on the range, the table row counter is updated with the deleted rows.
+        auto deleteQuery
+        {
+            DeleteQuery::builder()
+            .table(FIMDB_FILE_TABLE_NAME)
+            .rowFilter(filter)
+            .build()
+        };
+
+        FIMDB::instance().removeItem(deleteQuery.query());
+
+        for (const auto& path : removedPaths)
+        {
+            FIMDB::instance().inodeIndex().remove(path);
+        }
+    }
 }
 
 void DB::getFile(const std::string& path, std::function<void(const nlohmann::json&)> callback)
@@ -344,25 +469,7 @@ void DB::getFile(const std::string& path, std::function<void(const nlohmann::jso
     {
         SelectQuery::builder()
         .table(FIMDB_FILE_TABLE_NAME)
-        .columnList({"path",
-            "mode",
-            "last_event",
-            "scanned",
-            "options",
-            "checksum",
-            "dev",
-            "inode",
-            "size",
-            "perm",
-            "attributes",
-            "uid",
-            "gid",
-            "user_name",
-            "group_name",
-            "hash_md5",
-            "hash_sha1",
-            "hash_sha256",
-            "mtime"})
+        .columnList(FILE_ENTRY_COLUMNS)
         .rowFilter(std::string("WHERE path=\"") + std::string(path) + "\"")
         .orderByOpt(FILE_PRIMARY_KEY)
         .distinctOpt(false)
@@ -409,7 +516,54 @@ void DB::updateFile(const nlohmann::json& file, create_json_event_ctx* ctx, std:
 
     FIMDB::instance().updateItem(file, callback);
 
-    return;
+    // Reached only when the row is stored, a rejected row throws.
+    if (FIMDB::instance().inodeIndex().enabled())
+    {
+        const auto& data { file.at("data").at(0) };
+        FIMDB::instance().inodeIndex().insert(data.at("path"), data.at("inode"), data.at("dev"));
+    }
+}
+
+void DB::enableInodeIndex()
+{
+    auto& index { FIMDB::instance().inodeIndex() };
+
+    auto selectQuery
+    {
+        SelectQuery::builder()
+        .table(FIMDB_FILE_TABLE_NAME)
+        .columnList({"path", "inode", "dev"})
+        .rowFilter("")
+        .orderByOpt(FILE_PRIMARY_KEY)
+        .distinctOpt(false)
+        .build()
+    };
+
+    const auto callback
+    {
+        [&index](ReturnTypeCallback type, const nlohmann::json & jsonResult)
+        {
+            if (ReturnTypeCallback::SELECTED == type)
+            {
+                index.insert(jsonResult.at("path"), jsonResult.at("inode"), jsonResult.at("dev"));
+            }
+        }
+    };
+
+    index.enable();
+
+    try
+    {
+        FIMDB::instance().executeQuery(selectQuery.query(), callback);
+    }
+    // LCOV_EXCL_START
+    catch (...)
+    {
+        index.disable();
+        throw;
+    }
+
+    // LCOV_EXCL_STOP
 }
 
 void DB::searchFile(const SearchData& data, std::function<void(const std::string&)> callback)
@@ -425,6 +579,10 @@ void DB::searchFile(const SearchData& data, std::function<void(const std::string
     {
         filter = "WHERE path LIKE \"" + std::get<SEARCH_FIELD_PATH>(data) + "\"";
     }
+    else if (SEARCH_TYPE_PREFIX == searchType)
+    {
+        filter = "WHERE " + pathPrefixFilter(std::get<SEARCH_FIELD_PATH>(data));
+    }
     else
     {
         throw std::runtime_error{ "Invalid search type" };
@@ -496,6 +654,37 @@ FIMDBErrorCode fim_db_get_path(const char* file_path, callback_context_t callbac
     return retVal;
 }
 
+FIMDBErrorCode fim_db_remove_path_prefix(const char* prefix, callback_context_t callback)
+{
+    auto retVal { FIMDB_ERR };
+
+    if (!prefix || !*prefix || !callback.callback)
+    {
+        FIMDB::instance().logFunction(LOG_ERROR, "Invalid parameters");
+    }
+    else
+    {
+        try
+        {
+            DB::instance().removeFilePrefix(prefix, [&callback](const nlohmann::json & jsonResult)
+            {
+                const auto file { std::make_unique<FileItem>(jsonResult) };
+                callback.callback(file->toFimEntry(), callback.context);
+            });
+            retVal = FIMDB_OK;
+        }
+        // LCOV_EXCL_START
+        catch (const std::exception& err)
+        {
+            FIMDB::instance().logFunction(LOG_ERROR, err.what());
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    return retVal;
+}
+
 FIMDBErrorCode fim_db_remove_path(const char* path)
 {
     auto retVal { FIMDB_ERR };
@@ -529,7 +718,9 @@ int fim_db_get_count_file_inode()
 
     try
     {
-        count = DB::instance().countEntries(FIMDB_FILE_TABLE_NAME, COUNT_SELECT_TYPE::COUNT_INODE);
+        const auto& index { FIMDB::instance().inodeIndex() };
+        count = index.enabled() ? static_cast<int>(index.inodes())
+                : DB::instance().countEntries(FIMDB_FILE_TABLE_NAME, COUNT_SELECT_TYPE::COUNT_INODE);
     }
     // LCOV_EXCL_START
     catch (const std::exception& err)
@@ -612,7 +803,78 @@ FIMDBErrorCode fim_db_file_inode_search(const unsigned long long int inode,
     {
         try
         {
-            DB::instance().searchFile(std::make_tuple(SEARCH_TYPE_INODE, "", std::to_string(inode), std::to_string(dev)),
+            const auto searchCallback
+            {
+                [callback] (const std::string & path)
+                {
+                    char* entry = const_cast<char*>(path.c_str());
+                    callback.callback(entry, callback.context);
+                }
+            };
+            const auto& index { FIMDB::instance().inodeIndex() };
+
+            if (index.enabled())
+            {
+                index.search(inode, dev, searchCallback);
+            }
+            else
+            {
+                DB::instance().searchFile(std::make_tuple(SEARCH_TYPE_INODE, "", std::to_string(inode), std::to_string(dev)),
+                                          searchCallback);
+            }
+
+            retVal = FIMDB_OK;
+        }
+        // LCOV_EXCL_START
+        catch (const std::exception& err)
+        {
+            FIMDB::instance().logFunction(LOG_ERROR, err.what());
+        }
+
+        // LCOV_EXCL_STOP
+    }
+
+    return retVal;
+}
+
+FIMDBErrorCode fim_db_file_inode_index_init()
+{
+    auto retVal { FIMDB_ERR };
+
+    try
+    {
+        DB::instance().enableInodeIndex();
+        retVal = FIMDB_OK;
+    }
+    // LCOV_EXCL_START
+    catch (const std::exception& err)
+    {
+        FIMDB::instance().logFunction(LOG_ERROR, err.what());
+    }
+
+    // LCOV_EXCL_STOP
+
+    return retVal;
+}
+
+size_t fim_db_file_inode_index_memory()
+{
+    return FIMDB::instance().inodeIndex().memoryUsage();
+}
+
+FIMDBErrorCode fim_db_file_pattern_search(const char* pattern, callback_context_t callback)
+{
+    auto retVal { FIMDB_ERR };
+
+    if (!pattern || !callback.callback)
+    {
+        FIMDB::instance().logFunction(LOG_ERROR, "Invalid parameters");
+    }
+    else
+    {
+        try
+        {
+            DB::instance().searchFile(std::make_tuple(SEARCH_TYPE_PATH, pattern, "", ""),
                                       [callback] (const std::string & path)
             {
                 char* entry = const_cast<char*>(path.c_str());
@@ -632,11 +894,11 @@ FIMDBErrorCode fim_db_file_inode_search(const unsigned long long int inode,
     return retVal;
 }
 
-FIMDBErrorCode fim_db_file_pattern_search(const char* pattern, callback_context_t callback)
+FIMDBErrorCode fim_db_file_prefix_search(const char* prefix, callback_context_t callback)
 {
     auto retVal { FIMDB_ERR };
 
-    if (!pattern || !callback.callback)
+    if (!prefix || !*prefix || !callback.callback)
     {
         FIMDB::instance().logFunction(LOG_ERROR, "Invalid parameters");
     }
@@ -644,7 +906,7 @@ FIMDBErrorCode fim_db_file_pattern_search(const char* pattern, callback_context_
     {
         try
         {
-            DB::instance().searchFile(std::make_tuple(SEARCH_TYPE_PATH, pattern, "", ""),
+            DB::instance().searchFile(std::make_tuple(SEARCH_TYPE_PREFIX, prefix, "", ""),
                                       [callback] (const std::string & path)
             {
                 char* entry = const_cast<char*>(path.c_str());
@@ -0,0 +1,192 @@
+/*
+ * Wazuh Syscheck
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _FILE_INODE_INDEX_HPP
+#define _FILE_INODE_INDEX_HPP
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief In-memory copy of the (inode, dev) to path relation of the file_entry table.
+ * @details It is disabled until enable() is called, and while disabled every operation is a no-op.
+ * The database remains the source of truth, the index only mirrors the writes done through FIMDB.
+ */
+class FileInodeIndex final
+{
+    public:
+        using Key = std::pair<unsigned long long, unsigned long>;
+
+        FileInodeIndex()
+            : m_enabled{ false }
+        {}
+        FileInodeIndex& operator=(const FileInodeIndex&) = delete;
+        FileInodeIndex(const FileInodeIndex& other) = delete;
+        ~FileInodeIndex() = default;
+
+        bool enabled() const
+        {
+            return m_enabled;
+        }
+
+        void enable()
+        {
+            m_enabled = true;
+        }
+
+        void disable()
+        {
+            std::lock_guard<std::shared_timed_mutex> lock{ m_mutex };
+            m_enabled = false;
+            m_paths.clear();
+            m_keys.clear();
+        }
+
+        void insert(const std::string& path, const unsigned long long inode, const unsigned long dev)
+        {
+            if (m_enabled)
+            {
+                std::lock_guard<std::shared_timed_mutex> lock{ m_mutex };
+                const Key key { inode, dev };
+                const auto result { m_keys.emplace(path, key) };
+
+                if (!result.second)
+                {
+                    if (result.first->second == key)
+                    {
+                        return;
+                    }
+
+                    erasePath(result.first->second, path);
+                    result.first->second = key;
+                }
+
+                m_paths[key].insert(path);
+            }
+        }
+
+        void remove(const std::string& path)
+        {
+            if (m_enabled)
+            {
+                std::lock_guard<std::shared_timed_mutex> lock{ m_mutex };
+                const auto it { m_keys.find(path) };
+
+                if (m_keys.end() != it)
+                {
+                    erasePath(it->second, path);
+                    m_keys.erase(it);
+                }
+            }
+        }
+
+        /**
+         * @brief Calls callback with every path of the inode, in the path order of the database queries.
+         * @details The paths are copied first, so the callback can update the index.
+         */
+        void search(const unsigned long long inode,
+                    const unsigned long dev,
+                    const std::function<void(const std::string&)>& callback) const
+        {
+            std::set<std::string> paths;
+            {
+                std::shared_lock<std::shared_timed_mutex> lock{ m_mutex };
+                const auto it { m_paths.find(Key { inode, dev }) };
+
+                if (m_paths.end() != it)
+                {
+                    paths = it->second;
+                }
+            }
+
+            for (const auto& path : paths)
+            {
+                callback(path);
+            }
+        }
+
+        size_t inodes() const
+        {
+            std::shared_lock<std::shared_timed_mutex> lock{ m_mutex };
+            return m_paths.size();
+        }
+
+        size_t paths() const
+        {
+            std::shared_lock<std::shared_timed_mutex> lock{ m_mutex };
+            return m_keys.size();
+        }
+
+        /**
+         * @brief Estimated number of bytes used by the index, counting the nodes and path buffers of both maps.
+         */
+        size_t memoryUsage() const
+        {
+            // Red-black tree nodes hold three pointers and the color, hash nodes the next pointer and the hash.
+            constexpr auto TREE_NODE_OVERHEAD { 4 * sizeof(void*) };
+            constexpr auto HASH_NODE_OVERHEAD { 2 * sizeof(void*) };
+            std::shared_lock<std::shared_timed_mutex> lock{ m_mutex };
+            auto ret { m_keys.bucket_count() * sizeof(void*) };
+
+            for (const auto& entry : m_keys)
+            {
+                ret += HASH_NODE_OVERHEAD + sizeof(entry) + pathBuffer(entry.first);
+            }
+
+            for (const auto& entry : m_paths)
+            {
+                ret += TREE_NODE_OVERHEAD + sizeof(entry);
+                ret += entry.second.size() * TREE_NODE_OVERHEAD;
+
+                for (const auto& path : entry.second)
+                {
+                    ret += sizeof(path) + pathBuffer(path);
+                }
+            }
+
+            return ret;
+        }
+
+    private:
+        static size_t pathBuffer(const std::string& path)
+        {
+            // Short paths are stored inside the string object.
+            return path.capacity() > std::string().capacity() ? path.capacity() + 1 : 0;
+        }
+
+        void erasePath(const Key& key, const std::string& path)
+        {
+            const auto it { m_paths.find(key) };
+
+            if (m_paths.end() != it)
+            {
+                it->second.erase(path);
+
+                if (it->second.empty())
+                {
+                    m_paths.erase(it);
+                }
+            }
+        }
+
+        std::atomic_bool m_enabled;
+        mutable std::shared_timed_mutex m_mutex;
+        std::map<Key, std::set<std::string>> m_paths;
+        std::unordered_map<std::string, Key> m_keys;
+};
+
+#endif // _FILE_INODE_INDEX_HPP
@@ -12,6 +12,7 @@
 #include "fimDB.hpp"
 #include "fimDBSpecialization.h"
 #include "promiseFactory.h"
+#include <algorithm>
 #include <future>
 
 
@@ -51,11 +52,40 @@ void FIMDB::syncAlgorithm()
 
     if ((uint32_t)(getCurrentTime() - m_timeLastSyncMsg) > m_syncResponseTimeout)
     {
-        if (m_syncSuccessful && m_currentSyncInterval > m_syncInterval)
+        const auto previousInterval { m_currentSyncInterval };
+
+        if (m_syncSuccessful)
+        {
+            // The checksums matched, the interval is doubled for every consecutive match.
+            if (m_consecutiveMatches < 32 && (static_cast<uint64_t>(m_syncInterval) << m_consecutiveMatches) < m_syncMaxInterval)
+            {
+                ++m_consecutiveMatches;
+            }
+
+            m_currentSyncInterval = static_cast<uint32_t>(std::min(static_cast<uint64_t>(m_syncInterval) << m_consecutiveMatches,
+                                                                   static_cast<uint64_t>(m_syncMaxInterval)));
+        }
+        else
+        {
+            // The manager asked for data, the next check comes sooner.
+            m_consecutiveMatches = 0;
+            m_currentSyncInterval = std::max(std::min(m_currentSyncInterval, m_syncInterval) / 2,
+                                             std::min(m_syncInterval, 2 * m_syncResponseTimeout));
+        }
+
+        const auto hint { m_syncIntervalHint.exchange(0) };
+
+        if (hint > m_currentSyncInterval)
         {
-            m_currentSyncInterval = m_syncInterval;
+            m_currentSyncInterval = std::min(hint, m_syncMaxInterval);
 
-            snprintf(debugmsg, 1024, "Previous sync was successful. Sync interval is reset to: '%ds'", m_currentSyncInterval);
+            snprintf(debugmsg, 1024, "Sync interval set to '%ds' as suggested by the manager", m_currentSyncInterval);
+            m_loggingFunction(LOG_DEBUG_VERBOSE, debugmsg);
+        }
+        else if (m_currentSyncInterval != previousInterval)
+        {
+            snprintf(debugmsg, 1024, "Previous sync %s. Sync interval is set to: '%ds'",
+                     m_syncSuccessful ? "was successful" : "found differences", m_currentSyncInterval);
             m_loggingFunction(LOG_DEBUG_VERBOSE, debugmsg);
         }
 
@@ -108,6 +138,8 @@ void FIMDB::init(unsigned int syncInterval,
     m_syncResponseTimeout = syncResponseTimeout;
     m_syncMaxInterval = syncMaxInterval;
     m_currentSyncInterval = m_syncInterval;
+    m_consecutiveMatches = 0;
+    m_syncIntervalHint = 0;
     m_syncSuccessful = true;
 }
 
@@ -183,6 +215,19 @@ void FIMDB::pushMessage(const std::string& data)
         setTimeLastSyncMsg();
         m_syncSuccessful = false;
 
+        // The manager may suggest the next sync interval to spread the checks of its agents.
+        const auto jsonStart { rawData.find('{') };
+
+        if (std::string::npos != jsonStart)
+        {
+            const auto jsonData { nlohmann::json::parse(rawData.substr(jsonStart), nullptr, false) };
+
+            if (jsonData.is_object() && jsonData.contains("interval") && jsonData.at("interval").is_number_unsigned())
+            {
+                m_syncIntervalHint = jsonData.at("interval").get<uint32_t>();
+            }
+        }
+
         try
         {
             m_rsyncHandler->pushMessage(std::vector<uint8_t> {buff, buff + rawData.size()});
@@ -206,6 +251,7 @@ void FIMDB::teardown()
         std::lock_guard<std::shared_timed_mutex> lock(m_handlersMutex);
         m_rsyncHandler = nullptr;
         m_dbsyncHandler = nullptr;
+        m_inodeIndex.disable();
     }
     // LCOV_EXCL_START
     catch (const std::exception& ex)
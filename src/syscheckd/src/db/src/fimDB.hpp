@@ -13,7 +13,9 @@
 #define _FIMDB_HPP
 #include "dbsync.hpp"
 #include "rsync.hpp"
+#include "fileInodeIndex.hpp"
 #include "stringHelper.h"
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <thread>
@@ -218,6 +220,16 @@ class FIMDB
          *
          * @return std::shared_ptr<DBSync> this a shared_ptr for DBSync.
          */
+        /**
+        * @brief Index of the file paths by inode, it is disabled unless fim_db_file_inode_index_init is called.
+        *
+        * @return Inode index of the file_entry table.
+        */
+        FileInodeIndex& inodeIndex()
+        {
+            return m_inodeIndex;
+        }
+
         std::shared_ptr<DBSync> DBSyncHandler()
         {
             if (!m_dbsyncHandler)
@@ -258,6 +270,9 @@ class FIMDB
 
         /**
         * @brief Execute the sync algorithm to avoid overlaping differents syncs.
+        *
+        * The interval is halved after a sync that found differences, doubled up to the maximum
+        * interval after every sync whose checksums matched, and raised to the one suggested by the manager.
         */
         void syncAlgorithm();
 
@@ -286,8 +301,11 @@ class FIMDB
         uint32_t                                                                m_syncResponseTimeout;
         uint32_t                                                                m_syncMaxInterval;
         uint32_t                                                                m_currentSyncInterval;
+        uint32_t                                                                m_consecutiveMatches;
+        std::atomic<uint32_t>                                                   m_syncIntervalHint;
         bool                                                                    m_syncSuccessful;
         std::time_t                                                             m_timeLastSyncMsg;
+        FileInodeIndex                                                          m_inodeIndex;
 
         /**
         * @brief Function that executes the synchronization of the databases with the manager
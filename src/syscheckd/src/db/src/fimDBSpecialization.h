@@ -25,6 +25,7 @@ static auto fileSyncConfig
     .index("path")
     .checksumField("checksum")
     .lastEvent("last_event")
+    .singlePassSplit(true)
     .noData(QueryParameter::builder().rowFilter("WHERE path BETWEEN '?' and '?' ORDER BY path")
             .columnList({"*"})
             .distinctOpt(false)
@@ -52,6 +53,7 @@ static auto registryKeySyncConfig
     .index("hash_full_path")
     .checksumField("checksum")
     .lastEvent("last_event")
+    .singlePassSplit(true)
     .noData(QueryParameter::builder().rowFilter("WHERE hash_full_path BETWEEN '?' and '?' ORDER BY hash_full_path")
             .columnList({"*"})
             .distinctOpt(false)
@@ -79,6 +81,7 @@ static auto registryValueSyncConfig
     .index("hash_full_path")
     .checksumField("checksum")
     .lastEvent("last_event")
+    .singlePassSplit(true)
     .noData(QueryParameter::builder().rowFilter("WHERE hash_full_path BETWEEN '?' and '?' ORDER BY hash_full_path")
             .columnList({"*"})
             .distinctOpt(false)
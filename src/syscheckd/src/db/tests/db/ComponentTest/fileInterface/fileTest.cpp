@@ -84,6 +84,12 @@ static void callbackTestSearchPath(void* return_data, void* user_data)
     ASSERT_EQ(std::strcmp(returnPath, path), 0);
 }
 
+static void callbackTestCountPaths(void* return_data, void* user_data)
+{
+    ASSERT_TRUE(return_data);
+    ++*reinterpret_cast<int*>(user_data);
+}
+
 static void callBackTestFIMEntry(void* return_data, void* user_data)
 {
     fim_entry *entry = (fim_entry *) user_data;
@@ -331,6 +337,62 @@ TEST_F(DBTestFixture, TestFimDBFilePatternSearchNullParameters)
     });
 }
 
+TEST_F(DBTestFixture, TestFimDBFilePrefixSearch)
+{
+    const auto fileFIMTest1 { std::make_unique<FileItem>(insertStatement1["data"].front()) };
+    const auto fileFIMTest2 { std::make_unique<FileItem>(insertStatement2["data"].front()) };
+    const auto fileFIMTest3 { std::make_unique<FileItem>(insertStatement3["data"].front()) };
+
+    EXPECT_NO_THROW(
+    {
+        auto result = fim_db_file_update(fileFIMTest1->toFimEntry(), callback_data_added);
+        ASSERT_EQ(result, FIMDB_OK);
+        result = fim_db_file_update(fileFIMTest2->toFimEntry(), callback_data_added);
+        ASSERT_EQ(result, FIMDB_OK);
+        result = fim_db_file_update(fileFIMTest3->toFimEntry(), callback_data_added);
+        ASSERT_EQ(result, FIMDB_OK);
+
+        int paths { 0 };
+        callback_context_t callback_data;
+        callback_data.callback = callbackTestCountPaths;
+        callback_data.context = &paths;
+        result = fim_db_file_prefix_search("/tmp/", callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(paths, 2);
+
+        // The prefix is literal, not a LIKE pattern.
+        paths = 0;
+        result = fim_db_file_prefix_search("/tmp/test_", callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(paths, 0);
+        result = fim_db_file_prefix_search("/it's/", callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(paths, 0);
+
+        char *test;
+        test = strdup("/etc/wgetrc");
+        callback_data.callback = callbackTestSearchPath;
+        callback_data.context = test;
+        result = fim_db_file_prefix_search("/etc/", callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        os_free(test);
+    });
+}
+
+TEST_F(DBTestFixture, TestFimDBFilePrefixSearchNullParameters)
+{
+    callback_context_t callback_data{};
+    callback_data.callback = callbackTestSearch;
+    EXPECT_CALL(*mockLog, loggingFunction(LOG_ERROR, "Invalid parameters")).Times(testing::AtLeast(3));
+    EXPECT_NO_THROW(
+    {
+               ASSERT_EQ(fim_db_file_prefix_search(nullptr, callback_data), FIMDB_ERR);
+               ASSERT_EQ(fim_db_file_prefix_search("", callback_data), FIMDB_ERR);
+               callback_data.callback = nullptr;
+               ASSERT_EQ(fim_db_file_prefix_search("/tmp/", callback_data), FIMDB_ERR);
+    });
+}
+
 TEST_F(DBTestFixture, TestFimDBFileINodeSearchNullParameter)
 {
     callback_context_t callback_data{};
@@ -422,3 +484,91 @@ TEST_F(DBTestFixture, TestFimDBFileInodeSearchWithBigInode)
         ASSERT_EQ(result, FIMDB_OK);
     });
 }
+
+TEST_F(DBTestFixture, TestFimDBFileInodeIndex)
+{
+    const auto fileFIMTest1 { std::make_unique<FileItem>(insertStatement1["data"].front()) };
+    const auto fileFIMTest2 { std::make_unique<FileItem>(insertStatement2["data"].front()) };
+    const auto fileFIMTest3 { std::make_unique<FileItem>(insertStatement4["data"].front()) };
+    const auto fileFIMTest4 { std::make_unique<FileItem>(updateStatement1["data"].front()) };
+
+    EXPECT_NO_THROW(
+    {
+        auto result = fim_db_file_update(fileFIMTest1->toFimEntry(), callback_data_added);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(fim_db_file_inode_index_memory(), 0u);
+        result = fim_db_file_inode_index_init();
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_GT(fim_db_file_inode_index_memory(), 0u);
+        ASSERT_EQ(fim_db_get_count_file_inode(), 1);
+        result = fim_db_file_update(fileFIMTest2->toFimEntry(), callback_data_added);
+        ASSERT_EQ(result, FIMDB_OK);
+        result = fim_db_file_update(fileFIMTest3->toFimEntry(), callback_data_added);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(fim_db_get_count_file_inode(), 3);
+
+        int paths { 0 };
+        callback_context_t callback_data;
+        callback_data.callback = callbackTestCountPaths;
+        callback_data.context = &paths;
+        result = fim_db_file_inode_search(18277083, 2456, callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(paths, 1);
+        paths = 0;
+        result = fim_db_file_inode_search(1152921500312810880, 8432, callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(paths, 1);
+
+        // The inode of the file changes, it is only found under the new one.
+        result = fim_db_file_update(fileFIMTest4->toFimEntry(), callback_data_modified);
+        ASSERT_EQ(result, FIMDB_OK);
+        paths = 0;
+        result = fim_db_file_inode_search(18277083, 2456, callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(paths, 0);
+        result = fim_db_file_inode_search(18457083, 2151, callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(paths, 1);
+
+        result = fim_db_remove_path("/etc/wgetrc");
+        ASSERT_EQ(result, FIMDB_OK);
+        paths = 0;
+        result = fim_db_file_inode_search(18457083, 2151, callback_data);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(paths, 0);
+        ASSERT_EQ(fim_db_get_count_file_inode(), 2);
+    });
+}
+
+TEST_F(DBTestFixture, TestFimDBSnapshot)
+{
+    constexpr auto SNAPSHOT_PATH { "fim.db.snapshot" };
+    const auto fileFIMTest1 { std::make_unique<FileItem>(insertStatement1["data"].front()) };
+    const auto fileFIMTest2 { std::make_unique<FileItem>(insertStatement2["data"].front()) };
+    std::remove(SNAPSHOT_PATH);
+
+    EXPECT_NO_THROW(
+    {
+        ASSERT_EQ(fim_db_snapshot_save(nullptr), FIMDB_ERR);
+        ASSERT_EQ(fim_db_snapshot_restore(nullptr), FIMDB_ERR);
+        ASSERT_EQ(fim_db_snapshot_restore(SNAPSHOT_PATH), FIMDB_ERR);
+
+        auto result = fim_db_file_update(fileFIMTest1->toFimEntry(), callback_data_added);
+        ASSERT_EQ(result, FIMDB_OK);
+        result = fim_db_file_update(fileFIMTest2->toFimEntry(), callback_data_added);
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(fim_db_snapshot_save(SNAPSHOT_PATH), FIMDB_OK);
+
+        result = fim_db_remove_path("/etc/wgetrc");
+        ASSERT_EQ(result, FIMDB_OK);
+        result = fim_db_remove_path("/tmp/test.txt");
+        ASSERT_EQ(result, FIMDB_OK);
+        ASSERT_EQ(fim_db_get_count_file_entry(), 0);
+
+        ASSERT_EQ(fim_db_snapshot_restore(SNAPSHOT_PATH), FIMDB_OK);
+        ASSERT_EQ(fim_db_get_count_file_entry(), 2);
+        ASSERT_EQ(fim_db_get_count_file_inode(), 2);
+    });
+
+    std::remove(SNAPSHOT_PATH);
+}
@@ -287,7 +287,7 @@ TEST_F(FimDBFixture, syncAlgorithmLoop)
     fimDBMock.syncAlgorithm();
 
     EXPECT_CALL(fimDBMock, getCurrentTime()).WillOnce(testing::Return(15)).WillOnce(testing::Return(60));
-    EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG_VERBOSE, "Previous sync was successful. Sync interval is reset to: '900s'"));
+    EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG_VERBOSE, "Previous sync was successful. Sync interval is set to: '1800s'"));
 
     EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG, "Executing FIM sync."));
     EXPECT_CALL(*mockRSync, startSync(testing::_, testing::_, testing::_)).Times(testing::AtLeast(1));
@@ -297,6 +297,39 @@ TEST_F(FimDBFixture, syncAlgorithmLoop)
     fimDBMock.syncAlgorithm();
 }
 
+TEST_F(FimDBFixture, syncAlgorithmAdaptiveInterval)
+{
+    const std::string checksumFail(R"(fim_file checksum_fail {"begin":"/a","end":"/z","id":1})");
+    const std::string checksumFailHint(R"(fim_file checksum_fail {"begin":"/a","end":"/z","id":2,"interval":1200})");
+
+    EXPECT_CALL(*mockRSync, pushMessage(testing::_)).Times(2);
+    EXPECT_CALL(*mockRSync, startSync(testing::_, testing::_, testing::_)).Times(4);
+    EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG, "Executing FIM sync.")).Times(4);
+    EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG, "Finished FIM sync.")).Times(4);
+
+    // The checksums differ: the interval is halved
+    EXPECT_CALL(fimDBMock, getCurrentTime()).WillOnce(testing::Return(100)).WillOnce(testing::Return(200));
+    EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG_VERBOSE, "Previous sync found differences. Sync interval is set to: '450s'"));
+
+    fimDBMock.pushMessage(checksumFail);
+    fimDBMock.syncAlgorithm();
+
+    // The manager suggests a longer one
+    EXPECT_CALL(fimDBMock, getCurrentTime()).WillOnce(testing::Return(300)).WillOnce(testing::Return(400));
+    EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG_VERBOSE, "Sync interval set to '1200s' as suggested by the manager"));
+
+    fimDBMock.pushMessage(checksumFailHint);
+    fimDBMock.syncAlgorithm();
+
+    // Consecutive matches back off up to the maximum interval
+    EXPECT_CALL(fimDBMock, getCurrentTime()).WillOnce(testing::Return(2000)).WillOnce(testing::Return(4000));
+    EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG_VERBOSE, "Previous sync was successful. Sync interval is set to: '1800s'"));
+    EXPECT_CALL(*mockLog, loggingFunction(LOG_DEBUG_VERBOSE, "Previous sync was successful. Sync interval is set to: '2000s'"));
+
+    fimDBMock.syncAlgorithm();
+    fimDBMock.syncAlgorithm();
+}
+
 TEST_F(FimDBFixture, executeQuerySuccess)
 {
     nlohmann::json itemJson;
@@ -0,0 +1,903 @@
+/*
+ * Wazuh Syscheck - Test tool
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <system_error>
+#include <json.hpp>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "dbsync.hpp"
+#include "db.h"
+#include "fimDB.hpp"
+#include "fimDbDump.h"
+#include "benchmarkArgsHelper.h"
+
+constexpr auto MAX_QUERIES
+{
+    10000ull
+};
+
+constexpr auto RANGE_CHECKSUM_ITERATIONS
+{
+    5ull
+};
+
+constexpr auto RANGE_CHECKSUM_TIMEOUT
+{
+    std::chrono::minutes{ 5 }
+};
+
+constexpr auto SYNC_THREAD_POOL
+{
+    1
+};
+
+constexpr auto SYNC_QUEUE_SIZE
+{
+    16384
+};
+
+/* Attributes of a file of the FIM integration test of dbsync */
+struct FileTemplate final
+{
+    std::string path;
+    std::string perm;
+    std::string attributes;
+    std::string uid;
+    std::string gid;
+    std::string userName;
+    std::string groupName;
+    std::string md5;
+    std::string sha1;
+    std::string sha256;
+    std::string checksum;
+    unsigned int size;
+    time_t mtime;
+    time_t lastEvent;
+    unsigned long long inode;
+    unsigned long dev;
+    int options;
+};
+
+struct OperationResult final
+{
+    std::string storage;
+    size_t rows;
+    std::string operation;
+    size_t samples;
+    double throughput;
+    double p50;
+    double p99;
+    long peakRss;
+};
+
+/* Messages of the synchronization, they are sent by the rsync threads */
+struct SyncState final
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    int32_t id { 0 };
+    std::string begin;
+    std::string end;
+    size_t splits { 0 };
+};
+
+static SyncState s_sync;
+
+static void syncCallback(const char* /*tag*/, const char* msg)
+{
+    const auto json { nlohmann::json::parse(msg, nullptr, false) };
+
+    if (json.is_discarded() || !json.contains("type"))
+    {
+        return;
+    }
+
+    const auto& type { json.at("type").get_ref<const std::string&>() };
+    std::lock_guard<std::mutex> lock{ s_sync.mutex };
+
+    if ("integrity_check_global" == type)
+    {
+        const auto& data { json.at("data") };
+        s_sync.id = data.at("id").get<int32_t>();
+        s_sync.begin = data.at("begin").get<std::string>();
+        s_sync.end = data.at("end").get<std::string>();
+    }
+    else if ("integrity_check_left" == type || "integrity_check_right" == type)
+    {
+        ++s_sync.splits;
+        s_sync.cv.notify_all();
+    }
+}
+
+static void loggingCallback(const modules_log_level_t level, const char* log)
+{
+    if (LOG_ERROR == level || LOG_ERROR_EXIT == level || LOG_WARNING == level)
+    {
+        std::cerr << log << std::endl;
+    }
+}
+
+static void moduleLogCallback(const char* log)
+{
+    std::cerr << log << std::endl;
+}
+
+static long peakRss()
+{
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+static std::string text(const nlohmann::json& row, const std::string& key)
+{
+    const auto it { row.find(key) };
+
+    if (row.end() == it || it->is_null())
+    {
+        return "";
+    }
+
+    return it->is_string() ? it->get<std::string>() : it->dump();
+}
+
+static unsigned long long number(const nlohmann::json& row, const std::string& key)
+{
+    const auto it { row.find(key) };
+    return row.end() != it && it->is_number() ? it->get<unsigned long long>() : 0;
+}
+
+static std::vector<nlohmann::json> selectAll(DBSync& dbSync, const std::string& table)
+{
+    std::vector<nlohmann::json> rows;
+    ResultCallbackData callbackData
+    {
+        [&rows](ReturnTypeCallback type, const nlohmann::json & row)
+        {
+            if (SELECTED == type)
+            {
+                rows.push_back(row);
+            }
+        }
+    };
+    auto selectQuery
+    {
+        SelectQuery::builder()
+        .table(table)
+        .columnList({"*"})
+        .rowFilter("")
+        .orderByOpt("rowid")
+        .distinctOpt(false)
+        .build()
+    };
+
+    dbSync.selectRows(selectQuery.query(), callbackData);
+    return rows;
+}
+
+/* Each path of the dump is paired with the attributes stored at the same position */
+static std::vector<FileTemplate> loadTemplates()
+{
+    DBSync dump { HostType::AGENT, DbEngineType::SQLITE3, ":memory:", FIM_SQL_DB_DUMP };
+    const auto paths { selectAll(dump, "entry_path") };
+    const auto data { selectAll(dump, "entry_data") };
+    std::vector<FileTemplate> templates;
+
+    for (size_t i = 0; i < std::min(paths.size(), data.size()); ++i)
+    {
+        templates.push_back(
+        {
+            text(paths[i], "path"), text(data[i], "perm"), text(data[i], "attributes"), text(data[i], "uid"),
+            text(data[i], "gid"), text(data[i], "user_name"), text(data[i], "group_name"), text(data[i], "hash_md5"),
+            text(data[i], "hash_sha1"), text(data[i], "hash_sha256"), text(paths[i], "checksum"),
+            static_cast<unsigned int>(number(data[i], "size")), static_cast<time_t>(number(data[i], "mtime")),
+            static_cast<time_t>(number(paths[i], "last_event")), number(data[i], "inode"),
+            static_cast<unsigned long>(number(data[i], "dev")), static_cast<int>(number(paths[i], "options"))
+        });
+    }
+
+    if (templates.empty())
+    {
+        throw std::runtime_error { "The FIM dump has no files." };
+    }
+
+    return templates;
+}
+
+/* A file of the benchmark: a copy of a template under its own folder, changed by every revision */
+class FileEntry final
+{
+    public:
+        FileEntry(const FileTemplate& tpl, const size_t copy, const size_t revision)
+            : m_path{ path(tpl, copy) }
+        {
+            m_data.size = tpl.size + revision;
+            m_data.perm = const_cast<char*>(tpl.perm.c_str());
+            m_data.attributes = const_cast<char*>(tpl.attributes.c_str());
+            m_data.uid = const_cast<char*>(tpl.uid.c_str());
+            m_data.gid = const_cast<char*>(tpl.gid.c_str());
+            m_data.user_name = const_cast<char*>(tpl.userName.c_str());
+            m_data.group_name = const_cast<char*>(tpl.groupName.c_str());
+            m_data.mtime = tpl.mtime + revision;
+            m_data.inode = inode(tpl, copy);
+            copyHash(m_data.hash_md5, sizeof(m_data.hash_md5), tpl.md5, revision);
+            copyHash(m_data.hash_sha1, sizeof(m_data.hash_sha1), tpl.sha1, revision);
+            copyHash(m_data.hash_sha256, sizeof(m_data.hash_sha256), tpl.sha256, revision);
+            m_data.mode = FIM_SCHEDULED;
+            m_data.last_event = tpl.lastEvent + revision;
+            m_data.dev = tpl.dev;
+            m_data.scanned = 1;
+            m_data.options = tpl.options;
+            copyHash(m_data.checksum, sizeof(m_data.checksum), tpl.checksum, revision);
+
+            m_entry.type = FIM_TYPE_FILE;
+            m_entry.file_entry.path = &m_path[0];
+            m_entry.file_entry.data = &m_data;
+        }
+
+        FileEntry(const FileEntry&) = delete;
+        FileEntry& operator=(const FileEntry&) = delete;
+
+        fim_entry* get()
+        {
+            return &m_entry;
+        }
+
+        static std::string path(const FileTemplate& tpl, const size_t copy)
+        {
+            return copy ? "/fimdb_benchmark/" + std::to_string(copy) + tpl.path : tpl.path;
+        }
+
+        static unsigned long long inode(const FileTemplate& tpl, const size_t copy)
+        {
+            return tpl.inode + (static_cast<unsigned long long>(copy) << 32);
+        }
+
+    private:
+        // The revision is written over the first characters so that every revision has its own hashes.
+        static void copyHash(char* hash, const size_t size, const std::string& value, const size_t revision)
+        {
+            snprintf(hash, size, "%s", value.c_str());
+
+            if (revision && strlen(hash) >= 8)
+            {
+                char prefix[9];
+                snprintf(prefix, sizeof(prefix), "%08zx", revision);
+                memcpy(hash, prefix, 8);
+            }
+        }
+
+        std::string m_path;
+        fim_file_data m_data {};
+        fim_entry m_entry {};
+};
+
+class BenchmarkRunner final
+{
+    public:
+        BenchmarkRunner(const std::string& storage,
+                        const std::vector<FileTemplate>& templates,
+                        const size_t rows)
+            : m_storage{ storage }
+            , m_templates{ templates }
+            , m_rows{ rows }
+            , m_revisions(rows, 0)
+        {
+            m_config.options = templates.front().options;
+            m_event.report_event = true;
+            m_event.mode = FIM_SCHEDULED;
+            m_eventContext.event = &m_event;
+            m_eventContext.config = &m_config;
+        }
+
+        OperationResult fileUpdate()
+        {
+            std::vector<double> latencies;
+            latencies.reserve(m_rows);
+            size_t events { 0 };
+            const callback_context_t callback { countCallback, &events };
+
+            for (size_t id = 0; id < m_rows; ++id)
+            {
+                FileEntry entry { tpl(id), copy(id), m_revisions[id] };
+                latencies.push_back(measure([&]()
+                {
+                    fim_db_file_update(entry.get(), { callback.callback, &m_eventContext });
+                }));
+            }
+
+            return result("fileUpdate", latencies, m_rows, total(latencies));
+        }
+
+        void populate()
+        {
+            m_event.report_event = false;
+
+            for (size_t id = 0; id < m_rows; ++id)
+            {
+                FileEntry entry { tpl(id), copy(id), m_revisions[id] };
+                fim_db_file_update(entry.get(), { countCallback, &m_eventContext });
+            }
+
+            m_event.report_event = true;
+        }
+
+        OperationResult getPath()
+        {
+            std::vector<double> latencies;
+            size_t found { 0 };
+
+            for (const auto id : randomIds())
+            {
+                const auto filePath { FileEntry::path(tpl(id), copy(id)) };
+                latencies.push_back(measure([&]()
+                {
+                    fim_db_get_path(filePath.c_str(), { countCallback, &found });
+                }));
+            }
+
+            checkFound("getPath", found, latencies.size());
+            return result("getPath", latencies, latencies.size(), total(latencies));
+        }
+
+        OperationResult inodeSearch(const std::string& operation)
+        {
+            std::vector<double> latencies;
+            size_t found { 0 };
+
+            for (const auto id : randomIds())
+            {
+                const auto inode { FileEntry::inode(tpl(id), copy(id)) };
+                const auto dev { tpl(id).dev };
+                latencies.push_back(measure([&]()
+                {
+                    fim_db_file_inode_search(inode, dev, { countCallback, &found });
+                }));
+            }
+
+            // Several files of the dump may share their inode.
+            if (found < latencies.size())
+            {
+                std::cerr << operation << ": " << found << " files found for " << latencies.size() << " inodes." << std::endl;
+            }
+
+            return result(operation, latencies, latencies.size(), total(latencies));
+        }
+
+        OperationResult txnSync()
+        {
+            std::vector<double> latencies;
+            latencies.reserve(m_rows);
+            TxnCounters counters;
+            const auto start { std::chrono::steady_clock::now() };
+            const auto txnHandle { fim_db_transaction_start(FIMDB_FILE_TXN_TABLE, txnCallback, &counters) };
+
+            if (!txnHandle)
+            {
+                throw std::runtime_error { "The transaction can't be started." };
+            }
+
+            // Every 10th file changes and every 100th file is gone, the others are only marked as seen.
+            for (size_t id = 0; id < m_rows; ++id)
+            {
+                if (deleted(id))
+                {
+                    continue;
+                }
+
+                if (0 == id % 10)
+                {
+                    ++m_revisions[id];
+                }
+
+                FileEntry entry { tpl(id), copy(id), m_revisions[id] };
+                latencies.push_back(measure([&]()
+                {
+                    fim_db_transaction_sync_row(txnHandle, entry.get());
+                }));
+            }
+
+            fim_db_transaction_deleted_rows(txnHandle, txnCallback, &counters);
+            m_txnDone = true;
+
+            if (counters.deleted != m_rows / 100)
+            {
+                std::cerr << "txnSync: " << counters.deleted << " deleted files detected out of " << m_rows / 100 << "." << std::endl;
+            }
+
+            // The throughput includes the time needed to find the deleted rows and close the transaction.
+            return result("txnSync", latencies, m_rows, elapsed(start));
+        }
+
+        OperationResult integrity()
+        {
+            std::vector<double> latencies;
+
+            latencies.push_back(measure([]()
+            {
+                fim_run_integrity();
+            }));
+            m_integrityDone = true;
+
+            return result("integrity", latencies, m_rows, total(latencies));
+        }
+
+        OperationResult rangeChecksum()
+        {
+            std::vector<double> latencies;
+            std::string message;
+
+            if (!m_integrityDone)
+            {
+                fim_run_integrity();
+                m_integrityDone = true;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock{ s_sync.mutex };
+                message = std::string(FIM_COMPONENT_FILE) + " checksum_fail " + nlohmann::json
+                {
+                    {"begin", s_sync.begin}, {"end", s_sync.end}, {"id", s_sync.id}
+                }.dump();
+            }
+
+            // The manager asks for the whole table, that is split in two halves.
+            for (size_t i = 0; i < RANGE_CHECKSUM_ITERATIONS; ++i)
+            {
+                latencies.push_back(measure([&]()
+                {
+                    std::unique_lock<std::mutex> lock{ s_sync.mutex };
+                    const auto expected { s_sync.splits + 2 };
+
+                    lock.unlock();
+                    fim_sync_push_msg(message.c_str());
+                    lock.lock();
+
+                    const auto sent
+                    {
+                        s_sync.cv.wait_for(lock, RANGE_CHECKSUM_TIMEOUT, [expected]()
+                        {
+                            return s_sync.splits >= expected;
+                        })
+                    };
+
+                    if (!sent)
+                    {
+                        throw std::runtime_error { "rangeChecksum: the range checksums weren't sent." };
+                    }
+                }));
+            }
+
+            return result("rangeChecksum", latencies, m_rows * latencies.size(), total(latencies));
+        }
+
+        nlohmann::json footprint() const
+        {
+            struct stat dbStat {};
+            const auto dbSize { m_storage == "disk" && 0 == stat(FIM_DB_DISK_PATH, &dbStat) ? dbStat.st_size : 0 };
+
+            return
+            {
+                {"storage", m_storage}, {"rows", m_rows}, {"db_size_kb", dbSize / 1024},
+                {"inode_index_kb", fim_db_file_inode_index_memory() / 1024}, {"peak_rss_kb", peakRss()}
+            };
+        }
+
+    private:
+        struct TxnCounters final
+        {
+            size_t changed { 0 };
+            size_t deleted { 0 };
+        };
+
+        static void countCallback(void* /*data*/, void* context)
+        {
+            ++*reinterpret_cast<size_t*>(context);
+        }
+
+        static void txnCallback(ReturnTypeCallback type, const cJSON* /*json*/, void* context)
+        {
+            auto counters { reinterpret_cast<TxnCounters*>(context) };
+
+            if (DELETED == type)
+            {
+                ++counters->deleted;
+            }
+            else
+            {
+                ++counters->changed;
+            }
+        }
+
+        static double measure(const std::function<void()>& operation)
+        {
+            const auto start { std::chrono::steady_clock::now() };
+            operation();
+            return elapsed(start);
+        }
+
+        static double elapsed(const std::chrono::steady_clock::time_point& start)
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        static double total(const std::vector<double>& latencies)
+        {
+            double seconds { 0 };
+
+            for (const auto& latency : latencies)
+            {
+                seconds += latency;
+            }
+
+            return seconds;
+        }
+
+        static double percentile(std::vector<double> latencies, const double value)
+        {
+            if (latencies.empty())
+            {
+                return 0;
+            }
+
+            const auto index { static_cast<size_t>(value * static_cast<double>(latencies.size() - 1)) };
+            std::nth_element(latencies.begin(), latencies.begin() + index, latencies.end());
+            return latencies[index];
+        }
+
+        static void checkFound(const std::string& operation, const size_t found, const size_t queries)
+        {
+            if (found != queries)
+            {
+                std::cerr << operation << ": " << found << " files found out of " << queries << " queries." << std::endl;
+            }
+        }
+
+        const FileTemplate& tpl(const size_t id) const
+        {
+            return m_templates[id % m_templates.size()];
+        }
+
+        size_t copy(const size_t id) const
+        {
+            return id / m_templates.size();
+        }
+
+        bool deleted(const size_t id) const
+        {
+            return 99 == id % 100;
+        }
+
+        std::vector<size_t> randomIds() const
+        {
+            const auto queries { std::min(m_rows, static_cast<size_t>(MAX_QUERIES)) };
+            std::mt19937_64 generator { m_rows };
+            std::uniform_int_distribution<size_t> distribution { 0, m_rows - 1 };
+            std::vector<size_t> ids;
+
+            while (ids.size() < queries)
+            {
+                const auto id { distribution(generator) };
+
+                if (!m_txnDone || !deleted(id))
+                {
+                    ids.push_back(id);
+                }
+            }
+
+            return ids;
+        }
+
+        OperationResult result(const std::string& operation,
+                               const std::vector<double>& latencies,
+                               const size_t processedRows,
+                               const double seconds) const
+        {
+            return
+            {
+                m_storage,
+                m_rows,
+                operation,
+                latencies.size(),
+                seconds > 0 ? static_cast<double>(processedRows) / seconds : 0,
+                percentile(latencies, 0.5) * 1000000,
+                percentile(latencies, 0.99) * 1000000,
+                peakRss()
+            };
+        }
+
+        const std::string m_storage;
+        const std::vector<FileTemplate>& m_templates;
+        const size_t m_rows;
+        std::vector<size_t> m_revisions;
+        directory_t m_config {};
+        event_data_t m_event {};
+        create_json_event_ctx m_eventContext {};
+        bool m_txnDone { false };
+        bool m_integrityDone { false };
+};
+
+static nlohmann::json toJson(const OperationResult& result)
+{
+    return
+    {
+        {"storage", result.storage}, {"rows", result.rows}, {"operation", result.operation},
+        {"samples", result.samples}, {"throughput", result.throughput}, {"p50_us", result.p50},
+        {"p99_us", result.p99}, {"peak_rss_kb", result.peakRss}
+    };
+}
+
+static void printResult(const nlohmann::json& result)
+{
+    std::cout << std::left << std::setw(8) << result.at("storage").get<std::string>()
+              << std::right << std::setw(10) << result.at("rows").get<size_t>()
+              << "  " << std::left << std::setw(20) << result.at("operation").get<std::string>()
+              << std::right << std::setw(10) << result.at("samples").get<size_t>()
+              << std::setw(14) << std::fixed << std::setprecision(0) << result.at("throughput").get<double>()
+              << std::setw(12) << std::setprecision(1) << result.at("p50_us").get<double>()
+              << std::setw(12) << result.at("p99_us").get<double>()
+              << std::setw(14) << result.at("peak_rss_kb").get<long>()
+              << std::endl;
+}
+
+static void createDiskFolder()
+{
+    std::string folder;
+    std::stringstream ss{ FIM_DB_DISK_PATH };
+    std::string item;
+
+    // Every folder of the path but the file name
+    while (getline(ss, item, '/') && !ss.eof())
+    {
+        folder += item + "/";
+
+        if (0 != mkdir(folder.c_str(), 0750) && EEXIST != errno)
+        {
+            throw std::system_error { errno, std::generic_category(), folder };
+        }
+    }
+}
+
+static void removeDiskDatabase()
+{
+    for (const auto& suffix : { "", "-journal", "-wal", "-shm" })
+    {
+        std::remove((std::string(FIM_DB_DISK_PATH) + suffix).c_str());
+    }
+}
+
+/* FIMDB is a singleton that can't be initialized twice, so every run takes its own process */
+static nlohmann::json runInChild(const std::function<nlohmann::json()>& run)
+{
+    int fds[2];
+
+    if (0 != pipe(fds))
+    {
+        throw std::system_error { errno, std::generic_category(), "pipe" };
+    }
+
+    std::cout.flush();
+    const auto pid { fork() };
+
+    if (pid < 0)
+    {
+        throw std::system_error { errno, std::generic_category(), "fork" };
+    }
+
+    if (0 == pid)
+    {
+        std::string output;
+        close(fds[0]);
+
+        try
+        {
+            output = run().dump();
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+        }
+
+        for (size_t written = 0; written < output.size();)
+        {
+            const auto n { write(fds[1], output.data() + written, output.size() - written) };
+
+            if (n <= 0)
+            {
+                break;
+            }
+
+            written += n;
+        }
+
+        close(fds[1]);
+        _exit(0);
+    }
+
+    std::string output;
+    char buffer[4096];
+    ssize_t n;
+
+    close(fds[1]);
+
+    while ((n = read(fds[0], buffer, sizeof(buffer))) > 0)
+    {
+        output.append(buffer, n);
+    }
+
+    close(fds[0]);
+    waitpid(pid, nullptr, 0);
+
+    return output.empty() ? nlohmann::json::object() : nlohmann::json::parse(output);
+}
+
+int main(int argc, const char* argv[])
+{
+    try
+    {
+        BenchmarkArgs args(argc, argv);
+        const auto& operations { args.operations() };
+        const auto hasOperation
+        {
+            [&operations](const std::string& operation)
+            {
+                return operations.end() != std::find(operations.begin(), operations.end(), operation);
+            }
+        };
+        const auto templates { loadTemplates() };
+        auto results = nlohmann::json::array();
+        auto footprints = nlohmann::json::array();
+
+        std::cout << templates.size() << " files of the FIM dump, copied as many times as needed." << std::endl
+                  << std::left << std::setw(8) << "storage"
+                  << std::right << std::setw(10) << "rows"
+                  << "  " << std::left << std::setw(20) << "operation"
+                  << std::right << std::setw(10) << "samples"
+                  << std::setw(14) << "rows/s"
+                  << std::setw(12) << "p50(us)"
+                  << std::setw(12) << "p99(us)"
+                  << std::setw(14) << "peakRSS(KB)"
+                  << std::endl;
+
+        for (const auto& storage : args.storages())
+        {
+            if (storage != "memory" && storage != "disk")
+            {
+                throw std::runtime_error { "Unknown storage: " + storage };
+            }
+
+            for (const auto rows : args.rows())
+            {
+                if (storage == "disk")
+                {
+                    createDiskFolder();
+                    removeDiskDatabase();
+                }
+
+                const auto run
+                {
+                    runInChild([&]()
+                    {
+                        auto runResults = nlohmann::json::array();
+
+                        if (FIMDB_OK != fim_db_init(storage == "memory" ? FIM_DB_MEMORY : FIM_DB_DISK,
+                                                    86400,
+                                                    86400,
+                                                    30,
+                                                    syncCallback,
+                                                    loggingCallback,
+                                                    0,
+                                                    0,
+                                                    false,
+                                                    SYNC_THREAD_POOL,
+                                                    SYNC_QUEUE_SIZE,
+                                                    moduleLogCallback,
+                                                    moduleLogCallback))
+                        {
+                            throw std::runtime_error { "The FIM database can't be initialized." };
+                        }
+
+                        BenchmarkRunner runner { storage, templates, rows };
+
+                        if (hasOperation("fileUpdate"))
+                        {
+                            runResults.push_back(toJson(runner.fileUpdate()));
+                        }
+                        else
+                        {
+                            runner.populate();
+                        }
+
+                        if (hasOperation("getPath"))
+                        {
+                            runResults.push_back(toJson(runner.getPath()));
+                        }
+
+                        if (hasOperation("txnSync"))
+                        {
+                            runResults.push_back(toJson(runner.txnSync()));
+                        }
+
+                        if (hasOperation("integrity"))
+                        {
+                            runResults.push_back(toJson(runner.integrity()));
+                        }
+
+                        if (hasOperation("rangeChecksum"))
+                        {
+                            runResults.push_back(toJson(runner.rangeChecksum()));
+                        }
+
+                        // Once the inode index is enabled it can't be disabled, so it goes last.
+                        if (hasOperation("inodeSearch"))
+                        {
+                            runResults.push_back(toJson(runner.inodeSearch("inodeSearch")));
+                            fim_db_file_inode_index_init();
+                            runResults.push_back(toJson(runner.inodeSearch("inodeSearchIndexed")));
+                        }
+
+                        const auto footprint { runner.footprint() };
+                        fim_db_teardown();
+
+                        return nlohmann::json { {"results", runResults}, {"footprint", footprint} };
+                    })
+                };
+
+                for (const auto& result : run.value("results", nlohmann::json::array()))
+                {
+                    printResult(result);
+                    results.push_back(result);
+                }
+
+                if (run.contains("footprint"))
+                {
+                    const auto& footprint { run.at("footprint") };
+                    std::cout << std::left << std::setw(8) << storage
+                              << std::right << std::setw(10) << rows
+                              << "  database " << footprint.at("db_size_kb").get<long>() << " KB"
+                              << ", inode index " << footprint.at("inode_index_kb").get<long>() << " KB"
+                              << ", peak RSS " << footprint.at("peak_rss_kb").get<long>() << " KB" << std::endl;
+                    footprints.push_back(footprint);
+                }
+
+                if (storage == "disk")
+                {
+                    removeDiskDatabase();
+                }
+            }
+        }
+
+        if (!args.outputFile().empty())
+        {
+            std::ofstream outputFile{ args.outputFile() };
+            outputFile << nlohmann::json { {"results", results}, {"footprints", footprints} }.dump(4) << std::endl;
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        BenchmarkArgs::showHelp();
+    }
+
+    return 0;
+}
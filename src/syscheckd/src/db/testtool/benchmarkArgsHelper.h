@@ -0,0 +1,132 @@
+/*
+ * Wazuh Syscheck - Test tool
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 15, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#ifndef _BENCHMARK_ARGS_HELPER_H_
+#define _BENCHMARK_ARGS_HELPER_H_
+
+#include <stdexcept>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <iostream>
+
+class BenchmarkArgs
+{
+    public:
+        BenchmarkArgs(const int argc, const char* argv[])
+            : m_rows{ splitRows(paramValueOf(argc, argv, "-r", "10000,100000,1000000")) }
+            , m_storages{ splitValues(paramValueOf(argc, argv, "-s", "memory,disk")) }
+            , m_operations{ splitValues(paramValueOf(argc, argv, "-p", "fileUpdate,getPath,inodeSearch,txnSync,integrity,rangeChecksum")) }
+            , m_outputFile{ paramValueOf(argc, argv, "-o", "") }
+        {}
+
+        const std::vector<size_t>& rows() const
+        {
+            return m_rows;
+        }
+
+        const std::vector<std::string>& storages() const
+        {
+            return m_storages;
+        }
+
+        const std::vector<std::string>& operations() const
+        {
+            return m_operations;
+        }
+
+        const std::string& outputFile() const
+        {
+            return m_outputFile;
+        }
+
+        static void showHelp()
+        {
+            std::cout << "\nUsage: fimdb_benchmark <option(s)>\n"
+                      << "Options:\n"
+                      << "\t-h \t\t\tShow this help message\n"
+                      << "\t-r ROWS_LIST\t\tFiles to store (default: 10000,100000,1000000).\n"
+                      << "\t-s STORAGE_LIST\t\tDatabase storage: memory, disk (default: both).\n"
+                      << "\t-p OPERATION_LIST\tOperations to time: fileUpdate, getPath, inodeSearch, txnSync,\n"
+                      << "\t\t\t\tintegrity, rangeChecksum (default: all).\n"
+                      << "\t-o OUTPUT_FILE\t\tJSON file where the results are also written.\n"
+                      << "\nExample:"
+                      << "\n\t./fimdb_benchmark -r 10000,100000 -s disk -o results.json\n"
+                      << std::endl;
+        }
+
+    private:
+
+        static std::string paramValueOf(const int argc,
+                                        const char* argv[],
+                                        const std::string& switchValue,
+                                        const std::string& defaultValue)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                const std::string currentValue{ argv[i] };
+
+                if (currentValue == "-h")
+                {
+                    throw std::runtime_error
+                    {
+                        "Help requested."
+                    };
+                }
+
+                if (currentValue == switchValue && i + 1 < argc)
+                {
+                    // Switch found
+                    return argv[i + 1];
+                }
+            }
+
+            return defaultValue;
+        }
+
+        static std::vector<std::string> splitValues(const std::string& values)
+        {
+            std::vector<std::string> splitValues;
+            std::stringstream ss{ values };
+
+            while (ss.good())
+            {
+                std::string substr;
+                getline(ss, substr, ','); // Getting each string between ',' character
+
+                if (!substr.empty())
+                {
+                    splitValues.push_back(std::move(substr));
+                }
+            }
+
+            return splitValues;
+        }
+
+        static std::vector<size_t> splitRows(const std::string& values)
+        {
+            std::vector<size_t> rows;
+
+            for (const auto& value : splitValues(values))
+            {
+                rows.push_back(std::stoull(value));
+            }
+
+            return rows;
+        }
+
+        const std::vector<size_t> m_rows;
+        const std::vector<std::string> m_storages;
+        const std::vector<std::string> m_operations;
+        const std::string m_outputFile;
+};
+
+#endif // _BENCHMARK_ARGS_HELPER_H_
@@ -411,6 +411,11 @@ char *fim_file_diff(const char *filename, const directory_t *configuration) {
         goto cleanup;
     }
 
+    if (syscheck.diff_chunked) {
+        diff_changes = fim_diff_chunked_file(diff);
+        goto cleanup;
+    }
+
     // If the file is not there, create compressed file and return.
     if (w_uncompress_gzfile(diff->compress_file, diff->uncompress_file) != 0) {
         if (fim_diff_create_compress_file(diff) == 0){
@@ -0,0 +1,704 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#include "shared.h"
+#include "syscheck.h"
+#include "zlib.h"
+
+// Remove static qualifier from tests
+#ifdef WAZUH_UNIT_TESTING
+#define static
+#endif
+
+#ifdef WIN32
+#define FileSize(x) FileSizeWin(x)
+#endif
+
+/* A cut point is looked for after FIM_CHUNK_MIN bytes, one every 8 KiB on average, and the chunk ends with the
+ * line that holds it. Lines longer than FIM_CHUNK_LINE and binary data are cut at the cut point itself. */
+#define FIM_CHUNK_MIN       2048
+#define FIM_CHUNK_MASK      0x1FFFu
+#define FIM_CHUNK_LINE      4096
+#define FIM_CHUNK_MAX       65536
+
+#define FIM_CHUNKS_LIST     "chunks.list"
+#define FIM_CHUNKS_FOLDER   "chunks"
+
+static const char *STR_MORE_CHANGES = "More changes...";
+
+typedef struct fim_chunk {
+    os_sha1 hash;
+    size_t offset;          // Offset in the file it was read from
+    size_t length;
+    unsigned int lines;     // Line feeds in the chunk
+    int line_end;           // The chunk ends with a line feed
+    int written;            // The chunk file was written by this version
+} fim_chunk;
+
+typedef struct fim_chunk_list {
+    fim_chunk *chunks;
+    size_t count;
+    size_t size;
+} fim_chunk_list;
+
+typedef struct fim_chunk_store {
+    char folder[PATH_MAX];
+    float written_size;     // KiB of the chunk files written by this version
+} fim_chunk_store;
+
+/* Prototypes */
+
+/**
+ * @brief Splits a file in content-defined chunks, so an edit only changes the chunks around it
+ *
+ * @param path File to split
+ * @param list List the chunks are appended to
+ * @param store Folder the chunks not stored yet are compressed to, NULL to only list them
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int fim_diff_chunk_file(const char *path, fim_chunk_list *list, fim_chunk_store *store);
+
+/**
+ * @brief Reads the chunks of the stored version
+ *
+ * @return 0 on success, -1 if there is no list or it's corrupted
+ */
+static int fim_diff_read_chunk_list(const char *path, fim_chunk_list *list);
+
+/**
+ * @brief Writes the chunks of the stored version, replacing the previous list
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int fim_diff_write_chunk_list(const char *path, const fim_chunk_list *list);
+
+/**
+ * @brief Writes the bytes of the chunks [first, last) of a version to a file
+ *
+ * @param list Chunks of the version
+ * @param source Uncompressed copy of the version, NULL to read the chunks from the store
+ * @param folder Folder of the stored chunks
+ *
+ * @return 0 on success, -1 on failure
+ */
+static int fim_diff_write_chunks(const fim_chunk_list *list,
+                                 size_t first,
+                                 size_t last,
+                                 const char *source,
+                                 const char *folder,
+                                 const char *destination);
+
+/**
+ * @brief Adds an offset to the line numbers of a normal diff output
+ *
+ * @return New string with the line numbers shifted
+ */
+static char *fim_diff_shift_lines(const char *diff_str, unsigned int offset);
+
+/**
+ * @brief Removes the chunk files written by a version that is discarded
+ */
+static void fim_diff_discard_chunks(const fim_chunk_list *list, const char *folder);
+
+/**
+ * @brief Removes the chunk files of the previous version that the new one doesn't use
+ *
+ * @return KiB released
+ */
+static float fim_diff_release_chunks(const fim_chunk_list *old_list, const fim_chunk_list *new_list, const char *folder);
+
+/* Definitions */
+
+static void fim_chunk_list_free(fim_chunk_list *list) {
+    os_free(list->chunks);
+    list->count = 0;
+    list->size = 0;
+}
+
+static fim_chunk *fim_chunk_list_add(fim_chunk_list *list) {
+    if (list->count == list->size) {
+        list->size = list->size ? list->size * 2 : 64;
+        os_realloc(list->chunks, list->size * sizeof(fim_chunk), list->chunks);
+    }
+
+    fim_chunk *chunk = &list->chunks[list->count++];
+    memset(chunk, 0, sizeof(fim_chunk));
+    return chunk;
+}
+
+static int fim_chunk_compare_hash(const void *a, const void *b) {
+    return strcmp(((const fim_chunk *)a)->hash, ((const fim_chunk *)b)->hash);
+}
+
+static int fim_diff_store_chunk(fim_chunk *chunk, const char *data, fim_chunk_store *store) {
+    char path[PATH_MAX];
+    char tmp_path[PATH_MAX];
+    gzFile gz_fd;
+
+    snprintf(path, PATH_MAX, "%s/%s.gz", store->folder, chunk->hash);
+
+    // Chunks are named after their content, a stored one is shared with the previous version.
+    if (IsFile(path) == 0) {
+        return 0;
+    }
+
+    snprintf(tmp_path, PATH_MAX, "%s.tmp", path);
+
+    if (gz_fd = gzopen(tmp_path, "wb"), !gz_fd) {
+        merror(FOPEN_ERROR, tmp_path, errno, strerror(errno));
+        return -1;
+    }
+
+    if (chunk->length && gzwrite(gz_fd, data, (unsigned)chunk->length) != (int)chunk->length) {
+        gzclose(gz_fd);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    if (gzclose(gz_fd) != Z_OK || rename_ex(tmp_path, path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    chunk->written = 1;
+    store->written_size += FileSize(path) / 1024.0f;
+    return 0;
+}
+
+static int fim_diff_chunk_file(const char *path, fim_chunk_list *list, fim_chunk_store *store) {
+    uint32_t gear[256];
+    char *chunk_data = NULL;
+    char *buffer = NULL;
+    size_t chunk_length = 0;
+    size_t offset = 0;
+    size_t pending = 0;
+    unsigned int lines = 0;
+    uint32_t hash = 0;
+    size_t read;
+    int retval = -1;
+    FILE *fp;
+
+    // Table of the rolling hash, a fixed mix of every byte value.
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t x = (i + 1) * 0x9E3779B1u;
+        x ^= x >> 16;
+        x *= 0x85EBCA6Bu;
+        x ^= x >> 13;
+        x *= 0xC2B2AE35u;
+        gear[i] = x ^ (x >> 16);
+    }
+
+    if (fp = wfopen(path, "rb"), !fp) {
+        merror(FOPEN_ERROR, path, errno, strerror(errno));
+        return -1;
+    }
+
+    os_malloc(FIM_CHUNK_MAX, chunk_data);
+    os_malloc(OS_SIZE_65536, buffer);
+
+    while (read = fread(buffer, 1, OS_SIZE_65536, fp), read > 0) {
+        for (size_t i = 0; i < read; i++) {
+            const unsigned char byte = (unsigned char)buffer[i];
+
+            chunk_data[chunk_length++] = byte;
+            hash = (hash << 1) + gear[byte];
+
+            if (byte == '\n') {
+                lines++;
+            }
+
+            if (pending) {
+                pending++;
+            } else if (chunk_length >= FIM_CHUNK_MIN && (hash & FIM_CHUNK_MASK) == 0) {
+                pending = 1;
+            }
+
+            if ((pending && (byte == '\n' || pending > FIM_CHUNK_LINE)) || chunk_length == FIM_CHUNK_MAX) {
+                fim_chunk *chunk = fim_chunk_list_add(list);
+                OS_SHA1_Str(chunk_data, chunk_length, chunk->hash);
+                chunk->offset = offset;
+                chunk->length = chunk_length;
+                chunk->lines = lines;
+                chunk->line_end = byte == '\n';
+
+                if (store && fim_diff_store_chunk(chunk, chunk_data, store) != 0) {
+                    goto end;
+                }
+
+                offset += chunk_length;
+                chunk_length = 0;
+                pending = 0;
+                lines = 0;
+                hash = 0;
+            }
+        }
+    }
+
+    if (ferror(fp)) {
+        goto end;
+    }
+
+    if (chunk_length) {
+        fim_chunk *chunk = fim_chunk_list_add(list);
+        OS_SHA1_Str(chunk_data, chunk_length, chunk->hash);
+        chunk->offset = offset;
+        chunk->length = chunk_length;
+        chunk->lines = lines;
+        chunk->line_end = chunk_data[chunk_length - 1] == '\n';
+
+        if (store && fim_diff_store_chunk(chunk, chunk_data, store) != 0) {
+            goto end;
+        }
+    }
+
+    retval = 0;
+
+end:
+    fclose(fp);
+    os_free(chunk_data);
+    os_free(buffer);
+    return retval;
+}
+
+static int fim_diff_read_chunk_list(const char *path, fim_chunk_list *list) {
+    char line[OS_SIZE_256];
+    size_t offset = 0;
+    FILE *fp;
+
+    if (fp = wfopen(path, "r"), !fp) {
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        fim_chunk *chunk = fim_chunk_list_add(list);
+
+        if (sscanf(line, "%40s %zu %u %d", chunk->hash, &chunk->length, &chunk->lines, &chunk->line_end) != 4 ||
+            strlen(chunk->hash) != 40) {
+            fclose(fp);
+            fim_chunk_list_free(list);
+            return -1;
+        }
+
+        chunk->offset = offset;
+        offset += chunk->length;
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+static int fim_diff_write_chunk_list(const char *path, const fim_chunk_list *list) {
+    char tmp_path[PATH_MAX];
+    FILE *fp;
+    int retval = 0;
+
+    snprintf(tmp_path, PATH_MAX, "%s.tmp", path);
+
+    if (fp = wfopen(tmp_path, "w"), !fp) {
+        merror(FOPEN_ERROR, tmp_path, errno, strerror(errno));
+        return -1;
+    }
+
+    for (size_t i = 0; i < list->count && retval == 0; i++) {
+        const fim_chunk *chunk = &list->chunks[i];
+
+        if (fprintf(fp, "%s %zu %u %d\n", chunk->hash, chunk->length, chunk->lines, chunk->line_end) < 0) {
+            retval = -1;
+        }
+    }
+
+    if (fclose(fp) != 0 || retval != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    // The list is replaced at once, it never refers to a partial version.
+    if (rename_ex(tmp_path, path) != 0) {
+        merror(RENAME_ERROR, tmp_path, path, errno, strerror(errno));
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int fim_diff_write_chunks(const fim_chunk_list *list,
+                                 size_t first,
+                                 size_t last,
+                                 const char *source,
+                                 const char *folder,
+                                 const char *destination) {
+    char buffer[OS_SIZE_8192];
+    char path[PATH_MAX];
+    FILE *src_fp = NULL;
+    FILE *dst_fp;
+    int retval = 0;
+
+    if (dst_fp = wfopen(destination, "wb"), !dst_fp) {
+        merror(FOPEN_ERROR, destination, errno, strerror(errno));
+        return -1;
+    }
+
+    if (source && first < last) {
+        if (src_fp = wfopen(source, "rb"), !src_fp || fseek(src_fp, (long)list->chunks[first].offset, SEEK_SET) != 0) {
+            retval = -1;
+        }
+    }
+
+    for (size_t i = first; i < last && retval == 0; i++) {
+        const fim_chunk *chunk = &list->chunks[i];
+        size_t remaining = chunk->length;
+
+        if (src_fp) {
+            // The chunks are contiguous in the source.
+            while (remaining > 0 && retval == 0) {
+                const size_t length = remaining < sizeof(buffer) ? remaining : sizeof(buffer);
+
+                if (fread(buffer, 1, length, src_fp) != length || fwrite(buffer, 1, length, dst_fp) != length) {
+                    retval = -1;
+                }
+                remaining -= length;
+            }
+        } else {
+            gzFile gz_fd;
+            int length;
+
+            snprintf(path, PATH_MAX, "%s/%s.gz", folder, chunk->hash);
+
+            if (gz_fd = gzopen(path, "rb"), !gz_fd) {
+                merror(FOPEN_ERROR, path, errno, strerror(errno));
+                retval = -1;
+                break;
+            }
+
+            while (length = gzread(gz_fd, buffer, sizeof(buffer)), length > 0) {
+                if (fwrite(buffer, 1, (size_t)length, dst_fp) != (size_t)length) {
+                    retval = -1;
+                    break;
+                }
+                remaining -= (size_t)length < remaining ? (size_t)length : remaining;
+            }
+
+            if (length < 0 || remaining != 0) {
+                retval = -1;
+            }
+
+            gzclose(gz_fd);
+        }
+    }
+
+    if (src_fp) {
+        fclose(src_fp);
+    }
+
+    if (fclose(dst_fp) != 0) {
+        retval = -1;
+    }
+
+    return retval;
+}
+
+static char *fim_diff_shift_lines(const char *diff_str, unsigned int offset) {
+    const size_t limit = OS_MAXSTR - OS_SK_HEADER - 1;
+    const char *line = diff_str;
+    size_t lines = 1;
+    size_t length = 0;
+    char *shifted;
+
+    for (const char *it = diff_str; *it; it++) {
+        lines += *it == '\n';
+    }
+
+    // A header holds four numbers at most, each one grows ten digits at most.
+    os_malloc(strlen(diff_str) + lines * 40 + 1, shifted);
+
+    while (*line) {
+        const char *end = strchr(line, '\n');
+        const size_t line_length = end ? (size_t)(end - line + 1) : strlen(line);
+
+        // Headers such as "12,14c12,15" start with a digit, the changed lines start with "<", ">" or "---".
+        if (isdigit((unsigned char)*line)) {
+            const char *it = line;
+
+            while (it < line + line_length) {
+                if (isdigit((unsigned char)*it)) {
+                    char *number_end;
+                    unsigned long number = strtoul(it, &number_end, 10);
+                    length += sprintf(shifted + length, "%lu", number + offset);
+                    it = number_end;
+                } else {
+                    shifted[length++] = *it++;
+                }
+            }
+        } else {
+            memcpy(shifted + length, line, line_length);
+            length += line_length;
+        }
+
+        line += line_length;
+    }
+
+    shifted[length] = '\0';
+
+    // The output was already cut to the limit, that the longer numbers may exceed.
+    if (length >= limit) {
+        length = limit - strlen(STR_MORE_CHANGES);
+
+        while (length > 0 && shifted[length - 1] != '\n') {
+            length--;
+        }
+
+        strcpy(shifted + length, STR_MORE_CHANGES);
+    }
+
+    return shifted;
+}
+
+static void fim_diff_discard_chunks(const fim_chunk_list *list, const char *folder) {
+    char path[PATH_MAX];
+
+    for (size_t i = 0; i < list->count; i++) {
+        if (list->chunks[i].written) {
+            snprintf(path, PATH_MAX, "%s/%s.gz", folder, list->chunks[i].hash);
+            unlink(path);
+        }
+    }
+}
+
+static float fim_diff_release_chunks(const fim_chunk_list *old_list, const fim_chunk_list *new_list, const char *folder) {
+    char path[PATH_MAX];
+    fim_chunk *sorted = NULL;
+    float released = 0;
+
+    if (!old_list->count) {
+        return 0;
+    }
+
+    if (new_list->count) {
+        os_calloc(new_list->count, sizeof(fim_chunk), sorted);
+        memcpy(sorted, new_list->chunks, new_list->count * sizeof(fim_chunk));
+        qsort(sorted, new_list->count, sizeof(fim_chunk), fim_chunk_compare_hash);
+    }
+
+    for (size_t i = 0; i < old_list->count; i++) {
+        const fim_chunk *chunk = &old_list->chunks[i];
+
+        if (sorted && bsearch(chunk, sorted, new_list->count, sizeof(fim_chunk), fim_chunk_compare_hash)) {
+            continue;
+        }
+
+        snprintf(path, PATH_MAX, "%s/%s.gz", folder, chunk->hash);
+
+        // A chunk repeated in the old version is removed once.
+        if (IsFile(path) == 0) {
+            released += FileSize(path) / 1024.0f;
+            unlink(path);
+        }
+    }
+
+    os_free(sorted);
+    return released;
+}
+
+static int fim_diff_same_chunks(const fim_chunk_list *old_list, const fim_chunk_list *new_list) {
+    if (old_list->count != new_list->count) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < old_list->count; i++) {
+        if (strcmp(old_list->chunks[i].hash, new_list->chunks[i].hash) != 0) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int fim_diff_commit_chunks(const diff_data *diff,
+                                  const char *list_path,
+                                  const fim_chunk_list *old_list,
+                                  int old_stored,
+                                  const fim_chunk_list *new_list,
+                                  const fim_chunk_store *store) {
+    float released = 0;
+
+    if (fim_diff_write_chunk_list(list_path, new_list) != 0) {
+        return -1;
+    }
+
+    if (old_stored) {
+        released = fim_diff_release_chunks(old_list, new_list, store->folder);
+    }
+
+    // The copy kept by the previous versions of the agent is replaced by the chunks.
+    if (IsFile(diff->compress_file) == 0) {
+        released += FileSize(diff->compress_file) / 1024.0f;
+        unlink(diff->compress_file);
+    }
+
+    if (syscheck.disk_quota_enabled) {
+        syscheck.diff_folder_size += store->written_size - released;
+
+        if (syscheck.diff_folder_size < 0) {
+            syscheck.diff_folder_size = 0;
+        }
+    }
+
+    return 0;
+}
+
+char *fim_diff_chunked_file(const diff_data *diff) {
+    fim_chunk_list old_list = { .chunks = NULL, .count = 0, .size = 0 };
+    fim_chunk_list new_list = { .chunks = NULL, .count = 0, .size = 0 };
+    fim_chunk_store store = { .written_size = 0 };
+    char list_path[PATH_MAX];
+    char old_part[PATH_MAX];
+    char new_part[PATH_MAX];
+    const char *old_source = NULL;
+    char *diff_changes = NULL;
+    int old_stored = 0;
+    int first_version = 0;
+    size_t prefix = 0;
+    size_t suffix = 0;
+    unsigned int prefix_lines = 0;
+
+    snprintf(list_path, PATH_MAX, "%s/%s", diff->compress_folder, FIM_CHUNKS_LIST);
+    snprintf(store.folder, PATH_MAX, "%s/%s", diff->compress_folder, FIM_CHUNKS_FOLDER);
+    snprintf(old_part, PATH_MAX, "%s/old-part", diff->tmp_folder);
+    snprintf(new_part, PATH_MAX, "%s/new-part", diff->tmp_folder);
+
+    if (fim_diff_read_chunk_list(list_path, &old_list) == 0) {
+        old_stored = 1;
+    } else if (w_uncompress_gzfile(diff->compress_file, diff->uncompress_file) == 0) {
+        // A whole copy made before the chunks were enabled, split like the new version.
+        if (fim_diff_chunk_file(diff->uncompress_file, &old_list, NULL) != 0) {
+            goto end;
+        }
+        old_source = diff->uncompress_file;
+    } else {
+        first_version = 1;
+    }
+
+    mkdir_ex(store.folder);
+
+    if (fim_diff_chunk_file(diff->file_origin, &new_list, &store) != 0) {
+        mwarn(FIM_WARN_GENDIFF_SNAPSHOT, diff->file_origin);
+        goto discard;
+    }
+
+    // Only the chunks new to this version take space.
+    if (syscheck.disk_quota_enabled && syscheck.diff_folder_size + store.written_size > syscheck.disk_quota_limit) {
+        if (syscheck.disk_quota_full_msg) {
+            syscheck.disk_quota_full_msg = false;
+            mdebug2(FIM_DISK_QUOTA_LIMIT_REACHED, "calculate", diff->file_origin);
+        }
+        goto discard;
+    }
+
+    if (first_version) {
+        if (fim_diff_commit_chunks(diff, list_path, &old_list, old_stored, &new_list, &store) != 0) {
+            goto discard;
+        }
+        goto end;
+    }
+
+    if (fim_diff_same_chunks(&old_list, &new_list)) {
+        mdebug2(FIM_DIFF_IDENTICAL_MD5_FILES);
+
+        if (!old_stored && fim_diff_commit_chunks(diff, list_path, &old_list, old_stored, &new_list, &store) != 0) {
+            goto discard;
+        }
+        goto end;
+    }
+
+    if (is_file_nodiff(diff->file_origin)) {
+        if (fim_diff_commit_chunks(diff, list_path, &old_list, old_stored, &new_list, &store) != 0) {
+            goto discard;
+        }
+        os_strdup("<Diff truncated because nodiff option>", diff_changes);
+        goto end;
+    }
+
+#ifndef WIN32
+    // The chunks both versions start and end with aren't compared. The ranges are kept at line boundaries, so the
+    // line numbers of the output only need the lines skipped at the start. fc numbers the lines itself.
+    while (prefix < old_list.count && prefix < new_list.count &&
+           strcmp(old_list.chunks[prefix].hash, new_list.chunks[prefix].hash) == 0) {
+        prefix++;
+    }
+
+    while (prefix > 0 && !old_list.chunks[prefix - 1].line_end) {
+        prefix--;
+    }
+
+    while (suffix < old_list.count - prefix && suffix < new_list.count - prefix &&
+           strcmp(old_list.chunks[old_list.count - suffix - 1].hash,
+                  new_list.chunks[new_list.count - suffix - 1].hash) == 0) {
+        suffix++;
+    }
+
+    while (suffix > 0 &&
+           !((old_list.count - suffix == 0 || old_list.chunks[old_list.count - suffix - 1].line_end) &&
+             (new_list.count - suffix == 0 || new_list.chunks[new_list.count - suffix - 1].line_end))) {
+        suffix--;
+    }
+
+    for (size_t i = 0; i < prefix; i++) {
+        prefix_lines += old_list.chunks[i].lines;
+    }
+#endif
+
+    if (fim_diff_write_chunks(&old_list, prefix, old_list.count - suffix, old_source, store.folder, old_part) != 0) {
+        // The stored version is damaged, the new one replaces it without a diff.
+        mwarn(FIM_WARN_GENDIFF_SNAPSHOT, diff->file_origin);
+
+        if (fim_diff_commit_chunks(diff, list_path, &old_list, old_stored, &new_list, &store) != 0) {
+            goto discard;
+        }
+        goto end;
+    }
+
+    diff_data part = *diff;
+    part.uncompress_file = old_part;
+
+    if (prefix || suffix) {
+        if (fim_diff_write_chunks(&new_list, prefix, new_list.count - suffix, diff->file_origin, NULL, new_part) != 0) {
+            mwarn(FIM_WARN_GENDIFF_SNAPSHOT, diff->file_origin);
+            goto discard;
+        }
+        part.file_origin = new_part;
+    }
+
+    if (diff_changes = fim_diff_generate(&part), !diff_changes) {
+        goto discard;
+    }
+
+    if (prefix_lines) {
+        char *shifted = fim_diff_shift_lines(diff_changes, prefix_lines);
+        os_free(diff_changes);
+        diff_changes = shifted;
+    }
+
+    if (fim_diff_commit_chunks(diff, list_path, &old_list, old_stored, &new_list, &store) != 0) {
+        os_free(diff_changes);
+        goto discard;
+    }
+
+    goto end;
+
+discard:
+    // The previous version is kept, the chunks written for this one aren't referenced.
+    fim_diff_discard_chunks(&new_list, store.folder);
+
+end:
+    fim_chunk_list_free(&old_list);
+    fim_chunk_list_free(&new_list);
+    return diff_changes;
+}
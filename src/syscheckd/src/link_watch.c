@@ -0,0 +1,326 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "syscheck.h"
+
+#ifndef WIN32
+
+#ifdef INOTIFY_ENABLED
+#include <sys/inotify.h>
+#include <poll.h>
+#define LINK_WATCH_INOTIFY
+#elif defined(__MACH__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#include <sys/event.h>
+#define LINK_WATCH_KQUEUE
+#endif
+
+#ifdef WAZUH_UNIT_TESTING
+// Remove static qualifier when unit testing
+#define STATIC
+#else
+#define STATIC static
+#endif
+
+#define LINK_WATCH_MAX_HOPS 40          // Links followed from a configured path, as the kernel does
+#define LINK_WATCH_SETTLE 1             // Seconds without events to consider a replacement finished
+#define LINK_WATCH_SETTLE_MAX 5         // Maximum rounds waiting for the replacement to finish
+#define LINK_WATCH_BUFFER_SIZE (16 * 1024)
+
+#ifdef LINK_WATCH_INOTIFY
+#define LINK_WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | \
+                         IN_DONT_FOLLOW | IN_ONLYDIR)
+#elif defined(LINK_WATCH_KQUEUE)
+#define LINK_WATCH_FFLAGS (NOTE_WRITE | NOTE_DELETE | NOTE_RENAME | NOTE_REVOKE)
+#ifdef O_EVTONLY
+#define LINK_WATCH_OPEN_FLAGS (O_EVTONLY | O_CLOEXEC)
+#else
+#define LINK_WATCH_OPEN_FLAGS (O_RDONLY | O_CLOEXEC)
+#endif
+#endif
+
+#if defined(LINK_WATCH_INOTIFY) || defined(LINK_WATCH_KQUEUE)
+
+typedef struct link_watch_dir_t {
+    int wd;         ///< inotify watch descriptor, or descriptor of the directory registered in the kqueue.
+    char *path;     ///< Real path of the directory.
+} link_watch_dir_t;
+
+STATIC int link_watch_fd = -1;
+STATIC link_watch_dir_t *link_watch_dirs;
+STATIC size_t link_watch_dirs_size;
+STATIC W_Vector *link_watch_names;
+
+/**
+ * @brief Drop every watch and close the watch descriptor.
+ */
+STATIC void fim_link_watch_close() {
+    for (size_t i = 0; i < link_watch_dirs_size; i++) {
+#ifdef LINK_WATCH_KQUEUE
+        close(link_watch_dirs[i].wd);
+#endif
+        os_free(link_watch_dirs[i].path);
+    }
+
+    os_free(link_watch_dirs);
+    link_watch_dirs_size = 0;
+
+    if (link_watch_names) {
+        W_Vector_free(link_watch_names);
+        link_watch_names = NULL;
+    }
+
+    if (link_watch_fd >= 0) {
+        close(link_watch_fd);
+        link_watch_fd = -1;
+    }
+}
+
+/**
+ * @brief Watch the entries created, removed and renamed in a directory.
+ *
+ * @param dir Real path of the directory.
+ */
+STATIC void fim_link_watch_dir(const char *dir) {
+    int wd;
+
+    for (size_t i = 0; i < link_watch_dirs_size; i++) {
+        if (strcmp(link_watch_dirs[i].path, dir) == 0) {
+            return;
+        }
+    }
+
+#ifdef LINK_WATCH_INOTIFY
+    if (wd = inotify_add_watch(link_watch_fd, dir, LINK_WATCH_MASK), wd < 0) {
+        mdebug2(FIM_LINKWATCH_ADD, dir, errno, strerror(errno));
+        return;
+    }
+#else
+    struct kevent change;
+
+    if (wd = open(dir, LINK_WATCH_OPEN_FLAGS), wd < 0) {
+        mdebug2(FIM_LINKWATCH_ADD, dir, errno, strerror(errno));
+        return;
+    }
+
+    EV_SET(&change, wd, EVFILT_VNODE, EV_ADD | EV_CLEAR, LINK_WATCH_FFLAGS, 0, 0);
+
+    if (kevent(link_watch_fd, &change, 1, NULL, 0, NULL) < 0) {
+        mdebug2(FIM_LINKWATCH_ADD, dir, errno, strerror(errno));
+        close(wd);
+        return;
+    }
+#endif
+
+    os_realloc(link_watch_dirs, (link_watch_dirs_size + 1) * sizeof(link_watch_dir_t), link_watch_dirs);
+    link_watch_dirs[link_watch_dirs_size].wd = wd;
+    os_strdup(dir, link_watch_dirs[link_watch_dirs_size].path);
+    link_watch_dirs_size++;
+}
+
+/**
+ * @brief Watch the directories holding a configured path and every link it goes through.
+ *
+ * The configured path is watched even if it isn't a link, so that it's noticed when it becomes one.
+ * Links in the parent directories of the path aren't watched, the periodic check covers them.
+ *
+ * @param path Configured path.
+ */
+STATIC void fim_link_watch_path(const char *path) {
+    char current[PATH_MAX];
+    char parent[PATH_MAX];
+    char target[PATH_MAX];
+    char name[PATH_MAX];
+    struct stat statbuf;
+
+    snprintf(current, sizeof(current), "%s", path);
+
+    for (int hops = 0; hops < LINK_WATCH_MAX_HOPS; hops++) {
+        char *separator = strrchr(current, '/');
+        char *real_parent;
+        ssize_t length;
+
+        if (separator == NULL || separator[1] == '\0') {
+            break;
+        }
+
+        if (separator == current) {
+            snprintf(parent, sizeof(parent), "/");
+        } else {
+            snprintf(parent, sizeof(parent), "%.*s", (int)(separator - current), current);
+        }
+
+        if (real_parent = realpath(parent, NULL), real_parent == NULL) {
+            break;
+        }
+
+        fim_link_watch_dir(real_parent);
+        length = snprintf(name, sizeof(name), "%s/%s", strcmp(real_parent, "/") ? real_parent : "", separator + 1);
+        os_free(real_parent);
+
+        if (length >= (ssize_t)sizeof(name)) {
+            break;
+        }
+
+        W_Vector_insert_unique(link_watch_names, name);
+
+        if (lstat(current, &statbuf) != 0 || !S_ISLNK(statbuf.st_mode)) {
+            break;
+        }
+
+        if (length = readlink(current, target, sizeof(target) - 1), length < 0) {
+            break;
+        }
+
+        target[length] = '\0';
+
+        if (target[0] == '/') {
+            snprintf(current, sizeof(current), "%s", target);
+        } else if (snprintf(current, sizeof(current), "%.*s/%s", (int)(strrchr(name, '/') - name), name, target) >= (int)sizeof(current)) {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Read the pending events, waiting for them up to a timeout.
+ *
+ * @param timeout Maximum seconds to wait.
+ * @param changed Set if a watched link or one of its directories changed.
+ * @return Number of events read, 0 on timeout.
+ */
+STATIC int fim_link_watch_read(int timeout, bool *changed) {
+#ifdef LINK_WATCH_INOTIFY
+    char buffer[LINK_WATCH_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd pfd = { .fd = link_watch_fd, .events = POLLIN };
+    char path[PATH_MAX];
+    ssize_t length;
+    int events = 0;
+
+    if (poll(&pfd, 1, timeout * 1000) <= 0) {
+        return 0;
+    }
+
+    if (length = read(link_watch_fd, buffer, sizeof(buffer)), length <= 0) {
+        return 0;
+    }
+
+    for (char *it = buffer; it < buffer + length; events++) {
+        const struct inotify_event *event = (const struct inotify_event *)(void *)it;
+        it += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & (IN_Q_OVERFLOW | IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF)) {
+            *changed = true;
+            continue;
+        }
+
+        if (event->len == 0) {
+            continue;
+        }
+
+        for (size_t i = 0; i < link_watch_dirs_size; i++) {
+            if (link_watch_dirs[i].wd == event->wd) {
+                if (snprintf(path, sizeof(path), "%s/%s", strcmp(link_watch_dirs[i].path, "/") ? link_watch_dirs[i].path : "",
+                             event->name) >= (int)sizeof(path)) {
+                    break;
+                }
+
+                for (int j = 0; j < W_Vector_length(link_watch_names); j++) {
+                    if (strcmp(W_Vector_get(link_watch_names, j), path) == 0) {
+                        *changed = true;
+                        break;
+                    }
+                }
+
+                break;
+            }
+        }
+    }
+
+    return events;
+#else
+    struct kevent events[16];
+    struct timespec ts = { .tv_sec = timeout };
+    int count;
+
+    // kqueue doesn't report the entry that changed, any change of a watched directory counts
+    if (count = kevent(link_watch_fd, NULL, 0, events, 16, &ts), count <= 0) {
+        return 0;
+    }
+
+    *changed = true;
+    return count;
+#endif
+}
+
+int fim_link_watch_update() {
+    OSListNode *node_it;
+    directory_t *dir_it;
+
+    fim_link_watch_close();
+
+#ifdef LINK_WATCH_INOTIFY
+    link_watch_fd = inotify_init();
+#else
+    link_watch_fd = kqueue();
+#endif
+
+    if (link_watch_fd < 0) {
+        return -1;
+    }
+
+    fcntl(link_watch_fd, F_SETFD, FD_CLOEXEC);
+    link_watch_names = W_Vector_init(8);
+
+    OSList_foreach(node_it, syscheck.directories) {
+        dir_it = node_it->data;
+
+        if (dir_it->options & CHECK_FOLLOW) {
+            fim_link_watch_path(dir_it->path);
+        }
+    }
+
+    return (int)link_watch_dirs_size;
+}
+
+int fim_link_watch_wait(int timeout) {
+    time_t end = time(NULL) + timeout;
+    bool changed = false;
+    time_t remaining;
+
+    if (link_watch_fd < 0) {
+        sleep(timeout);
+        return 0;
+    }
+
+    while (remaining = end - time(NULL), remaining > 0) {
+        if (fim_link_watch_read((int)remaining, &changed) > 0 && changed) {
+            // Replacing a link takes several operations, wait for the last one
+            for (int i = 0; i < LINK_WATCH_SETTLE_MAX && fim_link_watch_read(LINK_WATCH_SETTLE, &changed) > 0; i++);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+#else
+
+int fim_link_watch_update() {
+    return -1;
+}
+
+int fim_link_watch_wait(int timeout) {
+    sleep(timeout);
+    return 0;
+}
+
+#endif /* LINK_WATCH_INOTIFY || LINK_WATCH_KQUEUE */
+
+#endif /* WIN32 */
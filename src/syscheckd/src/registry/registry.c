@@ -56,6 +56,12 @@ typedef struct fim_val_txn_context_s {
     char* diff;
 } fim_val_txn_context_t;
 
+/* Buffers reused while enumerating the values of every key in a scan */
+static TCHAR *value_name_buffer = NULL;
+static DWORD value_name_buffer_size = 0;
+static BYTE *value_data_buffer = NULL;
+static DWORD value_data_buffer_size = 0;
+
 // DBSync Callbacks
 
 /**
@@ -818,61 +824,91 @@ void fim_registry_free_entry(fim_entry *entry) {
 }
 
 
+/**
+ * @brief Make sure the value enumeration buffers can hold the values of a key.
+ *
+ * The buffers are kept between keys and only grow, so a scan allocates them a handful of times.
+ *
+ * @param max_value_length The size of longest value name contained in the key in unicode characters.
+ * @param max_value_data_length The size of the biggest data contained in of the keys values in bytes.
+ */
+static void fim_registry_reserve_value_buffers(DWORD max_value_length, DWORD max_value_data_length) {
+    if (max_value_length + 1 > value_name_buffer_size) {
+        value_name_buffer_size = max_value_length + 1;
+        os_realloc(value_name_buffer, value_name_buffer_size * sizeof(TCHAR), value_name_buffer);
+    }
+
+    // Keep room for a terminator so string data can always be read safely
+    if (max_value_data_length + sizeof(TCHAR) > value_data_buffer_size) {
+        value_data_buffer_size = max_value_data_length + sizeof(TCHAR);
+        os_realloc(value_data_buffer, value_data_buffer_size, value_data_buffer);
+    }
+}
+
+/**
+ * @brief Release the value enumeration buffers once the scan is over.
+ */
+static void fim_registry_free_value_buffers() {
+    os_free(value_name_buffer);
+    os_free(value_data_buffer);
+    value_name_buffer_size = 0;
+    value_data_buffer_size = 0;
+}
+
 /**
  * @brief Query the values belonging to a key.
  *
+ * All the values are enumerated in a single pass over buffers sized with the key information, and synced
+ * through the ongoing registry value transaction.
+ *
  * @param key_handle A handle to the key holding the values to query.
- * @param new A fim_entry object holding the information gathered from the key.
- * @param saved A fim_entry object holding the information from the key retrieved from the database.
+ * @param path A string holding the full path of the key.
+ * @param arch An integer specifying the bit count of the register to scan, must be ARCH_32BIT or ARCH_64BIT.
+ * @param configuration The configuration associated with the key.
  * @param value_count An integer holding the amount of values stored in the queried key.
  * @param max_value_length The size of longest value name contained in the key in unicode characters.
  * @param max_value_data_length The size of the biggest data contained in of the keys values in bytes.
- * @param mode A value specifying if the event has been triggered in scheduled, realtime or whodata mode.
+ * @param regval_txn_handler Handler of the registry value transaction.
+ * @param txn_ctx_regval Context of the registry value transaction.
  */
 void fim_read_values(HKEY key_handle,
                      char* path,
                      int arch,
+                     registry_t *configuration,
                      DWORD value_count,
                      DWORD max_value_length,
                      DWORD max_value_data_length,
                      TXN_HANDLE regval_txn_handler,
                      fim_val_txn_context_t *txn_ctx_regval) {
     fim_registry_value_data value_data;
-    TCHAR *value_buffer;
-    BYTE *data_buffer;
     DWORD i;
     fim_entry new;
     char *value_path;
     size_t value_path_length;
-    registry_t *configuration = NULL;
     char* diff = NULL;
     os_sha1 hash_full_path;
-    char* arch_string;
+    char* arch_string = (arch == ARCH_32BIT) ? "[x32]" : "[x64]";
 
     value_data.arch = arch;
     value_data.path = path;
     new.registry_entry.value = &value_data;
     new.registry_entry.key = NULL;
 
-    os_calloc(max_value_length + 1, sizeof(TCHAR), value_buffer);
-    os_calloc(max_value_data_length, sizeof(BYTE), data_buffer);
+    fim_registry_reserve_value_buffers(max_value_length, max_value_data_length);
 
     for (i = 0; i < value_count; i++) {
-        DWORD value_size = max_value_length + 1;
+        DWORD value_size = value_name_buffer_size;
         DWORD data_size = max_value_data_length;
         DWORD data_type = 0;
 
-        configuration = fim_registry_configuration(path, arch);
-        if (configuration == NULL) {
-            return;
-        }
-
-        if (RegEnumValue(key_handle, i, value_buffer, &value_size, NULL, &data_type, data_buffer, &data_size) !=
-            ERROR_SUCCESS) {
+        if (RegEnumValue(key_handle, i, value_name_buffer, &value_size, NULL, &data_type, value_data_buffer,
+                         &data_size) != ERROR_SUCCESS) {
             break;
         }
 
-        new.registry_entry.value->name = value_buffer;
+        memset(value_data_buffer + data_size, 0, value_data_buffer_size - data_size);
+
+        new.registry_entry.value->name = value_name_buffer;
         new.registry_entry.value->type = data_type <= REG_QWORD ? data_type : REG_UNKNOWN;
         new.registry_entry.value->size = data_size;
         new.registry_entry.value->last_event = time(NULL);
@@ -886,7 +922,6 @@ void fim_read_values(HKEY key_handle,
 
         if (fim_registry_validate_ignore(value_path, configuration, 0)) {
             os_free(value_path);
-            os_free(value_data.name);
             continue;
         }
         os_free(value_path);
@@ -895,21 +930,19 @@ void fim_read_values(HKEY key_handle,
             continue;
         }
 
-        arch_string = (arch == ARCH_32BIT) ? "[x32]" : "[x64]";
-
         // Hash containing "value", arch, key path and value name
         // Index used in wazuh manager DB
         OS_SHA1_strings(hash_full_path, "value", arch_string, new.registry_entry.value->path,
                         new.registry_entry.value->name, NULL);
         new.registry_entry.value->hash_full_path = hash_full_path;
 
-        fim_registry_calculate_hashes(&new, configuration, data_buffer);
+        fim_registry_calculate_hashes(&new, configuration, value_data_buffer);
 
         fim_registry_get_checksum_value(new.registry_entry.value);
 
         if (configuration->opts & CHECK_SEECHANGES) {
             diff = fim_registry_value_diff(new.registry_entry.value->path, new.registry_entry.value->name,
-                                       (char *)data_buffer, new.registry_entry.value->type, configuration);
+                                       (char *)value_data_buffer, new.registry_entry.value->type, configuration);
         }
         txn_ctx_regval->diff = diff;
         txn_ctx_regval->data = new.registry_entry.value;
@@ -922,8 +955,6 @@ void fim_read_values(HKEY key_handle,
     }
 
     new.registry_entry.value = NULL;
-    os_free(value_data.name);
-    os_free(data_buffer);
 }
 
 /**
@@ -1031,6 +1062,7 @@ void fim_open_key(HKEY root_key_handle,
 
     // Restrict check
     if (fim_check_restrict(full_key, configuration->restrict_key)) {
+        RegCloseKey(current_key_handle);
         return;
     }
 
@@ -1040,6 +1072,7 @@ void fim_open_key(HKEY root_key_handle,
     new.registry_entry.value = NULL;
 
     if (new.registry_entry.key == NULL) {
+        RegCloseKey(current_key_handle);
         return;
     }
 
@@ -1059,8 +1092,8 @@ void fim_open_key(HKEY root_key_handle,
     }
 
     if (value_count) {
-        fim_read_values(current_key_handle, new.registry_entry.key->path, new.registry_entry.key->arch, value_count, max_value_length, max_value_data_length,
-                        regval_txn_handler, txn_ctx_regval);
+        fim_read_values(current_key_handle, new.registry_entry.key->path, new.registry_entry.key->arch, configuration,
+                        value_count, max_value_length, max_value_data_length, regval_txn_handler, txn_ctx_regval);
     }
 
     fim_registry_free_key(new.registry_entry.key);
@@ -1107,6 +1140,7 @@ void fim_registry_scan() {
     fim_db_transaction_deleted_rows(regkey_txn_handler, registry_key_transaction_callback, &txn_ctx_reg);
     regkey_txn_handler = NULL;
     regval_txn_handler = NULL;
+    fim_registry_free_value_buffers();
 
     mdebug1(FIM_WINREGISTRY_ENDED);
 
@@ -25,8 +25,6 @@
 #include "db/include/db.h"
 
 #ifdef WAZUH_UNIT_TESTING
-unsigned int files_read = 0;
-time_t last_time = 0;
 void audit_set_db_consistency(void);
 #ifdef WIN32
 
@@ -67,6 +65,9 @@ STATIC void fim_link_reload_broken_link(char *path, directory_t *configuration);
 
 bool is_fim_shutdown = false;
 
+STATIC w_token_bucket_t fps_bucket = W_TOKEN_BUCKET_INITIALIZER;
+STATIC w_token_bucket_t sync_eps_bucket = W_TOKEN_BUCKET_INITIALIZER;
+
 bool fim_shutdown_process_on() {
     bool ret = is_fim_shutdown;
     return ret;
@@ -91,29 +92,17 @@ STATIC void fim_send_msg(char mq, const char * location, const char * msg) {
 }
 
 void fim_sync_check_eps() {
-    static long n_msg_sent = 0;
+    const unsigned int eps = (unsigned int)syscheck.sync_max_eps;
 
-    if (++n_msg_sent == syscheck.sync_max_eps) {
-        sleep(1);
-        n_msg_sent = 0;
-    }
+    w_token_bucket_wait(&sync_eps_bucket, eps, W_TOKEN_BUCKET_BURST(eps));
 }
 // Send a state synchronization message
 void fim_send_sync_state(const char *location, const char* msg) {
+    fim_send_msg(DBSYNC_MQ, location, msg);
+    mdebug2(FIM_DBSYNC_SEND, msg);
 
-    if (syscheck.sync_max_eps == 0) {
-        fim_send_msg(DBSYNC_MQ, location, msg);
-        mdebug2(FIM_DBSYNC_SEND, msg);
-    } else {
-        static pthread_mutex_t sync_eps_mutex = PTHREAD_MUTEX_INITIALIZER;
-
-        w_mutex_lock(&sync_eps_mutex);
-
-        fim_send_msg(DBSYNC_MQ, location, msg);
-        mdebug2(FIM_DBSYNC_SEND, msg);
+    if (syscheck.sync_max_eps != 0) {
         fim_sync_check_eps();
-
-        w_mutex_unlock(&sync_eps_mutex);
     }
 }
 
@@ -148,43 +137,10 @@ void fim_send_scan_info(fim_scan_event event) {
 }
 
 void check_max_fps() {
-#ifndef WAZUH_UNIT_TESTING
-    static unsigned int files_read = 0;
-    static time_t last_time = 0;
-#endif
-    static pthread_mutex_t fps_mutex = PTHREAD_MUTEX_INITIALIZER;
-    static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
-    struct timespec wait_time = {0, 0};
-
-    if (syscheck.max_files_per_second == 0) {
-        return;
-    }
-    w_mutex_lock(&fps_mutex);
-    gettime(&wait_time);
-
-    if (wait_time.tv_sec != last_time) {
-        files_read = 0;
-        last_time = wait_time.tv_sec;
-    }
-
-    if (files_read < syscheck.max_files_per_second) {
-        files_read++;
-        w_mutex_unlock(&fps_mutex);
-        return;
+    if (w_token_bucket_wait(&fps_bucket, syscheck.max_files_per_second,
+                            W_TOKEN_BUCKET_BURST(syscheck.max_files_per_second))) {
+        mdebug2(FIM_REACHED_MAX_FPS);
     }
-    mdebug2(FIM_REACHED_MAX_FPS);
-    wait_time.tv_sec += 1;
-
-    // Wait for one second or until the thread is unlocked using w_cond_broadcast
-    int rt = pthread_cond_timedwait(&cond, &fps_mutex, &wait_time);
-    if (rt == ETIMEDOUT) {
-        // In case that the mutex is unlocked due to a timeout, free all blocked threads.
-        files_read = 0;
-        w_cond_broadcast(&cond);
-    } else if (rt != 0) {
-        mdebug2("pthread_cond_timedwait failed: %s", strerror(rt));
-    }
-    w_mutex_unlock(&fps_mutex);
 }
 
 // LCOV_EXCL_START
@@ -467,9 +423,16 @@ void *fim_run_realtime(__attribute__((unused)) void * args) {
             struct timeval selecttime;
             fd_set rfds;
             int run_now = 0;
+            long pending_wait = realtime_pending_wait();
 
-            selecttime.tv_sec = SYSCHECK_WAIT;
-            selecttime.tv_usec = 0;
+            if (pending_wait >= 0) {
+                // Wake up when the coalescing window of the pending events ends
+                selecttime.tv_sec = pending_wait / 1000;
+                selecttime.tv_usec = (pending_wait % 1000) * 1000;
+            } else {
+                selecttime.tv_sec = SYSCHECK_WAIT;
+                selecttime.tv_usec = 0;
+            }
 
             // zero-out the fd_set
             FD_ZERO (&rfds);
@@ -480,6 +443,7 @@ void *fim_run_realtime(__attribute__((unused)) void * args) {
                 merror(FIM_ERROR_SELECT);
             } else if (run_now == 0) {
                 // Timeout
+                realtime_flush_pending(false);
             } else if (FD_ISSET (nfds, &rfds)) {
                 realtime_process();
             }
@@ -661,15 +625,34 @@ static void *symlink_checker_thread(__attribute__((unused)) void * data) {
     directory_t *dir_it;
     OSListNode *node_it;
 
+    int watched;
+
     mdebug1(FIM_LINKCHECK_START, syscheck.sym_checker_interval);
 
+    w_rwlock_rdlock(&syscheck.directories_lock);
+    watched = fim_link_watch_update();
+    w_rwlock_unlock(&syscheck.directories_lock);
+
+    if (watched < 0) {
+        mdebug1(FIM_LINKWATCH_UNAVAILABLE, syscheck.sym_checker_interval);
+    } else {
+        mdebug1(FIM_LINKWATCH_START, watched);
+    }
+
     while (1) {
-        sleep(syscheck.sym_checker_interval);
+        // The links are checked when one of them changes, or periodically in case a change was missed
+        if (fim_link_watch_wait(syscheck.sym_checker_interval)) {
+            mdebug1(FIM_LINKWATCH_CHANGE);
+        }
+
         mdebug1(FIM_LINKCHECK_START, syscheck.sym_checker_interval);
 
         w_mutex_lock(&syscheck.fim_scan_mutex);
         w_rwlock_rdlock(&syscheck.directories_lock);
 
+        // Watch the new targets before checking them, so that no change is lost in between
+        fim_link_watch_update();
+
         OSList_foreach(node_it, syscheck.directories) {
             dir_it = node_it->data;
             if ((dir_it->options & CHECK_FOLLOW) == 0) {
@@ -820,20 +803,20 @@ STATIC void fim_link_check_delete(directory_t *configuration) {
 
 STATIC void fim_link_delete_range(directory_t *configuration) {
     event_data_t evt_data = { .mode = FIM_SCHEDULED, .report_event = false, .w_evt = NULL, .type = FIM_DELETE };
-    char pattern[PATH_MAX] = {0};
+    char prefix[PATH_MAX] = {0};
 
     get_data_ctx ctx = {
         .event = (event_data_t *)&evt_data,
         .config = configuration,
         .path = configuration->path
     };
-    // Create the sqlite LIKE pattern.
-    snprintf(pattern, PATH_MAX, "%s%c%%", configuration->symbolic_links, PATH_SEP);
+    // Every entry under the link target -> "target/"
+    snprintf(prefix, PATH_MAX, "%s%c", configuration->symbolic_links, PATH_SEP);
     callback_context_t callback_data;
     callback_data.callback = fim_db_remove_validated_path;
     callback_data.context = &ctx;
 
-    fim_db_file_pattern_search(pattern, callback_data);
+    fim_db_file_prefix_search(prefix, callback_data);
 }
 
 STATIC void fim_link_silent_scan(const char *path, directory_t *configuration) {
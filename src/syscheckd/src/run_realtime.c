@@ -28,11 +28,27 @@
 
 #ifdef INOTIFY_ENABLED
 #include <sys/inotify.h>
+#include <sys/fanotify.h>
+#include <sys/vfs.h>
 
 #define REALTIME_MONITOR_FLAGS  IN_MODIFY|IN_ATTRIB|IN_MOVED_FROM|IN_MOVED_TO|IN_CREATE|IN_DELETE|IN_DELETE_SELF|IN_MOVE_SELF
 #define REALTIME_EVENT_SIZE     (sizeof (struct inotify_event))
 #define REALTIME_EVENT_BUFFER   (2048 * (REALTIME_EVENT_SIZE + 16))
 
+// Filesystem marks with file identifiers were added in Linux 5.1
+#if defined(FAN_REPORT_FID) && defined(FAN_MARK_FILESYSTEM)
+#define FANOTIFY_ENABLED
+#define FANOTIFY_MONITOR_FLAGS  FAN_MODIFY|FAN_ATTRIB|FAN_MOVED_FROM|FAN_MOVED_TO|FAN_CREATE|FAN_DELETE|FAN_DELETE_SELF|FAN_MOVE_SELF|FAN_ONDIR
+#define FANOTIFY_EVENT_BUFFER   65536
+
+static void fim_fanotify_free_mount(int *mount_fd);
+static int fim_fanotify_start();
+static int fim_add_fanotify_mark(const char *dir);
+static void fim_fanotify_process();
+#endif
+
+static void realtime_dispatch(rb_tree *tree);
+
 int realtime_start() {
     OSListNode *node_it;
     os_calloc(1, sizeof(rtfim), syscheck.realtime);
@@ -45,6 +61,12 @@ int realtime_start() {
 
     OSHash_SetFreeDataPointer(syscheck.realtime->dirtb, (void (*)(void *))free);
 
+#ifdef FANOTIFY_ENABLED
+    if (syscheck.rt_fanotify && fim_fanotify_start() == 0) {
+        return (0);
+    }
+#endif
+
     syscheck.realtime->fd = inotify_init();
     if (syscheck.realtime->fd < 0) {
         merror(FIM_ERROR_INOTIFY_INITIALIZE);
@@ -75,6 +97,12 @@ int fim_add_inotify_watch(const char *dir, const directory_t *configuration) {
     if (syscheck.realtime->fd < 0) {
         w_mutex_unlock(&syscheck.fim_realtime_mutex);
         return (-1);
+#ifdef FANOTIFY_ENABLED
+    } else if (syscheck.realtime->fanotify) {
+        int retval = fim_add_fanotify_mark(dir);
+        w_mutex_unlock(&syscheck.fim_realtime_mutex);
+        return retval;
+#endif
     } else {
         int wd = 0;
 
@@ -153,7 +181,8 @@ void fim_realtime_delete_watches(const directory_t *configuration) {
     assert(configuration != NULL);
 
     w_mutex_lock(&syscheck.fim_realtime_mutex);
-    if (syscheck.realtime == NULL || syscheck.realtime->dirtb == NULL) {
+    // The filesystem marks are shared by every directory, the events of removed ones are filtered out.
+    if (syscheck.realtime == NULL || syscheck.realtime->dirtb == NULL || syscheck.realtime->fanotify) {
         w_mutex_unlock(&syscheck.fim_realtime_mutex);
         return;
     }
@@ -205,6 +234,13 @@ void realtime_process() {
 
     buf[REALTIME_EVENT_BUFFER] = '\0';
 
+#ifdef FANOTIFY_ENABLED
+    if (syscheck.realtime->fanotify) {
+        fim_fanotify_process();
+        return;
+    }
+#endif
+
     w_mutex_lock(&syscheck.fim_realtime_mutex);
     len = read(syscheck.realtime->fd, buf, REALTIME_EVENT_BUFFER);
     w_mutex_unlock(&syscheck.fim_realtime_mutex);
@@ -230,6 +266,7 @@ void realtime_process() {
         if (event->wd == -1 && event->mask == IN_Q_OVERFLOW) {
             mwarn("Real-time inotify kernel queue is full. Some events may be lost. Next scheduled scan will recover lost data.");
             fim_realtime_set_queue_overflow(true);
+            syscheck.realtime->overflows++;
             send_log_msg("ossec: Real-time inotify kernel queue is full. Some events may be lost. Next scheduled scan will recover lost data.");
             continue;
         }
@@ -274,8 +311,21 @@ void realtime_process() {
         w_mutex_unlock(&syscheck.fim_realtime_mutex);
     }
 
+    realtime_dispatch(tree);
+}
+
+// Checks the paths of the events collected from a read of the real-time queue
+static void realtime_dispatch(rb_tree *tree) {
     char ** paths = rbtree_keys(tree);
 
+    if (syscheck.rt_coalesce_window > 0) {
+        realtime_pending_add(paths);
+        free_strarray(paths);
+        rbtree_destroy(tree);
+        realtime_flush_pending(false);
+        return;
+    }
+
     for (int i = 0; paths[i] != NULL; i++) {
         w_rwlock_rdlock(&syscheck.directories_lock);
         fim_realtime_event(paths[i]);
@@ -286,6 +336,323 @@ void realtime_process() {
     rbtree_destroy(tree);
 }
 
+// Must be called with the fim_realtime_mutex locked
+static long _realtime_pending_wait() {
+    struct timespec now;
+    long elapsed;
+
+    if (syscheck.realtime == NULL || syscheck.realtime->pending == NULL) {
+        return -1;
+    }
+
+    if (syscheck.realtime->pending_full) {
+        return 0;
+    }
+
+    gettime(&now);
+    elapsed = (long)(time_diff(&syscheck.realtime->pending_since, &now) * 1000);
+
+    return elapsed >= syscheck.rt_coalesce_window ? 0 : syscheck.rt_coalesce_window - elapsed;
+}
+
+long realtime_pending_wait() {
+    long retval;
+
+    w_mutex_lock(&syscheck.fim_realtime_mutex);
+    retval = _realtime_pending_wait();
+    w_mutex_unlock(&syscheck.fim_realtime_mutex);
+
+    return retval;
+}
+
+void realtime_pending_add(char **paths) {
+    w_mutex_lock(&syscheck.fim_realtime_mutex);
+
+    for (int i = 0; paths[i] != NULL; i++) {
+        if (syscheck.realtime->pending == NULL) {
+            syscheck.realtime->pending = rbtree_init();
+            syscheck.realtime->pending_full = false;
+            gettime(&syscheck.realtime->pending_since);
+        }
+
+        // Only the path is kept, the event is checked against the state of the file when it's processed.
+        if (rbtree_insert(syscheck.realtime->pending, paths[i], NULL) == NULL) {
+            syscheck.realtime->coalesced++;
+        }
+    }
+
+    if (syscheck.realtime->pending != NULL) {
+        unsigned int size = rbtree_size(syscheck.realtime->pending);
+
+        if (size > syscheck.realtime->pending_peak) {
+            syscheck.realtime->pending_peak = size;
+        }
+
+        if (size >= (unsigned int)syscheck.rt_coalesce_max) {
+            syscheck.realtime->pending_full = true;
+        }
+    }
+
+    w_mutex_unlock(&syscheck.fim_realtime_mutex);
+}
+
+void realtime_flush_pending(bool force) {
+    rb_tree *pending = NULL;
+
+    w_mutex_lock(&syscheck.fim_realtime_mutex);
+    if (syscheck.realtime != NULL && (force || _realtime_pending_wait() == 0)) {
+        pending = syscheck.realtime->pending;
+        syscheck.realtime->pending = NULL;
+    }
+    w_mutex_unlock(&syscheck.fim_realtime_mutex);
+
+    if (pending == NULL) {
+        return;
+    }
+
+    char **paths = rbtree_keys(pending);
+
+    for (int i = 0; paths[i] != NULL; i++) {
+        w_rwlock_rdlock(&syscheck.directories_lock);
+        fim_realtime_event(paths[i]);
+        w_rwlock_unlock(&syscheck.directories_lock);
+    }
+
+    free_strarray(paths);
+    rbtree_destroy(pending);
+}
+
+#ifdef FANOTIFY_ENABLED
+static void fim_fanotify_free_mount(int *mount_fd) {
+    close(*mount_fd);
+    free(mount_fd);
+}
+
+static int fim_fanotify_start() {
+    int fd = -1;
+
+#ifdef FAN_REPORT_DFID_NAME
+    // Since Linux 5.9 the events of the entries of a directory come with their name.
+    fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_DFID_NAME, O_RDONLY);
+#endif
+
+    if (fd < 0) {
+        fd = fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC | FAN_NONBLOCK | FAN_REPORT_FID, O_RDONLY);
+    }
+
+    if (fd < 0) {
+        mwarn(FIM_WARN_FANOTIFY_INITIALIZE, errno, strerror(errno));
+        return -1;
+    }
+
+    syscheck.realtime->mounts = OSHash_Create();
+    if (syscheck.realtime->mounts == NULL) {
+        merror(MEM_ERROR, errno, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    OSHash_SetFreeDataPointer(syscheck.realtime->mounts, (void (*)(void *))fim_fanotify_free_mount);
+
+    syscheck.realtime->fd = fd;
+    syscheck.realtime->fanotify = true;
+    mdebug1(FIM_REALTIME_FANOTIFY);
+
+    return 0;
+}
+
+static void fim_fanotify_fsid_key(const void *fsid, char *key, size_t size) {
+    unsigned int val[2];
+
+    memcpy(val, fsid, sizeof(val));
+    snprintf(key, size, "%x:%x", val[0], val[1]);
+}
+
+// Must be called with the fim_realtime_mutex locked
+static int fim_add_fanotify_mark(const char *dir) {
+    struct stat statbuf;
+    struct statfs fsbuf;
+    char devchar[33];
+    char fsid[33];
+    int *mount_fd;
+    char *data;
+
+    if (stat(dir, &statbuf) < 0) {
+        mdebug1(FIM_FANOTIFY_ADD_MARK, dir, errno, strerror(errno));
+        return -1;
+    }
+
+    // A single mark covers the whole filesystem, so most directories only take this lookup.
+    snprintf(devchar, 33, "%lu", (unsigned long)statbuf.st_dev);
+
+    if (OSHash_Get_ex(syscheck.realtime->dirtb, devchar)) {
+        return 1;
+    }
+
+    os_calloc(1, sizeof(int), mount_fd);
+
+    // Any descriptor in the filesystem is valid to resolve its file handles, except O_PATH ones.
+    if (*mount_fd = open(dir, O_RDONLY | O_NONBLOCK | O_CLOEXEC), *mount_fd < 0 || fstatfs(*mount_fd, &fsbuf) < 0 ||
+        fanotify_mark(syscheck.realtime->fd, FAN_MARK_ADD | FAN_MARK_FILESYSTEM, FANOTIFY_MONITOR_FLAGS, AT_FDCWD, dir) < 0) {
+        mdebug1(FIM_FANOTIFY_ADD_MARK, dir, errno, strerror(errno));
+
+        if (*mount_fd >= 0) {
+            close(*mount_fd);
+        }
+
+        os_free(mount_fd);
+        return -1;
+    }
+
+    fim_fanotify_fsid_key(&fsbuf.f_fsid, fsid, sizeof(fsid));
+
+    if (OSHash_Add_ex(syscheck.realtime->mounts, fsid, mount_fd) != 2) {
+        fim_fanotify_free_mount(mount_fd);
+    }
+
+    os_strdup(dir, data);
+
+    if (OSHash_Add_ex(syscheck.realtime->dirtb, devchar, data) != 2) {
+        os_free(data);
+        merror_exit(FIM_CRITICAL_ERROR_OUT_MEM);
+    }
+
+    mdebug2(FIM_REALTIME_NEWFILESYSTEM, dir);
+    return 1;
+}
+
+/**
+ * @brief Gets the path of the object of a fanotify event from its file handle
+ *
+ * @param metadata Event read from the fanotify descriptor
+ * @param path Buffer where the path is written
+ * @param size Size of the buffer
+ * @return 0 on success, -1 if the path can't be resolved (for example, the object doesn't exist anymore)
+ */
+static int fim_fanotify_event_path(const struct fanotify_event_metadata *metadata, char *path, size_t size) {
+    const struct fanotify_event_info_fid *fid;
+    struct file_handle *handle;
+    const char *name = NULL;
+    char proc_path[64];
+    char fsid[33];
+    int *mount_fd;
+    int fd;
+    ssize_t len;
+
+    if (metadata->event_len <= metadata->metadata_len) {
+        return -1;
+    }
+
+    fid = (const struct fanotify_event_info_fid *)((const char *)metadata + metadata->metadata_len);
+    handle = (struct file_handle *)fid->handle;
+
+    switch (fid->hdr.info_type) {
+    case FAN_EVENT_INFO_TYPE_FID:
+        break;
+#ifdef FAN_EVENT_INFO_TYPE_DFID_NAME
+    case FAN_EVENT_INFO_TYPE_DFID_NAME:
+        name = (const char *)handle->f_handle + handle->handle_bytes;
+        // The events on the directory itself are reported with the "." name.
+        if (strcmp(name, ".") == 0) {
+            name = NULL;
+        }
+        break;
+    case FAN_EVENT_INFO_TYPE_DFID:
+        break;
+#endif
+    default:
+        return -1;
+    }
+
+    fim_fanotify_fsid_key(&fid->fsid, fsid, sizeof(fsid));
+
+    w_mutex_lock(&syscheck.fim_realtime_mutex);
+    mount_fd = (int *)OSHash_Get_ex(syscheck.realtime->mounts, fsid);
+    fd = mount_fd != NULL ? open_by_handle_at(*mount_fd, handle, O_PATH | O_CLOEXEC) : -1;
+    w_mutex_unlock(&syscheck.fim_realtime_mutex);
+
+    if (fd < 0) {
+        return -1;
+    }
+
+    snprintf(proc_path, sizeof(proc_path), "/proc/self/fd/%d", fd);
+    len = readlink(proc_path, path, size - 1);
+    close(fd);
+
+    if (len < 0) {
+        return -1;
+    }
+
+    path[len] = '\0';
+
+    if (name != NULL) {
+        size_t path_len = (size_t)len;
+        snprintf(path + path_len, size - path_len, "%s%s", path[path_len - 1] == PATH_SEP ? "" : "/", name);
+    }
+
+    return 0;
+}
+
+static void fim_fanotify_process() {
+    char buf[FANOTIFY_EVENT_BUFFER] __attribute__((aligned(__alignof__(struct fanotify_event_metadata))));
+    const struct fanotify_event_metadata *metadata;
+    ssize_t len;
+
+    w_mutex_lock(&syscheck.fim_realtime_mutex);
+    len = read(syscheck.realtime->fd, buf, FANOTIFY_EVENT_BUFFER);
+    w_mutex_unlock(&syscheck.fim_realtime_mutex);
+
+    if (len < 0) {
+        if (errno != EAGAIN) {
+            merror(FIM_ERROR_REALTIME_READ_BUFFER);
+        }
+        return;
+    }
+
+    rb_tree * tree = rbtree_init();
+
+    for (metadata = (const struct fanotify_event_metadata *)buf; FAN_EVENT_OK(metadata, len);
+         metadata = FAN_EVENT_NEXT(metadata, len)) {
+        char final_name[MAX_LINE + 1];
+        directory_t *configuration;
+        int monitored;
+
+        if (metadata->vers != FANOTIFY_METADATA_VERSION) {
+            merror(FIM_ERROR_REALTIME_READ_BUFFER);
+            break;
+        }
+
+        if (metadata->fd >= 0) {
+            close(metadata->fd);
+        }
+
+        if (metadata->mask & FAN_Q_OVERFLOW) {
+            mwarn("Real-time fanotify kernel queue is full. Some events may be lost. Next scheduled scan will recover lost data.");
+            fim_realtime_set_queue_overflow(true);
+            syscheck.realtime->overflows++;
+            send_log_msg("ossec: Real-time fanotify kernel queue is full. Some events may be lost. Next scheduled scan will recover lost data.");
+            continue;
+        }
+
+        if (fim_fanotify_event_path(metadata, final_name, sizeof(final_name)) < 0) {
+            continue;
+        }
+
+        // The marks cover whole filesystems, only the events of the monitored directories are kept.
+        w_rwlock_rdlock(&syscheck.directories_lock);
+        configuration = fim_configuration_directory(final_name);
+        monitored = configuration != NULL && (configuration->options & REALTIME_ACTIVE);
+        w_rwlock_unlock(&syscheck.directories_lock);
+
+        if (monitored && rbtree_insert(tree, final_name, NULL) == NULL) {
+            mdebug2("Duplicate event in real-time buffer: %s", final_name);
+        }
+    }
+
+    realtime_dispatch(tree);
+}
+#endif /* FANOTIFY_ENABLED */
+
 int realtime_update_watch(const char *wd, const char *dir) {
     int old_wd, new_wd;
     char wdchar[33];
@@ -406,6 +773,13 @@ void realtime_sanitize_watch_map() {
     w_rwlock_rdlock(&syscheck.directories_lock);
     w_mutex_lock(&syscheck.fim_realtime_mutex);
 
+    // The filesystem marks don't depend on the directories, there is nothing to update.
+    if (syscheck.realtime->fanotify) {
+        w_mutex_unlock(&syscheck.fim_realtime_mutex);
+        w_rwlock_unlock(&syscheck.directories_lock);
+        return;
+    }
+
     gettime(&start);
     hash_node = OSHash_Begin(syscheck.realtime->dirtb, &inode_it);
 
@@ -769,7 +1143,20 @@ void fim_realtime_set_queue_overflow(int value) {
 void fim_realtime_print_watches() {
     w_mutex_lock(&syscheck.fim_realtime_mutex);
     if (syscheck.realtime != NULL) {
+#ifdef INOTIFY_ENABLED
+        mdebug2(syscheck.realtime->fanotify ? FIM_NUM_FILESYSTEMS : FIM_NUM_WATCHES,
+                OSHash_Get_Elem_ex(syscheck.realtime->dirtb));
+
+        if (syscheck.rt_coalesce_window > 0) {
+            mdebug2(FIM_REALTIME_QUEUE_INFO,
+                    syscheck.realtime->pending ? rbtree_size(syscheck.realtime->pending) : 0,
+                    syscheck.realtime->pending_peak,
+                    syscheck.realtime->coalesced,
+                    syscheck.realtime->overflows);
+        }
+#else
         mdebug2(FIM_NUM_WATCHES, OSHash_Get_Elem_ex(syscheck.realtime->dirtb));
+#endif
     }
     w_mutex_unlock(&syscheck.fim_realtime_mutex);
 }
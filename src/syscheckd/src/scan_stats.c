@@ -0,0 +1,238 @@
+/*
+ * Wazuh Syscheck
+ * Copyright (C) 2015, Wazuh Inc.
+ * October 14, 2026.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "syscheck.h"
+
+#define NSEC_PER_SEC 1000000000LL
+
+// The counters are updated by the scan threads for every file, so they avoid locks.
+#ifdef __ATOMIC_SEQ_CST
+#define stats_add(ptr, value) __atomic_add_fetch(ptr, value, __ATOMIC_RELAXED)
+#define stats_load(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#define stats_store(ptr, value) __atomic_store_n(ptr, value, __ATOMIC_RELAXED)
+
+static void slowest_lock(fim_scan_stats_t *stats) {
+    // It is only held to copy a few pointers.
+    while (__atomic_test_and_set(&stats->slowest_lock, __ATOMIC_ACQUIRE));
+}
+
+static void slowest_unlock(fim_scan_stats_t *stats) {
+    __atomic_clear(&stats->slowest_lock, __ATOMIC_RELEASE);
+}
+#else
+static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t slowest_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#define stats_add(ptr, value) do { w_mutex_lock(&stats_mutex); *(ptr) += (value); w_mutex_unlock(&stats_mutex); } while (0)
+#define stats_store(ptr, value) do { w_mutex_lock(&stats_mutex); *(ptr) = (value); w_mutex_unlock(&stats_mutex); } while (0)
+#define stats_load(ptr) (*(ptr))
+#define slowest_lock(stats) w_mutex_lock(&slowest_mutex)
+#define slowest_unlock(stats) w_mutex_unlock(&slowest_mutex)
+#endif
+
+static struct {
+    int64_t start;              ///< Timestamp of the last scan start.
+    int64_t end;                ///< Timestamp of the last scan end, 0 while the first scan runs.
+    int64_t wall_nsec;
+    int64_t cpu_nsec;
+    int running;
+} scan_info;
+
+static const char *COUNTER_NAMES[FIM_STATS_COUNTERS] = {
+    [FIM_STATS_FILES] = "files",
+    [FIM_STATS_HASHED_FILES] = "hashed_files",
+    [FIM_STATS_HASHED_BYTES] = "hashed_bytes",
+    [FIM_STATS_STAT_TIME] = "stat_time",
+    [FIM_STATS_HASH_TIME] = "hash_time",
+    [FIM_STATS_DB_TIME] = "db_time",
+    [FIM_STATS_SKIPPED_IGNORE] = "ignore",
+    [FIM_STATS_SKIPPED_RESTRICT] = "restrict",
+    [FIM_STATS_SKIPPED_DEPTH] = "depth",
+};
+
+int64_t fim_scan_stats_clock() {
+    struct timespec ts = { 0, 0 };
+
+    gettime(&ts);
+    return (int64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+void fim_scan_stats_add(fim_scan_stats_t *stats, fim_scan_counter_t counter, uint64_t value) {
+    if (stats != NULL) {
+        stats_add(&stats->counters[counter], value);
+    }
+}
+
+void fim_scan_stats_add_time(fim_scan_stats_t *stats, fim_scan_counter_t counter, int64_t since) {
+    if (stats != NULL) {
+        const int64_t elapsed = fim_scan_stats_clock() - since;
+
+        stats_add(&stats->counters[counter], elapsed > 0 ? (uint64_t)elapsed : 0);
+    }
+}
+
+void fim_scan_stats_hashed(fim_scan_stats_t *stats, const char *path, size_t bytes, int64_t nsec) {
+    char *copy = NULL;
+    char *evicted = NULL;
+    int i;
+
+    if (stats == NULL) {
+        return;
+    }
+
+    stats_add(&stats->counters[FIM_STATS_HASHED_FILES], 1);
+    stats_add(&stats->counters[FIM_STATS_HASHED_BYTES], bytes);
+    stats_add(&stats->counters[FIM_STATS_HASH_TIME], nsec > 0 ? (uint64_t)nsec : 0);
+
+    // Most files are faster than the slowest ones, they are discarded without taking the lock.
+    if (nsec <= stats_load(&stats->slowest[FIM_SCAN_STATS_SLOWEST - 1].nsec)) {
+        return;
+    }
+
+    os_strdup(path, copy);
+    slowest_lock(stats);
+
+    if (nsec > stats->slowest[FIM_SCAN_STATS_SLOWEST - 1].nsec) {
+        evicted = stats->slowest[FIM_SCAN_STATS_SLOWEST - 1].path;
+
+        for (i = FIM_SCAN_STATS_SLOWEST - 1; i > 0 && stats->slowest[i - 1].nsec < nsec; i--) {
+            stats->slowest[i].path = stats->slowest[i - 1].path;
+            stats_store(&stats->slowest[i].nsec, stats->slowest[i - 1].nsec);
+        }
+
+        stats->slowest[i].path = copy;
+        stats_store(&stats->slowest[i].nsec, nsec);
+    } else {
+        evicted = copy;
+    }
+
+    slowest_unlock(stats);
+    os_free(evicted);
+}
+
+void fim_scan_stats_reset(fim_scan_stats_t *stats) {
+    int i;
+
+    if (stats == NULL) {
+        return;
+    }
+
+    for (i = 0; i < FIM_STATS_COUNTERS; i++) {
+        stats_store(&stats->counters[i], 0);
+    }
+
+    slowest_lock(stats);
+
+    for (i = 0; i < FIM_SCAN_STATS_SLOWEST; i++) {
+        os_free(stats->slowest[i].path);
+        stats_store(&stats->slowest[i].nsec, 0);
+    }
+
+    slowest_unlock(stats);
+}
+
+void fim_scan_stats_start() {
+    OSListNode *node_it;
+
+    OSList_foreach(node_it, syscheck.directories) {
+        fim_scan_stats_reset(((directory_t *)node_it->data)->stats);
+    }
+
+    stats_store(&scan_info.start, (int64_t)time(NULL));
+    stats_store(&scan_info.running, 1);
+}
+
+void fim_scan_stats_end(int64_t wall_nsec, int64_t cpu_nsec) {
+    stats_store(&scan_info.wall_nsec, wall_nsec);
+    stats_store(&scan_info.cpu_nsec, cpu_nsec);
+    stats_store(&scan_info.end, (int64_t)time(NULL));
+    stats_store(&scan_info.running, 0);
+}
+
+static cJSON *fim_scan_stats_directory_json(const directory_t *dir) {
+    cJSON *json = cJSON_CreateObject();
+    cJSON *skipped = cJSON_CreateObject();
+    cJSON *slowest = cJSON_CreateArray();
+    fim_scan_stats_t *stats = dir->stats;
+    int i;
+
+    cJSON_AddStringToObject(json, "path", dir->path);
+
+    for (i = 0; i < FIM_STATS_COUNTERS; i++) {
+        const double value = (double)stats_load(&stats->counters[i]);
+
+        switch (i) {
+        case FIM_STATS_STAT_TIME:
+        case FIM_STATS_HASH_TIME:
+        case FIM_STATS_DB_TIME:
+            cJSON_AddNumberToObject(json, COUNTER_NAMES[i], value / NSEC_PER_SEC);
+            break;
+
+        case FIM_STATS_SKIPPED_IGNORE:
+        case FIM_STATS_SKIPPED_RESTRICT:
+        case FIM_STATS_SKIPPED_DEPTH:
+            cJSON_AddNumberToObject(skipped, COUNTER_NAMES[i], value);
+            break;
+
+        default:
+            cJSON_AddNumberToObject(json, COUNTER_NAMES[i], value);
+        }
+    }
+
+    cJSON_AddItemToObject(json, "skipped", skipped);
+
+    slowest_lock(stats);
+
+    for (i = 0; i < FIM_SCAN_STATS_SLOWEST && stats->slowest[i].path != NULL; i++) {
+        cJSON *file = cJSON_CreateObject();
+
+        cJSON_AddStringToObject(file, "path", stats->slowest[i].path);
+        cJSON_AddNumberToObject(file, "hash_time", (double)stats->slowest[i].nsec / NSEC_PER_SEC);
+        cJSON_AddItemToArray(slowest, file);
+    }
+
+    slowest_unlock(stats);
+
+    cJSON_AddItemToObject(json, "slowest", slowest);
+
+    return json;
+}
+
+cJSON *fim_scan_stats_json() {
+    cJSON *json = cJSON_CreateObject();
+    cJSON *scan = cJSON_CreateObject();
+    cJSON *directories = cJSON_CreateArray();
+    OSListNode *node_it;
+
+    cJSON_AddBoolToObject(scan, "running", stats_load(&scan_info.running));
+    cJSON_AddNumberToObject(scan, "start", (double)stats_load(&scan_info.start));
+    cJSON_AddNumberToObject(scan, "end", (double)stats_load(&scan_info.end));
+    cJSON_AddNumberToObject(scan, "wall_time", (double)stats_load(&scan_info.wall_nsec) / NSEC_PER_SEC);
+    cJSON_AddNumberToObject(scan, "cpu_time", (double)stats_load(&scan_info.cpu_nsec) / NSEC_PER_SEC);
+    cJSON_AddItemToObject(json, "scan", scan);
+
+    w_rwlock_rdlock(&syscheck.directories_lock);
+
+    OSList_foreach(node_it, syscheck.directories) {
+        const directory_t *dir = node_it->data;
+
+        if (dir->stats != NULL) {
+            cJSON_AddItemToArray(directories, fim_scan_stats_directory_json(dir));
+        }
+    }
+
+    w_rwlock_unlock(&syscheck.directories_lock);
+
+    cJSON_AddItemToObject(json, "directories", directories);
+
+    return json;
+}
@@ -57,6 +57,9 @@ void read_internal(int debug_level)
 
 #ifndef WIN32
     syscheck.max_audit_entries = getDefine_Int("syscheck", "max_audit_entries", 1, 4096);
+    syscheck.rt_coalesce_window = getDefine_Int("syscheck", "rt_coalesce_window", 0, 10000);
+    syscheck.rt_coalesce_max = getDefine_Int("syscheck", "rt_coalesce_max", 1, 1000000);
+    syscheck.rt_fanotify = getDefine_Int("syscheck", "rt_fanotify", 0, 1);
 #endif
     sys_debug_level = getDefine_Int("syscheck", "debug", 0, 2);
 
@@ -111,6 +114,21 @@ void fim_initialize() {
         merror_exit("Unable to initialize database.");
     }
 
+    // Only a memory database is lost on restart. The snapshot is loaded before the inode index is built.
+    if (syscheck.database_store == FIM_DB_MEMORY && syscheck.memory_snapshot && IsFile(FIM_DB_SNAPSHOT_PATH) == 0) {
+        if (fim_db_snapshot_restore(FIM_DB_SNAPSHOT_PATH) == FIMDB_OK) {
+            syscheck.snapshot_restored = 1;
+            mdebug1(FIM_SNAPSHOT_RESTORED, FIM_DB_SNAPSHOT_PATH);
+        } else {
+            mdebug1(FIM_SNAPSHOT_INVALID, FIM_DB_SNAPSHOT_PATH);
+        }
+    }
+
+    // Loaded before any thread uses the database, so it doesn't miss any change.
+    if (syscheck.inode_index && fim_db_file_inode_index_init() != FIMDB_OK) {
+        merror("Unable to build the inode index, inode lookups will query the database.");
+    }
+
     w_rwlock_init(&syscheck.directories_lock, NULL);
     w_mutex_init(&syscheck.fim_scan_mutex, NULL);
     w_mutex_init(&syscheck.fim_realtime_mutex, NULL);
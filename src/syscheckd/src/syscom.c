@@ -74,6 +74,19 @@ error:
     return strlen(*output);
 }
 
+size_t syscom_getstats(char ** output) {
+    assert(output != NULL);
+
+    cJSON *stats = fim_scan_stats_json();
+    char *json_str = cJSON_PrintUnformatted(stats);
+
+    os_strdup("ok", *output);
+    wm_strcat(output, json_str, ' ');
+    free(json_str);
+    cJSON_Delete(stats);
+    return strlen(*output);
+}
+
 size_t syscom_dispatch(char * command, char ** output){
     assert(command != NULL);
     assert(output != NULL);
@@ -87,6 +100,8 @@ size_t syscom_dispatch(char * command, char ** output){
         return 0;
     } else if (strncmp(command, HC_SK, strlen(HC_SK)) == 0 ||
                strncmp(command, HC_GETCONFIG, strlen(HC_GETCONFIG)) == 0 ||
+               strncmp(command, HC_GETSTATS, strlen(HC_GETSTATS)) == 0 ||
+               strncmp(command, HC_GETMETRICS, strlen(HC_GETMETRICS)) == 0 ||
                strncmp(command, HC_RESTART, strlen(HC_RESTART)) == 0) {
         char *rcv_comm = NULL;
         char *rcv_args = NULL;
@@ -110,6 +125,10 @@ size_t syscom_dispatch(char * command, char ** output){
                 return strlen(*output);
             }
             return syscom_getconfig(rcv_args, output);
+        } else if (strcmp(rcv_comm, "getstats") == 0) {
+            return syscom_getstats(output);
+        } else if (strcmp(rcv_comm, HC_GETMETRICS) == 0) {
+            return w_metrics_getmetrics(rcv_args, output);
         } else if (strcmp(rcv_comm, "restart") == 0) {
             os_set_restart_syscheck();
             return 0;
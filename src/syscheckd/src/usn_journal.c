@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include "shared.h"
+#include "hash_op.h"
+#include "syscheck.h"
+
+#ifdef WIN32
+
+#include <winioctl.h>
+
+#ifdef WAZUH_UNIT_TESTING
+// Remove static qualifier when unit testing
+#define STATIC
+#else
+#define STATIC static
+#endif
+
+#define USN_READ_BUFFER_SIZE (64 * 1024)
+#define USN_VOLUMES ('z' - 'a' + 1)
+#define USN_NEW_NAME_REASONS (USN_REASON_FILE_CREATE | USN_REASON_RENAME_NEW_NAME)
+
+typedef struct fim_usn_volume_s {
+    HANDLE handle;          ///< Handle of the volume, INVALID_HANDLE_VALUE if it isn't tracked.
+    DWORDLONG journal_id;   ///< Identifier of the journal instance the position belongs to.
+    USN next_usn;           ///< First record not checked yet.
+} fim_usn_volume_t;
+
+STATIC fim_usn_volume_t usn_volumes[USN_VOLUMES];
+STATIC bool usn_initialized = false;
+STATIC bool usn_tracking = false;
+
+/**
+ * @brief Get the volume of a monitored path.
+ *
+ * @param path Lowercase path, as stored in the configuration.
+ * @return Index of the volume in usn_volumes, -1 if the path isn't on a lettered volume.
+ */
+STATIC int fim_usn_volume_index(const char *path) {
+    if (path == NULL || path[0] < 'a' || path[0] > 'z' || path[1] != ':') {
+        return -1;
+    }
+
+    return path[0] - 'a';
+}
+
+/**
+ * @brief Open a volume and read the current state of its journal.
+ *
+ * @param index Index of the volume.
+ * @param journal Journal state read.
+ * @return 0 on success, -1 on error.
+ */
+STATIC int fim_usn_query(int index, USN_JOURNAL_DATA *journal) {
+    fim_usn_volume_t *volume = &usn_volumes[index];
+    char volume_path[8];
+    DWORD bytes;
+
+    snprintf(volume_path, sizeof(volume_path), "\\\\.\\%c:", 'a' + index);
+
+    if (volume->handle == INVALID_HANDLE_VALUE) {
+        volume->handle = CreateFile(volume_path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                                    OPEN_EXISTING, 0, NULL);
+
+        if (volume->handle == INVALID_HANDLE_VALUE) {
+            mdebug1(FIM_USN_UNAVAILABLE, volume_path, GetLastError());
+            return -1;
+        }
+    }
+
+    if (!DeviceIoControl(volume->handle, FSCTL_QUERY_USN_JOURNAL, NULL, 0, journal, sizeof(*journal), &bytes, NULL)) {
+        // Volumes without a journal (FAT, disabled journal) can't be tracked.
+        mdebug1(FIM_USN_UNAVAILABLE, volume_path, GetLastError());
+        CloseHandle(volume->handle);
+        volume->handle = INVALID_HANDLE_VALUE;
+        return -1;
+    }
+
+    return 0;
+}
+
+int fim_usn_checkpoint() {
+    bool needed[USN_VOLUMES] = { false };
+    USN_JOURNAL_DATA journal;
+    OSListNode *node_it;
+    int index;
+
+    if (!usn_initialized) {
+        for (index = 0; index < USN_VOLUMES; index++) {
+            usn_volumes[index].handle = INVALID_HANDLE_VALUE;
+        }
+        usn_initialized = true;
+    }
+
+    usn_tracking = false;
+
+    w_rwlock_rdlock(&syscheck.directories_lock);
+    OSList_foreach(node_it, syscheck.directories) {
+        directory_t *dir_it = node_it->data;
+
+        // Network shares and volumes mounted in folders aren't replayed.
+        if (index = fim_usn_volume_index(dir_it->path), index < 0) {
+            mdebug1(FIM_USN_UNAVAILABLE, dir_it->path, 0ul);
+            w_rwlock_unlock(&syscheck.directories_lock);
+            return -1;
+        }
+
+        needed[index] = true;
+    }
+    w_rwlock_unlock(&syscheck.directories_lock);
+
+    for (index = 0; index < USN_VOLUMES; index++) {
+        if (!needed[index]) {
+            if (usn_volumes[index].handle != INVALID_HANDLE_VALUE) {
+                CloseHandle(usn_volumes[index].handle);
+                usn_volumes[index].handle = INVALID_HANDLE_VALUE;
+            }
+            continue;
+        }
+
+        if (fim_usn_query(index, &journal) != 0) {
+            return -1;
+        }
+
+        usn_volumes[index].journal_id = journal.UsnJournalID;
+        usn_volumes[index].next_usn = journal.NextUsn;
+    }
+
+    usn_tracking = true;
+    return 0;
+}
+
+/**
+ * @brief Get the path of the directory holding a journaled entry.
+ *
+ * The directories are cached by file reference number, most changes happen on a handful of them.
+ *
+ * @param volume Volume of the entry.
+ * @param parent File reference number of the directory.
+ * @param directories Cache of the directories resolved in this scan.
+ * @return Path of the directory, NULL if it doesn't exist anymore. It belongs to the cache.
+ */
+STATIC const char *fim_usn_parent_path(fim_usn_volume_t *volume, DWORDLONG parent, OSHash *directories) {
+    FILE_ID_DESCRIPTOR descriptor = { .dwSize = sizeof(FILE_ID_DESCRIPTOR), .Type = FileIdType };
+    char key[OS_SIZE_32];
+    char path[MAX_PATH + 5];
+    char *cached;
+    HANDLE handle;
+    DWORD length;
+
+    snprintf(key, sizeof(key), "%llx", (unsigned long long)parent);
+
+    if (cached = OSHash_Get(directories, key), cached) {
+        return cached;
+    }
+
+    descriptor.FileId.QuadPart = parent;
+    handle = OpenFileById(volume->handle, &descriptor, 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                          NULL, FILE_FLAG_BACKUP_SEMANTICS);
+
+    if (handle == INVALID_HANDLE_VALUE) {
+        return NULL;
+    }
+
+    length = GetFinalPathNameByHandle(handle, path, sizeof(path), FILE_NAME_NORMALIZED | VOLUME_NAME_DOS);
+    CloseHandle(handle);
+
+    if (length == 0 || length >= sizeof(path)) {
+        return NULL;
+    }
+
+    // Skip the "\\?\" prefix of the final path.
+    os_strdup(strncmp(path, "\\\\?\\", 4) == 0 ? path + 4 : path, cached);
+    str_lowercase(cached);
+
+    if (OSHash_Add(directories, key, cached) != 2) {
+        os_free(cached);
+        return NULL;
+    }
+
+    return cached;
+}
+
+/**
+ * @brief Read the records of a volume journal since its checkpoint, collecting the monitored paths changed.
+ *
+ * @param index Index of the volume.
+ * @param changes Changed paths, with the reasons of their records.
+ * @param directories Cache of the directories resolved in this scan.
+ * @return 0 on success, -1 if the journal can't be replayed.
+ */
+STATIC int fim_usn_read_volume(int index, OSHash *changes, OSHash *directories) {
+    fim_usn_volume_t *volume = &usn_volumes[index];
+    USN_JOURNAL_DATA journal;
+    READ_USN_JOURNAL_DATA request = { .ReasonMask = 0xFFFFFFFF, .ReturnOnlyOnClose = FALSE };
+    char name[MAX_PATH];
+    char path[MAX_PATH];
+    BYTE *buffer;
+    DWORD bytes;
+
+    // The journal can be deleted, recreated or wrap over the unread records between scans.
+    if (fim_usn_query(index, &journal) != 0 || journal.UsnJournalID != volume->journal_id ||
+        journal.FirstUsn > volume->next_usn) {
+        mdebug1(FIM_USN_RESET, 'a' + index);
+        return -1;
+    }
+
+    request.UsnJournalID = volume->journal_id;
+    os_malloc(USN_READ_BUFFER_SIZE, buffer);
+
+    while (volume->next_usn < journal.NextUsn) {
+        request.StartUsn = volume->next_usn;
+
+        if (!DeviceIoControl(volume->handle, FSCTL_READ_USN_JOURNAL, &request, sizeof(request), buffer,
+                             USN_READ_BUFFER_SIZE, &bytes, NULL)) {
+            mdebug1(FIM_USN_RESET, 'a' + index);
+            os_free(buffer);
+            return -1;
+        }
+
+        if (bytes <= sizeof(USN)) {
+            break;
+        }
+
+        // The output starts with the position following the last record returned.
+        volume->next_usn = *(USN *)buffer;
+
+        for (DWORD offset = sizeof(USN); offset < bytes;) {
+            const USN_RECORD *record = (const USN_RECORD *)(buffer + offset);
+            const char *parent;
+            DWORD *reasons;
+            int length;
+
+            if (record->RecordLength == 0) {
+                break;
+            }
+            offset += record->RecordLength;
+
+            if (record->MajorVersion != 2) {
+                continue;
+            }
+
+            if (parent = fim_usn_parent_path(volume, record->ParentFileReferenceNumber, directories), !parent) {
+                // The whole directory is gone, its own deletion is journaled too.
+                continue;
+            }
+
+            length = WideCharToMultiByte(CP_ACP, 0, (LPCWSTR)((const BYTE *)record + record->FileNameOffset),
+                                         record->FileNameLength / sizeof(WCHAR), name, sizeof(name) - 1, NULL, NULL);
+            name[length] = '\0';
+
+            if (snprintf(path, sizeof(path), "%s%s%s", parent, parent[strlen(parent) - 1] == PATH_SEP ? "" : "\\",
+                         name) >= (int)sizeof(path)) {
+                continue;
+            }
+            str_lowercase(path);
+
+            if (reasons = OSHash_Get(changes, path), reasons) {
+                *reasons |= record->Reason;
+            } else if (fim_configuration_directory(path) != NULL) {
+                os_malloc(sizeof(DWORD), reasons);
+                *reasons = record->Reason;
+
+                if (OSHash_Add(changes, path, reasons) != 2) {
+                    os_free(reasons);
+                }
+            }
+        }
+    }
+
+    os_free(buffer);
+    return 0;
+}
+
+int fim_usn_scan() {
+    OSHash *changes = NULL;
+    OSHash *directories = NULL;
+    OSHashNode *node;
+#ifdef WIN_WHODATA
+    OSListNode *list_it;
+#endif
+    unsigned int i;
+    int ret = -1;
+
+    if (!usn_tracking) {
+        return -1;
+    }
+
+    // The checkpoint is taken again by the full scan run when any journal can't be replayed.
+    usn_tracking = false;
+
+    if (changes = OSHash_Create(), !changes) {
+        goto end;
+    }
+    if (directories = OSHash_Create(), !directories) {
+        goto end;
+    }
+    OSHash_SetFreeDataPointer(changes, free);
+    OSHash_SetFreeDataPointer(directories, free);
+
+    w_rwlock_rdlock(&syscheck.directories_lock);
+    for (int index = 0; index < USN_VOLUMES; index++) {
+        if (usn_volumes[index].handle == INVALID_HANDLE_VALUE) {
+            continue;
+        }
+
+        if (fim_usn_read_volume(index, changes, directories) != 0) {
+            w_rwlock_unlock(&syscheck.directories_lock);
+            goto end;
+        }
+    }
+    w_rwlock_unlock(&syscheck.directories_lock);
+
+    mdebug2(FIM_USN_SCAN, OSHash_Get_Elem_ex(changes));
+
+    fim_diff_folder_size();
+    syscheck.disk_quota_full_msg = true;
+
+    w_mutex_lock(&syscheck.fim_scan_mutex);
+    w_rwlock_rdlock(&syscheck.directories_lock);
+    fim_scan_stats_start();
+
+    for (node = OSHash_Begin(changes, &i); node; node = OSHash_Next(changes, &i, node)) {
+        fim_journal_event(node->key, (*(DWORD *)node->data & USN_NEW_NAME_REASONS) != 0);
+    }
+
+#ifdef WIN_WHODATA
+    // Verify the directories are being monitored correctly, as the full scan does
+    OSList_foreach(list_it, syscheck.directories) {
+        directory_t *dir_it = list_it->data;
+
+        if (FIM_MODE(dir_it->options) == FIM_WHODATA) {
+            char *path = fim_get_real_path(dir_it);
+
+            realtime_adddir(path, dir_it);
+            os_free(path);
+        }
+    }
+#endif
+
+    w_rwlock_unlock(&syscheck.directories_lock);
+    w_mutex_unlock(&syscheck.fim_scan_mutex);
+
+    usn_tracking = true;
+    ret = 0;
+
+end:
+    if (changes) {
+        OSHash_Free(changes);
+    }
+    if (directories) {
+        OSHash_Free(directories);
+    }
+    return ret;
+}
+
+#endif /* WIN32 */
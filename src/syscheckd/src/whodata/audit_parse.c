@@ -19,221 +19,241 @@
 #define STATIC
 #endif
 
-static regex_t regexCompiled_uid;
-static regex_t regexCompiled_pid;
-static regex_t regexCompiled_ppid;
-static regex_t regexCompiled_gid;
-static regex_t regexCompiled_auid;
-static regex_t regexCompiled_euid;
-
-static regex_t regexCompiled_cwd;
-static regex_t regexCompiled_pname;
-static regex_t regexCompiled_path0;
-static regex_t regexCompiled_path1;
-static regex_t regexCompiled_path2;
-static regex_t regexCompiled_path3;
-static regex_t regexCompiled_path4;
-
-static regex_t regexCompiled_cwd_hex;
-static regex_t regexCompiled_pname_hex;
-static regex_t regexCompiled_path0_hex;
-static regex_t regexCompiled_path1_hex;
-static regex_t regexCompiled_path2_hex;
-static regex_t regexCompiled_path3_hex;
-static regex_t regexCompiled_path4_hex;
-
-static regex_t regexCompiled_items;
-static regex_t regexCompiled_inode;
-static regex_t regexCompiled_dir;
-static regex_t regexCompiled_dir_hex;
-static regex_t regexCompiled_syscall;
-static regex_t regexCompiled_dev;
-
-// Initialize regular expressions
-int init_regex(void) {
-
-    static const char *pattern_uid = " uid=([0-9]*) ";
-    if (regcomp(&regexCompiled_uid, pattern_uid, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "uid"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_gid = " gid=([0-9]*) ";
-    if (regcomp(&regexCompiled_gid, pattern_gid, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "gid"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_auid = " auid=([0-9]*) ";
-    if (regcomp(&regexCompiled_auid, pattern_auid, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "auid"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_euid = " euid=([0-9]*) ";
-    if (regcomp(&regexCompiled_euid, pattern_euid, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "euid"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_pid = " pid=([0-9]*) ";
-    if (regcomp(&regexCompiled_pid, pattern_pid, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "pid"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_ppid = " ppid=([0-9]*) ";
-    if (regcomp(&regexCompiled_ppid, pattern_ppid, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "ppid"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_inode = " item=[0-9] name=.* inode=([0-9]*)";
-    if (regcomp(&regexCompiled_inode, pattern_inode, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "inode"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+#define AUDIT_SEPARATORS    " \n\035"
+#define AUDIT_HEX_DIGITS    "0123456789ABCDEFabcdef"
+
+// Arguments of the FIM_AUDIT_EVENT messages
+#define AUDIT_EVENT_ARGS(w_evt, path) \
+    (w_evt)->user_name ? (w_evt)->user_name : "", (w_evt)->audit_name ? (w_evt)->audit_name : "", \
+    (w_evt)->effective_name ? (w_evt)->effective_name : "", (w_evt)->group_name ? (w_evt)->group_name : "", \
+    (w_evt)->process_id, (w_evt)->ppid, (w_evt)->inode ? (w_evt)->inode : "", (path) ? (path) : "", \
+    (w_evt)->process_name ? (w_evt)->process_name : ""
+
+typedef enum audit_field_kind {
+    AUDIT_FIELD_NUMBER,     // Digits followed by a space
+    AUDIT_FIELD_DIGITS,     // Digits
+    AUDIT_FIELD_TEXT,       // Quoted, or hex encoded
+    AUDIT_FIELD_DEVICE      // major:minor, in hex
+} audit_field_kind;
+
+static const struct {
+    const char *key;
+    size_t offset;
+    audit_field_kind kind;
+} AUDIT_FIELDS[] = {
+    { "items", offsetof(audit_fields_t, items), AUDIT_FIELD_NUMBER },
+    { "uid", offsetof(audit_fields_t, uid), AUDIT_FIELD_NUMBER },
+    { "gid", offsetof(audit_fields_t, gid), AUDIT_FIELD_NUMBER },
+    { "auid", offsetof(audit_fields_t, auid), AUDIT_FIELD_NUMBER },
+    { "euid", offsetof(audit_fields_t, euid), AUDIT_FIELD_NUMBER },
+    { "pid", offsetof(audit_fields_t, pid), AUDIT_FIELD_NUMBER },
+    { "ppid", offsetof(audit_fields_t, ppid), AUDIT_FIELD_NUMBER },
+    { "syscall", offsetof(audit_fields_t, syscall), AUDIT_FIELD_DIGITS },
+    { "exe", offsetof(audit_fields_t, exe), AUDIT_FIELD_TEXT },
+    { "cwd", offsetof(audit_fields_t, cwd), AUDIT_FIELD_TEXT },
+    { "dir", offsetof(audit_fields_t, dir), AUDIT_FIELD_TEXT },
+    { "dev", offsetof(audit_fields_t, dev), AUDIT_FIELD_DEVICE },
+};
 
-    static const char *pattern_items = " items=([0-9]*) ";
-    if (regcomp(&regexCompiled_items, pattern_items, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "items"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+/**
+ * @brief Reads the value of a field, following the rules of its kind.
+ *
+ * @param value Start of the value, right after the equal sign.
+ * @param kind Kind of the field.
+ * @param [out] field Value of the field.
+ * @return 1 if the value is valid for the kind, 0 otherwise.
+ */
+static int audit_read_value(const char *value, audit_field_kind kind, audit_field_t *field) {
+    size_t length;
 
-    static const char *pattern_syscall = " syscall=([0-9]*)";
-    if (regcomp(&regexCompiled_syscall, pattern_syscall, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "syscall"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+    switch (kind) {
+    case AUDIT_FIELD_NUMBER:
+        length = strspn(value, "0123456789");
 
-    static const char *pattern_pname = " exe=\"([^ ]*)\"";
-    if (regcomp(&regexCompiled_pname, pattern_pname, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "pname"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_cwd = " cwd=\"([^ ]*)\"";
-    if (regcomp(&regexCompiled_cwd, pattern_cwd, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "cwd"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+        if (value[length] != ' ') {
+            return 0;
+        }
 
-    static const char *pattern_dir = " dir=\"([^ ]*)\"";
-    if (regcomp(&regexCompiled_dir, pattern_dir, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "dir"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+        break;
 
-    static const char *pattern_path0 = " item=0 name=\"([^ ]*)\"";
-    if (regcomp(&regexCompiled_path0, pattern_path0, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path0"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_path1 = " item=1 name=\"([^ ]*)\"";
-    if (regcomp(&regexCompiled_path1, pattern_path1, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path1"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_path2 = " item=2 name=\"([^ ]*)\"";
-    if (regcomp(&regexCompiled_path2, pattern_path2, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path2"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_path3 = " item=3 name=\"([^ ]*)\"";
-    if (regcomp(&regexCompiled_path3, pattern_path3, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path3"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
-    static const char *pattern_path4 = " item=4 name=\"([^ ]*)\"";
-    if (regcomp(&regexCompiled_path4, pattern_path4, REG_EXTENDED)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path4"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+    case AUDIT_FIELD_DIGITS:
+        length = strspn(value, "0123456789");
+        break;
 
-    static const char *pattern_pname_hex = " exe=([A-F0-9]*)";
-    if (regcomp(&regexCompiled_pname_hex, pattern_pname_hex, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "pname_hex"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+    case AUDIT_FIELD_TEXT:
+        if (*value == '"') {
+            length = strcspn(value + 1, "\"" AUDIT_SEPARATORS);
 
-    static const char *pattern_cwd_hex = " cwd=([A-F0-9]*)";
-    if (regcomp(&regexCompiled_cwd_hex, pattern_cwd_hex, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "cwd_hex"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+            if (value[length + 1] == '"') {
+                field->value = value + 1;
+                field->length = length;
+                field->hex = 0;
+                return 1;
+            }
 
-    static const char *pattern_dir_hex = " dir=([A-F0-9]*)";
-    if (regcomp(&regexCompiled_dir_hex, pattern_dir_hex, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "dir_hex"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
-    }
+            // A quoted value can't hold spaces, audit encodes those in hex
+            length = 0;
+        } else {
+            length = strspn(value, AUDIT_HEX_DIGITS);
+        }
+
+        field->value = value;
+        field->length = length;
+        field->hex = 1;
+        return 1;
+
+    case AUDIT_FIELD_DEVICE:
+        length = strspn(value, AUDIT_HEX_DIGITS);
+
+        if (value[length] != ':') {
+            return 0;
+        }
 
-    static const char *pattern_path0_hex = " item=0 name=([A-F0-9]*)";
-    if (regcomp(&regexCompiled_path0_hex, pattern_path0_hex, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path0_hex"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
+        length += 1 + strspn(value + length + 1, AUDIT_HEX_DIGITS);
+        break;
+
+    default:
+        return 0; // LCOV_EXCL_LINE
     }
 
-    static const char *pattern_path1_hex = " item=1 name=([A-F0-9]*)";
-    if (regcomp(&regexCompiled_path1_hex, pattern_path1_hex, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path1_hex"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
+    field->value = value;
+    field->length = length;
+    field->hex = 0;
+    return 1;
+}
+
+/**
+ * @brief Finds the fields of an audit event, without copying them.
+ * @details The first valid occurrence of every field is kept, but for the inode that is taken from the last PATH
+ * record. The name of a PATH record is kept only when it directly follows its item number.
+ *
+ * @param event Audit event, made of one record per line.
+ * @param [out] fields Fields found in the event.
+ */
+STATIC void audit_scan_fields(const char *event, audit_fields_t *fields) {
+    const char *item_end = NULL;
+    const char *it = event;
+    int item = -1;
+    int path_found = 0;
+    size_t i;
+
+    memset(fields, 0, sizeof(audit_fields_t));
+
+    while (it += strspn(it, AUDIT_SEPARATORS), *it != '\0') {
+        const char *key = it;
+        const size_t key_length = strcspn(it, "=" AUDIT_SEPARATORS);
+        const char *value = key + key_length + 1;
+        audit_field_t field;
+
+        it += key_length;
+
+        if (*it != '=') {
+            item = -1;
+            continue;
+        }
+
+        if (key_length == 4 && memcmp(key, "item", 4) == 0) {
+            // "item=N name=..."
+            item = (isdigit((unsigned char)value[0]) && value[1] == ' ') ? value[0] - '0' : -1;
+            item_end = value + 1;
+        } else if (key_length == 4 && memcmp(key, "name", 4) == 0) {
+            if (item >= 0 && key == item_end + 1) {
+                path_found = 1;
+
+                if (item < AUDIT_MAX_ITEMS && fields->name[item].value == NULL) {
+                    audit_read_value(value, AUDIT_FIELD_TEXT, &fields->name[item]);
+                }
+            }
+
+            item = -1;
+        } else if (key_length == 5 && memcmp(key, "inode", 5) == 0) {
+            if (path_found) {
+                audit_read_value(value, AUDIT_FIELD_DIGITS, &fields->inode);
+            }
+
+            item = -1;
+        } else {
+            for (i = 0; i < sizeof(AUDIT_FIELDS) / sizeof(AUDIT_FIELDS[0]); i++) {
+                audit_field_t *target = (audit_field_t *)((char *)fields + AUDIT_FIELDS[i].offset);
+
+                if (strlen(AUDIT_FIELDS[i].key) == key_length && memcmp(key, AUDIT_FIELDS[i].key, key_length) == 0) {
+                    if (target->value == NULL && audit_read_value(value, AUDIT_FIELDS[i].kind, &field)) {
+                        *target = field;
+                    }
+
+                    break;
+                }
+            }
+
+            item = -1;
+        }
+
+        // Quoted values hold no separators
+        it += strcspn(it, AUDIT_SEPARATORS);
     }
+}
 
-    static const char *pattern_path2_hex = " item=2 name=([A-F0-9]*)";
-    if (regcomp(&regexCompiled_path2_hex, pattern_path2_hex, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path2_hex"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
+/**
+ * @brief Copies the value of a field into a buffer, decoding it when it is hex encoded.
+ *
+ * @param field Field to copy.
+ * @param [out] output Buffer to copy the value to, truncated when it doesn't fit.
+ * @param size Size of the buffer.
+ * @return The buffer, NULL if the field wasn't found or its hex encoding is broken.
+ */
+STATIC char *audit_field_str(const audit_field_t *field, char *output, size_t size) {
+    size_t length = 0;
+    size_t i;
+
+    if (field->value == NULL || size == 0) {
+        return NULL;
     }
 
-    static const char *pattern_path3_hex = " item=3 name=([A-F0-9]*)";
-    if (regcomp(&regexCompiled_path3_hex, pattern_path3_hex, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path3_hex"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
+    if (!field->hex) {
+        length = field->length < size - 1 ? field->length : size - 1;
+        memcpy(output, field->value, length);
+        output[length] = '\0';
+        return output;
     }
 
-    static const char *pattern_path4_hex = " item=4 name=([A-F0-9]*)";
-    if (regcomp(&regexCompiled_path4_hex, pattern_path4_hex, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "path4_hex"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
+    // Each character has two hex digits
+    if (field->length % 2 != 0) {
+        merror("Error found while decoding HEX bufer: '%.*s'", (int)field->length, field->value);
+        return NULL;
     }
-    static const char *pattern_dev = " dev=([A-F0-9]*:[A-F0-9]*)";
-    if (regcomp(&regexCompiled_dev, pattern_dev, REG_EXTENDED | REG_ICASE)) {
-        merror(FIM_ERROR_WHODATA_COMPILE_REGEX, "dev"); // LCOV_EXCL_LINE
-        return -1; // LCOV_EXCL_LINE
+
+    for (i = 0; i < field->length && length < size - 1; i += 2) {
+        const char high = field->value[i];
+        const char low = field->value[i + 1];
+
+        output[length++] = (char)(((isdigit((unsigned char)high) ? high - '0' : (toupper((unsigned char)high) - 'A' + 10)) << 4) |
+                                  (isdigit((unsigned char)low) ? low - '0' : (toupper((unsigned char)low) - 'A' + 10)));
     }
-    return 0;
+
+    output[length] = '\0';
+    return output;
 }
 
-void clean_regex() {
-    static int freed = 0;
+/**
+ * @brief Allocates a copy of the value of a field, decoded when it is hex encoded.
+ *
+ * @param field Field to copy.
+ * @return The value, NULL if the field wasn't found or its hex encoding is broken.
+ */
+static char *audit_field_dup(const audit_field_t *field) {
+    char *value;
 
-    if (freed) { // Prevent double free
-        return;
+    if (field->value == NULL) {
+        return NULL;
     }
 
-    regfree(&regexCompiled_uid);
-    regfree(&regexCompiled_gid);
-    regfree(&regexCompiled_auid);
-    regfree(&regexCompiled_euid);
-    regfree(&regexCompiled_pid);
-    regfree(&regexCompiled_ppid);
-    regfree(&regexCompiled_inode);
-    regfree(&regexCompiled_items);
-    regfree(&regexCompiled_syscall);
-    regfree(&regexCompiled_pname);
-    regfree(&regexCompiled_cwd);
-    regfree(&regexCompiled_dir);
-    regfree(&regexCompiled_path0);
-    regfree(&regexCompiled_path1);
-    regfree(&regexCompiled_path2);
-    regfree(&regexCompiled_path3);
-    regfree(&regexCompiled_path4);
-
-    regfree(&regexCompiled_pname_hex);
-    regfree(&regexCompiled_cwd_hex);
-    regfree(&regexCompiled_dir_hex);
-    regfree(&regexCompiled_path0_hex);
-    regfree(&regexCompiled_path1_hex);
-    regfree(&regexCompiled_path2_hex);
-    regfree(&regexCompiled_path3_hex);
-    regfree(&regexCompiled_path4_hex);
-    regfree(&regexCompiled_dev);
-
-    freed = 1;
+    os_malloc(field->length + 1, value);
+
+    if (audit_field_str(field, value, field->length + 1) == NULL) {
+        os_free(value);
+    }
+
+    return value;
 }
 
 /**
@@ -426,11 +446,9 @@ void get_parent_process_info(char *ppid, char **const parent_name, char **const
 
 
 // Extract id: node=... type=CWD msg=audit(1529332881.955:3867): cwd="..."
-char *audit_get_id(const char *event) {
-    char *begin;
-    char *end;
-    char *id;
-    size_t len;
+const char *audit_event_id(const char *event, size_t *length) {
+    const char *begin;
+    const char *end;
 
     if (begin = strstr(event, "msg=audit("), !begin) {
         return NULL;
@@ -442,7 +460,20 @@ char *audit_get_id(const char *event) {
         return NULL;
     }
 
-    len = end - begin;
+    *length = end - begin;
+    return begin;
+}
+
+
+char *audit_get_id(const char *event) {
+    const char *begin;
+    char *id;
+    size_t len;
+
+    if (begin = audit_event_id(event, &len), !begin) {
+        return NULL;
+    }
+
     os_malloc(len + 1, id);
     memcpy(id, begin, len);
     id[len] = '\0';
@@ -450,28 +481,285 @@ char *audit_get_id(const char *event) {
 }
 
 
-void audit_parse(char *buffer) {
+/**
+ * @brief Checks if a path is inside a monitored directory.
+ *
+ * @param path Path to check.
+ * @return 1 if a directory of the configuration holds the path, 0 otherwise.
+ */
+STATIC int audit_path_monitored(const char *path) {
+    directory_t *configuration;
+
+    w_rwlock_rdlock(&syscheck.directories_lock);
+    configuration = fim_configuration_directory(path);
+    w_rwlock_unlock(&syscheck.directories_lock);
+
+    return configuration != NULL;
+}
+
+
+/**
+ * @brief Builds the whodata event of a syscall, with the fields shared by all the paths it modifies.
+ *
+ * @param fields Fields of the audit event.
+ * @param cwd Working directory of the process.
+ * @return The whodata event.
+ */
+STATIC whodata_evt *audit_whodata_event(const audit_fields_t *fields, const char *cwd) {
     static int auid_err_reported = 0;
-    char *psuccess;
-    char *pconfig;
-    char *pdelete;
     char *endptr = NULL;
-    regmatch_t match[2];
-    int match_size;
-    char *path0 = NULL;
-    char *path1 = NULL;
-    char *path2 = NULL;
-    char *path3 = NULL;
-    char *path4 = NULL;
-    char *file_path = NULL;
-    char *dev = NULL;
     whodata_evt *w_evt;
+
+    os_calloc(1, sizeof(whodata_evt), w_evt);
+
+    // user_name & user_id
+    if (w_evt->user_id = audit_field_dup(&fields->uid), w_evt->user_id && w_evt->user_id[0] != '\0') {
+        errno = 0;
+        int user_id = strtol(w_evt->user_id, &endptr, 10);
+
+        if (errno != ERANGE && endptr != NULL && *endptr == '\0') {
+            w_evt->user_name = get_user(user_id);
+        }
+    }
+
+    // audit_name & audit_uid
+    if (fields->auid.value) {
+        if (fields->auid.length == 10 && strncmp(fields->auid.value, "4294967295", 10) == 0) { // Invalid auid (-1)
+            if (!auid_err_reported) {
+                mdebug1(FIM_AUDIT_INVALID_AUID);
+                auid_err_reported = 1;
+            }
+        } else if (w_evt->audit_uid = audit_field_dup(&fields->auid), w_evt->audit_uid[0] != '\0') {
+            errno = 0;
+            int audit_uid = strtol(w_evt->audit_uid, &endptr, 10);
+
+            if (errno != ERANGE && endptr != NULL && *endptr == '\0') {
+                w_evt->audit_name = get_user(audit_uid);
+            }
+        }
+    }
+
+    // effective_name && effective_uid
+    if (w_evt->effective_uid = audit_field_dup(&fields->euid), w_evt->effective_uid && w_evt->effective_uid[0] != '\0') {
+        errno = 0;
+        int euid = strtol(w_evt->effective_uid, &endptr, 10);
+
+        if (errno != ERANGE && endptr != NULL && *endptr == '\0') {
+            w_evt->effective_name = get_user(euid);
+        }
+    }
+
+    // group_name & group_id
+    if (w_evt->group_id = audit_field_dup(&fields->gid), w_evt->group_id && w_evt->group_id[0] != '\0') {
+        errno = 0;
+        int gid = strtol(w_evt->group_id, &endptr, 10);
+
+        if (errno != ERANGE && endptr != NULL && *endptr == '\0') {
+            w_evt->group_name = get_group(gid);
+        }
+    }
+
+    // process_id, the value is followed by a space
+    if (fields->pid.value) {
+        w_evt->process_id = strtol(fields->pid.value, NULL, 10);
+    }
+
+    // ppid
+    if (fields->ppid.value) {
+        char ppid[OS_SIZE_32];
+
+        audit_field_str(&fields->ppid, ppid, sizeof(ppid));
+        os_malloc(OS_FLSIZE, w_evt->parent_name);
+        os_malloc(OS_FLSIZE, w_evt->parent_cwd);
+        get_parent_process_info(ppid, &w_evt->parent_name, &w_evt->parent_cwd);
+
+        w_evt->ppid = strtol(ppid, NULL, 10);
+    }
+
+    // process_name
+    w_evt->process_name = audit_field_dup(&fields->exe);
+
+    os_strdup(cwd, w_evt->cwd);
+
+    // inode
+    w_evt->inode = audit_field_dup(&fields->inode);
+
+    // dev, major and minor numbers joined in hex
+    if (fields->dev.value) {
+        char dev[OS_SIZE_64];
+        char *minor;
+
+        audit_field_str(&fields->dev, dev, sizeof(dev));
+
+        if (minor = wstr_chr(dev, ':'), minor) {
+            memmove(minor, minor + 1, strlen(minor));
+
+            os_calloc(OS_SIZE_64, sizeof(char), w_evt->dev);
+            snprintf(w_evt->dev, OS_SIZE_64, "%ld", strtol(dev, NULL, 16));
+        }
+    }
+
+    return w_evt;
+}
+
+
+/**
+ * @brief Reports a path modified by a syscall, if it's monitored.
+ * @details The whodata event is built along with the first monitored path of the syscall.
+ *
+ * @param [in, out] w_evt Whodata event of the syscall, NULL until it is built.
+ * @param fields Fields of the audit event.
+ * @param cwd Working directory of the process.
+ * @param path Path to report, freed by this function.
+ * @param logged_path Path written to the log, the reported one if NULL.
+ * @param part 0 for the only path of the syscall, 1 or 2 for the source and the destination of a rename.
+ */
+STATIC void audit_report_path(whodata_evt **w_evt,
+                              const audit_fields_t *fields,
+                              const char *cwd,
+                              char *path,
+                              const char *logged_path,
+                              int part) {
+    if (!audit_path_monitored(path)) {
+        os_free(path);
+        return;
+    }
+
+    if (*w_evt == NULL) {
+        *w_evt = audit_whodata_event(fields, cwd);
+    }
+
+    (*w_evt)->path = path;
+    logged_path = logged_path ? logged_path : path;
+
+    switch (part) {
+    case 1:
+        mdebug2(FIM_AUDIT_EVENT1 AUDIT_EVENT_ARGS(*w_evt, logged_path));
+        break;
+    case 2:
+        mdebug2(FIM_AUDIT_EVENT2 AUDIT_EVENT_ARGS(*w_evt, logged_path));
+        break;
+    default:
+        mdebug2(FIM_AUDIT_EVENT AUDIT_EVENT_ARGS(*w_evt, logged_path));
+        break;
+    }
+
+    if ((*w_evt)->inode) {
+        fim_whodata_event(*w_evt);
+    }
+
+    os_free((*w_evt)->path);
+}
+
+
+/**
+ * @brief Generates the whodata events of a successful syscall.
+ * @details Paths are built from the event buffer first, the rest of the event is only copied for the paths
+ * that are monitored.
+ *
+ * @param fields Fields of the audit event.
+ */
+STATIC void audit_parse_syscall(const audit_fields_t *fields) {
+    char cwd_buffer[PATH_MAX];
+    char name_buffer[AUDIT_MAX_ITEMS][PATH_MAX];
+    char *name[AUDIT_MAX_ITEMS] = { NULL };
+    whodata_evt *w_evt = NULL;
+    char *file_path = NULL;
     unsigned int items = 0;
+    char *cwd;
+
+    // Items, the value is followed by a space
+    if (fields->items.value) {
+        items = strtol(fields->items.value, NULL, 10);
+    }
+
+    cwd = audit_field_str(&fields->cwd, cwd_buffer, sizeof(cwd_buffer));
+    name[0] = audit_field_str(&fields->name[0], name_buffer[0], PATH_MAX);
+    name[1] = audit_field_str(&fields->name[1], name_buffer[1], PATH_MAX);
+
+    // TODO: Verify all case events
+    // TODO: Should we consider the w_evt->path if !w_evt->inode?
+    switch (items) {
+
+    case 1:
+        if (cwd && name[0]) {
+            if (file_path = gen_audit_path(cwd, name[0], NULL), file_path) {
+                audit_report_path(&w_evt, fields, cwd, file_path, NULL, 0);
+            }
+        }
+        break;
+    case 2:
+        if (cwd && name[0] && name[1]) {
+            if (file_path = gen_audit_path(cwd, name[0], name[1]), file_path) {
+                char *real_path = realpath(file_path, NULL);
+
+                if (real_path == NULL) {
+                    os_strdup(file_path, real_path);
+                    mdebug1(FIM_CHECK_LINK_REALPATH, real_path); // LCOV_EXCL_LINE
+                }
+
+                audit_report_path(&w_evt, fields, cwd, real_path, file_path, 0);
+                free(file_path);
+            }
+        }
+        break;
+    case 3:
+        name[2] = audit_field_str(&fields->name[2], name_buffer[2], PATH_MAX);
+
+        if (cwd && name[1] && name[2]) {
+            if (file_path = gen_audit_path(cwd, name[1], name[2]), file_path) {
+                audit_report_path(&w_evt, fields, cwd, file_path, NULL, 0);
+            }
+        }
+        break;
+    case 4:
+        name[2] = audit_field_str(&fields->name[2], name_buffer[2], PATH_MAX);
+        name[3] = audit_field_str(&fields->name[3], name_buffer[3], PATH_MAX);
+
+        if (cwd && name[0] && name[1] && name[2] && name[3]) {
+            // Send event 1/2
+            if (file_path = gen_audit_path(cwd, name[0], name[2]), file_path) {
+                audit_report_path(&w_evt, fields, cwd, file_path, NULL, 1);
+            }
+
+            // Send event 2/2
+            if (file_path = gen_audit_path(cwd, name[1], name[3]), file_path) {
+                audit_report_path(&w_evt, fields, cwd, file_path, NULL, 2);
+            }
+        }
+        break;
+    case 5:
+        name[4] = audit_field_str(&fields->name[4], name_buffer[4], PATH_MAX);
+
+        if (cwd && name[1] && name[4]) {
+            if (file_path = gen_audit_path(cwd, name[1], name[4]), file_path) {
+                audit_report_path(&w_evt, fields, cwd, file_path, NULL, 0);
+            }
+        }
+        break;
+    }
+
+    if (w_evt) {
+        free_whodata_event(w_evt);
+    }
+}
+
+
+void audit_parse(char *buffer) {
+    char *pconfig;
+    char *pdelete;
+    audit_fields_t fields;
     audit_key_type filter_key;
 
     // Checks if the key obtained is one of those configured to monitor
     filter_key = filterkey_audit_events(buffer);
 
+    if (filter_key == FIM_AUDIT_UNKNOWN_KEY) {
+        return;
+    }
+
+    audit_scan_fields(buffer, &fields);
+
     switch (filter_key) {
     case FIM_AUDIT_KEY:
         if ((pconfig = strstr(buffer, "type=CONFIG_CHANGE"), pconfig) &&
@@ -479,26 +767,8 @@ void audit_parse(char *buffer) {
              (pdelete = strstr(buffer, "op=\"remove_rule\""), pdelete))) { // Detect rules modification.
 
             // Filter rule removed
-            char *p_dir = NULL;
-            if (regexec(&regexCompiled_dir, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_calloc(1, match_size + 1, p_dir);
-                snprintf(p_dir, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-            }
-
-
-            else if (regexec(&regexCompiled_dir_hex, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                if (decoded_buffer) {
-                    const int decoded_length = match_size / 2;
-                    os_malloc(decoded_length + 1, p_dir);
-                    snprintf(p_dir, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                    os_free(decoded_buffer);
-                } else {
-                    merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                }
-            }
+            char dir_buffer[PATH_MAX];
+            char *p_dir = audit_field_str(&fields.dir, dir_buffer, sizeof(dir_buffer));
 
             if (p_dir && *p_dir != '\0') {
                 minfo(FIM_AUDIT_REMOVE_RULE, p_dir);
@@ -528,437 +798,20 @@ void audit_parse(char *buffer) {
                     atomic_int_set(&audit_thread_active, 0);
                 }
             }
-            os_free(p_dir);
         }
         // Fallthrough
     case FIM_AUDIT_CUSTOM_KEY:
-        if (psuccess = strstr(buffer, "success=yes"), psuccess) {
-
-            os_calloc(1, sizeof(whodata_evt), w_evt);
-
-            // Items
-            if (regexec(&regexCompiled_items, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *chr_item;
-                os_malloc(match_size + 1, chr_item);
-                snprintf(chr_item, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-
-                // No further checks needed on items
-                items = strtol(chr_item, NULL, 10);
-
-                free(chr_item);
-            }
-
-            // user_name & user_id
-            if (regexec(&regexCompiled_uid, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, w_evt->user_id);
-                snprintf(w_evt->user_id, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-
-                if (w_evt->user_id[0] != '\0') {
-                    errno = 0;
-                    int user_id = strtol(w_evt->user_id, &endptr, 10);
-
-                    if (errno != ERANGE && endptr != NULL && *endptr == '\0') {
-                        w_evt->user_name = get_user(user_id);
-                    }
-                    endptr = NULL;
-                }
-            }
-
-            // audit_name & audit_uid
-            if (regexec(&regexCompiled_auid, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *auid = NULL;
-                os_malloc(match_size + 1, auid);
-                snprintf(auid, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-                if (strcmp(auid, "4294967295") == 0) { // Invalid auid (-1)
-                    if (!auid_err_reported) {
-                        mdebug1(FIM_AUDIT_INVALID_AUID);
-                        auid_err_reported = 1;
-                    }
-                    w_evt->audit_name = NULL;
-                    w_evt->audit_uid = NULL;
-                } else {
-                    w_evt->audit_uid = auid;
-                    auid = NULL;
-
-                    if (w_evt->audit_uid[0] != '\0') {
-                        errno = 0;
-                        int audit_uid = strtol(w_evt->audit_uid, &endptr, 10);
-
-                        if (errno != ERANGE && endptr != NULL && *endptr == '\0') {
-                            w_evt->audit_name = get_user(audit_uid);
-                        }
-                        endptr = NULL;
-                    }
-                }
-                os_free(auid);
-            }
-            // effective_name && effective_uid
-            if (regexec(&regexCompiled_euid, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, w_evt->effective_uid);
-                snprintf(w_evt->effective_uid, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-
-                if (w_evt->effective_uid[0] != '\0') {
-                    errno = 0;
-                    int euid = strtol(w_evt->effective_uid, &endptr, 10);
-
-                    if (errno != ERANGE && endptr != NULL && *endptr == '\0') {
-                        w_evt->effective_name = get_user(euid);
-                    }
-                    endptr = NULL;
-                }
-            }
-            // group_name & group_id
-            if (regexec(&regexCompiled_gid, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, w_evt->group_id);
-                snprintf(w_evt->group_id, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-
-                if (w_evt->group_id[0] != '\0') {
-                    errno = 0;
-                    int gid = strtol(w_evt->group_id, &endptr, 10);
-
-                    if (errno != ERANGE && endptr != NULL && *endptr == '\0') {
-                        w_evt->group_name = get_group(gid);
-                    }
-                    endptr = NULL;
-                }
-            }
-            // process_id
-            if (regexec(&regexCompiled_pid, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *pid = NULL;
-                os_malloc(match_size + 1, pid);
-                snprintf(pid, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-
-                w_evt->process_id = strtol(pid, &endptr, 10);
-
-                free(pid);
-            }
-            // ppid
-            if (regexec(&regexCompiled_ppid, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *ppid = NULL;
-                os_malloc(OS_FLSIZE, w_evt->parent_name);
-                os_malloc(OS_FLSIZE, w_evt->parent_cwd);
-                os_malloc(match_size + 1, ppid);
-                snprintf(ppid, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-                get_parent_process_info(ppid, &w_evt->parent_name, &w_evt->parent_cwd);
-
-                w_evt->ppid = strtol(ppid, &endptr, 10);
-
-                free(ppid);
-            }
-            // process_name
-            if (regexec(&regexCompiled_pname, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, w_evt->process_name);
-                snprintf(w_evt->process_name, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-            } else if (regexec(&regexCompiled_pname_hex, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                if (decoded_buffer) {
-                    const int decoded_length = match_size / 2;
-                    os_malloc(decoded_length + 1, w_evt->process_name);
-                    snprintf(w_evt->process_name, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                    os_free(decoded_buffer);
-                } else {
-                    merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                }
-            }
-
-            // cwd
-            if (regexec(&regexCompiled_cwd, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, w_evt->cwd);
-                snprintf(w_evt->cwd, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-            } else if (regexec(&regexCompiled_cwd_hex, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                if (decoded_buffer) {
-                    const int decoded_length = match_size / 2;
-                    os_malloc(decoded_length + 1, w_evt->cwd);
-                    snprintf(w_evt->cwd, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                    os_free(decoded_buffer);
-                } else {
-                    merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                }
-            }
-
-            // path0
-            if (regexec(&regexCompiled_path0, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, path0);
-                snprintf(path0, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-            } else if (regexec(&regexCompiled_path0_hex, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                if (decoded_buffer) {
-                    const int decoded_length = match_size / 2;
-                    os_malloc(decoded_length + 1, path0);
-                    snprintf(path0, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                    os_free(decoded_buffer);
-                } else {
-                    merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                }
-            }
-
-            // path1
-            if (regexec(&regexCompiled_path1, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, path1);
-                snprintf(path1, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-            } else if (regexec(&regexCompiled_path1_hex, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                if (decoded_buffer) {
-                    const int decoded_length = match_size / 2;
-                    os_malloc(decoded_length + 1, path1);
-                    snprintf(path1, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                    os_free(decoded_buffer);
-                } else {
-                    merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                }
-            }
-
-            // inode
-            if (regexec(&regexCompiled_inode, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, w_evt->inode);
-                snprintf(w_evt->inode, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-            }
-            // dev
-            if (regexec(&regexCompiled_dev, buffer, 2, match, 0) == 0) {
-                match_size = match[1].rm_eo - match[1].rm_so;
-                os_malloc(match_size + 1, dev);
-                snprintf(dev, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-
-                char *aux = wstr_chr(dev, ':');
-
-                if (aux) {
-                    *(aux++) = '\0';
-
-                    os_calloc(OS_SIZE_64, sizeof(char), w_evt->dev);
-                    snprintf(w_evt->dev, OS_SIZE_64, "%s%s", dev, aux);
-                    snprintf(w_evt->dev, OS_SIZE_64, "%ld", strtol(w_evt->dev, NULL, 16));
-                } else {
-                    merror("Couldn't decode device chunk of audit log: colon not found in this string: \"%s\".",
-                           dev); // LCOV_EXCL_LINE
-                }
-
-                free(dev);
-            }
-
-            // TODO: Verify all case events
-            // TODO: Should we consider the w_evt->path if !w_evt->inode?
-            switch (items) {
-
-            case 1:
-                if (w_evt->cwd && path0) {
-                    if (file_path = gen_audit_path(w_evt->cwd, path0, NULL), file_path) {
-                        w_evt->path = file_path;
-                        mdebug2(FIM_AUDIT_EVENT(w_evt->user_name) ? w_evt->user_name : "",
-                                (w_evt->audit_name) ? w_evt->audit_name : "",
-                                (w_evt->effective_name) ? w_evt->effective_name : "",
-                                (w_evt->group_name) ? w_evt->group_name : "", w_evt->process_id, w_evt->ppid,
-                                (w_evt->inode) ? w_evt->inode : "", (w_evt->path) ? w_evt->path : "",
-                                (w_evt->process_name) ? w_evt->process_name : "");
-
-                        if (w_evt->inode) {
-                            fim_whodata_event(w_evt);
-                        }
-                    }
-                }
-                break;
-            case 2:
-                if (w_evt->cwd && path0 && path1) {
-                    if (file_path = gen_audit_path(w_evt->cwd, path0, path1), file_path) {
-                        mdebug2(FIM_AUDIT_EVENT(w_evt->user_name) ? w_evt->user_name : "",
-                                (w_evt->audit_name) ? w_evt->audit_name : "",
-                                (w_evt->effective_name) ? w_evt->effective_name : "",
-                                (w_evt->group_name) ? w_evt->group_name : "", w_evt->process_id, w_evt->ppid,
-                                (w_evt->inode) ? w_evt->inode : "", (file_path) ? file_path : "",
-                                (w_evt->process_name) ? w_evt->process_name : "");
-
-                        w_evt->path = realpath(file_path, NULL);
-                        if (w_evt->path == NULL) {
-                            os_strdup(file_path, w_evt->path);
-                            mdebug1(FIM_CHECK_LINK_REALPATH, w_evt->path); // LCOV_EXCL_LINE
-                        }
-
-                        free(file_path);
-
-                        if (w_evt->inode) {
-                            fim_whodata_event(w_evt);
-                        }
-                    }
-                }
-                break;
-            case 3:
-                // path2
-                if (regexec(&regexCompiled_path2, buffer, 2, match, 0) == 0) {
-                    match_size = match[1].rm_eo - match[1].rm_so;
-                    os_malloc(match_size + 1, path2);
-                    snprintf(path2, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-                } else if (regexec(&regexCompiled_path2_hex, buffer, 2, match, 0) == 0) {
-                    match_size = match[1].rm_eo - match[1].rm_so;
-                    char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                    if (decoded_buffer) {
-                        const int decoded_length = match_size / 2;
-                        os_malloc(decoded_length + 1, path2);
-                        snprintf(path2, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                        os_free(decoded_buffer);
-                    } else {
-                        merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                    }
-                }
-
-                if (w_evt->cwd && path1 && path2) {
-                    if (file_path = gen_audit_path(w_evt->cwd, path1, path2), file_path) {
-                        w_evt->path = file_path;
-                        mdebug2(FIM_AUDIT_EVENT(w_evt->user_name) ? w_evt->user_name : "",
-                                (w_evt->audit_name) ? w_evt->audit_name : "",
-                                (w_evt->effective_name) ? w_evt->effective_name : "",
-                                (w_evt->group_name) ? w_evt->group_name : "", w_evt->process_id, w_evt->ppid,
-                                (w_evt->inode) ? w_evt->inode : "", (w_evt->path) ? w_evt->path : "",
-                                (w_evt->process_name) ? w_evt->process_name : "");
-
-                        if (w_evt->inode) {
-                            fim_whodata_event(w_evt);
-                        }
-                    }
-                }
-                free(path2);
-                break;
-            case 4:
-                // path2
-                if (regexec(&regexCompiled_path2, buffer, 2, match, 0) == 0) {
-                    match_size = match[1].rm_eo - match[1].rm_so;
-                    os_malloc(match_size + 1, path2);
-                    snprintf(path2, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-                } else if (regexec(&regexCompiled_path2_hex, buffer, 2, match, 0) == 0) {
-                    match_size = match[1].rm_eo - match[1].rm_so;
-                    char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                    if (decoded_buffer) {
-                        const int decoded_length = match_size / 2;
-                        os_malloc(decoded_length + 1, path2);
-                        snprintf(path2, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                        os_free(decoded_buffer);
-                    } else {
-                        merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                    }
-                }
-
-                // path3
-                if (regexec(&regexCompiled_path3, buffer, 2, match, 0) == 0) {
-                    match_size = match[1].rm_eo - match[1].rm_so;
-                    os_malloc(match_size + 1, path3);
-                    snprintf(path3, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-                } else if (regexec(&regexCompiled_path3_hex, buffer, 2, match, 0) == 0) {
-                    match_size = match[1].rm_eo - match[1].rm_so;
-                    char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                    if (decoded_buffer) {
-                        const int decoded_length = match_size / 2;
-                        os_malloc(decoded_length + 1, path3);
-                        snprintf(path3, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                        os_free(decoded_buffer);
-                    } else {
-                        merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                    }
-                }
-
-                if (w_evt->cwd && path0 && path1 && path2 && path3) {
-                    // Send event 1/2
-                    char *file_path1;
-                    if (file_path1 = gen_audit_path(w_evt->cwd, path0, path2), file_path1) {
-                        w_evt->path = file_path1;
-                        mdebug2(FIM_AUDIT_EVENT1(w_evt->user_name) ? w_evt->user_name : "",
-                                (w_evt->audit_name) ? w_evt->audit_name : "",
-                                (w_evt->effective_name) ? w_evt->effective_name : "",
-                                (w_evt->group_name) ? w_evt->group_name : "", w_evt->process_id, w_evt->ppid,
-                                (w_evt->inode) ? w_evt->inode : "", (w_evt->path) ? w_evt->path : "",
-                                (w_evt->process_name) ? w_evt->process_name : "");
-
-                        if (w_evt->inode) {
-                            fim_whodata_event(w_evt);
-                        }
-                        free(file_path1);
-                        w_evt->path = NULL;
-                    }
-
-                    // Send event 2/2
-                    char *file_path2;
-                    if (file_path2 = gen_audit_path(w_evt->cwd, path1, path3), file_path2) {
-                        w_evt->path = file_path2;
-                        mdebug2(FIM_AUDIT_EVENT2(w_evt->user_name) ? w_evt->user_name : "",
-                                (w_evt->audit_name) ? w_evt->audit_name : "",
-                                (w_evt->effective_name) ? w_evt->effective_name : "",
-                                (w_evt->group_name) ? w_evt->group_name : "", w_evt->process_id, w_evt->ppid,
-                                (w_evt->inode) ? w_evt->inode : "", (w_evt->path) ? w_evt->path : "",
-                                (w_evt->process_name) ? w_evt->process_name : "");
-
-                        if (w_evt->inode) {
-                            fim_whodata_event(w_evt);
-                        }
-                    }
-                }
-                free(path2);
-                free(path3);
-                break;
-            case 5:
-                // path4
-                if (regexec(&regexCompiled_path4, buffer, 2, match, 0) == 0) {
-                    match_size = match[1].rm_eo - match[1].rm_so;
-                    os_malloc(match_size + 1, path4);
-                    snprintf(path4, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-                } else if (regexec(&regexCompiled_path4_hex, buffer, 2, match, 0) == 0) {
-                    match_size = match[1].rm_eo - match[1].rm_so;
-                    char *decoded_buffer = decode_hex_buffer_2_ascii_buffer(buffer + match[1].rm_so, match_size);
-                    if (decoded_buffer) {
-                        const int decoded_length = match_size / 2;
-                        os_malloc(decoded_length + 1, path4);
-                        snprintf(path4, decoded_length + 1, "%.*s", decoded_length, decoded_buffer);
-                        os_free(decoded_buffer);
-                    } else {
-                        merror("Error found while decoding HEX bufer: '%.*s'", match_size, buffer + match[1].rm_so);
-                    }
-                }
-
-                if (w_evt->cwd && path1 && path4) {
-                    char *file_path;
-                    if (file_path = gen_audit_path(w_evt->cwd, path1, path4), file_path) {
-                        w_evt->path = file_path;
-                        mdebug2(FIM_AUDIT_EVENT(w_evt->user_name) ? w_evt->user_name : "",
-                                (w_evt->audit_name) ? w_evt->audit_name : "",
-                                (w_evt->effective_name) ? w_evt->effective_name : "",
-                                (w_evt->group_name) ? w_evt->group_name : "", w_evt->process_id, w_evt->ppid,
-                                (w_evt->inode) ? w_evt->inode : "", (w_evt->path) ? w_evt->path : "",
-                                (w_evt->process_name) ? w_evt->process_name : "");
-
-                        if (w_evt->inode) {
-                            fim_whodata_event(w_evt);
-                        }
-                    }
-                }
-                free(path4);
-                break;
-            }
-
-            free(path0);
-            free(path1);
-            free_whodata_event(w_evt);
+        if (strstr(buffer, "success=yes")) {
+            audit_parse_syscall(&fields);
         }
         break;
     case FIM_AUDIT_HC_KEY:
-        if (regexec(&regexCompiled_syscall, buffer, 2, match, 0) == 0) {
-            match_size = match[1].rm_eo - match[1].rm_so;
-            char *syscall = NULL;
-            os_malloc(match_size + 1, syscall);
-            snprintf(syscall, match_size + 1, "%.*s", match_size, buffer + match[1].rm_so);
-            if (!strcmp(syscall, "2") || !strcmp(syscall, "257") || !strcmp(syscall, "5") || 
+        if (fields.syscall.value) {
+            char syscall[OS_SIZE_32];
+
+            audit_field_str(&fields.syscall, syscall, sizeof(syscall));
+
+            if (!strcmp(syscall, "2") || !strcmp(syscall, "257") || !strcmp(syscall, "5") ||
                 !strcmp(syscall, "295") || !strcmp(syscall, "56")) {
                 // x86_64: 2 open
                 // x86_64: 257 openat
@@ -978,7 +831,6 @@ void audit_parse(char *buffer) {
             } else {
                 mdebug2(FIM_HEALTHCHECK_UNRECOGNIZED_EVENT, syscall);
             }
-            os_free(syscall);
         }
         break;
     default:
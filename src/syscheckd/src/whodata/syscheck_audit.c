@@ -25,6 +25,7 @@
 #define AUDIT_CONF_LINK             "af_wazuh.conf"
 #define BUF_SIZE OS_MAXSTR
 #define MAX_CONN_RETRIES 5          // Max retries to reconnect to Audit socket
+#define AUDIT_EVENT_SLOTS 8         // Events assembled at the same time
 
 // Global variables
 pthread_mutex_t audit_mutex;
@@ -51,6 +52,16 @@ typedef struct _audit_data_s {
     audit_mode mode;
 } audit_data_t;
 
+/* Audit event being assembled from its records */
+typedef struct _audit_event_slot_s {
+    char id[OS_SIZE_64];
+    size_t id_length;           // 0 if the slot is free
+    char *buffer;
+    size_t length;
+    unsigned long last_line;    // Number of the last line appended
+    int too_long;               // The event didn't fit, it's discarded
+} audit_event_slot_t;
+
 /**
  * @brief Creates the necessary threads to process audit events
  *
@@ -352,12 +363,6 @@ int audit_init(void) {
         return -1;
     }
 
-    int regex_comp = init_regex();
-    if (regex_comp < 0) {
-        merror("Can't init regex in 'init_regex()'");
-        return -1;
-    }
-
     if (fim_audit_rules_init() != 0) {
         return -1;
     }
@@ -458,8 +463,6 @@ void *audit_main(audit_data_t *audit_data) {
     mdebug1(FIM_AUDIT_THREAD_STOPED);
     close(audit_data->socket);
 
-    // Clean regexes used for parsing events
-    clean_regex();
     // Change Audit monitored folders to Inotify.
     w_rwlock_wrlock(&syscheck.directories_lock);
     OSList_foreach(node_it, syscheck.directories) {
@@ -527,25 +530,95 @@ void *audit_parse_thread() {
     return NULL;
 }
 
+/**
+ * @brief Pushes an assembled event to the queue of the parsing thread.
+ *
+ * @param event Records of the event, one per line.
+ */
+static void audit_push_event(const char *event) {
+    char *event_dup;
+
+    os_strdup(event, event_dup);
+
+    if (queue_push_ex(audit_queue, event_dup)) {
+        if (!audit_queue_full_reported) {
+            mwarn(FIM_FULL_AUDIT_QUEUE);
+            audit_queue_full_reported = 1;
+        }
+        os_free(event_dup);
+    }
+}
+
+/**
+ * @brief Pushes the event of a slot, unless it was too long, and frees the slot.
+ *
+ * @param slot Slot to flush.
+ */
+static void audit_flush_slot(audit_event_slot_t *slot) {
+    if (slot->length && !slot->too_long) {
+        audit_push_event(slot->buffer);
+    }
+
+    slot->id_length = 0;
+    slot->length = 0;
+    slot->too_long = 0;
+    slot->buffer[0] = '\0';
+}
+
+/**
+ * @brief Finds the slot assembling an event.
+ * @details A new event takes a free slot, or the least recently used one, whose event is flushed.
+ *
+ * @param slots Ring of AUDIT_EVENT_SLOTS slots.
+ * @param id Id of the event.
+ * @param id_length Length of the id, less than OS_SIZE_64.
+ * @return The slot of the event.
+ */
+static audit_event_slot_t *audit_event_slot(audit_event_slot_t *slots, const char *id, size_t id_length) {
+    audit_event_slot_t *slot = NULL;
+    int i;
+
+    for (i = 0; i < AUDIT_EVENT_SLOTS; i++) {
+        if (slots[i].id_length == id_length && memcmp(slots[i].id, id, id_length) == 0) {
+            return &slots[i];
+        }
+
+        if (slot == NULL || (slot->id_length && (!slots[i].id_length || slots[i].last_line < slot->last_line))) {
+            slot = &slots[i];
+        }
+    }
+
+    audit_flush_slot(slot);
+    memcpy(slot->id, id, id_length);
+    slot->id[id_length] = '\0';
+    slot->id_length = id_length;
+    return slot;
+}
+
 void audit_read_events(int *audit_sock, atomic_int_t *running) {
     size_t byteRead;
-    char * cache;
-    char * cache_id = NULL;
+    audit_event_slot_t *slots;
+    audit_event_slot_t *slot;
+    unsigned long line_count = 0;
     char * line;
     char * endline;
-    size_t cache_i = 0;
+    const char * id;
+    size_t id_length;
     size_t buffer_i = 0; // Buffer offset
     size_t len;
     fd_set fdset;
     struct timeval timeout;
     count_reload_retries = 0;
     int conn_retries;
-    char * eoe_found = NULL;
-    char * cache_dup = NULL;
+    int i;
 
     char *buffer;
     os_malloc(BUF_SIZE * sizeof(char), buffer);
-    os_malloc(BUF_SIZE, cache);
+    os_calloc(AUDIT_EVENT_SLOTS, sizeof(audit_event_slot_t), slots);
+
+    for (i = 0; i < AUDIT_EVENT_SLOTS; i++) {
+        os_calloc(BUF_SIZE, sizeof(char), slots[i].buffer);
+    }
 
     while (atomic_int_get(running)) {
         FD_ZERO(&fdset);
@@ -561,17 +634,9 @@ void audit_read_events(int *audit_sock, atomic_int_t *running) {
             continue;
 
         case 0:
-            if (cache_i) {
-                // Flush cache
-                os_strdup(cache, cache_dup);
-                if (queue_push_ex(audit_queue, cache_dup)) {
-                    if (!audit_queue_full_reported) {
-                        mwarn(FIM_FULL_AUDIT_QUEUE);
-                        audit_queue_full_reported = 1;
-                    }
-                    os_free(cache_dup);
-                }
-                cache_i = 0;
+            // Flush the events that didn't get their end
+            for (i = 0; i < AUDIT_EVENT_SLOTS; i++) {
+                audit_flush_slot(&slots[i]);
             }
 
             continue;
@@ -622,44 +687,30 @@ void audit_read_events(int *audit_sock, atomic_int_t *running) {
         // Get all the lines
         line = buffer;
 
-        char * id;
-        char *event_too_long_id = NULL;
-
         do {
             *endline = '\0';
 
-            if (id = audit_get_id(line), id) {
-                // If there was cached data and the ID is different, parse cache first
-
-                if (cache_id && strcmp(cache_id, id) && cache_i) {
-                    if (!event_too_long_id) {
-                        os_strdup(cache, cache_dup);
-                        if (queue_push_ex(audit_queue, cache_dup)) {
-                            if (!audit_queue_full_reported) {
-                                mwarn(FIM_FULL_AUDIT_QUEUE);
-                                audit_queue_full_reported = 1;
-                            }
-                            os_free(cache_dup);
-                        }
-                    }
-                    cache_i = 0;
-                }
+            // Records of different events may come interleaved, each event is assembled in a slot of its own
+            if (id = audit_event_id(line, &id_length), id && id_length && id_length < OS_SIZE_64) {
+                slot = audit_event_slot(slots, id, id_length);
+                slot->last_line = ++line_count;
 
-                // Append to cache
+                // Append to the event
                 len = endline - line;
-                if (cache_i + len + 1 <= BUF_SIZE) {
-                    strncpy(cache + cache_i, line, len);
-                    cache_i += len;
-                    cache[cache_i++] = '\n';
-                    cache[cache_i] = '\0';
-                } else if (!event_too_long_id){
-                    mwarn(FIM_WARN_WHODATA_EVENT_TOOLONG, id);
-                    os_strdup(id, event_too_long_id);
+                if (slot->length + len + 1 < BUF_SIZE) {
+                    memcpy(slot->buffer + slot->length, line, len);
+                    slot->length += len;
+                    slot->buffer[slot->length++] = '\n';
+                    slot->buffer[slot->length] = '\0';
+                } else if (!slot->too_long) {
+                    mwarn(FIM_WARN_WHODATA_EVENT_TOOLONG, slot->id);
+                    slot->too_long = 1;
                 }
-                eoe_found = strstr(line, "type=EOE");
 
-                free(cache_id);
-                cache_id = id;
+                // The event is complete once the "end of event" record is found
+                if (strstr(line, "type=EOE")) {
+                    audit_flush_slot(slot);
+                }
             } else {
                 mwarn(FIM_WARN_WHODATA_GETID, line);
             }
@@ -667,19 +718,6 @@ void audit_read_events(int *audit_sock, atomic_int_t *running) {
             line = endline + 1;
         } while (*line && (endline = strchr(line, '\n'), endline));
 
-        // If some audit log remains in the cache and it is complet (line "end of event" is found), flush cache
-        if (eoe_found && !event_too_long_id){
-            os_strdup(cache, cache_dup);
-            if (queue_push_ex(audit_queue, cache_dup)) {
-                if (!audit_queue_full_reported) {
-                    mwarn(FIM_FULL_AUDIT_QUEUE);
-                    audit_queue_full_reported = 1;
-                }
-                os_free(cache_dup);
-            }
-            cache_i = 0;
-        }
-
         // If some data remains in the buffer, move it to the beginning
         if (*line) {
             buffer_i = strlen(line);
@@ -687,12 +725,13 @@ void audit_read_events(int *audit_sock, atomic_int_t *running) {
         } else {
             buffer_i = 0;
         }
+    }
 
-        os_free(event_too_long_id);
+    for (i = 0; i < AUDIT_EVENT_SLOTS; i++) {
+        os_free(slots[i].buffer);
     }
 
-    free(cache_id);
-    free(cache);
+    os_free(slots);
     free(buffer);
 }
 
@@ -55,8 +55,33 @@ int fim_audit_rules_init();
  */
 int fim_rules_initial_load();
 
-// Public parse functions
-void clean_regex();
+#define AUDIT_MAX_ITEMS 5 // PATH records of an event that are read
+
+/* Value of an audit field, pointing into the event it was read from */
+typedef struct audit_field {
+    const char *value;  // NULL if the field wasn't found
+    size_t length;
+    int hex;            // Unquoted text values are hex encoded
+} audit_field_t;
+
+/* Fields of an event used to build whodata events */
+typedef struct audit_fields {
+    audit_field_t items;
+    audit_field_t uid;
+    audit_field_t gid;
+    audit_field_t auid;
+    audit_field_t euid;
+    audit_field_t pid;
+    audit_field_t ppid;
+    audit_field_t syscall;
+    audit_field_t exe;
+    audit_field_t cwd;
+    audit_field_t dir;
+    audit_field_t inode;    // Last one of the PATH records
+    audit_field_t dev;
+    audit_field_t name[AUDIT_MAX_ITEMS];
+} audit_fields_t;
+
 
 extern pthread_mutex_t audit_mutex;
 extern atomic_int_t audit_thread_active;
@@ -1109,7 +1109,6 @@ long unsigned int WINAPI state_checker(__attribute__((unused)) void *_void) {
     whodata_dir_status *d_status;
     int interval;
     OSHashNode *w_dir_node;
-    OSHashNode *w_dir_node_next;
     whodata_directory *w_dir;
     directory_t *dir_it;
     OSListNode *node_it;
@@ -1211,25 +1210,18 @@ long unsigned int WINAPI state_checker(__attribute__((unused)) void *_void) {
         // 5 seconds ago
         stale_time.QuadPart -= 5 * FILETIME_SECOND;
 
-        w_dir_it = 0;
         w_rwlock_wrlock(&syscheck.wdata.directories->mutex);
 
-        while (w_dir_it <= syscheck.wdata.directories->rows) {
-            w_dir_node = syscheck.wdata.directories->table[w_dir_it];
-            w_dir_node_next = w_dir_node;
+        // The current node may be deleted while iterating, entries being resized are visited too
+        for (w_dir_node = OSHash_Begin(syscheck.wdata.directories, &w_dir_it); w_dir_node;
+             w_dir_node = OSHash_Next(syscheck.wdata.directories, &w_dir_it, w_dir_node)) {
+            w_dir = w_dir_node->data;
 
-            while(w_dir_node_next) {
-                w_dir_node_next = w_dir_node_next->next;
-
-                w_dir = w_dir_node->data;
-                if (w_dir->QuadPart < stale_time.QuadPart) {
-                    if (w_dir = OSHash_Delete(syscheck.wdata.directories, w_dir_node->key), w_dir) {
-                        free(w_dir);
-                    }
+            if (w_dir->QuadPart < stale_time.QuadPart) {
+                if (w_dir = OSHash_Delete(syscheck.wdata.directories, w_dir_node->key), w_dir) {
+                    free(w_dir);
                 }
-                w_dir_node = w_dir_node_next;
             }
-            w_dir_it++;
         }
 
         w_rwlock_unlock(&syscheck.wdata.directories->mutex);
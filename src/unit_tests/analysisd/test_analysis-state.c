@@ -119,7 +119,10 @@ static int test_setup(void ** state) {
     dispatch_dbsync_input = queue_init(4096);
     upgrade_module_input = queue_init(4096);
     decode_queue_event_input = queue_init(4096);
-    decode_queue_event_output = queue_init(4096);
+    num_rule_matching_threads = 2;
+    os_calloc(num_rule_matching_threads, sizeof(w_queue_t *), decode_queue_event_output);
+    decode_queue_event_output[0] = queue_init(2048);
+    decode_queue_event_output[1] = queue_init(2048);
     writer_queue_log = queue_init(4096);
     writer_queue_log_firewall = queue_init(4096);
     writer_queue_log_fts = queue_init(4096);
@@ -135,7 +138,8 @@ static int test_setup(void ** state) {
     dispatch_dbsync_input->size = queue_status.dbsync_queue_size = 4096;
     upgrade_module_input->size = queue_status.upgrade_queue_size = 4096;
     decode_queue_event_input->size = queue_status.events_queue_size = 4096;
-    decode_queue_event_output->size = queue_status.processed_queue_size = 4096;
+    decode_queue_event_output[0]->size = decode_queue_event_output[1]->size = 2048;
+    queue_status.processed_queue_size = 4096;
     writer_queue_log->size = queue_status.alerts_queue_size = 4096;
     writer_queue_log_firewall->size = queue_status.firewall_queue_size = 4096;
     writer_queue_log_fts->size = queue_status.fts_queue_size = 4096;
@@ -151,7 +155,8 @@ static int test_setup(void ** state) {
     dispatch_dbsync_input->elements = 456;
     upgrade_module_input->elements = 0;
     decode_queue_event_input->elements = 259;
-    decode_queue_event_output->elements = 154;
+    decode_queue_event_output[0]->elements = 100;
+    decode_queue_event_output[1]->elements = 54;
     writer_queue_log->elements = 5;
     writer_queue_log_firewall->elements = 1;
     writer_queue_log_fts->elements = 0;
@@ -223,7 +228,8 @@ static int test_teardown(void ** state) {
     os_free(dispatch_dbsync_input->data);
     os_free(upgrade_module_input->data);
     os_free(decode_queue_event_input->data);
-    os_free(decode_queue_event_output->data);
+    os_free(decode_queue_event_output[0]->data);
+    os_free(decode_queue_event_output[1]->data);
     os_free(writer_queue_log->data);
     os_free(writer_queue_log_firewall->data);
     os_free(writer_queue_log_fts->data);
@@ -238,6 +244,8 @@ static int test_teardown(void ** state) {
     os_free(dispatch_dbsync_input);
     os_free(upgrade_module_input);
     os_free(decode_queue_event_input);
+    os_free(decode_queue_event_output[0]);
+    os_free(decode_queue_event_output[1]);
     os_free(decode_queue_event_output);
     os_free(writer_queue_log);
     os_free(writer_queue_log_firewall);
@@ -44,6 +44,10 @@ int fim_process_alert(_sdb *sdb, Eventinfo *lf, cJSON *event);
 int decode_fim_event(_sdb *sdb, Eventinfo *lf);
 char *perm_json_to_old_format(cJSON *perm_json);
 void fim_adjust_checksum(sk_sum_t *newsum, char **checksum);
+void fim_send_db_request(_sdb * sdb, const char * agent_id, const char * query);
+
+extern w_queue_t ** fim_db_queues;
+extern unsigned int fim_db_writers;
 
 /* setup/teardown */
 
@@ -937,6 +941,77 @@ static void test_fim_send_db_save_null_data(void **state) {
     fim_send_db_save(&sdb, agent_id, NULL);
 }
 
+/* fim_send_db_request */
+static int setup_fim_db_writers(void **state) {
+    os_calloc(2, sizeof(w_queue_t *), fim_db_queues);
+    fim_db_queues[0] = queue_init(16);
+    fim_db_queues[1] = queue_init(16);
+    fim_db_writers = 2;
+
+    return 0;
+}
+
+static int teardown_fim_db_writers(void **state) {
+    char *query;
+
+    for (unsigned int i = 0; i < fim_db_writers; i++) {
+        while (query = queue_pop(fim_db_queues[i]), query) {
+            free(query);
+        }
+        queue_free(fim_db_queues[i]);
+    }
+
+    os_free(fim_db_queues);
+    fim_db_writers = 0;
+
+    return 0;
+}
+
+static void test_fim_send_db_request_writers(void **state) {
+    _sdb sdb = {.socket = 10};
+    char *query;
+
+    // No query is sent by the decoder
+    fim_send_db_delete(&sdb, "001", "/a/path");
+    fim_send_db_delete(&sdb, "002", "/a/path");
+    fim_send_db_request(&sdb, "003", "agent 003 syscheck delete /b/path");
+    fim_send_db_delete(&sdb, NULL, "/a/path");
+
+    query = queue_pop(fim_db_queues[1]);
+    assert_string_equal(query, "agent 001 syscheck delete /a/path");
+    free(query);
+
+    // The queries of an agent keep their order
+    query = queue_pop(fim_db_queues[1]);
+    assert_string_equal(query, "agent 003 syscheck delete /b/path");
+    free(query);
+
+    query = queue_pop(fim_db_queues[0]);
+    assert_string_equal(query, "agent 002 syscheck delete /a/path");
+    free(query);
+
+    query = queue_pop(fim_db_queues[0]);
+    assert_string_equal(query, "agent (null) syscheck delete /a/path");
+    free(query);
+
+    assert_true(queue_empty(fim_db_queues[0]));
+    assert_true(queue_empty(fim_db_queues[1]));
+}
+
+static void test_fim_send_db_request_scan_info(void **state) {
+    _sdb sdb = {.socket = 10};
+    cJSON *data = cJSON_Parse("{\"timestamp\":123456789}");
+    char *query;
+
+    fim_process_scan_info(&sdb, "005", FIM_SCAN_END, data);
+
+    query = queue_pop(fim_db_queues[1]);
+    assert_string_equal(query, "agent 005 syscheck scan_info_update end_scan 123456789");
+    free(query);
+
+    cJSON_Delete(data);
+}
+
 /* fim_process_scan_info */
 static void test_fim_process_scan_info_scan_start(void **state) {
     _sdb sdb = {.socket = 10};
@@ -3834,6 +3909,10 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_fim_send_db_save_null_agent_id, setup_fim_event_cjson, teardown_cjson),
         cmocka_unit_test_setup_teardown(test_fim_send_db_save_null_data, setup_fim_event_cjson, teardown_cjson),
 
+        /* fim_send_db_request */
+        cmocka_unit_test_setup_teardown(test_fim_send_db_request_writers, setup_fim_db_writers, teardown_fim_db_writers),
+        cmocka_unit_test_setup_teardown(test_fim_send_db_request_scan_info, setup_fim_db_writers, teardown_fim_db_writers),
+
         /* fim_process_scan_info */
         cmocka_unit_test_setup_teardown(test_fim_process_scan_info_scan_start,setup_fim_event_cjson, teardown_cjson),
         cmocka_unit_test_setup_teardown(test_fim_process_scan_info_scan_end, setup_fim_event_cjson, teardown_cjson),
@@ -136,6 +136,45 @@ void test_asyscom_dispatch_getconfig_empty_parameters(void ** state) {
     assert_int_equal(size, strlen(response));
 }
 
+void test_asyscom_dispatch_setprofile_empty_parameters(void ** state) {
+    char* request = "{\"command\":\"setprofile\"}";
+    char *response = NULL;
+
+    size_t size = asyscom_dispatch(request, &response);
+
+    *state = response;
+
+    assert_non_null(response);
+    assert_string_equal(response, "{\"error\":5,\"message\":\"Empty parameters\",\"data\":{}}");
+    assert_int_equal(size, strlen(response));
+}
+
+void test_asyscom_dispatch_setprofile_invalid_sampling(void ** state) {
+    char* request = "{\"command\":\"setprofile\",\"parameters\":{\"sampling\":-1}}";
+    char *response = NULL;
+
+    size_t size = asyscom_dispatch(request, &response);
+
+    *state = response;
+
+    assert_non_null(response);
+    assert_string_equal(response, "{\"error\":12,\"message\":\"Invalid sampling rate\",\"data\":{}}");
+    assert_int_equal(size, strlen(response));
+}
+
+void test_asyscom_dispatch_reloadruleset(void ** state) {
+    char* request = "{\"command\":\"reloadruleset\"}";
+    char *response = NULL;
+
+    size_t size = asyscom_dispatch(request, &response);
+
+    *state = response;
+
+    assert_non_null(response);
+    assert_string_equal(response, "{\"error\":0,\"message\":\"ok\",\"data\":{}}");
+    assert_int_equal(size, strlen(response));
+}
+
 void test_asyscom_dispatch_getagentsstats_empty_parameters(void ** state) {
     char* request = "{\"command\":\"getagentsstats\"}";
     char *response = NULL;
@@ -663,6 +702,9 @@ int main(void) {
         cmocka_unit_test_teardown(test_asyscom_dispatch_getconfig_unknown_section, test_teardown),
         cmocka_unit_test_teardown(test_asyscom_dispatch_getconfig_empty_section, test_teardown),
         cmocka_unit_test_teardown(test_asyscom_dispatch_getconfig_empty_parameters, test_teardown),
+        cmocka_unit_test_teardown(test_asyscom_dispatch_setprofile_empty_parameters, test_teardown),
+        cmocka_unit_test_teardown(test_asyscom_dispatch_setprofile_invalid_sampling, test_teardown),
+        cmocka_unit_test_teardown(test_asyscom_dispatch_reloadruleset, test_teardown),
         cmocka_unit_test_teardown(test_asyscom_dispatch_getagentsstats_empty_parameters, test_teardown),
         cmocka_unit_test_teardown(test_asyscom_dispatch_getagentsstats_invalid_agents, test_teardown),
         cmocka_unit_test_teardown(test_asyscom_dispatch_getagentsstats_empty_last_id, test_teardown),
@@ -19,6 +19,7 @@
 
 #include "../analysisd/eventinfo.h"
 #include "../analysisd/decoders/decoder.h"
+#include "../analysisd/config.h"
 #include "../headers/wazuhdb_op.h"
 
 /* setup/teardown redefinitions */
@@ -424,6 +425,27 @@ static void test_dispatch_answer_remote_success(void **state) {
     dispatch_answer(data->ctx, result);
 }
 
+static void test_dispatch_answer_interval_hint(void **state) {
+    test_dbsync_t *data = *state;
+    const char *result = "checksum_fail";
+
+    data->ctx->ar_sock = 65555;
+    snprintf(data->ctx->agent_id, OS_SIZE_16, "007");
+    snprintf(data->ctx->component, OS_SIZE_16, "fim_file");
+    Config.dbsync_interval_hint = 600;
+
+    expect_value(__wrap_send_msg_to_agent, msocket, 65555);
+    expect_string(__wrap_send_msg_to_agent, msg,
+        "fim_file dbsync checksum_fail {\"begin\":\"/a/path\",\"end\":\"/z/path\",\"interval\":607}");
+    expect_string(__wrap_send_msg_to_agent, agt_id, "007");
+    expect_value(__wrap_send_msg_to_agent, exec, NULL);
+    will_return(__wrap_send_msg_to_agent, 0);
+
+    dispatch_answer(data->ctx, result);
+
+    Config.dbsync_interval_hint = 0;
+}
+
 static void test_dispatch_answer_query_too_long(void **state) {
     test_dbsync_t *data = *state;
     char result[OS_MAXSTR];
@@ -875,6 +897,67 @@ static void test_DispatchDBSync_state_success(void **state) {
     DispatchDBSync(data->ctx, data->lf);
 }
 
+static void test_DispatchDBSync_state_batch_success(void **state) {
+    test_dbsync_t *data = *state;
+    char *response = "This is a mock response, payload points -> here <-";
+
+    snprintf(data->lf->agent_id, OS_SIZE_16, "007");
+
+    data->ctx->db_sock = 65555;
+
+    free(data->lf->log);
+    data->lf->log = strdup("{\"component\":\"syscheck\",\"type\":\"state_batch\",\"data\":[{\"index\":\"/a\"},{\"index\":\"/b\"}]}");
+
+    expect_value(__wrap_wdbc_query_ex, *sock, data->ctx->db_sock);
+    expect_string(__wrap_wdbc_query_ex, query, "agent 007 syscheck save2_batch 14:{\"index\":\"/a\"}14:{\"index\":\"/b\"}");
+    expect_value(__wrap_wdbc_query_ex, len, OS_MAXSTR);
+    will_return(__wrap_wdbc_query_ex, response);
+    will_return(__wrap_wdbc_query_ex, 0);
+
+    expect_string(__wrap_wdbc_parse_result, result, response);
+    will_return(__wrap_wdbc_parse_result, WDBC_OK);
+
+    DispatchDBSync(data->ctx, data->lf);
+}
+
+static void test_DispatchDBSync_state_batch_compressed_success(void **state) {
+    test_dbsync_t *data = *state;
+    char *response = "This is a mock response, payload points -> here <-";
+
+    snprintf(data->lf->agent_id, OS_SIZE_16, "007");
+
+    data->ctx->db_sock = 65555;
+
+    // zlib-compressed and base64-encoded '[{"index":"/a"}]'
+    free(data->lf->log);
+    data->lf->log = strdup("{\"component\":\"syscheck\",\"type\":\"state_batch\",\"compression\":\"zlib\",\"size\":16,"
+                           "\"data\":\"eAGLrlbKzEtJrVCyUtJPVKqNBQAtYgUb\"}");
+
+    expect_value(__wrap_wdbc_query_ex, *sock, data->ctx->db_sock);
+    expect_string(__wrap_wdbc_query_ex, query, "agent 007 syscheck save2_batch 14:{\"index\":\"/a\"}");
+    expect_value(__wrap_wdbc_query_ex, len, OS_MAXSTR);
+    will_return(__wrap_wdbc_query_ex, response);
+    will_return(__wrap_wdbc_query_ex, 0);
+
+    expect_string(__wrap_wdbc_parse_result, result, response);
+    will_return(__wrap_wdbc_parse_result, WDBC_OK);
+
+    DispatchDBSync(data->ctx, data->lf);
+}
+
+static void test_DispatchDBSync_state_batch_invalid_compression(void **state) {
+    test_dbsync_t *data = *state;
+
+    snprintf(data->lf->agent_id, OS_SIZE_16, "007");
+
+    free(data->lf->log);
+    data->lf->log = strdup("{\"component\":\"syscheck\",\"type\":\"state_batch\",\"compression\":\"lz4\",\"data\":\"\"}");
+
+    expect_string(__wrap__merror, formatted_msg, "dbsync: Unsupported state batch compression 'lz4'.");
+
+    DispatchDBSync(data->ctx, data->lf);
+}
+
 static void test_DispatchDBSync_integrity_clear_success(void **state) {
     test_dbsync_t *data = *state;
     char *response = "This is a mock response, payload points -> here <-";
@@ -1015,6 +1098,7 @@ int main(void) {
         /* dispatch_answer */
         cmocka_unit_test_setup_teardown(test_dispatch_answer_local_success, setup_dispatch_answer, teardown_dispatch_answer),
         cmocka_unit_test_setup_teardown(test_dispatch_answer_remote_success, setup_dispatch_answer, teardown_dispatch_answer),
+        cmocka_unit_test_setup_teardown(test_dispatch_answer_interval_hint, setup_dispatch_answer, teardown_dispatch_answer),
         cmocka_unit_test_setup_teardown(test_dispatch_answer_query_too_long, setup_dispatch_answer, teardown_dispatch_answer),
 
         /* dispatch_check */
@@ -1044,6 +1128,9 @@ int main(void) {
         /* DispatchDBSync */
         cmocka_unit_test_setup_teardown(test_DispatchDBSync_integrity_check_success, setup_DispatchDBSync, teardown_DispatchDBSync),
         cmocka_unit_test_setup_teardown(test_DispatchDBSync_state_success, setup_DispatchDBSync, teardown_DispatchDBSync),
+        cmocka_unit_test_setup_teardown(test_DispatchDBSync_state_batch_success, setup_DispatchDBSync, teardown_DispatchDBSync),
+        cmocka_unit_test_setup_teardown(test_DispatchDBSync_state_batch_compressed_success, setup_DispatchDBSync, teardown_DispatchDBSync),
+        cmocka_unit_test_setup_teardown(test_DispatchDBSync_state_batch_invalid_compression, setup_DispatchDBSync, teardown_DispatchDBSync),
         cmocka_unit_test_setup_teardown(test_DispatchDBSync_integrity_clear_success, setup_DispatchDBSync, teardown_DispatchDBSync),
         cmocka_unit_test_setup_teardown(test_DispatchDBSync_invalid_log, setup_DispatchDBSync, teardown_DispatchDBSync),
         cmocka_unit_test_setup_teardown(test_DispatchDBSync_no_component, setup_DispatchDBSync, teardown_DispatchDBSync),
@@ -25,6 +25,37 @@ void os_remove_decoders_list(OSDecoderNode *decoderlist_pn, OSDecoderNode *decod
 void os_remove_decodernode(OSDecoderNode *node, OSDecoderInfo **decoders, int *pos, int *max_size);
 void os_count_decoders(OSDecoderNode *node, int *num_decoders);
 
+/* Helpers */
+
+static OSDecoderNode * add_pname_decoder(OSDecoderNode * last, char * program_name) {
+    OSDecoderNode * node;
+    os_calloc(1, sizeof(OSDecoderNode), node);
+    os_calloc(1, sizeof(OSDecoderInfo), node->osdecoder);
+    w_calloc_expression_t(&node->osdecoder->program_name, EXP_TYPE_OSMATCH);
+    w_expression_compile(node->osdecoder->program_name, program_name, 0);
+
+    if (last) {
+        last->next = node;
+    }
+
+    return node;
+}
+
+static void free_pname_decoders(OSDecoderNode * node) {
+    OSDecoderNode * next;
+
+    if (node->program_names) {
+        OSHash_Free(node->program_names);
+    }
+
+    for (; node; node = next) {
+        next = node->next;
+        w_free_expression_t(&node->osdecoder->program_name);
+        os_free(node->osdecoder);
+        os_free(node);
+    }
+}
+
 /* setup/teardown */
 
 
@@ -140,6 +171,72 @@ void test_os_remove_decoders_list_OK(void **state)
 
 }
 
+/* OS_GetDecoderCandidates */
+void test_OS_GetDecoderCandidates_no_index(void **state)
+{
+    OSDecoderNode * node = add_pname_decoder(NULL, "sshd");
+    regex_matching decoder_match = {0};
+
+    assert_null(OS_GetDecoderCandidates(node, "sshd", &decoder_match));
+
+    free_pname_decoders(node);
+}
+
+void test_OS_GetDecoderCandidates_OK(void **state)
+{
+    OSDecoderNode * first = add_pname_decoder(NULL, "sshd");
+    OSDecoderNode * second = add_pname_decoder(first, "^cron$");
+    OSDecoderNode * third = add_pname_decoder(second, "ssh|cron");
+    OSDecoderNode ** candidates;
+    regex_matching decoder_match = {0};
+
+    OS_BuildDecoderIndex(first);
+    assert_non_null(first->program_names);
+    assert_null(second->program_names);
+
+    // Candidates keep the list order
+    candidates = OS_GetDecoderCandidates(first, "sshd", &decoder_match);
+    assert_ptr_equal(candidates[0], first);
+    assert_ptr_equal(candidates[1], third);
+    assert_null(candidates[2]);
+
+    // They are saved the first time
+    assert_ptr_equal(OS_GetDecoderCandidates(first, "sshd", &decoder_match), candidates);
+
+    candidates = OS_GetDecoderCandidates(first, "cron", &decoder_match);
+    assert_ptr_equal(candidates[0], second);
+    assert_ptr_equal(candidates[1], third);
+    assert_null(candidates[2]);
+
+    candidates = OS_GetDecoderCandidates(first, "kernel", &decoder_match);
+    assert_non_null(candidates);
+    assert_null(candidates[0]);
+
+    assert_int_equal(OSHash_Get_Elem_ex(first->program_names), 3);
+
+    free_pname_decoders(first);
+}
+
+void test_OS_GetDecoderCandidates_full(void **state)
+{
+    OSDecoderNode * node = add_pname_decoder(NULL, "sshd");
+    regex_matching decoder_match = {0};
+    char program_name[16];
+
+    OS_BuildDecoderIndex(node);
+
+    for (int i = 0; i < DECODER_PNAME_INDEX_MAX; i++) {
+        snprintf(program_name, sizeof(program_name), "prog%d", i);
+        assert_non_null(OS_GetDecoderCandidates(node, program_name, &decoder_match));
+    }
+
+    // The whole list has to be tried for new program names
+    assert_null(OS_GetDecoderCandidates(node, "sshd", &decoder_match));
+    assert_non_null(OS_GetDecoderCandidates(node, "prog0", &decoder_match));
+
+    free_pname_decoders(node);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -150,7 +247,11 @@ int main(void)
         cmocka_unit_test(test_os_remove_decodernode_no_child),
         cmocka_unit_test(test_os_remove_decodernode_child),
         // Tests os_remove_decoders_list
-        cmocka_unit_test(test_os_remove_decoders_list_OK)
+        cmocka_unit_test(test_os_remove_decoders_list_OK),
+        // Tests OS_GetDecoderCandidates
+        cmocka_unit_test(test_OS_GetDecoderCandidates_no_index),
+        cmocka_unit_test(test_OS_GetDecoderCandidates_OK),
+        cmocka_unit_test(test_OS_GetDecoderCandidates_full)
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
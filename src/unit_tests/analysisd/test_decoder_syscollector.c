@@ -21,6 +21,7 @@
 #include "../headers/wazuhdb_op.h"
 
 extern int DecodeSyscollector(Eventinfo *lf, int *socket);
+extern char ** SyscollectorSplitBatch(const char *msg);
 extern _Config Config;
 
 /* setup / teardown */
@@ -3756,6 +3757,31 @@ void test_syscollector_process_end (void **state)
     assert_int_not_equal(ret, -1);
 }
 
+void test_syscollector_split_batch(void **state)
+{
+    const char *msg = "d:[001] (agent) any->syscollector:{\"type\":\"dbsync_processes\",\"batch\":["
+                      "{\"operation\":\"INSERTED\",\"data\":{\"pid\":\"1\"}},5,"
+                      "{\"operation\":\"DELETED\",\"data\":{\"pid\":\"2\"}}]}";
+
+    expect_string(__wrap__mdebug1, formatted_msg, "Invalid delta in the batch of 'dbsync_processes'.");
+
+    char **messages = SyscollectorSplitBatch(msg);
+
+    assert_non_null(messages);
+    assert_string_equal(messages[0], "d:[001] (agent) any->syscollector:{\"operation\":\"INSERTED\",\"data\":{\"pid\":\"1\"},\"type\":\"dbsync_processes\"}");
+    assert_string_equal(messages[1], "d:[001] (agent) any->syscollector:{\"operation\":\"DELETED\",\"data\":{\"pid\":\"2\"},\"type\":\"dbsync_processes\"}");
+    assert_null(messages[2]);
+
+    free_strarray(messages);
+}
+
+void test_syscollector_split_batch_single_delta(void **state)
+{
+    assert_null(SyscollectorSplitBatch("d:syscollector:{\"type\":\"dbsync_processes\",\"operation\":\"INSERTED\",\"data\":{\"name\":\"\\\"batch\\\":[\"}}"));
+    assert_null(SyscollectorSplitBatch("d:syscollector:{\"type\":\"dbsync_processes\",\"batch\":{}}"));
+    assert_null(SyscollectorSplitBatch("d"));
+}
+
 int main()
 {
     const struct CMUnitTest tests[] = {
@@ -3836,7 +3862,10 @@ int main()
         cmocka_unit_test_setup_teardown(test_syscollector_process_valid, test_setup_process_valid_msg, test_cleanup),
         cmocka_unit_test_setup_teardown(test_syscollector_process_empty, test_setup_process_valid_msg_process_empty, test_cleanup),
         cmocka_unit_test_setup_teardown(test_syscollector_process_valid_without_ID, test_setup_process_valid_msg_without_ID, test_cleanup),
-        cmocka_unit_test_setup_teardown(test_syscollector_process_end, test_setup_process_valid_msg_process_end, test_cleanup)
+        cmocka_unit_test_setup_teardown(test_syscollector_process_end, test_setup_process_valid_msg_process_end, test_cleanup),
+        // Batch tests
+        cmocka_unit_test(test_syscollector_split_batch),
+        cmocka_unit_test(test_syscollector_split_batch_single_delta)
     };
     return cmocka_run_group_tests(tests, test_setup_global, NULL);
 }
@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+
+#include "../../headers/shared.h"
+#include "../../analysisd/eventinfo.h"
+#include "../../analysisd/config.h"
+#include "../../analysisd/analysisd.h"
+#include "../wrappers/wazuh/shared/debug_op_wrappers.h"
+
+char *w_sid_index_key(const RuleInfo *rule, const Eventinfo *lf);
+
+/* setup/teardown */
+
+static int setup_group(void **state) {
+    Config.decoder_order_size = 4;
+    return 0;
+}
+
+static void init_sid_rules(RuleInfo *parent, RuleInfo *rule) {
+    memset(parent, 0, sizeof(RuleInfo));
+    memset(rule, 0, sizeof(RuleInfo));
+
+    parent->sigid = 100;
+    parent->sid_prev_matched = OSList_Create();
+
+    rule->sigid = 101;
+    rule->level = 10;
+    rule->frequency = 1;
+    rule->timeframe = 60;
+    rule->same_field = FIELD_SRCIP;
+    rule->sid_search = parent->sid_prev_matched;
+
+    w_sid_index_init(parent, rule);
+}
+
+static void free_sid_rules(RuleInfo *parent, RuleInfo *rule) {
+    w_sid_index_free(rule);
+    os_free(parent->sid_prev_index);
+    OSList_Destroy(parent->sid_prev_matched);
+}
+
+/* Event generated by the parent rule, stored as analysisd does */
+static Eventinfo *add_sid_event(RuleInfo *parent, const char *agent_id, const char *srcip) {
+    Eventinfo *lf = w_alloc_event_info();
+
+    os_strdup(agent_id, lf->agent_id);
+    if (srcip) {
+        os_strdup(srcip, lf->srcip);
+    }
+    os_strdup("log", lf->full_log);
+    lf->generated_rule = parent;
+    lf->sid_node_to_delete = OSList_AddData(parent->sid_prev_matched, lf);
+    w_sid_index_add(parent, lf);
+
+    return lf;
+}
+
+static Eventinfo *new_sid_event(const char *agent_id, const char *srcip) {
+    Eventinfo *lf = w_alloc_event_info();
+
+    os_strdup(agent_id, lf->agent_id);
+    os_strdup(srcip, lf->srcip);
+    os_strdup("log", lf->full_log);
+
+    return lf;
+}
+
+/* tests */
+
+/* w_alloc_event_info */
+void test_w_alloc_event_info_new(void **state)
+{
+    Eventinfo *lf = w_alloc_event_info();
+
+    assert_non_null(lf);
+    assert_non_null(lf->fields);
+    assert_int_equal(lf->pooled, 1);
+    assert_int_equal(lf->nfields, 0);
+    assert_int_equal(lf->tid, -1);
+    assert_int_equal(lf->r_firedtimes, -1);
+
+    Free_Eventinfo(lf);
+}
+
+void test_w_alloc_event_info_reuse(void **state)
+{
+    Eventinfo *lf = w_alloc_event_info();
+    DynamicField *fields = lf->fields;
+    Eventinfo *reused;
+
+    os_strdup("key", lf->fields[0].key);
+    os_strdup("value", lf->fields[0].value);
+    lf->nfields = 1;
+    os_strdup("10.0.0.1", lf->srcip);
+    lf->generate_time = 1000;
+
+    Free_Eventinfo(lf);
+
+    reused = w_alloc_event_info();
+
+    assert_ptr_equal(reused, lf);
+    assert_ptr_equal(reused->fields, fields);
+    assert_null(reused->fields[0].key);
+    assert_null(reused->fields[0].value);
+    assert_int_equal(reused->nfields, 0);
+    assert_null(reused->srcip);
+    assert_int_equal(reused->generate_time, 0);
+    assert_int_equal(reused->pooled, 1);
+
+    Free_Eventinfo(reused);
+}
+
+void test_w_alloc_event_info_copy_not_pooled(void **state)
+{
+    Eventinfo *lf = w_alloc_event_info();
+    Eventinfo *lf_cpy;
+    Eventinfo *next;
+
+    os_calloc(1, sizeof(Eventinfo), lf_cpy);
+    w_copy_event_for_log(lf, lf_cpy);
+
+    assert_int_equal(lf_cpy->pooled, 0);
+
+    // The copy is freed, only the original returns to the pool
+    Free_Eventinfo(lf_cpy);
+    Free_Eventinfo(lf);
+
+    next = w_alloc_event_info();
+    assert_ptr_equal(next, lf);
+
+    Free_Eventinfo(next);
+}
+
+void test_w_alloc_event_info_pool_full(void **state)
+{
+    Eventinfo **events;
+
+    os_calloc(EVENTINFO_POOL_SIZE + 1, sizeof(Eventinfo *), events);
+
+    for (int i = 0; i <= EVENTINFO_POOL_SIZE; i++) {
+        events[i] = w_alloc_event_info();
+    }
+
+    // The last one doesn't fit in the pool and is freed
+    for (int i = 0; i <= EVENTINFO_POOL_SIZE; i++) {
+        Free_Eventinfo(events[i]);
+    }
+
+    for (int i = 0; i < EVENTINFO_POOL_SIZE; i++) {
+        events[i] = w_alloc_event_info();
+        assert_int_equal(events[i]->pooled, 1);
+    }
+
+    for (int i = 0; i < EVENTINFO_POOL_SIZE; i++) {
+        Free_Eventinfo(events[i]);
+    }
+
+    os_free(events);
+}
+
+/* w_sid_index */
+void test_w_sid_index_key(void **state)
+{
+    RuleInfo rule = { .same_field = FIELD_SRCIP | FIELD_USER, .alert_opts = SAME_EXTRAINFO };
+    Eventinfo lf = { .agent_id = "001", .srcip = "10.0.0.1", .dstuser = "root" };
+    char *key;
+
+    key = w_sid_index_key(&rule, &lf);
+    assert_string_equal(key, "001\n10.0.0.1\nroot\n");
+    os_free(key);
+
+    // An event without a value of the key can't match any other event
+    lf.dstuser = NULL;
+    assert_null(w_sid_index_key(&rule, &lf));
+
+    rule.context_opts = FIELD_GFREQUENCY;
+    rule.same_field = FIELD_SRCIP;
+    rule.alert_opts = 0;
+    lf.agent_id = NULL;
+    key = w_sid_index_key(&rule, &lf);
+    assert_string_equal(key, "10.0.0.1\n");
+    os_free(key);
+}
+
+void test_w_sid_index_init_no_key(void **state)
+{
+    RuleInfo parent = { .sigid = 100 };
+    RuleInfo rule = { .sigid = 101, .context_opts = FIELD_GFREQUENCY };
+
+    // A global frequency rule without same fields searches the whole list
+    w_sid_index_init(&parent, &rule);
+
+    assert_null(rule.sid_index);
+    assert_int_equal(parent.sid_prev_index_sz, 0);
+}
+
+void test_Search_LastSids_index(void **state)
+{
+    RuleInfo parent;
+    RuleInfo rule;
+    Eventinfo *events[4];
+    Eventinfo *my_lf;
+
+    init_sid_rules(&parent, &rule);
+
+    assert_non_null(rule.sid_index);
+    assert_int_equal(parent.sid_prev_index_sz, 1);
+    assert_ptr_equal(parent.sid_prev_index[0], rule.sid_index);
+
+    events[0] = add_sid_event(&parent, "001", "10.0.0.1");
+    events[1] = add_sid_event(&parent, "001", "10.0.0.2");
+    events[2] = add_sid_event(&parent, "002", "10.0.0.1");
+    events[3] = add_sid_event(&parent, "001", NULL);
+
+    assert_null(events[3]->sid_index_entries[0].node);
+
+    // Only one previous event from the same agent and source
+    my_lf = new_sid_event("001", "10.0.0.1");
+    assert_null(Search_LastSids(my_lf, NULL, &rule, NULL));
+    assert_int_equal(my_lf->matched, 0);
+    Free_Eventinfo(my_lf);
+
+    Free_Eventinfo(events[3]);
+    events[3] = add_sid_event(&parent, "001", "10.0.0.1");
+
+    my_lf = new_sid_event("001", "10.0.0.1");
+    assert_ptr_equal(Search_LastSids(my_lf, NULL, &rule, NULL), events[0]);
+    assert_int_equal(my_lf->matched, 10);
+    assert_int_equal(events[3]->matched, 10);
+    assert_int_equal(events[1]->matched, 0);
+    Free_Eventinfo(my_lf);
+
+    for (int i = 0; i < 4; i++) {
+        Free_Eventinfo(events[i]);
+    }
+
+    // Empty buckets are removed
+    assert_int_equal(rule.sid_index->buckets->elements, 0);
+    assert_int_equal(parent.sid_prev_matched->currently_size, 0);
+
+    free_sid_rules(&parent, &rule);
+}
+
+void test_Search_LastSids_index_missing_key(void **state)
+{
+    RuleInfo parent;
+    RuleInfo rule;
+    Eventinfo *lf;
+    Eventinfo *my_lf;
+
+    init_sid_rules(&parent, &rule);
+
+    lf = add_sid_event(&parent, "001", "10.0.0.1");
+
+    my_lf = new_sid_event("001", "10.0.0.1");
+    os_free(my_lf->srcip);
+    assert_null(Search_LastSids(my_lf, NULL, &rule, NULL));
+    Free_Eventinfo(my_lf);
+
+    my_lf = new_sid_event("001", "10.0.0.9");
+    assert_null(Search_LastSids(my_lf, NULL, &rule, NULL));
+    Free_Eventinfo(my_lf);
+
+    Free_Eventinfo(lf);
+    free_sid_rules(&parent, &rule);
+}
+
+void test_Search_LastSids_index_key_changed(void **state)
+{
+    RuleInfo parent;
+    RuleInfo rule;
+    Eventinfo *lf;
+
+    init_sid_rules(&parent, &rule);
+
+    lf = add_sid_event(&parent, "001", "10.0.0.1");
+    assert_int_equal(rule.sid_index->buckets->elements, 1);
+
+    // The event leaves the bucket it was added to, whatever its values are now
+    os_free(lf->srcip);
+    os_strdup("10.0.0.9", lf->srcip);
+    Free_Eventinfo(lf);
+
+    assert_int_equal(rule.sid_index->buckets->elements, 0);
+
+    free_sid_rules(&parent, &rule);
+}
+
+/* w_event_shard */
+
+static void test_w_event_shard_agent(void **state) {
+    // The events of an agent go to the same queue whatever their location
+    assert_int_equal(w_event_shard("001", "/var/log/syslog", 8), w_event_shard("001", "/var/log/auth.log", 8));
+    assert_int_equal(w_event_shard("001", NULL, 1), 0);
+    assert_int_equal(w_event_shard("001", NULL, 0), 0);
+}
+
+static void test_w_event_shard_manager_locations(void **state) {
+    char location[OS_SIZE_32];
+    size_t counts[8] = {0};
+    int used = 0;
+
+    for (int i = 0; i < 256; i++) {
+        snprintf(location, sizeof(location), "10.0.%d.%d", i / 16, i % 16);
+        size_t shard = w_event_shard("000", location, 8);
+        assert_true(shard < 8);
+        counts[shard]++;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        used += counts[i] > 0;
+    }
+
+    // The sources of the manager are spread across the queues, each one keeps its own queue
+    assert_int_equal(used, 8);
+    assert_int_equal(w_event_shard("000", "10.0.0.1", 8), w_event_shard("000", "10.0.0.1", 8));
+    assert_int_equal(w_event_shard(NULL, "10.0.0.1", 8), w_event_shard("000", "10.0.0.1", 8));
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        // Tests w_alloc_event_info
+        cmocka_unit_test(test_w_alloc_event_info_new),
+        cmocka_unit_test(test_w_alloc_event_info_reuse),
+        cmocka_unit_test(test_w_alloc_event_info_copy_not_pooled),
+        cmocka_unit_test(test_w_alloc_event_info_pool_full),
+        // Tests w_sid_index
+        cmocka_unit_test(test_w_sid_index_key),
+        cmocka_unit_test(test_w_sid_index_init_no_key),
+        cmocka_unit_test(test_Search_LastSids_index),
+        cmocka_unit_test(test_Search_LastSids_index_missing_key),
+        cmocka_unit_test(test_Search_LastSids_index_key_changed),
+        // w_event_shard
+        cmocka_unit_test(test_w_event_shard_agent),
+        cmocka_unit_test(test_w_event_shard_manager_locations),
+    };
+
+    return cmocka_run_group_tests(tests, setup_group, NULL);
+}
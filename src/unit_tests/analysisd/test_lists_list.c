@@ -16,7 +16,9 @@
 #include "../../headers/shared.h"
 #include "../../analysisd/rules.h"
 #include "../../analysisd/cdb/cdb.h"
+#include "../../analysisd/cdb/cdb_make.h"
 #include "../../analysisd/analysisd.h"
+#include "../wrappers/wazuh/shared/debug_op_wrappers.h"
 #include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
@@ -26,9 +28,77 @@ void os_remove_cdblist(ListNode **l_node);
 void os_remove_cdbrules(ListRule **l_rule);
 ListNode *OS_FindList(const char *listname, ListNode **l_node);
 void OS_ListLoadRules(ListNode **l_node, ListRule **lrule);
+void __real_OSMatch_FreePattern(OSMatch *reg);
 
 /* setup/teardown */
 
+static int setup_cdb_list(void **state) {
+    struct cdb_make cdbm;
+    ListNode *node;
+    FILE *fp;
+    int fd;
+
+    os_calloc(1, sizeof(ListNode), node);
+    os_strdup("/tmp/tmp_list-XXXXXX", node->cdb_filename);
+    os_strdup("tmp_list", node->txt_filename);
+    node->mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+    node->cdb_lock = (pthread_rwlock_t) PTHREAD_RWLOCK_INITIALIZER;
+
+    if (fd = mkstemp(node->cdb_filename), fd < 0 || !(fp = fdopen(fd, "w"))) {
+        return -1;
+    }
+
+    cdb_make_start(&cdbm, fp);
+    cdb_make_add(&cdbm, "10.0.0.1", 8, "single", 6);
+    cdb_make_add(&cdbm, "192.168.", 8, "subnet", 6);
+    cdb_make_add(&cdbm, "root", 4, "admin", 5);
+    cdb_make_finish(&cdbm);
+    fclose(fp);
+
+    *state = node;
+    return 0;
+}
+
+static int teardown_cdb_list(void **state) {
+    ListNode *node = *state;
+
+    if (node->loaded) {
+        cdb_free(&node->cdb);
+        close(node->cdb.fd);
+    }
+    unlink(node->cdb_filename);
+    os_free(node->cdb_filename);
+    os_free(node->txt_filename);
+    os_free(node);
+
+    return 0;
+}
+
+static ListRule *create_list_rule(ListNode *node, int lookup_type, char *value) {
+    ListRule *lrule;
+
+    os_calloc(1, sizeof(ListRule), lrule);
+    lrule->lookup_type = lookup_type;
+    lrule->db = node;
+    lrule->loaded = 1;
+    lrule->mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+
+    if (value) {
+        os_calloc(1, sizeof(OSMatch), lrule->matcher);
+        OSMatch_Compile(value, lrule->matcher, 0);
+    }
+
+    return lrule;
+}
+
+static void free_list_rule(ListRule *lrule) {
+    if (lrule->matcher) {
+        __real_OSMatch_FreePattern(lrule->matcher);
+        os_free(lrule->matcher);
+    }
+    os_free(lrule);
+}
+
 
 
 /* wraps */
@@ -203,6 +273,118 @@ void test_OS_ListLoadRules_already_load(void ** state) {
     os_free(lrule);
 }
 
+/* OS_DBSearch */
+void test_OS_DBSearch_string_match(void **state) {
+    ListNode *node = *state;
+    ListRule *lrule = create_list_rule(node, LR_STRING_MATCH, NULL);
+
+    assert_int_equal(OS_DBSearch(lrule, "root", NULL), 1);
+    assert_int_equal(OS_DBSearch(lrule, "roo", NULL), 0);
+    assert_int_equal(node->loaded, 1);
+
+    lrule->lookup_type = LR_STRING_NOT_MATCH;
+    assert_int_equal(OS_DBSearch(lrule, "root", NULL), 0);
+    assert_int_equal(OS_DBSearch(lrule, "admin", NULL), 1);
+
+    free_list_rule(lrule);
+}
+
+void test_OS_DBSearch_string_match_value(void **state) {
+    ListNode *node = *state;
+    ListRule *lrule = create_list_rule(node, LR_STRING_MATCH_VALUE, "admin");
+    ListRule *lrule_other = create_list_rule(node, LR_STRING_MATCH_VALUE, "guest");
+
+    assert_int_equal(OS_DBSearch(lrule, "root", NULL), 1);
+    assert_int_equal(OS_DBSearch(lrule, "user", NULL), 0);
+    assert_int_equal(OS_DBSearch(lrule_other, "root", NULL), 0);
+
+    free_list_rule(lrule);
+    free_list_rule(lrule_other);
+}
+
+void test_OS_DBSearch_address_match(void **state) {
+    ListNode *node = *state;
+    ListRule *lrule = create_list_rule(node, LR_ADDRESS_MATCH, NULL);
+
+    assert_int_equal(OS_DBSearch(lrule, "10.0.0.1", NULL), 1);
+    assert_int_equal(OS_DBSearch(lrule, "10.0.0.10", NULL), 0);
+    // Subnets are matched by prefix
+    assert_int_equal(OS_DBSearch(lrule, "192.168.1.20", NULL), 1);
+    assert_int_equal(OS_DBSearch(lrule, "192.169.1.20", NULL), 0);
+
+    lrule->lookup_type = LR_ADDRESS_NOT_MATCH;
+    assert_int_equal(OS_DBSearch(lrule, "192.168.1.20", NULL), 0);
+    assert_int_equal(OS_DBSearch(lrule, "8.8.8.8", NULL), 1);
+
+    free_list_rule(lrule);
+}
+
+void test_OS_DBSearch_address_match_value(void **state) {
+    ListNode *node = *state;
+    ListRule *lrule = create_list_rule(node, LR_ADDRESS_MATCH_VALUE, "subnet");
+
+    // The value lookup is true when the value doesn't match
+    assert_int_equal(OS_DBSearch(lrule, "192.168.1.20", NULL), 0);
+    assert_int_equal(OS_DBSearch(lrule, "10.0.0.1", NULL), 1);
+    assert_int_equal(OS_DBSearch(lrule, "8.8.8.8", NULL), 1);
+
+    free_list_rule(lrule);
+}
+
+void test_OS_DBSearch_open_error(void **state) {
+    ListNode *node = *state;
+    ListRule *lrule = create_list_rule(node, LR_STRING_MATCH, NULL);
+
+    unlink(node->cdb_filename);
+    expect_any(__wrap__merror, formatted_msg);
+
+    assert_int_equal(OS_DBSearch(lrule, "root", NULL), 0);
+    assert_int_equal(node->loaded, 0);
+
+    free_list_rule(lrule);
+}
+
+/* OS_ReloadList */
+void test_OS_ReloadList(void **state) {
+    ListNode *node = *state;
+    ListRule *lrule = create_list_rule(node, LR_STRING_MATCH, NULL);
+    struct cdb_make cdbm;
+    char tmp_filename[PATH_MAX];
+    FILE *fp;
+    int fd;
+
+    assert_int_equal(OS_DBSearch(lrule, "root", NULL), 1);
+
+    snprintf(tmp_filename, PATH_MAX, "%s.XXXXXX", node->cdb_filename);
+    fd = mkstemp(tmp_filename);
+    assert_true(fd >= 0);
+    fp = fdopen(fd, "w");
+    cdb_make_start(&cdbm, fp);
+    cdb_make_add(&cdbm, "wazuh", 5, "admin", 5);
+    cdb_make_finish(&cdbm);
+    fclose(fp);
+    assert_int_equal(rename(tmp_filename, node->cdb_filename), 0);
+
+    // The replaced cdb is still mapped
+    assert_int_equal(OS_DBSearch(lrule, "root", NULL), 1);
+
+    OS_ReloadList(node);
+    assert_int_equal(node->loaded, 0);
+
+    assert_int_equal(OS_DBSearch(lrule, "root", NULL), 0);
+    assert_int_equal(OS_DBSearch(lrule, "wazuh", NULL), 1);
+    assert_int_equal(node->loaded, 1);
+
+    free_list_rule(lrule);
+}
+
+void test_OS_ReloadList_not_loaded(void **state) {
+    ListNode *node = *state;
+
+    OS_ReloadList(node);
+    assert_int_equal(node->loaded, 0);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -220,6 +402,15 @@ int main(void)
         cmocka_unit_test(test_OS_ListLoadRules_list_checked),
         cmocka_unit_test(test_OS_ListLoadRules_list_checked_and_load),
         cmocka_unit_test(test_OS_ListLoadRules_already_load),
+        // Tests OS_DBSearch
+        cmocka_unit_test_setup_teardown(test_OS_DBSearch_string_match, setup_cdb_list, teardown_cdb_list),
+        cmocka_unit_test_setup_teardown(test_OS_DBSearch_string_match_value, setup_cdb_list, teardown_cdb_list),
+        cmocka_unit_test_setup_teardown(test_OS_DBSearch_address_match, setup_cdb_list, teardown_cdb_list),
+        cmocka_unit_test_setup_teardown(test_OS_DBSearch_address_match_value, setup_cdb_list, teardown_cdb_list),
+        cmocka_unit_test_setup_teardown(test_OS_DBSearch_open_error, setup_cdb_list, teardown_cdb_list),
+        // Tests OS_ReloadList
+        cmocka_unit_test_setup_teardown(test_OS_ReloadList, setup_cdb_list, teardown_cdb_list),
+        cmocka_unit_test_setup_teardown(test_OS_ReloadList_not_loaded, setup_cdb_list, teardown_cdb_list),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <utime.h>
+
+#include "../../headers/shared.h"
+#include "../../analysisd/rules.h"
+#include "../../analysisd/lists_make.h"
+#include "../wrappers/wazuh/shared/debug_op_wrappers.h"
+
+#define LISTS_COUNT 5
+
+/* The lists are written to a real folder */
+
+typedef struct lists_state {
+    char folder[PATH_MAX];
+    ListNode *lists;
+} lists_state;
+
+static void write_list(const char *path, const char *content) {
+    FILE *fp = fopen(path, "w");
+
+    assert_non_null(fp);
+    fputs(content, fp);
+    fclose(fp);
+}
+
+static int lookup(ListNode *node, const char *key) {
+    ListRule lrule = { .lookup_type = LR_STRING_MATCH, .db = node, .loaded = 1,
+                       .mutex = PTHREAD_MUTEX_INITIALIZER };
+
+    return OS_DBSearch(&lrule, (char *)key, NULL);
+}
+
+static void make_older(const char *path) {
+    struct utimbuf times = { .actime = time(NULL) - 10, .modtime = time(NULL) - 10 };
+
+    assert_int_equal(utime(path, &times), 0);
+}
+
+/* setup/teardown */
+
+static int setup_lists(void **state) {
+    lists_state *data;
+    char path[PATH_MAX];
+
+    os_calloc(1, sizeof(lists_state), data);
+    strcpy(data->folder, "/tmp/lists_make_XXXXXX");
+
+    if (!mkdtemp(data->folder)) {
+        os_free(data);
+        return -1;
+    }
+
+    for (int i = 0; i < LISTS_COUNT; i++) {
+        ListNode *node;
+
+        os_calloc(1, sizeof(ListNode), node);
+        snprintf(path, PATH_MAX, "%s/list-%d", data->folder, i);
+        os_strdup(path, node->txt_filename);
+        snprintf(path, PATH_MAX, "%s/list-%d.cdb", data->folder, i);
+        os_strdup(path, node->cdb_filename);
+        node->mutex = (pthread_mutex_t) PTHREAD_MUTEX_INITIALIZER;
+        node->cdb_lock = (pthread_rwlock_t) PTHREAD_RWLOCK_INITIALIZER;
+        write_list(node->txt_filename, "root:admin\n\"quoted:key\":value\n");
+        OS_AddList(node, &data->lists);
+    }
+
+    Lists_OP_MakeThreads(LISTS_COUNT - 1);
+
+    *state = data;
+    return 0;
+}
+
+static int teardown_lists(void **state) {
+    lists_state *data = *state;
+
+    for (ListNode *node = data->lists; node; node = node->next) {
+        if (node->loaded) {
+            cdb_free(&node->cdb);
+            close(node->cdb.fd);
+        }
+    }
+
+    os_remove_cdblist(&data->lists);
+    rmdir_ex(data->folder);
+    os_free(data);
+
+    Lists_OP_MakeThreads(1);
+
+    return 0;
+}
+
+/* tests */
+
+/* Lists_OP_MakeCDB */
+
+void test_Lists_OP_MakeCDB_compiled(void **state) {
+    lists_state *data = *state;
+    ListNode *node = data->lists;
+
+    assert_int_equal(Lists_OP_MakeCDB(node->txt_filename, node->cdb_filename, 0, 0), 1);
+
+    assert_int_equal(lookup(node, "root"), 1);
+    assert_int_equal(lookup(node, "quoted:key"), 1);
+    assert_int_equal(lookup(node, "admin"), 0);
+}
+
+void test_Lists_OP_MakeCDB_up_to_date(void **state) {
+    lists_state *data = *state;
+    ListNode *node = data->lists;
+
+    make_older(node->txt_filename);
+    assert_int_equal(Lists_OP_MakeCDB(node->txt_filename, node->cdb_filename, 0, 0), 1);
+    assert_int_equal(Lists_OP_MakeCDB(node->txt_filename, node->cdb_filename, 0, 0), 0);
+}
+
+void test_Lists_OP_MakeCDB_missing_list(void **state) {
+    lists_state *data = *state;
+    ListNode *node = data->lists;
+
+    unlink(node->txt_filename);
+    expect_any(__wrap__merror, formatted_msg);
+
+    assert_int_equal(Lists_OP_MakeCDB(node->txt_filename, node->cdb_filename, 1, 0), -1);
+    assert_int_equal(IsFile(node->cdb_filename), -1);
+}
+
+/* Lists_OP_MakeAll */
+
+void test_Lists_OP_MakeAll(void **state) {
+    lists_state *data = *state;
+
+    Lists_OP_MakeAll(0, 0, &data->lists);
+
+    for (ListNode *node = data->lists; node; node = node->next) {
+        assert_int_equal(IsFile(node->cdb_filename), 0);
+        assert_int_equal(lookup(node, "root"), 1);
+    }
+}
+
+/* Lists_OP_ReloadAll */
+
+void test_Lists_OP_ReloadAll(void **state) {
+    lists_state *data = *state;
+    ListNode *changed = data->lists->next;
+
+    for (ListNode *node = data->lists; node; node = node->next) {
+        make_older(node->txt_filename);
+    }
+
+    Lists_OP_MakeAll(0, 0, &data->lists);
+
+    for (ListNode *node = data->lists; node; node = node->next) {
+        assert_int_equal(lookup(node, "root"), 1);
+        make_older(node->cdb_filename);
+    }
+
+    write_list(changed->txt_filename, "wazuh:admin\n");
+    expect_any(__wrap__mdebug1, formatted_msg);
+
+    Lists_OP_ReloadAll(&data->lists);
+
+    // Only the changed list is swapped
+    assert_int_equal(lookup(changed, "root"), 0);
+    assert_int_equal(lookup(changed, "wazuh"), 1);
+
+    for (ListNode *node = data->lists; node; node = node->next) {
+        if (node != changed) {
+            assert_int_equal(node->loaded, 1);
+            assert_int_equal(lookup(node, "root"), 1);
+        }
+    }
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        // Tests Lists_OP_MakeCDB
+        cmocka_unit_test_setup_teardown(test_Lists_OP_MakeCDB_compiled, setup_lists, teardown_lists),
+        cmocka_unit_test_setup_teardown(test_Lists_OP_MakeCDB_up_to_date, setup_lists, teardown_lists),
+        cmocka_unit_test_setup_teardown(test_Lists_OP_MakeCDB_missing_list, setup_lists, teardown_lists),
+        // Tests Lists_OP_MakeAll
+        cmocka_unit_test_setup_teardown(test_Lists_OP_MakeAll, setup_lists, teardown_lists),
+        // Tests Lists_OP_ReloadAll
+        cmocka_unit_test_setup_teardown(test_Lists_OP_ReloadAll, setup_lists, teardown_lists),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -374,7 +374,7 @@ int __wrap__setlevels(RuleNode *node, int nnode) {
     return mock_type(int);
 }
 
-int __wrap_AddHash_Rule(RuleNode *node) {
+int __wrap_AddHash_Rule(OSHash *hash, RuleNode *node) {
     return mock_type(int);
 }
 
@@ -895,11 +895,44 @@ void test_w_logtest_remove_session_OK(void **state)
     char * key = "test";
     w_logtest_session_t *session;
     os_calloc(1, sizeof(w_logtest_session_t), session);
+    os_calloc(1, sizeof(w_logtest_ruleset_t), session->ruleset);
+    os_calloc(1, sizeof(OSList), session->ruleset->load_msg);
+    session->ruleset->decoder_store = (OSStore *) 8;
+    session->ruleset->references = 1;
 
     expect_value(__wrap_OSHash_Delete, key, "test");
     will_return(__wrap_OSHash_Delete, session);
 
-    will_return(__wrap_OSStore_Free, session->decoder_store);
+    /* The last reference frees the ruleset */
+    will_return(__wrap_OSStore_Free, NULL);
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
+
+    will_return(__wrap_OSHash_Free, session);
+
+    will_return(__wrap_OSHash_Free, session);
+
+    will_return(__wrap_pthread_mutex_destroy, 0);
+
+    expect_string(__wrap__mdebug1, formatted_msg, "(7206): The session 'test' was closed successfully");
+
+    w_logtest_remove_session(key);
+
+}
+
+void test_w_logtest_remove_session_shared_ruleset(void **state)
+{
+    char * key = "test";
+    w_logtest_ruleset_t ruleset = {.references = 2};
+    w_logtest_session_t *session;
+    os_calloc(1, sizeof(w_logtest_session_t), session);
+    session->ruleset = &ruleset;
+
+    expect_value(__wrap_OSHash_Delete, key, "test");
+    will_return(__wrap_OSHash_Delete, session);
 
     will_return(__wrap_OSHash_Free, session);
 
@@ -911,6 +944,8 @@ void test_w_logtest_remove_session_OK(void **state)
 
     w_logtest_remove_session(key);
 
+    // The ruleset is kept for the other sessions
+    assert_int_equal(ruleset.references, 1);
 }
 
 /* w_logtest_check_inactive_sessions */
@@ -997,8 +1032,6 @@ void test_w_logtest_check_inactive_sessions_remove(void **state)
     expect_value(__wrap_OSHash_Delete, key, "test");
     will_return(__wrap_OSHash_Delete, session);
 
-    will_return(__wrap_OSStore_Free, NULL);
-
     will_return(__wrap_OSHash_Free, session);
 
     will_return(__wrap_OSHash_Free, session);
@@ -1061,8 +1094,6 @@ void test_w_logtest_remove_old_session_one(void ** state) {
     expect_string(__wrap_OSHash_Delete, key, "old_session");
     will_return(__wrap_OSHash_Delete, old_session);
 
-    will_return(__wrap_OSStore_Free, old_session->decoder_store);
-
     will_return(__wrap_OSHash_Free, old_session);
 
     will_return(__wrap_OSHash_Free, old_session);
@@ -1116,8 +1147,6 @@ void test_w_logtest_remove_old_session_many(void ** state) {
     expect_value(__wrap_OSHash_Delete, key, old_session->token);
     will_return(__wrap_OSHash_Delete, old_session);
 
-    will_return(__wrap_OSStore_Free, NULL);
-
     will_return(__wrap_OSHash_Free, old_session);
 
     will_return(__wrap_OSHash_Free, old_session);
@@ -1198,8 +1227,6 @@ void test_w_logtest_register_session_remove_old(void ** state) {
     expect_value(__wrap_OSHash_Delete, key, old_session->token);
     will_return(__wrap_OSHash_Delete, old_session);
 
-    will_return(__wrap_OSStore_Free, NULL);
-
     will_return(__wrap_OSHash_Free, old_session);
 
     will_return(__wrap_OSHash_Free, old_session);
@@ -1299,7 +1326,16 @@ void test_w_logtest_initialize_session_error_decoders(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 0);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
 
 
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -1352,11 +1388,20 @@ void test_w_logtest_initialize_session_error_set_decoders(void ** state) {
     will_return(__wrap_Read_Rules, 0);
 
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 0);
 
     // test_w_logtest_remove_session_ok_error_load_decoder_cbd_rules_hash
     will_return(__wrap_OSStore_Free, (OSStore *) 8);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
 
@@ -1407,12 +1452,21 @@ void test_w_logtest_initialize_session_error_cbd_list(void ** state) {
     will_return(__wrap_Read_Rules, 0);
 
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, -1);
 
     // test_w_logtest_remove_session_ok_error_load_decoder_cbd_rules_hash
     will_return(__wrap_OSStore_Free, (OSStore *) 8);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
 
@@ -1462,6 +1516,9 @@ void test_w_logtest_initialize_session_error_rules(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1469,6 +1526,12 @@ void test_w_logtest_initialize_session_error_rules(void ** state) {
 
     // test_w_logtest_remove_session_ok_error_load_decoder_cbd_rules_hash
     will_return(__wrap_OSStore_Free, (OSStore *) 8);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
 
@@ -1518,6 +1581,9 @@ void test_w_logtest_initialize_session_error_hash_rules(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1527,6 +1593,12 @@ void test_w_logtest_initialize_session_error_hash_rules(void ** state) {
 
     // test_w_logtest_remove_session_ok_error_load_decoder_cbd_rules_hash
     will_return(__wrap_OSStore_Free, (OSStore *) 8);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
 
@@ -1577,6 +1649,9 @@ void test_w_logtest_initialize_session_error_fts_init(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1594,6 +1669,12 @@ void test_w_logtest_initialize_session_error_fts_init(void ** state) {
 
     // test_w_logtest_remove_session_ok_error_FTS_INIT
     will_return(__wrap_OSStore_Free, (OSStore *) 8);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
     will_return(__wrap_OSHash_Free, (OSHash *) 0);
 
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -1645,6 +1726,9 @@ void test_w_logtest_initialize_session_error_accumulate_init(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1671,6 +1755,12 @@ void test_w_logtest_initialize_session_error_accumulate_init(void ** state) {
 
     // test_w_logtest_remove_session_ok_error_acm
     will_return(__wrap_OSStore_Free, (OSStore *) 8);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
     will_return(__wrap_OSHash_Free, (OSStore *) 8);
     will_return(__wrap_OSHash_Free, (OSStore *) 8);
 
@@ -1728,6 +1818,9 @@ void test_w_logtest_initialize_session_success(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1755,10 +1848,13 @@ void test_w_logtest_initialize_session_success(void ** state) {
 
     assert_non_null(session);
     assert_int_equal(session->last_connection, 1212);
+    assert_int_equal(session->ruleset->references, 1);
 
     os_free(token);
     os_free(session->eventlist);
     os_free(session->token);
+    os_free(session->ruleset->load_msg);
+    os_free(session->ruleset);
     os_free(session);
 
 }
@@ -1809,6 +1905,9 @@ void test_w_logtest_initialize_session_success_duplicate_key(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -1836,12 +1935,225 @@ void test_w_logtest_initialize_session_success_duplicate_key(void ** state) {
 
     assert_non_null(session);
     assert_int_equal(session->last_connection, 1212);
+    assert_int_equal(session->ruleset->references, 1);
 
     os_free(token);
     os_free(session->eventlist);
     os_free(session->token);
+    os_free(session->ruleset->load_msg);
+    os_free(session->ruleset);
     os_free(session);
 }
+static void write_ruleset_file(const char * path, const char * content) {
+    FILE * fp = fopen(path, "w");
+
+    assert_non_null(fp);
+    fputs(content, fp);
+    fclose(fp);
+}
+
+/* The files of the configuration read by __wrap_Read_Rules */
+static void write_ruleset_files() {
+    write_ruleset_file("test_decoder.xml", "<decoder name=\"test\"/>\n");
+    write_ruleset_file("test_list.xml", "key:value\n");
+    write_ruleset_file("test_rule.xml", "<group name=\"test\"/>\n");
+}
+
+static void remove_ruleset_files() {
+    unlink("test_decoder.xml");
+    unlink("test_list.xml");
+    unlink("test_rule.xml");
+}
+
+static char * get_ruleset_stamp() {
+    char * decoders[] = { "test_decoder.xml", NULL };
+    char * lists[] = { "test_list.xml", NULL };
+    char * includes[] = { "test_rule.xml", NULL };
+    _Config ruleset_config = { .decoders = decoders, .lists = lists, .includes = includes,
+                               .logbylevel = session_level_alert };
+
+    return w_logtest_ruleset_stamp(&ruleset_config);
+}
+
+static void expect_ruleset_load() {
+    expect_function_call_any(__wrap_OS_ClearNode);
+    will_return(__wrap_OS_ReadXML, 0);
+    XML_NODE node;
+    os_calloc(2, sizeof(xml_node *), node);
+    /* <ossec_config></> */
+    os_calloc(1, sizeof(xml_node), node[0]);
+    os_strdup("ossec_config", node[0]->element);
+    will_return(__wrap_OS_GetElementsbyNode, node);
+    XML_NODE conf_section_nodes;
+    os_calloc(3, sizeof(xml_node *), conf_section_nodes);
+    os_calloc(1, sizeof(xml_node), conf_section_nodes[0]);
+    os_calloc(1, sizeof(xml_node), conf_section_nodes[1]);
+    will_return(__wrap_OS_GetElementsbyNode, conf_section_nodes);
+    os_strdup("alerts", conf_section_nodes[0]->element);
+    os_strdup("ruleset", conf_section_nodes[1]->element);
+    will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
+    will_return(__wrap_Read_Alerts, 0);
+    will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
+    will_return(__wrap_Read_Rules, 0);
+}
+
+static void expect_session_state_init() {
+    will_return(__wrap_OSHash_Create, 8);
+    will_return(__wrap_AddHash_Rule, 0);
+
+    /* FTS init success */
+    will_return(__wrap_getDefine_Int, 5);
+    will_return(__wrap_OSList_Create, (OSList *) 8);
+    will_return(__wrap_OSList_SetMaxSize, 1);
+    will_return(__wrap_OSHash_Create, (OSHash *) 8);
+    expect_value(__wrap_OSHash_setSize, new_size, 2048);
+    will_return(__wrap_OSHash_setSize, 1);
+    will_return(__wrap_OSHash_SetFreeDataPointer, 1);
+
+    will_return(__wrap_Accumulate_Init, 1);
+}
+
+void test_w_logtest_initialize_session_shared_ruleset(void ** state) {
+
+    OSList * msg = (OSList *) 8;
+    OSList load_msg = {0};
+    w_logtest_ruleset_t ruleset = { .references = 1, .max_freq = 120, .load_msg = &load_msg };
+    w_logtest_session_t * session;
+
+    write_ruleset_files();
+    ruleset.stamp = get_ruleset_stamp();
+    assert_non_null(ruleset.stamp);
+    w_logtest_ruleset = &ruleset;
+
+    random_bytes_result = 1234565555; // 0x49_95_f9_b3
+    expect_value(__wrap_randombytes, length, W_LOGTEST_TOKEN_LENGH >> 1);
+
+    expect_string(__wrap_OSHash_Get_ex, key, "4995f9b3");
+    will_return(__wrap_OSHash_Get_ex, NULL);
+
+    will_return(__wrap_time, 1212);
+    will_return(__wrap_pthread_mutex_init, 0);
+
+    expect_ruleset_load();
+
+    /* The files haven't changed, nothing is loaded */
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
+    expect_session_state_init();
+
+    session = w_logtest_initialize_session(msg);
+
+    assert_non_null(session);
+    assert_ptr_equal(session->ruleset, &ruleset);
+    assert_int_equal(ruleset.references, 2);
+    assert_int_equal(session->eventlist->_max_freq, 120);
+
+    w_logtest_ruleset = NULL;
+    remove_ruleset_files();
+    os_free(ruleset.stamp);
+    os_free(session->eventlist);
+    os_free(session->token);
+    os_free(session);
+}
+
+void test_w_logtest_initialize_session_changed_ruleset(void ** state) {
+
+    OSList * msg = (OSList *) 8;
+    w_logtest_ruleset_t * old_ruleset;
+    w_logtest_session_t * session;
+
+    write_ruleset_files();
+
+    /* Only the current ruleset references it */
+    os_calloc(1, sizeof(w_logtest_ruleset_t), old_ruleset);
+    os_calloc(1, sizeof(OSList), old_ruleset->load_msg);
+    os_strdup("7|test_decoder.xml:1:0.0:0;|test_list.xml:1:0.0:0;|test_rule.xml:1:0.0:0;", old_ruleset->stamp);
+    old_ruleset->references = 1;
+    w_logtest_ruleset = old_ruleset;
+
+    random_bytes_result = 1234565555; // 0x49_95_f9_b3
+    expect_value(__wrap_randombytes, length, W_LOGTEST_TOKEN_LENGH >> 1);
+
+    expect_string(__wrap_OSHash_Get_ex, key, "4995f9b3");
+    will_return(__wrap_OSHash_Get_ex, NULL);
+
+    will_return(__wrap_time, 1212);
+    will_return(__wrap_pthread_mutex_init, 0);
+
+    expect_ruleset_load();
+
+    will_return(__wrap_pthread_mutex_lock, 0);
+
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
+    will_return(__wrap_ReadDecodeXML, 1);
+    will_return(__wrap_SetDecodeXML, 1);
+    will_return(__wrap_Lists_OP_LoadList, 0);
+    will_return(__wrap_Rules_OP_ReadRules, 0);
+    will_return(__wrap__setlevels, 0);
+
+    will_return(__wrap_pthread_mutex_unlock, 0);
+
+    /* The old ruleset is freed, no session uses it. OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
+
+    expect_session_state_init();
+
+    session = w_logtest_initialize_session(msg);
+
+    assert_non_null(session);
+    assert_ptr_equal(session->ruleset, w_logtest_ruleset);
+    assert_ptr_not_equal(session->ruleset, old_ruleset);
+    assert_int_equal(session->ruleset->references, 2);
+    assert_non_null(session->ruleset->stamp);
+
+    w_logtest_ruleset = NULL;
+    remove_ruleset_files();
+    os_free(session->ruleset->stamp);
+    os_free(session->ruleset->load_msg);
+    os_free(session->ruleset);
+    os_free(session->eventlist);
+    os_free(session->token);
+    os_free(session);
+}
+
+/* w_logtest_ruleset_stamp */
+void test_w_logtest_ruleset_stamp_changed_file(void ** state) {
+
+    char * stamp;
+    char * new_stamp;
+
+    write_ruleset_files();
+    stamp = get_ruleset_stamp();
+    assert_non_null(stamp);
+
+    write_ruleset_file("test_rule.xml", "<group name=\"test,changed\"/>\n");
+    new_stamp = get_ruleset_stamp();
+
+    assert_non_null(new_stamp);
+    assert_string_not_equal(stamp, new_stamp);
+
+    os_free(stamp);
+    os_free(new_stamp);
+    remove_ruleset_files();
+}
+
+void test_w_logtest_ruleset_stamp_missing_file(void ** state) {
+
+    write_ruleset_files();
+    unlink("test_list.xml");
+
+    assert_null(get_ruleset_stamp());
+
+    remove_ruleset_files();
+}
+
 /* w_logtest_generate_token */
 void test_w_logtest_generate_token_success(void ** state) {
 
@@ -3152,7 +3464,16 @@ void test_w_logtest_process_request_type_log_processing(void ** state) {
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 0);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
 
     // test_w_logtest_remove_session_ok_error_load_decoder_cbd_rules_hash
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -3250,31 +3571,33 @@ void test_w_logtest_generate_error_response_ok(void ** state) {
 void test_w_logtest_decoding_phase_program_name(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
 
     lf.program_name = strdup("program name test");
-    os_calloc(1, sizeof(OSDecoderNode), session.decoderlist_forpname);
+    os_calloc(1, sizeof(OSDecoderNode), session_ruleset.decoderlist_forpname);
 
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, session_ruleset.decoderlist_forpname);
     w_logtest_decoding_phase(&lf, &session);
 
     os_free(lf.program_name);
-    os_free(session.decoderlist_forpname);
+    os_free(session_ruleset.decoderlist_forpname);
 
 }
 
 void test_w_logtest_decoding_phase_no_program_name(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
 
     lf.program_name = NULL;
-    os_calloc(1, sizeof(OSDecoderNode), session.decoderlist_nopname);
+    os_calloc(1, sizeof(OSDecoderNode), session_ruleset.decoderlist_nopname);
 
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_nopname);
+    expect_value(__wrap_DecodeEvent, node, session_ruleset.decoderlist_nopname);
     w_logtest_decoding_phase(&lf, &session);
 
-    os_free(session.decoderlist_nopname);
+    os_free(session_ruleset.decoderlist_nopname);
 }
 
 // w_logtest_preprocessing_phase
@@ -3463,7 +3786,8 @@ void test_w_logtest_preprocessing_phase_str_event_fail(void ** state)
 void test_w_logtest_rulesmatching_phase_no_load_rules(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = -1;
     int retval;
@@ -3482,7 +3806,8 @@ void test_w_logtest_rulesmatching_phase_no_load_rules(void ** state)
 void test_w_logtest_rulesmatching_phase_ossec_alert(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3509,7 +3834,8 @@ void test_w_logtest_rulesmatching_phase_ossec_alert(void ** state)
 void test_w_logtest_rulesmatching_phase_dont_match_category(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3542,7 +3868,8 @@ void test_w_logtest_rulesmatching_phase_dont_match_category(void ** state)
 void test_w_logtest_rulesmatching_phase_dont_match(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3577,7 +3904,8 @@ void test_w_logtest_rulesmatching_phase_dont_match(void ** state)
 void test_w_logtest_rulesmatching_phase_match_level_0(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3613,7 +3941,8 @@ void test_w_logtest_rulesmatching_phase_match_level_0(void ** state)
 void test_w_logtest_rulesmatching_phase_match_dont_ignore_first_time(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3653,7 +3982,8 @@ void test_w_logtest_rulesmatching_phase_match_dont_ignore_first_time(void ** sta
 void test_w_logtest_rulesmatching_phase_match_ignore_time_ignore(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3693,7 +4023,8 @@ void test_w_logtest_rulesmatching_phase_match_ignore_time_ignore(void ** state)
 void test_w_logtest_rulesmatching_phase_match_dont_ignore_time_out_windows(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3734,7 +4065,8 @@ void test_w_logtest_rulesmatching_phase_match_dont_ignore_time_out_windows(void
 void test_w_logtest_rulesmatching_phase_match_ignore_event(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 0;
     int retval;
@@ -3772,7 +4104,8 @@ void test_w_logtest_rulesmatching_phase_match_ignore_event(void ** state)
 void test_w_logtest_rulesmatching_phase_match_and_if_matched_sid_ok(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3816,7 +4149,8 @@ void test_w_logtest_rulesmatching_phase_match_and_if_matched_sid_ok(void ** stat
 void test_w_logtest_rulesmatching_phase_match_and_if_matched_sid_fail(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3863,7 +4197,8 @@ void test_w_logtest_rulesmatching_phase_match_and_if_matched_sid_fail(void ** st
 void test_w_logtest_rulesmatching_phase_match_and_group_prev_matched_fail(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3914,7 +4249,8 @@ void test_w_logtest_rulesmatching_phase_match_and_group_prev_matched_fail(void *
 void test_w_logtest_rulesmatching_phase_match_and_group_prev_matched(void ** state)
 {
     Eventinfo lf = {0};
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     const int expect_retval = 1;
     int retval;
@@ -3972,7 +4308,8 @@ void test_w_logtest_process_log_preprocessing_fail(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
 
     cJSON * retval;
@@ -4012,7 +4349,8 @@ void test_w_logtest_process_log_rule_match_fail(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     OSDecoderInfo decoder_info = {0};
     decoder_info.accumulate = 0;
@@ -4028,7 +4366,7 @@ void test_w_logtest_process_log_rule_match_fail(void ** state)
 
     refill_OS_CleanMSG = true;
     will_return(__wrap_OS_CleanMSG, 0);
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, session_ruleset.decoderlist_forpname);
 
     retval = w_logtest_process_log(&request, &session, &extra_data, &list_msg);
 
@@ -4058,7 +4396,8 @@ void test_w_logtest_process_log_rule_dont_match(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     OSDecoderInfo decoder_info = {0};
     decoder_info.accumulate = 1;
@@ -4084,7 +4423,7 @@ void test_w_logtest_process_log_rule_dont_match(void ** state)
     refill_OS_CleanMSG = true;
     will_return(__wrap_OS_CleanMSG, 0);
     // w_logtest_decoding_phase
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, session_ruleset.decoderlist_forpname);
 
     will_return(__wrap_Eventinfo_to_jsonstr, strdup("output example"));
     will_return(__wrap_cJSON_Parse, output);
@@ -4123,7 +4462,8 @@ void test_w_logtest_process_log_rule_match(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     OSDecoderInfo decoder_info = {0};
     decoder_info.accumulate = 1;
@@ -4151,7 +4491,7 @@ void test_w_logtest_process_log_rule_match(void ** state)
     will_return(__wrap_OS_CleanMSG, 0);
 
     // w_logtest_decoding_phase
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, session_ruleset.decoderlist_forpname);
 
     // w_logtest_rulesmatching_phase
     will_return(__wrap_OS_CheckIfRuleMatch, &ruleinfo);
@@ -4196,7 +4536,8 @@ void test_w_logtest_process_log_rule_match_level_0(void ** state)
     char * raw_event = strdup("event");
     char * str_location = strdup("location");
 
-    w_logtest_session_t session = {0};
+    w_logtest_ruleset_t session_ruleset = {0};
+    w_logtest_session_t session = {.ruleset = &session_ruleset};
     OSList list_msg = {0};
     OSDecoderInfo decoder_info = {0};
     decoder_info.accumulate = 1;
@@ -4224,7 +4565,7 @@ void test_w_logtest_process_log_rule_match_level_0(void ** state)
     will_return(__wrap_OS_CleanMSG, 0);
 
     // w_logtest_decoding_phase
-    expect_value(__wrap_DecodeEvent, node, session.decoderlist_forpname);
+    expect_value(__wrap_DecodeEvent, node, session_ruleset.decoderlist_forpname);
 
     // w_logtest_rulesmatching_phase
     will_return(__wrap_OS_CheckIfRuleMatch, &ruleinfo);
@@ -4464,8 +4805,6 @@ void test_w_logtest_process_request_remove_session_ok(void ** state)
     expect_value(__wrap_OSHash_Delete, key, "000015b3");
     will_return(__wrap_OSHash_Delete, session);
 
-    will_return(__wrap_OSStore_Free, session->decoder_store);
-
     will_return(__wrap_OSHash_Free, session);
 
     will_return(__wrap_OSHash_Free, session);
@@ -4812,7 +5151,16 @@ void test_w_logtest_process_request_log_processing_fail_session(void ** state)
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 0);
+    /* OSList_Destroy of the load messages */
+    will_return(__wrap_pthread_rwlock_wrlock, 0);
+    will_return(__wrap_pthread_mutex_lock, 0);
+    will_return(__wrap_pthread_mutex_unlock, 0);
+    will_return(__wrap_pthread_rwlock_unlock, 0);
+    will_return(__wrap_pthread_mutex_destroy, 0);
 
     // test_w_logtest_remove_session_ok_error_load_decoder_cbd_rules_hash
     will_return(__wrap_pthread_mutex_destroy, 0);
@@ -4871,7 +5219,8 @@ void test_w_logtest_process_request_log_processing_fail_process_log(void ** stat
 
     // get session
     cJSON * json_request_token;
-    w_logtest_session_t active_session;
+    w_logtest_ruleset_t active_ruleset = {0};
+    w_logtest_session_t active_session = {.ruleset = &active_ruleset};
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
 
@@ -4999,14 +5348,15 @@ void test_w_logtest_process_request_log_processing_ok_and_alert(void ** state)
 
     // get session
     cJSON * json_request_token;
-    w_logtest_session_t active_session;
+    w_logtest_ruleset_t active_ruleset = {0};
+    w_logtest_session_t active_session = {.ruleset = &active_ruleset};
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
 
     os_calloc(1, sizeof(cJSON), json_request_token);
     json_request_token->valuestring = token;
     active_session.last_connection = 0;
-    active_session.logbylevel = 3;
+    active_ruleset.logbylevel = 3;
 
     will_return(__wrap_cJSON_GetObjectItemCaseSensitive, json_request_token);
 
@@ -5144,7 +5494,8 @@ void test_w_logtest_process_request_log_processing_ok_session_expired(void ** st
 
     // get session
     cJSON * json_request_token;
-    w_logtest_session_t active_session;
+    w_logtest_ruleset_t active_ruleset = {0};
+    w_logtest_session_t active_session = {.ruleset = &active_ruleset};
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
 
@@ -5202,6 +5553,9 @@ void test_w_logtest_process_request_log_processing_ok_session_expired(void ** st
     will_return(__wrap_OS_GetElementsbyNode, (xml_node **) calloc(1, sizeof(xml_node *)));
     will_return(__wrap_Read_Rules, 0);
 
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 1);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -5363,7 +5717,8 @@ void test_w_logtest_process_request_log_processing_options_without_rules_debug(v
 
     // get session
     cJSON * json_request_token;
-    w_logtest_session_t active_session;
+    w_logtest_ruleset_t active_ruleset = {0};
+    w_logtest_session_t active_session = {.ruleset = &active_ruleset};
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
 
@@ -5407,6 +5762,9 @@ void test_w_logtest_process_request_log_processing_options_without_rules_debug(v
 
     will_return(__wrap_pthread_mutex_init, 0);
     will_return(__wrap_time, 1212);
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 0);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -5574,7 +5932,8 @@ void test_w_logtest_process_request_log_processing_rules_debug_not_bolean(void *
 
     // get session
     cJSON * json_request_token;
-    w_logtest_session_t active_session;
+    w_logtest_ruleset_t active_ruleset = {0};
+    w_logtest_session_t active_session = {.ruleset = &active_ruleset};
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
 
@@ -5618,6 +5977,9 @@ void test_w_logtest_process_request_log_processing_rules_debug_not_bolean(void *
 
     will_return(__wrap_pthread_mutex_init, 0);
     will_return(__wrap_time, 1212);
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 0);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -5791,7 +6153,8 @@ void test_w_logtest_process_request_log_processing_rules_debug_false(void ** sta
 
     // get session
     cJSON * json_request_token;
-    w_logtest_session_t active_session;
+    w_logtest_ruleset_t active_ruleset = {0};
+    w_logtest_session_t active_session = {.ruleset = &active_ruleset};
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
 
@@ -5835,6 +6198,9 @@ void test_w_logtest_process_request_log_processing_rules_debug_false(void ** sta
 
     will_return(__wrap_pthread_mutex_init, 0);
     will_return(__wrap_time, 1212);
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 0);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -6004,7 +6370,8 @@ void test_w_logtest_process_request_log_processing_rules_debug_true(void ** stat
 
     // get session
     cJSON * json_request_token;
-    w_logtest_session_t active_session;
+    w_logtest_ruleset_t active_ruleset = {0};
+    w_logtest_session_t active_session = {.ruleset = &active_ruleset};
     char * token = strdup("test_token");
     const time_t now = (time_t) 2020;
 
@@ -6048,6 +6415,9 @@ void test_w_logtest_process_request_log_processing_rules_debug_true(void ** stat
 
     will_return(__wrap_pthread_mutex_init, 0);
     will_return(__wrap_time, 1212);
+    /* w_logtest_ruleset_build */
+    will_return(__wrap_OSList_Create, calloc(1, sizeof(OSList)));
+    will_return(__wrap_OSList_SetMaxSize, 1);
     will_return(__wrap_ReadDecodeXML, 1);
     will_return(__wrap_SetDecodeXML, 0);
     will_return(__wrap_Lists_OP_LoadList, 0);
@@ -6585,6 +6955,7 @@ int main(void)
         // Tests w_logtest_remove_session
         cmocka_unit_test(test_w_logtest_remove_session_fail),
         cmocka_unit_test(test_w_logtest_remove_session_OK),
+        cmocka_unit_test(test_w_logtest_remove_session_shared_ruleset),
         // Tests w_logtest_check_inactive_sessions
         cmocka_unit_test(test_w_logtest_check_inactive_sessions_no_remove),
         cmocka_unit_test(test_w_logtest_check_inactive_sessions_remove),
@@ -6606,6 +6977,11 @@ int main(void)
         cmocka_unit_test(test_w_logtest_initialize_session_error_accumulate_init),
         cmocka_unit_test(test_w_logtest_initialize_session_success),
         cmocka_unit_test(test_w_logtest_initialize_session_success_duplicate_key),
+        cmocka_unit_test(test_w_logtest_initialize_session_shared_ruleset),
+        cmocka_unit_test(test_w_logtest_initialize_session_changed_ruleset),
+        // Tests w_logtest_ruleset_stamp
+        cmocka_unit_test(test_w_logtest_ruleset_stamp_changed_file),
+        cmocka_unit_test(test_w_logtest_ruleset_stamp_missing_file),
         // Tests w_logtest_generate_token
         cmocka_unit_test(test_w_logtest_generate_token_success),
         cmocka_unit_test(test_w_logtest_generate_token_success_empty_bytes),
@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../analysisd/profiler.h"
+#include "../wrappers/common.h"
+#include "../wrappers/wazuh/shared/debug_op_wrappers.h"
+
+static RuleInfo parent_rule = { .sigid = 5700, .level = 0, .comment = "SSHD messages grouped." };
+static RuleInfo child_rule = { .sigid = 5716, .level = 5, .comment = "sshd: authentication failed." };
+static OSDecoderInfo sshd_decoder = { .name = "sshd" };
+static OSDecoderInfo pam_decoder = { .name = "pam" };
+
+static void set_sampling(unsigned int rate) {
+    char msg[OS_SIZE_128];
+
+    snprintf(msg, sizeof(msg), "Ruleset profiler sampling rate set to %u.", rate);
+    expect_string(__wrap__mdebug1, formatted_msg, msg);
+
+    w_profiler_set_sampling(rate);
+}
+
+/* Time the decoding and rule matching of an event, as the analysisd threads do */
+static void process_event(void) {
+    w_profiler_frame_t parent;
+    w_profiler_frame_t child;
+
+    w_profiler_sample_event();
+
+    if (!w_profiler_sampled) {
+        return;
+    }
+
+    w_profiler_decoder_next(&pam_decoder);
+    w_profiler_decoder_next(&sshd_decoder);
+    w_profiler_decoder_next(NULL);
+
+    w_profiler_rule_enter(&parent);
+    w_profiler_rule_enter(&child);
+    w_profiler_rule_leave(&child, &child_rule);
+    w_profiler_rule_leave(&parent, &parent_rule);
+}
+
+static int setup(void **state) {
+    set_sampling(0);
+    w_profiler_reset();
+    return 0;
+}
+
+static cJSON * find_row(cJSON * rows, const char * key, const char * value, int id) {
+    cJSON * row;
+
+    cJSON_ArrayForEach(row, rows) {
+        cJSON * field = cJSON_GetObjectItem(row, key);
+
+        if (value ? strcmp(field->valuestring, value) == 0 : field->valueint == id) {
+            return row;
+        }
+    }
+
+    return NULL;
+}
+
+static void test_w_profiler_disabled(void **state) {
+    for (int i = 0; i < 10; i++) {
+        process_event();
+        assert_false(w_profiler_sampled);
+    }
+
+    cJSON * profile = w_profiler_json(W_PROFILER_TOP_DEFAULT);
+
+    assert_int_equal(cJSON_GetObjectItem(profile, "sampling")->valueint, 0);
+    assert_int_equal(cJSON_GetArraySize(cJSON_GetObjectItem(profile, "rules")), 0);
+    assert_int_equal(cJSON_GetArraySize(cJSON_GetObjectItem(profile, "decoders")), 0);
+
+    cJSON_Delete(profile);
+}
+
+static void test_w_profiler_sampling_rate(void **state) {
+    int sampled = 0;
+
+    set_sampling(3);
+    assert_int_equal(w_profiler_get_sampling(), 3);
+
+    for (int i = 0; i < 9; i++) {
+        w_profiler_sample_event();
+        sampled += w_profiler_sampled;
+    }
+
+    assert_int_equal(sampled, 3);
+}
+
+static void test_w_profiler_json(void **state) {
+    set_sampling(1);
+
+    for (int i = 0; i < 4; i++) {
+        process_event();
+    }
+
+    cJSON * profile = w_profiler_json(W_PROFILER_TOP_DEFAULT);
+    cJSON * rules = cJSON_GetObjectItem(profile, "rules");
+    cJSON * decoders = cJSON_GetObjectItem(profile, "decoders");
+
+    assert_int_equal(cJSON_GetObjectItem(profile, "sampling")->valueint, 1);
+    assert_int_equal(cJSON_GetArraySize(rules), 2);
+    assert_int_equal(cJSON_GetArraySize(decoders), 2);
+
+    cJSON * child = find_row(rules, "id", NULL, 5716);
+    assert_non_null(child);
+    assert_int_equal(cJSON_GetObjectItem(child, "samples")->valueint, 4);
+    assert_int_equal(cJSON_GetObjectItem(child, "level")->valueint, 5);
+    assert_string_equal(cJSON_GetObjectItem(child, "description")->valuestring, "sshd: authentication failed.");
+    assert_non_null(find_row(rules, "id", NULL, 5700));
+
+    cJSON * decoder = find_row(decoders, "name", "sshd", 0);
+    assert_non_null(decoder);
+    assert_int_equal(cJSON_GetObjectItem(decoder, "samples")->valueint, 4);
+    assert_non_null(find_row(decoders, "name", "pam", 0));
+
+    cJSON_Delete(profile);
+
+    // Sorted by cost and cut to the top
+    profile = w_profiler_json(1);
+    rules = cJSON_GetObjectItem(profile, "rules");
+
+    assert_int_equal(cJSON_GetArraySize(rules), 1);
+    assert_int_equal(cJSON_GetArraySize(cJSON_GetObjectItem(profile, "decoders")), 1);
+
+    cJSON_Delete(profile);
+}
+
+static void test_w_profiler_reset(void **state) {
+    set_sampling(1);
+    process_event();
+    w_profiler_reset();
+
+    cJSON * profile = w_profiler_json(W_PROFILER_TOP_DEFAULT);
+    assert_int_equal(cJSON_GetArraySize(cJSON_GetObjectItem(profile, "rules")), 0);
+    cJSON_Delete(profile);
+
+    process_event();
+
+    profile = w_profiler_json(W_PROFILER_TOP_DEFAULT);
+    cJSON * row = cJSON_GetArrayItem(cJSON_GetObjectItem(profile, "rules"), 0);
+
+    assert_int_equal(cJSON_GetObjectItem(row, "samples")->valueint, 1);
+    cJSON_Delete(profile);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup(test_w_profiler_disabled, setup),
+        cmocka_unit_test_setup(test_w_profiler_sampling_rate, setup),
+        cmocka_unit_test_setup(test_w_profiler_json, setup),
+        cmocka_unit_test_setup(test_w_profiler_reset, setup),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -857,6 +857,326 @@ void w_free_rules_tmp_params_null(void ** state){
     w_free_rules_tmp_params(NULL);
 }
 
+// OS_BuildRuleIndex, OS_FirstRuleCandidate and OS_NextRuleCandidate
+#define RULE_INDEX_TEST_SIZE 5
+
+typedef struct {
+    RuleNode nodes[RULE_INDEX_TEST_SIZE];
+    RuleInfo rules[RULE_INDEX_TEST_SIZE];
+    OSDecoderInfo decoder;
+    Eventinfo lf;
+} rule_index_test_t;
+
+/* Rule list decoded as: 0, 10, 0, 20, 10 */
+int setup_rule_index(void ** state)
+{
+    static const u_int16_t decoded_as[RULE_INDEX_TEST_SIZE] = { 0, 10, 0, 20, 10 };
+    rule_index_test_t * data;
+
+    os_calloc(1, sizeof(rule_index_test_t), data);
+
+    for (int i = 0; i < RULE_INDEX_TEST_SIZE; i++) {
+        data->rules[i].sigid = i + 1;
+        data->rules[i].decoded_as = decoded_as[i];
+        data->nodes[i].ruleinfo = &data->rules[i];
+        data->nodes[i].next = i + 1 < RULE_INDEX_TEST_SIZE ? &data->nodes[i + 1] : NULL;
+    }
+
+    data->lf.decoder_info = &data->decoder;
+    *state = data;
+
+    return 0;
+}
+
+int teardown_rule_index(void ** state)
+{
+    rule_index_test_t * data = *state;
+
+    for (int i = 0; i < RULE_INDEX_TEST_SIZE; i++) {
+        OS_FreeRuleIndex(data->nodes[i].index);
+    }
+
+    os_free(data);
+
+    return 0;
+}
+
+/* Walk the candidates and return the sigids, in order */
+static void rule_index_walk(rule_index_test_t * data, bool trace, int * sigids, int max)
+{
+    RuleNode ** cursor = NULL;
+    RuleNode * node;
+    int i = 0;
+
+    for (node = OS_FirstRuleCandidate(&data->nodes[0], &data->lf, trace, &cursor); node;
+         node = OS_NextRuleCandidate(node, &cursor)) {
+        assert_true(i < max);
+        sigids[i++] = node->ruleinfo->sigid;
+    }
+
+    for (; i < max; i++) {
+        sigids[i] = 0;
+    }
+}
+
+void test_OS_BuildRuleIndex_generic_list(void ** state)
+{
+    rule_index_test_t * data = *state;
+
+    for (int i = 0; i < RULE_INDEX_TEST_SIZE; i++) {
+        data->rules[i].decoded_as = 0;
+    }
+
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    assert_null(data->nodes[0].index);
+}
+
+void test_OS_BuildRuleIndex_decoders(void ** state)
+{
+    rule_index_test_t * data = *state;
+
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    assert_non_null(data->nodes[0].index);
+    assert_int_equal(data->nodes[0].index->decoders_size, 2);
+    assert_int_equal(data->nodes[0].index->decoders[0].decoder_id, 10);
+    assert_int_equal(data->nodes[0].index->decoders[1].decoder_id, 20);
+    assert_ptr_equal(data->nodes[0].index->generic[0], &data->nodes[0]);
+    assert_ptr_equal(data->nodes[0].index->generic[1], &data->nodes[2]);
+    assert_null(data->nodes[0].index->generic[2]);
+}
+
+void test_OS_BuildRuleIndex_children(void ** state)
+{
+    rule_index_test_t * data = *state;
+
+    // The last two rules are children of the first one
+    data->nodes[2].next = NULL;
+    data->nodes[0].child = &data->nodes[3];
+
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    assert_non_null(data->nodes[0].index);
+    assert_int_equal(data->nodes[0].index->decoders_size, 1);
+    assert_non_null(data->nodes[3].index);
+    assert_int_equal(data->nodes[3].index->decoders_size, 2);
+    assert_null(data->nodes[3].index->generic[0]);
+}
+
+void test_OS_FirstRuleCandidate_no_index(void ** state)
+{
+    rule_index_test_t * data = *state;
+    int sigids[RULE_INDEX_TEST_SIZE];
+    int expected[RULE_INDEX_TEST_SIZE] = { 1, 2, 3, 4, 5 };
+
+    data->decoder.id = 10;
+
+    rule_index_walk(data, false, sigids, RULE_INDEX_TEST_SIZE);
+
+    assert_memory_equal(sigids, expected, sizeof(expected));
+}
+
+void test_OS_FirstRuleCandidate_decoder(void ** state)
+{
+    rule_index_test_t * data = *state;
+    int sigids[RULE_INDEX_TEST_SIZE];
+    int expected[RULE_INDEX_TEST_SIZE] = { 1, 2, 3, 5, 0 };
+
+    data->decoder.id = 10;
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    rule_index_walk(data, false, sigids, RULE_INDEX_TEST_SIZE);
+
+    assert_memory_equal(sigids, expected, sizeof(expected));
+}
+
+void test_OS_FirstRuleCandidate_syscheck_decoder(void ** state)
+{
+    rule_index_test_t * data = *state;
+    int sigids[RULE_INDEX_TEST_SIZE];
+    int expected[RULE_INDEX_TEST_SIZE] = { 1, 3, 4, 0, 0 };
+
+    data->decoder.id = 10;
+    data->lf.decoder_syscheck_id = 20;
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    rule_index_walk(data, false, sigids, RULE_INDEX_TEST_SIZE);
+
+    assert_memory_equal(sigids, expected, sizeof(expected));
+}
+
+void test_OS_FirstRuleCandidate_unknown_decoder(void ** state)
+{
+    rule_index_test_t * data = *state;
+    int sigids[RULE_INDEX_TEST_SIZE];
+    int expected[RULE_INDEX_TEST_SIZE] = { 1, 3, 0, 0, 0 };
+
+    data->decoder.id = 30;
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    rule_index_walk(data, false, sigids, RULE_INDEX_TEST_SIZE);
+
+    assert_memory_equal(sigids, expected, sizeof(expected));
+}
+
+void test_OS_FirstRuleCandidate_no_candidates(void ** state)
+{
+    rule_index_test_t * data = *state;
+    RuleNode ** cursor = NULL;
+
+    data->rules[0].decoded_as = 20;
+    data->rules[2].decoded_as = 20;
+    data->decoder.id = 30;
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    assert_null(OS_FirstRuleCandidate(&data->nodes[0], &data->lf, false, &cursor));
+}
+
+void test_OS_FirstRuleCandidate_trace(void ** state)
+{
+    rule_index_test_t * data = *state;
+    int sigids[RULE_INDEX_TEST_SIZE];
+    int expected[RULE_INDEX_TEST_SIZE] = { 1, 2, 3, 4, 5 };
+
+    data->decoder.id = 30;
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    rule_index_walk(data, true, sigids, RULE_INDEX_TEST_SIZE);
+
+    assert_memory_equal(sigids, expected, sizeof(expected));
+}
+
+void test_OS_FirstRuleCandidate_alert(void ** state)
+{
+    rule_index_test_t * data = *state;
+    int sigids[RULE_INDEX_TEST_SIZE];
+    int expected[RULE_INDEX_TEST_SIZE] = { 1, 2, 3, 4, 5 };
+
+    data->decoder.id = 30;
+    data->decoder.type = OSSEC_ALERT;
+    OS_BuildRuleIndex(&data->nodes[0]);
+
+    rule_index_walk(data, false, sigids, RULE_INDEX_TEST_SIZE);
+
+    assert_memory_equal(sigids, expected, sizeof(expected));
+}
+
+void test_OS_BuildRuleLiterals(void ** state)
+{
+    rule_index_test_t * data = *state;
+    static const char * patterns[RULE_INDEX_TEST_SIZE] = { "error|fail", NULL, "^start", "denied", "!error" };
+
+    for (int i = 0; i < RULE_INDEX_TEST_SIZE; i++) {
+        if (patterns[i]) {
+            w_calloc_expression_t(&data->rules[i].match, EXP_TYPE_OSMATCH);
+            assert_true(OSMatch_Compile(patterns[i], data->rules[i].match->match, 0));
+        }
+    }
+
+    // The last rule is a child of the first one
+    data->nodes[3].next = NULL;
+    data->nodes[0].child = &data->nodes[4];
+
+    OS_BuildRuleLiterals(&data->nodes[0]);
+
+    assert_non_null(data->nodes[0].literals);
+    assert_int_equal(OSMatchSet_Size(data->nodes[0].literals), 2);
+    assert_ptr_equal(data->rules[0].match_literals, data->nodes[0].literals);
+    assert_int_equal(data->rules[0].match_literal, 0);
+    assert_null(data->rules[1].match_literals);
+    assert_null(data->rules[2].match_literals);
+    assert_ptr_equal(data->rules[3].match_literals, data->nodes[0].literals);
+    assert_int_equal(data->rules[3].match_literal, 1);
+    assert_null(data->rules[4].match_literals);
+
+    OSMatchSet_Free(data->nodes[0].literals);
+
+    for (int i = 0; i < RULE_INDEX_TEST_SIZE; i++) {
+        w_free_expression_t(&data->rules[i].match);
+    }
+}
+
+void test_OS_BuildRuleLiterals_no_literals(void ** state)
+{
+    rule_index_test_t * data = *state;
+
+    OS_BuildRuleLiterals(&data->nodes[0]);
+
+    assert_null(data->nodes[0].literals);
+}
+
+// os_clone_rules_list
+void test_os_clone_rules_list(void ** state)
+{
+    rule_index_test_t * data = *state;
+    RuleNode extra = { .ruleinfo = &data->rules[3] };
+    RuleNode * clone;
+    RuleNode * node;
+    RuleInfo * clones[RULE_INDEX_TEST_SIZE];
+    int i = 0;
+
+    // Rule 4 is also a child of rule 1, as with if_group
+    data->nodes[0].child = &extra;
+    data->rules[0].firedtimes = 3;
+    data->rules[0].time_ignored = 1000;
+
+    // Rule 5 has if_matched_sid 2, rule 1 matches the group of if_matched_group of rule 3
+    data->rules[1].sid_prev_matched = OSList_Create();
+    data->rules[4].sid_search = data->rules[1].sid_prev_matched;
+    data->rules[2].group_search = OSList_Create();
+    os_calloc(2, sizeof(OSList *), data->rules[0].group_prev_matched);
+    data->rules[0].group_prev_matched[0] = data->rules[2].group_search;
+    data->rules[0].group_prev_matched_sz = 1;
+
+    clone = os_clone_rules_list(&data->nodes[0]);
+
+    for (node = clone; node; node = node->next) {
+        assert_true(i < RULE_INDEX_TEST_SIZE);
+        assert_ptr_not_equal(node, &data->nodes[i]);
+        assert_ptr_not_equal(node->ruleinfo, &data->rules[i]);
+        assert_int_equal(node->ruleinfo->sigid, data->rules[i].sigid);
+        assert_true(node->ruleinfo->clone);
+        clones[i++] = node->ruleinfo;
+    }
+    assert_int_equal(i, RULE_INDEX_TEST_SIZE);
+
+    // The correlation state isn't copied
+    assert_int_equal(clones[0]->firedtimes, 0);
+    assert_int_equal(clones[0]->time_ignored, 0);
+
+    // A rule found twice is cloned once
+    assert_non_null(clone->child);
+    assert_ptr_equal(clone->child->ruleinfo, clones[3]);
+
+    // The links point to the lists of the clones
+    assert_non_null(clones[1]->sid_prev_matched);
+    assert_ptr_not_equal(clones[1]->sid_prev_matched, data->rules[1].sid_prev_matched);
+    assert_ptr_equal(clones[4]->sid_search, clones[1]->sid_prev_matched);
+    assert_non_null(clones[2]->group_search);
+    assert_ptr_not_equal(clones[2]->group_search, data->rules[2].group_search);
+    assert_int_equal(clones[0]->group_prev_matched_sz, 1);
+    assert_ptr_equal(clones[0]->group_prev_matched[0], clones[2]->group_search);
+    assert_null(clones[0]->group_prev_matched[1]);
+
+    // The candidates are the cloned nodes
+    assert_non_null(clone->index);
+    assert_int_equal(clone->index->decoders_size, 2);
+    assert_ptr_equal(clone->index->generic[0], clone);
+    assert_null(data->nodes[0].index);
+
+    os_remove_rules_list(clone);
+
+    os_free(data->rules[1].sid_prev_matched);
+    OSList_Destroy(data->rules[2].group_search);
+    os_free(data->rules[0].group_prev_matched);
+}
+
+void test_os_clone_rules_list_empty(void ** state)
+{
+    assert_null(os_clone_rules_list(NULL));
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -898,6 +1218,23 @@ int main(void)
         cmocka_unit_test(w_free_rules_tmp_params_only_rule_arr),
         cmocka_unit_test(w_free_rules_tmp_params_only_params),
         cmocka_unit_test(w_free_rules_tmp_params_null),
+        // Test OS_BuildRuleIndex, OS_FirstRuleCandidate and OS_NextRuleCandidate
+        cmocka_unit_test_setup_teardown(test_OS_BuildRuleIndex_generic_list, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_BuildRuleIndex_decoders, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_BuildRuleIndex_children, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_FirstRuleCandidate_no_index, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_FirstRuleCandidate_decoder, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_FirstRuleCandidate_syscheck_decoder, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_FirstRuleCandidate_unknown_decoder, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_FirstRuleCandidate_no_candidates, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_FirstRuleCandidate_trace, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_FirstRuleCandidate_alert, setup_rule_index, teardown_rule_index),
+        // Test OS_BuildRuleLiterals
+        cmocka_unit_test_setup_teardown(test_OS_BuildRuleLiterals, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test_setup_teardown(test_OS_BuildRuleLiterals_no_literals, setup_rule_index, teardown_rule_index),
+        // Test os_clone_rules_list
+        cmocka_unit_test_setup_teardown(test_os_clone_rules_list, setup_rule_index, teardown_rule_index),
+        cmocka_unit_test(test_os_clone_rules_list_empty),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../analysisd/ruleset.h"
+#include "../wrappers/common.h"
+#include "../wrappers/wazuh/shared/debug_op_wrappers.h"
+
+/* Decoder names of a ruleset, as loaded by the decoder files */
+static OSStore * decoder_store(const char ** names) {
+    OSStore * store = OSStore_Create();
+
+    for (int i = 0; names[i]; i++) {
+        OSStore_Put(store, names[i], NULL);
+    }
+
+    return store;
+}
+
+static void test_w_ruleset_acquire_before_init(void **state) {
+    assert_null(w_ruleset_acquire());
+    assert_null(w_ruleset_hold(NULL));
+    w_ruleset_release(NULL);
+}
+
+static void test_w_ruleset_swap(void **state) {
+    const char * old_names[] = { "pam", "rootcheck", "sshd", NULL };
+    const char * new_names[] = { "apache", "pam", "rootcheck", "sshd", NULL };
+    u_int16_t rootcheck_id = 0;
+    u_int16_t pam_id = 0;
+    u_int16_t rootcheck_id2 = 0;
+
+    os_analysisd_decoder_store = decoder_store(old_names);
+    int rootcheck_slot = w_ruleset_bind_decoder(&rootcheck_id, "rootcheck");
+    assert_int_equal(rootcheck_slot, 0);
+    assert_int_equal(rootcheck_id, 2);
+
+    w_ruleset_init();
+
+    // An event pins the first ruleset
+    w_ruleset_t * old_ruleset = w_ruleset_acquire();
+    assert_non_null(old_ruleset);
+    assert_ptr_equal(w_ruleset_hold(old_ruleset), old_ruleset);
+    assert_int_equal(old_ruleset->references, 3);
+    assert_int_equal(w_ruleset_decoder_id(old_ruleset, rootcheck_slot, rootcheck_id), 2);
+
+    // A decoder bound after the ruleset is published is resolved in it, the same name shares the slot
+    int pam_slot = w_ruleset_bind_decoder(&pam_id, "pam");
+    assert_int_equal(pam_slot, 1);
+    assert_int_equal(w_ruleset_decoder_id(old_ruleset, pam_slot, pam_id), 1);
+    assert_int_equal(w_ruleset_bind_decoder(&rootcheck_id2, "rootcheck"), rootcheck_slot);
+
+    os_analysisd_decoder_store = decoder_store(new_names);
+    w_ruleset_init();
+
+    // New events get the ids of the internal decoders in the new ruleset, the pinned events keep theirs
+    w_ruleset_t * new_ruleset = w_ruleset_acquire();
+    assert_ptr_not_equal(new_ruleset, old_ruleset);
+    assert_ptr_equal(os_analysisd_decoder_store, new_ruleset->decoder_store);
+    assert_int_equal(w_ruleset_decoder_id(new_ruleset, rootcheck_slot, rootcheck_id), 3);
+    assert_int_equal(w_ruleset_decoder_id(new_ruleset, pam_slot, pam_id), 2);
+    assert_int_equal(w_ruleset_decoder_id(old_ruleset, rootcheck_slot, rootcheck_id), 2);
+    assert_int_equal(w_ruleset_decoder_id(NULL, rootcheck_slot, rootcheck_id), 2);
+    assert_int_equal(old_ruleset->references, 2);
+
+    // The retired ruleset is kept while it's pinned
+    w_ruleset_release(old_ruleset);
+    w_ruleset_reclaim();
+    assert_int_equal(old_ruleset->references, 1);
+
+    w_ruleset_release(old_ruleset);
+    expect_string(__wrap__mdebug1, formatted_msg, "Retired ruleset freed.");
+    w_ruleset_reclaim();
+
+    assert_int_equal(new_ruleset->references, 2);
+    w_ruleset_release(new_ruleset);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_w_ruleset_acquire_before_init),
+        cmocka_unit_test(test_w_ruleset_swap),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -18,10 +18,15 @@
 #include "../wrappers/posix/pthread_wrappers.h"
 
 int w_agentd_get_buffer_lenght();
+int buffer_take_batch(char ** events);
+void buffer_release_bytes(char ** events, int count);
 
 extern agent *agt;
 extern int i;
 extern int j;
+extern char ** buffer;
+extern int batch_events;
+extern size_t buffer_used_bytes;
 
 /* setup/teardown */
 
@@ -60,10 +65,6 @@ void test_w_agentd_get_buffer_lenght_buffer_empty(void ** state)
     i = 1;
     j = 1;
 
-    expect_function_call(__wrap_pthread_mutex_lock);
-
-    expect_function_call(__wrap_pthread_mutex_unlock);
-
     int retval = w_agentd_get_buffer_lenght();
 
     assert_int_equal(retval, 0);
@@ -80,10 +81,6 @@ void test_w_agentd_get_buffer_lenght_buffer(void ** state)
     i = 1;
     j = 5;
 
-    expect_function_call(__wrap_pthread_mutex_lock);
-
-    expect_function_call(__wrap_pthread_mutex_unlock);
-
     int retval = w_agentd_get_buffer_lenght();
 
     assert_int_equal(retval, 2);
@@ -92,12 +89,83 @@ void test_w_agentd_get_buffer_lenght_buffer(void ** state)
 
 }
 
+/* buffer_take_batch */
+
+void test_buffer_take_batch_disabled(void ** state)
+{
+    char * events[1] = { "1:a" };
+
+    batch_events = 1;
+
+    assert_int_equal(buffer_take_batch(events), 1);
+}
+
+void test_buffer_take_batch_until_control(void ** state)
+{
+    char * events[4] = { "1:a" };
+    char * messages[4] = { NULL, "1:b", "#!-agent ack ", "1:c" };
+
+    os_calloc(1, sizeof(agent), agt);
+    agt->buflength = 3;
+    buffer = messages;
+    batch_events = 4;
+    i = 0;
+    j = 1;
+
+    // The control message is sent on its own
+    assert_int_equal(buffer_take_batch(events), 2);
+    assert_string_equal(events[1], "1:b");
+    assert_int_equal(j, 2);
+
+    buffer = NULL;
+    os_free(agt);
+}
+
+void test_buffer_take_batch_limit(void ** state)
+{
+    char * events[2] = { "1:a" };
+    char * messages[4] = { NULL, "1:b", "1:c", "1:d" };
+
+    os_calloc(1, sizeof(agent), agt);
+    agt->buflength = 3;
+    buffer = messages;
+    batch_events = 2;
+    i = 0;
+    j = 1;
+
+    assert_int_equal(buffer_take_batch(events), 2);
+    assert_string_equal(events[1], "1:b");
+    assert_int_equal(j, 2);
+
+    buffer = NULL;
+    os_free(agt);
+}
+
+/* buffer_release_bytes */
+
+void test_buffer_release_bytes(void ** state)
+{
+    char * events[2] = { "1:abc", "1:d" };
+
+    buffer_used_bytes = 10;
+
+    buffer_release_bytes(events, 2);
+
+    assert_int_equal(buffer_used_bytes, 2);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         // Tests w_agentd_get_buffer_lenght
         cmocka_unit_test(test_w_agentd_get_buffer_lenght_buffer_disabled),
         cmocka_unit_test(test_w_agentd_get_buffer_lenght_buffer_empty),
         cmocka_unit_test(test_w_agentd_get_buffer_lenght_buffer),
+        // Tests buffer_take_batch
+        cmocka_unit_test(test_buffer_take_batch_disabled),
+        cmocka_unit_test(test_buffer_take_batch_until_control),
+        cmocka_unit_test(test_buffer_take_batch_limit),
+        // Tests buffer_release_bytes
+        cmocka_unit_test(test_buffer_release_bytes),
     };
 
     return cmocka_run_group_tests(tests, setup_group, teardown_group);
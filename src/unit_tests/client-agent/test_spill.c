@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../headers/shared.h"
+#include "../../client-agent/agentd.h"
+
+#include "../wrappers/common.h"
+
+static char spill_dir[] = "/tmp/test_spill-XXXXXX";
+
+/* setup/teardown */
+
+static int setup_spill(void **state) {
+    test_mode = 1;
+    strcpy(spill_dir + strlen(spill_dir) - 6, "XXXXXX");
+
+    if (!mkdtemp(spill_dir)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int teardown_spill(void **state) {
+    spill_close();
+    rmdir_ex(spill_dir);
+    test_mode = 0;
+    return 0;
+}
+
+static void corrupt_segment(unsigned long segment, long offset) {
+    char path[PATH_MAX];
+    FILE * fp;
+
+    snprintf(path, sizeof(path), "%s/%010lu.seg", spill_dir, segment);
+    fp = fopen(path, "r+b");
+    assert_non_null(fp);
+    fseek(fp, offset, SEEK_SET);
+    fputc('Z', fp);
+    fclose(fp);
+}
+
+/* tests */
+
+void test_spill_push_pop(void ** state)
+{
+    char ** files;
+    char * msg;
+
+    assert_int_equal(spill_init(spill_dir, 1024, 1), 0);
+    assert_true(spill_empty());
+    assert_null(spill_pop());
+
+    assert_int_equal(spill_push("a", NULL), 0);
+    assert_int_equal(spill_push("bb", NULL), 0);
+    assert_false(spill_empty());
+
+    msg = spill_pop();
+    assert_string_equal(msg, "a");
+    os_free(msg);
+
+    assert_int_equal(spill_push("ccc", NULL), 0);
+
+    msg = spill_pop();
+    assert_string_equal(msg, "bb");
+    os_free(msg);
+
+    msg = spill_pop();
+    assert_string_equal(msg, "ccc");
+    os_free(msg);
+
+    assert_true(spill_empty());
+
+    // The drained segment is removed
+    files = wreaddir(spill_dir);
+    assert_non_null(files);
+    assert_null(files[0]);
+    free_strarray(files);
+}
+
+void test_spill_restart(void ** state)
+{
+    char * msg;
+
+    assert_int_equal(spill_init(spill_dir, 1024, 8), 0);
+    assert_int_equal(spill_push("a", NULL), 0);
+    assert_int_equal(spill_push("b", NULL), 0);
+    spill_close();
+
+    expect_string(__wrap__minfo, formatted_msg, "Found 18 bytes of spilled events.");
+
+    assert_int_equal(spill_init(spill_dir, 1024, 8), 0);
+    assert_false(spill_empty());
+
+    // New events go after the old ones
+    assert_int_equal(spill_push("c", NULL), 0);
+
+    msg = spill_pop();
+    assert_string_equal(msg, "a");
+    os_free(msg);
+
+    msg = spill_pop();
+    assert_string_equal(msg, "b");
+    os_free(msg);
+
+    msg = spill_pop();
+    assert_string_equal(msg, "c");
+    os_free(msg);
+
+    assert_true(spill_empty());
+}
+
+void test_spill_corrupted(void ** state)
+{
+    assert_int_equal(spill_init(spill_dir, 1024, 1), 0);
+    assert_int_equal(spill_push("a", NULL), 0);
+    assert_int_equal(spill_push("b", NULL), 0);
+    spill_close();
+
+    // Payload of the first record
+    corrupt_segment(0, 8);
+
+    expect_string(__wrap__minfo, formatted_msg, "Found 18 bytes of spilled events.");
+    expect_string(__wrap__mwarn, formatted_msg, "Discarding corrupted spill segment 0.");
+
+    assert_int_equal(spill_init(spill_dir, 1024, 1), 0);
+    assert_null(spill_pop());
+    assert_true(spill_empty());
+}
+
+void test_spill_full(void ** state)
+{
+    char * msg;
+
+    assert_int_equal(spill_init(spill_dir, 20, 1), 0);
+
+    assert_int_equal(spill_push("0123456789", NULL), 0);
+    assert_int_equal(spill_push("0123456789", NULL), -1);
+
+    // The space is reclaimed once the events are sent
+    msg = spill_pop();
+    assert_string_equal(msg, "0123456789");
+    os_free(msg);
+
+    assert_int_equal(spill_push("0123456789", NULL), 0);
+}
+
+void test_spill_sync_out_of_lock(void ** state)
+{
+    int sync_fd;
+    char * msg;
+
+    assert_int_equal(spill_init(spill_dir, 1024, 2), 0);
+
+    assert_int_equal(spill_push("a", &sync_fd), 0);
+    assert_int_equal(sync_fd, -1);
+
+    // The caller syncs the segment once it releases the buffer lock
+    assert_int_equal(spill_push("b", &sync_fd), 0);
+    assert_true(sync_fd >= 0);
+
+    // Even if the segment is drained and removed in the meantime
+    msg = spill_pop();
+    assert_string_equal(msg, "a");
+    os_free(msg);
+    msg = spill_pop();
+    assert_string_equal(msg, "b");
+    os_free(msg);
+
+    spill_sync(sync_fd);
+    assert_int_equal(fcntl(sync_fd, F_GETFD), -1);
+    spill_sync(-1);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_spill_push_pop, setup_spill, teardown_spill),
+        cmocka_unit_test_setup_teardown(test_spill_restart, setup_spill, teardown_spill),
+        cmocka_unit_test_setup_teardown(test_spill_corrupted, setup_spill, teardown_spill),
+        cmocka_unit_test_setup_teardown(test_spill_full, setup_spill, teardown_spill),
+        cmocka_unit_test_setup_teardown(test_spill_sync_out_of_lock, setup_spill, teardown_spill),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
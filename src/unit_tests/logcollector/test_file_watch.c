@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../headers/shared.h"
+#include "../../logcollector/logcollector.h"
+
+#include "../wrappers/common.h"
+
+static char watch_file[] = "/tmp/test_file_watch-XXXXXX";
+
+/* setup/teardown */
+
+static int setup_file(void **state) {
+    logreader * lf;
+    int fd;
+
+    strcpy(watch_file + strlen(watch_file) - 6, "XXXXXX");
+
+    if (fd = mkstemp(watch_file), fd < 0) {
+        return -1;
+    }
+
+    os_calloc(1, sizeof(logreader), lf);
+    lf->file = watch_file;
+    lf->fp = fdopen(fd, "r+");
+    *state = lf;
+    return 0;
+}
+
+static int teardown_file(void **state) {
+    logreader * lf = *state;
+
+    w_file_watch_remove(lf);
+    fclose(lf->fp);
+    unlink(watch_file);
+    os_free(lf);
+    return 0;
+}
+
+/* tests */
+
+void test_w_file_watch_disabled(void ** state)
+{
+    logreader * lf = *state;
+
+    file_watch = 0;
+
+    assert_int_equal(w_file_watch_init(), 0);
+    assert_int_equal(w_file_watch_enabled(), 0);
+
+    // The file is polled
+    w_file_watch_add(lf);
+    assert_int_equal(lf->wd, 0);
+    assert_int_equal(w_file_watch_changed(lf), 1);
+    assert_int_equal(w_file_watch_changed(lf), 1);
+}
+
+void test_w_file_watch_events(void ** state)
+{
+    logreader * lf = *state;
+
+    file_watch = 1;
+
+    assert_int_equal(w_file_watch_init(), 1);
+    assert_int_equal(w_file_watch_enabled(), 1);
+
+    w_file_watch_add(lf);
+    assert_true(lf->wd > 0);
+
+    // The new file is read once
+    assert_int_equal(w_file_watch_changed(lf), 1);
+    assert_int_equal(w_file_watch_changed(lf), 0);
+
+    fprintf(lf->fp, "new line\n");
+    fflush(lf->fp);
+    w_file_watch_wait(5);
+
+    assert_int_equal(w_file_watch_changed(lf), 1);
+    assert_int_equal(w_file_watch_changed(lf), 0);
+
+    // A partial read keeps it pending
+    w_file_watch_pending(lf);
+    assert_int_equal(w_file_watch_changed(lf), 1);
+    assert_int_equal(w_file_watch_changed(lf), 0);
+
+    w_file_watch_remove(lf);
+    assert_int_equal(lf->wd, 0);
+    assert_int_equal(w_file_watch_changed(lf), 1);
+}
+
+void test_w_file_watch_dir(void ** state)
+{
+    char dir[] = "/tmp/test_file_watch_dir-XXXXXX";
+    char path[PATH_MAX];
+    unsigned int events;
+    FILE * fp;
+    int wd;
+
+    assert_non_null(mkdtemp(dir));
+
+    // The files are already watched by the previous test
+    wd = w_file_watch_add_dir(dir);
+    assert_true(wd > 0);
+    events = w_file_watch_events(wd);
+
+    snprintf(path, sizeof(path), "%s/new.log", dir);
+    fp = fopen(path, "w");
+    assert_non_null(fp);
+    fclose(fp);
+    w_file_watch_wait(5);
+
+    assert_int_not_equal(w_file_watch_events(wd), events);
+
+    unlink(path);
+    rmdir(dir);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_w_file_watch_disabled, setup_file, teardown_file),
+        cmocka_unit_test_setup_teardown(test_w_file_watch_events, setup_file, teardown_file),
+        cmocka_unit_test(test_w_file_watch_dir),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
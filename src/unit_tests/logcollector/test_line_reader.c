@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../headers/shared.h"
+#include "../../logcollector/logcollector.h"
+
+#include "../wrappers/common.h"
+
+static char reader_file[] = "/tmp/test_line_reader-XXXXXX";
+
+/* setup/teardown */
+
+static int setup_file(void **state) {
+    logreader * lf;
+    int fd;
+
+    strcpy(reader_file + strlen(reader_file) - 6, "XXXXXX");
+
+    if (fd = mkstemp(reader_file), fd < 0) {
+        return -1;
+    }
+
+    close(fd);
+    os_calloc(1, sizeof(logreader), lf);
+    lf->file = reader_file;
+    *state = lf;
+    return 0;
+}
+
+static int teardown_file(void **state) {
+    logreader * lf = *state;
+
+    if (lf->fp) {
+        fclose(lf->fp);
+    }
+
+    unlink(reader_file);
+    os_free(lf);
+    return 0;
+}
+
+static void append_file(const char * data, size_t size) {
+    FILE * fp = fopen(reader_file, "ab");
+    assert_non_null(fp);
+    assert_int_equal(fwrite(data, 1, size, fp), size);
+    fclose(fp);
+}
+
+/* Hash of the first bytes of the file, as computed when it is opened */
+static void assert_hash(SHA_CTX * context, int64_t position) {
+    SHA_CTX expected;
+    os_sha1 expected_hash;
+    os_sha1 hash;
+
+    assert_int_equal(OS_SHA1_File_Nbytes(reader_file, &expected, expected_hash, OS_BINARY, position), 0);
+    OS_SHA1_Stream(context, hash, NULL);
+    assert_string_equal(hash, expected_hash);
+}
+
+/* tests */
+
+void test_w_line_reader_lines(void ** state)
+{
+    logreader * lf = *state;
+    w_line_reader_t reader;
+    SHA_CTX context;
+    size_t length;
+    char * line;
+
+    append_file("first\n\nthird\npart", 17);
+    lf->fp = fopen(reader_file, "r");
+    SHA1_Init(&context);
+
+    w_line_reader_init(&reader, lf, 0, 64, &context);
+
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_OK);
+    assert_string_equal(line, "first");
+    assert_int_equal(length, 5);
+    w_line_reader_commit(&reader);
+
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_OK);
+    assert_string_equal(line, "");
+    w_line_reader_commit(&reader);
+
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_OK);
+    assert_string_equal(line, "third");
+    w_line_reader_commit(&reader);
+
+    // The last line is not complete yet
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_NONE);
+    assert_int_equal(w_line_reader_close(&reader), 13);
+    assert_int_equal(w_ftell(lf->fp), 13);
+    assert_hash(&context, 13);
+
+    append_file("ial\n", 4);
+    w_line_reader_init(&reader, lf, 13, 64, &context);
+
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_OK);
+    assert_string_equal(line, "partial");
+    w_line_reader_commit(&reader);
+
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_NONE);
+    assert_int_equal(w_line_reader_close(&reader), 21);
+    assert_hash(&context, 21);
+}
+
+void test_w_line_reader_truncated(void ** state)
+{
+    logreader * lf = *state;
+    w_line_reader_t reader;
+    SHA_CTX context;
+    size_t length;
+    char * line;
+
+    append_file("0123456789abcdef\nnext\n", 22);
+    lf->fp = fopen(reader_file, "r");
+    SHA1_Init(&context);
+
+    w_line_reader_init(&reader, lf, 0, 10, &context);
+
+    // The rest of the line is skipped
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_TRUNCATED);
+    assert_string_equal(line, "0123456789");
+    assert_int_equal(length, 10);
+    w_line_reader_commit(&reader);
+
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_OK);
+    assert_string_equal(line, "next");
+    w_line_reader_commit(&reader);
+
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_NONE);
+    assert_int_equal(w_line_reader_close(&reader), 22);
+    assert_hash(&context, 22);
+}
+
+void test_w_line_reader_not_committed(void ** state)
+{
+    logreader * lf = *state;
+    w_line_reader_t reader;
+    SHA_CTX context;
+    size_t length;
+    char * line;
+
+    append_file("one\ntwo\nthree\n", 14);
+    lf->fp = fopen(reader_file, "r");
+    SHA1_Init(&context);
+
+    w_line_reader_init(&reader, lf, 0, 64, &context);
+
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_OK);
+    w_line_reader_commit(&reader);
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_OK);
+    assert_int_equal(w_line_reader_next(&reader, &line, &length), W_LINE_OK);
+
+    // The lines after the commit are read again
+    assert_int_equal(w_line_reader_close(&reader), 4);
+    assert_int_equal(w_ftell(lf->fp), 4);
+    assert_hash(&context, 4);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_w_line_reader_lines, setup_file, teardown_file),
+        cmocka_unit_test_setup_teardown(test_w_line_reader_truncated, setup_file, teardown_file),
+        cmocka_unit_test_setup_teardown(test_w_line_reader_not_committed, setup_file, teardown_file),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
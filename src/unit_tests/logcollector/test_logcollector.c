@@ -37,6 +37,7 @@ void w_initialize_file_status();
 ssize_t w_set_to_pos(logreader *lf, long pos, int mode);
 char * w_save_files_status_to_cJSON();
 void w_save_file_status();
+void w_save_file_status_changes();
 void w_load_files_status(cJSON *global_json);
 void w_initialize_file_status();
 int w_update_hash_node(char * path, int64_t pos);
@@ -190,6 +191,7 @@ static int teardown_regex(void **state) {
     }
 
     os_free(regex_config);
+    w_expression_release_thread_data();
 
     return 0;
 }
@@ -771,11 +773,11 @@ void test_w_save_file_status_wfopen_error(void ** state) {
 
     expect_function_call(__wrap_cJSON_Delete);
 
-    expect_string(__wrap_wfopen, __filename, "queue/logcollector/file_status.json");
+    expect_string(__wrap_wfopen, __filename, "queue/logcollector/file_status.json.tmp");
     expect_string(__wrap_wfopen, __modes, "w");
     will_return(__wrap_wfopen, 0);
 
-    expect_string(__wrap__merror_exit, formatted_msg, "(1103): Could not open file 'queue/logcollector/file_status.json' due to [(0)-(Success)].");
+    expect_string(__wrap__merror_exit, formatted_msg, "(1103): Could not open file 'queue/logcollector/file_status.json.tmp' due to [(0)-(Success)].");
     expect_assert_failure(w_save_file_status());
 }
 
@@ -838,13 +840,13 @@ void test_w_save_file_status_fwrite_error(void ** state) {
 
     expect_function_call(__wrap_cJSON_Delete);
 
-    expect_string(__wrap_wfopen, __filename, "queue/logcollector/file_status.json");
+    expect_string(__wrap_wfopen, __filename, "queue/logcollector/file_status.json.tmp");
     expect_string(__wrap_wfopen, __modes, "w");
     will_return(__wrap_wfopen, "test");
 
     will_return(__wrap_fwrite, 0);
 
-    expect_string(__wrap__merror, formatted_msg, "(1110): Could not write file 'queue/logcollector/file_status.json' due to [(0)-(Success)].");
+    expect_string(__wrap__merror, formatted_msg, "(1110): Could not write file 'queue/logcollector/file_status.json.tmp' due to [(0)-(Success)].");
 
     expect_function_call(__wrap_clearerr);
     expect_string(__wrap_clearerr, __stream, "test");
@@ -913,16 +915,101 @@ void test_w_save_file_status_OK(void ** state) {
 
     expect_function_call(__wrap_cJSON_Delete);
 
-    expect_string(__wrap_wfopen, __filename, "queue/logcollector/file_status.json");
+    expect_string(__wrap_wfopen, __filename, "queue/logcollector/file_status.json.tmp");
     expect_string(__wrap_wfopen, __modes, "w");
     will_return(__wrap_wfopen, "test");
 
     will_return(__wrap_fwrite, 1);
 
+    expect_value(__wrap_fileno, __stream, "test");
+    will_return(__wrap_fileno, -1);
+
     expect_value(__wrap_fclose, _File, "test");
     will_return(__wrap_fclose, 1);
 
+    expect_rename_ex("queue/logcollector/file_status.json.tmp", "queue/logcollector/file_status.json", 0);
+
     w_save_file_status();
+
+    assert_true(data->saved);
+}
+
+/* w_save_file_status_changes */
+
+void test_w_save_file_status_changes_OK(void ** state) {
+    test_logcollector_t *test_data = *state;
+    w_macos_log_procceses_t * macos_processes_backup = macos_processes;
+    const char * record = "5 32bb98743e298dee0a654a654765c765d765ae80 test\n";
+
+    os_file_status_t * data = test_data->status;
+    OSHashNode *hash_node = test_data->node;
+
+    strcpy(data->hash, "32bb98743e298dee0a654a654765c765d765ae80");
+    data->offset = 5;
+    data->saved = false;
+
+    hash_node->key = "test";
+    hash_node->data = data;
+
+    macos_processes = NULL;
+
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+
+    expect_value(__wrap_OSHash_Begin, self, files_status);
+    will_return(__wrap_OSHash_Begin, hash_node);
+
+    expect_value(__wrap_OSHash_Next, self, files_status);
+    will_return(__wrap_OSHash_Next, NULL);
+
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
+    expect_string(__wrap_wfopen, __filename, LOCALFILE_JOURNAL);
+    expect_string(__wrap_wfopen, __modes, "a");
+    will_return(__wrap_wfopen, "test");
+
+    will_return(__wrap_fwrite, strlen(record));
+
+    expect_value(__wrap_fileno, __stream, "test");
+    will_return(__wrap_fileno, -1);
+
+    expect_value(__wrap_fclose, _File, "test");
+    will_return(__wrap_fclose, 1);
+
+    w_save_file_status_changes();
+
+    assert_true(data->saved);
+
+    macos_processes = macos_processes_backup;
+}
+
+void test_w_save_file_status_changes_no_changes(void ** state) {
+    test_logcollector_t *test_data = *state;
+    w_macos_log_procceses_t * macos_processes_backup = macos_processes;
+
+    os_file_status_t * data = test_data->status;
+    OSHashNode *hash_node = test_data->node;
+
+    data->saved = true;
+
+    hash_node->key = "test";
+    hash_node->data = data;
+
+    macos_processes = NULL;
+
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+
+    expect_value(__wrap_OSHash_Begin, self, files_status);
+    will_return(__wrap_OSHash_Begin, hash_node);
+
+    expect_value(__wrap_OSHash_Next, self, files_status);
+    will_return(__wrap_OSHash_Next, NULL);
+
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
+    // Nothing is written
+    w_save_file_status_changes();
+
+    macos_processes = macos_processes_backup;
 }
 
 /* w_load_files_status */
@@ -1619,6 +1706,12 @@ void test_w_initialize_file_status_fopen_fail(void ** state) {
     expect_function_call(__wrap_OSHash_SetFreeDataPointer);
     will_return(__wrap_OSHash_SetFreeDataPointer, 1);
 
+    expect_string(__wrap_fopen, path, LOCALFILE_JOURNAL);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, NULL);
+
+    expect_string(__wrap__merror, formatted_msg, "(1103): Could not open file 'queue/logcollector/file_status.journal' due to [(0)-(Success)].");
+
     expect_string(__wrap_fopen, path, LOCALFILE_STATUS);
     expect_string(__wrap_fopen, mode, "r");
     will_return(__wrap_fopen, NULL);
@@ -1637,6 +1730,12 @@ void test_w_initialize_file_status_fread_fail(void ** state) {
     expect_function_call(__wrap_OSHash_SetFreeDataPointer);
     will_return(__wrap_OSHash_SetFreeDataPointer, 1);
 
+    expect_string(__wrap_fopen, path, LOCALFILE_JOURNAL);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, NULL);
+
+    expect_string(__wrap__merror, formatted_msg, "(1103): Could not open file 'queue/logcollector/file_status.journal' due to [(0)-(Success)].");
+
     expect_string(__wrap_fopen, path, LOCALFILE_STATUS);
     expect_string(__wrap_fopen, mode, "r");
     will_return(__wrap_fopen, "test");
@@ -1672,6 +1771,12 @@ void test_w_initialize_file_status_OK(void ** state) {
     expect_function_call(__wrap_OSHash_SetFreeDataPointer);
     will_return(__wrap_OSHash_SetFreeDataPointer, 1);
 
+    expect_string(__wrap_fopen, path, LOCALFILE_JOURNAL);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, NULL);
+
+    expect_string(__wrap__merror, formatted_msg, "(1103): Could not open file 'queue/logcollector/file_status.journal' due to [(0)-(Success)].");
+
     expect_string(__wrap_fopen, path, LOCALFILE_STATUS);
     expect_string(__wrap_fopen, mode, "r");
     will_return(__wrap_fopen, "test");
@@ -1732,6 +1837,57 @@ void test_w_initialize_file_status_OK(void ** state) {
     w_initialize_file_status();
 }
 
+void test_w_initialize_file_status_journal(void ** state) {
+    int mode = OS_BINARY;
+    char * file = "test";
+    struct stat stat_buf = { .st_mode = 0100000 };
+
+    expect_function_call(__wrap_OSHash_Create);
+    will_return(__wrap_OSHash_Create, 1);
+
+    will_return(__wrap_OSHash_setSize, 1);
+
+    expect_function_call(__wrap_OSHash_SetFreeDataPointer);
+    will_return(__wrap_OSHash_SetFreeDataPointer, 1);
+
+    expect_string(__wrap_fopen, path, LOCALFILE_JOURNAL);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, "test");
+
+    // The last record of each file is kept, and a partial record ends the journal
+    will_return(__wrap_fgets, "1 32bb98743e298dee0a654a654765c765d765ae80 test\n");
+    expect_value(__wrap_fgets, __stream, "test");
+    will_return(__wrap_fgets, "not a record\n");
+    expect_value(__wrap_fgets, __stream, "test");
+    will_return(__wrap_fgets, "7 5dd9a9e4b8a1c3f0e4d3c2b1a09f8e7d6c5b4a39 test\n");
+    expect_value(__wrap_fgets, __stream, "test");
+    will_return(__wrap_fgets, "3 5dd9a9e4b8a1c3f0e4d3c2b1a09f8e7d6c5b4a39 other");
+    expect_value(__wrap_fgets, __stream, "test");
+
+    expect_value(__wrap_fclose, _File, "test");
+    will_return(__wrap_fclose, 1);
+
+    expect_string(__wrap_fopen, path, LOCALFILE_STATUS);
+    expect_string(__wrap_fopen, mode, "r");
+    will_return(__wrap_fopen, NULL);
+
+    expect_string(__wrap__merror, formatted_msg, "(1103): Could not open file 'queue/logcollector/file_status.json' due to [(0)-(Success)].");
+
+    expect_string(__wrap_stat, __file, file);
+    will_return(__wrap_stat, &stat_buf);
+    will_return(__wrap_stat, 0);
+
+    expect_string(__wrap_OS_SHA1_File_Nbytes, fname, file);
+    expect_value(__wrap_OS_SHA1_File_Nbytes, mode, mode);
+    expect_value(__wrap_OS_SHA1_File_Nbytes, nbytes, 7);
+    will_return(__wrap_OS_SHA1_File_Nbytes, "5dd9a9e4b8a1c3f0e4d3c2b1a09f8e7d6c5b4a39");
+    will_return(__wrap_OS_SHA1_File_Nbytes, 1);
+
+    will_return(__wrap_OSHash_Update_ex, 1);
+
+    w_initialize_file_status();
+}
+
 /* w_update_hash_node */
 
 void test_w_update_hash_node_path_NULL(void ** state) {
@@ -2319,7 +2475,7 @@ void check_ignore_and_restrict_not_ignored(void ** state) {
     w_expression_compile(expression_ignore, "ignore.*", 0);
     OSList_InsertData(regex_config->regex_ignore, NULL, expression_ignore);
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, 1);
+    will_return(wrap_pcre2_match_data_create, 1);
     will_return(wrap_pcre2_match, 0);
 
     int ret = check_ignore_and_restrict(regex_config->regex_ignore, NULL, str_test);
@@ -2343,7 +2499,7 @@ void check_ignore_and_restrict_ignored(void ** state) {
     w_expression_compile(expression_ignore, "ignore.*", 0);
     OSList_InsertData(regex_config->regex_ignore, NULL, expression_ignore);
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, 1);
+    will_return(wrap_pcre2_match_data_create, 1);
     will_return(wrap_pcre2_match, 1);
     will_return(wrap_pcre2_get_ovector_pointer, aux);
 
@@ -2371,7 +2527,7 @@ void check_ignore_and_restrict_not_restricted(void ** state) {
     w_expression_compile(expression_restrict, "restrict.*", 0);
     OSList_InsertData(regex_config->regex_restrict, NULL, expression_restrict);
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, 1);
+    will_return(wrap_pcre2_match_data_create, 1);
     will_return(wrap_pcre2_match, 1);
     will_return(wrap_pcre2_get_ovector_pointer, aux);
 
@@ -2393,7 +2549,7 @@ void check_ignore_and_restrict_restricted(void ** state) {
     w_expression_compile(expression_restrict, "restrict.*", 0);
     OSList_InsertData(regex_config->regex_restrict, NULL, expression_restrict);
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, 1);
+    will_return(wrap_pcre2_match_data_create, 1);
     will_return(wrap_pcre2_match, 0);
 
     snprintf(log_str, PATH_MAX, LF_MATCH_REGEX, "testing log not match", "restrict", "restrict.*");
@@ -2404,6 +2560,105 @@ void check_ignore_and_restrict_restricted(void ** state) {
     assert_true(ret);
 }
 
+/* w_msg_file_get */
+
+void test_w_msg_file_get_shared(void ** state) {
+    w_msg_file_t * entry;
+    char * first = w_msg_file_get("/var/log/test.log");
+    char * second = w_msg_file_get("/var/log/test.log");
+
+    assert_string_equal(first, "/var/log/test.log");
+    assert_ptr_equal(first, second);
+
+    // Two messages and the input thread
+    entry = (w_msg_file_t *)(first - offsetof(w_msg_file_t, name));
+    assert_int_equal(entry->refs, 3);
+
+    w_msg_file_release(first);
+    w_msg_file_release(second);
+    assert_int_equal(entry->refs, 1);
+}
+
+void test_w_msg_file_get_other_file(void ** state) {
+    char * first = w_msg_file_get("/var/log/first.log");
+    char * second = w_msg_file_get("/var/log/second.log");
+
+    // The message keeps the name of the previous file
+    assert_string_equal(first, "/var/log/first.log");
+    assert_string_equal(second, "/var/log/second.log");
+    assert_ptr_not_equal(first, second);
+
+    w_msg_file_release(first);
+    w_msg_file_release(second);
+}
+
+/* w_msg_hash_queues_busy */
+
+void test_w_msg_hash_queues_busy(void ** state) {
+    w_msg_queue_t queue = { .msg_queue = queue_init(16) };
+    socket_forwarder socket = { .name = "agent" };
+    logtarget targets[2] = { { .log_socket = &socket, .queue = &queue } };
+    int values[14];
+    int i;
+
+    OUTPUT_QUEUE_SIZE = 16;
+    w_mutex_init(&queue.mutex, NULL);
+
+    assert_false(w_msg_hash_queues_busy(targets));
+
+    // The queue fits 15 messages, the files wait when less than 2 slots are left
+    for (i = 0; i < 13; i++) {
+        queue_push(queue.msg_queue, &values[i]);
+    }
+
+    assert_false(w_msg_hash_queues_busy(targets));
+
+    queue_push(queue.msg_queue, &values[13]);
+    assert_true(w_msg_hash_queues_busy(targets));
+
+    OUTPUT_QUEUE_SIZE = OUTPUT_MIN_QUEUE_SIZE;
+    w_mutex_destroy(&queue.mutex);
+    queue_free(queue.msg_queue);
+}
+
+void test_w_msg_hash_queues_busy_no_queue(void ** state) {
+    socket_forwarder socket = { .name = "custom" };
+    logtarget targets[2] = { { .log_socket = &socket } };
+
+    // Targets out of the configuration have no credit to check
+    assert_false(w_msg_hash_queues_busy(targets));
+}
+
+/* w_msg_queue_pop_batch */
+
+void test_w_msg_queue_pop_batch(void ** state) {
+    w_msg_queue_t queue = { .msg_queue = queue_init(8) };
+    w_message_t messages[5];
+    w_message_t * popped[4];
+
+    w_mutex_init(&queue.mutex, NULL);
+    w_cond_init(&queue.available, NULL);
+    w_cond_init(&queue.space, NULL);
+
+    for (int i = 0; i < 5; i++) {
+        queue_push(queue.msg_queue, &messages[i]);
+    }
+
+    assert_int_equal(w_msg_queue_pop_batch(&queue, popped, 4), 4);
+    assert_ptr_equal(popped[0], &messages[0]);
+    assert_ptr_equal(popped[3], &messages[3]);
+
+    // What is left doesn't fill the batch
+    assert_int_equal(w_msg_queue_pop_batch(&queue, popped, 4), 1);
+    assert_ptr_equal(popped[0], &messages[4]);
+    assert_true(queue_empty(queue.msg_queue));
+
+    w_cond_destroy(&queue.space);
+    w_cond_destroy(&queue.available);
+    w_mutex_destroy(&queue.mutex);
+    queue_free(queue.msg_queue);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         // Test w_get_hash_context
@@ -2436,6 +2691,9 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_w_save_file_status_wfopen_error, setup_log_context, teardown_log_context),
         cmocka_unit_test_setup_teardown(test_w_save_file_status_fwrite_error, setup_log_context, teardown_log_context),
         cmocka_unit_test_setup_teardown(test_w_save_file_status_OK, setup_log_context, teardown_log_context),
+        // Test w_save_file_status_changes
+        cmocka_unit_test_setup_teardown(test_w_save_file_status_changes_OK, setup_log_context, teardown_log_context),
+        cmocka_unit_test_setup_teardown(test_w_save_file_status_changes_no_changes, setup_log_context, teardown_log_context),
 
         // Test w_load_files_status
         cmocka_unit_test(test_w_load_files_status_empty_array),
@@ -2463,6 +2721,7 @@ int main(void) {
         cmocka_unit_test(test_w_initialize_file_status_fopen_fail),
         cmocka_unit_test(test_w_initialize_file_status_fread_fail),
         cmocka_unit_test_setup_teardown(test_w_initialize_file_status_OK, setup_local_hashmap, teardown_local_hashmap),
+        cmocka_unit_test_setup_teardown(test_w_initialize_file_status_journal, setup_local_hashmap, teardown_local_hashmap),
 
         // Test w_update_hash_node
         cmocka_unit_test(test_w_update_hash_node_path_NULL),
@@ -2505,8 +2764,16 @@ int main(void) {
         cmocka_unit_test_setup_teardown(check_ignore_and_restrict_not_ignored, setup_regex, teardown_regex),
         cmocka_unit_test_setup_teardown(check_ignore_and_restrict_ignored, setup_regex, teardown_regex),
         cmocka_unit_test_setup_teardown(check_ignore_and_restrict_not_restricted, setup_regex, teardown_regex),
-        cmocka_unit_test_setup_teardown(check_ignore_and_restrict_restricted, setup_regex, teardown_regex)
-
+        cmocka_unit_test_setup_teardown(check_ignore_and_restrict_restricted, setup_regex, teardown_regex),
+
+        // Test w_msg_file_get
+        cmocka_unit_test(test_w_msg_file_get_shared),
+        cmocka_unit_test(test_w_msg_file_get_other_file),
+        // Test w_msg_hash_queues_busy
+        cmocka_unit_test(test_w_msg_hash_queues_busy),
+        cmocka_unit_test(test_w_msg_hash_queues_busy_no_queue),
+        // Test w_msg_queue_pop_batch
+        cmocka_unit_test(test_w_msg_queue_pop_batch),
     };
 
     return cmocka_run_group_tests(tests, setup_group, teardown_group);
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Includes */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../../logcollector/logcollector.h"
+#include "../../headers/shared.h"
+#include "../wrappers/common.h"
+
+/* Prototypes */
+
+void w_journald_add_matches(void * journal, const char * query);
+size_t w_journald_format_entry(void * journal, char * buffer, size_t size);
+
+/* Globals */
+
+extern w_journald_lib_t sd;
+extern int maximum_lines;
+
+/* Fake journal: a list of entries, each one being a list of fields */
+
+static const char * const * fake_entries[5];
+static int fake_current;
+static int fake_disjunctions;
+static char fake_matches[OS_SIZE_256];
+
+static int fake_next(__attribute__((unused)) void * journal) {
+    if (fake_entries[fake_current + 1] == NULL) {
+        return 0;
+    }
+
+    fake_current++;
+    return 1;
+}
+
+static int fake_get_data(__attribute__((unused)) void * journal, const char * field, const void ** data, size_t * length) {
+    const size_t field_len = strlen(field);
+
+    for (const char * const * f = fake_entries[fake_current]; *f; f++) {
+        if (strncmp(*f, field, field_len) == 0 && (*f)[field_len] == '=') {
+            *data = *f;
+            *length = strlen(*f);
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+static int fake_get_realtime_usec(__attribute__((unused)) void * journal, uint64_t * usec) {
+    *usec = 1609459200000000ULL + 3723000000ULL;
+    return 0;
+}
+
+static int fake_get_cursor(__attribute__((unused)) void * journal, char ** cursor) {
+    *cursor = strdup("s=1;i=2");
+    return 0;
+}
+
+static int fake_wait(__attribute__((unused)) void * journal, __attribute__((unused)) uint64_t timeout_usec) {
+    return 0;
+}
+
+static int fake_add_match(__attribute__((unused)) void * journal, const void * data, __attribute__((unused)) size_t size) {
+    strncat(fake_matches, data, sizeof(fake_matches) - strlen(fake_matches) - 2);
+    strcat(fake_matches, ",");
+    return 0;
+}
+
+static int fake_add_disjunction(__attribute__((unused)) void * journal) {
+    fake_disjunctions++;
+    return 0;
+}
+
+static const char * const entry_syslog[] = {
+    "MESSAGE=Started Session 1 of user root.", "_HOSTNAME=host", "SYSLOG_IDENTIFIER=systemd", "_PID=1", NULL
+};
+
+static const char * const entry_comm[] = { "MESSAGE=hello", "_HOSTNAME=host", "_COMM=bash", NULL };
+static const char * const entry_no_message[] = { "_HOSTNAME=host", "_COMM=bash", NULL };
+static const char * const entry_bare[] = { "MESSAGE=kernel: oops", NULL };
+
+/* setup/teardown */
+
+static int group_setup(void ** state) {
+    test_mode = 1;
+    setenv("TZ", "UTC", 1);
+    tzset();
+
+    sd.next = fake_next;
+    sd.get_data = fake_get_data;
+    sd.get_realtime_usec = fake_get_realtime_usec;
+    sd.get_cursor = fake_get_cursor;
+    sd.wait = fake_wait;
+    sd.add_match = fake_add_match;
+    sd.add_disjunction = fake_add_disjunction;
+    return 0;
+}
+
+static int group_teardown(void ** state) {
+    test_mode = 0;
+    return 0;
+}
+
+static int setup_entries(void ** state) {
+    memset(fake_entries, 0, sizeof(fake_entries));
+    fake_current = 0;
+    fake_disjunctions = 0;
+    *fake_matches = '\0';
+    return 0;
+}
+
+/* wraps */
+
+int __wrap_can_read() {
+    return mock_type(int);
+}
+
+int __wrap_w_msg_hash_queues_push(const char * str, char * file, unsigned long size, logtarget * targets, char queue_mq) {
+    check_expected(str);
+    check_expected(file);
+    return 0;
+}
+
+/* tests */
+
+/* w_journald_format_entry */
+
+void test_w_journald_format_entry_syslog(void ** state) {
+    char buffer[OS_MAXSTR];
+
+    fake_entries[0] = entry_syslog;
+
+    assert_int_equal(w_journald_format_entry(NULL, buffer, sizeof(buffer)), 64);
+    assert_string_equal(buffer, "Jan 01 01:02:03 host systemd[1]: Started Session 1 of user root.");
+}
+
+void test_w_journald_format_entry_comm(void ** state) {
+    char buffer[OS_MAXSTR];
+
+    fake_entries[0] = entry_comm;
+
+    w_journald_format_entry(NULL, buffer, sizeof(buffer));
+    assert_string_equal(buffer, "Jan 01 01:02:03 host bash: hello");
+}
+
+void test_w_journald_format_entry_bare(void ** state) {
+    char buffer[OS_MAXSTR];
+
+    fake_entries[0] = entry_bare;
+
+    w_journald_format_entry(NULL, buffer, sizeof(buffer));
+    assert_string_equal(buffer, "Jan 01 01:02:03 localhost kernel: oops");
+}
+
+void test_w_journald_format_entry_no_message(void ** state) {
+    char buffer[OS_MAXSTR];
+
+    fake_entries[0] = entry_no_message;
+
+    assert_int_equal(w_journald_format_entry(NULL, buffer, sizeof(buffer)), 0);
+}
+
+void test_w_journald_format_entry_truncated(void ** state) {
+    char buffer[24];
+
+    fake_entries[0] = entry_syslog;
+
+    assert_int_equal(w_journald_format_entry(NULL, buffer, sizeof(buffer)), sizeof(buffer) - 1);
+    assert_string_equal(buffer, "Jan 01 01:02:03 host sy");
+}
+
+/* w_journald_add_matches */
+
+void test_w_journald_add_matches(void ** state) {
+    expect_string(__wrap__mwarn, formatted_msg, "Invalid journald match 'sshd', it will be ignored.");
+
+    w_journald_add_matches(NULL, "_SYSTEMD_UNIT=sshd.service sshd + _TRANSPORT=kernel");
+
+    assert_string_equal(fake_matches, "_SYSTEMD_UNIT=sshd.service,_TRANSPORT=kernel,");
+    assert_int_equal(fake_disjunctions, 1);
+}
+
+void test_w_journald_add_matches_null(void ** state) {
+    w_journald_add_matches(NULL, NULL);
+
+    assert_string_equal(fake_matches, "");
+    assert_int_equal(fake_disjunctions, 0);
+}
+
+/* read_journald */
+
+void test_read_journald(void ** state) {
+    w_journald_config_t journald = { .journal = (void *)1 };
+    logreader lf = { .journald = &journald };
+    int rc = -1;
+
+    fake_entries[1] = entry_syslog;
+    fake_entries[2] = entry_no_message;
+    fake_entries[3] = entry_comm;
+    maximum_lines = 10;
+    w_mutex_init(&journald.mutex, NULL);
+
+    will_return_count(__wrap_can_read, 1, 4);
+    expect_string(__wrap_w_msg_hash_queues_push, str, "Jan 01 01:02:03 host systemd[1]: Started Session 1 of user root.");
+    expect_string(__wrap_w_msg_hash_queues_push, file, JOURNALD_LOG_NAME);
+    expect_string(__wrap_w_msg_hash_queues_push, str, "Jan 01 01:02:03 host bash: hello");
+    expect_string(__wrap_w_msg_hash_queues_push, file, JOURNALD_LOG_NAME);
+
+    assert_null(read_journald(&lf, &rc, 0));
+
+    assert_int_equal(rc, 0);
+    assert_string_equal(journald.cursor, "s=1;i=2");
+    assert_false(journald.cursor_saved);
+
+    os_free(journald.cursor);
+    pthread_mutex_destroy(&journald.mutex);
+}
+
+void test_read_journald_maximum_lines(void ** state) {
+    w_journald_config_t journald = { .journal = (void *)1, .cursor_saved = true };
+    logreader lf = { .journald = &journald };
+    int rc = -1;
+
+    fake_entries[1] = entry_syslog;
+    fake_entries[2] = entry_comm;
+    maximum_lines = 1;
+    w_mutex_init(&journald.mutex, NULL);
+
+    will_return(__wrap_can_read, 1);
+    expect_string(__wrap_w_msg_hash_queues_push, str, "Jan 01 01:02:03 host systemd[1]: Started Session 1 of user root.");
+    expect_string(__wrap_w_msg_hash_queues_push, file, JOURNALD_LOG_NAME);
+
+    assert_null(read_journald(&lf, &rc, 0));
+
+    // The next entry is left for the next batch
+    assert_int_equal(fake_current, 1);
+    assert_false(journald.cursor_saved);
+
+    os_free(journald.cursor);
+    pthread_mutex_destroy(&journald.mutex);
+}
+
+void test_read_journald_disabled(void ** state) {
+    w_journald_config_t journald = { .disabled = true };
+    logreader lf = { .journald = &journald };
+    int rc = -1;
+
+    assert_null(read_journald(&lf, &rc, 0));
+    assert_int_equal(rc, 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        // Tests w_journald_format_entry
+        cmocka_unit_test_setup(test_w_journald_format_entry_syslog, setup_entries),
+        cmocka_unit_test_setup(test_w_journald_format_entry_comm, setup_entries),
+        cmocka_unit_test_setup(test_w_journald_format_entry_bare, setup_entries),
+        cmocka_unit_test_setup(test_w_journald_format_entry_no_message, setup_entries),
+        cmocka_unit_test_setup(test_w_journald_format_entry_truncated, setup_entries),
+        // Tests w_journald_add_matches
+        cmocka_unit_test_setup(test_w_journald_add_matches, setup_entries),
+        cmocka_unit_test_setup(test_w_journald_add_matches_null, setup_entries),
+        // Tests read_journald
+        cmocka_unit_test_setup(test_read_journald, setup_entries),
+        cmocka_unit_test_setup(test_read_journald_maximum_lines, setup_entries),
+        cmocka_unit_test_setup(test_read_journald_disabled, setup_entries),
+    };
+
+    return cmocka_run_group_tests(tests, group_setup, group_teardown);
+}
@@ -37,7 +37,8 @@ int __wrap_can_read() {
     return mock_type(int);
 }
 
-bool __wrap_w_get_hash_context(const char * path, SHA_CTX * context, int64_t position) {
+bool __wrap_w_get_hash_context(logreader * lf, SHA_CTX * context, int64_t position) {
+    SHA1_Init(context);
     return mock_type(bool);
 }
 
@@ -55,68 +56,65 @@ void __wrap_OS_SHA1_Stream(SHA_CTX *c, os_sha1 output, char * buf) {
 void test_buffer_space(void ** state) {
     logreader lf = { .file = "test", .linecount = 3 };
     int rc;
-    char * input_str = malloc(OS_MAX_LOG_SIZE);
-    memset(input_str, '.', OS_MAX_LOG_SIZE - 1);
-    input_str[OS_MAX_LOG_SIZE - 1] = '\0';
+    char * input_str = malloc(OS_MAX_LOG_SIZE * 2 + 8);
+
+    // Two lines filling the buffer and a third one
+    memset(input_str, '.', OS_MAX_LOG_SIZE * 2);
+    input_str[OS_MAX_LOG_SIZE - 1] = '\n';
+    input_str[OS_MAX_LOG_SIZE * 2 - 1] = '\n';
+    strcpy(input_str + OS_MAX_LOG_SIZE * 2, "end\n");
 
     expect_any(__wrap_w_ftell, x);
     will_return(__wrap_w_ftell, (int64_t) 0);
 
     will_return(__wrap_w_get_hash_context, true);
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) 0);
-
     will_return(__wrap_can_read, 1);
+    expect_fread(input_str, strlen(input_str));
 
-    expect_any(__wrap_fgets, __stream);
-    will_return(__wrap_fgets, input_str);
-
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) OS_MAX_LOG_SIZE - 1);
-
-    expect_function_call(__wrap_OS_SHA1_Stream);
-
+    will_return(__wrap_can_read, 1);
     will_return(__wrap_can_read, 1);
 
-    expect_any(__wrap_fgets, __stream);
-    will_return(__wrap_fgets, "\n");
+    expect_any(__wrap__merror, formatted_msg);
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) OS_MAX_LOG_SIZE);
+    will_return(__wrap_can_read, 1);
+    will_return(__wrap_w_update_file_status, 0);
 
-    expect_function_call(__wrap_OS_SHA1_Stream);
+    read_multiline(&lf, &rc, 1);
 
-    will_return(__wrap_can_read, 1);
+    free(input_str);
+}
 
-    expect_any(__wrap_fgets, __stream);
-    will_return(__wrap_fgets, input_str);
+void test_incomplete_message(void ** state) {
+    logreader lf = { .file = "test", .linecount = 2 };
+    int rc;
 
     expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) (OS_MAX_LOG_SIZE) * 2 - 1);
+    will_return(__wrap_w_ftell, (int64_t) 10);
 
-    expect_function_call(__wrap_OS_SHA1_Stream);
-
-    expect_any(__wrap__merror, formatted_msg);
+    will_return(__wrap_w_get_hash_context, true);
 
-    expect_any(__wrap_fgets, __stream);
-    will_return(__wrap_fgets, NULL);
+    will_return(__wrap_can_read, 1);
+    expect_fread("first\nsecond\nthird\n", 19);
 
-    expect_any(__wrap_w_ftell, x);
-    will_return(__wrap_w_ftell, (int64_t) (OS_MAX_LOG_SIZE) * 2 - 1);
+    will_return(__wrap_can_read, 1);
+    will_return(__wrap_can_read, 1);
+    will_return(__wrap_can_read, 1);
 
-    will_return(__wrap_can_read, 0);
+    // The third line is read again with the next one
+    expect_value(__wrap_w_fseek, pos, 23);
+    expect_any(__wrap_w_fseek, x);
+    will_return(__wrap_w_fseek, 0);
 
     will_return(__wrap_w_update_file_status, 0);
 
     read_multiline(&lf, &rc, 1);
-
-    free(input_str);
 }
 
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_buffer_space),
+        cmocka_unit_test(test_incomplete_message),
     };
 
     return cmocka_run_group_tests(tests, group_setup, group_teardown);
@@ -30,6 +30,7 @@ cJSON * w_logcollector_state_get();
 cJSON * _w_logcollector_generate_state(w_lc_state_storage_t * state, bool restart);
 void _w_logcollector_state_update_file(w_lc_state_storage_t * state, char * fpath, uint64_t bytes);
 void w_logcollector_state_update_file(char * fpath, uint64_t bytes);
+void _w_logcollector_state_update_read(w_lc_state_storage_t * state, char * fpath, uint64_t usec);
 void _w_logcollector_state_update_target(w_lc_state_storage_t * state, char * fpath, char * target, bool dropped);
 void w_logcollector_state_update_target(char * fpath, char * target, bool dropped);
 void w_logcollector_state_generate();
@@ -442,6 +443,69 @@ void test__w_logcollector_generate_state_one_target_restart(void ** state) {
     assert_int_equal(stats.start, 2525);
 }
 
+void test__w_logcollector_generate_state_reads_restart(void ** state) {
+
+    cJSON * retval;
+    w_lc_state_storage_t stats = {.states = (OSHash *) 2, .start = (time_t) 2020};
+    w_lc_state_target_t * target_array[1] = {NULL};
+
+    w_lc_state_file_t data = {.targets = (w_lc_state_target_t **) &target_array, .bytes = 100, .events = 5,
+                              .reads = 4, .read_usec = 1000, .read_max_usec = 700};
+    OSHashNode hash_node = {.data = &data, .key = "key_test"};
+
+    expect_value(__wrap_OSHash_Begin, self, stats.states);
+    will_return(__wrap_OSHash_Begin, &hash_node);
+
+    will_return_always(__wrap_cJSON_AddNumberToObject, 1);
+    will_return_always(__wrap_cJSON_AddStringToObject, 1);
+    will_return_always(__wrap_cJSON_AddItemToArray, true);
+    will_return_always(__wrap_cJSON_AddItemToObject, true);
+
+    will_return_always(__wrap_cJSON_CreateObject, (cJSON *) 10);
+    will_return_always(__wrap_cJSON_CreateArray, (cJSON *) 1);
+
+    expect_string(__wrap_cJSON_AddStringToObject, name, "location");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "key_test");
+    expect_string(__wrap_cJSON_AddNumberToObject, name, "events");
+    expect_value(__wrap_cJSON_AddNumberToObject, number, 5);
+    expect_string(__wrap_cJSON_AddNumberToObject, name, "bytes");
+    expect_value(__wrap_cJSON_AddNumberToObject, number, 100);
+    expect_string(__wrap_cJSON_AddNumberToObject, name, "reads");
+    expect_value(__wrap_cJSON_AddNumberToObject, number, 4);
+    expect_string(__wrap_cJSON_AddNumberToObject, name, "read_avg_usec");
+    expect_value(__wrap_cJSON_AddNumberToObject, number, 250);
+    expect_string(__wrap_cJSON_AddNumberToObject, name, "read_max_usec");
+    expect_value(__wrap_cJSON_AddNumberToObject, number, 700);
+
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+
+    expect_function_call(__wrap_cJSON_AddItemToArray);
+
+    expect_value(__wrap_OSHash_Next, self, stats.states);
+    will_return(__wrap_OSHash_Next, NULL);
+
+    will_return(__wrap_strftime,"2019-02-05 12:18:37");
+    will_return(__wrap_strftime, 20);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "start");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "2019-02-05 12:18:37");
+
+    will_return(__wrap_time, (time_t) 2525);
+    will_return(__wrap_strftime,"2019-02-05 12:18:42");
+    will_return(__wrap_strftime, 20);
+    expect_string(__wrap_cJSON_AddStringToObject, name, "end");
+    expect_string(__wrap_cJSON_AddStringToObject, string, "2019-02-05 12:18:42");
+
+    expect_function_call(__wrap_cJSON_AddItemToObject);
+    will_return(__wrap_time, (time_t) 2525);
+
+    retval = _w_logcollector_generate_state(&stats, true);
+
+    assert_ptr_equal(retval, (cJSON *) 10);
+    assert_int_equal(data.reads, 0);
+    assert_int_equal(data.read_usec, 0);
+    assert_int_equal(data.read_max_usec, 0);
+}
+
 /* Test _w_logcollector_state_update_file */
 void test__w_logcollector_state_update_file_new_data(void ** state) {
     w_lc_state_storage_t stat = {0};
@@ -507,6 +571,33 @@ void test_w_logcollector_state_update_file_null(void ** state) {
 }
 
 
+/* _w_logcollector_state_update_read */
+void test__w_logcollector_state_update_read_unknown_file(void ** state) {
+    w_lc_state_storage_t stat = { .states = *state };
+
+    expect_value(__wrap_OSHash_Get, self, stat.states);
+    expect_string(__wrap_OSHash_Get, key, "/test_path");
+    will_return(__wrap_OSHash_Get, NULL);
+
+    _w_logcollector_state_update_read(&stat, "/test_path", 100);
+}
+
+void test__w_logcollector_state_update_read_ok(void ** state) {
+    w_lc_state_storage_t stat = { .states = *state };
+    w_lc_state_file_t data = { .reads = 1, .read_usec = 300, .read_max_usec = 300 };
+
+    expect_value_count(__wrap_OSHash_Get, self, stat.states, 2);
+    expect_string_count(__wrap_OSHash_Get, key, "/test_path", 2);
+    will_return_count(__wrap_OSHash_Get, &data, 2);
+
+    _w_logcollector_state_update_read(&stat, "/test_path", 100);
+    _w_logcollector_state_update_read(&stat, "/test_path", 500);
+
+    assert_int_equal(data.reads, 3);
+    assert_int_equal(data.read_usec, 900);
+    assert_int_equal(data.read_max_usec, 500);
+}
+
 /* _w_logcollector_state_update_target */
 void test__w_logcollector_state_update_target_get_file_stats_fail(void ** state) {
     g_lc_state_type = LC_STATE_GLOBAL | LC_STATE_INTERVAL;
@@ -1182,12 +1273,16 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test__w_logcollector_generate_state_fail_get_node, setup_local_hashmap, teardown_local_hashmap),
         cmocka_unit_test_setup_teardown(test__w_logcollector_generate_state_one_target, setup_local_hashmap, teardown_local_hashmap),
         cmocka_unit_test_setup_teardown(test__w_logcollector_generate_state_one_target_restart, setup_local_hashmap, teardown_local_hashmap),
+        cmocka_unit_test_setup_teardown(test__w_logcollector_generate_state_reads_restart, setup_local_hashmap, teardown_local_hashmap),
 
         // Tests _w_logcollector_state_update_file
         cmocka_unit_test_setup_teardown(test__w_logcollector_state_update_file_new_data, setup_local_hashmap, teardown_local_hashmap),
         cmocka_unit_test_setup_teardown(test__w_logcollector_state_update_file_update, setup_local_hashmap, teardown_local_hashmap),
         cmocka_unit_test_setup_teardown(test__w_logcollector_state_update_file_fail_update, setup_local_hashmap, teardown_local_hashmap),
 
+        // Tests _w_logcollector_state_update_read
+        cmocka_unit_test_setup_teardown(test__w_logcollector_state_update_read_unknown_file, setup_local_hashmap, teardown_local_hashmap),
+        cmocka_unit_test_setup_teardown(test__w_logcollector_state_update_read_ok, setup_local_hashmap, teardown_local_hashmap),
         // Tests w_logcollector_state_update_file
         cmocka_unit_test(test_w_logcollector_state_update_file_null),
         cmocka_unit_test_setup_teardown(test_w_logcollector_state_update_file_ok, setup_global_variables, teardown_global_variables),
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../../headers/shared.h"
+#include "../../monitord/monitord.h"
+#include "../../external/zlib/zlib.h"
+
+/* The logs are compressed in a real folder */
+
+typedef struct compress_state {
+    char folder[PATH_MAX];
+    char logfile[PATH_MAX];
+    char logfile_gz[PATH_MAX];
+    char *content;
+    size_t size;
+} compress_state;
+
+static void write_log(compress_state *data, size_t size) {
+    FILE *fp = fopen(data->logfile, "w");
+    size_t i;
+
+    assert_non_null(fp);
+    os_malloc(size + 1, data->content);
+
+    for (i = 0; i < size; i++) {
+        // Somewhat compressible, not a single repeated pattern
+        data->content[i] = (char)('a' + (i * 7 + i / 1000) % 26);
+    }
+
+    data->size = size;
+    assert_int_equal(fwrite(data->content, 1, size, fp), size);
+    fclose(fp);
+}
+
+static void assert_gz_content(compress_state *data) {
+    gzFile zlog = gzopen(data->logfile_gz, "rb");
+    char *buffer;
+    int len;
+
+    assert_non_null(zlog);
+    os_malloc(data->size + 1, buffer);
+
+    // gzread goes through all the members of the file
+    len = gzread(zlog, buffer, (unsigned)data->size + 1);
+    gzclose(zlog);
+
+    assert_int_equal(len, data->size);
+    assert_memory_equal(buffer, data->content, data->size);
+    os_free(buffer);
+}
+
+static void assert_checksum(compress_state *data, log_checksum_t *checksum) {
+    unsigned char expected[SHA256_DIGEST_LENGTH];
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+
+    SHA256((unsigned char *)data->content, data->size, expected);
+    SHA256_Final(digest, &checksum->sha256);
+
+    assert_memory_equal(digest, expected, SHA256_DIGEST_LENGTH);
+}
+
+/* setup/teardown */
+
+static int setup_compress(void **state) {
+    compress_state *data;
+
+    os_calloc(1, sizeof(compress_state), data);
+    strcpy(data->folder, "/tmp/compress_log_XXXXXX");
+
+    if (!mkdtemp(data->folder)) {
+        os_free(data);
+        return -1;
+    }
+
+    snprintf(data->logfile, PATH_MAX, "%s/ossec-alerts-01.log", data->folder);
+    snprintf(data->logfile_gz, PATH_MAX, "%s.gz", data->logfile);
+
+    *state = data;
+    return 0;
+}
+
+static int teardown_compress(void **state) {
+    compress_state *data = *state;
+
+    OS_CompressLogOptions(Z_DEFAULT_COMPRESSION, 1);
+    rmdir_ex(data->folder);
+    os_free(data->content);
+    os_free(data);
+
+    return 0;
+}
+
+/* tests */
+
+void test_w_compress_log_single_thread(void **state) {
+    compress_state *data = *state;
+    log_checksum_t checksum;
+
+    write_log(data, 100000);
+    w_log_checksum_init(&checksum);
+
+    assert_int_equal(w_compress_log(data->logfile, &checksum), 0);
+
+    assert_int_equal(IsFile(data->logfile), -1);
+    assert_gz_content(data);
+    assert_checksum(data, &checksum);
+}
+
+void test_w_compress_log_threads(void **state) {
+    compress_state *data = *state;
+    log_checksum_t checksum;
+
+    // Several rounds of blocks, the last one incomplete
+    OS_CompressLogOptions(9, 3);
+    write_log(data, COMPRESS_BLOCK_SIZE * 7 + 1234);
+    w_log_checksum_init(&checksum);
+
+    assert_int_equal(w_compress_log(data->logfile, &checksum), 0);
+
+    assert_int_equal(IsFile(data->logfile), -1);
+    assert_gz_content(data);
+    assert_checksum(data, &checksum);
+}
+
+void test_w_compress_log_threads_empty(void **state) {
+    compress_state *data = *state;
+
+    OS_CompressLogOptions(6, 4);
+    write_log(data, 0);
+
+    assert_int_equal(w_compress_log(data->logfile, NULL), 0);
+
+    assert_int_equal(IsFile(data->logfile), -1);
+    assert_true(FileSize(data->logfile_gz) > 0);
+    assert_gz_content(data);
+}
+
+void test_w_compress_log_missing(void **state) {
+    compress_state *data = *state;
+
+    assert_int_equal(w_compress_log(data->logfile, NULL), -1);
+    assert_int_equal(IsFile(data->logfile_gz), -1);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        // Tests w_compress_log
+        cmocka_unit_test_setup_teardown(test_w_compress_log_single_thread, setup_compress, teardown_compress),
+        cmocka_unit_test_setup_teardown(test_w_compress_log_threads, setup_compress, teardown_compress),
+        cmocka_unit_test_setup_teardown(test_w_compress_log_threads_empty, setup_compress, teardown_compress),
+        cmocka_unit_test_setup_teardown(test_w_compress_log_missing, setup_compress, teardown_compress),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
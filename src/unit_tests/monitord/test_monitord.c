@@ -355,6 +355,8 @@ void test_getMonitorInternalOptions_success(void **state) {
     // Arbitrary configuration
     mond.day_wait = 2;
     mond.compress = 1;
+    mond.compress_level = 6;
+    mond.compress_threads = 4;
     mond.sign = 0;
     mond.monitor_agents = 1;
     mond.keep_log_days = 10;
@@ -370,6 +372,10 @@ void test_getMonitorInternalOptions_success(void **state) {
         assert_int_equal(object->valueint, mond.day_wait);
         object = cJSON_GetObjectItem(root->child, "compress");
         assert_int_equal(object->valueint, mond.compress);
+        object = cJSON_GetObjectItem(root->child, "compress_level");
+        assert_int_equal(object->valueint, mond.compress_level);
+        object = cJSON_GetObjectItem(root->child, "compress_threads");
+        assert_int_equal(object->valueint, mond.compress_threads);
         object = cJSON_GetObjectItem(root->child, "sign");
         assert_int_equal(object->valueint, mond.sign);
         object = cJSON_GetObjectItem(root->child, "monitor_agents");
@@ -485,6 +491,8 @@ void test_MonitordConfig_success(void **state) {
 
     assert_int_equal(mond.day_wait, 1);
     assert_int_equal(mond.compress, 1);
+    assert_int_equal(mond.compress_level, 1);
+    assert_int_equal(mond.compress_threads, 1);
     assert_int_equal(mond.sign, 1);
     assert_int_equal(mond.monitor_agents, 1);
     assert_int_equal(mond.rotate_log, 1);
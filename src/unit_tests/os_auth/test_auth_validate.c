@@ -48,8 +48,9 @@ void keys_init(keystore *keys, key_mode_t key_mode, int save_removed) {
     keys->keytree_id = rbtree_init();
     keys->keytree_ip = rbtree_init();
     keys->keytree_sock = rbtree_init();
+    keys->keytree_name = rbtree_init();
 
-    if (!(keys->keytree_id && keys->keytree_ip && keys->keytree_sock)) {
+    if (!(keys->keytree_id && keys->keytree_ip && keys->keytree_sock && keys->keytree_name)) {
         merror_exit(MEM_ERROR, errno, strerror(errno));
     }
 
@@ -36,9 +36,36 @@ void test_aes_string
     assert_int_equal(strncmp(buffer2, string, strlen(string)), 0);
 }
 
+void test_aes_string_key_change(void **state)
+{
+    const char *key1 = "0123456789abcdef0123456789abcdef";
+    const char *key2 = "fedcba9876543210fedcba9876543210";
+    const char *string = "test string";
+    char buffer1[64] = {0};
+    char buffer2[64] = {0};
+    char output[64];
+    int i;
+
+    // The context of the thread is reused, it has to follow the key of each call
+    for (i = 0; i < 2; i++) {
+        assert_int_equal(OS_AES_Str(string, buffer1, key1, strlen(string), OS_ENCRYPT), 16);
+        assert_int_equal(OS_AES_Str(string, buffer2, key2, strlen(string), OS_ENCRYPT), 16);
+        assert_memory_not_equal(buffer1, buffer2, 16);
+
+        memset(output, 0, sizeof(output));
+        assert_int_equal(OS_AES_Str(buffer1, output, key1, 16, OS_DECRYPT), 11);
+        assert_int_equal(strncmp(output, string, strlen(string)), 0);
+
+        memset(output, 0, sizeof(output));
+        assert_int_equal(OS_AES_Str(buffer2, output, key2, 16, OS_DECRYPT), 11);
+        assert_int_equal(strncmp(output, string, strlen(string)), 0);
+    }
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_aes_string),
+        cmocka_unit_test(test_aes_string_key_change),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
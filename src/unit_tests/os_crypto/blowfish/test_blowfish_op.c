@@ -32,9 +32,34 @@ void test_blowfish(void **state)
     assert_string_equal(buffer2, string);
 }
 
+void test_blowfish_key_change(void **state)
+{
+    const char *key1 = "test_key";
+    const char *key2 = "other_key";
+    const char *string = "test str";
+    char buffer1[8];
+    char buffer2[8];
+    char output[8];
+    int i;
+
+    // The key schedule of the thread is reused, it has to follow the key of each call
+    for (i = 0; i < 2; i++) {
+        assert_int_equal(OS_BF_Str(string, buffer1, key1, sizeof(buffer1), OS_ENCRYPT), 1);
+        assert_int_equal(OS_BF_Str(string, buffer2, key2, sizeof(buffer2), OS_ENCRYPT), 1);
+        assert_memory_not_equal(buffer1, buffer2, sizeof(buffer1));
+
+        assert_int_equal(OS_BF_Str(buffer1, output, key1, sizeof(output), OS_DECRYPT), 1);
+        assert_memory_equal(output, string, sizeof(output));
+
+        assert_int_equal(OS_BF_Str(buffer2, output, key2, sizeof(output), OS_DECRYPT), 1);
+        assert_memory_equal(output, string, sizeof(output));
+    }
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_blowfish),
+        cmocka_unit_test(test_blowfish_key_change),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -58,6 +58,26 @@ void test_md5_sha1_sha256_file(void **state)
     assert_string_equal(sha1buffer, string_sha1);
 }
 
+void test_md5_sha1_sha256_file_only_sha1(void **state)
+{
+    char *string = "teststring";
+    const char *string_sha1 = "b8473b86d4c2072ca9b08bd28e373e8253e865c4";
+
+    char file_name[256] = "/tmp/tmp_file-XXXXXX";
+
+    FILE * fp = 0x1;
+    expect_wfopen(file_name, "r", fp);
+    expect_fread(string, strlen(string));
+    expect_fread(string, 0);
+    expect_fclose(fp, 0);
+
+    os_sha1 sha1buffer;
+
+    assert_int_equal(OS_MD5_SHA1_SHA256_File(file_name, NULL, NULL, sha1buffer, NULL, OS_TEXT, 20), 0);
+
+    assert_string_equal(sha1buffer, string_sha1);
+}
+
 void test_md5_sha1_sha256_cmd_file(void **state)
 {
     char *string = "teststring";
@@ -165,6 +185,7 @@ void test_md5_sha1_sha256_file_max_size_fail(void **state)
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_md5_sha1_sha256_file),
+        cmocka_unit_test(test_md5_sha1_sha256_file_only_sha1),
         cmocka_unit_test(test_md5_sha1_sha256_cmd_file),
         cmocka_unit_test(test_md5_sha1_sha256_cmd_file_fail),
         cmocka_unit_test(test_md5_sha1_sha256_file_fail),
@@ -406,6 +406,110 @@ void test_OS_WriteTimestamps_move_error(void **state)
     assert_int_equal(r, -1);
 }
 
+// Test OS_IsAllowedName
+
+void test_OS_IsAllowedName_linear(void **state)
+{
+    keystore *keys = *(keystore **)state;
+
+    assert_int_equal(OS_IsAllowedName(keys, "agent2"), 1);
+    assert_int_equal(OS_IsAllowedName(keys, "agent3"), -1);
+}
+
+void test_OS_IsAllowedName_tree(void **state)
+{
+    keystore *keys = *(keystore **)state;
+    keys->keytree_name = (rb_tree *)1;
+
+    expect_value(__wrap_rbtree_get, tree, keys->keytree_name);
+    expect_string(__wrap_rbtree_get, key, "agent2");
+    will_return(__wrap_rbtree_get, keys->keyentries[1]);
+
+    assert_int_equal(OS_IsAllowedName(keys, "agent2"), 1);
+
+    expect_value(__wrap_rbtree_get, tree, keys->keytree_name);
+    expect_string(__wrap_rbtree_get, key, "agent3");
+    will_return(__wrap_rbtree_get, NULL);
+
+    assert_int_equal(OS_IsAllowedName(keys, "agent3"), -1);
+}
+
+// Test OS_AppendKeys
+
+void test_OS_AppendKeys_file_error(void **state)
+{
+    keystore *keys = *(keystore **)state;
+
+    expect_fopen(KEYS_FILE, "a", NULL);
+    expect_string(__wrap__merror, formatted_msg, "(1103): Could not open file '" KEYS_FILE "' due to [(13)-(Permission denied)].");
+    errno = EACCES;
+
+    int r = OS_AppendKeys(keys->keyentries, keys->keysize);
+    assert_int_equal(r, -1);
+}
+
+void test_OS_AppendKeys_file_write(void **state)
+{
+    keystore *keys = *(keystore **)state;
+    keys->keyentries[1]->raw_key = "key2";
+
+    expect_fopen(KEYS_FILE, "a", (FILE *)1);
+    expect_fprintf((FILE *)1, "002 agent2 2.2.2.2 key2\n", 0);
+    expect_fclose((FILE *)1, 0);
+
+    int r = OS_AppendKeys(keys->keyentries + 1, 1);
+    assert_int_equal(r, 0);
+}
+
+// Test OS_AppendTimestamps
+
+void test_OS_AppendTimestamps_file_error(void **state)
+{
+    keystore *keys = *(keystore **)state;
+
+    expect_fopen(TIMESTAMP_FILE, "a", NULL);
+    expect_string(__wrap__merror, formatted_msg, "(1103): Could not open file '" TIMESTAMP_FILE "' due to [(13)-(Permission denied)].");
+    errno = EACCES;
+
+    int r = OS_AppendTimestamps(keys->keyentries, keys->keysize);
+    assert_int_equal(r, -1);
+}
+
+void test_OS_AppendTimestamps_file_write(void **state)
+{
+    keystore *keys = *(keystore **)state;
+    char timestamp[40];
+    struct tm tm = { .tm_sec = 0 };
+
+    strftime(timestamp, 40, "002 agent2 2.2.2.2 %Y-%m-%d %H:%M:%S\n", localtime_r(&keys->keyentries[1]->time_added, &tm));
+
+    // The first key has no timestamp
+    expect_fopen(TIMESTAMP_FILE, "a", (FILE *)1);
+    expect_fprintf((FILE *)1, timestamp, 0);
+    expect_fclose((FILE *)1, 0);
+
+    int r = OS_AppendTimestamps(keys->keyentries, keys->keysize);
+    assert_int_equal(r, 0);
+}
+
+void test_OS_AppendTimestamps_close_error(void **state)
+{
+    keystore *keys = *(keystore **)state;
+    char timestamp[40];
+    struct tm tm = { .tm_sec = 0 };
+
+    strftime(timestamp, 40, "002 agent2 2.2.2.2 %Y-%m-%d %H:%M:%S\n", localtime_r(&keys->keyentries[1]->time_added, &tm));
+
+    expect_fopen(TIMESTAMP_FILE, "a", (FILE *)1);
+    expect_fprintf((FILE *)1, timestamp, 0);
+    expect_fclose((FILE *)1, -1);
+    expect_string(__wrap__merror, formatted_msg, "(1140): Could not close file '" TIMESTAMP_FILE "' due to [(28)-(No space left on device)].");
+    errno = ENOSPC;
+
+    int r = OS_AppendTimestamps(keys->keyentries, keys->keysize);
+    assert_int_equal(r, -1);
+}
+
 // Test w_get_key_hash
 
 void test_w_get_key_hash_empty_parameters(void **state){
@@ -473,6 +577,16 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_OS_WriteTimestamps_write_error, setup_config, teardown_config),
         cmocka_unit_test_setup_teardown(test_OS_WriteTimestamps_close_error, setup_config, teardown_config),
         cmocka_unit_test_setup_teardown(test_OS_WriteTimestamps_move_error, setup_config, teardown_config),
+        // Test OS_IsAllowedName
+        cmocka_unit_test_setup_teardown(test_OS_IsAllowedName_linear, setup_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_OS_IsAllowedName_tree, setup_config, teardown_config),
+        // Test OS_AppendKeys
+        cmocka_unit_test_setup_teardown(test_OS_AppendKeys_file_error, setup_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_OS_AppendKeys_file_write, setup_config, teardown_config),
+        // Test OS_AppendTimestamps
+        cmocka_unit_test_setup_teardown(test_OS_AppendTimestamps_file_error, setup_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_OS_AppendTimestamps_file_write, setup_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_OS_AppendTimestamps_close_error, setup_config, teardown_config),
         // Test w_get_key_hash
         cmocka_unit_test(test_w_get_key_hash_empty_parameters),
         cmocka_unit_test(test_w_get_key_hash_empty_value),
@@ -32,6 +32,7 @@
 
 extern int test_mode;
 extern OSList *timeout_list;
+extern OSHash *ar_key_fields;
 
 void ExecdStart(int q);
 
@@ -677,6 +678,106 @@ static void test_ExecdStart_timeout_repeated(void **state) {
     ExecdStart(queue);
 }
 
+static void test_ExecdStart_cached_keys(void **state) {
+    wfd_t * wfd = *state;
+    int queue = 1;
+    int now = 123456789;
+    char *message = "{"
+                        "\"version\":\"1\","
+                        "\"origin\":{"
+                            "\"name\":\"node01\","
+                            "\"module\":\"wazuh-analysisd\""
+                        "},"
+                        "\"command\":\"firewall-drop10\","
+                        "\"parameters\":{"
+                            "\"extra_args\":[],"
+                            "\"alert\":{"
+                                "\"rule\":{"
+                                    "\"level\":10,"
+                                    "\"id\":\"5712\""
+                                "},"
+                                "\"data\":{"
+                                    "\"srcip\":\"10.0.0.3\","
+                                    "\"srcuser\":\"root\""
+                                "},"
+                                "\"location\":\"/var/log/secure\""
+                            "}"
+                        "}"
+                    "}";
+    int timeout = 10;
+
+    // The first alert runs the script, that reports its keys
+    will_return(__wrap_time, now);
+    will_return(__wrap_select, 1);
+    expect_value(__wrap_OS_RecvUnix, socket, queue);
+    expect_value(__wrap_OS_RecvUnix, sizet, OS_MAXSTR);
+    will_return(__wrap_OS_RecvUnix, message);
+    will_return(__wrap_OS_RecvUnix, strlen(message));
+    expect_any(__wrap__mdebug2, formatted_msg);
+    will_return(__wrap_time, now);
+
+    expect_string(__wrap_GetCommandbyName, name, "firewall-drop10");
+    will_return(__wrap_GetCommandbyName, timeout);
+    will_return(__wrap_GetCommandbyName, "firewall-drop");
+
+    expect_any(__wrap__mdebug1, formatted_msg);
+    will_return(__wrap_wpopenv, wfd);
+
+    expect_value(__wrap_fprintf, __stream, wfd->file_in);
+    expect_any(__wrap_fprintf, formatted_msg);
+    will_return(__wrap_fprintf, 0);
+
+    expect_value(__wrap_fgets, __stream, wfd->file_out);
+    will_return(__wrap_fgets, "{"
+                                  "\"version\":1,"
+                                  "\"origin\":{"
+                                      "\"name\":\"firewall-drop\","
+                                      "\"module\":\"active-response\""
+                                  "},"
+                                  "\"command\":\"check_keys\","
+                                  "\"parameters\":{"
+                                      "\"keys\":[\"10.0.0.3\"]"
+                                  "}"
+                              "}\n");
+
+    expect_any(__wrap__mdebug1, formatted_msg);
+
+    expect_value(__wrap_fprintf, __stream, wfd->file_in);
+    expect_any(__wrap_fprintf, formatted_msg);
+    will_return(__wrap_fprintf, 0);
+
+    will_return(__wrap_wpclose, 0);
+
+    ExecdStart(queue);
+
+    assert_int_equal(timeout_list->currently_size, 1);
+
+    // The next alert of the same source is not sent to the script
+    will_return(__wrap_time, now + 5);
+    will_return(__wrap_select, 1);
+    expect_value(__wrap_OS_RecvUnix, socket, queue);
+    expect_value(__wrap_OS_RecvUnix, sizet, OS_MAXSTR);
+    will_return(__wrap_OS_RecvUnix, message);
+    will_return(__wrap_OS_RecvUnix, strlen(message));
+    expect_any(__wrap__mdebug2, formatted_msg);
+    will_return(__wrap_time, now + 5);
+
+    expect_string(__wrap_GetCommandbyName, name, "firewall-drop10");
+    will_return(__wrap_GetCommandbyName, timeout);
+    will_return(__wrap_GetCommandbyName, "firewall-drop");
+
+    expect_string(__wrap__mdebug1, formatted_msg, "Command already received, updating time of addition to now.");
+    expect_string(__wrap__mdebug1, formatted_msg, "Active response 'firewall-drop' already running for 'firewall-drop-10.0.0.3', the script won't be executed.");
+
+    ExecdStart(queue);
+
+    assert_int_equal(timeout_list->currently_size, 1);
+    assert_int_equal(((timeout_data *)timeout_list->first_node->data)->time_of_addition, now + 5);
+
+    OSHash_Free(ar_key_fields);
+    ar_key_fields = NULL;
+}
+
 static void test_ExecdStart_wpopenv_err(void **state) {
     wfd_t * wfd = *state;
     int queue = 1;
@@ -1133,6 +1234,7 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_ExecdStart_ok, test_setup_file, test_teardown_file),
         cmocka_unit_test_setup_teardown(test_ExecdStart_timeout_not_repeated, test_setup_file_timeout, test_teardown_file),
         cmocka_unit_test_setup_teardown(test_ExecdStart_timeout_repeated, test_setup_file_timeout, test_teardown_file),
+        cmocka_unit_test_setup_teardown(test_ExecdStart_cached_keys, test_setup_file, test_teardown_file),
         cmocka_unit_test_setup_teardown(test_ExecdStart_wpopenv_err, test_setup_file, test_teardown_file),
         cmocka_unit_test_setup_teardown(test_ExecdStart_fgets_err, test_setup_file, test_teardown_file),
         cmocka_unit_test_setup_teardown(test_ExecdStart_get_command_err, test_setup_file, test_teardown_file),
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+
+#include "../headers/shared.h"
+#include "../os_integrator/integrator.h"
+#include "../wrappers/common.h"
+#include "../wrappers/wazuh/shared/debug_op_wrappers.h"
+#include "../wrappers/libc/stdio_wrappers.h"
+
+static const char *alert_string = "{\"timestamp\":\"2022-09-09T23:43:15.168+0200\",\"rule\":{\"level\":9,\"description\":\"Integrity checksum changed.\",\"id\":\"550\",\"groups\":[\"ossec\",\"syscheck\"]},\"agent\":{\"id\":\"001\",\"name\":\"jellyfish\"},\"id\":\"1662759795.647670\",\"full_log\":\"File '/tmp/test.txt' modified\",\"location\":\"syscheck\"}";
+
+static int test_setup(void **state) {
+    test_mode = 1;
+    *state = cJSON_Parse(alert_string);
+    return *state ? OS_SUCCESS : OS_INVALID;
+}
+
+static int test_teardown(void **state) {
+    test_mode = 0;
+    cJSON_Delete(*state);
+    return OS_SUCCESS;
+}
+
+/* Native messages */
+
+void test_intg_slack_msg(void **state) {
+    IntegratorConfig config = { .name = "slack" };
+    char *msg = intg_slack_msg(*state, &config, NULL);
+
+    assert_string_equal(msg, "{\"attachments\":[{\"color\":\"danger\",\"pretext\":\"WAZUH Alert\",\"title\":\"Integrity checksum changed.\","
+                             "\"text\":\"File '/tmp/test.txt' modified\",\"fields\":[{\"title\":\"Agent\",\"value\":\"(001) - jellyfish\"},"
+                             "{\"title\":\"Location\",\"value\":\"syscheck\"},{\"title\":\"Rule ID\",\"value\":\"550 _(Level 9)_\"}],"
+                             "\"ts\":\"1662759795.647670\"}]}");
+    os_free(msg);
+}
+
+void test_intg_slack_msg_options(void **state) {
+    IntegratorConfig config = { .name = "slack" };
+    cJSON *options = cJSON_Parse("{\"pretext\":\"Custom\",\"footer\":\"Wazuh\"}");
+    cJSON *root;
+    cJSON *msg;
+    char *output = intg_slack_msg(*state, &config, options);
+
+    root = cJSON_Parse(output);
+    msg = cJSON_GetArrayItem(cJSON_GetObjectItem(root, "attachments"), 0);
+
+    assert_string_equal(cJSON_GetObjectItem(msg, "pretext")->valuestring, "Custom");
+    assert_string_equal(cJSON_GetObjectItem(msg, "footer")->valuestring, "Wazuh");
+    assert_string_equal(cJSON_GetObjectItem(msg, "color")->valuestring, "danger");
+
+    cJSON_Delete(root);
+    cJSON_Delete(options);
+    os_free(output);
+}
+
+void test_intg_shuffle_msg(void **state) {
+    IntegratorConfig config = { .name = "shuffle" };
+    char *output = intg_shuffle_msg(*state, &config, NULL);
+    cJSON *msg = cJSON_Parse(output);
+
+    assert_int_equal(cJSON_GetObjectItem(msg, "severity")->valueint, 3);
+    assert_string_equal(cJSON_GetObjectItem(msg, "rule_id")->valuestring, "550");
+    assert_string_equal(cJSON_GetObjectItem(msg, "id")->valuestring, "1662759795.647670");
+    assert_true(cJSON_Compare(cJSON_GetObjectItem(msg, "all_fields"), *state, true));
+
+    cJSON_Delete(msg);
+    os_free(output);
+}
+
+void test_intg_shuffle_msg_skipped_rule(void **state) {
+    IntegratorConfig config = { .name = "shuffle" };
+    cJSON *alert = cJSON_Parse("{\"rule\":{\"level\":5,\"id\":\"5710\"}}");
+
+    expect_string(__wrap__mdebug2, formatted_msg, "Skipping rule 5710");
+
+    assert_null(intg_shuffle_msg(alert, &config, NULL));
+    cJSON_Delete(alert);
+}
+
+void test_intg_pagerduty_msg(void **state) {
+    IntegratorConfig config = { .name = "pagerduty", .apikey = "123456" };
+    char *expected;
+    char *msg = intg_pagerduty_msg(*state, &config, NULL);
+
+    os_malloc(OS_MAXSTR, expected);
+    snprintf(expected, OS_MAXSTR, "{\"routing_key\":\"123456\",\"event_action\":\"trigger\",\"payload\":{\"summary\":\"Integrity checksum changed.\","
+             "\"timestamp\":\"2022-09-09T23:43:15.168+0200\",\"source\":\"jellyfish\",\"severity\":\"warning\",\"group\":\"ossec, syscheck\","
+             "\"custom_details\":%s},\"client\":\"Wazuh Monitoring Service\",\"client_url\":\"https://wazuh.com\"}", alert_string);
+
+    assert_string_equal(msg, expected);
+
+    os_free(expected);
+    os_free(msg);
+}
+
+void test_intg_msg_no_rule(void **state) {
+    IntegratorConfig config = { .name = "slack" };
+    cJSON *alert = cJSON_Parse("{\"location\":\"syscheck\"}");
+
+    assert_null(intg_slack_msg(alert, &config, NULL));
+    assert_null(intg_pagerduty_msg(alert, &config, NULL));
+    cJSON_Delete(alert);
+}
+
+/* Script workers */
+
+void test_intg_pool_start_disabled(void **state) {
+    IntegratorConfig config = { .name = "custom-test", .alert_format = "json" };
+
+    assert_null(intg_pool_start(&config));
+}
+
+void test_intg_pool_start_unsupported(void **state) {
+    IntegratorConfig config = { .name = "virustotal", .alert_format = "json", .workers = 2 };
+
+    expect_string(__wrap__mwarn, formatted_msg, "The integration 'virustotal' doesn't support workers. It will run once per alert.");
+
+    assert_null(intg_pool_start(&config));
+}
+
+void test_intg_pool_start_not_json(void **state) {
+    IntegratorConfig config = { .name = "custom-test", .workers = 2 };
+
+    expect_string(__wrap__mwarn, formatted_msg, "The workers of 'custom-test' need the JSON alert format. It will run once per alert.");
+
+    assert_null(intg_pool_start(&config));
+}
+
+void test_intg_pool_batches(void **state) {
+    IntegratorConfig config = { .name = "custom-test", .path = "integrations/custom-test", .alert_format = "json",
+                                .workers = 2, .batch_size = 2, .timeout = 10, .retries = 3 };
+    wfd_t workers[3] = { { .file_in = (FILE *)1 }, { .file_in = (FILE *)2 }, { .file_in = (FILE *)3 } };
+    char *line = cJSON_PrintUnformatted(*state);
+    char expected[OS_MAXSTR];
+    intg_pool_t *pool;
+    size_t length;
+
+    length = snprintf(expected, sizeof(expected), "%s\n%s\n", line, line);
+
+    will_return(__wrap_wpopenv, &workers[0]);
+    expect_string(__wrap__mdebug1, formatted_msg, "Worker of 'custom-test' started.");
+    will_return(__wrap_wpopenv, &workers[1]);
+    expect_string(__wrap__mdebug1, formatted_msg, "Worker of 'custom-test' started.");
+    expect_string(__wrap__minfo, formatted_msg, "Streaming the alerts of 'custom-test' to 2 workers.");
+
+    pool = intg_pool_start(&config);
+    assert_non_null(pool);
+
+    // Nothing is written until the batch is full
+    intg_pool_push(pool, *state);
+    assert_int_equal(pool->pending, 1);
+
+    will_return(__wrap_fwrite, length);
+    expect_string(__wrap__mdebug2, formatted_msg, "Sent 2 alerts to the worker 0 of 'custom-test'.");
+
+    intg_pool_push(pool, *state);
+    assert_int_equal(pool->pending, 0);
+    assert_memory_equal(pool->batch, expected, length);
+
+    // The second worker exited, it's started again
+    intg_pool_push(pool, *state);
+
+    will_return(__wrap_fwrite, 0);
+    will_return(__wrap_wpclose, 0);
+    expect_string(__wrap__mwarn, formatted_msg, "The worker of 'custom-test' exited with status 0.");
+    will_return(__wrap_wpopenv, &workers[2]);
+    expect_string(__wrap__mdebug1, formatted_msg, "Worker of 'custom-test' started.");
+    will_return(__wrap_fwrite, length);
+    expect_string(__wrap__mdebug2, formatted_msg, "Sent 2 alerts to the worker 1 of 'custom-test'.");
+
+    intg_pool_push(pool, *state);
+    assert_ptr_equal(pool->workers[1], &workers[2]);
+    assert_int_equal(pool->next, 0);
+
+    os_free(line);
+    os_free(pool->batch);
+    os_free(pool->workers);
+    os_free(pool);
+}
+
+void test_intg_pool_flush_partial(void **state) {
+    IntegratorConfig config = { .name = "custom-test", .path = "integrations/custom-test", .alert_format = "json",
+                                .workers = 1, .batch_size = 10 };
+    wfd_t worker = { .file_in = (FILE *)1 };
+    intg_pool_t *pool;
+
+    will_return(__wrap_wpopenv, &worker);
+    expect_string(__wrap__mdebug1, formatted_msg, "Worker of 'custom-test' started.");
+    expect_string(__wrap__minfo, formatted_msg, "Streaming the alerts of 'custom-test' to 1 workers.");
+
+    pool = intg_pool_start(&config);
+
+    intg_pool_push(pool, *state);
+
+    will_return(__wrap_fwrite, pool->batch_len);
+    expect_string(__wrap__mdebug2, formatted_msg, "Sent 1 alerts to the worker 0 of 'custom-test'.");
+
+    intg_pool_flush(pool);
+    assert_int_equal(pool->pending, 0);
+
+    // Nothing to flush
+    intg_pool_flush(pool);
+    intg_pool_flush(NULL);
+
+    os_free(pool->batch);
+    os_free(pool->workers);
+    os_free(pool);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        // Native messages
+        cmocka_unit_test_setup_teardown(test_intg_slack_msg, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_slack_msg_options, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_shuffle_msg, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_shuffle_msg_skipped_rule, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_pagerduty_msg, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_msg_no_rule, test_setup, test_teardown),
+        // Script workers
+        cmocka_unit_test_setup_teardown(test_intg_pool_start_disabled, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_pool_start_unsupported, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_pool_start_not_json, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_pool_batches, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_intg_pool_flush_partial, test_setup, test_teardown),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -128,6 +128,19 @@ void test_bind_TCP_port_ipv6(void **state) {
     assert_return_code(data->server_root_socket, 0);
 }
 
+void test_bind_TCP_port_reuseport(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    will_return(__wrap_socket, 3);
+    will_return(__wrap_bind, 1);
+    will_return(__wrap_setsockopt, 0);
+    will_return(__wrap_setsockopt, 0);
+    will_return(__wrap_listen, 0);
+
+    data->server_root_socket = OS_Bindporttcp_reuseport(PORT, IPV4, 0);
+    assert_return_code(data->server_root_socket, 0);
+}
+
 void test_connect_TCP_ipv4(void **state) {
     test_struct_t *data  = (test_struct_t *)*state;
 
@@ -316,6 +329,17 @@ void test_bind_UDP_port_ipv6(void **state) {
     assert_return_code(data->server_socket, 0);
 }
 
+void test_bind_UDP_port_reuseport(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    will_return(__wrap_socket, 3);
+    will_return(__wrap_setsockopt, 0);
+    will_return(__wrap_bind, 1);
+
+    data->server_socket = OS_Bindportudp_reuseport(PORT, IPV4, 0);
+    assert_return_code(data->server_socket, 0);
+}
+
 void test_connect_UDP_ipv4(void **state) {
     test_struct_t *data  = (test_struct_t *)*state;
 
@@ -948,6 +972,7 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_bind_TCP_port_ipv4, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_bind_TCP_port_null, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_bind_TCP_port_ipv6, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bind_TCP_port_reuseport, test_setup, test_teardown),
 
         /* Open a TCP socket */
         cmocka_unit_test_setup_teardown(test_connect_TCP_ipv4, test_setup, test_teardown),
@@ -983,6 +1008,7 @@ int main(void) {
         /* Bind a UDP port */
         cmocka_unit_test_setup_teardown(test_bind_UDP_port_ipv4, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_bind_UDP_port_ipv6, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bind_UDP_port_reuseport, test_setup, test_teardown),
 
         /* Open a UDP socket */
         cmocka_unit_test_setup_teardown(test_connect_UDP_ipv4, test_setup, test_teardown),
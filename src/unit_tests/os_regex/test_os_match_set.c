@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../../os_regex/os_regex.h"
+
+#define PATTERNS_SIZE 8
+
+typedef struct {
+    OSMatchSet *set;
+    OSMatch match[PATTERNS_SIZE];
+    int id[PATTERNS_SIZE];
+} test_match_set_t;
+
+static const char *patterns[PATTERNS_SIZE] = {
+    "abc",
+    "bc|xy",
+    "aab|b",
+    "^ab",
+    "cab$",
+    "!abc",
+    "ca|abca|bb",
+    "AB",
+};
+
+/* Setup/teardown */
+
+static int setup_match_set(void **state) {
+    test_match_set_t *data = calloc(1, sizeof(test_match_set_t));
+
+    if (!data || !(data->set = OSMatchSet_Create())) {
+        return -1;
+    }
+
+    for (int i = 0; i < PATTERNS_SIZE; i++) {
+        if (!OSMatch_Compile(patterns[i], &data->match[i], 0)) {
+            return -1;
+        }
+
+        data->id[i] = OSMatchSet_Add(data->set, &data->match[i]);
+    }
+
+    if (!OSMatchSet_Compile(data->set)) {
+        return -1;
+    }
+
+    *state = data;
+    return 0;
+}
+
+static int teardown_match_set(void **state) {
+    test_match_set_t *data = *state;
+
+    for (int i = 0; i < PATTERNS_SIZE; i++) {
+        OSMatch_FreePattern(&data->match[i]);
+    }
+
+    OSMatchSet_Free(data->set);
+    free(data);
+
+    return 0;
+}
+
+/* Tests */
+
+void test_OSMatchSet_Add_ids(void **state) {
+    test_match_set_t *data = *state;
+
+    assert_int_equal(data->id[0], 0);
+    assert_int_equal(data->id[1], 1);
+    assert_int_equal(data->id[2], 2);
+    // Anchored and negated patterns can't be added
+    assert_int_equal(data->id[3], -1);
+    assert_int_equal(data->id[4], -1);
+    assert_int_equal(data->id[5], -1);
+    assert_int_equal(data->id[6], 3);
+    assert_int_equal(data->id[7], 4);
+    assert_int_equal(OSMatchSet_Size(data->set), 5);
+}
+
+void test_OSMatchSet_Add_compiled(void **state) {
+    test_match_set_t *data = *state;
+
+    assert_int_equal(OSMatchSet_Add(data->set, &data->match[0]), -1);
+}
+
+void test_OSMatchSet_Add_empty_pattern(void **state) {
+    OSMatchSet *set = OSMatchSet_Create();
+    OSMatch match;
+
+    assert_int_equal(OSMatch_Compile("abc|", &match, 0), 1);
+    assert_int_equal(OSMatchSet_Add(set, &match), -1);
+    assert_int_equal(OSMatchSet_Size(set), 0);
+
+    OSMatch_FreePattern(&match);
+    OSMatchSet_Free(set);
+}
+
+void test_OSMatchSet_Execute_overlapping(void **state) {
+    test_match_set_t *data = *state;
+    unsigned char matches[1] = { 0xff };
+
+    OSMatchSet_Execute(data->set, "xxAABCAx", matches);
+
+    // Every pattern is found, even when they overlap
+    assert_int_equal(matches[0], 0x1f);
+}
+
+void test_OSMatchSet_Execute_no_match(void **state) {
+    test_match_set_t *data = *state;
+    unsigned char matches[1] = { 0xff };
+
+    OSMatchSet_Execute(data->set, "zzzz", matches);
+
+    assert_int_equal(matches[0], 0);
+}
+
+void test_OSMatchSet_Execute_same_as_OSMatch(void **state) {
+    test_match_set_t *data = *state;
+    const char *alphabet = "abcxyAB";
+    unsigned char matches[1];
+    char str[16];
+
+    srand(1);
+
+    for (int n = 0; n < 10000; n++) {
+        size_t len = rand() % (sizeof(str) - 1);
+
+        for (size_t i = 0; i < len; i++) {
+            str[i] = alphabet[rand() % strlen(alphabet)];
+        }
+        str[len] = '\0';
+
+        OSMatchSet_Execute(data->set, str, matches);
+
+        for (int i = 0; i < PATTERNS_SIZE; i++) {
+            if (data->id[i] >= 0) {
+                int expected = OSMatch_Execute(str, len, &data->match[i]);
+                assert_int_equal((matches[0] >> data->id[i]) & 1, expected);
+            }
+        }
+    }
+}
+
+void test_OSMatchSet_Execute_null_string(void **state) {
+    test_match_set_t *data = *state;
+    unsigned char matches[1] = { 0xff };
+
+    OSMatchSet_Execute(data->set, NULL, matches);
+
+    assert_int_equal(matches[0], 0);
+}
+
+void test_OSMatchSet_Execute_not_compiled(void **state) {
+    OSMatchSet *set = OSMatchSet_Create();
+    unsigned char matches[1] = { 0xff };
+    OSMatch match;
+
+    assert_int_equal(OSMatch_Compile("abc", &match, 0), 1);
+    assert_int_equal(OSMatchSet_Add(set, &match), 0);
+
+    OSMatchSet_Execute(set, "abc", matches);
+
+    assert_int_equal(matches[0], 0);
+
+    OSMatch_FreePattern(&match);
+    OSMatchSet_Free(set);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        // OSMatchSet_Add
+        cmocka_unit_test_setup_teardown(test_OSMatchSet_Add_ids, setup_match_set, teardown_match_set),
+        cmocka_unit_test_setup_teardown(test_OSMatchSet_Add_compiled, setup_match_set, teardown_match_set),
+        cmocka_unit_test(test_OSMatchSet_Add_empty_pattern),
+        // OSMatchSet_Execute
+        cmocka_unit_test_setup_teardown(test_OSMatchSet_Execute_overlapping, setup_match_set, teardown_match_set),
+        cmocka_unit_test_setup_teardown(test_OSMatchSet_Execute_no_match, setup_match_set, teardown_match_set),
+        cmocka_unit_test_setup_teardown(test_OSMatchSet_Execute_same_as_OSMatch, setup_match_set, teardown_match_set),
+        cmocka_unit_test_setup_teardown(test_OSMatchSet_Execute_null_string, setup_match_set, teardown_match_set),
+        cmocka_unit_test(test_OSMatchSet_Execute_not_compiled),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../os_regex/os_regex.h"
+#include "../../os_regex/os_regex_internal.h"
+
+#define FUZZ_PATTERNS   5000
+#define FUZZ_LOGS       20
+
+const char *_OS_Regex(const char *pattern, const char *str, const char **prts_closure,
+                      const char **prts_str, int flags);
+
+static const char *fuzz_tokens[] = {
+    "a", "b", "A", "1", " ", "-", ":", "(", ")", "\\d", "\\w", "\\s", "\\p", "\\S",
+    "\\D", "\\W", "\\.", "\\t", "\\(", "\\)", "\\\\", "+", "*", "|", "$", "^", "ab", "1a"
+};
+
+static const char fuzz_chars[] = "aAbB1 -:_()\t\\x9";
+
+/* Deterministic generator, so that a failure can be reproduced */
+static unsigned int fuzz_seed;
+
+static unsigned int fuzz_rand(unsigned int max) {
+    fuzz_seed = fuzz_seed * 1103515245 + 12345;
+    return (fuzz_seed >> 16) % max;
+}
+
+static void fuzz_pattern(char *pattern, size_t size) {
+    unsigned int tokens = 1 + fuzz_rand(8);
+
+    *pattern = '\0';
+
+    while (tokens-- > 0) {
+        const char *token = fuzz_tokens[fuzz_rand(sizeof(fuzz_tokens) / sizeof(fuzz_tokens[0]))];
+
+        if (strlen(pattern) + strlen(token) < size) {
+            strcat(pattern, token);
+        }
+    }
+}
+
+static void fuzz_log(char *log, size_t size) {
+    size_t length = fuzz_rand(size);
+    size_t i;
+
+    for (i = 0; i < length; i++) {
+        log[i] = fuzz_chars[fuzz_rand(sizeof(fuzz_chars) - 1)];
+    }
+    log[length] = '\0';
+}
+
+/* Result of the sub patterns run one by one, without the literal prefilter */
+static const char *reference_execute(const OSRegex *reg, const char *log) {
+    const char *ret;
+    int i;
+
+    for (i = 0; reg->patterns[i]; i++) {
+        if (ret = _OS_Regex(reg->patterns[i], log, NULL, NULL, reg->flags[i]), ret) {
+            return ret;
+        }
+    }
+
+    return NULL;
+}
+
+static void run_differential(int flags) {
+    char pattern[64];
+    char log[32];
+    int i;
+    int j;
+
+    for (i = 0; i < FUZZ_PATTERNS; i++) {
+        OSRegex reg;
+
+        fuzz_pattern(pattern, sizeof(pattern));
+
+        if (!OSRegex_Compile(pattern, &reg, flags)) {
+            continue;
+        }
+
+        for (j = 0; j < FUZZ_LOGS; j++) {
+            const char *expected;
+            const char *result;
+
+            fuzz_log(log, sizeof(log));
+            expected = reference_execute(&reg, log);
+            result = OSRegex_Execute(log, &reg);
+
+            if (result != expected) {
+                fail_msg("Pattern '%s' on '%s': expected %ld, got %ld", pattern, log,
+                         expected ? (long)(expected - log) : -1L, result ? (long)(result - log) : -1L);
+            }
+        }
+
+        OSRegex_FreePattern(&reg);
+    }
+}
+
+/* Tests */
+
+void test_literal_longest_run(void **state) {
+    OSRegex reg;
+
+    assert_int_equal(OSRegex_Compile("^ab\\d+Connection (\\S+) closed|\\w+$", &reg, OS_RETURN_SUBSTRING), 1);
+
+    assert_string_equal(reg.literals[0].str, "connection ");
+    assert_int_equal(reg.literals[0].size, 11);
+    assert_int_equal(reg.literals[0].first_size, 2);
+    assert_null(reg.literals[1].str);
+
+    OSRegex_FreePattern(&reg);
+}
+
+void test_literal_last_char_after_class(void **state) {
+    OSRegex reg;
+
+    // The matcher may accept a string without the last char
+    assert_int_equal(OSRegex_Compile("\\S+\\d\\dz", &reg, 0), 1);
+    assert_null(reg.literals[0].str);
+    assert_non_null(OSRegex_Execute("a1a", &reg));
+
+    OSRegex_FreePattern(&reg);
+}
+
+void test_literal_discard(void **state) {
+    OSRegex reg;
+
+    assert_int_equal(OSRegex_Compile("user (\\w+) logged|session opened", &reg, OS_RETURN_SUBSTRING), 1);
+
+    assert_null(OSRegex_Execute("Session closed for root", &reg));
+    assert_non_null(OSRegex_Execute("USER root logged in", &reg));
+    assert_string_equal(reg.d_sub_strings[0], "root");
+    assert_non_null(OSRegex_Execute("pam: session opened", &reg));
+
+    OSRegex_FreePattern(&reg);
+}
+
+void test_literal_case_sensitive(void **state) {
+    OSRegex reg;
+
+    // Strings are mapped through charmap, so capital letters never match
+    assert_int_equal(OSRegex_Compile("Root", &reg, OS_CASE_SENSITIVE), 1);
+    assert_int_equal(reg.literals[0].first_size, 0);
+    assert_null(OSRegex_Execute("Root", &reg));
+
+    OSRegex_FreePattern(&reg);
+}
+
+void test_literal_differential(void **state) {
+    fuzz_seed = 1;
+    run_differential(0);
+}
+
+void test_literal_differential_flags(void **state) {
+    fuzz_seed = 2;
+    run_differential(OS_CASE_SENSITIVE);
+    fuzz_seed = 3;
+    run_differential(OS_RETURN_SUBSTRING);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_literal_longest_run),
+        cmocka_unit_test(test_literal_last_char_after_class),
+        cmocka_unit_test(test_literal_discard),
+        cmocka_unit_test(test_literal_case_sensitive),
+        cmocka_unit_test(test_literal_differential),
+        cmocka_unit_test(test_literal_differential_flags),
+    };
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -2190,6 +2190,86 @@ void test_ftime_changed_both_null(void **state)
     assert_false(ftime_changed(hash1, hash2));
 }
 
+void test_merged_md5_no_cache(void **state)
+{
+    os_md5 md5sum = {0};
+
+    expect_string(__wrap_OS_MD5_File, fname, "etc/shared/test_default/merged.mg");
+    expect_value(__wrap_OS_MD5_File, mode, OS_TEXT);
+    will_return(__wrap_OS_MD5_File, "md5_test");
+    will_return(__wrap_OS_MD5_File, 0);
+
+    assert_int_equal(merged_md5("etc/shared/test_default/merged.mg", md5sum), 0);
+    assert_string_equal(md5sum, "md5_test");
+}
+
+void test_merged_md5_cached(void **state)
+{
+    os_md5 md5sum = {0};
+    struct stat attrib = { .st_mtime = 10, .st_ctime = 11, .st_size = 12, .st_ino = 13 };
+    merged_sum_t cached = { .m_time = 10, .c_time = 11, .size = 12, .inode = 13, .md5 = "md5_cached" };
+
+    merged_sums = (OSHash *)12;
+
+    expect_string(__wrap_stat, __file, "etc/shared/test_default/merged.mg");
+    will_return(__wrap_stat, &attrib);
+    will_return(__wrap_stat, 0);
+
+    expect_value(__wrap_OSHash_Get_ex, self, merged_sums);
+    expect_string(__wrap_OSHash_Get_ex, key, "etc/shared/test_default/merged.mg");
+    will_return(__wrap_OSHash_Get_ex, &cached);
+
+    assert_int_equal(merged_md5("etc/shared/test_default/merged.mg", md5sum), 0);
+    assert_string_equal(md5sum, "md5_cached");
+
+    merged_sums = NULL;
+}
+
+void test_merged_md5_changed(void **state)
+{
+    os_md5 md5sum = {0};
+    struct stat attrib = { .st_mtime = 20, .st_ctime = 21, .st_size = 12, .st_ino = 13 };
+    merged_sum_t cached = { .m_time = 10, .c_time = 11, .size = 12, .inode = 13, .md5 = "md5_cached" };
+
+    merged_sums = (OSHash *)12;
+
+    expect_string(__wrap_stat, __file, "etc/shared/test_default/merged.mg");
+    will_return(__wrap_stat, &attrib);
+    will_return(__wrap_stat, 0);
+
+    expect_value(__wrap_OSHash_Get_ex, self, merged_sums);
+    expect_string(__wrap_OSHash_Get_ex, key, "etc/shared/test_default/merged.mg");
+    will_return(__wrap_OSHash_Get_ex, &cached);
+
+    expect_string(__wrap_OS_MD5_File, fname, "etc/shared/test_default/merged.mg");
+    expect_value(__wrap_OS_MD5_File, mode, OS_TEXT);
+    will_return(__wrap_OS_MD5_File, "md5_test");
+    will_return(__wrap_OS_MD5_File, 0);
+
+    assert_int_equal(merged_md5("etc/shared/test_default/merged.mg", md5sum), 0);
+    assert_string_equal(md5sum, "md5_test");
+    assert_string_equal(cached.md5, "md5_test");
+    assert_int_equal(cached.m_time, 20);
+    assert_int_equal(cached.c_time, 21);
+
+    merged_sums = NULL;
+}
+
+void test_merged_md5_stat_error(void **state)
+{
+    os_md5 md5sum = {0};
+
+    merged_sums = (OSHash *)12;
+
+    expect_string(__wrap_stat, __file, "etc/shared/test_default/merged.mg");
+    will_return(__wrap_stat, NULL);
+    will_return(__wrap_stat, -1);
+
+    assert_int_equal(merged_md5("etc/shared/test_default/merged.mg", md5sum), -1);
+
+    merged_sums = NULL;
+}
+
 void test_group_changed_not_changed(void **state)
 {
     group_t *group1 = (group_t *)state[0];
@@ -4748,6 +4828,123 @@ void test_save_controlmsg_unable_to_save_last_keepalive(void **state)
     os_free(data.message);
 }
 
+void test_save_controlmsg_keepalive_batched(void **state)
+{
+    char r_msg[OS_SIZE_128] = {0};
+    strcpy(r_msg, "Invalid message \n with enter");
+
+    keyentry key;
+    keyentry_init(&key, "NEW_AGENT", "001", "10.2.2.5", NULL);
+
+    size_t msg_length = sizeof(r_msg);
+    int *wdb_sock = NULL;
+
+    keepalive_batch_interval = 1;
+
+    expect_string(__wrap_send_msg, agent_id, "001");
+    expect_string(__wrap_send_msg, msg, "#!-agent ack ");
+
+    expect_string(__wrap_rem_inc_send_ack, agent_id, "001");
+
+    expect_string(__wrap_rem_inc_recv_ctrl_keepalive, agent_id, "001");
+
+    expect_function_call(__wrap_OSHash_Create);
+    will_return(__wrap_OSHash_Create, 1);
+    pending_data = OSHash_Create();
+
+    pending_data_t data;
+    char * message = strdup("Invalid message \n");
+    data.changed = true;
+    data.message = message;
+
+    expect_value(__wrap_OSHash_Get, self, pending_data);
+    expect_string(__wrap_OSHash_Get, key, "001");
+    will_return(__wrap_OSHash_Get, &data);
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    // The keepalive waits for the next batch
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    save_controlmsg(&key, r_msg, msg_length, wdb_sock);
+
+    assert_int_equal(keepalive_batch_size, 1);
+    assert_int_equal(keepalive_batch[0], 1);
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_value(__wrap_wdb_update_agents_keepalive, count, 1);
+    expect_value(__wrap_wdb_update_agents_keepalive, ids, keepalive_batch);
+    expect_string(__wrap_wdb_update_agents_keepalive, connection_status, AGENT_CS_ACTIVE);
+    expect_string(__wrap_wdb_update_agents_keepalive, sync_status, "synced");
+    will_return(__wrap_wdb_update_agents_keepalive, OS_SUCCESS);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    keepalive_batch_flush(wdb_sock);
+
+    assert_int_equal(keepalive_batch_size, 0);
+
+    keepalive_batch_interval = 0;
+    free_keyentry(&key);
+    os_free(data.message);
+}
+
+void test_keepalive_batch_discard(void **state)
+{
+    expect_function_call_any(__wrap_pthread_mutex_lock);
+    expect_function_call_any(__wrap_pthread_mutex_unlock);
+
+    keepalive_batch_push(1);
+    keepalive_batch_push(2);
+    keepalive_batch_push(1);
+    keepalive_batch_discard(1);
+
+    assert_int_equal(keepalive_batch_size, 1);
+    assert_int_equal(keepalive_batch[0], 2);
+
+    // Nothing else is sent once discarded
+    keepalive_batch_discard(2);
+    keepalive_batch_flush(NULL);
+
+    assert_int_equal(keepalive_batch_size, 0);
+}
+
+void test_keepalive_batch_push_repeated(void **state)
+{
+    expect_function_call_any(__wrap_pthread_mutex_lock);
+    expect_function_call_any(__wrap_pthread_mutex_unlock);
+
+    // An agent is saved once per batch, whatever its keepalives
+    keepalive_batch_push(3);
+    keepalive_batch_push(5000);
+    keepalive_batch_push(3);
+    keepalive_batch_push(5000);
+
+    assert_int_equal(keepalive_batch_size, 2);
+    assert_int_equal(keepalive_batch[0], 3);
+    assert_int_equal(keepalive_batch[1], 5000);
+
+    expect_value(__wrap_wdb_update_agents_keepalive, count, 2);
+    expect_value(__wrap_wdb_update_agents_keepalive, ids, keepalive_batch);
+    expect_string(__wrap_wdb_update_agents_keepalive, connection_status, AGENT_CS_ACTIVE);
+    expect_string(__wrap_wdb_update_agents_keepalive, sync_status, "synced");
+    will_return(__wrap_wdb_update_agents_keepalive, OS_SUCCESS);
+
+    keepalive_batch_flush(NULL);
+
+    // The next batch takes it again
+    keepalive_batch_push(3);
+
+    assert_int_equal(keepalive_batch_size, 1);
+    assert_int_equal(keepalive_batch[0], 3);
+
+    keepalive_batch_discard(3);
+    keepalive_batch_discard(-1);
+
+    assert_int_equal(keepalive_batch_size, 0);
+}
+
 void test_save_controlmsg_update_msg_error_parsing(void **state)
 {
     char r_msg[OS_SIZE_128] = {0};
@@ -4904,6 +5101,11 @@ void test_save_controlmsg_update_msg_unable_to_update_information(void **state)
     will_return(__wrap_parse_agent_update_msg, agent_data);
     will_return(__wrap_parse_agent_update_msg, OS_SUCCESS);
 
+    expect_string(__wrap_compare_wazuh_versions, version1, "version 4.3");
+    expect_string(__wrap_compare_wazuh_versions, version2, "v4.9.0");
+    expect_value(__wrap_compare_wazuh_versions, compare_patch, true);
+    will_return(__wrap_compare_wazuh_versions, -1);
+
     expect_function_call(__wrap_pthread_mutex_lock);
     expect_function_call(__wrap_pthread_mutex_unlock);
 
@@ -4919,6 +5121,9 @@ void test_save_controlmsg_update_msg_unable_to_update_information(void **state)
 
     save_controlmsg(&key, r_msg, msg_length, wdb_sock);
 
+    // Deltas aren't sent to agents older than SHARED_DELTA_VERSION
+    assert_string_equal(data->agent_sum, "");
+
     os_free(group->name);
     os_free(group);
 
@@ -4988,6 +5193,11 @@ void test_save_controlmsg_update_msg_lookfor_agent_group_fail(void **state)
     will_return(__wrap_parse_agent_update_msg, agent_data);
     will_return(__wrap_parse_agent_update_msg, OS_SUCCESS);
 
+    expect_string(__wrap_compare_wazuh_versions, version1, "version 4.3");
+    expect_string(__wrap_compare_wazuh_versions, version2, "v4.9.0");
+    expect_value(__wrap_compare_wazuh_versions, compare_patch, true);
+    will_return(__wrap_compare_wazuh_versions, -1);
+
     expect_function_call(__wrap_pthread_mutex_lock);
     expect_function_call(__wrap_pthread_mutex_unlock);
 
@@ -5226,6 +5436,11 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_ftime_changed_different_size, test_ftime_changed_setup, test_ftime_changed_teardown),
         cmocka_unit_test_setup_teardown(test_ftime_changed_one_null, test_ftime_changed_setup, test_ftime_changed_teardown),
         cmocka_unit_test(test_ftime_changed_both_null),
+        // Tests merged_md5
+        cmocka_unit_test(test_merged_md5_no_cache),
+        cmocka_unit_test(test_merged_md5_cached),
+        cmocka_unit_test(test_merged_md5_changed),
+        cmocka_unit_test(test_merged_md5_stat_error),
         // Test group_changed
         cmocka_unit_test_setup_teardown(test_group_changed_not_changed, test_find_group_setup, test_c_group_teardown),
         cmocka_unit_test_setup_teardown(test_group_changed_has_changed, test_find_group_setup, test_c_group_teardown),
@@ -5304,6 +5519,9 @@ int main(void)
         cmocka_unit_test(test_save_controlmsg_get_agent_version_fail),
         cmocka_unit_test(test_save_controlmsg_could_not_add_pending_data),
         cmocka_unit_test(test_save_controlmsg_unable_to_save_last_keepalive),
+        cmocka_unit_test(test_save_controlmsg_keepalive_batched),
+        cmocka_unit_test(test_keepalive_batch_discard),
+        cmocka_unit_test(test_keepalive_batch_push_repeated),
         cmocka_unit_test(test_save_controlmsg_update_msg_error_parsing),
         cmocka_unit_test(test_save_controlmsg_update_msg_unable_to_update_information),
         cmocka_unit_test(test_save_controlmsg_update_msg_lookfor_agent_group_fail),
@@ -25,7 +25,7 @@
 #include "../wrappers/wazuh/shared/debug_op_wrappers.h"
 #include "../wrappers/wazuh/shared/notify_op_wrappers.h"
 
-extern wnotify_t * notify;
+static wnotify_t * notify;
 extern unsigned int send_chunk;
 
 int sock = 15;
@@ -52,6 +52,7 @@ static int test_setup(void ** state) {
     *state = netbuffer;
 
     os_calloc(1, sizeof(wnotify_t), notify);
+    netbuffer->notify = notify;
 
     send_chunk = 14;
 
@@ -91,11 +92,11 @@ void test_nb_queue_ok(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_push, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_memory(__wrap_bqueue_push, data, final_msg, final_size);
-    expect_value(__wrap_bqueue_push, length, final_size);
-    expect_value(__wrap_bqueue_push, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_push, 0);
+    expect_memory(__wrap_bqueue_pushv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_memory(__wrap_bqueue_pushv, data, final_msg, final_size);
+    expect_value(__wrap_bqueue_pushv, length, final_size);
+    expect_value(__wrap_bqueue_pushv, flags, BQUEUE_NOFLAG);
+    will_return(__wrap_bqueue_pushv, 0);
 
     expect_memory(__wrap_bqueue_used, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
     will_return(__wrap_bqueue_used, final_size);
@@ -128,11 +129,11 @@ void test_nb_queue_retry_ok(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_push, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_memory(__wrap_bqueue_push, data, final_msg, final_size);
-    expect_value(__wrap_bqueue_push, length, final_size);
-    expect_value(__wrap_bqueue_push, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_push, -1);
+    expect_memory(__wrap_bqueue_pushv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_memory(__wrap_bqueue_pushv, data, final_msg, final_size);
+    expect_value(__wrap_bqueue_pushv, length, final_size);
+    expect_value(__wrap_bqueue_pushv, flags, BQUEUE_NOFLAG);
+    will_return(__wrap_bqueue_pushv, -1);
 
     expect_string(__wrap__mdebug1, formatted_msg, "Not enough buffer space. Retrying... [buffer_size=100, used=0, msg_size=9]");
 
@@ -142,11 +143,11 @@ void test_nb_queue_retry_ok(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_push, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_memory(__wrap_bqueue_push, data, final_msg, final_size);
-    expect_value(__wrap_bqueue_push, length, final_size);
-    expect_value(__wrap_bqueue_push, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_push, 0);
+    expect_memory(__wrap_bqueue_pushv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_memory(__wrap_bqueue_pushv, data, final_msg, final_size);
+    expect_value(__wrap_bqueue_pushv, length, final_size);
+    expect_value(__wrap_bqueue_pushv, flags, BQUEUE_NOFLAG);
+    will_return(__wrap_bqueue_pushv, 0);
 
     expect_memory(__wrap_bqueue_used, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
     will_return(__wrap_bqueue_used, final_size);
@@ -179,11 +180,11 @@ void test_nb_queue_retry_err(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_push, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_memory(__wrap_bqueue_push, data, final_msg, final_size);
-    expect_value(__wrap_bqueue_push, length, final_size);
-    expect_value(__wrap_bqueue_push, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_push, -1);
+    expect_memory(__wrap_bqueue_pushv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_memory(__wrap_bqueue_pushv, data, final_msg, final_size);
+    expect_value(__wrap_bqueue_pushv, length, final_size);
+    expect_value(__wrap_bqueue_pushv, flags, BQUEUE_NOFLAG);
+    will_return(__wrap_bqueue_pushv, -1);
 
     expect_string(__wrap__mdebug1, formatted_msg, "Not enough buffer space. Retrying... [buffer_size=100, used=0, msg_size=9]");
 
@@ -193,11 +194,11 @@ void test_nb_queue_retry_err(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_push, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_memory(__wrap_bqueue_push, data, final_msg, final_size);
-    expect_value(__wrap_bqueue_push, length, final_size);
-    expect_value(__wrap_bqueue_push, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_push, -1);
+    expect_memory(__wrap_bqueue_pushv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_memory(__wrap_bqueue_pushv, data, final_msg, final_size);
+    expect_value(__wrap_bqueue_pushv, length, final_size);
+    expect_value(__wrap_bqueue_pushv, flags, BQUEUE_NOFLAG);
+    will_return(__wrap_bqueue_pushv, -1);
 
     expect_string(__wrap_rem_inc_send_discarded, agent_id, agent_id);
 
@@ -218,13 +219,14 @@ void test_nb_send_ok(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_peek, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_value(__wrap_bqueue_peek, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_peek, 1);
-    will_return(__wrap_bqueue_peek, final_msg);
-    will_return(__wrap_bqueue_peek, final_size);
+    expect_memory(__wrap_bqueue_peekv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_value(__wrap_bqueue_peekv, length, send_chunk);
+    will_return(__wrap_bqueue_peekv, final_msg);
+    will_return(__wrap_bqueue_peekv, final_size);
 
-    will_return(__wrap_send, final_size);
+    expect_value(__wrap_sendmsg, __message->msg_iovlen, 1);
+    expect_value(__wrap_sendmsg, __message->msg_iov[0].iov_base, final_msg);
+    will_return(__wrap_sendmsg, final_size);
 
     expect_memory(__wrap_bqueue_drop, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
     expect_value(__wrap_bqueue_drop, length, final_size);
@@ -251,10 +253,10 @@ void test_nb_send_zero_ok(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_peek, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_value(__wrap_bqueue_peek, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_peek, 0);
-    will_return(__wrap_bqueue_peek, 0);
+    expect_memory(__wrap_bqueue_peekv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_value(__wrap_bqueue_peekv, length, send_chunk);
+    will_return(__wrap_bqueue_peekv, NULL);
+    will_return(__wrap_bqueue_peekv, 0);
 
     expect_memory(__wrap_wnotify_modify, notify, notify, sizeof(wnotify_t *));
     expect_value(__wrap_wnotify_modify, fd, sock);
@@ -278,13 +280,14 @@ void test_nb_send_would_block_ok(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_peek, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_value(__wrap_bqueue_peek, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_peek, 1);
-    will_return(__wrap_bqueue_peek, final_msg);
-    will_return(__wrap_bqueue_peek, final_size);
+    expect_memory(__wrap_bqueue_peekv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_value(__wrap_bqueue_peekv, length, send_chunk);
+    will_return(__wrap_bqueue_peekv, final_msg);
+    will_return(__wrap_bqueue_peekv, final_size);
 
-    will_return(__wrap_send, -1);
+    expect_value(__wrap_sendmsg, __message->msg_iovlen, 1);
+    expect_value(__wrap_sendmsg, __message->msg_iov[0].iov_base, final_msg);
+    will_return(__wrap_sendmsg, -1);
 
     expect_memory(__wrap_bqueue_used, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
     will_return(__wrap_bqueue_used, final_size);
@@ -306,13 +309,14 @@ void test_nb_send_err(void ** state) {
 
     expect_function_call(__wrap_pthread_mutex_lock);
 
-    expect_memory(__wrap_bqueue_peek, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
-    expect_value(__wrap_bqueue_peek, flags, BQUEUE_NOFLAG);
-    will_return(__wrap_bqueue_peek, 1);
-    will_return(__wrap_bqueue_peek, final_msg);
-    will_return(__wrap_bqueue_peek, final_size);
+    expect_memory(__wrap_bqueue_peekv, queue, (bqueue_t *)netbuffer->buffers[sock].bqueue, sizeof(bqueue_t *));
+    expect_value(__wrap_bqueue_peekv, length, send_chunk);
+    will_return(__wrap_bqueue_peekv, final_msg);
+    will_return(__wrap_bqueue_peekv, final_size);
 
-    will_return(__wrap_send, -1);
+    expect_value(__wrap_sendmsg, __message->msg_iovlen, 1);
+    expect_value(__wrap_sendmsg, __message->msg_iov[0].iov_base, final_msg);
+    will_return(__wrap_sendmsg, -1);
 
     expect_string(__wrap__merror, formatted_msg, "Could not send data to socket 15: Connection reset by peer (104)");
 
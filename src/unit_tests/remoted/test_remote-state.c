@@ -34,8 +34,14 @@ typedef struct test_struct {
 extern remoted_state_t remoted_state;
 extern OSHash *remoted_agents_state;
 
+extern rem_latency_t rem_latency[REM_STAGE_COUNT];
+extern rem_thread_stats_t rem_reactor_stats[REM_MAX_THREAD_POOL];
+extern rem_thread_stats_t rem_worker_stats[REM_MAX_THREAD_POOL];
+
 remoted_agent_state_t * get_node(const char *agent_id);
 void w_remoted_clean_agents_state(int *sock);
+unsigned rem_latency_bucket(uint64_t usec);
+uint64_t rem_latency_bucket_max(unsigned bucket);
 
 /* setup/teardown */
 
@@ -65,6 +71,13 @@ static int test_setup(void ** state) {
     return 0;
 }
 
+static int test_setup_perf_stats(void ** state) {
+    memset(rem_latency, 0, sizeof(rem_latency));
+    memset(rem_reactor_stats, 0, sizeof(rem_reactor_stats));
+    memset(rem_worker_stats, 0, sizeof(rem_worker_stats));
+    return 0;
+}
+
 static int test_setup_agent(void ** state) {
     test_struct_t *test_data = NULL;
     os_calloc(1, sizeof(test_struct_t),test_data);
@@ -235,6 +248,86 @@ void test_rem_create_state_json(void ** state) {
     cJSON_Delete(state_json);
 }
 
+void test_rem_create_state_json_perf_stats(void ** state) {
+    rem_latency_add(REM_STAGE_FORWARD, 20000);
+    rem_latency_add(REM_STAGE_FORWARD, 40000);
+    rem_add_reactor_recv(1, 300);
+    rem_add_reactor_recv(1, 200);
+    rem_add_worker_msg(0, 7000);
+    reactor_pool = 2;
+    rem_set_worker_pool(1);
+
+    will_return(__wrap_time, 123456789);
+    will_return(__wrap_rem_get_qsize, 0);
+    will_return(__wrap_rem_get_tsize, 100000);
+
+    cJSON* state_json = rem_create_state_json();
+    cJSON* metrics = cJSON_GetObjectItem(state_json, "metrics");
+
+    cJSON* latency = cJSON_GetObjectItem(metrics, "latency");
+    assert_non_null(latency);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetObjectItem(latency, "read"), "count")->valueint, 0);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetObjectItem(latency, "read"), "p99")->valueint, 0);
+
+    cJSON* forward = cJSON_GetObjectItem(latency, "forward");
+    assert_non_null(forward);
+    assert_int_equal(cJSON_GetObjectItem(forward, "count")->valueint, 2);
+    assert_int_equal(cJSON_GetObjectItem(forward, "mean")->valueint, 30);
+    assert_int_equal(cJSON_GetObjectItem(forward, "p50")->valueint, 23);
+    assert_int_equal(cJSON_GetObjectItem(forward, "p99")->valueint, 40);
+    assert_int_equal(cJSON_GetObjectItem(forward, "max")->valueint, 40);
+
+    cJSON* reactors_json = cJSON_GetObjectItem(metrics, "reactors");
+    assert_int_equal(cJSON_GetArraySize(reactors_json), 2);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetArrayItem(reactors_json, 1), "id")->valueint, 1);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetArrayItem(reactors_json, 1), "reads")->valueint, 2);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetArrayItem(reactors_json, 1), "bytes")->valueint, 500);
+
+    cJSON* workers = cJSON_GetObjectItem(metrics, "workers");
+    assert_int_equal(cJSON_GetArraySize(workers), 1);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetArrayItem(workers, 0), "messages")->valueint, 1);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetArrayItem(workers, 0), "busy_time")->valueint, 7);
+
+    reactor_pool = 1;
+    rem_set_worker_pool(0);
+    cJSON_Delete(state_json);
+}
+
+void test_rem_latency_bucket(void ** state) {
+    assert_int_equal(rem_latency_bucket(0), 0);
+    assert_int_equal(rem_latency_bucket(3), 3);
+    assert_int_equal(rem_latency_bucket(4), 4);
+    assert_int_equal(rem_latency_bucket(8), 8);
+    assert_int_equal(rem_latency_bucket(9), 8);
+    assert_int_equal(rem_latency_bucket(10), 9);
+    assert_int_equal(rem_latency_bucket(UINT64_MAX), REM_LATENCY_BUCKETS - 1);
+    assert_int_equal(rem_latency_bucket_max(REM_LATENCY_BUCKETS - 1), UINT32_MAX);
+
+    // Buckets are contiguous
+    for (unsigned i = 0; i < REM_LATENCY_BUCKETS - 1; i++) {
+        assert_int_equal(rem_latency_bucket(rem_latency_bucket_max(i)), i);
+        assert_int_equal(rem_latency_bucket(rem_latency_bucket_max(i) + 1), i + 1);
+    }
+}
+
+void test_rem_latency_percentile(void ** state) {
+    for (int i = 0; i < 98; i++) {
+        rem_latency_add(REM_STAGE_DECRYPT, 10000);
+    }
+
+    rem_latency_add(REM_STAGE_DECRYPT, 1000000);
+    rem_latency_add(REM_STAGE_DECRYPT, 1000000);
+
+    assert_int_equal(rem_latency[REM_STAGE_DECRYPT].count, 100);
+    assert_int_equal(rem_latency[REM_STAGE_DECRYPT].sum, 2980);
+    assert_int_equal(rem_latency[REM_STAGE_DECRYPT].max, 1000);
+
+    // Upper bound of the bucket, limited by the maximum
+    assert_int_equal(rem_latency_percentile(&rem_latency[REM_STAGE_DECRYPT], 50), 11);
+    assert_int_equal(rem_latency_percentile(&rem_latency[REM_STAGE_DECRYPT], 99), 1000);
+    assert_int_equal(rem_latency_percentile(&rem_latency[REM_STAGE_QUEUE], 99), 0);
+}
+
 void test_rem_create_agents_state_json(void ** state) {
     test_struct_t *test_data  = (test_struct_t *)*state;
     int *agents_ids = NULL;
@@ -417,6 +510,10 @@ int main(void) {
     const struct CMUnitTest tests[] = {
         // Test rem_create_state_json
         cmocka_unit_test_setup(test_rem_create_state_json, test_setup),
+        cmocka_unit_test_setup(test_rem_create_state_json_perf_stats, test_setup_perf_stats),
+        // Test latency histograms
+        cmocka_unit_test(test_rem_latency_bucket),
+        cmocka_unit_test_setup(test_rem_latency_percentile, test_setup_perf_stats),
         // Test rem_create_agents_state_json
         cmocka_unit_test_setup_teardown(test_rem_create_agents_state_json, test_setup_agent, test_teardown_agent),
         // Test get_node
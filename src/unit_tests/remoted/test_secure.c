@@ -37,7 +37,8 @@
 
 extern keystore keys;
 extern remoted logr;
-extern wnotify_t * notify;
+extern rem_reactor_t ** sock_reactors;
+extern size_t sock_reactors_size;
 extern char *str_family_address[FAMILY_ADDRESS_SIZE];
 
 void tmp_HandleSecureMessage_invalid_family_address(sa_family_t sin_family);
@@ -46,8 +47,21 @@ void tmp_HandleSecureMessage_invalid_family_address(sa_family_t sin_family);
 void * close_fp_main(void * args);
 void HandleSecureMessage(const message_t *message, int *wdb_sock);
 
+static rem_reactor_t test_reactor;
+
 /* Setup/teardown */
 
+static int group_setup(void **state) {
+    reactors = &test_reactor;
+    reactor_pool = 1;
+    return 0;
+}
+
+static int group_teardown(void **state) {
+    reactors = NULL;
+    return 0;
+}
+
 static int setup_config(void **state) {
     w_linked_queue_t *queue = linked_queue_init();
     keys.opened_fp_queue = queue;
@@ -63,14 +77,14 @@ static int teardown_config(void **state) {
 
 static int setup_new_tcp(void **state) {
     test_mode = 1;
-    os_calloc(1, sizeof(wnotify_t), notify);
-    notify->fd = 0;
+    os_calloc(1, sizeof(wnotify_t), test_reactor.notify);
+    test_reactor.notify->fd = 0;
     return 0;
 }
 
 static int teardown_new_tcp(void **state) {
     test_mode = 0;
-    os_free(notify);
+    os_free(test_reactor.notify);
     return 0;
 }
 
@@ -953,6 +967,149 @@ void test_HandleSecureMessage_close_idle_sock(void **state)
     os_free(keyentries);
 }
 
+void test_HandleSecureMessage_batch(void **state)
+{
+    char buffer[OS_MAXSTR + 1] = "#!-batch 3:1:a4:1:bc8:#!-ctrl 3:1:d";
+    message_t message = { .buffer = buffer, .size = 35, .sock = 1};
+    struct sockaddr_in peer_info;
+    int wdb_sock;
+
+    keyentry** keyentries;
+    os_calloc(2, sizeof(keyentry*), keyentries);
+    keys.keyentries = keyentries;
+
+    keyentry *key = NULL;
+    os_calloc(1, sizeof(keyentry), key);
+
+    os_calloc(1, sizeof(os_ip), key->ip);
+
+    key->id = strdup("001");
+    key->sock = 1;
+    key->keyid = 1;
+    key->ip->ip = "127.0.0.1";
+
+    keys.keyentries[1] = key;
+
+    peer_info.sin_family = AF_INET;
+    peer_info.sin_addr.s_addr = inet_addr("127.0.0.1");
+    memcpy(&message.addr, &peer_info, sizeof(peer_info));
+
+    expect_function_call(__wrap_key_lock_read);
+
+    // OS_IsAllowedDynamicID
+    expect_string(__wrap_OS_IsAllowedIP, srcip, "127.0.0.1");
+    will_return(__wrap_OS_IsAllowedIP, 1);
+
+    // ReadSecMSG
+    expect_value(__wrap_ReadSecMSG, keys, &keys);
+    expect_string(__wrap_ReadSecMSG, buffer, buffer);
+    expect_value(__wrap_ReadSecMSG, id, 1);
+    expect_string(__wrap_ReadSecMSG, srcip, "127.0.0.1");
+    will_return(__wrap_ReadSecMSG, message.size);
+    will_return(__wrap_ReadSecMSG, buffer);
+    will_return(__wrap_ReadSecMSG, KS_VALID);
+
+    expect_function_call(__wrap_key_unlock);
+
+    // Each event is queued into the batch
+    expect_string(__wrap_mq_batch_push, message, "1:a");
+    expect_string(__wrap_mq_batch_push, locmsg, "[001] ((null)) 127.0.0.1");
+    expect_value(__wrap_mq_batch_push, loc, SECURE_MQ);
+    will_return(__wrap_mq_batch_push, 0);
+
+    expect_function_call(__wrap_rem_inc_recv_evt);
+
+    expect_string(__wrap_mq_batch_push, message, "1:bc");
+    expect_string(__wrap_mq_batch_push, locmsg, "[001] ((null)) 127.0.0.1");
+    expect_value(__wrap_mq_batch_push, loc, SECURE_MQ);
+    will_return(__wrap_mq_batch_push, 0);
+
+    expect_function_call(__wrap_rem_inc_recv_evt);
+
+    expect_string(__wrap__mdebug1, formatted_msg, "Discarding control message in a batch from agent '001'.");
+
+    expect_string(__wrap_mq_batch_push, message, "1:d");
+    expect_string(__wrap_mq_batch_push, locmsg, "[001] ((null)) 127.0.0.1");
+    expect_value(__wrap_mq_batch_push, loc, SECURE_MQ);
+    will_return(__wrap_mq_batch_push, 0);
+
+    expect_function_call(__wrap_rem_inc_recv_evt);
+
+    // The events are sent at once
+    will_return(__wrap_mq_batch_flush, 0);
+
+    HandleSecureMessage(&message, &wdb_sock);
+
+    os_free(key->id);
+    os_free(key->ip);
+    os_free(key);
+    os_free(keyentries);
+}
+
+void test_HandleSecureMessage_batch_invalid(void **state)
+{
+    char buffer[OS_MAXSTR + 1] = "#!-batch 3:1:a9:1:b";
+    message_t message = { .buffer = buffer, .size = 19, .sock = 1};
+    struct sockaddr_in peer_info;
+    int wdb_sock;
+
+    keyentry** keyentries;
+    os_calloc(2, sizeof(keyentry*), keyentries);
+    keys.keyentries = keyentries;
+
+    keyentry *key = NULL;
+    os_calloc(1, sizeof(keyentry), key);
+
+    os_calloc(1, sizeof(os_ip), key->ip);
+
+    key->id = strdup("001");
+    key->sock = 1;
+    key->keyid = 1;
+    key->ip->ip = "127.0.0.1";
+
+    keys.keyentries[1] = key;
+
+    peer_info.sin_family = AF_INET;
+    peer_info.sin_addr.s_addr = inet_addr("127.0.0.1");
+    memcpy(&message.addr, &peer_info, sizeof(peer_info));
+
+    expect_function_call(__wrap_key_lock_read);
+
+    // OS_IsAllowedDynamicID
+    expect_string(__wrap_OS_IsAllowedIP, srcip, "127.0.0.1");
+    will_return(__wrap_OS_IsAllowedIP, 1);
+
+    // ReadSecMSG
+    expect_value(__wrap_ReadSecMSG, keys, &keys);
+    expect_string(__wrap_ReadSecMSG, buffer, buffer);
+    expect_value(__wrap_ReadSecMSG, id, 1);
+    expect_string(__wrap_ReadSecMSG, srcip, "127.0.0.1");
+    will_return(__wrap_ReadSecMSG, message.size);
+    will_return(__wrap_ReadSecMSG, buffer);
+    will_return(__wrap_ReadSecMSG, KS_VALID);
+
+    expect_function_call(__wrap_key_unlock);
+
+    expect_string(__wrap_mq_batch_push, message, "1:a");
+    expect_string(__wrap_mq_batch_push, locmsg, "[001] ((null)) 127.0.0.1");
+    expect_value(__wrap_mq_batch_push, loc, SECURE_MQ);
+    will_return(__wrap_mq_batch_push, 0);
+
+    expect_function_call(__wrap_rem_inc_recv_evt);
+
+    expect_string(__wrap__mwarn, formatted_msg, "Invalid batch message from agent '001'.");
+
+    // The events before the invalid one are still sent
+    will_return(__wrap_mq_batch_flush, 0);
+
+    HandleSecureMessage(&message, &wdb_sock);
+
+    os_free(key->id);
+    os_free(key->ip);
+    os_free(key);
+    os_free(keyentries);
+}
+
 void test_HandleSecureMessage_close_idle_sock_2(void **state)
 {
     char buffer[OS_MAXSTR + 1] = "!12!AAA";
@@ -1662,12 +1819,54 @@ void test_handle_new_tcp_connection_success(void **state)
     expect_string(__wrap__mdebug1, formatted_msg, "New TCP connection [12]");
 
     // wnotify_add
-    expect_value(__wrap_wnotify_add, notify, notify);
+    expect_value(__wrap_wnotify_add, notify, test_reactor.notify);
+    expect_value(__wrap_wnotify_add, fd, sock_client);
+    expect_value(__wrap_wnotify_add, op, WO_READ);
+    will_return(__wrap_wnotify_add, 0);
+
+    handle_new_tcp_connection(&test_reactor, (struct sockaddr_storage *)&peer_info);
+}
+
+void test_handle_new_tcp_connection_reactor(void **state)
+{
+    struct sockaddr_in peer_info;
+    rem_reactor_t reactor = { .id = 1, .notify = test_reactor.notify };
+    int sock_client = 12;
+
+    sock_reactors_size = 16;
+    os_calloc(sock_reactors_size, sizeof(rem_reactor_t *), sock_reactors);
+
+    peer_info.sin_family = AF_INET;
+    peer_info.sin_addr.s_addr = 0x0A00A8C0;
+
+    will_return(__wrap_accept, AF_INET);
+    will_return(__wrap_accept, sock_client);
+
+    // nb_open
+    expect_value(__wrap_nb_open, sock, sock_client);
+    expect_value(__wrap_nb_open, peer_info, (struct sockaddr_storage *)&peer_info);
+    expect_value(__wrap_nb_open, sock, sock_client);
+    expect_value(__wrap_nb_open, peer_info, (struct sockaddr_storage *)&peer_info);
+
+    expect_function_call(__wrap_rem_inc_tcp);
+
+    expect_string(__wrap__mdebug1, formatted_msg, "New TCP connection [12]");
+
+    // wnotify_add
+    expect_value(__wrap_wnotify_add, notify, test_reactor.notify);
     expect_value(__wrap_wnotify_add, fd, sock_client);
     expect_value(__wrap_wnotify_add, op, WO_READ);
     will_return(__wrap_wnotify_add, 0);
 
-    handle_new_tcp_connection(notify, (struct sockaddr_storage *)&peer_info);
+    handle_new_tcp_connection(&reactor, (struct sockaddr_storage *)&peer_info);
+
+    // The socket is handled by the reactor that accepted it
+    assert_ptr_equal(rem_get_reactor(sock_client), &reactor);
+    assert_ptr_equal(rem_get_reactor(3), &test_reactor);
+    assert_ptr_equal(rem_get_reactor(20), &test_reactor);
+
+    os_free(sock_reactors);
+    sock_reactors_size = 0;
 }
 
 void test_handle_new_tcp_connection_wnotify_fail(void **state)
@@ -1692,7 +1891,7 @@ void test_handle_new_tcp_connection_wnotify_fail(void **state)
     expect_string(__wrap__mdebug1, formatted_msg, "New TCP connection [12]");
 
     // wnotify_add
-    expect_value(__wrap_wnotify_add, notify, notify);
+    expect_value(__wrap_wnotify_add, notify, test_reactor.notify);
     expect_value(__wrap_wnotify_add, fd, sock_client);
     expect_value(__wrap_wnotify_add, op, WO_READ);
     will_return(__wrap_wnotify_add, -1);
@@ -1720,7 +1919,7 @@ void test_handle_new_tcp_connection_wnotify_fail(void **state)
 
     expect_string(__wrap__mdebug1, formatted_msg, "TCP peer disconnected [12]");
 
-    handle_new_tcp_connection(notify, (struct sockaddr_storage *)&peer_info);
+    handle_new_tcp_connection(&test_reactor, (struct sockaddr_storage *)&peer_info);
 }
 
 void test_handle_new_tcp_connection_socket_fail(void **state)
@@ -1736,7 +1935,7 @@ void test_handle_new_tcp_connection_socket_fail(void **state)
     errno = -1;
     expect_string(__wrap__merror, formatted_msg, "(1242): Couldn't accept TCP connections: Unknown error -1 (-1)");
 
-    handle_new_tcp_connection(notify, (struct sockaddr_storage *)&peer_info);
+    handle_new_tcp_connection(&test_reactor, (struct sockaddr_storage *)&peer_info);
 }
 
 void test_handle_new_tcp_connection_socket_fail_err(void **state)
@@ -1752,26 +1951,26 @@ void test_handle_new_tcp_connection_socket_fail_err(void **state)
     errno = ECONNABORTED;
     expect_string(__wrap__mdebug1, formatted_msg, "(1242): Couldn't accept TCP connections: Software caused connection abort (103)");
 
-    handle_new_tcp_connection(notify, (struct sockaddr_storage *)&peer_info);
+    handle_new_tcp_connection(&test_reactor, (struct sockaddr_storage *)&peer_info);
 }
 
 void test_handle_incoming_data_from_udp_socket_0(void **state)
 {
     struct sockaddr_in peer_info;
-    logr.udp_sock = 1;
+    test_reactor.udp_sock = 1;
 
     peer_info.sin_family = AF_INET;
     peer_info.sin_addr.s_addr = 0x0A00A8C0;
 
     will_return(__wrap_recvfrom, 0);
 
-    handle_incoming_data_from_udp_socket((struct sockaddr_storage *)&peer_info);
+    handle_incoming_data_from_udp_socket(&test_reactor, (struct sockaddr_storage *)&peer_info);
 }
 
 void test_handle_incoming_data_from_udp_socket_success(void **state)
 {
     struct sockaddr_in peer_info;
-    logr.udp_sock = 1;
+    test_reactor.udp_sock = 1;
 
     peer_info.sin_family = AF_INET;
     peer_info.sin_addr.s_addr = 0x0A00A8C0;
@@ -1785,7 +1984,73 @@ void test_handle_incoming_data_from_udp_socket_success(void **state)
 
     expect_value(__wrap_rem_add_recv, bytes, 10);
 
-    handle_incoming_data_from_udp_socket((struct sockaddr_storage *)&peer_info);
+    handle_incoming_data_from_udp_socket(&test_reactor, (struct sockaddr_storage *)&peer_info);
+}
+
+void test_handle_incoming_data_from_udp_batch(void **state)
+{
+    rem_reactor_t reactor = { .udp_sock = 1 };
+    message_t * slots[3];
+    unsigned int i;
+
+    udp_batch = 3;
+    os_calloc(udp_batch, sizeof(message_t *), reactor.udp_messages);
+    os_calloc(udp_batch, sizeof(struct mmsghdr), reactor.udp_msgs);
+    os_calloc(udp_batch, sizeof(struct iovec), reactor.udp_iov);
+
+    for (i = 0; i < udp_batch; i++) {
+        rem_udp_slot_init(&reactor, i);
+        slots[i] = reactor.udp_messages[i];
+    }
+
+    will_return(__wrap_recvmmsg, 3);
+    will_return(__wrap_recvmmsg, 10);
+    will_return(__wrap_recvmmsg, 0);
+    will_return(__wrap_recvmmsg, 20);
+
+    expect_value(__wrap_rem_add_recv, bytes, 10);
+    expect_value(__wrap_rem_add_recv, bytes, 20);
+
+    expect_value(__wrap_rem_msgpush_batch, count, 2);
+    expect_value(__wrap_rem_msgpush_batch, size, 10);
+    expect_value(__wrap_rem_msgpush_batch, size, 20);
+
+    handle_incoming_data_from_udp_batch(&reactor);
+
+    // The queued messages are replaced, the empty datagram keeps its slot
+    assert_ptr_not_equal(reactor.udp_messages[0], slots[0]);
+    assert_ptr_equal(reactor.udp_messages[1], slots[1]);
+    assert_ptr_not_equal(reactor.udp_messages[2], slots[2]);
+    assert_ptr_equal(reactor.udp_iov[0].iov_base, reactor.udp_messages[0]->buffer);
+    assert_ptr_equal(reactor.udp_msgs[2].msg_hdr.msg_name, &reactor.udp_messages[2]->addr);
+
+    for (i = 0; i < udp_batch; i++) {
+        rem_msgfree(reactor.udp_messages[i]);
+    }
+
+    os_free(reactor.udp_messages);
+    os_free(reactor.udp_msgs);
+    os_free(reactor.udp_iov);
+}
+
+void test_handle_incoming_data_from_udp_batch_error(void **state)
+{
+    rem_reactor_t reactor = { .udp_sock = 1 };
+
+    udp_batch = 2;
+    os_calloc(udp_batch, sizeof(message_t *), reactor.udp_messages);
+    os_calloc(udp_batch, sizeof(struct mmsghdr), reactor.udp_msgs);
+    os_calloc(udp_batch, sizeof(struct iovec), reactor.udp_iov);
+
+    will_return(__wrap_recvmmsg, -1);
+
+    handle_incoming_data_from_udp_batch(&reactor);
+
+    assert_int_equal(reactor.udp_msgs[0].msg_hdr.msg_namelen, sizeof(struct sockaddr_storage));
+
+    os_free(reactor.udp_messages);
+    os_free(reactor.udp_msgs);
+    os_free(reactor.udp_iov);
 }
 
 void test_handle_incoming_data_from_tcp_socket_too_big_message(void **state)
@@ -1818,7 +2083,7 @@ void test_handle_incoming_data_from_tcp_socket_too_big_message(void **state)
 
     expect_string(__wrap__mdebug1, formatted_msg, "TCP peer disconnected [8]");
 
-    handle_incoming_data_from_tcp_socket(sock_client);
+    handle_incoming_data_from_tcp_socket(&test_reactor, sock_client);
 }
 
 void test_handle_incoming_data_from_tcp_socket_case_0(void **state)
@@ -1851,7 +2116,7 @@ void test_handle_incoming_data_from_tcp_socket_case_0(void **state)
 
     expect_string(__wrap__mdebug1, formatted_msg, "TCP peer disconnected [7]");
 
-    handle_incoming_data_from_tcp_socket(sock_client);
+    handle_incoming_data_from_tcp_socket(&test_reactor, sock_client);
 }
 
 void test_handle_incoming_data_from_tcp_socket_case_1(void **state)
@@ -1888,7 +2153,7 @@ void test_handle_incoming_data_from_tcp_socket_case_1(void **state)
 
     expect_string(__wrap__mdebug1, formatted_msg, "TCP peer disconnected [7]");
 
-    handle_incoming_data_from_tcp_socket(sock_client);
+    handle_incoming_data_from_tcp_socket(&test_reactor, sock_client);
 }
 
 void test_handle_incoming_data_from_tcp_socket_success(void **state)
@@ -1900,7 +2165,7 @@ void test_handle_incoming_data_from_tcp_socket_success(void **state)
 
     expect_value(__wrap_rem_add_recv, bytes, 100);
 
-    handle_incoming_data_from_tcp_socket(sock_client);
+    handle_incoming_data_from_tcp_socket(&test_reactor, sock_client);
 }
 
 void test_handle_outgoing_data_to_tcp_socket_case_1_EAGAIN(void **state)
@@ -1914,7 +2179,7 @@ void test_handle_outgoing_data_to_tcp_socket_case_1_EAGAIN(void **state)
 
     expect_string(__wrap__mdebug1, formatted_msg, "TCP peer [10]: Resource temporarily unavailable (11)");
 
-    handle_outgoing_data_to_tcp_socket(sock_client);
+    handle_outgoing_data_to_tcp_socket(&test_reactor, sock_client);
 }
 
 void test_handle_outgoing_data_to_tcp_socket_case_1_EPIPE(void **state)
@@ -1951,7 +2216,7 @@ void test_handle_outgoing_data_to_tcp_socket_case_1_EPIPE(void **state)
 
     expect_string(__wrap__mdebug1, formatted_msg, "TCP peer disconnected [10]");
 
-    handle_outgoing_data_to_tcp_socket(sock_client);
+    handle_outgoing_data_to_tcp_socket(&test_reactor, sock_client);
 }
 
 void test_handle_outgoing_data_to_tcp_socket_success(void **state)
@@ -1963,7 +2228,7 @@ void test_handle_outgoing_data_to_tcp_socket_success(void **state)
 
     expect_value(__wrap_rem_add_send, bytes, 100);
 
-    handle_outgoing_data_to_tcp_socket(sock_client);
+    handle_outgoing_data_to_tcp_socket(&test_reactor, sock_client);
 }
 
 int main(void)
@@ -1990,6 +2255,8 @@ int main(void)
         cmocka_unit_test(test_HandleSecureMessage_different_sock_2),
         cmocka_unit_test(test_HandleSecureMessage_close_idle_sock),
         cmocka_unit_test(test_HandleSecureMessage_close_idle_sock_2),
+        cmocka_unit_test(test_HandleSecureMessage_batch),
+        cmocka_unit_test(test_HandleSecureMessage_batch_invalid),
         cmocka_unit_test(test_HandleSecureMessage_close_idle_sock_disabled),
         cmocka_unit_test(test_HandleSecureMessage_close_idle_sock_disabled_2),
         cmocka_unit_test(test_HandleSecureMessage_close_idle_sock_recv_fail),
@@ -1999,12 +2266,16 @@ int main(void)
         cmocka_unit_test(test_HandleSecureMessage_close_same_sock_2),
         // Tests handle_new_tcp_connection
         cmocka_unit_test_setup_teardown(test_handle_new_tcp_connection_success, setup_new_tcp, teardown_new_tcp),
+        cmocka_unit_test_setup_teardown(test_handle_new_tcp_connection_reactor, setup_new_tcp, teardown_new_tcp),
         cmocka_unit_test_setup_teardown(test_handle_new_tcp_connection_wnotify_fail, setup_new_tcp, teardown_new_tcp),
         cmocka_unit_test_setup_teardown(test_handle_new_tcp_connection_socket_fail, setup_new_tcp, teardown_new_tcp),
         cmocka_unit_test_setup_teardown(test_handle_new_tcp_connection_socket_fail_err, setup_new_tcp, teardown_new_tcp),
         // Tests handle_incoming_data_from_udp_socket
         cmocka_unit_test(test_handle_incoming_data_from_udp_socket_0),
         cmocka_unit_test(test_handle_incoming_data_from_udp_socket_success),
+        // Tests handle_incoming_data_from_udp_batch
+        cmocka_unit_test(test_handle_incoming_data_from_udp_batch),
+        cmocka_unit_test(test_handle_incoming_data_from_udp_batch_error),
         // Tests handle_incoming_data_from_tcp_socket
         cmocka_unit_test(test_handle_incoming_data_from_tcp_socket_too_big_message),
         cmocka_unit_test(test_handle_incoming_data_from_tcp_socket_case_0),
@@ -2016,5 +2287,5 @@ int main(void)
         cmocka_unit_test(test_handle_outgoing_data_to_tcp_socket_success),
 
         };
-    return cmocka_run_group_tests(tests, NULL, NULL);
+    return cmocka_run_group_tests(tests, group_setup, group_teardown);
 }
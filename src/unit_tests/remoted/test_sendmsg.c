@@ -30,13 +30,17 @@ extern remoted_state_t remoted_state;
 
 /* setup/teardown */
 
+static rem_reactor_t test_reactor;
+
 static int group_setup(void ** state) {
     test_mode = 1;
+    reactors = &test_reactor;
     return 0;
 }
 
 static int group_teardown(void ** state) {
     test_mode = 0;
+    reactors = NULL;
     return 0;
 }
 
@@ -52,6 +52,14 @@ static int test_setup_1024(void **state) {
     return 0;
 }
 
+static int test_setup_fixed_20(void **state) {
+    test_mode = 1;
+
+    bqueue_t *bqueue = bqueue_init(20, BQUEUE_FIXED | BQUEUE_SHRINK);
+    *state = bqueue;
+    return 0;
+}
+
 static int test_teardown(void **state) {
     test_mode = 0;
 
@@ -365,6 +373,171 @@ static void test_bqueue_push_drop_to_expand(void **state) {
     assert_string_equal("2345678", buffer);
 }
 
+static void test_bqueue_pushv_fail_non_space(void **state) {
+    bqueue_t *queue = *state;
+    struct iovec iov[2] = { { .iov_base = "A", .iov_len = 1 }, { .iov_base = "BC", .iov_len = 2 } };
+
+    // No buffer is inserted if all of them don't fit
+    assert_non_null(queue);
+    assert_int_equal(bqueue_pushv(queue, iov, 2, BQUEUE_NOFLAG), -1);
+    assert_int_equal(bqueue_used(queue), 0);
+}
+
+static void test_bqueue_pushv_peekv_ok(void **state) {
+    bqueue_t *queue = *state;
+    struct iovec iov[2] = { { .iov_base = "1234", .iov_len = 4 }, { .iov_base = "567", .iov_len = 3 } };
+
+    assert_non_null(queue);
+    assert_int_equal(bqueue_pushv(queue, iov, 2, BQUEUE_NOFLAG), 0);
+    assert_int_equal(bqueue_used(queue), 7);
+
+    memset(iov, 0, sizeof(iov));
+    assert_int_equal(bqueue_peekv(queue, iov, 5), 5);
+    assert_int_equal(iov[0].iov_len, 5);
+    assert_memory_equal(iov[0].iov_base, "12345", 5);
+    assert_int_equal(iov[1].iov_len, 0);
+
+    // Nothing is removed
+    assert_int_equal(bqueue_used(queue), 7);
+}
+
+static void test_bqueue_pushv_peekv_rollover(void **state) {
+    /*
+       Buffer: |bcde......90a|
+                    T     H
+    */
+    bqueue_t *queue = *state;
+    struct iovec iov[2] = { { .iov_base = "ab", .iov_len = 2 }, { .iov_base = "cde", .iov_len = 3 } };
+
+    assert_non_null(queue);
+    assert_int_equal(bqueue_push(queue, "1234567890", 10, BQUEUE_NOFLAG), 0);
+    assert_int_equal(bqueue_drop(queue, 8), 0);
+    assert_int_equal(bqueue_pushv(queue, iov, 2, BQUEUE_NOFLAG), 0);
+
+    memset(iov, 0, sizeof(iov));
+    assert_int_equal(bqueue_peekv(queue, iov, 20), 7);
+    assert_int_equal(iov[0].iov_len, 3);
+    assert_memory_equal(iov[0].iov_base, "90a", 3);
+    assert_int_equal(iov[1].iov_len, 4);
+    assert_memory_equal(iov[1].iov_base, "bcde", 4);
+}
+
+static void test_bqueue_peekv_empty(void **state) {
+    bqueue_t *queue = *state;
+    struct iovec iov[2];
+
+    assert_non_null(queue);
+    assert_int_equal(bqueue_peekv(queue, iov, 10), 0);
+    assert_int_equal(iov[0].iov_len, 0);
+    assert_int_equal(iov[1].iov_len, 0);
+}
+
+static void test_bqueue_reserve_commit_ok(void **state) {
+    bqueue_t *queue = *state;
+    struct iovec iov[2];
+    char buffer[10] = {0};
+
+    assert_non_null(queue);
+    assert_int_equal(bqueue_reserve(queue, iov, 5, BQUEUE_NOFLAG), 0);
+    assert_int_equal(iov[0].iov_len, 5);
+    assert_int_equal(iov[1].iov_len, 0);
+
+    // Write less bytes than reserved
+    memcpy(iov[0].iov_base, "123", 3);
+    bqueue_commit(queue, 3);
+
+    assert_int_equal(bqueue_used(queue), 3);
+    assert_int_equal(bqueue_pop(queue, buffer, sizeof(buffer), BQUEUE_NOFLAG), 3);
+    assert_string_equal(buffer, "123");
+}
+
+static void test_bqueue_reserve_fail_non_space(void **state) {
+    bqueue_t *queue = *state;
+    struct iovec iov[2];
+
+    assert_non_null(queue);
+    assert_int_equal(bqueue_push(queue, "1234567890", 10, BQUEUE_NOFLAG), 0);
+    assert_int_equal(bqueue_reserve(queue, iov, 10, BQUEUE_NOFLAG), -1);
+
+    // The queue is unlocked on failure
+    assert_int_equal(bqueue_used(queue), 10);
+}
+
+static void test_bqueue_reserve_commit_cancel(void **state) {
+    bqueue_t *queue = *state;
+    struct iovec iov[2];
+
+    assert_non_null(queue);
+    assert_int_equal(bqueue_reserve(queue, iov, 5, BQUEUE_NOFLAG), 0);
+    bqueue_commit(queue, 0);
+
+    assert_int_equal(bqueue_used(queue), 0);
+}
+
+static void test_bqueue_reserve_rollover(void **state) {
+    /*
+       Buffer: |bcde......90a|
+                    T     H
+    */
+    bqueue_t *queue = *state;
+    struct iovec iov[2];
+
+    assert_non_null(queue);
+    assert_int_equal(bqueue_push(queue, "1234567890", 10, BQUEUE_NOFLAG), 0);
+    assert_int_equal(bqueue_drop(queue, 8), 0);
+
+    assert_int_equal(bqueue_reserve(queue, iov, 5, BQUEUE_NOFLAG), 0);
+    assert_int_equal(iov[0].iov_len, 1);
+    assert_int_equal(iov[1].iov_len, 4);
+    memcpy(iov[0].iov_base, "a", 1);
+    memcpy(iov[1].iov_base, "bcde", 4);
+    bqueue_commit(queue, 5);
+
+    memset(iov, 0, sizeof(iov));
+    assert_int_equal(bqueue_peekv(queue, iov, 20), 7);
+    assert_int_equal(iov[0].iov_len, 3);
+    assert_memory_equal(iov[0].iov_base, "90a", 3);
+    assert_int_equal(iov[1].iov_len, 4);
+    assert_memory_equal(iov[1].iov_base, "bcde", 4);
+}
+
+static void test_bqueue_fixed_init(void **state) {
+    bqueue_t *queue = *state;
+
+    // The memory is allocated up front and the shrink option is ignored
+    assert_non_null(queue);
+    assert_non_null(queue->memory);
+    assert_int_equal(queue->length, 20);
+    assert_false(queue->flags & BQUEUE_SHRINK);
+}
+
+static void test_bqueue_fixed_keep_memory(void **state) {
+    bqueue_t *queue = *state;
+    struct iovec iov[2];
+    char buffer[20];
+
+    assert_non_null(queue);
+    void * memory = queue->memory;
+
+    // Fill the queue up to its capacity
+    assert_int_equal(bqueue_push(queue, "1234567890123456789", 19, BQUEUE_NOFLAG), 0);
+    assert_int_equal(bqueue_push(queue, "0", 1, BQUEUE_NOFLAG), -1);
+    assert_int_equal(bqueue_pop(queue, buffer, 15, BQUEUE_NOFLAG), 15);
+    assert_int_equal(bqueue_drop(queue, 4), 0);
+
+    // An empty queue keeps its memory and rewinds, so the next reservation is contiguous
+    assert_ptr_equal(queue->memory, memory);
+    assert_int_equal(bqueue_reserve(queue, iov, 19, BQUEUE_NOFLAG), 0);
+    assert_ptr_equal(iov[0].iov_base, memory);
+    assert_int_equal(iov[0].iov_len, 19);
+    assert_int_equal(iov[1].iov_len, 0);
+    bqueue_commit(queue, 0);
+
+    bqueue_clear(queue);
+    assert_ptr_equal(queue->memory, memory);
+    assert_int_equal(queue->length, 20);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test(test_bqueue_init_fail),
@@ -385,6 +558,16 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_bqueue_push_pop_rollover, test_setup_1024, test_teardown),
         cmocka_unit_test_setup_teardown(test_bqueue_push_drop_cross_pointers, test_setup_20, test_teardown),
         cmocka_unit_test_setup_teardown(test_bqueue_push_drop_to_expand, test_setup_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_pushv_fail_non_space, test_setup_3, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_pushv_peekv_ok, test_setup_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_pushv_peekv_rollover, test_setup_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_peekv_empty, test_setup_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_reserve_commit_ok, test_setup_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_reserve_fail_non_space, test_setup_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_reserve_commit_cancel, test_setup_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_reserve_rollover, test_setup_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_fixed_init, test_setup_fixed_20, test_teardown),
+        cmocka_unit_test_setup_teardown(test_bqueue_fixed_keep_memory, test_setup_fixed_20, test_teardown),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../headers/shared.h"
+
+static const char * base =
+    "#default\n"
+    "!102 ar.conf\n"
+    "restart-ossec0 - restart-ossec.sh - 0\n"
+    "restart-ossec0 - restart-ossec.cmd - 0\n"
+    "!28 agent.conf\n"
+    "<agent_config>\n"
+    "</agent_config>\n";
+
+/* Round trip of a delta, returning its size */
+static size_t round_trip(const char * old_text, const char * new_text) {
+    size_t delta_size;
+    size_t result_size;
+    char * delta = w_delta_create(old_text, strlen(old_text), new_text, strlen(new_text), &delta_size);
+    char * result = w_delta_apply(old_text, strlen(old_text), delta, delta_size, &result_size);
+
+    assert_non_null(result);
+    assert_int_equal(result_size, strlen(new_text));
+    assert_memory_equal(result, new_text, result_size);
+
+    os_free(delta);
+    os_free(result);
+    return delta_size;
+}
+
+static void test_w_delta_unchanged(void **state) {
+    size_t delta_size;
+    char * delta = w_delta_create(base, strlen(base), base, strlen(base), &delta_size);
+
+    assert_string_equal(delta, W_DELTA_MAGIC "c 0 7\n");
+    os_free(delta);
+}
+
+static void test_w_delta_edit(void **state) {
+    const char * target =
+        "#default\n"
+        "!102 ar.conf\n"
+        "restart-ossec0 - restart-ossec.sh - 0\n"
+        "restart-ossec0 - restart-ossec.cmd - 0\n"
+        "!48 agent.conf\n"
+        "<agent_config>\n"
+        "  <labels/>\n"
+        "</agent_config>\n";
+    size_t delta_size;
+    char * delta = w_delta_create(base, strlen(base), target, strlen(target), &delta_size);
+
+    // A single short line is cheaper as a literal than as a copy
+    assert_string_equal(delta, W_DELTA_MAGIC "c 0 4\na 3\n!48 agent.conf\n<agent_config>\n  <labels/>\nc 6 1\n");
+    os_free(delta);
+
+    round_trip(base, target);
+}
+
+static void test_w_delta_moved_block(void **state) {
+    const char * target =
+        "!28 agent.conf\n"
+        "<agent_config>\n"
+        "</agent_config>\n"
+        "#default\n"
+        "!102 ar.conf\n"
+        "restart-ossec0 - restart-ossec.sh - 0\n"
+        "restart-ossec0 - restart-ossec.cmd - 0\n";
+
+    assert_true(round_trip(base, target) < 32);
+}
+
+static void test_w_delta_no_final_newline(void **state) {
+    round_trip(base, "#default\nlast line");
+    round_trip("#default\nlast line", base);
+    round_trip("", base);
+    round_trip(base, "");
+}
+
+static void test_w_delta_apply_invalid(void **state) {
+    size_t size;
+
+    assert_null(w_delta_apply(base, strlen(base), "c 0 1\n", 6, &size));
+    assert_null(w_delta_apply(base, strlen(base), W_DELTA_MAGIC "c 5 3\n", strlen(W_DELTA_MAGIC "c 5 3\n"), &size));
+    assert_null(w_delta_apply(base, strlen(base), W_DELTA_MAGIC "a 2\nonly one\n", strlen(W_DELTA_MAGIC "a 2\nonly one\n"), &size));
+    assert_null(w_delta_apply(base, strlen(base), W_DELTA_MAGIC "x 1\n", strlen(W_DELTA_MAGIC "x 1\n"), &size));
+    assert_null(w_delta_apply(base, strlen(base), W_DELTA_MAGIC "c 1", strlen(W_DELTA_MAGIC "c 1"), &size));
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_w_delta_unchanged),
+        cmocka_unit_test(test_w_delta_edit),
+        cmocka_unit_test(test_w_delta_moved_block),
+        cmocka_unit_test(test_w_delta_no_final_newline),
+        cmocka_unit_test(test_w_delta_apply_invalid),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -31,7 +31,12 @@ const char * w_expression_get_regex_pattern(w_expression_t * expression);
 
 
 /* setup/teardown */
-    
+
+static int teardown_thread_data(void ** state) {
+    w_expression_release_thread_data();
+    return 0;
+}
+
 /* tests */
 
 // w_calloc_expression_t
@@ -404,12 +409,24 @@ void w_expression_compile_pcre2(void ** state)
     assert_true(ret);
 
     os_free(pattern);
-    os_free(expression->pcre2->code);
+    pcre2_code_free(expression->pcre2->code);
     os_free(expression->pcre2->raw_pattern);
     os_free(expression->pcre2);
     os_free(expression);
 }
 
+void w_expression_compile_pcre2_ovector_pairs(void ** state)
+{
+    w_expression_t * expression = NULL;
+
+    w_calloc_expression_t(&expression, EXP_TYPE_PCRE2);
+
+    assert_true(w_expression_compile(expression, "^(\\w+)-(\\d+)$", 0));
+    assert_int_equal(expression->pcre2->ovector_pairs, 3);
+
+    w_free_expression_t(&expression);
+}
+
 void w_expression_compile_string(void ** state)
 {
     test_mode = 1;
@@ -554,7 +571,7 @@ void w_expression_match_pcre2_match_data_NULL(void ** state)
     char * str_test = NULL;
     os_strdup("test", str_test);
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, NULL);
+    will_return(wrap_pcre2_match_data_create, NULL);
 
     bool ret = w_expression_match(expression, str_test, &end_match, NULL);
     assert_false(ret);
@@ -585,7 +602,7 @@ void w_expression_match_pcre2_match_no_captured_groups(void ** state)
     char * str_test = NULL;
     os_strdup("test", str_test);
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, 1);
+    will_return(wrap_pcre2_match_data_create, 1);
     will_return(wrap_pcre2_match, 0);
 
     bool ret = w_expression_match(expression, str_test, &end_match, NULL);
@@ -621,7 +638,7 @@ void w_expression_match_pcre2_match_captured_groups(void ** state)
     aux[0] = str_test;
     aux[1] = str_test+1;
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, 1);
+    will_return(wrap_pcre2_match_data_create, 1);
     will_return(wrap_pcre2_match, 1);
     will_return(wrap_pcre2_get_ovector_pointer, aux);
 
@@ -661,7 +678,7 @@ void w_expression_match_pcre2_match_regex_matching(void ** state)
     regex_matching * regex_match;
     os_calloc(1, sizeof(regex_matching), regex_match);
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, 1);
+    will_return(wrap_pcre2_match_data_create, 1);
     will_return(wrap_pcre2_match, 1);
     will_return(wrap_pcre2_get_ovector_pointer, aux);
 
@@ -770,7 +787,7 @@ void w_expression_match_end_match_NULL(void ** state)
     regex_matching * regex_match;
     os_calloc(1, sizeof(regex_matching), regex_match);
 
-    will_return(wrap_pcre2_match_data_create_from_pattern, 1);
+    will_return(wrap_pcre2_match_data_create, 1);
     will_return(wrap_pcre2_match, 1);
     will_return(wrap_pcre2_get_ovector_pointer, aux);
 
@@ -783,6 +800,51 @@ void w_expression_match_end_match_NULL(void ** state)
     w_free_expression_t(&expression);
 }
 
+void w_expression_match_pcre2_reuse_match_data(void ** state)
+{
+    w_expression_t * first = NULL;
+    w_expression_t * second = NULL;
+
+    w_calloc_expression_t(&first, EXP_TYPE_PCRE2);
+    w_expression_compile(first, "first", 0);
+    w_calloc_expression_t(&second, EXP_TYPE_PCRE2);
+    w_expression_compile(second, "second", 0);
+
+    // Created by the first match only
+    will_return(wrap_pcre2_match_data_create, 1);
+    will_return_count(wrap_pcre2_match, 0, 3);
+
+    assert_false(w_expression_match(first, "test", NULL, NULL));
+    assert_false(w_expression_match(second, "test", NULL, NULL));
+    assert_false(w_expression_match(first, "test", NULL, NULL));
+
+    w_free_expression_t(&first);
+    w_free_expression_t(&second);
+}
+
+void w_expression_match_pcre2_grow_match_data(void ** state)
+{
+    w_expression_t * narrow = NULL;
+    w_expression_t * wide = NULL;
+
+    w_calloc_expression_t(&narrow, EXP_TYPE_PCRE2);
+    w_expression_compile(narrow, "test", 0);
+    w_calloc_expression_t(&wide, EXP_TYPE_PCRE2);
+    w_expression_compile(wide, "(t)(e)(s)t", 0);
+
+    // Created again for the pattern with more groups, then kept for both
+    will_return(wrap_pcre2_match_data_create, 1);
+    will_return(wrap_pcre2_match_data_create, 2);
+    will_return_count(wrap_pcre2_match, 0, 3);
+
+    assert_false(w_expression_match(narrow, "test", NULL, NULL));
+    assert_false(w_expression_match(wide, "test", NULL, NULL));
+    assert_false(w_expression_match(narrow, "test", NULL, NULL));
+
+    w_free_expression_t(&narrow);
+    w_free_expression_t(&wide);
+}
+
 // w_expression_PCRE2_fill_regex_match
 
 void w_expression_PCRE2_fill_regex_match_no_capture_groups(void ** state)
@@ -1096,6 +1158,232 @@ void w_expression_get_regex_type_exp_type_default(void ** state)
     os_free(expression);
 }
 
+static OSList * create_expression_list(w_exp_type_t types[], const char * patterns[], int count)
+{
+    OSList * list = OSList_Create();
+    w_expression_t * expression;
+
+    OSList_SetFreeDataPointer(list, (void (*)(void *))w_free_expression);
+
+    for (int i = 0; i < count; i++) {
+        w_calloc_expression_t(&expression, types[i]);
+        assert_true(w_expression_compile(expression, (char *)patterns[i], 0));
+        OSList_InsertData(list, NULL, expression);
+    }
+
+    return list;
+}
+
+// Test w_expression_merge_pcre2
+
+void w_expression_merge_pcre2_list_NULL(void ** state)
+{
+    assert_false(w_expression_merge_pcre2(NULL));
+}
+
+void w_expression_merge_pcre2_single(void ** state)
+{
+    w_exp_type_t types[] = { EXP_TYPE_PCRE2, EXP_TYPE_STRING };
+    const char * patterns[] = { "ignore.*", "test" };
+    OSList * list = create_expression_list(types, patterns, 2);
+
+    assert_false(w_expression_merge_pcre2(list));
+    assert_int_equal(list->currently_size, 2);
+
+    OSList_Destroy(list);
+}
+
+void w_expression_merge_pcre2_done(void ** state)
+{
+    w_exp_type_t types[] = { EXP_TYPE_PCRE2, EXP_TYPE_STRING, EXP_TYPE_PCRE2, EXP_TYPE_PCRE2 };
+    const char * patterns[] = { "ignore.*", "test", "(?i)debug", "^(a|b)$" };
+    OSList * list = create_expression_list(types, patterns, 4);
+    w_expression_t * expression;
+
+    assert_true(w_expression_merge_pcre2(list));
+    assert_int_equal(list->currently_size, 2);
+
+    expression = OSList_GetFirstNode(list)->data;
+    assert_int_equal(expression->exp_type, EXP_TYPE_STRING);
+
+    expression = OSList_GetLastNode(list)->data;
+    assert_int_equal(expression->exp_type, EXP_TYPE_PCRE2);
+    assert_string_equal(expression->pcre2->raw_pattern, "(?:ignore.*)|(?:(?i)debug)|(?:^(a|b)$)");
+
+    OSList_Destroy(list);
+}
+
+void w_expression_merge_pcre2_backreference(void ** state)
+{
+    w_exp_type_t types[] = { EXP_TYPE_PCRE2, EXP_TYPE_PCRE2, EXP_TYPE_PCRE2 };
+    const char * patterns[] = { "(a)\\1", "(?x) b # comment", "(c)(?1)" };
+    OSList * list = create_expression_list(types, patterns, 3);
+
+    // None of them keeps its meaning in an alternation
+    assert_false(w_expression_merge_pcre2(list));
+    assert_int_equal(list->currently_size, 3);
+
+    OSList_Destroy(list);
+}
+
+// Test w_expression_cache
+
+static w_expression_t * compile_pcre2(const char * pattern)
+{
+    w_expression_t * expression = NULL;
+
+    w_calloc_expression_t(&expression, EXP_TYPE_PCRE2);
+    assert_true(w_expression_compile(expression, (char *)pattern, 0));
+
+    return expression;
+}
+
+static void cache_path(char * path)
+{
+    int fd;
+
+    strcpy(path, "/tmp/test_expression_cache_XXXXXX");
+    fd = mkstemp(path);
+    assert_true(fd >= 0);
+    close(fd);
+    unlink(path);
+}
+
+void w_expression_cache_load_missing_file(void ** state)
+{
+    char path[PATH_MAX];
+
+    cache_path(path);
+
+    assert_int_equal(w_expression_cache_load(path), -1);
+    assert_null(w_expression_cache_get("test"));
+
+    w_expression_cache_free();
+}
+
+void w_expression_cache_save_load(void ** state)
+{
+    char path[PATH_MAX];
+    w_expression_t * first;
+    w_expression_t * second;
+    pcre2_code * code;
+
+    cache_path(path);
+
+    assert_int_equal(w_expression_cache_load(path), -1);
+    first = compile_pcre2("^foo(\\d+)$");
+    second = compile_pcre2("(?i)hello");
+    assert_int_equal(w_expression_cache_save(path), 0);
+    w_free_expression_t(&first);
+    w_free_expression_t(&second);
+    w_expression_cache_free();
+
+    assert_int_equal(w_expression_cache_load(path), 2);
+    code = w_expression_cache_get("(?i)hello");
+    assert_non_null(code);
+    pcre2_code_free(code);
+    assert_null(w_expression_cache_get("bar"));
+
+    // Once saved, the patterns compiled later are not kept
+    first = compile_pcre2("^foo(\\d+)$");
+    assert_int_equal(w_expression_cache_save(path), 0);
+    second = compile_pcre2("bar");
+    assert_null(w_expression_cache_get("bar"));
+    w_free_expression_t(&first);
+    w_free_expression_t(&second);
+    w_expression_cache_free();
+
+    assert_int_equal(w_expression_cache_load(path), 2);
+
+    w_expression_cache_free();
+    unlink(path);
+}
+
+void w_expression_cache_save_drop_unused(void ** state)
+{
+    char path[PATH_MAX];
+    w_expression_t * first;
+    w_expression_t * second;
+
+    cache_path(path);
+
+    assert_int_equal(w_expression_cache_load(path), -1);
+    first = compile_pcre2("first");
+    second = compile_pcre2("second");
+    assert_int_equal(w_expression_cache_save(path), 0);
+    w_free_expression_t(&first);
+    w_free_expression_t(&second);
+    w_expression_cache_free();
+
+    // The ruleset doesn't have the second pattern anymore
+    assert_int_equal(w_expression_cache_load(path), 2);
+    first = compile_pcre2("first");
+    assert_int_equal(w_expression_cache_save(path), 0);
+    w_free_expression_t(&first);
+    w_expression_cache_free();
+
+    assert_int_equal(w_expression_cache_load(path), 1);
+    assert_null(w_expression_cache_get("second"));
+
+    // Nor any pattern at all
+    assert_int_equal(w_expression_cache_save(path), 0);
+    assert_int_equal(access(path, F_OK), -1);
+
+    w_expression_cache_free();
+}
+
+void w_expression_cache_load_corrupted(void ** state)
+{
+    char path[PATH_MAX];
+    w_expression_t * expression;
+    FILE * fp;
+
+    cache_path(path);
+
+    assert_int_equal(w_expression_cache_load(path), -1);
+    expression = compile_pcre2("(a|b)+c");
+    assert_int_equal(w_expression_cache_save(path), 0);
+    w_free_expression_t(&expression);
+    w_expression_cache_free();
+
+    fp = fopen(path, "r+b");
+    assert_non_null(fp);
+    fseek(fp, 24, SEEK_SET);
+    fputs("garbage", fp);
+    fclose(fp);
+
+    assert_int_equal(w_expression_cache_load(path), -1);
+    assert_null(w_expression_cache_get("(a|b)+c"));
+
+    w_expression_cache_free();
+    unlink(path);
+}
+
+void w_expression_cache_load_truncated(void ** state)
+{
+    char path[PATH_MAX];
+    w_expression_t * expression;
+    struct stat st;
+
+    cache_path(path);
+
+    assert_int_equal(w_expression_cache_load(path), -1);
+    expression = compile_pcre2("(a|b)+c");
+    assert_int_equal(w_expression_cache_save(path), 0);
+    w_free_expression_t(&expression);
+    w_expression_cache_free();
+
+    // The last bytes of the serialized code are missing
+    assert_int_equal(stat(path, &st), 0);
+    assert_int_equal(truncate(path, st.st_size - 8), 0);
+
+    assert_int_equal(w_expression_cache_load(path), -1);
+    assert_null(w_expression_cache_get("(a|b)+c"));
+
+    w_expression_cache_free();
+    unlink(path);
+}
+
 int main(void)
 {
     const struct CMUnitTest tests[] = {
@@ -1129,6 +1417,7 @@ int main(void)
         cmocka_unit_test(w_expression_compile_osmatch_fail),
         cmocka_unit_test(w_expression_compile_osmatch),
         cmocka_unit_test(w_expression_compile_pcre2),
+        cmocka_unit_test(w_expression_compile_pcre2_ovector_pairs),
         cmocka_unit_test(w_expression_compile_string),
         cmocka_unit_test(w_expression_compile_osip_array),
         cmocka_unit_test(w_expression_compile_default),
@@ -1137,14 +1426,16 @@ int main(void)
         cmocka_unit_test(w_expression_match_NULL),
         cmocka_unit_test(w_expression_match_osmatch),
         cmocka_unit_test(w_expression_match_osregex),
-        cmocka_unit_test(w_expression_match_pcre2_match_data_NULL),
-        cmocka_unit_test(w_expression_match_pcre2_match_no_captured_groups),
-        cmocka_unit_test(w_expression_match_pcre2_match_captured_groups),
-        cmocka_unit_test(w_expression_match_pcre2_match_regex_matching),
+        cmocka_unit_test_teardown(w_expression_match_pcre2_match_data_NULL, teardown_thread_data),
+        cmocka_unit_test_teardown(w_expression_match_pcre2_match_no_captured_groups, teardown_thread_data),
+        cmocka_unit_test_teardown(w_expression_match_pcre2_match_captured_groups, teardown_thread_data),
+        cmocka_unit_test_teardown(w_expression_match_pcre2_match_regex_matching, teardown_thread_data),
         cmocka_unit_test(w_expression_match_string),
         cmocka_unit_test(w_expression_match_osip_array),
         cmocka_unit_test(w_expression_match_default),
-        cmocka_unit_test(w_expression_match_end_match_NULL),
+        cmocka_unit_test_teardown(w_expression_match_end_match_NULL, teardown_thread_data),
+        cmocka_unit_test_teardown(w_expression_match_pcre2_reuse_match_data, teardown_thread_data),
+        cmocka_unit_test_teardown(w_expression_match_pcre2_grow_match_data, teardown_thread_data),
 
         //Test w_expression_PCRE2_fill_regex_match
         cmocka_unit_test(w_expression_PCRE2_fill_regex_match_no_capture_groups),
@@ -1169,7 +1460,20 @@ int main(void)
         cmocka_unit_test(w_expression_get_regex_type_exp_type_pcre2),
         cmocka_unit_test(w_expression_get_regex_type_exp_type_string),
         cmocka_unit_test(w_expression_get_regex_type_exp_type_osip_array),
-        cmocka_unit_test(w_expression_get_regex_type_exp_type_default)
+        cmocka_unit_test(w_expression_get_regex_type_exp_type_default),
+
+        // Test w_expression_merge_pcre2
+        cmocka_unit_test(w_expression_merge_pcre2_list_NULL),
+        cmocka_unit_test(w_expression_merge_pcre2_single),
+        cmocka_unit_test(w_expression_merge_pcre2_done),
+        cmocka_unit_test(w_expression_merge_pcre2_backreference),
+
+        // Test w_expression_cache
+        cmocka_unit_test(w_expression_cache_load_missing_file),
+        cmocka_unit_test(w_expression_cache_save_load),
+        cmocka_unit_test(w_expression_cache_save_drop_unused),
+        cmocka_unit_test(w_expression_cache_load_corrupted),
+        cmocka_unit_test(w_expression_cache_load_truncated)
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,416 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "../headers/shared.h"
+
+#define TEST_KEYS 5000
+
+/* setup/teardowns */
+
+static int create_hash(void **state)
+{
+    OSHash *hash = OSHash_Create();
+
+    if (hash == NULL) {
+        return -1;
+    }
+
+    OSHash_SetFreeDataPointer(hash, free);
+    *state = hash;
+    return 0;
+}
+
+static int create_concurrent_hash(void **state)
+{
+    OSHash *hash = OSHash_Create();
+
+    if (hash == NULL || !OSHash_SetConcurrent(hash, 8)) {
+        return -1;
+    }
+
+    OSHash_SetFreeDataPointer(hash, free);
+    *state = hash;
+    return 0;
+}
+
+static int delete_hash(void **state)
+{
+    OSHash_Free(*state);
+    return 0;
+}
+
+static int delete_hash_if_any(void **state)
+{
+    if (*state) {
+        OSHash_Free(*state);
+    }
+    return 0;
+}
+
+/* auxiliary functions */
+
+static void fill_hash(OSHash *hash, unsigned int count)
+{
+    char key[OS_SIZE_32];
+    unsigned int i;
+    int *value;
+
+    for (i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key-%u", i);
+        os_calloc(1, sizeof(int), value);
+        *value = i;
+        assert_int_equal(OSHash_Add(hash, key, value), 2);
+    }
+}
+
+static void assert_hash_contents(OSHash *hash, unsigned int count, unsigned int step)
+{
+    char key[OS_SIZE_32];
+    unsigned int i;
+    int *value;
+
+    for (i = 0; i < count; i++) {
+        snprintf(key, sizeof(key), "key-%u", i);
+        value = OSHash_Get(hash, key);
+
+        if (i % step == 0) {
+            assert_non_null(value);
+            assert_int_equal(*value, i);
+        } else {
+            assert_null(value);
+        }
+    }
+}
+
+static void remove_odd(OSHashNode **row, OSHashNode **node, void *data)
+{
+    if (*(int *)(*node)->data % 2) {
+        (*(unsigned int *)data)++;
+        os_free((*node)->key);
+        os_free((*node)->data);
+        os_free(*node);
+        *row = NULL;
+    }
+}
+
+typedef struct {
+    OSHash *hash;
+    unsigned int first;
+    int misses;
+} worker_t;
+
+/* Add and delete its own keys, checking the keys that are never deleted */
+static void *concurrent_worker(void *arg)
+{
+    worker_t *worker = arg;
+    char key[OS_SIZE_32];
+    unsigned int i;
+    int round;
+    int *value;
+
+    for (round = 0; round < 20; round++) {
+        for (i = worker->first; i < worker->first + 500; i++) {
+            snprintf(key, sizeof(key), "key-%u", i);
+            os_calloc(1, sizeof(int), value);
+            *value = i;
+            if (OSHash_Add_ex(worker->hash, key, value) != 2) {
+                free(value);
+            }
+        }
+
+        for (i = 0; i < TEST_KEYS; i += 7) {
+            snprintf(key, sizeof(key), "key-%u", i);
+            if (value = OSHash_Get_ex(worker->hash, key), !value || *value != (int)i) {
+                worker->misses++;
+            }
+        }
+
+        for (i = worker->first; i < worker->first + 500; i++) {
+            snprintf(key, sizeof(key), "key-%u", i);
+            free(OSHash_Delete_ex(worker->hash, key));
+        }
+    }
+
+    return NULL;
+}
+
+/* tests */
+
+void test_OSHash_add_get(void **state)
+{
+    OSHash *hash = *state;
+    int *value;
+
+    os_calloc(1, sizeof(int), value);
+    *value = 1;
+
+    assert_int_equal(OSHash_Add(hash, "key", value), 2);
+    assert_int_equal(OSHash_Add(hash, "key", value), 1);
+    assert_ptr_equal(OSHash_Get(hash, "key"), value);
+    assert_null(OSHash_Get(hash, "other"));
+    assert_int_equal(OSHash_Get_Elem_ex(hash), 1);
+}
+
+void test_OSHash_update_delete(void **state)
+{
+    OSHash *hash = *state;
+    int *value;
+    int *other;
+
+    os_calloc(1, sizeof(int), value);
+    os_calloc(1, sizeof(int), other);
+
+    assert_int_equal(OSHash_Update(hash, "key", other), 0);
+    assert_int_equal(OSHash_Add(hash, "key", value), 2);
+    assert_int_equal(OSHash_Update(hash, "key", other), 1);
+    assert_ptr_equal(OSHash_Get(hash, "key"), other);
+
+    assert_ptr_equal(OSHash_Delete(hash, "key"), other);
+    assert_null(OSHash_Get(hash, "key"));
+    assert_null(OSHash_Delete(hash, "key"));
+    assert_int_equal(OSHash_Get_Elem_ex(hash), 0);
+
+    os_free(other);
+}
+
+void test_OSHash_grow(void **state)
+{
+    OSHash *hash = *state;
+
+    fill_hash(hash, TEST_KEYS);
+
+    assert_int_equal(OSHash_Get_Elem_ex(hash), TEST_KEYS);
+    assert_true(hash->rows + 1 >= TEST_KEYS);
+    assert_hash_contents(hash, TEST_KEYS, 1);
+}
+
+void test_OSHash_delete_reinsert(void **state)
+{
+    OSHash *hash = *state;
+    char key[OS_SIZE_32];
+    unsigned int i;
+
+    fill_hash(hash, TEST_KEYS);
+
+    for (i = 0; i < TEST_KEYS; i++) {
+        if (i % 3) {
+            snprintf(key, sizeof(key), "key-%u", i);
+            free(OSHash_Delete(hash, key));
+        }
+    }
+
+    assert_int_equal(OSHash_Get_Elem_ex(hash), (TEST_KEYS + 2) / 3);
+    assert_hash_contents(hash, TEST_KEYS, 3);
+}
+
+void test_OSHash_setSize_keeps_entries(void **state)
+{
+    OSHash *hash = *state;
+
+    fill_hash(hash, 100);
+
+    assert_int_equal(OSHash_setSize(hash, 4096), 1);
+    assert_true(hash->rows + 1 >= 4096);
+    assert_int_equal(OSHash_Get_Elem_ex(hash), 100);
+    assert_hash_contents(hash, 100, 1);
+}
+
+void test_OSHash_iterate(void **state)
+{
+    OSHash *hash = *state;
+    unsigned int seen = 0;
+    unsigned int i;
+    OSHashNode *node;
+    char *visited;
+
+    fill_hash(hash, TEST_KEYS);
+    os_calloc(TEST_KEYS, sizeof(char), visited);
+
+    for (node = OSHash_Begin(hash, &i); node; node = OSHash_Next(hash, &i, node)) {
+        int value = *(int *)node->data;
+
+        assert_true(value >= 0 && value < TEST_KEYS);
+        assert_int_equal(visited[value], 0);
+        visited[value] = 1;
+        seen++;
+    }
+
+    assert_int_equal(seen, TEST_KEYS);
+    os_free(visited);
+}
+
+void test_OSHash_It_remove(void **state)
+{
+    OSHash *hash = *state;
+    unsigned int removed = 0;
+
+    fill_hash(hash, TEST_KEYS);
+
+    OSHash_It(hash, &removed, remove_odd);
+
+    assert_int_equal(removed, TEST_KEYS / 2);
+    assert_int_equal(OSHash_Get_Elem_ex(hash), TEST_KEYS - TEST_KEYS / 2);
+    assert_hash_contents(hash, TEST_KEYS, 2);
+}
+
+void test_OSHash_duplicate(void **state)
+{
+    OSHash *hash = *state;
+    OSHash *copy;
+
+    fill_hash(hash, TEST_KEYS);
+
+    copy = OSHash_Duplicate(hash);
+    assert_non_null(copy);
+    assert_int_equal(OSHash_Get_Elem_ex(copy), TEST_KEYS);
+    assert_hash_contents(copy, TEST_KEYS, 1);
+
+    // The copy shares the data with the original table
+    OSHash_Clean(copy, NULL);
+}
+
+void test_OSHash_clean(void **state)
+{
+    OSHash *hash = *state;
+    unsigned int i;
+
+    fill_hash(hash, TEST_KEYS);
+
+    OSHash_Clean(hash, free);
+    *state = NULL;
+
+    hash = OSHash_Create();
+    assert_null(OSHash_Begin(hash, &i));
+    OSHash_Free(hash);
+}
+
+void test_OSHash_SetConcurrent_fail(void **state)
+{
+    OSHash *hash = *state;
+
+    // Already concurrent
+    assert_int_equal(OSHash_SetConcurrent(hash, 4), 0);
+
+    hash = OSHash_Create();
+    assert_int_equal(OSHash_SetConcurrent(hash, 1), 0);
+    assert_int_equal(OSHash_SetConcurrent(hash, 6), 0);
+
+    assert_int_equal(OSHash_Add(hash, "key", NULL), 2);
+    assert_int_equal(OSHash_SetConcurrent(hash, 4), 0);
+
+    OSHash_Free(hash);
+}
+
+void test_OSHash_concurrent_operations(void **state)
+{
+    OSHash *hash = *state;
+    int *value;
+
+    fill_hash(hash, TEST_KEYS);
+
+    assert_int_equal(OSHash_Get_Elem_ex(hash), TEST_KEYS);
+    assert_hash_contents(hash, TEST_KEYS, 1);
+
+    os_calloc(1, sizeof(int), value);
+    *value = 42;
+    assert_int_equal(OSHash_Update_ex(hash, "key-42", value), 1);
+    assert_ptr_equal(OSHash_Get_ex(hash, "key-42"), value);
+    assert_int_equal(OSHash_Add_ex(hash, "key-42", value), 1);
+
+    free(OSHash_Delete_ex(hash, "key-42"));
+    assert_null(OSHash_Get_ex(hash, "key-42"));
+    assert_int_equal(OSHash_Get_Elem_ex(hash), TEST_KEYS - 1);
+
+    assert_int_equal(OSHash_setSize_ex(hash, 4 * TEST_KEYS), 1);
+    assert_int_equal(OSHash_Get_Elem_ex(hash), TEST_KEYS - 1);
+    assert_non_null(OSHash_Get_ex(hash, "key-41"));
+}
+
+void test_OSHash_concurrent_iterate(void **state)
+{
+    OSHash *hash = *state;
+    unsigned int seen = 0;
+    unsigned int removed = 0;
+    unsigned int i;
+    OSHashNode *node;
+    OSHash *copy;
+
+    fill_hash(hash, TEST_KEYS);
+
+    for (node = OSHash_Begin(hash, &i); node; node = OSHash_Next(hash, &i, node)) {
+        seen++;
+    }
+
+    assert_int_equal(seen, TEST_KEYS);
+
+    copy = OSHash_Duplicate_ex(hash);
+    assert_int_equal(OSHash_Get_Elem_ex(copy), TEST_KEYS);
+    assert_hash_contents(copy, TEST_KEYS, 1);
+    OSHash_Clean(copy, NULL);
+
+    OSHash_It_ex(hash, 1, &removed, remove_odd);
+    assert_int_equal(removed, TEST_KEYS / 2);
+    assert_hash_contents(hash, TEST_KEYS, 2);
+}
+
+void test_OSHash_concurrent_threads(void **state)
+{
+    OSHash *hash = *state;
+    pthread_t threads[4];
+    worker_t workers[4];
+    int i;
+
+    // Keys that are never deleted
+    fill_hash(hash, TEST_KEYS);
+
+    for (i = 0; i < 4; i++) {
+        workers[i].hash = hash;
+        workers[i].first = TEST_KEYS + i * 500;
+        workers[i].misses = 0;
+        assert_int_equal(pthread_create(&threads[i], NULL, concurrent_worker, &workers[i]), 0);
+    }
+
+    for (i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        assert_int_equal(workers[i].misses, 0);
+    }
+
+    assert_int_equal(OSHash_Get_Elem_ex(hash), TEST_KEYS);
+    assert_hash_contents(hash, TEST_KEYS, 1);
+}
+
+int main(void)
+{
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_OSHash_add_get, create_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_update_delete, create_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_grow, create_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_delete_reinsert, create_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_setSize_keeps_entries, create_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_iterate, create_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_It_remove, create_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_duplicate, create_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_clean, create_hash, delete_hash_if_any),
+        // Concurrent hashes
+        cmocka_unit_test_setup_teardown(test_OSHash_SetConcurrent_fail, create_concurrent_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_concurrent_operations, create_concurrent_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_concurrent_iterate, create_concurrent_hash, delete_hash),
+        cmocka_unit_test_setup_teardown(test_OSHash_concurrent_threads, create_concurrent_hash, delete_hash),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
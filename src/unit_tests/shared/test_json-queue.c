@@ -230,6 +230,135 @@ void test_jqueue_parse_json_stat_fail_and_retry(void ** state) {
     assert_int_equal(queue->flags, 0);
 }
 
+void test_jqueue_parse_json_filtered_level(void ** state) {
+    file_queue * queue = *state;
+    char buffer[OS_MAXSTR + 1];
+    cJSON * object = NULL;
+
+    jqueue_set_filter(queue, 10, NULL);
+    snprintf(buffer, OS_MAXSTR, "%s\n", "{\"timestamp\":\"now\",\"rule\":{\"level\":3}}");
+
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, 0);
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, strlen(buffer));
+
+    expect_value(__wrap_fgets, __stream, queue->fp);
+    will_return(__wrap_fgets, buffer);
+
+    object = jqueue_parse_json(queue);
+
+    assert_null(object);
+    assert_int_equal(queue->flags, CRALERT_FILTERED);
+}
+
+void test_jqueue_parse_json_filter_match(void ** state) {
+    file_queue * queue = *state;
+    char buffer[OS_MAXSTR + 1];
+    cJSON * object = NULL;
+
+    jqueue_set_filter(queue, 10, "\"mail\":true");
+    snprintf(buffer, OS_MAXSTR, "%s\n", "{\"timestamp\":\"now\",\"rule\":{\"level\":12,\"mail\":true}}");
+
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, 0);
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, strlen(buffer));
+
+    expect_value(__wrap_fgets, __stream, queue->fp);
+    will_return(__wrap_fgets, buffer);
+
+    object = jqueue_parse_json(queue);
+
+    assert_non_null(object);
+    assert_int_equal(queue->flags, 0);
+
+    cJSON_Delete(object);
+}
+
+void test_jqueue_parse_json_filter_no_level(void ** state) {
+    file_queue * queue = *state;
+    char buffer[OS_MAXSTR + 1];
+    cJSON * object = NULL;
+
+    // Alerts whose level can't be found are parsed anyway
+    jqueue_set_filter(queue, 10, NULL);
+    snprintf(buffer, OS_MAXSTR, "%s\n", "{\"rule\":{\"id\":\"1\"}}");
+
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, 0);
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, strlen(buffer));
+
+    expect_value(__wrap_fgets, __stream, queue->fp);
+    will_return(__wrap_fgets, buffer);
+
+    object = jqueue_parse_json(queue);
+
+    assert_non_null(object);
+    cJSON_Delete(object);
+}
+
+void test_jqueue_parse_json_filtered_pattern(void ** state) {
+    file_queue * queue = *state;
+    char buffer[OS_MAXSTR + 1];
+    cJSON * object = NULL;
+
+    jqueue_set_filter(queue, 0, "\"mail\":true");
+    snprintf(buffer, OS_MAXSTR, "%s\n", "{\"rule\":{\"level\":12,\"mail\":false}}");
+
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, 0);
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, strlen(buffer));
+
+    expect_value(__wrap_fgets, __stream, queue->fp);
+    will_return(__wrap_fgets, buffer);
+
+    object = jqueue_parse_json(queue);
+
+    assert_null(object);
+    assert_int_equal(queue->flags, CRALERT_FILTERED);
+}
+
+void test_jqueue_next_skip_filtered(void ** state) {
+    file_queue * queue = *state;
+    char buffer1[OS_MAXSTR + 1];
+    char buffer2[OS_MAXSTR + 1];
+    cJSON * object = NULL;
+    char * output = NULL;
+
+    jqueue_set_filter(queue, 5, NULL);
+    snprintf(buffer1, OS_MAXSTR, "%s\n", "{\"rule\":{\"level\":3}}");
+    snprintf(buffer2, OS_MAXSTR, "%s\n", "{\"rule\":{\"level\":7}}");
+
+    expect_function_call(__wrap_clearerr);
+    expect_value(__wrap_clearerr, __stream, 1);
+
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, 0);
+    expect_value(__wrap_fgets, __stream, queue->fp);
+    will_return(__wrap_fgets, buffer1);
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, strlen(buffer1));
+
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, strlen(buffer1));
+    expect_value(__wrap_fgets, __stream, queue->fp);
+    will_return(__wrap_fgets, buffer2);
+    expect_any(__wrap_w_ftell, x);
+    will_return(__wrap_w_ftell, strlen(buffer1) + strlen(buffer2));
+
+    object = jqueue_next(queue);
+
+    output = cJSON_PrintUnformatted(object);
+    assert_string_equal(output, "{\"rule\":{\"level\":7}}");
+    assert_int_equal(queue->flags, 0);
+
+    os_free(output);
+    cJSON_Delete(object);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
             cmocka_unit_test_setup_teardown(test_jqueue_parse_json_valid, setup_queue, teardown_queue),
@@ -238,6 +367,12 @@ int main(void) {
             cmocka_unit_test_setup_teardown(test_jqueue_parse_json_fgets_fail, setup_queue, teardown_queue),
             cmocka_unit_test_setup_teardown(test_jqueue_parse_json_fgets_fail_and_retry, setup_queue, teardown_queue),
             cmocka_unit_test_setup_teardown(test_jqueue_parse_json_stat_fail_and_retry, setup_queue, teardown_queue),
+            // Pre-filter
+            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_filtered_level, setup_queue, teardown_queue),
+            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_filter_match, setup_queue, teardown_queue),
+            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_filter_no_level, setup_queue, teardown_queue),
+            cmocka_unit_test_setup_teardown(test_jqueue_parse_json_filtered_pattern, setup_queue, teardown_queue),
+            cmocka_unit_test_setup_teardown(test_jqueue_next_skip_filtered, setup_queue, teardown_queue),
 
     };
     return cmocka_run_group_tests(tests, setup_group, teardown_group);
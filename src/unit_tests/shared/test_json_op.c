@@ -16,6 +16,7 @@
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
+#include <math.h>
 
 
 #include "../../headers/json_op.h"
@@ -293,6 +294,153 @@ void test_json_parse_agents_empty(void **state)
     assert_int_equal(agent_ids[0], -1);
 }
 
+/* json_writer */
+
+void test_json_writer_object(void **state)
+{
+    json_writer_t writer;
+    json_writer_init(&writer, 0);
+
+    json_writer_object_begin(&writer, NULL);
+    json_writer_add_string(&writer, "name", "agent");
+    json_writer_add_number(&writer, "id", 10);
+    json_writer_add_int(&writer, "size", 8589934592LL);
+    json_writer_add_bool(&writer, "active", true);
+    json_writer_add_bool(&writer, "removed", false);
+    json_writer_add_null(&writer, "group");
+    json_writer_add_string(&writer, "os", NULL);
+    json_writer_object_end(&writer);
+
+    assert_string_equal(json_writer_str(&writer),
+        "{\"name\":\"agent\",\"id\":10,\"size\":8589934592,\"active\":true,\"removed\":false,\"group\":null,\"os\":null}");
+    assert_int_equal(writer.length, strlen(writer.data));
+
+    json_writer_free(&writer);
+}
+
+void test_json_writer_nested(void **state)
+{
+    json_writer_t writer;
+    json_writer_init(&writer, 4);
+
+    json_writer_object_begin(&writer, NULL);
+    json_writer_array_begin(&writer, "items");
+    json_writer_object_begin(&writer, NULL);
+    json_writer_object_end(&writer);
+    json_writer_array_begin(&writer, NULL);
+    json_writer_add_int(&writer, NULL, 1);
+    json_writer_add_int(&writer, NULL, 2);
+    json_writer_array_end(&writer);
+    json_writer_add_raw(&writer, NULL, "{\"a\":[]}", 8);
+    json_writer_array_end(&writer);
+    json_writer_object_begin(&writer, "rule");
+    json_writer_add_string(&writer, "level", "3");
+    json_writer_object_end(&writer);
+    json_writer_object_end(&writer);
+
+    assert_string_equal(json_writer_str(&writer), "{\"items\":[{},[1,2],{\"a\":[]}],\"rule\":{\"level\":\"3\"}}");
+    assert_int_equal(writer.depth, 0);
+    assert_false(writer.overflow);
+
+    json_writer_free(&writer);
+}
+
+void test_json_writer_escape(void **state)
+{
+    json_writer_t writer;
+    json_writer_init(&writer, 0);
+
+    json_writer_add_string(&writer, NULL, "\"quoted\" back\\slash /path\b\f\n\r\t\x01\x1f \xc3\xb1");
+    assert_string_equal(json_writer_str(&writer), "\"\\\"quoted\\\" back\\\\slash /path\\b\\f\\n\\r\\t\\u0001\\u001f \xc3\xb1\"");
+
+    json_writer_reset(&writer);
+    json_writer_add_stringn(&writer, "k\ney", "abcdef", 3);
+    assert_string_equal(json_writer_str(&writer), "\"k\\ney\":\"abc\"");
+
+    json_writer_free(&writer);
+}
+
+void test_json_writer_numbers(void **state)
+{
+    json_writer_t writer;
+    json_writer_init(&writer, 0);
+
+    json_writer_array_begin(&writer, NULL);
+    json_writer_add_number(&writer, NULL, -3);
+    json_writer_add_number(&writer, NULL, 0.5);
+    json_writer_add_number(&writer, NULL, 0.1);
+    json_writer_add_number(&writer, NULL, 1e20);
+    json_writer_add_number(&writer, NULL, 1.0 / 3);
+    json_writer_add_number(&writer, NULL, NAN);
+    json_writer_add_number(&writer, NULL, INFINITY);
+    json_writer_array_end(&writer);
+
+    assert_string_equal(json_writer_str(&writer), "[-3,0.5,0.1,1e+20,0.33333333333333331,null,null]");
+
+    json_writer_free(&writer);
+}
+
+void test_json_writer_reset(void **state)
+{
+    json_writer_t writer;
+    json_writer_init(&writer, 0);
+
+    json_writer_array_begin(&writer, NULL);
+    json_writer_add_int(&writer, NULL, 1);
+
+    char * data = writer.data;
+    size_t size = writer.size;
+
+    json_writer_reset(&writer);
+    json_writer_append(&writer, "due ", 4);
+    json_writer_object_begin(&writer, NULL);
+    json_writer_add_int(&writer, "a", 1);
+    json_writer_object_end(&writer);
+
+    assert_string_equal(json_writer_str(&writer), "due {\"a\":1}");
+    assert_ptr_equal(writer.data, data);
+    assert_int_equal(writer.size, size);
+
+    json_writer_free(&writer);
+}
+
+void test_json_writer_grow(void **state)
+{
+    char value[OS_SIZE_1024 + 1];
+    json_writer_t writer;
+
+    memset(value, 'A', OS_SIZE_1024);
+    value[OS_SIZE_1024] = '\0';
+
+    json_writer_init(&writer, 8);
+    json_writer_add_string(&writer, NULL, value);
+
+    assert_int_equal(writer.length, OS_SIZE_1024 + 2);
+    assert_true(writer.size > writer.length);
+    assert_int_equal(writer.data[0], '"');
+    assert_int_equal(writer.data[OS_SIZE_1024 + 1], '"');
+
+    json_writer_free(&writer);
+}
+
+void test_json_writer_overflow(void **state)
+{
+    json_writer_t writer;
+    json_writer_init(&writer, 0);
+
+    for (int i = 0; i < JSON_WRITER_MAX_DEPTH; i++) {
+        json_writer_array_begin(&writer, NULL);
+    }
+
+    assert_false(writer.overflow);
+    json_writer_array_begin(&writer, NULL);
+    assert_true(writer.overflow);
+    assert_int_equal(writer.depth, JSON_WRITER_MAX_DEPTH);
+    assert_int_equal(writer.length, JSON_WRITER_MAX_DEPTH);
+
+    json_writer_free(&writer);
+}
+
 
 int main(void) {
     const struct CMUnitTest tests[] = {
@@ -310,7 +458,15 @@ int main(void) {
         // json_parse_agents
         cmocka_unit_test_teardown(test_json_parse_agents_success, teardown),
         cmocka_unit_test_teardown(test_json_parse_agents_type_error, teardown),
-        cmocka_unit_test_teardown(test_json_parse_agents_empty, teardown)
+        cmocka_unit_test_teardown(test_json_parse_agents_empty, teardown),
+        // json_writer
+        cmocka_unit_test(test_json_writer_object),
+        cmocka_unit_test(test_json_writer_nested),
+        cmocka_unit_test(test_json_writer_escape),
+        cmocka_unit_test(test_json_writer_numbers),
+        cmocka_unit_test(test_json_writer_reset),
+        cmocka_unit_test(test_json_writer_grow),
+        cmocka_unit_test(test_json_writer_overflow),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
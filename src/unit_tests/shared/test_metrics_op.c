@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../headers/shared.h"
+#include "../wrappers/common.h"
+#include "../wrappers/wazuh/shared/debug_op_wrappers.h"
+#include "../wrappers/wazuh/shared/time_op_wrappers.h"
+
+// The registry is process-wide, so every test uses its own metric names
+
+static void test_w_metrics_counter(void **state) {
+    w_metric_t * counter = w_metrics_counter("test_counter_total", "Counter");
+
+    assert_non_null(counter);
+    assert_ptr_equal(w_metrics_counter("test_counter_total", NULL), counter);
+
+    w_metrics_add(counter, 1);
+    w_metrics_add(counter, 41);
+
+    assert_int_equal(w_metrics_value(counter), 42);
+}
+
+static void test_w_metrics_gauge(void **state) {
+    w_metric_t * gauge = w_metrics_gauge("test_gauge", "Gauge");
+
+    w_metrics_set(gauge, 5);
+    w_metrics_shift(gauge, -7);
+
+    assert_int_equal(w_metrics_value(gauge), -2);
+}
+
+static void test_w_metrics_type_mismatch(void **state) {
+    w_metric_t * counter = w_metrics_counter("test_mismatch", NULL);
+
+    expect_string(__wrap__merror, formatted_msg, "Metric 'test_mismatch' is already registered with another type.");
+
+    assert_null(w_metrics_gauge("test_mismatch", NULL));
+
+    // Updates of a metric of another type, or of no metric, are ignored
+    w_metrics_set(counter, 10);
+    w_metrics_record(counter, 10);
+    w_metrics_add(NULL, 1);
+
+    assert_int_equal(w_metrics_value(counter), 0);
+    assert_int_equal(w_metrics_value(NULL), 0);
+}
+
+static void test_w_metrics_percentile(void **state) {
+    w_metric_t * histogram = w_metrics_histogram("test_percentile_us", NULL);
+
+    assert_int_equal(w_metrics_percentile(histogram, 50), 0);
+
+    for (uint64_t i = 1; i <= 100; i++) {
+        w_metrics_record(histogram, i);
+    }
+
+    assert_int_equal(w_metrics_value(histogram), 100);
+    // Exact below 32, then within 1/16
+    assert_int_equal(w_metrics_percentile(histogram, 10), 10);
+    assert_int_equal(w_metrics_percentile(histogram, 50), 51);
+    assert_int_equal(w_metrics_percentile(histogram, 99), 99);
+    assert_int_equal(w_metrics_percentile(histogram, 100), 100);
+}
+
+static void test_w_metrics_record_large(void **state) {
+    w_metric_t * histogram = w_metrics_histogram("test_large_us", NULL);
+
+    w_metrics_record(histogram, 1000000);
+    w_metrics_record(histogram, UINT64_MAX);
+
+    uint64_t p50 = w_metrics_percentile(histogram, 50);
+
+    assert_true(p50 >= 1000000 && p50 < 1000000 + 1000000 / 16);
+    assert_int_equal(w_metrics_value(histogram), 2);
+}
+
+static void test_w_metrics_record_since(void **state) {
+    w_metric_t * histogram = w_metrics_histogram("test_since_us", NULL);
+    struct timespec start = { .tv_sec = 100, .tv_nsec = 0 };
+
+    will_return(__wrap_gettime, 102);
+
+    w_metrics_record_since(histogram, &start);
+
+    assert_int_equal(w_metrics_percentile(histogram, 100), 2000000);
+}
+
+static void test_w_metrics_json(void **state) {
+    w_metric_t * histogram = w_metrics_histogram("test_json_us", NULL);
+
+    w_metrics_add(w_metrics_counter("test_json_total", NULL), 3);
+    w_metrics_record(histogram, 7);
+    w_metrics_record(histogram, 9);
+
+    cJSON * metrics = w_metrics_json();
+    cJSON * data = cJSON_GetObjectItem(metrics, "test_json_us");
+
+    assert_int_equal(cJSON_GetObjectItem(metrics, "test_json_total")->valueint, 3);
+    assert_int_equal(cJSON_GetObjectItem(data, "count")->valueint, 2);
+    assert_int_equal(cJSON_GetObjectItem(data, "sum")->valueint, 16);
+    assert_int_equal(cJSON_GetObjectItem(data, "max")->valueint, 9);
+    assert_int_equal(cJSON_GetObjectItem(data, "p50")->valueint, 7);
+    assert_int_equal(cJSON_GetObjectItem(data, "p999")->valueint, 9);
+
+    cJSON_Delete(metrics);
+}
+
+static void collect_sampled_gauge(void) {
+    w_metrics_shift(w_metrics_gauge("test_sampled", NULL), 1);
+}
+
+static void test_w_metrics_collector(void **state) {
+    w_metrics_collector(collect_sampled_gauge);
+
+    cJSON * metrics = w_metrics_json();
+    assert_int_equal(cJSON_GetObjectItem(metrics, "test_sampled")->valueint, 1);
+    cJSON_Delete(metrics);
+
+    char * text = w_metrics_prometheus();
+    assert_non_null(strstr(text, "test_sampled 2\n"));
+    os_free(text);
+}
+
+static void test_w_metrics_prometheus(void **state) {
+    w_metric_t * histogram = w_metrics_histogram("test_prometheus_us", "Latency");
+
+    w_metrics_record(histogram, 5);
+
+    char * text = w_metrics_prometheus();
+
+    assert_non_null(strstr(text, "# HELP test_prometheus_us Latency\n# TYPE test_prometheus_us summary\n"));
+    assert_non_null(strstr(text, "test_prometheus_us{quantile=\"0.99\"} 5\n"));
+    assert_non_null(strstr(text, "test_prometheus_us_sum 5\ntest_prometheus_us_count 1\n"));
+    assert_non_null(strstr(text, "# TYPE test_counter_total counter\ntest_counter_total 42\n"));
+
+    os_free(text);
+}
+
+static void test_w_metrics_getmetrics(void **state) {
+    char * output = NULL;
+
+    w_metrics_getmetrics(NULL, &output);
+    assert_non_null(strstr(output, "ok {"));
+    os_free(output);
+
+    w_metrics_getmetrics("prometheus", &output);
+    assert_non_null(strstr(output, "ok # HELP"));
+    os_free(output);
+
+    w_metrics_getmetrics("xml", &output);
+    assert_string_equal(output, "err Unrecognized metrics format");
+    os_free(output);
+}
+
+static void test_w_metrics_getmetrics_json(void **state) {
+    cJSON * parameters = cJSON_Parse("{\"format\":\"prometheus\"}");
+    cJSON * data = w_metrics_getmetrics_json(parameters);
+
+    assert_true(cJSON_IsString(cJSON_GetObjectItem(data, "prometheus")));
+    cJSON_Delete(data);
+    cJSON_Delete(parameters);
+
+    data = w_metrics_getmetrics_json(NULL);
+    assert_true(cJSON_IsNumber(cJSON_GetObjectItem(data, "test_counter_total")));
+    cJSON_Delete(data);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_w_metrics_counter),
+        cmocka_unit_test(test_w_metrics_gauge),
+        cmocka_unit_test(test_w_metrics_type_mismatch),
+        cmocka_unit_test(test_w_metrics_percentile),
+        cmocka_unit_test(test_w_metrics_record_large),
+        cmocka_unit_test(test_w_metrics_record_since),
+        cmocka_unit_test(test_w_metrics_json),
+        cmocka_unit_test(test_w_metrics_collector),
+        cmocka_unit_test(test_w_metrics_prometheus),
+        cmocka_unit_test(test_w_metrics_getmetrics),
+        cmocka_unit_test(test_w_metrics_getmetrics_json),
+        };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -36,6 +36,30 @@ int __wrap_OS_getsocketsize(int ossock) {
 
 void __wrap_sleep(unsigned int seconds) { };
 
+int __wrap_sendmmsg(int sockfd, struct mmsghdr *msgvec, unsigned int vlen, int flags) {
+    char buffer[OS_MAXSTR];
+
+    check_expected(vlen);
+
+    // Check the concatenation of the header and the message of each datagram
+    for (unsigned int i = 0; i < vlen; i++) {
+        struct iovec *iov = msgvec[i].msg_hdr.msg_iov;
+
+        assert_int_equal(msgvec[i].msg_hdr.msg_iovlen, 2);
+        memcpy(buffer, iov[0].iov_base, iov[0].iov_len);
+        memcpy(buffer + iov[0].iov_len, iov[1].iov_base, iov[1].iov_len);
+        check_expected(buffer);
+    }
+
+    int retval = mock_type(int);
+
+    if (retval < 0) {
+        errno = mock_type(int);
+    }
+
+    return retval;
+}
+
 bool ptr_function_value = false;
 
 bool ptr_function() {
@@ -422,6 +446,142 @@ void test_SendMSGAction_secure_msg_keepalive(void ** state){
     assert_int_equal(ret, 0);
 }
 
+void test_mq_batch_push_flush(void ** state){
+    (void)state;
+    mq_batch_t *batch = mq_batch_init(0);
+
+    assert_int_equal(mq_batch_push(batch, "first", "location", SYSLOG_MQ), 0);
+    assert_int_equal(mq_batch_push(batch, "second", "location", SYSLOG_MQ), 0);
+    assert_int_equal(mq_batch_push(batch, "third", "other", LOCALFILE_MQ), 0);
+    assert_int_equal(batch->count, 3);
+
+    // The header is copied once per location
+    assert_ptr_equal(batch->iov[0].iov_base, batch->iov[2].iov_base);
+    assert_ptr_not_equal(batch->iov[0].iov_base, batch->iov[4].iov_base);
+
+    expect_value(__wrap_sendmmsg, vlen, 3);
+    expect_string(__wrap_sendmmsg, buffer, "2:location:first");
+    expect_string(__wrap_sendmmsg, buffer, "2:location:second");
+    expect_string(__wrap_sendmmsg, buffer, "1:other:third");
+    will_return(__wrap_sendmmsg, 3);
+
+    assert_int_equal(mq_batch_flush(batch), 0);
+    assert_int_equal(batch->count, 0);
+    assert_int_equal(batch->used, 0);
+
+    mq_batch_free(batch);
+}
+
+void test_mq_batch_push_secure(void ** state){
+    (void)state;
+    mq_batch_t *batch = mq_batch_init(0);
+
+    assert_int_equal(mq_batch_push(batch, "4:keepalive", "location", SECURE_MQ), 0);
+    assert_int_equal(mq_batch_push(batch, "4:message", "location", SECURE_MQ), 0);
+    assert_int_equal(batch->count, 1);
+
+    expect_value(__wrap_sendmmsg, vlen, 1);
+    expect_string(__wrap_sendmmsg, buffer, "4:location->message");
+    will_return(__wrap_sendmmsg, 1);
+
+    assert_int_equal(mq_batch_flush(batch), 0);
+
+    mq_batch_free(batch);
+}
+
+void test_mq_batch_flush_partial(void ** state){
+    (void)state;
+    mq_batch_t *batch = mq_batch_init(0);
+
+    assert_int_equal(mq_batch_push(batch, "first", "location", SYSLOG_MQ), 0);
+    assert_int_equal(mq_batch_push(batch, "second", "location", SYSLOG_MQ), 0);
+
+    // The rest of the batch is sent again
+    expect_value(__wrap_sendmmsg, vlen, 2);
+    expect_string(__wrap_sendmmsg, buffer, "2:location:first");
+    expect_string(__wrap_sendmmsg, buffer, "2:location:second");
+    will_return(__wrap_sendmmsg, 1);
+
+    expect_value(__wrap_sendmmsg, vlen, 1);
+    expect_string(__wrap_sendmmsg, buffer, "2:location:second");
+    will_return(__wrap_sendmmsg, 1);
+
+    assert_int_equal(mq_batch_flush(batch), 0);
+
+    mq_batch_free(batch);
+}
+
+void test_mq_batch_flush_busy(void ** state){
+    (void)state;
+    mq_batch_t *batch = mq_batch_init(0);
+
+    assert_int_equal(mq_batch_push(batch, "first", "location", SYSLOG_MQ), 0);
+    assert_int_equal(mq_batch_push(batch, "second", "location", SYSLOG_MQ), 0);
+
+    // The first message is discarded
+    expect_value(__wrap_sendmmsg, vlen, 2);
+    expect_string(__wrap_sendmmsg, buffer, "2:location:first");
+    expect_string(__wrap_sendmmsg, buffer, "2:location:second");
+    will_return(__wrap_sendmmsg, -1);
+    will_return(__wrap_sendmmsg, ENOBUFS);
+
+    expect_string(__wrap__mdebug2, formatted_msg, "Socket busy, discarding message.");
+    expect_string(__wrap__mwarn, formatted_msg, "Socket busy, discarding message.");
+
+    expect_value(__wrap_sendmmsg, vlen, 1);
+    expect_string(__wrap_sendmmsg, buffer, "2:location:second");
+    will_return(__wrap_sendmmsg, 1);
+
+    assert_int_equal(mq_batch_flush(batch), 0);
+
+    mq_batch_free(batch);
+}
+
+void test_mq_batch_flush_socket_error(void ** state){
+    (void)state;
+    mq_batch_t *batch = mq_batch_init(-1);
+
+    assert_int_equal(mq_batch_push(batch, "first", "location", SYSLOG_MQ), 0);
+
+    // Queue not available
+    assert_int_equal(mq_batch_flush(batch), -1);
+
+    // The messages are kept until the queue is restored
+    batch->queue = 1000;
+
+    expect_value(__wrap_sendmmsg, vlen, 1);
+    expect_string(__wrap_sendmmsg, buffer, "2:location:first");
+    will_return(__wrap_sendmmsg, -1);
+    will_return(__wrap_sendmmsg, ENOTSOCK);
+
+    expect_string(__wrap__merror, formatted_msg, "socketerr (not available).");
+
+    assert_int_equal(mq_batch_flush(batch), -1);
+    assert_int_equal(batch->queue, -1);
+    assert_int_equal(batch->count, 1);
+
+    mq_batch_free(batch);
+}
+
+void test_mq_batch_push_full(void ** state){
+    (void)state;
+    mq_batch_t *batch = mq_batch_init(0);
+    int i;
+
+    for (i = 0; i < MQ_BATCH_MAX; i++) {
+        assert_int_equal(mq_batch_push(batch, "message", "location", SYSLOG_MQ), 0);
+    }
+
+    // A full batch is sent before queueing the next message
+    expect_value(__wrap_sendmmsg, vlen, MQ_BATCH_MAX);
+    expect_string_count(__wrap_sendmmsg, buffer, "2:location:message", MQ_BATCH_MAX);
+    will_return(__wrap_sendmmsg, MQ_BATCH_MAX);
+
+    assert_int_equal(mq_batch_push(batch, "last", "location", SYSLOG_MQ), 0);
+    assert_int_equal(batch->count, 1);
+
+    mq_batch_free(batch);
+}
 
 // Main test function
 
@@ -446,6 +606,12 @@ int main(void){
        cmocka_unit_test(test_SendMSGAction_non_secure_msg),
        cmocka_unit_test(test_SendMSGAction_secure_msg),
        cmocka_unit_test(test_SendMSGAction_secure_msg_keepalive),
+       cmocka_unit_test(test_mq_batch_push_flush),
+       cmocka_unit_test(test_mq_batch_push_secure),
+       cmocka_unit_test(test_mq_batch_flush_partial),
+       cmocka_unit_test(test_mq_batch_flush_busy),
+       cmocka_unit_test(test_mq_batch_flush_socket_error),
+       cmocka_unit_test(test_mq_batch_push_full),
        };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../headers/shared.h"
+
+static void test_w_cpuset_parse_list(void **state) {
+    w_cpuset_t * cpus = w_cpuset_parse("0-3, 8");
+
+    assert_non_null(cpus);
+
+    for (unsigned int cpu = 0; cpu < 4; cpu++) {
+        assert_true(w_cpuset_contains(cpus, cpu));
+    }
+
+    assert_false(w_cpuset_contains(cpus, 4));
+    assert_true(w_cpuset_contains(cpus, 8));
+    assert_false(w_cpuset_contains(cpus, 100000));
+
+    os_free(cpus);
+}
+
+static void test_w_cpuset_parse_single(void **state) {
+    w_cpuset_t * cpus = w_cpuset_parse("5");
+
+    assert_non_null(cpus);
+    assert_true(w_cpuset_contains(cpus, 5));
+    assert_false(w_cpuset_contains(cpus, 0));
+
+    os_free(cpus);
+}
+
+static void test_w_cpuset_parse_invalid(void **state) {
+    assert_null(w_cpuset_parse(""));
+    assert_null(w_cpuset_parse("3-1"));
+    assert_null(w_cpuset_parse("1-"));
+    assert_null(w_cpuset_parse("a"));
+    assert_null(w_cpuset_parse("2x"));
+    assert_null(w_cpuset_parse("nodex"));
+    assert_null(w_cpuset_parse("999999"));
+}
+
+static void test_w_set_thread_affinity_null(void **state) {
+    assert_int_equal(w_set_thread_affinity(NULL), 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_w_cpuset_parse_list),
+        cmocka_unit_test(test_w_cpuset_parse_single),
+        cmocka_unit_test(test_w_cpuset_parse_invalid),
+        cmocka_unit_test(test_w_set_thread_affinity_null),
+        };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -79,6 +79,11 @@ int __wrap_pthread_cond_signal(pthread_cond_t *cond) {
     return 0;
 }
 
+int __wrap_pthread_cond_broadcast(pthread_cond_t *cond) {
+    check_expected_ptr(cond);
+    return 0;
+}
+
 /****************TESTS***************************/
 void test_queue_full(void **state){
     w_queue_t *queue = *state;
@@ -284,6 +289,144 @@ void test_queue_pop_ex_timedwait_no_timeout(void **state) {
     assert_ptr_not_equal(ptr, NULL);
     os_free(ptr);
 }
+
+void test_queue_pop_ex_batch(void **state) {
+    w_queue_t *queue = *state;
+    void *data[QUEUE_SIZE];
+    int i;
+    int *ptr = NULL;
+    for (i=0; i < QUEUE_SIZE - 1; i++){
+        ptr = malloc(sizeof(int));
+        *ptr = i;
+        queue_push(queue, ptr);
+    }
+    // Pop part of the items with a single lock
+    expect_value_count(__wrap_pthread_mutex_lock, mutex,  &queue->mutex, 2);
+    expect_value_count(__wrap_pthread_mutex_unlock, mutex, &queue->mutex, 2);
+    expect_value_count(__wrap_pthread_cond_broadcast, cond, &queue->available_not_empty, 2);
+    assert_int_equal(queue_pop_ex_batch(queue, data, 3), 3);
+    for (i=0; i < 3; i++) {
+        assert_int_equal(*(int *)data[i], i);
+        os_free(data[i]);
+    }
+    // Only the remaining item is retrieved
+    assert_int_equal(queue_pop_ex_batch(queue, data, QUEUE_SIZE), 1);
+    assert_int_equal(*(int *)data[0], 3);
+    os_free(data[0]);
+    assert_int_equal(queue_empty(queue), 1);
+}
+
+void test_queue_pop_ex_batch_wait(void **state) {
+    w_queue_t *queue = *state;
+    void *data[QUEUE_SIZE];
+    // Should be empty until some push event
+    expect_value_count(__wrap_pthread_mutex_lock, mutex,  &queue->mutex, 2);
+    expect_value_count(__wrap_pthread_mutex_unlock, mutex, &queue->mutex, 2);
+    expect_value(__wrap_pthread_cond_wait, mutex, &queue->mutex);
+    expect_value(__wrap_pthread_cond_wait, cond, &queue->available);
+    expect_value(__wrap_pthread_cond_signal, cond, &queue->available);
+    expect_value(__wrap_pthread_cond_broadcast, cond, &queue->available_not_empty);
+    callback_ptr = callback_queue_push_ex;
+    assert_int_equal(queue_pop_ex_batch(queue, data, QUEUE_SIZE), 1);
+    assert_ptr_not_equal(data[0], NULL);
+    os_free(data[0]);
+}
+void test_queue_pop_ex_batch_wrap(void **state) {
+    w_queue_t *queue = *state;
+    void *data[QUEUE_SIZE];
+    int values[QUEUE_SIZE + 2];
+    int i;
+    // Leave the elements at the end of the buffer and at its beginning
+    for (i = 0; i < QUEUE_SIZE + 2; i++) {
+        values[i] = i;
+    }
+    for (i = 0; i < 3; i++) {
+        queue_push(queue, &values[i]);
+        queue_pop(queue);
+    }
+    for (i = 3; i < 7; i++) {
+        queue_push(queue, &values[i]);
+    }
+    expect_value(__wrap_pthread_mutex_lock, mutex,  &queue->mutex);
+    expect_value(__wrap_pthread_mutex_unlock, mutex, &queue->mutex);
+    expect_value(__wrap_pthread_cond_broadcast, cond, &queue->available_not_empty);
+    assert_int_equal(queue_pop_ex_batch(queue, data, QUEUE_SIZE), 4);
+    for (i = 0; i < 4; i++) {
+        assert_int_equal(*(int *)data[i], i + 3);
+    }
+    assert_int_equal(queue_empty(queue), 1);
+    assert_int_equal(queue->elements, 0);
+}
+
+void test_queue_push_ex_batch(void **state) {
+    w_queue_t *queue = *state;
+    int values[QUEUE_SIZE];
+    void *data[QUEUE_SIZE];
+    int i;
+    for (i = 0; i < QUEUE_SIZE; i++) {
+        values[i] = i;
+        data[i] = &values[i];
+    }
+    // Nobody is waiting: no signal
+    expect_value_count(__wrap_pthread_mutex_lock, mutex,  &queue->mutex, 2);
+    expect_value_count(__wrap_pthread_mutex_unlock, mutex, &queue->mutex, 2);
+    assert_int_equal(queue_push_ex_batch(queue, data, 2), 2);
+    // Only the free slots are filled
+    assert_int_equal(queue_push_ex_batch(queue, data + 2, 3), 2);
+    assert_int_equal(queue_full(queue), 1);
+    for (i = 0; i < QUEUE_SIZE - 1; i++) {
+        assert_int_equal(*(int *)queue_pop(queue), i);
+    }
+}
+
+void test_queue_push_ex_batch_waiting(void **state) {
+    w_queue_t *queue = *state;
+    int values[2] = { 0, 1 };
+    void *data[2] = { &values[0], &values[1] };
+    expect_value_count(__wrap_pthread_mutex_lock, mutex,  &queue->mutex, 2);
+    expect_value_count(__wrap_pthread_mutex_unlock, mutex, &queue->mutex, 2);
+    // Several consumers are woken up for several elements
+    queue->waiting = 2;
+    expect_value(__wrap_pthread_cond_broadcast, cond, &queue->available);
+    assert_int_equal(queue_push_ex_batch(queue, data, 2), 2);
+    // One is enough for one element
+    expect_value(__wrap_pthread_cond_signal, cond, &queue->available);
+    assert_int_equal(queue_push_ex_batch(queue, data, 1), 1);
+    queue->waiting = 0;
+}
+
+void test_queue_pop_ex_batch_timedwait_timeout(void **state) {
+    w_queue_t *queue = *state;
+    struct timespec abstime;
+    void *data[QUEUE_SIZE];
+    expect_value(__wrap_pthread_mutex_lock, mutex,  &queue->mutex);
+    expect_value(__wrap_pthread_mutex_unlock, mutex, &queue->mutex);
+    expect_value(__wrap_pthread_cond_timedwait, mutex, &queue->mutex);
+    expect_value(__wrap_pthread_cond_timedwait, cond, &queue->available);
+    expect_value(__wrap_pthread_cond_timedwait, abstime, &abstime);
+    will_return(__wrap_pthread_cond_timedwait, ETIMEDOUT);
+    assert_int_equal(queue_pop_ex_batch_timedwait(queue, data, QUEUE_SIZE, &abstime), 0);
+    assert_int_equal(queue->waiting, 0);
+}
+
+void test_queue_pop_ex_batch_timedwait_no_timeout(void **state) {
+    w_queue_t *queue = *state;
+    struct timespec abstime;
+    void *data[QUEUE_SIZE];
+    // Should be empty until some push event
+    expect_value_count(__wrap_pthread_mutex_lock, mutex,  &queue->mutex, 2);
+    expect_value_count(__wrap_pthread_mutex_unlock, mutex, &queue->mutex, 2);
+    expect_value(__wrap_pthread_cond_timedwait, mutex, &queue->mutex);
+    expect_value(__wrap_pthread_cond_timedwait, cond, &queue->available);
+    expect_value(__wrap_pthread_cond_timedwait, abstime, &abstime);
+    will_return(__wrap_pthread_cond_timedwait, 0);
+    expect_value(__wrap_pthread_cond_signal, cond, &queue->available);
+    expect_value(__wrap_pthread_cond_broadcast, cond, &queue->available_not_empty);
+    callback_ptr = callback_queue_push_ex;
+    assert_int_equal(queue_pop_ex_batch_timedwait(queue, data, QUEUE_SIZE, &abstime), 1);
+    assert_ptr_not_equal(data[0], NULL);
+    os_free(data[0]);
+}
 /************************************************/
 int main(void) {
     const struct CMUnitTest tests[] = {
@@ -296,6 +439,13 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_queue_pop_ex, setup_queue, teardown_queue),
         cmocka_unit_test_setup_teardown(test_queue_pop_ex_timedwait_timeout, setup_queue, teardown_queue),
         cmocka_unit_test_setup_teardown(test_queue_pop_ex_timedwait_no_timeout, setup_queue, teardown_queue),
+        cmocka_unit_test_setup_teardown(test_queue_pop_ex_batch, setup_queue, teardown_queue),
+        cmocka_unit_test_setup_teardown(test_queue_pop_ex_batch_wait, setup_queue, teardown_queue),
+        cmocka_unit_test_setup_teardown(test_queue_pop_ex_batch_wrap, setup_queue, teardown_queue),
+        cmocka_unit_test_setup_teardown(test_queue_push_ex_batch, setup_queue, teardown_queue),
+        cmocka_unit_test_setup_teardown(test_queue_push_ex_batch_waiting, setup_queue, teardown_queue),
+        cmocka_unit_test_setup_teardown(test_queue_pop_ex_batch_timedwait_timeout, setup_queue, teardown_queue),
+        cmocka_unit_test_setup_teardown(test_queue_pop_ex_batch_timedwait_no_timeout, setup_queue, teardown_queue),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
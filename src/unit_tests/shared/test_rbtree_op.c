@@ -621,6 +621,79 @@ void test_rbtree_empty_null_tree(void **state)
     expect_assert_failure(rbtree_empty(NULL));
 }
 
+void test_rbtree_iterate(void **state)
+{
+    rb_tree *tree = *state;
+    const char *keys[] = { "d_key", "b_key", "a_key", "e_key", "c_key" };
+    const char *sorted[] = { "a_key", "b_key", "c_key", "d_key", "e_key" };
+    unsigned i = 0;
+
+    assert_null(rbtree_first(tree));
+
+    for (unsigned j = 0; j < 5; j++) {
+        rbtree_insert(tree, keys[j], NULL);
+    }
+
+    for (const rb_node *node = rbtree_first(tree); node != NULL; node = rbtree_next(node)) {
+        assert_true(i < 5);
+        assert_string_equal(node->key, sorted[i++]);
+    }
+
+    assert_int_equal(i, 5);
+}
+
+void test_rbtree_lower_bound(void **state)
+{
+    rb_tree *tree = *state;
+
+    rbtree_insert(tree, "b_key", NULL);
+    rbtree_insert(tree, "d_key", NULL);
+    rbtree_insert(tree, "f_key", NULL);
+
+    assert_string_equal(rbtree_lower_bound(tree, "a")->key, "b_key");
+    assert_string_equal(rbtree_lower_bound(tree, "d_key")->key, "d_key");
+    assert_string_equal(rbtree_lower_bound(tree, "d_key0")->key, "f_key");
+    assert_string_equal(rbtree_next(rbtree_lower_bound(tree, "c"))->key, "f_key");
+    assert_null(rbtree_lower_bound(tree, "g"));
+}
+
+void test_rbtree_lower_bound_null_key(void **state)
+{
+    rb_tree *tree = *state;
+
+    expect_assert_failure(rbtree_lower_bound(tree, NULL));
+}
+
+void test_rbtree_delete_balance(void **state)
+{
+    rb_tree *tree = *state;
+    char key[16];
+    unsigned count = 0;
+
+    // Insert in a scrambled order, then delete every third key
+    for (unsigned i = 0; i < 300; i++) {
+        snprintf(key, sizeof(key), "%03u", (i * 7) % 300);
+        assert_non_null(rbtree_insert(tree, key, strdup(key)));
+    }
+
+    for (unsigned i = 0; i < 300; i += 3) {
+        snprintf(key, sizeof(key), "%03u", i);
+        assert_int_equal(rbtree_delete(tree, key), 1);
+        assert_true(rbtree_black_depth(tree) > 0);
+    }
+
+    assert_int_equal(rbtree_size(tree), 200);
+
+    for (const rb_node *node = rbtree_first(tree); node != NULL; node = rbtree_next(node)) {
+        snprintf(key, sizeof(key), "%03u", count + count / 2 + 1);
+        assert_string_equal(node->key, key);
+        assert_string_equal(node->value, key);
+        count++;
+    }
+
+    assert_int_equal(count, 200);
+}
+
 
 int main(void) {
     const struct CMUnitTest tests[] = {
@@ -685,6 +758,12 @@ int main(void) {
         /* rbtree_empty tests */
         cmocka_unit_test_setup_teardown(test_rbtree_empty, create_rbtree, delete_rbtree),
         cmocka_unit_test_setup_teardown(test_rbtree_empty_null_tree, create_rbtree, delete_rbtree),
+
+        /* rbtree iteration tests */
+        cmocka_unit_test_setup_teardown(test_rbtree_iterate, create_rbtree, delete_rbtree),
+        cmocka_unit_test_setup_teardown(test_rbtree_lower_bound, create_rbtree, delete_rbtree),
+        cmocka_unit_test_setup_teardown(test_rbtree_lower_bound_null_key, create_rbtree, delete_rbtree),
+        cmocka_unit_test_setup_teardown(test_rbtree_delete_balance, create_rbtree_with_dispose, delete_rbtree),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../headers/shared.h"
+
+static int setup_store(void **state) {
+    OSStore *store = OSStore_Create();
+
+    if (!store) {
+        return -1;
+    }
+
+    *state = store;
+    return 0;
+}
+
+static int teardown_store(void **state) {
+    OSStore_Free(*state);
+    return 0;
+}
+
+static void put_keys(OSStore *store, const char **keys) {
+    for (int i = 0; keys[i]; i++) {
+        assert_int_equal(OSStore_Put(store, keys[i], strdup(keys[i])), 1);
+    }
+}
+
+/* Order in which the list is traversed */
+static void assert_keys(OSStore *store, const char **keys) {
+    OSStoreNode *node = OSStore_GetFirstNode(store);
+    OSStoreNode *prev = NULL;
+    int i;
+
+    for (i = 0; keys[i]; i++) {
+        assert_non_null(node);
+        assert_string_equal(node->key, keys[i]);
+        assert_ptr_equal(node->prev, prev);
+        prev = node;
+        node = node->next;
+    }
+
+    assert_null(node);
+    assert_ptr_equal(store->last_node, prev);
+}
+
+void test_OSStore_Get(void **state) {
+    OSStore *store = *state;
+    const char *keys[] = { "sshd", "pam", "apache-errorlog", "windows", "sshd-success", NULL };
+
+    put_keys(store, keys);
+
+    for (int i = 0; keys[i]; i++) {
+        assert_string_equal(OSStore_Get(store, keys[i]), keys[i]);
+        assert_int_equal(OSStore_Check(store, keys[i]), 1);
+    }
+
+    assert_null(OSStore_Get(store, "ssh"));
+    assert_int_equal(OSStore_Check(store, "sshd-"), 0);
+    assert_int_equal(store->currently_size, 5);
+}
+
+void test_OSStore_Put_duplicate(void **state) {
+    OSStore *store = *state;
+    char *first = strdup("first");
+    char *second = strdup("second");
+
+    assert_int_equal(OSStore_Put(store, "key", first), 1);
+    assert_int_equal(OSStore_Put(store, "key", second), 1);
+
+    assert_ptr_equal(OSStore_Get(store, "key"), first);
+    assert_int_equal(store->currently_size, 1);
+
+    free(second);
+}
+
+void test_OSStore_GetPosition(void **state) {
+    OSStore *store = *state;
+    const char *keys[] = { "sshd", "pam", "apache-errorlog", "windows", NULL };
+    const char *sorted[] = { "apache-errorlog", "pam", "sshd", "windows", NULL };
+
+    put_keys(store, keys);
+
+    assert_int_equal(OSStore_GetPosition(store, "apache-errorlog"), 1);
+    assert_int_equal(OSStore_GetPosition(store, "pam"), 2);
+    assert_int_equal(OSStore_GetPosition(store, "sshd"), 3);
+    assert_int_equal(OSStore_GetPosition(store, "windows"), 4);
+    assert_int_equal(OSStore_GetPosition(store, "unknown"), 0);
+    assert_keys(store, sorted);
+
+    // Positions move after a lower key is added
+    assert_int_equal(OSStore_Put(store, "ossec", NULL), 1);
+    assert_int_equal(OSStore_GetPosition(store, "ossec"), 2);
+    assert_int_equal(OSStore_GetPosition(store, "windows"), 5);
+}
+
+void test_OSStore_NCheck(void **state) {
+    OSStore *store = *state;
+    const char *keys[] = { "/etc/", "/usr/bin/", "C:\\Windows\\", NULL };
+
+    put_keys(store, keys);
+
+    assert_int_equal(OSStore_NCheck(store, "/etc/passwd"), 1);
+    assert_int_equal(OSStore_NCheck(store, "/usr/bin/ls"), 1);
+    assert_int_equal(OSStore_NCheck(store, "/etc"), 0);
+    assert_int_equal(OSStore_NCheck(store, "/var/log/"), 0);
+    assert_int_equal(OSStore_NCheck(store, "c:\\windows\\system32"), 0);
+    assert_int_equal(OSStore_NCaseCheck(store, "c:\\windows\\system32"), 1);
+    assert_int_equal(OSStore_NCaseCheck(store, "/ETC/passwd"), 1);
+    assert_int_equal(OSStore_NCaseCheck(store, "/var/log/"), 0);
+}
+
+static void *sort_by_size(void *d1, void *d2) {
+    return strlen(d1) > strlen(d2) ? d1 : NULL;
+}
+
+void test_OSStore_Sort(void **state) {
+    OSStore *store = *state;
+    const char *keys[] = { "ccc", "a", "bbbb", "dd", NULL };
+    const char *sorted[] = { "bbbb", "ccc", "dd", "a", NULL };
+
+    put_keys(store, keys);
+
+    assert_int_equal(OSStore_Sort(store, sort_by_size), 1);
+    assert_keys(store, sorted);
+
+    // Lookups and positions don't depend on the order of the list
+    assert_string_equal(OSStore_Get(store, "dd"), "dd");
+    assert_int_equal(OSStore_GetPosition(store, "dd"), 4);
+    assert_keys(store, sorted);
+}
+
+void test_OSStore_many_keys(void **state) {
+    OSStore *store = *state;
+    char key[16];
+
+    for (int i = 999; i >= 0; i--) {
+        snprintf(key, sizeof(key), "key%03d", i);
+        assert_int_equal(OSStore_Put(store, key, NULL), 1);
+    }
+
+    assert_int_equal(store->currently_size, 1000);
+
+    for (int i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "key%03d", i);
+        assert_int_equal(OSStore_GetPosition(store, key), i + 1);
+    }
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_OSStore_Get, setup_store, teardown_store),
+        cmocka_unit_test_setup_teardown(test_OSStore_Put_duplicate, setup_store, teardown_store),
+        cmocka_unit_test_setup_teardown(test_OSStore_GetPosition, setup_store, teardown_store),
+        cmocka_unit_test_setup_teardown(test_OSStore_NCheck, setup_store, teardown_store),
+        cmocka_unit_test_setup_teardown(test_OSStore_Sort, setup_store, teardown_store),
+        cmocka_unit_test_setup_teardown(test_OSStore_many_keys, setup_store, teardown_store),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../../headers/shared.h"
+
+#define THREADS 4
+#define ROUNDS 1000
+
+/* setup/teardown */
+
+static int setup_pool(void ** state) {
+    *state = w_strpool_init();
+    return 0;
+}
+
+static int teardown_pool(void ** state) {
+    w_strpool_free(*state);
+    return 0;
+}
+
+/* tests */
+
+void test_w_strpool_get_same(void ** state) {
+    w_strpool_t * pool = *state;
+    char buffer[] = "agent-001";
+
+    char * a = w_strpool_get(pool, "agent-001");
+    char * b = w_strpool_get(pool, buffer);
+    char * c = w_strpool_get(pool, "agent-002");
+
+    assert_string_equal(a, "agent-001");
+    assert_ptr_equal(a, b);
+    assert_ptr_not_equal(a, c);
+    assert_int_equal(w_strpool_count(pool), 2);
+
+    w_strpool_release(pool, a);
+    w_strpool_release(pool, b);
+    w_strpool_release(pool, c);
+    assert_int_equal(w_strpool_count(pool), 0);
+}
+
+void test_w_strpool_getn(void ** state) {
+    w_strpool_t * pool = *state;
+
+    char * a = w_strpool_getn(pool, "agent) any", 5);
+    char * b = w_strpool_get(pool, "agent");
+    char * c = w_strpool_getn(pool, "agen", 4);
+
+    assert_string_equal(a, "agent");
+    assert_ptr_equal(a, b);
+    assert_string_equal(c, "agen");
+    assert_ptr_not_equal(a, c);
+
+    w_strpool_release(pool, a);
+    w_strpool_release(pool, b);
+    w_strpool_release(pool, c);
+}
+
+void test_w_strpool_ref_release(void ** state) {
+    w_strpool_t * pool = *state;
+
+    char * a = w_strpool_get(pool, "location");
+    char * b = w_strpool_ref(pool, a);
+
+    assert_ptr_equal(a, b);
+
+    w_strpool_release(pool, a);
+    assert_int_equal(w_strpool_count(pool), 1);
+    assert_string_equal(b, "location");
+
+    w_strpool_release(pool, b);
+    assert_int_equal(w_strpool_count(pool), 0);
+
+    assert_null(w_strpool_get(pool, NULL));
+    assert_null(w_strpool_ref(pool, NULL));
+    w_strpool_release(pool, NULL);
+}
+
+void test_w_strpool_grow(void ** state) {
+    w_strpool_t * pool = *state;
+    char * strings[ROUNDS];
+    char buffer[32];
+
+    for (int i = 0; i < ROUNDS; i++) {
+        snprintf(buffer, sizeof(buffer), "host-%d", i);
+        strings[i] = w_strpool_get(pool, buffer);
+    }
+
+    assert_int_equal(w_strpool_count(pool), ROUNDS);
+
+    for (int i = 0; i < ROUNDS; i++) {
+        snprintf(buffer, sizeof(buffer), "host-%d", i);
+        char * str = w_strpool_get(pool, buffer);
+
+        assert_ptr_equal(str, strings[i]);
+        w_strpool_release(pool, str);
+        w_strpool_release(pool, strings[i]);
+    }
+
+    assert_int_equal(w_strpool_count(pool), 0);
+}
+
+void test_w_strpool_no_pool(void ** state) {
+    char * a = w_strpool_get(NULL, "agent");
+    char * b = w_strpool_ref(NULL, a);
+    char * c = w_strpool_getn(NULL, "agent) any", 5);
+
+    assert_string_equal(a, "agent");
+    assert_string_equal(b, "agent");
+    assert_string_equal(c, "agent");
+    assert_ptr_not_equal(a, b);
+
+    w_strpool_release(NULL, a);
+    w_strpool_release(NULL, b);
+    w_strpool_release(NULL, c);
+}
+
+static void * strpool_worker(void * arg) {
+    w_strpool_t * pool = arg;
+    char buffer[32];
+
+    for (int i = 0; i < ROUNDS; i++) {
+        snprintf(buffer, sizeof(buffer), "host-%d", i % 16);
+        char * a = w_strpool_get(pool, buffer);
+        char * b = w_strpool_ref(pool, a);
+
+        if (strcmp(a, buffer) != 0) {
+            return (void *)1;
+        }
+
+        w_strpool_release(pool, a);
+        w_strpool_release(pool, b);
+    }
+
+    return NULL;
+}
+
+void test_w_strpool_threads(void ** state) {
+    w_strpool_t * pool = *state;
+    pthread_t threads[THREADS];
+
+    for (int i = 0; i < THREADS; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, strpool_worker, pool), 0);
+    }
+
+    for (int i = 0; i < THREADS; i++) {
+        void * result;
+        pthread_join(threads[i], &result);
+        assert_null(result);
+    }
+
+    assert_int_equal(w_strpool_count(pool), 0);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_w_strpool_get_same, setup_pool, teardown_pool),
+        cmocka_unit_test_setup_teardown(test_w_strpool_getn, setup_pool, teardown_pool),
+        cmocka_unit_test_setup_teardown(test_w_strpool_ref_release, setup_pool, teardown_pool),
+        cmocka_unit_test_setup_teardown(test_w_strpool_grow, setup_pool, teardown_pool),
+        cmocka_unit_test(test_w_strpool_no_pool),
+        cmocka_unit_test_setup_teardown(test_w_strpool_threads, setup_pool, teardown_pool),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
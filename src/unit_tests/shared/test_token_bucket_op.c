@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../headers/shared.h"
+#include "../wrappers/wazuh/shared/time_op_wrappers.h"
+
+#define SEC 1000000000LL
+
+static void test_w_token_bucket_take_unlimited(void **state) {
+    w_token_bucket_t bucket = W_TOKEN_BUCKET_INITIALIZER;
+
+    assert_int_equal(w_token_bucket_take(&bucket, 0, 0), 0);
+    assert_int_equal(bucket.tat, 0);
+}
+
+static void test_w_token_bucket_take_burst(void **state) {
+    w_token_bucket_t bucket = W_TOKEN_BUCKET_INITIALIZER;
+
+    // 10 tokens per second, 2 in a row
+    will_return_count(__wrap_gettime, 100, 3);
+
+    assert_int_equal(w_token_bucket_take(&bucket, 10, 2), 0);
+    assert_int_equal(w_token_bucket_take(&bucket, 10, 2), 0);
+    assert_int_equal(w_token_bucket_take(&bucket, 10, 2), SEC / 10);
+    assert_int_equal(bucket.tat, 100 * SEC + 3 * (SEC / 10));
+}
+
+static void test_w_token_bucket_take_refill(void **state) {
+    w_token_bucket_t bucket = { .tat = 105 * SEC };
+
+    // A bucket idle for a while is full again, but it does not keep the unused tokens
+    will_return(__wrap_gettime, 200);
+
+    assert_int_equal(w_token_bucket_take(&bucket, 1, 1), 0);
+    assert_int_equal(bucket.tat, 201 * SEC);
+}
+
+static void test_w_token_bucket_take_debt(void **state) {
+    w_token_bucket_t bucket = { .tat = 105 * SEC };
+
+    will_return(__wrap_gettime, 100);
+
+    assert_int_equal(w_token_bucket_take(&bucket, 1, 1), 5 * SEC);
+    assert_int_equal(bucket.tat, 106 * SEC);
+}
+
+static void test_w_token_bucket_take_clock_backwards(void **state) {
+    w_token_bucket_t bucket = { .tat = 1000 * SEC };
+
+    will_return(__wrap_gettime, 100);
+
+    assert_int_equal(w_token_bucket_take(&bucket, 1, 1), 0);
+    assert_int_equal(bucket.tat, 101 * SEC);
+}
+
+static void test_w_token_bucket_wait(void **state) {
+    w_token_bucket_t bucket = W_TOKEN_BUCKET_INITIALIZER;
+
+    will_return_count(__wrap_gettime, 100, 2);
+
+    assert_false(w_token_bucket_wait(&bucket, 1, 1));
+    assert_true(w_token_bucket_wait(&bucket, 1, 1));
+}
+
+static void test_w_token_bucket_wait_sub_millisecond(void **state) {
+    w_token_bucket_t bucket = W_TOKEN_BUCKET_INITIALIZER;
+
+    // The delay of a single token at 10k tokens per second is too short to sleep for
+    will_return_count(__wrap_gettime, 100, 2);
+
+    assert_false(w_token_bucket_wait(&bucket, 10000, 1));
+    assert_false(w_token_bucket_wait(&bucket, 10000, 1));
+    assert_int_equal(bucket.tat, 100 * SEC + 2 * (SEC / 10000));
+}
+
+static void test_w_token_bucket_burst(void **state) {
+    assert_int_equal(W_TOKEN_BUCKET_BURST(0), 1);
+    assert_int_equal(W_TOKEN_BUCKET_BURST(9), 1);
+    assert_int_equal(W_TOKEN_BUCKET_BURST(500), 50);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_w_token_bucket_take_unlimited),
+        cmocka_unit_test(test_w_token_bucket_take_burst),
+        cmocka_unit_test(test_w_token_bucket_take_refill),
+        cmocka_unit_test(test_w_token_bucket_take_debt),
+        cmocka_unit_test(test_w_token_bucket_take_clock_backwards),
+        cmocka_unit_test(test_w_token_bucket_wait),
+        cmocka_unit_test(test_w_token_bucket_wait_sub_millisecond),
+        cmocka_unit_test(test_w_token_bucket_burst),
+        };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -1048,6 +1048,100 @@ void OS_IPFoundList_valid_ipv6(void **state)
     free(ret_ip);
 }
 
+void OS_IPTreeBuild_negated(void **state)
+{
+    os_ip **ret_ip;
+    os_calloc(2, sizeof(os_ip *), ret_ip);
+    os_calloc(1, sizeof(os_ip), ret_ip[0]);
+
+    os_strdup("!16.16.16.16", (*ret_ip[0]).ip);
+    os_calloc(1, sizeof(os_ipv4), (*ret_ip[0]).ipv4);
+
+    (*ret_ip[0]).ipv4->ip_address = 0x10101010;
+    (*ret_ip[0]).ipv4->netmask = 0xFFFFFFFF;
+
+    assert_null(OS_IPTreeBuild(ret_ip));
+    assert_null(OS_IPTreeBuild(NULL));
+
+    w_free_os_ip(ret_ip[0]);
+    free(ret_ip);
+}
+
+void OS_IPFoundTree_valid_ipv4(void **state)
+{
+    os_iptree *tree;
+    uint32_t address;
+    os_ip **ret_ip;
+    os_calloc(3, sizeof(os_ip *), ret_ip);
+    os_calloc(1, sizeof(os_ip), ret_ip[0]);
+    os_calloc(1, sizeof(os_ip), ret_ip[1]);
+
+    os_strdup("10.0.0.0/8", (*ret_ip[0]).ip);
+    os_calloc(1, sizeof(os_ipv4), (*ret_ip[0]).ipv4);
+
+    (*ret_ip[0]).ipv4->ip_address = htonl(0x0A000000);
+    (*ret_ip[0]).ipv4->netmask = htonl(0xFF000000);
+
+    os_strdup("192.168.1.1", (*ret_ip[1]).ip);
+    os_calloc(1, sizeof(os_ipv4), (*ret_ip[1]).ipv4);
+
+    (*ret_ip[1]).ipv4->ip_address = htonl(0xC0A80101);
+    (*ret_ip[1]).ipv4->netmask = 0xFFFFFFFF;
+
+    tree = OS_IPTreeBuild(ret_ip);
+    assert_non_null(tree);
+
+    address = htonl(0x0A010203);
+    assert_int_equal(OS_IPFoundTree(tree, &address, false), 1);
+
+    address = htonl(0xC0A80101);
+    assert_int_equal(OS_IPFoundTree(tree, &address, false), 1);
+
+    address = htonl(0xC0A80102);
+    assert_int_equal(OS_IPFoundTree(tree, &address, false), 0);
+
+    address = htonl(0x0B000000);
+    assert_int_equal(OS_IPFoundTree(tree, &address, false), 0);
+
+    OS_IPTreeFree(tree);
+    w_free_os_ip(ret_ip[0]);
+    w_free_os_ip(ret_ip[1]);
+    free(ret_ip);
+}
+
+void OS_IPFoundTree_valid_ipv6(void **state)
+{
+    os_iptree *tree;
+    uint8_t address[16];
+    os_ip **ret_ip;
+    os_calloc(2, sizeof(os_ip *), ret_ip);
+    os_calloc(1, sizeof(os_ip), ret_ip[0]);
+
+    os_strdup("2020:2020::/32", (*ret_ip[0]).ip);
+    os_calloc(1, sizeof(os_ipv6), (*ret_ip[0]).ipv6);
+
+    for(unsigned int a = 0; a < 4; a++) {
+        (*ret_ip[0]).ipv6->ip_address[a] = 0x20;
+        (*ret_ip[0]).ipv6->netmask[a] = 0xFF;
+    }
+
+    tree = OS_IPTreeBuild(ret_ip);
+    assert_non_null(tree);
+
+    memset(address, 0x20, sizeof(address));
+    assert_int_equal(OS_IPFoundTree(tree, address, true), 1);
+
+    address[3] = 0x21;
+    assert_int_equal(OS_IPFoundTree(tree, address, true), 0);
+
+    // The IPv4 tree is empty
+    assert_int_equal(OS_IPFoundTree(tree, address, false), 0);
+
+    OS_IPTreeFree(tree);
+    w_free_os_ip(ret_ip[0]);
+    free(ret_ip);
+}
+
 void OS_CIDRtoStr_any(void **state)
 {
     char ip_to_test[IPSIZE] = {0};
@@ -1351,6 +1445,10 @@ int main(void) {
         cmocka_unit_test(OS_IPFoundList_valid_ipv4_not_found),
         cmocka_unit_test(OS_IPFoundList_valid_ipv6_fail),
         cmocka_unit_test(OS_IPFoundList_valid_ipv6),
+        // Test OS_IPTreeBuild and OS_IPFoundTree
+        cmocka_unit_test(OS_IPTreeBuild_negated),
+        cmocka_unit_test(OS_IPFoundTree_valid_ipv4),
+        cmocka_unit_test(OS_IPFoundTree_valid_ipv6),
         // Test OS_CIDRtoStr
         cmocka_unit_test(OS_CIDRtoStr_any),
         cmocka_unit_test(OS_CIDRtoStr_valid_ipv4),
@@ -719,6 +719,73 @@ static void test_fim_registry_scan_base_line_generation(void **state) {
     assert_int_equal(_base_line, 1);
 }
 
+static void test_fim_registry_scan_ignored_value(void **state) {
+    syscheck.registry = one_entry_config;
+    syscheck.registry[0].opts = CHECK_REGISTRY_ALL;
+
+    registry_ignore value_ignore[] = {
+        { "HKEY_LOCAL_MACHINE\\Software\\Classes\\batfile\\FirstSubKey\\ignored_value", ARCH_64BIT },
+        { NULL, 0 }
+    };
+    syscheck.value_ignore = value_ignore;
+
+    // Set values of FirstSubKey
+    char *value_name = "test_value";
+    unsigned int value_type = REG_DWORD;
+    unsigned int value_size = 4;
+    DWORD value_data = 123456;
+    DWORD ignored_data = 42;
+    TXN_HANDLE mock_handle;
+
+    LPSTR usid = "userid";
+    LPSTR gsid = "groupid";
+    FILETIME last_write_time = { 0, 1000 };
+
+    will_return(__wrap_fim_db_transaction_start, mock_handle);
+    will_return(__wrap_fim_db_transaction_start, mock_handle);
+    expect_string(__wrap__mdebug1, formatted_msg, FIM_WINREGISTRY_START);
+    expect_any_always(__wrap__mdebug2, formatted_msg);
+
+    // Scan a subkey of batfile
+    expect_RegOpenKeyEx_call(HKEY_LOCAL_MACHINE, "Software\\Classes\\batfile", 0, KEY_READ | KEY_WOW64_64KEY, NULL,
+                             ERROR_SUCCESS);
+    expect_RegQueryInfoKey_call(1, 0, &last_write_time, ERROR_SUCCESS);
+    expect_RegEnumKeyEx_call("FirstSubKey", 12, ERROR_SUCCESS);
+
+    // Scan the values of FirstSubKey, the first one is ignored
+    expect_RegOpenKeyEx_call(HKEY_LOCAL_MACHINE, "Software\\Classes\\batfile\\FirstSubKey", 0,
+                             KEY_READ | KEY_WOW64_64KEY, NULL, ERROR_SUCCESS);
+    expect_RegQueryInfoKey_call(0, 2, &last_write_time, ERROR_SUCCESS);
+
+    // Inside fim_registry_get_key_data
+    expect_fim_registry_get_key_data_call(usid, gsid, "username", "groupname",
+                                          "sid (allowed): delete|write_dac|write_data|append_data|write_attributes",
+                                          last_write_time);
+    will_return(__wrap_fim_db_transaction_sync_row, 0);
+    expect_RegEnumValue_call("ignored_value", value_type, (LPBYTE)&ignored_data, value_size, ERROR_SUCCESS);
+    expect_RegEnumValue_call(value_name, value_type, (LPBYTE)&value_data, value_size, ERROR_SUCCESS);
+
+    expect_fim_registry_value_diff("HKEY_LOCAL_MACHINE\\Software\\Classes\\batfile\\FirstSubKey", "test_value",
+                                   (const char *)&value_data, 4, REG_DWORD, NULL);
+    will_return(__wrap_fim_db_transaction_sync_row, 0);
+
+    // Inside fim_registry_get_key_data
+    expect_fim_registry_get_key_data_call(usid, gsid, "username", "groupname",
+                                          "sid (allowed): delete|write_dac|write_data|append_data|write_attributes",
+                                          last_write_time);
+
+    will_return(__wrap_fim_db_transaction_sync_row, 0);
+
+    expect_function_call(__wrap_fim_db_transaction_deleted_rows);
+    expect_function_call(__wrap_fim_db_transaction_deleted_rows);
+    expect_string(__wrap__mdebug1, formatted_msg, FIM_WINREGISTRY_ENDED);
+
+    // Test
+    fim_registry_scan();
+
+    syscheck.value_ignore = NULL;
+}
+
 static void test_fim_registry_scan_regular_scan(void **state) {
     syscheck.registry = default_config;
 
@@ -1157,6 +1224,7 @@ int main(void) {
 
         /* fim_registry_scan tests */
         cmocka_unit_test(test_fim_registry_scan_base_line_generation),
+        cmocka_unit_test(test_fim_registry_scan_ignored_value),
         cmocka_unit_test(test_fim_registry_scan_regular_scan),
         cmocka_unit_test(test_fim_registry_scan_RegOpenKeyEx_fail),
         cmocka_unit_test(test_fim_registry_scan_RegQueryInfoKey_fail),
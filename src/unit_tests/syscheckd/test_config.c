@@ -140,12 +140,20 @@ void test_Read_Syscheck_Config_success(void **state)
     assert_int_equal(syscheck.sync_interval, 600);
     assert_int_equal(syscheck.sync_queue_size, 16384);
     assert_int_equal(syscheck.sync_thread_pool, 1);
+    assert_int_equal(syscheck.scan_threads, 1);
+    assert_int_equal(syscheck.fast_rescan, 0);
+    assert_int_equal(syscheck.fast_rescan_full_verify, 10);
+    assert_int_equal(syscheck.inode_index, 0);
+    assert_int_equal(syscheck.memory_snapshot, 0);
+    assert_int_equal(syscheck.usn_journal, 0);
+    assert_int_equal(syscheck.usn_full_verify, 10);
     assert_int_equal(syscheck.max_eps, 200);
     assert_int_equal(syscheck.disk_quota_enabled, true);
     assert_int_equal(syscheck.disk_quota_limit, 1024 * 1024);
     assert_int_equal(syscheck.file_size_enabled, true);
     assert_int_equal(syscheck.file_size_limit, 50 * 1024);
     assert_int_equal(syscheck.diff_folder_size, 0);
+    assert_int_equal(syscheck.diff_chunked, 0);
     assert_int_equal(syscheck.file_limit_enabled, 1);
     assert_int_equal(syscheck.file_entry_limit, 50000);
 #ifdef WIN32
@@ -210,12 +218,20 @@ void test_Read_Syscheck_Config_undefined(void **state)
     assert_int_equal(syscheck.sync_interval, 600);
     assert_int_equal(syscheck.sync_queue_size, 16384);
     assert_int_equal(syscheck.sync_thread_pool, 1);
+    assert_int_equal(syscheck.scan_threads, 1);
+    assert_int_equal(syscheck.fast_rescan, 0);
+    assert_int_equal(syscheck.fast_rescan_full_verify, 10);
+    assert_int_equal(syscheck.inode_index, 0);
+    assert_int_equal(syscheck.memory_snapshot, 0);
+    assert_int_equal(syscheck.usn_journal, 0);
+    assert_int_equal(syscheck.usn_full_verify, 10);
     assert_int_equal(syscheck.max_eps, 200);
     assert_int_equal(syscheck.disk_quota_enabled, true);
     assert_int_equal(syscheck.disk_quota_limit, 2 * 1024 * 1024);
     assert_int_equal(syscheck.file_size_enabled, true);
     assert_int_equal(syscheck.file_size_limit, 5);
     assert_int_equal(syscheck.diff_folder_size, 0);
+    assert_int_equal(syscheck.diff_chunked, 0);
     assert_int_equal(syscheck.file_limit_enabled, 1);
     assert_int_equal(syscheck.file_entry_limit, 50000);
 #ifdef WIN32
@@ -265,12 +281,20 @@ void test_Read_Syscheck_Config_unparsed(void **state)
     assert_int_equal(syscheck.sync_interval, 300);
     assert_int_equal(syscheck.sync_queue_size, 16384);
     assert_int_equal(syscheck.sync_thread_pool, 1);
+    assert_int_equal(syscheck.scan_threads, 1);
+    assert_int_equal(syscheck.fast_rescan, 0);
+    assert_int_equal(syscheck.fast_rescan_full_verify, 10);
+    assert_int_equal(syscheck.inode_index, 0);
+    assert_int_equal(syscheck.memory_snapshot, 0);
+    assert_int_equal(syscheck.usn_journal, 0);
+    assert_int_equal(syscheck.usn_full_verify, 10);
     assert_int_equal(syscheck.max_eps, 50);
     assert_int_equal(syscheck.disk_quota_enabled, true);
     assert_int_equal(syscheck.disk_quota_limit, 1024 * 1024);
     assert_int_equal(syscheck.file_size_enabled, true);
     assert_int_equal(syscheck.file_size_limit, 50 * 1024);
     assert_int_equal(syscheck.diff_folder_size, 0);
+    assert_int_equal(syscheck.diff_chunked, 0);
 }
 
 void test_getSyscheckConfig(void **state)
@@ -298,9 +322,9 @@ void test_getSyscheckConfig(void **state)
 
     cJSON *sys_items = cJSON_GetObjectItem(ret, "syscheck");
     #if defined(TEST_SERVER) || defined(TEST_AGENT)
-    assert_int_equal(cJSON_GetArraySize(sys_items), 21);
+    assert_int_equal(cJSON_GetArraySize(sys_items), 25);
     #elif defined(TEST_WINAGENT)
-    assert_int_equal(cJSON_GetArraySize(sys_items), 29);
+    assert_int_equal(cJSON_GetArraySize(sys_items), 35);
     #endif
 
     cJSON *disabled = cJSON_GetObjectItem(sys_items, "disabled");
@@ -434,9 +458,9 @@ void test_getSyscheckConfig_no_audit(void **state)
 
     cJSON *sys_items = cJSON_GetObjectItem(ret, "syscheck");
     #ifndef TEST_WINAGENT
-    assert_int_equal(cJSON_GetArraySize(sys_items), 17);
-    #else
     assert_int_equal(cJSON_GetArraySize(sys_items), 21);
+    #else
+    assert_int_equal(cJSON_GetArraySize(sys_items), 27);
     #endif
 
     cJSON *disabled = cJSON_GetObjectItem(sys_items, "disabled");
@@ -561,7 +585,7 @@ void test_getSyscheckConfig_no_directories(void **state)
     assert_int_equal(cJSON_GetArraySize(ret), 1);
 
     cJSON *sys_items = cJSON_GetObjectItem(ret, "syscheck");
-    assert_int_equal(cJSON_GetArraySize(sys_items), 18);
+    assert_int_equal(cJSON_GetArraySize(sys_items), 24);
     cJSON *disabled = cJSON_GetObjectItem(sys_items, "disabled");
     assert_string_equal(cJSON_GetStringValue(disabled), "yes");
     cJSON *frequency = cJSON_GetObjectItem(sys_items, "frequency");
@@ -675,7 +699,11 @@ void test_getSyscheckInternalOptions(void **state)
     cJSON *items = cJSON_GetObjectItem(ret, "internal");
     assert_int_equal(cJSON_GetArraySize(items), 2);
     cJSON *sys_items = cJSON_GetObjectItem(items, "syscheck");
+#ifndef TEST_WINAGENT
+    assert_int_equal(cJSON_GetArraySize(sys_items), 9);
+#else
     assert_int_equal(cJSON_GetArraySize(sys_items), 6);
+#endif
     cJSON *root_items = cJSON_GetObjectItem(items, "rootcheck");
     assert_int_equal(cJSON_GetArraySize(root_items), 1);
 }
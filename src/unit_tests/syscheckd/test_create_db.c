@@ -48,6 +48,7 @@ cJSON * fim_calculate_dbsync_difference(const fim_file_data *data, const cJSON*
                                         cJSON* changed_attributes);
 void create_windows_who_data_events(void * data, void * ctx);
 void fim_db_remove_entry(void * data, void * ctx);
+void fim_db_remove_prefix_entry(void * data, void * ctx);
 void process_delete_event(void * data, void * ctx);
 void fim_db_process_missing_entry(void * data, void * ctx);
 void dbsync_attributes_json(const cJSON *dbsync_event, const directory_t *configuration, cJSON *attributes);
@@ -1692,6 +1693,53 @@ static void test_fim_checker_deleted_file_enoent(void **state) {
     ((directory_t *)OSList_GetDataFromIndex(syscheck.directories, 3))->options &= ~CHECK_SEECHANGES;
 }
 
+static void test_fim_journal_event_no_configuration(void **state) {
+    expect_function_call_any(__wrap_pthread_rwlock_rdlock);
+    expect_function_call_any(__wrap_pthread_rwlock_unlock);
+
+    expect_string(__wrap__mdebug2, formatted_msg, "(6319): No configuration found for (file):'/test'");
+
+    fim_journal_event("/test", true);
+}
+
+static void test_fim_journal_event_directory_changed(void **state) {
+    struct stat statbuf = { .st_mode = S_IFDIR };
+    const char *path = "/media/test";
+
+    expect_function_call_any(__wrap_pthread_rwlock_rdlock);
+    expect_function_call_any(__wrap_pthread_rwlock_unlock);
+
+    // The directory isn't walked, its entries are journaled on their own
+    expect_string(__wrap_lstat, filename, path);
+    will_return(__wrap_lstat, &statbuf);
+    will_return(__wrap_lstat, 0);
+
+    fim_journal_event(path, false);
+}
+
+static void test_fim_journal_event_deleted(void **state) {
+    struct stat statbuf = DEFAULT_STATBUF;
+    const char *path = "/media/test.file";
+
+    expect_function_call_any(__wrap_pthread_rwlock_rdlock);
+    expect_function_call_any(__wrap_pthread_rwlock_unlock);
+    expect_function_call_any(__wrap_pthread_mutex_lock);
+    expect_function_call_any(__wrap_pthread_mutex_unlock);
+
+    expect_string(__wrap_lstat, filename, path);
+    will_return(__wrap_lstat, &statbuf);
+    will_return(__wrap_lstat, -1);
+    errno = ENOENT;
+
+    // Scheduled deletions are reported right away, there is no transaction
+    expect_fim_db_get_path(path, FIMDB_OK);
+    expect_fim_db_remove_path_prefix("/media/test.file/", FIMDB_OK);
+
+    fim_journal_event(path, false);
+
+    errno = 0;
+}
+
 static void test_fim_checker_no_file_system(void **state) {
     event_data_t evt_data = { .mode = FIM_REALTIME, .w_evt = NULL, .report_event = true };
     struct stat statbuf = DEFAULT_STATBUF;
@@ -3468,8 +3516,8 @@ void test_fim_process_missing_entry(void **state){
     fim_data->w_evt->path = strdup("/etc/test.txt");
 #endif
 
-    char pattern[PATH_MAX] = {0};
-    snprintf(pattern, PATH_MAX, "%s%c%%", fim_data->w_evt->path, PATH_SEP);
+    char prefix[PATH_MAX] = {0};
+    snprintf(prefix, PATH_MAX, "%s%c", fim_data->w_evt->path, PATH_SEP);
 
 #ifndef TEST_WINAGENT
     expect_function_call_any(__wrap_pthread_rwlock_wrlock);
@@ -3487,8 +3535,7 @@ void test_fim_process_missing_entry(void **state){
 
     expect_string(__wrap_fim_db_get_path, file_path, fim_data->w_evt->path);
     will_return(__wrap_fim_db_get_path, FIMDB_ERR);
-    expect_string(__wrap_fim_db_file_pattern_search, pattern, pattern);
-    will_return(__wrap_fim_db_file_pattern_search, FIMDB_OK);
+    expect_fim_db_remove_path_prefix(prefix, FIMDB_OK);
 
     fim_process_missing_entry(fim_data->w_evt->path, FIM_SCHEDULED, fim_data->w_evt);
 }
@@ -3501,9 +3548,8 @@ static void test_fim_process_wildcard_removed_no_data(void **state) {
     directory_t *directory0 = OSList_GetFirstNode(removed_entries)->data;
 
     char buff[OS_SIZE_128] = {0};
-    snprintf(buff, OS_SIZE_128, "%s%c%%", directory0->path, PATH_SEP);
-    expect_string(__wrap_fim_db_file_pattern_search, pattern, buff);
-    will_return(__wrap_fim_db_file_pattern_search, FIMDB_OK);
+    snprintf(buff, OS_SIZE_128, "%s%c", directory0->path, PATH_SEP);
+    expect_fim_db_remove_path_prefix(buff, FIMDB_OK);
 
     expect_string(__wrap_fim_db_get_path, file_path, directory0->path);
     will_return(__wrap_fim_db_get_path, NULL);
@@ -3523,9 +3569,8 @@ static void test_fim_process_wildcard_removed_failure(void **state) {
 
     char buff[OS_SIZE_128] = {0};
 
-    snprintf(buff, OS_SIZE_128, "%s%c%%", directory0->path, PATH_SEP);
-    expect_string(__wrap_fim_db_file_pattern_search, pattern, buff);
-    will_return(__wrap_fim_db_file_pattern_search, FIMDB_OK);
+    snprintf(buff, OS_SIZE_128, "%s%c", directory0->path, PATH_SEP);
+    expect_fim_db_remove_path_prefix(buff, FIMDB_OK);
     expect_string(__wrap_fim_db_get_path, file_path, directory0->path);
     will_return(__wrap_fim_db_get_path, NULL);
 
@@ -3563,10 +3608,9 @@ static void test_fim_process_wildcard_removed_data_exists(void **state) {
     fim_data->local_data->scanned = 123456;
     fim_data->local_data->options = 511;
     strcpy(fim_data->local_data->checksum, "");
-    char pattern[100];
-    snprintf(pattern, PATH_MAX, "%s%c%%", directory0->path, PATH_SEP);
-    expect_string(__wrap_fim_db_file_pattern_search, pattern, pattern);
-    will_return(__wrap_fim_db_file_pattern_search, FIMDB_OK);
+    char prefix[100];
+    snprintf(prefix, 100, "%s%c", directory0->path, PATH_SEP);
+    expect_fim_db_remove_path_prefix(prefix, FIMDB_OK);
     expect_string(__wrap_fim_db_get_path, file_path, directory0->path);
     will_return(__wrap_fim_db_get_path, fim_data->fentry);
 
@@ -3647,15 +3691,15 @@ static void test_update_wildcards_config_remove_config() {
     char wildcard2[20] = "/*/path";
     char resolvedpath1[20] = "/testdir1";
     char resolvedpath2[20] = "/testdir2";
-    char pattern1[20] = "/testdir1/%";
-    char pattern2[20] = "/testdir2/%";
+    char prefix1[20] = "/testdir1/";
+    char prefix2[20] = "/testdir2/";
 #else
     char wildcard1[20] = "c:\\testdir?";
     char wildcard2[20] = "c:\\*\\path";
     char resolvedpath1[20] = "c:\\testdir1";
     char resolvedpath2[20] = "c:\\testdir2";
-    char pattern1[20] = "c:\\testdir1\\%";
-    char pattern2[20] = "c:\\testdir2\\%";
+    char prefix1[20] = "c:\\testdir1\\";
+    char prefix2[20] = "c:\\testdir2\\";
 #endif
 
     char error_msg[OS_MAXSTR];
@@ -3691,11 +3735,9 @@ static void test_update_wildcards_config_remove_config() {
     expect_string(__wrap_fim_db_get_path, file_path, resolvedpath1);
     will_return(__wrap_fim_db_get_path, NULL);
 
-    expect_string(__wrap_fim_db_file_pattern_search, pattern, pattern2);
-    will_return(__wrap_fim_db_file_pattern_search, 0);
+    expect_fim_db_remove_path_prefix(prefix2, 0);
 
-    expect_string(__wrap_fim_db_file_pattern_search, pattern, pattern1);
-    will_return(__wrap_fim_db_file_pattern_search, 0);
+    expect_fim_db_remove_path_prefix(prefix1, 0);
     update_wildcards_config();
 
     // Empty config
@@ -4221,6 +4263,33 @@ void test_fim_db_remove_entry(void **state){
     fim_db_remove_entry(path, &get_data);
 }
 
+void test_fim_db_remove_prefix_entry(void **state){
+    fim_data_t* fim_data = (fim_data_t*) *state;
+    directory_t config = { .options = CHECK_SEECHANGES, .tag = NULL };
+    event_data_t evt = { .mode = FIM_SCHEDULED, .w_evt = NULL, .report_event = true, .type = FIM_DELETE };
+    get_data_ctx get_data = { .event = &evt, .config = &config };
+    fim_data->fentry->file_entry.path = "/testdir1/file";
+
+    // The entry isn't removed one by one, the whole prefix is deleted by fim_db_remove_path_prefix.
+    expect_string(__wrap_fim_diff_process_delete_file, filename, fim_data->fentry->file_entry.path);
+    will_return(__wrap_fim_diff_process_delete_file, 0);
+    expect_function_call(__wrap_send_syscheck_msg);
+
+    fim_db_remove_prefix_entry(fim_data->fentry, &get_data);
+    fim_data->fentry->file_entry.path = NULL;
+}
+
+void test_fim_db_remove_prefix_entry_no_report(void **state){
+    fim_data_t* fim_data = (fim_data_t*) *state;
+    directory_t config = { .options = 0, .tag = NULL };
+    event_data_t evt = { .mode = FIM_SCHEDULED, .w_evt = NULL, .report_event = false, .type = FIM_DELETE };
+    get_data_ctx get_data = { .event = &evt, .config = &config };
+    fim_data->fentry->file_entry.path = "/testdir1/file";
+
+    fim_db_remove_prefix_entry(fim_data->fentry, &get_data);
+    fim_data->fentry->file_entry.path = NULL;
+}
+
 void test_fim_db_process_missing_entry(void **state){
     fim_data_t* fim_data = (fim_data_t*) *state;
     fim_data->fentry->file_entry.path = "mock_path";
@@ -4379,6 +4448,11 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_fim_checker_deleted_file_enoent, setup_fim_entry, teardown_fim_entry),
 #ifndef TEST_WINAGENT
         cmocka_unit_test(test_fim_checker_no_file_system),
+
+        /* fim_journal_event */
+        cmocka_unit_test(test_fim_journal_event_no_configuration),
+        cmocka_unit_test(test_fim_journal_event_directory_changed),
+        cmocka_unit_test(test_fim_journal_event_deleted),
 #endif
         cmocka_unit_test(test_fim_checker_fim_regular),
         cmocka_unit_test(test_fim_checker_fim_regular_warning),
@@ -4445,6 +4519,8 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_create_windows_who_data_events, setup_fim_data, teardown_fim_data),
         cmocka_unit_test_setup_teardown(test_process_delete_event, setup_fim_entry, teardown_fim_entry),
         cmocka_unit_test_setup_teardown(test_fim_db_remove_entry, setup_fim_entry, teardown_fim_entry),
+        cmocka_unit_test_setup_teardown(test_fim_db_remove_prefix_entry, setup_fim_entry, teardown_fim_entry),
+        cmocka_unit_test_setup_teardown(test_fim_db_remove_prefix_entry_no_report, setup_fim_entry, teardown_fim_entry),
         cmocka_unit_test_setup_teardown(test_fim_db_process_missing_entry, setup_fim_entry, teardown_fim_entry),
 
         /* dbsync_attributes_json */
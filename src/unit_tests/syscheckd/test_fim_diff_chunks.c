@@ -0,0 +1,295 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "../syscheckd/include/syscheck.h"
+#include "../config/syscheck-config.h"
+
+/* The chunks are stored in a real folder, the versions are compared with the diff command. */
+
+char *fim_diff_shift_lines(const char *diff_str, unsigned int offset);
+
+typedef struct chunks_state {
+    char folder[PATH_MAX];
+    char old_copy[PATH_MAX];
+    diff_data diff;
+} chunks_state;
+
+static void write_lines(const char *path, unsigned int first, unsigned int last, const char *changed, unsigned int line) {
+    FILE *fp = fopen(path, "w");
+    assert_non_null(fp);
+
+    for (unsigned int i = first; i <= last; i++) {
+        if (changed && i == line) {
+            fprintf(fp, "%s\n", changed);
+        } else {
+            fprintf(fp, "Line number %u of the monitored file\n", i);
+        }
+    }
+
+    fclose(fp);
+}
+
+static char *expected_diff(const char *old_path, const char *new_path) {
+    char command[PATH_MAX * 3];
+    char buffer[OS_MAXSTR + 1];
+    size_t length;
+    FILE *fp;
+
+    snprintf(command, sizeof(command), "diff \"%s\" \"%s\"", old_path, new_path);
+    fp = popen(command, "r");
+    assert_non_null(fp);
+    length = fread(buffer, 1, sizeof(buffer) - 1, fp);
+    pclose(fp);
+    buffer[length] = '\0';
+
+    return strdup(buffer);
+}
+
+static void copy_file(const char *source, const char *destination) {
+    char command[PATH_MAX * 3];
+
+    snprintf(command, sizeof(command), "cp \"%s\" \"%s\"", source, destination);
+    assert_int_equal(system(command), 0);
+}
+
+static int count_lines(const char *path) {
+    char line[OS_SIZE_256];
+    int lines = 0;
+    FILE *fp = fopen(path, "r");
+
+    if (!fp) {
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        lines++;
+    }
+
+    fclose(fp);
+    return lines;
+}
+
+static int setup_chunks(void **state) {
+    chunks_state *data = calloc(1, sizeof(chunks_state));
+    char buffer[PATH_MAX];
+
+    strcpy(data->folder, "/tmp/fim_diff_chunks_XXXXXX");
+    if (!mkdtemp(data->folder)) {
+        free(data);
+        return -1;
+    }
+
+    snprintf(buffer, PATH_MAX, "%s/file/store", data->folder);
+    os_strdup(buffer, data->diff.compress_folder);
+    mkdir_ex(data->diff.compress_folder);
+    snprintf(buffer, PATH_MAX, "%s/last-entry.gz", data->diff.compress_folder);
+    os_strdup(buffer, data->diff.compress_file);
+    snprintf(buffer, PATH_MAX, "%s/tmp", data->folder);
+    os_strdup(buffer, data->diff.tmp_folder);
+    mkdir_ex(data->diff.tmp_folder);
+    snprintf(buffer, PATH_MAX, "%s/monitored", data->folder);
+    os_strdup(buffer, data->diff.file_origin);
+    snprintf(buffer, PATH_MAX, "%s/tmp-entry", data->diff.tmp_folder);
+    os_strdup(buffer, data->diff.uncompress_file);
+    snprintf(buffer, PATH_MAX, "%s/diff-file", data->diff.tmp_folder);
+    os_strdup(buffer, data->diff.diff_file);
+    snprintf(data->old_copy, PATH_MAX, "%s/old-copy", data->folder);
+
+    syscheck.disk_quota_enabled = true;
+    syscheck.disk_quota_limit = 1024 * 1024;
+    syscheck.disk_quota_full_msg = true;
+    syscheck.diff_folder_size = 0;
+    syscheck.nodiff = NULL;
+    syscheck.nodiff_regex = NULL;
+
+    *state = data;
+    return 0;
+}
+
+static int teardown_chunks(void **state) {
+    chunks_state *data = *state;
+
+    rmdir_ex(data->folder);
+    os_free(data->diff.compress_folder);
+    os_free(data->diff.compress_file);
+    os_free(data->diff.tmp_folder);
+    os_free(data->diff.file_origin);
+    os_free(data->diff.uncompress_file);
+    os_free(data->diff.diff_file);
+    free(data);
+
+    return 0;
+}
+
+static char *list_path(const chunks_state *data, char *buffer) {
+    snprintf(buffer, PATH_MAX, "%s/chunks.list", data->diff.compress_folder);
+    return buffer;
+}
+
+/* Tests */
+
+static void test_fim_diff_shift_lines(void **state) {
+    char *shifted = fim_diff_shift_lines("3c3\n< a\n---\n> b\n5,7d4\n< 1\n< 2\n< 3\n8a6\n> 42\n", 10);
+
+    assert_string_equal(shifted, "13c13\n< a\n---\n> b\n15,17d14\n< 1\n< 2\n< 3\n18a16\n> 42\n");
+    free(shifted);
+}
+
+static void test_fim_diff_chunked_file_first_version(void **state) {
+    chunks_state *data = *state;
+    char path[PATH_MAX];
+
+    write_lines(data->diff.file_origin, 1, 20000, NULL, 0);
+
+    assert_null(fim_diff_chunked_file(&data->diff));
+
+    // The file is cut in several chunks, all of them stored.
+    assert_true(count_lines(list_path(data, path)) > 1);
+    assert_true(syscheck.diff_folder_size > 0);
+}
+
+static void test_fim_diff_chunked_file_identical(void **state) {
+    chunks_state *data = *state;
+    char path[PATH_MAX];
+    float folder_size;
+
+    write_lines(data->diff.file_origin, 1, 20000, NULL, 0);
+    assert_null(fim_diff_chunked_file(&data->diff));
+    folder_size = syscheck.diff_folder_size;
+
+    expect_string(__wrap__mdebug2, formatted_msg, FIM_DIFF_IDENTICAL_MD5_FILES);
+
+    assert_null(fim_diff_chunked_file(&data->diff));
+    assert_true(count_lines(list_path(data, path)) > 1);
+    assert_true(syscheck.diff_folder_size == folder_size);
+}
+
+static void test_fim_diff_chunked_file_changed_line(void **state) {
+    chunks_state *data = *state;
+    char *expected;
+    char *diff_str;
+
+    write_lines(data->diff.file_origin, 1, 20000, NULL, 0);
+    copy_file(data->diff.file_origin, data->old_copy);
+    assert_null(fim_diff_chunked_file(&data->diff));
+
+    write_lines(data->diff.file_origin, 1, 20000, "Changed line", 12345);
+    expected = expected_diff(data->old_copy, data->diff.file_origin);
+
+    diff_str = fim_diff_chunked_file(&data->diff);
+
+    // Only the chunk holding the line is compared, the line numbers are the ones of the whole file.
+    assert_non_null(diff_str);
+    assert_string_equal(diff_str, expected);
+    assert_non_null(strstr(diff_str, "12345c12345"));
+
+    free(expected);
+    free(diff_str);
+}
+
+static void test_fim_diff_chunked_file_inserted_and_removed_lines(void **state) {
+    chunks_state *data = *state;
+    char *expected;
+    char *diff_str;
+
+    write_lines(data->diff.file_origin, 1, 20000, NULL, 0);
+    assert_null(fim_diff_chunked_file(&data->diff));
+    copy_file(data->diff.file_origin, data->old_copy);
+
+    // Lines removed at the start shift every chunk that follows.
+    write_lines(data->diff.file_origin, 100, 20010, NULL, 0);
+    expected = expected_diff(data->old_copy, data->diff.file_origin);
+
+    diff_str = fim_diff_chunked_file(&data->diff);
+
+    assert_non_null(diff_str);
+    assert_string_equal(diff_str, expected);
+
+    free(expected);
+    free(diff_str);
+
+    // The next change is compared against the version just stored.
+    copy_file(data->diff.file_origin, data->old_copy);
+    write_lines(data->diff.file_origin, 100, 20010, "Changed line", 20010);
+    expected = expected_diff(data->old_copy, data->diff.file_origin);
+
+    diff_str = fim_diff_chunked_file(&data->diff);
+
+    assert_non_null(diff_str);
+    assert_string_equal(diff_str, expected);
+
+    free(expected);
+    free(diff_str);
+}
+
+static void test_fim_diff_chunked_file_legacy_copy(void **state) {
+    chunks_state *data = *state;
+    char path[PATH_MAX];
+    char *expected;
+    char *diff_str;
+
+    write_lines(data->old_copy, 1, 3000, NULL, 0);
+    assert_int_equal(w_compress_gzfile(data->old_copy, data->diff.compress_file), 0);
+    write_lines(data->diff.file_origin, 1, 3001, NULL, 0);
+    expected = expected_diff(data->old_copy, data->diff.file_origin);
+
+    diff_str = fim_diff_chunked_file(&data->diff);
+
+    // The whole copy is replaced by the chunks.
+    assert_non_null(diff_str);
+    assert_string_equal(diff_str, expected);
+    assert_int_equal(IsFile(data->diff.compress_file), -1);
+    assert_true(count_lines(list_path(data, path)) > 0);
+
+    free(expected);
+    free(diff_str);
+}
+
+static void test_fim_diff_chunked_file_quota_reached(void **state) {
+    chunks_state *data = *state;
+    char path[PATH_MAX];
+    char message[OS_SIZE_1024];
+    int chunks;
+
+    write_lines(data->diff.file_origin, 1, 20000, NULL, 0);
+    assert_null(fim_diff_chunked_file(&data->diff));
+    chunks = count_lines(list_path(data, path));
+
+    write_lines(data->diff.file_origin, 20001, 60000, NULL, 0);
+    syscheck.disk_quota_limit = (int)syscheck.diff_folder_size + 1;
+
+    snprintf(message, OS_SIZE_1024, FIM_DISK_QUOTA_LIMIT_REACHED, "calculate", data->diff.file_origin);
+    expect_string(__wrap__mdebug2, formatted_msg, message);
+
+    // The new version doesn't fit, the stored one is kept.
+    assert_null(fim_diff_chunked_file(&data->diff));
+    assert_int_equal(count_lines(list_path(data, path)), chunks);
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test(test_fim_diff_shift_lines),
+        cmocka_unit_test_setup_teardown(test_fim_diff_chunked_file_first_version, setup_chunks, teardown_chunks),
+        cmocka_unit_test_setup_teardown(test_fim_diff_chunked_file_identical, setup_chunks, teardown_chunks),
+        cmocka_unit_test_setup_teardown(test_fim_diff_chunked_file_changed_line, setup_chunks, teardown_chunks),
+        cmocka_unit_test_setup_teardown(test_fim_diff_chunked_file_inserted_and_removed_lines, setup_chunks, teardown_chunks),
+        cmocka_unit_test_setup_teardown(test_fim_diff_chunked_file_legacy_copy, setup_chunks, teardown_chunks),
+        cmocka_unit_test_setup_teardown(test_fim_diff_chunked_file_quota_reached, setup_chunks, teardown_chunks),
+    };
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -60,8 +60,8 @@ void fim_realtime_delete_watches(const directory_t *configuration);
 
 void fim_db_remove_validated_path(void * data, void * ctx);
 
-extern time_t last_time;
-extern unsigned int files_read;
+extern w_token_bucket_t fps_bucket;
+extern w_token_bucket_t sync_eps_bucket;
 
 /* redefinitons/wrapping */
 
@@ -248,6 +248,7 @@ static void expect_w_send_sync_msg(const char *msg, const char *locmsg, char loc
 
 static int setup_max_fps(void **state) {
     syscheck.max_files_per_second = 1;
+    fps_bucket.tat = 0;
     return 0;
 }
 
@@ -832,8 +833,8 @@ void test_fim_link_update(void **state) {
 
     expect_string(__wrap_remove_audit_rule_syscheck, path, affected_config->symbolic_links);
 
-    snprintf(pattern, PATH_MAX, "%s%c%%", affected_config->symbolic_links, PATH_SEP);
-    expect_fim_db_file_pattern_search(pattern, 0);
+    snprintf(pattern, PATH_MAX, "%s%c", affected_config->symbolic_links, PATH_SEP);
+    expect_fim_db_file_prefix_search(pattern, 0);
 
     expect_fim_checker_call(new_path, affected_config);
     expect_realtime_adddir_call(new_path, 0);
@@ -881,8 +882,8 @@ void test_fim_link_check_delete(void **state) {
 
     expect_string(__wrap_remove_audit_rule_syscheck, path, affected_config->symbolic_links);
 
-    snprintf(pattern, PATH_MAX, "%s%c%%", affected_config->symbolic_links, PATH_SEP);
-    expect_fim_db_file_pattern_search(pattern, 0);
+    snprintf(pattern, PATH_MAX, "%s%c", affected_config->symbolic_links, PATH_SEP);
+    expect_fim_db_file_prefix_search(pattern, 0);
 
     expect_fim_configuration_directory_call("data", NULL);
     fim_link_check_delete(affected_config);
@@ -962,8 +963,8 @@ void test_fim_link_delete_range(void **state) {
     expect_function_call_any(__wrap_pthread_mutex_lock);
     expect_function_call_any(__wrap_pthread_mutex_unlock);
 
-    snprintf(pattern, PATH_MAX, "%s%c%%", "/folder", PATH_SEP);
-    expect_fim_db_file_pattern_search(pattern, 0);
+    snprintf(pattern, PATH_MAX, "%s%c", "/folder", PATH_SEP);
+    expect_fim_db_file_prefix_search(pattern, 0);
 
     fim_link_delete_range(((directory_t *)OSList_GetDataFromIndex(syscheck.directories, 1)));
 }
@@ -1026,21 +1027,25 @@ void test_fim_link_reload_broken_link_reload_broken(void **state) {
 #endif
 
 void test_check_max_fps_no_sleep(void **state) {
-    expect_function_call(__wrap_pthread_mutex_lock);
-    expect_function_call(__wrap_pthread_mutex_unlock);
-    will_return(__wrap_gettime, last_time + 1);
+    will_return(__wrap_gettime, 10);
+    check_max_fps();
 
+    // The bucket refills within the next second
+    will_return(__wrap_gettime, 11);
     check_max_fps();
 }
 
 void test_check_max_fps_sleep(void **state) {
-    expect_function_call(__wrap_pthread_mutex_lock);
-    expect_function_call(__wrap_pthread_mutex_unlock);
-    last_time = 10;
-    files_read = syscheck.max_files_per_second;
-
-    will_return(__wrap_gettime, last_time);
+    will_return_count(__wrap_gettime, 10, 2);
     expect_string(__wrap__mdebug2, formatted_msg, FIM_REACHED_MAX_FPS);
+
+    check_max_fps();
+    check_max_fps();
+}
+
+void test_check_max_fps_unlimited(void **state) {
+    syscheck.max_files_per_second = 0;
+
     check_max_fps();
 }
 
@@ -1050,18 +1055,22 @@ void test_send_sync_state(void **state) {
 
     snprintf(debug_msg, OS_SIZE_256, FIM_DBSYNC_SEND, event);
     syscheck.sync_max_eps = 1;
+    sync_eps_bucket.tat = 0;
 
-    expect_function_call(__wrap_pthread_mutex_lock);
     expect_w_send_sync_msg(event, "fim_file", DBSYNC_MQ, fim_shutdown_process_on, 0);
-#ifdef TEST_WINAGENT
-    expect_value(wrap_Sleep, dwMilliseconds, 1 * 1000);
-#else
-    expect_value(__wrap_sleep, seconds, 1);
-#endif
     expect_string(__wrap__mdebug2, formatted_msg, debug_msg);
-    expect_function_call(__wrap_pthread_mutex_unlock);
+    will_return(__wrap_gettime, 10);
 
     fim_send_sync_state("fim_file", event);
+
+    // The second message in the same second has to wait for the bucket
+    expect_w_send_sync_msg(event, "fim_file", DBSYNC_MQ, fim_shutdown_process_on, 0);
+    expect_string(__wrap__mdebug2, formatted_msg, debug_msg);
+    will_return(__wrap_gettime, 10);
+
+    fim_send_sync_state("fim_file", event);
+
+    assert_int_equal(sync_eps_bucket.tat, 12 * 1000000000LL);
 }
 
 void test_send_sync_state_without_max_eps(void **state) {
@@ -1108,6 +1117,7 @@ int main(void) {
         cmocka_unit_test(test_fim_send_scan_info),
         cmocka_unit_test_setup_teardown(test_check_max_fps_no_sleep, setup_max_fps, teardown_max_fps),
         cmocka_unit_test_setup_teardown(test_check_max_fps_sleep, setup_max_fps, teardown_max_fps),
+        cmocka_unit_test_setup_teardown(test_check_max_fps_unlimited, setup_max_fps, teardown_max_fps),
 #ifndef TEST_WINAGENT
         cmocka_unit_test(test_fim_run_realtime_first_error),
         cmocka_unit_test(test_fim_run_realtime_first_timeout),
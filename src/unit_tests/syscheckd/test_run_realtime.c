@@ -15,12 +15,14 @@
 #include <string.h>
 #ifndef TEST_WINAGENT
 #include <sys/inotify.h>
+#include <sys/fanotify.h>
 #endif
 
 #include "../wrappers/common.h"
 #include "../wrappers/posix/pthread_wrappers.h"
 #include "../wrappers/posix/unistd_wrappers.h"
 #include "../wrappers/linux/inotify_wrappers.h"
+#include "../wrappers/linux/fanotify_wrappers.h"
 #include "../wrappers/wazuh/shared/debug_op_wrappers.h"
 #include "../wrappers/wazuh/shared/fs_op_wrappers.h"
 #include "../wrappers/wazuh/shared/hash_op_wrappers.h"
@@ -395,6 +397,69 @@ void test_realtime_start_failure_inotify(void **state) {
     assert_int_equal(ret, -1);
 }
 
+#if defined(FAN_REPORT_FID) && defined(FAN_MARK_FILESYSTEM)
+void test_realtime_start_fanotify(void **state) {
+    OSHash *hash = *state;
+    int ret;
+
+    syscheck.rt_fanotify = 1;
+
+    expect_function_call(__wrap_OSHash_Create);
+    will_return(__wrap_OSHash_Create, hash);
+
+    expect_function_call(__wrap_OSHash_SetFreeDataPointer);
+    will_return(__wrap_OSHash_SetFreeDataPointer, 0);
+
+    will_return(__wrap_fanotify_init, 5);
+
+    // Mount descriptors table
+    expect_function_call(__wrap_OSHash_Create);
+    will_return(__wrap_OSHash_Create, hash);
+
+    expect_function_call(__wrap_OSHash_SetFreeDataPointer);
+    will_return(__wrap_OSHash_SetFreeDataPointer, 0);
+
+    ret = realtime_start();
+
+    syscheck.rt_fanotify = 0;
+    assert_int_equal(ret, 0);
+    assert_int_equal(syscheck.realtime->fd, 5);
+    assert_true(syscheck.realtime->fanotify);
+}
+
+void test_realtime_start_fanotify_failure(void **state) {
+    OSHash *hash = *state;
+    int ret;
+
+    syscheck.rt_fanotify = 1;
+
+    expect_function_call(__wrap_OSHash_Create);
+    will_return(__wrap_OSHash_Create, hash);
+
+    expect_function_call(__wrap_OSHash_SetFreeDataPointer);
+    will_return(__wrap_OSHash_SetFreeDataPointer, 0);
+
+#ifdef FAN_REPORT_DFID_NAME
+    will_return(__wrap_fanotify_init, -1);
+#endif
+    will_return(__wrap_fanotify_init, -1);
+
+    errno = EPERM;
+    expect_string(__wrap__mwarn, formatted_msg,
+        "(6956): Unable to initialize fanotify (1): 'Operation not permitted'. Using inotify for real-time monitoring.");
+
+    will_return(__wrap_inotify_init, 3);
+
+    ret = realtime_start();
+
+    syscheck.rt_fanotify = 0;
+    errno = 0;
+    assert_int_equal(ret, 0);
+    assert_int_equal(syscheck.realtime->fd, 3);
+    assert_false(syscheck.realtime->fanotify);
+}
+#endif
+
 void test_realtime_adddir_realtime_start_failure(void **state) {
     int ret;
     directory_t config = { .options = REALTIME_ACTIVE };
@@ -869,6 +934,127 @@ void test_realtime_process_failure(void **state)
     realtime_process();
 }
 
+static int teardown_realtime_pending(void **state) {
+    if (syscheck.realtime->pending) {
+        rbtree_destroy(syscheck.realtime->pending);
+        syscheck.realtime->pending = NULL;
+    }
+
+    syscheck.realtime->pending_full = false;
+    syscheck.realtime->pending_peak = 0;
+    syscheck.realtime->coalesced = 0;
+    syscheck.rt_coalesce_window = 0;
+    syscheck.rt_coalesce_max = 0;
+
+    return teardown_inotify_event(state);
+}
+
+void test_realtime_process_coalesce(void **state) {
+    struct inotify_event *event = *state;
+    event->wd = 1;
+    event->mask = 2;
+    event->cookie = 0;
+    event->len = 5;
+    strcpy(event->name, "test");
+
+    syscheck.realtime->fd = 1;
+    syscheck.rt_coalesce_window = 10000;
+    syscheck.rt_coalesce_max = 100;
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    will_return(__wrap_read, event);
+    will_return(__wrap_read, 21);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_value(__wrap_OSHash_Get_ex, self, syscheck.realtime->dirtb);
+    expect_string(__wrap_OSHash_Get_ex, key, "1");
+    will_return(__wrap_OSHash_Get_ex, "test");
+
+    expect_string(__wrap__mdebug2, formatted_msg, "Duplicate event in real-time buffer: test/test");
+
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    char **paths = NULL;
+    paths = os_AddStrArray("/test", paths);
+
+    will_return(__wrap_rbtree_keys, paths);
+
+    // The path is added to the pending events, and the window hasn't ended yet
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    test_mode = 1;
+    realtime_process();
+    test_mode = 0;
+
+    assert_non_null(syscheck.realtime->pending);
+    // The rbtree_insert wrapper simulates the path was already pending
+    assert_int_equal(syscheck.realtime->coalesced, 1);
+}
+
+void test_realtime_pending_wait(void **state) {
+    syscheck.rt_coalesce_window = 10000;
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    assert_int_equal(realtime_pending_wait(), -1);
+
+    syscheck.realtime->pending = rbtree_init();
+    gettime(&syscheck.realtime->pending_since);
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    long wait = realtime_pending_wait();
+    assert_true(wait > 0 && wait <= 10000);
+
+    syscheck.realtime->pending_full = true;
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    assert_int_equal(realtime_pending_wait(), 0);
+}
+
+void test_realtime_flush_pending_not_due(void **state) {
+    syscheck.rt_coalesce_window = 10000;
+    syscheck.realtime->pending = rbtree_init();
+    gettime(&syscheck.realtime->pending_since);
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    realtime_flush_pending(false);
+
+    assert_non_null(syscheck.realtime->pending);
+}
+
+void test_realtime_flush_pending_force(void **state) {
+    syscheck.rt_coalesce_window = 10000;
+    syscheck.realtime->pending = rbtree_init();
+    gettime(&syscheck.realtime->pending_since);
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    char **paths = NULL;
+    paths = os_AddStrArray("/test", paths);
+
+    will_return(__wrap_rbtree_keys, paths);
+
+    expect_function_call(__wrap_pthread_rwlock_rdlock);
+    expect_string(__wrap_fim_realtime_event, file, "/test");
+    expect_function_call(__wrap_pthread_rwlock_unlock);
+
+    realtime_flush_pending(true);
+
+    assert_null(syscheck.realtime->pending);
+}
+
 void test_delete_subdirectories_watches_realtime_fd_null(void **state) {
     (void) state;
     char *dir = "/test";
@@ -1934,6 +2120,10 @@ int main(void) {
 
 #if defined(TEST_SERVER) || defined(TEST_AGENT)
         cmocka_unit_test_setup_teardown(test_realtime_start_failure_inotify, setup_realtime_start, teardown_realtime_start),
+#if defined(FAN_REPORT_FID) && defined(FAN_MARK_FILESYSTEM)
+        cmocka_unit_test_setup_teardown(test_realtime_start_fanotify, setup_realtime_start, teardown_realtime_start),
+        cmocka_unit_test_setup_teardown(test_realtime_start_fanotify_failure, setup_realtime_start, teardown_realtime_start),
+#endif
 
         /* realtime_adddir */
         cmocka_unit_test_setup_teardown(test_realtime_adddir_realtime_start_failure, setup_realtime_adddir_realtime_start_error, teardown_realtime_adddir_realtime_start_error),
@@ -1954,6 +2144,10 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_realtime_process_delete, setup_inotify_event, teardown_inotify_event),
         cmocka_unit_test_setup_teardown(test_realtime_process_move_self, setup_realtime_process, teardown_realtime_process),
         cmocka_unit_test(test_realtime_process_failure),
+        cmocka_unit_test_setup_teardown(test_realtime_process_coalesce, setup_inotify_event, teardown_realtime_pending),
+        cmocka_unit_test_setup_teardown(test_realtime_pending_wait, setup_inotify_event, teardown_realtime_pending),
+        cmocka_unit_test_setup_teardown(test_realtime_flush_pending_not_due, setup_inotify_event, teardown_realtime_pending),
+        cmocka_unit_test_setup_teardown(test_realtime_flush_pending_force, setup_inotify_event, teardown_realtime_pending),
 
         /* delete_subdirectories_watches */
         cmocka_unit_test_setup_teardown(test_delete_subdirectories_watches_realtime_fd_null, setup_hash_node, teardown_hash_node),
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../wrappers/wazuh/shared/time_op_wrappers.h"
+#include "../wrappers/posix/pthread_wrappers.h"
+#include "../../syscheckd/include/syscheck.h"
+#include "../../config/syscheck-config.h"
+
+#define SEC 1000000000LL
+
+/* setup/teardown */
+
+static int setup_group(void **state) {
+    expect_function_call_any(__wrap_pthread_rwlock_rdlock);
+    expect_function_call_any(__wrap_pthread_rwlock_unlock);
+
+    syscheck.directories = OSList_Create();
+    if (syscheck.directories == NULL) {
+        return -1;
+    }
+
+    OSList_InsertData(syscheck.directories, NULL, fim_create_directory("/etc", 0, NULL, 256, NULL, -1, 0));
+
+    return 0;
+}
+
+static int teardown_group(void **state) {
+    OSListNode *node_it;
+
+    OSList_foreach(node_it, syscheck.directories) {
+        free_directory(node_it->data);
+        node_it->data = NULL;
+    }
+
+    OSList_Destroy(syscheck.directories);
+    syscheck.directories = NULL;
+
+    return 0;
+}
+
+static int setup_stats(void **state) {
+    fim_scan_stats_t *stats;
+
+    os_calloc(1, sizeof(fim_scan_stats_t), stats);
+    *state = stats;
+
+    return 0;
+}
+
+static int teardown_stats(void **state) {
+    fim_scan_stats_t *stats = *state;
+
+    fim_scan_stats_reset(stats);
+    os_free(stats);
+
+    return 0;
+}
+
+static int teardown_json(void **state) {
+    cJSON_Delete(*state);
+
+    return 0;
+}
+
+/* tests */
+
+static void test_fim_scan_stats_add(void **state) {
+    fim_scan_stats_t *stats = *state;
+
+    fim_scan_stats_add(stats, FIM_STATS_FILES, 1);
+    fim_scan_stats_add(stats, FIM_STATS_FILES, 2);
+    fim_scan_stats_add(stats, FIM_STATS_SKIPPED_IGNORE, 5);
+
+    assert_int_equal(stats->counters[FIM_STATS_FILES], 3);
+    assert_int_equal(stats->counters[FIM_STATS_SKIPPED_IGNORE], 5);
+    assert_int_equal(stats->counters[FIM_STATS_SKIPPED_RESTRICT], 0);
+}
+
+static void test_fim_scan_stats_add_null(void **state) {
+    // Events that are not part of a scheduled scan are not counted.
+    fim_scan_stats_add(NULL, FIM_STATS_FILES, 1);
+    fim_scan_stats_add_time(NULL, FIM_STATS_STAT_TIME, 0);
+    fim_scan_stats_hashed(NULL, "/etc/passwd", 100, SEC);
+    fim_scan_stats_reset(NULL);
+}
+
+static void test_fim_scan_stats_add_time(void **state) {
+    fim_scan_stats_t *stats = *state;
+
+    will_return(__wrap_gettime, 12);
+    fim_scan_stats_add_time(stats, FIM_STATS_DB_TIME, 10 * SEC);
+
+    assert_int_equal(stats->counters[FIM_STATS_DB_TIME], 2 * SEC);
+}
+
+static void test_fim_scan_stats_add_time_clock_backwards(void **state) {
+    fim_scan_stats_t *stats = *state;
+
+    will_return(__wrap_gettime, 8);
+    fim_scan_stats_add_time(stats, FIM_STATS_DB_TIME, 10 * SEC);
+
+    assert_int_equal(stats->counters[FIM_STATS_DB_TIME], 0);
+}
+
+static void test_fim_scan_stats_hashed_slowest(void **state) {
+    fim_scan_stats_t *stats = *state;
+    const int64_t times[] = { 5, 1, 12, 7, 3, 9, 2, 11, 4, 10, 8, 6 };
+    char path[OS_SIZE_32];
+    size_t i;
+
+    for (i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+        snprintf(path, OS_SIZE_32, "/etc/file%d", (int)times[i]);
+        fim_scan_stats_hashed(stats, path, 10, times[i]);
+    }
+
+    assert_int_equal(stats->counters[FIM_STATS_HASHED_FILES], 12);
+    assert_int_equal(stats->counters[FIM_STATS_HASHED_BYTES], 120);
+    assert_int_equal(stats->counters[FIM_STATS_HASH_TIME], 78);
+
+    // The list keeps the slowest files, slowest first.
+    for (i = 0; i < FIM_SCAN_STATS_SLOWEST; i++) {
+        snprintf(path, OS_SIZE_32, "/etc/file%d", (int)(12 - i));
+        assert_int_equal(stats->slowest[i].nsec, 12 - i);
+        assert_string_equal(stats->slowest[i].path, path);
+    }
+}
+
+static void test_fim_scan_stats_hashed_tie(void **state) {
+    fim_scan_stats_t *stats = *state;
+
+    fim_scan_stats_hashed(stats, "/etc/first", 1, 5);
+    fim_scan_stats_hashed(stats, "/etc/second", 1, 5);
+
+    assert_string_equal(stats->slowest[0].path, "/etc/first");
+    assert_string_equal(stats->slowest[1].path, "/etc/second");
+    assert_null(stats->slowest[2].path);
+}
+
+static void test_fim_scan_stats_reset(void **state) {
+    fim_scan_stats_t *stats = *state;
+
+    fim_scan_stats_add(stats, FIM_STATS_FILES, 1);
+    fim_scan_stats_hashed(stats, "/etc/passwd", 100, SEC);
+
+    fim_scan_stats_reset(stats);
+
+    assert_int_equal(stats->counters[FIM_STATS_FILES], 0);
+    assert_int_equal(stats->counters[FIM_STATS_HASHED_BYTES], 0);
+    assert_null(stats->slowest[0].path);
+    assert_int_equal(stats->slowest[0].nsec, 0);
+}
+
+static void test_fim_scan_stats_json(void **state) {
+    directory_t *dir = OSList_GetFirstNode(syscheck.directories)->data;
+    cJSON *json;
+    cJSON *entry;
+
+    fim_scan_stats_start();
+
+    fim_scan_stats_add(dir->stats, FIM_STATS_FILES, 4);
+    fim_scan_stats_add(dir->stats, FIM_STATS_STAT_TIME, SEC / 2);
+    fim_scan_stats_add(dir->stats, FIM_STATS_SKIPPED_DEPTH, 1);
+    fim_scan_stats_hashed(dir->stats, "/etc/passwd", 1024, SEC);
+
+    json = fim_scan_stats_json();
+    *state = json;
+
+    assert_true(cJSON_IsTrue(cJSON_GetObjectItem(cJSON_GetObjectItem(json, "scan"), "running")));
+
+    entry = cJSON_GetArrayItem(cJSON_GetObjectItem(json, "directories"), 0);
+    assert_non_null(entry);
+    assert_string_equal(cJSON_GetStringValue(cJSON_GetObjectItem(entry, "path")), "/etc");
+    assert_int_equal(cJSON_GetObjectItem(entry, "files")->valueint, 4);
+    assert_int_equal(cJSON_GetObjectItem(entry, "hashed_files")->valueint, 1);
+    assert_int_equal(cJSON_GetObjectItem(entry, "hashed_bytes")->valueint, 1024);
+    assert_true(cJSON_GetObjectItem(entry, "stat_time")->valuedouble == 0.5);
+    assert_true(cJSON_GetObjectItem(entry, "hash_time")->valuedouble == 1.0);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetObjectItem(entry, "skipped"), "depth")->valueint, 1);
+    assert_int_equal(cJSON_GetObjectItem(cJSON_GetObjectItem(entry, "skipped"), "ignore")->valueint, 0);
+
+    entry = cJSON_GetArrayItem(cJSON_GetObjectItem(entry, "slowest"), 0);
+    assert_string_equal(cJSON_GetStringValue(cJSON_GetObjectItem(entry, "path")), "/etc/passwd");
+    assert_true(cJSON_GetObjectItem(entry, "hash_time")->valuedouble == 1.0);
+}
+
+static void test_fim_scan_stats_json_scan_end(void **state) {
+    directory_t *dir = OSList_GetFirstNode(syscheck.directories)->data;
+    cJSON *json;
+    cJSON *scan;
+
+    fim_scan_stats_add(dir->stats, FIM_STATS_FILES, 1);
+
+    // A new scan starts from zero.
+    fim_scan_stats_start();
+    fim_scan_stats_end(3 * SEC, SEC / 4);
+
+    json = fim_scan_stats_json();
+    *state = json;
+
+    scan = cJSON_GetObjectItem(json, "scan");
+    assert_false(cJSON_IsTrue(cJSON_GetObjectItem(scan, "running")));
+    assert_true(cJSON_GetObjectItem(scan, "wall_time")->valuedouble == 3.0);
+    assert_true(cJSON_GetObjectItem(scan, "cpu_time")->valuedouble == 0.25);
+    assert_true(cJSON_GetObjectItem(scan, "end")->valuedouble >= cJSON_GetObjectItem(scan, "start")->valuedouble);
+
+    dir = OSList_GetFirstNode(syscheck.directories)->data;
+    assert_int_equal(dir->stats->counters[FIM_STATS_FILES], 0);
+    assert_null(cJSON_GetArrayItem(cJSON_GetObjectItem(cJSON_GetArrayItem(cJSON_GetObjectItem(json, "directories"), 0),
+                                                       "slowest"), 0));
+}
+
+int main(void) {
+    const struct CMUnitTest tests[] = {
+        cmocka_unit_test_setup_teardown(test_fim_scan_stats_add, setup_stats, teardown_stats),
+        cmocka_unit_test(test_fim_scan_stats_add_null),
+        cmocka_unit_test_setup_teardown(test_fim_scan_stats_add_time, setup_stats, teardown_stats),
+        cmocka_unit_test_setup_teardown(test_fim_scan_stats_add_time_clock_backwards, setup_stats, teardown_stats),
+        cmocka_unit_test_setup_teardown(test_fim_scan_stats_hashed_slowest, setup_stats, teardown_stats),
+        cmocka_unit_test_setup_teardown(test_fim_scan_stats_hashed_tie, setup_stats, teardown_stats),
+        cmocka_unit_test_setup_teardown(test_fim_scan_stats_reset, setup_stats, teardown_stats),
+        cmocka_unit_test_teardown(test_fim_scan_stats_json, teardown_json),
+        cmocka_unit_test_teardown(test_fim_scan_stats_json_scan_end, teardown_json),
+    };
+
+    return cmocka_run_group_tests(tests, setup_group, teardown_group);
+}
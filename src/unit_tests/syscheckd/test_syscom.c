@@ -17,6 +17,7 @@
 #include "../wrappers/wazuh/shared/debug_op_wrappers.h"
 #include "../wrappers/wazuh/syscheckd/config_wrappers.h"
 #include "../wrappers/wazuh/syscheckd/fim_sync_wrappers.h"
+#include "../wrappers/wazuh/syscheckd/scan_stats_wrappers.h"
 #include "../../syscheckd/include/syscheck.h"
 #include "../../config/syscheck-config.h"
 
@@ -307,6 +308,47 @@ void test_syscom_getconfig_null_output(void **state)
     expect_assert_failure(syscom_getconfig(section, NULL));
 }
 
+void test_syscom_dispatch_getstats_agent(void **state)
+{
+    size_t ret;
+
+    char command[] = "syscheck getstats";
+    char * output;
+
+    cJSON * root = cJSON_CreateObject();
+    cJSON_AddBoolToObject(root, "running", false);
+
+    will_return(__wrap_fim_scan_stats_json, root);
+    ret = syscom_dispatch(command, &output);
+    *state = output;
+
+    assert_string_equal(output, "ok {\"running\":false}");
+    assert_int_equal(ret, 20);
+}
+
+void test_syscom_dispatch_getstats_manager(void **state)
+{
+    size_t ret;
+
+    char command[] = "getstats";
+    char * output;
+
+    cJSON * root = cJSON_CreateObject();
+    cJSON_AddArrayToObject(root, "directories");
+
+    will_return(__wrap_fim_scan_stats_json, root);
+    ret = syscom_dispatch(command, &output);
+    *state = output;
+
+    assert_string_equal(output, "ok {\"directories\":[]}");
+    assert_int_equal(ret, 21);
+}
+
+void test_syscom_getstats_null_output(void **state)
+{
+    expect_assert_failure(syscom_getstats(NULL));
+}
+
 
 int main(void) {
     const struct CMUnitTest tests[] = {
@@ -328,6 +370,9 @@ int main(void) {
         cmocka_unit_test_teardown(test_syscom_getconfig_internal_failure, delete_string),
         cmocka_unit_test(test_syscom_getconfig_null_section),
         cmocka_unit_test(test_syscom_getconfig_null_output),
+        cmocka_unit_test_teardown(test_syscom_dispatch_getstats_agent, delete_string),
+        cmocka_unit_test_teardown(test_syscom_dispatch_getstats_manager, delete_string),
+        cmocka_unit_test(test_syscom_getstats_null_output),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
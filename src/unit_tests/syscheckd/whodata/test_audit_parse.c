@@ -31,12 +31,12 @@
 
 extern unsigned int count_reload_retries;
 audit_key_type filterkey_audit_events(char *buffer);
+void audit_scan_fields(const char *event, audit_fields_t *fields);
 
 /* setup/teardown */
 static int setup_group(void **state) {
     (void) state;
     test_mode = 1;
-    init_regex();
 
     return 0;
 }
@@ -45,7 +45,6 @@ static int teardown_group(void **state) {
     (void) state;
     memset(&syscheck, 0, sizeof(syscheck_config));
     Free_Syscheck(&syscheck);
-    clean_regex();
     test_mode = 0;
     return 0;
 }
@@ -68,6 +67,26 @@ static int setup_config(void **state) {
     return 0;
 }
 
+static int setup_monitored_config(void **state) {
+    // Paths of the events are checked against the configuration before building the whodata event
+    expect_function_call_any(__wrap_pthread_rwlock_wrlock);
+    expect_function_call_any(__wrap_pthread_rwlock_rdlock);
+    expect_function_call_any(__wrap_pthread_rwlock_unlock);
+    expect_function_call_any(__wrap_pthread_mutex_lock);
+    expect_function_call_any(__wrap_pthread_mutex_unlock);
+
+    directory_t *directory0 = fim_create_directory("/root", WHODATA_ACTIVE, NULL, 512, NULL, 1024, 0);
+
+    syscheck.directories = OSList_Create();
+    if (syscheck.directories == NULL) {
+        return -1;
+    }
+
+    OSList_InsertData(syscheck.directories, NULL, directory0);
+
+    return 0;
+}
+
 static int teardown_config(void **state) {
     OSListNode *node_it;
 
@@ -1188,20 +1207,7 @@ void test_audit_parse_delete_folder_hex3_error(void **state) {
     expect_value(__wrap_SendMSG, loc, LOCALFILE_MQ);
     will_return(__wrap_SendMSG, 1);
 
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-
-    expect_value(__wrap_get_group, gid, 0);
-    will_return(__wrap_get_group, strdup("root"));
-
-    will_return(__wrap_readlink, 0);
-    will_return(__wrap_readlink, 0);
-
-    expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '1'");
+    // No path can be decoded, the process isn't looked up
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '2'");
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '3'");
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '4'");
@@ -1239,20 +1245,7 @@ void test_audit_parse_delete_folder_hex4_error(void **state) {
     expect_value(__wrap_SendMSG, loc, LOCALFILE_MQ);
     will_return(__wrap_SendMSG, 1);
 
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-
-    expect_value(__wrap_get_group, gid, 0);
-    will_return(__wrap_get_group, strdup("root"));
-
-    will_return(__wrap_readlink, 0);
-    will_return(__wrap_readlink, 0);
-
-    expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '1'");
+    // No path can be decoded, the process isn't looked up
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '2'");
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '3'");
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '4'");
@@ -1293,20 +1286,7 @@ void test_audit_parse_delete_folder_hex5_error(void **state) {
     expect_value(__wrap_SendMSG, loc, LOCALFILE_MQ);
     will_return(__wrap_SendMSG, 1);
 
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-    expect_value(__wrap_get_user, uid, 0);
-    will_return(__wrap_get_user, strdup("root"));
-
-    expect_value(__wrap_get_group, gid, 0);
-    will_return(__wrap_get_group, strdup("root"));
-
-    will_return(__wrap_readlink, 0);
-    will_return(__wrap_readlink, 0);
-
-    expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '1'");
+    // No path can be decoded, the process isn't looked up
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '2'");
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '3'");
     expect_string(__wrap__merror, formatted_msg, "Error found while decoding HEX bufer: '4'");
@@ -1314,6 +1294,71 @@ void test_audit_parse_delete_folder_hex5_error(void **state) {
 
     audit_parse(buffer);
 }
+void test_audit_parse_not_monitored(void **state) {
+    (void) state;
+
+    char audit_key_msg[OS_SIZE_128] = {0};
+    char debug_msg[OS_SIZE_256] = {0};
+    char * buffer = " \
+        type=SYSCALL msg=audit(1571992092.822:3004348): arch=c000003e syscall=268 success=yes exit=0 a0=ffffff9c a1=5648a8ab74c0 a2=1ff a3=fff items=1 ppid=3211 pid=58280 auid=4 uid=99 gid=78 euid=29 suid=0 fsuid=0 egid=0 sgid=0 fsgid=0 tty=pts3 ses=5 comm=\"chmod\" exe=\"/usr/bin/chmod\" key=\"wazuh_fim\" \
+        type=CWD msg=audit(1571992092.822:3004348): cwd=\"/etc\" \
+        type=PATH msg=audit(1571992092.822:3004348): item=0 name=\"/etc/file\" inode=19 dev=08:02 mode=0100644 ouid=0 ogid=0 rdev=00:00 nametype=NORMAL cap_fp=0 cap_fi=0 cap_fe=0 cap_fver=0 \
+        type=PROCTITLE msg=audit(1571992092.822:3004348): proctitle=63686D6F6400373737002F6574632F66696C65 \
+    ";
+
+    snprintf(audit_key_msg, OS_SIZE_128, FIM_AUDIT_MATCH_KEY, "wazuh_fim");
+    expect_string(__wrap__mdebug2, formatted_msg, audit_key_msg);
+
+    // Neither the users nor the parent process are looked up
+    snprintf(debug_msg, OS_SIZE_256, FIM_CONFIGURATION_NOTFOUND, "file", "/etc/file");
+    expect_string(__wrap__mdebug2, formatted_msg, debug_msg);
+
+    audit_parse(buffer);
+}
+
+
+void test_audit_scan_fields(void **state) {
+    (void) state;
+
+    audit_fields_t fields;
+    char * buffer = "type=SYSCALL msg=audit(1571925844.299:3004308): arch=c000003e syscall=82 success=yes exit=0 items=3 ppid=3210 pid=52277 auid=20 uid=30 gid=40 euid=50 suid=0 comm=\"mv\" exe=\"/usr/bin/mv\" key=\"wazuh_fim\"\n"
+                    "type=CWD msg=audit(1571925844.299:3004308): cwd=2F726F6F74\n"
+                    "type=PATH msg=audit(1571925844.299:3004308): item=0 name=\"./\" inode=110 dev=08:02 mode=040755 ouid=0 ogid=0 nametype=PARENT\n"
+                    "type=PATH msg=audit(1571925844.299:3004308): item=1 nametype=PARENT name=\"other\" inode=24 dev=fd:01 mode=040755\n"
+                    "type=PATH msg=audit(1571925844.299:3004308): item=2 name=\"./test\" inode=28 dev=fd:01 mode=0100644 ouid=0 nametype=DELETE\n"
+                    "type=PROCTITLE msg=audit(1571925844.299:3004308): proctitle=6D76002E2F7465737400666F6C646572\n";
+
+    audit_scan_fields(buffer, &fields);
+
+    // The first occurrence of each field is kept, "suid" and "ouid" aren't taken as "uid"
+    assert_int_equal(fields.uid.length, 2);
+    assert_memory_equal(fields.uid.value, "30", 2);
+    assert_int_equal(fields.auid.length, 2);
+    assert_memory_equal(fields.auid.value, "20", 2);
+    assert_int_equal(fields.pid.length, 5);
+    assert_memory_equal(fields.pid.value, "52277", 5);
+    assert_int_equal(fields.exe.hex, 0);
+    assert_int_equal(fields.exe.length, 11);
+    assert_memory_equal(fields.exe.value, "/usr/bin/mv", 11);
+    assert_int_equal(fields.cwd.hex, 1);
+    assert_int_equal(fields.cwd.length, 10);
+    assert_int_equal(fields.dev.length, 5);
+    assert_memory_equal(fields.dev.value, "08:02", 5);
+
+    // Names are only taken right after their item number
+    assert_non_null(fields.name[0].value);
+    assert_memory_equal(fields.name[0].value, "./", 2);
+    assert_null(fields.name[1].value);
+    assert_non_null(fields.name[2].value);
+    assert_memory_equal(fields.name[2].value, "./test", 6);
+    assert_null(fields.name[3].value);
+
+    // The inode is the one of the last PATH record
+    assert_int_equal(fields.inode.length, 2);
+    assert_memory_equal(fields.inode.value, "28", 2);
+    assert_null(fields.dir.value);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         cmocka_unit_test_setup_teardown(test_filterkey_audit_events_custom, setup_custom_key, teardown_custom_key),
@@ -1341,25 +1386,27 @@ int main(void) {
         cmocka_unit_test_teardown(test_gen_audit_path8, free_string),
         cmocka_unit_test(test_get_process_parent_info_failed),
         cmocka_unit_test(test_get_process_parent_info_passsed),
-        cmocka_unit_test(test_audit_parse),
-        cmocka_unit_test(test_audit_parse3),
-        cmocka_unit_test(test_audit_parse4),
-        cmocka_unit_test(test_audit_parse_hex),
+        cmocka_unit_test_setup_teardown(test_audit_parse, setup_monitored_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_audit_parse3, setup_monitored_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_audit_parse4, setup_monitored_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_audit_parse_hex, setup_monitored_config, teardown_config),
         cmocka_unit_test(test_audit_parse_empty_fields),
         cmocka_unit_test(test_audit_parse_delete),
         cmocka_unit_test_setup_teardown(test_audit_parse_delete_recursive, setup_config, teardown_config),
-        cmocka_unit_test(test_audit_parse_mv),
-        cmocka_unit_test(test_audit_parse_mv_hex),
-        cmocka_unit_test(test_audit_parse_rm),
-        cmocka_unit_test(test_audit_parse_chmod),
+        cmocka_unit_test_setup_teardown(test_audit_parse_mv, setup_monitored_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_audit_parse_mv_hex, setup_monitored_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_audit_parse_rm, setup_monitored_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_audit_parse_chmod, setup_monitored_config, teardown_config),
         cmocka_unit_test(test_audit_parse_rm_hc),
         cmocka_unit_test(test_audit_parse_add_hc),
         cmocka_unit_test(test_audit_parse_unknown_hc),
-        cmocka_unit_test(test_audit_parse_delete_folder),
-        cmocka_unit_test(test_audit_parse_delete_folder_hex),
+        cmocka_unit_test_setup_teardown(test_audit_parse_delete_folder, setup_monitored_config, teardown_config),
+        cmocka_unit_test_setup_teardown(test_audit_parse_delete_folder_hex, setup_monitored_config, teardown_config),
         cmocka_unit_test(test_audit_parse_delete_folder_hex3_error),
         cmocka_unit_test(test_audit_parse_delete_folder_hex4_error),
         cmocka_unit_test(test_audit_parse_delete_folder_hex5_error),
+        cmocka_unit_test_setup_teardown(test_audit_parse_not_monitored, setup_monitored_config, teardown_config),
+        cmocka_unit_test(test_audit_scan_fields),
         };
 
     return cmocka_run_group_tests(tests, setup_group, teardown_group);
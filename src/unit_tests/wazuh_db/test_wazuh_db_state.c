@@ -58,6 +58,8 @@ static int test_setup(void ** state) {
     wdb_state.queries_breakdown.agent_breakdown.syscollector.deprecated.netaddr_queries = 5;
     wdb_state.queries_breakdown.agent_breakdown.syscollector.deprecated.netinfo_queries = 12;
     wdb_state.queries_breakdown.agent_breakdown.syscollector.deprecated.hardware_queries = 8;
+    wdb_state.sqlite.busy = 14;
+    wdb_state.sqlite.busy_exceeded = 1;
     wdb_state.queries_breakdown.agent_breakdown.syscollector.deprecated.osinfo_queries = 1;
     wdb_state.queries_breakdown.agent_breakdown.vulnerability.vulnerability_detector_queries = 8;
     wdb_state.queries_breakdown.agent_breakdown.sync.dbsync_queries = 5;
@@ -506,6 +508,12 @@ void test_wazuhdb_create_state_json(void ** state) {
     assert_non_null(cJSON_GetObjectItem(wazuhdb_queries_db, "remove"));
     assert_int_equal(cJSON_GetObjectItem(wazuhdb_queries_db, "remove")->valueint, 212);
 
+    assert_non_null(cJSON_GetObjectItem(metrics, "sqlite"));
+    cJSON* sqlite = cJSON_GetObjectItem(metrics, "sqlite");
+
+    assert_int_equal(cJSON_GetObjectItem(sqlite, "busy")->valueint, 14);
+    assert_int_equal(cJSON_GetObjectItem(sqlite, "busy_exceeded")->valueint, 1);
+
     assert_non_null(cJSON_GetObjectItem(metrics, "time"));
     cJSON* time = cJSON_GetObjectItem(metrics, "time");
 
@@ -36,6 +36,15 @@ int wdb_get_last_vacuum_data(wdb_t * wdb, int *last_vacuum_time, int *last_vacuu
 int wdb_execute_single_int_select_query(wdb_t * wdb, const char *query, int *value);
 
 extern wdb_t * db_pool_begin;
+extern wdb_t * db_pool_last;
+extern wdb_t * db_pool_hot;
+extern int db_pool_cold_size;
+extern wdb_commit_entry_t ** commit_heap;
+extern size_t commit_heap_size;
+
+void wdb_schedule_commit(wdb_t * wdb);
+void wdb_commit_heap_push(wdb_commit_entry_t * entry);
+wdb_commit_entry_t * wdb_commit_heap_pop();
 
 typedef struct test_struct {
     wdb_t *wdb;
@@ -926,6 +935,49 @@ void test_wdb_leave(){
     assert_null(wdb.last);
 }
 
+void test_wdb_leave_commit_queries_max(){
+    wdb_t wdb = { .id = "000", .refcount = 1, .transaction = 1, .transaction_queries = 1, .transaction_changes = 5 };
+
+    wconfig.commit_queries_max = 2;
+
+    will_return(__wrap_time, 0);
+    will_return(__wrap_sqlite3_total_changes64, 6);
+
+    // wdb_commit2
+    will_return(__wrap_sqlite3_prepare_v2, 1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_DONE);
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    wdb_leave(&wdb);
+
+    assert_int_equal(wdb.transaction, 0);
+    assert_int_equal(wdb.transaction_queries, 0);
+
+    wconfig.commit_queries_max = 0;
+}
+
+void test_wdb_leave_commit_queries_max_read_only(){
+    wdb_t wdb = { .id = "000", .refcount = 1, .transaction = 1, .transaction_queries = 1, .transaction_changes = 5 };
+
+    wconfig.commit_queries_max = 2;
+
+    // No rows changed since the last counted query
+    will_return(__wrap_time, 0);
+    will_return(__wrap_sqlite3_total_changes64, 5);
+
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    wdb_leave(&wdb);
+
+    assert_int_equal(wdb.transaction, 1);
+    assert_int_equal(wdb.transaction_queries, 1);
+
+    wconfig.commit_queries_max = 0;
+}
+
 void test_wdb_finalize_all_statements(){
     const int kMaxStmt = 10;
     wdb_t wdb = {0};
@@ -952,6 +1004,177 @@ void test_wdb_finalize_all_statements(){
     assert_null(wdb.cache_list);
 }
 
+/* Tests wdb_get_cache_stmt */
+
+void test_wdb_get_cache_stmt_lru(){
+    wdb_t wdb = { .id = "000" };
+
+    will_return(__wrap_sqlite3_prepare_v2, (sqlite3_stmt *)1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    assert_ptr_equal(wdb_get_cache_stmt(&wdb, "SELECT 1;"), (sqlite3_stmt *)1);
+
+    will_return(__wrap_sqlite3_prepare_v2, (sqlite3_stmt *)2);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    assert_ptr_equal(wdb_get_cache_stmt(&wdb, "SELECT 2;"), (sqlite3_stmt *)2);
+
+    // A hit is reset and moved to the front
+    will_return(__wrap_sqlite3_reset, SQLITE_OK);
+    will_return(__wrap_sqlite3_clear_bindings, SQLITE_OK);
+    assert_ptr_equal(wdb_get_cache_stmt(&wdb, "SELECT 1;"), (sqlite3_stmt *)1);
+
+    assert_int_equal(wdb.cache_size, 2);
+    assert_string_equal(wdb.cache_list->value.query, "SELECT 1;");
+    assert_string_equal(wdb.cache_list->next->value.query, "SELECT 2;");
+
+    will_return_count(__wrap_sqlite3_finalize, SQLITE_OK, 2);
+    wdb_finalize_all_statements(&wdb);
+}
+
+void test_wdb_get_cache_stmt_evict(){
+    wdb_t wdb = { .id = "000" };
+    char query[32];
+
+    for (int i = 0; i <= WDB_STMT_CACHE_MAX; i++) {
+        snprintf(query, sizeof(query), "SELECT %d;", i);
+        will_return(__wrap_sqlite3_prepare_v2, (sqlite3_stmt *)(intptr_t)(i + 1));
+        will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+
+        if (i == WDB_STMT_CACHE_MAX) {
+            // The least recently used statement is finalized
+            will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+        }
+
+        wdb_get_cache_stmt(&wdb, query);
+    }
+
+    assert_int_equal(wdb.cache_size, WDB_STMT_CACHE_MAX);
+
+    for (struct stmt_cache_list *node = wdb.cache_list; node; node = node->next) {
+        assert_string_not_equal(node->value.query, "SELECT 0;");
+    }
+
+    will_return_count(__wrap_sqlite3_finalize, SQLITE_OK, WDB_STMT_CACHE_MAX);
+    wdb_finalize_all_statements(&wdb);
+}
+
+void test_wdb_get_cache_stmt_prepare_error(){
+    wdb_t wdb = { .id = "000" };
+
+    will_return(__wrap_sqlite3_prepare_v2, NULL);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_ERROR);
+    will_return(__wrap_sqlite3_errmsg, "ERROR MESSAGE");
+    expect_string(__wrap__merror, formatted_msg, "DB(000) sqlite3_prepare_v2() : ERROR MESSAGE");
+
+    assert_null(wdb_get_cache_stmt(&wdb, "SELECT 1;"));
+    assert_null(wdb.cache_list);
+    assert_int_equal(wdb.cache_size, 0);
+}
+
+/* Tests wdb_cursor */
+
+static void expect_cursor_text_row(const char * value) {
+    expect_sqlite3_step_call(SQLITE_ROW);
+    will_return(__wrap_sqlite3_column_count, 1);
+    expect_value(__wrap_sqlite3_column_type, i, 0);
+    will_return(__wrap_sqlite3_column_type, SQLITE_TEXT);
+    expect_value(__wrap_sqlite3_column_name, N, 0);
+    will_return(__wrap_sqlite3_column_name, "name");
+    expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, value);
+}
+
+void test_wdb_cursor_open_single_chunk(){
+    wdb_t wdb = { .id = "000" };
+    char output[OS_MAXSTR + 1] = "";
+
+    will_return(__wrap_time, 0);
+    will_return(__wrap_sqlite3_prepare_v2, (sqlite3_stmt *)1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    will_return(__wrap_sqlite3_stmt_readonly, 1);
+    expect_cursor_text_row("agent");
+    expect_sqlite3_step_call(SQLITE_DONE);
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+
+    assert_int_equal(wdb_cursor_open(&wdb, "SELECT name FROM agent;", output), OS_SUCCESS);
+    assert_string_equal(output, "ok [{\"name\":\"agent\"}]");
+    assert_null(wdb.cursors);
+}
+
+void test_wdb_cursor_chunks(){
+    wdb_t wdb = { .id = "000" };
+    char output[OS_MAXSTR + 1] = "";
+    char expected[OS_MAXSTR + 1];
+    char * value;
+
+    // Two rows don't fit in one response
+    os_calloc((WDB_MAX_RESPONSE_SIZE) / 2 + 1, sizeof(char), value);
+    memset(value, 'a', (WDB_MAX_RESPONSE_SIZE) / 2);
+
+    will_return(__wrap_time, 0);
+    will_return(__wrap_sqlite3_prepare_v2, (sqlite3_stmt *)1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    will_return(__wrap_sqlite3_stmt_readonly, 1);
+    expect_cursor_text_row(value);
+    expect_cursor_text_row(value);
+    will_return(__wrap_time, 10);
+
+    assert_int_equal(wdb_cursor_open(&wdb, "SELECT name FROM agent;", output), OS_SUCCESS);
+    snprintf(expected, sizeof(expected), "due {\"cursor\":1,\"data\":[{\"name\":\"%s\"}]}", value);
+    assert_string_equal(output, expected);
+    assert_non_null(wdb.cursors);
+    assert_non_null(wdb.cursors->pending);
+
+    // The pending row is the first one of the last chunk
+    will_return(__wrap_time, 20);
+    expect_sqlite3_step_call(SQLITE_DONE);
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+
+    assert_int_equal(wdb_cursor_next(&wdb, 1, output), OS_SUCCESS);
+    snprintf(expected, sizeof(expected), "ok [{\"name\":\"%s\"}]", value);
+    assert_string_equal(output, expected);
+    assert_null(wdb.cursors);
+
+    os_free(value);
+}
+
+void test_wdb_cursor_open_not_readonly(){
+    wdb_t wdb = { .id = "000" };
+    char output[OS_MAXSTR + 1] = "";
+
+    will_return(__wrap_time, 0);
+    will_return(__wrap_sqlite3_prepare_v2, (sqlite3_stmt *)1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    will_return(__wrap_sqlite3_stmt_readonly, 0);
+    expect_string(__wrap__mdebug1, formatted_msg, "DB(000) Cursors only admit read-only queries.");
+    expect_string(__wrap__mdebug2, formatted_msg, "DB(000) SQL: DELETE FROM agent;");
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+
+    assert_int_equal(wdb_cursor_open(&wdb, "DELETE FROM agent;", output), OS_INVALID);
+    assert_string_equal(output, "err Cursors only admit read-only queries");
+    assert_null(wdb.cursors);
+}
+
+void test_wdb_cursor_next_expired(){
+    wdb_t wdb = { .id = "000" };
+    char output[OS_MAXSTR + 1] = "";
+    wdb_cursor_t * cursor;
+
+    os_calloc(1, sizeof(wdb_cursor_t), cursor);
+    cursor->id = 1;
+    cursor->stmt = (sqlite3_stmt *)1;
+    cursor->last = 100;
+    wdb.cursors = cursor;
+
+    will_return(__wrap_time, 100 + WDB_CURSOR_TTL);
+    expect_string(__wrap__mdebug2, formatted_msg, "DB(000) Closing idle cursor 1.");
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+    expect_string(__wrap__mdebug1, formatted_msg, "DB(000) Cursor 1 not found.");
+
+    assert_int_equal(wdb_cursor_next(&wdb, 1, output), OS_INVALID);
+    assert_string_equal(output, "err Cursor not found");
+    assert_null(wdb.cursors);
+}
+
 /* Tests wdb_close*/
 
 void test_wdb_close_refcount_error(){
@@ -1005,6 +1228,226 @@ void test_wdb_close_success(){
     assert_int_equal(0, wdb_close(wdb, 0));
 }
 
+/* Tests wdb_pool_touch */
+
+void test_wdb_pool_touch(){
+    wdb_t *wdb[3];
+    char *ids[3] = { "001", "002", "003" };
+
+    open_dbs = (OSHash *)0xDEADBEEF;
+
+    for (int i = 0; i < 3; i++) {
+        wdb[i] = calloc(1, sizeof(wdb_t));
+        wdb[i]->id = ids[i];
+        expect_string(__wrap_OSHash_Add, key, ids[i]);
+        will_return(__wrap_OSHash_Add, 2);
+        wdb_pool_append(wdb[i]);
+    }
+
+    // New databases stay in the FIFO queue, in opening order
+    wdb_pool_touch(wdb[0]);
+    assert_ptr_equal(db_pool_begin, wdb[0]);
+    assert_ptr_equal(wdb[0]->next, wdb[1]);
+    assert_ptr_equal(wdb[1]->next, wdb[2]);
+    assert_ptr_equal(db_pool_last, wdb[2]);
+    assert_null(db_pool_hot);
+
+    // The most recently used hot database goes to the end
+    wdb[0]->hot = wdb[1]->hot = wdb[2]->hot = 1;
+    db_pool_hot = wdb[0];
+    db_pool_cold_size = 0;
+
+    wdb_pool_touch(wdb[0]);
+    assert_ptr_equal(db_pool_begin, wdb[1]);
+    assert_ptr_equal(db_pool_hot, wdb[1]);
+    assert_ptr_equal(wdb[1]->next, wdb[2]);
+    assert_ptr_equal(wdb[2]->next, wdb[0]);
+    assert_ptr_equal(wdb[0]->prev, wdb[2]);
+    assert_ptr_equal(db_pool_last, wdb[0]);
+
+    wdb_pool_touch(wdb[0]);
+    assert_ptr_equal(db_pool_last, wdb[0]);
+
+    for (int i = 0; i < 3; i++) {
+        expect_value(__wrap_OSHash_Delete, self, open_dbs);
+        expect_string(__wrap_OSHash_Delete, key, ids[i]);
+        will_return(__wrap_OSHash_Delete, 1);
+    }
+
+    wdb_pool_remove(wdb[2]);
+    assert_ptr_equal(wdb[1]->next, wdb[0]);
+    assert_ptr_equal(wdb[0]->prev, wdb[1]);
+
+    wdb_pool_remove(wdb[1]);
+    wdb_pool_remove(wdb[0]);
+    assert_null(db_pool_begin);
+    assert_null(db_pool_last);
+    assert_null(db_pool_hot);
+
+    for (int i = 0; i < 3; i++) {
+        free(wdb[i]);
+    }
+}
+
+static wdb_t * pool_open(const char * id) {
+    wdb_t * wdb = calloc(1, sizeof(wdb_t));
+    wdb->id = strdup(id);
+
+    expect_string(__wrap_OSHash_Add, key, id);
+    will_return(__wrap_OSHash_Add, 2);
+    wdb_pool_append(wdb);
+
+    return wdb;
+}
+
+void test_wdb_pool_2q(){
+    wdb_t *wdb[4];
+
+    open_dbs = (OSHash *)0xDEADBEEF;
+    wconfig.open_db_limit = 2;
+
+    expect_function_call_any(__wrap_pthread_mutex_lock);
+    expect_function_call_any(__wrap_pthread_mutex_unlock);
+
+    test_mode = 0;
+    wdb_pool_init();
+    test_mode = 1;
+
+    w_metric_t * ghost_hits = w_metrics_counter("wazuhdb_pool_ghost_hits_total", NULL);
+
+    wdb[0] = pool_open("001");
+    wdb[1] = pool_open("002");
+    wdb[2] = pool_open("003");
+    assert_int_equal(db_pool_cold_size, 3);
+
+    // The first database opened is evicted
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+    expect_value(__wrap_OSHash_Delete, self, open_dbs);
+    expect_string(__wrap_OSHash_Delete, key, "001");
+    will_return(__wrap_OSHash_Delete, 1);
+
+    wdb_close_old();
+    assert_int_equal(db_pool_size, 2);
+    assert_ptr_equal(db_pool_begin, wdb[1]);
+
+    // Reopened after its eviction, it goes to the frequently used queue
+    wdb[0] = pool_open("001");
+    assert_true(wdb[0]->hot);
+    assert_ptr_equal(db_pool_hot, wdb[0]);
+    assert_int_equal(w_metrics_value(ghost_hits), 1);
+
+    // New databases go before the frequently used ones
+    wdb[3] = pool_open("004");
+    assert_false(wdb[3]->hot);
+    assert_ptr_equal(wdb[2]->next, wdb[3]);
+    assert_ptr_equal(wdb[3]->next, wdb[0]);
+    assert_ptr_equal(db_pool_last, wdb[0]);
+
+    // The FIFO queue is evicted before the frequently used queue
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+    expect_value(__wrap_OSHash_Delete, self, open_dbs);
+    expect_string(__wrap_OSHash_Delete, key, "002");
+    will_return(__wrap_OSHash_Delete, 1);
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+    expect_value(__wrap_OSHash_Delete, self, open_dbs);
+    expect_string(__wrap_OSHash_Delete, key, "003");
+    will_return(__wrap_OSHash_Delete, 1);
+
+    wdb_close_old();
+    assert_int_equal(db_pool_size, 2);
+    assert_ptr_equal(db_pool_begin, wdb[3]);
+    assert_ptr_equal(db_pool_hot, wdb[0]);
+
+    expect_value(__wrap_OSHash_Delete, self, open_dbs);
+    expect_string(__wrap_OSHash_Delete, key, "004");
+    will_return(__wrap_OSHash_Delete, 1);
+    expect_value(__wrap_OSHash_Delete, self, open_dbs);
+    expect_string(__wrap_OSHash_Delete, key, "001");
+    will_return(__wrap_OSHash_Delete, 1);
+
+    wdb_pool_remove(wdb[3]);
+    wdb_pool_remove(wdb[0]);
+    assert_null(db_pool_begin);
+    assert_int_equal(db_pool_cold_size, 0);
+
+    wdb_destroy(wdb[3]);
+    wdb_destroy(wdb[0]);
+}
+
+/* Tests commit deadlines */
+
+void test_wdb_commit_heap(){
+    time_t deadlines[] = { 5, 1, 3, 2, 4, 1 };
+    wdb_commit_entry_t entries[6];
+    wdb_commit_entry_t *entry;
+    time_t last = 0;
+
+    for (int i = 0; i < 6; i++) {
+        entries[i].deadline = deadlines[i];
+        wdb_commit_heap_push(&entries[i]);
+    }
+
+    for (int i = 0; i < 6; i++) {
+        entry = wdb_commit_heap_pop();
+        assert_non_null(entry);
+        assert_true(entry->deadline >= last);
+        last = entry->deadline;
+    }
+
+    assert_int_equal(last, 5);
+    assert_null(wdb_commit_heap_pop());
+}
+
+void test_wdb_commit_old_node_closed(){
+    wdb_t wdb = { .id = "001", .transaction_begin_time = 100 };
+
+    wconfig.commit_time_min = 10;
+
+    // Scheduled once for each transaction
+    wdb_schedule_commit(&wdb);
+    wdb_schedule_commit(&wdb);
+    assert_true(wdb.commit_scheduled);
+
+    will_return(__wrap_time, 200);
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_any(__wrap_OSHash_Get, self);
+    expect_string(__wrap_OSHash_Get, key, "001");
+    will_return(__wrap_OSHash_Get, NULL);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    wdb_commit_old();
+
+    assert_int_equal(commit_heap_size, 0);
+}
+
+void test_wdb_commit_old_not_due(){
+    wdb_t wdb = { .id = "001", .transaction = 1, .transaction_begin_time = 150, .last = 195 };
+    wdb_commit_entry_t *entry;
+
+    wconfig.commit_time_min = 10;
+    wconfig.commit_time_max = 60;
+
+    wdb_schedule_commit(&wdb);
+
+    will_return_count(__wrap_time, 200, 3);
+    expect_function_calls(__wrap_pthread_mutex_lock, 2);
+    expect_any(__wrap_OSHash_Get, self);
+    expect_string(__wrap_OSHash_Get, key, "001");
+    will_return(__wrap_OSHash_Get, &wdb);
+    expect_function_calls(__wrap_pthread_mutex_unlock, 2);
+
+    wdb_commit_old();
+
+    // Rescheduled when the idle time reaches commit_time_min
+    assert_int_equal(commit_heap_size, 1);
+    assert_int_equal(commit_heap[0]->deadline, 206);
+    assert_true(wdb.commit_scheduled);
+
+    entry = wdb_commit_heap_pop();
+    os_free(entry->id);
+    os_free(entry);
+}
+
 void test_wdb_get_db_free_pages_percentage_page_count_error(void **state) {
     wdb_t *wdb = calloc(1, sizeof(wdb_t));
     wdb->db = calloc(1, sizeof(sqlite3 *));
@@ -3101,6 +3544,162 @@ void test_wdb_check_fragmentation_vacuum_current_fragmentation_delta(void **stat
     os_free(db_pool_begin);
 }
 
+/* Tests wdb_incremental_vacuum */
+
+void test_wdb_incremental_vacuum_done(void **state)
+{
+    wdb_t *wdb = NULL;
+    os_calloc(1, sizeof(wdb_t), wdb);
+    os_strdup("000", wdb->id);
+
+    will_return(__wrap_sqlite3_prepare_v2, 1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_ROW);
+    will_return(__wrap_time_diff, 0.001);
+    expect_sqlite3_step_call(SQLITE_DONE);
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+
+    assert_int_equal(wdb_incremental_vacuum(wdb, 16, 50), 1);
+
+    os_free(wdb->id);
+    os_free(wdb);
+}
+
+void test_wdb_incremental_vacuum_time_limit(void **state)
+{
+    wdb_t *wdb = NULL;
+    os_calloc(1, sizeof(wdb_t), wdb);
+    os_strdup("000", wdb->id);
+
+    will_return(__wrap_sqlite3_prepare_v2, 1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_ROW);
+    will_return(__wrap_time_diff, 0.01);
+    expect_sqlite3_step_call(SQLITE_ROW);
+    will_return(__wrap_time_diff, 0.05);
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+
+    assert_int_equal(wdb_incremental_vacuum(wdb, 16, 50), 2);
+
+    os_free(wdb->id);
+    os_free(wdb);
+}
+
+void test_wdb_incremental_vacuum_error(void **state)
+{
+    wdb_t *wdb = NULL;
+    os_calloc(1, sizeof(wdb_t), wdb);
+    os_strdup("000", wdb->id);
+
+    will_return(__wrap_sqlite3_prepare_v2, 1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_ERROR);
+    will_return(__wrap_sqlite3_errmsg, "ERROR MESSAGE");
+    expect_string(__wrap__mdebug1, formatted_msg, "SQLite: ERROR MESSAGE");
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+
+    assert_int_equal(wdb_incremental_vacuum(wdb, 16, 50), OS_INVALID);
+
+    os_free(wdb->id);
+    os_free(wdb);
+}
+
+/* Tests wdb_reclaim_free_pages */
+
+void test_wdb_reclaim_free_pages_disabled(void **state)
+{
+    wconfig.vacuum_step_pages = 0;
+
+    // Nothing is locked or queried
+    wdb_reclaim_free_pages();
+}
+
+void test_wdb_reclaim_free_pages_skip_busy(void **state)
+{
+    wconfig.vacuum_step_pages = 16;
+    wconfig.commit_time_min = 10;
+
+    os_calloc(1, sizeof(wdb_t), db_pool_begin);
+    os_strdup("000", db_pool_begin->id);
+    db_pool_begin->refcount = 1;
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    will_return(__wrap_time, 100);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    wdb_reclaim_free_pages();
+
+    wconfig.vacuum_step_pages = 0;
+    os_free(db_pool_begin->id);
+    os_free(db_pool_begin);
+}
+
+void test_wdb_reclaim_free_pages_highest_ratio(void **state)
+{
+    wdb_t *second = NULL;
+
+    wconfig.vacuum_step_pages = 16;
+    wconfig.vacuum_step_time = 50;
+    wconfig.commit_time_min = 10;
+
+    os_calloc(1, sizeof(wdb_t), db_pool_begin);
+    os_strdup("000", db_pool_begin->id);
+    os_calloc(1, sizeof(wdb_t), second);
+    os_strdup("001", second->id);
+    db_pool_begin->next = second;
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    will_return(__wrap_time, 100);
+
+    // 000: 10 of 100 pages are free
+    expect_function_call(__wrap_pthread_mutex_lock);
+    will_return(__wrap_sqlite3_prepare_v2, 1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 10);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 100);
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    // 001: 50 of 100 pages are free
+    expect_function_call(__wrap_pthread_mutex_lock);
+    will_return(__wrap_sqlite3_prepare_v2, 1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_ROW);
+    expect_value(__wrap_sqlite3_column_int, iCol, 0);
+    will_return(__wrap_sqlite3_column_int, 50);
+    expect_value(__wrap_sqlite3_column_int, iCol, 1);
+    will_return(__wrap_sqlite3_column_int, 100);
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    expect_function_call(__wrap_pthread_mutex_lock);
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    // wdb_incremental_vacuum
+    will_return(__wrap_sqlite3_prepare_v2, 1);
+    will_return(__wrap_sqlite3_prepare_v2, SQLITE_OK);
+    expect_sqlite3_step_call(SQLITE_ROW);
+    will_return(__wrap_time_diff, 0.001);
+    expect_sqlite3_step_call(SQLITE_DONE);
+    will_return(__wrap_sqlite3_finalize, SQLITE_OK);
+
+    expect_string(__wrap__mdebug2, formatted_msg, "Incremental vacuum released 1 pages of the '001' database (50.0% free).");
+    expect_function_call(__wrap_pthread_mutex_unlock);
+
+    wdb_reclaim_free_pages();
+
+    assert_int_equal(second->refcount, 0);
+
+    wconfig.vacuum_step_pages = 0;
+    os_free(second->id);
+    os_free(second);
+    os_free(db_pool_begin->id);
+    os_free(db_pool_begin);
+}
+
 int main() {
     const struct CMUnitTest tests[] = {
         // wdb_open_tasks
@@ -3156,12 +3755,30 @@ int main() {
         cmocka_unit_test_setup_teardown(test_wdb_exec_row_stmt_single_column_sql_error, setup_wdb, teardown_wdb),
         // wdb_leave
         cmocka_unit_test(test_wdb_leave),
+        cmocka_unit_test(test_wdb_leave_commit_queries_max),
+        cmocka_unit_test(test_wdb_leave_commit_queries_max_read_only),
         // wdb_finalize_all_statements
         cmocka_unit_test(test_wdb_finalize_all_statements),
+        // wdb_get_cache_stmt
+        cmocka_unit_test(test_wdb_get_cache_stmt_lru),
+        cmocka_unit_test(test_wdb_get_cache_stmt_evict),
+        cmocka_unit_test(test_wdb_get_cache_stmt_prepare_error),
+        // wdb_cursor
+        cmocka_unit_test(test_wdb_cursor_open_single_chunk),
+        cmocka_unit_test(test_wdb_cursor_chunks),
+        cmocka_unit_test(test_wdb_cursor_open_not_readonly),
+        cmocka_unit_test(test_wdb_cursor_next_expired),
         // wdb_close
         cmocka_unit_test(test_wdb_close_refcount_error),
         cmocka_unit_test(test_wdb_close_no_commit_sqlerror),
         cmocka_unit_test(test_wdb_close_success),
+        // wdb_pool_touch
+        cmocka_unit_test(test_wdb_pool_touch),
+        cmocka_unit_test(test_wdb_pool_2q),
+        // Commit deadlines
+        cmocka_unit_test(test_wdb_commit_heap),
+        cmocka_unit_test(test_wdb_commit_old_node_closed),
+        cmocka_unit_test(test_wdb_commit_old_not_due),
         // wdb_get_db_free_pages_percentage
         cmocka_unit_test(test_wdb_get_db_free_pages_percentage_page_count_error),
         cmocka_unit_test(test_wdb_get_db_free_pages_percentage_page_free_error),
@@ -3211,6 +3828,14 @@ int main() {
         cmocka_unit_test(test_wdb_check_fragmentation_no_vacuum_current_fragmentation_delta),
         cmocka_unit_test(test_wdb_check_fragmentation_vacuum_first),
         cmocka_unit_test(test_wdb_check_fragmentation_vacuum_current_fragmentation_delta),
+        // wdb_incremental_vacuum
+        cmocka_unit_test(test_wdb_incremental_vacuum_done),
+        cmocka_unit_test(test_wdb_incremental_vacuum_time_limit),
+        cmocka_unit_test(test_wdb_incremental_vacuum_error),
+        // wdb_reclaim_free_pages
+        cmocka_unit_test(test_wdb_reclaim_free_pages_disabled),
+        cmocka_unit_test(test_wdb_reclaim_free_pages_skip_busy),
+        cmocka_unit_test(test_wdb_reclaim_free_pages_highest_ratio),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -4013,6 +4013,35 @@ void test_wdb_global_update_agent_keepalive_success(void **state)
     assert_int_equal(result, OS_SUCCESS);
 }
 
+/* Tests wdb_global_update_agents_keepalive */
+
+void test_wdb_global_update_agents_keepalive_success(void **state)
+{
+    int result = 0;
+    test_struct_t *data  = (test_struct_t *)*state;
+    const char *connection_status = "active";
+    const char *status = "synced";
+    const char *ids = "[1,2,3]";
+
+    will_return(__wrap_wdb_begin2, 1);
+    will_return(__wrap_wdb_stmt_cache, 1);
+
+    expect_value(__wrap_sqlite3_bind_text, pos, 1);
+    expect_value(__wrap_sqlite3_bind_text, buffer, connection_status);
+    will_return(__wrap_sqlite3_bind_text, SQLITE_OK);
+    expect_value(__wrap_sqlite3_bind_text, pos, 2);
+    expect_value(__wrap_sqlite3_bind_text, buffer, status);
+    will_return(__wrap_sqlite3_bind_text, SQLITE_OK);
+    expect_value(__wrap_sqlite3_bind_text, pos, 3);
+    expect_value(__wrap_sqlite3_bind_text, buffer, ids);
+    will_return(__wrap_sqlite3_bind_text, SQLITE_OK);
+    will_return(__wrap_wdb_exec_stmt_silent, OS_SUCCESS);
+
+    result = wdb_global_update_agents_keepalive(data->wdb, ids, connection_status, status);
+
+    assert_int_equal(result, OS_SUCCESS);
+}
+
 /* Tests wdb_global_update_agent_connection_status */
 
 void test_wdb_global_update_agent_connection_status_transaction_fail(void **state)
@@ -7173,6 +7202,161 @@ void test_wdb_global_create_backup_success(void **state) {
     __real_cJSON_Delete(j_path);
 }
 
+/* Tests wdb_global_create_backup_online */
+
+static void expect_backup_online_open(int ret) {
+    char* test_date = strdup("2015/11/23 12:00:00");
+
+    will_return(__wrap_time, (time_t)0);
+    expect_value(__wrap_w_get_timestamp, time, 0);
+    will_return(__wrap_w_get_timestamp, test_date);
+    expect_string(__wrap_sqlite3_open_v2, filename, "backup/db/global.db-backup-2015-11-23-12:00:00");
+    expect_value(__wrap_sqlite3_open_v2, flags, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+    will_return(__wrap_sqlite3_open_v2, (sqlite3 *)1);
+    will_return(__wrap_sqlite3_open_v2, ret);
+}
+
+void test_wdb_global_create_backup_online_open_failed(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+    int result = OS_INVALID;
+
+    expect_backup_online_open(SQLITE_CANTOPEN);
+    will_return(__wrap_sqlite3_errmsg, "ERROR MESSAGE");
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+
+    result = wdb_global_create_backup_online(data->wdb, data->output, NULL);
+
+    assert_string_equal(data->output, "err Cannot open backup file: ERROR MESSAGE");
+    assert_int_equal(result, OS_INVALID);
+}
+
+void test_wdb_global_create_backup_online_init_failed(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+    int result = OS_INVALID;
+
+    expect_backup_online_open(SQLITE_OK);
+    will_return(__wrap_sqlite3_backup_init, NULL);
+    will_return(__wrap_sqlite3_errmsg, "ERROR MESSAGE");
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+    expect_string(__wrap_unlink, file, "backup/db/global.db-backup-2015-11-23-12:00:00");
+    will_return(__wrap_unlink, OS_SUCCESS);
+
+    result = wdb_global_create_backup_online(data->wdb, data->output, NULL);
+
+    assert_string_equal(data->output, "err DB(global) sqlite3_backup_init(): ERROR MESSAGE");
+    assert_int_equal(result, OS_INVALID);
+}
+
+void test_wdb_global_create_backup_online_commit_failed(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+    int result = OS_INVALID;
+
+    expect_backup_online_open(SQLITE_OK);
+    will_return(__wrap_sqlite3_backup_init, (sqlite3_backup *)1);
+    will_return(__wrap_wdb_commit2, OS_INVALID);
+    will_return(__wrap_sqlite3_backup_finish, SQLITE_OK);
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+    expect_string(__wrap_unlink, file, "backup/db/global.db-backup-2015-11-23-12:00:00");
+    will_return(__wrap_unlink, OS_SUCCESS);
+
+    result = wdb_global_create_backup_online(data->wdb, data->output, NULL);
+
+    assert_string_equal(data->output, "err Cannot commit current transaction to create backup");
+    assert_int_equal(result, OS_INVALID);
+}
+
+void test_wdb_global_create_backup_online_step_failed(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+    int result = OS_INVALID;
+
+    wconfig.backup_step_pages = 256;
+    expect_backup_online_open(SQLITE_OK);
+    will_return(__wrap_sqlite3_backup_init, (sqlite3_backup *)1);
+    will_return(__wrap_wdb_commit2, OS_SUCCESS);
+    expect_value(__wrap_sqlite3_backup_step, nPage, 256);
+    will_return(__wrap_sqlite3_backup_step, SQLITE_IOERR);
+    will_return(__wrap_sqlite3_errmsg, "ERROR MESSAGE");
+    will_return(__wrap_sqlite3_backup_finish, SQLITE_IOERR);
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+    expect_string(__wrap_unlink, file, "backup/db/global.db-backup-2015-11-23-12:00:00");
+    will_return(__wrap_unlink, OS_SUCCESS);
+
+    result = wdb_global_create_backup_online(data->wdb, data->output, NULL);
+
+    assert_string_equal(data->output, "err SQLite: ERROR MESSAGE");
+    assert_int_equal(result, OS_INVALID);
+}
+
+void test_wdb_global_create_backup_online_disabled(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+    int result = OS_INVALID;
+
+    wconfig.backup_step_pages = 256;
+    wconfig.backup_step_delay = 0;
+    data->wdb->enabled = false;
+    w_mutex_lock(&data->wdb->mutex);
+
+    expect_backup_online_open(SQLITE_OK);
+    will_return(__wrap_sqlite3_backup_init, (sqlite3_backup *)1);
+    will_return(__wrap_wdb_commit2, OS_SUCCESS);
+    expect_value(__wrap_sqlite3_backup_step, nPage, 256);
+    will_return(__wrap_sqlite3_backup_step, SQLITE_OK);
+    will_return(__wrap_sqlite3_backup_finish, SQLITE_OK);
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+    expect_string(__wrap_unlink, file, "backup/db/global.db-backup-2015-11-23-12:00:00");
+    will_return(__wrap_unlink, OS_SUCCESS);
+
+    result = wdb_global_create_backup_online(data->wdb, data->output, NULL);
+
+    assert_string_equal(data->output, "err Global database disabled during backup");
+    assert_int_equal(result, OS_INVALID);
+    w_mutex_unlock(&data->wdb->mutex);
+}
+
+void test_wdb_global_create_backup_online_success(void **state) {
+    test_struct_t *data  = (test_struct_t *)*state;
+    int result = OS_INVALID;
+
+    wconfig.backup_step_pages = 256;
+    wconfig.backup_step_delay = 0;
+    data->wdb->enabled = true;
+    w_mutex_lock(&data->wdb->mutex);
+
+    expect_backup_online_open(SQLITE_OK);
+    will_return(__wrap_sqlite3_backup_init, (sqlite3_backup *)1);
+
+    // The database is released after the first step, and the second one copies the last pages
+    will_return(__wrap_wdb_commit2, OS_SUCCESS);
+    expect_value(__wrap_sqlite3_backup_step, nPage, 256);
+    will_return(__wrap_sqlite3_backup_step, SQLITE_OK);
+    will_return(__wrap_wdb_commit2, OS_SUCCESS);
+    expect_value(__wrap_sqlite3_backup_step, nPage, 256);
+    will_return(__wrap_sqlite3_backup_step, SQLITE_DONE);
+    will_return(__wrap_sqlite3_backup_finish, SQLITE_OK);
+    will_return(__wrap_sqlite3_close_v2, SQLITE_OK);
+
+    expect_string(__wrap_w_compress_gzfile, filesrc, "backup/db/global.db-backup-2015-11-23-12:00:00");
+    expect_string(__wrap_w_compress_gzfile, filedst, "backup/db/global.db-backup-2015-11-23-12:00:00.gz");
+    will_return(__wrap_w_compress_gzfile, OS_SUCCESS);
+    expect_string(__wrap_unlink, file, "backup/db/global.db-backup-2015-11-23-12:00:00");
+    will_return(__wrap_unlink, OS_SUCCESS);
+    expect_string(__wrap__minfo, formatted_msg, "Created Global database backup \"backup/db/global.db-backup-2015-11-23-12:00:00.gz\"");
+    cJSON* j_path = __real_cJSON_CreateArray();
+    will_return(__wrap_cJSON_CreateArray, j_path);
+    expect_function_call(__wrap_cJSON_Delete);
+
+    // wdb_global_remove_old_backups
+    will_return(__wrap_opendir, NULL);
+    expect_string(__wrap__mdebug1, formatted_msg, "Unable to open backup directory 'backup/db'");
+
+    result = wdb_global_create_backup_online(data->wdb, data->output, NULL);
+
+    assert_string_equal(data->output, "ok [\"backup/db/global.db-backup-2015-11-23-12:00:00.gz\"]");
+    assert_int_equal(result, OS_SUCCESS);
+    w_mutex_unlock(&data->wdb->mutex);
+    __real_cJSON_Delete(j_path);
+}
+
 /* Tests wdb_global_remove_old_backups */
 
 void test_wdb_global_remove_old_backups_opendir_failed(void **state) {
@@ -9303,6 +9487,7 @@ int main()
         cmocka_unit_test_setup_teardown(test_wdb_global_update_agent_keepalive_bind3_fail, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_global_update_agent_keepalive_step_fail, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_global_update_agent_keepalive_success, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_global_update_agents_keepalive_success, test_setup, test_teardown),
         /* Tests wdb_global_update_agent_connection_status */
         cmocka_unit_test_setup_teardown(test_wdb_global_update_agent_connection_status_transaction_fail,
                                         test_setup,
@@ -9520,6 +9705,13 @@ int main()
         cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_exec_failed, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_compress_failed, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_success, test_setup, test_teardown),
+        /* Tests wdb_global_create_backup_online */
+        cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_online_open_failed, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_online_init_failed, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_online_commit_failed, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_online_step_failed, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_online_disabled, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_global_create_backup_online_success, test_setup, test_teardown),
         /* Tests wdb_global_remove_old_backups */
         cmocka_unit_test_setup_teardown(test_wdb_global_remove_old_backups_opendir_failed, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_global_remove_old_backups_success_without_removing,
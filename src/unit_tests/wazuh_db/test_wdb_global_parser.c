@@ -368,6 +368,74 @@ void test_wdb_parse_global_insert_agent_success(void **state)
     assert_int_equal(ret, OS_SUCCESS);
 }
 
+void test_wdb_parse_global_insert_agent_batch_success(void **state)
+{
+    int ret = 0;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char query[OS_BUFFER_SIZE] = "global insert-agent {\"agents\":[{\"id\":1,\"name\":\"test_name\",\"date_add\":123},\
+{\"id\":2,\"name\":\"test_name2\",\"date_add\":456}]}";
+
+    will_return(__wrap_wdb_open_global, data->wdb);
+    expect_string(__wrap__mdebug2, formatted_msg, "Global query: insert-agent {\"agents\":[{\"id\":1,\"name\":\"test_name\",\"date_add\":123},\
+{\"id\":2,\"name\":\"test_name2\",\"date_add\":456}]}");
+
+    expect_value(__wrap_wdb_global_insert_agent, id, 1);
+    expect_string(__wrap_wdb_global_insert_agent, name, "test_name");
+    expect_value(__wrap_wdb_global_insert_agent, ip, NULL);
+    expect_value(__wrap_wdb_global_insert_agent, register_ip, NULL);
+    expect_value(__wrap_wdb_global_insert_agent, internal_key, NULL);
+    expect_value(__wrap_wdb_global_insert_agent, group, NULL);
+    expect_value(__wrap_wdb_global_insert_agent, date_add, 123);
+    will_return(__wrap_wdb_global_insert_agent, OS_SUCCESS);
+
+    expect_value(__wrap_wdb_global_insert_agent, id, 2);
+    expect_string(__wrap_wdb_global_insert_agent, name, "test_name2");
+    expect_value(__wrap_wdb_global_insert_agent, ip, NULL);
+    expect_value(__wrap_wdb_global_insert_agent, register_ip, NULL);
+    expect_value(__wrap_wdb_global_insert_agent, internal_key, NULL);
+    expect_value(__wrap_wdb_global_insert_agent, group, NULL);
+    expect_value(__wrap_wdb_global_insert_agent, date_add, 456);
+    will_return(__wrap_wdb_global_insert_agent, OS_SUCCESS);
+
+    expect_function_call(__wrap_w_inc_queries_total);
+    expect_function_call(__wrap_w_inc_global);
+    expect_function_call(__wrap_w_inc_global_agent_insert_agent);
+    expect_function_call(__wrap_gettimeofday);
+    expect_function_call(__wrap_gettimeofday);
+    expect_function_call(__wrap_w_inc_global_agent_insert_agent_time);
+
+    ret = wdb_parse(query, data->output, 0);
+
+    assert_string_equal(data->output, "ok");
+    assert_int_equal(ret, OS_SUCCESS);
+}
+
+void test_wdb_parse_global_insert_agent_batch_compliant_error(void **state)
+{
+    int ret = 0;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char query[OS_BUFFER_SIZE] = "global insert-agent {\"agents\":[{\"id\":1,\"date_add\":123}]}";
+
+    will_return(__wrap_wdb_open_global, data->wdb);
+    expect_string(__wrap__mdebug2, formatted_msg, "Global query: insert-agent {\"agents\":[{\"id\":1,\"date_add\":123}]}");
+    expect_string(__wrap__mdebug1, formatted_msg, "Global DB Invalid JSON data when inserting agent. Not compliant with constraints defined in the database.");
+
+    expect_function_call(__wrap_w_inc_queries_total);
+    expect_function_call(__wrap_w_inc_global);
+    expect_function_call(__wrap_w_inc_global_agent_insert_agent);
+    expect_function_call(__wrap_gettimeofday);
+    expect_function_call(__wrap_gettimeofday);
+    expect_function_call(__wrap_w_inc_global_agent_insert_agent_time);
+
+    expect_string(__wrap_w_is_file, file, "queue/db/global.db");
+    will_return(__wrap_w_is_file, 1);
+
+    ret = wdb_parse(query, data->output, 0);
+
+    assert_string_equal(data->output, "err Invalid JSON data, near '{\"agents\":[{\"id\":1,\"date_add\":12'");
+    assert_int_equal(ret, OS_INVALID);
+}
+
 /* Tests wdb_parse_global_update_agent_name */
 
 void test_wdb_parse_global_update_agent_name_syntax_error(void **state)
@@ -4435,6 +4503,8 @@ int main()
         cmocka_unit_test_setup_teardown(test_wdb_parse_global_insert_agent_compliant_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_parse_global_insert_agent_query_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_parse_global_insert_agent_success, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_parse_global_insert_agent_batch_success, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_parse_global_insert_agent_batch_compliant_error, test_setup, test_teardown),
         /* Tests wdb_parse_global_update_agent_name */
         cmocka_unit_test_setup_teardown(test_wdb_parse_global_update_agent_name_syntax_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_parse_global_update_agent_name_invalid_json, test_setup, test_teardown),
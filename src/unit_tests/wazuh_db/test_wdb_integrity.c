@@ -27,6 +27,7 @@
 #include "os_err.h"
 
 int wdb_calculate_stmt_checksum(wdb_t * wdb, sqlite3_stmt * stmt, wdb_component_t component, os_sha1 hexdigest, const char * pk_value);
+int wdb_calculate_stmt_checksum_algorithm(wdb_t * wdb, sqlite3_stmt * stmt, wdb_component_t component, wdb_checksum_algorithm_t algorithm, os_sha1 hexdigest, const char * pk_value);
 extern os_sha1 global_group_hash;
 
 /* setup/teardown */
@@ -161,6 +162,33 @@ static void test_wdb_calculate_stmt_checksum_duplicate_entries_found(void **stat
     assert_int_equal(ret, 1);
 }
 
+static void test_wdb_calculate_stmt_checksum_sum_success(void **state) {
+    int ret;
+
+    wdb_t *data = *state;
+    data->id = strdup("000");
+    sqlite3_stmt *stmt = (sqlite3_stmt *)1;
+    os_sha1 test_hex = {0};
+
+    will_return(__wrap_sqlite3_step, 0);
+    will_return(__wrap_sqlite3_step, 100);
+    expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, "00000000000000000000000000000000000000ff");
+    // Next iteration
+    will_return(__wrap_sqlite3_step, 0);
+    will_return(__wrap_sqlite3_step, 100);
+    expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, "0000000000000000000000000000000000000002");
+    // No more rows
+    will_return(__wrap_sqlite3_step, 0);
+    will_return(__wrap_sqlite3_step, 0);
+
+    ret = wdb_calculate_stmt_checksum_algorithm(data, stmt, WDB_FIM, WDB_CHECKSUM_SUM, test_hex, NULL);
+
+    assert_int_equal(ret, 1);
+    assert_string_equal(test_hex, "0000000000000000000000000000000000000101");
+}
+
 // Tests wdbi_checksum
 static void test_wdbi_checksum_wdb_null(void **state) {
     expect_assert_failure(wdbi_checksum(NULL, 0, ""));
@@ -894,6 +922,19 @@ void test_wdbi_query_checksum_no_id(void **state) {
     assert_int_equal(ret, INTEGRITY_SYNC_ERR);
 }
 
+void test_wdbi_query_checksum_unsupported_algorithm(void **state) {
+    wdb_t *data = *state;
+    int ret;
+    os_strdup("000", data->id);
+    const char * payload = "{\"begin\":\"something\",\"end\":\"something\",\"checksum\":\"something\",\"id\":1234,\"algorithm\":\"md5\"}";
+
+    expect_string(__wrap__mdebug1, formatted_msg, "Unsupported checksum 'algorithm' in JSON payload.");
+
+    ret = wdbi_query_checksum(data, WDB_FIM, INTEGRITY_CHECK_GLOBAL, payload);
+
+    assert_int_equal(ret, INTEGRITY_SYNC_ERR);
+}
+
 void test_wdbi_query_checksum_range_fail(void **state) {
     wdb_t *data = *state;
     int ret;
@@ -1225,6 +1266,72 @@ void test_wdbi_query_checksum_last_manager_diff(void **state) {
     assert_int_equal(ret, INTEGRITY_SYNC_CKS_OK);
 }
 
+static void expect_wdbi_checksum_range_null_row(const char * begin, const char * end) {
+    will_return(__wrap_wdb_stmt_cache, 0);
+    expect_value(__wrap_sqlite3_bind_text, pos, 1);
+    expect_string(__wrap_sqlite3_bind_text, buffer, begin);
+    will_return(__wrap_sqlite3_bind_text, 0);
+    expect_value(__wrap_sqlite3_bind_text, pos, 2);
+    expect_string(__wrap_sqlite3_bind_text, buffer, end);
+    will_return(__wrap_sqlite3_bind_text, 0);
+    will_return(__wrap_sqlite3_step, 0);
+    will_return(__wrap_sqlite3_step, 100);
+    expect_value(__wrap_sqlite3_column_text, iCol, 0);
+    will_return(__wrap_sqlite3_column_text, NULL);
+    will_return(__wrap_sqlite3_step, 0);
+    will_return(__wrap_sqlite3_step, 101);
+    expect_string(__wrap__mdebug1, formatted_msg, "DB(000) has a NULL fim checksum.");
+}
+
+void test_wdbi_query_checksum_range_reused(void **state) {
+    wdb_t *data = *state;
+    os_strdup("000", data->id);
+    const char * payload = "{\"begin\":\"a\",\"end\":\"b\",\"checksum\":\"something\",\"id\":1234}";
+
+    // Computed
+    expect_wdbi_checksum_range_null_row("a", "b");
+    expect_any(__wrap__mdebug2, formatted_msg);
+    will_return(__wrap_sqlite3_total_changes64, 5);
+
+    assert_int_equal(wdbi_query_checksum(data, WDB_FIM, INTEGRITY_CLEAR, payload), INTEGRITY_SYNC_CKS_FAIL);
+
+    // Reused while no row changes
+    will_return(__wrap_sqlite3_total_changes64, 5);
+    expect_string(__wrap__mdebug2, formatted_msg, "Agent '000' fim range checksum reused.");
+    expect_any(__wrap__mdebug2, formatted_msg);
+    will_return(__wrap_sqlite3_total_changes64, 5);
+
+    assert_int_equal(wdbi_query_checksum(data, WDB_FIM, INTEGRITY_CLEAR, payload), INTEGRITY_SYNC_CKS_FAIL);
+}
+
+void test_wdbi_query_checksum_range_changed(void **state) {
+    wdb_t *data = *state;
+    os_strdup("000", data->id);
+    const char * payload_ab = "{\"begin\":\"a\",\"end\":\"b\",\"checksum\":\"something\",\"id\":1234}";
+    const char * payload_ac = "{\"begin\":\"a\",\"end\":\"c\",\"checksum\":\"something\",\"id\":1234}";
+
+    expect_wdbi_checksum_range_null_row("a", "b");
+    expect_any(__wrap__mdebug2, formatted_msg);
+    will_return(__wrap_sqlite3_total_changes64, 5);
+
+    assert_int_equal(wdbi_query_checksum(data, WDB_FIM, INTEGRITY_CLEAR, payload_ab), INTEGRITY_SYNC_CKS_FAIL);
+
+    // Computed again after a row change
+    will_return(__wrap_sqlite3_total_changes64, 6);
+    expect_wdbi_checksum_range_null_row("a", "b");
+    expect_any(__wrap__mdebug2, formatted_msg);
+    will_return(__wrap_sqlite3_total_changes64, 6);
+
+    assert_int_equal(wdbi_query_checksum(data, WDB_FIM, INTEGRITY_CLEAR, payload_ab), INTEGRITY_SYNC_CKS_FAIL);
+
+    // Computed for another range
+    expect_wdbi_checksum_range_null_row("a", "c");
+    expect_any(__wrap__mdebug2, formatted_msg);
+    will_return(__wrap_sqlite3_total_changes64, 6);
+
+    assert_int_equal(wdbi_query_checksum(data, WDB_FIM, INTEGRITY_CLEAR, payload_ac), INTEGRITY_SYNC_CKS_FAIL);
+}
+
 // Test wdbi_get_last_manager_checksum
 void test_wdbi_get_last_manager_checksum_success(void **state) {
     wdb_t *data = *state;
@@ -1769,6 +1876,7 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_wdb_calculate_stmt_checksum_no_row, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdb_calculate_stmt_checksum_success, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdb_calculate_stmt_checksum_duplicate_entries_found, setup_wdb_t, teardown_wdb_t),
+        cmocka_unit_test_setup_teardown(test_wdb_calculate_stmt_checksum_sum_success, setup_wdb_t, teardown_wdb_t),
         //Test wdbi_checksum_range
         cmocka_unit_test(test_wdbi_checksum_wdb_null),
         cmocka_unit_test_setup_teardown(test_wdbi_checksum_hexdigest_null, setup_wdb_t, teardown_wdb_t),
@@ -1819,6 +1927,7 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_no_end, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_no_checksum, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_no_id, setup_wdb_t, teardown_wdb_t),
+        cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_unsupported_algorithm, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_range_fail, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_range_no_data, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_diff_hexdigest, setup_wdb_t, teardown_wdb_t),
@@ -1828,6 +1937,8 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_check_left_ok, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_last_manager_success, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_last_manager_diff, setup_wdb_t, teardown_wdb_t),
+        cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_range_reused, setup_wdb_t, teardown_wdb_t),
+        cmocka_unit_test_setup_teardown(test_wdbi_query_checksum_range_changed, setup_wdb_t, teardown_wdb_t),
         // Test wdbi_get_last_manager_checksum
         cmocka_unit_test_setup_teardown(test_wdbi_get_last_manager_checksum_success, setup_wdb_t, teardown_wdb_t),
         cmocka_unit_test_setup_teardown(test_wdbi_get_last_manager_stmt_cache_fail, setup_wdb_t, teardown_wdb_t),
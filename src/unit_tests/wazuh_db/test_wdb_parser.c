@@ -447,6 +447,57 @@ void test_syscheck_save2_ok(void **state) {
     os_free(query);
 }
 
+void test_syscheck_save2_batch_ok(void **state) {
+    int ret;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *query = strdup("save2_batch 14:{\"index\":\"/a\"}14:{\"index\":\"/b\"}");
+
+    will_return_count(__wrap_wdb_syscheck_save2, 1, 2);
+
+    ret = wdb_parse_syscheck(data->wdb, WDB_FIM_FILE, query, data->output);
+
+    assert_string_equal(data->output, "ok");
+    assert_int_equal(ret, 0);
+    // The rows are restored after being saved
+    assert_string_equal(query + 12, "14:{\"index\":\"/a\"}14:{\"index\":\"/b\"}");
+
+    os_free(query);
+}
+
+void test_syscheck_save2_batch_row_error(void **state) {
+    int ret;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *query = strdup("save2_batch 2:{}2:{}2:{}");
+
+    will_return(__wrap_wdb_syscheck_save2, 1);
+    will_return(__wrap_wdb_syscheck_save2, -1);
+    will_return(__wrap_wdb_syscheck_save2, 1);
+    expect_string(__wrap__mdebug1, formatted_msg, "DB(000) Cannot save 1 of 3 rows.");
+
+    ret = wdb_parse_syscheck(data->wdb, WDB_FIM_FILE, query, data->output);
+
+    assert_string_equal(data->output, "err Cannot save 1 of 3 rows");
+    assert_int_equal(ret, -1);
+
+    os_free(query);
+}
+
+void test_syscheck_save2_batch_invalid_framing(void **state) {
+    int ret;
+    test_struct_t *data  = (test_struct_t *)*state;
+    char *query = strdup("save2_batch 2:{}9:{}");
+
+    will_return(__wrap_wdb_syscheck_save2, 1);
+    expect_string(__wrap__mdebug1, formatted_msg, "DB(000) Invalid save2 batch framing after 1 rows.");
+
+    ret = wdb_parse_syscheck(data->wdb, WDB_FIM_FILE, query, data->output);
+
+    assert_string_equal(data->output, "err Invalid batch framing, near '9:{}'");
+    assert_int_equal(ret, -1);
+
+    os_free(query);
+}
+
 void test_integrity_check_error(void **state) {
     int ret;
     test_struct_t *data  = (test_struct_t *)*state;
@@ -2904,6 +2955,9 @@ int main()
         cmocka_unit_test_setup_teardown(test_syscheck_save_registry_type_ok, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_syscheck_save2_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_syscheck_save2_ok, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_syscheck_save2_batch_ok, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_syscheck_save2_batch_row_error, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_syscheck_save2_batch_invalid_framing, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_integrity_check_error, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_integrity_check_no_data, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_integrity_check_checksum_fail, test_setup, test_teardown),
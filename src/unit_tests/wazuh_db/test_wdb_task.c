@@ -1473,6 +1473,94 @@ void test_wdb_task_cancel_upgrade_tasks_begin2_err(void **state)
     assert_int_equal(ret, OS_INVALID);
 }
 
+void test_wdb_task_get_summary_cached(void **state)
+{
+    cJSON *summary = NULL;
+    cJSON *rows = cJSON_Parse("[{\"node\":\"master\",\"module\":\"upgrade_module\",\"command\":\"upgrade\",\"status\":\"Done\",\"total\":3}]");
+
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    will_return(__wrap_wdb_begin2, 1);
+    will_return(__wrap_wdb_stmt_cache, 1);
+    will_return(__wrap_wdb_exec_stmt, rows);
+
+    assert_int_equal(wdb_task_get_summary(data->wdb, &summary), OS_SUCCESS);
+    assert_true(cJSON_Compare(summary, rows, true));
+    cJSON_Delete(summary);
+
+    // The second request doesn't query the DB
+    assert_int_equal(wdb_task_get_summary(data->wdb, &summary), OS_SUCCESS);
+    assert_true(cJSON_Compare(summary, rows, true));
+    cJSON_Delete(summary);
+
+    wdb_task_reset_summary();
+}
+
+void test_wdb_task_get_summary_reset_on_change(void **state)
+{
+    int timestamp = 12345;
+    cJSON *summary = NULL;
+
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    will_return(__wrap_wdb_begin2, 1);
+    will_return(__wrap_wdb_stmt_cache, 1);
+    will_return(__wrap_wdb_exec_stmt, cJSON_CreateArray());
+
+    assert_int_equal(wdb_task_get_summary(data->wdb, &summary), OS_SUCCESS);
+    cJSON_Delete(summary);
+
+    will_return(__wrap_wdb_begin2, 1);
+    will_return(__wrap_wdb_stmt_cache, 1);
+    expect_value(__wrap_sqlite3_bind_int, index, 1);
+    expect_value(__wrap_sqlite3_bind_int, value, timestamp);
+    will_return(__wrap_sqlite3_bind_int, 0);
+    will_return(__wrap_wdb_step, SQLITE_DONE);
+
+    assert_int_equal(wdb_task_delete_old_entries(data->wdb, timestamp), OS_SUCCESS);
+
+    // The deletion drops the summary, it's queried again
+    will_return(__wrap_wdb_begin2, 1);
+    will_return(__wrap_wdb_stmt_cache, 1);
+    will_return(__wrap_wdb_exec_stmt, cJSON_CreateArray());
+
+    assert_int_equal(wdb_task_get_summary(data->wdb, &summary), OS_SUCCESS);
+    assert_int_equal(cJSON_GetArraySize(summary), 0);
+    cJSON_Delete(summary);
+
+    wdb_task_reset_summary();
+}
+
+void test_wdb_task_get_summary_exec_err(void **state)
+{
+    cJSON *summary = NULL;
+
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    will_return(__wrap_wdb_begin2, 1);
+    will_return(__wrap_wdb_stmt_cache, 1);
+    will_return(__wrap_wdb_exec_stmt, NULL);
+    will_return(__wrap_sqlite3_errmsg, "ERROR MESSAGE");
+    expect_string(__wrap__merror, formatted_msg, "(5211): SQL error: 'ERROR MESSAGE'");
+
+    assert_int_equal(wdb_task_get_summary(data->wdb, &summary), OS_INVALID);
+    assert_null(summary);
+}
+
+void test_wdb_task_get_summary_cache_err(void **state)
+{
+    cJSON *summary = NULL;
+
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    will_return(__wrap_wdb_begin2, 1);
+    will_return(__wrap_wdb_stmt_cache, -1);
+    expect_any(__wrap__mdebug1, formatted_msg);
+
+    assert_int_equal(wdb_task_get_summary(data->wdb, &summary), OS_INVALID);
+    assert_null(summary);
+}
+
 int main(void) {
     const struct CMUnitTest tests[] = {
         // wdb_task_delete_old_entries
@@ -1525,7 +1613,12 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_wdb_task_cancel_upgrade_tasks_ok, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_task_cancel_upgrade_tasks_step_err, test_setup, test_teardown),
         cmocka_unit_test_setup_teardown(test_wdb_task_cancel_upgrade_tasks_cache_err, test_setup, test_teardown),
-        cmocka_unit_test_setup_teardown(test_wdb_task_cancel_upgrade_tasks_begin2_err, test_setup, test_teardown)
+        cmocka_unit_test_setup_teardown(test_wdb_task_cancel_upgrade_tasks_begin2_err, test_setup, test_teardown),
+        // wdb_task_get_summary
+        cmocka_unit_test_setup_teardown(test_wdb_task_get_summary_cached, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_task_get_summary_reset_on_change, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_task_get_summary_exec_err, test_setup, test_teardown),
+        cmocka_unit_test_setup_teardown(test_wdb_task_get_summary_cache_err, test_setup, test_teardown)
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
@@ -563,6 +563,64 @@ void test_wdb_parse_task_upgrade_update_status_agent_err(void **state)
     assert_string_equal(output, "err Error upgrade update status task: 'parsing agent error'");
 }
 
+void test_wdb_parse_task_upgrade_update_status_agents_ok(void **state)
+{
+    char *node = "master";
+    char *status = "Done";
+
+    char output[OS_MAXSTR + 1];
+    *output = '\0';
+
+    cJSON *parameters = cJSON_CreateObject();
+    cJSON *agents = cJSON_CreateArray();
+    cJSON_AddItemToArray(agents, cJSON_CreateNumber(15));
+    cJSON_AddItemToArray(agents, cJSON_CreateNumber(16));
+    cJSON_AddItemToObject(parameters, "agents", agents);
+    cJSON_AddStringToObject(parameters, "node", node);
+    cJSON_AddStringToObject(parameters, "status", status);
+
+    expect_value(__wrap_wdb_task_update_upgrade_task_status, agent_id, 15);
+    expect_string(__wrap_wdb_task_update_upgrade_task_status, node, node);
+    expect_string(__wrap_wdb_task_update_upgrade_task_status, status, status);
+    will_return(__wrap_wdb_task_update_upgrade_task_status, 0);
+
+    expect_value(__wrap_wdb_task_update_upgrade_task_status, agent_id, 16);
+    expect_string(__wrap_wdb_task_update_upgrade_task_status, node, node);
+    expect_string(__wrap_wdb_task_update_upgrade_task_status, status, status);
+    will_return(__wrap_wdb_task_update_upgrade_task_status, OS_NOTFOUND);
+
+    int result = wdb_parse_task_upgrade_update_status((wdb_t*)1, parameters, output);
+
+    *state = (void*)parameters;
+
+    assert_int_equal(result, 0);
+    assert_string_equal(output, "ok {\"error\":0,\"data\":[{\"agent\":15,\"error\":0},{\"agent\":16,\"error\":-2}]}");
+}
+
+void test_wdb_parse_task_upgrade_update_status_agents_err(void **state)
+{
+    char *node = "master";
+    char *status = "Done";
+
+    char output[OS_MAXSTR + 1];
+    *output = '\0';
+
+    cJSON *parameters = cJSON_CreateObject();
+    cJSON *agents = cJSON_CreateArray();
+    cJSON_AddItemToArray(agents, cJSON_CreateNumber(15));
+    cJSON_AddItemToArray(agents, cJSON_CreateString("16"));
+    cJSON_AddItemToObject(parameters, "agents", agents);
+    cJSON_AddStringToObject(parameters, "node", node);
+    cJSON_AddStringToObject(parameters, "status", status);
+
+    int result = wdb_parse_task_upgrade_update_status((wdb_t*)1, parameters, output);
+
+    *state = (void*)parameters;
+
+    assert_int_equal(result, OS_INVALID);
+    assert_string_equal(output, "err Error upgrade update status task: 'parsing agents error'");
+}
+
 void test_wdb_parse_task_upgrade_result_ok(void **state)
 {
     int agent_id = 15;
@@ -851,6 +909,43 @@ void test_wdb_parse_task_delete_old_timestamp_err(void **state)
     assert_string_equal(output, "err Error delete old task: 'parsing timestamp error'");
 }
 
+void test_wdb_parse_task_summary_ok(void **state)
+{
+    char output[OS_MAXSTR + 1];
+    *output = '\0';
+
+    cJSON *summary = cJSON_CreateArray();
+    cJSON *row = cJSON_CreateObject();
+    cJSON_AddStringToObject(row, "node", "master");
+    cJSON_AddStringToObject(row, "module", "upgrade_module");
+    cJSON_AddStringToObject(row, "command", "upgrade");
+    cJSON_AddStringToObject(row, "status", "In progress");
+    cJSON_AddNumberToObject(row, "total", 120);
+    cJSON_AddItemToArray(summary, row);
+
+    will_return(__wrap_wdb_task_get_summary, summary);
+    will_return(__wrap_wdb_task_get_summary, OS_SUCCESS);
+
+    int result = wdb_parse_task_summary((wdb_t*)1, output);
+
+    assert_int_equal(result, OS_SUCCESS);
+    assert_string_equal(output, "ok {\"error\":0,\"data\":[{\"node\":\"master\",\"module\":\"upgrade_module\",\"command\":\"upgrade\",\"status\":\"In progress\",\"total\":120}]}");
+}
+
+void test_wdb_parse_task_summary_err(void **state)
+{
+    char output[OS_MAXSTR + 1];
+    *output = '\0';
+
+    will_return(__wrap_wdb_task_get_summary, NULL);
+    will_return(__wrap_wdb_task_get_summary, OS_INVALID);
+
+    int result = wdb_parse_task_summary((wdb_t*)1, output);
+
+    assert_int_equal(result, OS_INVALID);
+    assert_string_equal(output, "ok {\"error\":-1}");
+}
+
 int main()
 {
     const struct CMUnitTest tests[] = {
@@ -883,6 +978,8 @@ int main()
         cmocka_unit_test_teardown(test_wdb_parse_task_upgrade_update_status_status_err, teardown_json),
         cmocka_unit_test_teardown(test_wdb_parse_task_upgrade_update_status_node_err, teardown_json),
         cmocka_unit_test_teardown(test_wdb_parse_task_upgrade_update_status_agent_err, teardown_json),
+        cmocka_unit_test_teardown(test_wdb_parse_task_upgrade_update_status_agents_ok, teardown_json),
+        cmocka_unit_test_teardown(test_wdb_parse_task_upgrade_update_status_agents_err, teardown_json),
         // wdb_parse_task_upgrade_result
         cmocka_unit_test_teardown(test_wdb_parse_task_upgrade_result_ok, teardown_json),
         cmocka_unit_test_teardown(test_wdb_parse_task_upgrade_result_err, teardown_json),
@@ -899,7 +996,10 @@ int main()
         // wdb_parse_task_delete_old
         cmocka_unit_test_teardown(test_wdb_parse_task_delete_old_ok, teardown_json),
         cmocka_unit_test_teardown(test_wdb_parse_task_delete_old_err, teardown_json),
-        cmocka_unit_test_teardown(test_wdb_parse_task_delete_old_timestamp_err, teardown_json)
+        cmocka_unit_test_teardown(test_wdb_parse_task_delete_old_timestamp_err, teardown_json),
+        // wdb_parse_task_summary
+        cmocka_unit_test(test_wdb_parse_task_summary_ok),
+        cmocka_unit_test(test_wdb_parse_task_summary_err)
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
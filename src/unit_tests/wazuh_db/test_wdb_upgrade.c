@@ -817,6 +817,74 @@ void test_wdb_is_older_than_v310_step_ok(void **state) {
 }
 
 
+/* Tests wdb_upgrade_tasks */
+
+void test_wdb_upgrade_tasks_update_v1_to_v2_success(void **state)
+{
+    wdb_t *ret = NULL;
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    expect_string(__wrap_wdb_metadata_get_entry, key, "db_version");
+    will_return(__wrap_wdb_metadata_get_entry, "1");
+    will_return(__wrap_wdb_metadata_get_entry, OS_SUCCESS);
+
+    expect_string(__wrap__mdebug2, formatted_msg, "Updating database 'global' to version 2");
+    expect_string(__wrap_wdb_sql_exec, sql_exec, schema_task_manager_upgrade_v2_sql);
+    will_return(__wrap_wdb_sql_exec, 0);
+
+    ret = wdb_upgrade_tasks(data->wdb);
+
+    assert_int_equal(ret, data->wdb);
+}
+
+void test_wdb_upgrade_tasks_update_v1_to_v2_fail(void **state)
+{
+    wdb_t *ret = NULL;
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    expect_string(__wrap_wdb_metadata_get_entry, key, "db_version");
+    will_return(__wrap_wdb_metadata_get_entry, "1");
+    will_return(__wrap_wdb_metadata_get_entry, OS_SUCCESS);
+
+    expect_string(__wrap__mdebug2, formatted_msg, "Updating database 'global' to version 2");
+    expect_string(__wrap_wdb_sql_exec, sql_exec, schema_task_manager_upgrade_v2_sql);
+    will_return(__wrap_wdb_sql_exec, OS_INVALID);
+    expect_string(__wrap__merror, formatted_msg, "Failed to update global.db to version 2.");
+
+    ret = wdb_upgrade_tasks(data->wdb);
+
+    assert_int_equal(ret, data->wdb);
+}
+
+void test_wdb_upgrade_tasks_up_to_date(void **state)
+{
+    wdb_t *ret = NULL;
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    expect_string(__wrap_wdb_metadata_get_entry, key, "db_version");
+    will_return(__wrap_wdb_metadata_get_entry, "2");
+    will_return(__wrap_wdb_metadata_get_entry, OS_SUCCESS);
+
+    ret = wdb_upgrade_tasks(data->wdb);
+
+    assert_int_equal(ret, data->wdb);
+}
+
+void test_wdb_upgrade_tasks_error_getting_database_version(void **state)
+{
+    wdb_t *ret = NULL;
+    test_struct_t *data  = (test_struct_t *)*state;
+
+    expect_string(__wrap_wdb_metadata_get_entry, key, "db_version");
+    will_return(__wrap_wdb_metadata_get_entry, "1");
+    will_return(__wrap_wdb_metadata_get_entry, OS_INVALID);
+    expect_string(__wrap__mwarn, formatted_msg, "DB(global): Error trying to get DB version");
+
+    ret = wdb_upgrade_tasks(data->wdb);
+
+    assert_int_equal(ret, data->wdb);
+}
+
 int main()
 {
 
@@ -849,6 +917,10 @@ int main()
         cmocka_unit_test_setup_teardown(test_wdb_upgrade_global_update_v4_to_v5_fail, setup_wdb, teardown_wdb),
         cmocka_unit_test_setup_teardown(test_wdb_upgrade_global_update_v4_to_v5_success, setup_wdb, teardown_wdb),
         cmocka_unit_test_setup_teardown(test_wdb_upgrade_global_fail_backup_fail, setup_wdb, teardown_wdb),
+        cmocka_unit_test_setup_teardown(test_wdb_upgrade_tasks_update_v1_to_v2_success, setup_wdb, teardown_wdb),
+        cmocka_unit_test_setup_teardown(test_wdb_upgrade_tasks_update_v1_to_v2_fail, setup_wdb, teardown_wdb),
+        cmocka_unit_test_setup_teardown(test_wdb_upgrade_tasks_up_to_date, setup_wdb, teardown_wdb),
+        cmocka_unit_test_setup_teardown(test_wdb_upgrade_tasks_error_getting_database_version, setup_wdb, teardown_wdb),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
@@ -483,6 +483,17 @@ int setup_write(void **state) {
     return 0;
 }
 
+int setup_write_offset(void **state) {
+    cJSON * command = cJSON_CreateObject();
+    cJSON_AddStringToObject(command, "buffer", "ABCDABCD");
+    cJSON_AddStringToObject(command, "file", "test_file");
+    cJSON_AddNumberToObject(command, "length", 8);
+    cJSON_AddNumberToObject(command, "offset", 1024);
+    *state = command;
+    test_mode = 1;
+    return 0;
+}
+
 int setup_sha1(void **state) {
     cJSON * command = cJSON_CreateObject();
     cJSON_AddStringToObject(command, "file", "test_file");
@@ -680,6 +691,54 @@ void test_wm_agent_upgrade_com_write_success(void **state) {
     os_free(response);
 }
 
+void test_wm_agent_upgrade_com_write_offset_success(void **state) {
+    cJSON * command = *state;
+#ifdef TEST_WINAGENT
+    sprintf(file.path, "incoming\\test_file");
+#else
+    sprintf(file.path, "var/incoming/test_file");
+#endif
+
+    expect_string(__wrap_w_ref_parent_folder, path, "test_file");
+    will_return(__wrap_w_ref_parent_folder, 0);
+
+    will_return(__wrap_fseek, 0);
+    will_return(__wrap_fwrite, 8);
+
+    char *response = wm_agent_upgrade_com_write(command);
+    cJSON *response_object = cJSON_Parse(response);
+    assert_string_equal(cJSON_GetObjectItem(response_object, task_manager_json_keys[WM_TASK_ERROR_MESSAGE])->valuestring, "ok");
+    cJSON_Delete(response_object);
+    os_free(response);
+}
+
+void test_wm_agent_upgrade_com_write_offset_error(void **state) {
+    cJSON * command = *state;
+#ifdef TEST_WINAGENT
+    sprintf(file.path, "incoming\\test_file");
+#else
+    sprintf(file.path, "var/incoming/test_file");
+#endif
+
+    expect_string(__wrap_w_ref_parent_folder, path, "test_file");
+    will_return(__wrap_w_ref_parent_folder, 0);
+
+    will_return(__wrap_fseek, -1);
+
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:agent-upgrade");
+#ifdef TEST_WINAGENT
+    expect_string(__wrap__mterror, formatted_msg, "(8129): At write: Cannot write on 'incoming\\test_file'");
+#else
+    expect_string(__wrap__mterror, formatted_msg, "(8129): At write: Cannot write on 'var/incoming/test_file'");
+#endif
+
+    char *response = wm_agent_upgrade_com_write(command);
+    cJSON *response_object = cJSON_Parse(response);
+    assert_string_equal(cJSON_GetObjectItem(response_object, task_manager_json_keys[WM_TASK_ERROR_MESSAGE])->valuestring, "Cannot write file");
+    cJSON_Delete(response_object);
+    os_free(response);
+}
+
 void test_wm_agent_upgrade_com_close_file_opened(void **state) {
     cJSON * command = *state;
 
@@ -1885,6 +1944,8 @@ int main(void) {
         cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_com_write_different_file_name, setup_write, teardown_commands),
         cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_com_write_error, setup_write, teardown_commands),
         cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_com_write_success, setup_write, teardown_commands),
+        cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_com_write_offset_success, setup_write_offset, teardown_commands),
+        cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_com_write_offset_error, setup_write_offset, teardown_commands),
         cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_com_close_file_opened, setup_write, teardown_commands),
         cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_com_close_invalid_file_name, setup_write, teardown_commands),
         cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_com_close_different_file_name, setup_write, teardown_commands),
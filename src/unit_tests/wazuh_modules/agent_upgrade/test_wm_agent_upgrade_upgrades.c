@@ -16,6 +16,7 @@
 #include "../../wrappers/common.h"
 #include "../../wrappers/libc/stdio_wrappers.h"
 #include "../../wrappers/posix/pthread_wrappers.h"
+#include "../../wrappers/posix/stat_wrappers.h"
 #include "../../wrappers/posix/unistd_wrappers.h"
 #include "../../wrappers/wazuh/shared/debug_op_wrappers.h"
 #include "../../wrappers/wazuh/shared/queue_linked_op_wrappers.h"
@@ -33,6 +34,8 @@ extern w_linked_queue_t *upgrade_queue;
 
 extern sem_t upgrade_semaphore;
 
+extern wm_upgrade_wpk *wpk_cache;
+
 typedef struct _test_upgrade_args {
     wm_manager_configs *config;
     wm_agent_task *agent_task;
@@ -42,7 +45,9 @@ void* wm_agent_upgrade_start_upgrade(void *arg);
 int wm_agent_upgrade_send_wpk_to_agent(const wm_agent_task *agent_task, const wm_manager_configs* manager_configs);
 int wm_agent_upgrade_send_lock_restart(int agent_id);
 int wm_agent_upgrade_send_open(int agent_id, int wpk_message_format, const char *wpk_file);
-int wm_agent_upgrade_send_write(int agent_id, int wpk_message_format, const char *wpk_file, const char *file_path, int chunk_size);
+int wm_agent_upgrade_send_write(int agent_id, int wpk_message_format, const char *wpk_file, const wm_upgrade_wpk *wpk, unsigned int chunk_size, unsigned int chunk_window, unsigned int rate_limit);
+wm_upgrade_wpk* wm_agent_upgrade_get_wpk(const char *file_path, const char *file_sha1, bool load);
+void wm_agent_upgrade_release_wpk(wm_upgrade_wpk *wpk);
 int wm_agent_upgrade_send_close(int agent_id, int wpk_message_format, const char *wpk_file);
 int wm_agent_upgrade_send_sha1(int agent_id, int wpk_message_format, const char *wpk_file, const char *file_sha1);
 int wm_agent_upgrade_send_upgrade(int agent_id, int wpk_message_format, const char *wpk_file, const char *installer);
@@ -88,8 +93,19 @@ static int setup_upgrade_args(void **state) {
     return 0;
 }
 
+static void free_wpk_cache() {
+    while (wpk_cache) {
+        wm_upgrade_wpk *next = wpk_cache->next;
+        os_free(wpk_cache->path);
+        os_free(wpk_cache->data);
+        os_free(wpk_cache);
+        wpk_cache = next;
+    }
+}
+
 static int teardown_upgrade_args(void **state) {
     wm_manager_configs *config = state[1];
+    free_wpk_cache();
     os_free(config);
     linked_queue_free(upgrade_queue);
     sem_destroy(&upgrade_semaphore);
@@ -150,6 +166,7 @@ static int setup_config_agent_task(void **state) {
 static int teardown_config_agent_task(void **state) {
     wm_manager_configs *config = state[0];
     wm_agent_task *agent_task = state[1];
+    free_wpk_cache();
     os_free(config);
     wm_agent_upgrade_free_agent_task(agent_task);
     return 0;
@@ -611,20 +628,12 @@ void test_wm_agent_upgrade_send_write_ok(void **state)
     int socket = 555;
     int agent = 39;
     char *wpk_file = "test.wpk";
-    char *file_path = "/var/upgrade/wazuh_agent.wpk";
+    wm_upgrade_wpk wpk = { .data = "test\ntest\n", .size = 10 };
     int chunk_size = 5;
-    char *chunk = "test\n";
     char *cmd = "039 com write 5 test.wpk test\n";
     char *agent_res = "ok ";
     int format = -1;
 
-    expect_string(__wrap_fopen, path, file_path);
-    expect_string(__wrap_fopen, mode, "rb");
-    will_return(__wrap_fopen, 1);
-
-    will_return(__wrap_fread, chunk);
-    will_return(__wrap_fread, chunk_size);
-
     expect_string(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK);
     expect_value(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM);
     expect_value(__wrap_OS_ConnectUnixDomain, max_msg_size, OS_MAXSTR);
@@ -649,9 +658,6 @@ void test_wm_agent_upgrade_send_write_ok(void **state)
     expect_string(__wrap_wm_agent_upgrade_parse_agent_response, agent_response, agent_res);
     will_return(__wrap_wm_agent_upgrade_parse_agent_response, 0);
 
-    will_return(__wrap_fread, chunk);
-    will_return(__wrap_fread, chunk_size);
-
     expect_string(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK);
     expect_value(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM);
     expect_value(__wrap_OS_ConnectUnixDomain, max_msg_size, OS_MAXSTR);
@@ -676,13 +682,7 @@ void test_wm_agent_upgrade_send_write_ok(void **state)
     expect_string(__wrap_wm_agent_upgrade_parse_agent_response, agent_response, agent_res);
     will_return(__wrap_wm_agent_upgrade_parse_agent_response, 0);
 
-    will_return(__wrap_fread, chunk);
-    will_return(__wrap_fread, 0);
-
-    expect_value(__wrap_fclose, _File, 1);
-    will_return(__wrap_fclose, 0);
-
-    int res = wm_agent_upgrade_send_write(agent, format, wpk_file, file_path, chunk_size);
+    int res = wm_agent_upgrade_send_write(agent, format, wpk_file, &wpk, chunk_size, 1, 0);
 
     assert_int_equal(res, 0);
 }
@@ -694,20 +694,12 @@ void test_wm_agent_upgrade_send_write_ok_new(void **state)
     int socket = 555;
     int agent = 39;
     char *wpk_file = "test.wpk";
-    char *file_path = "/var/upgrade/wazuh_agent.wpk";
+    wm_upgrade_wpk wpk = { .data = "test\ntest\n", .size = 10 };
     int chunk_size = 5;
-    char *chunk = "test\n";
     char *cmd = "039 upgrade {\"command\":\"write\",\"parameters\":{\"buffer\":\"dGVzdAo=\",\"length\":5,\"file\":\"test.wpk\"}}";
     char *agent_res = "{\"error\":0,\"message\":\"ok\",\"data\": []}";
     int format = 1;
 
-    expect_string(__wrap_fopen, path, file_path);
-    expect_string(__wrap_fopen, mode, "rb");
-    will_return(__wrap_fopen, 1);
-
-    will_return(__wrap_fread, chunk);
-    will_return(__wrap_fread, chunk_size);
-
     expect_string(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK);
     expect_value(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM);
     expect_value(__wrap_OS_ConnectUnixDomain, max_msg_size, OS_MAXSTR);
@@ -732,9 +724,6 @@ void test_wm_agent_upgrade_send_write_ok_new(void **state)
     expect_string(__wrap_wm_agent_upgrade_parse_agent_upgrade_command_response, agent_response, agent_res);
     will_return(__wrap_wm_agent_upgrade_parse_agent_upgrade_command_response, 0);
 
-    will_return(__wrap_fread, chunk);
-    will_return(__wrap_fread, chunk_size);
-
     expect_string(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK);
     expect_value(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM);
     expect_value(__wrap_OS_ConnectUnixDomain, max_msg_size, OS_MAXSTR);
@@ -759,13 +748,7 @@ void test_wm_agent_upgrade_send_write_ok_new(void **state)
     expect_string(__wrap_wm_agent_upgrade_parse_agent_upgrade_command_response, agent_response, agent_res);
     will_return(__wrap_wm_agent_upgrade_parse_agent_upgrade_command_response, 0);
 
-    will_return(__wrap_fread, chunk);
-    will_return(__wrap_fread, 0);
-
-    expect_value(__wrap_fclose, _File, 1);
-    will_return(__wrap_fclose, 0);
-
-    int res = wm_agent_upgrade_send_write(agent, format, wpk_file, file_path, chunk_size);
+    int res = wm_agent_upgrade_send_write(agent, format, wpk_file, &wpk, chunk_size, 1, 0);
 
     assert_int_equal(res, 0);
 }
@@ -777,21 +760,13 @@ void test_wm_agent_upgrade_send_write_err(void **state)
     int socket = 555;
     int agent = 39;
     char *wpk_file = "test.wpk";
-    char *file_path = "/var/upgrade/wazuh_agent.wpk";
+    wm_upgrade_wpk wpk = { .data = "test\ntest\n", .size = 10 };
     int chunk_size = 5;
-    char *chunk = "test\n";
     char *cmd = "039 com write 5 test.wpk test\n";
     char *agent_res1 = "ok ";
     char *agent_res2 = "err Could not write file in agent";
     int format = -1;
 
-    expect_string(__wrap_fopen, path, file_path);
-    expect_string(__wrap_fopen, mode, "rb");
-    will_return(__wrap_fopen, 1);
-
-    will_return(__wrap_fread, chunk);
-    will_return(__wrap_fread, chunk_size);
-
     expect_string(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK);
     expect_value(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM);
     expect_value(__wrap_OS_ConnectUnixDomain, max_msg_size, OS_MAXSTR);
@@ -816,9 +791,6 @@ void test_wm_agent_upgrade_send_write_err(void **state)
     expect_string(__wrap_wm_agent_upgrade_parse_agent_response, agent_response, agent_res1);
     will_return(__wrap_wm_agent_upgrade_parse_agent_response, 0);
 
-    will_return(__wrap_fread, chunk);
-    will_return(__wrap_fread, chunk_size);
-
     expect_string(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK);
     expect_value(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM);
     expect_value(__wrap_OS_ConnectUnixDomain, max_msg_size, OS_MAXSTR);
@@ -843,31 +815,209 @@ void test_wm_agent_upgrade_send_write_err(void **state)
     expect_string(__wrap_wm_agent_upgrade_parse_agent_response, agent_response, agent_res2);
     will_return(__wrap_wm_agent_upgrade_parse_agent_response, OS_INVALID);
 
-    expect_value(__wrap_fclose, _File, 1);
-    will_return(__wrap_fclose, 0);
-
-    int res = wm_agent_upgrade_send_write(agent, format, wpk_file, file_path, chunk_size);
+    int res = wm_agent_upgrade_send_write(agent, format, wpk_file, &wpk, chunk_size, 1, 0);
 
     assert_int_equal(res, OS_INVALID);
 }
 
-void test_wm_agent_upgrade_send_write_open_err(void **state)
+void test_wm_agent_upgrade_send_write_empty_file(void **state)
 {
     (void) state;
 
     int agent = 39;
     char *wpk_file = "test.wpk";
-    char *file_path = "/var/upgrade/wazuh_agent.wpk";
+    wm_upgrade_wpk wpk = { .data = "", .size = 0 };
     int chunk_size = 5;
     int format = -1;
 
+    int res = wm_agent_upgrade_send_write(agent, format, wpk_file, &wpk, chunk_size, 1, 0);
+
+    assert_int_equal(res, OS_INVALID);
+}
+
+static void expect_write_request(int socket, const char *cmd) {
+    char message[OS_SIZE_1024];
+
+    expect_string(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK);
+    expect_value(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM);
+    expect_value(__wrap_OS_ConnectUnixDomain, max_msg_size, OS_MAXSTR);
+    will_return(__wrap_OS_ConnectUnixDomain, socket);
+
+    snprintf(message, sizeof(message), "(8165): Sending message to agent: '%s'", cmd);
+    expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:agent-upgrade");
+    expect_string(__wrap__mtdebug2, formatted_msg, message);
+
+    expect_value(__wrap_OS_SendSecureTCP, sock, socket);
+    expect_value(__wrap_OS_SendSecureTCP, size, strlen(cmd));
+    expect_string(__wrap_OS_SendSecureTCP, msg, cmd);
+    will_return(__wrap_OS_SendSecureTCP, 0);
+}
+
+static void expect_write_response(int socket, const char *agent_res, int result) {
+    char message[OS_SIZE_1024];
+
+    expect_value(__wrap_OS_RecvSecureTCP, sock, socket);
+    expect_value(__wrap_OS_RecvSecureTCP, size, OS_MAXSTR);
+    will_return(__wrap_OS_RecvSecureTCP, agent_res);
+    will_return(__wrap_OS_RecvSecureTCP, strlen(agent_res) + 1);
+
+    snprintf(message, sizeof(message), "(8166): Receiving message from agent: '%s'", agent_res);
+    expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:agent-upgrade");
+    expect_string(__wrap__mtdebug2, formatted_msg, message);
+
+    expect_string(__wrap_wm_agent_upgrade_parse_agent_upgrade_command_response, agent_response, agent_res);
+    will_return(__wrap_wm_agent_upgrade_parse_agent_upgrade_command_response, result);
+}
+
+void test_wm_agent_upgrade_send_write_window_ok(void **state)
+{
+    (void) state;
+
+    int agent = 39;
+    char *wpk_file = "test.wpk";
+    wm_upgrade_wpk wpk = { .data = "test\ntest\ntest\n", .size = 15 };
+    char *agent_res = "{\"error\":0,\"message\":\"ok\",\"data\": []}";
+
+    // The third chunk is sent once the first one is answered
+    expect_write_request(555, "039 upgrade {\"command\":\"write\",\"parameters\":{\"buffer\":\"dGVzdAo=\",\"length\":5,\"offset\":0,\"file\":\"test.wpk\"}}");
+    expect_write_request(556, "039 upgrade {\"command\":\"write\",\"parameters\":{\"buffer\":\"dGVzdAo=\",\"length\":5,\"offset\":5,\"file\":\"test.wpk\"}}");
+    expect_write_response(555, agent_res, 0);
+    expect_write_request(557, "039 upgrade {\"command\":\"write\",\"parameters\":{\"buffer\":\"dGVzdAo=\",\"length\":5,\"offset\":10,\"file\":\"test.wpk\"}}");
+    expect_write_response(556, agent_res, 0);
+    expect_write_response(557, agent_res, 0);
+
+    int res = wm_agent_upgrade_send_write(agent, 1, wpk_file, &wpk, 5, 2, 0);
+
+    assert_int_equal(res, 0);
+}
+
+void test_wm_agent_upgrade_send_write_window_err(void **state)
+{
+    (void) state;
+
+    int agent = 39;
+    char *wpk_file = "test.wpk";
+    wm_upgrade_wpk wpk = { .data = "test\ntest\ntest\n", .size = 15 };
+    char *agent_res = "{\"error\":0,\"message\":\"ok\",\"data\": []}";
+    char *agent_res_err = "{\"error\":10,\"message\":\"Cannot write file\",\"data\": []}";
+
+    // The response to the chunk sent after the failed one isn't waited for
+    expect_write_request(555, "039 upgrade {\"command\":\"write\",\"parameters\":{\"buffer\":\"dGVzdAo=\",\"length\":5,\"offset\":0,\"file\":\"test.wpk\"}}");
+    expect_write_request(556, "039 upgrade {\"command\":\"write\",\"parameters\":{\"buffer\":\"dGVzdAo=\",\"length\":5,\"offset\":5,\"file\":\"test.wpk\"}}");
+    expect_write_response(555, agent_res, 0);
+    expect_write_request(557, "039 upgrade {\"command\":\"write\",\"parameters\":{\"buffer\":\"dGVzdAo=\",\"length\":5,\"offset\":10,\"file\":\"test.wpk\"}}");
+    expect_write_response(556, agent_res_err, OS_INVALID);
+
+    int res = wm_agent_upgrade_send_write(agent, 1, wpk_file, &wpk, 5, 2, 0);
+
+    assert_int_equal(res, OS_INVALID);
+}
+
+void test_wm_agent_upgrade_get_wpk_cached_by_sha1(void **state)
+{
+    (void) state;
+
+    char *file_path = "var/upgrade/test.wpk";
+    char *sha1 = "4e1243bd22c66e76c2ba9eddc1f91394e57f9f83";
+
+    // Not loaded yet
+    assert_null(wm_agent_upgrade_get_wpk(file_path, sha1, false));
+
+    expect_string(__wrap_fopen, path, file_path);
+    expect_string(__wrap_fopen, mode, "rb");
+    will_return(__wrap_fopen, 1);
+    will_return(__wrap_fread, "test\n");
+    will_return(__wrap_fread, 5);
+    will_return(__wrap_fread, "test\n");
+    will_return(__wrap_fread, 0);
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 0);
+
+    wm_upgrade_wpk *wpk = wm_agent_upgrade_get_wpk(file_path, sha1, true);
+
+    assert_non_null(wpk);
+    assert_int_equal(wpk->size, 5);
+    assert_memory_equal(wpk->data, "test\n", 5);
+    assert_string_equal(wpk->sha1, sha1);
+
+    // The next upgrades don't read it again
+    wm_upgrade_wpk *other = wm_agent_upgrade_get_wpk(file_path, sha1, false);
+    assert_ptr_equal(other, wpk);
+    assert_int_equal(wpk->references, 2);
+
+    wm_agent_upgrade_release_wpk(other);
+    wm_agent_upgrade_release_wpk(wpk);
+    assert_ptr_equal(wpk_cache, wpk);
+    assert_int_equal(wpk->references, 0);
+
+    // Another version of the file
+    assert_null(wm_agent_upgrade_get_wpk(file_path, "d321af65983fa412e3a12c312ada12ab321a253a", false));
+}
+
+void test_wm_agent_upgrade_get_wpk_cached_by_stat(void **state)
+{
+    (void) state;
+
+    char *file_path = "/tmp/test.wpk";
+    struct stat file_stat = { .st_size = 5, .st_mtime = 1000, .st_ino = 42 };
+
+    expect_string(__wrap_stat, __file, file_path);
+    will_return(__wrap_stat, &file_stat);
+    will_return(__wrap_stat, 0);
+
+    expect_string(__wrap_fopen, path, file_path);
+    expect_string(__wrap_fopen, mode, "rb");
+    will_return(__wrap_fopen, 1);
+    will_return(__wrap_fread, "test\n");
+    will_return(__wrap_fread, 5);
+    will_return(__wrap_fread, "test\n");
+    will_return(__wrap_fread, 0);
+    expect_value(__wrap_fclose, _File, 1);
+    will_return(__wrap_fclose, 0);
+
+    wm_upgrade_wpk *wpk = wm_agent_upgrade_get_wpk(file_path, NULL, true);
+
+    assert_non_null(wpk);
+    assert_string_equal(wpk->sha1, "4e1243bd22c66e76c2ba9eddc1f91394e57f9f83");
+    wm_agent_upgrade_release_wpk(wpk);
+
+    // Unchanged file
+    expect_string(__wrap_stat, __file, file_path);
+    will_return(__wrap_stat, &file_stat);
+    will_return(__wrap_stat, 0);
+
+    assert_ptr_equal(wm_agent_upgrade_get_wpk(file_path, NULL, true), wpk);
+    wm_agent_upgrade_release_wpk(wpk);
+
+    // Modified file
+    file_stat.st_mtime = 2000;
+
+    expect_string(__wrap_stat, __file, file_path);
+    will_return(__wrap_stat, &file_stat);
+    will_return(__wrap_stat, 0);
+
+    assert_null(wm_agent_upgrade_get_wpk(file_path, NULL, false));
+}
+
+void test_wm_agent_upgrade_get_wpk_open_err(void **state)
+{
+    (void) state;
+
+    char *file_path = "/tmp/test.wpk";
+
+    expect_string(__wrap_stat, __file, file_path);
+    will_return(__wrap_stat, NULL);
+    will_return(__wrap_stat, -1);
+
     expect_string(__wrap_fopen, path, file_path);
     expect_string(__wrap_fopen, mode, "rb");
     will_return(__wrap_fopen, 0);
 
-    int res = wm_agent_upgrade_send_write(agent, format, wpk_file, file_path, chunk_size);
+    expect_string(__wrap__mterror, tag, "wazuh-modulesd:agent-upgrade");
+    expect_any(__wrap__mterror, formatted_msg);
 
-    assert_int_equal(res, OS_INVALID);
+    assert_null(wm_agent_upgrade_get_wpk(file_path, NULL, true));
+    assert_null(wpk_cache);
 }
 
 void test_wm_agent_upgrade_send_close_ok(void **state)
@@ -1673,7 +1823,7 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_custom_custom_installer_ok(
     char *run_upgrade = "111 com upgrade test.wpk test.sh";
     char *agent_res_ok = "ok ";
     char *agent_res_ok_0 = "ok 0";
-    char *agent_res_ok_sha1 = "ok 2c312ada12ab321a253ad321af65983fa412e3a1";
+    char *agent_res_ok_sha1 = "ok 4e1243bd22c66e76c2ba9eddc1f91394e57f9f83";
 
     wm_manager_configs *config = state[0];
     wm_agent_task *agent_task = state[1];
@@ -1696,10 +1846,6 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_custom_custom_installer_ok(
     expect_string(__wrap__mtdebug1, tag, "wazuh-modulesd:agent-upgrade");
     expect_string(__wrap__mtdebug1, formatted_msg, "(8162): Sending WPK to agent: '111'");
 
-    expect_string(__wrap_OS_SHA1_File, fname, "/tmp/test.wpk");
-    expect_value(__wrap_OS_SHA1_File, mode, OS_BINARY);
-    will_return(__wrap_OS_SHA1_File, "2c312ada12ab321a253ad321af65983fa412e3a1");
-    will_return(__wrap_OS_SHA1_File, 0);
 
     expect_string_count(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK, 6);
     expect_value_count(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM, 6);
@@ -1739,6 +1885,10 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_custom_custom_installer_ok(
 
     // Write file
 
+    expect_string(__wrap_stat, __file, "/tmp/test.wpk");
+    will_return(__wrap_stat, NULL);
+    will_return(__wrap_stat, -1);
+
     expect_string(__wrap_fopen, path, "/tmp/test.wpk");
     expect_string(__wrap_fopen, mode, "rb");
     will_return(__wrap_fopen, 1);
@@ -1808,7 +1958,7 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_custom_custom_installer_ok(
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '111 com close test.wpk'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok '");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '111 com sha1 test.wpk'");
-    expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok 2c312ada12ab321a253ad321af65983fa412e3a1'");
+    expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok 4e1243bd22c66e76c2ba9eddc1f91394e57f9f83'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '111 com upgrade test.wpk test.sh'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok 0'");
 
@@ -1838,7 +1988,7 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_custom_default_installer_ok
     char *run_upgrade = "111 com upgrade test.wpk upgrade.sh";
     char *agent_res_ok = "ok ";
     char *agent_res_ok_0 = "ok 0";
-    char *agent_res_ok_sha1 = "ok 2c312ada12ab321a253ad321af65983fa412e3a1";
+    char *agent_res_ok_sha1 = "ok 4e1243bd22c66e76c2ba9eddc1f91394e57f9f83";
 
     wm_manager_configs *config = state[0];
     wm_agent_task *agent_task = state[1];
@@ -1860,10 +2010,6 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_custom_default_installer_ok
     expect_string(__wrap__mtdebug1, tag, "wazuh-modulesd:agent-upgrade");
     expect_string(__wrap__mtdebug1, formatted_msg, "(8162): Sending WPK to agent: '111'");
 
-    expect_string(__wrap_OS_SHA1_File, fname, "/tmp/test.wpk");
-    expect_value(__wrap_OS_SHA1_File, mode, OS_BINARY);
-    will_return(__wrap_OS_SHA1_File, "2c312ada12ab321a253ad321af65983fa412e3a1");
-    will_return(__wrap_OS_SHA1_File, 0);
 
     expect_string_count(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK, 6);
     expect_value_count(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM, 6);
@@ -1903,6 +2049,10 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_custom_default_installer_ok
 
     // Write file
 
+    expect_string(__wrap_stat, __file, "/tmp/test.wpk");
+    will_return(__wrap_stat, NULL);
+    will_return(__wrap_stat, -1);
+
     expect_string(__wrap_fopen, path, "/tmp/test.wpk");
     expect_string(__wrap_fopen, mode, "rb");
     will_return(__wrap_fopen, 1);
@@ -1972,7 +2122,7 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_custom_default_installer_ok
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '111 com close test.wpk'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok '");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '111 com sha1 test.wpk'");
-    expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok 2c312ada12ab321a253ad321af65983fa412e3a1'");
+    expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok 4e1243bd22c66e76c2ba9eddc1f91394e57f9f83'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '111 com upgrade test.wpk upgrade.sh'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok 0'");
 
@@ -2529,6 +2679,9 @@ void test_wm_agent_upgrade_send_wpk_to_agent_upgrade_write_file_err(void **state
     will_return(__wrap_fread, "test\n");
     will_return(__wrap_fread, config->chunk_size);
 
+    will_return(__wrap_fread, "test\n");
+    will_return(__wrap_fread, 0);
+
     expect_value(__wrap_OS_SendSecureTCP, sock, socket);
     expect_value(__wrap_OS_SendSecureTCP, size, strlen(write_file));
     expect_string(__wrap_OS_SendSecureTCP, msg, write_file);
@@ -3360,7 +3513,7 @@ void test_wm_agent_upgrade_start_upgrade_upgrade_custom_ok(void **state)
     char *run_upgrade = "025 com upgrade test.wpk upgrade.sh";
     char *agent_res_ok = "ok ";
     char *agent_res_ok_0 = "ok 0";
-    char *agent_res_ok_sha1 = "ok d321af65983fa412e3a12c312ada12ab321a253a";
+    char *agent_res_ok_sha1 = "ok 4e1243bd22c66e76c2ba9eddc1f91394e57f9f83";
 
     test_upgrade_args *args = state[0];
     wm_manager_configs *config = args->config;
@@ -3421,10 +3574,6 @@ void test_wm_agent_upgrade_start_upgrade_upgrade_custom_ok(void **state)
     expect_string(__wrap__mtdebug1, tag, "wazuh-modulesd:agent-upgrade");
     expect_string(__wrap__mtdebug1, formatted_msg, "(8162): Sending WPK to agent: '025'");
 
-    expect_string(__wrap_OS_SHA1_File, fname, "/tmp/test.wpk");
-    expect_value(__wrap_OS_SHA1_File, mode, OS_BINARY);
-    will_return(__wrap_OS_SHA1_File, "d321af65983fa412e3a12c312ada12ab321a253a");
-    will_return(__wrap_OS_SHA1_File, 0);
 
     expect_string_count(__wrap_OS_ConnectUnixDomain, path, REMOTE_LOCAL_SOCK, 6);
     expect_value_count(__wrap_OS_ConnectUnixDomain, type, SOCK_STREAM, 6);
@@ -3464,6 +3613,10 @@ void test_wm_agent_upgrade_start_upgrade_upgrade_custom_ok(void **state)
 
     // Write file
 
+    expect_string(__wrap_stat, __file, "/tmp/test.wpk");
+    will_return(__wrap_stat, NULL);
+    will_return(__wrap_stat, -1);
+
     expect_string(__wrap_fopen, path, "/tmp/test.wpk");
     expect_string(__wrap_fopen, mode, "rb");
     will_return(__wrap_fopen, 1);
@@ -3533,7 +3686,7 @@ void test_wm_agent_upgrade_start_upgrade_upgrade_custom_ok(void **state)
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '025 com close test.wpk'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok '");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '025 com sha1 test.wpk'");
-    expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok d321af65983fa412e3a12c312ada12ab321a253a'");
+    expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok 4e1243bd22c66e76c2ba9eddc1f91394e57f9f83'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8165): Sending message to agent: '025 com upgrade test.wpk upgrade.sh'");
     expect_string(__wrap__mtdebug2, formatted_msg, "(8166): Receiving message from agent: 'ok 0'");
 
@@ -3824,7 +3977,13 @@ int main(void) {
         cmocka_unit_test(test_wm_agent_upgrade_send_write_ok),
         cmocka_unit_test(test_wm_agent_upgrade_send_write_ok_new),
         cmocka_unit_test(test_wm_agent_upgrade_send_write_err),
-        cmocka_unit_test(test_wm_agent_upgrade_send_write_open_err),
+        cmocka_unit_test(test_wm_agent_upgrade_send_write_empty_file),
+        cmocka_unit_test(test_wm_agent_upgrade_send_write_window_ok),
+        cmocka_unit_test(test_wm_agent_upgrade_send_write_window_err),
+        // wm_agent_upgrade_get_wpk
+        cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_get_wpk_cached_by_sha1, setup_config_agent_task, teardown_config_agent_task),
+        cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_get_wpk_cached_by_stat, setup_config_agent_task, teardown_config_agent_task),
+        cmocka_unit_test_setup_teardown(test_wm_agent_upgrade_get_wpk_open_err, setup_config_agent_task, teardown_config_agent_task),
         // wm_agent_upgrade_send_close
         cmocka_unit_test(test_wm_agent_upgrade_send_close_ok),
         cmocka_unit_test(test_wm_agent_upgrade_send_close_ok_new),
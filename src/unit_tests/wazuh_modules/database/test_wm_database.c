@@ -389,22 +389,19 @@ void test_sync_keys_with_wdb_insert(void **state) {
     will_return(__wrap_OS_CIDRtoStr, test_ip);
     will_return(__wrap_OS_CIDRtoStr, 0);
 
-    expect_value(__wrap_wdb_insert_agent, id, 1);
-    expect_string(__wrap_wdb_insert_agent, name, keys.keyentries[0]->name);
-    expect_string(__wrap_wdb_insert_agent, register_ip, test_ip);
-    expect_string(__wrap_wdb_insert_agent, internal_key, keys.keyentries[0]->raw_key);
-    expect_value(__wrap_wdb_insert_agent, keep_date, 1);
-    will_return(__wrap_wdb_insert_agent, 1);
+    expect_string(__wrap_wdb_insert_agents, agents_str, "[{\"id\":1,\"name\":\"agent1\",\"register_ip\":\"1.1.1.1\",\"internal_key\":\"1234567890abcdef\"}]");
+    expect_value(__wrap_wdb_insert_agents, keep_date, 1);
+    will_return(__wrap_wdb_insert_agents, 1);
 
     expect_string(__wrap__mtdebug1, tag, "wazuh-modulesd:database");
-    expect_string(__wrap__mtdebug1, formatted_msg, "Couldn't insert agent '001' in the database.");
+    expect_string(__wrap__mtdebug1, formatted_msg, "Couldn't insert the new agents in the database.");
 
     will_return(__wrap_rbtree_keys, ids);
 
     expect_string(__wrap_OS_IsAllowedID, id, keys.keyentries[0]->id);
     will_return(__wrap_OS_IsAllowedID, 0);
 
-    sync_keys_with_wdb(&keys);
+    assert_int_equal(sync_keys_with_wdb(&keys), OS_INVALID);
 }
 
 void test_sync_keys_with_wdb_delete(void **state) {
@@ -440,7 +437,7 @@ void test_sync_keys_with_wdb_delete(void **state) {
     expect_string(__wrap__mtdebug1, tag, "wazuh-modulesd:database");
     expect_string(__wrap__mtdebug1, formatted_msg, "Couldn't remove agent '001' from the database.");
 
-    sync_keys_with_wdb(&keys);
+    assert_int_equal(sync_keys_with_wdb(&keys), OS_INVALID);
 }
 
 void test_sync_keys_with_wdb_insert_delete(void **state) {
@@ -471,12 +468,9 @@ void test_sync_keys_with_wdb_insert_delete(void **state) {
     will_return(__wrap_OS_CIDRtoStr, test_ip);
     will_return(__wrap_OS_CIDRtoStr, 0);
 
-    expect_value(__wrap_wdb_insert_agent, id, 1);
-    expect_string(__wrap_wdb_insert_agent, name, keys.keyentries[0]->name);
-    expect_string(__wrap_wdb_insert_agent, register_ip, test_ip);
-    expect_string(__wrap_wdb_insert_agent, internal_key, keys.keyentries[0]->raw_key);
-    expect_value(__wrap_wdb_insert_agent, keep_date, 1);
-    will_return(__wrap_wdb_insert_agent, 0);
+    expect_string(__wrap_wdb_insert_agents, agents_str, "[{\"id\":1,\"name\":\"agent1\",\"register_ip\":\"1.1.1.1\",\"internal_key\":\"1234567890abcdef\"}]");
+    expect_value(__wrap_wdb_insert_agents, keep_date, 1);
+    will_return(__wrap_wdb_insert_agents, 0);
 
     will_return(__wrap_rbtree_keys, ids);
 
@@ -508,7 +502,7 @@ void test_sync_keys_with_wdb_insert_delete(void **state) {
     expect_string(__wrap_fopen, mode, "r");
     will_return(__wrap_fopen, NULL);
 
-    sync_keys_with_wdb(&keys);
+    assert_int_equal(sync_keys_with_wdb(&keys), OS_SUCCESS);
 }
 
 void test_sync_keys_with_wdb_null(void **state) {
@@ -521,7 +515,66 @@ void test_sync_keys_with_wdb_null(void **state) {
     expect_string(__wrap__mterror, tag, "wazuh-modulesd:database");
     expect_string(__wrap__mterror, formatted_msg, "Couldn't synchronize the keystore with the DB.");
 
-    sync_keys_with_wdb(&keys);
+    assert_int_equal(sync_keys_with_wdb(&keys), OS_INVALID);
+}
+
+/* Tests sync_keys_changes_with_wdb */
+
+void test_sync_keys_changes_with_wdb_unchanged(void **state) {
+    keystore keys = *((keystore *)*state);
+    keys.keysize = 1;
+    keys.keytree_id = rbtree_init();
+    rbtree_insert(keys.keytree_id, "001", keys.keyentries[0]);
+
+    rb_tree *snapshot = rbtree_init();
+    rbtree_insert(snapshot, "001", NULL);
+
+    // Nothing is sent to the DB
+    assert_int_equal(sync_keys_changes_with_wdb(&keys, snapshot), OS_SUCCESS);
+
+    rbtree_destroy(snapshot);
+    rbtree_destroy(keys.keytree_id);
+}
+
+void test_sync_keys_changes_with_wdb_added_removed(void **state) {
+    keystore keys = *((keystore *)*state);
+    keys.keysize = 1;
+    keys.keytree_id = rbtree_init();
+    rbtree_insert(keys.keytree_id, "001", keys.keyentries[0]);
+
+    rb_tree *snapshot = rbtree_init();
+    rbtree_insert(snapshot, "000", NULL);
+    rbtree_insert(snapshot, "002", NULL);
+
+    char *test_ip = "1.1.1.1";
+    char *test_name = strdup("TESTNAME");
+
+    expect_string(__wrap__mtdebug2, tag, "wazuh-modulesd:database");
+    expect_string(__wrap__mtdebug2, formatted_msg, "Synchronizing agent 001 'agent1'.");
+
+    expect_any(__wrap_OS_CIDRtoStr, ip);
+    expect_value(__wrap_OS_CIDRtoStr, size, IPSIZE);
+    will_return(__wrap_OS_CIDRtoStr, test_ip);
+    will_return(__wrap_OS_CIDRtoStr, 0);
+
+    expect_value(__wrap_wdb_get_agent_name, id, 2);
+    will_return(__wrap_wdb_get_agent_name, test_name);
+
+    expect_value(__wrap_wdb_remove_agent, id, 2);
+    will_return(__wrap_wdb_remove_agent, -1);
+
+    expect_string(__wrap__mtdebug1, tag, "wazuh-modulesd:database");
+    expect_string(__wrap__mtdebug1, formatted_msg, "Couldn't remove agent '002' from the database.");
+
+    expect_string(__wrap_wdb_insert_agents, agents_str, "[{\"id\":1,\"name\":\"agent1\",\"register_ip\":\"1.1.1.1\",\"internal_key\":\"1234567890abcdef\"}]");
+    expect_value(__wrap_wdb_insert_agents, keep_date, 1);
+    will_return(__wrap_wdb_insert_agents, 0);
+
+    // The agent that couldn't be removed forces a full synchronization next time
+    assert_int_equal(sync_keys_changes_with_wdb(&keys, snapshot), OS_INVALID);
+
+    rbtree_destroy(snapshot);
+    rbtree_destroy(keys.keytree_id);
 }
 
 int main()
@@ -543,6 +596,9 @@ int main()
         cmocka_unit_test_setup_teardown(test_sync_keys_with_wdb_delete, setup_keys_to_db, teardown_keys_to_db),
         cmocka_unit_test_setup_teardown(test_sync_keys_with_wdb_insert_delete, setup_keys_to_db, teardown_keys_to_db),
         cmocka_unit_test_setup_teardown(test_sync_keys_with_wdb_null, setup_keys_to_db, teardown_keys_to_db),
+        // sync_keys_changes_with_wdb
+        cmocka_unit_test_setup_teardown(test_sync_keys_changes_with_wdb_unchanged, setup_keys_to_db, teardown_keys_to_db),
+        cmocka_unit_test_setup_teardown(test_sync_keys_changes_with_wdb_added_removed, setup_keys_to_db, teardown_keys_to_db),
     };
 
     return cmocka_run_group_tests(tests, NULL, NULL);
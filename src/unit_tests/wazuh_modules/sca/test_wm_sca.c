@@ -42,7 +42,11 @@ extern int wm_sca_test_positive_minterm(const char * const pattern, const char *
 extern int wm_sca_regex_numeric_comparison(const char * const pattern, const char * const str, char ** reason, w_expression_t * regex_engine);
 extern int wm_sca_apply_numeric_partial_comparison(const char * const partial_comparison, const long int number, char ** reason, w_expression_t * regex_engine);
 
+extern int wm_sca_exec_command(char * command, char ** output, int * result_code, wm_sca_t * data);
+extern void wm_sca_free_command_result(void * result);
+
 extern w_queue_t * request_queue;
+extern OSHash * command_cache;
 extern char **last_sha256;
 extern OSHash **cis_db;
 extern struct cis_db_hash_info_t *cis_db_for_hash;
@@ -774,6 +778,56 @@ void test_wm_sca_apply_numeric_partial_comparison_no_operation_supported_with_re
     w_free_expression_t(&regex);
 }
 
+void test_wm_sca_exec_command_cached(void **state)
+{
+    wm_sca_t data = { .commands_timeout = 30 };
+    char * output = NULL;
+    int result_code = -1;
+
+    command_cache = OSHash_Create();
+    OSHash_SetFreeDataPointer(command_cache, wm_sca_free_command_result);
+
+    // The command is run only once
+    expect_string(__wrap_wm_exec, command, "sysctl kernel.randomize_va_space");
+    expect_value(__wrap_wm_exec, secs, 30);
+    expect_value(__wrap_wm_exec, add_path, NULL);
+    will_return(__wrap_wm_exec, "kernel.randomize_va_space = 2\n");
+    will_return(__wrap_wm_exec, 0);
+    will_return(__wrap_wm_exec, 0);
+
+    assert_int_equal(wm_sca_exec_command("sysctl kernel.randomize_va_space", &output, &result_code, &data), 0);
+    assert_string_equal(output, "kernel.randomize_va_space = 2\n");
+    assert_int_equal(result_code, 0);
+    os_free(output);
+    result_code = -1;
+
+    assert_int_equal(wm_sca_exec_command("sysctl kernel.randomize_va_space", &output, &result_code, &data), 0);
+    assert_string_equal(output, "kernel.randomize_va_space = 2\n");
+    assert_int_equal(result_code, 0);
+    os_free(output);
+
+    OSHash_Free(command_cache);
+    command_cache = NULL;
+}
+
+void test_wm_sca_exec_command_no_cache(void **state)
+{
+    wm_sca_t data = { .commands_timeout = 30 };
+    char * output = NULL;
+    int result_code = 0;
+
+    expect_string(__wrap_wm_exec, command, "missing-command");
+    expect_value(__wrap_wm_exec, secs, 30);
+    expect_value(__wrap_wm_exec, add_path, NULL);
+    will_return(__wrap_wm_exec, NULL);
+    will_return(__wrap_wm_exec, EXECVE_ERROR);
+    will_return(__wrap_wm_exec, -1);
+
+    assert_int_equal(wm_sca_exec_command("missing-command", &output, &result_code, &data), -1);
+    assert_null(output);
+    assert_int_equal(result_code, EXECVE_ERROR);
+}
+
 /* main */
 
 int main(void) {
@@ -819,7 +873,9 @@ int main(void) {
         cmocka_unit_test(test_wm_sca_apply_numeric_partial_comparison_no_capture_number_with_reason_null),
         cmocka_unit_test(test_wm_sca_apply_numeric_partial_comparison_no_capture_number_with_reason_not_null),
         cmocka_unit_test(test_wm_sca_apply_numeric_partial_comparison_no_operation_supported_with_reason_null),
-        cmocka_unit_test(test_wm_sca_apply_numeric_partial_comparison_no_operation_supported_with_reason_not_null)
+        cmocka_unit_test(test_wm_sca_apply_numeric_partial_comparison_no_operation_supported_with_reason_not_null),
+        cmocka_unit_test(test_wm_sca_exec_command_cached),
+        cmocka_unit_test(test_wm_sca_exec_command_no_cache)
     };
     int result;
     result = cmocka_run_group_tests(tests_with_startup, setup_module, teardown_module);
@@ -717,6 +717,99 @@ void test_wm_task_manager_command_upgrade_update_status_db_response_null(void **
     assert_int_equal(error_code, WM_TASK_DATABASE_ERROR);
 }
 
+void test_wm_task_manager_command_upgrade_update_status_batch_ok(void **state)
+{
+    char *node = "node02";
+    int error_code = 0;
+    char *status = "Done";
+
+    char *wdb_response = "ok {\"error\":0,\"data\":[{\"agent\":35,\"error\":0},{\"agent\":36,\"error\":-2}]}";
+
+    wm_task_manager_upgrade_update_status *task_parameters = wm_task_manager_init_upgrade_update_status_parameters();
+    int *agents = NULL;
+
+    os_calloc(3, sizeof(int), agents);
+    agents[0] = 35;
+    agents[1] = 36;
+    agents[2] = OS_INVALID;
+
+    os_strdup(node, task_parameters->node);
+    task_parameters->agent_ids = agents;
+    os_strdup(status, task_parameters->status);
+
+    cJSON* res1 = cJSON_CreateObject();
+    cJSON* res2 = cJSON_CreateObject();
+
+    expect_value(__wrap_wdbc_query_ex, *sock, -1);
+    expect_string(__wrap_wdbc_query_ex, query, "task upgrade_update_status {\"agents\":[35,36],\"node\":\"node02\",\"status\":\"Done\"}");
+    expect_value(__wrap_wdbc_query_ex, len, OS_MAXSTR);
+    will_return(__wrap_wdbc_query_ex, wdb_response);
+    will_return(__wrap_wdbc_query_ex, 0);
+
+    expect_string(__wrap_wdbc_parse_result, result, wdb_response);
+    will_return(__wrap_wdbc_parse_result, WDBC_OK);
+
+    expect_value(__wrap_wm_task_manager_parse_data_response, error_code, WM_TASK_SUCCESS);
+    expect_value(__wrap_wm_task_manager_parse_data_response, agent_id, 35);
+    expect_value(__wrap_wm_task_manager_parse_data_response, task_id, OS_INVALID);
+    will_return(__wrap_wm_task_manager_parse_data_response, res1);
+
+    expect_value(__wrap_wm_task_manager_parse_data_response, error_code, WM_TASK_DATABASE_NO_TASK);
+    expect_value(__wrap_wm_task_manager_parse_data_response, agent_id, 36);
+    expect_value(__wrap_wm_task_manager_parse_data_response, task_id, OS_INVALID);
+    will_return(__wrap_wm_task_manager_parse_data_response, res2);
+
+    cJSON *response = wm_task_manager_command_upgrade_update_status(task_parameters, &error_code);
+
+    state[0] = response;
+    state[1] = task_parameters;
+
+    assert_non_null(response);
+    assert_int_equal(cJSON_GetArraySize(response), 2);
+    assert_ptr_equal(cJSON_GetArrayItem(response, 0), res1);
+    assert_ptr_equal(cJSON_GetArrayItem(response, 1), res2);
+    assert_int_equal(error_code, 0);
+}
+
+void test_wm_task_manager_command_upgrade_update_status_batch_db_err(void **state)
+{
+    char *node = "node02";
+    int error_code = 0;
+    char *status = "Done";
+
+    // The DB answered for a single agent of the batch
+    char *wdb_response = "ok {\"error\":0,\"data\":[{\"agent\":35,\"error\":0}]}";
+
+    wm_task_manager_upgrade_update_status *task_parameters = wm_task_manager_init_upgrade_update_status_parameters();
+    int *agents = NULL;
+
+    os_calloc(3, sizeof(int), agents);
+    agents[0] = 35;
+    agents[1] = 36;
+    agents[2] = OS_INVALID;
+
+    os_strdup(node, task_parameters->node);
+    task_parameters->agent_ids = agents;
+    os_strdup(status, task_parameters->status);
+
+    expect_value(__wrap_wdbc_query_ex, *sock, -1);
+    expect_string(__wrap_wdbc_query_ex, query, "task upgrade_update_status {\"agents\":[35,36],\"node\":\"node02\",\"status\":\"Done\"}");
+    expect_value(__wrap_wdbc_query_ex, len, OS_MAXSTR);
+    will_return(__wrap_wdbc_query_ex, wdb_response);
+    will_return(__wrap_wdbc_query_ex, 0);
+
+    expect_string(__wrap_wdbc_parse_result, result, wdb_response);
+    will_return(__wrap_wdbc_parse_result, WDBC_OK);
+
+    cJSON *response = wm_task_manager_command_upgrade_update_status(task_parameters, &error_code);
+
+    state[0] = NULL;
+    state[1] = task_parameters;
+
+    assert_null(response);
+    assert_int_equal(error_code, WM_TASK_DATABASE_ERROR);
+}
+
 void test_wm_task_manager_command_upgrade_result_ok(void **state)
 {
     int error_code = 0;
@@ -1461,6 +1554,8 @@ int main(void) {
         cmocka_unit_test_teardown(test_wm_task_manager_command_upgrade_update_status_task_err, teardown_json_upgrade_update_status_task),
         cmocka_unit_test_teardown(test_wm_task_manager_command_upgrade_update_status_db_err, teardown_json_upgrade_update_status_task),
         cmocka_unit_test_teardown(test_wm_task_manager_command_upgrade_update_status_db_response_null, teardown_json_upgrade_update_status_task),
+        cmocka_unit_test_teardown(test_wm_task_manager_command_upgrade_update_status_batch_ok, teardown_json_upgrade_update_status_task),
+        cmocka_unit_test_teardown(test_wm_task_manager_command_upgrade_update_status_batch_db_err, teardown_json_upgrade_update_status_task),
         // wm_task_manager_command_upgrade_result
         cmocka_unit_test_teardown(test_wm_task_manager_command_upgrade_result_ok, teardown_json_upgrade_result_task),
         cmocka_unit_test_teardown(test_wm_task_manager_command_upgrade_result_not_found_err, teardown_json_upgrade_result_task),
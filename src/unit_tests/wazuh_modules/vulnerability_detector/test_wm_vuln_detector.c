@@ -3196,6 +3196,30 @@ void test_wm_checks_package_vulnerability_lt_with_epoch(void **state)
     assert_int_equal(VU_VULNERABLE, ret);
 }
 
+void test_wm_checks_package_vulnerability_cached(void **state)
+{
+    char *version_a = "1:5.3.2-3.9.7";
+    char *version_b = "2:6.1.1-2.6.8";
+    char *operation = "less than";
+
+    wm_vuldet_version_cache_init();
+
+    // Only the first comparison reaches the version comparator
+    expect_value(__wrap_pkg_version_relate, rel, PKG_RELATION_LT);
+    will_return(__wrap_pkg_version_relate, true);
+
+    assert_int_equal(VU_VULNERABLE, wm_checks_package_vulnerability(version_a, operation, version_b, VER_TYPE_DEB));
+    assert_int_equal(VU_VULNERABLE, wm_checks_package_vulnerability(version_a, operation, version_b, VER_TYPE_DEB));
+    assert_int_equal(1, rbtree_size(vu_version_cache));
+
+    expect_string(__wrap__mtdebug1, tag, "wazuh-modulesd:vulnerability-detector");
+    expect_string(__wrap__mtdebug1, formatted_msg, "Version comparison cache released with 1 entries.");
+
+    wm_vuldet_version_cache_free();
+
+    assert_null(vu_version_cache);
+}
+
 void test_wm_checks_package_vulnerability_lt_no_epoch(void **state)
 {
     char *version_a = "5.3.2-3.9.7";
@@ -10206,6 +10230,34 @@ void test_wm_vuldet_send_cve_report_sendmsg_error(void **state)
     os_free(strerr);
 }
 
+/* wm_vuldet_queue_cve_report */
+
+void test_wm_vuldet_queue_cve_report(void **state)
+{
+    vu_report *report = NULL;
+    vu_report *queued = NULL;
+    vu_pending_report *pending = NULL;
+
+    os_calloc(1, sizeof(vu_report), report);
+    queued = report;
+    vu_report_queue = queue_init(2);
+
+    int retval = wm_vuldet_queue_cve_report(&report, true);
+
+    assert_int_equal(retval, 0);
+    assert_null(report);
+
+    pending = queue_pop_ex(vu_report_queue);
+    assert_ptr_equal(pending->report, queued);
+    assert_true(pending->updated);
+    assert_true(queue_empty(vu_report_queue));
+
+    os_free(pending->report);
+    os_free(pending);
+    queue_free(vu_report_queue);
+    vu_report_queue = NULL;
+}
+
 /* wm_vuldet_extract_advisories */
 
 void test_wm_vuldet_extract_advisories_no_advisories(void **state)
@@ -23489,6 +23541,7 @@ int main(void)
         cmocka_unit_test(test_wm_checks_package_vulnerability_big_version_b),
         cmocka_unit_test(test_wm_checks_package_vulnerability_lt_with_epoch),
         cmocka_unit_test(test_wm_checks_package_vulnerability_lt_no_epoch),
+        cmocka_unit_test(test_wm_checks_package_vulnerability_cached),
         cmocka_unit_test(test_wm_checks_package_vulnerability_lt_no_revision),
         cmocka_unit_test(test_wm_checks_package_vulnerability_lt_no_revision_and_score),
         cmocka_unit_test(test_wm_checks_package_vulnerability_le),
@@ -23636,6 +23689,8 @@ int main(void)
         cmocka_unit_test_setup_teardown(test_wm_vuldet_send_cve_report_without_ip, setup_cve_report, teardown_cve_report),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_send_cve_report_without_hotfix, setup_cve_report, teardown_cve_report),
         cmocka_unit_test_setup_teardown(test_wm_vuldet_send_cve_report_sendmsg_error, setup_cve_report, teardown_cve_report),
+        // Tests wm_vuldet_queue_cve_report
+        cmocka_unit_test(test_wm_vuldet_queue_cve_report),
         // Tests wm_vuldet_extract_advisories
         cmocka_unit_test(test_wm_vuldet_extract_advisories_no_advisories),
         cmocka_unit_test(test_wm_vuldet_extract_advisories),
@@ -14,8 +14,8 @@
 #include <cmocka.h>
 #include "pcre2_wrappers.h"
 
-pcre2_match_data_8 * wrap_pcre2_match_data_create_from_pattern(__attribute__((unused))pcre2_code_8 * code,
-                                                               __attribute__((unused))void* aux) {
+pcre2_match_data_8 * wrap_pcre2_match_data_create(__attribute__((unused))uint32_t ovecsize,
+                                                  __attribute__((unused))void* aux) {
     return mock_type(pcre2_match_data_8 *);
 }
 
@@ -27,6 +27,12 @@ int wrap_pcre2_match(__attribute__((unused))pcre2_code_8 * code_match_data,
     return mock();
 }
 
+/* Same results as pcre2_match, the JIT may not be available */
+int wrap_pcre2_jit_match(pcre2_code_8 * code_match_data, const PCRE2_UCHAR8 * str_test, size_t strlen, int a, int b,
+                         pcre2_match_data_8 * match_data, void * aux) {
+    return wrap_pcre2_match(code_match_data, str_test, strlen, a, b, match_data, aux);
+}
+
 void wrap_pcre2_match_data_free(__attribute__((unused))pcre2_match_data_8 * match_data) {
     return;
 }
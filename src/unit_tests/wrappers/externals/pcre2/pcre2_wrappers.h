@@ -16,10 +16,10 @@
 #include "shared.h"
 #include "expression.h"
 
-#undef pcre2_match_data_create_from_pattern
-#define pcre2_match_data_create_from_pattern wrap_pcre2_match_data_create_from_pattern
+#undef pcre2_match_data_create
+#define pcre2_match_data_create wrap_pcre2_match_data_create
 
-pcre2_match_data_8 * wrap_pcre2_match_data_create_from_pattern(pcre2_code_8 * code, void* aux);
+pcre2_match_data_8 * wrap_pcre2_match_data_create(uint32_t ovecsize, void* aux);
 
 #undef pcre2_match
 #define pcre2_match wrap_pcre2_match
@@ -27,6 +27,12 @@ pcre2_match_data_8 * wrap_pcre2_match_data_create_from_pattern(pcre2_code_8 * co
 int pcre2_match(pcre2_code_8 * code_match_data, const PCRE2_UCHAR8 * str_test, 
                 size_t strlen, int a, int b, pcre2_match_data_8 * match_data, void * aux);
 
+#undef pcre2_jit_match
+#define pcre2_jit_match wrap_pcre2_jit_match
+
+int wrap_pcre2_jit_match(pcre2_code_8 * code_match_data, const PCRE2_UCHAR8 * str_test,
+                         size_t strlen, int a, int b, pcre2_match_data_8 * match_data, void * aux);
+
 #undef pcre2_match_data_free
 #define pcre2_match_data_free wrap_pcre2_match_data_free
 
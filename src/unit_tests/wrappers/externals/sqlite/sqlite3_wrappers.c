@@ -14,6 +14,22 @@
 #include <cmocka.h>
 #include "../../common.h"
 
+sqlite3_backup *__wrap_sqlite3_backup_init(__attribute__((unused)) sqlite3 *pDest,
+                                           __attribute__((unused)) const char *zDestName,
+                                           __attribute__((unused)) sqlite3 *pSource,
+                                           __attribute__((unused)) const char *zSourceName) {
+    return mock_type(sqlite3_backup *);
+}
+
+int __wrap_sqlite3_backup_step(__attribute__((unused)) sqlite3_backup *p, int nPage) {
+    check_expected(nPage);
+    return mock();
+}
+
+int __wrap_sqlite3_backup_finish(__attribute__((unused)) sqlite3_backup *p) {
+    return mock();
+}
+
 
 int __wrap_sqlite3_bind_int(__attribute__((unused)) sqlite3_stmt *stmt,
                             int index,
@@ -219,6 +235,14 @@ int __wrap_sqlite3_get_autocommit(__attribute__((unused)) sqlite3 * db) {
     return mock();
 }
 
+sqlite3_int64 __wrap_sqlite3_total_changes64(__attribute__((unused)) sqlite3 * db) {
+    return mock_type(sqlite3_int64);
+}
+
+int __wrap_sqlite3_stmt_readonly(__attribute__((unused)) sqlite3_stmt *pStmt) {
+    return mock();
+}
+
 const char*  __wrap_sqlite3_sql(__attribute__((unused)) sqlite3_stmt *pStmt){
     return mock_ptr_type(char*);
 }
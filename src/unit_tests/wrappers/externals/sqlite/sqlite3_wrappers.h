@@ -13,6 +13,15 @@
 
 #include "../external/sqlite/sqlite3.h"
 
+sqlite3_backup *__wrap_sqlite3_backup_init(sqlite3 *pDest,
+                                           const char *zDestName,
+                                           sqlite3 *pSource,
+                                           const char *zSourceName);
+
+int __wrap_sqlite3_backup_step(sqlite3_backup *p, int nPage);
+
+int __wrap_sqlite3_backup_finish(sqlite3_backup *p);
+
 int __wrap_sqlite3_bind_int(sqlite3_stmt *stmt,
                             int index,
                             int value);
@@ -102,6 +111,10 @@ const char* __wrap_sqlite3_column_name(sqlite3_stmt *pStmt, int N);
 
 int __wrap_sqlite3_get_autocommit(__attribute__((unused)) sqlite3 * db);
 
+sqlite3_int64 __wrap_sqlite3_total_changes64(sqlite3 * db);
+
+int __wrap_sqlite3_stmt_readonly(sqlite3_stmt *pStmt);
+
 const char* __wrap_sqlite3_sql(sqlite3_stmt *pStmt);
 
 #endif
@@ -0,0 +1,20 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+#include "fanotify_wrappers.h"
+#include <stddef.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+
+int __wrap_fanotify_init(__attribute__((unused)) unsigned int flags,
+                         __attribute__((unused)) unsigned int event_f_flags) {
+    return mock();
+}
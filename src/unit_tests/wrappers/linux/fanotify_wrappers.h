@@ -0,0 +1,16 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+
+#ifndef FANOTIFY_WRAPPERS_H
+#define FANOTIFY_WRAPPERS_H
+
+int __wrap_fanotify_init(unsigned int flags, unsigned int event_f_flags);
+
+#endif
@@ -57,6 +57,12 @@ ssize_t __wrap_send(__attribute__((unused))int __fd, __attribute__((unused))cons
     return mock();
 }
 
+ssize_t __wrap_sendmsg(__attribute__((unused))int __fd, const struct msghdr *__message, __attribute__((unused))int __flags) {
+    check_expected(__message->msg_iovlen);
+    check_expected_ptr(__message->msg_iov[0].iov_base);
+    return mock();
+}
+
 ssize_t __wrap_sendto(__attribute__((unused)) int __fd, __attribute__((unused)) const void *__buf, __attribute__((unused)) size_t __n, __attribute__((unused)) int __flags,
                       __attribute__((unused)) __CONST_SOCKADDR_ARG __addr, __attribute__((unused))socklen_t __len){
     return mock();
@@ -90,6 +96,16 @@ ssize_t __wrap_recv(__attribute__((unused))int __fd, __attribute__((unused))void
     return mock();
 }
 
+int __wrap_recvmmsg(__attribute__((unused))int __fd, struct mmsghdr *__vmessages, unsigned int __vlen, __attribute__((unused))int __flags, __attribute__((unused))struct timespec *__tmo) {
+    int n = mock();
+
+    for (int i = 0; i < n && (unsigned int)i < __vlen; i++) {
+        __vmessages[i].msg_len = mock();
+    }
+
+    return n;
+}
+
 ssize_t __wrap_recvfrom(__attribute__((unused))int __fd, __attribute__((unused))void *__restrict __buf, __attribute__((unused))size_t __n, __attribute__((unused))int __flags, __attribute__((unused))__SOCKADDR_ARG __addr, __attribute__((unused))socklen_t *__restrict __addr_len) {
 
     if(__fd != -1) {
@@ -30,6 +30,8 @@ int __wrap_accept(__attribute__((unused))int __fd, struct sockaddr * __addr, __a
 
 ssize_t __wrap_send(__attribute__((unused))int __fd, __attribute__((unused))const void *__buf, __attribute__((unused))size_t __n, __attribute__((unused))int __flags);
 
+ssize_t __wrap_sendmsg(int __fd, const struct msghdr *__message, int __flags);
+
 ssize_t __wrap_sendto(__attribute__((unused))int __fd, __attribute__((unused))const void *__buf, __attribute__((unused))size_t __n, __attribute__((unused)) int __flags,
                       __attribute__((unused)) __CONST_SOCKADDR_ARG __addr, __attribute__((unused))socklen_t __len);
 
@@ -37,6 +39,8 @@ ssize_t __wrap_recv(__attribute__((unused))int __fd, __attribute__((unused))void
 
 ssize_t __wrap_recvfrom(__attribute__((unused))int __fd, __attribute__((unused))void *__restrict __buf, __attribute__((unused))size_t __n, __attribute__((unused))int __flags, __attribute__((unused))__SOCKADDR_ARG __addr, __attribute__((unused))socklen_t *__restrict __addr_len);
 
+int __wrap_recvmmsg(int __fd, struct mmsghdr *__vmessages, unsigned int __vlen, int __flags, struct timespec *__tmo);
+
 int __wrap_fcntl(__attribute__((unused))int __fd, __attribute__((unused))int __cmd, ...);
 
 int __wrap_getaddrinfo(const char *node, __attribute__((unused))const char *service, __attribute__((unused))const struct addrinfo *hints, struct addrinfo **res);
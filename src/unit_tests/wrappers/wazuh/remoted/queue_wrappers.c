@@ -33,3 +33,15 @@ int __wrap_rem_msgpush(__attribute__((unused)) const char * buffer, unsigned lon
 
     return mock();
 }
+
+size_t __wrap_rem_msgpush_batch(message_t ** messages, size_t count) {
+    check_expected(count);
+
+    for (size_t i = 0; i < count; i++) {
+        unsigned int size = messages[i]->size;
+        check_expected(size);
+        rem_msgfree(messages[i]);
+    }
+
+    return count;
+}
@@ -21,6 +21,22 @@ int __wrap_bqueue_push(bqueue_t * queue, const void * data, size_t length, unsig
     return mock();
 }
 
+int __wrap_bqueue_pushv(bqueue_t * queue, const struct iovec * iov, int iovcnt, unsigned flags) {
+    char data[OS_MAXSTR + sizeof(uint32_t)];
+    size_t length = 0;
+
+    for (int i = 0; i < iovcnt; i++) {
+        memcpy(data + length, iov[i].iov_base, iov[i].iov_len);
+        length += iov[i].iov_len;
+    }
+
+    check_expected_ptr(queue);
+    check_expected(data);
+    check_expected(length);
+    check_expected(flags);
+    return mock();
+}
+
 size_t __wrap_bqueue_peek(bqueue_t * queue, char * buffer, size_t length, unsigned flags) {
     check_expected_ptr(queue);
     check_expected(flags);
@@ -30,6 +46,16 @@ size_t __wrap_bqueue_peek(bqueue_t * queue, char * buffer, size_t length, unsign
     return mock();
 }
 
+size_t __wrap_bqueue_peekv(bqueue_t * queue, struct iovec iov[2], size_t length) {
+    check_expected_ptr(queue);
+    check_expected(length);
+    iov[0].iov_base = mock_type(char *);
+    iov[0].iov_len = mock();
+    iov[1].iov_base = NULL;
+    iov[1].iov_len = 0;
+    return iov[0].iov_len;
+}
+
 int __wrap_bqueue_drop(bqueue_t * queue, size_t length) {
     check_expected_ptr(queue);
     check_expected(length);
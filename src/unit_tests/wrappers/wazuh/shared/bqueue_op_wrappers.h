@@ -16,8 +16,12 @@
 
 int __wrap_bqueue_push(bqueue_t * queue, const void * data, size_t length, unsigned flags);
 
+int __wrap_bqueue_pushv(bqueue_t * queue, const struct iovec * iov, int iovcnt, unsigned flags);
+
 size_t __wrap_bqueue_peek(bqueue_t * queue, char * buffer, size_t length, unsigned flags);
 
+size_t __wrap_bqueue_peekv(bqueue_t * queue, struct iovec iov[2], size_t length);
+
 int __wrap_bqueue_drop(bqueue_t * queue, size_t length);
 
 void __wrap_bqueue_clear(bqueue_t * queue);
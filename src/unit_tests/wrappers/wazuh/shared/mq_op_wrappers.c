@@ -29,6 +29,19 @@ int __wrap_SendMSGPredicated(int queue, const char *message, const char *locmsg,
 }
 
 
+#ifndef WIN32
+int __wrap_mq_batch_push(__attribute__((unused)) mq_batch_t * batch, const char * message, const char * locmsg, char loc) {
+    check_expected(message);
+    check_expected(locmsg);
+    check_expected(loc);
+    return mock();
+}
+
+int __wrap_mq_batch_flush(__attribute__((unused)) mq_batch_t * batch) {
+    return mock();
+}
+#endif
+
 int __wrap_StartMQ(const char *path, short int type,__attribute__((unused)) short int n_attempts) {
     check_expected(path);
     check_expected(type);
@@ -11,6 +11,7 @@
 #ifndef MQ_OP_WRAPPERS_H
 #define MQ_OP_WRAPPERS_H
 #include <stdbool.h>
+#include "../../../../headers/shared.h"
 
 int __wrap_SendMSG(int queue, const char *message, const char *locmsg, char loc);
 
@@ -33,4 +34,10 @@ int __wrap_SendMSGPredicated(int queue, const char *message, const char *locmsg,
  */
 void expect_SendMSGPredicated_call(const char *message, const char *locmsg, char loc, bool (*fn_ptr)(), int ret);
 
+#ifndef WIN32
+int __wrap_mq_batch_push(mq_batch_t * batch, const char * message, const char * locmsg, char loc);
+
+int __wrap_mq_batch_flush(mq_batch_t * batch);
+#endif
+
 #endif
@@ -27,6 +27,16 @@ int __wrap_getDefine_Int(__attribute__((unused)) const char *high_name,
         return 300;
     }
 
+    // For SCA
+    if (!strcmp(low_name, "max_parallel")) {
+        return 1;
+    }
+
+    // For SCA
+    if (!strcmp(low_name, "nice")) {
+        return 0;
+    }
+
     return mock();
 }
 
@@ -131,6 +131,30 @@ void expect_fim_db_file_pattern_search(const char* pattern, int ret_val) {
     will_return(__wrap_fim_db_file_pattern_search, ret_val);
 }
 
+FIMDBErrorCode __wrap_fim_db_file_prefix_search(const char* prefix,
+                                                __attribute__((unused)) callback_context_t callback) {
+    check_expected(prefix);
+
+    return mock();
+}
+
+void expect_fim_db_file_prefix_search(const char* prefix, int ret_val) {
+    expect_string(__wrap_fim_db_file_prefix_search, prefix, prefix);
+    will_return(__wrap_fim_db_file_prefix_search, ret_val);
+}
+
+FIMDBErrorCode __wrap_fim_db_remove_path_prefix(const char* prefix,
+                                                __attribute__((unused)) callback_context_t callback) {
+    check_expected(prefix);
+
+    return mock();
+}
+
+void expect_fim_db_remove_path_prefix(const char* prefix, int ret_val) {
+    expect_string(__wrap_fim_db_remove_path_prefix, prefix, prefix);
+    will_return(__wrap_fim_db_remove_path_prefix, ret_val);
+}
+
 FIMDBErrorCode __wrap_fim_db_file_inode_search(const unsigned long inode,
                                     const unsigned long dev,
                                     __attribute__((unused)) callback_context_t callback) {
@@ -84,6 +84,22 @@ FIMDBErrorCode __wrap_fim_db_file_pattern_search(const char* pattern,
 
 void expect_fim_db_file_pattern_search(const char* pattern, int ret_val);
 
+FIMDBErrorCode __wrap_fim_db_file_prefix_search(const char* prefix,
+                                                __attribute__((unused)) callback_context_t callback);
+
+/**
+ * @brief This function loads the expect and will_return calls for the wrapper of fim_db_file_prefix_search
+ */
+void expect_fim_db_file_prefix_search(const char* prefix, int ret_val);
+
+FIMDBErrorCode __wrap_fim_db_remove_path_prefix(const char* prefix,
+                                                __attribute__((unused)) callback_context_t callback);
+
+/**
+ * @brief This function loads the expect and will_return calls for the wrapper of fim_db_remove_path_prefix
+ */
+void expect_fim_db_remove_path_prefix(const char* prefix, int ret_val);
+
 FIMDBErrorCode __wrap_fim_db_file_inode_search(const unsigned long inode,
                                     const unsigned long dev,
                                     __attribute__((unused)) callback_context_t callback);
@@ -0,0 +1,18 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation
+ */
+
+
+#ifndef SYSCHECKD_SCAN_STATS_WRAPPERS_H
+#define SYSCHECKD_SCAN_STATS_WRAPPERS_H
+
+#include <cJSON.h>
+
+cJSON * __wrap_fim_scan_stats_json();
+
+#endif
@@ -65,6 +65,14 @@ int __wrap_wdb_update_agent_keepalive(int id, const char *connection_status, con
     return mock();
 }
 
+int __wrap_wdb_update_agents_keepalive(const int *ids, size_t count, const char *connection_status, const char *sync_status, __attribute__((unused)) int *sock) {
+    check_expected(count);
+    check_expected_ptr(ids);
+    check_expected(connection_status);
+    check_expected(sync_status);
+    return mock();
+}
+
 int __wrap_wdb_update_agent_data(agent_info_data *agent_data, __attribute__((unused)) int *sock) {
     check_expected(agent_data);
     return mock();
@@ -146,6 +154,14 @@ int __wrap_wdb_insert_agent(int id, const char *name, __attribute__((unused)) co
     return mock();
 }
 
+int __wrap_wdb_insert_agents(cJSON *agents, int keep_date, __attribute__((unused)) int *sock) {
+    char *agents_str = cJSON_PrintUnformatted(agents);
+    check_expected(agents_str);
+    check_expected(keep_date);
+    free(agents_str);
+    return mock();
+}
+
 int __wrap_wdb_remove_agent(int id, __attribute__((unused)) int *sock) {
     check_expected(id);
     return mock();
@@ -22,6 +22,7 @@ int* __wrap_wdb_get_agents_ids_of_current_node(const char* status, __attribute__
 int* __wrap_wdb_get_all_agents(bool include_manager, int *sock);
 rb_tree* __wrap_wdb_get_all_agents_rbtree(bool include_manager, int *sock);
 int __wrap_wdb_update_agent_keepalive(int id, const char *connection_status, const char *sync_status, __attribute__((unused)) int *sock);
+int __wrap_wdb_update_agents_keepalive(const int *ids, size_t count, const char *connection_status, const char *sync_status, __attribute__((unused)) int *sock);
 int __wrap_wdb_update_agent_data(agent_info_data *agent_data, __attribute__((unused)) int *sock);
 int __wrap_wdb_update_agent_connection_status(int id, const char *connection_status, const char *sync_status, __attribute__((unused)) int *sock);
 int __wrap_wdb_update_agent_status_code(int id, agent_status_code_t status_code, const char *version, const char *sync_status, __attribute__((unused)) int *sock);
@@ -49,6 +50,8 @@ cJSON* __wrap_wdb_get_distinct_agent_groups(__attribute__((unused)) int *sock);
 int __wrap_wdb_insert_agent(int id, const char *name, __attribute__((unused)) const char *ip, const char *register_ip,
                             const char *internal_key, const char *group, int keep_date, __attribute__((unused)) int *sock);
 
+int __wrap_wdb_insert_agents(cJSON *agents, int keep_date, __attribute__((unused)) int *sock);
+
 int __wrap_wdb_remove_agent(int id, __attribute__((unused)) int *sock);
 
 #endif
@@ -20,5 +20,6 @@ int __wrap_wdb_task_get_upgrade_task_by_agent_id(__attribute__((unused)) wdb_t*
 int __wrap_wdb_task_cancel_upgrade_tasks(__attribute__((unused)) wdb_t* wdb, const char *node);
 int __wrap_wdb_task_set_timeout_status(__attribute__((unused)) wdb_t* wdb, time_t now, int interval, time_t *next_timeout);
 int __wrap_wdb_task_delete_old_entries(__attribute__((unused)) wdb_t* wdb, int timestamp);
+int __wrap_wdb_task_get_summary(__attribute__((unused)) wdb_t* wdb, cJSON **summary);
 
 #endif
@@ -0,0 +1,518 @@
+/* Copyright (C) 2015, Wazuh Inc.
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU General Public
+ * License (version 2) as published by the FSF - Free Software
+ * Foundation.
+ */
+
+/* Load test of wazuh-db.
+ * A capture of requests is replayed over the wazuh-db socket, with a
+ * connection per thread, and the latency of each command is reported.
+ */
+
+#ifdef ARGV0
+#undef ARGV0
+#endif
+#define ARGV0 "wazuh-db-bench"
+
+#include "shared.h"
+#include "wazuhdb_op.h"
+
+#define BENCH_AGENT_TAG "{agent}"
+#define BENCH_STATS     "{\"command\":\"getstats\"}"
+
+/* Request of the capture. Agent requests keep the text after the agent ID. */
+typedef struct bench_request_t {
+    char *text;
+    int agent;          ///< Whether the request is "agent <id> <text>"
+    int command;        ///< Index in the command table
+} bench_request_t;
+
+/* Latencies of a command, in microseconds */
+typedef struct bench_latency_t {
+    unsigned int *usec;
+    size_t size;
+    size_t alloc;
+    unsigned long long errors;
+} bench_latency_t;
+
+typedef struct bench_worker_t {
+    pthread_t thread;
+    int id;
+    int sock;
+    bench_latency_t *latency;       ///< One per command
+    unsigned long long requests;
+} bench_worker_t;
+
+static bench_request_t *requests;
+static size_t requests_size;
+static char **commands;
+static size_t commands_size;
+static int loops = 1;
+static int threads = 1;
+static int agents = 0;
+static int first_agent = 1;
+
+__attribute__((noreturn))
+static void help_bench(char * home_path)
+{
+    print_header();
+    print_out("  %s: -[hde] [-t threads] [-n loops] [-a agents] [-o first] [-D dir] <capture>", ARGV0);
+    print_out("    -h          This help message");
+    print_out("    -d          Execute in debug mode. This parameter");
+    print_out("                can be specified multiple times");
+    print_out("                to increase the debug level.");
+    print_out("    -t <n>      Number of threads, each one with its own connection (default: 1)");
+    print_out("    -n <n>      Number of times the capture is replayed (default: 1)");
+    print_out("    -a <n>      Number of agents the agent requests are replayed for (default: as captured)");
+    print_out("    -o <id>     ID of the first agent (default: 1)");
+    print_out("    -e          Remove the databases of the agents before the replay");
+    print_out("    -D <dir>    Directory to chdir into (default: %s)", home_path);
+    print_out(" ");
+    print_out("  The capture is a file with one request per line, '-' for stdin, like the");
+    print_out("  wazuh_db.capture_size internal option records in logs/wazuh-db-requests.log.");
+    print_out("  With -a, each thread replays the agent requests for its share of the agents,");
+    print_out("  and %s is replaced with the agent ID in the other requests.", BENCH_AGENT_TAG);
+    print_out(" ");
+    os_free(home_path);
+    exit(1);
+}
+
+static unsigned long long bench_nsec(const struct timespec *start, const struct timespec *end) {
+    return (unsigned long long)(end->tv_sec - start->tv_sec) * 1000000000ULL + end->tv_nsec - start->tv_nsec;
+}
+
+/* Command of a request: its actor, command and subcommand, without the agent ID nor the payload */
+static int bench_command(const char *text, int agent) {
+    char command[OS_SIZE_128];
+    const char *cur = text;
+    size_t length = 0;
+    int words;
+    size_t i;
+
+    // Agent requests that keep their agent ID
+    if (!agent && strncmp(cur, "agent ", 6) == 0) {
+        cur += 6;
+        cur += strcspn(cur, " ");
+        cur += strspn(cur, " ");
+        agent = 1;
+    }
+
+    if (agent) {
+        length = snprintf(command, sizeof(command), "agent ");
+    }
+
+    for (words = 0; words < (agent ? 2 : 3) && *cur && length < sizeof(command) - 1; words++) {
+        size_t word = strcspn(cur, " ");
+
+        // Payloads are not part of the command
+        if (words > 0 && (*cur == '{' || *cur == '[' || isdigit((unsigned char)*cur))) {
+            break;
+        }
+
+        length += snprintf(command + length, sizeof(command) - length, "%s%.*s", length && command[length - 1] != ' ' ? " " : "", (int)word, cur);
+        cur += word;
+        cur += strspn(cur, " ");
+    }
+
+    for (i = 0; i < commands_size; i++) {
+        if (strcmp(commands[i], command) == 0) {
+            return i;
+        }
+    }
+
+    os_realloc(commands, (commands_size + 1) * sizeof(char *), commands);
+    os_strdup(command, commands[commands_size]);
+    return commands_size++;
+}
+
+/* Load the capture. Agent requests lose their agent ID, if it is replaced. */
+static void bench_load_capture(const char *path) {
+    char line[OS_MAXSTR + 1];
+    size_t alloc = 0;
+    FILE *fp;
+
+    if (strcmp(path, "-") == 0) {
+        fp = stdin;
+    } else if (fp = wfopen(path, "r"), !fp) {
+        merror_exit(FOPEN_ERROR, path, errno, strerror(errno));
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        bench_request_t *request;
+        char *text = line;
+        char *end;
+        int agent = 0;
+
+        if (end = strchr(line, '\n'), end) {
+            *end = '\0';
+        }
+
+        if (*line == '\0' || *line == '#') {
+            continue;
+        }
+
+        if (agents > 0 && strncmp(line, "agent ", 6) == 0 && (end = strchr(line + 6, ' '), end)) {
+            text = end + 1;
+            agent = 1;
+        }
+
+        if (requests_size == alloc) {
+            alloc = alloc ? alloc * 2 : 1024;
+            os_realloc(requests, alloc * sizeof(bench_request_t), requests);
+        }
+
+        request = &requests[requests_size++];
+        os_strdup(text, request->text);
+        request->agent = agent;
+        request->command = bench_command(text, agent);
+    }
+
+    if (fp != stdin) {
+        fclose(fp);
+    }
+
+    if (requests_size == 0) {
+        merror_exit("No requests found in the capture '%s'.", path);
+    }
+}
+
+/* Build the request to send for an agent, or for none if agent is 0 */
+static void bench_build(const bench_request_t *request, int agent, char *query) {
+    char id[OS_SIZE_16];
+    const char *tag;
+
+    if (agent == 0) {
+        snprintf(query, OS_MAXSTR, "%s", request->text);
+        return;
+    }
+
+    if (request->agent) {
+        snprintf(query, OS_MAXSTR, "agent %03d %s", agent, request->text);
+        return;
+    }
+
+    snprintf(id, sizeof(id), "%d", agent);
+    *query = '\0';
+
+    for (const char *cur = request->text; cur; cur = tag ? tag + strlen(BENCH_AGENT_TAG) : NULL) {
+        size_t length = strlen(query);
+
+        if (tag = strstr(cur, BENCH_AGENT_TAG), tag) {
+            snprintf(query + length, OS_MAXSTR - length, "%.*s%s", (int)(tag - cur), cur, id);
+        } else {
+            snprintf(query + length, OS_MAXSTR - length, "%s", cur);
+        }
+    }
+}
+
+static void bench_send(bench_worker_t *worker, const bench_request_t *request, char *query, char *response) {
+    bench_latency_t *latency = &worker->latency[request->command];
+    struct timespec t0;
+    struct timespec t1;
+    int result;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    result = wdbc_query_ex(&worker->sock, query, response, OS_MAXSTR);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (result != 0 || strncmp(response, "err", 3) == 0) {
+        mdebug1("Request '%.64s' failed: %.64s", query, result ? "communication error" : response);
+        latency->errors++;
+    }
+
+    if (latency->size == latency->alloc) {
+        latency->alloc = latency->alloc ? latency->alloc * 2 : 1024;
+        os_realloc(latency->usec, latency->alloc * sizeof(unsigned int), latency->usec);
+    }
+
+    latency->usec[latency->size++] = bench_nsec(&t0, &t1) / 1000;
+    worker->requests++;
+}
+
+static void *bench_worker(void *arg) {
+    bench_worker_t *worker = (bench_worker_t *)arg;
+    char *query;
+    char *response;
+    int loop;
+    size_t i;
+
+    os_malloc(OS_MAXSTR + 1, query);
+    os_malloc(OS_MAXSTR + 1, response);
+
+    for (loop = 0; loop < loops; loop++) {
+        if (agents == 0) {
+            for (i = 0; i < requests_size; i++) {
+                bench_build(&requests[i], 0, query);
+                bench_send(worker, &requests[i], query, response);
+            }
+
+            continue;
+        }
+
+        // Each agent is replayed by one thread, like a manager serves it
+        for (int agent = first_agent + worker->id; agent < first_agent + agents; agent += threads) {
+            for (i = 0; i < requests_size; i++) {
+                bench_build(&requests[i], agent, query);
+                bench_send(worker, &requests[i], query, response);
+            }
+        }
+    }
+
+    os_free(query);
+    os_free(response);
+    return NULL;
+}
+
+/* Remove the databases of the agents, so that the replay starts with empty ones */
+static void bench_empty_agents() {
+    char query[OS_SIZE_128];
+    char *response;
+    int sock = -1;
+
+    os_malloc(OS_MAXSTR + 1, response);
+
+    for (int agent = first_agent; agent < first_agent + agents; agent++) {
+        snprintf(query, sizeof(query), "wazuhdb remove %d", agent);
+
+        if (wdbc_query_ex(&sock, query, response, OS_MAXSTR) != 0 || strncmp(response, "ok", 2) != 0) {
+            merror_exit("Couldn't remove the database of agent %03d.", agent);
+        }
+    }
+
+    os_free(response);
+
+    if (sock >= 0) {
+        close(sock);
+    }
+}
+
+/* SQLite counters of wazuh-db. Returns 0 on success or -1 if they are not available. */
+static int bench_sqlite_stats(unsigned long long *busy, unsigned long long *busy_exceeded) {
+    char *response;
+    cJSON *stats;
+    cJSON *sqlite;
+    int sock = -1;
+    int result = -1;
+
+    os_malloc(OS_MAXSTR + 1, response);
+
+    if (wdbc_query_ex(&sock, BENCH_STATS, response, OS_MAXSTR) == 0 && (stats = cJSON_Parse(response), stats)) {
+        sqlite = cJSON_GetObjectItem(cJSON_GetObjectItem(cJSON_GetObjectItem(stats, "data"), "metrics"), "sqlite");
+
+        if (cJSON_IsNumber(cJSON_GetObjectItem(sqlite, "busy")) && cJSON_IsNumber(cJSON_GetObjectItem(sqlite, "busy_exceeded"))) {
+            *busy = cJSON_GetObjectItem(sqlite, "busy")->valuedouble;
+            *busy_exceeded = cJSON_GetObjectItem(sqlite, "busy_exceeded")->valuedouble;
+            result = 0;
+        }
+
+        cJSON_Delete(stats);
+    }
+
+    os_free(response);
+
+    if (sock >= 0) {
+        close(sock);
+    }
+
+    return result;
+}
+
+static int bench_usec_compare(const void *a, const void *b) {
+    unsigned int x = *(const unsigned int *)a;
+    unsigned int y = *(const unsigned int *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static double bench_percentile(const unsigned int *usec, size_t size, double percentile) {
+    return usec[(size_t)((size - 1) * percentile / 100.0)] / 1e3;
+}
+
+/* Latency percentiles of each command, merged from all the workers */
+static void bench_report(bench_worker_t *workers, double wall) {
+    size_t c;
+    int i;
+
+    print_out(" ");
+    print_out("%-36s %10s %8s %10s %9s %9s %9s %9s", "Command", "requests", "errors", "req/s", "p50 (ms)", "p90 (ms)", "p99 (ms)", "max (ms)");
+
+    for (c = 0; c < commands_size; c++) {
+        unsigned long long errors = 0;
+        unsigned int *usec = NULL;
+        size_t size = 0;
+
+        for (i = 0; i < threads; i++) {
+            bench_latency_t *latency = &workers[i].latency[c];
+
+            os_realloc(usec, (size + latency->size + 1) * sizeof(unsigned int), usec);
+            memcpy(usec + size, latency->usec, latency->size * sizeof(unsigned int));
+            size += latency->size;
+            errors += latency->errors;
+        }
+
+        if (size > 0) {
+            qsort(usec, size, sizeof(unsigned int), bench_usec_compare);
+            print_out("%-36.36s %10zu %8llu %10.0f %9.3f %9.3f %9.3f %9.3f", commands[c], size, errors,
+                      wall > 0 ? size / wall : 0.0, bench_percentile(usec, size, 50), bench_percentile(usec, size, 90),
+                      bench_percentile(usec, size, 99), usec[size - 1] / 1e3);
+        }
+
+        os_free(usec);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int c = 0;
+    int empty = 0;
+    bench_worker_t *workers;
+    struct timespec start;
+    struct timespec end;
+    unsigned long long total = 0;
+    unsigned long long errors = 0;
+    unsigned long long busy[2] = { 0 };
+    unsigned long long busy_exceeded[2] = { 0 };
+    int sqlite_stats;
+    double wall;
+    size_t k;
+    int i;
+
+    OS_SetName(ARGV0);
+
+    char * home_path = w_homedir(argv[0]);
+
+    while ((c = getopt(argc, argv, "hdet:n:a:o:D:")) != -1) {
+        switch (c) {
+            case 'h':
+                help_bench(home_path);
+                break;
+            case 'd':
+                nowDebug();
+                break;
+            case 'e':
+                empty = 1;
+                break;
+            case 't':
+                if (threads = atoi(optarg), threads < 1) {
+                    merror_exit("-t needs a positive number");
+                }
+                break;
+            case 'n':
+                if (loops = atoi(optarg), loops < 1) {
+                    merror_exit("-n needs a positive number");
+                }
+                break;
+            case 'a':
+                if (agents = atoi(optarg), agents < 1) {
+                    merror_exit("-a needs a positive number");
+                }
+                break;
+            case 'o':
+                if (first_agent = atoi(optarg), first_agent < 1) {
+                    merror_exit("-o needs a positive number");
+                }
+                break;
+            case 'D':
+                snprintf(home_path, PATH_MAX, "%s", optarg);
+                break;
+            default:
+                help_bench(home_path);
+                break;
+        }
+    }
+
+    if (optind >= argc) {
+        help_bench(home_path);
+    }
+
+    if (empty && agents == 0) {
+        merror_exit("-e needs the agents to be set with -a");
+    }
+
+    /* The capture path is relative to the current directory */
+    bench_load_capture(argv[optind]);
+
+    if (chdir(home_path) == -1) {
+        merror_exit(CHDIR_ERROR, home_path, errno, strerror(errno));
+    }
+
+    if (empty) {
+        print_out("Removing the databases of %d agents.", agents);
+        bench_empty_agents();
+    }
+
+    sqlite_stats = bench_sqlite_stats(&busy[0], &busy_exceeded[0]);
+
+    os_calloc(threads, sizeof(bench_worker_t), workers);
+
+    for (i = 0; i < threads; i++) {
+        workers[i].id = i;
+        workers[i].sock = -1;
+        os_calloc(commands_size, sizeof(bench_latency_t), workers[i].latency);
+    }
+
+    if (agents > 0) {
+        print_out("Replaying %zu requests %d times for %d agents on %d threads.", requests_size, loops, agents, threads);
+    } else {
+        print_out("Replaying %zu requests %d times on %d threads.", requests_size, loops, threads);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (i = 0; i < threads; i++) {
+        if (CreateThreadJoinable(&workers[i].thread, bench_worker, &workers[i])) {
+            merror_exit(THREAD_ERROR);
+        }
+    }
+
+    for (i = 0; i < threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    wall = bench_nsec(&start, &end) / 1e9;
+
+    if (sqlite_stats == 0) {
+        sqlite_stats = bench_sqlite_stats(&busy[1], &busy_exceeded[1]);
+    }
+
+    for (i = 0; i < threads; i++) {
+        total += workers[i].requests;
+
+        for (k = 0; k < commands_size; k++) {
+            errors += workers[i].latency[k].errors;
+        }
+    }
+
+    print_out(" ");
+    print_out("Requests:        %llu (%llu failed)", total, errors);
+    print_out("Wall time:       %.3f s", wall);
+    print_out("Throughput:      %.0f requests/s", wall > 0 ? total / wall : 0.0);
+
+    if (sqlite_stats == 0) {
+        print_out("SQLite busy:     %llu retries, %llu failed steps", busy[1] - busy[0], busy_exceeded[1] - busy_exceeded[0]);
+    } else {
+        print_out("SQLite busy:     not available");
+    }
+
+    bench_report(workers, wall);
+
+    for (i = 0; i < threads; i++) {
+        for (k = 0; k < commands_size; k++) {
+            os_free(workers[i].latency[k].usec);
+        }
+
+        os_free(workers[i].latency);
+
+        if (workers[i].sock >= 0) {
+            close(workers[i].sock);
+        }
+    }
+
+    os_free(workers);
+    os_free(home_path);
+    return errors ? 1 : 0;
+}
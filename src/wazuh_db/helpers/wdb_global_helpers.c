@@ -112,6 +112,100 @@ int wdb_insert_agent(int id,
     return result;
 }
 
+/**
+ * @brief Send a batch of agents to be inserted.
+ *
+ * @param[in] batch Comma-separated list of JSON objects with the agents.
+ * @param[in] sock The Wazuh DB socket connection.
+ * @return Returns OS_SUCCESS on success or OS_INVALID on failure.
+ */
+static int wdb_insert_agents_batch(const char *batch, int *sock) {
+    char *wdbquery = NULL;
+    char wdboutput[WDBOUTPUT_SIZE] = "";
+    char *payload = NULL;
+    int result;
+
+    os_malloc(OS_MAXSTR, wdbquery);
+    snprintf(wdbquery, OS_MAXSTR, "global insert-agent {\"agents\":[%s]}", batch);
+
+    result = wdbc_query_ex(sock, wdbquery, wdboutput, sizeof(wdboutput));
+
+    switch (result) {
+        case OS_SUCCESS:
+            if (WDBC_OK != wdbc_parse_result(wdboutput, &payload)) {
+                mdebug1("Global DB Error reported in the result of the query");
+                result = OS_INVALID;
+            }
+            break;
+        case OS_INVALID:
+            mdebug1("Global DB Error in the response from socket");
+            mdebug2("Global DB SQL query: %s", wdbquery);
+            break;
+        default:
+            mdebug1("Global DB Cannot execute SQL query; err database %s/%s.db", WDB2_DIR, WDB_GLOB_NAME);
+            mdebug2("Global DB SQL query: %s", wdbquery);
+            result = OS_INVALID;
+    }
+
+    os_free(wdbquery);
+
+    return result;
+}
+
+int wdb_insert_agents(cJSON *agents, int keep_date, int *sock) {
+    int result = OS_SUCCESS;
+    char *batch = NULL;
+    size_t length = 0;
+    int aux_sock = -1;
+    cJSON *agent = NULL;
+    time_t now = time(NULL);
+    // Room for the command and the enclosing object
+    const size_t batch_limit = OS_MAXSTR - OS_SIZE_128;
+
+    os_calloc(batch_limit, sizeof(char), batch);
+
+    cJSON_ArrayForEach(agent, agents) {
+        cJSON *j_id = cJSON_GetObjectItem(agent, "id");
+        char *agent_str = NULL;
+        size_t agent_len;
+
+        cJSON_DeleteItemFromObject(agent, "date_add");
+        cJSON_AddNumberToObject(agent, "date_add", keep_date && cJSON_IsNumber(j_id) ? get_agent_date_added(j_id->valueint) : now);
+
+        agent_str = cJSON_PrintUnformatted(agent);
+        agent_len = strlen(agent_str);
+
+        if (agent_len + 1 >= batch_limit) {
+            mdebug1("Global DB Agent data too long to be inserted: %.64s", agent_str);
+            os_free(agent_str);
+            result = OS_INVALID;
+            continue;
+        }
+
+        if (length + agent_len + 1 >= batch_limit) {
+            if (OS_SUCCESS != wdb_insert_agents_batch(batch, sock?sock:&aux_sock)) {
+                result = OS_INVALID;
+            }
+            length = 0;
+        }
+
+        length += snprintf(batch + length, batch_limit - length, "%s%s", length ? "," : "", agent_str);
+        os_free(agent_str);
+    }
+
+    if (length && OS_SUCCESS != wdb_insert_agents_batch(batch, sock?sock:&aux_sock)) {
+        result = OS_INVALID;
+    }
+
+    if (!sock) {
+        wdbc_close(&aux_sock);
+    }
+
+    os_free(batch);
+
+    return result;
+}
+
 int wdb_insert_group(const char *name, int *sock) {
     int result = 0;
     char wdbquery[WDBQUERY_SIZE] = "";
@@ -333,6 +427,59 @@ int wdb_update_agent_keepalive(int id, const char *connection_status, const char
     return result;
 }
 
+int wdb_update_agents_keepalive(const int *ids, size_t count, const char *connection_status, const char *sync_status, int *sock) {
+    int result = OS_SUCCESS;
+    char *wdbquery = NULL;
+    char *wdboutput = NULL;
+    char *payload = NULL;
+    int aux_sock = -1;
+
+    os_malloc(OS_MAXSTR, wdbquery);
+    os_malloc(WDBOUTPUT_SIZE, wdboutput);
+
+    for (size_t offset = 0; offset < count; offset += WDB_KEEPALIVE_BATCH_SIZE) {
+        size_t batch = count - offset < WDB_KEEPALIVE_BATCH_SIZE ? count - offset : WDB_KEEPALIVE_BATCH_SIZE;
+        cJSON *data_in = cJSON_CreateObject();
+        char *data_in_str = NULL;
+
+        cJSON_AddItemToObject(data_in, "ids", cJSON_CreateIntArray(ids + offset, (int)batch));
+        cJSON_AddStringToObject(data_in, "connection_status", connection_status);
+        cJSON_AddStringToObject(data_in, "sync_status", sync_status);
+        data_in_str = cJSON_PrintUnformatted(data_in);
+
+        snprintf(wdbquery, OS_MAXSTR, global_db_commands[WDB_UPDATE_AGENT_KEEPALIVE], data_in_str);
+        cJSON_Delete(data_in);
+        os_free(data_in_str);
+
+        switch (wdbc_query_ex(sock?sock:&aux_sock, wdbquery, wdboutput, WDBOUTPUT_SIZE)) {
+            case OS_SUCCESS:
+                if (WDBC_OK != wdbc_parse_result(wdboutput, &payload)) {
+                    mdebug1("Global DB Error reported in the result of the query");
+                    result = OS_INVALID;
+                }
+                break;
+            case OS_INVALID:
+                mdebug1("Global DB Error in the response from socket");
+                mdebug2("Global DB SQL query: %s", wdbquery);
+                result = OS_INVALID;
+                break;
+            default:
+                mdebug1("Global DB Cannot execute SQL query; err database %s/%s.db", WDB2_DIR, WDB_GLOB_NAME);
+                mdebug2("Global DB SQL query: %s", wdbquery);
+                result = OS_INVALID;
+        }
+    }
+
+    if (!sock) {
+        wdbc_close(&aux_sock);
+    }
+
+    os_free(wdbquery);
+    os_free(wdboutput);
+
+    return result;
+}
+
 int wdb_update_agent_connection_status(int id, const char *connection_status, const char *sync_status, int *sock, agent_status_code_t status_code) {
     int result = 0;
     cJSON *data_in = NULL;
@@ -40,6 +40,9 @@ typedef enum global_db_access {
     WDB_GET_DISTINCT_AGENT_GROUP
 } global_db_access;
 
+// Agents of each batched keepalive query
+#define WDB_KEEPALIVE_BATCH_SIZE 4096
+
 /**
  * @brief Insert agent to the global.db.
  *
@@ -62,6 +65,19 @@ int wdb_insert_agent(int id,
                      int keep_date,
                      int *sock);
 
+/**
+ * @brief Insert several agents to the global.db.
+ *
+ * The agents are sent in queries of up to OS_MAXSTR bytes. The ones already in the DB are left as they are.
+ *
+ * @param[in] agents JSON array of objects with the id, name, ip, register_ip, internal_key and group of each agent.
+ *                   The addition date is set in each object.
+ * @param[in] keep_date If 1, the addition date will be taken from agents-timestamp. If 0, the addition date is the current time.
+ * @param[in] sock The Wazuh DB socket connection. If NULL, a new connection will be created and closed locally.
+ * @return Returns OS_SUCCESS on success or OS_INVALID on failure.
+ */
+int wdb_insert_agents(cJSON *agents, int keep_date, int *sock);
+
 /**
  * @brief Insert a new group.
  *
@@ -101,6 +117,20 @@ int wdb_update_agent_data(agent_info_data *agent_data, int *sock);
  */
 int wdb_update_agent_keepalive(int id, const char *connection_status, const char *sync_status, int *sock);
 
+/**
+ * @brief Update the last keepalive and the cluster synchronization status of several agents.
+ *
+ * The agents are sent in queries of up to WDB_KEEPALIVE_BATCH_SIZE IDs.
+ *
+ * @param[in] ids Array with the IDs of the agents.
+ * @param[in] count Number of IDs.
+ * @param[in] connection_status String with the connection status to be set.
+ * @param[in] sync_status String with the cluster synchronization status to be set.
+ * @param[in] sock The Wazuh DB socket connection. If NULL, a new connection will be created and closed locally.
+ * @return OS_SUCCESS on success or OS_INVALID on failure.
+ */
+int wdb_update_agents_keepalive(const int *ids, size_t count, const char *connection_status, const char *sync_status, int *sock);
+
 /**
  * @brief Update agent's connection status.
  *
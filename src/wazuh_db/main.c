@@ -24,12 +24,27 @@ static void * run_backup(void * args);
 
 extern wdb_state_t wdb_state;
 
-//int wazuhdb_fdsock;
-wnotify_t * notify_queue;
-//static w_queue_t * sock_queue;
-static pthread_mutex_t queue_mutex = PTHREAD_MUTEX_INITIALIZER;
-//static pthread_cond_t sock_cond = PTHREAD_COND_INITIALIZER;
+// Events taken by a worker on each wait
+#define WDB_WORKER_EVENTS 64
+
+// Requests received, for wazuh-db-bench to replay them
+#define WDB_CAPTURE_FILE "logs/wazuh-db-requests.log"
+
+/* Each worker owns the peers that the dealer assigns to it, and waits for
+ * their requests on its own notification set. */
+typedef struct wdb_worker_t {
+    pthread_t thread;
+    wnotify_t * notify;
+    int peers;
+} wdb_worker_t;
+
+static wdb_worker_t * workers;
 static volatile int running = 1;
+static FILE * capture_fp;
+static long capture_left;
+static pthread_mutex_t capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+static w_metric_t * metric_requests;
+static w_metric_t * metric_request_latency;
 rlim_t nofile;
 
 int main(int argc, char ** argv)
@@ -40,7 +55,6 @@ int main(int argc, char ** argv)
     int status;
 
     pthread_t thread_dealer;
-    pthread_t * worker_pool = NULL;
     pthread_t thread_gc;
     pthread_t thread_up;
     pthread_t thread_backup;
@@ -91,6 +105,8 @@ int main(int argc, char ** argv)
     wconfig.worker_pool_size = getDefine_Int("wazuh_db", "worker_pool_size", 1, 32);
     wconfig.commit_time_min = getDefine_Int("wazuh_db", "commit_time_min", 1, 3600);
     wconfig.commit_time_max = getDefine_Int("wazuh_db", "commit_time_max", 1, 3600);
+    wconfig.commit_queries_max = getDefine_Int("wazuh_db", "commit_queries_max", 0, 1000000);
+    wconfig.global_readers = getDefine_Int("wazuh_db", "global_readers", 0, 32);
     wconfig.open_db_limit = getDefine_Int("wazuh_db", "open_db_limit", 1, 4096);
     nofile = getDefine_Int("wazuh_db", "rlimit_nofile", 1024, 1048576);
 
@@ -99,6 +115,11 @@ int main(int argc, char ** argv)
     wconfig.free_pages_percentage = getDefine_Int("wazuh_db", "free_pages_percentage", 0, 99);
     wconfig.max_fragmentation = getDefine_Int("wazuh_db", "max_fragmentation", 0, 100);
     wconfig.check_fragmentation_interval = getDefine_Int("wazuh_db", "check_fragmentation_interval", 1, 30758400);
+    wconfig.vacuum_step_pages = getDefine_Int("wazuh_db", "vacuum_step_pages", 0, 1048576);
+    wconfig.vacuum_step_time = getDefine_Int("wazuh_db", "vacuum_step_time", 1, 1000);
+    wconfig.backup_step_pages = getDefine_Int("wazuh_db", "backup_step_pages", 1, 1048576);
+    wconfig.backup_step_delay = getDefine_Int("wazuh_db", "backup_step_delay", 0, 1000);
+    capture_left = (long)getDefine_Int("wazuh_db", "capture_size", 0, 1024) * 1024 * 1024;
 
     // Allocating memory for configuration structures and setting default values
     wdb_init_conf();
@@ -126,6 +147,7 @@ int main(int argc, char ** argv)
 
     open_dbs = OSHash_Create();
     if (!open_dbs) merror_exit("wazuh_db: OSHash_Create() failed");
+    wdb_pool_init();
 
     if (!run_foreground) {
         goDaemon();
@@ -195,15 +217,23 @@ int main(int argc, char ** argv)
 
     minfo(STARTUP_MSG, (int)getpid());
 
-    if (notify_queue = wnotify_init(1), !notify_queue) {
-        merror_exit("at run_dealer(): wnotify_init(): %s (%d)",
-                strerror(errno), errno);
+    os_calloc(wconfig.worker_pool_size, sizeof(wdb_worker_t), workers);
+
+    for (i = 0; i < wconfig.worker_pool_size; i++) {
+        if (workers[i].notify = wnotify_init(WDB_WORKER_EVENTS), !workers[i].notify) {
+            merror_exit("at run_worker(): wnotify_init(): %s (%d)",
+                    strerror(errno), errno);
+        }
     }
 
     // Global stats uptime
 
     wdb_state.uptime = time(NULL);
 
+    metric_requests = w_metrics_counter("wazuhdb_requests_total", "Requests served by the workers");
+    metric_request_latency = w_metrics_histogram("wazuhdb_request_latency_us", "Time to serve a request, in microseconds");
+    w_mem_metrics_init();
+
     // Start threads
 
     if (status = pthread_create(&thread_dealer, NULL, run_dealer, NULL), status != 0) {
@@ -211,10 +241,8 @@ int main(int argc, char ** argv)
         goto failure;
     }
 
-    os_calloc(wconfig.worker_pool_size, sizeof(pthread_t), worker_pool);
-
     for (i = 0; i < wconfig.worker_pool_size; i++) {
-        if (status = pthread_create(worker_pool + i, NULL, run_worker, NULL), status != 0) {
+        if (status = pthread_create(&workers[i].thread, NULL, run_worker, workers + i), status != 0) {
             merror("Couldn't create 'run_worker' %d thread: %s", i + 1, strerror(status));
             goto failure;
         }
@@ -243,11 +271,11 @@ int main(int argc, char ** argv)
     pthread_join(thread_dealer, NULL);
 
     for (i = 0; i < wconfig.worker_pool_size; i++) {
-        pthread_join(worker_pool[i], NULL);
+        pthread_join(workers[i].thread, NULL);
+        wnotify_close(workers[i].notify);
     }
 
-    wnotify_close(notify_queue);
-    free(worker_pool);
+    os_free(workers);
     pthread_join(thread_up, NULL);
     pthread_join(thread_gc, NULL);
     if(backups_enabled) {
@@ -267,7 +295,6 @@ int main(int argc, char ** argv)
     return EXIT_SUCCESS;
 
 failure:
-    os_free(worker_pool);
     return EXIT_FAILURE;
 }
 
@@ -315,7 +342,19 @@ void * run_dealer(__attribute__((unused)) void * args) {
 
             continue;
         }
-        if (wnotify_add(notify_queue, peer, WO_READ) < 0) {
+        // Assign the peer to the worker that holds the fewest peers
+
+        wdb_worker_t * worker = workers;
+
+        for (int i = 1; i < wconfig.worker_pool_size; i++) {
+            if (__atomic_load_n(&workers[i].peers, __ATOMIC_RELAXED) < __atomic_load_n(&worker->peers, __ATOMIC_RELAXED)) {
+                worker = workers + i;
+            }
+        }
+
+        __atomic_add_fetch(&worker->peers, 1, __ATOMIC_RELAXED);
+
+        if (wnotify_add(worker->notify, peer, WO_READ) < 0) {
             merror("at run_dealer(): wnotify_add(%d): %s (%d)",
                     peer, strerror(errno), errno);
             goto error;
@@ -330,94 +369,122 @@ error:
     return NULL;
 }
 
-void * run_worker(__attribute__((unused)) void * args) {
-    char buffer[OS_MAXSTR + 1];
-    char response[OS_MAXSTR + 1];
+/* Append a request to the capture file, until it reaches capture_size */
+static void capture_request(const char * request) {
+    size_t length = strlen(request);
+
+    w_mutex_lock(&capture_mutex);
+
+    if (capture_left > 0 && !capture_fp) {
+        if (capture_fp = wfopen(WDB_CAPTURE_FILE, "a"), !capture_fp) {
+            merror(FOPEN_ERROR, WDB_CAPTURE_FILE, errno, strerror(errno));
+            capture_left = 0;
+        } else {
+            minfo("Capturing requests into '%s'.", WDB_CAPTURE_FILE);
+        }
+    }
+
+    if (capture_left >= (long)length + 1) {
+        fprintf(capture_fp, "%s\n", request);
+        capture_left -= length + 1;
+    } else if (capture_fp) {
+        minfo("Capture file '%s' is complete.", WDB_CAPTURE_FILE);
+        fclose(capture_fp);
+        capture_fp = NULL;
+        capture_left = 0;
+    }
+
+    w_mutex_unlock(&capture_mutex);
+}
+
+/* Serve a request of a peer. Returns -1 if the peer was closed. */
+static int serve_peer(int peer, char * buffer, char * response) {
+    struct timespec start;
     ssize_t length;
     int terminal;
-    int peer;
 
-    while (running) {
-        // Dequeue peer
-        w_mutex_lock(&queue_mutex);
+    length = OS_RecvSecureTCP(peer, buffer, OS_MAXSTR);
 
-        switch (wnotify_wait(notify_queue, 100)) {
-        case -1:
-            if (errno == EINTR) {
-                mdebug1("at run_worker(): wnotify_wait(): %s", strerror(EINTR));
-            } else {
-                merror("at run_worker(): wnotify_wait(): %s", strerror(errno));
-            }
+    switch (length) {
+    case OS_SOCKTERR:
+        mwarn("at run_worker(): received string size is bigger than %d bytes",
+                OS_MAXSTR);
+        close(peer);
+        return -1;
 
-            w_mutex_unlock(&queue_mutex);
-            continue;
+    case -1:
+        merror("at run_worker(): at recv(): %s (%d)", strerror(errno), errno);
+        close(peer);
+        return -1;
 
-        case 0:
-            w_mutex_unlock(&queue_mutex);
-            continue;
-        }
+    case 0:
+        mdebug1("Client %d disconnected.", peer);
+        close(peer);
+        return -1;
+    }
 
-        peer = wnotify_get(notify_queue, 0, NULL);
-        if (wnotify_delete(notify_queue, peer, WO_READ) < 0) {
-            merror("at run_worker(): wnotify_delete(%d): %s (%d)",
-                    peer, strerror(errno), errno);
-        }
+    if (buffer[length - 1] == '\n') {
+        buffer[length - 1] = '\0';
+        terminal = 1;
+    } else {
+        buffer[length] = '\0';
+        terminal = 0;
+    }
 
-        w_mutex_unlock(&queue_mutex);
+    *response = '\0';
 
-        ssize_t count;
-        length = 0;
-        count = OS_RecvSecureTCP(peer, buffer, OS_MAXSTR);
+    if (__atomic_load_n(&capture_left, __ATOMIC_RELAXED) > 0) {
+        capture_request(buffer);
+    }
 
-        if(count == OS_SOCKTERR){
-            mwarn("at run_worker(): received string size is bigger than %d bytes",
-                    OS_MAXSTR);
-            break;
-        }
-        length+=count;
+    gettime(&start);
 
-        switch (length) {
-        case -1:
-            merror("at run_worker(): at recv(): %s (%d)", strerror(errno), errno);
-            close(peer);
-            continue;
+    if (buffer[0] == '{') {
+        wdbcom_dispatch(buffer, response);
+    } else {
+        wdb_parse(buffer, response, peer);
+    }
 
-        case 0:
-            mdebug1("Client %d disconnected.", peer);
-            close(peer);
-            continue;
+    w_metrics_add(metric_requests, 1);
+    w_metrics_record_since(metric_request_latency, &start);
 
-        default:
-            if (length > 0 && buffer[length - 1] == '\n') {
-                buffer[length - 1] = '\0';
-                terminal = 1;
-            } else {
-                buffer[length] = '\0';
-                terminal = 0;
-            }
+    if (length = strlen(response), length > 0) {
+        if (terminal && length < OS_MAXSTR - 1) {
+            response[length++] = '\n';
+        }
+        if (OS_SendSecureTCP(peer, length, response) < 0) {
+            merror("at run_worker(): OS_SendSecureTCP(%d): %s (%d)",
+                    peer, strerror(errno), errno);
+        }
+    }
+
+    return 0;
+}
 
-            *response = '\0';
+void * run_worker(void * args) {
+    wdb_worker_t * worker = (wdb_worker_t *)args;
+    char buffer[OS_MAXSTR + 1];
+    char response[OS_MAXSTR + 1];
+    int n_events;
+
+    while (running) {
+        // The peers stay in the set of the worker between requests
 
-            if (buffer[0] == '{') {
-                wdbcom_dispatch(buffer, response);
+        if (n_events = wnotify_wait(worker->notify, 100), n_events < 0) {
+            if (errno == EINTR) {
+                mdebug1("at run_worker(): wnotify_wait(): %s", strerror(EINTR));
             } else {
-                wdb_parse(buffer, response, peer);
-            }
-            if (length = strlen(response), length > 0) {
-                if (terminal && length < OS_MAXSTR - 1) {
-                    response[length++] = '\n';
-                }
-                if (OS_SendSecureTCP(peer, length, response) < 0) {
-                    merror("at run_worker(): OS_SendSecureTCP(%d): %s (%d)",
-                            peer, strerror(errno), errno);
-                }
+                merror("at run_worker(): wnotify_wait(): %s", strerror(errno));
             }
-            break;
+
+            continue;
         }
 
-        if (wnotify_add(notify_queue, peer, WO_READ) < 0) {
-            merror("at run_worker(): wnotify_add(%d): %s (%d)",
-                    peer, strerror(errno), errno);
+        for (int i = 0; i < n_events; i++) {
+            // Closing a peer removes it from the set
+            if (serve_peer(wnotify_get(worker->notify, i, NULL), buffer, response) < 0) {
+                __atomic_sub_fetch(&worker->peers, 1, __ATOMIC_RELAXED);
+            }
         }
     }
 
@@ -428,6 +495,7 @@ void * run_gc(__attribute__((unused)) void * args) {
     int fragmentation_interval = wconfig.check_fragmentation_interval;
     while (running) {
         wdb_commit_old();
+        wdb_reclaim_free_pages();
 
         if (fragmentation_interval <= 0) {
             wdb_check_fragmentation();
@@ -461,7 +529,7 @@ void * run_backup(__attribute__((unused)) void * args) {
                         current_time = time(NULL);
                         if((current_time - last_global_backup_time) >= global_interval) {
                             wdb_t* wdb = wdb_open_global();
-                            if (wdb && wdb->enabled && OS_SUCCESS != wdb_global_create_backup(wdb, output, NULL)) {
+                            if (wdb && wdb->enabled && OS_SUCCESS != wdb_global_create_backup_online(wdb, output, NULL)) {
                                 merror("Creating Global DB snapshot by interval failed: %s", output);
                             }
                             last_global_backup_time = current_time;
@@ -19,21 +19,22 @@ CREATE TABLE IF NOT EXISTS TASKS (
     STATUS TEXT NOT NULL,
     ERROR_MESSAGE TEXT DEFAULT NULL
 );
-CREATE INDEX IF NOT EXISTS IN_TASK_ID ON TASKS (TASK_ID);
-CREATE INDEX IF NOT EXISTS IN_TASK_AGENT ON TASKS (AGENT_ID);
-CREATE INDEX IF NOT EXISTS IN_TASK_NODE ON TASKS (NODE);
+CREATE INDEX IF NOT EXISTS IN_TASK_AGENT_COMMAND ON TASKS (AGENT_ID, COMMAND, CREATE_TIME);
+CREATE INDEX IF NOT EXISTS IN_TASK_NODE_STATUS_MODULE ON TASKS (NODE, STATUS, MODULE);
+CREATE INDEX IF NOT EXISTS IN_TASK_STATUS_UPDATE_TIME ON TASKS (STATUS, LAST_UPDATE_TIME);
 CREATE INDEX IF NOT EXISTS IN_TASK_MODULE ON TASKS (MODULE);
 CREATE INDEX IF NOT EXISTS IN_TASK_COMMAND ON TASKS (COMMAND);
 CREATE INDEX IF NOT EXISTS IN_TASK_CREATE_TIME ON TASKS (CREATE_TIME);
-CREATE INDEX IF NOT EXISTS IN_TASK_LAST_UPDATE_TIME ON TASKS (LAST_UPDATE_TIME);
-CREATE INDEX IF NOT EXISTS IN_TASK_STATUS ON TASKS (STATUS);
-CREATE INDEX IF NOT EXISTS IN_TASK_ERROR_MESSAGE ON TASKS (ERROR_MESSAGE);
+
+CREATE VIEW IF NOT EXISTS TASKS_SUMMARY AS
+    SELECT NODE AS node, MODULE AS module, COMMAND AS command, STATUS AS status, COUNT(*) AS total
+    FROM TASKS GROUP BY NODE, STATUS, MODULE, COMMAND;
 
 CREATE TABLE IF NOT EXISTS METADATA (
     key TEXT PRIMARY KEY,
     value TEXT
 );
 
-INSERT INTO METADATA (key, value) VALUES ('db_version', '1');
+INSERT INTO METADATA (key, value) VALUES ('db_version', '2');
 
 END;
@@ -0,0 +1,30 @@
+/*
+ * SQL Schema for upgrading databases
+ * Copyright (C) 2015, Wazuh Inc.
+ *
+ * October 14, 2026.
+ *
+ * This program is a free software, you can redistribute it
+ * and/or modify it under the terms of GPLv2.
+*/
+
+BEGIN;
+
+DROP INDEX IF EXISTS IN_TASK_ID;
+DROP INDEX IF EXISTS IN_TASK_AGENT;
+DROP INDEX IF EXISTS IN_TASK_NODE;
+DROP INDEX IF EXISTS IN_TASK_STATUS;
+DROP INDEX IF EXISTS IN_TASK_LAST_UPDATE_TIME;
+DROP INDEX IF EXISTS IN_TASK_ERROR_MESSAGE;
+
+CREATE INDEX IF NOT EXISTS IN_TASK_AGENT_COMMAND ON TASKS (AGENT_ID, COMMAND, CREATE_TIME);
+CREATE INDEX IF NOT EXISTS IN_TASK_NODE_STATUS_MODULE ON TASKS (NODE, STATUS, MODULE);
+CREATE INDEX IF NOT EXISTS IN_TASK_STATUS_UPDATE_TIME ON TASKS (STATUS, LAST_UPDATE_TIME);
+
+CREATE VIEW IF NOT EXISTS TASKS_SUMMARY AS
+    SELECT NODE AS node, MODULE AS module, COMMAND AS command, STATUS AS status, COUNT(*) AS total
+    FROM TASKS GROUP BY NODE, STATUS, MODULE, COMMAND;
+
+INSERT OR REPLACE INTO METADATA (key, value) VALUES ('db_version', '2');
+
+END;
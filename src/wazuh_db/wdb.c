@@ -10,6 +10,7 @@
  */
 
 #include "wdb.h"
+#include "wdb_state.h"
 #include "wazuh_modules/wmodules.h"
 #include "wazuhdb_op.h"
 
@@ -46,6 +47,8 @@ static const char *SQL_SELECT_TEMP_TABLE = "SELECT sum(s1.pageno+1==s2.pageno)*1
 static const char *SQL_SELECT_PAGE_COUNT = "SELECT page_count FROM pragma_page_count();";
 static const char *SQL_SELECT_PAGE_FREE = "SELECT freelist_count FROM pragma_freelist_count();";
 static const char *SQL_VACUUM = "VACUUM;";
+static const char *SQL_AUTO_VACUUM_INCREMENTAL = "PRAGMA auto_vacuum = INCREMENTAL;";
+static const char *SQL_SELECT_INCREMENTAL_FREE_PAGES = "SELECT freelist_count, page_count FROM pragma_freelist_count(), pragma_page_count(), pragma_auto_vacuum() WHERE auto_vacuum = 2;";
 static const char *SQL_METADATA_UPDATE_FRAGMENTATION_DATA = "INSERT INTO metadata (key, value) VALUES ('last_vacuum_time', ?), ('last_vacuum_value', ?) ON CONFLICT(key) DO UPDATE SET value=excluded.value;";
 static const char *SQL_METADATA_GET_FRAGMENTATION_DATA = "SELECT key, value FROM metadata WHERE key in ('last_vacuum_time', 'last_vacuum_value');";
 static const char *SQL_INSERT_INFO = "INSERT INTO info (key, value) VALUES (?, ?);";
@@ -175,6 +178,7 @@ static const char *SQL_STMT[] = {
     [WDB_STMT_GLOBAL_LABELS_DEL] = "DELETE FROM labels WHERE id = ?;",
     [WDB_STMT_GLOBAL_LABELS_SET] = "INSERT INTO labels (id, key, value) VALUES (?,?,?);",
     [WDB_STMT_GLOBAL_UPDATE_AGENT_KEEPALIVE] = "UPDATE agent SET last_keepalive = STRFTIME('%s', 'NOW'), connection_status = ?, sync_status = ?, disconnection_time = 0, status_code = 0 WHERE id = ?;",
+    [WDB_STMT_GLOBAL_UPDATE_AGENTS_KEEPALIVE] = "UPDATE agent SET last_keepalive = STRFTIME('%s', 'NOW'), connection_status = ?, sync_status = ?, disconnection_time = 0, status_code = 0 WHERE id IN (SELECT value FROM json_each(?));",
     [WDB_STMT_GLOBAL_UPDATE_AGENT_CONNECTION_STATUS] = "UPDATE agent SET connection_status = ?, sync_status = ?, disconnection_time = ?, status_code = ? WHERE id = ?;",
     [WDB_STMT_GLOBAL_UPDATE_AGENT_STATUS_CODE] = "UPDATE agent SET status_code = ?, version = ?, sync_status = ? WHERE id = ?;",
     [WDB_STMT_GLOBAL_DELETE_AGENT] = "DELETE FROM agent WHERE id = ?;",
@@ -219,8 +223,10 @@ static const char *SQL_STMT[] = {
     [WDB_STMT_TASK_DELETE_OLD_TASKS] = "DELETE FROM TASKS WHERE CREATE_TIME <= ?;",
     [WDB_STMT_TASK_DELETE_TASK] = "DELETE FROM TASKS WHERE TASK_ID = ?;",
     [WDB_STMT_TASK_CANCEL_PENDING_UPGRADE_TASKS] = "UPDATE TASKS SET STATUS = '" WM_TASK_STATUS_CANCELLED "', LAST_UPDATE_TIME = ? WHERE NODE = ? AND STATUS = '" WM_TASK_STATUS_PENDING "' AND (COMMAND = 'upgrade' OR COMMAND = 'upgrade_custom');",
+    [WDB_STMT_TASK_GET_SUMMARY] = "SELECT * FROM TASKS_SUMMARY;",
     [WDB_STMT_PRAGMA_JOURNAL_WAL] = "PRAGMA journal_mode=WAL;",
     [WDB_STMT_PRAGMA_ENABLE_FOREIGN_KEYS] = "PRAGMA foreign_keys=ON;",
+    [WDB_STMT_PRAGMA_SYNCHRONOUS_NORMAL] = "PRAGMA synchronous=NORMAL;",
     [WDB_STMT_SYSCOLLECTOR_PROCESSES_SELECT_CHECKSUM] = "SELECT checksum FROM sys_processes WHERE checksum != 'legacy' AND checksum != '' ORDER BY pid;",
     [WDB_STMT_SYSCOLLECTOR_PROCESSES_SELECT_CHECKSUM_RANGE] = "SELECT checksum FROM sys_processes WHERE pid BETWEEN ? and ? AND checksum != 'legacy' AND checksum != '' ORDER BY pid;",
     [WDB_STMT_SYSCOLLECTOR_PROCESSES_DELETE_AROUND] = "DELETE FROM sys_processes WHERE pid < ? OR pid > ? OR checksum = 'legacy' OR checksum = '';",
@@ -343,6 +349,28 @@ STATIC int wdb_any_transaction(wdb_t * wdb, const char* sql_transaction);
 */
 STATIC int wdb_write_state_transaction(wdb_t * wdb, uint8_t state, wdb_ptr_any_txn_t wdb_ptr_any_txn);
 
+/**
+ * @brief Schedule the commit of a transaction that has just begun
+ *
+ * The entry is pushed into a lock-free stack, since the caller holds the
+ * database mutex. wdb_commit_old() moves the entries into its heap.
+ *
+ * @param[in] wdb Database whose transaction has begun.
+ */
+STATIC void wdb_schedule_commit(wdb_t * wdb);
+
+/**
+ * @brief Insert an entry into the commit deadline heap
+ * @param[in] entry Entry to insert.
+ */
+STATIC void wdb_commit_heap_push(wdb_commit_entry_t * entry);
+
+/**
+ * @brief Take the entry with the earliest deadline from the commit deadline heap
+ * @return Entry, or NULL if the heap is empty.
+ */
+STATIC wdb_commit_entry_t * wdb_commit_heap_pop();
+
 wdb_config wconfig;
 pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
 wdb_t * db_pool_begin;
@@ -350,6 +378,36 @@ wdb_t * db_pool_last;
 int db_pool_size;
 OSHash * open_dbs;
 
+// First database of the frequently used queue, the FIFO queue goes before it
+wdb_t * db_pool_hot;
+int db_pool_cold_size;
+
+// Hashes of the ids evicted lately from the FIFO queue, in a ring. 0 is a free slot.
+static unsigned int * db_pool_ghosts;
+static unsigned int db_pool_ghosts_size;
+static unsigned int db_pool_ghosts_next;
+
+// Agent database files whose schema is known to be current, by id and inode
+static OSHash * schema_registry;
+
+static w_metric_t * metric_pool_hits;
+static w_metric_t * metric_pool_misses;
+static w_metric_t * metric_pool_evictions;
+static w_metric_t * metric_pool_ghost_hits;
+static w_metric_t * metric_schema_skips;
+
+// Read-only connections to the global database, opened on demand
+static wdb_t ** global_readers;
+static unsigned int global_reader_next;
+
+// Transactions that began since the last commit pass, pushed without lock
+static wdb_commit_entry_t * commit_pending;
+
+// Commit deadlines, only used by the thread that runs wdb_commit_old()
+STATIC wdb_commit_entry_t ** commit_heap;
+STATIC size_t commit_heap_size;
+static size_t commit_heap_max;
+
 // Opens global database and stores it in DB pool. It returns a locked database or NULL
 wdb_t * wdb_open_global() {
     char path[PATH_MAX + 1] = "";
@@ -360,6 +418,7 @@ wdb_t * wdb_open_global() {
 
     // Finds DB in pool
     if (wdb = (wdb_t *)OSHash_Get(open_dbs, WDB_GLOB_NAME), wdb) {
+        wdb_pool_touch(wdb);
         // The corresponding w_mutex_unlock(&wdb->mutex) is called in wdb_leave(wdb_t * wdb)
         w_mutex_lock(&wdb->mutex);
         wdb->refcount++;
@@ -405,12 +464,107 @@ wdb_t * wdb_open_global() {
         }
 
         wdb_enable_foreign_keys(wdb->db);
+
+        // The readers only see committed data, so every query ends its transaction
+        if (wconfig.global_readers > 0 && wdb->enabled) {
+            wdb_journal_wal(wdb->db);
+            wdb_synchronous_normal(wdb->db);
+            wdb->commit_on_leave = 1;
+        }
+    }
+
+    w_mutex_unlock(&pool_mutex);
+    return wdb;
+}
+
+wdb_t * wdb_open_global_reader() {
+    char path[PATH_MAX + 1] = "";
+    wdb_t * wdb = NULL;
+    wdb_t * writer;
+    unsigned int start;
+
+    if (wconfig.global_readers <= 0) {
+        return NULL;
+    }
+
+    w_mutex_lock(&pool_mutex);
+
+    // The readers are only open along with an enabled writer, that sets the WAL mode
+    if (writer = (wdb_t *)OSHash_Get(open_dbs, WDB_GLOB_NAME), !writer || !writer->commit_on_leave) {
+        w_mutex_unlock(&pool_mutex);
+        return NULL;
+    }
+
+    if (!global_readers) {
+        os_calloc(wconfig.global_readers, sizeof(wdb_t *), global_readers);
+    }
+
+    start = global_reader_next++;
+
+    for (int i = 0; i < wconfig.global_readers && !wdb; i++) {
+        wdb_t * reader = global_readers[(start + i) % wconfig.global_readers];
+
+        if (reader && pthread_mutex_trylock(&reader->mutex) == 0) {
+            wdb = reader;
+        }
+    }
+
+    // Every reader is busy: open another one, if there is room
+    for (int i = 0; i < wconfig.global_readers && !wdb; i++) {
+        sqlite3 * db = NULL;
+
+        if (global_readers[i]) {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s.db", WDB2_DIR, WDB_GLOB_NAME);
+
+        if (sqlite3_open_v2(path, &db, SQLITE_OPEN_READONLY, NULL)) {
+            mdebug1("Can't open SQLite database '%s' for reading: %s", path, sqlite3_errmsg(db));
+            sqlite3_close_v2(db);
+            break;
+        }
+
+        wdb = global_readers[i] = wdb_init(db, WDB_GLOB_NAME);
+        wdb->reader = 1;
+        wdb->commit_on_leave = 1;
+        w_mutex_lock(&wdb->mutex);
+    }
+
+    if (wdb) {
+        wdb->refcount++;
     }
 
     w_mutex_unlock(&pool_mutex);
     return wdb;
 }
 
+void wdb_close_global_readers() {
+    if (!global_readers) {
+        return;
+    }
+
+    for (int i = 0; i < wconfig.global_readers; i++) {
+        wdb_t * reader = global_readers[i];
+
+        if (!reader) {
+            continue;
+        }
+
+        // Wait for the query in progress
+        w_mutex_lock(&reader->mutex);
+        wdb_finalize_all_statements(reader);
+
+        if (sqlite3_close_v2(reader->db) != SQLITE_OK) {
+            merror("DB(%s) Cannot close reader: %s", reader->id, sqlite3_errmsg(reader->db));
+        }
+
+        w_mutex_unlock(&reader->mutex);
+        wdb_destroy(reader);
+        global_readers[i] = NULL;
+    }
+}
+
 wdb_t * wdb_open_mitre() {
     char path[PATH_MAX + 1];
     sqlite3 *db;
@@ -421,6 +575,7 @@ wdb_t * wdb_open_mitre() {
     w_mutex_lock(&pool_mutex);
 
     if (wdb = (wdb_t *)OSHash_Get(open_dbs, WDB_MITRE_NAME), wdb) {
+        wdb_pool_touch(wdb);
         goto success;
     }
 
@@ -447,6 +602,18 @@ end:
     return wdb;
 }
 
+/* Key of an agent database file in the schema registry. Returns 0 on success or -1 if the file can't be stat'ed. */
+static int wdb_schema_key(const char * id, const char * path, char * key, size_t size) {
+    struct stat st;
+
+    if (stat(path, &st) < 0) {
+        return -1;
+    }
+
+    snprintf(key, size, "%s:%lu:%lu", id, (unsigned long)st.st_dev, (unsigned long)st.st_ino);
+    return 0;
+}
+
 // Open database for agent and store in DB pool. It returns a locked database or NULL
 wdb_t * wdb_open_agent2(int agent_id) {
     char sagent_id[64];
@@ -461,6 +628,7 @@ wdb_t * wdb_open_agent2(int agent_id) {
     w_mutex_lock(&pool_mutex);
 
     if (wdb = (wdb_t *)OSHash_Get(open_dbs, sagent_id), wdb) {
+        wdb_pool_touch(wdb);
         goto success;
     }
 
@@ -489,12 +657,26 @@ wdb_t * wdb_open_agent2(int agent_id) {
         wdb_pool_append(wdb);
     }
     else {
+        char key[OS_SIZE_128];
+        bool has_key = schema_registry && wdb_schema_key(sagent_id, path, key, sizeof(key)) == 0;
+
         wdb = wdb_init(db, sagent_id);
         wdb_pool_append(wdb);
-        wdb = wdb_upgrade(wdb);
 
-        if (wdb == NULL) {
-            goto end;
+        // The file was upgraded since this process started, skip the version query
+        if (has_key && OSHash_Get(schema_registry, key)) {
+            wdb->schema_current = true;
+            w_metrics_add(metric_schema_skips, 1);
+        } else {
+            wdb = wdb_upgrade(wdb);
+
+            if (wdb == NULL) {
+                goto end;
+            }
+
+            if (has_key && wdb->schema_current) {
+                OSHash_Add(schema_registry, key, (void *)1);
+            }
         }
     }
 
@@ -517,6 +699,7 @@ wdb_t * wdb_open_tasks() {
 
     // Finds DB in pool
     if (wdb = (wdb_t *)OSHash_Get(open_dbs, WDB_TASK_NAME), wdb) {
+        wdb_pool_touch(wdb);
         // The corresponding w_mutex_unlock(&wdb->mutex) is called in wdb_leave(wdb_t * wdb)
         w_mutex_lock(&wdb->mutex);
         wdb->refcount++;
@@ -551,6 +734,7 @@ wdb_t * wdb_open_tasks() {
         else {
             wdb = wdb_init(db, WDB_TASK_NAME);
             wdb_pool_append(wdb);
+            wdb = wdb_upgrade_tasks(wdb);
         }
     }
 
@@ -644,9 +828,12 @@ int wdb_step(sqlite3_stmt *stmt) {
 
     for (attempts = 0; (result = sqlite3_step(stmt)) == SQLITE_BUSY; attempts++) {
         if (attempts == MAX_ATTEMPTS) {
+            w_inc_sqlite_busy_exceeded();
             mdebug1("Maximum attempts exceeded for sqlite3_step()");
             return -1;
         }
+
+        w_inc_sqlite_busy();
     }
 
     return result;
@@ -711,6 +898,11 @@ int wdb_create_file(const char *path, const char *source) {
         return OS_INVALID;
     }
 
+    // The vacuum mode must be set before the first table is created
+    if (wconfig.vacuum_step_pages > 0 && sqlite3_exec(db, SQL_AUTO_VACUUM_INCREMENTAL, NULL, NULL, NULL) != SQLITE_OK) {
+        mdebug1("Couldn't enable incremental vacuum on '%s': %s", path, sqlite3_errmsg(db));
+    }
+
     for (sql = source; sql && *sql; sql = tail) {
         if (sqlite3_prepare_v2(db, sql, -1, &stmt, &tail) != SQLITE_OK) {
             mdebug1("Preparing statement: %s", sqlite3_errmsg(db));
@@ -777,6 +969,11 @@ int wdb_vacuum(wdb_t * wdb) {
     sqlite3_stmt *stmt;
     int result;
 
+    // Databases created without incremental vacuum switch to it when they are rebuilt
+    if (wconfig.vacuum_step_pages > 0 && wdb_execute_non_select_query(wdb, SQL_AUTO_VACUUM_INCREMENTAL) == OS_INVALID) {
+        mdebug1("Couldn't enable incremental vacuum for the '%s' database.", wdb->id);
+    }
+
     if (!wdb_prepare(wdb->db, SQL_VACUUM, -1, &stmt, NULL)) {
         result = wdb_step(stmt) == SQLITE_DONE ? 0 : -1;
         sqlite3_finalize(stmt);
@@ -832,6 +1029,62 @@ int wdb_get_db_free_pages_percentage(wdb_t * wdb) {
     return (int)(((float)free_pages / (float)total_pages) * 100.00);
 }
 
+/* Get the free and total pages of a db in incremental vacuum mode. Returns OS_SUCCESS on success or OS_INVALID on error or if the db is in another mode. */
+int wdb_get_incremental_free_pages(wdb_t * wdb, int *free_pages, int *total_pages) {
+    sqlite3_stmt *stmt = NULL;
+    int result = OS_INVALID;
+
+    if (sqlite3_prepare_v2(wdb->db, SQL_SELECT_INCREMENTAL_FREE_PAGES, -1, &stmt, NULL) != SQLITE_OK) {
+        mdebug1("sqlite3_prepare_v2(): %s", sqlite3_errmsg(wdb->db));
+        return OS_INVALID;
+    }
+
+    if (wdb_step(stmt) == SQLITE_ROW) {
+        *free_pages = sqlite3_column_int(stmt, 0);
+        *total_pages = sqlite3_column_int(stmt, 1);
+        result = OS_SUCCESS;
+    }
+
+    sqlite3_finalize(stmt);
+    return result;
+}
+
+/* Release up to a number of free pages of a db, during max_time milliseconds at most. Returns the released pages or OS_INVALID on error. */
+int wdb_incremental_vacuum(wdb_t * wdb, int pages, int max_time) {
+    char sql[OS_SIZE_64];
+    sqlite3_stmt *stmt = NULL;
+    struct timespec ts_start, ts_end;
+    int released = 0;
+    int result;
+
+    snprintf(sql, sizeof(sql), "PRAGMA incremental_vacuum(%d);", pages);
+
+    if (sqlite3_prepare_v2(wdb->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        mdebug1("sqlite3_prepare_v2(): %s", sqlite3_errmsg(wdb->db));
+        return OS_INVALID;
+    }
+
+    gettime(&ts_start);
+
+    // Every step releases one page. Stopping early keeps the pages released so far.
+    while (result = wdb_step(stmt), result == SQLITE_ROW) {
+        released++;
+        gettime(&ts_end);
+
+        if (time_diff(&ts_start, &ts_end) * 1e3 >= max_time) {
+            break;
+        }
+    }
+
+    if (result != SQLITE_ROW && result != SQLITE_DONE) {
+        mdebug1("SQLite: %s", sqlite3_errmsg(wdb->db));
+        released = OS_INVALID;
+    }
+
+    sqlite3_finalize(stmt);
+    return released;
+}
+
 /* Execute a select query that returns a single integer value. Returns OS_SUCCESS on success or OS_INVALID on error. */
 STATIC int wdb_execute_single_int_select_query(wdb_t * wdb, const char *query, int *value) {
     sqlite3_stmt *stmt = NULL;
@@ -952,14 +1205,94 @@ void wdb_destroy(wdb_t * wdb) {
     free(wdb);
 }
 
+void wdb_pool_init() {
+    db_pool_ghosts_size = wconfig.open_db_limit / 2 > 0 ? wconfig.open_db_limit / 2 : 1;
+    os_calloc(db_pool_ghosts_size, sizeof(unsigned int), db_pool_ghosts);
+
+    if (schema_registry = OSHash_Create(), !schema_registry) {
+        merror_exit("wazuh_db: OSHash_Create() failed");
+    }
+
+    metric_pool_hits = w_metrics_counter("wazuhdb_pool_hits_total", "Databases found open in the pool");
+    metric_pool_misses = w_metrics_counter("wazuhdb_pool_misses_total", "Databases opened into the pool");
+    metric_pool_evictions = w_metrics_counter("wazuhdb_pool_evictions_total", "Idle databases closed beyond open_db_limit");
+    metric_pool_ghost_hits = w_metrics_counter("wazuhdb_pool_ghost_hits_total", "Databases reopened shortly after their eviction");
+    metric_schema_skips = w_metrics_counter("wazuhdb_schema_checks_skipped_total", "Agent databases reopened without checking their schema version");
+}
+
+// FNV-1a of a database id, never 0
+static unsigned int wdb_pool_ghost_hash(const char * id) {
+    unsigned int hash = 2166136261u;
+
+    for (; *id; id++) {
+        hash = (hash ^ (unsigned char)*id) * 16777619u;
+    }
+
+    return hash | 1;
+}
+
+// Check whether a database was evicted lately from the FIFO queue, forgetting it
+static bool wdb_pool_ghost_take(const char * id) {
+    unsigned int hash;
+
+    if (!db_pool_ghosts) {
+        return false;
+    }
+
+    hash = wdb_pool_ghost_hash(id);
+
+    for (unsigned int i = 0; i < db_pool_ghosts_size; i++) {
+        if (db_pool_ghosts[i] == hash) {
+            db_pool_ghosts[i] = 0;
+            return true;
+        }
+    }
+
+    return false;
+}
+
 void wdb_pool_append(wdb_t * wdb) {
     int r;
 
-    if (db_pool_begin) {
-        db_pool_last->next = wdb;
+    w_metrics_add(metric_pool_misses, 1);
+
+    if (wdb_pool_ghost_take(wdb->id)) {
+        // Reopened shortly after its eviction: last of the frequently used queue
+        w_metrics_add(metric_pool_ghost_hits, 1);
+        wdb->hot = 1;
+        wdb->next = NULL;
+        wdb->prev = db_pool_last;
+
+        if (db_pool_last) {
+            db_pool_last->next = wdb;
+        } else {
+            db_pool_begin = wdb;
+        }
+
         db_pool_last = wdb;
+
+        if (!db_pool_hot) {
+            db_pool_hot = wdb;
+        }
     } else {
-        db_pool_begin = db_pool_last = wdb;
+        // Last of the FIFO queue, right before the frequently used databases
+        wdb->hot = 0;
+        wdb->next = db_pool_hot;
+        wdb->prev = db_pool_hot ? db_pool_hot->prev : db_pool_last;
+
+        if (wdb->prev) {
+            wdb->prev->next = wdb;
+        } else {
+            db_pool_begin = wdb;
+        }
+
+        if (db_pool_hot) {
+            db_pool_hot->prev = wdb;
+        } else {
+            db_pool_last = wdb;
+        }
+
+        db_pool_cold_size++;
     }
 
     db_pool_size++;
@@ -970,31 +1303,62 @@ void wdb_pool_append(wdb_t * wdb) {
 }
 
 void wdb_pool_remove(wdb_t * wdb) {
-    wdb_t * prev;
-
     if (!OSHash_Delete(open_dbs, wdb->id)) {
         merror("Database for agent '%s' was not in hash table.", wdb->id);
     }
 
-    if (wdb == db_pool_begin) {
+    if (wdb != db_pool_begin && wdb->prev == NULL) {
+        merror("Database for agent '%s' not found in the pool.", wdb->id);
+        return;
+    }
+
+    if (wdb == db_pool_hot) {
+        db_pool_hot = wdb->next;
+    }
+
+    if (!wdb->hot) {
+        db_pool_cold_size--;
+    }
+
+    if (wdb->prev) {
+        wdb->prev->next = wdb->next;
+    } else {
         db_pool_begin = wdb->next;
+    }
 
-        if (wdb == db_pool_last) {
-            db_pool_last = NULL;
-        }
+    if (wdb->next) {
+        wdb->next->prev = wdb->prev;
+    } else {
+        db_pool_last = wdb->prev;
+    }
 
-        db_pool_size--;
-    } else if (prev = wdb_pool_find_prev(wdb), prev) {
-        prev->next = wdb->next;
+    wdb->prev = wdb->next = NULL;
+    db_pool_size--;
+}
 
-        if (wdb == db_pool_last) {
-            db_pool_last = prev;
-        }
+void wdb_pool_touch(wdb_t * wdb) {
+    w_metrics_add(metric_pool_hits, 1);
+
+    if (!wdb->hot || wdb == db_pool_last || (wdb != db_pool_begin && wdb->prev == NULL)) {
+        return;
+    }
+
+    if (wdb == db_pool_hot) {
+        db_pool_hot = wdb->next;
+    }
 
-        db_pool_size--;
+    if (wdb->prev) {
+        wdb->prev->next = wdb->next;
     } else {
-        merror("Database for agent '%s' not found in the pool.", wdb->id);
+        db_pool_begin = wdb->next;
     }
+
+    wdb->next->prev = wdb->prev;
+
+    wdb->prev = db_pool_last;
+    wdb->next = NULL;
+    db_pool_last->next = wdb;
+    db_pool_last = wdb;
 }
 
 // Duplicate the database pool
@@ -1034,22 +1398,92 @@ void wdb_close_all() {
     w_mutex_unlock(&pool_mutex);
 }
 
+STATIC void wdb_schedule_commit(wdb_t * wdb) {
+    wdb_commit_entry_t * entry;
+
+    if (wdb->commit_scheduled) {
+        return;
+    }
+
+    os_malloc(sizeof(wdb_commit_entry_t), entry);
+    os_strdup(wdb->id, entry->id);
+    entry->deadline = wdb->transaction_begin_time + wconfig.commit_time_min;
+    entry->next = __atomic_load_n(&commit_pending, __ATOMIC_RELAXED);
+
+    while (!__atomic_compare_exchange_n(&commit_pending, &entry->next, entry, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+    wdb->commit_scheduled = 1;
+}
+
+STATIC void wdb_commit_heap_push(wdb_commit_entry_t * entry) {
+    size_t i;
+
+    if (commit_heap_size == commit_heap_max) {
+        commit_heap_max = commit_heap_max ? commit_heap_max * 2 : 64;
+        os_realloc(commit_heap, commit_heap_max * sizeof(wdb_commit_entry_t *), commit_heap);
+    }
+
+    for (i = commit_heap_size++; i > 0 && commit_heap[(i - 1) / 2]->deadline > entry->deadline; i = (i - 1) / 2) {
+        commit_heap[i] = commit_heap[(i - 1) / 2];
+    }
+
+    commit_heap[i] = entry;
+}
+
+STATIC wdb_commit_entry_t * wdb_commit_heap_pop() {
+    wdb_commit_entry_t * top;
+    wdb_commit_entry_t * last;
+    size_t i = 0;
+
+    if (commit_heap_size == 0) {
+        return NULL;
+    }
+
+    top = commit_heap[0];
+    last = commit_heap[--commit_heap_size];
+
+    while (2 * i + 1 < commit_heap_size) {
+        size_t child = 2 * i + 1;
+
+        if (child + 1 < commit_heap_size && commit_heap[child + 1]->deadline < commit_heap[child]->deadline) {
+            child++;
+        }
+
+        if (commit_heap[child]->deadline >= last->deadline) {
+            break;
+        }
+
+        commit_heap[i] = commit_heap[child];
+        i = child;
+    }
+
+    if (commit_heap_size > 0) {
+        commit_heap[i] = last;
+    }
+
+    return top;
+}
+
 void wdb_commit_old() {
+    wdb_commit_entry_t * entry;
+    wdb_commit_entry_t * next;
     wdb_t * node;
-    wdb_t * next;
 
-    w_mutex_lock(&pool_mutex);
-    wdb_t *copy = wdb_pool_copy();
-    w_mutex_unlock(&pool_mutex);
+    for (entry = __atomic_exchange_n(&commit_pending, NULL, __ATOMIC_ACQUIRE); entry; entry = next) {
+        next = entry->next;
+        wdb_commit_heap_push(entry);
+    }
 
-    for (wdb_t *i = copy; i != NULL; wdb_destroy(i), i = next) {
-        next = i->next;
+    while (commit_heap_size > 0 && commit_heap[0]->deadline <= time(NULL)) {
+        entry = wdb_commit_heap_pop();
 
         w_mutex_lock(&pool_mutex);
-        node = (wdb_t *)OSHash_Get(open_dbs, i->id);
+        node = (wdb_t *)OSHash_Get(open_dbs, entry->id);
 
         if (node == NULL) {
             w_mutex_unlock(&pool_mutex);
+            os_free(entry->id);
+            os_free(entry);
             continue;
         }
 
@@ -1068,6 +1502,20 @@ void wdb_commit_old() {
             mdebug2("Agent '%s' database commited. Time: %.3f ms.", node->id, time_diff(&ts_start, &ts_end) * 1e3);
         }
 
+        if (node->transaction) {
+            // Not due yet, or the commit failed: compute the next deadline
+            time_t idle_deadline = node->last + wconfig.commit_time_min + 1;
+            time_t max_deadline = node->transaction_begin_time + wconfig.commit_time_max + 1;
+
+            entry->deadline = idle_deadline < max_deadline ? idle_deadline : max_deadline;
+            entry->deadline = entry->deadline > cur_time ? entry->deadline : cur_time + 1;
+            wdb_commit_heap_push(entry);
+        } else {
+            node->commit_scheduled = 0;
+            os_free(entry->id);
+            os_free(entry);
+        }
+
         w_mutex_unlock(&node->mutex);
         w_mutex_unlock(&pool_mutex);
     }
@@ -1165,6 +1613,60 @@ void wdb_check_fragmentation() {
     }
 }
 
+void wdb_reclaim_free_pages() {
+    wdb_t * node;
+    wdb_t * candidate = NULL;
+    double candidate_ratio = 0;
+    time_t cur_time;
+    int released;
+
+    if (wconfig.vacuum_step_pages <= 0) {
+        return;
+    }
+
+    w_mutex_lock(&pool_mutex);
+    cur_time = time(NULL);
+
+    // Pick the idle database with the highest ratio of free pages
+    for (node = db_pool_begin; node != NULL; node = node->next) {
+        int free_pages;
+        int total_pages;
+
+        if (node->refcount > 0 || node->transaction || node->cursors || cur_time - node->last < wconfig.commit_time_min) {
+            continue;
+        }
+
+        w_mutex_lock(&node->mutex);
+
+        if (wdb_get_incremental_free_pages(node, &free_pages, &total_pages) == OS_SUCCESS && free_pages > 0 && total_pages > 0 &&
+            (double)free_pages / total_pages > candidate_ratio) {
+            candidate = node;
+            candidate_ratio = (double)free_pages / total_pages;
+        }
+
+        w_mutex_unlock(&node->mutex);
+    }
+
+    if (candidate == NULL) {
+        w_mutex_unlock(&pool_mutex);
+        return;
+    }
+
+    // The reference keeps the database open once the pool is released
+    w_mutex_lock(&candidate->mutex);
+    candidate->refcount++;
+    w_mutex_unlock(&pool_mutex);
+
+    if (released = wdb_incremental_vacuum(candidate, wconfig.vacuum_step_pages, wconfig.vacuum_step_time), released == OS_INVALID) {
+        merror("Couldn't execute incremental vacuum for the database '%s'", candidate->id);
+    } else {
+        mdebug2("Incremental vacuum released %d pages of the '%s' database (%.1f%% free).", released, candidate->id, candidate_ratio * 100);
+    }
+
+    candidate->refcount--;
+    w_mutex_unlock(&candidate->mutex);
+}
+
 STATIC int wdb_get_last_vacuum_data(wdb_t * wdb, int *last_vacuum_time, int *last_vacuum_value) {
    int result = OS_INVALID;
    cJSON *data = NULL;
@@ -1242,37 +1744,55 @@ int wdb_update_last_vacuum_data(wdb_t * wdb, const char *last_vacuum_time, const
     return OS_SUCCESS;
 }
 
-void wdb_close_old() {
-    wdb_t * node;
-    wdb_t * next;
+// Close a database of the pool if it's idle, remembering the ones evicted from the FIFO queue
+static void wdb_close_idle(wdb_t * node) {
+    unsigned int hash = wdb_pool_ghost_hash(node->id);
+    bool hot = node->hot;
 
-    w_mutex_lock(&pool_mutex);
-    wdb_t *copy = wdb_pool_copy();
-    w_mutex_unlock(&pool_mutex);
+    w_mutex_lock(&node->mutex);
 
-    for (wdb_t *i = copy; i != NULL; wdb_destroy(i), i = next) {
-        next = i->next;
+    if (node->refcount == 0 && !node->transaction) {
+        w_mutex_unlock(&node->mutex);
+        mdebug2("Closing database for agent %s", node->id);
 
-        w_mutex_lock(&pool_mutex);
-        node = (wdb_t *)OSHash_Get(open_dbs, i->id);
+        if (wdb_close(node, FALSE) == OS_SUCCESS) {
+            w_metrics_add(metric_pool_evictions, 1);
 
-        if (node == NULL || db_pool_size <= wconfig.open_db_limit) {
-            w_mutex_unlock(&pool_mutex);
-            continue;
+            if (!hot && db_pool_ghosts) {
+                db_pool_ghosts[db_pool_ghosts_next] = hash;
+                db_pool_ghosts_next = (db_pool_ghosts_next + 1) % db_pool_ghosts_size;
+            }
         }
+    } else {
+        w_mutex_unlock(&node->mutex);
+    }
+}
 
-        w_mutex_lock(&node->mutex);
+void wdb_close_old() {
+    wdb_t * node;
+    wdb_t * next;
 
-        if (node->refcount == 0 && !node->transaction) {
-            w_mutex_unlock(&node->mutex);
-            mdebug2("Closing database for agent %s", node->id);
-            wdb_close(node, FALSE);
-        } else {
-            w_mutex_unlock(&node->mutex);
-        }
+    w_mutex_lock(&pool_mutex);
 
-        w_mutex_unlock(&pool_mutex);
+    // The FIFO queue, in opening order, down to a quarter of the limit
+    for (node = db_pool_begin; node != NULL && !node->hot && db_pool_size > wconfig.open_db_limit && db_pool_cold_size > wconfig.open_db_limit / 4; node = next) {
+        next = node->next;
+        wdb_close_idle(node);
+    }
+
+    // The frequently used queue, from the least recently used database
+    for (node = db_pool_hot; node != NULL && db_pool_size > wconfig.open_db_limit; node = next) {
+        next = node->next;
+        wdb_close_idle(node);
     }
+
+    // The rest of the FIFO queue
+    for (node = db_pool_begin; node != NULL && !node->hot && db_pool_size > wconfig.open_db_limit; node = next) {
+        next = node->next;
+        wdb_close_idle(node);
+    }
+
+    w_mutex_unlock(&pool_mutex);
 }
 
 int wdb_exec_stmt_silent(sqlite3_stmt* stmt) {
@@ -1337,6 +1857,55 @@ cJSON* wdb_exec_row_stmt_multi_column(sqlite3_stmt* stmt, int* status) {
     return result;
 }
 
+bool wdb_exec_row_stmt_write(sqlite3_stmt* stmt, int* status, json_writer_t* writer) {
+    bool row = false;
+
+    int _status = wdb_step(stmt);
+    if (SQLITE_ROW == _status) {
+        int count = sqlite3_column_count(stmt);
+        if (count > 0) {
+            row = true;
+            json_writer_object_begin(writer, NULL);
+
+            for (int i = 0; i < count; i++) {
+                switch (sqlite3_column_type(stmt, i)) {
+                case SQLITE_INTEGER:
+                case SQLITE_FLOAT:
+                    json_writer_add_number(writer, sqlite3_column_name(stmt, i), sqlite3_column_double(stmt, i));
+                    break;
+
+                case SQLITE_TEXT:
+                case SQLITE_BLOB: {
+                    const char * name = sqlite3_column_name(stmt, i);
+                    const char * text = (const char *)sqlite3_column_text(stmt, i);
+
+                    // Same as cJSON_AddStringToObject(), a NULL text is not added
+                    if (text) {
+                        json_writer_add_string(writer, name, text);
+                    }
+                    break;
+                }
+
+                case SQLITE_NULL:
+                default:
+                    ;
+                }
+            }
+
+            json_writer_object_end(writer);
+        }
+    }
+    else if (SQLITE_DONE != _status) {
+        mdebug1("SQL statement execution failed");
+    }
+
+    if (status) {
+        *status = _status;
+    }
+
+    return row;
+}
+
 cJSON* wdb_exec_stmt_sized(sqlite3_stmt* stmt, const size_t max_size, int* status, bool column_mode) {
     if (!stmt) {
         mdebug1("Invalid SQL statement.");
@@ -1384,40 +1953,38 @@ int wdb_exec_stmt_send(sqlite3_stmt* stmt, int peer) {
 
     int status = OS_SUCCESS;
     int sql_status = SQLITE_ERROR;
-    cJSON * row = NULL;
-    char* response = NULL;
     // Every row will be the payload of a message with the format "due {payload}"
     const char* header = "due ";
-    int header_size = strlen(header);
-    // Allocating the memory where all the responses will be dumped, it will contain the header+payload
-    os_calloc(OS_MAXSTR, sizeof(char), response);
-    // Coping the "due" header into the response buffer
-    memcpy(response, header, header_size);
-    // Each row is dumped into the payload section of the buffer, so the pointer and the tailing available space for the payload are obtained
-    char* payload = response + header_size;
-    int payload_size = OS_MAXSTR - header_size;
-
-    while ((row = wdb_exec_row_stmt(stmt, &sql_status, STMT_MULTI_COLUMN))) {
-        bool row_fits = cJSON_PrintPreallocated(row, payload, payload_size, FALSE);
-        cJSON_Delete(row);
-        if (row_fits) {
-            if (OS_SendSecureTCP(peer, strlen(response), response) < 0) {
-                merror("Socket %d error: %s (%d)", peer, strerror(errno), errno);
-                status = OS_SOCKTERR;
-                break;
-            }
+    const size_t header_size = strlen(header);
+    // The writer buffer is reused for every row, it will contain the header+payload
+    json_writer_t response;
+    json_writer_init(&response, OS_MAXSTR);
+
+    for (;;) {
+        json_writer_reset(&response);
+        json_writer_append(&response, header, header_size);
+
+        if (!wdb_exec_row_stmt_write(stmt, &sql_status, &response)) {
+            break;
         }
-        else {
+
+        if (response.length >= OS_MAXSTR) {
             merror("SQL row response for statement %s is too big to be sent", sqlite3_sql(stmt));
             status = OS_SIZELIM;
             break;
         }
+
+        if (OS_SendSecureTCP(peer, response.length, json_writer_str(&response)) < 0) {
+            merror("Socket %d error: %s (%d)", peer, strerror(errno), errno);
+            status = OS_SOCKTERR;
+            break;
+        }
     }
     if (status == OS_SUCCESS && sql_status != SQLITE_DONE) {
         status = OS_INVALID;
     }
 
-    os_free(response);
+    json_writer_free(&response);
 
     return status;
 }
@@ -1506,6 +2073,187 @@ cJSON* wdb_exec(sqlite3* db, const char * sql) {
     return result;
 }
 
+/* Detach a cursor from the list of its database */
+static wdb_cursor_t * wdb_cursor_remove(wdb_t * wdb, unsigned long id) {
+    wdb_cursor_t ** link;
+
+    for (link = &wdb->cursors; *link; link = &(*link)->next) {
+        if ((*link)->id == id) {
+            wdb_cursor_t * cursor = *link;
+            *link = cursor->next;
+            cursor->next = NULL;
+            return cursor;
+        }
+    }
+
+    return NULL;
+}
+
+static void wdb_cursor_free(wdb_cursor_t * cursor) {
+    sqlite3_finalize(cursor->stmt);
+    cJSON_Delete(cursor->pending);
+    os_free(cursor);
+}
+
+/* Close the cursors that weren't used during the last WDB_CURSOR_TTL seconds */
+static void wdb_cursor_expire(wdb_t * wdb) {
+    time_t now = time(NULL);
+    wdb_cursor_t ** link = &wdb->cursors;
+
+    while (*link) {
+        wdb_cursor_t * cursor = *link;
+
+        if (now - cursor->last >= WDB_CURSOR_TTL) {
+            mdebug2("DB(%s) Closing idle cursor %lu.", wdb->id, cursor->id);
+            *link = cursor->next;
+            wdb_cursor_free(cursor);
+        } else {
+            link = &cursor->next;
+        }
+    }
+}
+
+/* Answer the rows of a cursor that fit in a response */
+static int wdb_cursor_fill(wdb_t * wdb, wdb_cursor_t * cursor, char * output) {
+    cJSON * data = cJSON_CreateArray();
+    size_t size = 2; // '[]' json array
+    int status = SQLITE_ROW;
+    int result = OS_SUCCESS;
+    cJSON * row;
+    char * out;
+
+    while (row = cursor->pending ? cursor->pending : wdb_exec_row_stmt(cursor->stmt, &status, STMT_MULTI_COLUMN), row) {
+        char * row_str = cJSON_PrintUnformatted(row);
+        size_t row_len = strlen(row_str) + 1;
+
+        os_free(row_str);
+        cursor->pending = NULL;
+
+        if (size + row_len < WDB_MAX_RESPONSE_SIZE) {
+            cJSON_AddItemToArray(data, row);
+            size += row_len;
+        } else {
+            // The row is the first one of the next chunk
+            cursor->pending = row;
+            break;
+        }
+    }
+
+    if (cursor->pending && cJSON_GetArraySize(data) == 0) {
+        mdebug1("DB(%s) SQL row of cursor %lu is too big to be sent.", wdb->id, cursor->id);
+        snprintf(output, OS_MAXSTR + 1, "err SQL row response is too big to be sent");
+        result = OS_INVALID;
+    } else if (status != SQLITE_ROW && status != SQLITE_DONE) {
+        mdebug1("DB(%s) Cannot step cursor %lu: %s", wdb->id, cursor->id, sqlite3_errmsg(wdb->db));
+        snprintf(output, OS_MAXSTR + 1, "err Cannot execute SQL query; %s", sqlite3_errmsg(wdb->db));
+        result = OS_INVALID;
+    } else if (cursor->pending) {
+        cJSON * chunk = cJSON_CreateObject();
+
+        cJSON_AddNumberToObject(chunk, "cursor", cursor->id);
+        cJSON_AddItemToObject(chunk, "data", data);
+        data = NULL;
+
+        out = cJSON_PrintUnformatted(chunk);
+        snprintf(output, OS_MAXSTR + 1, "due %s", out);
+        os_free(out);
+        cJSON_Delete(chunk);
+
+        cursor->last = time(NULL);
+        return OS_SUCCESS;
+    } else {
+        out = cJSON_PrintUnformatted(data);
+        snprintf(output, OS_MAXSTR + 1, "ok %s", out);
+        os_free(out);
+    }
+
+    cJSON_Delete(data);
+
+    // The last chunk, and any error, closes the cursor
+    if (cursor = wdb_cursor_remove(wdb, cursor->id), cursor) {
+        wdb_cursor_free(cursor);
+    }
+
+    return result;
+}
+
+int wdb_cursor_open(wdb_t * wdb, const char * sql, char * output) {
+    sqlite3_stmt * stmt = NULL;
+    wdb_cursor_t * cursor;
+    int count = 0;
+
+    wdb_cursor_expire(wdb);
+
+    for (cursor = wdb->cursors; cursor; cursor = cursor->next) {
+        count++;
+    }
+
+    if (count >= WDB_MAX_CURSORS) {
+        mdebug1("DB(%s) Cannot open more than %d cursors.", wdb->id, WDB_MAX_CURSORS);
+        snprintf(output, OS_MAXSTR + 1, "err Too many open cursors");
+        return OS_INVALID;
+    }
+
+    if (sqlite3_prepare_v2(wdb->db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        mdebug1("DB(%s) sqlite3_prepare_v2(): %s", wdb->id, sqlite3_errmsg(wdb->db));
+        mdebug2("DB(%s) SQL: %s", wdb->id, sql);
+        snprintf(output, OS_MAXSTR + 1, "err Cannot execute SQL query; %s", sqlite3_errmsg(wdb->db));
+        return OS_INVALID;
+    }
+
+    // The statement stays open between queries, so it can't change the database
+    if (!stmt || !sqlite3_stmt_readonly(stmt)) {
+        mdebug1("DB(%s) Cursors only admit read-only queries.", wdb->id);
+        mdebug2("DB(%s) SQL: %s", wdb->id, sql);
+        snprintf(output, OS_MAXSTR + 1, "err Cursors only admit read-only queries");
+        sqlite3_finalize(stmt);
+        return OS_INVALID;
+    }
+
+    os_calloc(1, sizeof(wdb_cursor_t), cursor);
+    cursor->id = ++wdb->cursor_id;
+    cursor->stmt = stmt;
+    cursor->next = wdb->cursors;
+    wdb->cursors = cursor;
+
+    return wdb_cursor_fill(wdb, cursor, output);
+}
+
+int wdb_cursor_next(wdb_t * wdb, unsigned long id, char * output) {
+    wdb_cursor_t * cursor;
+
+    wdb_cursor_expire(wdb);
+
+    for (cursor = wdb->cursors; cursor && cursor->id != id; cursor = cursor->next);
+
+    if (!cursor) {
+        mdebug1("DB(%s) Cursor %lu not found.", wdb->id, id);
+        snprintf(output, OS_MAXSTR + 1, "err Cursor not found");
+        return OS_INVALID;
+    }
+
+    return wdb_cursor_fill(wdb, cursor, output);
+}
+
+int wdb_cursor_close(wdb_t * wdb, unsigned long id) {
+    wdb_cursor_t * cursor = wdb_cursor_remove(wdb, id);
+
+    if (!cursor) {
+        return OS_INVALID;
+    }
+
+    wdb_cursor_free(cursor);
+    return OS_SUCCESS;
+}
+
+void wdb_cursor_close_all(wdb_t * wdb) {
+    while (wdb->cursors) {
+        wdb_cursor_t * cursor = wdb->cursors;
+        wdb->cursors = cursor->next;
+        wdb_cursor_free(cursor);
+    }
+}
+
 int wdb_close(wdb_t * wdb, bool commit) {
     int result;
 
@@ -1518,6 +2266,11 @@ int wdb_close(wdb_t * wdb, bool commit) {
 
         wdb_finalize_all_statements(wdb);
 
+        // The last connection to close removes the WAL
+        if (wdb->commit_on_leave && !strcmp(wdb->id, WDB_GLOB_NAME)) {
+            wdb_close_global_readers();
+        }
+
         result = sqlite3_close_v2(wdb->db);
         w_mutex_unlock(&wdb->mutex);
 
@@ -1537,6 +2290,8 @@ int wdb_close(wdb_t * wdb, bool commit) {
 }
 
 void wdb_finalize_all_statements(wdb_t * wdb) {
+    wdb_cursor_close_all(wdb);
+
     for (int i = 0; i < WDB_STMT_SIZE; i++) {
         if (wdb->stmt[i]) {
             sqlite3_finalize(wdb->stmt[i]);
@@ -1560,26 +2315,33 @@ void wdb_finalize_all_statements(wdb_t * wdb) {
     }
 
     wdb->cache_list = NULL;
+    wdb->cache_size = 0;
 }
 
 void wdb_leave(wdb_t * wdb) {
     if (wdb) {
         wdb->refcount--;
         wdb->last = time(NULL);
-        w_mutex_unlock(&wdb->mutex);
-    }
-}
 
-wdb_t * wdb_pool_find_prev(wdb_t * wdb) {
-    wdb_t * node;
+        // Group commit: bound the size of a transaction, not only its age
+        if (wdb->transaction && !wdb->commit_on_leave && wconfig.commit_queries_max > 0) {
+            sqlite3_int64 changes = sqlite3_total_changes64(wdb->db);
 
-    for (node = db_pool_begin; node && node->next; node = node->next) {
-        if (node->next == wdb) {
-            return node;
+            // Only the queries that changed rows make the commit heavier
+            if (changes != wdb->transaction_changes) {
+                wdb->transaction_changes = changes;
+                wdb->transaction_queries++;
+            }
         }
-    }
 
-    return NULL;
+        if (wdb->transaction && (wdb->commit_on_leave || (wconfig.commit_queries_max > 0 && wdb->transaction_queries >= (unsigned int)wconfig.commit_queries_max))) {
+            if (wdb_commit2(wdb) < 0) {
+                mdebug1("DB(%s) Cannot commit transaction after %u queries.", wdb->id, wdb->transaction_queries);
+            }
+        }
+
+        w_mutex_unlock(&wdb->mutex);
+    }
 }
 
 int wdb_stmt_cache(wdb_t * wdb, int index) {
@@ -1619,8 +2381,15 @@ int wdb_sql_exec(wdb_t *wdb, const char *sql_exec) {
 /* Delete a database file */
 int wdb_remove_database(const char * agent_id) {
     char path[PATH_MAX];
+    char key[OS_SIZE_128];
 
     snprintf(path, PATH_MAX, "%s/%s.db", WDB2_DIR, agent_id);
+
+    // A new file could get the same inode
+    if (schema_registry && wdb_schema_key(agent_id, path, key, sizeof(key)) == 0) {
+        OSHash_Delete(schema_registry, key);
+    }
+
     int result = unlink(path);
 
     if (result == -1) {
@@ -1712,6 +2481,20 @@ int wdb_journal_wal(sqlite3 *db) {
     return 0;
 }
 
+int wdb_synchronous_normal(sqlite3 *db) {
+    char *sql_error = NULL;
+
+    sqlite3_exec(db, SQL_STMT[WDB_STMT_PRAGMA_SYNCHRONOUS_NORMAL], NULL, NULL, &sql_error);
+
+    if (sql_error != NULL) {
+        merror("Cannot set database synchronous mode to NORMAL: '%s'", sql_error);
+        sqlite3_free(sql_error);
+        return -1;
+    }
+
+    return 0;
+}
+
 int wdb_enable_foreign_keys(sqlite3 *db) {
     char *sql_error = NULL;
 
@@ -1773,58 +2556,66 @@ sqlite3_stmt* wdb_init_stmt_in_cache(wdb_t * wdb, wdb_stmt statement_index) {
     return wdb->stmt[statement_index];
 }
 
+// FNV-1a hash of a query, checked before comparing the whole text
+static unsigned int wdb_stmt_cache_hash(const char * query) {
+    unsigned int hash = 2166136261u;
+
+    for (; *query; query++) {
+        hash = (hash ^ (unsigned char)*query) * 16777619u;
+    }
+
+    return hash;
+}
+
 sqlite3_stmt * wdb_get_cache_stmt(wdb_t * wdb, char const *query) {
-    sqlite3_stmt * ret_val = NULL;
-    if (NULL != wdb && NULL != query) {
-        struct stmt_cache_list *node_stmt = NULL;
-        for (node_stmt = wdb->cache_list; node_stmt ; node_stmt=node_stmt->next) {
-            if (node_stmt->value.query) {
-                if (strcmp(node_stmt->value.query, query) == 0)
-                {
-                    if (sqlite3_reset(node_stmt->value.stmt) != SQLITE_OK || sqlite3_clear_bindings(node_stmt->value.stmt) != SQLITE_OK) {
-                        mdebug1("DB(%s) sqlite3_reset() stmt(%s): %s", wdb->id, sqlite3_sql(node_stmt->value.stmt), sqlite3_errmsg(wdb->db));
-                    }
-                    ret_val = node_stmt->value.stmt;
-                    break;
-                }
-            }
-        }
-        bool is_first_element = true;
-        if (NULL == ret_val) {
-            struct stmt_cache_list *new_item = NULL;
-            if (NULL == wdb->cache_list) {
-                os_malloc(sizeof(struct stmt_cache_list), wdb->cache_list);
-                new_item = wdb->cache_list;
-            } else {
-                node_stmt = wdb->cache_list;
-                while (node_stmt->next) {
-                    node_stmt = node_stmt->next;
-                }
-                is_first_element = false;
-                os_malloc(sizeof(struct stmt_cache_list), node_stmt->next);
-                //Add element in the end list
-                new_item = node_stmt->next;
-            }
-            new_item->next = NULL;
-            os_malloc(strlen(query) + 1, new_item->value.query);
-            strcpy(new_item->value.query, query);
-
-            if (sqlite3_prepare_v2(wdb->db, new_item->value.query, -1, &new_item->value.stmt, NULL) != SQLITE_OK) {
-                merror("DB(%s) sqlite3_prepare_v2() : %s", wdb->id, sqlite3_errmsg(wdb->db));
-                os_free(new_item->value.query);
-                if (is_first_element) {
-                    os_free(wdb->cache_list);
-                    wdb->cache_list = NULL;
-                } else {
-                    os_free(node_stmt->next);
-                    node_stmt->next = NULL;
-                }
-            } else {
-                ret_val = new_item->value.stmt;
+    struct stmt_cache_list *node_stmt;
+    struct stmt_cache_list **link;
+    unsigned int hash;
+
+    if (NULL == wdb || NULL == query) {
+        return NULL;
+    }
+
+    hash = wdb_stmt_cache_hash(query);
+
+    // The list is kept in LRU order: hits are moved to the front
+    for (link = &wdb->cache_list; (node_stmt = *link); link = &node_stmt->next) {
+        if (node_stmt->value.query && node_stmt->value.hash == hash && strcmp(node_stmt->value.query, query) == 0) {
+            if (sqlite3_reset(node_stmt->value.stmt) != SQLITE_OK || sqlite3_clear_bindings(node_stmt->value.stmt) != SQLITE_OK) {
+                mdebug1("DB(%s) sqlite3_reset() stmt(%s): %s", wdb->id, sqlite3_sql(node_stmt->value.stmt), sqlite3_errmsg(wdb->db));
             }
+
+            *link = node_stmt->next;
+            node_stmt->next = wdb->cache_list;
+            wdb->cache_list = node_stmt;
+            return node_stmt->value.stmt;
         }
     }
-    return ret_val;
+
+    os_malloc(sizeof(struct stmt_cache_list), node_stmt);
+
+    if (sqlite3_prepare_v2(wdb->db, query, -1, &node_stmt->value.stmt, NULL) != SQLITE_OK) {
+        merror("DB(%s) sqlite3_prepare_v2() : %s", wdb->id, sqlite3_errmsg(wdb->db));
+        os_free(node_stmt);
+        return NULL;
+    }
+
+    os_strdup(query, node_stmt->value.query);
+    node_stmt->value.hash = hash;
+    node_stmt->next = wdb->cache_list;
+    wdb->cache_list = node_stmt;
+
+    // Evict the least recently used statement
+    if (++wdb->cache_size > WDB_STMT_CACHE_MAX) {
+        for (link = &wdb->cache_list; (*link)->next; link = &(*link)->next);
+
+        sqlite3_finalize((*link)->value.stmt);
+        os_free((*link)->value.query);
+        os_free(*link);
+        wdb->cache_size--;
+    }
+
+    return node_stmt->value.stmt;
 }
 
 cJSON* wdb_get_internal_config() {
@@ -1833,6 +2624,8 @@ cJSON* wdb_get_internal_config() {
 
     cJSON_AddNumberToObject(wazuh_db_config, "commit_time_max", wconfig.commit_time_max);
     cJSON_AddNumberToObject(wazuh_db_config, "commit_time_min", wconfig.commit_time_min);
+    cJSON_AddNumberToObject(wazuh_db_config, "commit_queries_max", wconfig.commit_queries_max);
+    cJSON_AddNumberToObject(wazuh_db_config, "global_readers", wconfig.global_readers);
     cJSON_AddNumberToObject(wazuh_db_config, "open_db_limit", wconfig.open_db_limit);
     cJSON_AddNumberToObject(wazuh_db_config, "worker_pool_size", wconfig.worker_pool_size);
     cJSON_AddNumberToObject(wazuh_db_config, "fragmentation_threshold", wconfig.fragmentation_threshold);
@@ -1840,6 +2633,10 @@ cJSON* wdb_get_internal_config() {
     cJSON_AddNumberToObject(wazuh_db_config, "free_pages_percentage", wconfig.free_pages_percentage);
     cJSON_AddNumberToObject(wazuh_db_config, "max_fragmentation", wconfig.max_fragmentation);
     cJSON_AddNumberToObject(wazuh_db_config, "check_fragmentation_interval", wconfig.check_fragmentation_interval);
+    cJSON_AddNumberToObject(wazuh_db_config, "vacuum_step_pages", wconfig.vacuum_step_pages);
+    cJSON_AddNumberToObject(wazuh_db_config, "vacuum_step_time", wconfig.vacuum_step_time);
+    cJSON_AddNumberToObject(wazuh_db_config, "backup_step_pages", wconfig.backup_step_pages);
+    cJSON_AddNumberToObject(wazuh_db_config, "backup_step_delay", wconfig.backup_step_delay);
 
     cJSON_AddItemToObject(root, "wazuh_db", wazuh_db_config);
 
@@ -1919,8 +2716,14 @@ STATIC int wdb_write_state_transaction(wdb_t * wdb, uint8_t state, wdb_ptr_any_t
         }
 
         wdb->transaction = state;
+        wdb->transaction_queries = 0;
         if (1 == state) {
             wdb->transaction_begin_time = time(NULL);
+
+            // Readers aren't in the pool: wdb_leave() ends their transactions
+            if (!wdb->reader) {
+                wdb_schedule_commit(wdb);
+            }
         }
     }
     return 0;
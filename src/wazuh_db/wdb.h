@@ -46,6 +46,9 @@
 #define WDB_MAX_RESPONSE_SIZE   OS_MAXSTR-WDB_MAX_COMMAND_SIZE
 #define WDB_MAX_QUERY_SIZE      OS_MAXSTR-WDB_MAX_COMMAND_SIZE
 
+#define WDB_MAX_CURSORS         16      // Open cursors of each database
+#define WDB_CURSOR_TTL          60      // Seconds before an idle cursor is closed
+
 #define AGENT_CS_NEVER_CONNECTED "never_connected"
 #define AGENT_CS_PENDING         "pending"
 #define AGENT_CS_ACTIVE          "active"
@@ -99,6 +102,15 @@ typedef enum wdb_global_group_hash_operations_t {
     WDB_GLOBAL_GROUP_HASH_CLEAR  ///< Erases the global group hash value in cache
 } wdb_global_group_hash_operations_t;
 
+/// Algorithms an agent can use to compute its range checksums
+typedef enum wdb_checksum_algorithm_t {
+    WDB_CHECKSUM_SHA1,  ///< SHA-1 digest of the ordered row checksums (default)
+    WDB_CHECKSUM_SUM    ///< Order-independent 160-bit sum of the row checksums
+} wdb_checksum_algorithm_t;
+
+#define WDB_CHECKSUM_ALGORITHM_SHA1 "sha1"
+#define WDB_CHECKSUM_ALGORITHM_SUM "sum"
+
 #define WDB_GROUP_MODE_EMPTY_ONLY "empty_only"
 #define WDB_GROUP_MODE_OVERRIDE "override"
 #define WDB_GROUP_MODE_APPEND "append"
@@ -233,6 +245,7 @@ typedef enum wdb_stmt {
     WDB_STMT_GLOBAL_LABELS_DEL,
     WDB_STMT_GLOBAL_LABELS_SET,
     WDB_STMT_GLOBAL_UPDATE_AGENT_KEEPALIVE,
+    WDB_STMT_GLOBAL_UPDATE_AGENTS_KEEPALIVE,
     WDB_STMT_GLOBAL_UPDATE_AGENT_CONNECTION_STATUS,
     WDB_STMT_GLOBAL_UPDATE_AGENT_STATUS_CODE,
     WDB_STMT_GLOBAL_DELETE_AGENT,
@@ -277,8 +290,10 @@ typedef enum wdb_stmt {
     WDB_STMT_TASK_DELETE_OLD_TASKS,
     WDB_STMT_TASK_DELETE_TASK,
     WDB_STMT_TASK_CANCEL_PENDING_UPGRADE_TASKS,
+    WDB_STMT_TASK_GET_SUMMARY,
     WDB_STMT_PRAGMA_JOURNAL_WAL,
     WDB_STMT_PRAGMA_ENABLE_FOREIGN_KEYS,
+    WDB_STMT_PRAGMA_SYNCHRONOUS_NORMAL,
     WDB_STMT_SYSCOLLECTOR_PROCESSES_SELECT_CHECKSUM,
     WDB_STMT_SYSCOLLECTOR_PROCESSES_SELECT_CHECKSUM_RANGE,
     WDB_STMT_SYSCOLLECTOR_PROCESSES_DELETE_AROUND,
@@ -347,9 +362,13 @@ typedef enum wdb_stmt {
     WDB_STMT_SIZE // This must be the last constant
 } wdb_stmt;
 
+// Maximum number of dynamic statements cached for each database
+#define WDB_STMT_CACHE_MAX 64
+
 struct stmt_cache {
     sqlite3_stmt *stmt;
     char *query;
+    unsigned int hash;
 };
 
 struct stmt_cache_list {
@@ -357,6 +376,43 @@ struct stmt_cache_list {
     struct stmt_cache_list *next;
 };
 
+/// Enumeration of components supported by the integrity library.
+typedef enum {
+    WDB_FIM,                         ///< File integrity monitoring.
+    WDB_FIM_FILE,                    ///< File integrity monitoring.
+    WDB_FIM_REGISTRY,                ///< Registry integrity monitoring.
+    WDB_FIM_REGISTRY_KEY,            ///< Registry key integrity monitoring.
+    WDB_FIM_REGISTRY_VALUE,          ///< Registry value integrity monitoring.
+    WDB_SYSCOLLECTOR_PROCESSES,      ///< Processes integrity monitoring.
+    WDB_SYSCOLLECTOR_PACKAGES,       ///< Packages integrity monitoring.
+    WDB_SYSCOLLECTOR_HOTFIXES,       ///< Hotfixes integrity monitoring.
+    WDB_SYSCOLLECTOR_PORTS,          ///< Ports integrity monitoring.
+    WDB_SYSCOLLECTOR_NETPROTO,       ///< Net protocols integrity monitoring.
+    WDB_SYSCOLLECTOR_NETADDRESS,     ///< Net addresses integrity monitoring.
+    WDB_SYSCOLLECTOR_NETINFO,        ///< Net info integrity monitoring.
+    WDB_SYSCOLLECTOR_HWINFO,         ///< Hardware info integrity monitoring.
+    WDB_SYSCOLLECTOR_OSINFO,         ///< OS info integrity monitoring.
+    WDB_GENERIC_COMPONENT,           ///< Miscellaneous component
+} wdb_component_t;
+
+/* Last range checksum computed for a component */
+typedef struct wdb_range_checksum_t {
+    bool valid;
+    os_sha1 key;                // Digest of the algorithm and the range bounds
+    sqlite3_int64 changes;      // Row changes of the database once the query was answered
+    int result;                 // Result of wdbi_checksum_range_algorithm()
+    os_sha1 hexdigest;
+} wdb_range_checksum_t;
+
+/* Statement whose result is sent in chunks, one per "cursor next" query */
+typedef struct wdb_cursor_t {
+    unsigned long id;
+    sqlite3_stmt * stmt;
+    cJSON * pending;            // Row that didn't fit in the last chunk
+    time_t last;
+    struct wdb_cursor_t * next;
+} wdb_cursor_t;
+
 typedef struct wdb_t {
     sqlite3 * db;
     sqlite3_stmt * stmt[WDB_STMT_SIZE];
@@ -364,14 +420,33 @@ typedef struct wdb_t {
     int peer;
     unsigned int refcount;
     unsigned int transaction:1;
+    unsigned int commit_scheduled:1;    // The transaction has an entry in the commit deadline heap
+    unsigned int transaction_queries;   // Queries that modified data since the transaction began
+    sqlite3_int64 transaction_changes;  // Rows changed by the connection when the last query was counted
+    unsigned int reader:1;              // Read-only connection of the global database
+    unsigned int commit_on_leave:1;     // The transaction doesn't outlive the query
     time_t last;
     time_t transaction_begin_time;
     pthread_mutex_t mutex;
-    struct stmt_cache_list *cache_list;
+    struct stmt_cache_list *cache_list;     // Dynamic statements, in LRU order
+    unsigned int cache_size;
+    wdb_range_checksum_t range_checksum[WDB_GENERIC_COMPONENT];
+    wdb_cursor_t * cursors;
+    unsigned long cursor_id;                // Identifier of the last cursor opened
+    struct wdb_t * prev;
     struct wdb_t * next;
+    unsigned int hot:1;                     // In the frequently used queue of the pool
     bool enabled;
+    bool schema_current;                    // The schema is at the latest version
 } wdb_t;
 
+/* Commit deadline of a transaction, by database id */
+typedef struct wdb_commit_entry_t {
+    time_t deadline;
+    char * id;
+    struct wdb_commit_entry_t * next;
+} wdb_commit_entry_t;
+
 typedef enum wdb_backup_db {
     WDB_GLOBAL_BACKUP,
     WDB_LAST_BACKUP
@@ -387,37 +462,25 @@ typedef struct wdb_config {
     int worker_pool_size;
     int commit_time_min;
     int commit_time_max;
+    int commit_queries_max;
+    int global_readers;
     int open_db_limit;
     int fragmentation_threshold;
     int fragmentation_delta;
     int free_pages_percentage;
     int max_fragmentation;
     int check_fragmentation_interval;
+    int vacuum_step_pages;
+    int vacuum_step_time;
+    int backup_step_pages;
+    int backup_step_delay;
     wdb_backup_settings_node** wdb_backup_settings;
 } wdb_config;
 
-/// Enumeration of components supported by the integrity library.
-typedef enum {
-    WDB_FIM,                         ///< File integrity monitoring.
-    WDB_FIM_FILE,                    ///< File integrity monitoring.
-    WDB_FIM_REGISTRY,                ///< Registry integrity monitoring.
-    WDB_FIM_REGISTRY_KEY,            ///< Registry key integrity monitoring.
-    WDB_FIM_REGISTRY_VALUE,          ///< Registry value integrity monitoring.
-    WDB_SYSCOLLECTOR_PROCESSES,      ///< Processes integrity monitoring.
-    WDB_SYSCOLLECTOR_PACKAGES,       ///< Packages integrity monitoring.
-    WDB_SYSCOLLECTOR_HOTFIXES,       ///< Hotfixes integrity monitoring.
-    WDB_SYSCOLLECTOR_PORTS,          ///< Ports integrity monitoring.
-    WDB_SYSCOLLECTOR_NETPROTO,       ///< Net protocols integrity monitoring.
-    WDB_SYSCOLLECTOR_NETADDRESS,     ///< Net addresses integrity monitoring.
-    WDB_SYSCOLLECTOR_NETINFO,        ///< Net info integrity monitoring.
-    WDB_SYSCOLLECTOR_HWINFO,         ///< Hardware info integrity monitoring.
-    WDB_SYSCOLLECTOR_OSINFO,         ///< OS info integrity monitoring.
-    WDB_GENERIC_COMPONENT,           ///< Miscellaneous component
-} wdb_component_t;
-
 extern char *schema_global_sql;
 extern char *schema_agents_sql;
 extern char *schema_task_manager_sql;
+extern char *schema_task_manager_upgrade_v2_sql;
 extern char *schema_upgrade_v1_sql;
 extern char *schema_upgrade_v2_sql;
 extern char *schema_upgrade_v3_sql;
@@ -527,6 +590,24 @@ typedef int (*wdb_ptr_any_txn_t)(wdb_t *);
  */
 wdb_t * wdb_open_global();
 
+/**
+ * @brief Take an idle read-only connection to the global database.
+ *
+ * The connections are opened on demand, up to the global_readers internal
+ * option, and only while the writer connection is open. They are released
+ * with wdb_leave(), which also ends their read transaction.
+ *
+ * @return wdb_t* Database Structure locked, or NULL if no reader is idle.
+ */
+wdb_t * wdb_open_global_reader();
+
+/**
+ * @brief Close the read-only connections to the global database.
+ *
+ * It waits for the queries that the readers are running.
+ */
+void wdb_close_global_readers();
+
 /**
  * @brief Open mitre database and store in DB poll.
  *
@@ -778,6 +859,26 @@ int wdb_get_db_state(wdb_t * wdb);
  */
 int wdb_get_db_free_pages_percentage(wdb_t * wdb);
 
+/**
+ * @brief Get the free and total pages of a db in incremental vacuum mode.
+ *
+ * @param[in] wdb Database to query.
+ * @param[out] free_pages Pages in the freelist.
+ * @param[out] total_pages Pages of the database.
+ * @return Returns OS_SUCCESS on success, or OS_INVALID on error or if the db is not in incremental vacuum mode.
+ */
+int wdb_get_incremental_free_pages(wdb_t * wdb, int *free_pages, int *total_pages);
+
+/**
+ * @brief Release free pages of a db in incremental vacuum mode.
+ *
+ * @param[in] wdb Database to vacuum.
+ * @param[in] pages Maximum pages to release.
+ * @param[in] max_time Maximum time to spend, in milliseconds.
+ * @return Returns the released pages or OS_INVALID on error.
+ */
+int wdb_incremental_vacuum(wdb_t * wdb, int pages, int max_time);
+
 /**
  * @brief Store the fragmentation data of the last vacuum in the metadata table.
  *
@@ -878,10 +979,37 @@ wdb_t * wdb_init(sqlite3 * db, const char * id);
 
 void wdb_destroy(wdb_t * wdb);
 
+/**
+ * @brief Create the schema version registry and the pool metrics
+ */
+void wdb_pool_init();
+
+/**
+ * @brief Add a newly opened database to the pool
+ *
+ * Databases enter the FIFO queue of the pool, unless they were evicted from
+ * it recently: then they go straight to the frequently used queue.
+ * The caller must hold pool_mutex.
+ *
+ * @param wdb Database to add.
+ */
 void wdb_pool_append(wdb_t * wdb);
 
 void wdb_pool_remove(wdb_t * wdb);
 
+/**
+ * @brief Account a hit on a database of the pool
+ *
+ * The pool follows the 2Q policy: first the databases of the FIFO queue, in
+ * opening order, then the ones of the frequently used queue, in least
+ * recently used order. A hit moves a frequently used database to the end of
+ * the pool, and leaves the ones of the FIFO queue where they are, so that a
+ * burst of queries doesn't make a database hot. The caller must hold pool_mutex.
+ *
+ * @param wdb Database in the pool. Nothing is done if it is not in the pool.
+ */
+void wdb_pool_touch(wdb_t * wdb);
+
 /**
  * @brief Duplicate the database pool
  *
@@ -894,8 +1022,22 @@ wdb_t * wdb_pool_copy();
 
 void wdb_close_all();
 
+/**
+ * @brief Commit the transactions that reached their deadline
+ *
+ * Transactions are scheduled when they begin, so the function only visits
+ * the databases whose commit_time_min or commit_time_max may have elapsed.
+ */
 void wdb_commit_old();
 
+/**
+ * @brief Close idle databases beyond open_db_limit
+ *
+ * The FIFO queue is shrunk first, down to a quarter of the limit, then the
+ * least recently used frequently used databases go. The ids of the
+ * databases evicted from the FIFO queue are remembered for half the limit
+ * evictions, to spot the ones that are reopened.
+ */
 void wdb_close_old();
 
 int wdb_remove_database(const char * agent_id);
@@ -905,6 +1047,14 @@ int wdb_remove_database(const char * agent_id);
  */
 void wdb_check_fragmentation();
 
+/**
+ * @brief Release the free pages of the idle database with the highest ratio of them.
+ *
+ * It runs a bounded incremental vacuum step, so it can be called frequently. The full
+ * vacuum of wdb_check_fragmentation() is still needed to defragment the databases.
+ */
+void wdb_reclaim_free_pages();
+
 /**
  * @brief Function to execute one row of an SQL statement and save the result in a JSON array.
  *
@@ -936,6 +1086,17 @@ cJSON* wdb_exec_row_stmt_single_column(sqlite3_stmt* stmt, int* status);
  */
 cJSON* wdb_exec_row_stmt_multi_column(sqlite3_stmt* stmt, int* status);
 
+/**
+ * @brief Function to execute one row of an SQL statement and serialize it straight into a JSON writer,
+ *        with the same format as wdb_exec_row_stmt_multi_column().
+ *
+ * @param [in] stmt The SQL statement to be executed.
+ * @param [out] status The status code of the statement execution. If NULL no value is written.
+ * @param [out] writer JSON writer where the row object is appended.
+ * @return true if a row was written, false when there are no more rows or on error.
+ */
+bool wdb_exec_row_stmt_write(sqlite3_stmt* stmt, int* status, json_writer_t* writer);
+
 /**
  * @brief Function to execute an SQL statement without a response.
  *
@@ -994,6 +1155,47 @@ cJSON* wdb_exec_stmt(sqlite3_stmt* stmt);
  */
 cJSON* wdb_exec(sqlite3* db, const char * sql);
 
+/**
+ * @brief Open a cursor over a read-only query and answer its first chunk.
+ *
+ * The rows are sent in chunks that fit in a response. Every chunk but the
+ * last one is answered as "due {"cursor":<id>,"data":[...]}", and the next
+ * one is requested with wdb_cursor_next(). The last chunk is answered as
+ * "ok [...]" and closes the cursor.
+ *
+ * @param [in] wdb The database struct pointer.
+ * @param [in] sql The SQL query.
+ * @param [out] output Response of the query.
+ * @return OS_SUCCESS on success, OS_INVALID on error.
+ */
+int wdb_cursor_open(wdb_t * wdb, const char * sql, char * output);
+
+/**
+ * @brief Answer the next chunk of an open cursor.
+ *
+ * @param [in] wdb The database struct pointer.
+ * @param [in] id Identifier of the cursor.
+ * @param [out] output Response of the query.
+ * @return OS_SUCCESS on success, OS_INVALID on error.
+ */
+int wdb_cursor_next(wdb_t * wdb, unsigned long id, char * output);
+
+/**
+ * @brief Close an open cursor before reaching its last chunk.
+ *
+ * @param [in] wdb The database struct pointer.
+ * @param [in] id Identifier of the cursor.
+ * @return OS_SUCCESS on success, OS_INVALID if the cursor doesn't exist.
+ */
+int wdb_cursor_close(wdb_t * wdb, unsigned long id);
+
+/**
+ * @brief Close every cursor of a database.
+ *
+ * @param [in] wdb The database struct pointer.
+ */
+void wdb_cursor_close_all(wdb_t * wdb);
+
 // Execute SQL script into an database
 int wdb_sql_exec(wdb_t *wdb, const char *sql_exec);
 
@@ -1006,14 +1208,51 @@ int wdb_close(wdb_t * wdb, bool commit);
  */
 void wdb_finalize_all_statements(wdb_t * wdb);
 
+/**
+ * @brief Release a database after serving a query
+ *
+ * If commit_queries_max queries have modified data in the open transaction,
+ * it is committed here instead of waiting for wdb_commit_old(). Read-only
+ * queries don't count.
+ *
+ * @param wdb Database to release. It must be locked.
+ */
 void wdb_leave(wdb_t * wdb);
 
-wdb_t * wdb_pool_find_prev(wdb_t * wdb);
-
 int wdb_stmt_cache(wdb_t * wdb, int index);
 
 int wdb_parse(char * input, char * output, int peer);
 
+/**
+ * @brief Function that saves a row of a component, such as wdb_syscollector_save2()
+ */
+typedef int (*wdb_save2_t)(wdb_t * wdb, wdb_component_t component, const char * payload);
+
+/**
+ * @brief Save a batch of rows of a component, answering once for all of them
+ *
+ * Each row is framed as "<length>:<row>". The rows are saved in the open
+ * transaction of the database, one after another.
+ *
+ * @param wdb Database of the agent.
+ * @param component Component of the rows.
+ * @param save Function that saves each row.
+ * @param input Framed rows.
+ * @param output Response: "ok", or "err" with the number of rows that failed.
+ * @return OS_SUCCESS if every row was saved, OS_INVALID otherwise.
+ */
+int wdb_parse_save2_batch(wdb_t * wdb, wdb_component_t component, wdb_save2_t save, char * input, char * output);
+
+/**
+ * @brief Parse a cursor query: "open <sql>", "next <id>" or "close <id>".
+ *
+ * @param wdb The database struct pointer.
+ * @param input Query arguments.
+ * @param output Response of the query.
+ * @return OS_SUCCESS on success, OS_INVALID on error.
+ */
+int wdb_parse_cursor(wdb_t * wdb, char * input, char * output);
+
 int wdb_parse_syscheck(wdb_t * wdb, wdb_component_t component, char * input, char * output);
 int wdb_parse_syscollector(wdb_t * wdb, const char * query, char * input, char * output);
 
@@ -1127,6 +1366,9 @@ int wdb_parse_dbsync(wdb_t * wdb, char * input, char * output);
 /**
  * @brief Function to parse the agent insert request.
  *
+ * The input may also be an object with an "agents" array, to insert a batch of agents.
+ * The agents of a batch that are already in the database are left as they are.
+ *
  * @param [in] wdb The global struct database.
  * @param [in] input String with the agent data in JSON format.
  * @param [out] output Response of the query.
@@ -1205,7 +1447,7 @@ int wdb_parse_global_set_agent_labels(wdb_t * wdb, char * input, char * output);
  * @brief Function to parse the update agent keepalive request.
  *
  * @param [in] wdb The global struct database.
- * @param [in] input String with the agent data in JSON format.
+ * @param [in] input String with the agent data in JSON format. An "ids" array updates several agents at once.
  * @param [out] output Response of the query.
  * @return 0 Success: response contains "ok".
  *        -1 On error: response contains "err" and an error description.
@@ -1488,6 +1730,21 @@ int wdb_parse_global_restore_backup(wdb_t** wdb, char* input, char* output);
  */
 int wdb_global_create_backup(wdb_t* wdb, char* output, const char* tag);
 
+/**
+ * @brief Function to create a backup of global.db without blocking it.
+ *
+ * The database is copied with the SQLite online backup API in steps of wazuh_db.backup_step_pages pages. The
+ * mutex of the database is released between steps and during the compression, so the caller must hold a
+ * reference to it (wdb_open_global()).
+ *
+ * @param [in] wdb The global.db database to backup, locked by the caller.
+ * @param [out] output A message related to the result of the operation.
+ * @param [in] tag Adds extra information to snapshot file name.
+ * @retval  0 Success: Backup created successfully.
+ * @retval -1 On error: The backup creation failed.
+ */
+int wdb_global_create_backup_online(wdb_t* wdb, char* output, const char* tag);
+
 /**
  * @brief Function to delete old backups in case the amount exceeds the max_files limit.
  *
@@ -1545,6 +1802,21 @@ int wdbi_checksum(wdb_t * wdb, wdb_component_t component, os_sha1 hexdigest);
 
 int wdbi_checksum_range(wdb_t * wdb, wdb_component_t component, const char * begin, const char * end, os_sha1 hexdigest);
 
+/**
+ * @brief Run checksum of a database table range with the algorithm advertised by the agent.
+ *
+ * @param [in] wdb Database node.
+ * @param [in] component Name of the component.
+ * @param [in] algorithm Algorithm used to combine the row checksums.
+ * @param [in] begin First element.
+ * @param [in] end Last element.
+ * @param [out] hexdigest Range checksum in hexadecimal.
+ * @retval 1 On success.
+ * @retval 0 If no items were found in that range.
+ * @retval -1 On error.
+ */
+int wdbi_checksum_range_algorithm(wdb_t * wdb, wdb_component_t component, wdb_checksum_algorithm_t algorithm, const char * begin, const char * end, os_sha1 hexdigest);
+
 int wdbi_delete(wdb_t * wdb, wdb_component_t component, const char * begin, const char * end, const char * tail);
 
 /**
@@ -1628,6 +1900,14 @@ wdb_t * wdb_upgrade(wdb_t *wdb);
  */
 wdb_t * wdb_upgrade_global(wdb_t *wdb);
 
+/**
+ * @brief Function to upgrade the tasks DB to the latest version.
+ *
+ * @param [in] wdb The tasks database to upgrade.
+ * @return wdb The tasks database, upgraded as far as possible.
+ */
+wdb_t * wdb_upgrade_tasks(wdb_t *wdb);
+
 // Create backup and generate an empty DB
 wdb_t * wdb_backup(wdb_t *wdb, int version);
 
@@ -1669,7 +1949,7 @@ bool wdb_is_older_than_v310(wdb_t *wdb);
  * @param [in] component Name of the component.
  * @param [in] action Integrity check action: INTEGRITY_CHECK_GLOBAL, INTEGRITY_CHECK_LEFT or INTEGRITY_CHECK_RIGHT.
  * @param [in] payload Operation arguments in JSON format.
- * @pre payload must contain strings "id", "begin", "end" and "checksum", and optionally "tail".
+ * @pre payload must contain strings "id", "begin", "end" and "checksum", and optionally "tail" and "algorithm".
  * @retval INTEGRITY_SYNC_CKS_OK   Success: checksum matches.
  * @retval INTEGRITY_SYNC_CKS_FAIL Success: checksum does not match.
  * @retval INTEGRITY_SYNC_NO_DATA  Success: no files were found in this range.
@@ -1708,6 +1988,17 @@ int wdb_journal_wal(sqlite3 *db);
  */
 int wdb_enable_foreign_keys(sqlite3 *db);
 
+/**
+ * @brief Set the database synchronous mode to NORMAL
+ *
+ * In WAL mode, commits don't sync the database: the WAL is synced on checkpoints.
+ *
+ * @param [in] db Pointer to an open database.
+ * @retval 0 On success.
+ * @retval -1 On error.
+ */
+int wdb_synchronous_normal(sqlite3 *db);
+
 /**
 *  @brief Calculates SHA1 hash from a NULL terminated string array.
 *
@@ -1847,6 +2138,17 @@ int wdb_global_set_agent_label(wdb_t *wdb, int id, char* key, char* value);
  */
 int wdb_global_update_agent_keepalive(wdb_t *wdb, int id, const char *connection_status, const char *sync_status);
 
+/**
+ * @brief Function to update the keepalive and the synchronization status of several agents at once.
+ *
+ * @param [in] wdb The Global struct database.
+ * @param [in] ids JSON array with the agent IDs.
+ * @param [in] connection_status The agents' connection status.
+ * @param [in] sync_status The value of sync_status
+ * @return Returns 0 on success or -1 on error.
+ */
+int wdb_global_update_agents_keepalive(wdb_t *wdb, const char *ids, const char *connection_status, const char *sync_status);
+
 /**
  * @brief Function to update an agent connection status and the synchronization status.
  *
@@ -2418,6 +2720,16 @@ int wdb_parse_task_set_timeout(wdb_t* wdb, const cJSON *parameters, char* output
  */
 int wdb_parse_task_delete_old(wdb_t* wdb, const cJSON *parameters, char* output);
 
+/**
+ * @brief Function to parse the summary request.
+ *
+ * @param [in] wdb The global struct database.
+ * @param [out] output Response of the query.
+ * @return 0 Success: response contains "ok".
+ *        -1 On error: response contains "err" and an error description.
+ */
+int wdb_parse_task_summary(wdb_t* wdb, char* output);
+
 /**
  * @brief Function to parse the vuln_cves requests.
  *
@@ -2537,6 +2849,20 @@ int wdb_task_cancel_upgrade_tasks(wdb_t* wdb, const char *node);
  * */
 int wdb_task_get_upgrade_task_by_agent_id(wdb_t* wdb, int agent_id, char **node, char **module, char **command, char **status, char **error, int *create_time, int *last_update_time);
 
+/**
+ * Get the number of tasks by node, module, command and status from the tasks DB.
+ * The summary is kept until any task changes.
+ * @param wdb The task struct database
+ * @param summary JSON array where a copy of the summary will be stored.
+ * @return OS_SUCCESS on success, OS_INVALID on errors
+ * */
+int wdb_task_get_summary(wdb_t* wdb, cJSON **summary);
+
+/**
+ * Drop the summary of the tasks so it's built again on the next request.
+ * */
+void wdb_task_reset_summary();
+
 /**
  * @brief Delete entries by pk.
  *
@@ -2551,6 +2877,8 @@ void wdbi_remove_by_pk(wdb_t *wdb, wdb_component_t component, const char * pk);
 
 /**
  * Get cache stmt cached for specific query.
+ * The statement is prepared on a miss. At most WDB_STMT_CACHE_MAX statements are
+ * kept, the least recently used is finalized.
  * @param wdb The task struct database
  * @param query is the query to be executed.
  * @return Pointer to the statement already cached. NULL On error.
@@ -88,6 +88,9 @@ void wdbcom_dispatch(char* request, char* output) {
         if (strcmp(command_json->valuestring, "getstats") == 0) {
             output_builder = wdbcom_output_builder(ERROR_OK, error_messages[ERROR_OK], wdb_create_state_json());
             snprintf(output, OS_MAXSTR + 1, "%s", output_builder);
+        } else if (strcmp(command_json->valuestring, HC_GETMETRICS) == 0) {
+            output_builder = wdbcom_output_builder(ERROR_OK, error_messages[ERROR_OK], w_metrics_getmetrics_json(cJSON_GetObjectItem(request_json, "parameters")));
+            snprintf(output, OS_MAXSTR + 1, "%s", output_builder);
         } else if (strcmp(command_json->valuestring, "getconfig") == 0) {
             if (parameters_json = cJSON_GetObjectItem(request_json, "parameters"), cJSON_IsObject(parameters_json)) {
                 if (section_json = cJSON_GetObjectItem(parameters_json, "section"), cJSON_IsString(section_json)) {
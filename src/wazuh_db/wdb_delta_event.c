@@ -8,6 +8,7 @@
 #endif
 
 #define QUERY_MAX_SIZE OS_SIZE_2048
+#define WDB_TRIAGED_FIELD "triaged"
 
 #define GT(X, Y) (X > Y ? true : false)
 #define LT(X, Y) (X < Y ? true : false)
@@ -99,6 +100,15 @@ bool wdb_upsert_dbsync(wdb_t * wdb, struct kv const * kv_value, cJSON * data) {
             }
         }
 
+        // A modified row must be evaluated again by the vulnerability detector partial scan
+        for (column = kv_value->column_list; column; column = column->next) {
+            if (column->value.is_aux_field && !strcmp(column->value.target_name, WDB_TRIAGED_FIELD)) {
+                query_actual_size += snprintf(query + query_actual_size, QUERY_MAX_SIZE - query_actual_size - 1,
+                                              first_condition_element ? "%s=0" : ",%s=0", WDB_TRIAGED_FIELD);
+                first_condition_element = false;
+            }
+        }
+
         sqlite3_stmt * stmt = wdb_get_cache_stmt(wdb, query);
         bool has_error = false;
         if (NULL != stmt) {
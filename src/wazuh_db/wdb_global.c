@@ -348,6 +348,37 @@ int wdb_global_update_agent_keepalive(wdb_t *wdb, int id, const char *connection
     return wdb_exec_stmt_silent(stmt);
 }
 
+int wdb_global_update_agents_keepalive(wdb_t *wdb, const char *ids, const char *connection_status, const char *sync_status) {
+    sqlite3_stmt *stmt = NULL;
+
+    if (!wdb->transaction && wdb_begin2(wdb) < 0) {
+        mdebug1("Cannot begin transaction");
+        return OS_INVALID;
+    }
+
+    if (wdb_stmt_cache(wdb, WDB_STMT_GLOBAL_UPDATE_AGENTS_KEEPALIVE) < 0) {
+        mdebug1("Cannot cache statement");
+        return OS_INVALID;
+    }
+
+    stmt = wdb->stmt[WDB_STMT_GLOBAL_UPDATE_AGENTS_KEEPALIVE];
+
+    if (sqlite3_bind_text(stmt, 1, connection_status, -1, NULL) != SQLITE_OK) {
+        merror("DB(%s) sqlite3_bind_text(): %s", wdb->id, sqlite3_errmsg(wdb->db));
+        return OS_INVALID;
+    }
+    if (sqlite3_bind_text(stmt, 2, sync_status, -1, NULL) != SQLITE_OK) {
+        merror("DB(%s) sqlite3_bind_text(): %s", wdb->id, sqlite3_errmsg(wdb->db));
+        return OS_INVALID;
+    }
+    if (sqlite3_bind_text(stmt, 3, ids, -1, NULL) != SQLITE_OK) {
+        merror("DB(%s) sqlite3_bind_text(): %s", wdb->id, sqlite3_errmsg(wdb->db));
+        return OS_INVALID;
+    }
+
+    return wdb_exec_stmt_silent(stmt);
+}
+
 int wdb_global_update_agent_connection_status(wdb_t *wdb, int id, const char *connection_status, const char *sync_status, int status_code) {
     sqlite3_stmt *stmt = NULL;
     time_t disconnection_time = 0;
@@ -1823,17 +1854,56 @@ cJSON* wdb_global_get_agents_by_connection_status (wdb_t *wdb, int last_agent_id
     return result;
 }
 
-int wdb_global_create_backup(wdb_t* wdb, char* output, const char* tag) {
-    char path[PATH_MAX-3] = {0};
-    char path_compressed[PATH_MAX] = {0};
-    int result = OS_INVALID;
-    char* timestamp = NULL;
-
-    timestamp = w_get_timestamp(time(NULL));
+/**
+ * @brief Builds the path of a new backup of global.db, without the compression extension.
+ *
+ * @param [out] path Buffer of PATH_MAX-3 bytes for the path.
+ * @param [in] tag Extra information for the file name.
+ */
+static void wdb_global_backup_path(char* path, const char* tag) {
+    char* timestamp = w_get_timestamp(time(NULL));
     wchr_replace(timestamp, ' ', '-');
     wchr_replace(timestamp, '/', '-');
     snprintf(path, PATH_MAX-3, "%s/%s-%s%s", WDB_BACKUP_FOLDER, WDB_GLOB_BACKUP_NAME, timestamp, tag ? tag : "");
     os_free(timestamp);
+}
+
+/**
+ * @brief Compresses a copy of global.db into the backup file and removes the copy.
+ *
+ * @param [in] path Path of the uncompressed copy.
+ * @param [out] output Response of the backup command.
+ * @retval  0 Success.
+ * @retval -1 On error: the compression failed.
+ */
+static int wdb_global_compress_backup(const char* path, char* output) {
+    char path_compressed[PATH_MAX] = {0};
+    int result;
+
+    snprintf(path_compressed, PATH_MAX, "%s.gz", path);
+    result = w_compress_gzfile(path, path_compressed);
+    unlink(path);
+    if(OS_SUCCESS == result) {
+        minfo("Created Global database backup \"%s\"", path_compressed);
+        wdb_global_remove_old_backups();
+        cJSON* j_path = cJSON_CreateArray();
+        cJSON_AddItemToArray(j_path, cJSON_CreateString(path_compressed));
+        char* output_str = cJSON_PrintUnformatted(j_path);
+        snprintf(output, OS_MAXSTR + 1, "ok %s", output_str);
+        cJSON_Delete(j_path);
+        os_free(output_str);
+    } else {
+        snprintf(output, OS_MAXSTR + 1, "err Failed during database backup compression");
+    }
+
+    return result;
+}
+
+int wdb_global_create_backup(wdb_t* wdb, char* output, const char* tag) {
+    char path[PATH_MAX-3] = {0};
+    int result = OS_INVALID;
+
+    wdb_global_backup_path(path, tag);
 
     // Commiting pending transaction to run VACUUM
     if (wdb_commit2(wdb) < 0) {
@@ -1865,23 +1935,71 @@ int wdb_global_create_backup(wdb_t* wdb, char* output, const char* tag) {
     sqlite3_finalize(stmt);
 
     if (OS_SUCCESS == result) {
-        snprintf(path_compressed, PATH_MAX, "%s.gz", path);
-        result = w_compress_gzfile(path, path_compressed);
+        result = wdb_global_compress_backup(path, output);
+    }
+
+    return result;
+}
+
+int wdb_global_create_backup_online(wdb_t* wdb, char* output, const char* tag) {
+    char path[PATH_MAX-3] = {0};
+    sqlite3* dest = NULL;
+    sqlite3_backup* backup = NULL;
+    int result = SQLITE_ERROR;
+
+    wdb_global_backup_path(path, tag);
+
+    if (sqlite3_open_v2(path, &dest, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL) != SQLITE_OK) {
+        snprintf(output, OS_MAXSTR + 1, "err Cannot open backup file: %s", sqlite3_errmsg(dest));
+        sqlite3_close_v2(dest);
+        return OS_INVALID;
+    }
+
+    if (backup = sqlite3_backup_init(dest, "main", wdb->db, "main"), backup == NULL) {
+        snprintf(output, OS_MAXSTR + 1, "err DB(%s) sqlite3_backup_init(): %s", wdb->id, sqlite3_errmsg(dest));
+        sqlite3_close_v2(dest);
         unlink(path);
-        if(OS_SUCCESS == result) {
-            minfo("Created Global database backup \"%s\"", path_compressed);
-            wdb_global_remove_old_backups();
-            cJSON* j_path = cJSON_CreateArray();
-            cJSON_AddItemToArray(j_path, cJSON_CreateString(path_compressed));
-            char* output_str = cJSON_PrintUnformatted(j_path);
-            snprintf(output, OS_MAXSTR + 1, "ok %s", output_str);
-            cJSON_Delete(j_path);
-            os_free(output_str);
-        } else {
-            snprintf(output, OS_MAXSTR + 1, "err Failed during database backup compression");
+        return OS_INVALID;
+    }
+
+    for (;;) {
+        // The step would copy the pages of the pending transaction before its commit
+        if (wdb_commit2(wdb) < 0) {
+            snprintf(output, OS_MAXSTR + 1, "err Cannot commit current transaction to create backup");
+            break;
+        }
+
+        if (result = sqlite3_backup_step(backup, wconfig.backup_step_pages), result != SQLITE_OK && result != SQLITE_BUSY && result != SQLITE_LOCKED) {
+            if (result != SQLITE_DONE) {
+                snprintf(output, OS_MAXSTR + 1, "err SQLite: %s", sqlite3_errmsg(dest));
+            }
+            break;
+        }
+
+        // Other threads take the database between steps. SQLite copies their writes on this handle to the backup.
+        w_mutex_unlock(&wdb->mutex);
+        w_time_delay(wconfig.backup_step_delay);
+        w_mutex_lock(&wdb->mutex);
+
+        if (!wdb->enabled) {
+            snprintf(output, OS_MAXSTR + 1, "err Global database disabled during backup");
+            break;
         }
     }
 
+    sqlite3_backup_finish(backup);
+    sqlite3_close_v2(dest);
+
+    if (result != SQLITE_DONE) {
+        unlink(path);
+        return OS_INVALID;
+    }
+
+    // The copy is done, the compression doesn't need the database
+    w_mutex_unlock(&wdb->mutex);
+    result = wdb_global_compress_backup(path, output);
+    w_mutex_lock(&wdb->mutex);
+
     return result;
 }
 
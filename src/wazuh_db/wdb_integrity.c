@@ -18,6 +18,7 @@
 #include "wdb.h"
 #include "os_crypto/sha1/sha1_op.h"
 #include <openssl/evp.h>
+#include <openssl/sha.h>
 #include <stdarg.h>
 
 static const char * COMPONENT_NAMES[] = {
@@ -92,18 +93,49 @@ void wdbi_remove_by_pk(wdb_t *wdb, wdb_component_t component, const char *pk_val
     }
 }
 
+/**
+ * @brief Add a row checksum to an order-independent range checksum
+ *
+ * The row checksum is read as a 160-bit big-endian number and added modulo 2^160.
+ * Values that are not a hexadecimal SHA-1 digest are hashed first so every row counts.
+ *
+ * @param[in,out] sum Accumulated range value.
+ * @param[in] checksum Row checksum.
+ */
+static void wdb_checksum_sum_update(unsigned char sum[SHA_DIGEST_LENGTH], const char * checksum) {
+    unsigned char value[SHA_DIGEST_LENGTH];
+    const size_t length = strlen(checksum);
+
+    if (length == SHA_DIGEST_LENGTH * 2 && strspn(checksum, "0123456789abcdefABCDEF") == length) {
+        for (int i = 0; i < SHA_DIGEST_LENGTH; ++i) {
+            sscanf(checksum + i * 2, "%2hhx", &value[i]);
+        }
+    } else {
+        SHA1((const unsigned char *)checksum, length, value);
+    }
+
+    unsigned int carry = 0;
+
+    for (int i = SHA_DIGEST_LENGTH - 1; i >= 0; --i) {
+        carry += sum[i] + value[i];
+        sum[i] = carry & 0xFF;
+        carry >>= 8;
+    }
+}
+
 /**
  * @brief Run checksum of the whole result of an already prepared statement
  *
  * @param[in] wdb Database node.
  * @param[in] stmt Statement to be executed already prepared.
  * @param[in] component Name of the component.
+ * @param[in] algorithm Algorithm used to combine the row checksums.
  * @param[out] hexdigest
  * @param[in] pk_value Primary key value.
  * @retval 1 On success.
  * @retval 0 If no items were found.
  */
-int wdb_calculate_stmt_checksum(wdb_t * wdb, sqlite3_stmt * stmt, wdb_component_t component, os_sha1 hexdigest, const char * pk_value) {
+int wdb_calculate_stmt_checksum_algorithm(wdb_t * wdb, sqlite3_stmt * stmt, wdb_component_t component, wdb_checksum_algorithm_t algorithm, os_sha1 hexdigest, const char * pk_value) {
     assert(wdb != NULL);
     assert(stmt != NULL);
     assert(hexdigest != NULL);
@@ -114,8 +146,14 @@ int wdb_calculate_stmt_checksum(wdb_t * wdb, sqlite3_stmt * stmt, wdb_component_
         return 0;
     }
 
-    EVP_MD_CTX * ctx = EVP_MD_CTX_create();
-    EVP_DigestInit(ctx, EVP_sha1());
+    EVP_MD_CTX * ctx = NULL;
+    unsigned char digest[EVP_MAX_MD_SIZE] = {0};
+    unsigned int digest_size;
+
+    if (WDB_CHECKSUM_SHA1 == algorithm) {
+        ctx = EVP_MD_CTX_create();
+        EVP_DigestInit(ctx, EVP_sha1());
+    }
 
     size_t row_count = 0;
     for (; step == SQLITE_ROW; step = wdb_step(stmt)) {
@@ -128,15 +166,18 @@ int wdb_calculate_stmt_checksum(wdb_t * wdb, sqlite3_stmt * stmt, wdb_component_
             continue;
         }
 
-        EVP_DigestUpdate(ctx, checksum, strlen((const char *)checksum));
+        if (ctx) {
+            EVP_DigestUpdate(ctx, checksum, strlen((const char *)checksum));
+        } else {
+            wdb_checksum_sum_update(digest, checksum);
+        }
     }
 
     // Get the hex SHA-1 digest
-    unsigned char digest[EVP_MAX_MD_SIZE];
-    unsigned int digest_size;
-
-    EVP_DigestFinal_ex(ctx, digest, &digest_size);
-    EVP_MD_CTX_destroy(ctx);
+    if (ctx) {
+        EVP_DigestFinal_ex(ctx, digest, &digest_size);
+        EVP_MD_CTX_destroy(ctx);
+    }
 
     if (pk_value && row_count > 1) {
         mwarn("DB(%s) %s component has more than one element with the same PK value '%s'.",
@@ -151,6 +192,21 @@ int wdb_calculate_stmt_checksum(wdb_t * wdb, sqlite3_stmt * stmt, wdb_component_
     return 1;
 }
 
+/**
+ * @brief Run SHA-1 checksum of the whole result of an already prepared statement
+ *
+ * @param[in] wdb Database node.
+ * @param[in] stmt Statement to be executed already prepared.
+ * @param[in] component Name of the component.
+ * @param[out] hexdigest
+ * @param[in] pk_value Primary key value.
+ * @retval 1 On success.
+ * @retval 0 If no items were found.
+ */
+int wdb_calculate_stmt_checksum(wdb_t * wdb, sqlite3_stmt * stmt, wdb_component_t component, os_sha1 hexdigest, const char * pk_value) {
+    return wdb_calculate_stmt_checksum_algorithm(wdb, stmt, component, WDB_CHECKSUM_SHA1, hexdigest, pk_value);
+}
+
 /**
  * @brief Run checksum of a database table
  *
@@ -205,6 +261,10 @@ int wdbi_checksum(wdb_t * wdb, wdb_component_t component, os_sha1 hexdigest) {
  * @retval -1 On error.
  */
 int wdbi_checksum_range(wdb_t * wdb, wdb_component_t component, const char * begin, const char * end, os_sha1 hexdigest) {
+    return wdbi_checksum_range_algorithm(wdb, component, WDB_CHECKSUM_SHA1, begin, end, hexdigest);
+}
+
+int wdbi_checksum_range_algorithm(wdb_t * wdb, wdb_component_t component, wdb_checksum_algorithm_t algorithm, const char * begin, const char * end, os_sha1 hexdigest) {
     assert(wdb != NULL);
     assert(hexdigest != NULL);
 
@@ -240,7 +300,7 @@ int wdbi_checksum_range(wdb_t * wdb, wdb_component_t component, const char * beg
         unique_id = begin;
     }
 
-    return wdb_calculate_stmt_checksum(wdb, stmt, component, hexdigest, unique_id);
+    return wdb_calculate_stmt_checksum_algorithm(wdb, stmt, component, algorithm, hexdigest, unique_id);
 }
 
 /**
@@ -384,6 +444,71 @@ void wdbi_set_last_completion(wdb_t * wdb, wdb_component_t component, long times
     }
 }
 
+/**
+ * @brief Key of a range checksum: digest of the algorithm and both bounds
+ */
+static void wdbi_range_checksum_key(wdb_checksum_algorithm_t algorithm, const char * begin, const char * end, os_sha1 key) {
+    const size_t begin_size = strlen(begin) + 1;
+    const size_t end_size = strlen(end) + 1;
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    unsigned char * buffer;
+
+    os_malloc(begin_size + end_size + 1, buffer);
+    buffer[0] = (unsigned char)algorithm;
+    memcpy(buffer + 1, begin, begin_size);
+    memcpy(buffer + 1 + begin_size, end, end_size);
+
+    SHA1(buffer, begin_size + end_size + 1, digest);
+    OS_SHA1_Hexdigest(digest, key);
+    os_free(buffer);
+}
+
+/**
+ * @brief Run checksum of a database table range, reusing the last one of the component
+ *
+ * Agents ask for the same ranges on every synchronization. The checksum of the
+ * last range is kept with the row changes count of the connection, so it is
+ * reused while no row of the database has changed.
+ *
+ * @param[in] wdb Database node.
+ * @param[in] component Name of the component.
+ * @param[in] algorithm Algorithm used to combine the row checksums.
+ * @param[in] begin First element.
+ * @param[in] end Last element.
+ * @param[out] hexdigest Range checksum in hexadecimal.
+ * @return Same as wdbi_checksum_range_algorithm().
+ */
+static int wdbi_checksum_range_cached(wdb_t * wdb, wdb_component_t component, wdb_checksum_algorithm_t algorithm, const char * begin, const char * end, os_sha1 hexdigest) {
+    wdb_range_checksum_t * last = &wdb->range_checksum[component];
+    os_sha1 key;
+    int result;
+
+    // A single element range may remove duplicated rows
+    if (!strcmp(begin, end)) {
+        last->valid = false;
+        return wdbi_checksum_range_algorithm(wdb, component, algorithm, begin, end, hexdigest);
+    }
+
+    wdbi_range_checksum_key(algorithm, begin, end, key);
+
+    if (last->valid && !strcmp(last->key, key) && last->changes == sqlite3_total_changes64(wdb->db)) {
+        mdebug2("Agent '%s' %s range checksum reused.", wdb->id, COMPONENT_NAMES[component]);
+        memcpy(hexdigest, last->hexdigest, sizeof(os_sha1));
+        return last->result;
+    }
+
+    if (result = wdbi_checksum_range_algorithm(wdb, component, algorithm, begin, end, hexdigest), result < 0) {
+        last->valid = false;
+        return result;
+    }
+
+    last->valid = true;
+    memcpy(last->key, key, sizeof(os_sha1));
+    memcpy(last->hexdigest, hexdigest, sizeof(os_sha1));
+    last->result = result;
+    return result;
+}
+
 // Query the checksum of a data range
 integrity_sync_status_t wdbi_query_checksum(wdb_t * wdb, wdb_component_t component, dbsync_msg action, const char * payload) {
     integrity_sync_status_t status = INTEGRITY_SYNC_ERR;
@@ -419,6 +544,18 @@ integrity_sync_status_t wdbi_query_checksum(wdb_t * wdb, wdb_component_t compone
     }
     long timestamp = item->valuedouble;
 
+    wdb_checksum_algorithm_t algorithm = WDB_CHECKSUM_SHA1;
+    item = cJSON_GetObjectItem(data, "algorithm");
+    if (item != NULL) {
+        char * algorithm_name = cJSON_GetStringValue(item);
+        if (algorithm_name != NULL && !strcmp(algorithm_name, WDB_CHECKSUM_ALGORITHM_SUM)) {
+            algorithm = WDB_CHECKSUM_SUM;
+        } else if (algorithm_name == NULL || strcmp(algorithm_name, WDB_CHECKSUM_ALGORITHM_SHA1)) {
+            mdebug1("Unsupported checksum 'algorithm' in JSON payload.");
+            goto end;
+        }
+    }
+
     os_sha1 manager_checksum = {0};
     // Get the previously computed manager checksum
     if (INTEGRITY_CHECK_GLOBAL == action) {
@@ -428,11 +565,13 @@ integrity_sync_status_t wdbi_query_checksum(wdb_t * wdb, wdb_component_t compone
         }
     }
 
+    bool range_cached = false;
+
     // Get the actual manager checksum
     if (status != INTEGRITY_SYNC_CKS_OK) {
         struct timespec ts_start, ts_end;
         gettime(&ts_start);
-        switch (wdbi_checksum_range(wdb, component, begin, end, manager_checksum)) {
+        switch (wdbi_checksum_range_cached(wdb, component, algorithm, begin, end, manager_checksum)) {
         case -1:
             goto end;
 
@@ -445,6 +584,8 @@ integrity_sync_status_t wdbi_query_checksum(wdb_t * wdb, wdb_component_t compone
             mdebug2("Agent '%s' %s range checksum: Time: %.3f ms.", wdb->id, COMPONENT_NAMES[component], time_diff(&ts_start, &ts_end) * 1e3);
             status = strcmp(manager_checksum, checksum) ? INTEGRITY_SYNC_CKS_FAIL : INTEGRITY_SYNC_CKS_OK;
         }
+
+        range_cached = wdb->range_checksum[component].valid;
     }
 
     // Update sync status
@@ -470,6 +611,11 @@ integrity_sync_status_t wdbi_query_checksum(wdb_t * wdb, wdb_component_t compone
         wdbi_delete(wdb, component, begin, end, cJSON_GetStringValue(item));
     }
 
+    // The synchronization updates above do not touch the range
+    if (range_cached) {
+        wdb->range_checksum[component].changes = sqlite3_total_changes64(wdb->db);
+    }
+
 end:
     cJSON_Delete(data);
     return status;
@@ -197,6 +197,25 @@ static struct kv_list const TABLE_MAP[] = {
     { .current = { "processes", "sys_processes",  false, TABLE_PROCESSES, PROCESSES_FIELD_COUNT }, .next = NULL},
 };
 
+// Global commands that only read, served by the reader connections
+static const char * const GLOBAL_READ_ONLY_COMMANDS[] = {
+    "get-labels", "select-agent-name", "select-agent-group", "find-agent", "find-group", "select-group-belong",
+    "get-group-agents", "select-groups", "get-all-agents", "get-distinct-groups", "get-agent-info",
+    "get-agents-by-connection-status", NULL
+};
+
+static bool wdb_global_read_only(const char * query) {
+    size_t length = strcspn(query, " ");
+
+    for (int i = 0; GLOBAL_READ_ONLY_COMMANDS[i]; i++) {
+        if (strlen(GLOBAL_READ_ONLY_COMMANDS[i]) == length && !strncmp(query, GLOBAL_READ_ONLY_COMMANDS[i], length)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 int wdb_parse(char * input, char * output, int peer) {
     char * actor;
     char * id;
@@ -589,6 +608,20 @@ int wdb_parse(char * input, char * output, int peer) {
                     result = OS_INVALID;
                 }
             }
+        } else if (strcmp(query, "cursor") == 0) {
+            w_inc_agent_sql();
+            if (!next) {
+                mdebug1("DB(%s) Invalid DB query syntax.", sagent_id);
+                mdebug2("DB(%s) query error near: %s", sagent_id, query);
+                snprintf(output, OS_MAXSTR + 1, "err Invalid DB query syntax, near '%.32s'", query);
+                result = OS_INVALID;
+            } else {
+                gettimeofday(&begin, 0);
+                result = wdb_parse_cursor(wdb, next, output);
+                gettimeofday(&end, 0);
+                timersub(&end, &begin, &diff);
+                w_inc_agent_sql_time(diff);
+            }
         } else if (strcmp(query, "remove") == 0) {
             w_inc_agent_remove();
             wdb_leave(wdb);
@@ -857,7 +890,10 @@ int wdb_parse(char * input, char * output, int peer) {
 
         mdebug2("Global query: %s", query);
 
-        if (wdb = wdb_open_global(), !wdb) {
+        // Reads don't wait for the writer while a reader is idle
+        wdb = wdb_global_read_only(query) ? wdb_open_global_reader() : NULL;
+
+        if (!wdb && (wdb = wdb_open_global(), !wdb)) {
             mdebug2("Couldn't open DB global: %s/%s.db", WDB2_DIR, WDB_GLOB_NAME);
             snprintf(output, OS_MAXSTR + 1, "err Couldn't open DB global");
             return OS_INVALID;
@@ -901,6 +937,20 @@ int wdb_parse(char * input, char * output, int peer) {
                     result = OS_INVALID;
                 }
             }
+        } else if (strcmp(query, "cursor") == 0) {
+            w_inc_global_sql();
+            if (!next) {
+                mdebug1("Global DB Invalid DB query syntax.");
+                mdebug2("Global DB query error near: %s", query);
+                snprintf(output, OS_MAXSTR + 1, "err Invalid DB query syntax, near '%.32s'", query);
+                result = OS_INVALID;
+            } else {
+                gettimeofday(&begin, 0);
+                result = wdb_parse_cursor(wdb, next, output);
+                gettimeofday(&end, 0);
+                timersub(&end, &begin, &diff);
+                w_inc_global_sql_time(diff);
+            }
         } else if (strcmp(query, "insert-agent") == 0) {
             w_inc_global_agent_insert_agent();
             if (!next) {
@@ -1382,8 +1432,10 @@ int wdb_parse(char * input, char * output, int peer) {
             snprintf(output, OS_MAXSTR + 1, "err Invalid DB query syntax, near '%.32s'", query);
             result = OS_INVALID;
         }
+        // The reader may be destroyed by the writer as soon as it's left
+        bool is_reader = wdb->reader;
         wdb_leave(wdb);
-        if (result == OS_INVALID) {
+        if (result == OS_INVALID && !is_reader) {
             snprintf(path, sizeof(path), "%s/%s.db", WDB2_DIR, WDB_GLOB_NAME);
             if (!w_is_file(path)) {
                 mwarn("DB(%s) not found. This behavior is unexpected, the database will be recreated.", path);
@@ -1410,7 +1462,10 @@ int wdb_parse(char * input, char * output, int peer) {
         // Add the current peer to wdb structure
         wdb->peer = peer;
 
-        if (next = wstr_chr(query, ' '), !next) {
+        // The summary is the only command without parameters
+        if (next = wstr_chr(query, ' '), next) {
+            *next++ = '\0';
+        } else if (strcmp("summary", query)) {
             mdebug1("Invalid DB query syntax.");
             mdebug2("DB query error near: %s", query);
             snprintf(output, OS_MAXSTR + 1, "err Invalid DB query syntax, near '%.32s'", query);
@@ -1418,8 +1473,6 @@ int wdb_parse(char * input, char * output, int peer) {
             return OS_INVALID;
         }
 
-        *next++ = '\0';
-
         if (!strcmp("upgrade", query)) {
             w_inc_task_upgrade();
             if (!next) {
@@ -1612,6 +1665,9 @@ int wdb_parse(char * input, char * output, int peer) {
             w_inc_task_delete_old_time(diff);
             cJSON_Delete(parameters_json);
 
+        } else if (!strcmp("summary", query)) {
+            result = wdb_parse_task_summary(wdb, output);
+
         } else if (!strcmp("sql", query)) {
             w_inc_task_sql();
             if (!next) {
@@ -1627,6 +1683,8 @@ int wdb_parse(char * input, char * output, int peer) {
                 gettimeofday(&end, 0);
                 timersub(&end, &begin, &diff);
                 w_inc_task_sql_time(diff);
+                // The query may have changed the tasks
+                wdb_task_reset_summary();
                 if (data) {
                     out = cJSON_PrintUnformatted(data);
                     snprintf(output, OS_MAXSTR + 1, "ok %s", out);
@@ -1654,6 +1712,95 @@ int wdb_parse(char * input, char * output, int peer) {
     }
 }
 
+// Adapter of wdb_syscheck_save2() for wdb_parse_save2_batch()
+static int wdb_syscheck_save2_row(wdb_t * wdb, __attribute__((unused)) wdb_component_t component, const char * payload) {
+    return wdb_syscheck_save2(wdb, payload);
+}
+
+int wdb_parse_save2_batch(wdb_t * wdb, wdb_component_t component, wdb_save2_t save, char * input, char * output) {
+    char * cur = input;
+    char * end = input + strlen(input);
+    int rows = 0;
+    int failed = 0;
+
+    while (cur < end) {
+        char * row;
+        char last;
+        unsigned long length = strtoul(cur, &row, 10);
+
+        if (row == cur || *row != ':' || length == 0 || length > (unsigned long)(end - row - 1)) {
+            mdebug1("DB(%s) Invalid save2 batch framing after %d rows.", wdb->id, rows);
+            snprintf(output, OS_MAXSTR + 1, "err Invalid batch framing, near '%.32s'", cur);
+            return OS_INVALID;
+        }
+
+        row++;
+        cur = row + length;
+
+        // Terminate the row in place, the next length starts here
+        last = *cur;
+        *cur = '\0';
+
+        if (save(wdb, component, row) == OS_INVALID) {
+            failed++;
+        }
+
+        *cur = last;
+        rows++;
+    }
+
+    if (failed > 0) {
+        mdebug1("DB(%s) Cannot save %d of %d rows.", wdb->id, failed, rows);
+        snprintf(output, OS_MAXSTR + 1, "err Cannot save %d of %d rows", failed, rows);
+        return OS_INVALID;
+    }
+
+    snprintf(output, OS_MAXSTR + 1, "ok");
+    return OS_SUCCESS;
+}
+
+int wdb_parse_cursor(wdb_t * wdb, char * input, char * output) {
+    char * next;
+    char * end;
+    unsigned long id;
+
+    if (next = wstr_chr(input, ' '), !next) {
+        mdebug1("DB(%s) Invalid cursor query syntax.", wdb->id);
+        snprintf(output, OS_MAXSTR + 1, "err Invalid cursor query syntax, near '%.32s'", input);
+        return OS_INVALID;
+    }
+
+    *next++ = '\0';
+
+    if (strcmp(input, "open") == 0) {
+        return wdb_cursor_open(wdb, next, output);
+    }
+
+    id = strtoul(next, &end, 10);
+
+    if (end == next || *end != '\0') {
+        mdebug1("DB(%s) Invalid cursor identifier.", wdb->id);
+        snprintf(output, OS_MAXSTR + 1, "err Invalid cursor identifier, near '%.32s'", next);
+        return OS_INVALID;
+    }
+
+    if (strcmp(input, "next") == 0) {
+        return wdb_cursor_next(wdb, id, output);
+    } else if (strcmp(input, "close") == 0) {
+        if (wdb_cursor_close(wdb, id) == OS_INVALID) {
+            snprintf(output, OS_MAXSTR + 1, "err Cursor not found");
+            return OS_INVALID;
+        }
+
+        snprintf(output, OS_MAXSTR + 1, "ok");
+        return OS_SUCCESS;
+    }
+
+    mdebug1("DB(%s) Invalid cursor query syntax.", wdb->id);
+    snprintf(output, OS_MAXSTR + 1, "err Invalid cursor query syntax, near '%.32s'", input);
+    return OS_INVALID;
+}
+
 int wdb_parse_syscheck(wdb_t * wdb, wdb_component_t component, char * input, char * output) {
     char * curr;
     char * next;
@@ -1810,6 +1957,8 @@ int wdb_parse_syscheck(wdb_t * wdb, wdb_component_t component, char * input, cha
 
         snprintf(output, OS_MAXSTR + 1, "ok");
         return 0;
+    } else if (strcmp(curr, "save2_batch") == 0) {
+        return wdb_parse_save2_batch(wdb, component, wdb_syscheck_save2_row, next, output);
     } else if (strncmp(curr, "integrity_check_", 16) == 0) {
         dbsync_msg action = INTEGRITY_CLEAR;
         if (0 == strcmp(curr, INTEGRITY_COMMANDS[INTEGRITY_CHECK_GLOBAL])) {
@@ -1943,6 +2092,13 @@ int wdb_parse_syscollector(wdb_t * wdb, const char * query, char * input, char *
         snprintf(output, OS_MAXSTR + 1, "ok");
         return component;
     }
+    if (strcmp(curr, "save2_batch") == 0) {
+        if (wdb_parse_save2_batch(wdb, component, wdb_syscollector_save2, next, output) == OS_INVALID) {
+            return OS_INVALID;
+        }
+
+        return component;
+    }
     if (strncmp(curr, "integrity_check_", 16) == 0) {
         dbsync_msg action = INTEGRITY_CLEAR;
         if (0 == strcmp(curr, INTEGRITY_COMMANDS[INTEGRITY_CHECK_GLOBAL])) {
@@ -5067,16 +5223,63 @@ int wdb_parse_rootcheck(wdb_t * wdb, char * input, char * output) {
     return result;
 }
 
+/**
+ * @brief Inserts the agent described by a JSON object.
+ *
+ * @param [in] wdb The global struct database.
+ * @param [in] agent_data JSON object with the agent data.
+ * @param [in] input Query text, used in the error description.
+ * @param [out] output Error description, untouched on success.
+ * @param [in] batch Whether the agent is part of a batch, in which case an agent already present isn't an error.
+ * @return OS_SUCCESS on success, OS_INVALID on error.
+ */
+static int wdb_parse_global_insert_agent_data(wdb_t * wdb, cJSON * agent_data, char * input, char * output, bool batch) {
+    cJSON *j_id = cJSON_GetObjectItem(agent_data, "id");
+    cJSON *j_name = cJSON_GetObjectItem(agent_data, "name");
+    cJSON *j_ip = cJSON_GetObjectItem(agent_data, "ip");
+    cJSON *j_register_ip = cJSON_GetObjectItem(agent_data, "register_ip");
+    cJSON *j_internal_key = cJSON_GetObjectItem(agent_data, "internal_key");
+    cJSON *j_group = cJSON_GetObjectItem(agent_data, "group");
+    cJSON *j_date_add = cJSON_GetObjectItem(agent_data, "date_add");
+
+    // These are the only constraints defined in the database for this
+    // set of parameters. All the other parameters could be NULL.
+    if (cJSON_IsNumber(j_id) &&
+        cJSON_IsString(j_name) && j_name->valuestring &&
+        cJSON_IsNumber(j_date_add)) {
+        // Getting each field
+        int id = j_id->valueint;
+        char* name = j_name->valuestring;
+        char* ip = cJSON_IsString(j_ip) ? j_ip->valuestring : NULL;
+        char* register_ip = cJSON_IsString(j_register_ip) ? j_register_ip->valuestring : NULL;
+        char* internal_key = cJSON_IsString(j_internal_key) ? j_internal_key->valuestring : NULL;
+        char* group = cJSON_IsString(j_group) ? j_group->valuestring : NULL;
+        int date_add = j_date_add->valueint;
+
+        if (OS_SUCCESS != wdb_global_insert_agent(wdb, id, name, ip, register_ip, internal_key, group, date_add)) {
+            if (batch && sqlite3_errcode(wdb->db) == SQLITE_CONSTRAINT) {
+                mdebug2("Global DB Agent %d already inserted.", id);
+                return OS_SUCCESS;
+            }
+
+            mdebug1("Global DB Cannot execute SQL query; err database %s/%s.db: %s", WDB2_DIR, WDB_GLOB_NAME, sqlite3_errmsg(wdb->db));
+            snprintf(output, OS_MAXSTR + 1, "err Cannot execute Global database query; %s", sqlite3_errmsg(wdb->db));
+            return OS_INVALID;
+        }
+    } else {
+        mdebug1("Global DB Invalid JSON data when inserting agent. Not compliant with constraints defined in the database.");
+        snprintf(output, OS_MAXSTR + 1, "err Invalid JSON data, near '%.32s'", input);
+        return OS_INVALID;
+    }
+
+    return OS_SUCCESS;
+}
+
 int wdb_parse_global_insert_agent(wdb_t * wdb, char * input, char * output) {
     cJSON *agent_data = NULL;
     const char *error = NULL;
-    cJSON *j_id = NULL;
-    cJSON *j_name = NULL;
-    cJSON *j_ip = NULL;
-    cJSON *j_register_ip = NULL;
-    cJSON *j_internal_key = NULL;
-    cJSON *j_group = NULL;
-    cJSON *j_date_add = NULL;
+    cJSON *j_agents = NULL;
+    cJSON *j_item = NULL;
 
     agent_data = cJSON_ParseWithOpts(input, &error, TRUE);
     if (!agent_data) {
@@ -5084,41 +5287,19 @@ int wdb_parse_global_insert_agent(wdb_t * wdb, char * input, char * output) {
         mdebug2("Global DB JSON error near: %s", error);
         snprintf(output, OS_MAXSTR + 1, "err Invalid JSON syntax, near '%.32s'", input);
         return OS_INVALID;
-    } else {
-        j_id = cJSON_GetObjectItem(agent_data, "id");
-        j_name = cJSON_GetObjectItem(agent_data, "name");
-        j_ip = cJSON_GetObjectItem(agent_data, "ip");
-        j_register_ip = cJSON_GetObjectItem(agent_data, "register_ip");
-        j_internal_key = cJSON_GetObjectItem(agent_data, "internal_key");
-        j_group = cJSON_GetObjectItem(agent_data, "group");
-        j_date_add = cJSON_GetObjectItem(agent_data, "date_add");
-
-        // These are the only constraints defined in the database for this
-        // set of parameters. All the other parameters could be NULL.
-        if (cJSON_IsNumber(j_id) &&
-            cJSON_IsString(j_name) && j_name->valuestring &&
-            cJSON_IsNumber(j_date_add)) {
-            // Getting each field
-            int id = j_id->valueint;
-            char* name = j_name->valuestring;
-            char* ip = cJSON_IsString(j_ip) ? j_ip->valuestring : NULL;
-            char* register_ip = cJSON_IsString(j_register_ip) ? j_register_ip->valuestring : NULL;
-            char* internal_key = cJSON_IsString(j_internal_key) ? j_internal_key->valuestring : NULL;
-            char* group = cJSON_IsString(j_group) ? j_group->valuestring : NULL;
-            int date_add = j_date_add->valueint;
+    }
 
-            if (OS_SUCCESS != wdb_global_insert_agent(wdb, id, name, ip, register_ip, internal_key, group, date_add)) {
-                mdebug1("Global DB Cannot execute SQL query; err database %s/%s.db: %s", WDB2_DIR, WDB_GLOB_NAME, sqlite3_errmsg(wdb->db));
-                snprintf(output, OS_MAXSTR + 1, "err Cannot execute Global database query; %s", sqlite3_errmsg(wdb->db));
+    // A batch of agents is inserted in the same transaction
+    if (j_agents = cJSON_GetObjectItem(agent_data, "agents"), cJSON_IsArray(j_agents)) {
+        cJSON_ArrayForEach(j_item, j_agents) {
+            if (OS_SUCCESS != wdb_parse_global_insert_agent_data(wdb, j_item, input, output, true)) {
                 cJSON_Delete(agent_data);
                 return OS_INVALID;
             }
-        } else {
-            mdebug1("Global DB Invalid JSON data when inserting agent. Not compliant with constraints defined in the database.");
-            snprintf(output, OS_MAXSTR + 1, "err Invalid JSON data, near '%.32s'", input);
-            cJSON_Delete(agent_data);
-            return OS_INVALID;
         }
+    } else if (OS_SUCCESS != wdb_parse_global_insert_agent_data(wdb, agent_data, input, output, false)) {
+        cJSON_Delete(agent_data);
+        return OS_INVALID;
     }
 
     wdb_global_group_hash_cache(WDB_GLOBAL_GROUP_HASH_CLEAR, NULL);
@@ -5358,6 +5539,7 @@ int wdb_parse_global_update_agent_keepalive(wdb_t * wdb, char * input, char * ou
     cJSON *agent_data = NULL;
     const char *error = NULL;
     cJSON *j_id = NULL;
+    cJSON *j_ids = NULL;
     cJSON *j_connection_status = NULL;
     cJSON *j_sync_status = NULL;
 
@@ -5369,10 +5551,36 @@ int wdb_parse_global_update_agent_keepalive(wdb_t * wdb, char * input, char * ou
         return OS_INVALID;
     } else {
         j_id = cJSON_GetObjectItem(agent_data, "id");
+        j_ids = cJSON_GetObjectItem(agent_data, "ids");
         j_connection_status = cJSON_GetObjectItem(agent_data, "connection_status");
         j_sync_status = cJSON_GetObjectItem(agent_data, "sync_status");
 
-        if (cJSON_IsNumber(j_id) && cJSON_IsString(j_connection_status) && cJSON_IsString(j_sync_status)) {
+        // A batch of agents is updated with a single statement
+        if (cJSON_IsArray(j_ids) && cJSON_IsString(j_connection_status) && cJSON_IsString(j_sync_status)) {
+            cJSON *j_item = NULL;
+            char *ids = NULL;
+            int result;
+
+            cJSON_ArrayForEach(j_item, j_ids) {
+                if (!cJSON_IsNumber(j_item)) {
+                    mdebug1("Global DB Invalid JSON data when updating agent keepalive.");
+                    snprintf(output, OS_MAXSTR + 1, "err Invalid JSON data, near '%.32s'", input);
+                    cJSON_Delete(agent_data);
+                    return OS_INVALID;
+                }
+            }
+
+            ids = cJSON_PrintUnformatted(j_ids);
+            result = wdb_global_update_agents_keepalive(wdb, ids, j_connection_status->valuestring, j_sync_status->valuestring);
+            os_free(ids);
+
+            if (OS_SUCCESS != result) {
+                mdebug1("Global DB Cannot execute SQL query; err database %s/%s.db: %s", WDB2_DIR, WDB_GLOB_NAME, sqlite3_errmsg(wdb->db));
+                snprintf(output, OS_MAXSTR + 1, "err Cannot execute Global database query; %s", sqlite3_errmsg(wdb->db));
+                cJSON_Delete(agent_data);
+                return OS_INVALID;
+            }
+        } else if (cJSON_IsNumber(j_id) && cJSON_IsString(j_connection_status) && cJSON_IsString(j_sync_status)) {
             // Getting each field
             int id = j_id->valueint;
             char *connection_status = j_connection_status->valuestring;
@@ -6452,12 +6660,29 @@ int wdb_parse_task_upgrade_update_status(wdb_t* wdb, const cJSON *parameters, ch
     char *status = NULL;
     char *error = NULL;
 
+    // A batch of agents is sent in the "agents" array instead of the "agent" number
+    cJSON *agents_json = cJSON_GetObjectItem(parameters, "agents");
     cJSON *agent_id_json = cJSON_GetObjectItem(parameters, "agent");
-    if (!agent_id_json || (agent_id_json->type != cJSON_Number)) {
+    if (agents_json) {
+        cJSON *agent_json = NULL;
+
+        if (!cJSON_IsArray(agents_json)) {
+            snprintf(output, OS_MAXSTR + 1, "err Error upgrade update status task: 'parsing agents error'");
+            return OS_INVALID;
+        }
+
+        cJSON_ArrayForEach(agent_json, agents_json) {
+            if (agent_json->type != cJSON_Number) {
+                snprintf(output, OS_MAXSTR + 1, "err Error upgrade update status task: 'parsing agents error'");
+                return OS_INVALID;
+            }
+        }
+    } else if (!agent_id_json || (agent_id_json->type != cJSON_Number)) {
         snprintf(output, OS_MAXSTR + 1, "err Error upgrade update status task: 'parsing agent error'");
         return OS_INVALID;
+    } else {
+        agent_id = agent_id_json->valueint;
     }
-    agent_id = agent_id_json->valueint;
 
     cJSON *node_json = cJSON_GetObjectItem(parameters, "node");
     if (!node_json || (node_json->type != cJSON_String)) {
@@ -6478,12 +6703,29 @@ int wdb_parse_task_upgrade_update_status(wdb_t* wdb, const cJSON *parameters, ch
         error = error_json->valuestring;
     }
 
-    result = wdb_task_update_upgrade_task_status(wdb, agent_id, node, status, error);
-
     cJSON *response = cJSON_CreateObject();
     char *out = NULL;
 
-    cJSON_AddNumberToObject(response, "error", result);
+    if (agents_json) {
+        cJSON *data = cJSON_CreateArray();
+        cJSON *agent_json = NULL;
+
+        // Every update runs in the same transaction, each agent gets its own result
+        cJSON_ArrayForEach(agent_json, agents_json) {
+            cJSON *agent_result = cJSON_CreateObject();
+
+            cJSON_AddNumberToObject(agent_result, "agent", agent_json->valueint);
+            cJSON_AddNumberToObject(agent_result, "error", wdb_task_update_upgrade_task_status(wdb, agent_json->valueint, node, status, error));
+            cJSON_AddItemToArray(data, agent_result);
+        }
+
+        result = OS_SUCCESS;
+        cJSON_AddNumberToObject(response, "error", result);
+        cJSON_AddItemToObject(response, "data", data);
+    } else {
+        result = wdb_task_update_upgrade_task_status(wdb, agent_id, node, status, error);
+        cJSON_AddNumberToObject(response, "error", result);
+    }
     out = cJSON_PrintUnformatted(response);
 
     snprintf(output, OS_MAXSTR + 1, "ok %s", out);
@@ -6642,6 +6884,29 @@ int wdb_parse_task_delete_old(wdb_t* wdb, const cJSON *parameters, char* output)
     return result;
 }
 
+int wdb_parse_task_summary(wdb_t* wdb, char* output) {
+    int result = OS_INVALID;
+    cJSON *summary = NULL;
+
+    result = wdb_task_get_summary(wdb, &summary);
+
+    cJSON *response = cJSON_CreateObject();
+    char *out = NULL;
+
+    cJSON_AddNumberToObject(response, "error", result);
+    if (result == OS_SUCCESS) {
+        cJSON_AddItemToObject(response, "data", summary);
+    }
+    out = cJSON_PrintUnformatted(response);
+
+    snprintf(output, OS_MAXSTR + 1, "ok %s", out);
+
+    os_free(out);
+    cJSON_Delete(response);
+
+    return result;
+}
+
 // 'agents' DB command parsing
 
 int wdb_parse_vuln_cves(wdb_t* wdb, char* input, char* output) {
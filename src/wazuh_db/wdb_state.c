@@ -994,6 +994,14 @@ void w_inc_mitre_sql_time(struct timeval time) {
     w_mutex_unlock(&db_state_t_mutex);
 }
 
+void w_inc_sqlite_busy() {
+    __atomic_add_fetch(&wdb_state.sqlite.busy, 1, __ATOMIC_RELAXED);
+}
+
+void w_inc_sqlite_busy_exceeded() {
+    __atomic_add_fetch(&wdb_state.sqlite.busy_exceeded, 1, __ATOMIC_RELAXED);
+}
+
 cJSON* wdb_create_state_json() {
     wdb_state_t wdb_state_cpy;
 
@@ -1204,6 +1212,12 @@ cJSON* wdb_create_state_json() {
 
     cJSON_AddNumberToObject(_wazuhdb_db, "remove", wdb_state_cpy.queries_breakdown.wazuhdb_breakdown.remove_queries);
 
+    cJSON *_sqlite = cJSON_CreateObject();
+    cJSON_AddItemToObject(_metrics, "sqlite", _sqlite);
+
+    cJSON_AddNumberToObject(_sqlite, "busy", wdb_state_cpy.sqlite.busy);
+    cJSON_AddNumberToObject(_sqlite, "busy_exceeded", wdb_state_cpy.sqlite.busy_exceeded);
+
     cJSON *_time = cJSON_CreateObject();
     cJSON_AddItemToObject(_metrics, "time", _time);
 
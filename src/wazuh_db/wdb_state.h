@@ -253,10 +253,16 @@ typedef struct _queries_breakdown_t {
     wazuhdb_breakdown_t wazuhdb_breakdown;
 } queries_breakdown_t;
 
+typedef struct _sqlite_stats_t {
+    uint64_t busy;              ///< Steps retried because the database was locked
+    uint64_t busy_exceeded;     ///< Steps that failed after all the retries
+} sqlite_stats_t;
+
 typedef struct _db_stats_t {
     uint64_t uptime;
     uint64_t queries_total;
     queries_breakdown_t queries_breakdown;
+    sqlite_stats_t sqlite;
 } wdb_state_t;
 
 /* Status functions */
@@ -1256,6 +1262,18 @@ void w_inc_mitre_sql();
  */
 void w_inc_mitre_sql_time(struct timeval time);
 
+/**
+ * @brief Increment the counter of SQLite steps retried on a locked database
+ *
+ * It doesn't lock the state, as it is called while stepping statements.
+ */
+void w_inc_sqlite_busy();
+
+/**
+ * @brief Increment the counter of SQLite steps that exceeded the retries on a locked database
+ */
+void w_inc_sqlite_busy_exceeded();
+
 /**
  * @brief Create a JSON object with all the wazuh-db state information
  * @return JSON object
@@ -12,6 +12,9 @@
 #include "wdb.h"
 #include "wazuh_modules/wm_task_general.h"
 
+// Rows of the TASKS_SUMMARY view, it's only accessed with the tasks DB locked
+static cJSON *tasks_summary = NULL;
+
 int wdb_task_insert_task(wdb_t* wdb, int agent_id, const char *node, const char *module, const char *command) {
     sqlite3_stmt *stmt = NULL;
     int result = 0;
@@ -41,6 +44,8 @@ int wdb_task_insert_task(wdb_t* wdb, int agent_id, const char *node, const char
         return OS_INVALID;
     }
 
+    wdb_task_reset_summary();
+
     if (wdb_stmt_cache(wdb, WDB_STMT_TASK_GET_LAST_AGENT_TASK) < 0) {
         mdebug1(DB_CACHE_ERROR);
         return OS_INVALID;
@@ -117,6 +122,8 @@ int wdb_task_get_upgrade_task_status(wdb_t* wdb, int agent_id, const char *node,
             return OS_INVALID;
         }
 
+        wdb_task_reset_summary();
+
     } else {
         sqlite_strdup(task_status, *status);
     }
@@ -193,6 +200,8 @@ int wdb_task_update_upgrade_task_status(wdb_t* wdb, int agent_id, const char *no
         return OS_INVALID;
     }
 
+    wdb_task_reset_summary();
+
     return OS_SUCCESS;
 }
 
@@ -262,6 +271,8 @@ int wdb_task_cancel_upgrade_tasks(wdb_t* wdb, const char *node) {
         return OS_INVALID;
     }
 
+    wdb_task_reset_summary();
+
     return OS_SUCCESS;
 }
 
@@ -307,6 +318,8 @@ int wdb_task_set_timeout_status(wdb_t* wdb, time_t now, int interval, time_t *ne
                 return OS_INVALID;
             }
 
+            wdb_task_reset_summary();
+
         } else if (*next_timeout > (last_update_time + interval)) {
             *next_timeout = last_update_time + interval;
         }
@@ -338,5 +351,39 @@ int wdb_task_delete_old_entries(wdb_t* wdb, int timestamp) {
         return OS_INVALID;
     }
 
+    wdb_task_reset_summary();
+
+    return OS_SUCCESS;
+}
+
+int wdb_task_get_summary(wdb_t* wdb, cJSON **summary) {
+    sqlite3_stmt *stmt = NULL;
+
+    if (!tasks_summary) {
+        if (!wdb->transaction && wdb_begin2(wdb) < 0) {
+            mdebug1(DB_TRANSACTION_ERROR);
+            return OS_INVALID;
+        }
+
+        if (wdb_stmt_cache(wdb, WDB_STMT_TASK_GET_SUMMARY) < 0) {
+            mdebug1(DB_CACHE_ERROR);
+            return OS_INVALID;
+        }
+
+        stmt = wdb->stmt[WDB_STMT_TASK_GET_SUMMARY];
+
+        if (tasks_summary = wdb_exec_stmt(stmt), !tasks_summary) {
+            merror(DB_SQL_ERROR, sqlite3_errmsg(wdb->db));
+            return OS_INVALID;
+        }
+    }
+
+    *summary = cJSON_Duplicate(tasks_summary, true);
+
     return OS_SUCCESS;
 }
+
+void wdb_task_reset_summary() {
+    cJSON_Delete(tasks_summary);
+    tasks_summary = NULL;
+}
@@ -65,10 +65,11 @@ wdb_t * wdb_upgrade(wdb_t *wdb) {
 
             if (wdb_sql_exec(wdb, UPDATES[i]) == -1 ||
                 wdb_adjust_upgrade(wdb, i)) {
-                wdb = wdb_backup(wdb, version);
-                break;
+                return wdb_backup(wdb, version);
             }
         }
+
+        wdb->schema_current = true;
     }
 
     return wdb;
@@ -167,6 +168,36 @@ wdb_t * wdb_upgrade_global(wdb_t *wdb) {
     return wdb;
 }
 
+// Upgrade tasks database to last version
+wdb_t * wdb_upgrade_tasks(wdb_t *wdb) {
+    const char * UPDATES[] = {
+        schema_task_manager_upgrade_v2_sql,
+    };
+
+    char db_version[OS_SIZE_256];
+    int version = 0;
+
+    if (wdb_metadata_get_entry(wdb, "db_version", db_version) != OS_SUCCESS) {
+        mwarn("DB(%s): Error trying to get DB version", wdb->id);
+        return wdb;
+    }
+
+    // The first version of the tasks database is the 1
+    version = atoi(db_version);
+
+    for (int i = version - 1; i >= 0 && i < (int)(sizeof(UPDATES) / sizeof(char *)); i++) {
+        mdebug2("Updating database '%s' to version %d", wdb->id, i + 2);
+
+        // The tasks are kept as they are, only the indexes and views change between versions
+        if (wdb_sql_exec(wdb, UPDATES[i]) == OS_INVALID) {
+            merror("Failed to update %s.db to version %d.", wdb->id, i + 2);
+            break;
+        }
+    }
+
+    return wdb;
+}
+
 // Create backup and generate an empty DB
 wdb_t * wdb_backup(wdb_t *wdb, int version) {
     char path[PATH_MAX];
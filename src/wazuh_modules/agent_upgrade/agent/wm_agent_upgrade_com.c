@@ -247,6 +247,7 @@ STATIC char * wm_agent_upgrade_com_write(const cJSON* json_object) {
     const cJSON *file_path_obj = cJSON_GetObjectItem(json_object, "file");
     const cJSON *buffer_obj = cJSON_GetObjectItem(json_object, "buffer");
     const cJSON *value_obj = cJSON_GetObjectItem(json_object, "length");
+    const cJSON *offset_obj = cJSON_GetObjectItem(json_object, "offset");
     char final_path[PATH_MAX + 1];
 
     if (!*file.path) {
@@ -264,6 +265,12 @@ STATIC char * wm_agent_upgrade_com_write(const cJSON* json_object) {
         return wm_agent_upgrade_command_ack(ERROR_TARGET_FILE_NOT_MATCH, error_messages[ERROR_TARGET_FILE_NOT_MATCH]);
     }
 
+    // The manager may send several chunks at once, each one tells where it goes
+    if (offset_obj && (offset_obj->type != cJSON_Number || offset_obj->valuedouble < 0 || fseek(file.fp, (long)offset_obj->valuedouble, SEEK_SET) != 0)) {
+        mterror(WM_AGENT_UPGRADE_LOGTAG, WM_UPGRADE_CANNOT_WRITE, "write", final_path);
+        return wm_agent_upgrade_command_ack(ERROR_WRITE_FILE, error_messages[ERROR_WRITE_FILE]);
+    }
+
     char *base64_string = decode_base64(buffer_obj->valuestring);
     if (value_obj && (value_obj->type == cJSON_Number) && base64_string && fwrite(base64_string, 1, value_obj->valueint, file.fp) == (unsigned)value_obj->valueint) {
         os_free(base64_string);
@@ -16,10 +16,12 @@
 #define WM_UPGRADE_MINIMAL_VERSION_SUPPORT_MACOS "v4.3.0"
 #define WM_UPGRADE_NEW_VERSION_REPOSITORY "v3.4.0"
 #define WM_UPGRADE_NEW_UPGRADE_MECHANISM "v4.1.0"
+#define WM_UPGRADE_CHUNK_WINDOW_VERSION "v4.9.0"
 #define WM_UPGRADE_WPK_DEFAULT_PATH "var/upgrade/"
 #define WM_UPGRADE_WPK_DOWNLOAD_TIMEOUT 60000
 #define WM_UPGRADE_WPK_DOWNLOAD_ATTEMPTS 5
 #define WM_UPGRADE_WPK_OPEN_ATTEMPTS 10
+#define WM_UPGRADE_WPK_CACHE_SIZE 8
 #define WM_UPGRADE_MAX_RESPONSE_SIZE 1048576L
 #define MANAGER_ID 0
 #define WM_AGENT_UPGRADE_START_WAIT_TIME 30
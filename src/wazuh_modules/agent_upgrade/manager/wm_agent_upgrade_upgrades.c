@@ -30,6 +30,10 @@ STATIC w_linked_queue_t *upgrade_queue;
 /* Running threads semaphore */
 sem_t upgrade_semaphore;
 
+/* WPK files loaded in memory, most recent first */
+STATIC wm_upgrade_wpk *wpk_cache;
+static pthread_mutex_t wpk_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 /* Definition of upgrade arguments structure */
 typedef struct _wm_upgrade_args {
     wm_manager_configs *config;
@@ -79,17 +83,21 @@ STATIC int wm_agent_upgrade_send_lock_restart(int agent_id);
 STATIC int wm_agent_upgrade_send_open(int agent_id, int wpk_message_format, const char *wpk_file) __attribute__((nonnull));
 
 /**
- * Send a write file command to an agent
+ * Send the write file commands of a WPK to an agent
+ * When chunk_window is greater than 1, that many chunks are sent before waiting
+ * for the response to the first one, each command tells the offset of its chunk
  * @param agent_id id of the agent
  * @param wpk_message_format 1 for new format, 0 for old
  * @param wpk_file name of the file to write in the agent
- * @param file_path name of the file to read in the manager
+ * @param wpk WPK file loaded in the manager
  * @param chunk_size size of block to send WPK file
+ * @param chunk_window number of chunks sent without a response
+ * @param rate_limit maximum kilobytes per second sent to the agent, 0 for no limit
  * @return error code
  * @retval OS_SUCCESS on success
  * @retval OS_INVALID on errors
  * */
-STATIC int wm_agent_upgrade_send_write(int agent_id, int wpk_message_format, const char *wpk_file, const char *file_path, int chunk_size) __attribute__((nonnull));
+STATIC int wm_agent_upgrade_send_write(int agent_id, int wpk_message_format, const char *wpk_file, const wm_upgrade_wpk *wpk, unsigned int chunk_size, unsigned int chunk_window, unsigned int rate_limit) __attribute__((nonnull));
 
 /**
  * Send a close file command to an agent
@@ -126,12 +134,70 @@ STATIC int wm_agent_upgrade_send_sha1(int agent_id, int wpk_message_format, cons
  * */
 STATIC int wm_agent_upgrade_send_upgrade(int agent_id, int wpk_message_format, const char *wpk_file, const char *installer) __attribute__((nonnull));
 
+/**
+ * Get a WPK file from the cache, loading it if needed
+ * An entry is found by its sha1 when it's known, otherwise the file must not have
+ * changed since it was loaded
+ * @param file_path path of the file in the manager
+ * @param file_sha1 expected sha1 of the file, NULL if it's unknown
+ * @param load read the file when it isn't in the cache
+ * @return WPK file to release with wm_agent_upgrade_release_wpk
+ * @retval NULL if it isn't cached or it couldn't be read
+ * */
+STATIC wm_upgrade_wpk* wm_agent_upgrade_get_wpk(const char *file_path, const char *file_sha1, bool load) __attribute__((nonnull(1)));
+
+/**
+ * Release a WPK file got from the cache
+ * @param wpk WPK file
+ * */
+STATIC void wm_agent_upgrade_release_wpk(wm_upgrade_wpk *wpk) __attribute__((nonnull));
+
+/**
+ * Read a WPK file into memory and calculate its sha1
+ * @param file_path path of the file in the manager
+ * @return WPK file not cached yet
+ * @retval NULL if the file couldn't be read
+ * */
+STATIC wm_upgrade_wpk* wm_agent_upgrade_read_wpk(const char *file_path) __attribute__((nonnull));
+
+/**
+ * Send a command to the agent without waiting for the response
+ * @param command command to send
+ * @param command_size size of the command
+ * @return socket to read the response from
+ * @retval OS_SOCKTERR if remoted couldn't be reached
+ * */
+STATIC int wm_agent_upgrade_send_request(const char *command, size_t command_size) __attribute__((nonnull));
+
+/**
+ * Receive the response of a command sent with wm_agent_upgrade_send_request
+ * @param sock socket returned when sending the command, it's closed
+ * @return response of the agent
+ * @retval NULL if the command couldn't be sent
+ * */
+STATIC char* wm_agent_upgrade_recv_response(int sock);
+
 void wm_agent_upgrade_init_upgrade_queue() {
     upgrade_queue = linked_queue_init();
 }
 
 void wm_agent_upgrade_destroy_upgrade_queue() {
     linked_queue_free(upgrade_queue);
+
+    w_mutex_lock(&wpk_cache_mutex);
+    for (wm_upgrade_wpk *wpk = wpk_cache, *next; wpk; wpk = next) {
+        next = wpk->next;
+        if (wpk->references) {
+            // The last upgrade using it will free it
+            wpk->cached = false;
+        } else {
+            os_free(wpk->path);
+            os_free(wpk->data);
+            os_free(wpk);
+        }
+    }
+    wpk_cache = NULL;
+    w_mutex_unlock(&wpk_cache_mutex);
 }
 
 void wm_agent_upgrade_prepare_upgrades() {
@@ -263,18 +329,35 @@ STATIC int wm_agent_upgrade_send_wpk_to_agent(const wm_agent_task *agent_task, c
     char *file_sha1 = NULL;
     char *wpk_path = NULL;
     char *installer = NULL;
+    wm_upgrade_wpk *wpk = NULL;
+    unsigned int chunk_window = 1;
 
     // Validate WPK file
     if (WM_UPGRADE_UPGRADE == agent_task->task_info->command) {
-        result = wm_agent_upgrade_validate_wpk_version(agent_task->agent_info, (wm_upgrade_task *)agent_task->task_info->task, manager_configs->wpk_repository);
+        wm_upgrade_task *upgrade_task = agent_task->task_info->task;
+
+        result = wm_agent_upgrade_validate_wpk_version(agent_task->agent_info, upgrade_task, manager_configs->wpk_repository);
         if (result == WM_UPGRADE_SUCCESS) {
-            result = wm_agent_upgrade_validate_wpk((wm_upgrade_task *)agent_task->task_info->task);
+            // A WPK already sent to another agent doesn't need to be checked again
+            if (upgrade_task->wpk_file && upgrade_task->wpk_sha1) {
+                os_calloc(OS_SIZE_4096, sizeof(char), file_path);
+                snprintf(file_path, OS_SIZE_4096, "%s%s", WM_UPGRADE_WPK_DEFAULT_PATH, upgrade_task->wpk_file);
+                wpk = wm_agent_upgrade_get_wpk(file_path, upgrade_task->wpk_sha1, false);
+                os_free(file_path);
+            }
+
+            if (!wpk) {
+                result = wm_agent_upgrade_validate_wpk(upgrade_task);
+            }
         }
     } else {
         result = wm_agent_upgrade_validate_wpk_custom((wm_upgrade_custom_task *)agent_task->task_info->task);
     }
 
     if (result != WM_UPGRADE_SUCCESS) {
+        if (wpk) {
+            wm_agent_upgrade_release_wpk(wpk);
+        }
         return result;
     }
 
@@ -291,11 +374,8 @@ STATIC int wm_agent_upgrade_send_wpk_to_agent(const wm_agent_task *agent_task, c
     } else {
         wm_upgrade_custom_task *upgrade_custom_task = NULL;
         upgrade_custom_task = agent_task->task_info->task;
-        // WPK custom file path
+        // WPK custom file path, its sha1 is calculated when loading it
         os_strdup(upgrade_custom_task->custom_file_path, file_path);
-        // WPK custom file sha1
-        os_calloc(41, sizeof(char), file_sha1);
-        OS_SHA1_File(file_path, file_sha1, OS_BINARY);
         // Installer
         if (upgrade_custom_task->custom_installer) {
             os_strdup(upgrade_custom_task->custom_installer, installer);
@@ -322,14 +402,28 @@ STATIC int wm_agent_upgrade_send_wpk_to_agent(const wm_agent_task *agent_task, c
     // Compare actual agent version to know which command format to use
     int wpk_message_format = compare_wazuh_versions(strchr(agent_task->agent_info->wazuh_version, 'v'), WM_UPGRADE_NEW_UPGRADE_MECHANISM, true);
 
+    // Agents writing each chunk at its offset can receive several chunks at once
+    if (manager_configs->chunk_window > 1 && wpk_message_format >= 0
+        && compare_wazuh_versions(strchr(agent_task->agent_info->wazuh_version, 'v'), WM_UPGRADE_CHUNK_WINDOW_VERSION, true) >= 0) {
+        chunk_window = manager_configs->chunk_window;
+    }
+
     // open wb
     if ((result == WM_UPGRADE_SUCCESS) && wm_agent_upgrade_send_open(agent_task->agent_info->agent_id, wpk_message_format, wpk_path)) {
         result = WM_UPGRADE_SEND_OPEN_ERROR;
     }
 
     // write
-    if ((result == WM_UPGRADE_SUCCESS) && wm_agent_upgrade_send_write(agent_task->agent_info->agent_id, wpk_message_format, wpk_path, file_path, manager_configs->chunk_size)) {
-        result = WM_UPGRADE_SEND_WRITE_ERROR;
+    if (result == WM_UPGRADE_SUCCESS) {
+        if (!wpk) {
+            wpk = wm_agent_upgrade_get_wpk(file_path, file_sha1, true);
+        }
+
+        if (!wpk || wm_agent_upgrade_send_write(agent_task->agent_info->agent_id, wpk_message_format, wpk_path, wpk, manager_configs->chunk_size, chunk_window, manager_configs->rate_limit)) {
+            result = WM_UPGRADE_SEND_WRITE_ERROR;
+        } else if (!file_sha1) {
+            os_strdup(wpk->sha1, file_sha1);
+        }
     }
 
     // close
@@ -347,6 +441,10 @@ STATIC int wm_agent_upgrade_send_wpk_to_agent(const wm_agent_task *agent_task, c
         result = WM_UPGRADE_SEND_UPGRADE_ERROR;
     }
 
+    if (wpk) {
+        wm_agent_upgrade_release_wpk(wpk);
+    }
+
     os_free(file_path);
     os_free(file_path_copy);
     os_free(file_sha1);
@@ -418,19 +516,28 @@ STATIC int wm_agent_upgrade_send_open(int agent_id, int wpk_message_format, cons
     return result;
 }
 
-STATIC int wm_agent_upgrade_send_write(int agent_id, int wpk_message_format, const char *wpk_file, const char *file_path, int chunk_size) {
-    int result = OS_INVALID;
+STATIC int wm_agent_upgrade_send_write(int agent_id, int wpk_message_format, const char *wpk_file, const wm_upgrade_wpk *wpk, unsigned int chunk_size, unsigned int chunk_window, unsigned int rate_limit) {
+    int result = wpk->size ? OS_SUCCESS : OS_INVALID;
     char *command = NULL;
     char *response = NULL;
-    char buffer[chunk_size];
-    size_t bytes = 0;
+    int sockets[chunk_window];
+    unsigned int first = 0;
+    unsigned int pending = 0;
+    size_t offset = 0;
     size_t command_size = 0;
+    struct timespec start;
 
     os_calloc(OS_MAXSTR, sizeof(char), command);
 
-    FILE *file = fopen(file_path, "rb");
-    if (file) {
-        while (bytes = fread(buffer, 1, sizeof(buffer), file), bytes) {
+    if (rate_limit) {
+        gettime(&start);
+    }
+
+    while (result == OS_SUCCESS && (offset < wpk->size || pending)) {
+
+        if (offset < wpk->size && pending < chunk_window) {
+            const char *buffer = wpk->data + offset;
+            size_t bytes = wpk->size - offset < chunk_size ? wpk->size - offset : chunk_size;
 
             if (wpk_message_format >= 0) {
                 cJSON *command_info = cJSON_CreateObject();
@@ -439,6 +546,9 @@ STATIC int wm_agent_upgrade_send_write(int agent_id, int wpk_message_format, con
                 char *base64 = encode_base64(bytes, buffer);
                 cJSON_AddStringToObject(params, "buffer", base64);
                 cJSON_AddNumberToObject(params, "length", bytes);
+                if (chunk_window > 1) {
+                    cJSON_AddNumberToObject(params, "offset", offset);
+                }
                 cJSON_AddStringToObject(params, "file", wpk_file);
                 cJSON_AddItemToObject(command_info, task_manager_json_keys[WM_TASK_PARAMETERS], params);
                 char *command_string = cJSON_PrintUnformatted(command_info);
@@ -450,27 +560,48 @@ STATIC int wm_agent_upgrade_send_write(int agent_id, int wpk_message_format, con
             } else {
                 snprintf(command, OS_MAXSTR, "%.3d com write %ld %s ", agent_id, bytes, wpk_file);
                 command_size = strlen(command);
-                for (size_t byte = 0; byte < bytes; ++byte) {
-                    sprintf(&command[command_size++], "%c", buffer[byte]);
-                }
+                memcpy(&command[command_size], buffer, bytes);
+                command_size += bytes;
+                command[command_size] = '\0';
             }
 
-            os_free(response);
-            response = wm_agent_upgrade_send_command_to_agent(command, command_size);
-            if (wpk_message_format >= 0) {
-                result = wm_agent_upgrade_parse_agent_upgrade_command_response(response, NULL);
-            } else {
-                result = wm_agent_upgrade_parse_agent_response(response, NULL);
-            }
-            if (result) {
-                break;
+            sockets[(first + pending++) % chunk_window] = wm_agent_upgrade_send_request(command, command_size);
+            offset += bytes;
+
+            if (rate_limit) {
+                struct timespec now;
+                gettime(&now);
+                double delay = (double)offset / (rate_limit * 1024.0) - time_diff(&start, &now);
+
+                if (delay > 0) {
+                    struct timespec wait = { .tv_sec = (time_t)delay, .tv_nsec = (long)((delay - (time_t)delay) * 1e9) };
+                    nanosleep(&wait, NULL);
+                }
             }
+            continue;
+        }
+
+        // Wait for the oldest chunk
+        response = wm_agent_upgrade_recv_response(sockets[first]);
+        first = (first + 1) % chunk_window;
+        pending--;
+
+        if (wpk_message_format >= 0) {
+            result = wm_agent_upgrade_parse_agent_upgrade_command_response(response, NULL);
+        } else {
+            result = wm_agent_upgrade_parse_agent_response(response, NULL);
+        }
+        os_free(response);
+    }
+
+    // The responses to the chunks sent after a failed one are discarded
+    for (; pending; pending--, first = (first + 1) % chunk_window) {
+        if (sockets[first] >= 0) {
+            close(sockets[first]);
         }
-        fclose(file);
     }
 
     os_free(command);
-    os_free(response);
 
     return result;
 }
@@ -599,9 +730,10 @@ STATIC int wm_agent_upgrade_send_upgrade(int agent_id, int wpk_message_format, c
 }
 
 char* wm_agent_upgrade_send_command_to_agent(const char *command, const size_t command_size) {
-    char *response = NULL;
-    int length = 0;
+    return wm_agent_upgrade_recv_response(wm_agent_upgrade_send_request(command, command_size));
+}
 
+STATIC int wm_agent_upgrade_send_request(const char *command, size_t command_size) {
     const char *path = REMOTE_LOCAL_SOCK;
 
     int sock = OS_ConnectUnixDomain(path, SOCK_STREAM, OS_MAXSTR);
@@ -612,22 +744,143 @@ char* wm_agent_upgrade_send_command_to_agent(const char *command, const size_t c
         mtdebug2(WM_AGENT_UPGRADE_LOGTAG, WM_UPGRADE_REQUEST_SEND_MESSAGE, command);
 
         OS_SendSecureTCP(sock, command_size ? command_size : strlen(command), command);
-        os_calloc(OS_MAXSTR, sizeof(char), response);
+    }
 
-        switch (length = OS_RecvSecureTCP(sock, response, OS_MAXSTR), length) {
-            case OS_SOCKTERR:
-                mterror(WM_AGENT_UPGRADE_LOGTAG, WM_UPGRADE_SOCKTERR_ERROR);
-                break;
-            case -1:
-                mterror(WM_AGENT_UPGRADE_LOGTAG, WM_UPGRADE_RECV_ERROR, strerror(errno));
-                break;
-            default:
-                mtdebug2(WM_AGENT_UPGRADE_LOGTAG, WM_UPGRADE_REQUEST_RECEIVE_MESSAGE, response);
+    return sock;
+}
+
+STATIC char* wm_agent_upgrade_recv_response(int sock) {
+    char *response = NULL;
+    int length = 0;
+
+    if (sock == OS_SOCKTERR) {
+        return NULL;
+    }
+
+    os_calloc(OS_MAXSTR, sizeof(char), response);
+
+    switch (length = OS_RecvSecureTCP(sock, response, OS_MAXSTR), length) {
+        case OS_SOCKTERR:
+            mterror(WM_AGENT_UPGRADE_LOGTAG, WM_UPGRADE_SOCKTERR_ERROR);
+            break;
+        case -1:
+            mterror(WM_AGENT_UPGRADE_LOGTAG, WM_UPGRADE_RECV_ERROR, strerror(errno));
+            break;
+        default:
+            mtdebug2(WM_AGENT_UPGRADE_LOGTAG, WM_UPGRADE_REQUEST_RECEIVE_MESSAGE, response);
+            break;
+    }
+
+    close(sock);
+
+    return response;
+}
+
+STATIC wm_upgrade_wpk* wm_agent_upgrade_get_wpk(const char *file_path, const char *file_sha1, bool load) {
+    wm_upgrade_wpk *wpk = NULL;
+    struct stat file_stat;
+    bool file_found = false;
+
+    if (!file_sha1) {
+        // The file changes when it's replaced or modified
+        file_found = !stat(file_path, &file_stat);
+    }
+
+    w_mutex_lock(&wpk_cache_mutex);
+
+    for (wpk = wpk_cache; wpk; wpk = wpk->next) {
+        if (!strcmp(wpk->path, file_path)) {
+            if (file_sha1 ? !strcasecmp(wpk->sha1, file_sha1)
+                          : file_found && wpk->mtime == file_stat.st_mtime && wpk->inode == file_stat.st_ino && wpk->size == (size_t)file_stat.st_size) {
                 break;
+            }
+        }
+    }
+
+    if (!wpk && load && (wpk = wm_agent_upgrade_read_wpk(file_path), wpk) && (file_sha1 || file_found)) {
+        unsigned int entries = 1;
+        wm_upgrade_wpk **prev = &wpk_cache;
+
+        if (file_found) {
+            wpk->mtime = file_stat.st_mtime;
+            wpk->inode = file_stat.st_ino;
         }
 
-        close(sock);
+        wpk->cached = true;
+
+        // Drop the former versions of the file and the oldest entries not in use
+        while (*prev) {
+            wm_upgrade_wpk *entry = *prev;
+
+            if (!strcmp(entry->path, file_path) || entries >= WM_UPGRADE_WPK_CACHE_SIZE) {
+                *prev = entry->next;
+                entry->cached = false;
+
+                if (!entry->references) {
+                    os_free(entry->path);
+                    os_free(entry->data);
+                    os_free(entry);
+                }
+            } else {
+                entries++;
+                prev = &entry->next;
+            }
+        }
+
+        wpk->next = wpk_cache;
+        wpk_cache = wpk;
     }
 
-    return response;
+    if (wpk) {
+        wpk->references++;
+    }
+
+    w_mutex_unlock(&wpk_cache_mutex);
+
+    return wpk;
+}
+
+STATIC void wm_agent_upgrade_release_wpk(wm_upgrade_wpk *wpk) {
+    bool unused;
+
+    w_mutex_lock(&wpk_cache_mutex);
+    unused = !--wpk->references && !wpk->cached;
+    w_mutex_unlock(&wpk_cache_mutex);
+
+    if (unused) {
+        os_free(wpk->path);
+        os_free(wpk->data);
+        os_free(wpk);
+    }
+}
+
+STATIC wm_upgrade_wpk* wm_agent_upgrade_read_wpk(const char *file_path) {
+    wm_upgrade_wpk *wpk = NULL;
+    size_t capacity = OS_SIZE_65536;
+    size_t bytes = 0;
+    FILE *file = NULL;
+
+    if (file = fopen(file_path, "rb"), !file) {
+        mterror(WM_AGENT_UPGRADE_LOGTAG, FOPEN_ERROR, file_path, errno, strerror(errno));
+        return NULL;
+    }
+
+    os_calloc(1, sizeof(wm_upgrade_wpk), wpk);
+    os_strdup(file_path, wpk->path);
+    os_malloc(capacity, wpk->data);
+
+    while (bytes = fread(wpk->data + wpk->size, 1, capacity - wpk->size, file), bytes) {
+        wpk->size += bytes;
+
+        if (wpk->size == capacity) {
+            capacity *= 2;
+            os_realloc(wpk->data, capacity, wpk->data);
+        }
+    }
+
+    fclose(file);
+
+    OS_SHA1_Str(wpk->data, wpk->size, wpk->sha1);
+
+    return wpk;
 }
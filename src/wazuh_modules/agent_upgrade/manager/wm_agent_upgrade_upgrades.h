@@ -15,6 +15,21 @@
 #include "wm_agent_upgrade_manager.h"
 #include <semaphore.h>
 
+/**
+ * WPK file loaded in memory, shared by the upgrades that send it
+ * */
+typedef struct _wm_upgrade_wpk {
+    char *path;                    ///> path of the file in the manager
+    char *data;                    ///> content of the file
+    size_t size;                   ///> size of the content
+    os_sha1 sha1;                  ///> sha1 of the content
+    time_t mtime;                  ///> modification time of the file when loaded
+    ino_t inode;                   ///> inode of the file when loaded
+    bool cached;                   ///> the entry is kept in the cache
+    unsigned int references;       ///> upgrades using the entry
+    struct _wm_upgrade_wpk *next;
+} wm_upgrade_wpk;
+
 /**
  * Upgrade queue initialization
  * */
@@ -86,6 +86,8 @@ STATIC cJSON *wm_agent_upgrade_dump(const wm_agent_upgrade* upgrade_config){
     #ifndef CLIENT
     cJSON_AddNumberToObject(wm_info, "max_threads", upgrade_config->manager_config.max_threads);
     cJSON_AddNumberToObject(wm_info, "chunk_size", upgrade_config->manager_config.chunk_size);
+    cJSON_AddNumberToObject(wm_info, "chunk_window", upgrade_config->manager_config.chunk_window);
+    cJSON_AddNumberToObject(wm_info, "rate_limit", upgrade_config->manager_config.rate_limit);
     if (upgrade_config->manager_config.wpk_repository) {
         cJSON_AddStringToObject(wm_info, "wpk_repository", upgrade_config->manager_config.wpk_repository);
     }
@@ -18,6 +18,9 @@
 #define WM_UPGRADE_WPK_REPO_URL "packages.wazuh.com/%d.x/wpk/"
 #define WM_UPGRADE_CHUNK_SIZE 512
 #define WM_UPGRADE_MAX_THREADS 8
+#define WM_UPGRADE_MAX_THREADS_LIMIT 1024
+#define WM_UPGRADE_CHUNK_WINDOW 8
+#define WM_UPGRADE_CHUNK_WINDOW_LIMIT 64
 #define WM_UPGRADE_WAIT_START 300
 #define WM_UPGRADE_WAIT_MAX 3600
 #define WM_UPGRADE_WAIT_FACTOR_INCREASE 2.0
@@ -38,6 +41,8 @@ typedef struct _wm_agent_configs {
 typedef struct _wm_manager_configs {
     unsigned int max_threads;
     unsigned int chunk_size;
+    unsigned int chunk_window;  // Chunks sent to an agent before waiting for its responses
+    unsigned int rate_limit;    // Kilobytes per second sent to each agent, 0 for no limit
     char *wpk_repository;
 } wm_manager_configs;
 
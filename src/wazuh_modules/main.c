@@ -95,6 +95,8 @@ int main(int argc, char **argv)
         mdebug2("Created new thread for the '%s' module.", cur_module->tag);
     }
 
+    w_mem_metrics_init();
+
     // Start com request thread
     w_create_thread(wmcom_main, NULL);
 
@@ -37,6 +37,23 @@ typedef void((*log_callback_t)(const modules_log_level_t level, const char* log,
 
 typedef void((*send_data_callback_t)(const void* buffer));
 
+typedef bool((*pressure_callback_t)(void));
+
+typedef struct syscollector_schedule_t
+{
+    unsigned int hardware;          // Interval of each inventory, 0 takes the one of the module
+    unsigned int os;
+    unsigned int network;
+    unsigned int packages;
+    unsigned int hotfixes;
+    unsigned int ports;
+    unsigned int processes;
+    unsigned int jitter;            // Maximum delay of the scans, fixed for each seed
+    const char* jitter_seed;
+    unsigned int max_backoff;       // Maximum stretch of the intervals under pressure
+    pressure_callback_t pressure;   // Whether the output got congested since the last call
+} syscollector_schedule_t;
+
 EXPORTED void syscollector_start(const unsigned int inverval,
                                  send_data_callback_t callbackDiff,
                                  send_data_callback_t callbackSync,
@@ -52,7 +69,9 @@ EXPORTED void syscollector_start(const unsigned int inverval,
                                  const bool ports,
                                  const bool portsAll,
                                  const bool processes,
-                                 const bool hotfixes);
+                                 const bool hotfixes,
+                                 const syscollector_schedule_t* schedule,
+                                 const unsigned int deltaBatchSize);
 
 EXPORTED void syscollector_stop();
 
@@ -79,7 +98,9 @@ typedef void(*syscollector_start_func)(const unsigned int inverval,
                                        const bool ports,
                                        const bool portsAll,
                                        const bool processes,
-                                       const bool hotfixes);
+                                       const bool hotfixes,
+                                       const syscollector_schedule_t* schedule,
+                                       const unsigned int deltaBatchSize);
 
 typedef void(*syscollector_stop_func)();
 
@@ -11,6 +11,8 @@
 #ifndef _SYSCOLLECTOR_HPP
 #define _SYSCOLLECTOR_HPP
 #include <chrono>
+#include <functional>
+#include <map>
 #include <thread>
 #include <condition_variable>
 #include <mutex>
@@ -35,6 +37,28 @@
 #define EXPORTED
 #endif
 
+// Inventory collected by a lazy scan, with what it depends on.
+struct LazyInventory final
+{
+    bool valid { false };
+    nlohmann::json data;
+    std::string bootId;
+    nlohmann::json fingerprint;
+    std::chrono::steady_clock::time_point time;
+};
+
+// Scheduling of the inventories. An interval of 0 takes the one of the module, the scans are
+// delayed up to jitter seconds (a fixed amount for each seed and inventory) and their intervals
+// are stretched up to maxBackoff times while pressure() reports a congested output.
+struct SyscollectorSchedule final
+{
+    std::map<std::string, unsigned int> intervals;
+    unsigned int jitter { 0 };
+    std::string jitterSeed;
+    unsigned int maxBackoff { 1 };
+    std::function<bool()> pressure;
+};
+
 class EXPORTED Syscollector final
 {
     public:
@@ -61,11 +85,33 @@ class EXPORTED Syscollector final
                   const bool portsAll = true,
                   const bool processes = true,
                   const bool hotfixes = true,
-                  const bool notifyOnFirstScan = false);
+                  const bool notifyOnFirstScan = false,
+                  const bool processesIncremental = false,
+                  const unsigned int lazyInventoryTtl = 0,
+                  const unsigned int scanThreads = 1,
+                  const SyscollectorSchedule& schedule = {},
+                  const unsigned int deltaBatchSize = 0);
 
         void destroy();
         void push(const std::string& data);
     private:
+        struct ScheduledInventory final
+        {
+            std::string name;
+            void (Syscollector::*scan)();
+            void (Syscollector::*sync)();
+            std::chrono::seconds interval;
+            std::chrono::steady_clock::time_point next;
+            bool scanned;
+        };
+
+        // Deltas of a table waiting to be sent in a single message.
+        struct DeltaBatch final
+        {
+            std::string items;
+            unsigned int count { 0 };
+        };
+
         Syscollector();
         ~Syscollector() = default;
         Syscollector(const Syscollector&) = delete;
@@ -75,7 +121,8 @@ class EXPORTED Syscollector final
         nlohmann::json getOSData();
         nlohmann::json getHardwareData();
         nlohmann::json getNetworkData();
-        nlohmann::json getPortsData();
+        bool lazyInventoryOutdated(const LazyInventory& inventory, const nlohmann::json& fingerprint) const;
+        void lazyInventoryUpdate(LazyInventory& inventory, nlohmann::json data, nlohmann::json fingerprint);
 
         void registerWithRsync();
         void updateChanges(const std::string& table,
@@ -83,6 +130,9 @@ class EXPORTED Syscollector final
         void notifyChange(ReturnTypeCallback result,
                           const nlohmann::json& data,
                           const std::string& table);
+        void reportDelta(const std::string& table, const std::string& operation, nlohmann::json data);
+        void sendDeltaBatch(const std::string& table, DeltaBatch& batch);
+        void flushDeltas();
         void scanHardware();
         void scanOs();
         void scanNetwork();
@@ -97,8 +147,10 @@ class EXPORTED Syscollector final
         void syncHotfixes();
         void syncPorts();
         void syncProcesses();
-        void scan();
-        void sync();
+        void scheduleInventories();
+        void scan(const std::vector<ScheduledInventory*>& inventories);
+        void sync(const std::vector<ScheduledInventory*>& inventories);
+        void updateBackoff();
         void syncLoop(std::unique_lock<std::mutex>& lock);
         std::shared_ptr<ISysInfo>                                               m_spInfo;
         std::function<void(const std::string&)>                                 m_reportDiffFunction;
@@ -114,6 +166,15 @@ class EXPORTED Syscollector final
         bool                                                                    m_portsAll;
         bool                                                                    m_processes;
         bool                                                                    m_hotfixes;
+        bool                                                                    m_processesIncremental;
+        unsigned int                                                            m_lazyInventoryTtl;
+        unsigned int                                                            m_scanThreads;
+        SyscollectorSchedule                                                    m_schedule;
+        std::vector<ScheduledInventory>                                         m_inventories;
+        unsigned int                                                            m_backoff;
+        unsigned int                                                            m_deltaBatchSize;
+        std::map<std::string, DeltaBatch>                                       m_deltaBatches;
+        std::mutex                                                              m_deltaBatchesMutex;
         bool                                                                    m_stopping;
         bool                                                                    m_notify;
         std::unique_ptr<DBSync>                                                 m_spDBSync;
@@ -122,6 +183,9 @@ class EXPORTED Syscollector final
         std::mutex                                                              m_mutex;
         std::unique_ptr<SysNormalizer>                                          m_spNormalizer;
         std::string                                                             m_scanTime;
+        nlohmann::json                                                          m_packagesFingerprint;
+        LazyInventory                                                           m_hardwareInventory;
+        LazyInventory                                                           m_osInventory;
 };
 
 
@@ -13,6 +13,8 @@
 #include <json.hpp>
 #include <string>
 #include <map>
+#include <regex>
+#include <vector>
 
 class SysNormalizer
 {
@@ -25,11 +27,37 @@ class SysNormalizer
         void removeExcluded(const std::string& type,
                             nlohmann::json& data) const;
     private:
+        struct Exclusion final
+        {
+            std::string fieldName;
+            std::regex pattern;
+        };
+        struct DictionaryRule final
+        {
+            bool hasFind;
+            std::string findField;
+            std::regex findPattern;
+            bool hasReplace;
+            std::string replaceField;
+            std::regex replacePattern;
+            std::string replaceValue;
+            bool hasAdd;
+            std::string addField;
+            std::string addValue;
+        };
+        using Exclusions = std::map<std::string, std::vector<Exclusion>>;
+        using Dictionary = std::map<std::string, std::vector<DictionaryRule>>;
+
         static std::map<std::string, nlohmann::json> getTypeValues(const std::string& configFile,
                                                                    const std::string& target,
                                                                    const std::string& type);
-        const std::map<std::string, nlohmann::json> m_typeExclusions;
-        const std::map<std::string, nlohmann::json> m_typeDictionary;
+        static Exclusions compileExclusions(const std::map<std::string, nlohmann::json>& typeValues);
+        static Dictionary compileDictionary(const std::map<std::string, nlohmann::json>& typeValues);
+        static void normalizeItem(const std::vector<DictionaryRule>& dictionary,
+                                  nlohmann::json& item);
+        // The configuration is compiled once, the regular expressions aren't built again for every item.
+        const Exclusions m_typeExclusions;
+        const Dictionary m_typeDictionary;
 };
 
 
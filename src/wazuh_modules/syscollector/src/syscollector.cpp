@@ -33,7 +33,9 @@ void syscollector_start(const unsigned int inverval,
                         const bool ports,
                         const bool portsAll,
                         const bool processes,
-                        const bool hotfixes)
+                        const bool hotfixes,
+                        const syscollector_schedule_t* schedule,
+                        const unsigned int deltaBatchSize)
 {
     std::function<void(const std::string&)> callbackDiffWrapper
     {
@@ -67,6 +69,30 @@ void syscollector_start(const unsigned int inverval,
         }
     };
 
+    SyscollectorSchedule scheduleWrapper;
+
+    if (schedule)
+    {
+        scheduleWrapper.intervals =
+        {
+            { "hardware", schedule->hardware },
+            { "os", schedule->os },
+            { "network", schedule->network },
+            { "packages", schedule->packages },
+            { "hotfixes", schedule->hotfixes },
+            { "ports", schedule->ports },
+            { "processes", schedule->processes }
+        };
+        scheduleWrapper.jitter = schedule->jitter;
+        scheduleWrapper.jitterSeed = schedule->jitter_seed ? schedule->jitter_seed : "";
+        scheduleWrapper.maxBackoff = schedule->max_backoff;
+
+        if (schedule->pressure)
+        {
+            scheduleWrapper.pressure = schedule->pressure;
+        }
+    }
+
     DBSync::initialize(callbackErrorLogWrapper);
 
     try
@@ -87,7 +113,13 @@ void syscollector_start(const unsigned int inverval,
                                       ports,
                                       portsAll,
                                       processes,
-                                      hotfixes);
+                                      hotfixes,
+                                      false,
+                                      false,
+                                      0,
+                                      1,
+                                      scheduleWrapper,
+                                      deltaBatchSize);
     }
     catch (const std::exception& ex)
     {
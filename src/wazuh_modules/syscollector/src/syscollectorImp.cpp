@@ -12,6 +12,11 @@
 #include "syscollector.hpp"
 #include "json.hpp"
 #include <iostream>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <tuple>
+#include <unordered_set>
 #include "stringHelper.h"
 #include "hashHelper.h"
 #include "timeHelper.h"
@@ -40,6 +45,17 @@ constexpr auto QUEUE_SIZE
     4096
 };
 
+constexpr auto SYNC_BATCH_SIZE
+{
+    512u
+};
+
+// The messages of the agents are up to 64 KiB, the location and the headers included.
+constexpr auto DELTA_BATCH_MAX_SIZE
+{
+    60000ul
+};
+
 static const std::map<ReturnTypeCallback, std::string> OPERATION_MAP
 {
     // LCOV_EXCL_START
@@ -83,6 +99,8 @@ constexpr auto OS_SYNC_CONFIG_STATEMENT
         "component":"syscollector_osinfo",
         "index":"os_name",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE os_name BETWEEN '?' and '?' ORDER BY os_name",
                 "column_list":["*"],
@@ -169,6 +187,8 @@ constexpr auto HW_SYNC_CONFIG_STATEMENT
         "component":"syscollector_hwinfo",
         "index":"board_serial",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE board_serial BETWEEN '?' and '?' ORDER BY board_serial",
                 "column_list":["*"],
@@ -250,6 +270,8 @@ constexpr auto HOTFIXES_SYNC_CONFIG_STATEMENT
         "component":"syscollector_hotfixes",
         "index":"hotfix",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE hotfix BETWEEN '?' and '?' ORDER BY hotfix",
                 "column_list":["*"],
@@ -344,6 +366,8 @@ constexpr auto PACKAGES_SYNC_CONFIG_STATEMENT
         "component":"syscollector_packages",
         "index":"item_id",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE item_id BETWEEN '?' and '?' ORDER BY item_id",
                 "column_list":["*"],
@@ -450,6 +474,8 @@ constexpr auto PROCESSES_SYNC_CONFIG_STATEMENT
         "component":"syscollector_processes",
         "index":"pid",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE pid BETWEEN '?' and '?' ORDER BY pid",
                 "column_list":["*"],
@@ -514,6 +540,14 @@ constexpr auto PROCESSES_SQL_STATEMENT
     PRIMARY KEY (pid)) WITHOUT ROWID;)"
 };
 
+// Columns of dbsync_processes, the only process fields read from the system.
+static const std::set<std::string> PROCESSES_FIELDS
+{
+    "pid", "name", "state", "ppid", "utime", "stime", "cmd", "argvs", "euser", "ruser", "suser", "egroup", "rgroup",
+    "sgroup", "fgroup", "priority", "nice", "size", "vm_size", "resident", "share", "start_time", "pgrp", "session",
+    "nlwp", "tgid", "tty", "processor"
+};
+
 constexpr auto PORTS_START_CONFIG_STATEMENT
 {
     R"({"table":"dbsync_ports",
@@ -557,6 +591,8 @@ constexpr auto PORTS_SYNC_CONFIG_STATEMENT
         "component":"syscollector_ports",
         "index":"item_id",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE item_id BETWEEN '?' and '?' ORDER BY item_id",
                 "column_list":["*"],
@@ -649,6 +685,8 @@ constexpr auto NETIFACE_SYNC_CONFIG_STATEMENT
         "component":"syscollector_network_iface",
         "index":"item_id",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE item_id BETWEEN '?' and '?' ORDER BY item_id",
                 "column_list":["*"],
@@ -744,6 +782,8 @@ constexpr auto NETPROTO_SYNC_CONFIG_STATEMENT
         "component":"syscollector_network_protocol",
         "index":"item_id",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE item_id BETWEEN '?' and '?' ORDER BY item_id",
                 "column_list":["*"],
@@ -830,6 +870,8 @@ constexpr auto NETADDRESS_SYNC_CONFIG_STATEMENT
         "component":"syscollector_network_address",
         "index":"item_id",
         "checksum_field":"checksum",
+        "change_tracking":true,
+        "single_pass_split":true,
         "no_data_query_json": {
                 "row_filter":"WHERE item_id BETWEEN '?' and '?' ORDER BY item_id",
                 "column_list":["*"],
@@ -883,6 +925,20 @@ constexpr auto PROCESSES_TABLE    { "dbsync_processes"        };
 constexpr auto OS_TABLE           { "dbsync_osinfo"           };
 constexpr auto HW_TABLE           { "dbsync_hwinfo"           };
 
+// Sync id of each table, rsync is told about their row changes to skip the scan of the unchanged ones.
+static const std::map<std::string, std::string> SYNC_IDS
+{
+    { NET_IFACE_TABLE,    "syscollector_network_iface"    },
+    { NET_PROTOCOL_TABLE, "syscollector_network_protocol" },
+    { NET_ADDRESS_TABLE,  "syscollector_network_address"  },
+    { PACKAGES_TABLE,     "syscollector_packages"         },
+    { HOTFIXES_TABLE,     "syscollector_hotfixes"         },
+    { PORTS_TABLE,        "syscollector_ports"            },
+    { PROCESSES_TABLE,    "syscollector_processes"        },
+    { OS_TABLE,           "syscollector_osinfo"           },
+    { HW_TABLE,           "syscollector_hwinfo"           },
+};
+
 
 static std::string getItemId(const nlohmann::json& item, const std::vector<std::string>& idFields)
 {
@@ -894,25 +950,58 @@ static std::string getItemId(const nlohmann::json& item, const std::vector<std::
 
         if (value.is_string())
         {
-            const auto& valueString{value.get<std::string>()};
+            const auto& valueString{value.get_ref<const std::string&>()};
             hash.update(valueString.c_str(), valueString.size());
         }
         else
         {
-            const auto& valueNumber{value.get<unsigned long>()};
-            const auto valueString{std::to_string(valueNumber)};
-            hash.update(valueString.c_str(), valueString.size());
+            // Same digits std::to_string would print, written backwards into a stack buffer.
+            auto valueNumber{value.get<unsigned long>()};
+            char buffer[std::numeric_limits<unsigned long>::digits10 + 1];
+            auto begin{std::end(buffer)};
+
+            do
+            {
+                *--begin = static_cast<char>('0' + valueNumber % 10);
+                valueNumber /= 10;
+            }
+            while (valueNumber);
+
+            hash.update(begin, static_cast<size_t>(std::end(buffer) - begin));
         }
     }
 
     return Utils::asciiToHex(hash.hash());
 }
 
+// Serializer output that feeds the hash directly instead of building the dumped string.
+class HashOutputAdapter final : public nlohmann::detail::output_adapter_protocol<char>
+{
+    public:
+        explicit HashOutputAdapter(Utils::HashData& hash)
+            : m_hash{ hash }
+        {}
+        void write_character(char c) override
+        {
+            m_hash.update(&c, 1);
+        }
+        void write_characters(const char* s, std::size_t length) override
+        {
+            m_hash.update(s, length);
+        }
+    private:
+        Utils::HashData& m_hash;
+};
+
 static std::string getItemChecksum(const nlohmann::json& item)
 {
-    const auto content{item.dump()};
     Utils::HashData hash;
-    hash.update(content.c_str(), content.size());
+    HashOutputAdapter output{hash};
+    // Non owning pointer to the stack adapter, the aliasing constructor doesn't allocate a control block.
+    const nlohmann::detail::output_adapter_t<char> spOutput{std::shared_ptr<void>{}, &output};
+    // Same bytes as item.dump(), so the checksums already stored keep matching.
+    nlohmann::detail::serializer<nlohmann::json> serializer{spOutput, ' '};
+    serializer.dump(item, false, false, 0);
     return Utils::asciiToHex(hash.hash());
 }
 
@@ -935,16 +1024,70 @@ static void removeKeysWithEmptyValue(nlohmann::json& input)
     }
 }
 
-static bool isElementDuplicated(const nlohmann::json& input, const std::pair<std::string, std::string>& keyValue)
+void Syscollector::reportDelta(const std::string& table, const std::string& operation, nlohmann::json data)
+{
+    data["scan_time"] = m_scanTime;
+    removeKeysWithEmptyValue(data);
+
+    if (m_deltaBatchSize <= 1)
+    {
+        nlohmann::json msg;
+        msg["type"] = table;
+        msg["operation"] = operation;
+        msg["data"] = std::move(data);
+        const auto msgToSend{msg.dump()};
+        m_reportDiffFunction(msgToSend);
+        m_logFunction(LOG_DEBUG_VERBOSE, "Delta sent: " + msgToSend);
+        return;
+    }
+
+    nlohmann::json item;
+    item["operation"] = operation;
+    item["data"] = std::move(data);
+    const auto itemString{item.dump()};
+
+    // The deltas of a table keep their order, the scans of other tables may run at once.
+    std::lock_guard<std::mutex> lock{m_deltaBatchesMutex};
+    auto& batch{m_deltaBatches[table]};
+
+    if (batch.count && batch.items.size() + itemString.size() + 1 > DELTA_BATCH_MAX_SIZE)
+    {
+        sendDeltaBatch(table, batch);
+    }
+
+    if (batch.count)
+    {
+        batch.items += ',';
+    }
+
+    batch.items += itemString;
+
+    if (++batch.count >= m_deltaBatchSize)
+    {
+        sendDeltaBatch(table, batch);
+    }
+}
+
+void Syscollector::sendDeltaBatch(const std::string& table, DeltaBatch& batch)
 {
-    const auto it
+    const auto msgToSend{R"({"type":")" + table + R"(","batch":[)" + batch.items + "]}"};
+    m_reportDiffFunction(msgToSend);
+    m_logFunction(LOG_DEBUG_VERBOSE, "Deltas sent: " + msgToSend);
+    batch.items.clear();
+    batch.count = 0;
+}
+
+void Syscollector::flushDeltas()
+{
+    std::lock_guard<std::mutex> lock{m_deltaBatchesMutex};
+
+    for (auto& [table, batch] : m_deltaBatches)
     {
-        std::find_if (input.begin(), input.end(), [&keyValue](const auto & elem)
+        if (batch.count)
         {
-            return elem.at(keyValue.first) == keyValue.second;
-        })
-    };
-    return it != input.end();
+            sendDeltaBatch(table, batch);
+        }
+    }
 }
 
 void Syscollector::notifyChange(ReturnTypeCallback result, const nlohmann::json& data, const std::string& table)
@@ -952,36 +1095,27 @@ void Syscollector::notifyChange(ReturnTypeCallback result, const nlohmann::json&
     if (DB_ERROR == result)
     {
         m_logFunction(LOG_ERROR, data.dump());
+        return;
     }
-    else if (m_notify && !m_stopping)
+
+    if (INSERTED == result || MODIFIED == result || DELETED == result)
+    {
+        m_spRsync->notifyRowChange(SYNC_IDS.at(table), result, data);
+    }
+
+    if (m_notify && !m_stopping)
     {
         if (data.is_array())
         {
             for (const auto& item : data)
             {
-                nlohmann::json msg;
-                msg["type"] = table;
-                msg["operation"] = OPERATION_MAP.at(result);
-                msg["data"] = item;
-                msg["data"]["scan_time"] = m_scanTime;
-                removeKeysWithEmptyValue(msg["data"]);
-                const auto msgToSend{msg.dump()};
-                m_reportDiffFunction(msgToSend);
-                m_logFunction(LOG_DEBUG_VERBOSE, "Delta sent: " + msgToSend);
+                reportDelta(table, OPERATION_MAP.at(result), item);
             }
         }
         else
         {
             // LCOV_EXCL_START
-            nlohmann::json msg;
-            msg["type"] = table;
-            msg["operation"] = OPERATION_MAP.at(result);
-            msg["data"] = data;
-            msg["data"]["scan_time"] = m_scanTime;
-            removeKeysWithEmptyValue(msg["data"]);
-            const auto msgToSend{msg.dump()};
-            m_reportDiffFunction(msgToSend);
-            m_logFunction(LOG_DEBUG_VERBOSE, "Delta sent: " + msgToSend);
+            reportDelta(table, OPERATION_MAP.at(result), data);
             // LCOV_EXCL_STOP
         }
     }
@@ -1023,6 +1157,11 @@ Syscollector::Syscollector()
     , m_portsAll { false }
     , m_processes { false }
     , m_hotfixes { false }
+    , m_processesIncremental { false }
+    , m_lazyInventoryTtl { 0 }
+    , m_scanThreads { 1 }
+    , m_backoff { 1 }
+    , m_deltaBatchSize { 0 }
     , m_stopping { true }
     , m_notify { false }
 {}
@@ -1167,7 +1306,12 @@ void Syscollector::init(const std::shared_ptr<ISysInfo>& spInfo,
                         const bool portsAll,
                         const bool processes,
                         const bool hotfixes,
-                        const bool notifyOnFirstScan)
+                        const bool notifyOnFirstScan,
+                        const bool processesIncremental,
+                        const unsigned int lazyInventoryTtl,
+                        const unsigned int scanThreads,
+                        const SyscollectorSchedule& schedule,
+                        const unsigned int deltaBatchSize)
 {
     m_spInfo = spInfo;
     m_reportDiffFunction = reportDiffFunction;
@@ -1184,6 +1328,16 @@ void Syscollector::init(const std::shared_ptr<ISysInfo>& spInfo,
     m_processes = processes;
     m_hotfixes = hotfixes;
     m_notify = notifyOnFirstScan;
+    m_processesIncremental = processesIncremental;
+    m_lazyInventoryTtl = lazyInventoryTtl;
+    m_scanThreads = scanThreads;
+    m_schedule = schedule;
+    m_backoff = 1;
+    m_deltaBatchSize = deltaBatchSize;
+    m_deltaBatches.clear();
+    m_packagesFingerprint = nlohmann::json();
+    m_hardwareInventory = LazyInventory();
+    m_osInventory = LazyInventory();
 
     std::unique_lock<std::mutex> lock{m_mutex};
     m_stopping = false;
@@ -1202,6 +1356,23 @@ void Syscollector::destroy()
     lock.unlock();
 }
 
+bool Syscollector::lazyInventoryOutdated(const LazyInventory& inventory, const nlohmann::json& fingerprint) const
+{
+    return !inventory.valid ||
+           inventory.fingerprint != fingerprint ||
+           std::chrono::steady_clock::now() - inventory.time >= std::chrono::seconds{m_lazyInventoryTtl} ||
+           inventory.bootId != m_spInfo->bootId();
+}
+
+void Syscollector::lazyInventoryUpdate(LazyInventory& inventory, nlohmann::json data, nlohmann::json fingerprint)
+{
+    inventory.valid = true;
+    inventory.data = std::move(data);
+    inventory.bootId = m_spInfo->bootId();
+    inventory.fingerprint = std::move(fingerprint);
+    inventory.time = std::chrono::steady_clock::now();
+}
+
 nlohmann::json Syscollector::getHardwareData()
 {
     nlohmann::json ret;
@@ -1215,8 +1386,36 @@ void Syscollector::scanHardware()
     if (m_hardware)
     {
         m_logFunction(LOG_DEBUG_VERBOSE, "Starting hardware scan");
-        const auto& hwData{getHardwareData()};
+        const auto cached { m_lazyInventoryTtl && !lazyInventoryOutdated(m_hardwareInventory, nlohmann::json()) };
+        nlohmann::json hwData;
+
+        if (cached)
+        {
+            // Only the memory figures change while the host is up.
+            hwData[0] = m_hardwareInventory.data;
+            const auto memory = m_spInfo->memory();
+
+            if (memory.is_object())
+            {
+                hwData[0].update(memory);
+            }
+
+            hwData[0]["checksum"] = getItemChecksum(hwData[0]);
+        }
+        else
+        {
+            hwData = getHardwareData();
+        }
+
         updateChanges(HW_TABLE, hwData);
+
+        if (m_lazyInventoryTtl && !cached)
+        {
+            auto data = hwData[0];
+            data.erase("checksum");
+            lazyInventoryUpdate(m_hardwareInventory, std::move(data), nlohmann::json());
+        }
+
         m_logFunction(LOG_DEBUG_VERBOSE, "Ending hardware scan");
     }
 }
@@ -1238,9 +1437,29 @@ void Syscollector::scanOs()
 {
     if (m_os)
     {
+        nlohmann::json fingerprint;
+
+        if (m_lazyInventoryTtl)
+        {
+            // An upgrade of the OS goes through the package manager.
+            fingerprint = m_spInfo->packagesFingerprint();
+
+            if (!lazyInventoryOutdated(m_osInventory, fingerprint))
+            {
+                m_logFunction(LOG_DEBUG_VERBOSE, "OS unchanged since the last scan");
+                return;
+            }
+        }
+
         m_logFunction(LOG_DEBUG_VERBOSE, "Starting os scan");
         const auto& osData{getOSData()};
         updateChanges(OS_TABLE, osData);
+
+        if (m_lazyInventoryTtl)
+        {
+            lazyInventoryUpdate(m_osInventory, nlohmann::json(), std::move(fingerprint));
+        }
+
         m_logFunction(LOG_DEBUG_VERBOSE, "Ending os scan");
     }
 }
@@ -1253,7 +1472,6 @@ void Syscollector::syncOs()
 nlohmann::json Syscollector::getNetworkData()
 {
     nlohmann::json ret;
-    const auto& networks { m_spInfo->networks() };
     nlohmann::json ifaceTableDataList {};
     nlohmann::json protoTableDataList {};
     nlohmann::json addressTableDataList {};
@@ -1265,90 +1483,85 @@ nlohmann::json Syscollector::getNetworkData()
         { IPV6, "ipv6" }
     };
 
-    if (!networks.is_null())
+    m_spInfo->networks([&](const nlohmann::json & item)
     {
-        const auto& itIface { networks.find("iface") };
-
-        if (networks.end() != itIface)
+        // Split the resulting networks data into the specific DB tables
+        // "dbsync_network_iface" table data to update and notify
+        nlohmann::json ifaceTableData {};
+        ifaceTableData["name"]       = item.at("name");
+        ifaceTableData["adapter"]    = item.at("adapter");
+        ifaceTableData["type"]       = item.at("type");
+        ifaceTableData["state"]      = item.at("state");
+        ifaceTableData["mtu"]        = item.at("mtu");
+        ifaceTableData["mac"]        = item.at("mac");
+        ifaceTableData["tx_packets"] = item.at("tx_packets");
+        ifaceTableData["rx_packets"] = item.at("rx_packets");
+        ifaceTableData["tx_errors"]  = item.at("tx_errors");
+        ifaceTableData["rx_errors"]  = item.at("rx_errors");
+        ifaceTableData["tx_bytes"]   = item.at("tx_bytes");
+        ifaceTableData["rx_bytes"]   = item.at("rx_bytes");
+        ifaceTableData["tx_dropped"] = item.at("tx_dropped");
+        ifaceTableData["rx_dropped"] = item.at("rx_dropped");
+        ifaceTableData["checksum"]   = getItemChecksum(ifaceTableData);
+        ifaceTableData["item_id"]    = getItemId(ifaceTableData, NETIFACE_ITEM_ID_FIELDS);
+        ifaceTableDataList.push_back(std::move(ifaceTableData));
+
+
+        if (item.find("IPv4") != item.end())
         {
-            for (const auto& item : itIface.value())
-            {
-                // Split the resulting networks data into the specific DB tables
-                // "dbsync_network_iface" table data to update and notify
-                nlohmann::json ifaceTableData {};
-                ifaceTableData["name"]       = item.at("name");
-                ifaceTableData["adapter"]    = item.at("adapter");
-                ifaceTableData["type"]       = item.at("type");
-                ifaceTableData["state"]      = item.at("state");
-                ifaceTableData["mtu"]        = item.at("mtu");
-                ifaceTableData["mac"]        = item.at("mac");
-                ifaceTableData["tx_packets"] = item.at("tx_packets");
-                ifaceTableData["rx_packets"] = item.at("rx_packets");
-                ifaceTableData["tx_errors"]  = item.at("tx_errors");
-                ifaceTableData["rx_errors"]  = item.at("rx_errors");
-                ifaceTableData["tx_bytes"]   = item.at("tx_bytes");
-                ifaceTableData["rx_bytes"]   = item.at("rx_bytes");
-                ifaceTableData["tx_dropped"] = item.at("tx_dropped");
-                ifaceTableData["rx_dropped"] = item.at("rx_dropped");
-                ifaceTableData["checksum"]   = getItemChecksum(ifaceTableData);
-                ifaceTableData["item_id"]    = getItemId(ifaceTableData, NETIFACE_ITEM_ID_FIELDS);
-                ifaceTableDataList.push_back(std::move(ifaceTableData));
-
-
-                if (item.find("IPv4") != item.end())
-                {
 
-                    // "dbsync_network_protocol" table data to update and notify
-                    nlohmann::json protoTableData {};
-                    protoTableData["iface"]   = item.at("name");
-                    protoTableData["gateway"] = item.at("gateway");
-                    protoTableData["type"]    = IP_TYPE.at(IPV4);
-                    protoTableData["dhcp"]    = item.at("IPv4").begin()->at("dhcp");
-                    protoTableData["metric"]  = item.at("IPv4").begin()->at("metric");
-                    protoTableData["checksum"]  = getItemChecksum(protoTableData);
-                    protoTableData["item_id"]   = getItemId(protoTableData, NETPROTO_ITEM_ID_FIELDS);
-                    protoTableDataList.push_back(std::move(protoTableData));
-
-                    for (auto addressTableData : item.at("IPv4"))
-                    {
-                        // "dbsync_network_address" table data to update and notify
-                        addressTableData["iface"]     = item.at("name");
-                        addressTableData["proto"]     = IPV4;
-                        addressTableData["checksum"]  = getItemChecksum(addressTableData);
-                        addressTableData["item_id"]   = getItemId(addressTableData, NETADDRESS_ITEM_ID_FIELDS);
-                        addressTableDataList.push_back(std::move(addressTableData));
-                    }
-                }
-
-                if (item.find("IPv6") != item.end())
-                {
-                    // "dbsync_network_protocol" table data to update and notify
-                    nlohmann::json protoTableData {};
-                    protoTableData["iface"]   = item.at("name");
-                    protoTableData["gateway"] = item.at("gateway");
-                    protoTableData["type"]    = IP_TYPE.at(IPV6);
-                    protoTableData["dhcp"]    = item.at("IPv6").begin()->at("dhcp");
-                    protoTableData["metric"]  = item.at("IPv6").begin()->at("metric");
-                    protoTableData["checksum"]  = getItemChecksum(protoTableData);
-                    protoTableData["item_id"]   = getItemId(protoTableData, NETPROTO_ITEM_ID_FIELDS);
-                    protoTableDataList.push_back(std::move(protoTableData));
-
-                    for (auto addressTableData : item.at("IPv6"))
-                    {
-                        // "dbsync_network_address" table data to update and notify
-                        addressTableData["iface"]     = item.at("name");
-                        addressTableData["proto"]     = IPV6;
-                        addressTableData["checksum"]  = getItemChecksum(addressTableData);
-                        addressTableData["item_id"]   = getItemId(addressTableData, NETADDRESS_ITEM_ID_FIELDS);
-                        addressTableDataList.push_back(std::move(addressTableData));
-                    }
-                }
+            // "dbsync_network_protocol" table data to update and notify
+            nlohmann::json protoTableData {};
+            protoTableData["iface"]   = item.at("name");
+            protoTableData["gateway"] = item.at("gateway");
+            protoTableData["type"]    = IP_TYPE.at(IPV4);
+            protoTableData["dhcp"]    = item.at("IPv4").begin()->at("dhcp");
+            protoTableData["metric"]  = item.at("IPv4").begin()->at("metric");
+            protoTableData["checksum"]  = getItemChecksum(protoTableData);
+            protoTableData["item_id"]   = getItemId(protoTableData, NETPROTO_ITEM_ID_FIELDS);
+            protoTableDataList.push_back(std::move(protoTableData));
+
+            for (auto addressTableData : item.at("IPv4"))
+            {
+                // "dbsync_network_address" table data to update and notify
+                addressTableData["iface"]     = item.at("name");
+                addressTableData["proto"]     = IPV4;
+                addressTableData["checksum"]  = getItemChecksum(addressTableData);
+                addressTableData["item_id"]   = getItemId(addressTableData, NETADDRESS_ITEM_ID_FIELDS);
+                addressTableDataList.push_back(std::move(addressTableData));
             }
+        }
 
-            ret[NET_IFACE_TABLE] = std::move(ifaceTableDataList);
-            ret[NET_PROTOCOL_TABLE] = std::move(protoTableDataList);
-            ret[NET_ADDRESS_TABLE] = std::move(addressTableDataList);
+        if (item.find("IPv6") != item.end())
+        {
+            // "dbsync_network_protocol" table data to update and notify
+            nlohmann::json protoTableData {};
+            protoTableData["iface"]   = item.at("name");
+            protoTableData["gateway"] = item.at("gateway");
+            protoTableData["type"]    = IP_TYPE.at(IPV6);
+            protoTableData["dhcp"]    = item.at("IPv6").begin()->at("dhcp");
+            protoTableData["metric"]  = item.at("IPv6").begin()->at("metric");
+            protoTableData["checksum"]  = getItemChecksum(protoTableData);
+            protoTableData["item_id"]   = getItemId(protoTableData, NETPROTO_ITEM_ID_FIELDS);
+            protoTableDataList.push_back(std::move(protoTableData));
+
+            for (auto addressTableData : item.at("IPv6"))
+            {
+                // "dbsync_network_address" table data to update and notify
+                addressTableData["iface"]     = item.at("name");
+                addressTableData["proto"]     = IPV6;
+                addressTableData["checksum"]  = getItemChecksum(addressTableData);
+                addressTableData["item_id"]   = getItemId(addressTableData, NETADDRESS_ITEM_ID_FIELDS);
+                addressTableDataList.push_back(std::move(addressTableData));
+            }
         }
+    });
+
+    if (!ifaceTableDataList.is_null())
+    {
+        ret[NET_IFACE_TABLE] = std::move(ifaceTableDataList);
+        ret[NET_PROTOCOL_TABLE] = std::move(protoTableDataList);
+        ret[NET_ADDRESS_TABLE] = std::move(addressTableDataList);
     }
 
     return ret;
@@ -1401,6 +1614,16 @@ void Syscollector::scanPackages()
     if (m_packages)
     {
         m_logFunction(LOG_DEBUG_VERBOSE, "Starting packages scan");
+
+        // The package sources are only enumerated again when their databases changed since the last scan.
+        auto fingerprint = m_spInfo->packagesFingerprint();
+
+        if (!fingerprint.empty() && fingerprint == m_packagesFingerprint)
+        {
+            m_logFunction(LOG_DEBUG_VERBOSE, "Packages unchanged since the last scan");
+            return;
+        }
+
         const auto callback
         {
             [this](ReturnTypeCallback result, const nlohmann::json & data)
@@ -1416,24 +1639,39 @@ void Syscollector::scanPackages()
             QUEUE_SIZE,
             callback
         };
-        m_spInfo->packages([this, &txn](nlohmann::json & rawData)
-        {
-            nlohmann::json input;
+        nlohmann::json input;
+        input["table"] = PACKAGES_TABLE;
+        input["data"] = nlohmann::json::array();
 
+        m_spInfo->packages([this, &txn, &input](nlohmann::json & rawData)
+        {
             rawData["checksum"] = getItemChecksum(rawData);
             rawData["item_id"] = getItemId(rawData, PACKAGES_ITEM_ID_FIELDS);
 
-            input["table"] = PACKAGES_TABLE;
             m_spNormalizer->normalize("packages", rawData);
             m_spNormalizer->removeExcluded("packages", rawData);
 
             if (!rawData.empty())
             {
-                input["data"] = nlohmann::json::array( { rawData } );
-                txn.syncTxnRow(input);
+                auto& data { input["data"] };
+                data.push_back(std::move(rawData));
+
+                // Packages are synced in batches to avoid one lookup per package in the local database.
+                if (SYNC_BATCH_SIZE <= data.size())
+                {
+                    txn.syncTxnRows(input);
+                    data.clear();
+                }
             }
         });
+
+        if (!input["data"].empty())
+        {
+            txn.syncTxnRows(input);
+        }
+
         txn.getDeletedRows(callback);
+        m_packagesFingerprint = std::move(fingerprint);
 
         m_logFunction(LOG_DEBUG_VERBOSE, "Ending packages scan");
     }
@@ -1444,16 +1682,50 @@ void Syscollector::scanHotfixes()
     if (m_hotfixes)
     {
         m_logFunction(LOG_DEBUG_VERBOSE, "Starting hotfixes scan");
-        auto hotfixes = m_spInfo->hotfixes();
+        const auto callback
+        {
+            [this](ReturnTypeCallback result, const nlohmann::json & data)
+            {
+                notifyChange(result, data, HOTFIXES_TABLE);
+            }
+        };
+        // The transaction is only opened with the first hotfix, an empty result leaves the table untouched.
+        std::unique_ptr<DBSyncTxn> spTxn;
+        nlohmann::json input;
+        input["table"] = HOTFIXES_TABLE;
+        input["data"] = nlohmann::json::array();
+
+        m_spInfo->hotfixes([this, &callback, &spTxn, &input](nlohmann::json & hotfix)
+        {
+            if (!spTxn)
+            {
+                spTxn = std::make_unique<DBSyncTxn>(m_spDBSync->handle(),
+                                                    nlohmann::json{HOTFIXES_TABLE},
+                                                    0,
+                                                    QUEUE_SIZE,
+                                                    callback);
+            }
 
-        if (!hotfixes.is_null())
+            hotfix["checksum"] = getItemChecksum(hotfix);
+
+            auto& data { input["data"] };
+            data.push_back(std::move(hotfix));
+
+            if (SYNC_BATCH_SIZE <= data.size())
+            {
+                spTxn->syncTxnRows(input);
+                data.clear();
+            }
+        });
+
+        if (spTxn)
         {
-            for (auto& hotfix : hotfixes)
+            if (!input["data"].empty())
             {
-                hotfix["checksum"] = getItemChecksum(hotfix);
+                spTxn->syncTxnRows(input);
             }
 
-            updateChanges(HOTFIXES_TABLE, hotfixes);
+            spTxn->getDeletedRows(callback);
         }
 
         m_logFunction(LOG_DEBUG_VERBOSE, "Ending hotfixes scan");
@@ -1470,76 +1742,85 @@ void Syscollector::syncHotfixes()
     m_spRsync->startSync(m_spDBSync->handle(), nlohmann::json::parse(HOTFIXES_START_CONFIG_STATEMENT), m_reportSyncFunction);
 }
 
-nlohmann::json Syscollector::getPortsData()
+void Syscollector::scanPorts()
 {
-    nlohmann::json ret;
-    constexpr auto PORT_LISTENING_STATE { "listening" };
-    constexpr auto TCP_PROTOCOL { "tcp" };
-    constexpr auto UDP_PROTOCOL { "udp" };
-    auto data(m_spInfo->ports());
-
-    if (!data.is_null())
+    if (m_ports)
     {
-        for (auto& item : data)
+        m_logFunction(LOG_DEBUG_VERBOSE, "Starting ports scan");
+        constexpr auto PORT_LISTENING_STATE { "listening" };
+        constexpr auto TCP_PROTOCOL { "tcp" };
+        constexpr auto UDP_PROTOCOL { "udp" };
+        const auto callback
+        {
+            [this](ReturnTypeCallback result, const nlohmann::json & data)
+            {
+                notifyChange(result, data, PORTS_TABLE);
+            }
+        };
+        DBSyncTxn txn
         {
-            const auto protocol { item.at("protocol").get_ref<const std::string&>() };
+            m_spDBSync->handle(),
+            nlohmann::json{PORTS_TABLE},
+            0,
+            QUEUE_SIZE,
+            callback
+        };
+        nlohmann::json input;
+        input["table"] = PORTS_TABLE;
+        input["data"] = nlohmann::json::array();
+        std::unordered_set<std::string> itemIds;
 
-            if (Utils::startsWith(protocol, TCP_PROTOCOL))
+        const auto portCallback
+        {
+            [this, &txn, &input, &itemIds](nlohmann::json & item)
             {
-                // All ports.
-                if (m_portsAll)
+                const auto& protocol { item.at("protocol").get_ref<const std::string&>() };
+                // TCP ports are reported when all the ports are requested or when they are listening.
+                const auto isReported
                 {
-                    const auto& itemId { getItemId(item, PORTS_ITEM_ID_FIELDS) };
+                    Utils::startsWith(protocol, TCP_PROTOCOL)
+                    ? m_portsAll || item.at("state") == PORT_LISTENING_STATE
+                    : Utils::startsWith(protocol, UDP_PROTOCOL)
+                };
 
-                    if (!isElementDuplicated(ret, std::make_pair("item_id", itemId)))
-                    {
-                        item["checksum"] = getItemChecksum(item);
-                        item["item_id"] = itemId;
-                        ret.push_back(item);
-                    }
-                }
-                else
+                if (isReported)
                 {
-                    // Only listening ports.
-                    const auto isListeningState { item.at("state") == PORT_LISTENING_STATE };
+                    auto itemId { getItemId(item, PORTS_ITEM_ID_FIELDS) };
 
-                    if (isListeningState)
+                    if (itemIds.insert(itemId).second)
                     {
-                        const auto& itemId { getItemId(item, PORTS_ITEM_ID_FIELDS) };
+                        item["checksum"] = getItemChecksum(item);
+                        item["item_id"] = std::move(itemId);
+
+                        auto& data { input["data"] };
+                        data.push_back(std::move(item));
 
-                        if (!isElementDuplicated(ret, std::make_pair("item_id", itemId)))
+                        if (SYNC_BATCH_SIZE <= data.size())
                         {
-                            item["checksum"] = getItemChecksum(item);
-                            item["item_id"] = itemId;
-                            ret.push_back(item);
+                            txn.syncTxnRows(input);
+                            data.clear();
                         }
                     }
                 }
             }
-            else if (Utils::startsWith(protocol, UDP_PROTOCOL))
-            {
-                const auto& itemId { getItemId(item, PORTS_ITEM_ID_FIELDS) };
+        };
 
-                if (!isElementDuplicated(ret, std::make_pair("item_id", itemId)))
-                {
-                    item["checksum"] = getItemChecksum(item);
-                    item["item_id"] = itemId;
-                    ret.push_back(item);
-                }
-            }
+        // Without all the ports only the listening ones are needed, the provider may skip the rest.
+        if (m_portsAll)
+        {
+            m_spInfo->ports(portCallback);
+        }
+        else
+        {
+            m_spInfo->listeningPorts(portCallback);
         }
-    }
 
-    return ret;
-}
+        if (!input["data"].empty())
+        {
+            txn.syncTxnRows(input);
+        }
 
-void Syscollector::scanPorts()
-{
-    if (m_ports)
-    {
-        m_logFunction(LOG_DEBUG_VERBOSE, "Starting ports scan");
-        const auto& portsData { getPortsData() };
-        updateChanges(PORTS_TABLE, portsData);
+        txn.getDeletedRows(callback);
         m_logFunction(LOG_DEBUG_VERBOSE, "Ending ports scan");
     }
 }
@@ -1569,17 +1850,53 @@ void Syscollector::scanProcesses()
             QUEUE_SIZE,
             callback
         };
-        m_spInfo->processes([&txn](nlohmann::json & rawData)
+        const auto processChanged
         {
-            nlohmann::json input;
+            [&txn](nlohmann::json & rawData)
+            {
+                nlohmann::json input;
 
-            rawData["checksum"] = getItemChecksum(rawData);
+                rawData["checksum"] = getItemChecksum(rawData);
+
+                input["table"] = PROCESSES_TABLE;
+                // The provider is done with the process, it's moved instead of copied into the row list.
+                input["data"] = nlohmann::json::array();
+                input["data"].push_back(std::move(rawData));
 
+                txn.syncTxnRow(input);
+            }
+        };
+
+        if (m_processesIncremental)
+        {
+            nlohmann::json input;
             input["table"] = PROCESSES_TABLE;
-            input["data"] = nlohmann::json::array( { rawData } );
+            input["data"] = nlohmann::json::array();
+
+            // Processes that didn't restart since the previous scan are kept without comparing them.
+            m_spInfo->processes(PROCESSES_FIELDS, processChanged, [&txn, &input](const nlohmann::json & rawData)
+            {
+                auto& data { input["data"] };
+                data.push_back(rawData);
+                data.back()["checksum"] = getItemChecksum(rawData);
+
+                if (SYNC_BATCH_SIZE <= data.size())
+                {
+                    txn.keepTxnRows(input);
+                    data.clear();
+                }
+            });
+
+            if (!input["data"].empty())
+            {
+                txn.keepTxnRows(input);
+            }
+        }
+        else
+        {
+            m_spInfo->processes(PROCESSES_FIELDS, processChanged);
+        }
 
-            txn.syncTxnRow(input);
-        });
         txn.getDeletedRows(callback);
 
         m_logFunction(LOG_DEBUG_VERBOSE, "Ending processes scan");
@@ -1591,53 +1908,208 @@ void Syscollector::syncProcesses()
     m_spRsync->startSync(m_spDBSync->handle(), nlohmann::json::parse(PROCESSES_START_CONFIG_STATEMENT), m_reportSyncFunction);
 }
 
-void Syscollector::scan()
+void Syscollector::scheduleInventories()
+{
+    // In the order they are scanned one after another
+    const std::vector<std::tuple<std::string, bool, void (Syscollector::*)(), void (Syscollector::*)()>> inventories
+    {
+        { "hardware", m_hardware, &Syscollector::scanHardware, &Syscollector::syncHardware },
+        { "os", m_os, &Syscollector::scanOs, &Syscollector::syncOs },
+        { "network", m_network, &Syscollector::scanNetwork, &Syscollector::syncNetwork },
+        { "packages", m_packages, &Syscollector::scanPackages, &Syscollector::syncPackages },
+        { "hotfixes", m_hotfixes, &Syscollector::scanHotfixes, &Syscollector::syncHotfixes },
+        { "ports", m_ports, &Syscollector::scanPorts, &Syscollector::syncPorts },
+        { "processes", m_processes, &Syscollector::scanProcesses, &Syscollector::syncProcesses }
+    };
+    const auto now { std::chrono::steady_clock::now() };
+
+    m_inventories.clear();
+
+    for (const auto& [name, enabled, scanTask, syncTask] : inventories)
+    {
+        if (!enabled)
+        {
+            continue;
+        }
+
+        const auto it { m_schedule.intervals.find(name) };
+        const std::chrono::seconds interval { it != m_schedule.intervals.end() && it->second ? it->second : m_intervalValue };
+        std::chrono::seconds delay { m_scanOnStart ? 0 : interval.count() };
+
+        // FNV-1a, so every agent keeps its delay across restarts and platforms
+        if (const auto jitter { std::min<unsigned long long>(m_schedule.jitter, interval.count()) }; jitter > 0)
+        {
+            unsigned long long hash { 14695981039346656037ull };
+
+            for (const auto c : m_schedule.jitterSeed + ":" + name)
+            {
+                hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+            }
+
+            delay += std::chrono::seconds { static_cast<std::chrono::seconds::rep>(hash % (jitter + 1)) };
+        }
+
+        m_inventories.push_back({ name, scanTask, syncTask, interval, now + delay, false });
+    }
+}
+
+void Syscollector::scan(const std::vector<ScheduledInventory*>& inventories)
 {
     m_logFunction(LOG_INFO, "Starting evaluation.");
     m_scanTime = Utils::getCurrentTimestamp();
 
-    TRY_CATCH_TASK(scanHardware);
-    TRY_CATCH_TASK(scanOs);
-    TRY_CATCH_TASK(scanNetwork);
-    TRY_CATCH_TASK(scanPackages);
-    TRY_CATCH_TASK(scanHotfixes);
-    TRY_CATCH_TASK(scanPorts);
-    TRY_CATCH_TASK(scanProcesses);
-    m_notify = true;
+    std::vector<std::function<void()>> tasks;
+
+    for (const auto inventory : inventories)
+    {
+        tasks.push_back([this, inventory]()
+        {
+            const auto task { [this, inventory]() { (this->*inventory->scan)(); } };
+            TRY_CATCH_TASK(task);
+        });
+    }
+
+    if (m_scanThreads > 1 && tasks.size() > 1)
+    {
+        // Each inventory has its own tables and its own dbsync transaction, so they can run at once.
+        // The slowest ones are the last of the sequential order, so they are taken first.
+        std::atomic<size_t> next { 0 };
+        std::vector<std::thread> workers;
+
+        for (auto i { std::min<size_t>(m_scanThreads, tasks.size()) }; i > 0; --i)
+        {
+            workers.emplace_back([&tasks, &next]()
+            {
+                for (auto task { next++ }; task < tasks.size(); task = next++)
+                {
+                    tasks[tasks.size() - task - 1]();
+                }
+            });
+        }
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+    else
+    {
+        for (const auto& task : tasks)
+        {
+            task();
+        }
+    }
+
+    flushDeltas();
+
+    for (const auto inventory : inventories)
+    {
+        inventory->scanned = true;
+    }
+
+    // The changes are notified once every inventory has its first scan
+    m_notify = m_notify || std::all_of(m_inventories.begin(), m_inventories.end(), [](const ScheduledInventory & inventory)
+    {
+        return inventory.scanned;
+    });
     m_logFunction(LOG_INFO, "Evaluation finished.");
 }
 
-void Syscollector::sync()
+void Syscollector::sync(const std::vector<ScheduledInventory*>& inventories)
 {
     m_logFunction(LOG_DEBUG, "Starting syscollector sync");
-    TRY_CATCH_TASK(syncHardware);
-    TRY_CATCH_TASK(syncOs);
-    TRY_CATCH_TASK(syncNetwork);
-    TRY_CATCH_TASK(syncPackages);
-    TRY_CATCH_TASK(syncHotfixes);
-    TRY_CATCH_TASK(syncPorts);
-    TRY_CATCH_TASK(syncProcesses);
+
+    for (const auto inventory : inventories)
+    {
+        const auto task { [this, inventory]() { (this->*inventory->sync)(); } };
+        TRY_CATCH_TASK(task);
+    }
+
     m_logFunction(LOG_DEBUG, "Ending syscollector sync");
 }
 
-void Syscollector::syncLoop(std::unique_lock<std::mutex>& lock)
+void Syscollector::updateBackoff()
 {
-    m_logFunction(LOG_INFO, "Module started.");
+    if (!m_schedule.pressure)
+    {
+        return;
+    }
 
-    if (m_scanOnStart)
+    const auto previous { m_backoff };
+
+    if (m_schedule.pressure())
+    {
+        m_backoff = std::min(m_backoff * 2, std::max(m_schedule.maxBackoff, 1u));
+    }
+    else
     {
-        scan();
-        sync();
+        m_backoff = std::max(m_backoff / 2, 1u);
     }
 
-    while (!m_cv.wait_for(lock, std::chrono::seconds{m_intervalValue}, [&]()
+    if (m_backoff != previous)
+    {
+        m_logFunction(LOG_DEBUG, "The scan intervals are stretched " + std::to_string(m_backoff) + " times.");
+    }
+}
+
+void Syscollector::syncLoop(std::unique_lock<std::mutex>& lock)
 {
-    return m_stopping;
-}))
+    m_logFunction(LOG_INFO, "Module started.");
+
+    scheduleInventories();
+
+    while (!m_stopping)
+    {
+        if (m_inventories.empty())
+        {
+            m_cv.wait(lock, [&]()
+            {
+                return m_stopping;
+            });
+            break;
+        }
+
+        auto next { m_inventories.front().next };
+
+        for (const auto& inventory : m_inventories)
+        {
+            next = std::min(next, inventory.next);
+        }
+
+        if (m_cv.wait_until(lock, next, [&]()
     {
-        scan();
-        sync();
+        return m_stopping;
+    }))
+        {
+            break;
+        }
+
+        std::vector<ScheduledInventory*> due;
+        const auto now { std::chrono::steady_clock::now() };
+
+        for (auto& inventory : m_inventories)
+        {
+            if (inventory.next <= now)
+            {
+                due.push_back(&inventory);
+            }
+        }
+
+        if (due.empty())
+        {
+            continue;
+        }
+
+        scan(due);
+        sync(due);
+        updateBackoff();
+
+        for (const auto inventory : due)
+        {
+            inventory->next = std::chrono::steady_clock::now() + inventory->interval * m_backoff;
+        }
     }
+
     m_spRsync.reset(nullptr);
     m_spDBSync.reset(nullptr);
 }
@@ -15,8 +15,8 @@
 
 SysNormalizer::SysNormalizer(const std::string& configFile,
                              const std::string& target)
-    : m_typeExclusions{getTypeValues(configFile, target, "exclusions")}
-    , m_typeDictionary{getTypeValues(configFile, target, "dictionary")}
+    : m_typeExclusions{compileExclusions(getTypeValues(configFile, target, "exclusions"))}
+    , m_typeDictionary{compileDictionary(getTypeValues(configFile, target, "dictionary"))}
 {
 }
 
@@ -27,30 +27,31 @@ void SysNormalizer::removeExcluded(const std::string& type,
 
     if (exclusionsIt != m_typeExclusions.cend())
     {
-        for (const auto& exclusionItem : exclusionsIt->second)
+        for (const auto& exclusion : exclusionsIt->second)
         {
             try
             {
-                std::regex pattern{exclusionItem["pattern"].get_ref<const std::string&>()};
-                const auto& fieldName{exclusionItem["field_name"].get_ref<const std::string&>()};
-
                 if (data.is_array())
                 {
-                    for (auto item{data.begin()}; item != data.end(); ++item)
+                    for (auto item{data.begin()}; item != data.end();)
                     {
-                        const auto fieldIt{item->find(fieldName)};
+                        const auto fieldIt{item->find(exclusion.fieldName)};
 
-                        if (fieldIt != item->end() && std::regex_match(fieldIt->get_ref<const std::string&>(), pattern))
+                        if (fieldIt != item->end() && std::regex_match(fieldIt->get_ref<const std::string&>(), exclusion.pattern))
+                        {
+                            item = data.erase(item);
+                        }
+                        else
                         {
-                            data.erase(item);
+                            ++item;
                         }
                     }
                 }
                 else
                 {
-                    const auto fieldIt{data.find(fieldName)};
+                    const auto fieldIt{data.find(exclusion.fieldName)};
 
-                    if (fieldIt != data.end() && std::regex_match(fieldIt->get_ref<const std::string&>(), pattern))
+                    if (fieldIt != data.end() && std::regex_match(fieldIt->get_ref<const std::string&>(), exclusion.pattern))
                     {
                         data.clear();
                     }
@@ -66,53 +67,36 @@ void SysNormalizer::removeExcluded(const std::string& type,
 }
 
 
-static void normalizeItem(const nlohmann::json& dictionary,
-                          nlohmann::json& item)
+void SysNormalizer::normalizeItem(const std::vector<DictionaryRule>& dictionary,
+                                  nlohmann::json& item)
 {
-    for (const auto& dictItem : dictionary)
+    for (const auto& rule : dictionary)
     {
-        const auto itFindPattern{dictItem.find("find_pattern")};
-        const auto itFindField{dictItem.find("find_field")};
-
-        if (itFindPattern != dictItem.end() && itFindField != dictItem.end())
+        if (rule.hasFind)
         {
-            const auto fieldIt{item.find(itFindField->get_ref<const std::string&>())};
-            std::regex pattern{itFindPattern->get_ref<const std::string&>()};
+            const auto fieldIt{item.find(rule.findField)};
 
             if (fieldIt == item.end() ||
-                    !std::regex_match(fieldIt->get_ref<const std::string&>(), pattern))
+                    !std::regex_match(fieldIt->get_ref<const std::string&>(), rule.findPattern))
             {
                 //no field in the item or no matching, we continue
                 continue;
             }
         }
-        else if (itFindPattern != dictItem.end() || itFindField != dictItem.end())
-        {
-            //we won't evaluate an incomplete item.
-            continue;
-        }
 
-        const auto itReplacePattern{dictItem.find("replace_pattern")};
-        const auto itReplaceField{dictItem.find("replace_field")};
-        const auto itReplaceValue{dictItem.find("replace_value")};
-
-        if (itReplacePattern != dictItem.end() && itReplaceField != dictItem.end() && itReplaceValue != dictItem.end())
+        if (rule.hasReplace)
         {
-            std::regex pattern{itReplacePattern->get_ref<const std::string&>()};
-            const auto fieldIt{item.find(itReplaceField->get_ref<const std::string&>())};
+            const auto fieldIt{item.find(rule.replaceField)};
 
             if (fieldIt != item.end())
             {
-                *fieldIt = std::regex_replace(fieldIt->get_ref<const std::string&>(), pattern, itReplaceValue->get_ref<const std::string&>());
+                *fieldIt = std::regex_replace(fieldIt->get_ref<const std::string&>(), rule.replacePattern, rule.replaceValue);
             }
         }
 
-        const auto itAddField{dictItem.find("add_field")};
-        const auto itAddValue{dictItem.find("add_value")};
-
-        if (itAddField != dictItem.end() && itAddValue != dictItem.end())
+        if (rule.hasAdd)
         {
-            item[itAddField->get_ref<const std::string&>()] = itAddValue->get_ref<const std::string&>();
+            item[rule.addField] = rule.addValue;
         }
     }
 }
@@ -126,6 +110,7 @@ void SysNormalizer::normalize(const std::string& type,
     {
         if (data.is_array())
         {
+            // Batches of items are normalized with a single lookup of the rules of their type.
             for (auto& item : data)
             {
                 normalizeItem(dictionaryIt->second, item);
@@ -138,6 +123,98 @@ void SysNormalizer::normalize(const std::string& type,
     }
 }
 
+SysNormalizer::Exclusions SysNormalizer::compileExclusions(const std::map<std::string, nlohmann::json>& typeValues)
+{
+    Exclusions ret;
+
+    for (const auto& typeValue : typeValues)
+    {
+        auto& exclusions{ret[typeValue.first]};
+
+        for (const auto& exclusionItem : typeValue.second)
+        {
+            try
+            {
+                exclusions.push_back(Exclusion
+                {
+                    exclusionItem.at("field_name").get<std::string>(),
+                    std::regex{exclusionItem.at("pattern").get_ref<const std::string&>()}
+                });
+            }
+            // LCOV_EXCL_START
+            catch (...)
+            {}
+
+            // LCOV_EXCL_STOP
+        }
+    }
+
+    return ret;
+}
+
+SysNormalizer::Dictionary SysNormalizer::compileDictionary(const std::map<std::string, nlohmann::json>& typeValues)
+{
+    Dictionary ret;
+
+    for (const auto& typeValue : typeValues)
+    {
+        auto& dictionary{ret[typeValue.first]};
+
+        for (const auto& dictItem : typeValue.second)
+        {
+            const auto itFindPattern{dictItem.find("find_pattern")};
+            const auto itFindField{dictItem.find("find_field")};
+            const auto itReplacePattern{dictItem.find("replace_pattern")};
+            const auto itReplaceField{dictItem.find("replace_field")};
+            const auto itReplaceValue{dictItem.find("replace_value")};
+            const auto itAddField{dictItem.find("add_field")};
+            const auto itAddValue{dictItem.find("add_value")};
+
+            DictionaryRule rule{};
+            rule.hasFind = itFindPattern != dictItem.end() && itFindField != dictItem.end();
+            rule.hasReplace = itReplacePattern != dictItem.end() && itReplaceField != dictItem.end() && itReplaceValue != dictItem.end();
+            rule.hasAdd = itAddField != dictItem.end() && itAddValue != dictItem.end();
+
+            if (!rule.hasFind && (itFindPattern != dictItem.end() || itFindField != dictItem.end()))
+            {
+                //we won't evaluate an incomplete item.
+                continue;
+            }
+
+            try
+            {
+                if (rule.hasFind)
+                {
+                    rule.findField = itFindField->get<std::string>();
+                    rule.findPattern = std::regex{itFindPattern->get_ref<const std::string&>()};
+                }
+
+                if (rule.hasReplace)
+                {
+                    rule.replaceField = itReplaceField->get<std::string>();
+                    rule.replacePattern = std::regex{itReplacePattern->get_ref<const std::string&>()};
+                    rule.replaceValue = itReplaceValue->get<std::string>();
+                }
+
+                if (rule.hasAdd)
+                {
+                    rule.addField = itAddField->get<std::string>();
+                    rule.addValue = itAddValue->get<std::string>();
+                }
+
+                dictionary.push_back(std::move(rule));
+            }
+            // LCOV_EXCL_START
+            catch (...)
+            {}
+
+            // LCOV_EXCL_STOP
+        }
+    }
+
+    return ret;
+}
+
 std::map<std::string, nlohmann::json> SysNormalizer::getTypeValues(const std::string& configFile,
                                                                    const std::string& target,
                                                                    const std::string& type)
@@ -8,7 +8,9 @@
  * License (version 2) as published by the FSF - Free Software
  * Foundation.
  */
+#include <atomic>
 #include <cstdio>
+#include <future>
 #include "syscollectorImp_test.h"
 #include "syscollector.hpp"
 
@@ -29,9 +31,16 @@ class SysInfoWrapper: public ISysInfo
     public:
         SysInfoWrapper() = default;
         ~SysInfoWrapper() = default;
+        using ISysInfo::processes;
+        using ISysInfo::ports;
+        using ISysInfo::networks;
+        using ISysInfo::hotfixes;
         MOCK_METHOD(nlohmann::json, hardware, (), (override));
         MOCK_METHOD(nlohmann::json, packages, (), (override));
         MOCK_METHOD(void, packages, (std::function<void(nlohmann::json&)>), (override));
+        MOCK_METHOD(nlohmann::json, packagesFingerprint, (), (override));
+        MOCK_METHOD(nlohmann::json, memory, (), (override));
+        MOCK_METHOD(std::string, bootId, (), (override));
         MOCK_METHOD(nlohmann::json, os, (), (override));
         MOCK_METHOD(nlohmann::json, networks, (), (override));
         MOCK_METHOD(nlohmann::json, processes, (), (override));
@@ -2327,3 +2336,411 @@ TEST_F(SyscollectorImpTest, PackagesDuplicated)
         t.join();
     }
 }
+
+TEST_F(SyscollectorImpTest, PackagesUnchangedFingerprint)
+{
+    const auto spInfoWrapper{std::make_shared<SysInfoWrapper>()};
+
+    EXPECT_CALL(*spInfoWrapper, packagesFingerprint())
+    .Times(::testing::AtLeast(2))
+    .WillRepeatedly(Return(R"({"dpkg":"550121:707688:1759619900.0"})"_json));
+    EXPECT_CALL(*spInfoWrapper, packages(_))
+    .Times(1)
+    .WillOnce(::testing::InvokeArgument<0>
+              (R"({"architecture":"amd64","scan_time":"2020/12/28 21:49:50", "group":"x11","name":"xserver-xorg","priority":"optional","size":411,"source":"xorg","version":"1:7.7+19ubuntu14","format":"deb","location":" "})"_json));
+
+    CallbackMock wrapper;
+    std::function<void(const std::string&)> callbackData
+    {
+        [&wrapper](const std::string & data)
+        {
+            auto delta = nlohmann::json::parse(data);
+            delta["data"].erase("checksum");
+            delta["data"].erase("scan_time");
+            wrapper.callbackMock(delta.dump());
+        }
+    };
+
+    const auto expectedResult1
+    {
+        R"({"data":{"architecture":"amd64","format":"deb","group":"x11","item_id":"285901cb705fc0883ff04197e730c429dcc77e99","location":" ","name":"xserver-xorg","priority":"optional","size":411,"source":"xorg","version":"1:7.7+19ubuntu14"},"operation":"INSERTED","type":"dbsync_packages"})"
+    };
+
+    EXPECT_CALL(wrapper, callbackMock(expectedResult1)).Times(1);
+    std::thread t
+    {
+        [&spInfoWrapper, &callbackData]()
+        {
+            Syscollector::instance().init(spInfoWrapper,
+                                          callbackData,
+                                          reportFunction,
+                                          logFunction,
+                                          SYSCOLLECTOR_DB_PATH,
+                                          "",
+                                          "",
+                                          1, true, false, false, false, true, false, false, false, false, true);
+        }
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{2500});
+    Syscollector::instance().destroy();
+
+    if (t.joinable())
+    {
+        t.join();
+    }
+}
+
+TEST_F(SyscollectorImpTest, LazyHardwareInventory)
+{
+    const auto spInfoWrapper{std::make_shared<SysInfoWrapper>()};
+
+    EXPECT_CALL(*spInfoWrapper, hardware()).Times(1).WillOnce(Return(nlohmann::json::parse(
+                                                                          R"({"board_serial":"Intel Corporation","cpu_MHz":2904,"cpu_cores":2,"cpu_name":"Intel(R) Core(TM) i5-9400 CPU @ 2.90GHz", "ram_free":2257872,"ram_total":4972208,"ram_usage":54})")));
+    EXPECT_CALL(*spInfoWrapper, memory())
+    .Times(::testing::AtLeast(1))
+    .WillRepeatedly(Return(R"({"ram_free":1000,"ram_total":4972208,"ram_usage":99})"_json));
+    EXPECT_CALL(*spInfoWrapper, bootId()).WillRepeatedly(Return("c1d4a7b2-0a33-4c8e-9a35-2b1f39e7c1d4"));
+
+    CallbackMock wrapper;
+    std::function<void(const std::string&)> callbackData
+    {
+        [&wrapper](const std::string & data)
+        {
+            const auto delta = nlohmann::json::parse(data);
+            wrapper.callbackMock(delta.at("operation").get<std::string>() + ":" + delta.at("data").at("ram_free").dump());
+        }
+    };
+
+    EXPECT_CALL(wrapper, callbackMock("INSERTED:2257872")).Times(1);
+    EXPECT_CALL(wrapper, callbackMock("MODIFIED:1000")).Times(1);
+    std::thread t
+    {
+        [&spInfoWrapper, &callbackData]()
+        {
+            Syscollector::instance().init(spInfoWrapper,
+                                          callbackData,
+                                          reportFunction,
+                                          logFunction,
+                                          SYSCOLLECTOR_DB_PATH,
+                                          "",
+                                          "",
+                                          1, true, true, false, false, false, false, false, false, false, true, false, 3600);
+        }
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{2500});
+    Syscollector::instance().destroy();
+
+    if (t.joinable())
+    {
+        t.join();
+    }
+}
+
+TEST_F(SyscollectorImpTest, LazyOsInventoryBootIdChange)
+{
+    const auto spInfoWrapper{std::make_shared<SysInfoWrapper>()};
+
+    // Unchanged packages, the host reboots before the third scan.
+    EXPECT_CALL(*spInfoWrapper, packagesFingerprint())
+    .Times(::testing::AtLeast(2))
+    .WillRepeatedly(Return(R"({"dpkg":"550121:707688:1759619900.0"})"_json));
+    EXPECT_CALL(*spInfoWrapper, bootId())
+    .WillOnce(Return("boot-1"))
+    .WillOnce(Return("boot-1"))
+    .WillRepeatedly(Return("boot-2"));
+    EXPECT_CALL(*spInfoWrapper, os()).Times(2).WillRepeatedly(Return(nlohmann::json::parse(
+                                                                         R"({"architecture":"x86_64","hostname":"UBUNTU","os_build":"7601","os_major":"6","os_minor":"1","os_name":"Microsoft Windows 7","os_release":"sp1","os_version":"6.1.7601"})")));
+
+    std::function<void(const std::string&)> callbackData
+    {
+        [](const std::string&)
+        {
+        }
+    };
+    std::thread t
+    {
+        [&spInfoWrapper, &callbackData]()
+        {
+            Syscollector::instance().init(spInfoWrapper,
+                                          callbackData,
+                                          reportFunction,
+                                          logFunction,
+                                          SYSCOLLECTOR_DB_PATH,
+                                          "",
+                                          "",
+                                          1, true, false, true, false, false, false, false, false, false, true, false, 3600);
+        }
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{3500});
+    Syscollector::instance().destroy();
+
+    if (t.joinable())
+    {
+        t.join();
+    }
+}
+
+TEST_F(SyscollectorImpTest, ConcurrentScan)
+{
+    const auto spInfoWrapper{std::make_shared<SysInfoWrapper>()};
+    const auto package
+    {
+        R"({"architecture":"amd64","scan_time":"2020/12/28 21:49:50", "group":"x11","name":"xserver-xorg","priority":"optional","size":411,"source":"xorg","version":"1:7.7+19ubuntu14","format":"deb","location":" "})"_json
+    };
+    const auto process
+    {
+        R"({"egroup":"root","euser":"root","fgroup":"root","name":"kworker/u256:2-","scan_time":"2020/12/28 21:49:50", "nice":0,"nlwp":1,"pgrp":0,"pid":"431625","ppid":2,"priority":20,"processor":1,"resident":0,"rgroup":"root","ruser":"root","session":0,"sgroup":"root","share":0,"size":0,"start_time":9302261,"state":"I","stime":3,"suser":"root","tgid":431625,"tty":0,"utime":0,"vm_size":0})"_json
+    };
+    std::promise<void> processesStarted;
+    const auto processesFuture { processesStarted.get_future().share() };
+    std::atomic<bool> concurrent { false };
+
+    // The packages scan only ends once the processes one has started.
+    EXPECT_CALL(*spInfoWrapper, packages(_))
+    .Times(::testing::AtLeast(1))
+    .WillOnce([&](std::function<void(nlohmann::json&)> callback)
+    {
+        concurrent = processesFuture.wait_for(std::chrono::seconds{2}) == std::future_status::ready;
+        auto data { package };
+        callback(data);
+    })
+    .WillRepeatedly(::testing::InvokeArgument<0>(package));
+    EXPECT_CALL(*spInfoWrapper, processes(_))
+    .Times(::testing::AtLeast(1))
+    .WillOnce([&](std::function<void(nlohmann::json&)> callback)
+    {
+        processesStarted.set_value();
+        auto data { process };
+        callback(data);
+    })
+    .WillRepeatedly(::testing::InvokeArgument<0>(process));
+    EXPECT_CALL(*spInfoWrapper, os()).WillRepeatedly(Return(nlohmann::json::parse(
+                                                                R"({"architecture":"x86_64","hostname":"UBUNTU","os_build":"7601","os_major":"6","os_minor":"1","os_name":"Microsoft Windows 7","os_release":"sp1","os_version":"6.1.7601"})")));
+
+    CallbackMock wrapper;
+    std::function<void(const std::string&)> callbackData
+    {
+        [&wrapper](const std::string & data)
+        {
+            const auto delta = nlohmann::json::parse(data);
+            wrapper.callbackMock(delta.at("type").get<std::string>() + ":" + delta.at("operation").get<std::string>());
+        }
+    };
+
+    EXPECT_CALL(wrapper, callbackMock(_)).Times(::testing::AnyNumber());
+    EXPECT_CALL(wrapper, callbackMock("dbsync_packages:INSERTED")).Times(1);
+    EXPECT_CALL(wrapper, callbackMock("dbsync_processes:INSERTED")).Times(1);
+    EXPECT_CALL(wrapper, callbackMock("dbsync_osinfo:INSERTED")).Times(1);
+    std::thread t
+    {
+        [&spInfoWrapper, &callbackData]()
+        {
+            Syscollector::instance().init(spInfoWrapper,
+                                          callbackData,
+                                          reportFunction,
+                                          logFunction,
+                                          SYSCOLLECTOR_DB_PATH,
+                                          "",
+                                          "",
+                                          1, true, false, true, false, true, false, false, true, false, true, false, 0, 4);
+        }
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{2500});
+    Syscollector::instance().destroy();
+
+    if (t.joinable())
+    {
+        t.join();
+    }
+
+    EXPECT_TRUE(concurrent);
+}
+
+TEST_F(SyscollectorImpTest, InventoryInterval)
+{
+    const auto spInfoWrapper{std::make_shared<SysInfoWrapper>()};
+
+    EXPECT_CALL(*spInfoWrapper, hardware()).Times(1).WillOnce(Return(nlohmann::json::parse(
+                                                                          R"({"board_serial":"Intel Corporation","cpu_MHz":2904,"cpu_cores":2,"cpu_name":"Intel(R) Core(TM) i5-9400 CPU @ 2.90GHz", "ram_free":2257872,"ram_total":4972208,"ram_usage":54})")));
+    EXPECT_CALL(*spInfoWrapper, os())
+    .Times(::testing::AtLeast(2))
+    .WillRepeatedly(Return(nlohmann::json::parse(
+                               R"({"architecture":"x86_64","hostname":"UBUNTU","os_build":"7601","os_major":"6","os_minor":"1","os_name":"Microsoft Windows 7","os_release":"sp1","os_version":"6.1.7601"})")));
+
+    SyscollectorSchedule schedule;
+    schedule.intervals["os"] = 1;
+
+    std::thread t
+    {
+        [&spInfoWrapper, &schedule]()
+        {
+            Syscollector::instance().init(spInfoWrapper,
+                                          reportFunction,
+                                          reportFunction,
+                                          logFunction,
+                                          SYSCOLLECTOR_DB_PATH,
+                                          "",
+                                          "",
+                                          3600, true, true, true, false, false, false, false, false, false, false, false, 0, 1, schedule);
+        }
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{2500});
+    Syscollector::instance().destroy();
+
+    if (t.joinable())
+    {
+        t.join();
+    }
+}
+
+TEST_F(SyscollectorImpTest, InventoryJitter)
+{
+    const auto spInfoWrapper{std::make_shared<SysInfoWrapper>()};
+
+    // With this seed the OS scan isn't delayed and the hardware one is 8 seconds late.
+    EXPECT_CALL(*spInfoWrapper, hardware()).Times(0);
+    EXPECT_CALL(*spInfoWrapper, os()).Times(1).WillOnce(Return(nlohmann::json::parse(
+                                                                   R"({"architecture":"x86_64","hostname":"UBUNTU","os_build":"7601","os_major":"6","os_minor":"1","os_name":"Microsoft Windows 7","os_release":"sp1","os_version":"6.1.7601"})")));
+
+    SyscollectorSchedule schedule;
+    schedule.jitter = 10;
+    schedule.jitterSeed = "014";
+
+    std::thread t
+    {
+        [&spInfoWrapper, &schedule]()
+        {
+            Syscollector::instance().init(spInfoWrapper,
+                                          reportFunction,
+                                          reportFunction,
+                                          logFunction,
+                                          SYSCOLLECTOR_DB_PATH,
+                                          "",
+                                          "",
+                                          3600, true, true, true, false, false, false, false, false, false, false, false, 0, 1, schedule);
+        }
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{2500});
+    Syscollector::instance().destroy();
+
+    if (t.joinable())
+    {
+        t.join();
+    }
+}
+
+TEST_F(SyscollectorImpTest, PressureBackoff)
+{
+    const auto spInfoWrapper{std::make_shared<SysInfoWrapper>()};
+    std::atomic<int> rounds { 0 };
+
+    EXPECT_CALL(*spInfoWrapper, os()).WillRepeatedly(Return(nlohmann::json::parse(
+                                                                R"({"architecture":"x86_64","hostname":"UBUNTU","os_build":"7601","os_major":"6","os_minor":"1","os_name":"Microsoft Windows 7","os_release":"sp1","os_version":"6.1.7601"})")));
+
+    // The interval of 1 second is doubled after each round: they start at 0, 2 and 6 seconds.
+    SyscollectorSchedule schedule;
+    schedule.maxBackoff = 4;
+    schedule.pressure = [&rounds]()
+    {
+        ++rounds;
+        return true;
+    };
+
+    std::thread t
+    {
+        [&spInfoWrapper, &schedule]()
+        {
+            Syscollector::instance().init(spInfoWrapper,
+                                          reportFunction,
+                                          reportFunction,
+                                          logFunction,
+                                          SYSCOLLECTOR_DB_PATH,
+                                          "",
+                                          "",
+                                          1, true, false, true, false, false, false, false, false, false, false, false, 0, 1, schedule);
+        }
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{3500});
+    Syscollector::instance().destroy();
+
+    if (t.joinable())
+    {
+        t.join();
+    }
+
+    EXPECT_EQ(rounds, 2);
+}
+
+TEST_F(SyscollectorImpTest, DeltaBatches)
+{
+    const auto spInfoWrapper{std::make_shared<SysInfoWrapper>()};
+    const auto process
+    {
+        R"({"egroup":"root","euser":"root","fgroup":"root","name":"kworker/u256:2-","scan_time":"2020/12/28 21:49:50", "nice":0,"nlwp":1,"pgrp":0,"pid":"431625","ppid":2,"priority":20,"processor":1,"resident":0,"rgroup":"root","ruser":"root","session":0,"sgroup":"root","share":0,"size":0,"start_time":9302261,"state":"I","stime":3,"suser":"root","tgid":431625,"tty":0,"utime":0,"vm_size":0})"_json
+    };
+    const auto processes
+    {
+        [process](std::function<void(nlohmann::json&)> callback)
+        {
+            for (const auto pid : { "1", "2", "3" })
+            {
+                auto data { process };
+                data["pid"] = pid;
+                callback(data);
+            }
+        }
+    };
+
+    EXPECT_CALL(*spInfoWrapper, processes(_)).WillRepeatedly(processes);
+
+    CallbackMock wrapper;
+    std::function<void(const std::string&)> callbackData
+    {
+        [&wrapper](const std::string & data)
+        {
+            const auto delta = nlohmann::json::parse(data);
+            std::string pids;
+
+            for (const auto& item : delta.at("batch"))
+            {
+                pids += item.at("operation").get<std::string>() + ":" + item.at("data").at("pid").get<std::string>() + " ";
+            }
+
+            wrapper.callbackMock(delta.at("type").get<std::string>() + " " + pids);
+        }
+    };
+
+    // Up to two deltas in a message, the rest are sent once the scan ends.
+    ::testing::InSequence sequence;
+    EXPECT_CALL(wrapper, callbackMock("dbsync_processes INSERTED:1 INSERTED:2 ")).Times(1);
+    EXPECT_CALL(wrapper, callbackMock("dbsync_processes INSERTED:3 ")).Times(1);
+    std::thread t
+    {
+        [&spInfoWrapper, &callbackData]()
+        {
+            Syscollector::instance().init(spInfoWrapper,
+                                          callbackData,
+                                          reportFunction,
+                                          logFunction,
+                                          SYSCOLLECTOR_DB_PATH,
+                                          "",
+                                          "",
+                                          1, true, false, false, false, false, false, false, true, false, true, false, 0, 1, {}, 2);
+        }
+    };
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{2500});
+    Syscollector::instance().destroy();
+
+    if (t.joinable())
+    {
+        t.join();
+    }
+}
@@ -96,6 +96,21 @@ TEST_F(SysNormalizerTest, excludeSingleItemMatch)
     EXPECT_TRUE(inputJson.empty());
 }
 
+TEST_F(SysNormalizerTest, excludeConsecutiveItems)
+{
+    auto inputJson(nlohmann::json::parse(R"(
+        [
+            {"name": "Siri", "version": "1.0"},
+            {"name": "Siri", "version": "2.0"},
+            {"name": "FaceTime", "version": "3.0"},
+            {"name": "iCloud", "version": "1.0"}
+        ])"));
+    SysNormalizer normalizer{TEST_CONFIG_FILE_NAME, "macos"};
+    normalizer.removeExcluded("packages", inputJson);
+    ASSERT_EQ(1ul, inputJson.size());
+    EXPECT_EQ("FaceTime", inputJson[0]["name"]);
+}
+
 TEST_F(SysNormalizerTest, normalizeSingleMicosoft)
 {
     auto inputJson(nlohmann::json::parse(R"(
@@ -19,6 +19,7 @@
 #define WM_TASK_MAX_IN_PROGRESS_TIME 900 // 15 minutes
 #define WM_TASK_CLEANUP_DB_SLEEP_TIME 86400 // A day
 #define WM_TASK_DEFAULT_CLEANUP_TIME 604800 // A week
+#define WM_TASK_MAX_UPDATE_BATCH 100 // Agents per upgrade_update_status query
 
 typedef struct _wm_task_manager {
     int enabled:1;
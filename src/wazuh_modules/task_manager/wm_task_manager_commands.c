@@ -48,6 +48,15 @@ STATIC cJSON* wm_task_manager_command_upgrade_get_status(wm_task_manager_upgrade
  * */
 STATIC cJSON* wm_task_manager_command_upgrade_update_status(wm_task_manager_upgrade_update_status *task, int *error_code) __attribute__((nonnull));
 
+/**
+ * Add the response of an agent to an upgrade_update_status command.
+ * @param response JSON array where the response of the agent will be added.
+ * @param agent_id ID of the agent.
+ * @param wdb_error Error of the update in the tasks DB.
+ * @return OS_SUCCESS if the task was updated or not found, OS_INVALID on DB errors.
+ * */
+STATIC int wm_task_manager_add_update_status_result(cJSON *response, int agent_id, const cJSON *wdb_error) __attribute__((nonnull(1)));
+
 /**
  * Analyze an upgrade_result command.
  * @param task Upgrade result task to be processed.
@@ -199,16 +208,42 @@ STATIC cJSON* wm_task_manager_command_upgrade_get_status(wm_task_manager_upgrade
     return response;
 }
 
+STATIC int wm_task_manager_add_update_status_result(cJSON *response, int agent_id, const cJSON *wdb_error) {
+    if (wdb_error && (wdb_error->type == cJSON_Number) && (wdb_error->valueint == OS_SUCCESS)) {
+        cJSON_AddItemToArray(response, wm_task_manager_parse_data_response(WM_TASK_SUCCESS, agent_id, OS_INVALID, NULL));
+    } else if (wdb_error && (wdb_error->type == cJSON_Number) && (wdb_error->valueint == OS_NOTFOUND)) {
+        cJSON_AddItemToArray(response, wm_task_manager_parse_data_response(WM_TASK_DATABASE_NO_TASK, agent_id, OS_INVALID, NULL));
+    } else {
+        return OS_INVALID;
+    }
+
+    return OS_SUCCESS;
+}
+
 STATIC cJSON* wm_task_manager_command_upgrade_update_status(wm_task_manager_upgrade_update_status *task, int *error_code) {
     cJSON *response = cJSON_CreateArray();
     int agent_it = 0;
-    int agent_id = 0;
 
-    while (agent_id = task->agent_ids[agent_it++], agent_id != OS_INVALID) {
+    while (task->agent_ids[agent_it] != OS_INVALID) {
         cJSON *parameters = cJSON_CreateObject();
+        cJSON *agents = NULL;
         cJSON *wdb_response = NULL;
+        int agent_id = task->agent_ids[agent_it];
+        int result = OS_INVALID;
+
+        // Several agents are updated with a single query
+        if (task->agent_ids[agent_it + 1] == OS_INVALID) {
+            cJSON_AddNumberToObject(parameters, task_manager_json_keys[WM_TASK_AGENT_ID], agent_id);
+            agent_it++;
+        } else {
+            agents = cJSON_CreateArray();
+            cJSON_AddItemToObject(parameters, task_manager_json_keys[WM_TASK_AGENTS], agents);
+
+            for (int batch = 0; batch < WM_TASK_MAX_UPDATE_BATCH && task->agent_ids[agent_it] != OS_INVALID; batch++) {
+                cJSON_AddItemToArray(agents, cJSON_CreateNumber(task->agent_ids[agent_it++]));
+            }
+        }
 
-        cJSON_AddNumberToObject(parameters, task_manager_json_keys[WM_TASK_AGENT_ID], agent_id);
         cJSON_AddStringToObject(parameters, task_manager_json_keys[WM_TASK_NODE], task->node);
         cJSON_AddStringToObject(parameters, task_manager_json_keys[WM_TASK_STATUS], task->status);
         if (task->error_msg) {
@@ -220,11 +255,26 @@ STATIC cJSON* wm_task_manager_command_upgrade_update_status(wm_task_manager_upgr
 
             cJSON *wdb_error = cJSON_GetObjectItem(wdb_response, task_manager_json_keys[WM_TASK_ERROR]);
 
-            if (wdb_error && (wdb_error->type == cJSON_Number) && (wdb_error->valueint == OS_SUCCESS)) {
-                cJSON_AddItemToArray(response, wm_task_manager_parse_data_response(WM_TASK_SUCCESS, agent_id, OS_INVALID, NULL));
-            } else if (wdb_error && (wdb_error->type == cJSON_Number) && (wdb_error->valueint == OS_NOTFOUND)) {
-                cJSON_AddItemToArray(response, wm_task_manager_parse_data_response(WM_TASK_DATABASE_NO_TASK, agent_id, OS_INVALID, NULL));
-            } else {
+            if (!agents) {
+                result = wm_task_manager_add_update_status_result(response, agent_id, wdb_error);
+            } else if (wdb_error && (wdb_error->type == cJSON_Number) && (wdb_error->valueint == OS_SUCCESS)) {
+                cJSON *wdb_data = cJSON_GetObjectItem(wdb_response, task_manager_json_keys[WM_TASK_DATA]);
+                cJSON *agent_result = NULL;
+
+                result = cJSON_GetArraySize(wdb_data) == cJSON_GetArraySize(agents) ? OS_SUCCESS : OS_INVALID;
+
+                cJSON_ArrayForEach(agent_result, wdb_data) {
+                    cJSON *agent_json = cJSON_GetObjectItem(agent_result, task_manager_json_keys[WM_TASK_AGENT_ID]);
+
+                    if (result != OS_SUCCESS || !agent_json || (agent_json->type != cJSON_Number) ||
+                        (result = wm_task_manager_add_update_status_result(response, agent_json->valueint, cJSON_GetObjectItem(agent_result, task_manager_json_keys[WM_TASK_ERROR]))) != OS_SUCCESS) {
+                        result = OS_INVALID;
+                        break;
+                    }
+                }
+            }
+
+            if (result != OS_SUCCESS) {
                 *error_code = WM_TASK_DATABASE_ERROR;
                 cJSON_Delete(wdb_response);
                 cJSON_Delete(parameters);
@@ -519,6 +519,16 @@ STATIC int wm_vuldet_compare_vendors(char * vendor);
  */
 STATIC void wm_vuldel_truncate_revision(char * revision);
 
+/**
+ * @brief Compare a package version against a feed version, without going through the scan cache.
+ * @param version_a Package version.
+ * @param operation Comparison operation.
+ * @param version_b Version of the CVE to compare with @operation.
+ * @param vertype Comparator to use: NVD, RPM or DEB.
+ * @return Same as wm_checks_package_vulnerability().
+ */
+STATIC int wm_vuldet_compare_versions(char *version_a, const char *operation, const char *version_b, version_type vertype);
+
 /**
  * @brief Generates the cpe product name for Windows versions.
  * @param pr Product name of the Windows distribution.
@@ -531,9 +541,16 @@ STATIC char *wm_vuldet_build_product_name(const char *pr, const char *ver);
 time_t curr_time;
 int wdb_vuldet_sock = -1;
 int *vu_queue;
+// Serializes the writes to the queue socket between the scan and the report threads
+static pthread_mutex_t vu_queue_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Reports pending to be sent by the report thread, NULL if reports are sent inline
+w_queue_t *vu_report_queue;
+int vu_report_queue_size;
 // Define time to sleep between messages sent
 int usec;
 int deps_id = 0;
+// Results of the version comparisons made during the current scan, NULL out of a scan
+rb_tree *vu_version_cache;
 
 const wm_context WM_VULNDETECTOR_CONTEXT = {
     .name = "vulnerability-detector",
@@ -923,16 +940,60 @@ int wm_vuldet_step(sqlite3_stmt *stmt) {
 * This function should be taken as the version comparison entry point
 */
 int wm_checks_package_vulnerability(char *version_a, const char *operation, const char *version_b, version_type vertype) {
+    char key[2 * KEY_SIZE + OS_SIZE_64];
+    int *cached;
+    int size;
+    int ret;
+
+    if (!vu_version_cache || !version_a || !operation || !version_b || !strcmp(version_b, version_null)) {
+        return wm_vuldet_compare_versions(version_a, operation, version_b, vertype);
+    }
+
+    // The length of the first version keeps the key unambiguous, as versions may contain any separator
+    size = snprintf(key, sizeof(key), "%d|%s|%zu|%s|%s", vertype, operation, strlen(version_a), version_a, version_b);
+
+    if (size < 0 || (size_t)size >= sizeof(key)) {
+        return wm_vuldet_compare_versions(version_a, operation, version_b, vertype);
+    }
+
+    if (cached = rbtree_get(vu_version_cache, key), cached) {
+        return *cached;
+    }
+
+    ret = wm_vuldet_compare_versions(version_a, operation, version_b, vertype);
+
+    if (rbtree_size(vu_version_cache) < VU_VERSION_CACHE_MAX) {
+        os_malloc(sizeof(int), cached);
+        *cached = ret;
+        rbtree_insert(vu_version_cache, key, cached);
+    }
+
+    return ret;
+}
+
+void wm_vuldet_version_cache_init(void) {
+    vu_version_cache = rbtree_init();
+    rbtree_set_dispose(vu_version_cache, free);
+}
+
+void wm_vuldet_version_cache_free(void) {
+    if (vu_version_cache) {
+        mtdebug1(WM_VULNDETECTOR_LOGTAG, "Version comparison cache released with %u entries.", rbtree_size(vu_version_cache));
+        rbtree_destroy(vu_version_cache);
+        vu_version_cache = NULL;
+    }
+}
+
+int wm_vuldet_compare_versions(char *version_a, const char *operation, const char *version_b, version_type vertype) {
     int size;
     int epoch, c_epoch;
     char version_cl[KEY_SIZE];
     char cversion_cl[KEY_SIZE];
     char *version_it, *release_it;
     char *cversion_it, *crelease_it;
-    struct pkg_version *package_version;
-    struct pkg_version *package_feed_version;
+    struct pkg_version package_version;
+    struct pkg_version package_feed_version;
     enum pkg_relation feed_condition;
-    int8_t ret = 0;
 
     if (version_b && strcmp(version_b, version_null)) {
         // Copy the original values
@@ -991,14 +1052,12 @@ int wm_checks_package_vulnerability(char *version_a, const char *operation, cons
             }
         }
 
-        os_calloc(1, sizeof(struct pkg_version), package_version);
-        os_calloc(1, sizeof(struct pkg_version), package_feed_version);
-        package_version->epoch = epoch;
-        package_version->version = version_it;
-        package_version->revision = release_it ? release_it : "0";
-        package_feed_version->epoch = c_epoch;
-        package_feed_version->version = cversion_it;
-        package_feed_version->revision = crelease_it ? crelease_it : "0";
+        package_version.epoch = epoch;
+        package_version.version = version_it;
+        package_version.revision = release_it ? release_it : "0";
+        package_feed_version.epoch = c_epoch;
+        package_feed_version.version = cversion_it;
+        package_feed_version.revision = crelease_it ? crelease_it : "0";
 
         if (!strcmp(operation, vu_package_comp[VU_COMP_L])) {
             feed_condition = PKG_RELATION_LT;
@@ -1011,27 +1070,16 @@ int wm_checks_package_vulnerability(char *version_a, const char *operation, cons
         } else if (!strcmp(operation, vu_package_comp[VU_COMP_EQ])) {
             feed_condition = PKG_RELATION_EQ;
         } else {
-            ret = VU_ERROR_CMP;
-            goto clean;
+            return VU_ERROR_CMP;
         }
 
         // This sanity is included since you cannot always expect a revision to come,
         // since it is a data provided by the agent.
-        if ((vertype == VER_TYPE_RPM_CENTOS || vertype == VER_TYPE_RPM_ALAS || vertype == VER_TYPE_RPM) && (NULL == package_version->version)) {
-            ret = VU_ERROR_CMP;
-            goto clean;
+        if ((vertype == VER_TYPE_RPM_CENTOS || vertype == VER_TYPE_RPM_ALAS || vertype == VER_TYPE_RPM) && (NULL == package_version.version)) {
+            return VU_ERROR_CMP;
         }
 
-        if (pkg_version_relate(package_version, feed_condition, package_feed_version, vertype)) {
-            ret = VU_VULNERABLE;
-        } else {
-            ret = VU_NOT_VULNERABLE;
-        }
-
-    clean:
-        os_free(package_version);
-        os_free(package_feed_version);
-        return ret;
+        return pkg_version_relate(&package_version, feed_condition, &package_feed_version, vertype) ? VU_VULNERABLE : VU_NOT_VULNERABLE;
     }
 
     return VU_NOT_FIXED;
@@ -1691,8 +1739,8 @@ int wm_vuldet_process_agent_vulnerabilities(sqlite3 *db, OSHash *cve_table, scan
                     "exists");
             }
 
-            // Sending CVE report
-            if (wm_vuldet_send_cve_report(report, update)) {
+            // Sending CVE report. When the report thread is running, it takes ownership of the report.
+            if (vu_report_queue ? wm_vuldet_queue_cve_report(&report, update) : wm_vuldet_send_cve_report(report, update)) {
                 mterror(WM_VULNDETECTOR_LOGTAG, VU_SEND_AGENT_REPORT_ERROR, report->cve ? report->cve : "", report->software ? report->software : "" , scan_ctx->agent_id);
             } else {
                 if (pkg->feed & VU_SRC_NVD) {
@@ -1872,12 +1920,14 @@ int wm_vuldet_send_cve_report(vu_report *report, bool updated) {
         send_queue = LOCALFILE_MQ;
     }
 
+    w_mutex_lock(&vu_queue_mutex);
     if (wm_sendmsg(usec, *vu_queue, alert_msg, header, send_queue) < 0) {
         mterror(WM_VULNDETECTOR_LOGTAG, QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
         if ((*vu_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
             mterror_exit(WM_VULNDETECTOR_LOGTAG, QUEUE_FATAL, DEFAULTQUEUE);
         }
     }
+    w_mutex_unlock(&vu_queue_mutex);
 
     retval = 0;
 end:
@@ -1886,6 +1936,39 @@ end:
     return retval;
 }
 
+int wm_vuldet_queue_cve_report(vu_report **report, bool updated) {
+    vu_pending_report *pending;
+
+    os_calloc(1, sizeof(vu_pending_report), pending);
+    pending->report = *report;
+    pending->updated = updated;
+    *report = NULL;
+
+    // Block while the queue is full so the scan does not outpace the EPS limit indefinitely
+    queue_push_ex_block(vu_report_queue, pending);
+    return 0;
+}
+
+void *wm_vuldet_report_thread(__attribute__((unused)) void *args) {
+    vu_pending_report *pending;
+
+    while (1) {
+        pending = queue_pop_ex(vu_report_queue);
+
+        if (wm_vuldet_send_cve_report(pending->report, pending->updated)) {
+            mterror(WM_VULNDETECTOR_LOGTAG, VU_SEND_AGENT_REPORT_ERROR,
+                    pending->report->cve ? pending->report->cve : "",
+                    pending->report->software ? pending->report->software : "",
+                    pending->report->agent_id ? atoi(pending->report->agent_id) : 0);
+        }
+
+        wm_vuldet_free_report(pending->report);
+        os_free(pending);
+    }
+
+    return NULL;
+}
+
 int wm_vuldet_send_removed_cve_report (cJSON* j_vuln, scan_ctx_t* scan_ctx) {
     int retval = OS_INVALID;
     char header[OS_SIZE_256 + 1];
@@ -1969,12 +2052,14 @@ int wm_vuldet_send_removed_cve_report (cJSON* j_vuln, scan_ctx_t* scan_ctx) {
             send_queue = LOCALFILE_MQ;
         }
 
+        w_mutex_lock(&vu_queue_mutex);
         if (wm_sendmsg(usec, *vu_queue, alert_msg, header, send_queue) < 0) {
             mterror(WM_VULNDETECTOR_LOGTAG, QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
             if ((*vu_queue = StartMQ(DEFAULTQUEUE, WRITE, INFINITE_OPENQ_ATTEMPTS)) < 0) {
                 mterror_exit(WM_VULNDETECTOR_LOGTAG, QUEUE_FATAL, DEFAULTQUEUE);
             }
         }
+        w_mutex_unlock(&vu_queue_mutex);
 
         retval = OS_SUCCESS;
     }
@@ -2782,6 +2867,9 @@ int wm_vuldet_check_agent_vulnerabilities(wm_vuldet_t *vuldet) {
         return wm_vuldet_sql_error(db, stmt);
     }
 
+    // Agents sharing the same packages and feed reuse the version comparisons
+    wm_vuldet_version_cache_init();
+
     // Iterate agents to look for vulnerabilities
     do {
         retry_agents = false;
@@ -2884,6 +2972,8 @@ int wm_vuldet_check_agent_vulnerabilities(wm_vuldet_t *vuldet) {
 
     } while (retry_agents && !abort_scan);
 
+    wm_vuldet_version_cache_free();
+
     // Reset the tables
     wm_vuldet_reset_tables(db);
 
@@ -8753,6 +8843,13 @@ void wm_vuldet_init(wm_vuldet_t * vuldet) {
 
     vu_queue = &vuldet->queue_fd;
 
+    // Send the reports from a dedicated thread so that the scan does not wait for the EPS limit
+    if (vu_report_queue_size > 0) {
+        vu_report_queue = queue_init(vu_report_queue_size);
+        w_create_thread(wm_vuldet_report_thread, NULL);
+        mtdebug1(WM_VULNDETECTOR_LOGTAG, "Report thread started with a queue of %d reports.", vu_report_queue_size);
+    }
+
     if (!flags->run_on_start) {
         time_t time_sleep = vuldet->scan_interval;
         for (i = 0; i < OS_SUPP_SIZE; i++) {
@@ -30,6 +30,7 @@
 #define WM_VULNDETECTOR_ONLY_ONE_UPD UINT_MAX
 #define WM_VULNDETECTOR_MAX_AGENT_SCAN_ATTEMPS 5
 #define WM_VULNDETECTOR_DOWN_ATTEMPTS  5
+#define VU_VERSION_CACHE_MAX 200000 // Version comparisons remembered during a scan
 #define VU_DEF_MIN_FULL_SCAN_INTERVAL 21600 // 6 hours
 #define VU_DEF_RETRY_INTERVAL 30 // 30 seconds
 #define VU_TEMP_FILE "tmp/vuln-temp"
@@ -140,6 +141,9 @@ extern const char *vu_package_comp[];
 extern const char *vu_severities[];
 extern const char *vu_cpe_tags[];
 extern int wdb_vuldet_sock;
+extern w_queue_t *vu_report_queue;
+extern int vu_report_queue_size;
+extern rb_tree *vu_version_cache;
 typedef struct cpe_list cpe_list;
 typedef struct nvd_vulnerability nvd_vulnerability;
 typedef struct cv_scoring_system cv_scoring_system;
@@ -568,6 +572,12 @@ struct vu_report {
     char *agent_ip;
 };
 
+// Report waiting to be sent by the report thread
+typedef struct vu_pending_report {
+    vu_report *report;
+    bool updated;
+} vu_pending_report;
+
 typedef struct oval_metadata {
     char *product_name;
     char *product_version;
@@ -1040,6 +1050,17 @@ int wm_vuldet_win_nvd_vulnerabilities(sqlite3 *db, scan_agent *agent, wm_vuldet_
  */
 int wm_checks_package_vulnerability(char *version_a, const char *operation, const char *version_b, version_type vertype);
 
+/**
+ * @brief Start remembering the results of wm_checks_package_vulnerability() until the cache is released.
+ * Agents with the same packages are then mostly evaluated from the cache.
+ */
+void wm_vuldet_version_cache_init(void);
+
+/**
+ * @brief Release the version comparison cache and go back to uncached comparisons.
+ */
+void wm_vuldet_version_cache_free(void);
+
 /**
  * @brief Send a report for a specific CVE and the affected packages.
  * @param report An already generated report that must be parsed and sent.
@@ -1047,6 +1068,21 @@ int wm_checks_package_vulnerability(char *version_a, const char *operation, cons
  */
 int wm_vuldet_send_cve_report(vu_report *report, bool updated);
 
+/**
+ * @brief Hand a report over to the report thread, which sends and releases it.
+ * @param report Report to be sent. It is set to NULL, as the report thread takes ownership of it.
+ * @param updated Whether the vulnerability was already reported but the package version changed.
+ * @return 0 always.
+ */
+int wm_vuldet_queue_cve_report(vu_report **report, bool updated);
+
+/**
+ * @brief Main loop of the report thread. It sends the reports queued by the scan.
+ * @param args Unused.
+ * @return NULL, it never returns.
+ */
+void *wm_vuldet_report_thread(void *args);
+
 /**
  * @brief Send a report for a removed CVE and the affected package.
  * @param j_vuln A cJSON object containing the CVE's information from vuln_cves table.
@@ -216,6 +216,54 @@ int order(int c)
         return 0;
 }
 
+/*
+* Compare alpha and numeric segments of two DEB versions, limited to the first
+* alen and blen characters, so that prefixes can be compared without copying them.
+* Extracted from DPKG source code.
+* return > 0: a is newer than b
+*          0: a and b are the same version
+*        < 0: b is newer than a
+*/
+static int deb_verrevcmp_n(const char *a, size_t alen, const char *b, size_t blen)
+{
+    const char *a_end = a + alen;
+    const char *b_end = b + blen;
+
+    while (a < a_end || b < b_end) {
+        int first_diff = 0;
+
+        while ((a < a_end && !c_isdigit(*a)) || (b < b_end && !c_isdigit(*b))) {
+            int ac = order(a < a_end ? *a : '\0');
+            int bc = order(b < b_end ? *b : '\0');
+
+            if (ac != bc)
+                return ac - bc;
+
+            a++;
+            b++;
+        }
+        while (a < a_end && *a == '0')
+            a++;
+        while (b < b_end && *b == '0')
+            b++;
+        while (a < a_end && b < b_end && c_isdigit(*a) && c_isdigit(*b)) {
+            if (!first_diff)
+                first_diff = *a - *b;
+            a++;
+            b++;
+        }
+
+        if (a < a_end && c_isdigit(*a))
+            return 1;
+        if (b < b_end && c_isdigit(*b))
+            return -1;
+        if (first_diff)
+            return first_diff;
+    }
+
+    return 0;
+}
+
 /*
 * Compare alpha and numeric segments of two DEB versions
 * Extracted from DPKG source code.
@@ -265,6 +313,22 @@ static int deb_verrevcmp(const char *a, const char *b, __attribute__((unused)) i
     return 0;
 }
 
+/*
+* Compare two alpha or numeric segments of RPM versions the same way strcmp
+* would do if they were null-terminated.
+*/
+static int rpm_segcmp(const char *one, size_t onelen, const char *two, size_t twolen)
+{
+    int rc = memcmp(one, two, onelen < twolen ? onelen : twolen);
+
+    if (rc)
+        return rc < 0 ? -1 : 1;
+    if (onelen == twolen)
+        return 0;
+
+    return onelen < twolen ? -1 : 1;
+}
+
 /*
 * Compare alpha and numeric segments of two RPM versions
 * Extracted from rpmLib source code.
@@ -277,20 +341,12 @@ static int rpm_vercmp(const char * a, const char * b, __attribute__((unused)) in
     /* easy comparison to see if versions are identical */
     if (!strcmp(a, b)) return 0;
 
-    char oldch1, oldch2;
-    char abuf[strlen(a)+1], bbuf[strlen(b)+1];
-    char *str1 = abuf, *str2 = bbuf;
-    char * one, * two;
+    const char *one = a, *two = b;
+    const char *str1, *str2;
     int rc;
     int isnum;
 
-    strcpy(str1, a);
-    strcpy(str2, b);
-
-    one = str1;
-    two = str2;
-
-    /* loop through each version segment of str1 and str2 and compare them */
+    /* loop through each version segment of a and b and compare them */
     while (*one || *two) {
         while (*one && !(c_isalpha(*one) || c_isdigit(*one)) && *one != '~' && *one != '^') one++;
         while (*two && !(c_isalpha(*two) || c_isdigit(*two)) && *two != '~' && *two != '^') two++;
@@ -338,13 +394,6 @@ static int rpm_vercmp(const char * a, const char * b, __attribute__((unused)) in
             isnum = 0;
         }
 
-        /* save character at the end of the alpha or numeric segment */
-        /* so that they can be restored after the comparison */
-        oldch1 = *str1;
-        *str1 = '\0';
-        oldch2 = *str2;
-        *str2 = '\0';
-
         /* this cannot happen, as we previously tested to make sure that */
         /* the first string has a non-null segment */
         if (one == str1) return -1;   /* arbitrary */
@@ -356,33 +405,22 @@ static int rpm_vercmp(const char * a, const char * b, __attribute__((unused)) in
         if (two == str2) return (isnum ? 1 : -1);
 
         if (isnum) {
-            size_t onelen, twolen;
-            /* this used to be done by converting the digit segments */
-            /* to ints using atoi() - it's changed because long  */
-            /* digit segments can overflow an int - this should fix that. */
-
             /* throw away any leading zeros - it's a number, right? */
             while (*one == '0') one++;
             while (*two == '0') two++;
 
             /* whichever number has more digits wins */
-            onelen = strlen(one);
-            twolen = strlen(two);
-            if (onelen > twolen) return 1;
-            if (twolen > onelen) return -1;
+            if (str1 - one > str2 - two) return 1;
+            if (str2 - two > str1 - one) return -1;
         }
 
-        /* strcmp will return which one is greater - even if the two */
-        /* segments are alpha or if they are numeric.  don't return  */
-        /* if they are equal because there might be more segments to */
-        /* compare */
-        rc = strcmp(one, two);
-        if (rc) return (rc < 1 ? -1 : 1);
+        /* compare the segments in place - even if the two segments are */
+        /* alpha or if they are numeric. don't return if they are equal */
+        /* because there might be more segments to compare */
+        rc = rpm_segcmp(one, str1 - one, two, str2 - two);
+        if (rc) return rc;
 
-        /* restore character that was replaced by null above */
-        *str1 = oldch1;
         one = str1;
-        *str2 = oldch2;
         two = str2;
     }
 
@@ -403,9 +441,8 @@ static int rpm_vercmp(const char * a, const char * b, __attribute__((unused)) in
 */
 static int nvd_verrevcmp(const char *a, const char *b, int revision)
 {
-    int result;
-    char *rev;
-    size_t rev_size;
+    size_t a_size;
+    size_t b_size;
 
     // In the NVD version comparison, we avoid the revision
     // comparison if any of them is not present.
@@ -413,6 +450,9 @@ static int nvd_verrevcmp(const char *a, const char *b, int revision)
         return 0;
     }
 
+    a_size = strlen(a);
+    b_size = strlen(b);
+
     // When comparing revisions, in some cases the NVD's is shorter because it's
     // more generic than the package's, but that doesn't mean they are different.
     // Example: Package version: 3.0pl1-128.1ubuntu1
@@ -420,53 +460,30 @@ static int nvd_verrevcmp(const char *a, const char *b, int revision)
     // To avoid an incorrect comparison, we will only compare the number of
     // characters that the NVD version contains.
     if (revision) {
-        if (strlen(a) > strlen(b)) {
-            rev_size = strlen(b);
-        } else {
-            rev_size = strlen(a);
-        }
+        return deb_verrevcmp_n(a, a_size > b_size ? b_size : a_size, b, b_size);
+    }
 
-        os_calloc(1, rev_size + 1, rev);
-        strncpy(rev, a, rev_size);
-
-        result = deb_verrevcmp(rev, b, 1);
-
-        os_free(rev);
-
-    } else {
-        // When comparing versions, we are comparing the number of characters
-        // of the NVD version contains for certains cases only
-
-        size_t a_size = strlen(a);
-        size_t b_size = strlen(b);
-
-        if (a_size > b_size) {
-            int i;
-            for (i = 0; i < (int)a_size - 1; i++) {
-                if ((a[i] == '.'
-                        && !c_isdigit(a[i + 1]))
-                    || a[i] == '~'
-                    || a[i] == '+') {
-                    // The version is truncated when is found
-                    // a point followed by a non-digit character
-                    // Examples:
-                    //      2.02~beta2
-                    //      1.2.8.dfsg
-                    //      4.6.0+git+20161106
-                    char * ver;
-                    os_calloc(1, i + 1, ver);
-                    strncpy(ver, a, i);
-
-                    result = deb_verrevcmp(ver, b, 0);
-                    os_free(ver);
-                    return result;
-                }
+    // When comparing versions, we are comparing the number of characters
+    // of the NVD version contains for certains cases only
+    if (a_size > b_size) {
+        int i;
+        for (i = 0; i < (int)a_size - 1; i++) {
+            if ((a[i] == '.'
+                    && !c_isdigit(a[i + 1]))
+                || a[i] == '~'
+                || a[i] == '+') {
+                // The version is truncated when is found
+                // a point followed by a non-digit character
+                // Examples:
+                //      2.02~beta2
+                //      1.2.8.dfsg
+                //      4.6.0+git+20161106
+                return deb_verrevcmp_n(a, i, b, b_size);
             }
         }
-        result = deb_verrevcmp(a, b, 0);
     }
 
-    return result;
+    return deb_verrevcmp_n(a, a_size, b, b_size);
 }
 
 /**
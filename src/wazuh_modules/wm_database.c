@@ -84,6 +84,33 @@ static void wm_check_agents();
  */
 static void wm_sync_agents();
 
+/**
+ * @brief Adds the agent of a key to the array of agents to be inserted in the DB.
+ *
+ * @param agents JSON array of agents.
+ * @param entry The key of the agent.
+ */
+static void wm_add_agent_data(cJSON *agents, const keyentry *entry);
+
+/**
+ * @brief Removes an agent from the DB and all its artifacts.
+ *
+ * @param id The ID of the agent.
+ * @return OS_SUCCESS if the agent was removed from the DB, OS_INVALID otherwise.
+ */
+static int wm_remove_agent(const char *id);
+
+/**
+ * @brief Builds the tree of agent IDs of a keystore, to be compared with the next one.
+ *
+ * @param keys The keystore.
+ * @return Tree with the IDs as keys and no values.
+ */
+static rb_tree *wm_keys_snapshot(const keystore *keys);
+
+// IDs in client.keys at the last synchronization, NULL until a full one succeeds
+static rb_tree *agents_snapshot;
+
 // Clean dangling database files
 static void wm_clean_dangling_wdb_dbs();
 
@@ -269,6 +296,7 @@ void wm_sync_agents() {
     clock_t clock0 = clock();
     struct timespec spec0;
     struct timespec spec1;
+    int result;
 
     gettime(&spec0);
 
@@ -276,7 +304,12 @@ void wm_sync_agents() {
     OS_PassEmptyKeyfile();
     OS_ReadKeys(&keys, W_RAW_KEY, 0);
 
-    sync_keys_with_wdb(&keys);
+    // Once the DB matches the keystore, only the changes of client.keys are sent
+    result = agents_snapshot ? sync_keys_changes_with_wdb(&keys, agents_snapshot) : sync_keys_with_wdb(&keys);
+
+    rbtree_destroy(agents_snapshot);
+    // After a failure, the whole keystore is compared with the DB again
+    agents_snapshot = result == OS_SUCCESS ? wm_keys_snapshot(&keys) : NULL;
 
     OS_FreeKeys(&keys);
     mtdebug1(WM_DATABASE_LOGTAG, "Agents synchronization completed.");
@@ -293,64 +326,142 @@ void wm_sync_agents() {
  *        agents.
  *
  * @param keys The keystore structure to be synchronized
+ * @return OS_SUCCESS if the DB matches the keystore, OS_INVALID otherwise.
  */
-void sync_keys_with_wdb(keystore *keys) {
+int sync_keys_with_wdb(keystore *keys) {
     rb_tree *agents = NULL;
+    cJSON *new_agents = NULL;
     char **ids = NULL;
     unsigned int i;
+    int result = OS_SUCCESS;
 
     agents = wdb_get_all_agents_rbtree(FALSE, &wdb_wmdb_sock);
 
     if (agents == NULL) {
         mterror(WM_DATABASE_LOGTAG, "Couldn't synchronize the keystore with the DB.");
-        return;
+        return OS_INVALID;
     }
 
+    new_agents = cJSON_CreateArray();
+
     // Add new agents to the database
     for (i = 0; i < keys->keysize; i++) {
         keyentry *entry = keys->keyentries[i];
-        int agent_id = atoi(entry->id);
-
-        if (agent_id && (rbtree_get(agents, entry->id) == NULL)) {
-            char agent_cidr[IPSIZE + 1];
-
-            mtdebug2(WM_DATABASE_LOGTAG, "Synchronizing agent %s '%s'.", entry->id, entry->name);
 
-            if (wdb_insert_agent(agent_id, entry->name, NULL, OS_CIDRtoStr(entry->ip, agent_cidr, IPSIZE) ?
-                                entry->ip->ip : agent_cidr, entry->raw_key, NULL, 1, &wdb_wmdb_sock)) {
-                mtdebug1(WM_DATABASE_LOGTAG, "Couldn't insert agent '%s' in the database.", entry->id);
-            }
+        if (atoi(entry->id) && (rbtree_get(agents, entry->id) == NULL)) {
+            wm_add_agent_data(new_agents, entry);
         }
     }
 
+    if (cJSON_GetArraySize(new_agents) > 0 && wdb_insert_agents(new_agents, 1, &wdb_wmdb_sock)) {
+        mtdebug1(WM_DATABASE_LOGTAG, "Couldn't insert the new agents in the database.");
+        result = OS_INVALID;
+    }
+
+    cJSON_Delete(new_agents);
+
     ids = rbtree_keys(agents);
 
     // Delete from the database all the agents without a key and all its artifacts
     for (i = 0; ids[i] != NULL; i++) {
-        int agent_id = atoi(ids[i]);
+        if (atoi(ids[i]) && (OS_IsAllowedID(keys, ids[i]) == -1) && wm_remove_agent(ids[i]) != OS_SUCCESS) {
+            result = OS_INVALID;
+        }
+    }
 
-        if (agent_id && (OS_IsAllowedID(keys, ids[i]) == -1)) {
-            char *agent_name = wdb_get_agent_name(agent_id, &wdb_wmdb_sock);
+    free_strarray(ids);
+    rbtree_destroy(agents);
+
+    return result;
+}
 
-            if (wdb_remove_agent(agent_id, &wdb_wmdb_sock) < 0) {
-                mtdebug1(WM_DATABASE_LOGTAG, "Couldn't remove agent '%s' from the database.", ids[i]);
-                os_free(agent_name);
-                continue;
+/**
+ * @brief Synchronizes the changes of a keystore since the previous synchronization.
+ *        Only the agents added or removed from client.keys are sent to wazuh-db.
+ *
+ * @param keys The keystore structure to be synchronized
+ * @param snapshot Tree with the agent IDs of the previous keystore
+ * @return OS_SUCCESS if the DB matches the keystore, OS_INVALID otherwise.
+ */
+int sync_keys_changes_with_wdb(keystore *keys, const rb_tree *snapshot) {
+    const rb_node *current = rbtree_first(keys->keytree_id);
+    const rb_node *previous = rbtree_first(snapshot);
+    cJSON *new_agents = cJSON_CreateArray();
+    int result = OS_SUCCESS;
+
+    // Both trees are sorted by ID, so a single pass finds the added and removed agents
+    while (current || previous) {
+        int cmp = !current ? 1 : !previous ? -1 : strcmp(current->key, previous->key);
+
+        if (cmp < 0) {
+            if (atoi(current->key)) {
+                wm_add_agent_data(new_agents, current->value);
             }
+            current = rbtree_next(current);
+        } else if (cmp > 0) {
+            if (atoi(previous->key) && wm_remove_agent(previous->key) != OS_SUCCESS) {
+                result = OS_INVALID;
+            }
+            previous = rbtree_next(previous);
+        } else {
+            current = rbtree_next(current);
+            previous = rbtree_next(previous);
+        }
+    }
 
-            // Agent not found. Removing agent artifacts
-            wm_clean_agent_artifacts(agent_id, agent_name);
+    if (cJSON_GetArraySize(new_agents) > 0 && wdb_insert_agents(new_agents, 1, &wdb_wmdb_sock)) {
+        mtdebug1(WM_DATABASE_LOGTAG, "Couldn't insert the new agents in the database.");
+        result = OS_INVALID;
+    }
 
-            // Remove agent-related files
-            OS_RemoveCounter(ids[i]);
-            OS_RemoveAgentTimestamp(ids[i]);
+    cJSON_Delete(new_agents);
 
-            os_free(agent_name);
-        }
+    return result;
+}
+
+void wm_add_agent_data(cJSON *agents, const keyentry *entry) {
+    char agent_cidr[IPSIZE + 1];
+    cJSON *agent = cJSON_CreateObject();
+
+    mtdebug2(WM_DATABASE_LOGTAG, "Synchronizing agent %s '%s'.", entry->id, entry->name);
+
+    cJSON_AddNumberToObject(agent, "id", atoi(entry->id));
+    cJSON_AddStringToObject(agent, "name", entry->name);
+    cJSON_AddStringToObject(agent, "register_ip", OS_CIDRtoStr(entry->ip, agent_cidr, IPSIZE) ? entry->ip->ip : agent_cidr);
+    cJSON_AddStringToObject(agent, "internal_key", entry->raw_key);
+    cJSON_AddItemToArray(agents, agent);
+}
+
+int wm_remove_agent(const char *id) {
+    int agent_id = atoi(id);
+    char *agent_name = wdb_get_agent_name(agent_id, &wdb_wmdb_sock);
+
+    if (wdb_remove_agent(agent_id, &wdb_wmdb_sock) < 0) {
+        mtdebug1(WM_DATABASE_LOGTAG, "Couldn't remove agent '%s' from the database.", id);
+        os_free(agent_name);
+        return OS_INVALID;
     }
 
-    free_strarray(ids);
-    rbtree_destroy(agents);
+    // Agent not found. Removing agent artifacts
+    wm_clean_agent_artifacts(agent_id, agent_name);
+
+    // Remove agent-related files
+    OS_RemoveCounter(id);
+    OS_RemoveAgentTimestamp(id);
+
+    os_free(agent_name);
+
+    return OS_SUCCESS;
+}
+
+rb_tree *wm_keys_snapshot(const keystore *keys) {
+    rb_tree *snapshot = rbtree_init();
+
+    for (const rb_node *node = rbtree_first(keys->keytree_id); node; node = rbtree_next(node)) {
+        rbtree_insert(snapshot, node->key, NULL);
+    }
+
+    return snapshot;
 }
 
 /**
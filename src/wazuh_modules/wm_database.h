@@ -34,8 +34,20 @@ wmodule* wm_database_read();
  *        agents.
  *
  * @param keys The keystore structure to be synchronized
+ * @return OS_SUCCESS if the DB matches the keystore, OS_INVALID otherwise.
  */
-void sync_keys_with_wdb(keystore *keys);
+int sync_keys_with_wdb(keystore *keys);
+
+/**
+ * @brief Synchronizes the changes of a keystore since the previous one with the
+ *        agent table of global.db. It inserts the agents added to the keystore in
+ *        batches and removes the ones that are gone, with all their artifacts.
+ *
+ * @param keys The keystore structure to be synchronized
+ * @param snapshot Tree with the agent IDs of the previous keystore, already synchronized
+ * @return OS_SUCCESS if the DB matches the keystore, OS_INVALID otherwise.
+ */
+int sync_keys_changes_with_wdb(keystore *keys, const rb_tree *snapshot);
 
 /**
  * @brief This function removes the wazuh-db agent DB and the diff folder of an agent.
@@ -16,6 +16,11 @@
 #include "expression.h"
 #include "shared.h"
 
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
 #undef minfo
 #undef mwarn
 #undef merror
@@ -38,8 +43,45 @@ typedef struct request_dump_t {
     int first_scan;
 } request_dump_t;
 
+/* Result of a command run during the current scan */
+typedef struct command_result_t {
+    int status;
+    int result_code;
+    char *output;
+} command_result_t;
+
+/* Policy read and validated, waiting to be evaluated */
+typedef struct wm_sca_policy_job_t {
+    int index;                      ///< Index of the policy, also the one of its databases.
+    int id;                         ///< Unique ID of the scan.
+    cJSON *object;                  ///< Policy file, transformed from YAML.
+    cJSON *requirements_array;
+    OSStore *vars;
+    char **sorted_variables;
+    char *integrity_hash_file;
+    char *integrity_hash;           ///< Hash of the results, NULL until the policy is evaluated.
+    int requirements_satisfied;
+    int checks_number;
+    unsigned int passed;
+    unsigned int failed;
+    unsigned int invalid;
+    time_t time_start;
+    time_t time_end;
+} wm_sca_policy_job_t;
+
+/* Policies evaluated concurrently by the scan threads */
+typedef struct wm_sca_pool_t {
+    wm_sca_t *data;
+    wm_sca_policy_job_t **jobs;
+    int jobs_count;
+    int next;                       ///< Next job to be taken by a thread.
+    int first_scan;
+    pthread_mutex_t mutex;
+} wm_sca_pool_t;
+
 #ifdef WIN32
-static HKEY wm_sca_sub_tree;
+/* Set while resolving a registry key, every scan thread has its own */
+static __thread HKEY wm_sca_sub_tree;
 #endif
 
 static const int RETURN_NOT_FOUND = 0;
@@ -56,6 +98,14 @@ static int wm_sca_start(wm_sca_t * data);  // Start
 static cJSON *wm_sca_build_event(const cJSON * const check, const cJSON * const policy, char **p_alert_msg, int id, const char * const result, const char * const reason);
 static int wm_sca_send_event_check(wm_sca_t * data,cJSON *event);  // Send check event
 static void wm_sca_read_files(wm_sca_t * data);  // Read policy monitoring files
+static wm_sca_policy_job_t *wm_sca_read_policy(wm_sca_t * data, int index, OSHash *global_check_list);
+static void wm_sca_evaluate_policy(wm_sca_t * data, wm_sca_policy_job_t *job, int first_scan);
+static void wm_sca_finish_policy(wm_sca_t * data, wm_sca_policy_job_t *job, int first_scan, unsigned int summary_delay);
+static void wm_sca_free_policy_job(wm_sca_policy_job_t *job);
+static void wm_sca_evaluate_policies(wm_sca_t * data, wm_sca_policy_job_t **jobs, int jobs_count, int first_scan);
+static void * wm_sca_policy_thread(void *args);
+static void wm_sca_set_priority(int nice);
+static char **wm_sca_alert_msg(wm_sca_t * data);
 static int wm_sca_do_scan(cJSON *checks, OSStore *vars, wm_sca_t * data, int id, cJSON *policy, int requirements_scan, int cis_db_index, unsigned int remote_policy, int first_scan, int *checks_number, char ** sorted_variables, char * policy_engine);
 static int wm_sca_send_summary(wm_sca_t * data, int scan_id,unsigned int passed, unsigned int failed,unsigned int invalid,cJSON *policy,int start_time,int end_time, char * integrity_hash, char * integrity_hash_file, int first_scan, int id, int checks_number);
 static int wm_sca_check_policy(const cJSON * const policy, const cJSON * const checks, OSHash *global_check_list);
@@ -93,6 +143,8 @@ static int wm_sca_check_file_existence(const char * const file, char ** reason);
 static int wm_sca_check_file_list_for_existence(const char * const file_list, char ** reason);
 static int wm_sca_check_file_list(const char * const file_list, char * const pattern, char ** reason, w_expression_t * regex_engine);
 static int wm_sca_read_command(char *command, char * pattern, wm_sca_t * data, char ** reason, w_expression_t * regex_engine);
+static int wm_sca_exec_command(char * command, char ** output, int * result_code, wm_sca_t * data);
+static void wm_sca_free_command_result(command_result_t * result);
 static int wm_sca_test_positive_minterm(char * const minterm, const char * const str, char ** reason, w_expression_t * regex_engine);
 static int wm_sca_pattern_matches(const char * const str, const char * const pattern, char ** reason, w_expression_t * regex_engine); // Check pattern match
 static int wm_sca_check_dir(const char * const dir, const char * const file, char * const pattern, char ** reason, w_expression_t * regex_engine);
@@ -124,9 +176,16 @@ const wm_context WM_SCA_CONTEXT = {
     .query = NULL,
 };
 
-static unsigned int summary_passed = 0;
-static unsigned int summary_failed = 0;
-static unsigned int summary_invalid = 0;
+/* Results of the policy being evaluated, every scan thread has its own */
+static __thread unsigned int summary_passed = 0;
+static __thread unsigned int summary_failed = 0;
+static __thread unsigned int summary_invalid = 0;
+
+/* Messages of the check being evaluated by a pool thread, NULL in the module thread */
+static __thread char **thread_alert_msg;
+
+/* The events of every scan thread share the EPS limit */
+static pthread_mutex_t send_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static OSHash **cis_db;
 static char **last_sha256;
@@ -135,6 +194,9 @@ static cis_db_hash_info_t *cis_db_for_hash;
 static w_queue_t * request_queue;
 static wm_sca_t * data_win;
 
+/* Commands run during the current scan, shared among checks and policies */
+static OSHash * command_cache;
+
 cJSON **last_summary_json = NULL;
 
 /* Multiple readers / one write mutex */
@@ -173,6 +235,8 @@ void * wm_sca_main(wm_sca_t * data) {
 
     data->request_db_interval = getDefine_Int("sca","request_db_interval", 1, 60) * 60;
     data->commands_timeout = getDefine_Int("sca", "commands_timeout", 1, 300);
+    data->max_parallel = getDefine_Int("sca", "max_parallel", 1, 16);
+    data->nice = getDefine_Int("sca", "nice", 0, 19);
 #ifdef CLIENT
     data->remote_commands = getDefine_Int("sca", "remote_commands", 0, 1);
 #else
@@ -270,6 +334,8 @@ static int wm_sca_send_alert(wm_sca_t * data,cJSON *json_alert)
     char *msg = cJSON_PrintUnformatted(json_alert);
     mdebug2("Sending event: %s",msg);
 
+    w_mutex_lock(&send_mutex);
+
     if (wm_sendmsg(data->msg_delay, queue_fd, msg,WM_SCA_STAMP, SCA_MQ) < 0) {
         merror(QUEUE_ERROR, DEFAULTQUEUE, strerror(errno));
 
@@ -282,6 +348,8 @@ static int wm_sca_send_alert(wm_sca_t * data,cJSON *json_alert)
         }
     }
 
+    w_mutex_unlock(&send_mutex);
+
     os_free(msg);
 
     return (0);
@@ -316,6 +384,8 @@ static int wm_sca_start(wm_sca_t * data) {
     time_t time_start = 0;
     time_t duration = 0;
 
+    wm_sca_set_priority(data->nice);
+
     do {
         const time_t time_sleep = sched_scan_get_time_until_next_scan(&(data->scan_config), WM_SCA_LOGTAG, data->scan_on_start);
 
@@ -344,208 +414,399 @@ static int wm_sca_start(wm_sca_t * data) {
 }
 
 static void wm_sca_read_files(wm_sca_t * data) {
-    int checks_number = 0;
     static int first_scan = 1;
 
     /* Read every policy monitoring file */
     if(data->policies) {
         OSHash *check_list = OSHash_Create();
+        wm_sca_policy_job_t **jobs = NULL;
+        int jobs_count = 0;
         int i;
+
+        if (command_cache = OSHash_Create(), command_cache) {
+            OSHash_SetFreeDataPointer(command_cache, (void (*)(void *))wm_sca_free_command_result);
+        }
+
         for(i = 0; data->policies[i]; i++) {
             if(!data->policies[i]->enabled){
                 continue;
             }
 
-            OSStore *vars = NULL;
-            cJSON * object = NULL;
-            cJSON *requirements_array = NULL;
-            int cis_db_index = i;
-            char **sorted_variables = NULL;
+            wm_sca_policy_job_t *job = wm_sca_read_policy(data, i, check_list);
 
-            FILE *fp = fopen(data->policies[i]->policy_path, "r");
+            if (!job) {
+                continue;
+            }
 
-            if(!fp) {
-                mwarn("Policy file not found: '%s'. Skipping it.", data->policies[i]->policy_path);
-                goto next;
+            if (data->max_parallel <= 1) {
+                wm_sca_evaluate_policy(data, job, first_scan);
+                wm_sca_finish_policy(data, job, first_scan, data->summary_delay);
+                wm_sca_free_policy_job(job);
+            } else {
+                os_realloc(jobs, (jobs_count + 1) * sizeof(wm_sca_policy_job_t *), jobs);
+                jobs[jobs_count++] = job;
             }
-            w_file_cloexec(fp);
+        }
 
-            /* Yaml parsing */
-            yaml_document_t document;
+        if (jobs_count > 0) {
+            wm_sca_evaluate_policies(data, jobs, jobs_count, first_scan);
 
-            if (yaml_parse_file(data->policies[i]->policy_path, &document)) {
-                mwarn("Error found while parsing file: '%s'. Skipping it.", data->policies[i]->policy_path);
-                goto next;
-            }
+            /* The summaries follow the order of the policies, once every check event was queued */
+            w_time_delay(1000 * data->summary_delay);
 
-            if (object = yaml2json(&document,1), !object) {
-                mwarn("Error found while transforming yaml to json: '%s'. Skipping it.", data->policies[i]->policy_path);
-                yaml_document_delete(&document);
-                goto next;
+            for (i = 0; i < jobs_count; i++) {
+                wm_sca_finish_policy(data, jobs[i], first_scan, 0);
+                wm_sca_free_policy_job(jobs[i]);
             }
+        }
+
+        os_free(jobs);
+        first_scan = 0;
+        OSHash_Clean(check_list, free);
 
-            yaml_document_delete(&document);
+        if (command_cache) {
+            OSHash_Free(command_cache);
+            command_cache = NULL;
+        }
+    }
+}
 
-            cJSON *policy = cJSON_GetObjectItem(object, "policy");
-            cJSON *variables_policy = cJSON_GetObjectItem(object, "variables");
-            cJSON *checks = cJSON_GetObjectItem(object, "checks");
-            requirements_array = cJSON_CreateArray();
-            cJSON *requirements = cJSON_GetObjectItem(object, "requirements");
-            cJSON_AddItemReferenceToArray(requirements_array, requirements);
+/**
+ * @brief Reads and validates a policy file, and resets its results if the file changed.
+ *
+ * @param data SCA module.
+ * @param index Index of the policy.
+ * @param global_check_list Check IDs of the policies read during this scan.
+ *
+ * @return Policy ready to be evaluated, NULL if it has to be skipped.
+ */
+static wm_sca_policy_job_t *wm_sca_read_policy(wm_sca_t * data, int index, OSHash *global_check_list) {
+    wm_sca_policy_job_t *job = NULL;
+    const char *policy_path = data->policies[index]->policy_path;
+    yaml_document_t document;
 
-            if (wm_sca_check_policy(policy, checks, check_list)) {
-                mwarn("Error found while validating policy file: '%s'. Skipping it.", data->policies[i]->policy_path);
-                goto next;
-            }
+    os_calloc(1, sizeof(wm_sca_policy_job_t), job);
+    job->index = index;
 
-            cJSON * policy_regex_type = cJSON_GetObjectItem(policy, "regex_type");
+    FILE *fp = fopen(policy_path, "r");
 
-            if (!policy_regex_type) {
-                data->policies[i]->policy_regex_type = OSREGEX_STR;
-            } else {
-                data->policies[i]->policy_regex_type = cJSON_GetStringValue(policy_regex_type);
-            }
+    if(!fp) {
+        mwarn("Policy file not found: '%s'. Skipping it.", policy_path);
+        goto error;
+    }
+    fclose(fp);
 
-            if (requirements && wm_sca_check_requirements(requirements)) {
-                mwarn("Error found while reading 'requirements' section of file: '%s'. Skipping it.", data->policies[i]->policy_path);
-                goto next;
-            }
+    /* Yaml parsing */
+    if (yaml_parse_file(policy_path, &document)) {
+        mwarn("Error found while parsing file: '%s'. Skipping it.", policy_path);
+        goto error;
+    }
 
-            if (!data->policies[i]->policy_id) {
-                cJSON *id = cJSON_GetObjectItem(policy, "id");
-                os_strdup(id->valuestring,data->policies[i]->policy_id);
-            }
+    if (job->object = yaml2json(&document,1), !job->object) {
+        mwarn("Error found while transforming yaml to json: '%s'. Skipping it.", policy_path);
+        yaml_document_delete(&document);
+        goto error;
+    }
 
-            if (!checks) {
-                mwarn("Error found while reading 'checks' section of file: '%s'. Skipping it.", data->policies[i]->policy_path);
-                goto next;
-            }
+    yaml_document_delete(&document);
 
-            vars = OSStore_Create();
-            sorted_variables = wm_sort_variables(variables_policy);
-            if (wm_sca_get_vars(variables_policy,vars) != 0) {
-                mwarn("Error found while reading the 'variables' section of file: '%s'. Skipping it.", data->policies[i]->policy_path);
-                goto next;
-            }
+    cJSON *policy = cJSON_GetObjectItem(job->object, "policy");
+    cJSON *variables_policy = cJSON_GetObjectItem(job->object, "variables");
+    cJSON *checks = cJSON_GetObjectItem(job->object, "checks");
+    job->requirements_array = cJSON_CreateArray();
+    cJSON *requirements = cJSON_GetObjectItem(job->object, "requirements");
+    cJSON_AddItemReferenceToArray(job->requirements_array, requirements);
 
-            // Set unique ID for each scan
+    if (wm_sca_check_policy(policy, checks, global_check_list)) {
+        mwarn("Error found while validating policy file: '%s'. Skipping it.", policy_path);
+        goto error;
+    }
+
+    cJSON * policy_regex_type = cJSON_GetObjectItem(policy, "regex_type");
+
+    if (!policy_regex_type) {
+        data->policies[index]->policy_regex_type = OSREGEX_STR;
+    } else {
+        data->policies[index]->policy_regex_type = cJSON_GetStringValue(policy_regex_type);
+    }
+
+    if (requirements && wm_sca_check_requirements(requirements)) {
+        mwarn("Error found while reading 'requirements' section of file: '%s'. Skipping it.", policy_path);
+        goto error;
+    }
+
+    if (!data->policies[index]->policy_id) {
+        cJSON *id = cJSON_GetObjectItem(policy, "id");
+        os_strdup(id->valuestring,data->policies[index]->policy_id);
+    }
+
+    if (!checks) {
+        mwarn("Error found while reading 'checks' section of file: '%s'. Skipping it.", policy_path);
+        goto error;
+    }
+
+    job->vars = OSStore_Create();
+    job->sorted_variables = wm_sort_variables(variables_policy);
+    if (wm_sca_get_vars(variables_policy,job->vars) != 0) {
+        mwarn("Error found while reading the 'variables' section of file: '%s'. Skipping it.", policy_path);
+        goto error;
+    }
+
+    // Set unique ID for each scan
 #ifndef WIN32
-            int id = os_random();
-            if (id < 0) {
-                id = -id;
-            }
+    job->id = os_random();
 #else
-            char random_id[RANDOM_LENGTH];
-            snprintf(random_id, RANDOM_LENGTH - 1, "%u%u", os_random(), os_random());
-            int id = atoi(random_id);
-
-            if (id < 0) {
-                id = -id;
-            }
+    char random_id[RANDOM_LENGTH];
+    snprintf(random_id, RANDOM_LENGTH - 1, "%u%u", os_random(), os_random());
+    job->id = atoi(random_id);
 #endif
-            int requirements_satisfied = 0;
 
-            if(!requirements) {
-                requirements_satisfied = 1;
-            }
+    if (job->id < 0) {
+        job->id = -job->id;
+    }
 
-            mdebug1("Calculating hash for policy file '%s'", data->policies[i]->policy_path);
-            char * integrity_hash_file = wm_sca_hash_integrity_file(data->policies[i]->policy_path);
+    mdebug1("Calculating hash for policy file '%s'", policy_path);
+    job->integrity_hash_file = wm_sca_hash_integrity_file(policy_path);
 
-            /* Check if the file integrity has changed */
-            if(last_sha256[cis_db_index]) {
-                w_rwlock_rdlock(&dump_rwlock);
-                if (strcmp(last_sha256[cis_db_index],"")) {
+    /* Check if the file integrity has changed */
+    if(last_sha256[index]) {
+        w_rwlock_rdlock(&dump_rwlock);
+        if (strcmp(last_sha256[index],"")) {
 
-                    /* File hash changed, delete table */
-                    if(integrity_hash_file && strcmp(integrity_hash_file,last_sha256[cis_db_index])) {
-                        OSHash_Free(cis_db[cis_db_index]);
-                        cis_db[cis_db_index] = OSHash_Create();
+            /* File hash changed, delete table */
+            if(job->integrity_hash_file && strcmp(job->integrity_hash_file,last_sha256[index])) {
+                OSHash_Free(cis_db[index]);
+                cis_db[index] = OSHash_Create();
 
-                        if (!cis_db[cis_db_index]) {
-                            merror(LIST_ERROR);
-                            w_rwlock_unlock(&dump_rwlock);
-                            pthread_exit(NULL);
-                        }
+                if (!cis_db[index]) {
+                    merror(LIST_ERROR);
+                    w_rwlock_unlock(&dump_rwlock);
+                    pthread_exit(NULL);
+                }
 
-                        OSHash_SetFreeDataPointer(cis_db[cis_db_index], (void (*)(void *))wm_sca_free_hash_data);
+                OSHash_SetFreeDataPointer(cis_db[index], (void (*)(void *))wm_sca_free_hash_data);
 
-                        os_free(cis_db_for_hash[cis_db_index].elem);
-                        os_realloc(cis_db_for_hash[cis_db_index].elem, sizeof(cis_db_info_t *) * (2), cis_db_for_hash[cis_db_index].elem);
-                        cis_db_for_hash[cis_db_index].elem[0] = NULL;
-                        cis_db_for_hash[cis_db_index].elem[1] = NULL;
-                    }
-                }
-                w_rwlock_unlock(&dump_rwlock);
+                os_free(cis_db_for_hash[index].elem);
+                os_realloc(cis_db_for_hash[index].elem, sizeof(cis_db_info_t *) * (2), cis_db_for_hash[index].elem);
+                cis_db_for_hash[index].elem[0] = NULL;
+                cis_db_for_hash[index].elem[1] = NULL;
             }
+        }
+        w_rwlock_unlock(&dump_rwlock);
+    }
 
-            if(requirements) {
-                w_rwlock_rdlock(&dump_rwlock);
-                if (wm_sca_do_scan(requirements_array, vars, data, id, policy, 1, cis_db_index, data->policies[i]->remote,first_scan, &checks_number, sorted_variables, data->policies[i]->policy_regex_type) == 0) {
-                    requirements_satisfied = 1;
-                }
-                w_rwlock_unlock(&dump_rwlock);
-            }
+    return job;
 
-            if(requirements_satisfied) {
-                w_rwlock_rdlock(&dump_rwlock);
+error:
+    wm_sca_free_policy_job(job);
+    return NULL;
+}
 
-                time_t time_start = 0;
-                time_t time_end = 0;
-                time_start = time(NULL);
+/**
+ * @brief Evaluates the requirements and the checks of a policy, and hashes its results.
+ *
+ * It runs either in the module thread or in a pool thread. The check events are sent as they
+ * are found, the summary is left to wm_sca_finish_policy.
+ *
+ * @param data SCA module.
+ * @param job Policy read by wm_sca_read_policy.
+ * @param first_scan Whether this is the first scan since the module started.
+ */
+static void wm_sca_evaluate_policy(wm_sca_t * data, wm_sca_policy_job_t *job, int first_scan) {
+    wm_sca_policy_t *policy_config = data->policies[job->index];
+    cJSON *policy = cJSON_GetObjectItem(job->object, "policy");
+    cJSON *checks = cJSON_GetObjectItem(job->object, "checks");
+    cJSON *requirements = cJSON_GetObjectItem(job->object, "requirements");
 
-                minfo("Starting evaluation of policy: '%s'", data->policies[i]->policy_path);
+    if(!requirements) {
+        job->requirements_satisfied = 1;
+    } else {
+        w_rwlock_rdlock(&dump_rwlock);
+        if (wm_sca_do_scan(job->requirements_array, job->vars, data, job->id, policy, 1, job->index, policy_config->remote, first_scan, &job->checks_number, job->sorted_variables, policy_config->policy_regex_type) == 0) {
+            job->requirements_satisfied = 1;
+        }
+        w_rwlock_unlock(&dump_rwlock);
+    }
 
-                if (wm_sca_do_scan(checks, vars, data, id, policy, 0, cis_db_index, data->policies[i]->remote, first_scan, &checks_number, sorted_variables, data->policies[i]->policy_regex_type) != 0) {
-                    merror("Error while evaluating the policy '%s'", data->policies[i]->policy_path);
-                }
-                mdebug1("Calculating hash for scanned results.");
-                char * integrity_hash = wm_sca_hash_integrity(cis_db_index);
+    if (!job->requirements_satisfied) {
+        return;
+    }
 
-                time_end = time(NULL);
+    w_rwlock_rdlock(&dump_rwlock);
 
-                /* Send summary */
-                if(integrity_hash && integrity_hash_file) {
-                    w_time_delay(1000 * data->summary_delay);
-                    wm_sca_send_summary(data,id,summary_passed,summary_failed,summary_invalid,policy,time_start,time_end,integrity_hash,integrity_hash_file,first_scan,cis_db_index,checks_number);
-                    snprintf(last_sha256[cis_db_index] ,sizeof(os_sha256),"%s",integrity_hash_file);
-                }
+    job->time_start = time(NULL);
 
-                os_free(integrity_hash);
+    minfo("Starting evaluation of policy: '%s'", policy_config->policy_path);
 
-                minfo("Evaluation finished for policy '%s'", data->policies[i]->policy_path);
-                wm_sca_reset_summary();
+    if (wm_sca_do_scan(checks, job->vars, data, job->id, policy, 0, job->index, policy_config->remote, first_scan, &job->checks_number, job->sorted_variables, policy_config->policy_regex_type) != 0) {
+        merror("Error while evaluating the policy '%s'", policy_config->policy_path);
+    }
+    mdebug1("Calculating hash for scanned results.");
+    job->integrity_hash = wm_sca_hash_integrity(job->index);
 
-                w_rwlock_unlock(&dump_rwlock);
-            } else {
-                cJSON *title = cJSON_GetObjectItem(requirements,"title");
-                minfo("Skipping policy '%s': '%s'", data->policies[i]->policy_path, title->valuestring);
-            }
+    job->time_end = time(NULL);
 
-            os_free(integrity_hash_file);
+    job->passed = summary_passed;
+    job->failed = summary_failed;
+    job->invalid = summary_invalid;
+    wm_sca_reset_summary();
 
-    next:
-            if(fp){
-                fclose(fp);
-            }
+    w_rwlock_unlock(&dump_rwlock);
+}
 
-            if(object) {
-                cJSON_Delete(object);
-            }
+/**
+ * @brief Sends the summary of an evaluated policy and keeps the hash of its file.
+ *
+ * @param data SCA module.
+ * @param job Policy evaluated by wm_sca_evaluate_policy.
+ * @param first_scan Whether this is the first scan since the module started.
+ * @param summary_delay Seconds to wait for the check events to be sent before the summary.
+ */
+static void wm_sca_finish_policy(wm_sca_t * data, wm_sca_policy_job_t *job, int first_scan, unsigned int summary_delay) {
+    const char *policy_path = data->policies[job->index]->policy_path;
 
-            if(requirements_array){
-                cJSON_Delete(requirements_array);
-            }
+    if (!job->requirements_satisfied) {
+        cJSON *title = cJSON_GetObjectItem(cJSON_GetObjectItem(job->object, "requirements"),"title");
+        minfo("Skipping policy '%s': '%s'", policy_path, title->valuestring);
+        return;
+    }
 
-            if(vars) {
-                OSStore_Free(vars);
-            }
+    w_rwlock_rdlock(&dump_rwlock);
 
-            free_strarray(sorted_variables);
+    /* Send summary */
+    if(job->integrity_hash && job->integrity_hash_file) {
+        if (summary_delay) {
+            w_time_delay(1000 * summary_delay);
         }
-        first_scan = 0;
-        OSHash_Clean(check_list, free);
+        wm_sca_send_summary(data,job->id,job->passed,job->failed,job->invalid,cJSON_GetObjectItem(job->object, "policy"),job->time_start,job->time_end,job->integrity_hash,job->integrity_hash_file,first_scan,job->index,job->checks_number);
+        snprintf(last_sha256[job->index] ,sizeof(os_sha256),"%s",job->integrity_hash_file);
+    }
+
+    minfo("Evaluation finished for policy '%s'", policy_path);
+
+    w_rwlock_unlock(&dump_rwlock);
+}
+
+static void wm_sca_free_policy_job(wm_sca_policy_job_t *job) {
+    if (!job) {
+        return;
+    }
+
+    if(job->object) {
+        cJSON_Delete(job->object);
     }
+
+    if(job->requirements_array){
+        cJSON_Delete(job->requirements_array);
+    }
+
+    if(job->vars) {
+        OSStore_Free(job->vars);
+    }
+
+    free_strarray(job->sorted_variables);
+    os_free(job->integrity_hash_file);
+    os_free(job->integrity_hash);
+    os_free(job);
+}
+
+/**
+ * @brief Evaluates the policies read during a scan with up to max_parallel threads.
+ *
+ * The policies are evaluated in the module thread if the threads can't be created.
+ *
+ * @param data SCA module.
+ * @param jobs Policies read by wm_sca_read_policy.
+ * @param jobs_count Number of policies.
+ * @param first_scan Whether this is the first scan since the module started.
+ */
+static void wm_sca_evaluate_policies(wm_sca_t * data, wm_sca_policy_job_t **jobs, int jobs_count, int first_scan) {
+    wm_sca_pool_t pool = { .data = data, .jobs = jobs, .jobs_count = jobs_count, .next = 0, .first_scan = first_scan };
+    const int threads_count = jobs_count < data->max_parallel ? jobs_count : data->max_parallel;
+    pthread_t *threads = NULL;
+    int i;
+
+    w_mutex_init(&pool.mutex, NULL);
+    os_calloc(threads_count, sizeof(pthread_t), threads);
+
+    for (i = 0; i < threads_count; i++) {
+        if (pthread_create(&threads[i], NULL, wm_sca_policy_thread, &pool) != 0) {
+            merror(THREAD_ERROR);
+            break;
+        }
+    }
+
+    mdebug1("Evaluating %d policies with %d threads.", jobs_count, i);
+
+    // No thread could be created, the policies are evaluated here.
+    if (i == 0) {
+        wm_sca_policy_thread(&pool);
+    }
+
+    while (i > 0) {
+        pthread_join(threads[--i], NULL);
+    }
+
+    os_free(threads);
+    w_mutex_destroy(&pool.mutex);
+}
+
+static void * wm_sca_policy_thread(void *args) {
+    wm_sca_pool_t *pool = (wm_sca_pool_t *)args;
+    wm_sca_policy_job_t *job;
+
+    wm_sca_set_priority(pool->data->nice);
+    os_calloc(256, sizeof(char *), thread_alert_msg);
+
+    while (1) {
+        w_mutex_lock(&pool->mutex);
+        job = pool->next < pool->jobs_count ? pool->jobs[pool->next++] : NULL;
+        w_mutex_unlock(&pool->mutex);
+
+        if (!job) {
+            break;
+        }
+
+        wm_sca_evaluate_policy(pool->data, job, pool->first_scan);
+    }
+
+    free_strarray(thread_alert_msg);
+    thread_alert_msg = NULL;
+
+    return NULL;
+}
+
+/**
+ * @brief Lowers the priority of the calling thread, the threads it creates inherit it on Linux.
+ *
+ * On Linux the nice value belongs to the thread, and its disk I/O priority follows it when no
+ * I/O class was set. The nice value is shared by the whole process on other UNIX systems, so
+ * it is kept.
+ *
+ * @param nice Nice value, 0 keeps the current priority.
+ */
+static void wm_sca_set_priority(int nice) {
+    if (nice <= 0) {
+        return;
+    }
+
+#ifdef WIN32
+    const int priority = nice <= 5 ? THREAD_PRIORITY_BELOW_NORMAL :
+                         nice <= 10 ? THREAD_PRIORITY_LOWEST :
+                         THREAD_PRIORITY_IDLE;
+
+    if (!SetThreadPriority(GetCurrentThread(), priority)) {
+        mwarn("Can't set the scan thread priority: %lu", GetLastError());
+    }
+#elif defined(__linux__)
+    if (setpriority(PRIO_PROCESS, (id_t)syscall(SYS_gettid), nice) < 0) {
+        mwarn("Can't set the scan thread priority: %s (%d)", strerror(errno), errno);
+    }
+#endif
+}
+
+static char **wm_sca_alert_msg(wm_sca_t * data) {
+    return thread_alert_msg ? thread_alert_msg : data->alert_msg;
 }
 
 static int wm_sca_check_policy(const cJSON * const policy, const cJSON * const checks, OSHash *global_check_list)
@@ -963,6 +1224,7 @@ static int wm_sca_do_scan(cJSON * checks,
 
     int ret_val = 0;
     OSList *p_list = NULL;
+    char **alert_msg = wm_sca_alert_msg(data);
 
     /* Initialize variables */
     memset(buf, '\0', sizeof(buf));
@@ -1316,9 +1578,9 @@ static int wm_sca_do_scan(cJSON * checks,
                 unless the result is INVALID */
             ret_val = g_found == RETURN_INVALID ? 1 : !g_found;
             int i;
-            for (i=0; data->alert_msg[i]; i++){
-                free(data->alert_msg[i]);
-                data->alert_msg[i] = NULL;
+            for (i=0; alert_msg[i]; i++){
+                free(alert_msg[i]);
+                alert_msg[i] = NULL;
             }
             w_free_expression_t(&regex_engine);
             goto clean_return;
@@ -1347,7 +1609,7 @@ static int wm_sca_do_scan(cJSON * checks,
             }
         }
 
-        cJSON *event = wm_sca_build_event(check, policy, data->alert_msg, id, message_ref, reason);
+        cJSON *event = wm_sca_build_event(check, policy, alert_msg, id, message_ref, reason);
         if (event) {
             /* Alert if necessary */
             if(!cis_db_for_hash[cis_db_index].elem[check_count]) {
@@ -1369,9 +1631,9 @@ static int wm_sca_do_scan(cJSON * checks,
         }
 
         int i;
-        for (i=0; data->alert_msg[i]; i++){
-            free(data->alert_msg[i]);
-            data->alert_msg[i] = NULL;
+        for (i=0; alert_msg[i]; i++){
+            free(alert_msg[i]);
+            alert_msg[i] = NULL;
         }
 
         os_free(reason);
@@ -1701,7 +1963,7 @@ static int wm_sca_read_command(char * command,
     char *cmd_output = NULL;
     int result_code;
 
-    switch (wm_exec(command, &cmd_output, &result_code, data->commands_timeout, NULL)) {
+    switch (wm_sca_exec_command(command, &cmd_output, &result_code, data)) {
     case 0:
         mdebug1("Command '%s' returned code %d", command, result_code);
         break;
@@ -1763,6 +2025,42 @@ static int wm_sca_read_command(char * command,
     return result;
 }
 
+static int wm_sca_exec_command(char * command, char ** output, int * result_code, wm_sca_t * data)
+{
+    command_result_t * result;
+
+    // Many checks run the same command, so run it once per scan
+    if (command_cache && (result = OSHash_Get(command_cache, command), result)) {
+        mdebug2("Reusing the output of command '%s' from this scan.", command);
+        *result_code = result->result_code;
+        w_strdup(result->output, *output);
+        return result->status;
+    }
+
+    int status = wm_exec(command, output, result_code, data->commands_timeout, NULL);
+
+    if (command_cache) {
+        os_calloc(1, sizeof(command_result_t), result);
+        result->status = status;
+        result->result_code = *result_code;
+        w_strdup(*output, result->output);
+
+        if (OSHash_Add(command_cache, command, result) != 2) {
+            wm_sca_free_command_result(result);
+        }
+    }
+
+    return status;
+}
+
+static void wm_sca_free_command_result(command_result_t * result)
+{
+    if (result) {
+        os_free(result->output);
+        os_free(result);
+    }
+}
+
 static int wm_sca_apply_numeric_partial_comparison(const char * const partial_comparison,
                                                    const long int number,
                                                    char ** reason,
@@ -3303,18 +3601,20 @@ cJSON *wm_sca_dump(const wm_sca_t *data) {
 
 static int append_msg_to_vm_scat (wm_sca_t * const data, const char * const msg)
 {
+    char **alert_msg = wm_sca_alert_msg(data);
+
     /* Already present */
-    if (w_is_str_in_array(data->alert_msg, msg)) {
+    if (w_is_str_in_array(alert_msg, msg)) {
         return 1;
     }
 
     int i = 0;
-    while (data->alert_msg[i] && (i < 255)) {
+    while (alert_msg[i] && (i < 255)) {
         i++;
     }
 
-    if (!data->alert_msg[i]) {
-        os_strdup(msg, data->alert_msg[i]);
+    if (!alert_msg[i]) {
+        os_strdup(msg, alert_msg[i]);
     }
     return 0;
 }
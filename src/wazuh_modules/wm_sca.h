@@ -50,6 +50,8 @@ typedef struct wm_sca_t {
     int queue;
     int remote_commands:1;
     int commands_timeout;
+    int max_parallel;           // Maximum number of policies evaluated at once
+    int nice;                   // Nice value of the scan threads
     sched_scan_config scan_config;
 } wm_sca_t;
 
@@ -52,6 +52,10 @@ syscollector_sync_message_func syscollector_sync_message_ptr = NULL;
 
 long syscollector_sync_max_eps = 10;    // Database syncrhonization number of events per seconds (default value)
 int queue_fd = 0;                       // Output queue file descriptor
+static w_token_bucket_t sys_eps_bucket = W_TOKEN_BUCKET_INITIALIZER;
+static unsigned int sys_sent_messages;          // Messages sent since the last pressure check
+static unsigned int sys_throttled_messages;     // Of them, the ones delayed by max_eps
+static unsigned int sys_failed_messages;        // Of them, the ones the queue didn't accept
 
 static bool is_shutdown_process_started() {
     bool ret_val = shutdown_process_started;
@@ -60,8 +64,13 @@ static bool is_shutdown_process_started() {
 
 static void wm_sys_send_message(const void* data, const char queue_id) {
     if (!is_shutdown_process_started()) {
-        const int eps = 1000000/syscollector_sync_max_eps;
-        if (wm_sendmsg_ex(eps, queue_fd, data, WM_SYS_LOCATION, queue_id, &is_shutdown_process_started) < 0) {
+        const unsigned int eps = (unsigned int)syscollector_sync_max_eps;
+        __atomic_add_fetch(&sys_sent_messages, 1, __ATOMIC_RELAXED);
+        if (w_token_bucket_wait(&sys_eps_bucket, eps, W_TOKEN_BUCKET_BURST(eps))) {
+            __atomic_add_fetch(&sys_throttled_messages, 1, __ATOMIC_RELAXED);
+        }
+        if (wm_sendmsg_ex(0, queue_fd, data, WM_SYS_LOCATION, queue_id, &is_shutdown_process_started) < 0) {
+            __atomic_add_fetch(&sys_failed_messages, 1, __ATOMIC_RELAXED);
     #ifdef CLIENT
             mterror(WM_SYS_LOGTAG, "Unable to send message to '%s' (wazuh-agentd might be down). Attempting to reconnect.", DEFAULTQUEUE);
     #else
@@ -70,10 +79,10 @@ static void wm_sys_send_message(const void* data, const char queue_id) {
             // Since this method is beign called by multiple threads it's necessary this particular portion of code
             // to be mutually exclusive. When one thread is successfully reconnected, the other ones will make use of it.
             w_mutex_lock(&sys_reconnect_mutex);
-            if (!is_shutdown_process_started() && wm_sendmsg_ex(eps, queue_fd, data, WM_SYS_LOCATION, queue_id, &is_shutdown_process_started) < 0) {
+            if (!is_shutdown_process_started() && wm_sendmsg_ex(0, queue_fd, data, WM_SYS_LOCATION, queue_id, &is_shutdown_process_started) < 0) {
                 if (queue_fd = MQReconnectPredicated(DEFAULTQUEUE, &is_shutdown_process_started), 0 <= queue_fd) {
                     mtinfo(WM_SYS_LOGTAG, "Successfully reconnected to '%s'", DEFAULTQUEUE);
-                    if (wm_sendmsg_ex(eps, queue_fd, data, WM_SYS_LOCATION, queue_id, &is_shutdown_process_started) < 0) {
+                    if (wm_sendmsg_ex(0, queue_fd, data, WM_SYS_LOCATION, queue_id, &is_shutdown_process_started) < 0) {
                         mterror(WM_SYS_LOGTAG, "Unable to send message to '%s' after a successfull reconnection...", DEFAULTQUEUE);
                     }
                 }
@@ -91,6 +100,33 @@ static void wm_sys_send_dbsync_message(const void* data) {
     wm_sys_send_message(data, DBSYNC_MQ);
 }
 
+/* The output is congested when most of the messages didn't fit in max_eps (that includes
+ * the rsync answers) or when the queue of the agent rejects them. */
+static bool wm_sys_pressure() {
+    const unsigned int sent = __atomic_exchange_n(&sys_sent_messages, 0, __ATOMIC_RELAXED);
+    const unsigned int throttled = __atomic_exchange_n(&sys_throttled_messages, 0, __ATOMIC_RELAXED);
+    const unsigned int failed = __atomic_exchange_n(&sys_failed_messages, 0, __ATOMIC_RELAXED);
+
+    return failed > 0 || throttled * 2 > sent;
+}
+
+/* The agent ID spreads the scans of the agents, the hostname is used until the agent gets one */
+static void wm_sys_jitter_seed(char *seed, size_t size) {
+#ifdef CLIENT
+    char *agent_id;
+
+    if (IsFile(AGENT_INFO_FILE) == 0 && (agent_id = os_read_agent_id(), agent_id)) {
+        snprintf(seed, size, "%s", agent_id);
+        seed[strcspn(seed, "\r\n")] = '\0';
+        os_free(agent_id);
+        return;
+    }
+#endif
+    if (gethostname(seed, size) != 0) {
+        *seed = '\0';
+    }
+}
+
 static void wm_sys_log_config(wm_sys_t *sys)
 {
     cJSON * config_json = wm_sys_dump(sys);
@@ -139,7 +175,8 @@ void* wm_sys_main(wm_sys_t *sys) {
         if(rsync_module = so_check_module_loaded("rsync"), rsync_module) {
             rsync_initialize_full_log_func rsync_initialize_log_function_ptr = so_get_function_sym(rsync_module, "rsync_initialize_full_log_function");
             if(rsync_initialize_log_function_ptr) {
-                rsync_initialize_log_function_ptr(_mtdebug2, _mtdebug1, _mtinfo, _mtwarn, _mterror);
+                // The disabled debug levels get no function, so rsync skips formatting their messages
+                rsync_initialize_log_function_ptr(isDebug() >= 2 ? _mtdebug2 : NULL, isDebug() >= 1 ? _mtdebug1 : NULL, _mtinfo, _mtwarn, _mterror);
             }
             // Even when the RTLD_NOLOAD flag was used for dlopen(), we need a matching call to dlclose()
 #ifndef WIN32
@@ -165,6 +202,24 @@ void* wm_sys_main(wm_sys_t *sys) {
         }
         // else: if max_eps is 0 (from configuration) let's use the default max_eps value (10)
         wm_sys_log_config(sys);
+
+        char seed[OS_SIZE_256] = "";
+        wm_sys_jitter_seed(seed, sizeof(seed));
+
+        const syscollector_schedule_t schedule = {
+            .hardware = sys->intervals.hwinfo,
+            .os = sys->intervals.osinfo,
+            .network = sys->intervals.netinfo,
+            .packages = sys->intervals.programinfo,
+            .hotfixes = sys->intervals.hotfixinfo,
+            .ports = sys->intervals.portsinfo,
+            .processes = sys->intervals.procinfo,
+            .jitter = sys->jitter,
+            .jitter_seed = seed,
+            .max_backoff = WM_SYSCOLLECTOR_MAX_BACKOFF,
+            .pressure = wm_sys_pressure,
+        };
+
         syscollector_start_ptr(sys->interval,
                                wm_sys_send_diff_message,
                                wm_sys_send_dbsync_message,
@@ -180,7 +235,9 @@ void* wm_sys_main(wm_sys_t *sys) {
                                sys->flags.portsinfo,
                                sys->flags.allports,
                                sys->flags.procinfo,
-                               sys->flags.hotfixinfo);
+                               sys->flags.hotfixinfo,
+                               &schedule,
+                               sys->delta_batch_size);
     } else {
         mterror(WM_SYS_LOGTAG, "Can't get syscollector_start_ptr.");
         pthread_exit(NULL);
@@ -232,6 +289,8 @@ cJSON *wm_sys_dump(const wm_sys_t *sys) {
     if (sys->flags.enabled) cJSON_AddStringToObject(wm_sys,"disabled","no"); else cJSON_AddStringToObject(wm_sys,"disabled","yes");
     if (sys->flags.scan_on_start) cJSON_AddStringToObject(wm_sys,"scan-on-start","yes"); else cJSON_AddStringToObject(wm_sys,"scan-on-start","no");
     cJSON_AddNumberToObject(wm_sys,"interval",sys->interval);
+    if (sys->jitter) cJSON_AddNumberToObject(wm_sys,"jitter",sys->jitter);
+    if (sys->delta_batch_size) cJSON_AddNumberToObject(wm_sys,"delta_batch_size",sys->delta_batch_size);
     if (sys->flags.netinfo) cJSON_AddStringToObject(wm_sys,"network","yes"); else cJSON_AddStringToObject(wm_sys,"network","no");
     if (sys->flags.osinfo) cJSON_AddStringToObject(wm_sys,"os","yes"); else cJSON_AddStringToObject(wm_sys,"os","no");
     if (sys->flags.hwinfo) cJSON_AddStringToObject(wm_sys,"hardware","yes"); else cJSON_AddStringToObject(wm_sys,"hardware","no");
@@ -242,6 +301,13 @@ cJSON *wm_sys_dump(const wm_sys_t *sys) {
 #ifdef WIN32
     if (sys->flags.hotfixinfo) cJSON_AddStringToObject(wm_sys,"hotfixes","yes"); else cJSON_AddStringToObject(wm_sys,"hotfixes","no");
 #endif
+    if (sys->intervals.hwinfo) cJSON_AddNumberToObject(wm_sys,"hardware_interval",sys->intervals.hwinfo);
+    if (sys->intervals.osinfo) cJSON_AddNumberToObject(wm_sys,"os_interval",sys->intervals.osinfo);
+    if (sys->intervals.netinfo) cJSON_AddNumberToObject(wm_sys,"network_interval",sys->intervals.netinfo);
+    if (sys->intervals.programinfo) cJSON_AddNumberToObject(wm_sys,"packages_interval",sys->intervals.programinfo);
+    if (sys->intervals.hotfixinfo) cJSON_AddNumberToObject(wm_sys,"hotfixes_interval",sys->intervals.hotfixinfo);
+    if (sys->intervals.portsinfo) cJSON_AddNumberToObject(wm_sys,"ports_interval",sys->intervals.portsinfo);
+    if (sys->intervals.procinfo) cJSON_AddNumberToObject(wm_sys,"processes_interval",sys->intervals.procinfo);
     // Database synchronization values
     cJSON_AddNumberToObject(wm_sys,"sync_max_eps",sys->sync.sync_max_eps);
 
@@ -19,6 +19,7 @@ extern const wm_context WM_SYS_CONTEXT;     // Context
 
 #define WM_SYS_LOGTAG ARGV0 ":syscollector" // Tag for log messages
 #define WM_SYSCOLLECTOR_DEFAULT_INTERVAL W_HOUR_SECONDS
+#define WM_SYSCOLLECTOR_MAX_BACKOFF 8       // Maximum stretch of the intervals while the output is congested
 
 typedef struct wm_sys_flags_t {
     unsigned int enabled:1;                 // Main switch
@@ -33,6 +34,16 @@ typedef struct wm_sys_flags_t {
     unsigned int procinfo:1;                // Running processes inventory
 } wm_sys_flags_t;
 
+typedef struct wm_sys_intervals_t {
+    unsigned int hwinfo;                    // Interval of each inventory (seconds), 0 takes the one of the module
+    unsigned int osinfo;
+    unsigned int netinfo;
+    unsigned int programinfo;
+    unsigned int hotfixinfo;
+    unsigned int portsinfo;
+    unsigned int procinfo;
+} wm_sys_intervals_t;
+
 typedef struct wm_sys_state_t {
     time_t next_time;                       // Absolute time for next scan
 } wm_sys_state_t;
@@ -43,6 +54,9 @@ typedef struct wm_sys_db_sync_flags_t {
 
 typedef struct wm_sys_t {
     unsigned int interval;                  // Time interval between cycles (seconds)
+    wm_sys_intervals_t intervals;           // Time interval of each inventory
+    unsigned int jitter;                    // Maximum delay of the scans, fixed for each agent (seconds)
+    unsigned int delta_batch_size;          // Maximum deltas of a table sent in a message, 0 sends each one apart
     wm_sys_flags_t flags;                   // Flag bitfield
     wm_sys_state_t state;                   // Running state
     wm_sys_db_sync_flags_t sync;            // Database synchronization value
@@ -34,6 +34,12 @@ size_t wmcom_dispatch(char * command, char ** output){
             return strlen(*output);
         }
         return wmcom_getconfig(rcv_args, output);
+    } else if (strncmp(command, HC_GETMETRICS, strlen(HC_GETMETRICS)) == 0 &&
+               (command[strlen(HC_GETMETRICS)] == '\0' || command[strlen(HC_GETMETRICS)] == ' ')) {
+        /*
+         * getmetrics [json|prometheus]
+        */
+        return w_metrics_getmetrics(command[strlen(HC_GETMETRICS)] ? command + strlen(HC_GETMETRICS) + 1 : NULL, output);
     } else if (strncmp(command, "query ", 6) == 0) {
         /*
          * query vulnerability-detector run_now
@@ -86,6 +86,8 @@ int wm_config() {
     wmodule *module;
     // The database module won't be available on agents
 
+    vu_report_queue_size = getDefine_Int("wazuh_modules", "vuldet_report_queue_size", 0, 1000000);
+
     if ((module = wm_database_read()))
         wm_add(module);
 